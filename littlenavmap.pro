@@ -179,7 +179,7 @@ win32 {
 
   CONFIG(debug, debug|release) : LIBS += -L$$MARBLE_LIB_PATH -llibmarblewidget-qt5d
   CONFIG(release, debug|release) : LIBS += -L$$MARBLE_LIB_PATH -llibmarblewidget-qt5
-  LIBS += -L$$ATOOLS_LIB_PATH -latools -lz
+  LIBS += -L$$ATOOLS_LIB_PATH -latools -lz -lpsapi
 }
 
 macx {
@@ -274,18 +274,24 @@ SOURCES += \
   src/common/filecheck.cpp \
   src/common/formatter.cpp \
   src/common/fueltool.cpp \
+  src/common/geobatch.cpp \
   src/common/htmlinfobuilder.cpp \
   src/common/jsoninfobuilder.cpp \
   src/common/jumpback.cpp \
   src/common/mapcolors.cpp \
   src/common/mapflags.cpp \
   src/common/mapresult.cpp \
+  src/common/memoryregistry.cpp \
   src/common/maptools.cpp \
   src/common/maptypes.cpp \
   src/common/maptypesfactory.cpp \
+  src/common/microbenchmark.cpp \
   src/common/procflags.cpp \
   src/common/proctypes.cpp \
   src/common/settingsmigrate.cpp \
+  src/common/stallmonitor.cpp \
+  src/common/stringpool.cpp \
+  src/common/symbolatlas.cpp \
   src/common/symbolpainter.cpp \
   src/common/tabindexes.cpp \
   src/common/textplacement.cpp \
@@ -293,15 +299,20 @@ SOURCES += \
   src/common/unitstringtool.cpp \
   src/common/updatehandler.cpp \
   src/common/vehicleicons.cpp \
+  src/common/waitloop.cpp \
   src/connect/connectclient.cpp \
   src/connect/connectdialog.cpp \
+  src/connect/sessionrecorder.cpp \
   src/db/airspacedialog.cpp \
+  src/db/bulkimporter.cpp \
   src/db/databasedialog.cpp \
   src/db/databaseloader.cpp \
   src/db/databasemanager.cpp \
+  src/db/databasepool.cpp \
   src/db/databaseprogressdialog.cpp \
   src/db/dbtools.cpp \
   src/db/dbtypes.cpp \
+  src/db/statementcache.cpp \
   src/db/undoredoprogress.cpp \
   src/export/csvexporter.cpp \
   src/export/exporter.cpp \
@@ -325,22 +336,33 @@ SOURCES += \
   src/logbook/logdatadialog.cpp \
   src/logbook/logstatisticsdialog.cpp \
   src/main.cpp \
+  src/mapgui/airspacegeometrycache.cpp \
   src/mapgui/aprongeometrycache.cpp \
   src/mapgui/imageexportdialog.cpp \
+  src/mapgui/kmlsimplifier.cpp \
+  src/mapgui/linegeometrycache.cpp \
   src/mapgui/mapairporthandler.cpp \
   src/mapgui/mapcontextmenu.cpp \
   src/mapgui/mapdetailhandler.cpp \
+  src/mapgui/mapelevationtile.cpp \
   src/mapgui/mapfunctions.cpp \
+  src/mapgui/mapimagebatch.cpp \
+  src/mapgui/mapimagetiler.cpp \
   src/mapgui/maplayer.cpp \
   src/mapgui/maplayersettings.cpp \
   src/mapgui/mapmarkhandler.cpp \
   src/mapgui/mappaintwidget.cpp \
+  src/mapgui/mapprefetcher.cpp \
   src/mapgui/mapscale.cpp \
+  src/mapgui/mapscreengrid.cpp \
   src/mapgui/mapscreenindex.cpp \
   src/mapgui/mapthemehandler.cpp \
+  src/mapgui/maptiledownloader.cpp \
   src/mapgui/maptooltip.cpp \
   src/mapgui/mapvisible.cpp \
   src/mapgui/mapwidget.cpp \
+  src/mapgui/projectedgeometrycache.cpp \
+  src/mappainter/labelplacement.cpp \
   src/mappainter/mappainter.cpp \
   src/mappainter/mappainteraircraft.cpp \
   src/mappainter/mappainterairport.cpp \
@@ -358,7 +380,9 @@ SOURCES += \
   src/mappainter/mappaintervehicle.cpp \
   src/mappainter/mappainterweather.cpp \
   src/mappainter/mappainterwind.cpp \
+  src/mappainter/gpulayerrenderer.cpp \
   src/mappainter/mappaintlayer.cpp \
+  src/mappainter/paintstatistics.cpp \
   src/online/onlinedatacontroller.cpp \
   src/options/optiondata.cpp \
   src/options/optionsdialog.cpp \
@@ -373,16 +397,24 @@ SOURCES += \
   src/profile/profilescrollarea.cpp \
   src/profile/profilewidget.cpp \
   src/query/airportquery.cpp \
+  src/query/airspacecontainment.cpp \
+  src/query/airspacegeometryfile.cpp \
+  src/query/airspaceindex.cpp \
   src/query/airspacequery.cpp \
   src/query/airwayquery.cpp \
   src/query/airwaytrackquery.cpp \
   src/query/infoquery.cpp \
   src/query/mapquery.cpp \
+  src/query/neareststore.cpp \
+  src/query/onlinecentergeometryfile.cpp \
   src/query/procedurequery.cpp \
+  src/query/procedurestore.cpp \
   src/query/querytypes.cpp \
+  src/query/spatialindex.cpp \
   src/query/waypointquery.cpp \
   src/query/waypointtrackquery.cpp \
   src/route/customproceduredialog.cpp \
+  src/route/cruisealtitudedialog.cpp \
   src/route/flightplanentrybuilder.cpp \
   src/route/parkingdialog.cpp \
   src/route/route.cpp \
@@ -405,6 +437,7 @@ SOURCES += \
   src/routeexport/routeexportformat.cpp \
   src/routeexport/routemultiexportdialog.cpp \
   src/routeexport/simbriefhandler.cpp \
+  src/routestring/routestringbatch.cpp \
   src/routestring/routestringdialog.cpp \
   src/routestring/routestringreader.cpp \
   src/routestring/routestringtypes.cpp \
@@ -414,6 +447,8 @@ SOURCES += \
   src/search/airportsearch.cpp \
   src/search/column.cpp \
   src/search/columnlist.cpp \
+  src/search/featureindex.cpp \
+  src/search/fulltextindex.cpp \
   src/search/logdatasearch.cpp \
   src/search/navicondelegate.cpp \
   src/search/navsearch.cpp \
@@ -423,12 +458,12 @@ SOURCES += \
   src/search/proceduresearch.cpp \
   src/search/querybuilder.cpp \
   src/search/randomdepartureairportpickingbycriteria.cpp \
-  src/search/randomdestinationairportpickingbycriteria.cpp \
   src/search/searchbasetable.cpp \
   src/search/searchcontroller.cpp \
   src/search/sqlcontroller.cpp \
   src/search/sqlmodel.cpp \
   src/search/sqlmodeltypes.cpp \
+  src/search/sqlpagecache.cpp \
   src/search/sqlproxymodel.cpp \
   src/search/userdatasearch.cpp \
   src/search/usericondelegate.cpp \
@@ -440,18 +475,25 @@ SOURCES += \
   src/weather/weathercontext.cpp \
   src/weather/weathercontexthandler.cpp \
   src/weather/weatherreporter.cpp \
+  src/weather/windfield.cpp \
   src/weather/windreporter.cpp \
+  src/web/imageencoder.cpp \
   src/web/requesthandler.cpp \
+  src/web/staticfilecache.cpp \
   src/web/webapp.cpp \
   src/web/webcontroller.cpp \
   src/web/webflags.cpp \
   src/web/webmapcontroller.cpp \
+  src/web/webmetrics.cpp \
+  src/web/webpushchannel.cpp \
+  src/web/websnapshot.cpp \
   src/web/webtools.cpp \
   src/webapi/abstractactionscontroller.cpp \
   src/webapi/abstractlnmactionscontroller.cpp \
   src/webapi/actionscontrollerindex.cpp \
   src/webapi/airportactionscontroller.cpp \
   src/webapi/mapactionscontroller.cpp \
+  src/webapi/routeactionscontroller.cpp \
   src/webapi/simactionscontroller.cpp \
   src/webapi/uiactionscontroller.cpp \
   src/webapi/webapicontroller.cpp
@@ -472,7 +514,9 @@ HEADERS  += \
   src/common/elevationprovider.h \
   src/common/filecheck.h \
   src/common/formatter.h \
+  src/common/framearena.h \
   src/common/fueltool.h \
+  src/common/geobatch.h \
   src/common/htmlinfobuilder.h \
   src/common/htmlinfobuilderflags.h \
   src/common/infobuildertypes.h \
@@ -481,12 +525,17 @@ HEADERS  += \
   src/common/mapcolors.h \
   src/common/mapflags.h \
   src/common/mapresult.h \
+  src/common/memoryregistry.h \
   src/common/maptools.h \
   src/common/maptypes.h \
   src/common/maptypesfactory.h \
+  src/common/microbenchmark.h \
   src/common/procflags.h \
   src/common/proctypes.h \
   src/common/settingsmigrate.h \
+  src/common/stallmonitor.h \
+  src/common/stringpool.h \
+  src/common/symbolatlas.h \
   src/common/symbolpainter.h \
   src/common/tabindexes.h \
   src/common/textplacement.h \
@@ -494,15 +543,20 @@ HEADERS  += \
   src/common/unitstringtool.h \
   src/common/updatehandler.h \
   src/common/vehicleicons.h \
+  src/common/waitloop.h \
   src/connect/connectclient.h \
   src/connect/connectdialog.h \
+  src/connect/sessionrecorder.h \
   src/db/airspacedialog.h \
+  src/db/bulkimporter.h \
   src/db/databasedialog.h \
   src/db/databaseloader.h \
   src/db/databasemanager.h \
+  src/db/databasepool.h \
   src/db/databaseprogressdialog.h \
   src/db/dbtools.h \
   src/db/dbtypes.h \
+  src/db/statementcache.h \
   src/db/undoredoprogress.h \
   src/export/csvexporter.h \
   src/export/exporter.h \
@@ -525,22 +579,33 @@ HEADERS  += \
   src/logbook/logdataconverter.h \
   src/logbook/logdatadialog.h \
   src/logbook/logstatisticsdialog.h \
+  src/mapgui/airspacegeometrycache.h \
   src/mapgui/aprongeometrycache.h \
   src/mapgui/imageexportdialog.h \
+  src/mapgui/kmlsimplifier.h \
+  src/mapgui/linegeometrycache.h \
   src/mapgui/mapairporthandler.h \
   src/mapgui/mapcontextmenu.h \
   src/mapgui/mapdetailhandler.h \
+  src/mapgui/mapelevationtile.h \
   src/mapgui/mapfunctions.h \
+  src/mapgui/mapimagebatch.h \
+  src/mapgui/mapimagetiler.h \
   src/mapgui/maplayer.h \
   src/mapgui/maplayersettings.h \
   src/mapgui/mapmarkhandler.h \
   src/mapgui/mappaintwidget.h \
+  src/mapgui/mapprefetcher.h \
   src/mapgui/mapscale.h \
+  src/mapgui/mapscreengrid.h \
   src/mapgui/mapscreenindex.h \
   src/mapgui/mapthemehandler.h \
+  src/mapgui/maptiledownloader.h \
   src/mapgui/maptooltip.h \
   src/mapgui/mapvisible.h \
   src/mapgui/mapwidget.h \
+  src/mapgui/projectedgeometrycache.h \
+  src/mappainter/labelplacement.h \
   src/mappainter/mappainter.h \
   src/mappainter/mappainteraircraft.h \
   src/mappainter/mappainterairport.h \
@@ -558,7 +623,9 @@ HEADERS  += \
   src/mappainter/mappaintervehicle.h \
   src/mappainter/mappainterweather.h \
   src/mappainter/mappainterwind.h \
+  src/mappainter/gpulayerrenderer.h \
   src/mappainter/mappaintlayer.h \
+  src/mappainter/paintstatistics.h \
   src/online/onlinedatacontroller.h \
   src/options/optiondata.h \
   src/options/optionsdialog.h \
@@ -573,16 +640,24 @@ HEADERS  += \
   src/profile/profilescrollarea.h \
   src/profile/profilewidget.h \
   src/query/airportquery.h \
+  src/query/airspacecontainment.h \
+  src/query/airspacegeometryfile.h \
+  src/query/airspaceindex.h \
   src/query/airspacequery.h \
   src/query/airwayquery.h \
   src/query/airwaytrackquery.h \
   src/query/infoquery.h \
   src/query/mapquery.h \
+  src/query/neareststore.h \
+  src/query/onlinecentergeometryfile.h \
   src/query/procedurequery.h \
+  src/query/procedurestore.h \
   src/query/querytypes.h \
+  src/query/spatialindex.h \
   src/query/waypointquery.h \
   src/query/waypointtrackquery.h \
   src/route/customproceduredialog.h \
+  src/route/cruisealtitudedialog.h \
   src/route/flightplanentrybuilder.h \
   src/route/parkingdialog.h \
   src/route/route.h \
@@ -606,6 +681,7 @@ HEADERS  += \
   src/routeexport/routeexportformat.h \
   src/routeexport/routemultiexportdialog.h \
   src/routeexport/simbriefhandler.h \
+  src/routestring/routestringbatch.h \
   src/routestring/routestringdialog.h \
   src/routestring/routestringreader.h \
   src/routestring/routestringtypes.h \
@@ -615,6 +691,8 @@ HEADERS  += \
   src/search/airportsearch.h \
   src/search/column.h \
   src/search/columnlist.h \
+  src/search/featureindex.h \
+  src/search/fulltextindex.h \
   src/search/logdatasearch.h \
   src/search/navicondelegate.h \
   src/search/navsearch.h \
@@ -624,12 +702,12 @@ HEADERS  += \
   src/search/proceduresearch.h \
   src/search/querybuilder.h \
   src/search/randomdepartureairportpickingbycriteria.h \
-  src/search/randomdestinationairportpickingbycriteria.h \
   src/search/searchbasetable.h \
   src/search/searchcontroller.h \
   src/search/sqlcontroller.h \
   src/search/sqlmodel.h \
   src/search/sqlmodeltypes.h \
+  src/search/sqlpagecache.h \
   src/search/sqlproxymodel.h \
   src/search/userdatasearch.h \
   src/search/usericondelegate.h \
@@ -641,18 +719,25 @@ HEADERS  += \
   src/weather/weathercontext.h \
   src/weather/weathercontexthandler.h \
   src/weather/weatherreporter.h \
+  src/weather/windfield.h \
   src/weather/windreporter.h \
+  src/web/imageencoder.h \
   src/web/requesthandler.h \
+  src/web/staticfilecache.h \
   src/web/webapp.h \
   src/web/webcontroller.h \
   src/web/webflags.h \
   src/web/webmapcontroller.h \
+  src/web/webmetrics.h \
+  src/web/webpushchannel.h \
+  src/web/websnapshot.h \
   src/web/webtools.h \
   src/webapi/abstractactionscontroller.h \
   src/webapi/abstractlnmactionscontroller.h \
   src/webapi/actionscontrollerindex.h \
   src/webapi/airportactionscontroller.h \
   src/webapi/mapactionscontroller.h \
+  src/webapi/routeactionscontroller.h \
   src/webapi/simactionscontroller.h \
   src/webapi/uiactionscontroller.h \
   src/webapi/webapicontroller.h \
@@ -681,6 +766,7 @@ FORMS += \
   src/perf/perfmergedialog.ui \
   src/print/printdialog.ui \
   src/route/customproceduredialog.ui \
+  src/route/cruisealtitudedialog.ui \
   src/route/parkingdialog.ui \
   src/route/routecalcdialog.ui \
   src/route/runwayselectiondialog.ui \
@@ -27,6 +27,8 @@
 #include "fs/userdata/airspacereaderivao.h"
 #include "fs/userdata/airspacereaderopenair.h"
 #include "fs/userdata/airspacereadervatsim.h"
+#include "geo/calculations.h"
+#include "geo/rect.h"
 #include "gui/errorhandler.h"
 #include "gui/mainwindow.h"
 #include "gui/textdialog.h"
@@ -34,6 +36,8 @@
 #include "app/navapp.h"
 #include "query/airportquery.h"
 #include "query/airspacequery.h"
+#include "route/route.h"
+#include "route/routealtitude.h"
 #include "sql/sqltransaction.h"
 #include "ui_mainwindow.h"
 #include "util/htmlbuilder.h"
@@ -44,6 +48,34 @@
 #include <QMessageBox>
 #include <QProgressDialog>
 
+namespace  {
+
+/* true if any point sampled along the section is inside the boundary or closer than corridor */
+bool sectionTouchesBoundary(const atools::geo::Pos& from, const atools::geo::Pos& to, AirspaceQuery *query, int airspaceId,
+                            const atools::geo::LineString& boundary, float corridorMeter)
+{
+  float step = std::max(corridorMeter, atools::geo::nmToMeter(1.f));
+  int num = std::max(1, static_cast<int>(std::ceil(from.distanceMeterTo(to) / step)));
+
+  for(int i = 0; i <= num; i++)
+  {
+    atools::geo::Pos pos = from.interpolate(to, static_cast<float>(i) / num);
+    if(query->isPosInsideAirspace(airspaceId, pos))
+      return true;
+
+    if(corridorMeter > 0.f)
+    {
+      atools::geo::LineDistance result;
+      boundary.distanceMeterToLineString(pos, result);
+      if(result.status != atools::geo::INVALID && std::abs(result.distance) <= corridorMeter)
+        return true;
+    }
+  }
+  return false;
+}
+
+}
+
 AirspaceController::AirspaceController(MainWindow *mainWindowParam,
                                        atools::sql::SqlDatabase *dbSim, atools::sql::SqlDatabase *dbNav,
                                        atools::sql::SqlDatabase *dbUser, atools::sql::SqlDatabase *dbOnline)
@@ -208,7 +240,110 @@ void AirspaceController::getAirspaces(AirspaceVector& airspaces, const Marble::G
   }
 }
 
-const atools::geo::LineString *AirspaceController::getAirspaceGeometry(map::MapAirspaceId id)
+QVector<AirspaceLegResult> AirspaceController::getAirspacesAlongRoute(const Route& route, float corridorNm,
+                                                                      const map::MapAirspaceFilter& filter,
+                                                                      map::MapAirspaceSources sourcesParam)
+{
+  // Split legs into sections to keep the bounding rectangles small for long great circle legs
+  const static float MAX_SECTION_METER = atools::geo::nmToMeter(100.f);
+  const float corridorMeter = atools::geo::nmToMeter(corridorNm);
+  const RouteAltitude& altitudeLegs = route.getAltitudeLegs();
+  bool hasAltitude = altitudeLegs.size() == route.size();
+  float cruiseAltitude = route.getCruiseAltitudeFt();
+
+  QVector<atools::geo::Rect> rects;
+  QVector<std::pair<float, float> > altitudeRanges;
+  QVector<int> legIndexes;
+  QVector<std::pair<atools::geo::Pos, atools::geo::Pos> > sections;
+  for(int legIndex = 1; legIndex < route.size(); legIndex++)
+  {
+    const RouteLeg& leg = route.value(legIndex);
+    if(leg.isAlternate() || leg.getProcedureLeg().isMissed())
+      continue;
+
+    std::pair<float, float> altRange(cruiseAltitude, cruiseAltitude);
+    if(hasAltitude && !altitudeLegs.value(legIndex).isEmpty())
+      altRange = std::make_pair(altitudeLegs.value(legIndex).getMinAltitude(), altitudeLegs.value(legIndex).getMaxAltitude());
+
+    const atools::geo::LineString& geometry = leg.getGeometry();
+    for(int i = 1; i < geometry.size(); i++)
+    {
+      const atools::geo::Pos& from = geometry.at(i - 1);
+      const atools::geo::Pos& to = geometry.at(i);
+      int num = std::max(1, static_cast<int>(std::ceil(from.distanceMeterTo(to) / MAX_SECTION_METER)));
+      for(int j = 0; j < num; j++)
+      {
+        atools::geo::Pos p1 = from.interpolate(to, static_cast<float>(j) / num);
+        atools::geo::Pos p2 = from.interpolate(to, static_cast<float>(j + 1) / num);
+        atools::geo::Rect rect(p1, corridorMeter, true /* fast */);
+        rect.extend(atools::geo::Rect(p2, corridorMeter, true /* fast */));
+
+        rects.append(rect);
+        altitudeRanges.append(altRange);
+        legIndexes.append(legIndex);
+        sections.append(std::make_pair(p1, p2));
+      }
+    }
+  }
+
+  QVector<AirspaceLegResult> results;
+  for(map::MapAirspaceSources src : map::MAP_AIRSPACE_SRC_NO_ONLINE_VALUES)
+  {
+    if(!(sourcesParam & src) || ((src & map::AIRSPACE_SRC_USER) && loadingUserAirspaces))
+      continue;
+
+    AirspaceQuery *query = queries.value(src);
+    if(query == nullptr)
+      continue;
+
+    // One indexed pass over all sections
+    QVector<std::pair<int, map::MapAirspace> > candidates;
+    query->getAirspacesForRects(candidates, rects, altitudeRanges, filter);
+
+    // Check geometry and add each airspace once per leg
+    QSet<std::pair<int, int> > found;
+    for(const std::pair<int, map::MapAirspace>& candidate : qAsConst(candidates))
+    {
+      int legIndex = legIndexes.at(candidate.first);
+      std::pair<int, int> key(legIndex, candidate.second.id);
+      if(found.contains(key))
+        continue;
+
+      const atools::geo::LineString *boundary = query->getAirspaceGeometryById(candidate.second.id);
+      const std::pair<atools::geo::Pos, atools::geo::Pos>& section = sections.at(candidate.first);
+      if(boundary != nullptr && sectionTouchesBoundary(section.first, section.second, query, candidate.second.id, *boundary,
+                                                         corridorMeter))
+      {
+        found.insert(key);
+        results.append({legIndex, candidate.second});
+      }
+    }
+  }
+
+  std::sort(results.begin(), results.end(), [](const AirspaceLegResult& result1, const AirspaceLegResult& result2) -> bool {
+    return result1.legIndex < result2.legIndex;
+  });
+  return results;
+}
+
+QList<map::MapAirspace> AirspaceController::getAirspacesAtPos(const atools::geo::Pos& pos, float altitudeFt,
+                                                             const map::MapAirspaceFilter& filter,
+                                                             map::MapAirspaceSources sourcesParam)
+{
+  QList<map::MapAirspace> airspaces;
+  for(map::MapAirspaceSources src : map::MAP_AIRSPACE_SRC_NO_ONLINE_VALUES)
+  {
+    if(!(sourcesParam & src) || ((src & map::AIRSPACE_SRC_USER) && loadingUserAirspaces))
+      continue;
+
+    AirspaceQuery *query = queries.value(src);
+    if(query != nullptr)
+      query->getAirspacesAtPos(airspaces, pos, altitudeFt, filter);
+  }
+  return airspaces;
+}
+
+const atools::geo::LineString *AirspaceController::getAirspaceGeometry(map::MapAirspaceId id, const MapLayer *mapLayer)
 {
   if((id.src & map::AIRSPACE_SRC_USER) && loadingUserAirspaces)
     // Avoid deadlock while loading user airspaces
@@ -216,7 +351,7 @@ const atools::geo::LineString *AirspaceController::getAirspaceGeometry(map::MapA
 
   AirspaceQuery *query = queries.value(id.src);
   if(query != nullptr)
-    return query->getAirspaceGeometryById(id.id);
+    return query->getAirspaceGeometryById(id.id, mapLayer);
 
   return nullptr;
 }
@@ -273,12 +408,6 @@ void AirspaceController::postDatabaseLoad()
   }
 }
 
-void AirspaceController::onlineClientAndAtcUpdated()
-{
-  if(queries.contains(map::AIRSPACE_SRC_ONLINE))
-    queries.value(map::AIRSPACE_SRC_ONLINE)->clearCache();
-}
-
 void AirspaceController::resetAirspaceOnlineScreenGeometry()
 {
   if(queries.contains(map::AIRSPACE_SRC_ONLINE))
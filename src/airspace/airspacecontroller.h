@@ -42,12 +42,20 @@ class GeoDataLatLonBox;
 
 class AirspaceQuery;
 class MapLayer;
+class Route;
 class AirspaceToolBarHandler;
 class MainWindow;
 
 typedef  QHash<map::MapAirspaceSources, AirspaceQuery *> AirspaceQueryMapType;
 typedef  QVector<const map::MapAirspace *> AirspaceVector;
 
+/* Airspace crossed by or touching the corridor of a flight plan leg */
+struct AirspaceLegResult
+{
+  int legIndex;
+  map::MapAirspace airspace;
+};
+
 /*
  * Wraps the airspace queries for nav, sim, user and online airspaces.
  * Provides a method to import user airspaces recursively from a folder.
@@ -83,8 +91,20 @@ public:
                     const map::MapAirspaceFilter& filter, float flightPlanAltitude, bool lazy,
                     map::MapAirspaceSources sourcesParam, bool& overflow);
 
-  /* Get Geometry for any airspace and source database */
-  const atools::geo::LineString *getAirspaceGeometry(map::MapAirspaceId id);
+  /* Get airspaces within corridorNm of the flight plan legs and within the altitude band of each leg given by
+   * the altitude profile. Uses one indexed query per leg section and checks the boundary geometry afterwards.
+   * Missed approaches, alternates and online centers are not included. */
+  QVector<AirspaceLegResult> getAirspacesAlongRoute(const Route& route, float corridorNm, const map::MapAirspaceFilter& filter,
+                                                    map::MapAirspaceSources sourcesParam);
+
+  /* Get airspaces containing the position at the given altitude in feet. Uses the cached point in polygon
+   * structures of the queries. Online centers are not included. */
+  QList<map::MapAirspace> getAirspacesAtPos(const atools::geo::Pos& pos, float altitudeFt, const map::MapAirspaceFilter& filter,
+                                            map::MapAirspaceSources sourcesParam);
+
+  /* Get Geometry for any airspace and source database. Returns simplified geometry if zoomed out and
+   * map layer is given. Full resolution if mapLayer is null. */
+  const atools::geo::LineString *getAirspaceGeometry(map::MapAirspaceId id, const MapLayer *mapLayer = nullptr);
 
   /* Read and write widget states, source and airspace selection */
   void restoreState();
@@ -98,9 +118,6 @@ public:
   /* Re-initializes all queries */
   void postDatabaseLoad();
 
-  /* Clears cache for online database changes */
-  void onlineClientAndAtcUpdated();
-
   /* Resets all queries */
   void resetAirspaceOnlineScreenGeometry();
 
@@ -91,6 +91,119 @@ CommandLine::CommandLine()
                                                    "The code is not checked for existence or validity and "
                                                    "is saved for the next startup."), "language");
   parser->addOption(*languageOpt);
+
+  routeBatchOpt = new QCommandLineOption(lnm::STARTUP_ROUTE_BATCH,
+                                         QObject::tr("Read all flight plan route descriptions from the text file <%1> after startup. "
+                                                     "One description per line. Empty lines and lines starting with \"#\" "
+                                                     "are ignored.").arg(lnm::STARTUP_ROUTE_BATCH),
+                                         lnm::STARTUP_ROUTE_BATCH);
+  parser->addOption(*routeBatchOpt);
+
+  routeBatchOutputOpt = new QCommandLineOption(lnm::STARTUP_ROUTE_BATCH_OUTPUT,
+                                               QObject::tr("Save flight plans read by option \"%1\" as \".lnmpln\" files "
+                                                           "and a report into directory <%2>. "
+                                                           "Missing directories are created.").
+                                               arg(lnm::STARTUP_ROUTE_BATCH).arg(lnm::STARTUP_ROUTE_BATCH_OUTPUT),
+                                               lnm::STARTUP_ROUTE_BATCH_OUTPUT);
+  parser->addOption(*routeBatchOutputOpt);
+
+  routeBatchBenchmarkOpt = new QCommandLineOption(lnm::STARTUP_ROUTE_BATCH_BENCHMARK,
+                                                  QObject::tr("Add parse, resolve and write timings per flight plan to the report "
+                                                              "of option \"%1\".").arg(lnm::STARTUP_ROUTE_BATCH));
+  parser->addOption(*routeBatchBenchmarkOpt);
+
+  routeBatchQuitOpt = new QCommandLineOption(lnm::STARTUP_ROUTE_BATCH_QUIT,
+                                             QObject::tr("Exit application after processing option \"%1\".").arg(lnm::STARTUP_ROUTE_BATCH));
+  parser->addOption(*routeBatchQuitOpt);
+
+  imageBatchOpt = new QCommandLineOption(lnm::STARTUP_IMAGE_BATCH,
+                                         QObject::tr("Render map images for all entries in the text file <%1> after startup. "
+                                                     "One flight plan file name or rectangle \"rect:leftlon,toplat,rightlon,bottomlat\" "
+                                                     "per line. Empty lines and lines starting with \"#\" "
+                                                     "are ignored.").arg(lnm::STARTUP_IMAGE_BATCH),
+                                         lnm::STARTUP_IMAGE_BATCH);
+  parser->addOption(*imageBatchOpt);
+
+  imageBatchOutputOpt = new QCommandLineOption(lnm::STARTUP_IMAGE_BATCH_OUTPUT,
+                                               QObject::tr("Save images rendered by option \"%1\" as \".png\" files "
+                                                           "and a report into directory <%2>. "
+                                                           "Missing directories are created.").
+                                               arg(lnm::STARTUP_IMAGE_BATCH).arg(lnm::STARTUP_IMAGE_BATCH_OUTPUT),
+                                               lnm::STARTUP_IMAGE_BATCH_OUTPUT);
+  parser->addOption(*imageBatchOutputOpt);
+
+  imageBatchSizeOpt = new QCommandLineOption(lnm::STARTUP_IMAGE_BATCH_SIZE,
+                                             QObject::tr("Image size <%1> like \"1920x1080\" for option \"%2\". "
+                                                         "Default is \"1920x1080\".").
+                                             arg(lnm::STARTUP_IMAGE_BATCH_SIZE).arg(lnm::STARTUP_IMAGE_BATCH),
+                                             lnm::STARTUP_IMAGE_BATCH_SIZE);
+  parser->addOption(*imageBatchSizeOpt);
+
+  imageBatchQuitOpt = new QCommandLineOption(lnm::STARTUP_IMAGE_BATCH_QUIT,
+                                             QObject::tr("Exit application after processing option \"%1\".").arg(lnm::STARTUP_IMAGE_BATCH));
+  parser->addOption(*imageBatchQuitOpt);
+
+  benchmarkOpt = new QCommandLineOption(lnm::STARTUP_BENCHMARK,
+                                        QObject::tr("Run benchmarks for geometry, query and paint functions after startup "
+                                                    "and save the results to the JSON file <%1>. "
+                                                    "The loaded flight plan and database are used. Use the same plan and "
+                                                    "database for comparable results.").arg(lnm::STARTUP_BENCHMARK),
+                                        lnm::STARTUP_BENCHMARK);
+  parser->addOption(*benchmarkOpt);
+
+  benchmarkBaselineOpt = new QCommandLineOption(lnm::STARTUP_BENCHMARK_BASELINE,
+                                                QObject::tr("Compare results of option "%1" with the JSON file <%2> "
+                                                            "saved by a previous run and report regressions.").
+                                                arg(lnm::STARTUP_BENCHMARK).arg(lnm::STARTUP_BENCHMARK_BASELINE),
+                                                lnm::STARTUP_BENCHMARK_BASELINE);
+  parser->addOption(*benchmarkBaselineOpt);
+
+  benchmarkQuitOpt = new QCommandLineOption(lnm::STARTUP_BENCHMARK_QUIT,
+                                            QObject::tr("Exit application after processing option "%1".").arg(lnm::STARTUP_BENCHMARK));
+  parser->addOption(*benchmarkQuitOpt);
+
+  sessionRecordOpt = new QCommandLineOption(lnm::STARTUP_SESSION_RECORD,
+                                            QObject::tr("Record all data received from the simulator into the file <%1> "
+                                                        "until the application exits.").arg(lnm::STARTUP_SESSION_RECORD),
+                                            lnm::STARTUP_SESSION_RECORD);
+  parser->addOption(*sessionRecordOpt);
+
+  sessionReplayOpt = new QCommandLineOption(lnm::STARTUP_SESSION_REPLAY,
+                                            QObject::tr("Replay simulator data from the file <%1> recorded with option \"%2\" "
+                                                        "after startup and report timings and memory usage.").
+                                            arg(lnm::STARTUP_SESSION_REPLAY).arg(lnm::STARTUP_SESSION_RECORD),
+                                            lnm::STARTUP_SESSION_REPLAY);
+  parser->addOption(*sessionReplayOpt);
+
+  sessionReplaySpeedOpt = new QCommandLineOption(lnm::STARTUP_SESSION_REPLAY_SPEED,
+                                                 QObject::tr("Speed factor <%1> for option \"%2\" like \"10\". "
+                                                             "\"0\" replays as fast as possible. Default is \"1\".").
+                                                 arg(lnm::STARTUP_SESSION_REPLAY_SPEED).arg(lnm::STARTUP_SESSION_REPLAY),
+                                                 lnm::STARTUP_SESSION_REPLAY_SPEED);
+  parser->addOption(*sessionReplaySpeedOpt);
+
+  sessionReplayReportOpt = new QCommandLineOption(lnm::STARTUP_SESSION_REPLAY_REPORT,
+                                                  QObject::tr("Save the report of option \"%1\" into the text file <%2>.").
+                                                  arg(lnm::STARTUP_SESSION_REPLAY).arg(lnm::STARTUP_SESSION_REPLAY_REPORT),
+                                                  lnm::STARTUP_SESSION_REPLAY_REPORT);
+  parser->addOption(*sessionReplayReportOpt);
+
+  sessionReplayQuitOpt = new QCommandLineOption(lnm::STARTUP_SESSION_REPLAY_QUIT,
+                                                QObject::tr("Exit application after processing option \"%1\".").
+                                                arg(lnm::STARTUP_SESSION_REPLAY));
+  parser->addOption(*sessionReplayQuitOpt);
+
+  headlessOpt = new QCommandLineOption(lnm::STARTUP_HEADLESS,
+                                       QObject::tr("Use the offscreen platform and do not show any windows. "
+                                                   "Intended for batch processing with options like \"%1\" on servers "
+                                                   "without display.").arg(lnm::STARTUP_IMAGE_BATCH));
+  parser->addOption(*headlessOpt);
+
+  serverOpt = new QCommandLineOption(lnm::STARTUP_SERVER,
+                                     QObject::tr("Run as web and API server only. Uses the offscreen platform, does not show any "
+                                                 "windows or dialogs and always starts the web server. "
+                                                 "Map images for the web interface are rendered offscreen."));
+  parser->addOption(*serverOpt);
 }
 
 CommandLine::~CommandLine()
@@ -105,6 +218,24 @@ CommandLine::~CommandLine()
   delete performanceOpt;
   delete layoutOpt;
   delete languageOpt;
+  delete routeBatchOpt;
+  delete routeBatchOutputOpt;
+  delete routeBatchBenchmarkOpt;
+  delete routeBatchQuitOpt;
+  delete imageBatchOpt;
+  delete imageBatchOutputOpt;
+  delete imageBatchSizeOpt;
+  delete imageBatchQuitOpt;
+  delete benchmarkOpt;
+  delete benchmarkBaselineOpt;
+  delete benchmarkQuitOpt;
+  delete sessionRecordOpt;
+  delete sessionReplayOpt;
+  delete sessionReplaySpeedOpt;
+  delete sessionReplayReportOpt;
+  delete sessionReplayQuitOpt;
+  delete headlessOpt;
+  delete serverOpt;
 }
 
 void CommandLine::process()
@@ -142,6 +273,76 @@ void CommandLine::process()
   if(parser->isSet(*layoutOpt) && !parser->value(*layoutOpt).isEmpty())
     NavApp::addStartupOptionStr(lnm::STARTUP_LAYOUT, parser->value(*layoutOpt));
 
+  // Batch conversion of route descriptions
+  if(parser->isSet(*routeBatchOpt) && !parser->value(*routeBatchOpt).isEmpty())
+  {
+    NavApp::addStartupOptionStr(lnm::STARTUP_ROUTE_BATCH, parser->value(*routeBatchOpt));
+
+    if(parser->isSet(*routeBatchOutputOpt) && !parser->value(*routeBatchOutputOpt).isEmpty())
+      NavApp::addStartupOptionStr(lnm::STARTUP_ROUTE_BATCH_OUTPUT, parser->value(*routeBatchOutputOpt));
+
+    if(parser->isSet(*routeBatchBenchmarkOpt))
+      NavApp::addStartupOptionStr(lnm::STARTUP_ROUTE_BATCH_BENCHMARK, "true");
+
+    if(parser->isSet(*routeBatchQuitOpt))
+      NavApp::addStartupOptionStr(lnm::STARTUP_ROUTE_BATCH_QUIT, "true");
+  }
+
+  // Batch rendering of map images
+  if(parser->isSet(*imageBatchOpt) && !parser->value(*imageBatchOpt).isEmpty())
+  {
+    NavApp::addStartupOptionStr(lnm::STARTUP_IMAGE_BATCH, parser->value(*imageBatchOpt));
+
+    if(parser->isSet(*imageBatchOutputOpt) && !parser->value(*imageBatchOutputOpt).isEmpty())
+      NavApp::addStartupOptionStr(lnm::STARTUP_IMAGE_BATCH_OUTPUT, parser->value(*imageBatchOutputOpt));
+
+    if(parser->isSet(*imageBatchSizeOpt) && !parser->value(*imageBatchSizeOpt).isEmpty())
+      NavApp::addStartupOptionStr(lnm::STARTUP_IMAGE_BATCH_SIZE, parser->value(*imageBatchSizeOpt));
+
+    if(parser->isSet(*imageBatchQuitOpt))
+      NavApp::addStartupOptionStr(lnm::STARTUP_IMAGE_BATCH_QUIT, "true");
+  }
+
+  // Benchmarks
+  if(parser->isSet(*benchmarkOpt) && !parser->value(*benchmarkOpt).isEmpty())
+  {
+    NavApp::addStartupOptionStr(lnm::STARTUP_BENCHMARK, parser->value(*benchmarkOpt));
+
+    if(parser->isSet(*benchmarkBaselineOpt) && !parser->value(*benchmarkBaselineOpt).isEmpty())
+      NavApp::addStartupOptionStr(lnm::STARTUP_BENCHMARK_BASELINE, parser->value(*benchmarkBaselineOpt));
+
+    if(parser->isSet(*benchmarkQuitOpt))
+      NavApp::addStartupOptionStr(lnm::STARTUP_BENCHMARK_QUIT, "true");
+  }
+
+  // Recording and replay of simulator data
+  if(parser->isSet(*sessionRecordOpt) && !parser->value(*sessionRecordOpt).isEmpty())
+    NavApp::addStartupOptionStr(lnm::STARTUP_SESSION_RECORD, parser->value(*sessionRecordOpt));
+
+  if(parser->isSet(*sessionReplayOpt) && !parser->value(*sessionReplayOpt).isEmpty())
+  {
+    NavApp::addStartupOptionStr(lnm::STARTUP_SESSION_REPLAY, parser->value(*sessionReplayOpt));
+
+    if(parser->isSet(*sessionReplaySpeedOpt) && !parser->value(*sessionReplaySpeedOpt).isEmpty())
+      NavApp::addStartupOptionStr(lnm::STARTUP_SESSION_REPLAY_SPEED, parser->value(*sessionReplaySpeedOpt));
+
+    if(parser->isSet(*sessionReplayReportOpt) && !parser->value(*sessionReplayReportOpt).isEmpty())
+      NavApp::addStartupOptionStr(lnm::STARTUP_SESSION_REPLAY_REPORT, parser->value(*sessionReplayReportOpt));
+
+    if(parser->isSet(*sessionReplayQuitOpt))
+      NavApp::addStartupOptionStr(lnm::STARTUP_SESSION_REPLAY_QUIT, "true");
+  }
+
+  if(parser->isSet(*headlessOpt))
+    NavApp::addStartupOptionStr(lnm::STARTUP_HEADLESS, "true");
+
+  // Server mode implies headless to suppress dialogs in batch functions
+  if(parser->isSet(*serverOpt))
+  {
+    NavApp::addStartupOptionStr(lnm::STARTUP_SERVER, "true");
+    NavApp::addStartupOptionStr(lnm::STARTUP_HEADLESS, "true");
+  }
+
   // Other arguments without option
   if(!parser->positionalArguments().isEmpty())
     NavApp::addStartupOptionStrList(lnm::STARTUP_OTHER_ARGUMENTS, parser->positionalArguments());
@@ -62,7 +62,13 @@ private:
 
   QCommandLineOption *settingsDirOpt = nullptr, *settingsPathOpt = nullptr, *logPathOpt = nullptr, *cachePathOpt = nullptr,
                      *flightplanOpt = nullptr, *flightplanDescrOpt = nullptr, *performanceOpt,
-                     *layoutOpt = nullptr, *languageOpt = nullptr;
+                     *layoutOpt = nullptr, *languageOpt = nullptr, *routeBatchOpt = nullptr, *routeBatchOutputOpt = nullptr,
+                     *routeBatchBenchmarkOpt = nullptr, *routeBatchQuitOpt = nullptr, *imageBatchOpt = nullptr,
+                     *imageBatchOutputOpt = nullptr, *imageBatchSizeOpt = nullptr, *imageBatchQuitOpt = nullptr,
+                     *benchmarkOpt = nullptr, *benchmarkBaselineOpt = nullptr, *benchmarkQuitOpt = nullptr,
+                     *sessionRecordOpt = nullptr, *sessionReplayOpt = nullptr, *sessionReplaySpeedOpt = nullptr,
+                     *sessionReplayReportOpt = nullptr, *sessionReplayQuitOpt = nullptr,
+                     *headlessOpt = nullptr, *serverOpt = nullptr;
 };
 
 #endif // LNM_COMMANDLINE_H
@@ -24,187 +24,196 @@
 #include "common/constants.h"
 #include "settings/settings.h"
 
+#include <QCryptographicHash>
 #include <QDataStream>
-#include <QSharedMemory>
-#include <QDateTime>
 #include <QDir>
+#include <QLocalServer>
+#include <QLocalSocket>
 
-static const int SHARED_MEMORY_SIZE = 4096;
 static QLatin1String PROGRAM_GUID("203abd54-8a6a-4308-a654-6771efec62cd");
 
+/* Milliseconds to wait for connection and confirmation from a running instance.
+ * Confirmation can take a while if the other instance is still starting up. */
+static const int CONNECT_TIMEOUT_MS = 1000;
+static const int CONFIRM_TIMEOUT_MS = 10000;
+
+/* Single byte sent back after reading a message */
+static const char CONFIRM_BYTE = 'A';
+
 DataExchange::DataExchange()
   : QObject(nullptr)
 {
-  // Shared memory layout:
-  // - quint32 Size of serialized property list
-  // - qint64 Timestamp milliseconds since Epoch
-  // - properties Serialized properties object
-
   exit = false;
 
-  // Detect other running application instance with same settings - this is unsafe on Unix since shm can remain after crashes
-  if(sharedMemory == nullptr)
-    sharedMemory = new QSharedMemory(PROGRAM_GUID + "-" +
-                                     QDir::cleanPath(QFileInfo(atools::settings::Settings::getPath()).canonicalFilePath()));
-
-  // Create and attach
-  if(sharedMemory->create(SHARED_MEMORY_SIZE, QSharedMemory::ReadWrite))
-  {
-#ifdef DEBUG_INFORMATION
-    qDebug() << Q_FUNC_INFO << "Created" << sharedMemory->key() << sharedMemory->nativeKey();
-#endif
+  // Use a hash of the settings path to get a valid and short socket name which detects instances using the same settings
+  QByteArray path = QDir::cleanPath(QFileInfo(atools::settings::Settings::getPath()).canonicalFilePath()).toUtf8();
+  QString name = PROGRAM_GUID + "-" + QString::fromLatin1(QCryptographicHash::hash(path, QCryptographicHash::Md5).toHex());
 
-    // Created =====================================================================
-    // Write null size and timestamp into the shared memory segment
-    // A crash is detected if timestamp is not updated for ten seconds
-    QByteArray bytes;
-    QDataStream out(&bytes, QIODevice::WriteOnly);
-    out << static_cast<quint32>(0) << QDateTime::currentMSecsSinceEpoch();
-
-    if(sharedMemory->lock())
-    {
-      memcpy(sharedMemory->data(), bytes.constData(), static_cast<size_t>(bytes.size()));
-      sharedMemory->unlock();
-    }
-  }
+  if(sendToRunningInstance(name))
+    exit = true;
   else
   {
-    // Attach to already present one if not attached =========================================
-    if(sharedMemory->attach(QSharedMemory::ReadWrite))
-    {
-#ifdef DEBUG_INFORMATION
-      qDebug() << Q_FUNC_INFO << "Attached" << sharedMemory->key() << sharedMemory->nativeKey();
-#endif
+    // No running instance or not confirmed - start listening =================================
+    server = new QLocalServer(this);
+    server->setSocketOptions(QLocalServer::UserAccessOption);
 
-      // Read timestamp to detect freeze or crash
-      if(sharedMemory->lock())
+    bool serverListening = server->listen(name);
+    if(!serverListening && server->serverError() == QAbstractSocket::AddressInUseError)
+    {
+      if(isServerAlive(name))
+      {
+        // Other instance is running but busy or frozen - do not start a second one using the same settings
+        qWarning() << Q_FUNC_INFO << "Other instance is running but not responding on" << name;
+        exit = true;
+      }
+      else
       {
-        qint64 datetime;
-        quint32 size;
-        // Create a view on the shared memory for reading - does not copy but needs a lock
-        QByteArray sizeBytes = QByteArray::fromRawData(static_cast<const char *>(sharedMemory->constData()), SHARED_MEMORY_SIZE);
-        QDataStream in(&sizeBytes, QIODevice::ReadOnly);
-        in >> size >> datetime;
-
-        // If timestamp is older than ten seconds other might be crashed or frozen, start normally - otherwise send message
-        if(QDateTime::fromMSecsSinceEpoch(datetime).secsTo(QDateTime::currentDateTimeUtc()) < 10)
-        {
-          // Copy command line parameters and add activate option to bring other to front
-          atools::util::Properties properties(NavApp::getStartupOptionsConst());
-          properties.setPropertyBool(lnm::STARTUP_COMMAND_ACTIVATE, true); // Raise other window
+        // Remove socket file left over by a crashed instance on Unix and try again
+        QLocalServer::removeServer(name);
+        serverListening = server->listen(name);
+      }
+    }
 
+    if(serverListening)
+    {
 #ifdef DEBUG_INFORMATION
-          qDebug() << Q_FUNC_INFO << "Sending" << properties;
+      qDebug() << Q_FUNC_INFO << "Listening" << server->fullServerName();
 #endif
-
-          // Get properties for size
-          QByteArray propBytes = properties.asByteArray();
-
-          // Write off for other process
-          QByteArray bytes;
-          QDataStream out(&bytes, QIODevice::WriteOnly);
-          out << static_cast<quint32>(propBytes.size()) << QDateTime::currentMSecsSinceEpoch();
-          out.writeRawData(propBytes.constData(), propBytes.size());
-
-          if(bytes.size() < sharedMemory->size())
-          {
-            memcpy(sharedMemory->data(), bytes.constData(), static_cast<size_t>(bytes.size()));
-            exit = true;
-          }
-        } // if(QDateTime::fromMSecsSinceEpoch(date ...
-
-        sharedMemory->unlock();
-      } // if(sharedMemory->lock())
+      connect(server, &QLocalServer::newConnection, this, &DataExchange::newConnection);
     }
+    else if(!exit)
+      qWarning() << Q_FUNC_INFO << "Cannot listen on" << name << server->errorString();
   }
 }
 
 DataExchange::~DataExchange()
 {
-  sharedMemoryCheckTimer.stop();
-
-  if(sharedMemory != nullptr)
+  if(server != nullptr)
   {
-    qDebug() << Q_FUNC_INFO << "delete sharedMemory";
-    sharedMemory->detach();
-    delete sharedMemory;
-    sharedMemory = nullptr;
+    qDebug() << Q_FUNC_INFO << "delete server";
+    server->close();
+    delete server;
+    server = nullptr;
   }
 }
 
-void DataExchange::startTimer()
+bool DataExchange::isServerAlive(const QString& name)
 {
-  // Check for commands from other instance =====================
-  sharedMemoryCheckTimer.setInterval(500);
-  connect(&sharedMemoryCheckTimer, &QTimer::timeout, this, &DataExchange::checkData);
-  sharedMemoryCheckTimer.start();
+  QLocalSocket socket;
+  socket.connectToServer(name, QIODevice::ReadWrite);
+  bool connected = socket.waitForConnected(CONNECT_TIMEOUT_MS);
+  socket.abort();
+  return connected;
 }
 
-void DataExchange::checkData()
+bool DataExchange::sendToRunningInstance(const QString& name)
 {
-  // Check for message from other instance
-  atools::util::Properties properties = fetchSharedMemory();
+  QLocalSocket socket;
+  socket.connectToServer(name, QIODevice::ReadWrite);
+  if(!socket.waitForConnected(CONNECT_TIMEOUT_MS))
+    // Nothing running or crashed
+    return false;
 
-  if(!properties.isEmpty())
-  {
-    // Found message
-    qDebug() << Q_FUNC_INFO << properties;
+  // Copy command line parameters and add activate option to bring other to front
+  atools::util::Properties properties(NavApp::getStartupOptionsConst());
+  properties.setPropertyBool(lnm::STARTUP_COMMAND_ACTIVATE, true); // Raise other window
 
-    // Extract filenames from known options ================================
-    QString flightplan, flightplanDescr, perf, layout;
-    fc::fromStartupProperties(properties, &flightplan, &flightplanDescr, &perf, &layout);
+#ifdef DEBUG_INFORMATION
+  qDebug() << Q_FUNC_INFO << "Sending" << properties;
+#endif
 
-    // Load files if found and exist ===========================================
-    if(atools::checkFile(Q_FUNC_INFO, flightplan, true /* warn */))
-      emit loadRoute(flightplan);
+  QDataStream out(&socket);
+  out << properties;
+  socket.flush();
 
-    if(!flightplanDescr.isEmpty())
-      emit loadRouteDescr(flightplanDescr);
+  // Wait for confirmation - other might be frozen if nothing comes back
+  bool confirmed = false;
+  while(!confirmed && socket.waitForReadyRead(CONFIRM_TIMEOUT_MS))
+  {
+    char confirm;
+    if(socket.getChar(&confirm))
+      confirmed = confirm == CONFIRM_BYTE;
+  }
 
-    if(atools::checkFile(Q_FUNC_INFO, layout, true /* warn */))
-      emit loadLayout(layout);
+  if(!confirmed)
+    qWarning() << Q_FUNC_INFO << "No confirmation from running instance";
 
-    if(atools::checkFile(Q_FUNC_INFO, perf, true /* warn */))
-      emit loadPerf(perf);
+  socket.disconnectFromServer();
+  return confirmed;
+}
 
-    // Activate window - always sent by other instance =====================================================
-    if(properties.getPropertyBool(lnm::STARTUP_COMMAND_ACTIVATE))
-      emit activateMain();
+void DataExchange::startListening()
+{
+  listening = true;
+
+  // Process all messages which came in during startup
+  const QVector<atools::util::Properties> queued(queuedProperties);
+  queuedProperties.clear();
+  for(const atools::util::Properties& properties : queued)
+    processData(properties);
+}
+
+void DataExchange::newConnection()
+{
+  while(server->hasPendingConnections())
+  {
+    QLocalSocket *socket = server->nextPendingConnection();
+    connect(socket, &QLocalSocket::disconnected, socket, &QLocalSocket::deleteLater);
+    connect(socket, &QLocalSocket::readyRead, this, [this, socket]() -> void {
+      readData(socket);
+    });
+
+    // Data might be available already
+    readData(socket);
   }
 }
 
-atools::util::Properties DataExchange::fetchSharedMemory()
+void DataExchange::readData(QLocalSocket *socket)
 {
+  // Wait until message is complete
   atools::util::Properties properties;
+  QDataStream in(socket);
+  in.startTransaction();
+  in >> properties;
+  if(!in.commitTransaction())
+    return;
+
+  // Confirm to let other instance exit
+  socket->putChar(CONFIRM_BYTE);
+  socket->flush();
 
-  if(sharedMemory != nullptr)
+  if(!properties.isEmpty())
   {
-    // Already attached
-    if(sharedMemory->lock())
-    {
-      // Read size only for now
-      quint32 size;
-      // Create a view on the shared memory for reading - does not copy
-      QByteArray sizeBytes = QByteArray::fromRawData(static_cast<const char *>(sharedMemory->constData()), SHARED_MEMORY_SIZE);
-      QDataStream in(&sizeBytes, QIODevice::ReadOnly);
-      in >> size;
-
-      if(size > 0)
-      {
-        // Read properties if size is given - ignore timestamp
-        qint64 datetimeDummy;
-        in >> datetimeDummy >> properties;
-      }
+    if(listening)
+      processData(properties);
+    else
+      queuedProperties.append(properties);
+  }
+}
 
-      // Write back a null size and a timestamp to allow the other process detect a crash
-      QByteArray bytesEmpty;
-      QDataStream out(&bytesEmpty, QIODevice::WriteOnly);
-      out << static_cast<quint32>(0) << QDateTime::currentMSecsSinceEpoch();
-      memcpy(sharedMemory->data(), bytesEmpty.constData(), static_cast<size_t>(bytesEmpty.size()));
+void DataExchange::processData(const atools::util::Properties& properties)
+{
+  // Found message
+  qDebug() << Q_FUNC_INFO << properties;
 
-      sharedMemory->unlock();
-    }
-  }
+  // Extract filenames from known options ================================
+  QString flightplan, flightplanDescr, perf, layout;
+  fc::fromStartupProperties(properties, &flightplan, &flightplanDescr, &perf, &layout);
+
+  // Load files if found and exist ===========================================
+  if(atools::checkFile(Q_FUNC_INFO, flightplan, true /* warn */))
+    emit loadRoute(flightplan);
+
+  if(!flightplanDescr.isEmpty())
+    emit loadRouteDescr(flightplanDescr);
+
+  if(atools::checkFile(Q_FUNC_INFO, layout, true /* warn */))
+    emit loadLayout(layout);
+
+  if(atools::checkFile(Q_FUNC_INFO, perf, true /* warn */))
+    emit loadPerf(perf);
 
-  return properties;
+  // Activate window - always sent by other instance =====================================================
+  if(properties.getPropertyBool(lnm::STARTUP_COMMAND_ACTIVATE))
+    emit activateMain();
 }
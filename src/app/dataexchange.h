@@ -19,7 +19,7 @@
 #define LNM_DATAEXCHANGE_H
 
 #include <QObject>
-#include <QTimer>
+#include <QVector>
 
 namespace atools {
 namespace util {
@@ -27,12 +27,15 @@ class Properties;
 }
 }
 
-class QSharedMemory;
+class QLocalServer;
+class QLocalSocket;
 
 /*
  * Implements a mechanism similar to the old Windows DDE to pass parameters to a running instance from another starting instance.
- * Uses shared memory to attach to a running instance which regularily checks the shared memory for messages.
- * A timestamp is saved to avoid dead or crashed instances blocking further startups.
+ * The first instance listens on a local socket (named pipe on Windows) which is unique for the settings directory.
+ * A starting instance connects to it, sends its command line options and waits for a confirmation before exiting.
+ * Crashed instances do not accept connections which lets the new instance remove the stale socket and start normally.
+ * The new instance exits if a busy or frozen instance accepts the connection but does not confirm.
  */
 class DataExchange :
   public QObject
@@ -40,12 +43,11 @@ class DataExchange :
   Q_OBJECT
 
 public:
-  /* Creates or attaches to a shared memory segment and sets exit flag.
-   * Sends a message to the other instance if attaching.
-   *  Sets a timestamp if creating. */
+  /* Connects to a running instance and sends a message and sets exit flag if successful.
+   * Starts listening for other instances otherwise. */
   explicit DataExchange();
 
-  /* Detaches and deletes shared memory */
+  /* Closes the server */
   virtual ~DataExchange() override;
 
   /* Found other instance and sent message. This instance can exit now. */
@@ -54,9 +56,9 @@ public:
     return exit;
   }
 
-  /* Start the timer which updates the timestamp in the shared memory segment. Sends messages below if another instance left messages.
-   * Currently twice a second. */
-  void startTimer();
+  /* Start sending the signals below for messages from other instances. Messages received before are queued.
+   * Call once the main window is ready. */
+  void startListening();
 
 signals:
   /* Sent if time found messages from other instance. */
@@ -69,18 +71,28 @@ signals:
   void activateMain();
 
 private:
-  /* Fetch messages from shared memory, read and check files and send messages above. */
-  atools::util::Properties fetchSharedMemory();
+  /* Connect to running instance, send properties and wait for confirmation. Returns true if confirmed. */
+  bool sendToRunningInstance(const QString& name);
 
-  /* Called by sharedMemoryCheckTimer and checks for messages from other instances */
-  void checkData();
+  /* true if a server accepts connections on the socket */
+  static bool isServerAlive(const QString& name);
+
+  /* Connection from other instance */
+  void newConnection();
+
+  /* Read properties from other instance when complete and confirm */
+  void readData(QLocalSocket *socket);
+
+  /* Read and check files and send messages above */
+  void processData(const atools::util::Properties& properties);
 
   /* Found other instance if true. This one can exit now. */
-  bool exit = false;
+  bool exit = false, listening = false;
+
+  QLocalServer *server = nullptr;
 
-  /* Check shared memory for updates by other instance every second. Calls checkSharedMemory() */
-  QTimer sharedMemoryCheckTimer;
-  QSharedMemory *sharedMemory = nullptr;
+  /* Messages received before startListening() was called */
+  QVector<atools::util::Properties> queuedProperties;
 };
 
 #endif // LNM_DATAEXCHANGE_H
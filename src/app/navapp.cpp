@@ -26,6 +26,7 @@
 #include "common/vehicleicons.h"
 #include "connect/connectclient.h"
 #include "db/databasemanager.h"
+#include "db/databasepool.h"
 #include "exception.h"
 #include "fs/perf/aircraftperf.h"
 #include "fs/common/magdecreader.h"
@@ -49,6 +50,7 @@
 #include "query/airportquery.h"
 #include "query/infoquery.h"
 #include "query/mapquery.h"
+#include "query/neareststore.h"
 #include "query/procedurequery.h"
 #include "query/waypointtrackquery.h"
 #include "route/routecontroller.h"
@@ -68,14 +70,17 @@
 
 #include <QIcon>
 #include <QSplashScreen>
+#include <QTimer>
 
 AirportQuery *NavApp::airportQuerySim = nullptr;
 AirportQuery *NavApp::airportQueryNav = nullptr;
 InfoQuery *NavApp::infoQuery = nullptr;
 ProcedureQuery *NavApp::procedureQuery = nullptr;
+NearestStore *NavApp::nearestStore = nullptr;
 
 ConnectClient *NavApp::connectClient = nullptr;
 DatabaseManager *NavApp::databaseManager = nullptr;
+DatabasePool *NavApp::databasePool = nullptr;
 MainWindow *NavApp::mainWindow = nullptr;
 ElevationProvider *NavApp::elevationProvider = nullptr;
 atools::fs::db::DatabaseMeta *NavApp::databaseMetaSim = nullptr;
@@ -106,12 +111,18 @@ bool NavApp::closeCalled = false;
 bool NavApp::shuttingDown = false;
 bool NavApp::loadingDatabase = false;
 bool NavApp::mainWindowVisible = false;
+bool NavApp::startupDone = false;
+QElapsedTimer NavApp::startupTimer;
+
+/* Delay after first map frame before loading deferred subsystems */
+const static int DEFERRED_INIT_DELAY_MS = 1000;
 
 using atools::settings::Settings;
 
 NavApp::NavApp(int& argc, char **argv, int flags)
   : atools::gui::Application(argc, argv, flags)
 {
+  startupTimer.start();
   startupOptions = new atools::util::Properties;
   initApplication();
 }
@@ -144,10 +155,12 @@ void NavApp::init(MainWindow *mainWindowParam)
 
   elevationProvider = new ElevationProvider(mainWindow);
 
+  databasePool = new DatabasePool();
   databaseManager = new DatabaseManager(mainWindow);
   databaseManager->openAllDatabases(); // Only readonly databases
-  databaseManager->loadLanguageIndex(); // MSFS translations from table "translation"
-  databaseManager->loadAircraftIndex(); // MSFS aircraft.cfg properties
+  databaseManager->loadLanguageIndex(); // MSFS translations from table "translation" - deferred
+  databaseManager->loadAircraftIndex(); // MSFS aircraft.cfg properties - deferred
+  logStartupTime("Databases opened");
 
   userdataController = new UserdataController(databaseManager->getUserdataManager(), mainWindow);
   logdataController = new LogdataController(databaseManager->getLogdataManager(), mainWindow);
@@ -197,6 +210,8 @@ void NavApp::init(MainWindow *mainWindowParam)
 
   procedureQuery = new ProcedureQuery(databaseManager->getDatabaseNav());
 
+  nearestStore = new NearestStore(mainWindow);
+
   connectClient = new ConnectClient(mainWindow);
 
   updateHandler = new UpdateHandler(mainWindow);
@@ -204,6 +219,7 @@ void NavApp::init(MainWindow *mainWindowParam)
   styleHandler = new StyleHandler(mainWindow);
 
   webController = new WebController(mainWindow);
+  logStartupTime("Controllers created");
 }
 
 void NavApp::initQueries()
@@ -214,6 +230,7 @@ void NavApp::initQueries()
   airportQueryNav->initQueries();
   infoQuery->initQueries();
   procedureQuery->initQueries();
+  nearestStore->postDatabaseLoad();
 }
 
 void NavApp::showElevationProviderErrors()
@@ -251,7 +268,9 @@ void NavApp::deInit()
   ATOOLS_DELETE_LOG(airportQueryNav);
   ATOOLS_DELETE_LOG(infoQuery);
   ATOOLS_DELETE_LOG(procedureQuery);
+  ATOOLS_DELETE_LOG(nearestStore);
   ATOOLS_DELETE_LOG(databaseManager);
+  ATOOLS_DELETE_LOG(databasePool);
   ATOOLS_DELETE_LOG(databaseMetaSim);
   ATOOLS_DELETE_LOG(databaseMetaNav);
   ATOOLS_DELETE_LOG(magDecReader);
@@ -360,6 +379,8 @@ void NavApp::preDatabaseLoad()
   airportQuerySim->deInitQueries();
   airportQueryNav->deInitQueries();
   procedureQuery->deInitQueries();
+  nearestStore->preDatabaseLoad();
+  databasePool->invalidate();
   moraReader->preDatabaseLoad();
   airspaceController->preDatabaseLoad();
   trackController->preDatabaseLoad();
@@ -385,6 +406,7 @@ void NavApp::postDatabaseLoad()
   airportQueryNav->initQueries();
   infoQuery->initQueries();
   procedureQuery->initQueries();
+  nearestStore->postDatabaseLoad();
   moraReader->readFromTable(getDatabaseNav(), getDatabaseSim());
   airspaceController->postDatabaseLoad();
   logdataController->postDatabaseLoad();
@@ -402,6 +424,29 @@ bool NavApp::isMainWindowVisible()
   return mainWindowVisible;
 }
 
+void NavApp::logStartupTime(const QString& step)
+{
+  if(!startupDone)
+    qInfo() << "Startup" << step << "after" << startupTimer.elapsed() << "ms";
+}
+
+void NavApp::startupFinished()
+{
+  if(!startupDone)
+  {
+    logStartupTime("First map frame");
+    startupDone = true;
+
+    // Load subsystems which are not needed for the first map display
+    QTimer::singleShot(DEFERRED_INIT_DELAY_MS, databaseManager, &DatabaseManager::loadDeferredIndexes);
+  }
+}
+
+bool NavApp::isStartupFinished()
+{
+  return startupDone;
+}
+
 bool NavApp::isFetchAiAircraft()
 {
   return connectClient->isFetchAiAircraft();
@@ -500,7 +545,7 @@ const atools::geo::Pos& NavApp::getUserAircraftPos()
 void NavApp::updateAllMaps()
 {
   if(mainWindow->getMapWidget() != nullptr)
-    mainWindow->getMapWidget()->update();
+    mainWindow->getMapWidget()->updateFull();
 
   if(mainWindow->getProfileWidget() != nullptr)
     mainWindow->getProfileWidget()->update();
@@ -551,6 +596,11 @@ ProcedureQuery *NavApp::getProcedureQuery()
   return procedureQuery;
 }
 
+NearestStore *NavApp::getNearestStore()
+{
+  return nearestStore;
+}
+
 const Route& NavApp::getRouteConst()
 {
   return mainWindow->getRouteController()->getRouteConst();
@@ -1196,6 +1246,11 @@ WebController *NavApp::getWebController()
   return webController;
 }
 
+WebMapController *NavApp::getWebMapController()
+{
+  return webController != nullptr ? webController->getWebMapController() : nullptr;
+}
+
 MapPaintWidget *NavApp::getMapPaintWidgetWeb()
 {
   if(webController != nullptr && webController->getWebMapController() != nullptr)
@@ -1209,6 +1264,11 @@ DatabaseManager *NavApp::getDatabaseManager()
   return databaseManager;
 }
 
+DatabasePool *NavApp::getDatabasePool()
+{
+  return databasePool;
+}
+
 const atools::fs::scenery::LanguageJson& NavApp::getLanguageIndex()
 {
   return databaseManager->getLanguageIndex();
@@ -23,6 +23,8 @@
 #include "common/mapflags.h"
 #include "fs/fspaths.h"
 
+#include <QElapsedTimer>
+
 class AircraftPerfController;
 class AircraftTrail;
 class AirportQuery;
@@ -32,6 +34,7 @@ class TrackController;
 class AirspaceController;
 class ConnectClient;
 class DatabaseManager;
+class DatabasePool;
 class ElevationProvider;
 class InfoController;
 class InfoQuery;
@@ -44,6 +47,7 @@ class MapWidget;
 class OnlinedataController;
 class OptionsDialog;
 class ProcedureQuery;
+class NearestStore;
 class QMainWindow;
 class QSplashScreen;
 class Route;
@@ -58,6 +62,7 @@ class UserdataSearch;
 class VehicleIcons;
 class WeatherReporter;
 class WebController;
+class WebMapController;
 class WindReporter;
 class MapMarkHandler;
 struct MapAirportHandler;
@@ -173,6 +178,14 @@ public:
   static bool isMainWindowVisible();
   static void setMainWindowVisible();
 
+  /* Log time elapsed since program start for a startup step. Ignored once startup is finished. */
+  static void logStartupTime(const QString& step);
+
+  /* Called on the first frame of the visible map. Logs time to first map and starts loading of the
+   * deferred subsystems in idle time. */
+  static void startupFinished();
+  static bool isStartupFinished();
+
   static void setStayOnTop(QWidget *widget);
 
   static bool isFetchAiAircraft();
@@ -224,6 +237,9 @@ public:
 
   static InfoQuery *getInfoQuery();
   static ProcedureQuery *getProcedureQuery();
+
+  /* Precomputed nearest airports and navaids for the airport information */
+  static NearestStore *getNearestStore();
   static const Route& getRouteConst();
   static Route& getRoute();
   static void updateRouteCycleMetadata();
@@ -331,6 +347,9 @@ public:
 
   static DatabaseManager *getDatabaseManager();
 
+  /* Per thread read only connections and prepared statements for background jobs. Thread safe. */
+  static DatabasePool *getDatabasePool();
+
   /* MSFS translations from table "translation" */
   static const atools::fs::scenery::LanguageJson& getLanguageIndex();
 
@@ -421,8 +440,13 @@ public:
   static const QString& getCurrentAircraftPerfAircraftType();
 
   static WebController *getWebController();
+
+  /* First map paint widget of the web server pool. Null if not started. */
   static MapPaintWidget *getMapPaintWidgetWeb();
 
+  /* Null if web server is not started */
+  static WebMapController *getWebMapController();
+
   static MapMarkHandler *getMapMarkHandler();
   static MapAirportHandler *getMapAirportHandler();
   static MapDetailHandler *getMapDetailHandler();
@@ -466,11 +490,13 @@ private:
   static AirportQuery *airportQuerySim, *airportQueryNav;
   static InfoQuery *infoQuery;
   static ProcedureQuery *procedureQuery;
+  static NearestStore *nearestStore;
   static ElevationProvider *elevationProvider;
 
   /* Most important handlers */
   static ConnectClient *connectClient;
   static DatabaseManager *databaseManager;
+  static DatabasePool *databasePool;
   static atools::fs::common::MagDecReader *magDecReader;
 
   /* minimum off route altitude from nav database */
@@ -505,6 +531,8 @@ private:
   static bool shuttingDown;
   static bool closeCalled;
   static bool mainWindowVisible;
+  static bool startupDone;
+  static QElapsedTimer startupTimer;
 };
 
 #endif // NAVAPPLICATION_H
@@ -59,6 +59,36 @@ QByteArray AbstractInfoBuilder::uiinfo(UiInfoData uiInfoData) const
     return "not implemented";
 }
 
+QByteArray AbstractInfoBuilder::paintstatistics(PaintStatisticsData paintStatisticsData) const
+{
+  Q_UNUSED(paintStatisticsData);
+    return "not implemented";
+}
+
+QByteArray AbstractInfoBuilder::webmetrics(WebMetricsData webMetricsData) const
+{
+  Q_UNUSED(webMetricsData);
+    return "not implemented";
+}
+
+QByteArray AbstractInfoBuilder::memoryusage(MemoryUsageData memoryUsageData) const
+{
+  Q_UNUSED(memoryUsageData);
+    return "not implemented";
+}
+
+QByteArray AbstractInfoBuilder::routebatch(RouteBatchData routeBatchData) const
+{
+  Q_UNUSED(routeBatchData);
+    return "not implemented";
+}
+
+QByteArray AbstractInfoBuilder::routeairspaces(RouteAirspacesData routeAirspacesData) const
+{
+  Q_UNUSED(routeAirspacesData);
+    return "not implemented";
+}
+
 QByteArray AbstractInfoBuilder::features(MapFeaturesData mapFeaturesData) const
 {
   Q_UNUSED(mapFeaturesData);
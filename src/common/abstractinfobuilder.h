@@ -25,7 +25,10 @@ namespace InfoBuilderTypes {
     struct AirportInfoData;
     struct SimConnectInfoData;
     struct UiInfoData;
+    struct PaintStatisticsData;
+    struct WebMetricsData;
     struct MapFeaturesData;
+    struct RouteBatchData;
 }
 namespace atools {
     namespace sql {
@@ -40,7 +43,10 @@ using atools::geo::Pos;
 using InfoBuilderTypes::AirportInfoData;
 using InfoBuilderTypes::SimConnectInfoData;
 using InfoBuilderTypes::UiInfoData;
+using InfoBuilderTypes::PaintStatisticsData;
+using InfoBuilderTypes::WebMetricsData;
 using InfoBuilderTypes::MapFeaturesData;
+using InfoBuilderTypes::RouteBatchData;
 
 /**
  * Generic interface for LNM-specific views.
@@ -98,6 +104,41 @@ public:
    * @param uiInfoData
    */
   virtual QByteArray uiinfo(UiInfoData uiInfoData) const;
+
+  /**
+   * Creates a description for the provided map painter statistics.
+   *
+   * @param paintStatisticsData
+   */
+  virtual QByteArray paintstatistics(PaintStatisticsData paintStatisticsData) const;
+
+  /**
+   * Creates a description for the provided web server metrics.
+   *
+   * @param webMetricsData
+   */
+  virtual QByteArray webmetrics(WebMetricsData webMetricsData) const;
+
+  /**
+   * Creates a description for the provided cache memory usage.
+   *
+   * @param memoryUsageData
+   */
+  virtual QByteArray memoryusage(MemoryUsageData memoryUsageData) const;
+
+  /**
+   * Creates a description for the provided route description batch results.
+   *
+   * @param routeBatchData
+   */
+  virtual QByteArray routebatch(RouteBatchData routeBatchData) const;
+
+  /**
+   * Creates a description for the provided airspaces along the flight plan.
+   *
+   * @param routeAirspacesData
+   */
+  virtual QByteArray routeairspaces(RouteAirspacesData routeAirspacesData) const;
 protected:
   /**
    * @brief Get heading and opposed heading corrected by magnetic variation
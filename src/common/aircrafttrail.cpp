@@ -25,6 +25,7 @@
 #include "geo/calculations.h"
 #include "geo/linestring.h"
 #include "io/fileroller.h"
+#include "mapgui/maplayer.h"
 #include "settings/settings.h"
 
 #include <QDataStream>
@@ -43,6 +44,15 @@ static const float MAX_POINT_DISTANCE_NM = 5.f;
 /* Number of entries to remove at once */
 static const int PRUNE_TRACK_ENTRIES = 200;
 
+/* Number of trail positions in one chunk for viewport culling */
+static const int TRAIL_CHUNK_SIZE = 256;
+
+/* Maximum deviation in degree for simplified trail levels. 0 is full resolution. */
+static const float LOD_TOLERANCE_DEG[] = {0.f, 0.002f, 0.01f, 0.05f};
+
+/* Maximum number of positions replaced by one simplified segment. Limits effort when appending. */
+static const int LOD_MAX_SPAN = 128;
+
 static const quint32 FILE_MAGIC_NUMBER = 0x5B6C1A2B;
 
 /* Version 2 to adds timstamp and single floating point precision. Uses 32-bit second timestamps */
@@ -54,6 +64,13 @@ static const quint16 FILE_VERSION_64BIT_TS = 3;
 /* Version 4 adds double floating point precision for coordinates */
 static const quint16 FILE_VERSION_64BIT_COORDS = 4;
 
+/* Journal file header and record types. Positions use the version 4 format. */
+static const quint32 JOURNAL_MAGIC_NUMBER = 0x5B6C1A2C;
+static const quint16 JOURNAL_VERSION = 1;
+static const quint8 JOURNAL_RECORD_POS = 1;
+static const quint8 JOURNAL_RECORD_CLEAR = 2;
+static const QLatin1String JOURNAL_SUFFIX(".journal");
+
 QDataStream& operator>>(QDataStream& dataStream, AircraftTrailPos& trackPos)
 {
   if(AircraftTrail::version == FILE_VERSION_64BIT_COORDS)
@@ -136,6 +153,7 @@ AircraftTrail::AircraftTrail()
 AircraftTrail::~AircraftTrail()
 {
   delete lastUserAircraft;
+  delete journalFile;
 }
 
 AircraftTrail::AircraftTrail(const AircraftTrail& other)
@@ -149,6 +167,12 @@ AircraftTrail& AircraftTrail::operator=(const AircraftTrail& other)
 {
   clear();
   append(other);
+  chunks = other.chunks;
+  for(int i = 0; i < NUM_LOD_LEVELS - 1; i++)
+    lodIndexes[i] = other.lodIndexes[i];
+  lodNumPositions = other.lodNumPositions;
+  timeIndex = other.timeIndex;
+  numPruned = other.numPruned;
   maxTrackEntries = other.maxTrackEntries;
   *lastUserAircraft = *other.lastUserAircraft;
   return *this;
@@ -258,28 +282,30 @@ atools::fs::gpx::GpxData AircraftTrail::toGpxData(const atools::fs::pln::Flightp
   atools::fs::gpx::GpxData gpxData;
   gpxData.flightplan = flightplan;
 
-  const QVector<QVector<atools::geo::PosD> >& positionList = getPositionsD();
-  const QVector<QVector<qint64> >& timestampsList = getTimestampsMs();
-
-  Q_ASSERT(positionList.size() == timestampsList.size());
-
-  for(int i = 0; i < positionList.size(); i++)
+  // Convert directly without intermediate position and timestamp lists to keep memory low for long trails
+  atools::fs::gpx::TrailPoints points;
+  for(const AircraftTrailPos& trackPos : *this)
   {
-    const QVector<atools::geo::PosD>& positions = positionList.at(i);
-    const QVector<qint64>& timestamps = timestampsList.at(i);
-
-    Q_ASSERT(positions.size() == timestamps.size());
-
-    atools::fs::gpx::TrailPoints points;
-    for(int j = 0; j < positions.size(); j++)
+    if(!trackPos.isValid())
     {
-      const atools::geo::PosD& pos = positions.at(j);
-      points.append(atools::fs::gpx::TrailPoint(pos, timestamps.at(j)));
-      gpxData.updateBoundaries(pos.asPos());
+      // An invalid position shows a break in the lines - add segment and start a new one
+      if(!points.isEmpty())
+      {
+        gpxData.trails.append(points);
+        points.clear();
+      }
+    }
+    else
+    {
+      points.append(atools::fs::gpx::TrailPoint(trackPos.getPosD(), trackPos.getTimestampMs()));
+      gpxData.updateBoundaries(trackPos.getPosition());
     }
-    gpxData.trails.append(points);
   }
 
+  // Add rest
+  if(!points.isEmpty())
+    gpxData.trails.append(points);
+
   for(const atools::fs::pln::FlightplanEntry& entry : flightplan)
     gpxData.flightplanRect.extend(entry.getPosition());
 
@@ -289,11 +315,20 @@ atools::fs::gpx::GpxData AircraftTrail::toGpxData(const atools::fs::pln::Flightp
 void AircraftTrail::fillTrailFromGpxData(const atools::fs::gpx::GpxData& gpxData)
 {
   clear();
+  writeJournal(JOURNAL_RECORD_CLEAR);
   appendTrailFromGpxData(gpxData);
 }
 
 void AircraftTrail::appendTrailFromGpxData(const atools::fs::gpx::GpxData& gpxData)
 {
+  int fromIndex = size();
+
+  // Reserve space for all points and separators
+  int numPoints = size() + 1;
+  for(const atools::fs::gpx::TrailPoints& points : qAsConst(gpxData.trails))
+    numPoints += points.size() + 1;
+  reserve(numPoints);
+
   // Add separator
   if(!isEmpty())
     append(AircraftTrailPos());
@@ -308,9 +343,18 @@ void AircraftTrail::appendTrailFromGpxData(const atools::fs::gpx::GpxData& gpxDa
       append(AircraftTrailPos());
     }
   }
+
+  // Write all new positions to the journal at once instead of flushing for each one
+  writeJournalPositions(fromIndex);
   calculateBoundaries();
 }
 
+void AircraftTrail::appendPos(const AircraftTrailPos& trackPos)
+{
+  append(trackPos);
+  writeJournal(JOURNAL_RECORD_POS, trackPos);
+}
+
 void AircraftTrail::saveState(const QString& suffix, int numBackupFiles)
 {
   QFile trackFile(atools::settings::Settings::getConfigFilename(suffix));
@@ -323,11 +367,125 @@ void AircraftTrail::saveState(const QString& suffix, int numBackupFiles)
     QDataStream out(&trackFile);
     saveToStream(out);
     trackFile.close();
+
+    if(journalFile != nullptr && suffix == journalSuffix && trackFile.error() == QFileDevice::NoError)
+    {
+      // Compact journal since all positions are in the track file now
+      journalFile->resize(0);
+      QDataStream journal(journalFile);
+      journal.setVersion(QDataStream::Qt_5_5);
+      journal << JOURNAL_MAGIC_NUMBER << JOURNAL_VERSION;
+      journalFile->flush();
+    }
   }
   else
     qWarning() << "Cannot write track" << trackFile.fileName() << ":" << trackFile.errorString();
 }
 
+void AircraftTrail::startJournal(const QString& suffix)
+{
+  delete journalFile;
+  journalSuffix = suffix;
+  journalFile = new QFile(atools::settings::Settings::getConfigFilename(suffix + JOURNAL_SUFFIX));
+
+  if(journalFile->open(QIODevice::ReadWrite | QIODevice::Append))
+  {
+    if(journalFile->size() == 0)
+    {
+      QDataStream out(journalFile);
+      out.setVersion(QDataStream::Qt_5_5);
+      out << JOURNAL_MAGIC_NUMBER << JOURNAL_VERSION;
+    }
+
+    // Track file was not loaded or is empty - let the replay start from an empty trail
+    if(isEmpty())
+      writeJournal(JOURNAL_RECORD_CLEAR);
+    journalFile->flush();
+  }
+  else
+  {
+    qWarning() << "Cannot open track journal" << journalFile->fileName() << ":" << journalFile->errorString();
+    delete journalFile;
+    journalFile = nullptr;
+    journalSuffix.clear();
+  }
+}
+
+void AircraftTrail::writeJournal(quint8 type, const AircraftTrailPos& trackPos)
+{
+  if(journalFile != nullptr)
+  {
+    QDataStream out(journalFile);
+    out.setVersion(QDataStream::Qt_5_5);
+    out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    out << type;
+    if(type == JOURNAL_RECORD_POS)
+      out << trackPos;
+
+    // Pass to operating system to survive an application crash
+    journalFile->flush();
+  }
+}
+
+void AircraftTrail::writeJournalPositions(int fromIndex)
+{
+  if(journalFile != nullptr)
+  {
+    QDataStream out(journalFile);
+    out.setVersion(QDataStream::Qt_5_5);
+    out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    for(int i = fromIndex; i < size(); i++)
+      out << JOURNAL_RECORD_POS << at(i);
+
+    journalFile->flush();
+  }
+}
+
+void AircraftTrail::replayJournal(const QString& filename)
+{
+  QFile file(filename);
+  if(file.exists() && file.open(QIODevice::ReadOnly))
+  {
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_5);
+    in.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    quint32 magic;
+    quint16 journalVersion;
+    in >> magic >> journalVersion;
+
+    if(magic == JOURNAL_MAGIC_NUMBER && journalVersion == JOURNAL_VERSION)
+    {
+      AircraftTrail::version = FILE_VERSION_64BIT_COORDS;
+      int numRecords = 0;
+      while(!in.atEnd())
+      {
+        quint8 type;
+        AircraftTrailPos trackPos;
+        in >> type;
+        if(type == JOURNAL_RECORD_POS)
+          in >> trackPos;
+
+        // Ignore incomplete last record from a crash
+        if(in.status() != QDataStream::Ok)
+          break;
+
+        if(type == JOURNAL_RECORD_CLEAR)
+          clear();
+        else if(type == JOURNAL_RECORD_POS)
+          append(trackPos);
+        numRecords++;
+      }
+      qDebug() << Q_FUNC_INFO << "Replayed" << numRecords << "records from" << filename;
+    }
+    else if(file.size() > 0)
+      qWarning() << "Cannot read track journal. Invalid magic number or version:" << magic << journalVersion;
+    file.close();
+  }
+}
+
 void AircraftTrail::restoreState(const QString& suffix)
 {
   clear();
@@ -344,6 +502,9 @@ void AircraftTrail::restoreState(const QString& suffix)
     else
       qWarning() << "Cannot read track" << trackFile.fileName() << ":" << trackFile.errorString();
   }
+
+  // Add positions recorded after the last save
+  replayJournal(trackFile.fileName() + JOURNAL_SUFFIX);
   calculateBoundaries();
 }
 
@@ -364,6 +525,7 @@ bool AircraftTrail::readFromStream(QDataStream& in)
 {
   bool retval = false;
   clear();
+  clearBoundaries();
 
   quint32 magic;
   in.setVersion(QDataStream::Qt_5_5);
@@ -421,7 +583,7 @@ bool AircraftTrail::appendTrailPos(const atools::fs::sc::SimConnectUserAircraft&
   if(isEmpty() && userAircraft.isValid())
   {
     // First point
-    append(AircraftTrailPos(posD, timestampMs, onGround));
+    appendPos(AircraftTrailPos(posD, timestampMs, onGround));
     *lastUserAircraft = userAircraft;
   }
   else
@@ -488,13 +650,14 @@ bool AircraftTrail::appendTrailPos(const atools::fs::sc::SimConnectUserAircraft&
 #endif
 
         // Add an invalid position before indicating a break
-        append(AircraftTrailPos(timestampMs, onGround));
-        append(AircraftTrailPos(posD, timestampMs, onGround));
+        appendPos(AircraftTrailPos(timestampMs, onGround));
+        appendPos(AircraftTrailPos(posD, timestampMs, onGround));
       }
       else
       {
         if(size() > maxTrackEntries)
         {
+          int oldSize = size();
           for(int i = 0; i < PRUNE_TRACK_ENTRIES; i++)
             removeFirst();
 
@@ -502,9 +665,10 @@ bool AircraftTrail::appendTrailPos(const atools::fs::sc::SimConnectUserAircraft&
           while(!isEmpty() && !constFirst().isValid())
             removeFirst();
 
+          pruneIndexes(oldSize - size());
           pruned = true;
         }
-        append(AircraftTrailPos(posD, timestampMs, onGround));
+        appendPos(AircraftTrailPos(posD, timestampMs, onGround));
       }
       *lastUserAircraft = userAircraft;
     } // if(maxDistanceExceeded || maxTimeExceeded || speedChanged || altChanged || headingChanged)
@@ -514,6 +678,10 @@ bool AircraftTrail::appendTrailPos(const atools::fs::sc::SimConnectUserAircraft&
     // Last one is always valid
     calculateBoundary(constLast());
 
+  updateChunks();
+  updateLod();
+  updateTimeIndex();
+
   return pruned;
 }
 
@@ -521,6 +689,7 @@ void AircraftTrail::clearTrail()
 {
   clear();
   clearBoundaries();
+  writeJournal(JOURNAL_RECORD_CLEAR);
 }
 
 void AircraftTrail::clearBoundaries()
@@ -528,6 +697,12 @@ void AircraftTrail::clearBoundaries()
   bounding = atools::geo::Rect();
   minAltitude = std::numeric_limits<float>::max();
   maxAltitude = std::numeric_limits<float>::min();
+  chunks.clear();
+  for(QVector<int>& indexes : lodIndexes)
+    indexes.clear();
+  lodNumPositions = 0;
+  timeIndex.clear();
+  numPruned = 0;
 }
 
 void AircraftTrail::calculateBoundaries()
@@ -535,6 +710,197 @@ void AircraftTrail::calculateBoundaries()
   clearBoundaries();
   for(const AircraftTrailPos& trackPos : qAsConst(*this))
     calculateBoundary(trackPos);
+  updateChunks();
+  updateLod();
+  updateTimeIndex();
+}
+
+void AircraftTrail::pruneIndexes(int numRemoved)
+{
+  if(isEmpty())
+  {
+    clearBoundaries();
+    return;
+  }
+
+  for(int i = 0; i < numRemoved && !timeIndex.isEmpty(); i++)
+    timeIndex.removeFirst();
+  numPruned += numRemoved;
+
+  // Drop chunks covering only removed positions - the first remaining one might be partially pruned
+  int numChunks = 0;
+  while(numChunks < chunks.size() && chunks.at(numChunks).start + chunks.at(numChunks).size <= numPruned)
+    numChunks++;
+  chunks.remove(0, numChunks);
+
+  // Remove pruned positions from simplified trails
+  for(QVector<int>& indexes : lodIndexes)
+  {
+    indexes.erase(indexes.begin(), std::lower_bound(indexes.begin(), indexes.end(), numPruned));
+
+    // Keep new first position as start of the line
+    if(indexes.isEmpty() || indexes.constFirst() > numPruned)
+      indexes.prepend(numPruned);
+  }
+}
+
+void AircraftTrail::updateTimeIndex()
+{
+  for(int index = timeIndex.size(); index < size(); index++)
+  {
+    const AircraftTrailPos& trackPos = at(index);
+    TimeIndexEntry entry = timeIndex.isEmpty() ? TimeIndexEntry{0L, 0.} : timeIndex.constLast();
+
+    if(trackPos.isValid())
+    {
+      entry.timestampMs = std::max(entry.timestampMs, trackPos.getTimestampMs());
+
+      // Separators break the distance
+      if(index > 0 && at(index - 1).isValid())
+        entry.distanceNm += atools::geo::meterToNm(trackPos.getPosD().distanceMeterTo(at(index - 1).getPosD()));
+    }
+    timeIndex.append(entry);
+  }
+}
+
+int AircraftTrail::getIndexForTime(qint64 timestampMs) const
+{
+  auto it = std::lower_bound(timeIndex.constBegin(), timeIndex.constEnd(), timestampMs,
+                             [](const TimeIndexEntry& entry, qint64 ts) -> bool {
+    return entry.timestampMs < ts;
+  });
+  return static_cast<int>(std::distance(timeIndex.constBegin(), it));
+}
+
+int AircraftTrail::getIndexForDistanceToEnd(float distanceNm) const
+{
+  if(timeIndex.isEmpty())
+    return 0;
+
+  double minDistanceNm = timeIndex.constLast().distanceNm - distanceNm;
+  auto it = std::lower_bound(timeIndex.constBegin(), timeIndex.constEnd(), minDistanceNm,
+                             [](const TimeIndexEntry& entry, double dist) -> bool {
+    return entry.distanceNm < dist;
+  });
+  return static_cast<int>(std::distance(timeIndex.constBegin(), it));
+}
+
+qint64 AircraftTrail::getMaxTimestampMs() const
+{
+  return timeIndex.isEmpty() ? 0L : timeIndex.constLast().timestampMs;
+}
+
+void AircraftTrail::updateLod()
+{
+  for(; lodNumPositions < numPruned + size(); lodNumPositions++)
+  {
+    for(int level = 1; level < NUM_LOD_LEVELS; level++)
+      appendLod(level, lodNumPositions);
+  }
+}
+
+void AircraftTrail::appendLod(int level, int index)
+{
+  QVector<int>& indexes = lodIndexes[level - 1];
+  const AircraftTrailPos& trackPos = atSerial(index);
+
+  // Keep separators and the first position after a separator
+  if(!trackPos.isValid() || indexes.size() < 2 || !atSerial(indexes.constLast()).isValid() ||
+     !atSerial(indexes.at(indexes.size() - 2)).isValid())
+  {
+    indexes.append(index);
+    return;
+  }
+
+  // Check if the last kept position can be replaced by the new one.
+  // All positions between anchor and new position have to be within tolerance of the new segment.
+  int anchor = indexes.at(indexes.size() - 2);
+  bool replace = index - anchor <= LOD_MAX_SPAN;
+  if(replace)
+  {
+    const Pos first = atSerial(anchor).getPosition(), last = trackPos.getPosition();
+
+    // Use simple planar approximation with longitude scaled down by latitude
+    float lonScale = std::cos(atools::geo::toRadians((first.getLatY() + last.getLatY()) / 2.f));
+    float x1 = first.getLonX() * lonScale, y1 = first.getLatY();
+    float dx = last.getLonX() * lonScale - x1, dy = last.getLatY() - y1;
+    float length = std::sqrt(dx * dx + dy * dy);
+    float tolerance = LOD_TOLERANCE_DEG[level];
+
+    for(int i = anchor + 1; i < index && replace; i++)
+    {
+      const Pos pos = atSerial(i).getPosition();
+      float px = pos.getLonX() * lonScale - x1, py = pos.getLatY() - y1;
+      float dist = length > 0.f ? std::abs(px * dy - py * dx) / length : std::sqrt(px * px + py * py);
+      replace = dist <= tolerance;
+    }
+  }
+
+  if(replace)
+    indexes.last() = index;
+  else
+    indexes.append(index);
+}
+
+bool AircraftTrail::chunksOverlap(int from, int to, const atools::geo::Rect& rect) const
+{
+  if(chunks.isEmpty())
+    return false;
+
+  // Chunks have fixed size and start at multiples of the size
+  int first = chunks.constFirst().start / TRAIL_CHUNK_SIZE;
+  for(int i = std::max(from / TRAIL_CHUNK_SIZE - first, 0); i <= to / TRAIL_CHUNK_SIZE - first && i < chunks.size(); i++)
+  {
+    const atools::geo::Rect& chunkRect = chunks.at(i).bounding;
+    if(chunkRect.isValid() && chunkRect.overlaps(rect))
+      return true;
+  }
+  return false;
+}
+
+int AircraftTrail::lodLevel(const MapLayer *mapLayer)
+{
+  if(mapLayer == nullptr)
+    return 0;
+
+  // Allow half a pixel deviation assuming a screen width of about 1000 pixels for the layer range
+  float maxDeviationDeg = mapLayer->getMaxRange() / 2000.f / 111.f;
+
+  int level = 0;
+  for(int i = 1; i < NUM_LOD_LEVELS; i++)
+  {
+    if(LOD_TOLERANCE_DEG[i] <= maxDeviationDeg)
+      level = i;
+  }
+  return level;
+}
+
+void AircraftTrail::updateChunks()
+{
+  if(isEmpty())
+  {
+    chunks.clear();
+    return;
+  }
+
+  // Start behind last fully covered position
+  int index = chunks.isEmpty() ? numPruned : chunks.constLast().start + chunks.constLast().size;
+  for(; index < numPruned + size(); index++)
+  {
+    const AircraftTrailPos& trackPos = atSerial(index);
+
+    // Extend previous chunk by the connecting position
+    if(!chunks.isEmpty() && trackPos.isValid())
+      chunks.last().bounding.extend(trackPos.getPosition());
+
+    if(chunks.isEmpty() || chunks.constLast().size >= TRAIL_CHUNK_SIZE)
+      chunks.append({index, 0, atools::geo::Rect()});
+
+    TrailChunk& chunk = chunks.last();
+    chunk.size++;
+    if(trackPos.isValid())
+      chunk.bounding.extend(trackPos.getPosition());
+  }
 }
 
 void AircraftTrail::calculateBoundary(const AircraftTrailPos& trackPos)
@@ -581,58 +947,96 @@ const QVector<atools::geo::LineString> AircraftTrail::getLineStrings(const atool
   return linestrings;
 }
 
-const QVector<QVector<atools::geo::PosD> > AircraftTrail::getPositionsD() const
+const QVector<atools::geo::LineString> AircraftTrail::getLineStrings(const atools::geo::Pos& aircraftPos,
+                                                                    const atools::geo::Rect& viewportRect,
+                                                                    const MapLayer *mapLayer, int fromIndex) const
 {
-  QVector<QVector<atools::geo::PosD> > linestrings;
+  QVector<atools::geo::LineString> linestrings;
+  atools::geo::LineString line;
 
-  if(!isEmpty())
+  int level = lodLevel(mapLayer);
+  if(level > 0)
   {
-    QVector<atools::geo::PosD> line;
-    linestrings.reserve(size());
-
-    for(const AircraftTrailPos& trackPos : *this)
+    // Simplified trail ==========================================
+    const QVector<int>& indexes = lodIndexes[level - 1];
+    int start = static_cast<int>(std::lower_bound(indexes.constBegin(), indexes.constEnd(), numPruned + fromIndex) -
+                                 indexes.constBegin());
+    for(int i = std::max(start, 1); i < indexes.size(); i++)
     {
-      if(!trackPos.isValid())
+      const AircraftTrailPos& from = atSerial(indexes.at(i - 1)), &to = atSerial(indexes.at(i));
+
+      // Skip separators and segments outside of the viewport
+      if(from.isValid() && to.isValid() && chunksOverlap(indexes.at(i - 1), indexes.at(i), viewportRect))
+      {
+        if(line.isEmpty())
+          line.append(from.getPosition());
+        line.append(to.getPosition());
+      }
+      else if(!line.isEmpty())
       {
-        // An invalid position shows a break in the lines - add line and start a new one
         linestrings.append(line);
         line.clear();
       }
-      else
-        line.append(trackPos.getPosD());
     }
 
-    // Add rest
+    // Add aircraft position to avoid gap if the line reaches the end of the trail
+    if(aircraftPos.isValid() && !line.isEmpty() && !indexes.isEmpty() && indexes.constLast() == numPruned + size() - 1)
+      line.append(aircraftPos);
+
     if(!line.isEmpty())
       linestrings.append(line);
+
+    return linestrings;
   }
-  return linestrings;
-}
 
-const QVector<QVector<qint64> > AircraftTrail::getTimestampsMs() const
-{
-  QVector<QVector<qint64> > timestamps;
+  // Full resolution trail ==========================================
+  int nextIndex = numPruned + fromIndex; // Next index to add - avoids duplicates for positions connecting chunks
 
-  if(!isEmpty())
+  for(const TrailChunk& chunk : chunks)
   {
-    QVector<qint64> times;
-    timestamps.reserve(size());
+    // Skip chunks before start
+    if(chunk.start + chunk.size <= nextIndex)
+      continue;
 
-    for(const AircraftTrailPos& trackPos : *this)
+    if(!chunk.bounding.isValid() || !chunk.bounding.overlaps(viewportRect))
+    {
+      // Not visible - split line
+      if(!line.isEmpty())
+      {
+        linestrings.append(line);
+        line.clear();
+      }
+      continue;
+    }
+
+    // Add connecting position of next chunk too
+    int end = std::min(chunk.start + chunk.size + 1, numPruned + size());
+    for(int i = std::max(chunk.start, nextIndex); i < end; i++)
     {
+      const AircraftTrailPos& trackPos = atSerial(i);
       if(!trackPos.isValid())
       {
-        // An invalid position shows a break in the lines - start a new list
-        timestamps.append(times);
-        times.clear();
+        // An invalid position shows a break in the lines - add line and start a new one
+        if(!line.isEmpty())
+        {
+          linestrings.append(line);
+          line.clear();
+        }
       }
       else
-        times.append(trackPos.getTimestampMs());
+        line.append(trackPos.getPosition());
     }
-
-    // Add rest
-    if(!times.isEmpty())
-      timestamps.append(times);
+    nextIndex = end;
   }
-  return timestamps;
+
+  // Add aircraft position to avoid gap if the line reaches the end of the trail
+  if(aircraftPos.isValid() && !line.isEmpty() && nextIndex == numPruned + size())
+    line.append(aircraftPos);
+
+  // Add rest
+  if(!line.isEmpty())
+    linestrings.append(line);
+
+  return linestrings;
 }
+
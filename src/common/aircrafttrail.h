@@ -24,6 +24,8 @@
 namespace Marble {
 class GeoDataLatLonAltBox;
 }
+class MapLayer;
+class QFile;
 namespace map {
 struct AircraftTrailSegment;
 }
@@ -149,10 +151,15 @@ public:
   /* Appends the given gpxData as new track segment without deleting the current one. */
   void appendTrailFromGpxData(const atools::fs::gpx::GpxData& gpxData);
 
-  /* Saves and restores track into a separate file (little_navmap.track). Creates two additional backup files. */
+  /* Saves and restores track into a separate file (little_navmap.track). Creates two additional backup files.
+   * restoreState() also replays a journal left over from a crash. saveState() compacts an active journal. */
   void saveState(const QString& suffix, int numBackupFiles);
   void restoreState(const QString& suffix);
 
+  /* Start write-ahead journal mode for the track file given by suffix (little_navmap.track.journal).
+   * All new positions are appended to the journal as they arrive. */
+  void startJournal(const QString& suffix);
+
   void clearTrail();
 
   /*
@@ -182,6 +189,25 @@ public:
    * More than one linestring might be returned if the trail is interrupted. */
   const QVector<atools::geo::LineString> getLineStrings(const atools::geo::Pos& aircraftPos) const;
 
+  /* As above but skips all chunks of trail points not overlapping the viewport rectangle.
+   * Lines are split where chunks are left out.
+   * Uses a simplified trail matching the map layer range if mapLayer is not null.
+   * Positions before fromIndex are left out. */
+  const QVector<atools::geo::LineString> getLineStrings(const atools::geo::Pos& aircraftPos,
+                                                        const atools::geo::Rect& viewportRect,
+                                                        const MapLayer *mapLayer = nullptr, int fromIndex = 0) const;
+
+  /* Index of the first position not older than the given timestamp in milliseconds since Epoch.
+   * Uses a binary search. Returns size() if all positions are older. */
+  int getIndexForTime(qint64 timestampMs) const;
+
+  /* Index of the first position which is not farther away than the given distance from the last position
+   * measured along the trail. Uses a binary search. */
+  int getIndexForDistanceToEnd(float distanceNm) const;
+
+  /* Latest timestamp of all positions in milliseconds since Epoch or 0 if empty */
+  qint64 getMaxTimestampMs() const;
+
   /* Track will be pruned if it contains more track entries than this value. Default is 20000. */
   void setMaxTrackEntries(int value)
   {
@@ -211,11 +237,45 @@ private:
   void calculateBoundaries();
   void calculateBoundary(const AircraftTrailPos& trackPos);
 
-  /* Accurate positions for drawing */
-  const QVector<QVector<atools::geo::PosD> > getPositionsD() const;
+  /* Append position to list and write it to the journal if active */
+  void appendPos(const AircraftTrailPos& trackPos);
+
+  /* Write a record to the journal if active. Position is ignored for clear records. */
+  void writeJournal(quint8 type, const AircraftTrailPos& trackPos = AircraftTrailPos());
+
+  /* Write all positions starting at fromIndex to the journal if active. Flushes only once. */
+  void writeJournalPositions(int fromIndex);
+
+  /* Replay journal records into the trail */
+  void replayJournal(const QString& filename);
+
+  /* Add all positions not covered yet to the chunk index */
+  void updateChunks();
+
+  /* Add all positions not covered yet to the time and distance index */
+  void updateTimeIndex();
+
+  /* Remove entries for pruned positions from all indexes. Called after numRemoved positions were removed
+   * from the front of the trail. */
+  void pruneIndexes(int numRemoved);
+
+  /* Get position for an index including pruned positions as used by chunks and simplified trails */
+  const AircraftTrailPos& atSerial(int serial) const
+  {
+    return at(serial - numPruned);
+  }
 
-  /* Same size as getLineStrings() but returns the timestamps in milliseconds since Epoch UTC for each position */
-  const QVector<QVector<qint64> > getTimestampsMs() const;
+  /* Add all positions not covered yet to the simplified trails */
+  void updateLod();
+
+  /* Add position at index to simplified trail for level */
+  void appendLod(int level, int index);
+
+  /* true if any chunk covering the positions from index "from" to "to" overlaps the rectangle */
+  bool chunksOverlap(int from, int to, const atools::geo::Rect& rect) const;
+
+  /* Get level of detail for the layer range. 0 is full resolution. */
+  static int lodLevel(const MapLayer *mapLayer);
 
   /* Maximum number of track points. If exceeded entries will be removed from beginning of the list */
   int maxTrackEntries = 20000;
@@ -223,12 +283,49 @@ private:
   float maxAltitude, minAltitude;
   atools::geo::Rect bounding;
 
+  /* Number of positions pruned from the front since the trail was cleared.
+   * Chunks and simplified trails use indexes including pruned positions which avoids shifting them when pruning. */
+  int numPruned = 0;
+
+  /* Index over consecutive ranges of trail positions. Bounding includes the first position of the
+   * following chunk to cover the connecting line. Start is a multiple of TRAIL_CHUNK_SIZE. */
+  struct TrailChunk
+  {
+    int start, size;
+    atools::geo::Rect bounding;
+  };
+
+  QVector<TrailChunk> chunks;
+
+  /* Number of simplification levels including the full resolution trail at index 0 */
+  static Q_DECL_CONSTEXPR int NUM_LOD_LEVELS = 4;
+
+  /* Indexes of kept trail positions for simplified levels 1 to NUM_LOD_LEVELS - 1.
+   * Separators are always kept and the last index is always the last trail position. */
+  QVector<int> lodIndexes[NUM_LOD_LEVELS - 1];
+  int lodNumPositions = 0; /* Number of trail positions covered by lodIndexes including pruned */
+
+  /* One entry for each trail position. Timestamp is the running maximum and distance is accumulated along the
+   * trail to have sorted values for binary search. Running maximum keeps order for appended GPX trails. */
+  struct TimeIndexEntry
+  {
+    qint64 timestampMs;
+    double distanceNm;
+  };
+
+  /* QList allows removing entries from the front without moving the rest */
+  QList<TimeIndexEntry> timeIndex;
+
   /* Trail density settings which depends on ground speed */
   float minGroundDistMeter, minFlyingDistMeter, maxHeadingDiffDeg, maxSpeedDiffKts, maxAltDiffFtUpper, maxAltDiffFtLower, aglThresholdFt;
   qint64 maxFlyingTimeMs, maxGroundTimeMs;
 
   atools::fs::sc::SimConnectUserAircraft *lastUserAircraft;
 
+  /* Open journal file and track file suffix if journal mode is active */
+  QFile *journalFile = nullptr;
+  QString journalSuffix;
+
   /* Needed in RouteExportFormat stream operators to read different formats */
   static quint16 version;
 };
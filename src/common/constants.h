@@ -107,6 +107,7 @@ const QLatin1String ACTIONS_SHOW_XP12_WEATHER_FILE_INVALID("Actions/Xplane12Weat
 const QLatin1String ACTIONS_SHOW_XP11_WEATHER_FILE_NO_SIM("Actions/Xplane11WeatherFileNoSim");
 const QLatin1String ACTIONS_SHOW_XP12_WEATHER_FILE_NO_SIM("Actions/Xplane12WeatherFileNoSim");
 const QLatin1String ACTIONS_SHOW_REPLACE_TRAIL("Actions/ReplaceTrail");
+const QLatin1String ACTIONS_SHOW_ROUTE_TILE_DOWNLOAD("Actions/RouteTileDownload");
 
 const QLatin1String ACTIONS_SHOW_DATABASE_HINTS("Actions/DatabaseLoadShowHints");
 const QLatin1String ACTIONS_SHOW_DATABASE_OLD("Actions/DatabaseOld");
@@ -307,6 +308,7 @@ const QLatin1String TIME_DIALOG("Map/TimeDialog");
 /* Flightplan export dialog for online formats */
 const QLatin1String FLIGHTPLAN_ONLINE_EXPORT("Route/FlightplanOnlineExport");
 const QLatin1String ROUTE_PARKING_DIALOG("Route/ParkingDialog");
+const QLatin1String ROUTE_CRUISE_ALTITUDE_DIALOG("Route/CruiseAltitudeDialog");
 
 const QLatin1String LOGDATA_EDIT_ADD_DIALOG("LogdataDialog/Widget");
 const QLatin1String LOGDATA_STATS_DIALOG("LogdataStatsDialog/Widget");
@@ -355,6 +357,8 @@ const QLatin1String OPTIONS_DIALOG_FONT("OptionsDialog/Font");
 const QLatin1String OPTIONS_DIALOG_MAP_FONT("OptionsDialog/MapFont");
 const QLatin1String OPTIONS_PIXMAP_CACHE("Options/PixmapCache");
 const QLatin1String OPTIONS_MULTIEXPORT_DEBUG_PATH("Options/MultexporDebugPath");
+const QLatin1String OPTIONS_MULTIEXPORT_PARALLEL("Options/MultiexportParallel");
+const QLatin1String OPTIONS_LOGBOOK_GPX_CACHE_KB("Options/LogbookGpxCacheKb");
 const QLatin1String OPTIONS_MARBLE_DEBUG("Options/MarbleDebug");
 const QLatin1String OPTIONS_CONNECTCLIENT_DEBUG("Options/ConnectClientDebug");
 const QLatin1String OPTIONS_MAPWIDGET_DEBUG("Options/MapWidgetDebug");
@@ -364,11 +368,44 @@ const QLatin1String OPTIONS_DATAREADER_DEBUG("Options/DataReaderDebug");
 const QLatin1String OPTIONS_DATAREADER_RECONNECT_SIM("Options/DataReaderReconnectSim");
 const QLatin1String OPTIONS_DATAREADER_RECONNECT_XP("Options/DataReaderReconnectXp");
 const QLatin1String OPTIONS_DATAREADER_RECONNECT_SOCKET("Options/DataReaderReconnectSocket");
+const QLatin1String OPTIONS_DATAREADER_LOW_UPDATE_RATE("Options/DataReaderLowUpdateRateMs");
 const QLatin1String OPTIONS_WEATHER_DEBUG("Options/WeatherDebug");
+const QLatin1String OPTIONS_WEATHER_METAR_CACHE("Options/WeatherMetarCache");
 const QLatin1String OPTIONS_MAP_JUMP_BACK_DEBUG("Options/MapJumpBackDebug");
 const QLatin1String OPTIONS_PROFILE_JUMP_BACK_DEBUG("Options/ProfileJumpBackDebug");
+const QLatin1String OPTIONS_PROFILE_ELEVATION_CACHE("Options/ProfileElevationLegCache");
+const QLatin1String OPTIONS_PROFILE_GRID_SAFE_ALTITUDE("Options/ProfileGridSafeAltitude");
 const QLatin1String OPTIONS_MAP_LAYER_DEBUG("Options/MapLayerDebug");
 const QLatin1String OPTIONS_MAP_LAYER_DEBUG_DRAW("Options/MapLayerDebugDraw");
+const QLatin1String OPTIONS_MAP_LAYER_PARALLEL("Options/MapLayerParallel");
+const QLatin1String OPTIONS_MAP_LAYER_BASE_CACHE("Options/MapLayerBaseCache");
+const QLatin1String OPTIONS_MAP_LAYER_LABEL_DECLUTTER("Options/MapLayerLabelDeclutter");
+const QLatin1String OPTIONS_MAP_LAYER_AIRPORT_DIAGRAM_CACHE("Options/MapLayerAirportDiagramCache");
+const QLatin1String OPTIONS_MAP_LAYER_GPU("Options/MapLayerGpu");
+const QLatin1String OPTIONS_MAP_LAYER_GPU_SAMPLES("Options/MapLayerGpuSamples");
+const QLatin1String OPTIONS_MAP_LAYER_FRAME_BUDGET_MS("Options/MapLayerFrameBudgetMs");
+const QLatin1String OPTIONS_MAP_TILE_PREFETCH_CORRIDOR_NM("Options/MapTilePrefetchCorridorNm");
+const QLatin1String OPTIONS_MAP_TILE_PREFETCH_MAX_TILES("Options/MapTilePrefetchMaxTiles");
+const QLatin1String OPTIONS_MAP_AIRCRAFT_PREDICTION("Options/MapAircraftPrediction");
+const QLatin1String OPTIONS_MAP_DRAG_SNAPSHOT("Options/MapDragSnapshot");
+const QLatin1String OPTIONS_MAP_SUN_SHADING_INTERVAL("Options/MapSunShadingIntervalSeconds");
+const QLatin1String OPTIONS_MAP_KML_SIMPLIFY_DEG("Options/MapKmlSimplifyDeg");
+const QLatin1String OPTIONS_MAP_KML_SIMPLIFY_MIN_KB("Options/MapKmlSimplifyMinKb");
+const QLatin1String OPTIONS_PERF_COLLECT_INTERVAL_MS("Options/PerfCollectIntervalMs");
+const QLatin1String OPTIONS_SEARCH_ESTIMATE_COUNT("Options/SearchEstimateCount");
+const QLatin1String OPTIONS_SEARCH_COUNT_DELAY_MS("Options/SearchCountDelayMs");
+const QLatin1String OPTIONS_ROUTE_NETWORK_PRELOAD("Options/RouteNetworkPreload");
+const QLatin1String OPTIONS_PROCEDURE_STORE("Options/ProcedureStore");
+const QLatin1String OPTIONS_PROCEDURE_WARMUP("Options/ProcedureWarmup");
+const QLatin1String OPTIONS_NEAREST_STORE("Options/NearestStore");
+const QLatin1String OPTIONS_WEB_MAP_WIDGETS("Options/WebMapWidgets");
+const QLatin1String OPTIONS_WEB_RENDER_TIMEOUT_MS("Options/WebRenderTimeoutMs");
+const QLatin1String OPTIONS_WEB_PUSH_INTERVAL_MS("Options/WebPushIntervalMs");
+const QLatin1String OPTIONS_WEB_PUSH_MAX_SUBSCRIBERS("Options/WebPushMaxSubscribers");
+const QLatin1String OPTIONS_WEB_MIN_THREADS("Options/WebMinThreads");
+const QLatin1String OPTIONS_WEB_MAX_THREADS("Options/WebMaxThreads");
+const QLatin1String OPTIONS_WEB_KEEP_ALIVE_MS("Options/WebKeepAliveMs");
+const QLatin1String OPTIONS_WEB_ENCODE_THREADS("Options/WebEncodeThreads");
 
 const QLatin1String OPTIONS_ONLINE_NETWORK_DEBUG("Options/OnlineNetworkDebug");
 const QLatin1String OPTIONS_ONLINE_NETWORK_MAX_SHADOW_DIST_NM("Options/MaxShadowDistNm");
@@ -380,6 +417,16 @@ const QLatin1String OPTIONS_TRACK_DEBUG("Options/TrackDebug");
 const QLatin1String OPTIONS_WIND_DEBUG("Options/WindDebug");
 const QLatin1String OPTIONS_WEBSERVER_DEBUG("Options/WebserverDebug");
 const QLatin1String OPTIONS_STORAGE_DEBUG("Options/StorageDebug");
+
+/* Memory budgets in MB for all registered caches and the resident memory of the process. 0 disables the budget. */
+const QLatin1String OPTIONS_MEMORY_CACHE_BUDGET_MB("Options/MemoryCacheBudgetMb");
+const QLatin1String OPTIONS_MEMORY_RESIDENT_BUDGET_MB("Options/MemoryResidentBudgetMb");
+
+/* Threshold in ms for logging GUI thread stalls. 0 disables the stall monitor. */
+const QLatin1String OPTIONS_STALL_MONITOR_MS("Options/StallMonitorMs");
+
+const QLatin1String OPTIONS_QUERY_DEBUG("Options/QueryDebug");
+const QLatin1String OPTIONS_QUERY_DEBUG_SLOW_MS("Options/QueryDebugSlowMs");
 const QLatin1String OPTIONS_VERSION("Options/Version");
 const QLatin1String OPTIONS_NO_USER_AGENT("Options/NoUserAgent");
 const QLatin1String OPTIONS_WEATHER_UPDATE("Options/WeatherUpdate");
@@ -458,6 +505,24 @@ const QLatin1String STARTUP_FLIGHTPLAN("flight-plan");
 const QLatin1String STARTUP_FLIGHTPLAN_DESCR("flight-plan-descr");
 const QLatin1String STARTUP_AIRCRAFT_PERF("aircraft-perf");
 const QLatin1String STARTUP_LAYOUT("layout");
+const QLatin1String STARTUP_ROUTE_BATCH("route-batch");
+const QLatin1String STARTUP_ROUTE_BATCH_OUTPUT("route-batch-output");
+const QLatin1String STARTUP_ROUTE_BATCH_BENCHMARK("route-batch-benchmark");
+const QLatin1String STARTUP_ROUTE_BATCH_QUIT("route-batch-quit");
+const QLatin1String STARTUP_IMAGE_BATCH("image-batch");
+const QLatin1String STARTUP_IMAGE_BATCH_OUTPUT("image-batch-output");
+const QLatin1String STARTUP_IMAGE_BATCH_SIZE("image-batch-size");
+const QLatin1String STARTUP_IMAGE_BATCH_QUIT("image-batch-quit");
+const QLatin1String STARTUP_BENCHMARK("benchmark");
+const QLatin1String STARTUP_BENCHMARK_BASELINE("benchmark-baseline");
+const QLatin1String STARTUP_BENCHMARK_QUIT("benchmark-quit");
+const QLatin1String STARTUP_SESSION_RECORD("session-record");
+const QLatin1String STARTUP_SESSION_REPLAY("session-replay");
+const QLatin1String STARTUP_SESSION_REPLAY_SPEED("session-replay-speed");
+const QLatin1String STARTUP_SESSION_REPLAY_REPORT("session-replay-report");
+const QLatin1String STARTUP_SESSION_REPLAY_QUIT("session-replay-quit");
+const QLatin1String STARTUP_HEADLESS("headless"); /* Also checked in main() before creating the application */
+const QLatin1String STARTUP_SERVER("server"); /* Also checked in main() before creating the application */
 
 /* Not used as long options */
 const QLatin1String STARTUP_OTHER_ARGUMENTS("others"); /* Positional arguments not found after option - string list */
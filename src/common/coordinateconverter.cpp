@@ -18,6 +18,7 @@
 #include "common/coordinateconverter.h"
 
 #include "atools.h"
+#include "geo/calculations.h"
 #include "geo/pos.h"
 #include "geo/line.h"
 #include "geo/linestring.h"
@@ -25,9 +26,11 @@
 #include <marble/GeoDataLineString.h>
 #include <marble/GeoDataLinearRing.h>
 #include <marble/ViewportParams.h>
+#include <marble/Quaternion.h>
 
 #include <QLineF>
 #include <QPolygonF>
+#include <QBitArray>
 
 using namespace Marble;
 using namespace atools::geo;
@@ -396,6 +399,128 @@ bool CoordinateConverter::wToSInternal(const Marble::GeoDataCoordinates& coords,
   return visible && !hidden;
 }
 
+int CoordinateConverter::wToSBatch(QPolygonF& points, QBitArray& visible, const LineString& positions, const QSize& size,
+                                   QBitArray *hidden) const
+{
+  const int num = positions.size();
+  points.resize(num);
+  visible.fill(false, num);
+  if(hidden != nullptr)
+    hidden->fill(false, num);
+
+  if(num == 0)
+    return 0;
+
+  int numVisible = 0;
+  const Marble::Projection projection = viewport->projection();
+  if(projection != Marble::Spherical && projection != Marble::Mercator)
+  {
+    // Use Marble for all other projections ==================================
+    for(int i = 0; i < num; i++)
+    {
+      double x = 0., y = 0.;
+      bool isHidden = false;
+      if(wToS(positions.at(i), x, y, size, &isHidden))
+      {
+        visible.setBit(i);
+        numVisible++;
+      }
+
+      if(hidden != nullptr && isHidden)
+        hidden->setBit(i);
+      points[i] = QPointF(x, y);
+    }
+    return numVisible;
+  }
+
+  // Copy to struct of arrays in radians ==================================
+  QVector<double> lonX(num), latY(num), xs(num), ys(num);
+  for(int i = 0; i < num; i++)
+  {
+    const Pos& pos = positions.at(i);
+    lonX[i] = atools::geo::toRadians(static_cast<double>(pos.getLonX()));
+    latY[i] = atools::geo::toRadians(static_cast<double>(pos.getLatY()));
+  }
+
+  const double width = viewport->width(), height = viewport->height(), radius = viewport->radius();
+  if(!(radius > 0.))
+    return 0;
+
+  const double halfWidth = size.width() / 2., halfHeight = size.height() / 2.;
+
+  if(projection == Marble::Spherical)
+  {
+    // Same as Marble::SphericalProjection - rotate unit vector by planet axis and check for back side
+    const Marble::matrix& m = viewport->planetAxisMatrix();
+    QVector<double> zs(num);
+    for(int i = 0; i < num; i++)
+    {
+      const double cosLat = std::cos(latY[i]);
+      const double qx = cosLat * std::sin(lonX[i]), qy = std::sin(latY[i]), qz = cosLat * std::cos(lonX[i]);
+      xs[i] = width / 2. + radius * (m[0][0] * qx + m[1][0] * qy + m[2][0] * qz);
+      ys[i] = height / 2. - radius * (m[0][1] * qx + m[1][1] * qy + m[2][1] * qz);
+      zs[i] = m[0][2] * qx + m[1][2] * qy + m[2][2] * qz;
+    }
+
+    for(int i = 0; i < num; i++)
+    {
+      points[i] = QPointF(xs.at(i), ys.at(i));
+      bool isHidden = !positions.at(i).isValid() || zs.at(i) < 0.;
+      if(hidden != nullptr && isHidden)
+        hidden->setBit(i);
+
+      if(!isHidden && xs.at(i) + halfWidth >= 0. && xs.at(i) < width + halfWidth && ys.at(i) + halfHeight >= 0. && ys.at(i) < height + halfHeight)
+      {
+        visible.setBit(i);
+        numVisible++;
+      }
+    }
+  }
+  else
+  {
+    // Same as Marble::MercatorProjection ======================================
+    const static double MAX_LAT_RAD = std::atan(std::sinh(M_PI));
+    const double rad2Pixel = 2. * radius / M_PI, repeatWidth = 4. * radius;
+    const double centerLatInv = std::atanh(std::sin(viewport->centerLatitude()));
+    const double centerLon = viewport->centerLongitude();
+
+    for(int i = 0; i < num; i++)
+    {
+      xs[i] = width / 2. + (lonX[i] - centerLon) * rad2Pixel;
+      ys[i] = height / 2. - (std::atanh(std::sin(atools::minmax(-MAX_LAT_RAD, MAX_LAT_RAD, latY[i]))) - centerLatInv) * rad2Pixel;
+    }
+
+    for(int i = 0; i < num; i++)
+    {
+      double x = xs.at(i), y = ys.at(i);
+
+      // Flat projection hides only invalid positions
+      if(hidden != nullptr && !positions.at(i).isValid())
+        hidden->setBit(i);
+
+      if(positions.at(i).isValid() && std::abs(latY.at(i)) <= MAX_LAT_RAD && y + halfHeight >= 0. && y - halfHeight <= height)
+      {
+        // Use the leftmost visible repetition like wToS()
+        while(x - halfWidth > 0.)
+          x -= repeatWidth;
+        while(x + halfWidth < 0.)
+          x += repeatWidth;
+
+        if(x - halfWidth <= width)
+        {
+          visible.setBit(i);
+          numVisible++;
+        }
+        else
+          x = xs.at(i);
+      }
+      points[i] = QPointF(x, y);
+    }
+  }
+
+  return numVisible;
+}
+
 const QVector<QPolygonF *> CoordinateConverter::createPolygons(const atools::geo::LineString& linestring, const QRectF& screenRect) const
 {
   QVector<QPolygonF *> polys;
@@ -511,11 +636,16 @@ const QVector<QPolygonF *> CoordinateConverter::createPolylinesInternal(const at
 
       // Split long lines to work around the buggy visibility check in Marble resulting in disappearing line segments
       // Do a quick check using Manhattan distance in degree
-      LineString ls;
+      int maxPoints = 1;
       if(line.lengthSimple() > 30.f)
-        line.interpolatePoints(line.lengthMeter(), 20, ls);
+        maxPoints = 20;
       else if(line.lengthSimple() > 5.f)
-        line.interpolatePoints(line.lengthMeter(), 5, ls);
+        maxPoints = 5;
+
+      LineString ls;
+      int numPoints = maxPoints > 1 ? std::min(maxPoints, splitCount(line)) : 1;
+      if(numPoints > 1)
+        line.interpolatePoints(line.lengthMeter(), numPoints, ls);
       else
         ls.append(line.getPos1());
 
@@ -556,6 +686,24 @@ const QVector<QPolygonF *> CoordinateConverter::createPolylinesInternal(const at
   return polylineVector;
 }
 
+int CoordinateConverter::splitCount(const atools::geo::Line& line) const
+{
+  // Maximum deviation in pixel between great circle arc and its chords on screen
+  const double MAX_ERROR_PIXEL = 0.5;
+
+  // Globe radius in pixel - Mercator and Equirectangular use the same scale at the equator
+  double radiusPixel = viewport->radius();
+  if(radiusPixel <= MAX_ERROR_PIXEL)
+    return 1;
+
+  // Sagitta of a chord spanning the angle a is r * (1 - cos(a / 2)) - get maximum angle per chord for the error
+  double maxChordAngle = 2. * std::acos(1. - MAX_ERROR_PIXEL / radiusPixel);
+  // One degree of arc is 60 NM
+  double angle = atools::geo::toRadians(static_cast<double>(atools::geo::meterToNm(line.lengthMeter())) / 60.);
+
+  return std::max(1, static_cast<int>(std::ceil(angle / maxChordAngle)));
+}
+
 void CoordinateConverter::releasePolylines(const QVector<QPolygonF *>& polylines) const
 {
   qDeleteAll(polylines);
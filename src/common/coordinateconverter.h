@@ -23,6 +23,9 @@
 #include <QPoint>
 #include <QSize>
 
+class QBitArray;
+class QPolygonF;
+
 namespace Marble {
 class ViewportParams;
 class GeoDataLineString;
@@ -123,6 +126,23 @@ public:
 
   bool wToS(const atools::geo::Line& coords, QLineF& line, const QSize& size = DEFAULT_WTOS_SIZE, bool *isHidden = nullptr) const;
 
+  /*
+   * Convert all positions to screen coordinates in one run.
+   * Uses direct projection math on contiguous arrays for spherical and Mercator projection. This avoids the
+   * per point overhead of Marble and allows the compiler to vectorize the loops.
+   * Falls back to wToS() for each point in other projections.
+   *
+   * @param points screen coordinates. Resized to the number of positions. Invisible and hidden points have a
+   * coordinate too which is not usable.
+   * @param visible bit is set for each point which is visible and not hidden behind the globe
+   * @param positions world coordinates. Invalid positions are not visible.
+   * @param size estimated screen size of each point
+   * @param hidden if not null bit is set for each point hidden behind the globe or invalid
+   * @return number of visible points
+   */
+  int wToSBatch(QPolygonF& points, QBitArray& visible, const atools::geo::LineString& positions,
+                const QSize& size = DEFAULT_WTOS_SIZE, QBitArray *hidden = nullptr) const;
+
   bool sToW(int x, int y, atools::geo::Pos& pos) const;
   bool sToW(int x, int y, Marble::GeoDataCoordinates& coords) const;
 
@@ -158,6 +178,9 @@ private:
   const QVector<QPolygonF *> createPolygonsInternal(const atools::geo::LineString& linestring, const QRectF& screenRect) const;
   const QVector<QPolygonF *> createPolylinesInternal(const atools::geo::LineString& linestring, const QRectF& screenRect) const;
 
+  /* Number of chords needed to keep the great circle deviation below half a pixel at the current zoom */
+  int splitCount(const atools::geo::Line& line) const;
+
   const Marble::ViewportParams *viewport;
 
 };
@@ -23,6 +23,7 @@
 #include "fs/common/globereader.h"
 #include "gui/helphandler.h"
 #include "options/optiondata.h"
+#include "settings/settings.h"
 #include "geo/line.h"
 #include "geo/linestring.h"
 #include "geo/pos.h"
@@ -46,9 +47,27 @@ using atools::fs::common::GlobeReader;
 
 using namespace Marble;
 
+/* Marks a cell in the block cache as not read */
+static Q_DECL_CONSTEXPR float INVALID_CELL = std::numeric_limits<float>::max();
+
+/* Get key for the 1 x 1 degree block containing pos and the lower left corner of the block */
+static int blockKeyForPos(const atools::geo::Pos& pos, float& lonFloor, float& latFloor)
+{
+  lonFloor = std::min(std::floor(pos.getLonX()), 179.f);
+  latFloor = std::min(std::floor(pos.getLatY()), 89.f);
+  return static_cast<int>(latFloor + 90.f) * 360 + static_cast<int>(lonFloor + 180.f);
+}
+
 ElevationProvider::ElevationProvider(QObject *parent)
   : QObject(parent)
 {
+  // About 56 KB per block
+  blockCache.setMaxCost(atools::settings::Settings::instance().getAndStoreValue(lnm::SETTINGS_MAPQUERY % "ElevationBlockCache",
+                                                                                64).toInt());
+
+  // About 4 KB per block - filled blocks stay valid until the GLOBE reader changes
+  maxBlockCache.setMaxCost(atools::settings::Settings::instance().getAndStoreValue(lnm::SETTINGS_MAPQUERY % "ElevationMaxGridCache",
+                                                                                   2048).toInt());
 }
 
 ElevationProvider::~ElevationProvider()
@@ -67,7 +86,7 @@ float ElevationProvider::getElevationMeter(const atools::geo::Pos& pos, float sa
   if(isGlobeOfflineProvider())
   {
     QMutexLocker locker(&mutex);
-    float elevation = globeReader->getElevation(pos, sampleRadiusMeter);
+    float elevation = sampleRadiusMeter > 0.f ? globeReader->getElevation(pos, sampleRadiusMeter) : elevationMeterInternal(pos);
     if(!(elevation > atools::fs::common::OCEAN && elevation < atools::fs::common::INVALID))
       return 0.f;
     else
@@ -77,6 +96,141 @@ float ElevationProvider::getElevationMeter(const atools::geo::Pos& pos, float sa
     return 0.f;
 }
 
+QVector<float> ElevationProvider::getElevationsMeter(const QVector<atools::geo::Pos>& positions)
+{
+  QVector<float> elevations(positions.size(), 0.f);
+
+  if(isGlobeOfflineProvider())
+  {
+    QMutexLocker locker(&mutex);
+    for(int i = 0; i < positions.size(); i++)
+    {
+      float elevation = elevationMeterInternal(positions.at(i));
+      if(elevation > atools::fs::common::OCEAN && elevation < atools::fs::common::INVALID)
+        elevations[i] = elevation;
+    }
+  }
+  return elevations;
+}
+
+float ElevationProvider::elevationMeterInternal(const atools::geo::Pos& pos)
+{
+  if(!pos.isValid())
+    return atools::fs::common::INVALID;
+
+  // Find 1 x 1 degree block
+  float lonFloor, latFloor;
+  int blockKey = blockKeyForPos(pos, lonFloor, latFloor);
+
+  ElevationBlock *block = blockCache.object(blockKey);
+  if(block == nullptr)
+  {
+    block = new ElevationBlock;
+    block->cells.fill(INVALID_CELL, CELLS_PER_DEGREE * CELLS_PER_DEGREE);
+    blockCache.insert(blockKey, block);
+  }
+
+  // Find GLOBE cell in block
+  int x = atools::minmax(0, CELLS_PER_DEGREE - 1, static_cast<int>((pos.getLonX() - lonFloor) * CELLS_PER_DEGREE));
+  int y = atools::minmax(0, CELLS_PER_DEGREE - 1, static_cast<int>((pos.getLatY() - latFloor) * CELLS_PER_DEGREE));
+  float& cell = block->cells[y * CELLS_PER_DEGREE + x];
+
+  if(cell == INVALID_CELL)
+    // Not read yet - use cell center for the query to get the same value for all positions in the cell
+    cell = globeReader->getElevation(Pos(lonFloor + (x + 0.5f) / CELLS_PER_DEGREE, latFloor + (y + 0.5f) / CELLS_PER_DEGREE), 0.f);
+
+  return cell;
+}
+
+float ElevationProvider::getMaxElevationMeter(const atools::geo::Pos& pos, bool coarse)
+{
+  if(isGlobeOfflineProvider())
+  {
+    QMutexLocker locker(&mutex);
+    return maxElevationMeterInternal(pos, coarse);
+  }
+  else
+    return 0.f;
+}
+
+float ElevationProvider::getMaxElevationMeter(const atools::geo::LineString& geometry, bool coarse)
+{
+  float maxElevation = 0.f;
+  if(isGlobeOfflineProvider() && !geometry.isEmpty())
+  {
+    // Step a quarter cell size to catch all cells touched by the line - use latitude cell height
+    float stepMeter = atools::geo::nmToMeter(60.f / (coarse ? GRID_COARSE_PER_DEGREE : GRID_FINE_PER_DEGREE)) / 4.f;
+
+    QMutexLocker locker(&mutex);
+    maxElevation = maxElevationMeterInternal(geometry.constFirst(), coarse);
+
+    for(int i = 1; i < geometry.size(); i++)
+    {
+      const Pos& pos1 = geometry.at(i - 1), &pos2 = geometry.at(i);
+      float distanceMeter = pos1.distanceMeterTo(pos2);
+      int steps = std::max(1, static_cast<int>(std::ceil(distanceMeter / stepMeter)));
+
+      for(int j = 1; j <= steps; j++)
+      {
+        Pos pos = j == steps ? pos2 : pos1.interpolate(pos2, distanceMeter, static_cast<float>(j) / steps);
+        maxElevation = std::max(maxElevation, maxElevationMeterInternal(pos, coarse));
+      }
+    }
+  }
+  return maxElevation;
+}
+
+float ElevationProvider::maxElevationMeterInternal(const atools::geo::Pos& pos, bool coarse)
+{
+  if(!pos.isValid())
+    return 0.f;
+
+  float lonFloor, latFloor;
+  int blockKey = blockKeyForPos(pos, lonFloor, latFloor);
+
+  MaxElevationBlock *block = maxBlockCache.object(blockKey);
+  if(block == nullptr)
+  {
+    // Read all GLOBE cells of the block once and keep the maximum for each grid cell
+    block = new MaxElevationBlock;
+    block->fine.fill(0.f, GRID_FINE_PER_DEGREE * GRID_FINE_PER_DEGREE);
+    block->coarse.fill(0.f, GRID_COARSE_PER_DEGREE * GRID_COARSE_PER_DEGREE);
+
+    const int globePerFine = CELLS_PER_DEGREE / GRID_FINE_PER_DEGREE, finePerCoarse = GRID_FINE_PER_DEGREE / GRID_COARSE_PER_DEGREE;
+    for(int y = 0; y < CELLS_PER_DEGREE; y++)
+    {
+      for(int x = 0; x < CELLS_PER_DEGREE; x++)
+      {
+        float elevation = globeReader->getElevation(Pos(lonFloor + (x + 0.5f) / CELLS_PER_DEGREE,
+                                                        latFloor + (y + 0.5f) / CELLS_PER_DEGREE), 0.f);
+
+        if(elevation > atools::fs::common::OCEAN && elevation < atools::fs::common::INVALID)
+        {
+          float& fine = block->fine[(y / globePerFine) * GRID_FINE_PER_DEGREE + x / globePerFine];
+          fine = std::max(fine, elevation);
+        }
+      }
+    }
+
+    for(int y = 0; y < GRID_FINE_PER_DEGREE; y++)
+    {
+      for(int x = 0; x < GRID_FINE_PER_DEGREE; x++)
+      {
+        float& coarseCell = block->coarse[(y / finePerCoarse) * GRID_COARSE_PER_DEGREE + x / finePerCoarse];
+        coarseCell = std::max(coarseCell, block->fine.at(y * GRID_FINE_PER_DEGREE + x));
+      }
+    }
+
+    maxBlockCache.insert(blockKey, block);
+  }
+
+  int perDegree = coarse ? GRID_COARSE_PER_DEGREE : GRID_FINE_PER_DEGREE;
+  int x = atools::minmax(0, perDegree - 1, static_cast<int>((pos.getLonX() - lonFloor) * perDegree));
+  int y = atools::minmax(0, perDegree - 1, static_cast<int>((pos.getLatY() - latFloor) * perDegree));
+
+  return std::min((coarse ? block->coarse : block->fine).at(y * perDegree + x), ALTITUDE_LIMIT_METER);
+}
+
 float ElevationProvider::getElevationFt(const atools::geo::Pos& pos, float sampleRadiusMeter)
 {
   return atools::geo::meterToFeet(getElevationMeter(pos, sampleRadiusMeter));
@@ -196,6 +350,8 @@ void ElevationProvider::updateReader(bool startupParam)
   {
     // Make sure to wait for other methods to finish before changing the reader
     QMutexLocker locker(&mutex);
+    blockCache.clear();
+    maxBlockCache.clear();
 
     if(useOffline)
     {
@@ -18,8 +18,10 @@
 #ifndef LITTLENAVMAP_ELEVATIONPROVIDER_H
 #define LITTLENAVMAP_ELEVATIONPROVIDER_H
 
+#include <QCache>
 #include <QMutex>
 #include <QObject>
+#include <QVector>
 
 namespace Marble {
 class ElevationModel;
@@ -62,11 +64,23 @@ public:
   float getElevationMeter(const atools::geo::Pos& pos, float sampleRadiusMeter = 0.f);
   float getElevationFt(const atools::geo::Pos& pos, float sampleRadiusMeter = 0.f);
 
+  /* Elevations in meter for a list of positions using a single lock. Only for offline data.
+   * Result has same size and order as positions. */
+  QVector<float> getElevationsMeter(const QVector<atools::geo::Pos>& positions);
+
   /* Get elevations along a great circle line. Will create a point every 500 meters and delete
    * consecutive ones with same elevation. Elevation given in meter
    * "sampleRadiusMeter" defines a rectangle where five points are sampled for each pos and the maximum is used.*/
   void getElevations(atools::geo::LineString& elevations, const atools::geo::Line& line, float sampleRadiusMeter = 0.f);
 
+  /* Maximum ground elevation in meter of all minimum grid cells touched by the geometry.
+   * Cells are two arc minutes or ten arc minutes if "coarse" is true. Only for offline data.
+   * Grid values are precomputed from GLOBE data once per 1 x 1 degree block on first use. */
+  float getMaxElevationMeter(const atools::geo::LineString& geometry, bool coarse = false);
+
+  /* Maximum ground elevation in meter of the minimum grid cell containing pos */
+  float getMaxElevationMeter(const atools::geo::Pos& pos, bool coarse = false);
+
   /* true if the data is provided from the fast offline source */
   bool isGlobeOfflineProvider() const;
 
@@ -98,6 +112,37 @@ private:
   void marbleUpdateAvailable();
   void updateReader(bool startupParam);
 
+  /* Get elevation for pos from the block cache or GLOBE reader. Lock has to be held. */
+  float elevationMeterInternal(const atools::geo::Pos& pos);
+
+  /* Get maximum grid elevation for pos. Lock has to be held. */
+  float maxElevationMeterInternal(const atools::geo::Pos& pos, bool coarse);
+
+  /* GLOBE cells per degree (30 arc seconds) */
+  static Q_DECL_CONSTEXPR int CELLS_PER_DEGREE = 120;
+
+  /* Minimum grid cells per degree for fine (2 arc minutes) and coarse (10 arc minutes) resolution */
+  static Q_DECL_CONSTEXPR int GRID_FINE_PER_DEGREE = 30;
+  static Q_DECL_CONSTEXPR int GRID_COARSE_PER_DEGREE = 6;
+
+  /* Lazily filled elevation values for a 1 x 1 degree block in GLOBE cell resolution */
+  struct ElevationBlock
+  {
+    QVector<float> cells; /* INVALID_CELL if not read yet */
+  };
+
+  /* Recently used blocks for single point queries without sample radius */
+  QCache<int, ElevationBlock> blockCache;
+
+  /* Maximum elevation for each minimum grid cell of a 1 x 1 degree block. Ocean and invalid are 0. */
+  struct MaxElevationBlock
+  {
+    QVector<float> fine, coarse;
+  };
+
+  /* Fully computed blocks for terrain clearance queries */
+  QCache<int, MaxElevationBlock> maxBlockCache;
+
   const Marble::ElevationModel *marbleModel = nullptr;
   atools::fs::common::GlobeReader *globeReader = nullptr;
 
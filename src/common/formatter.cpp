@@ -300,12 +300,12 @@ QString courseText(float magCourse, float trueCourse, bool magBold, bool magBig,
 {
   QString magStr, trueStr;
   if(magCourse < map::INVALID_COURSE_VALUE / 2.f)
-    magStr = QLocale().toString(magCourse, 'f', 0);
+    magStr = Unit::numStr(magCourse);
 
   if(forceBoth || OptionData::instance().getFlags2().testFlag(opts2::UNIT_TRUE_COURSE) || magStr.isEmpty())
   {
     if(trueCourse < map::INVALID_COURSE_VALUE / 2.f)
-      trueStr = QLocale().toString(trueCourse, 'f', 0);
+      trueStr = Unit::numStr(trueCourse);
   }
 
   // Formatting for magnetic course
@@ -357,10 +357,10 @@ QString courseTextNarrow(float magCourse, float trueCourse)
   QString initTrueText, initMagText;
 
   if(trueCourse < map::INVALID_COURSE_VALUE)
-    initTrueText = QString::number(trueCourse, 'f', 0);
+    initTrueText = Unit::numStr(trueCourse, true /* narrow */);
 
   if(magCourse < map::INVALID_COURSE_VALUE)
-    initMagText = QString::number(magCourse, 'f', 0);
+    initMagText = Unit::numStr(magCourse, true /* narrow */);
 
   QString initText;
   if(!initTrueText.isEmpty() && !initMagText.isEmpty())
@@ -0,0 +1,202 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_FRAMEARENA_H
+#define LNM_FRAMEARENA_H
+
+#include "geo/line.h"
+#include "geo/linestring.h"
+
+#include <QLineF>
+#include <QPolygonF>
+#include <QStringList>
+#include <QVector>
+
+/*
+ * Per frame scratch storage for temporary containers used while painting like screen polygons,
+ * line lists, index vectors and label texts.
+ *
+ * Containers are handed out in a stack like fashion. A Scope returns all containers acquired
+ * within its lifetime when going out of scope. Returned containers are emptied but keep their capacity
+ * so that repeated use in the same or following frames does not allocate again.
+ *
+ * A reference to a container is valid until its scope ends. Not thread safe.
+ */
+class FrameArena
+{
+  /* Stack of reusable containers of one type */
+  template<typename TYPE>
+  class Pool
+  {
+public:
+    ~Pool()
+    {
+      qDeleteAll(items);
+    }
+
+    TYPE& acquire(int& allocations)
+    {
+      if(used == items.size())
+      {
+        items.append(new TYPE);
+        allocations++;
+      }
+      return *items.at(used++);
+    }
+
+    /* Return all containers above mark and empty them */
+    void release(int mark)
+    {
+      while(used > mark)
+        clearKeepCapacity(*items.at(--used));
+    }
+
+    int getUsed() const
+    {
+      return used;
+    }
+
+private:
+    /* QVector::clear() keeps capacity since Qt 5.7 - QList::clear() does not */
+    template<typename T>
+    static void clearKeepCapacity(QVector<T>& vector)
+    {
+      vector.clear();
+    }
+
+    static void clearKeepCapacity(QStringList& list)
+    {
+      list.erase(list.begin(), list.end());
+    }
+
+    QVector<TYPE *> items;
+    int used = 0;
+  };
+
+public:
+  FrameArena()
+  {
+  }
+
+  FrameArena(const FrameArena& other) = delete;
+  FrameArena& operator=(const FrameArena& other) = delete;
+
+  /* Acquires containers from an arena and returns them on destruction */
+  class Scope
+  {
+public:
+    explicit Scope(FrameArena& arenaParam)
+      : arena(arenaParam), polygonMark(arenaParam.polygons.getUsed()), lineMark(arenaParam.lines.getUsed()),
+      intMark(arenaParam.ints.getUsed()), doubleMark(arenaParam.doubles.getUsed()),
+      stringMark(arenaParam.strings.getUsed()), lineStringMark(arenaParam.lineStrings.getUsed()),
+      geoLineMark(arenaParam.geoLines.getUsed())
+    {
+    }
+
+    ~Scope()
+    {
+      arena.polygons.release(polygonMark);
+      arena.lines.release(lineMark);
+      arena.ints.release(intMark);
+      arena.doubles.release(doubleMark);
+      arena.strings.release(stringMark);
+      arena.lineStrings.release(lineStringMark);
+      arena.geoLines.release(geoLineMark);
+    }
+
+    Scope(const Scope& other) = delete;
+    Scope& operator=(const Scope& other) = delete;
+
+    /* Also usable as QVector<QPointF> */
+    QPolygonF& polygon()
+    {
+      arena.acquires++;
+      return arena.polygons.acquire(arena.allocations);
+    }
+
+    QVector<QLineF>& lines()
+    {
+      arena.acquires++;
+      return arena.lines.acquire(arena.allocations);
+    }
+
+    QVector<int>& ints()
+    {
+      arena.acquires++;
+      return arena.ints.acquire(arena.allocations);
+    }
+
+    QVector<double>& doubles()
+    {
+      arena.acquires++;
+      return arena.doubles.acquire(arena.allocations);
+    }
+
+    QStringList& strings()
+    {
+      arena.acquires++;
+      return arena.strings.acquire(arena.allocations);
+    }
+
+    atools::geo::LineString& lineString()
+    {
+      arena.acquires++;
+      return arena.lineStrings.acquire(arena.allocations);
+    }
+
+    QVector<atools::geo::Line>& geoLines()
+    {
+      arena.acquires++;
+      return arena.geoLines.acquire(arena.allocations);
+    }
+
+private:
+    FrameArena& arena;
+    int polygonMark, lineMark, intMark, doubleMark, stringMark, lineStringMark, geoLineMark;
+  };
+
+  /* Call at the start of each frame. Resets the statistics. */
+  void startFrame()
+  {
+    acquires = allocations = 0;
+  }
+
+  /* Number of containers requested in this frame */
+  int getAcquireCount() const
+  {
+    return acquires;
+  }
+
+  /* Number of containers which had to be created in this frame since the arena had no free one */
+  int getAllocationCount() const
+  {
+    return allocations;
+  }
+
+private:
+  Pool<QPolygonF> polygons;
+  Pool<QVector<QLineF> > lines;
+  Pool<QVector<int> > ints;
+  Pool<QVector<double> > doubles;
+  Pool<QStringList> strings;
+  Pool<atools::geo::LineString> lineStrings;
+  Pool<QVector<atools::geo::Line> > geoLines;
+
+  int acquires = 0, allocations = 0;
+};
+
+#endif // LNM_FRAMEARENA_H
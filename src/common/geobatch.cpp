@@ -0,0 +1,236 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+#include "common/geobatch.h"
+
+#include "geo/pos.h"
+#include "geo/calculations.h"
+#include "common/mapflags.h"
+
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LNM_GEOBATCH_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define LNM_GEOBATCH_NEON
+#include <arm_neon.h>
+#endif
+
+namespace geobatch {
+
+/* Meter per radian. One nautical mile is one arc minute. */
+const static double EARTH_RADIUS_METER = 1852. * 10800. / M_PI;
+
+/* Squared distance between unit vectors and point p */
+static void chordKernel(float *out, const float *x, const float *y, const float *z, float px, float py, float pz, int num)
+{
+  int i = 0;
+#if defined(LNM_GEOBATCH_SSE2)
+  const __m128 vpx = _mm_set1_ps(px), vpy = _mm_set1_ps(py), vpz = _mm_set1_ps(pz);
+  for(; i + 4 <= num; i += 4)
+  {
+    __m128 dx = _mm_sub_ps(_mm_loadu_ps(x + i), vpx);
+    __m128 dy = _mm_sub_ps(_mm_loadu_ps(y + i), vpy);
+    __m128 dz = _mm_sub_ps(_mm_loadu_ps(z + i), vpz);
+    _mm_storeu_ps(out + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+  }
+#elif defined(LNM_GEOBATCH_NEON)
+  const float32x4_t vpx = vdupq_n_f32(px), vpy = vdupq_n_f32(py), vpz = vdupq_n_f32(pz);
+  for(; i + 4 <= num; i += 4)
+  {
+    float32x4_t dx = vsubq_f32(vld1q_f32(x + i), vpx);
+    float32x4_t dy = vsubq_f32(vld1q_f32(y + i), vpy);
+    float32x4_t dz = vsubq_f32(vld1q_f32(z + i), vpz);
+    vst1q_f32(out + i, vmlaq_f32(vmlaq_f32(vmulq_f32(dx, dx), dy, dy), dz, dz));
+  }
+#endif
+
+  // Remaining elements or all if no vector instructions available
+  for(; i < num; i++)
+  {
+    float dx = x[i] - px, dy = y[i] - py, dz = z[i] - pz;
+    out[i] = dx * dx + dy * dy + dz * dz;
+  }
+}
+
+/* Dot products of unit vectors with the two vectors a and b */
+static void dotKernel(float *outA, float *outB, const float *x, const float *y, const float *z,
+                      float ax, float ay, float az, float bx, float by, float bz, int num)
+{
+  int i = 0;
+#if defined(LNM_GEOBATCH_SSE2)
+  const __m128 vax = _mm_set1_ps(ax), vay = _mm_set1_ps(ay), vaz = _mm_set1_ps(az);
+  const __m128 vbx = _mm_set1_ps(bx), vby = _mm_set1_ps(by), vbz = _mm_set1_ps(bz);
+  for(; i + 4 <= num; i += 4)
+  {
+    __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i), vz = _mm_loadu_ps(z + i);
+    _mm_storeu_ps(outA + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vax), _mm_mul_ps(vy, vay)), _mm_mul_ps(vz, vaz)));
+    _mm_storeu_ps(outB + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vbx), _mm_mul_ps(vy, vby)), _mm_mul_ps(vz, vbz)));
+  }
+#elif defined(LNM_GEOBATCH_NEON)
+  const float32x4_t vax = vdupq_n_f32(ax), vay = vdupq_n_f32(ay), vaz = vdupq_n_f32(az);
+  const float32x4_t vbx = vdupq_n_f32(bx), vby = vdupq_n_f32(by), vbz = vdupq_n_f32(bz);
+  for(; i + 4 <= num; i += 4)
+  {
+    float32x4_t vx = vld1q_f32(x + i), vy = vld1q_f32(y + i), vz = vld1q_f32(z + i);
+    vst1q_f32(outA + i, vmlaq_f32(vmlaq_f32(vmulq_f32(vx, vax), vy, vay), vz, vaz));
+    vst1q_f32(outB + i, vmlaq_f32(vmlaq_f32(vmulq_f32(vx, vbx), vy, vby), vz, vbz));
+  }
+#endif
+
+  for(; i < num; i++)
+  {
+    outA[i] = x[i] * ax + y[i] * ay + z[i] * az;
+    outB[i] = x[i] * bx + y[i] * by + z[i] * bz;
+  }
+}
+
+PosBatch::PosBatch()
+{
+
+}
+
+PosBatch::PosBatch(int reserveSize)
+{
+  reserve(reserveSize);
+}
+
+void PosBatch::reserve(int reserveSize)
+{
+  x.reserve(reserveSize);
+  y.reserve(reserveSize);
+  z.reserve(reserveSize);
+}
+
+void PosBatch::clear()
+{
+  x.clear();
+  y.clear();
+  z.clear();
+}
+
+void PosBatch::append(const atools::geo::Pos& pos)
+{
+  if(pos.isValid())
+  {
+    double lonX = atools::geo::toRadians(static_cast<double>(pos.getLonX()));
+    double latY = atools::geo::toRadians(static_cast<double>(pos.getLatY()));
+    double cosLat = std::cos(latY);
+    x.append(static_cast<float>(cosLat * std::cos(lonX)));
+    y.append(static_cast<float>(cosLat * std::sin(lonX)));
+    z.append(static_cast<float>(std::sin(latY)));
+  }
+  else
+  {
+    // NaN propagates through the kernels and is replaced by the invalid values
+    x.append(std::numeric_limits<float>::quiet_NaN());
+    y.append(std::numeric_limits<float>::quiet_NaN());
+    z.append(std::numeric_limits<float>::quiet_NaN());
+  }
+}
+
+void PosBatch::chordsSq(QVector<float>& chords, const atools::geo::Pos& pos) const
+{
+  chords.resize(size());
+  if(isEmpty())
+    return;
+
+  if(!pos.isValid())
+  {
+    chords.fill(std::numeric_limits<float>::max());
+    return;
+  }
+
+  double lonX = atools::geo::toRadians(static_cast<double>(pos.getLonX()));
+  double latY = atools::geo::toRadians(static_cast<double>(pos.getLatY()));
+  double cosLat = std::cos(latY);
+
+  chordKernel(chords.data(), x.constData(), y.constData(), z.constData(),
+              static_cast<float>(cosLat * std::cos(lonX)), static_cast<float>(cosLat * std::sin(lonX)),
+              static_cast<float>(std::sin(latY)), size());
+
+  for(float& chord : chords)
+  {
+    if(std::isnan(chord))
+      chord = std::numeric_limits<float>::max();
+  }
+}
+
+void PosBatch::distancesMeter(QVector<float>& distances, const atools::geo::Pos& pos) const
+{
+  chordsSq(distances, pos);
+  for(float& distance : distances)
+    distance = meterFromChordSq(distance);
+}
+
+void PosBatch::coursesDeg(QVector<float>& courses, const atools::geo::Pos& pos) const
+{
+  courses.resize(size());
+  if(isEmpty())
+    return;
+
+  if(!pos.isValid())
+  {
+    courses.fill(map::INVALID_COURSE_VALUE);
+    return;
+  }
+
+  double lonX = atools::geo::toRadians(static_cast<double>(pos.getLonX()));
+  double latY = atools::geo::toRadians(static_cast<double>(pos.getLatY()));
+  double sinLon = std::sin(lonX), cosLon = std::cos(lonX), sinLat = std::sin(latY), cosLat = std::cos(latY);
+
+  // Project all points on the local east and north vectors at pos
+  QVector<float> north(size());
+  dotKernel(courses.data(), north.data(), x.constData(), y.constData(), z.constData(),
+            static_cast<float>(-sinLon), static_cast<float>(cosLon), 0.f,
+            static_cast<float>(-sinLat * cosLon), static_cast<float>(-sinLat * sinLon), static_cast<float>(cosLat), size());
+
+  for(int i = 0; i < courses.size(); i++)
+  {
+    float east = courses.at(i);
+    if(std::isnan(east))
+      courses[i] = map::INVALID_COURSE_VALUE;
+    else
+    {
+      float course = atools::geo::toDegree(std::atan2(east, north.at(i)));
+      courses[i] = course < 0.f ? course + 360.f : course;
+    }
+  }
+}
+
+float chordSqFromMeter(float distanceMeter)
+{
+  if(!(distanceMeter < map::INVALID_DISTANCE_VALUE))
+    return std::numeric_limits<float>::max();
+
+  // Half angle limited to antipode
+  double halfAngle = std::min(static_cast<double>(distanceMeter) / EARTH_RADIUS_METER / 2., M_PI / 2.);
+  double chord = 2. * std::sin(halfAngle);
+  return static_cast<float>(chord * chord);
+}
+
+float meterFromChordSq(float chordSq)
+{
+  if(!(chordSq < std::numeric_limits<float>::max()))
+    return map::INVALID_DISTANCE_VALUE;
+
+  double halfChord = std::min(std::sqrt(static_cast<double>(std::max(chordSq, 0.f))) / 2., 1.);
+  return static_cast<float>(2. * std::asin(halfChord) * EARTH_RADIUS_METER);
+}
+
+} // namespace geobatch
@@ -0,0 +1,82 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+#ifndef LNM_GEOBATCH_H
+#define LNM_GEOBATCH_H
+
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class Pos;
+}
+}
+
+namespace geobatch {
+
+/*
+ * List of positions stored as unit vectors on the sphere in struct of arrays layout.
+ * Allows to calculate great circle distances and courses from one position to many positions in one run
+ * using SSE2 or NEON vector instructions if available. A scalar fallback is used otherwise.
+ *
+ * Distances are calculated from chord lengths which are monotonic to great circle distances.
+ * Sorting and filtering by chord length avoids all trigonometric functions.
+ */
+class PosBatch
+{
+public:
+  PosBatch();
+  explicit PosBatch(int reserveSize);
+
+  void reserve(int reserveSize);
+  void clear();
+
+  /* Invalid positions result in invalid distances (map::INVALID_DISTANCE_VALUE) and courses */
+  void append(const atools::geo::Pos& pos);
+
+  int size() const
+  {
+    return x.size();
+  }
+
+  bool isEmpty() const
+  {
+    return x.isEmpty();
+  }
+
+  /* Squared chord length on the unit sphere between pos and all positions. Monotonic to the distance. */
+  void chordsSq(QVector<float>& chords, const atools::geo::Pos& pos) const;
+
+  /* Great circle distances in meter from pos to all positions */
+  void distancesMeter(QVector<float>& distances, const atools::geo::Pos& pos) const;
+
+  /* Initial great circle course in degree true from pos to all positions. Result is normalized to 0 to 360. */
+  void coursesDeg(QVector<float>& courses, const atools::geo::Pos& pos) const;
+
+private:
+  /* Unit vector components */
+  QVector<float> x, y, z;
+};
+
+/* Converts a distance to a squared chord on the unit sphere for filtering by chordsSq() */
+float chordSqFromMeter(float distanceMeter);
+
+/* Converts a squared chord on the unit sphere back to a great circle distance */
+float meterFromChordSq(float chordSq);
+
+} // namespace geobatch
+
+#endif // LNM_GEOBATCH_H
@@ -47,6 +47,7 @@
 #include "query/airwaytrackquery.h"
 #include "query/infoquery.h"
 #include "query/mapquery.h"
+#include "query/neareststore.h"
 #include "query/waypointtrackquery.h"
 #include "route/route.h"
 #include "route/routealtitude.h"
@@ -65,6 +66,8 @@
 
 // Use % to concatenate strings faster than +
 #include <QStringBuilder>
+#include <QThread>
+#include <QCoreApplication>
 
 using namespace map;
 using atools::sql::SqlRecord;
@@ -90,10 +93,10 @@ namespace ahtml = atools::util::html;
 namespace ageo = atools::geo;
 
 // Limits for nearest airports and navaids to airport
-const float NEAREST_MAX_DISTANCE_AIRPORT_NM = 75.f;
-const float NEAREST_MAX_DISTANCE_NAVAID_NM = 50.f;
-const int NEAREST_MAX_NUM_AIRPORT = 10;
-const int NEAREST_MAX_NUM_NAVAID = 15;
+const float NEAREST_MAX_DISTANCE_AIRPORT_NM = NearestStore::MAX_DISTANCE_AIRPORT_NM;
+const float NEAREST_MAX_DISTANCE_NAVAID_NM = NearestStore::MAX_DISTANCE_NAVAID_NM;
+const int NEAREST_MAX_NUM_AIRPORT = NearestStore::MAX_NUM_AIRPORT;
+const int NEAREST_MAX_NUM_NAVAID = NearestStore::MAX_NUM_NAVAID;
 
 // Print weather time in red or orange if older than this
 const qint64 WEATHER_MAX_AGE_HOURS_WARN = 3;
@@ -552,18 +555,44 @@ void HtmlInfoBuilder::nearestText(const MapAirport& airport, HtmlBuilder& html)
     if(!print)
       airportTitle(airport, html, -1, true /* procedures */);
 
+    // Use precomputed lists if available ====================================
+    MapQuery *mapQuery = mapWidget->getMapQuery();
+    QVector<int> nearestAirportIds;
+    QVector<map::MapRef> nearestNavaidRefs;
+    MapResultIndex storedAirportsNav, storedNavaids;
+    bool stored = NavApp::getNearestStore()->getNearest(mapQuery->getAirportNav(airport).id, nearestAirportIds, nearestNavaidRefs);
+
+    if(stored)
+    {
+      MapResult result;
+      for(int id : qAsConst(nearestAirportIds))
+      {
+        MapAirport ap;
+        airportQueryNav->getAirportById(ap, id);
+        if(ap.isValid())
+          result.airports.append(ap);
+      }
+      storedAirportsNav.add(result).sort(airport.position);
+
+      result.clear();
+      for(const map::MapRef& ref : qAsConst(nearestNavaidRefs))
+        mapQuery->getMapObjectById(result, ref.objType, map::AIRSPACE_SRC_NONE, ref.id, true /* airportFromNavDatabase */);
+      storedNavaids.add(result).sort(airport.position);
+    }
+
     // Get nearest airports that have procedures ====================================
-    const MapResultIndex *nearestAirportsNav =
-      airportQueryNav->getNearestProcAirports(airport.position, airport.ident, NEAREST_MAX_DISTANCE_AIRPORT_NM);
+    const MapResultIndex *nearestAirportsNav = stored ? &storedAirportsNav :
+                                               airportQueryNav->getNearestProcAirports(airport.position, airport.ident,
+                                                                                       NEAREST_MAX_DISTANCE_AIRPORT_NM);
 
     if(!nearestMapObjectsText(airport, html, nearestAirportsNav, tr("Nearest Airports with Procedures"), false, true,
                               NEAREST_MAX_NUM_AIRPORT))
       html.p().b(tr("No airports with procedures within a radius of %1.").arg(Unit::distNm(NEAREST_MAX_DISTANCE_AIRPORT_NM * 4.f))).pEnd();
 
     // Get nearest VOR and NDB ====================================
-    MapResultIndex *nearestNavaids =
-      mapWidget->getMapQuery()->getNearestNavaids(airport.position, NEAREST_MAX_DISTANCE_NAVAID_NM,
-                                                  map::VOR | map::NDB | map::ILS, 3 /* maxIls */, 4.f /* maxIlsDistNm */);
+    const MapResultIndex *nearestNavaids =
+      stored ? &storedNavaids : mapQuery->getNearestNavaids(airport.position, NEAREST_MAX_DISTANCE_NAVAID_NM,
+                                                            map::VOR | map::NDB | map::ILS, 3 /* maxIls */, 4.f /* maxIlsDistNm */);
 
     if(!nearestMapObjectsText(airport, html, nearestNavaids, tr("Nearest Radio Navaids"), true, false, NEAREST_MAX_NUM_NAVAID))
       html.p().b(tr("No navaids within a radius of %1.").arg(Unit::distNm(NEAREST_MAX_DISTANCE_NAVAID_NM * 4.f))).pEnd();
@@ -4769,10 +4798,30 @@ void HtmlInfoBuilder::aircraftProgressText(const atools::fs::sc::SimConnectAircr
     html.tableEndIf();
   }
 
-  if(longDisplay && html.isIdSet(pid::POS_COORDINATES))
+  if(longDisplay && (html.isIdSet(pid::POS_COORDINATES) || html.isIdSet(pid::POS_AIRSPACES)))
   {
     head(html, tr("Position"));
-    addCoordinates(aircraft.getPosition(), html);
+    html.table();
+    if(html.isIdSet(pid::POS_COORDINATES))
+      addCoordinates(aircraft.getPosition(), html);
+
+    // Airspace queries are not thread safe - skip for web server threads
+    if(html.isIdSet(pid::POS_AIRSPACES) && QThread::currentThread() == QCoreApplication::instance()->thread())
+    {
+      AirspaceController *airspaceController = NavApp::getAirspaceController();
+      map::MapAirspaceFilter filter(map::AIRSPACE_ALL, map::AIRSPACE_FLAG_DEFAULT, map::MapAirspaceFilter::MIN_AIRSPACE_ALT,
+                                    map::MapAirspaceFilter::MAX_AIRSPACE_ALT);
+      const QList<map::MapAirspace> airspaces =
+        airspaceController->getAirspacesAtPos(aircraft.getPosition(), aircraft.getActualAltitudeFt(), filter,
+                                              airspaceController->getAirspaceSources());
+
+      QStringList names;
+      for(const map::MapAirspace& airspace : airspaces)
+        names.append(map::airspaceName(airspace) % tr(" (") % map::airspaceTypeToString(airspace.type) % tr(")"));
+
+      html.id(pid::POS_AIRSPACES).row2(tr("Airspaces:"), names.isEmpty() ? tr("None") : names.join(tr("<br/>")),
+                                       ahtml::NO_ENTITIES);
+    }
     html.tableEnd();
   }
   html.row2AlignRight(false);
@@ -114,8 +114,9 @@ enum ProgressConfId
 
   // "Position" =================================
   POS_COORDINATES = 200,
+  POS_AIRSPACES,
 
-  LAST = POS_COORDINATES, /* Last field to determine bit array size */
+  LAST = POS_AIRSPACES, /* Last field to determine bit array size */
 
   /* Maximum is HtmlBuilder::MAX_ID (512) ==================================== */
 };
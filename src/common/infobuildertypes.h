@@ -20,11 +20,17 @@
 
 
 #include "common/maptypes.h"
+#include "common/memoryregistry.h"
 #include "fs/sc/simconnectdata.h"
+#include "web/webmetrics.h"
 
 #include <QObject>
 
 class Route;
+class PaintStatistics;
+struct AirspaceLegResult;
+
+namespace rs { struct BatchResult; }
 
 namespace map { class WeatherContext; }
 namespace atools {
@@ -88,6 +94,58 @@ namespace InfoBuilderTypes {
         const qreal distanceWeb;
     };
 
+    /**
+     * @brief Data container for map painter timing statistics
+     */
+    struct PaintStatisticsData{
+        const PaintStatistics* statisticsUi;
+        const PaintStatistics* statisticsWeb;
+    };
+
+    /**
+     * @brief Data container for web server request metrics
+     */
+    struct WebMetricsData{
+        const QVector<WebMetrics::Stat> stats;
+        const int activeRequests;
+        const int maxActiveRequests;
+        const int minThreads;
+        const int maxThreads;
+        const int keepAliveMs;
+        const int renderQueueDepth;
+        const int renderQueueMaxDepth;
+        const int renderTimeouts;
+    };
+
+    /**
+     * @brief Data container for estimated memory usage of registered caches
+     */
+    struct MemoryUsageData{
+        const QVector<memreg::Usage> usage;
+        const qint64 residentBytes;
+        const qint64 cacheBudgetBytes;
+        const qint64 residentBudgetBytes;
+        const int evictionRuns;
+        const int evictedOwners;
+    };
+
+    /**
+     * @brief Data container for route description batch results
+     */
+    struct RouteBatchData{
+        const QVector<rs::BatchResult>* results;
+        const bool benchmark;
+    };
+
+    /**
+     * @brief Data container for airspaces along the flight plan
+     */
+    struct RouteAirspacesData{
+        const Route* route;
+        const QVector<AirspaceLegResult>* results;
+        const float corridorNm;
+    };
+
     /**
      * @brief Data container for map features data
      */
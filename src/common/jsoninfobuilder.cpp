@@ -17,10 +17,16 @@
 
 #include "common/jsoninfobuilder.h"
 #include "common/infobuildertypes.h"
+#include "airspace/airspacecontroller.h"
+#include "mappainter/paintstatistics.h"
+#include "route/route.h"
+#include "routestring/routestringbatch.h"
 
 #include "sql/sqlrecord.h"
 #include "weather/weathercontext.h"
 
+#include <cmath>
+
 using InfoBuilderTypes::AirportInfoData;
 
 JsonInfoBuilder::JsonInfoBuilder(QObject *parent)
@@ -34,6 +40,175 @@ JsonInfoBuilder::~JsonInfoBuilder()
 
 }
 
+namespace internal {
+
+/*
+ * Minimal JSON writer appending directly to a byte array. Caller is responsible for proper nesting
+ * and the order of keys and values.
+ */
+class JsonWriter
+{
+public:
+    explicit JsonWriter(QByteArray& bufferParam)
+      : buffer(bufferParam)
+    {
+    }
+
+    void beginObject()
+    {
+        separator();
+        buffer.append('{');
+        needComma = false;
+    }
+
+    void endObject()
+    {
+        buffer.append('}');
+        needComma = true;
+    }
+
+    void beginArray()
+    {
+        separator();
+        buffer.append('[');
+        needComma = false;
+    }
+
+    void endArray()
+    {
+        buffer.append(']');
+        needComma = true;
+    }
+
+    void key(const char *name)
+    {
+        separator();
+        buffer.append('"').append(name).append("\":");
+        needComma = false;
+    }
+
+    void value(const QString& str)
+    {
+        separator();
+        string(str.toUtf8());
+        needComma = true;
+    }
+
+    void value(int number)
+    {
+        separator();
+        buffer.append(QByteArray::number(number));
+        needComma = true;
+    }
+
+    void value(quint64 number)
+    {
+        separator();
+        buffer.append(QByteArray::number(number));
+        needComma = true;
+    }
+
+    void value(float number)
+    {
+        separator();
+        if(std::isfinite(number))
+            // Nine significant digits are enough to restore the float value
+            buffer.append(QByteArray::number(static_cast<double>(number), 'g', 9));
+        else
+            buffer.append("null");
+        needComma = true;
+    }
+
+private:
+    void separator()
+    {
+        if(needComma)
+            buffer.append(',');
+    }
+
+    void string(const QByteArray& utf8)
+    {
+        static const char HEX[] = "0123456789abcdef";
+
+        buffer.append('"');
+        for(char c : utf8)
+        {
+            switch(c)
+            {
+                case '"':
+                    buffer.append("\\\"");
+                    break;
+                case '\\':
+                    buffer.append("\\\\");
+                    break;
+                case '\n':
+                    buffer.append("\\n");
+                    break;
+                case '\r':
+                    buffer.append("\\r");
+                    break;
+                case '\t':
+                    buffer.append("\\t");
+                    break;
+                case '\b':
+                    buffer.append("\\b");
+                    break;
+                case '\f':
+                    buffer.append("\\f");
+                    break;
+                default:
+                    if(static_cast<unsigned char>(c) < 0x20)
+                        buffer.append("\\u00").append(HEX[(c >> 4) & 0xf]).append(HEX[c & 0xf]);
+                    else
+                        buffer.append(c);
+            }
+        }
+        buffer.append('"');
+    }
+
+    QByteArray& buffer;
+    bool needComma = false;
+};
+
+}
+
+/* Write count and result array for one feature type. extraFunc adds type specific keys. */
+template<typename TYPE, typename FUNC>
+void JsonInfoBuilder::writeFeatureList(internal::JsonWriter& writer, const QList<TYPE>& features, map::MapType type,
+                                       const FUNC& extraFunc) const
+{
+    writer.beginObject();
+    writer.key("count");
+    writer.value(features.size());
+    writer.key("result");
+    writer.beginArray();
+    for(const TYPE& feature : features)
+    {
+        QMap<QString, float> coordinates = getCoordinates(feature.position);
+
+        writer.beginObject();
+        writer.key("elevation");
+        writer.value(feature.getAltitude());
+        writer.key("ident");
+        writer.value(feature.ident);
+        extraFunc(writer, feature);
+        writer.key("object_id");
+        writer.value(feature.id);
+        writer.key("position");
+        writer.beginObject();
+        writer.key("lat");
+        writer.value(coordinates.value("lat"));
+        writer.key("lon");
+        writer.value(coordinates.value("lon"));
+        writer.endObject();
+        writer.key("type_id");
+        writer.value(static_cast<quint64>(type));
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
 JSON JsonInfoBuilder::coordinatesToJSON(QMap<QString,float> map) const
 {
     return {
@@ -333,223 +508,242 @@ QByteArray JsonInfoBuilder::uiinfo(UiInfoData uiInfoData) const
     return json.dump().data();
 }
 
-QByteArray JsonInfoBuilder::features(MapFeaturesData mapFeaturesData) const
+QByteArray JsonInfoBuilder::paintstatistics(PaintStatisticsData paintStatisticsData) const
 {
 
-    MapFeaturesData data = mapFeaturesData;
+    PaintStatisticsData data = paintStatisticsData;
 
     JSON json;
 
        json = {
-           { "airports", JSON::object() },
-           { "ndbs", JSON::object() },
-           { "vors", JSON::object() },
-           { "markers", JSON::object() },
-           { "waypoints", JSON::object() },
+           { "histogram_limits_ms", paintstat::HISTOGRAM_LIMITS_MS.toStdVector() },
+           { "ui", paintStatisticsToJSON(data.statisticsUi) },
+           { "web", paintStatisticsToJSON(data.statisticsWeb) },
        };
 
-       json["airports"].push_back({ "count", data.airports.count() });
-       json["airports"].push_back({ "result", JSON::array() });
-
-       json["ndbs"].push_back({ "count", data.ndbs.count() });
-       json["ndbs"].push_back({ "result", JSON::array() });
-
-       json["vors"].push_back({ "count", data.vors.count() });
-       json["vors"].push_back({ "result", JSON::array() });
-
-       json["markers"].push_back({ "count", data.markers.count() });
-       json["markers"].push_back({ "result", JSON::array() });
-
-       json["waypoints"].push_back({ "count", data.waypoints.count() });
-       json["waypoints"].push_back({ "result", JSON::array() });
-
-
-
-       for(int i = 0; i < data.airports.count(); ++i){
-
-           map::MapAirport airport =  data.airports[i];
-
-           json["airports"]["result"][i]["object_id"] = airport.id;
-           json["airports"]["result"][i]["type_id"] = map::AIRPORT;
-           json["airports"]["result"][i]["ident"] = qUtf8Printable(airport.ident);
-           json["airports"]["result"][i]["name"] = qUtf8Printable(airport.name);
-           json["airports"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(airport.position));
-           json["airports"]["result"][i]["elevation"] =  airport.getAltitude();
-
-//           JSON airportJson;
-
-//           airportJson = {
-//               { "ident", qUtf8Printable(airport.ident) },
-//               { "name", qUtf8Printable(airport.name)},
-//               { "position", coordinatesToJSON(getCoordinates(airport.position))},
-//               { "elevation", airport.getPosition().getAltitude() },
-//           };
-
-//           json["airports"]["result"].push_back(airportJson);
-       }
-
-       for(int i = 0; i < data.ndbs.count(); ++i){
-
-           map::MapNdb ndb =  data.ndbs[i];
-
-           json["ndbs"]["result"][i]["object_id"] = ndb.id;
-           json["ndbs"]["result"][i]["type_id"] = map::NDB;
-           json["ndbs"]["result"][i]["ident"] = qUtf8Printable(ndb.ident);
-           json["ndbs"]["result"][i]["name"] = qUtf8Printable(ndb.name);
-           json["ndbs"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(ndb.position));
-           json["ndbs"]["result"][i]["elevation"] =  ndb.getAltitude();
-
-       }
-
-       for(int i = 0; i < data.vors.count(); ++i){
-
-           map::MapVor vor =  data.vors[i];
-
-           json["vors"]["result"][i]["object_id"] = vor.id;
-           json["vors"]["result"][i]["type_id"] = map::VOR;
-           json["vors"]["result"][i]["ident"] = qUtf8Printable(vor.ident);
-           json["vors"]["result"][i]["name"] = qUtf8Printable(vor.name);
-           json["vors"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(vor.position));
-           json["vors"]["result"][i]["elevation"] =  vor.getAltitude();
-
-       }
-
-       for(int i = 0; i < data.markers.count(); ++i){
-
-           map::MapMarker marker =  data.markers[i];
-
-           json["markers"]["result"][i]["object_id"] = marker.id;
-           json["markers"]["result"][i]["type_id"] = map::MARKER;
-           json["markers"]["result"][i]["ident"] = qUtf8Printable(marker.ident);
-           json["markers"]["result"][i]["type"] = qUtf8Printable(marker.type);
-           json["markers"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(marker.position));
-           json["markers"]["result"][i]["elevation"] =  marker.getAltitude();
-
-       }
-
-       for(int i = 0; i < data.waypoints.count(); ++i){
-
-           map::MapWaypoint waypoint =  data.waypoints[i];
-
-           json["waypoints"]["result"][i]["object_id"] = waypoint.id;
-           json["waypoints"]["result"][i]["type_id"] = map::WAYPOINT;
-           json["waypoints"]["result"][i]["ident"] = qUtf8Printable(waypoint.ident);
-           json["waypoints"]["result"][i]["type"] = qUtf8Printable(waypoint.type);
-           json["waypoints"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(waypoint.position));
-           json["waypoints"]["result"][i]["elevation"] =  waypoint.getAltitude();
-
-       }
-
     return json.dump().data();
-
 }
 
-QByteArray JsonInfoBuilder::feature(MapFeaturesData mapFeaturesData) const
+QByteArray JsonInfoBuilder::webmetrics(WebMetricsData webMetricsData) const
 {
 
-    MapFeaturesData data = mapFeaturesData;
-
-    JSON json;
-
-       json = {
-           { "airports", JSON::object() },
-           { "ndbs", JSON::object() },
-           { "vors", JSON::object() },
-           { "markers", JSON::object() },
-           { "waypoints", JSON::object() },
-       };
+    WebMetricsData data = webMetricsData;
+
+    JSON endpoints = JSON::array();
+    for(const WebMetrics::Stat& stat : data.stats){
+        endpoints.push_back({
+            { "endpoint", stat.key.constData() },
+            { "count", stat.count },
+            { "bytes", stat.bytes },
+            { "p50_ms", stat.p50Ms },
+            { "p95_ms", stat.p95Ms },
+            { "p99_ms", stat.p99Ms },
+            { "max_ms", stat.maxMs },
+        });
+    }
 
-       json["airports"].push_back({ "count", data.airports.count() });
-       json["airports"].push_back({ "result", JSON::array() });
+    JSON json = {
+        { "active_requests", data.activeRequests },
+        { "max_active_requests", data.maxActiveRequests },
+        { "min_threads", data.minThreads },
+        { "max_threads", data.maxThreads },
+        { "keep_alive_ms", data.keepAliveMs },
+        { "render_queue_depth", data.renderQueueDepth },
+        { "render_queue_max_depth", data.renderQueueMaxDepth },
+        { "render_timeouts", data.renderTimeouts },
+        { "endpoints", endpoints },
+    };
 
-       json["ndbs"].push_back({ "count", data.ndbs.count() });
-       json["ndbs"].push_back({ "result", JSON::array() });
+    return json.dump().data();
+}
 
-       json["vors"].push_back({ "count", data.vors.count() });
-       json["vors"].push_back({ "result", JSON::array() });
+QByteArray JsonInfoBuilder::memoryusage(MemoryUsageData memoryUsageData) const
+{
 
-       json["markers"].push_back({ "count", data.markers.count() });
-       json["markers"].push_back({ "result", JSON::array() });
+    MemoryUsageData data = memoryUsageData;
 
-       json["waypoints"].push_back({ "count", data.waypoints.count() });
-       json["waypoints"].push_back({ "result", JSON::array() });
+    qint64 totalBytes = 0;
+    JSON caches = JSON::array();
+    for(const memreg::Usage& usage : data.usage){
+        caches.push_back({
+            { "group", qUtf8Printable(usage.group) },
+            { "name", qUtf8Printable(usage.name) },
+            { "bytes", usage.bytes },
+            { "count", usage.count },
+        });
+        totalBytes += usage.bytes;
+    }
 
-       for(int i = 0; i < data.airports.count(); ++i){
+    JSON json = {
+        { "total_bytes", totalBytes },
+        { "resident_bytes", data.residentBytes },
+        { "cache_budget_bytes", data.cacheBudgetBytes },
+        { "resident_budget_bytes", data.residentBudgetBytes },
+        { "eviction_runs", data.evictionRuns },
+        { "evicted_owners", data.evictedOwners },
+        { "caches", caches },
+    };
 
-           map::MapAirport airport =  data.airports[i];
+    return json.dump().data();
+}
 
-           json["airports"]["result"][i]["object_id"] = airport.id;
-           json["airports"]["result"][i]["type_id"] = map::AIRPORT;
-           json["airports"]["result"][i]["ident"] = qUtf8Printable(airport.ident);
-           json["airports"]["result"][i]["name"] = qUtf8Printable(airport.name);
-           json["airports"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(airport.position));
-           json["airports"]["result"][i]["elevation"] =  airport.getAltitude();
+QByteArray JsonInfoBuilder::routebatch(RouteBatchData routeBatchData) const
+{
 
-//           JSON airportJson;
+    RouteBatchData data = routeBatchData;
 
-//           airportJson = {
-//               { "ident", qUtf8Printable(airport.ident) },
-//               { "name", qUtf8Printable(airport.name)},
-//               { "position", coordinatesToJSON(getCoordinates(airport.position))},
-//               { "elevation", airport.getPosition().getAltitude() },
-//           };
+    JSON json = {
+        { "plans", JSON::array() },
+        { "success", 0 },
+    };
 
-//           json["airports"]["result"].push_back(airportJson);
-       }
+    int success = 0;
+    for(const rs::BatchResult& result : *data.results)
+    {
+        JSON plan = {
+            { "route", qUtf8Printable(result.routeString) },
+            { "success", result.success },
+            { "entries", result.numEntries },
+            { "messages", JSON::array() },
+        };
 
-       for(int i = 0; i < data.ndbs.count(); ++i){
+        if(!result.filename.isEmpty())
+            plan["file"] = qUtf8Printable(result.filename);
 
-           map::MapNdb ndb =  data.ndbs[i];
+        for(const QString& message : result.messages)
+            plan["messages"].push_back(qUtf8Printable(message));
 
-           json["ndbs"]["result"][i]["object_id"] = ndb.id;
-           json["ndbs"]["result"][i]["type_id"] = map::NDB;
-           json["ndbs"]["result"][i]["ident"] = qUtf8Printable(ndb.ident);
-           json["ndbs"]["result"][i]["name"] = qUtf8Printable(ndb.name);
-           json["ndbs"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(ndb.position));
-           json["ndbs"]["result"][i]["elevation"] =  ndb.getAltitude();
+        if(data.benchmark)
+        {
+            plan["parse_ms"] = result.parseMs;
+            plan["resolve_ms"] = result.resolveMs;
+            plan["write_ms"] = result.writeMs;
+        }
 
-       }
+        if(result.success)
+            success++;
 
-       for(int i = 0; i < data.vors.count(); ++i){
+        json["plans"].push_back(plan);
+    }
+    json["success"] = success;
 
-           map::MapVor vor =  data.vors[i];
+    return json.dump().data();
+}
 
-           json["vors"]["result"][i]["object_id"] = vor.id;
-           json["vors"]["result"][i]["type_id"] = map::VOR;
-           json["vors"]["result"][i]["ident"] = qUtf8Printable(vor.ident);
-           json["vors"]["result"][i]["name"] = qUtf8Printable(vor.name);
-           json["vors"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(vor.position));
-           json["vors"]["result"][i]["elevation"] =  vor.getAltitude();
+QByteArray JsonInfoBuilder::routeairspaces(RouteAirspacesData routeAirspacesData) const
+{
 
-       }
+    RouteAirspacesData data = routeAirspacesData;
+
+    JSON airspaces = JSON::array();
+    for(const AirspaceLegResult& result : *data.results)
+    {
+        const map::MapAirspace& airspace = result.airspace;
+        airspaces.push_back({
+            { "leg", result.legIndex },
+            { "leg_ident", qUtf8Printable(data.route->value(result.legIndex).getIdent()) },
+            { "id", airspace.id },
+            { "source", qUtf8Printable(map::airspaceSourceText(airspace.src)) },
+            { "name", qUtf8Printable(map::airspaceName(airspace)) },
+            { "type", qUtf8Printable(map::airspaceTypeToString(airspace.type)) },
+            { "min_altitude_ft", airspace.minAltitude },
+            { "max_altitude_ft", airspace.maxAltitude },
+        });
+    }
 
-       for(int i = 0; i < data.markers.count(); ++i){
+    JSON json = {
+        { "corridor_nm", data.corridorNm },
+        { "airspaces", airspaces },
+    };
 
-           map::MapMarker marker =  data.markers[i];
+    return json.dump().data();
+}
 
-           json["markers"]["result"][i]["object_id"] = marker.id;
-           json["markers"]["result"][i]["type_id"] = map::MARKER;
-           json["markers"]["result"][i]["ident"] = qUtf8Printable(marker.ident);
-           json["markers"]["result"][i]["type"] = qUtf8Printable(marker.type);
-           json["markers"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(marker.position));
-           json["markers"]["result"][i]["elevation"] =  marker.getAltitude();
+JSON JsonInfoBuilder::paintStatisticsToJSON(const PaintStatistics *statistics) const
+{
+    if(statistics == nullptr)
+        return nullptr;
 
-       }
+    JSON json = {
+        { "frame", paintLayerStatisticsToJSON(statistics->getFrame()) },
+        { "painters", JSON::array() },
+    };
 
-       for(int i = 0; i < data.waypoints.count(); ++i){
+    for(const PaintLayerStatistics& stats : statistics->getLayers())
+        json["painters"].push_back(paintLayerStatisticsToJSON(stats));
 
-           map::MapWaypoint waypoint =  data.waypoints[i];
+    return json;
+}
 
-           json["waypoints"]["result"][i]["object_id"] = waypoint.id;
-           json["waypoints"]["result"][i]["type_id"] = map::WAYPOINT;
-           json["waypoints"]["result"][i]["ident"] = qUtf8Printable(waypoint.ident);
-           json["waypoints"]["result"][i]["type"] = qUtf8Printable(waypoint.type);
-           json["waypoints"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(waypoint.position));
-           json["waypoints"]["result"][i]["elevation"] =  waypoint.getAltitude();
+JSON JsonInfoBuilder::paintLayerStatisticsToJSON(const PaintLayerStatistics& stats) const
+{
+    return {
+        { "name", qUtf8Printable(stats.name) },
+        { "frames", stats.frames },
+        { "query_ms", stats.averageMs(paintstat::QUERY) },
+        { "projection_ms", stats.averageMs(paintstat::PROJECTION) },
+        { "draw_ms", stats.averageMs(paintstat::DRAW) },
+        { "total_ms", stats.averageTotalMs() },
+        { "last_ms", stats.lastTotalMs() },
+        { "max_ms", stats.maxMs },
+        { "objects", stats.averageObjects() },
+        { "last_objects", stats.lastObjects },
+        { "histogram", stats.histogram.toStdVector() },
+    };
+}
 
-       }
+QByteArray JsonInfoBuilder::features(MapFeaturesData mapFeaturesData) const
+{
+    return featuresToJSON(mapFeaturesData);
+}
 
-    return json.dump().data();
+QByteArray JsonInfoBuilder::feature(MapFeaturesData mapFeaturesData) const
+{
+    return featuresToJSON(mapFeaturesData);
+}
 
+QByteArray JsonInfoBuilder::featuresToJSON(const MapFeaturesData& data) const
+{
+    // Written directly into the buffer without building a JSON tree first
+    int count = data.airports.size() + data.ndbs.size() + data.vors.size() + data.markers.size() + data.waypoints.size();
+
+    QByteArray buffer;
+    buffer.reserve(200 + count * 150);
+    internal::JsonWriter writer(buffer);
+
+    writer.beginObject();
+
+    writer.key("airports");
+    writeFeatureList(writer, data.airports, map::AIRPORT, [](internal::JsonWriter& w, const map::MapAirport& airport) {
+        w.key("name");
+        w.value(airport.name);
+    });
+
+    writer.key("markers");
+    writeFeatureList(writer, data.markers, map::MARKER, [](internal::JsonWriter& w, const map::MapMarker& marker) {
+        w.key("type");
+        w.value(marker.type);
+    });
+
+    writer.key("ndbs");
+    writeFeatureList(writer, data.ndbs, map::NDB, [](internal::JsonWriter& w, const map::MapNdb& ndb) {
+        w.key("name");
+        w.value(ndb.name);
+    });
+
+    writer.key("vors");
+    writeFeatureList(writer, data.vors, map::VOR, [](internal::JsonWriter& w, const map::MapVor& vor) {
+        w.key("name");
+        w.value(vor.name);
+    });
+
+    writer.key("waypoints");
+    writeFeatureList(writer, data.waypoints, map::WAYPOINT, [](internal::JsonWriter& w, const map::MapWaypoint& waypoint) {
+        w.key("type");
+        w.value(waypoint.type);
+    });
+
+    writer.endObject();
+    return buffer;
 }
 
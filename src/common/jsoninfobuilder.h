@@ -19,11 +19,18 @@
 #define JSONINFOBUILDER_H
 
 #include "common/abstractinfobuilder.h"
+#include "common/mapflags.h"
 
 // Use JSON library
 #include "json/nlohmann/json.hpp"
 using JSON = nlohmann::json;
 
+struct PaintLayerStatistics;
+
+namespace internal {
+class JsonWriter;
+}
+
 /**
  * Builder for JSON representations of supplied data. All
  * usable methods must be declared at AbstractInfoBuilder
@@ -41,11 +48,25 @@ public:
   QByteArray airport(AirportInfoData airportInfoData) const override;
   QByteArray siminfo(SimConnectInfoData simConnectInfoData) const override;
   QByteArray uiinfo(UiInfoData uiInfoData) const override;
+  QByteArray paintstatistics(PaintStatisticsData paintStatisticsData) const override;
+  QByteArray webmetrics(WebMetricsData webMetricsData) const override;
+  QByteArray memoryusage(MemoryUsageData memoryUsageData) const override;
+  QByteArray routebatch(RouteBatchData routeBatchData) const override;
+  QByteArray routeairspaces(RouteAirspacesData routeAirspacesData) const override;
   QByteArray features(MapFeaturesData mapFeaturesData) const override;
   QByteArray feature(MapFeaturesData mapFeaturesData) const override;
 
 private:
   JSON coordinatesToJSON(QMap<QString,float> map) const;
+  JSON paintStatisticsToJSON(const PaintStatistics *statistics) const;
+  JSON paintLayerStatisticsToJSON(const PaintLayerStatistics& stats) const;
+
+  /* Streams airports, navaids and waypoints into a byte array. Used by features() and feature(). */
+  QByteArray featuresToJSON(const InfoBuilderTypes::MapFeaturesData& data) const;
+
+  template<typename TYPE, typename FUNC>
+  void writeFeatureList(internal::JsonWriter& writer, const QList<TYPE>& features, map::MapType type,
+                        const FUNC& extraFunc) const;
 };
 
 #endif // JSONINFOBUILDER_H
@@ -17,8 +17,11 @@
 
 #include "common/mapresult.h"
 
+#include "common/geobatch.h"
 #include "geo/calculations.h"
 
+#include <numeric>
+
 namespace map {
 
 MapResult& MapResult::clear(const MapTypes& types)
@@ -123,6 +126,49 @@ MapResult& MapResult::clear(const MapTypes& types)
   return *this;
 }
 
+MapResult& MapResult::reset()
+{
+  resetList(airports);
+  resetSet(airportIds);
+  resetList(runways);
+  resetList(runwayEnds);
+  resetList(towers);
+  resetList(parkings);
+  resetList(helipads);
+  resetList(waypoints);
+  resetSet(waypointIds);
+  resetList(vors);
+  resetSet(vorIds);
+  resetList(ndbs);
+  resetSet(ndbIds);
+  resetList(markers);
+  resetList(ils);
+  resetList(airways);
+  resetList(airspaces);
+  resetList(userpointsRoute);
+  resetList(userpoints);
+  resetSet(userpointIds);
+  resetList(logbookEntries);
+  userAircraft.clear();
+  resetList(aiAircraft);
+  resetList(onlineAircraft);
+  resetSet(onlineAircraftIds);
+  windPos = atools::geo::EMPTY_POS;
+  resetList(patternMarks);
+  resetList(rangeMarks);
+  resetList(distanceMarks);
+  resetList(holdingMarks);
+  resetList(msaMarks);
+  resetList(holdings);
+  resetSet(holdingIds);
+  resetList(airportMsa);
+  resetSet(airportMsaIds);
+  resetList(procPoints);
+  trailSegment = map::AircraftTrailSegment();
+  trailSegmentLog = map::AircraftTrailSegment();
+  return *this;
+}
+
 template<typename TYPE>
 void MapResult::removeInvalid(QList<TYPE>& list, QSet<int> *ids)
 {
@@ -1056,36 +1102,40 @@ MapResultIndex& MapResultIndex::sort(const atools::geo::Pos& pos, bool sortNearT
     // Nothing to sort
     return *this;
 
-  std::sort(begin(), end(), [pos, sortNearToFar](const MapBase *obj1, const MapBase *obj2) -> bool
-    {
-      float dist1, dist2;
-      atools::geo::LineDistance lineDist;
+  // Calculate all distances to center positions in one batch
+  geobatch::PosBatch batch(size());
+  for(const MapBase *obj : qAsConst(*this))
+    batch.append(obj->getPosition());
 
-      const map::MapRunway *rw = obj1->asPtr<map::MapRunway>();
-      if(rw != nullptr)
-      {
-        // Distance to runway line
-        pos.distanceMeterToLine(rw->primaryPosition, rw->secondaryPosition, lineDist);
-        dist1 = std::abs(lineDist.distance);
-      }
-      else
-        // Distance to center position
-        dist1 = obj1->getPosition().distanceMeterTo(pos);
+  QVector<float> distances;
+  batch.distancesMeter(distances, pos);
 
-      rw = obj2->asPtr<map::MapRunway>();
-      if(rw != nullptr)
-      {
-        // Distance to runway line
-        pos.distanceMeterToLine(rw->primaryPosition, rw->secondaryPosition, lineDist);
-        dist2 = std::abs(lineDist.distance);
-      }
-      else
-        // Distance to center position
-        dist2 = obj2->getPosition().distanceMeterTo(pos);
+  for(int i = 0; i < size(); i++)
+  {
+    const map::MapRunway *rw = at(i)->asPtr<map::MapRunway>();
+    if(rw != nullptr)
+    {
+      // Distance to runway line
+      atools::geo::LineDistance lineDist;
+      pos.distanceMeterToLine(rw->primaryPosition, rw->secondaryPosition, lineDist);
+      distances[i] = std::abs(lineDist.distance);
+    }
+  }
 
+  QVector<int> indexes(size());
+  std::iota(indexes.begin(), indexes.end(), 0);
+  std::sort(indexes.begin(), indexes.end(), [&distances, sortNearToFar](int index1, int index2) -> bool
+    {
+      float dist1 = distances.at(index1), dist2 = distances.at(index2);
       return sortNearToFar ? dist1<dist2 : dist1> dist2;
     });
 
+  QVector<const map::MapBase *> sorted;
+  sorted.reserve(size());
+  for(int index : indexes)
+    sorted.append(at(index));
+  QVector<const map::MapBase *>::swap(sorted);
+
   return *this;
 }
 
@@ -1094,15 +1144,24 @@ MapResultIndex& MapResultIndex::remove(const atools::geo::Pos& pos, float maxDis
   if(isEmpty() || !pos.isValid())
     return *this;
 
-  float maxMeter = atools::geo::nmToMeter(maxDistanceNm);
+  geobatch::PosBatch batch(size());
+  for(const MapBase *obj : qAsConst(*this))
+    batch.append(obj->position);
 
-  auto it = std::remove_if(begin(), end(), [maxMeter, &pos](const MapBase *obj) -> bool
-    {
-      return obj->position.distanceMeterTo(pos) > maxMeter;
-    });
+  // Compare squared chords to avoid trigonometric functions
+  QVector<float> chords;
+  batch.chordsSq(chords, pos);
+  float maxChord = geobatch::chordSqFromMeter(atools::geo::nmToMeter(maxDistanceNm));
+
+  int retained = 0;
+  for(int i = 0; i < size(); i++)
+  {
+    if(chords.at(i) <= maxChord)
+      (*this)[retained++] = at(i);
+  }
 
-  if(it != end())
-    erase(it, end());
+  if(retained < size())
+    resize(retained);
   return *this;
 }
 
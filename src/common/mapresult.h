@@ -129,6 +129,11 @@ struct MapResult
   /* Remove the given types only */
   MapResult& clear(const MapTypes& types = map::ALL);
 
+  /* Remove all objects but keep allocated memory of lists and sets for reuse.
+   * Used for results which are filled on each mouse move like tooltips.
+   * Lists shared with other copies are released instead to avoid a deep copy on detach. */
+  MapResult& reset();
+
   /* Remove all except first for the given types only */
   MapResult& clearAllButFirst(const MapTypes& types = map::ALL);
 
@@ -267,6 +272,28 @@ struct MapResult
   void removeNoRouteIndex();
 
 private:
+  /* Empty list and keep capacity if not shared */
+  template<typename TYPE>
+  static void resetList(QList<TYPE>& list)
+  {
+    if(list.isDetached())
+      list.erase(list.begin(), list.end());
+    else
+      list.clear();
+  }
+
+  /* Empty set and keep buckets if not shared. QSet::erase() does not shrink in contrast to clear() or remove(). */
+  static void resetSet(QSet<int>& set)
+  {
+    if(set.isDetached())
+    {
+      for(auto it = set.begin(); it != set.end();)
+        it = set.erase(it);
+    }
+    else
+      set.clear();
+  }
+
   template<typename TYPE>
   void clearAllButFirst(QList<TYPE>& list)
   {
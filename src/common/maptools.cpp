@@ -22,6 +22,65 @@
 
 namespace maptools {
 
+QVector<int> simplifyLineIndexes(const atools::geo::LineString& line, float toleranceDeg)
+{
+  int num = line.size();
+  QVector<int> indexes;
+  if(num < 3 || toleranceDeg <= 0.f)
+  {
+    for(int i = 0; i < num; i++)
+      indexes.append(i);
+    return indexes;
+  }
+
+  QVector<bool> keep(num, false);
+  keep[0] = keep[num - 1] = true;
+
+  QVector<std::pair<int, int> > ranges({std::make_pair(0, num - 1)});
+  while(!ranges.isEmpty())
+  {
+    std::pair<int, int> range = ranges.takeLast();
+    const atools::geo::Pos& first = line.at(range.first);
+    const atools::geo::Pos& last = line.at(range.second);
+
+    float maxDist = 0.f;
+    int maxIndex = -1;
+    for(int i = range.first + 1; i < range.second; i++)
+    {
+      const atools::geo::Pos& pos = line.at(i);
+      float dist = atools::geo::distanceToLine(pos.getLonX(), pos.getLatY(), first.getLonX(), first.getLatY(),
+                                               last.getLonX(), last.getLatY(), false /* lineDistanceOnly */);
+      if(dist > maxDist)
+      {
+        maxDist = dist;
+        maxIndex = i;
+      }
+    }
+
+    if(maxIndex != -1 && maxDist > toleranceDeg)
+    {
+      keep[maxIndex] = true;
+      ranges.append(std::make_pair(range.first, maxIndex));
+      ranges.append(std::make_pair(maxIndex, range.second));
+    }
+  }
+
+  for(int i = 0; i < num; i++)
+  {
+    if(keep.at(i))
+      indexes.append(i);
+  }
+  return indexes;
+}
+
+atools::geo::LineString simplifyLine(const atools::geo::LineString& line, float toleranceDeg)
+{
+  atools::geo::LineString simplified;
+  for(int index : simplifyLineIndexes(line, toleranceDeg))
+    simplified.append(line.at(index));
+  return simplified;
+}
+
 struct RwKey
 {
   RwKey(const RwEnd& end)
@@ -126,4 +185,68 @@ QStringList RwVector::getSortedRunways(int minHeadWind)
   return runways;
 }
 
+atools::geo::LineString simplifyLineString(const atools::geo::LineString& lineString, float toleranceDeg)
+{
+  if(lineString.size() < 3)
+    return lineString;
+
+  // Points to keep
+  QVector<bool> keep(lineString.size(), false);
+  keep[0] = keep[lineString.size() - 1] = true;
+
+  // Segments to check - avoid recursion for long boundaries
+  QVector<std::pair<int, int> > stack;
+  stack.append(std::make_pair(0, lineString.size() - 1));
+
+  while(!stack.isEmpty())
+  {
+    std::pair<int, int> segment = stack.takeLast();
+    const atools::geo::Pos& first = lineString.at(segment.first);
+    const atools::geo::Pos& last = lineString.at(segment.second);
+
+    // Use simple planar approximation with longitude scaled down by latitude
+    float lonScale = std::cos(atools::geo::toRadians((first.getLatY() + last.getLatY()) / 2.f));
+    float x1 = first.getLonX() * lonScale, y1 = first.getLatY();
+    float dx = last.getLonX() * lonScale - x1, dy = last.getLatY() - y1;
+    float lengthSq = dx * dx + dy * dy;
+
+    float maxDist = 0.f;
+    int maxIndex = -1;
+    for(int i = segment.first + 1; i < segment.second; i++)
+    {
+      const atools::geo::Pos& pos = lineString.at(i);
+      float px = pos.getLonX() * lonScale - x1, py = pos.getLatY() - y1;
+
+      float dist;
+      if(lengthSq > 0.f)
+        // Distance to line through first and last
+        dist = std::abs(px * dy - py * dx) / std::sqrt(lengthSq);
+      else
+        // First and last are equal for closed polygons - use distance to point
+        dist = std::sqrt(px * px + py * py);
+
+      if(dist > maxDist)
+      {
+        maxDist = dist;
+        maxIndex = i;
+      }
+    }
+
+    if(maxIndex != -1 && maxDist > toleranceDeg)
+    {
+      keep[maxIndex] = true;
+      stack.append(std::make_pair(segment.first, maxIndex));
+      stack.append(std::make_pair(maxIndex, segment.second));
+    }
+  }
+
+  atools::geo::LineString retval;
+  for(int i = 0; i < lineString.size(); i++)
+  {
+    if(keep.at(i))
+      retval.append(lineString.at(i));
+  }
+  return retval;
+}
+
 } // namespace maptools
@@ -21,12 +21,15 @@
 #include "common/coordinateconverter.h"
 #include "geo/calculations.h"
 #include "common/mapflags.h"
+#include "common/geobatch.h"
+#include "geo/linestring.h"
 #include "geo/pos.h"
 
 #include <QList>
 #include <QSet>
 #include <algorithm>
 #include <functional>
+#include <numeric>
 
 class CoordinateConverter;
 
@@ -110,6 +113,57 @@ float removeFarthest(const atools::geo::Pos& pos, QList<TYPE>& list)
   return closestDist;
 }
 
+/* Squared chord lengths from pos to all elements calculated in one batch. Monotonic to the distance. */
+template<typename CONTAINER>
+QVector<float> chordsSq(const CONTAINER& list, const atools::geo::Pos& pos)
+{
+  geobatch::PosBatch batch(list.size());
+  for(const auto& type : list)
+    batch.append(type.getPosition());
+
+  QVector<float> chords;
+  batch.chordsSq(chords, pos);
+  return chords;
+}
+
+/* Keep all elements closer than maxDistanceMeter comparing chords instead of distances */
+template<typename CONTAINER>
+void removeByDistanceInternal(CONTAINER& list, const atools::geo::Pos& pos, float maxDistanceMeter)
+{
+  const QVector<float> chords = chordsSq(list, pos);
+  const float maxChord = geobatch::chordSqFromMeter(maxDistanceMeter);
+
+  CONTAINER retained;
+  retained.reserve(list.size());
+  for(int i = 0; i < list.size(); i++)
+  {
+    if(chords.at(i) <= maxChord)
+      retained.append(list.at(i));
+  }
+
+  if(retained.size() != list.size())
+    list.swap(retained);
+}
+
+/* Sort elements by distance calculating each distance only once */
+template<typename CONTAINER>
+void sortByDistanceInternal(CONTAINER& list, const atools::geo::Pos& pos)
+{
+  const QVector<float> chords = chordsSq(list, pos);
+
+  QVector<int> indexes(list.size());
+  std::iota(indexes.begin(), indexes.end(), 0);
+  std::sort(indexes.begin(), indexes.end(), [&chords](int index1, int index2) -> bool {
+      return chords.at(index1) < chords.at(index2);
+    });
+
+  CONTAINER sorted;
+  sorted.reserve(list.size());
+  for(int index : indexes)
+    sorted.append(list.at(index));
+  list.swap(sorted);
+}
+
 /* Erase all elements that are farther away than maxDistanceMeter */
 template<typename TYPE>
 void removeByDistance(QList<TYPE>& list, const atools::geo::Pos& pos, int maxDistanceMeter)
@@ -117,13 +171,7 @@ void removeByDistance(QList<TYPE>& list, const atools::geo::Pos& pos, int maxDis
   if(list.isEmpty() || !pos.isValid() || !(maxDistanceMeter < map::INVALID_INDEX_VALUE))
     return;
 
-  auto it = std::remove_if(list.begin(), list.end(), [maxDistanceMeter, &pos](const TYPE& type) -> bool {
-      return type.getPosition().distanceMeterTo(pos) > maxDistanceMeter;
-    });
-
-  if(it != list.end())
-    list.erase(it, list.end());
-
+  removeByDistanceInternal(list, pos, static_cast<float>(maxDistanceMeter));
 }
 
 /* Erase all elements that are farther away than maxDistanceMeter */
@@ -133,13 +181,7 @@ void removeByDistance(QList<TYPE>& list, const atools::geo::Pos& pos, float maxD
   if(list.isEmpty() || !pos.isValid() || !(maxDistanceMeter < map::INVALID_DISTANCE_VALUE))
     return;
 
-  auto it = std::remove_if(list.begin(), list.end(), [maxDistanceMeter, &pos](const TYPE& type) -> bool {
-      return type.getPosition().distanceMeterTo(pos) > maxDistanceMeter;
-    });
-
-  if(it != list.end())
-    list.erase(it, list.end());
-
+  removeByDistanceInternal(list, pos, maxDistanceMeter);
 }
 
 /* Sorts elements by distance to a point */
@@ -167,9 +209,7 @@ void sortByDistance(QList<TYPE>& list, const atools::geo::Pos& pos)
   if(list.size() <= 1 || !pos.isValid())
     return;
 
-  std::sort(list.begin(), list.end(), [&pos](const TYPE& t1, const TYPE& t2) -> bool {
-      return t1.getPosition().distanceMeterTo(pos) < t2.getPosition().distanceMeterTo(pos);
-    });
+  sortByDistanceInternal(list, pos);
 }
 
 template<typename TYPE>
@@ -178,9 +218,7 @@ void sortByDistance(QVector<TYPE>& list, const atools::geo::Pos& pos)
   if(list.size() <= 1 || !pos.isValid())
     return;
 
-  std::sort(list.begin(), list.end(), [&pos](const TYPE& t1, const TYPE& t2) -> bool {
-      return t1.getPosition().distanceMeterTo(pos) < t2.getPosition().distanceMeterTo(pos);
-    });
+  sortByDistanceInternal(list, pos);
 }
 
 /* Sorts elements by distance to a point including simple altitude difference */
@@ -331,6 +369,11 @@ void removeDuplicatesById(QVector<TYPE>& vector)
   vector.erase(std::unique(vector.begin(), vector.end()), vector.end());
 }
 
+// ==============================================================================
+/* Simplify line string using the Douglas-Peucker algorithm. First and last point are kept.
+ * Tolerance is the maximum deviation in degree where longitude is scaled by latitude. */
+atools::geo::LineString simplifyLineString(const atools::geo::LineString& lineString, float toleranceDeg);
+
 // ==============================================================================
 /* Runway sorting tools. Allows to sort runways by headwind and crosswind */
 struct RwEnd
@@ -346,6 +389,13 @@ struct RwEnd
   int crossWind, headWind, minlength, maxlength;
 };
 
+/* Douglas-Peucker simplification in lon/lat coordinates. Returns indexes of points to keep in ascending order.
+ * Keeps first and last point. */
+QVector<int> simplifyLineIndexes(const atools::geo::LineString& line, float toleranceDeg);
+
+/* Same as above but returns the simplified line */
+atools::geo::LineString simplifyLine(const atools::geo::LineString& line, float toleranceDeg);
+
 /* List of runway ends */
 class RwVector
   : public QVector<maptools::RwEnd>
@@ -880,6 +880,13 @@ struct MapUserpoint
   bool temp = false;
 };
 
+/* Aggregated userpoints of one grid cell. Only used for drawing and not part of the screen index. */
+struct MapUserpointCluster
+{
+  atools::geo::Pos position; /* Average position of all points in the cell */
+  int count = 0;
+};
+
 // =====================================================================
 /* User aircraft wrapper */
 struct MapUserAircraft
@@ -1121,6 +1128,17 @@ struct MapAirway
 
 };
 
+/* Consecutive segments of one airway fragment merged into a polyline. Used to paint airways at low zoom
+ * levels where segments are drawn without texts or direction arrows. */
+struct MapAirwayPolyline
+{
+  map::MapAirwayTrackType type;
+  atools::geo::Rect bounding;
+
+  /* Full line at index 0 and simplified lines with increasing tolerance. See AirwayQuery::airwayPolylineLevel(). */
+  QVector<atools::geo::LineString> levels;
+};
+
 // =====================================================================
 /* Marker beacon */
 /* database id marker.marker_id */
@@ -18,6 +18,7 @@
 #include "common/maptypesfactory.h"
 
 #include "common/maptypes.h"
+#include "common/stringpool.h"
 #include "fs/common/binarymsageometry.h"
 #include "geo/calculations.h"
 #include "io/binaryutil.h"
@@ -45,7 +46,7 @@ void MapTypesFactory::fillAirport(const SqlRecord& record, map::MapAirport& airp
     airport.asosFrequency = record.valueInt("asos_frequency");
     airport.unicomFrequency = record.valueInt("unicom_frequency");
     airport.position = Pos(record.valueFloat("lonx"), record.valueFloat("laty"), record.valueFloat("altitude"));
-    airport.region = record.valueStr("region", QString());
+    airport.region = StringPool::intern(record.valueStr("region", QString()));
   }
   else
     airport.position = Pos(record.valueFloat("lonx"), record.valueFloat("laty"), 0.f);
@@ -67,7 +68,7 @@ void MapTypesFactory::fillRunway(const atools::sql::SqlRecord& record, map::MapR
 
   if(!overview)
   {
-    runway.surface = record.valueStr("surface");
+    runway.surface = StringPool::intern(record.valueStr("surface"));
     runway.shoulder = record.valueStr("shoulder", QString()); // Optional X-Plane field
     runway.primaryName = record.valueStr("primary_name");
     runway.secondaryName = record.valueStr("secondary_name");
@@ -289,19 +290,19 @@ void MapTypesFactory::fillVorBase(const SqlRecord& record, map::MapVor& vor)
 {
   vor.id = record.valueInt("vor_id");
   vor.ident = record.valueStr("ident");
-  vor.region = record.valueStr("region");
+  vor.region = StringPool::intern(record.valueStr("region"));
   vor.name = atools::capString(record.valueStr("name"));
 
   // Check also for types from the nav_search table and VORTACs
   QString type = record.valueStr("type");
   if(type == "VH" || type == "VTH")
-    vor.type = "H";
+    vor.type = QStringLiteral("H");
   else if(type == "VL" || type == "VTL")
-    vor.type = "L";
+    vor.type = QStringLiteral("L");
   else if(type == "VT" || type == "VTT")
-    vor.type = "T";
+    vor.type = QStringLiteral("T");
   else
-    vor.type = type;
+    vor.type = StringPool::intern(type);
 
   vor.tacan = type == "TC";
   vor.vortac = type.startsWith("VT");
@@ -398,9 +399,9 @@ void MapTypesFactory::fillNdb(const SqlRecord& record, map::MapNdb& ndb)
 {
   ndb.id = record.valueInt("ndb_id");
   ndb.ident = record.valueStr("ident");
-  ndb.region = record.valueStr("region");
+  ndb.region = StringPool::intern(record.valueStr("region"));
   ndb.name = atools::capString(record.valueStr("name"));
-  ndb.type = record.valueStr("type");
+  ndb.type = StringPool::intern(record.valueStr("type"));
   ndb.frequency = record.valueInt("frequency");
   ndb.range = record.valueInt("range");
   ndb.magvar = record.valueFloat("mag_var");
@@ -424,8 +425,8 @@ void MapTypesFactory::fillHelipad(const SqlRecord& record, map::MapHelipad& heli
   helipad.width = record.value("width").toInt();
   helipad.length = record.value("length").toInt();
   helipad.heading = static_cast<int>(std::roundf(record.value("heading").toFloat()));
-  helipad.surface = record.value("surface").toString();
-  helipad.type = record.value("type").toString();
+  helipad.surface = StringPool::intern(record.value("surface").toString());
+  helipad.type = StringPool::intern(record.value("type").toString());
   helipad.transparent = record.value("is_transparent").toInt() > 0;
   helipad.closed = record.value("is_closed").toInt() > 0;
 }
@@ -434,9 +435,9 @@ void MapTypesFactory::fillWaypoint(const SqlRecord& record, map::MapWaypoint& wa
 {
   waypoint.id = record.valueInt(track ? "trackpoint_id" : "waypoint_id");
   waypoint.ident = record.valueStr("ident");
-  waypoint.region = record.valueStr("region");
-  waypoint.type = record.valueStr("type");
-  waypoint.arincType = record.valueStr("arinc_type", QString());
+  waypoint.region = StringPool::intern(record.valueStr("region"));
+  waypoint.type = StringPool::intern(record.valueStr("type"));
+  waypoint.arincType = StringPool::intern(record.valueStr("arinc_type", QString()));
   waypoint.magvar = record.valueFloat("mag_var");
   waypoint.hasVictorAirways = record.valueInt("num_victor_airway") > 0;
   waypoint.hasJetAirways = record.valueInt("num_jet_airway") > 0;
@@ -449,9 +450,9 @@ void MapTypesFactory::fillWaypointFromNav(const SqlRecord& record, map::MapWaypo
 {
   waypoint.id = record.valueInt("waypoint_id");
   waypoint.ident = record.valueStr("ident");
-  waypoint.region = record.valueStr("region");
-  waypoint.type = record.valueStr("type");
-  waypoint.arincType = record.valueStr("arinc_type", QString());
+  waypoint.region = StringPool::intern(record.valueStr("region"));
+  waypoint.type = StringPool::intern(record.valueStr("type"));
+  waypoint.arincType = StringPool::intern(record.valueStr("arinc_type", QString()));
   waypoint.magvar = record.valueFloat("mag_var");
   waypoint.hasVictorAirways = record.valueInt("waypoint_num_victor_airway") > 0;
   waypoint.hasJetAirways = record.valueInt("waypoint_num_jet_airway") > 0;
@@ -557,7 +558,7 @@ void MapTypesFactory::fillAirwayOrTrack(const SqlRecord& record, map::MapAirway&
 void MapTypesFactory::fillMarker(const SqlRecord& record, map::MapMarker& marker)
 {
   marker.id = record.valueInt("marker_id");
-  marker.type = record.valueStr("type");
+  marker.type = StringPool::intern(record.valueStr("type"));
   marker.ident = record.valueStr("ident");
   marker.heading = static_cast<int>(std::round(record.valueFloat("heading")));
   marker.position = Pos(record.valueFloat("lonx"),
@@ -572,7 +573,7 @@ void MapTypesFactory::fillIls(const SqlRecord& record, map::MapIls& ils, float r
   ils.runwayName = record.valueStr("loc_runway_name");
   ils.ident = record.valueStr("ident");
   ils.name = record.valueStr("name");
-  ils.region = record.valueStr("region", QString());
+  ils.region = StringPool::intern(record.valueStr("region", QString()));
 
   ils.type = static_cast<map::IlsType>(atools::strToChar(record.valueStr("type", QString())));
   ils.perfIndicator = record.valueStr("perf_indicator", QString());
@@ -692,7 +693,7 @@ void MapTypesFactory::fillAirportMsa(const atools::sql::SqlRecord& record, map::
   airportMsa.id = record.valueInt("airport_msa_id");
   airportMsa.airportIdent = record.valueStr("airport_ident");
   airportMsa.navIdent = record.valueStr("nav_ident");
-  airportMsa.region = record.valueStr("region");
+  airportMsa.region = StringPool::intern(record.valueStr("region"));
   airportMsa.multipleCode = record.valueStr("multiple_code");
 
   airportMsa.vorType = record.valueStr("vor_type");
@@ -722,7 +723,7 @@ void MapTypesFactory::fillParking(const SqlRecord& record, map::MapParking& park
 {
   parking.id = record.valueInt("parking_id");
   parking.airportId = record.valueInt("airport_id");
-  parking.type = record.valueStr("type");
+  parking.type = StringPool::intern(record.valueStr("type"));
   parking.name = record.valueStr("name");
   parking.suffix = record.valueStr("suffix", QString());
   parking.airlineCodes = record.valueStr("airline_codes");
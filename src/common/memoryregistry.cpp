@@ -0,0 +1,223 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "common/memoryregistry.h"
+
+#include "common/constants.h"
+#include "settings/settings.h"
+#include "util/htmlbuilder.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QLocale>
+#include <QTextStream>
+
+#include <algorithm>
+#include <functional>
+
+#if defined(Q_OS_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#elif defined(Q_OS_LINUX)
+#include <unistd.h>
+#endif
+
+namespace memreg {
+
+struct Owner
+{
+  const void *owner;
+  memreg::ReportFunc report;
+  memreg::EvictFunc evict;
+};
+
+static QVector<Owner> owners;
+static int numEvictionRuns = 0, numEvictedOwners = 0;
+
+static double toMb(qint64 bytes)
+{
+  return bytes / 1048576.;
+}
+
+static qint64 totalBytes(const QVector<memreg::Usage>& usages)
+{
+  qint64 total = 0L;
+  for(const memreg::Usage& usage : usages)
+    total += usage.bytes;
+  return total;
+}
+
+}
+
+void MemoryRegistry::registerCaches(const void *owner, const memreg::ReportFunc& report, const memreg::EvictFunc& evict)
+{
+  memreg::owners.append({owner, report, evict});
+}
+
+void MemoryRegistry::unregisterCaches(const void *owner)
+{
+  memreg::owners.erase(std::remove_if(memreg::owners.begin(), memreg::owners.end(), [owner](const memreg::Owner& o) -> bool {
+    return o.owner == owner;
+  }), memreg::owners.end());
+}
+
+QVector<memreg::Usage> MemoryRegistry::collect()
+{
+  QVector<memreg::Usage> usages;
+  for(const memreg::Owner& owner : qAsConst(memreg::owners))
+    owner.report(usages);
+  return usages;
+}
+
+qint64 MemoryRegistry::getCacheBudgetBytes()
+{
+  return atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MEMORY_CACHE_BUDGET_MB, 1024).toLongLong() * 1048576L;
+}
+
+qint64 MemoryRegistry::getResidentBudgetBytes()
+{
+  return atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MEMORY_RESIDENT_BUDGET_MB, 0).toLongLong() * 1048576L;
+}
+
+int MemoryRegistry::checkBudget()
+{
+  qint64 cacheBudget = getCacheBudgetBytes(), residentBudget = getResidentBudgetBytes();
+
+  // Get usage per evictable owner
+  QVector<std::pair<qint64, int> > ownerBytes;
+  qint64 total = 0L;
+  for(int i = 0; i < memreg::owners.size(); i++)
+  {
+    QVector<memreg::Usage> usages;
+    memreg::owners.at(i).report(usages);
+    qint64 bytes = memreg::totalBytes(usages);
+    total += bytes;
+
+    if(memreg::owners.at(i).evict)
+      ownerBytes.append(std::make_pair(bytes, i));
+  }
+
+  qint64 resident = residentMemoryBytes();
+  bool cachePressure = cacheBudget > 0L && total > cacheBudget;
+  bool residentPressure = residentBudget > 0L && resident > residentBudget;
+  if(!cachePressure && !residentPressure)
+    return 0;
+
+  qInfo() << Q_FUNC_INFO << "Memory pressure. Caches" << memreg::toMb(total) << "MB, budget" << memreg::toMb(cacheBudget)
+          << "MB, resident" << memreg::toMb(resident) << "MB, budget" << memreg::toMb(residentBudget) << "MB";
+
+  // Drop largest first until caches are below budget.
+  // Resident memory does not shrink immediately - drop half of the caches in this case.
+  std::sort(ownerBytes.begin(), ownerBytes.end(), std::greater<std::pair<qint64, int> >());
+  qint64 target = residentPressure ? total / 2 : cacheBudget;
+  if(cachePressure)
+    target = std::min(target, cacheBudget);
+
+  int num = 0;
+  for(const std::pair<qint64, int>& entry : qAsConst(ownerBytes))
+  {
+    if(total <= target)
+      break;
+
+    memreg::owners.at(entry.second).evict();
+    total -= entry.first;
+    num++;
+  }
+
+  memreg::numEvictionRuns++;
+  memreg::numEvictedOwners += num;
+  qInfo() << Q_FUNC_INFO << "Evicted" << num << "owners";
+  return num;
+}
+
+int MemoryRegistry::getNumEvictionRuns()
+{
+  return memreg::numEvictionRuns;
+}
+
+int MemoryRegistry::getNumEvictedOwners()
+{
+  return memreg::numEvictedOwners;
+}
+
+void MemoryRegistry::html(atools::util::HtmlBuilder& html)
+{
+  const QVector<memreg::Usage> usages = collect();
+  QLocale locale;
+
+  html.table();
+  html.tr().th(tr("Group")).th(tr("Cache")).th(tr("Objects")).th(tr("Size MB")).trEnd();
+  for(const memreg::Usage& usage : usages)
+    html.tr().td(usage.group).td(usage.name).
+    td(locale.toString(usage.count)).
+    td(locale.toString(memreg::toMb(usage.bytes), 'f', 2)).trEnd();
+  html.tableEnd();
+
+  qint64 cacheBudget = getCacheBudgetBytes(), residentBudget = getResidentBudgetBytes(), resident = residentMemoryBytes();
+  html.p().b(tr("Total for all caches: %L1 MB").arg(memreg::toMb(memreg::totalBytes(usages)), 0, 'f', 1)).pEnd();
+
+  if(cacheBudget > 0L)
+    html.p(tr("Budget for all caches: %L1 MB").arg(memreg::toMb(cacheBudget), 0, 'f', 0));
+  if(resident >= 0L)
+    html.p(tr("Resident memory of process: %L1 MB").arg(memreg::toMb(resident), 0, 'f', 1));
+  if(residentBudget > 0L)
+    html.p(tr("Budget for resident memory: %L1 MB").arg(memreg::toMb(residentBudget), 0, 'f', 0));
+  html.p(tr("Caches dropped due to memory pressure: %L1 times in %L2 runs").
+         arg(memreg::numEvictedOwners).arg(memreg::numEvictionRuns));
+}
+
+QString MemoryRegistry::report()
+{
+  QString text;
+  QTextStream stream(&text);
+
+  const QVector<memreg::Usage> usages = collect();
+  for(const memreg::Usage& usage : usages)
+    stream << QString("%1 %2 %3 %4 MB").arg(usage.group, -20).arg(usage.name, -30).arg(usage.count, 10).
+      arg(memreg::toMb(usage.bytes), 10, 'f', 2) << endl;
+
+  stream << tr("Total %1 MB, resident %2 MB").
+    arg(memreg::toMb(memreg::totalBytes(usages)), 0, 'f', 1).arg(memreg::toMb(residentMemoryBytes()), 0, 'f', 1) << endl;
+  stream.flush();
+  return text;
+}
+
+qint64 MemoryRegistry::residentMemoryBytes()
+{
+#if defined(Q_OS_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return static_cast<qint64>(counters.WorkingSetSize);
+#elif defined(Q_OS_MACOS)
+  mach_task_basic_info info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS)
+    return static_cast<qint64>(info.resident_size);
+#elif defined(Q_OS_LINUX)
+  // Second value is resident pages
+  QFile file("/proc/self/statm");
+  if(file.open(QIODevice::ReadOnly))
+  {
+    QList<QByteArray> values = file.readAll().split(' ');
+    if(values.size() > 1)
+      return values.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+  }
+#endif
+  return -1L;
+}
@@ -0,0 +1,120 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_MEMORYREGISTRY_H
+#define LNM_MEMORYREGISTRY_H
+
+#include <QCache>
+#include <QCoreApplication>
+#include <QPixmap>
+#include <QVector>
+
+#include <functional>
+
+namespace atools {
+namespace util {
+class HtmlBuilder;
+}
+}
+
+namespace memreg {
+
+/* Approximate memory usage of one cache */
+struct Usage
+{
+  QString group, name;
+  qint64 bytes = 0L, count = 0L;
+};
+
+/* Adds usage for all caches of an owner */
+typedef std::function<void (QVector<memreg::Usage>& usage)> ReportFunc;
+
+/* Drops all objects in the caches of an owner. Called from the event loop only. */
+typedef std::function<void ()> EvictFunc;
+
+/* Usage estimated from the number of objects and an average object size */
+inline memreg::Usage usage(const QString& group, const QString& name, qint64 count, qint64 bytesPerObject)
+{
+  return {group, name, count * bytesPerObject, count};
+}
+
+/* Usage of a QCache estimated from the number of objects and an average object size */
+template<typename KEY, typename T>
+memreg::Usage cacheUsage(const QString& group, const QString& name, const QCache<KEY, T>& cache, qint64 bytesPerObject)
+{
+  return usage(group, name, cache.size(), bytesPerObject);
+}
+
+/* Usage of a pixmap cache summed up from the pixmap sizes */
+template<typename KEY>
+memreg::Usage pixmapCacheUsage(const QString& group, const QString& name, const QCache<KEY, QPixmap>& cache)
+{
+  memreg::Usage usage = {group, name, 0L, cache.size()};
+  for(const KEY& key : cache.keys())
+  {
+    const QPixmap *pixmap = cache.object(key);
+    if(pixmap != nullptr)
+      usage.bytes += static_cast<qint64>(pixmap->width()) * pixmap->height() * pixmap->depth() / 8;
+  }
+  return usage;
+}
+
+}
+
+/*
+ * Collects approximate memory usage of all registered caches. Owners register a function reporting
+ * their caches and optionally a function to drop them.
+ *
+ * checkBudget() is called periodically and drops caches starting with the largest owner if the registered
+ * caches exceed the budget or the resident memory of the process exceeds its budget.
+ *
+ * Not thread safe. Only to be used from the GUI thread.
+ */
+class MemoryRegistry
+{
+  Q_DECLARE_TR_FUNCTIONS(MemoryRegistry)
+
+public:
+  /* Register caches of owner. Has to be removed with unregisterCaches() before owner is deleted. */
+  static void registerCaches(const void *owner, const memreg::ReportFunc& report, const memreg::EvictFunc& evict = nullptr);
+  static void unregisterCaches(const void *owner);
+
+  /* Get usage of all registered caches */
+  static QVector<memreg::Usage> collect();
+
+  /* Drop caches if budgets are exceeded. Returns number of owners evicted. */
+  static int checkBudget();
+
+  /* Resident memory of the process in bytes or -1 if not available for the platform */
+  static qint64 residentMemoryBytes();
+
+  /* Append table of all caches and totals */
+  static void html(atools::util::HtmlBuilder& html);
+
+  /* Plain text report for the log */
+  static QString report();
+
+  /* Number of eviction runs and owners evicted since start */
+  static int getNumEvictionRuns();
+  static int getNumEvictedOwners();
+
+  /* Budgets in bytes from settings. 0 means no limit. */
+  static qint64 getCacheBudgetBytes();
+  static qint64 getResidentBudgetBytes();
+};
+
+#endif // LNM_MEMORYREGISTRY_H
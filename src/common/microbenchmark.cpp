@@ -0,0 +1,334 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "common/microbenchmark.h"
+
+#include "app/navapp.h"
+#include "atools.h"
+#include "common/coordinateconverter.h"
+#include "common/mapresult.h"
+#include "common/symbolpainter.h"
+#include "common/textplacement.h"
+#include "exception.h"
+#include "fs/pln/flightplan.h"
+#include "mapgui/mappaintwidget.h"
+#include "mapgui/mapscreenindex.h"
+#include "query/procedurequery.h"
+#include "route/route.h"
+#include "route/routealtitude.h"
+#include "routestring/routestringreader.h"
+#include "routestring/routestringwriter.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QTextStream>
+
+#include <algorithm>
+
+using atools::geo::Pos;
+
+namespace bench {
+/* Minimum time for one round and number of rounds to get the median from */
+static const qint64 MIN_ROUND_NS = 100000000L;
+static const int NUM_ROUNDS = 5;
+
+/* Allowed slowdown compared to baseline before a result is reported as regression */
+static const double REGRESSION_TOLERANCE = 1.2;
+
+/* Version of the JSON file format */
+static const int JSON_VERSION = 1;
+}
+
+MicroBenchmark::MicroBenchmark(MapPaintWidget *mapPaintWidgetParam, FlightplanEntryBuilder *entryBuilderParam)
+  : mapPaintWidget(mapPaintWidgetParam), entryBuilder(entryBuilderParam)
+{
+
+}
+
+MicroBenchmark::~MicroBenchmark()
+{
+
+}
+
+void MicroBenchmark::run()
+{
+  results.clear();
+
+  benchCoordinateConverter();
+  benchScreenIndex();
+  benchRouteAltitude();
+  benchProcedureQuery();
+  benchRouteString();
+  benchTextPlacement();
+  benchSymbolPainter();
+}
+
+void MicroBenchmark::measure(const QString& name, const std::function<void()>& func)
+{
+  // Warm up caches
+  func();
+
+  QVector<double> nsPerOp;
+  qint64 iterations = 0L;
+  QElapsedTimer timer;
+  for(int round = 0; round < bench::NUM_ROUNDS; round++)
+  {
+    qint64 num = 0L;
+    timer.start();
+    do
+    {
+      func();
+      num++;
+    } while(timer.nsecsElapsed() < bench::MIN_ROUND_NS);
+
+    nsPerOp.append(static_cast<double>(timer.nsecsElapsed()) / num);
+    iterations += num;
+  }
+
+  std::sort(nsPerOp.begin(), nsPerOp.end());
+
+  bench::BenchResult result;
+  result.name = name;
+  result.nsPerOp = nsPerOp.at(nsPerOp.size() / 2);
+  result.iterations = iterations;
+  results.append(result);
+
+  qDebug() << Q_FUNC_INFO << name << result.nsPerOp << "ns per call" << iterations << "iterations";
+}
+
+void MicroBenchmark::benchCoordinateConverter()
+{
+  // Grid of positions covering the visible map
+  const atools::geo::Rect rect = mapPaintWidget->getCurrentViewRect();
+  QVector<Pos> positions;
+  for(int y = 0; y < 50; y++)
+  {
+    for(int x = 0; x < 50; x++)
+      positions.append(Pos(rect.getWest() + rect.getWidthDegree() * x / 50.f,
+                           rect.getNorth() - rect.getHeightDegree() * y / 50.f));
+  }
+
+  CoordinateConverter conv(mapPaintWidget->viewport());
+  measure("CoordinateConverter::wToS", [&conv, &positions]() -> void {
+    float x, y;
+    bool hidden;
+    for(const Pos& pos : qAsConst(positions))
+      conv.wToS(pos, x, y, CoordinateConverter::DEFAULT_WTOS_SIZE, &hidden);
+  });
+}
+
+void MicroBenchmark::benchScreenIndex()
+{
+  // Grid of points covering the widget
+  const QRect rect = mapPaintWidget->rect();
+  QVector<QPoint> points;
+  for(int y = rect.top(); y < rect.bottom(); y += rect.height() / 20)
+  {
+    for(int x = rect.left(); x < rect.right(); x += rect.width() / 20)
+      points.append(QPoint(x, y));
+  }
+
+  const MapScreenIndex *screenIndex = mapPaintWidget->getScreenIndexConst();
+  measure("MapScreenIndex::getAllNearest", [screenIndex, &points]() -> void {
+    for(const QPoint& point : qAsConst(points))
+    {
+      map::MapResult result;
+      screenIndex->getAllNearest(point, 10, result, map::QUERY_NONE);
+    }
+  });
+}
+
+void MicroBenchmark::benchRouteAltitude()
+{
+  const Route& route = NavApp::getRouteConst();
+  if(route.isEmpty())
+    return;
+
+  // Calculates a copy of the altitude legs and leaves the route untouched
+  measure("RouteAltitude::calculateAll", [&route]() -> void {
+    route.calculateAltitudeLegsForCruise(route.getCruiseAltitudeFt());
+  });
+}
+
+void MicroBenchmark::benchProcedureQuery()
+{
+  const Route& route = NavApp::getRouteConst();
+  const proc::MapProcedureLegs& approach = route.getApproachLegs();
+  if(route.isEmpty() || approach.ref.procedureId == -1)
+    return;
+
+  // Load and post-process legs of the flight plan approach again for each call
+  const map::MapAirport& airport = route.getDestinationAirportLeg().getAirport();
+  ProcedureQuery *procedureQuery = NavApp::getProcedureQuery();
+  int procedureId = approach.ref.procedureId;
+  measure("ProcedureQuery::getProcedureLegs", [procedureQuery, &airport, procedureId]() -> void {
+    procedureQuery->clearCache();
+    procedureQuery->getProcedureLegs(airport, procedureId);
+  });
+}
+
+void MicroBenchmark::benchRouteString()
+{
+  const Route& route = NavApp::getRouteConst();
+  if(route.isEmpty())
+    return;
+
+  QString routeString = RouteStringWriter().createStringForRoute(route, 0.f, rs::DEFAULT_OPTIONS);
+  RouteStringReader reader(entryBuilder);
+  reader.setPlaintextMessages(true);
+
+  measure("RouteStringReader::createRouteFromString", [&reader, &routeString]() -> void {
+    atools::fs::pln::Flightplan flightplan;
+    reader.createRouteFromString(routeString, rs::DEFAULT_OPTIONS, &flightplan);
+  });
+}
+
+void MicroBenchmark::benchTextPlacement()
+{
+  const Route& route = NavApp::getRouteConst();
+  if(route.size() < 2)
+    return;
+
+  QVector<atools::geo::Line> lines;
+  QStringList texts;
+  for(int i = 1; i < route.size(); i++)
+  {
+    lines.append(atools::geo::Line(route.value(i - 1).getPosition(), route.value(i).getPosition()));
+    texts.append(route.value(i).getIdent());
+  }
+
+  QImage image(mapPaintWidget->size(), QImage::Format_ARGB32_Premultiplied);
+  QPainter painter(&image);
+  CoordinateConverter conv(mapPaintWidget->viewport());
+
+  measure("TextPlacement::calculateTextAlongLines", [&painter, &conv, &image, &lines, &texts]() -> void {
+    TextPlacement placement(&painter, &conv, image.rect());
+    placement.calculateTextAlongLines(lines, texts);
+    placement.drawTextAlongLines();
+  });
+}
+
+void MicroBenchmark::benchSymbolPainter()
+{
+  const Route& route = NavApp::getRouteConst();
+  if(route.isEmpty() || !route.getDestinationAirportLeg().getAirport().isValid())
+    return;
+
+  const map::MapAirport& airport = route.getDestinationAirportLeg().getAirport();
+  QImage image(256, 256, QImage::Format_ARGB32_Premultiplied);
+  QPainter painter(&image);
+  painter.setRenderHint(QPainter::Antialiasing);
+  SymbolPainter symbolPainter;
+
+  measure("SymbolPainter::drawAirportSymbol", [&painter, &symbolPainter, &airport]() -> void {
+    symbolPainter.drawAirportSymbol(&painter, airport, 128.f, 128.f, 40.f, false /* diagram */, false /* fast */,
+                                    false /* addon highlight */);
+  });
+}
+
+void MicroBenchmark::compareBaseline(const QString& filename)
+{
+  QFile file(filename);
+  if(!file.open(QIODevice::ReadOnly))
+    throw atools::Exception(tr("Cannot open file \"%1\". Reason: %2").arg(filename).arg(file.errorString()));
+
+  QJsonParseError error;
+  QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+  file.close();
+
+  if(doc.isNull())
+    throw atools::Exception(tr("Cannot read file \"%1\". Reason: %2").arg(filename).arg(error.errorString()));
+
+  // Map benchmark name to nanoseconds
+  QHash<QString, double> baseline;
+  for(const QJsonValue& value : doc.object().value("results").toArray())
+  {
+    QJsonObject obj = value.toObject();
+    baseline.insert(obj.value("name").toString(), obj.value("ns_per_op").toDouble());
+  }
+
+  for(bench::BenchResult& result : results)
+    result.baselineNsPerOp = baseline.value(result.name, 0.);
+}
+
+int MicroBenchmark::getNumRegressions() const
+{
+  int num = 0;
+  for(const bench::BenchResult& result : results)
+  {
+    if(result.ratio() > bench::REGRESSION_TOLERANCE)
+      num++;
+  }
+  return num;
+}
+
+void MicroBenchmark::saveJson(const QString& filename) const
+{
+  QJsonArray array;
+  for(const bench::BenchResult& result : results)
+  {
+    QJsonObject obj;
+    obj.insert("name", result.name);
+    obj.insert("ns_per_op", result.nsPerOp);
+    obj.insert("iterations", result.iterations);
+    if(result.baselineNsPerOp > 0.)
+      obj.insert("baseline_ns_per_op", result.baselineNsPerOp);
+    array.append(obj);
+  }
+
+  QJsonObject root;
+  root.insert("version", bench::JSON_VERSION);
+  root.insert("application_version", QCoreApplication::applicationVersion());
+  root.insert("timestamp", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+  root.insert("results", array);
+
+  QFile file(filename);
+  if(!file.open(QIODevice::WriteOnly))
+    throw atools::Exception(tr("Cannot open file \"%1\". Reason: %2").arg(filename).arg(file.errorString()));
+
+  file.write(QJsonDocument(root).toJson());
+  file.close();
+}
+
+QString MicroBenchmark::getReport() const
+{
+  QString report;
+  QTextStream stream(&report);
+
+  for(const bench::BenchResult& result : results)
+  {
+    stream << QString("%1 %2 ns").arg(result.name, -45).arg(result.nsPerOp, 14, 'f', 1);
+
+    if(result.baselineNsPerOp > 0.)
+      stream << tr(", baseline %1 ns, %2 %").
+        arg(result.baselineNsPerOp, 0, 'f', 1).arg((result.ratio() - 1.) * 100., 0, 'f', 1) <<
+        (result.ratio() > bench::REGRESSION_TOLERANCE ? tr(" REGRESSION") : QString());
+    stream << endl;
+  }
+
+  stream << tr("%1 benchmarks run, %2 regressions.").arg(results.size()).arg(getNumRegressions()) << endl;
+  stream.flush();
+  return report;
+}
@@ -0,0 +1,107 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_MICROBENCHMARK_H
+#define LNM_MICROBENCHMARK_H
+
+#include <QCoreApplication>
+#include <QVector>
+
+#include <functional>
+
+class MapPaintWidget;
+class FlightplanEntryBuilder;
+
+namespace bench {
+
+/* Result for one benchmarked function */
+struct BenchResult
+{
+  QString name;
+  double nsPerOp = 0., baselineNsPerOp = 0.;
+  qint64 iterations = 0L;
+
+  /* Ratio to baseline or 0 if not in baseline */
+  double ratio() const
+  {
+    return baselineNsPerOp > 0. ? nsPerOp / baselineNsPerOp : 0.;
+  }
+};
+
+}
+
+/*
+ * Runs repeatable timings for hot paths in geometry, queries and painting. Used by the command line option "benchmark".
+ *
+ * The current map view, the loaded flight plan and the selected navdata are used as fixture. Use the same
+ * window layout, flight plan (option "flight-plan") and database to get comparable results between releases.
+ *
+ * Each function is called until a minimum time is exceeded. This is repeated several times and the median
+ * time per call is reported. Results can be saved as JSON and compared against a previously saved baseline file.
+ *
+ * Has to be used in the main thread.
+ */
+class MicroBenchmark
+{
+  Q_DECLARE_TR_FUNCTIONS(MicroBenchmark)
+
+public:
+  MicroBenchmark(MapPaintWidget *mapPaintWidgetParam, FlightplanEntryBuilder *entryBuilderParam);
+  ~MicroBenchmark();
+
+  MicroBenchmark(const MicroBenchmark& other) = delete;
+  MicroBenchmark& operator=(const MicroBenchmark& other) = delete;
+
+  /* Run all benchmarks */
+  void run();
+
+  /* Load baseline from JSON file written by saveJson() and compare.
+   * Throws atools::Exception if the file cannot be read. */
+  void compareBaseline(const QString& filename);
+
+  /* Save results as JSON. Throws atools::Exception if the file cannot be written. */
+  void saveJson(const QString& filename) const;
+
+  /* Plain text report of the last run including comparison to baseline if loaded */
+  QString getReport() const;
+
+  /* Number of results slower than baseline by more than the allowed tolerance */
+  int getNumRegressions() const;
+
+  const QVector<bench::BenchResult>& getResults() const
+  {
+    return results;
+  }
+
+private:
+  /* Measure function and add result. func has to do one iteration. */
+  void measure(const QString& name, const std::function<void()>& func);
+
+  void benchCoordinateConverter();
+  void benchScreenIndex();
+  void benchRouteAltitude();
+  void benchProcedureQuery();
+  void benchRouteString();
+  void benchTextPlacement();
+  void benchSymbolPainter();
+
+  MapPaintWidget *mapPaintWidget;
+  FlightplanEntryBuilder *entryBuilder;
+  QVector<bench::BenchResult> results;
+};
+
+#endif // LNM_MICROBENCHMARK_H
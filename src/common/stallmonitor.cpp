@@ -0,0 +1,199 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "common/stallmonitor.h"
+
+#include "common/constants.h"
+#include "settings/settings.h"
+#include "util/htmlbuilder.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLocale>
+#include <QStringBuilder>
+#include <QTextStream>
+#include <QThread>
+#include <QVector>
+
+#include <algorithm>
+
+namespace stallmon {
+
+bool enabled = false;
+
+/* Entry point currently executing in the GUI thread */
+struct Frame
+{
+  const char *name;
+  qint64 startNs;
+  bool childReported;
+};
+
+/* Statistics for one entry point */
+struct Offender
+{
+  QString name;
+  int count;
+  qint64 maxMs, totalMs;
+};
+
+static QElapsedTimer clock;
+static QVector<Frame> frames;
+static QHash<QString, Offender> offenders;
+static qint64 thresholdMs = 0L, lastHeartbeatNs = -1L, maxStallMs = 0L;
+static int numStalls = 0, numUnattributed = 0, numReportedSinceHeartbeat = 0;
+
+const static int HEARTBEAT_INTERVAL_MS = 100;
+
+/* Offenders sorted by count descending */
+static QVector<Offender> sortedOffenders()
+{
+  QVector<Offender> sorted;
+  for(const Offender& offender : qAsConst(offenders))
+    sorted.append(offender);
+
+  std::sort(sorted.begin(), sorted.end(), [](const Offender& o1, const Offender& o2) -> bool {
+    return o1.count == o2.count ? o1.totalMs > o2.totalMs : o1.count > o2.count;
+  });
+  return sorted;
+}
+
+bool Scope::enter(const char *name)
+{
+  if(QThread::currentThread() != QCoreApplication::instance()->thread())
+    return false;
+
+  frames.append({name, clock.nsecsElapsed(), false});
+  return true;
+}
+
+void Scope::leave()
+{
+  Frame frame = frames.takeLast();
+  qint64 ms = (clock.nsecsElapsed() - frame.startNs) / 1000000L;
+
+  if(ms >= thresholdMs && !frame.childReported)
+  {
+    Offender& offender = offenders[frame.name];
+    if(offender.name.isEmpty())
+      offender = {frame.name, 0, 0L, 0L};
+    offender.count++;
+    offender.totalMs += ms;
+    offender.maxMs = std::max(offender.maxMs, ms);
+    numReportedSinceHeartbeat++;
+
+    // Stack of enclosing entry points which are not counted again
+    QStringList stack;
+    for(int i = frames.size() - 1; i >= 0; i--)
+    {
+      frames[i].childReported = true;
+      stack.append(frames.at(i).name);
+    }
+
+    qWarning().noquote().nospace() << "GUI thread stalled " << ms << " ms in " << frame.name
+                                   << (stack.isEmpty() ? QString() : " called from " % stack.join(" <- "));
+  }
+}
+
+}
+
+void StallMonitor::init()
+{
+  stallmon::thresholdMs = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_STALL_MONITOR_MS, 0).toLongLong();
+  stallmon::enabled = stallmon::thresholdMs > 0L;
+
+  if(stallmon::enabled)
+  {
+    stallmon::clock.start();
+    qInfo() << Q_FUNC_INFO << "Stall monitor enabled with threshold" << stallmon::thresholdMs << "ms";
+  }
+}
+
+int StallMonitor::getHeartbeatIntervalMs()
+{
+  return stallmon::HEARTBEAT_INTERVAL_MS;
+}
+
+void StallMonitor::heartbeat()
+{
+  if(!stallmon::enabled)
+    return;
+
+  qint64 now = stallmon::clock.nsecsElapsed();
+  if(stallmon::lastHeartbeatNs >= 0L)
+  {
+    // Time the timer event was late
+    qint64 lateMs = (now - stallmon::lastHeartbeatNs) / 1000000L - stallmon::HEARTBEAT_INTERVAL_MS;
+    if(lateMs >= stallmon::thresholdMs)
+    {
+      stallmon::numStalls++;
+      stallmon::maxStallMs = std::max(stallmon::maxStallMs, lateMs);
+
+      if(stallmon::numReportedSinceHeartbeat == 0)
+      {
+        stallmon::numUnattributed++;
+        qWarning().noquote().nospace() << "GUI thread stalled " << lateMs << " ms outside of monitored entry points";
+      }
+    }
+  }
+  stallmon::lastHeartbeatNs = now;
+  stallmon::numReportedSinceHeartbeat = 0;
+}
+
+void StallMonitor::html(atools::util::HtmlBuilder& html)
+{
+  if(!stallmon::enabled)
+  {
+    html.p(tr("GUI thread stall monitor is disabled."));
+    return;
+  }
+
+  QLocale locale;
+  html.p().b(tr("GUI thread stalls of %L1 ms and more").arg(stallmon::thresholdMs)).pEnd();
+
+  const QVector<stallmon::Offender> offenders = stallmon::sortedOffenders();
+  if(!offenders.isEmpty())
+  {
+    html.table();
+    html.tr().th(tr("Entry point")).th(tr("Stalls")).th(tr("Max ms")).th(tr("Total ms")).trEnd();
+    for(const stallmon::Offender& offender : offenders)
+      html.tr().td(offender.name).
+      td(locale.toString(offender.count)).
+      td(locale.toString(offender.maxMs)).
+      td(locale.toString(offender.totalMs)).trEnd();
+    html.tableEnd();
+  }
+
+  html.p(tr("Event loop stalls: %L1, longest %L2 ms").arg(stallmon::numStalls).arg(stallmon::maxStallMs));
+  html.p(tr("Stalls outside of monitored entry points: %L1").arg(stallmon::numUnattributed));
+}
+
+QString StallMonitor::report()
+{
+  QString text;
+  QTextStream stream(&text);
+
+  for(const stallmon::Offender& offender : stallmon::sortedOffenders())
+    stream << QString("%1 %2 %3 ms %4 ms").arg(offender.name, -60).arg(offender.count, 6).
+      arg(offender.maxMs, 8).arg(offender.totalMs, 10) << endl;
+
+  stream << tr("Stalls %1, longest %2 ms, unattributed %3").
+    arg(stallmon::numStalls).arg(stallmon::maxStallMs).arg(stallmon::numUnattributed) << endl;
+  stream.flush();
+  return text;
+}
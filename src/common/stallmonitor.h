@@ -0,0 +1,104 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_STALLMONITOR_H
+#define LNM_STALLMONITOR_H
+
+#include <QCoreApplication>
+
+namespace atools {
+namespace util {
+class HtmlBuilder;
+}
+}
+
+namespace stallmon {
+
+/* True if enabled in settings. Checked by Scope to keep the overhead low if disabled. */
+extern bool enabled;
+
+/* Measures time spent in an entry point of the GUI thread. Use macro LNM_STALL_SCOPE. */
+class Scope
+{
+public:
+  explicit Scope(const char *name)
+  {
+    if(enabled)
+      entered = enter(name);
+  }
+
+  ~Scope()
+  {
+    if(entered)
+      leave();
+  }
+
+  Scope(const Scope& other) = delete;
+  Scope& operator=(const Scope& other) = delete;
+
+private:
+  static bool enter(const char *name);
+  static void leave();
+
+  bool entered = false;
+};
+
+}
+
+/* Attribute GUI thread stalls to the enclosing function */
+#define LNM_STALL_SCOPE stallmon::Scope lnmStallScope(Q_FUNC_INFO)
+
+/*
+ * Detects stalls of the GUI thread event loop and attributes them to instrumented entry points.
+ *
+ * Entry points like slots for simulator data, downloads, flight plan changes and map rendering are
+ * marked with LNM_STALL_SCOPE. A scope taking longer than the threshold is logged with the stack of
+ * enclosing scopes and counted. Only the innermost offending scope is counted.
+ * heartbeat() is called from a timer and detects late timer events. Stalls without offending scope
+ * are counted as unattributed.
+ *
+ * Enabled with "[Options] StallMonitorMs=500" in the ini file. 0 disables the monitor.
+ *
+ * Not thread safe. Scopes in other threads are ignored.
+ */
+class StallMonitor
+{
+  Q_DECLARE_TR_FUNCTIONS(StallMonitor)
+
+public:
+  /* Read threshold from settings */
+  static void init();
+
+  /* Interval for the timer calling heartbeat() */
+  static int getHeartbeatIntervalMs();
+
+  /* Called by timer in the GUI thread */
+  static void heartbeat();
+
+  static bool isEnabled()
+  {
+    return stallmon::enabled;
+  }
+
+  /* Append table of offending entry points */
+  static void html(atools::util::HtmlBuilder& html);
+
+  /* Plain text report for the log */
+  static QString report();
+};
+
+#endif // LNM_STALLMONITOR_H
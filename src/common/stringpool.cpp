@@ -0,0 +1,94 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "common/stringpool.h"
+
+StringPool::StringPool()
+{
+  // Index zero is reserved for null strings
+  strings.append(QString());
+}
+
+StringPool& StringPool::instance()
+{
+  static StringPool pool;
+  return pool;
+}
+
+QString StringPool::intern(const QString& str)
+{
+  if(str.isNull())
+    return str;
+
+  if(str.isEmpty())
+    return QLatin1String("");
+
+  StringPool& pool = instance();
+  quint32 idx = pool.insert(str);
+
+  QReadLocker locker(&pool.lock);
+  return pool.strings.at(static_cast<int>(idx));
+}
+
+quint32 StringPool::handle(const QString& str)
+{
+  if(str.isNull())
+    return NULL_HANDLE;
+
+  return instance().insert(str);
+}
+
+QString StringPool::string(quint32 handle)
+{
+  StringPool& pool = instance();
+  QReadLocker locker(&pool.lock);
+
+  if(handle < static_cast<quint32>(pool.strings.size()))
+    return pool.strings.at(static_cast<int>(handle));
+  else
+    return QString();
+}
+
+int StringPool::size()
+{
+  StringPool& pool = instance();
+  QReadLocker locker(&pool.lock);
+  return pool.strings.size() - 1;
+}
+
+quint32 StringPool::insert(const QString& str)
+{
+  {
+    // Fast path - most strings are already in the pool
+    QReadLocker locker(&lock);
+    auto it = handles.constFind(str);
+    if(it != handles.constEnd())
+      return it.value();
+  }
+
+  QWriteLocker locker(&lock);
+
+  // Check again since another thread might have added it in the meantime
+  auto it = handles.constFind(str);
+  if(it != handles.constEnd())
+    return it.value();
+
+  quint32 idx = static_cast<quint32>(strings.size());
+  strings.append(str);
+  handles.insert(str, idx);
+  return idx;
+}
@@ -0,0 +1,67 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_STRINGPOOL_H
+#define LNM_STRINGPOOL_H
+
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+
+/*
+ * Thread safe pool for short and frequently repeated strings like ICAO regions, navaid type codes or
+ * surface and parking types which are read from the database for many map objects.
+ *
+ * intern() returns a shared copy of a pooled string. QString is implicitly shared which means that all
+ * objects holding an interned string refer to the same heap buffer instead of each allocating its own.
+ * handle() and string() allow to store strings as 32 bit values in compact records.
+ *
+ * Strings are never removed from the pool. Use it only for values with a small number of variants.
+ */
+class StringPool
+{
+public:
+  /* Handle for null strings */
+  static const quint32 NULL_HANDLE = 0;
+
+  /* Get shared copy of string. Adds the string to the pool if not already present. */
+  static QString intern(const QString& str);
+
+  /* Get handle for string. Adds the string to the pool if not already present. */
+  static quint32 handle(const QString& str);
+
+  /* Get string for handle. Returns a null string for NULL_HANDLE or invalid handles. */
+  static QString string(quint32 handle);
+
+  /* Number of strings in pool for debugging */
+  static int size();
+
+private:
+  StringPool();
+
+  static StringPool& instance();
+
+  /* Returns handle and adds string if needed */
+  quint32 insert(const QString& str);
+
+  QHash<QString, quint32> handles;
+  QVector<QString> strings;
+  QReadWriteLock lock;
+};
+
+#endif // LNM_STRINGPOOL_H
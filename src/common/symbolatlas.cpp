@@ -0,0 +1,123 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "common/symbolatlas.h"
+
+#include <QPixmap>
+
+#include <cmath>
+
+SymbolAtlas::SymbolAtlas(int atlasSizeParam)
+  : atlasSize(atlasSizeParam)
+{
+}
+
+SymbolAtlas::~SymbolAtlas()
+{
+  delete atlas;
+}
+
+void SymbolAtlas::clear()
+{
+  pending.clear();
+  fragments.clear();
+  shelfX = shelfY = shelfHeight = 0;
+
+  if(atlas != nullptr)
+    atlas->fill(Qt::transparent);
+}
+
+void SymbolAtlas::add(QPainter *painter, quint64 key, int side, float x, float y, const RenderFunc& renderFunc,
+                      float rotation)
+{
+  qreal ratio = painter->device() != nullptr ? painter->device()->devicePixelRatioF() : 1.;
+
+  if(atlas == nullptr || ratio != pixelRatio)
+  {
+    // Draw what is left and start over with a new pixmap matching the device
+    flush(painter);
+    delete atlas;
+    pixelRatio = ratio;
+    atlas = new QPixmap(atlasSize, atlasSize);
+    clear();
+  }
+
+  if(!fragments.contains(key))
+  {
+    if(!render(painter, key, side, renderFunc))
+    {
+      // Atlas is full - draw all queued symbols and start over
+      flush(painter);
+      clear();
+
+      if(!render(painter, key, side, renderFunc))
+      {
+        // Does not fit in an empty atlas - draw directly
+        painter->save();
+        painter->translate(x, y);
+        painter->rotate(rotation);
+        painter->translate(-side / 2.f, -side / 2.f);
+        renderFunc(painter, side / 2.f);
+        painter->restore();
+        return;
+      }
+    }
+  }
+
+  const QRect& rect = fragments.value(key);
+  pending.append(QPainter::PixmapFragment::create(QPointF(x, y), QRectF(rect), 1. / pixelRatio, 1. / pixelRatio,
+                                                  static_cast<qreal>(rotation)));
+}
+
+void SymbolAtlas::flush(QPainter *painter)
+{
+  if(!pending.isEmpty() && atlas != nullptr)
+    painter->drawPixmapFragments(pending.constData(), pending.size(), *atlas);
+  pending.clear();
+}
+
+bool SymbolAtlas::render(QPainter *painter, quint64 key, int side, const RenderFunc& renderFunc)
+{
+  // Size in device pixels plus one pixel spacing to avoid bleeding of smoothed neighbors
+  int deviceSide = static_cast<int>(std::ceil(side * pixelRatio));
+
+  if(shelfX + deviceSide > atlasSize)
+  {
+    // Next shelf
+    shelfY += shelfHeight + 1;
+    shelfX = shelfHeight = 0;
+  }
+
+  if(shelfY + deviceSide > atlasSize || deviceSide > atlasSize)
+    return false;
+
+  QRect rect(shelfX, shelfY, deviceSide, deviceSide);
+
+  {
+    QPainter atlasPainter(atlas);
+    atlasPainter.setRenderHints(painter->renderHints());
+    atlasPainter.setClipRect(rect);
+    atlasPainter.translate(rect.topLeft());
+    atlasPainter.scale(pixelRatio, pixelRatio);
+    renderFunc(&atlasPainter, side / 2.f);
+  }
+
+  fragments.insert(key, rect);
+  shelfX += deviceSide + 1;
+  shelfHeight = std::max(shelfHeight, deviceSide);
+  return true;
+}
@@ -0,0 +1,99 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_SYMBOLATLAS_H
+#define LNM_SYMBOLATLAS_H
+
+#include <QHash>
+#include <QPainter>
+#include <QVector>
+
+#include <algorithm>
+#include <functional>
+
+class QPixmap;
+
+/*
+ * Sprite atlas for frequently drawn map symbols like waypoints, NDB or aircraft.
+ *
+ * Symbols are rendered once into a large shared pixmap on first use and then queued by add().
+ * flush() draws all queued symbols using a single QPainter::drawPixmapFragments() call.
+ * The atlas is cleared when full or when the device pixel ratio changes.
+ *
+ * The pixmap is allocated lazily on first use to avoid memory overhead for painters not using it.
+ */
+class SymbolAtlas
+{
+public:
+  /* Symbol kinds to build keys. Values are used in the lowest four bits of the key. */
+  enum Kind : quint64
+  {
+    WAYPOINT = 1,
+    NDB = 2,
+    VEHICLE = 3,
+    WIND_BARB = 4
+  };
+
+  /* Called to render a symbol centered at center/center into an empty square of side length 2 * center */
+  typedef std::function<void (QPainter *painter, float center)> RenderFunc;
+
+  explicit SymbolAtlas(int atlasSizeParam = 1024);
+  ~SymbolAtlas();
+
+  SymbolAtlas(const SymbolAtlas& other) = delete;
+  SymbolAtlas& operator=(const SymbolAtlas& other) = delete;
+
+  /* Build a key from kind, size in quarter pixels and up to 40 bits of further attributes */
+  static quint64 key(Kind kind, float size, quint64 attributes = 0L)
+  {
+    return kind | static_cast<quint64>(std::min(std::max(static_cast<int>(size * 4.f), 0), 0xffff)) << 4 | attributes << 20;
+  }
+
+  /* Queue symbol identified by key for drawing centered at x/y. side is the width and height of the area
+   * needed by the symbol in logical pixels. renderFunc is only called if the symbol is not in the atlas yet.
+   * rotation is clockwise in degree around the symbol center. */
+  void add(QPainter *painter, quint64 key, int side, float x, float y, const RenderFunc& renderFunc,
+           float rotation = 0.f);
+
+  /* true if the symbol is already rendered into the atlas */
+  bool contains(quint64 key) const
+  {
+    return fragments.contains(key);
+  }
+
+  /* Draw all queued symbols */
+  void flush(QPainter *painter);
+
+  /* Remove all symbols and queued fragments */
+  void clear();
+
+private:
+  /* Allocate a new slot and render symbol into it. Returns false if the atlas is full. */
+  bool render(QPainter *painter, quint64 key, int side, const RenderFunc& renderFunc);
+
+  QPixmap *atlas = nullptr;
+
+  /* Position and size of symbols in device pixels */
+  QHash<quint64, QRect> fragments;
+  QVector<QPainter::PixmapFragment> pending;
+
+  /* Simple shelf packing. New symbols are placed right of the last one or on a new shelf if the row is full. */
+  int shelfX = 0, shelfY = 0, shelfHeight = 0, atlasSize;
+  qreal pixelRatio = 1.;
+};
+
+#endif // LNM_SYMBOLATLAS_H
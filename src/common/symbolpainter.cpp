@@ -23,9 +23,11 @@
 #include "fs/util/fsutil.h"
 #include "fs/weather/metar.h"
 #include "fs/weather/metarparser.h"
+#include "mappainter/labelplacement.h"
 #include "geo/calculations.h"
 #include "options/optiondata.h"
 #include "util/paintercontextsaver.h"
+#include "weather/weathercontext.h"
 
 #include <QPainter>
 #include <QStringBuilder>
@@ -381,9 +383,74 @@ void SymbolPainter::drawAirportWeather(QPainter *painter, const atools::fs::weat
   if(metar.isValid())
   {
     const atools::fs::weather::MetarParser& parsedMetar = metar.getParsedMetar();
+    drawAirportWeatherInternal(painter, parsedMetar.getFlightRules(), parsedMetar.getMaxCoverage(),
+                               parsedMetar.getPrevailingWindSpeedKnots(), parsedMetar.getGustSpeedKts(),
+                               parsedMetar.getPrevailingWindDir(), x, y, size, windPointer, windBarbs, fast);
+  }
+}
+
+void SymbolPainter::drawAirportWeatherCached(QPainter *painter, const map::AirportWeatherSummary& weather, float x, float y,
+                                             float size, bool windPointer, bool windBarbs, bool fast)
+{
+  if(weather.isValid())
+  {
+    // Round wind speeds to barb resolution of five knots and direction to five degrees =================
+    auto windBucket = [](float wind) -> quint64 {
+      if(wind >= 2.f && wind < atools::fs::weather::INVALID_METAR_VALUE / 2.f)
+        return static_cast<quint64>(atools::minmax(1, 255, atools::roundToInt(wind / 5.f)));
+      else
+        return 0L; // No wind or no barbs
+    };
+
+    float dir = weather.prevailingWindDir;
+    quint64 dirBucket = dir >= 0.f && dir < atools::fs::weather::INVALID_METAR_VALUE / 2.f ?
+                        static_cast<quint64>(atools::roundToInt(dir / 5.f) % 72) : 127L;
+    quint64 wind = windBucket(weather.prevailingWindSpeedKts), gust = windBucket(weather.gustSpeedKts);
+    if(dirBucket == 127L)
+      wind = gust = 0L;
+
+    int intSize = atools::roundToInt(size);
+    qreal pixelRatio = painter->device() != nullptr ? painter->device()->devicePixelRatioF() : 1.;
+
+    // Pack all values which change the appearance of the symbol into a key =============================
+    quint64 key = static_cast<quint64>(weather.flightRules & 0x7) |
+                  static_cast<quint64>(weather.maxCoverage & 0xf) << 3 |
+                  wind << 7 | gust << 15 | dirBucket << 23 |
+                  static_cast<quint64>(atools::minmax(0, 1023, intSize)) << 30 |
+                  static_cast<quint64>(windPointer) << 40 | static_cast<quint64>(windBarbs) << 41 |
+                  static_cast<quint64>(fast) << 42 |
+                  static_cast<quint64>(atools::minmax(1, 63, atools::roundToInt(pixelRatio * 4.))) << 43;
+
+    // Wind pointer and barbs extend about twice the symbol size from the center
+    float half = std::ceil(size * 2.5f);
+
+    QPixmap *pixmap = weatherPixmaps.object(key);
+    if(pixmap == nullptr)
+    {
+      int side = static_cast<int>(half * 2.f);
+      pixmap = new QPixmap(QSize(side, side) * pixelRatio);
+      pixmap->setDevicePixelRatio(pixelRatio);
+      pixmap->fill(Qt::transparent);
+
+      QPainter pixmapPainter(pixmap);
+      pixmapPainter.setRenderHints(painter->renderHints());
+      drawAirportWeatherInternal(&pixmapPainter, weather.flightRules, weather.maxCoverage,
+                                 wind * 5.f, gust * 5.f, dirBucket * 5.f, half, half, size, windPointer, windBarbs, fast);
+      pixmapPainter.end();
+
+      weatherPixmaps.insert(key, pixmap);
+    }
 
+    painter->drawPixmap(QPointF(x - half, y - half), *pixmap);
+  }
+}
+
+void SymbolPainter::drawAirportWeatherInternal(QPainter *painter, int flightRules, int maxCoverage,
+                                               float wind, float gust, float dir, float x, float y, float size,
+                                               bool windPointer, bool windBarbs, bool fast)
+{
+  {
     // Determine correct color for flight rules (IFR, etc.) =============================================
-    atools::fs::weather::MetarParser::FlightRules flightRules = parsedMetar.getFlightRules();
     atools::util::PainterContextSaver saver(painter);
 
     painter->setBackgroundMode(Qt::OpaqueMode);
@@ -400,13 +467,13 @@ void SymbolPainter::drawAirportWeather(QPainter *painter, const atools::fs::weat
 
     // Wind pointer and/or barbs =====================================================
     if(windBarbs || windPointer)
-      drawWindBarbs(painter, parsedMetar, x, y, size, windBarbs, false /* altWind */, false /* route */, fast);
+      drawWindBarbs(painter, wind, gust, dir, x, y, size, windBarbs, false /* altWind */, false /* route */, fast);
 
     // Draw coverage indicating pies or circles =====================================================
 
     // Color depending on flight rule
     QColor color;
-    switch(flightRules)
+    switch(static_cast<atools::fs::weather::MetarParser::FlightRules>(flightRules))
     {
       case atools::fs::weather::MetarParser::UNKNOWN:
         break;
@@ -426,8 +493,7 @@ void SymbolPainter::drawAirportWeather(QPainter *painter, const atools::fs::weat
 
     float lineWidth = size * 0.2f;
     painter->setPen(QPen(color, lineWidth, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
-    atools::fs::weather::MetarCloud::Coverage maxCoverage = parsedMetar.getMaxCoverage();
-    switch(maxCoverage)
+    switch(static_cast<atools::fs::weather::MetarCloud::Coverage>(maxCoverage))
     {
       case atools::fs::weather::MetarCloud::COVERAGE_NIL:
         painter->drawEllipse(rect);
@@ -547,6 +613,7 @@ void SymbolPainter::drawWindBarbs(QPainter *painter, float wind, float gust, flo
 
     QLineF line(0., 0., 0., -lineLength);
     painter->setPen(QPen(background, bgLineWidth, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+    painter->save();
     painter->translate(QPointF(x, y));
     painter->rotate(dir);
     // Line from 0 to 0 - length
@@ -586,7 +653,7 @@ void SymbolPainter::drawWindBarbs(QPainter *painter, float wind, float gust, flo
     painter->setPen(QPen(mapcolors::weatherWindColor, lineWidth, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
     painter->setBrush(background);
     painter->drawLine(line);
-    painter->resetTransform();
+    painter->restore();
 
   }
 
@@ -668,6 +735,59 @@ int SymbolPainter::airportMsaSize(QPainter *painter, const map::MapAirportMsa& a
          atools::roundToInt(airportMsa.altitudes.size() > 1 || !drawDetails ? sizeFactor : sizeFactor / 2.f);
 }
 
+void SymbolPainter::drawAirportMsaCached(QPainter *painter, const map::MapAirportMsa& airportMsa, float x, float y, float size,
+                                         float symbolScale, bool header, bool transparency, bool fast)
+{
+  bool drawDetails = symbolScale > 0.f;
+  if(size <= 0.f)
+    size = airportMsaSize(painter, airportMsa, symbolScale, drawDetails);
+
+  qreal pixelRatio = painter->device() != nullptr ? painter->device()->devicePixelRatioF() : 1.;
+  const QFont& font = painter->font();
+
+  // Units and font change texts and size of labels
+  QString key = QString::number(airportMsa.id) % '_' % QString::number(atools::roundToInt(size)) % '_' %
+                QString::number(atools::roundToInt(symbolScale * 100.f)) % '_' %
+                QString::number(header | transparency << 1 | fast << 2) % '_' %
+                QString::number(atools::roundToInt(pixelRatio * 4.)) % '_' %
+                font.key() % '_' % Unit::getUnitAltStr() % '_' % Unit::getUnitDistStr();
+
+  QPixmap *pixmap = msaPixmaps.object(key);
+  if(pixmap == nullptr)
+  {
+    // Header label is drawn above the circle and can be wider than the symbol - add space for this
+    QFontMetricsF metrics(font);
+    float halfWidth = std::ceil(size / 2.f) + 2.f, halfHeight = std::ceil(size / 2.f + static_cast<float>(metrics.height())) + 2.f;
+    if(header && drawDetails && !fast)
+      halfWidth = std::max(halfWidth, std::ceil(static_cast<float>(metrics.boundingRect(airportMsaHeader(airportMsa)).width()) / 2.f) + 2.f);
+
+    pixmap = new QPixmap(QSize(static_cast<int>(halfWidth * 2.f), static_cast<int>(halfHeight * 2.f)) * pixelRatio);
+    pixmap->setDevicePixelRatio(pixelRatio);
+    pixmap->fill(Qt::transparent);
+
+    QPainter pixmapPainter(pixmap);
+    pixmapPainter.setRenderHints(painter->renderHints());
+    pixmapPainter.setFont(font);
+    drawAirportMsa(&pixmapPainter, airportMsa, halfWidth, halfHeight, size, symbolScale, header, transparency, fast);
+    pixmapPainter.end();
+
+    msaPixmaps.insert(key, pixmap);
+  }
+
+  // Symbol is centered in pixmap
+  painter->drawPixmap(QPointF(x - pixmap->width() / pixmap->devicePixelRatioF() / 2.,
+                              y - pixmap->height() / pixmap->devicePixelRatioF() / 2.), *pixmap);
+}
+
+QString SymbolPainter::airportMsaHeader(const map::MapAirportMsa& airportMsa)
+{
+  return tr("MSA %1 %2 (%3, %4)").
+         arg(airportMsa.navIdent).
+         arg(Unit::distNm(airportMsa.radius, true, true)).
+         arg(airportMsa.trueBearing ? tr("°T") : tr("°M")).
+         arg(Unit::getUnitAltStr());
+}
+
 void SymbolPainter::drawAirportMsa(QPainter *painter, const map::MapAirportMsa& airportMsa, float x, float y, float size, float symbolScale,
                                    bool header, bool transparency, bool fast)
 {
@@ -699,11 +819,7 @@ void SymbolPainter::drawAirportMsa(QPainter *painter, const map::MapAirportMsa&
     if(header && drawDetails)
     {
       // Draw a header label =============================================
-      QString heading = tr("MSA %1 %2 (%3, %4)").
-                        arg(airportMsa.navIdent).
-                        arg(Unit::distNm(airportMsa.radius, true, true)).
-                        arg(airportMsa.trueBearing ? tr("°T") : tr("°M")).
-                        arg(Unit::getUnitAltStr());
+      QString heading = airportMsaHeader(airportMsa);
 
       QRectF bounding = QFontMetricsF(painter->font()).boundingRect(heading);
       QPointF pt(x - bounding.size().width() / 2., y - radius);
@@ -1344,6 +1460,84 @@ void SymbolPainter::textBox(QPainter *painter, const QStringList& texts, const Q
 
 void SymbolPainter::textBoxF(QPainter *painter, QStringList texts, QPen textPen, float x, float y, textatt::TextAttributes atts,
                              int transparency, const QColor& backgroundColor)
+{
+  if(labelPlacement != nullptr)
+  {
+    // Remove empty lines
+    texts.removeAll(QString());
+
+    if(texts.isEmpty())
+      return;
+
+    // Defer drawing until all painters have submitted their labels - keep font and transformation
+    QFont font = painter->font();
+    QTransform transform = painter->transform();
+    labelPlacement->submit(transform.mapRect(textBoxRect(font, texts, x, y, atts)), labelPriority, [=](QPainter *labelPainter) {
+      labelPainter->save();
+      labelPainter->setFont(font);
+      labelPainter->setTransform(transform);
+      textBoxFInternal(labelPainter, texts, textPen, x, y, atts, transparency, backgroundColor);
+      labelPainter->restore();
+    });
+  }
+  else
+    textBoxFInternal(painter, texts, textPen, x, y, atts, transparency, backgroundColor);
+}
+
+QFont SymbolPainter::textBoxFont(QFont font, textatt::TextAttributes atts)
+{
+  if(atts.testFlag(textatt::BOLD))
+    font.setBold(true);
+
+  if(atts.testFlag(textatt::ITALIC))
+    font.setItalic(true);
+
+  if(atts.testFlag(textatt::UNDERLINE))
+    font.setUnderline(true);
+
+  if(atts.testFlag(textatt::OVERLINE))
+    font.setOverline(true);
+
+  if(atts.testFlag(textatt::STRIKEOUT))
+    font.setStrikeOut(true);
+
+  return font;
+}
+
+QRectF SymbolPainter::textBoxRect(const QFont& painterFont, const QStringList& texts, float x, float y,
+                                  textatt::TextAttributes atts)
+{
+  // Same layout as in textBoxFInternal() but background margins are approximated
+  QFont font = textBoxFont(painterFont, atts);
+  QFontMetricsF metrics(font);
+  double height = metrics.height() - 1.;
+  double totalHeight = height * texts.size();
+
+  double yoffset = 0.;
+  if(atts.testFlag(textatt::ABOVE))
+    yoffset = -totalHeight;
+  else if(!atts.testFlag(textatt::BELOW))
+    yoffset = -totalHeight / 2.;
+
+  QRectF rect;
+  for(const QString& text : texts)
+  {
+    QRectF boundingRect = labelTextFromCache(font, metrics, text)->boundingRect;
+    double newx = x;
+    if(atts.testFlag(textatt::LEFT))
+      newx -= boundingRect.width();
+    else if(atts.testFlag(textatt::CENTER))
+      newx -= boundingRect.width() / 2.;
+
+    boundingRect.moveTo(newx, y + yoffset);
+    rect = rect.isNull() ? boundingRect : rect.united(boundingRect);
+    yoffset += height;
+  }
+  return rect.marginsAdded(QMarginsF(2., 1., 2., 1.));
+}
+
+void SymbolPainter::textBoxFInternal(QPainter *painter, QStringList texts, QPen textPen, float x, float y,
+                                     textatt::TextAttributes atts, int transparency, const QColor& backgroundColor)
 {
   // Added margins to background retangle to avoid letters touching the border
   // Windows needs different margins due to fontengine=freetype
@@ -1421,26 +1615,7 @@ void SymbolPainter::textBoxF(QPainter *painter, QStringList texts, QPen textPen,
   // Text attributes =============================================
   if(atts.testFlag(textatt::ITALIC) || atts.testFlag(textatt::BOLD) || atts.testFlag(textatt::UNDERLINE) ||
      atts.testFlag(textatt::OVERLINE) || atts.testFlag(textatt::STRIKEOUT))
-  {
-    QFont f = painter->font();
-
-    if(atts.testFlag(textatt::BOLD))
-      f.setBold(true);
-
-    if(atts.testFlag(textatt::ITALIC))
-      f.setItalic(true);
-
-    if(atts.testFlag(textatt::UNDERLINE))
-      f.setUnderline(true);
-
-    if(atts.testFlag(textatt::OVERLINE))
-      f.setOverline(true);
-
-    if(atts.testFlag(textatt::STRIKEOUT))
-      f.setStrikeOut(true);
-
-    painter->setFont(f);
-  }
+    painter->setFont(textBoxFont(painter->font(), atts));
 
   // Calculate font sizes =========================
   QFontMetricsF metrics(painter->font());
@@ -1463,9 +1638,13 @@ void SymbolPainter::textBoxF(QPainter *painter, QStringList texts, QPen textPen,
   painter->setPen(Qt::NoPen);
 
   QVector<QPointF> textPt;
+  QVector<QStaticText> staticTexts;
   for(const QString& text : qAsConst(texts))
   {
-    QRectF boundingRect = metrics.boundingRect(text);
+    // Use pre-shaped text and measured bounding rectangle from cache
+    const LabelText *label = labelTextFromCache(painter->font(), metrics, text);
+    staticTexts.append(label->staticText);
+    QRectF boundingRect = label->boundingRect;
     double w = boundingRect.width();
     double newx = x;
     if(atts.testFlag(textatt::LEFT))
@@ -1510,9 +1689,27 @@ void SymbolPainter::textBoxF(QPainter *painter, QStringList texts, QPen textPen,
   painter->setPen(textPen);
 
   // Draw texts =================================
-  QPointF ascent(0., metrics.ascent());
-  for(int i = 0; i < texts.size(); i++)
-    painter->drawText(textPt.at(i) + ascent, texts.at(i));
+  // Static text is positioned using the top left corner and not the baseline
+  for(int i = 0; i < staticTexts.size(); i++)
+    painter->drawStaticText(textPt.at(i), staticTexts.at(i));
+}
+
+const SymbolPainter::LabelText *SymbolPainter::labelTextFromCache(const QFont& font, const QFontMetricsF& metrics,
+                                                                   const QString& text)
+{
+  QString key = font.key() % QChar('\x1f') % text;
+  LabelText *label = labelTexts.object(key);
+  if(label == nullptr)
+  {
+    label = new LabelText;
+    label->staticText.setText(text);
+    label->staticText.setTextFormat(Qt::PlainText);
+    label->staticText.setPerformanceHint(QStaticText::AggressiveCaching);
+    label->staticText.prepare(QTransform(), font);
+    label->boundingRect = metrics.boundingRect(text);
+    labelTexts.insert(key, label);
+  }
+  return label;
 }
 
 QRectF SymbolPainter::textBoxSize(QPainter *painter, const QStringList& texts, textatt::TextAttributes atts)
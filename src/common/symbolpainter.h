@@ -26,6 +26,7 @@
 #include <QIcon>
 #include <QCoreApplication>
 #include <QCache>
+#include <QStaticText>
 
 namespace atools {
 namespace fs {
@@ -36,6 +37,7 @@ class MetarParser;
 }
 }
 
+class LabelPlacement;
 class QPainter;
 class QPen;
 
@@ -53,6 +55,7 @@ struct MapAirspace;
 struct MapAirway;
 struct MapHelipad;
 struct MapAirportMsa;
+struct AirportWeatherSummary;
 }
 
 /*
@@ -97,6 +100,11 @@ public:
   void drawAirportWeather(QPainter *painter, const atools::fs::weather::Metar& metar,
                           float x, float y, float size, bool windPointer, bool windBarbs, bool fast);
 
+  /* Same as above but uses the METAR summary and blits a pre-rendered symbol from a pixmap cache. Wind speed is
+   * rounded to five knots and direction to five degrees. Used for map display where many airports show the same symbol. */
+  void drawAirportWeatherCached(QPainter *painter, const map::AirportWeatherSummary& weather,
+                                float x, float y, float size, bool windPointer, bool windBarbs, bool fast);
+
   /* Wind arrow */
   void drawWindPointer(QPainter *painter, float x, float y, float size, float dir);
 
@@ -104,6 +112,11 @@ public:
   void drawAirportMsa(QPainter *painter, const map::MapAirportMsa& airportMsa, float x, float y, float size, float symbolScale, bool header,
                       bool transparency, bool fast);
 
+  /* Same as above but blits a pre-rendered symbol from a pixmap cache keyed by MSA id, size, scale, font and units.
+   * Symbol size on the screen does not depend on zoom which allows to reuse the pixmap across frames. */
+  void drawAirportMsaCached(QPainter *painter, const map::MapAirportMsa& airportMsa, float x, float y, float size, float symbolScale,
+                            bool header, bool transparency, bool fast);
+
   /* Aircraft track */
   void drawTrackLine(QPainter *painter, float x, float y, int size, float dir);
 
@@ -157,6 +170,21 @@ public:
                 textatt::TextAttributes atts = textatt::NONE,
                 int transparency = 255, const QColor& backgroundColor = QColor());
 
+  /* Submit all texts of textBoxF() to the shared label placement using the given priority from label::Priority
+   * instead of drawing them directly. Labels colliding with ones of higher priority are not drawn.
+   * Pass null to draw directly again. */
+  void setLabelPlacement(LabelPlacement *placement, int priority)
+  {
+    labelPlacement = placement;
+    labelPriority = priority;
+  }
+
+  /* Remove all pre-shaped label texts */
+  void clearLabelCache()
+  {
+    labelTexts.clear();
+  }
+
   /* Get dimensions of a custom text box */
   QRectF textBoxSize(QPainter *painter, const QStringList& texts, textatt::TextAttributes atts);
 
@@ -170,10 +198,43 @@ public:
 private:
   QStringList airportTexts(optsd::DisplayOptionsAirport dispOpts, textflags::TextFlags flags,
                            const map::MapAirport& airport, int maxTextLength);
+  static QString airportMsaHeader(const map::MapAirportMsa& airportMsa);
   const QPixmap *windPointerFromCache(int size);
   const QPixmap *trackLineFromCache(int size);
 
   QCache<int, QPixmap> windPointerPixmaps, trackLinePixmaps;
+
+  /* Pre-rendered airport weather symbols keyed by flight rules, coverage, wind, size and flags */
+  QCache<quint64, QPixmap> weatherPixmaps{1000};
+
+  /* Pre-rendered airport MSA symbols */
+  QCache<QString, QPixmap> msaPixmaps{200};
+
+  /* Pre-shaped label text and bounding rectangle as measured by QFontMetricsF */
+  struct LabelText
+  {
+    QStaticText staticText;
+    QRectF boundingRect;
+  };
+
+  /* Get label from cache or create it. Key contains font key and text. A changed font results in new entries
+   * while old ones are dropped by the cache later. Colors are not part of the key since they are set by the pen. */
+  static QFont textBoxFont(QFont font, textatt::TextAttributes atts);
+
+  /* Screen rectangle covered by textBoxF() including background */
+  QRectF textBoxRect(const QFont& painterFont, const QStringList& texts, float x, float y, textatt::TextAttributes atts);
+  void textBoxFInternal(QPainter *painter, QStringList texts, QPen textPen, float x, float y, textatt::TextAttributes atts,
+                        int transparency, const QColor& backgroundColor);
+
+  LabelPlacement *labelPlacement = nullptr;
+  int labelPriority = 0;
+
+  const LabelText *labelTextFromCache(const QFont& font, const QFontMetricsF& metrics, const QString& text);
+  QCache<QString, LabelText> labelTexts{5000};
+
+  /* Flight rules and coverage are values of the enums MetarParser::FlightRules and MetarCloud::Coverage */
+  void drawAirportWeatherInternal(QPainter *painter, int flightRules, int maxCoverage, float wind, float gust, float dir,
+                                  float x, float y, float size, bool windPointer, bool windBarbs, bool fast);
   static void prepareForIcon(QPainter& painter);
 
   void drawWindBarbs(QPainter *painter, const atools::fs::weather::MetarParser& parsedMetar, float x, float y,
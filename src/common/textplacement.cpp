@@ -16,6 +16,7 @@
 *****************************************************************************/
 
 #include "common/coordinateconverter.h"
+#include "common/framearena.h"
 #include "common/textplacement.h"
 
 #include "geo/line.h"
@@ -35,8 +36,8 @@ using atools::geo::LineString;
 using atools::geo::Pos;
 
 TextPlacement::TextPlacement(QPainter *painterParam, const CoordinateConverter *coordinateConverter,
-                             const QRect& screenRectParam)
-  : painter(painterParam), converter(coordinateConverter)
+                             const QRect& screenRectParam, FrameArena *frameArenaParam)
+  : painter(painterParam), converter(coordinateConverter), frameArena(frameArenaParam)
 {
   arrowRight = tr(" ►");
   arrowLeft = tr("◄ ");
@@ -311,13 +312,17 @@ bool TextPlacement::findTextPosInternal(const Line& line, float distanceMeter, f
   if(!line.isValid())
     return false;
 
+  // Use a local arena if none given - this does not allocate before first use
+  FrameArena localArena;
+  FrameArena::Scope scratch(frameArena != nullptr ? *frameArena : localArena);
+
   // Split line into a number of positions ============================================
-  LineString positions;
+  LineString& positions = scratch.lineString();
   line.interpolatePoints(distanceMeter, numPoints - 1, positions);
   positions.append(line.getPos2());
 
   // Collect positions which are not hidden ============================================
-  QPolygonF points;
+  QPolygonF& points = scratch.polygon();
   double lineLength = 0.;
   bool firstVisible = false, lastVisible = false;
   for(int i = 0; i < positions.size(); i++)
@@ -349,8 +354,8 @@ bool TextPlacement::findTextPosInternal(const Line& line, float distanceMeter, f
     QRectF screenRectF = screenRect;
 
     // Calculate bearing and do some first rough filtering ============================================
-    QVector<int> pointsIdxValid; // Index into "points" of fully or partially visible points
-    QVector<double> bearingsValid; // Same size vector as above
+    QVector<int>& pointsIdxValid = scratch.ints(); // Index into "points" of fully or partially visible points
+    QVector<double>& bearingsValid = scratch.doubles(); // Same size vector as above
     for(int i = 0; i < points.size(); i++)
     {
       const QPointF& pt = points.at(i);
@@ -394,8 +399,8 @@ bool TextPlacement::findTextPosInternal(const Line& line, float distanceMeter, f
       QPolygonF screenPolygon({screenRect.topLeft(), screenRect.topRight(), screenRect.bottomRight(), screenRect.bottomLeft(),
                                screenRect.topLeft()});
 
-      QVector<int> fullyVisibleValid /* Index into "pointsIdxValid". Fully within screen rect */,
-                   partiallyVisibleValid /* Index into "pointsIdxValid". Only touching screen rect */;
+      QVector<int>& fullyVisibleValid = scratch.ints(); // Index into "pointsIdxValid". Fully within screen rect
+      QVector<int>& partiallyVisibleValid = scratch.ints(); // Index into "pointsIdxValid". Only touching screen rect
       QMatrix matrix;
       for(int i = 0; i < pointsIdxValid.size(); i++)
       {
@@ -38,6 +38,7 @@ class Pos;
 class QPainter;
 class QFontMetricsF;
 class CoordinateConverter;
+class FrameArena;
 
 /* Contains methods for text placement along line strings.
  * Texts can be separated by '\n' which will be considered as line break.
@@ -48,7 +49,9 @@ class TextPlacement
   Q_DECLARE_TR_FUNCTIONS(TextPlacement)
 
 public:
-  TextPlacement(QPainter *painterParam, const CoordinateConverter *coordinateConverter, const QRect& screenRectParam);
+  /* frameArenaParam is optional and provides temporary containers for the text position search */
+  TextPlacement(QPainter *painterParam, const CoordinateConverter *coordinateConverter, const QRect& screenRectParam,
+                FrameArena *frameArenaParam = nullptr);
 
   /* Prepare for drawTextAlongLines and also fills data for getVisibleStartPoints and getStartPoints.
    *  Lines do not have to form a connected linestring. */
@@ -192,6 +195,7 @@ private:
   bool fast = false, textOnTopOfLine = true, textOnLineCenter = false, arrowForEmpty = false;
   QPainter *painter = nullptr;
   const CoordinateConverter *converter = nullptr;
+  FrameArena *frameArena = nullptr;
   QString arrowRight, arrowLeft, sectionSeparator;
   float lineWidth = 10.f;
   QVector<QColor> colors;
@@ -22,17 +22,22 @@
 #include "geo/pos.h"
 
 #include <QStringBuilder>
+#include <QVector>
 
 namespace ageo = atools::geo;
 
-const static QString COORDS_DEC_FORMAT_LONX("%L1° %L2");
-const static QString COORDS_DEC_FORMAT_LATY("%L1° %L2");
-const static QString COORDS_DMS_FORMAT_LONX("%L1° %L2' %L3\" %L4");
-const static QString COORDS_DMS_FORMAT_LATY("%L1° %L2' %L3\" %L4");
-const static QString COORDS_DM_FORMAT_LONX("%L1° %L2' %L3");
-const static QString COORDS_DM_FORMAT_LATY("%L1° %L2' %L3");
-const static QString COORDS_DM_GOOGLE_FORMAT_LONX("%1 %2");
-const static QString COORDS_DM_GOOGLE_FORMAT_LATY("%1 %2");
+/* Separators for coordinate formats */
+const static QString COORDS_DEG("° ");
+const static QString COORDS_MIN("' ");
+const static QString COORDS_SEC("\" ");
+const static QString COORDS_SPACE(" ");
+const static QString COORDS_NORTH("N"), COORDS_SOUTH("S"), COORDS_EAST("E"), COORDS_WEST("W");
+
+/* Cached locale formatted numbers. Index 0 is default locale and index 1 is C locale for narrow. */
+const static int NUM_CACHE_SIZE = 1000; /* Integers 0 to 999 for courses, speeds and other small values */
+const static int NUM_CACHE_HUNDREDS_SIZE = 1000; /* Multiples of 100 up to 99900 for altitudes and flight levels */
+const static int NUM_CACHE_TENTHS_SIZE = 1000; /* 0.0 to 99.9 with one decimal for short distances */
+static QVector<QString> numCache[2], numCacheHundreds[2], numCacheTenths[2];
 
 QLocale *Unit::locale = nullptr;
 QLocale *Unit::clocale = nullptr;
@@ -138,10 +143,67 @@ void Unit::init()
     locale = new QLocale();
     clocale = new QLocale(QLocale::C);
     opts = &OptionData::instance();
+    initNumCache();
     optionsChanged();
   }
 }
 
+void Unit::initNumCache()
+{
+  const QLocale *locales[2] = {locale, clocale};
+  for(int i = 0; i < 2; i++)
+  {
+    numCache[i].clear();
+    numCache[i].reserve(NUM_CACHE_SIZE);
+    for(int num = 0; num < NUM_CACHE_SIZE; num++)
+      numCache[i].append(locales[i]->toString(num));
+
+    numCacheHundreds[i].clear();
+    numCacheHundreds[i].reserve(NUM_CACHE_HUNDREDS_SIZE);
+    for(int num = 0; num < NUM_CACHE_HUNDREDS_SIZE; num++)
+      numCacheHundreds[i].append(locales[i]->toString(num * 100));
+
+    numCacheTenths[i].clear();
+    numCacheTenths[i].reserve(NUM_CACHE_TENTHS_SIZE);
+    for(int num = 0; num < NUM_CACHE_TENTHS_SIZE; num++)
+      numCacheTenths[i].append(locales[i]->toString(num / 10., 'f', 1));
+  }
+}
+
+QString Unit::numStr(float value, bool narrow)
+{
+  int idx = narrow ? 1 : 0;
+
+  // Comparison also excludes NaN and covers cache not being initialized yet
+  if(value > -0.5f && value < NUM_CACHE_HUNDREDS_SIZE * 100.f - 0.5f && !numCache[idx].isEmpty())
+  {
+    int intValue = atools::roundToInt(value);
+    if(intValue < NUM_CACHE_SIZE)
+      return numCache[idx].at(intValue);
+    else if(intValue % 100 == 0)
+      return numCacheHundreds[idx].at(intValue / 100);
+  }
+
+  return (narrow ? clocale : locale)->toString(value, 'f', 0);
+}
+
+QString Unit::numStr(float value, int precision, bool narrow)
+{
+  if(precision == 0)
+    return numStr(value, narrow);
+
+  int idx = narrow ? 1 : 0;
+  if(precision == 1 && value > -0.05f && value < NUM_CACHE_TENTHS_SIZE / 10.f - 0.05f && !numCacheTenths[idx].isEmpty())
+  {
+    // Use double to get the same rounding as QLocale
+    int tenths = atools::roundToInt(static_cast<double>(value) * 10.);
+    if(tenths < NUM_CACHE_TENTHS_SIZE)
+      return numCacheTenths[idx].at(tenths);
+  }
+
+  return (narrow ? clocale : locale)->toString(value, 'f', precision);
+}
+
 void Unit::deInit()
 {
   ATOOLS_DELETE_LOG(locale);
@@ -186,19 +248,13 @@ void Unit::initTranslateableTexts()
 QString Unit::distMeter(float meter, bool addUnit, int minValPrec, bool narrow)
 {
   float localValue = distMeterF(meter);
-  if(narrow)
-    return u(clocale->toString(localValue, 'f', localValue < minValPrec ? 1 : 0), unitDistStr, addUnit, narrow);
-  else
-    return u(locale->toString(localValue, 'f', localValue < minValPrec ? 1 : 0), unitDistStr, addUnit, narrow);
+  return u(numStr(localValue, localValue < minValPrec ? 1 : 0, narrow), unitDistStr, addUnit, narrow);
 }
 
 QString Unit::distNm(float nm, bool addUnit, int minValPrec, bool narrow)
 {
   float localValue = distNmF(nm);
-  if(narrow)
-    return u(clocale->toString(localValue, 'f', localValue < minValPrec ? 1 : 0), unitDistStr, addUnit, narrow);
-  else
-    return u(locale->toString(localValue, 'f', localValue < minValPrec ? 1 : 0), unitDistStr, addUnit, narrow);
+  return u(numStr(localValue, localValue < minValPrec ? 1 : 0, narrow), unitDistStr, addUnit, narrow);
 }
 
 float Unit::distMeterF(float meter)
@@ -380,7 +436,7 @@ QString Unit::speedVertFpm(float fpm, bool addUnit)
   switch(unitVertSpeed)
   {
     case opts::VERT_SPEED_FPM:
-      return locale->toString(fpm, 'f', 0) % (addUnit ? " " % unitVertSpeedStr : QString());
+      return numStr(fpm) % (addUnit ? " " % unitVertSpeedStr : QString());
 
     case opts::VERT_SPEED_MS:
       return locale->toString(ageo::feetToMeter(fpm) / 60.f, 'f', 2) % (addUnit ? " " % unitVertSpeedStr : QString());
@@ -411,7 +467,7 @@ QString Unit::speedVertFpmOther(float fpm, bool addUnit)
 
     case opts::VERT_SPEED_MS:
       // Default is m/s and ft/m input - print ft/m
-      return locale->toString(fpm, 'f', 0) % (addUnit ? " " % suffixVertSpeedFpm : QString());
+      return numStr(fpm) % (addUnit ? " " % suffixVertSpeedFpm : QString());
   }
   return QString();
 
@@ -780,27 +836,16 @@ QString Unit::coordsLonX(const ageo::Pos& pos, opts::UnitCoords coordUnit)
       return QLocale().toString(pos.getLonX(), 'f', 5);
 
     case opts::COORDS_DMS:
-      return COORDS_DMS_FORMAT_LONX.
-             arg(atools::absInt(pos.getLonXDeg())).
-             arg(atools::absInt(pos.getLonXMin())).
-             arg(std::abs(pos.getLonXSec()), 0, 'f', 2).
-             arg(pos.getLonX() > 0.f ? "E" : "W");
+      return coordsDms(pos.getLonXDeg(), pos.getLonXMin(), pos.getLonXSec(), pos.getLonX() > 0.f ? COORDS_EAST : COORDS_WEST);
 
     case opts::COORDS_DEC:
-      return COORDS_DEC_FORMAT_LONX.
-             arg(std::abs(pos.getLonX()), 0, 'f', 4, QChar('0')).
-             arg(pos.getLonX() > 0.f ? "E" : "W");
+      return coordsDec(pos.getLonX(), pos.getLonX() > 0.f ? COORDS_EAST : COORDS_WEST);
 
     case opts::COORDS_DM:
-      return COORDS_DM_FORMAT_LONX.
-             arg(atools::absInt(pos.getLonXDeg())).
-             arg(std::abs(pos.getLonXMin() + pos.getLonXSec() / 60.f), 0, 'f', 2).
-             arg(pos.getLonX() > 0.f ? "E" : "W");
+      return coordsDm(pos.getLonXDeg(), pos.getLonXMin() + pos.getLonXSec() / 60.f, pos.getLonX() > 0.f ? COORDS_EAST : COORDS_WEST);
 
     case opts::COORDS_DECIMAL_GOOGLE:
-      return COORDS_DM_GOOGLE_FORMAT_LONX.
-             arg(pos.getLonXDeg()).
-             arg(std::abs(pos.getLonXMin() + pos.getLonXSec() / 60.f), 0, 'f', 2);
+      return coordsGoogle(pos.getLonXDeg(), pos.getLonXMin() + pos.getLonXSec() / 60.f);
   }
   return QString();
 }
@@ -822,31 +867,45 @@ QString Unit::coordsLatY(const ageo::Pos& pos, opts::UnitCoords coordUnit)
       return QLocale().toString(pos.getLatY(), 'f', 5);
 
     case opts::COORDS_DMS:
-      return COORDS_DMS_FORMAT_LATY.
-             arg(atools::absInt(pos.getLatYDeg())).
-             arg(atools::absInt(pos.getLatYMin())).
-             arg(std::abs(pos.getLatYSec()), 0, 'f', 2).
-             arg(pos.getLatY() > 0.f ? "N" : "S");
+      return coordsDms(pos.getLatYDeg(), pos.getLatYMin(), pos.getLatYSec(), pos.getLatY() > 0.f ? COORDS_NORTH : COORDS_SOUTH);
 
     case opts::COORDS_DEC:
-      return COORDS_DEC_FORMAT_LATY.
-             arg(std::abs(pos.getLatY()), 0, 'f', 4, QChar('0')).
-             arg(pos.getLatY() > 0.f ? "N" : "S");
+      return coordsDec(pos.getLatY(), pos.getLatY() > 0.f ? COORDS_NORTH : COORDS_SOUTH);
 
     case opts::COORDS_DM:
-      return COORDS_DM_FORMAT_LATY.
-             arg(atools::absInt(pos.getLatYDeg())).
-             arg(std::abs(pos.getLatYMin() + pos.getLatYSec() / 60.f), 0, 'f', 2).
-             arg(pos.getLatY() > 0.f ? "N" : "S");
+      return coordsDm(pos.getLatYDeg(), pos.getLatYMin() + pos.getLatYSec() / 60.f, pos.getLatY() > 0.f ? COORDS_NORTH : COORDS_SOUTH);
 
     case opts::COORDS_DECIMAL_GOOGLE:
-      return COORDS_DM_GOOGLE_FORMAT_LATY.
-             arg(pos.getLatYDeg()).
-             arg(std::abs(pos.getLatYMin() + pos.getLatYSec() / 60.f), 0, 'f', 2);
+      return coordsGoogle(pos.getLatYDeg(), pos.getLatYMin() + pos.getLatYSec() / 60.f);
   }
   return QString();
 }
 
+QString Unit::coordsDms(int deg, int min, float sec, const QString& hemisphere)
+{
+  // Format "%L1° %L2' %L3\" %L4"
+  return numStr(atools::absInt(deg)) % COORDS_DEG % numStr(atools::absInt(min)) % COORDS_MIN %
+         locale->toString(std::abs(sec), 'f', 2) % COORDS_SEC % hemisphere;
+}
+
+QString Unit::coordsDm(int deg, float min, const QString& hemisphere)
+{
+  // Format "%L1° %L2' %L3"
+  return numStr(atools::absInt(deg)) % COORDS_DEG % locale->toString(std::abs(min), 'f', 2) % COORDS_MIN % hemisphere;
+}
+
+QString Unit::coordsDec(float value, const QString& hemisphere)
+{
+  // Format "%L1° %L2"
+  return locale->toString(std::abs(value), 'f', 4) % COORDS_DEG % hemisphere;
+}
+
+QString Unit::coordsGoogle(int deg, float min)
+{
+  // Format "%1 %2" using C locale
+  return QString::number(deg) % COORDS_SPACE % QString::number(std::abs(min), 'f', 2);
+}
+
 QString Unit::u(const QString& num, const QString& un, bool addUnit, bool narrow)
 {
   if(narrow)
@@ -864,9 +923,9 @@ QString Unit::u(const QString& num, const QString& un, bool addUnit, bool narrow
 QString Unit::u(float num, const QString& un, bool addUnit, bool narrow)
 {
   if(narrow)
-    return clocale->toString(num, 'f', 0) % (addUnit ? QString() % un : QString());
+    return numStr(num, true /* narrow */) % (addUnit ? QString() % un : QString());
   else
-    return locale->toString(num, 'f', 0) % (addUnit ? " " % un : QString());
+    return numStr(num) % (addUnit ? " " % un : QString());
 }
 
 void Unit::optionsChanged()
@@ -380,6 +380,13 @@ public:
   /* Remove trailing zeroes if the number has a decimal point */
   static QString adjustNum(QString num);
 
+  /* Locale formatted number rounded to integer. narrow uses the C locale.
+   * Frequent values like courses, speeds and altitudes are taken from a cache. */
+  static QString numStr(float value, bool narrow = false);
+
+  /* As above with the given number of decimals. Cache is used for zero and one decimal. */
+  static QString numStr(float value, int precision, bool narrow);
+
 private:
   /* Singleton */
   Unit();
@@ -390,6 +397,15 @@ private:
   static QString localOtherText(bool localBold, bool otherSmall);
   static QString localOtherText2(bool localBold, bool otherSmall);
 
+  /* Fill cache of locale formatted numbers used by numStr() */
+  static void initNumCache();
+
+  /* Coordinate formats used by coordsLonX() and coordsLatY() */
+  static QString coordsDms(int deg, int min, float sec, const QString& hemisphere);
+  static QString coordsDm(int deg, float min, const QString& hemisphere);
+  static QString coordsDec(float value, const QString& hemisphere);
+  static QString coordsGoogle(int deg, float min);
+
   static const OptionData *opts;
   static QLocale *locale, *clocale;
 
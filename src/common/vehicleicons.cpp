@@ -18,37 +18,26 @@
 #include "common/vehicleicons.h"
 
 #include "atools.h"
+#include "common/memoryregistry.h"
 #include "fs/sc/simconnectaircraft.h"
 #include "settings/settings.h"
 
+#include <QApplication>
 #include <QIcon>
 #include <QPainter>
+#include <QSvgRenderer>
+#include <QtConcurrent/QtConcurrentRun>
 
-namespace internal {
+#include <functional>
 
-enum AircraftType
-{
-  AC_SMALL,
-  AC_JET,
-  AC_HELICOPTER,
-  AC_SHIP,
-  AC_CARRIER,
-  AC_FRIGATE
-};
+/* Maximum number of cached pixmaps */
+static const int MAX_PIXMAPS = 500;
 
-/* Key built from all attributes */
-struct PixmapKey
-{
-  bool operator==(const PixmapKey& other) const
-  {
-    return type == other.type && ground == other.ground && user == other.user && size == other.size && rotate == other.rotate &&
-           online == other.online;
-  }
+/* Number of most used sizes rendered in prefetchIcons() and sizes used if nothing was drawn yet */
+static const int PREFETCH_NUM_SIZES = 4;
+static const QVector<int> PREFETCH_DEFAULT_SIZES = {24, 32};
 
-  AircraftType type;
-  bool ground, user, online;
-  int size, rotate;
-};
+namespace internal {
 
 uint qHash(const PixmapKey& key)
 {
@@ -59,12 +48,20 @@ uint qHash(const PixmapKey& key)
 
 VehicleIcons::VehicleIcons()
 {
+  aircraftPixmaps.setMaxCost(MAX_PIXMAPS);
+  connect(&renderWatcher, &QFutureWatcher<QVector<IconRender> >::finished, this, &VehicleIcons::renderingFinished);
 
+  MemoryRegistry::registerCaches(this, [this](QVector<memreg::Usage>& usage) -> void {
+    usage.append(memreg::pixmapCacheUsage("Icons", "Aircraft", aircraftPixmaps));
+  }, [this]() -> void {
+    aircraftPixmaps.clear();
+  });
 }
 
 VehicleIcons::~VehicleIcons()
 {
-
+  renderWatcher.waitForFinished();
+  MemoryRegistry::unregisterCaches(this);
 }
 
 QIcon VehicleIcons::iconFromCache(const atools::fs::sc::SimConnectAircraft& ac, int size, int rotate)
@@ -72,58 +69,66 @@ QIcon VehicleIcons::iconFromCache(const atools::fs::sc::SimConnectAircraft& ac,
   return QIcon(*pixmapFromCache(ac, size, rotate));
 }
 
-const QPixmap *VehicleIcons::pixmapFromCache(const internal::PixmapKey& key, int rotate)
+QString VehicleIcons::iconFilename(const internal::PixmapKey& key)
 {
-  if(aircraftPixmaps.contains(key))
-    return aircraftPixmaps.object(key);
-  else
+  QString name = ":/littlenavmap/resources/icons/aircraft";
+  switch(key.type)
   {
-    int size = key.size;
-    QString name = ":/littlenavmap/resources/icons/aircraft";
-    switch(key.type)
-    {
-      case internal::AC_SMALL:
-        name += "_small";
-        break;
-      case internal::AC_JET:
-        name += "_jet";
-        break;
-      case internal::AC_HELICOPTER:
-        name += "_helicopter";
-        // Make helicopter a bit bigger due to image
-        size = atools::roundToInt(size * 1.2f);
-        break;
-      case internal::AC_SHIP:
-        name += "_boat";
-        break;
-      case internal::AC_CARRIER:
-        name += "_carrier";
-        break;
-      case internal::AC_FRIGATE:
-        name += "_frigate";
-        break;
-    }
+    case internal::AC_SMALL:
+      name += "_small";
+      break;
+    case internal::AC_JET:
+      name += "_jet";
+      break;
+    case internal::AC_HELICOPTER:
+      name += "_helicopter";
+      break;
+    case internal::AC_SHIP:
+      name += "_boat";
+      break;
+    case internal::AC_CARRIER:
+      name += "_carrier";
+      break;
+    case internal::AC_FRIGATE:
+      name += "_frigate";
+      break;
+  }
+
+  if(key.ground)
+    name += "_ground";
 
-    if(key.ground)
-      name += "_ground";
+  // User aircraft always yellow
+  if(!key.online && key.user)
+    // No user key for online
+    name += "_user";
 
-    // User aircraft always yellow
-    if(!key.online && key.user)
-      // No user key for online
-      name += "_user";
+  // Dark online icon not for user aircraft
+  if(key.online && !key.user)
+    name += "_online";
 
-    // Dark online icon not for user aircraft
-    if(key.online && !key.user)
-      name += "_online";
+  name = atools::settings::Settings::getOverloadedPath(name + ".svg", true /* ignoreMissing */);
 
-    name = atools::settings::Settings::getOverloadedPath(name + ".svg", true /* ignoreMissing */);
+  // Check if SVG exists
+  if(name.isEmpty())
+    name = ":/littlenavmap/resources/icons/aircraft_unknown.svg";
+  return name;
+}
 
-    // Check if SVG exists
-    if(name.isEmpty())
-      name = ":/littlenavmap/resources/icons/aircraft_unknown.svg";
+int VehicleIcons::iconPixmapSize(const internal::PixmapKey& key)
+{
+  // Make helicopter a bit bigger due to image
+  return key.type == internal::AC_HELICOPTER ? atools::roundToInt(key.size * 1.2f) : key.size;
+}
 
+const QPixmap *VehicleIcons::pixmapFromCache(const internal::PixmapKey& key, int rotate)
+{
+  if(aircraftPixmaps.contains(key))
+    return aircraftPixmaps.object(key);
+  else
+  {
+    int size = iconPixmapSize(key);
     QPixmap *newPx = nullptr;
-    QPixmap pixmap = QIcon(name).pixmap(QSize(size, size));
+    QPixmap pixmap = QIcon(iconFilename(key)).pixmap(QSize(size, size));
     if(rotate == 0)
       newPx = new QPixmap(pixmap);
     else
@@ -148,7 +153,140 @@ const QPixmap *VehicleIcons::pixmapFromCache(const internal::PixmapKey& key, int
   }
 }
 
-const QPixmap *VehicleIcons::pixmapFromCache(const atools::fs::sc::SimConnectAircraft& ac, int size, int rotate)
+const QPixmap *VehicleIcons::pixmapFromCacheNearest(const atools::fs::sc::SimConnectAircraft& ac, int size, int& pixmapSize)
+{
+  internal::PixmapKey key = keyFromAircraft(ac, size, 0);
+  sizeCounts[size]++;
+
+  const QPixmap *pixmap = aircraftPixmaps.object(key);
+  if(pixmap != nullptr)
+  {
+    pixmapSize = size;
+    return pixmap;
+  }
+
+  // Look for the same icon in other sizes while the requested one is rendered
+  int nearestSize = -1;
+  const QList<internal::PixmapKey> keys = aircraftPixmaps.keys();
+  for(const internal::PixmapKey& other : keys)
+  {
+    if(other.type == key.type && other.ground == key.ground && other.user == key.user && other.online == key.online &&
+       other.rotate == 0 && (nearestSize == -1 || std::abs(other.size - size) < std::abs(nearestSize - size)))
+      nearestSize = other.size;
+  }
+
+  if(nearestSize == -1)
+  {
+    // Nothing to fall back to - render now
+    pixmapSize = size;
+    return pixmapFromCache(key, 0);
+  }
+
+  requestIcon(key);
+  startRendering();
+
+  key.size = pixmapSize = nearestSize;
+  return aircraftPixmaps.object(key);
+}
+
+void VehicleIcons::prefetchIcons()
+{
+  // Get most used sizes
+  QVector<std::pair<int, int> > counts;
+  for(auto it = sizeCounts.constBegin(); it != sizeCounts.constEnd(); ++it)
+    counts.append(std::make_pair(it.value(), it.key()));
+  std::sort(counts.begin(), counts.end(), std::greater<std::pair<int, int> >());
+
+  QVector<int> sizes;
+  for(int i = 0; i < counts.size() && i < PREFETCH_NUM_SIZES; i++)
+    sizes.append(counts.at(i).second);
+
+  if(sizes.isEmpty())
+    sizes = PREFETCH_DEFAULT_SIZES;
+
+  // All types which can appear for AI and online aircraft
+  for(int size : sizes)
+  {
+    for(internal::AircraftType type : {internal::AC_SMALL, internal::AC_JET, internal::AC_HELICOPTER, internal::AC_SHIP,
+                                       internal::AC_CARRIER, internal::AC_FRIGATE})
+    {
+      for(bool ground : {false, true})
+      {
+        for(bool online : {false, true})
+          requestIcon({type, ground, false /* user */, online, size, 0 /* rotate */});
+      }
+    }
+  }
+
+#ifdef DEBUG_INFORMATION
+  qDebug() << Q_FUNC_INFO << "sizes" << sizes << "queued" << renderQueue.size();
+#endif
+  startRendering();
+}
+
+void VehicleIcons::requestIcon(const internal::PixmapKey& key)
+{
+  if(!aircraftPixmaps.contains(key) && !renderKeys.contains(key))
+  {
+    // Settings path lookup is done in the GUI thread
+    renderQueue.append({key, iconFilename(key), iconPixmapSize(key), QImage()});
+    renderKeys.insert(key);
+  }
+}
+
+void VehicleIcons::startRendering()
+{
+  if(renderWatcher.isRunning() || renderQueue.isEmpty())
+    return;
+
+  QVector<IconRender> icons;
+  icons.swap(renderQueue);
+  qreal pixelRatio = qApp->devicePixelRatio();
+
+  renderWatcher.setFuture(QtConcurrent::run([icons, pixelRatio]() -> QVector<IconRender> {
+    QVector<IconRender> rendered(icons);
+    for(IconRender& icon : rendered)
+      icon.image = renderIcon(icon.filename, icon.pixmapSize, pixelRatio);
+    return rendered;
+  }));
+}
+
+void VehicleIcons::renderingFinished()
+{
+  const QVector<IconRender> icons = renderWatcher.result();
+  for(const IconRender& icon : icons)
+  {
+    renderKeys.remove(icon.key);
+    if(!icon.image.isNull())
+      // Pixmaps have to be created in the GUI thread
+      aircraftPixmaps.insert(icon.key, new QPixmap(QPixmap::fromImage(icon.image)));
+  }
+
+  // Continue with icons requested in the meantime
+  startRendering();
+  emit iconsLoaded();
+}
+
+QImage VehicleIcons::renderIcon(const QString& filename, int size, qreal pixelRatio)
+{
+  QSvgRenderer renderer(filename);
+  if(!renderer.isValid())
+    return QImage();
+
+  int deviceSize = atools::roundToInt(size * pixelRatio);
+  QImage image(deviceSize, deviceSize, QImage::Format_ARGB32_Premultiplied);
+  image.fill(Qt::transparent);
+  {
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    renderer.render(&painter, QRectF(0., 0., deviceSize, deviceSize));
+  }
+  image.setDevicePixelRatio(pixelRatio);
+  return image;
+}
+
+internal::PixmapKey VehicleIcons::keyFromAircraft(const atools::fs::sc::SimConnectAircraft& ac, int size, int rotate)
 {
   internal::PixmapKey key;
 
@@ -175,5 +313,17 @@ const QPixmap *VehicleIcons::pixmapFromCache(const atools::fs::sc::SimConnectAir
   key.user = ac.isUser();
   key.size = size;
   key.rotate = rotate;
-  return pixmapFromCache(key, rotate);
+  return key;
+}
+
+const QPixmap *VehicleIcons::pixmapFromCache(const atools::fs::sc::SimConnectAircraft& ac, int size, int rotate)
+{
+  return pixmapFromCache(keyFromAircraft(ac, size, rotate), rotate);
+}
+
+quint32 VehicleIcons::iconKey(const atools::fs::sc::SimConnectAircraft& ac)
+{
+  internal::PixmapKey key = keyFromAircraft(ac, 0, 0);
+  return static_cast<quint32>(key.type) | static_cast<quint32>(key.ground) << 4 | static_cast<quint32>(key.user) << 5 |
+         static_cast<quint32>(key.online) << 6;
 }
@@ -19,6 +19,10 @@
 #define LNM_VEHICLEICONS_H
 
 #include <QCache>
+#include <QFutureWatcher>
+#include <QImage>
+#include <QObject>
+#include <QSet>
 
 namespace atools {
 namespace fs {
@@ -32,18 +36,49 @@ class QIcon;
 class QPixmap;
 
 namespace internal {
-struct PixmapKey;
+
+enum AircraftType
+{
+  AC_SMALL,
+  AC_JET,
+  AC_HELICOPTER,
+  AC_SHIP,
+  AC_CARRIER,
+  AC_FRIGATE
+};
+
+/* Key built from all attributes */
+struct PixmapKey
+{
+  bool operator==(const PixmapKey& other) const
+  {
+    return type == other.type && ground == other.ground && user == other.user && size == other.size && rotate == other.rotate &&
+           online == other.online;
+  }
+
+  AircraftType type;
+  bool ground, user, online;
+  int size, rotate;
+};
+
+uint qHash(const PixmapKey& key);
+
 }
 
 /*
  * Caches pixmaps generated from SVG graphic files for aircraft, boat, helicopter, etc.
+ *
+ * Unrotated pixmaps for the map can be rendered in a background thread to avoid stutters when many
+ * AI or online aircraft appear at once.
  */
-class VehicleIcons
+class VehicleIcons :
+  public QObject
 {
+  Q_OBJECT
 
 public:
   VehicleIcons();
-  ~VehicleIcons();
+  virtual ~VehicleIcons() override;
 
   VehicleIcons(const VehicleIcons& other) = delete;
   VehicleIcons& operator=(const VehicleIcons& other) = delete;
@@ -51,10 +86,55 @@ public:
   QIcon iconFromCache(const atools::fs::sc::SimConnectAircraft& ac, int size, int rotate);
   const QPixmap *pixmapFromCache(const atools::fs::sc::SimConnectAircraft& ac, int size, int rotate);
 
+  /* Get unrotated pixmap without blocking. Returns the cached pixmap of the same icon having the nearest size
+   * if the requested size is not available yet and starts rendering it in background.
+   * pixmapSize is set to the size of the returned pixmap. Renders immediately if no size of the icon is cached. */
+  const QPixmap *pixmapFromCacheNearest(const atools::fs::sc::SimConnectAircraft& ac, int size, int& pixmapSize);
+
+  /* Render all AI, multiplayer and online vehicle icons in background for the most used sizes. Called on connect. */
+  void prefetchIcons();
+
+  /* Seven bit key built from all attributes except size and rotation which change the icon. Used for the symbol atlas. */
+  static quint32 iconKey(const atools::fs::sc::SimConnectAircraft& ac);
+
+signals:
+  /* Icons rendered in background were added to the cache. Map needs a redraw. */
+  void iconsLoaded();
+
 private:
+  /* Icon to be rendered and result from background thread */
+  struct IconRender
+  {
+    internal::PixmapKey key;
+    QString filename;
+    int pixmapSize;
+    QImage image;
+  };
+
   const QPixmap *pixmapFromCache(const internal::PixmapKey& key, int rotate);
+  static internal::PixmapKey keyFromAircraft(const atools::fs::sc::SimConnectAircraft& ac, int size, int rotate);
+
+  /* Get SVG filename and size of the pixmap considering the helicopter scale for key */
+  static QString iconFilename(const internal::PixmapKey& key);
+  static int iconPixmapSize(const internal::PixmapKey& key);
+
+  /* Queue icon for background rendering if not already cached, queued or running */
+  void requestIcon(const internal::PixmapKey& key);
+  void startRendering();
+  void renderingFinished();
+
+  /* Called in background thread */
+  static QImage renderIcon(const QString& filename, int size, qreal pixelRatio);
 
   QCache<internal::PixmapKey, QPixmap> aircraftPixmaps;
+
+  /* Icons waiting for rendering and keys of all waiting or currently rendered icons */
+  QVector<IconRender> renderQueue;
+  QSet<internal::PixmapKey> renderKeys;
+  QFutureWatcher<QVector<IconRender> > renderWatcher;
+
+  /* Number of requests for each size of unrotated icons */
+  QHash<int, int> sizeCounts;
 };
 
 #endif // LNM_VEHICLEICONS_H
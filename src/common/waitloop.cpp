@@ -0,0 +1,80 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "common/waitloop.h"
+
+#include <QEventLoop>
+#include <QProgressDialog>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace waitloop {
+
+bool run(QProgressDialog& dialog, const std::function<bool(bool canceled)>& tick, int intervalMs)
+{
+  // Remember cancel here since QProgressDialog::reset() clears the flag on auto reset
+  bool canceled = false;
+  QMetaObject::Connection connection = QObject::connect(&dialog, &QProgressDialog::canceled, [&canceled]() -> void {
+    canceled = true;
+  });
+
+  if(!tick(canceled))
+  {
+    QEventLoop loop;
+    QTimer timer;
+    timer.setInterval(intervalMs);
+    QObject::connect(&timer, &QTimer::timeout, &loop, [&loop, &tick, &canceled]() -> void {
+      if(tick(canceled))
+        loop.quit();
+    });
+    timer.start();
+    loop.exec(QEventLoop::AllEvents);
+  }
+
+  QObject::disconnect(connection);
+  return !canceled;
+}
+
+bool waitForFutures(QProgressDialog& dialog, const QVector<QFuture<void> >& futures, Progress *progress)
+{
+  return run(dialog, [&dialog, &futures, progress](bool canceled) -> bool {
+    if(canceled && progress != nullptr)
+      progress->canceled = true;
+
+    int numFinished = static_cast<int>(std::count_if(futures.constBegin(), futures.constEnd(), [](const QFuture<void>& future) {
+      return future.isFinished();
+    }));
+
+    if(!canceled)
+    {
+      if(progress != nullptr && progress->maximum > 0)
+      {
+        dialog.setMaximum(progress->maximum);
+        dialog.setValue(progress->value);
+      }
+      else
+      {
+        dialog.setMaximum(futures.size());
+        dialog.setValue(numFinished);
+      }
+    }
+    return numFinished == futures.size();
+  });
+}
+
+} // namespace waitloop
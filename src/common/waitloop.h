@@ -0,0 +1,58 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_WAITLOOP_H
+#define LNM_WAITLOOP_H
+
+#include <QVector>
+#include <QFuture>
+
+#include <atomic>
+#include <functional>
+
+class QProgressDialog;
+
+/*
+ * Keeps the GUI responsive while waiting for long running work with a progress dialog.
+ *
+ * Runs a local event loop like QDialog::exec() instead of calling QApplication::processEvents()
+ * and sleeping in a loop. Work is done in worker threads or in short slices by the tick function.
+ * The progress dialog should be application or window modal to keep user input away from other windows.
+ */
+namespace waitloop {
+
+/* Progress and cancel flag shared between a worker thread and the GUI thread */
+struct Progress
+{
+  std::atomic_int value{0}, maximum{0};
+  std::atomic_bool canceled{false};
+};
+
+/* Runs the event loop and calls tick every intervalMs milliseconds in the GUI thread until it returns true.
+ * canceled is true once the user pressed the cancel button of the dialog.
+ * tick has to keep returning false until all workers have stopped.
+ * Returns false if canceled. */
+bool run(QProgressDialog& dialog, const std::function<bool(bool canceled)>& tick, int intervalMs = 50);
+
+/* Waits for all futures and updates the dialog from progress if given and its maximum is not 0.
+ * Shows number of finished futures otherwise. Sets progress->canceled if the user cancels.
+ * Returns false if canceled. */
+bool waitForFutures(QProgressDialog& dialog, const QVector<QFuture<void> >& futures, Progress *progress = nullptr);
+
+} // namespace waitloop
+
+#endif // LNM_WAITLOOP_H
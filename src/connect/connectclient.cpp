@@ -19,12 +19,14 @@
 
 #include "app/navapp.h"
 #include "common/constants.h"
+#include "connect/sessionrecorder.h"
 #include "fs/sc/simconnectreply.h"
 #include "fs/sc/datareaderthread.h"
 #include "gui/dialog.h"
 #include "gui/helphandler.h"
 #include "online/onlinedatacontroller.h"
 #include "gui/mainwindow.h"
+#include "query/querytypes.h"
 #include "geo/calculations.h"
 #include "settings/settings.h"
 #include "fs/sc/simconnecthandler.h"
@@ -32,8 +34,10 @@
 #include "fs/scenery/languagejson.h"
 #include "fs/scenery/aircraftindex.h"
 #include "util/version.h"
+#include "web/webcontroller.h"
 
 #include <QDataStream>
+#include <QElapsedTimer>
 #include <QTcpSocket>
 #include <QWidget>
 #include <QCoreApplication>
@@ -46,6 +50,9 @@ using atools::fs::sc::DataReaderThread;
 
 const static int FLUSH_QUEUE_MS = 50;
 
+/* Check web clients for update rate demand */
+const static int WEB_RATE_DEMAND_CHECK_MS = 1000;
+
 /* Any metar fetched from the Simulator will time out in 15 seconds */
 const static int WEATHER_TIMEOUT_FS_SECS = 15;
 const static int NOT_AVAILABLE_TIMEOUT_FS_SECS = 300;
@@ -75,6 +82,7 @@ ConnectClient::ConnectClient(MainWindow *parent)
   directReconnectSimSec = settings.getAndStoreValue(lnm::OPTIONS_DATAREADER_RECONNECT_SIM, 15).toInt();
   directReconnectXpSec = settings.getAndStoreValue(lnm::OPTIONS_DATAREADER_RECONNECT_XP, 5).toInt();
   socketReconnectSec = settings.getAndStoreValue(lnm::OPTIONS_DATAREADER_RECONNECT_SOCKET, 10).toInt();
+  lowUpdateRateMs = settings.getAndStoreValue(lnm::OPTIONS_DATAREADER_LOW_UPDATE_RATE, 1000).toUInt();
 
   if(simConnectHandler->isLoaded())
   {
@@ -88,6 +96,11 @@ ConnectClient::ConnectClient(MainWindow *parent)
   }
 
   connect(dataReader, &DataReaderThread::postSimConnectData, this, &ConnectClient::postSimConnectData);
+
+  // Invalidate caches depending on weather before any other receiver is notified
+  connect(this, &ConnectClient::weatherUpdated, this, []() -> void {
+    query::incrementRevision(query::REV_WEATHER);
+  });
   connect(dataReader, &DataReaderThread::postStatus, this, &ConnectClient::statusPosted);
   connect(dataReader, &DataReaderThread::connectedToSimulator, this, &ConnectClient::connectedToSimulatorDirect);
   connect(dataReader, &DataReaderThread::disconnectedFromSimulator, this, &ConnectClient::disconnectedFromSimulatorDirect);
@@ -106,6 +119,19 @@ ConnectClient::ConnectClient(MainWindow *parent)
   flushQueuedRequestsTimer.setInterval(FLUSH_QUEUE_MS);
   connect(&flushQueuedRequestsTimer, &QTimer::timeout, this, &ConnectClient::flushQueuedRequests);
   flushQueuedRequestsTimer.start();
+
+  webRateDemandTimer.setInterval(WEB_RATE_DEMAND_CHECK_MS);
+  connect(&webRateDemandTimer, &QTimer::timeout, this, &ConnectClient::updateWebRateDemand);
+  webRateDemandTimer.start();
+
+  // Replayed packets are processed like received ones - measure time including all receivers
+  sessionRecorder = new SessionRecorder(this);
+  connect(sessionRecorder, &SessionRecorder::replayPacket, this, [this](const atools::fs::sc::SimConnectData& data) -> void {
+    QElapsedTimer timer;
+    timer.start();
+    postSimConnectData(data);
+    sessionRecorder->addPacketTime(timer.nsecsElapsed());
+  });
 }
 
 ConnectClient::~ConnectClient()
@@ -114,6 +140,7 @@ ConnectClient::~ConnectClient()
 
   flushQueuedRequestsTimer.stop();
   reconnectNetworkTimer.stop();
+  webRateDemandTimer.stop();
 
   disconnectClicked();
 
@@ -253,6 +280,7 @@ void ConnectClient::disconnectedFromSimulatorDirect()
   queuedRequests.clear();
   queuedRequestIdents.clear();
   notAvailableStations.clear();
+  aiIndexByObjectId.clear();
 
   if(!NavApp::isShuttingDown())
   {
@@ -264,9 +292,32 @@ void ConnectClient::disconnectedFromSimulatorDirect()
   manualDisconnect = false;
 }
 
+const atools::fs::sc::SimConnectAircraft *ConnectClient::getAiAircraftByObjectId(const atools::fs::sc::SimConnectData& data,
+                                                                                  unsigned int objectId) const
+{
+  const QVector<atools::fs::sc::SimConnectAircraft>& aiAircraft = data.getAiAircraftConst();
+
+  // Check index first - verify object id in case the packet is not the last one posted
+  int index = aiIndexByObjectId.value(objectId, -1);
+  if(index >= 0 && index < aiAircraft.size() && aiAircraft.at(index).getObjectId() == objectId)
+    return &aiAircraft.at(index);
+
+  // Older packet - linear search
+  for(const atools::fs::sc::SimConnectAircraft& ac : aiAircraft)
+  {
+    if(ac.getObjectId() == objectId)
+      return &ac;
+  }
+  return nullptr;
+}
+
 /* Posts data received directly from simconnect or the socket and caches any metar reports */
 void ConnectClient::postSimConnectData(atools::fs::sc::SimConnectData dataPacket)
 {
+  // Record unmodified packet - replayed packets are not recorded again
+  if(sessionRecorder->isRecording() && !sessionRecorder->isReplaying())
+    sessionRecorder->record(dataPacket);
+
   if(dataPacket.getStatus() == atools::fs::sc::OK)
   {
     // Check for empty weather replies or metar replys. Aircraft is not valid in this case.
@@ -285,9 +336,6 @@ void ConnectClient::postSimConnectData(atools::fs::sc::SimConnectData dataPacket
         userAircraft.setCoordinates(atools::geo::EMPTY_POS);
       }
 
-      // Modify AI aircraft and set shadow flag if a online network aircraft is registered as shadowed in the index
-      NavApp::getOnlinedataController()->updateAircraftShadowState(dataPacket);
-
       // Update the MSFS translated aircraft names and types ===================================
       /* Mooney, Boeing, Actually aircraft model. */
       // const QString& getAirplaneType() const
@@ -304,13 +352,6 @@ void ConnectClient::postSimConnectData(atools::fs::sc::SimConnectData dataPacket
                                          languageIndex.getName(userAircraft.getAirplaneAirline()),
                                          languageIndex.getName(userAircraft.getAirplaneTitle()),
                                          languageIndex.getName(userAircraft.getAirplaneModel()));
-
-        // Change AI names
-        for(atools::fs::sc::SimConnectAircraft& ac : dataPacket.getAiAircraft())
-          ac.updateAircraftNames(languageIndex.getName(ac.getAirplaneType()),
-                                 languageIndex.getName(ac.getAirplaneAirline()),
-                                 languageIndex.getName(ac.getAirplaneTitle()),
-                                 languageIndex.getName(ac.getAirplaneModel()));
       }
 
       // Update ICAO aircraft designator from aircraft.cfg for MSFS ===================================
@@ -319,9 +360,18 @@ void ConnectClient::postSimConnectData(atools::fs::sc::SimConnectData dataPacket
         // Has property - fetch from index by loaded aircraft.cfg values
         userAircraft.setAirplaneModel(NavApp::getAircraftIndex().getIcaoTypeDesignator(aircraftCfgKey));
 
-      // Fix incorrect on-ground status which appears from some traffic tools =======================
+      // Update AI in one pass - the AI list is copied only once on first modification
+      // since the packet is still shared with the queued signal
       for(atools::fs::sc::SimConnectAircraft& ac : dataPacket.getAiAircraft())
       {
+        // Change AI names
+        if(!languageIndex.isEmpty())
+          ac.updateAircraftNames(languageIndex.getName(ac.getAirplaneType()),
+                                 languageIndex.getName(ac.getAirplaneAirline()),
+                                 languageIndex.getName(ac.getAirplaneTitle()),
+                                 languageIndex.getName(ac.getAirplaneModel()));
+
+        // Fix incorrect on-ground status which appears from some traffic tools =======================
         // Ground speed given and too high for ground operations
         bool gsFlying = ac.getGroundSpeedKts() < map::INVALID_SPEED_VALUE && ac.getGroundSpeedKts() > 40.f;
 
@@ -333,6 +383,18 @@ void ConnectClient::postSimConnectData(atools::fs::sc::SimConnectData dataPacket
           ac.setFlag(atools::fs::sc::ON_GROUND);
       }
 
+      // Modify AI aircraft and set shadow flag if a online network aircraft is registered as shadowed in the index
+      // Done last since the packet is stored there and any later modification would copy the AI list again
+      NavApp::getOnlinedataController()->updateAircraftShadowState(dataPacket);
+
+      // Build object id index once for all receivers which have to find AI by id
+      aiIndexByObjectId.clear();
+      const QVector<atools::fs::sc::SimConnectAircraft>& aiAircraft = dataPacket.getAiAircraftConst();
+      aiIndexByObjectId.reserve(aiAircraft.size());
+      for(int i = 0; i < aiAircraft.size(); i++)
+        aiIndexByObjectId.insert(aiAircraft.at(i).getObjectId(), i);
+
+      // All receivers get a reference and keep implicitly shared copies of this final packet
       emit dataPacketReceived(dataPacket);
     } // if(!dataPacket.isEmptyReply())
 
@@ -455,7 +517,7 @@ void ConnectClient::restoreState()
   else if(isSimConnect())
     dataReader->setReconnectRateSec(directReconnectSimSec);
 
-  dataReader->setUpdateRate(connectDialog->getUpdateRateMs(connectDialog->getCurrentSimType()));
+  dataReader->setUpdateRate(updateRateMs(connectDialog->getCurrentSimType()));
   dataReader->setAiFetchRadius(atools::geo::nmToKm(connectDialog->getAiFetchRadiusNm(connectDialog->getCurrentSimType())));
   fetchOptionsChanged(connectDialog->getCurrentSimType());
   aiFetchRadiusChanged(connectDialog->getCurrentSimType());
@@ -481,7 +543,41 @@ void ConnectClient::updateRateChanged(cd::ConnectSimType type)
   if((dataReader->getHandler() == simConnectHandler && type == cd::FSX_P3D_MSFS) ||
      (dataReader->getHandler() == xpConnectHandler && type == cd::XPLANE))
     // The currently active value has changed
-    dataReader->setUpdateRate(connectDialog->getUpdateRateMs(type));
+    dataReader->setUpdateRate(updateRateMs(type));
+}
+
+unsigned int ConnectClient::updateRateMs(cd::ConnectSimType type) const
+{
+  unsigned int rateMs = connectDialog->getUpdateRateMs(type);
+  if(rateDemands == 0 && lowUpdateRateMs > 0)
+    // Nobody needs data at full rate
+    rateMs = std::max(rateMs, lowUpdateRateMs);
+  return rateMs;
+}
+
+void ConnectClient::setRateDemand(RateDemand demand, bool needed)
+{
+  int newDemands = needed ? (rateDemands | demand) : (rateDemands & ~demand);
+  if(newDemands != rateDemands)
+  {
+    bool wasLow = rateDemands == 0, isLow = newDemands == 0;
+    rateDemands = newDemands;
+
+    if(wasLow != isLow)
+    {
+      if(verbose)
+        qDebug() << Q_FUNC_INFO << "Low rate" << isLow << "demands" << rateDemands;
+
+      // Change rate in data reader at once
+      updateRateChanged(connectDialog->getCurrentSimType());
+    }
+  }
+}
+
+void ConnectClient::updateWebRateDemand()
+{
+  WebController *webController = NavApp::getWebController();
+  setRateDemand(RATE_DEMAND_WEB, webController != nullptr && webController->hasActiveClients());
 }
 
 void ConnectClient::fetchOptionsChanged(cd::ConnectSimType type)
@@ -906,6 +1002,9 @@ void ConnectClient::connectedToServerSocket()
   socketConnected = true;
   reconnectNetworkTimer.stop();
 
+  // Send the small per packet replies immediately - Nagle's algorithm delays them and throttles the update rate
+  socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
   mainWindow->setConnectionStatusMessageText(tr("Connected"),
                                              tr("Connected to remote flight simulator on \"%1\".").
                                              arg(socket->peerName()));
@@ -976,8 +1075,8 @@ void ConnectClient::readFromSocket()
           QTimer::singleShot(0, this, &ConnectClient::flushQueuedRequests);
         }
 
-        // Send around in the application
-        postSimConnectData(*simConnectData);
+        // Send around in the application - move to avoid a deep copy of the AI lists when updating indexes
+        postSimConnectData(std::move(*simConnectData));
         delete simConnectData;
         simConnectData = nullptr;
       }
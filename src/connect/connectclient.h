@@ -29,6 +29,7 @@
 
 class QTcpSocket;
 class ConnectDialog;
+class SessionRecorder;
 class MainWindow;
 class QMessageBox;
 
@@ -102,6 +103,32 @@ public:
   /* Print the size of all container classes to detect overflow or memory leak conditions */
   void debugDumpContainerSizes() const;
 
+  /* Consumers which need simulator data at the configured update rate.
+   * The rate is reduced for direct connections if none of them needs it. */
+  enum RateDemand
+  {
+    RATE_DEMAND_MAP = 1 << 0, /* User or AI aircraft visible on map or map follows aircraft */
+    RATE_DEMAND_AIRCRAFT_INFO = 1 << 1, /* Aircraft dock window is visible */
+    RATE_DEMAND_WEB = 1 << 2, /* Web clients sent requests recently */
+    RATE_DEMAND_LOGBOOK = 1 << 3, /* Takeoff and landing detection needs accurate data close to ground */
+    RATE_DEMAND_ALL = RATE_DEMAND_MAP | RATE_DEMAND_AIRCRAFT_INFO | RATE_DEMAND_WEB | RATE_DEMAND_LOGBOOK
+  };
+
+  /* Set or clear demand for a consumer. Updates the rate immediately if needed. */
+  void setRateDemand(RateDemand demand, bool needed);
+
+  /* Get AI aircraft or ship by object id from the given packet or null if not found.
+   * Uses an index which is built once for the last posted packet. Falls back to a linear search
+   * if the index does not match the given packet. */
+  const atools::fs::sc::SimConnectAircraft *getAiAircraftByObjectId(const atools::fs::sc::SimConnectData& data,
+                                                                    unsigned int objectId) const;
+
+  /* Records received packets to a file or replays them instead of simulator data */
+  SessionRecorder *getSessionRecorder() const
+  {
+    return sessionRecorder;
+  }
+
 signals:
   /* Emitted when new data was received from the server (Little Navconnect), SimConnect or X-Plane.
    * can be aircraft position or weather update */
@@ -143,6 +170,12 @@ private:
   void updateRateChanged(cd::ConnectSimType type);
   void aiFetchRadiusChanged(cd::ConnectSimType type);
 
+  /* Get configured update rate for simulator type or the low rate if no consumer needs data */
+  unsigned int updateRateMs(cd::ConnectSimType type) const;
+
+  /* Check web server clients periodically */
+  void updateWebRateDemand();
+
   void handleError(atools::fs::sc::SimConnectStatus status, const QString& error, bool xplane, bool network);
 
   void statusPosted(atools::fs::sc::SimConnectStatus status, QString statusText);
@@ -157,12 +190,21 @@ private:
   atools::fs::sc::SimConnectHandler *simConnectHandler = nullptr;
   atools::fs::sc::XpConnectHandler *xpConnectHandler = nullptr;
 
+  /* Records or replays packets. Replayed packets pass postSimConnectData() like received ones. */
+  SessionRecorder *sessionRecorder = nullptr;
+
   /* Have to keep it since it is read multiple times */
   atools::fs::sc::SimConnectData *simConnectData = nullptr;
 
   QTcpSocket *socket = nullptr;
   /* Used to trigger reconnects on socket base connections */
-  QTimer reconnectNetworkTimer, flushQueuedRequestsTimer;
+  QTimer reconnectNetworkTimer, flushQueuedRequestsTimer, webRateDemandTimer;
+
+  /* Bitfield of RateDemand values. Start with full rate. */
+  int rateDemands = RATE_DEMAND_ALL;
+
+  /* Update rate if no consumer needs data. 0 disables rate reduction. */
+  unsigned int lowUpdateRateMs = 1000;
   MainWindow *mainWindow;
   bool verbose = false;
   atools::util::TimedCache<QString, atools::fs::weather::MetarResult> metarIdentCache;
@@ -194,6 +236,9 @@ private:
   int directReconnectXpSec = 5;
 
   atools::util::Version minimumXpconnectVersion;
+
+  /* Maps AI object id to index in AI list of the last posted packet. Built once per packet for all consumers. */
+  QHash<unsigned int, int> aiIndexByObjectId;
 };
 
 #endif // LITTLENAVMAP_CONNECTCLIENT_H
@@ -0,0 +1,279 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "connect/sessionrecorder.h"
+
+#include "app/navapp.h"
+#include "common/memoryregistry.h"
+#include "exception.h"
+#include "fs/sc/simconnectdata.h"
+#include "mapgui/mappaintwidget.h"
+#include "mappainter/paintstatistics.h"
+
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QTextStream>
+
+using atools::fs::sc::SimConnectData;
+
+namespace sessionrec {
+/* File header */
+static const quint32 MAGIC_NUMBER = 0x4C4E5352;
+static const quint16 FILE_VERSION = 1;
+
+/* Interval for the event loop latency timer */
+static const int LATENCY_PROBE_MS = 20;
+
+/* Latency above this is counted as a noticeable stall */
+static const qint64 SLOW_LATENCY_NS = 50000000L;
+
+/* Sample memory every this number of latency probes which is about once a second */
+static const quint64 MEMORY_SAMPLE_PROBES = 50;
+}
+
+SessionRecorder::SessionRecorder(QObject *parent)
+  : QObject(parent)
+{
+  replayTimerNext.setSingleShot(true);
+  connect(&replayTimerNext, &QTimer::timeout, this, &SessionRecorder::replayNext);
+
+  latencyTimer.setTimerType(Qt::PreciseTimer);
+  latencyTimer.setInterval(sessionrec::LATENCY_PROBE_MS);
+  connect(&latencyTimer, &QTimer::timeout, this, &SessionRecorder::latencyProbe);
+}
+
+SessionRecorder::~SessionRecorder()
+{
+  stopRecording();
+  stopReplay();
+}
+
+void SessionRecorder::startRecording(const QString& filename)
+{
+  qDebug() << Q_FUNC_INFO << filename;
+
+  stopRecording();
+
+  recordFile.setFileName(filename);
+  if(!recordFile.open(QIODevice::WriteOnly))
+    throw atools::Exception(tr("Cannot open file \"%1\". Reason: %2").arg(filename).arg(recordFile.errorString()));
+
+  recordStream = new QDataStream(&recordFile);
+  recordStream->setVersion(QDataStream::Qt_5_5);
+  *recordStream << sessionrec::MAGIC_NUMBER << sessionrec::FILE_VERSION;
+  recordTimer.start();
+}
+
+void SessionRecorder::stopRecording()
+{
+  if(recordStream != nullptr)
+  {
+    qDebug() << Q_FUNC_INFO << recordFile.fileName();
+    delete recordStream;
+    recordStream = nullptr;
+    recordFile.close();
+  }
+}
+
+void SessionRecorder::record(const SimConnectData& data)
+{
+  if(recordStream != nullptr)
+  {
+    *recordStream << static_cast<qint64>(recordTimer.elapsed());
+
+    // Write packet with the same serialization as used by Little Navconnect
+    SimConnectData packet(data);
+    packet.write(&recordFile);
+
+    if(recordStream->status() != QDataStream::Ok)
+    {
+      qWarning() << Q_FUNC_INFO << "Error writing" << recordFile.fileName() << recordFile.errorString();
+      stopRecording();
+    }
+  }
+}
+
+void SessionRecorder::startReplay(const QString& filename, float speed)
+{
+  qDebug() << Q_FUNC_INFO << filename << "speed" << speed;
+
+  stopReplay();
+
+  replayFile.setFileName(filename);
+  if(!replayFile.open(QIODevice::ReadOnly))
+    throw atools::Exception(tr("Cannot open file \"%1\". Reason: %2").arg(filename).arg(replayFile.errorString()));
+
+  replayStream = new QDataStream(&replayFile);
+  replayStream->setVersion(QDataStream::Qt_5_5);
+
+  quint32 magic = 0;
+  quint16 version = 0;
+  *replayStream >> magic >> version;
+  if(magic != sessionrec::MAGIC_NUMBER || version != sessionrec::FILE_VERSION)
+  {
+    stopReplay();
+    throw atools::Exception(tr("File \"%1\" is not a valid session recording.").arg(filename));
+  }
+
+  replayData = new SimConnectData;
+  if(!readNext())
+  {
+    stopReplay();
+    throw atools::Exception(tr("File \"%1\" does not contain any data.").arg(filename));
+  }
+
+  replayFilename = filename;
+  replaySpeed = speed;
+
+  // Reset statistics ====================================
+  latencySumNs = latencyMaxNs = packetSumNs = packetMaxNs = replayNs = 0L;
+  numProbes = numSlowProbes = numPackets = 0;
+  memoryStart = memoryPeak = memoryEnd = MemoryRegistry::residentMemoryBytes();
+
+  if(NavApp::getMapPaintWidgetGui() != nullptr)
+    NavApp::getMapPaintWidgetGui()->resetPaintStatistics();
+
+  replayTimer.start();
+  lastProbeNs = 0L;
+  latencyTimer.start();
+  replayTimerNext.start(0);
+}
+
+void SessionRecorder::stopReplay()
+{
+  replayTimerNext.stop();
+  latencyTimer.stop();
+
+  delete replayStream;
+  replayStream = nullptr;
+  delete replayData;
+  replayData = nullptr;
+  replayFile.close();
+}
+
+bool SessionRecorder::readNext()
+{
+  if(replayStream->atEnd())
+    return false;
+
+  qint64 timeMs = 0L;
+  *replayStream >> timeMs;
+
+  *replayData = SimConnectData();
+  if(replayStream->status() != QDataStream::Ok || !replayData->read(&replayFile) ||
+     replayData->getStatus() != atools::fs::sc::OK)
+  {
+    qWarning() << Q_FUNC_INFO << "Error reading" << replayFile.fileName() << replayData->getStatusText();
+    return false;
+  }
+
+  replayDataMs = timeMs;
+  return true;
+}
+
+void SessionRecorder::replayNext()
+{
+  if(replayData == nullptr)
+    return;
+
+  emit replayPacket(*replayData);
+  numPackets++;
+
+  if(readNext())
+  {
+    if(replaySpeed > 0.f)
+      replayTimerNext.start(static_cast<int>(std::max(static_cast<qint64>(replayDataMs / replaySpeed) - replayTimer.elapsed(),
+                                                      static_cast<qint64>(0))));
+    else
+      // As fast as possible but let the event loop paint and process other events in between
+      replayTimerNext.start(0);
+  }
+  else
+  {
+    replayNs = replayTimer.nsecsElapsed();
+    memoryEnd = MemoryRegistry::residentMemoryBytes();
+    memoryPeak = std::max(memoryPeak, memoryEnd);
+    stopReplay();
+
+    qDebug() << Q_FUNC_INFO << "Replay finished" << numPackets << "packets";
+    emit replayFinished();
+  }
+}
+
+void SessionRecorder::addPacketTime(qint64 ns)
+{
+  packetSumNs += ns;
+  packetMaxNs = std::max(packetMaxNs, ns);
+}
+
+void SessionRecorder::latencyProbe()
+{
+  qint64 now = replayTimer.nsecsElapsed();
+  if(lastProbeNs > 0L)
+  {
+    qint64 latency = std::max(now - lastProbeNs - sessionrec::LATENCY_PROBE_MS * 1000000L, static_cast<qint64>(0));
+    latencySumNs += latency;
+    latencyMaxNs = std::max(latencyMaxNs, latency);
+    if(latency > sessionrec::SLOW_LATENCY_NS)
+      numSlowProbes++;
+    numProbes++;
+
+    if(numProbes % sessionrec::MEMORY_SAMPLE_PROBES == 0)
+      memoryPeak = std::max(memoryPeak, MemoryRegistry::residentMemoryBytes());
+  }
+  lastProbeNs = now;
+}
+
+QString SessionRecorder::getReport() const
+{
+  QString report;
+  QTextStream stream(&report);
+
+  double replayMs = replayNs / 1000000.;
+  stream << tr("Session replay of \"%1\"").arg(QDir::toNativeSeparators(replayFilename)) << endl;
+  stream << tr("Speed: %1, duration: %2 s, packets: %3").
+    arg(replaySpeed > 0.f ? QString::number(replaySpeed) : tr("max")).arg(replayMs / 1000., 0, 'f', 1).arg(numPackets) << endl;
+
+  // Packet processing by connect client and all receivers
+  stream << tr("Packet processing: average %1 ms, maximum %2 ms, %3 % of time").
+    arg(numPackets > 0 ? packetSumNs / 1000000. / numPackets : 0., 0, 'f', 2).arg(packetMaxNs / 1000000., 0, 'f', 2).
+    arg(replayNs > 0 ? packetSumNs * 100. / replayNs : 0., 0, 'f', 1) << endl;
+
+  // Map frames
+  if(NavApp::getMapPaintWidgetGui() != nullptr)
+  {
+    const PaintLayerStatistics& frame = NavApp::getMapPaintWidgetGui()->getPaintStatistics().getFrame();
+    stream << tr("Map frames: %1, average %2 ms, maximum %3 ms, %4 % of time").
+      arg(frame.frames).arg(frame.averageTotalMs(), 0, 'f', 2).arg(frame.maxMs, 0, 'f', 2).
+      arg(replayMs > 0. ? frame.averageTotalMs() * frame.frames * 100. / replayMs : 0., 0, 'f', 1) << endl;
+  }
+
+  // Event loop
+  stream << tr("Event loop latency: average %1 ms, maximum %2 ms, %3 stalls above %4 ms").
+    arg(numProbes > 0 ? latencySumNs / 1000000. / numProbes : 0., 0, 'f', 2).arg(latencyMaxNs / 1000000., 0, 'f', 2).
+    arg(numSlowProbes).arg(sessionrec::SLOW_LATENCY_NS / 1000000L) << endl;
+
+  // Memory
+  if(memoryStart >= 0L)
+    stream << tr("Resident memory: start %1 MB, end %2 MB, peak %3 MB, growth %4 MB").
+      arg(memoryStart / 1048576., 0, 'f', 1).arg(memoryEnd / 1048576., 0, 'f', 1).
+      arg(memoryPeak / 1048576., 0, 'f', 1).arg((memoryEnd - memoryStart) / 1048576., 0, 'f', 1) << endl;
+
+  stream.flush();
+  return report;
+}
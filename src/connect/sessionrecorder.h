@@ -0,0 +1,122 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_SESSIONRECORDER_H
+#define LNM_SESSIONRECORDER_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QTimer>
+
+namespace atools {
+namespace fs {
+namespace sc {
+class SimConnectData;
+}
+}
+}
+
+class QDataStream;
+
+/*
+ * Records the stream of simulator data packets including simulator weather replies into a file and replays it later
+ * at the original speed, a multiple of it or as fast as possible. Used for the command line options
+ * "session-record" and "session-replay" to get reproducible end-to-end timings of a flight.
+ *
+ * Packets are recorded before any modification by the connect client and are replayed through the same path.
+ * The replay collects packet processing times, event loop latency, map frame times and memory usage for a report.
+ *
+ * File format is a header followed by records of relative time in milliseconds and the serialized packet.
+ */
+class SessionRecorder :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit SessionRecorder(QObject *parent);
+  virtual ~SessionRecorder() override;
+
+  SessionRecorder(const SessionRecorder& other) = delete;
+  SessionRecorder& operator=(const SessionRecorder& other) = delete;
+
+  /* Start recording all packets passed to record() into the file. Throws atools::Exception on error. */
+  void startRecording(const QString& filename);
+  void stopRecording();
+
+  /* Write packet to file if recording */
+  void record(const atools::fs::sc::SimConnectData& data);
+
+  /* Start sending packets from file using signal replayPacket. speed is a factor for the recorded time
+   * and 0 replays as fast as possible while still allowing the event loop to paint.
+   * Throws atools::Exception on error. */
+  void startReplay(const QString& filename, float speed);
+  void stopReplay();
+
+  bool isRecording() const
+  {
+    return recordStream != nullptr;
+  }
+
+  bool isReplaying() const
+  {
+    return replayStream != nullptr;
+  }
+
+  /* Add time needed to process one replayed packet by all receivers */
+  void addPacketTime(qint64 ns);
+
+  /* Plain text report of the last replay */
+  QString getReport() const;
+
+signals:
+  /* Replayed packet to be processed like one from the simulator */
+  void replayPacket(const atools::fs::sc::SimConnectData& data);
+
+  /* All packets sent or replay stopped */
+  void replayFinished();
+
+private:
+  /* Send current packet and schedule the next one */
+  void replayNext();
+
+  /* Read next record into replayData. Returns false at end of file or on error. */
+  bool readNext();
+
+  /* Measures delay of a periodic timer to get the event loop latency */
+  void latencyProbe();
+
+  QFile recordFile, replayFile;
+  QDataStream *recordStream = nullptr, *replayStream = nullptr;
+  QElapsedTimer recordTimer, replayTimer;
+
+  /* Next packet to send and its time relative to start of recording */
+  atools::fs::sc::SimConnectData *replayData = nullptr;
+  qint64 replayDataMs = 0L;
+  float replaySpeed = 1.f;
+  QTimer replayTimerNext;
+
+  /* Statistics for report */
+  QTimer latencyTimer;
+  qint64 lastProbeNs = 0L, latencySumNs = 0L, latencyMaxNs = 0L, packetSumNs = 0L, packetMaxNs = 0L, replayNs = 0L;
+  quint64 numProbes = 0, numSlowProbes = 0, numPackets = 0;
+  qint64 memoryStart = 0L, memoryEnd = 0L, memoryPeak = 0L;
+  QString replayFilename;
+};
+
+#endif // LNM_SESSIONRECORDER_H
@@ -0,0 +1,345 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "db/bulkimporter.h"
+
+#include "exception.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqltransaction.h"
+
+#include <QAtomicInt>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutex>
+#include <QProgressDialog>
+#include <QQueue>
+#include <QStringBuilder>
+#include <QTextStream>
+#include <QWaitCondition>
+#include <QtConcurrent/QtConcurrentRun>
+
+using atools::sql::SqlQuery;
+using atools::sql::SqlTransaction;
+
+namespace bulkimport {
+
+/* Maximum number of chunks waiting for insert to limit memory usage */
+const static int MAX_QUEUED_CHUNKS = 4;
+
+/* Converted rows as passed from reader to inserter */
+typedef QVector<QVariantList> Chunk;
+
+/* Bounded chunk queue between reader thread and GUI thread */
+class ChunkQueue
+{
+public:
+  /* Called by reader. Blocks if queue is full. Returns false if canceled. */
+  bool push(const Chunk& chunk)
+  {
+    QMutexLocker locker(&mutex);
+    while(queue.size() >= MAX_QUEUED_CHUNKS && !canceled)
+      notFull.wait(&mutex);
+
+    if(canceled)
+      return false;
+
+    queue.enqueue(chunk);
+    notEmpty.wakeAll();
+    return true;
+  }
+
+  /* Called by GUI thread. Waits up to timeoutMs and returns false if nothing available. */
+  bool pop(Chunk& chunk, unsigned long timeoutMs)
+  {
+    QMutexLocker locker(&mutex);
+    if(queue.isEmpty())
+      notEmpty.wait(&mutex, timeoutMs);
+
+    if(queue.isEmpty())
+      return false;
+
+    chunk = queue.dequeue();
+    notFull.wakeAll();
+    return true;
+  }
+
+  /* Wake up and stop reader */
+  void cancel()
+  {
+    QMutexLocker locker(&mutex);
+    canceled = true;
+    notFull.wakeAll();
+  }
+
+  bool isCanceled()
+  {
+    QMutexLocker locker(&mutex);
+    return canceled;
+  }
+
+  bool isEmpty()
+  {
+    QMutexLocker locker(&mutex);
+    return queue.isEmpty();
+  }
+
+private:
+  QQueue<Chunk> queue;
+  QMutex mutex;
+  QWaitCondition notEmpty, notFull;
+  bool canceled = false;
+};
+
+/* State shared between reader and GUI thread */
+struct ReaderState
+{
+  ChunkQueue queue;
+  QAtomicInteger<qint64> bytesRead;
+  QAtomicInt numSkipped;
+};
+
+/* Runs in the reader thread. Returns error message or empty if successful or canceled. */
+QString readFiles(ReaderState *state, const QStringList& filenames, BulkImportConverterType converter,
+                  int chunkSize, QChar separator, QChar quote)
+{
+  qint64 bytesDone = 0L;
+  for(const QString& filename : filenames)
+  {
+    QFile file(filename);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+      return BulkImporter::tr("Cannot open file \"%1\". Reason: %2").arg(filename).arg(file.errorString());
+
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+
+    Chunk chunk;
+    chunk.reserve(chunkSize);
+    QStringList fields;
+    QString line;
+    int lineNum = 0;
+    try
+    {
+      while(!stream.atEnd())
+      {
+        // Read line and continue with next if a quoted field contains line feeds
+        QString nextLine = stream.readLine();
+        lineNum++;
+        line = line.isEmpty() ? nextLine : line % "\n" % nextLine;
+        if(!BulkImporter::parseCsvLine(fields, line, separator, quote) && !stream.atEnd())
+          continue;
+        line.clear();
+
+        if(fields.isEmpty() || (fields.size() == 1 && fields.constFirst().isEmpty()))
+          continue;
+
+        QVariantList values;
+        if(converter(fields, filename, values))
+          chunk.append(values);
+        else
+          state->numSkipped.fetchAndAddOrdered(1);
+
+        if(chunk.size() >= chunkSize)
+        {
+          state->bytesRead.storeRelease(bytesDone + stream.pos());
+          if(!state->queue.push(chunk))
+            return QString(); // Canceled
+          chunk.clear();
+          chunk.reserve(chunkSize);
+        }
+      }
+    }
+    catch(atools::Exception& e)
+    {
+      return BulkImporter::tr("File \"%1\" line %2: %3").arg(filename).arg(lineNum).arg(e.what());
+    }
+
+    bytesDone += file.size();
+    state->bytesRead.storeRelease(bytesDone);
+    if(!chunk.isEmpty())
+    {
+      if(!state->queue.push(chunk))
+        return QString(); // Canceled
+    }
+    file.close();
+  }
+  return QString();
+}
+
+}
+
+BulkImporter::BulkImporter(QWidget *parentWidget, atools::sql::SqlDatabase *sqlDb, const QString& tableName,
+                           const QStringList& columnNames, BulkImportConverterType converterFunc)
+  : parent(parentWidget), db(sqlDb), table(tableName), columns(columnNames), converter(converterFunc)
+{
+}
+
+int BulkImporter::importFiles(const QStringList& filenames, const QString& title)
+{
+  QElapsedTimer timer;
+  timer.start();
+  numSkipped = 0;
+
+  qint64 totalBytes = 0L;
+  for(const QString& filename : filenames)
+    totalBytes += QFileInfo(filename).size();
+
+  QProgressDialog progress(tr("Importing ..."), tr("&Cancel"), 0, 1000, parent);
+  progress.setWindowTitle(title);
+  progress.setWindowFlags(progress.windowFlags() & ~Qt::WindowContextHelpButtonHint);
+  progress.setWindowModality(Qt::ApplicationModal);
+  progress.setMinimumDuration(200);
+
+  SqlTransaction transaction(db);
+
+  // Remember and drop indexes - these are recreated after loading all rows ===========================
+  QStringList indexSql;
+  SqlQuery indexQuery(db);
+  indexQuery.prepare("select name, sql from sqlite_master where type = 'index' and tbl_name = :table and sql is not null");
+  indexQuery.bindValue(":table", table);
+  indexQuery.exec();
+  QStringList indexNames;
+  while(indexQuery.next())
+  {
+    indexNames.append(indexQuery.valueStr("name"));
+    indexSql.append(indexQuery.valueStr("sql"));
+  }
+  indexQuery.finish();
+
+  SqlQuery query(db);
+  for(const QString& name : qAsConst(indexNames))
+    query.exec("drop index if exists " % name);
+
+  // Prepare insert statement ===========================
+  QStringList placeholders;
+  for(const QString& col : qAsConst(columns))
+    placeholders.append(':' % col);
+  query.prepare("insert into " % table % " (" % columns.join(", ") % ") values(" % placeholders.join(", ") % ")");
+
+  // Start reader thread ===========================
+  bulkimport::ReaderState state;
+  QFuture<QString> future = QtConcurrent::run(bulkimport::readFiles, &state, filenames, converter, chunkSize, separator, quote);
+
+  int numInserted = 0;
+  bool canceled = false;
+  bulkimport::Chunk chunk;
+  try
+  {
+    while(true)
+    {
+      if(state.queue.pop(chunk, 50))
+      {
+        for(const QVariantList& values : qAsConst(chunk))
+        {
+          for(int i = 0; i < columns.size(); i++)
+            query.bindValue(placeholders.at(i), values.value(i));
+          query.exec();
+          numInserted++;
+        }
+      }
+      else if(future.isFinished() && state.queue.isEmpty())
+        break;
+
+      if(totalBytes > 0)
+        progress.setValue(static_cast<int>(state.bytesRead.loadAcquire() * 1000 / totalBytes));
+      progress.setLabelText(tr("Imported %L1 rows ...").arg(numInserted));
+      QCoreApplication::processEvents();
+
+      if(progress.wasCanceled())
+      {
+        canceled = true;
+        state.queue.cancel();
+        break;
+      }
+    }
+  }
+  catch(...)
+  {
+    // Stop reader before state goes out of scope
+    state.queue.cancel();
+    future.waitForFinished();
+    transaction.rollback();
+    throw;
+  }
+
+  // Wait for reader to finish - either done or canceled
+  future.waitForFinished();
+  QString error = future.result();
+  numSkipped = state.numSkipped.loadAcquire();
+  progress.setValue(1000);
+
+  if(canceled || !error.isEmpty())
+  {
+    qDebug() << Q_FUNC_INFO << "Rolling back" << table << "canceled" << canceled << error;
+    transaction.rollback();
+
+    if(!error.isEmpty())
+      throw atools::Exception(error);
+    return -1;
+  }
+
+  // Recreate indexes ===========================
+  for(const QString& sql : qAsConst(indexSql))
+    query.exec(sql);
+
+  transaction.commit();
+
+  qDebug() << Q_FUNC_INFO << table << "inserted" << numInserted << "skipped" << numSkipped << "in" << timer.elapsed() << "ms";
+  return numInserted;
+}
+
+bool BulkImporter::parseCsvLine(QStringList& fields, const QString& line, QChar separator, QChar quote)
+{
+  fields.clear();
+  QString field;
+  bool inQuotes = false;
+
+  for(int i = 0; i < line.size(); i++)
+  {
+    QChar c = line.at(i);
+    if(inQuotes)
+    {
+      if(c == quote)
+      {
+        if(i + 1 < line.size() && line.at(i + 1) == quote)
+        {
+          // Escaped quote
+          field.append(quote);
+          i++;
+        }
+        else
+          inQuotes = false;
+      }
+      else
+        field.append(c);
+    }
+    else if(c == quote)
+      inQuotes = true;
+    else if(c == separator)
+    {
+      fields.append(field);
+      field.clear();
+    }
+    else
+      field.append(c);
+  }
+  fields.append(field);
+
+  return !inQuotes;
+}
@@ -0,0 +1,97 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_BULKIMPORTER_H
+#define LNM_BULKIMPORTER_H
+
+#include <QCoreApplication>
+#include <QVariantList>
+#include <functional>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+class QWidget;
+
+/* Converts one parsed CSV row into values in the same order as the columns given to BulkImporter.
+ * Called in the reader thread. Return false to skip the row. */
+typedef std::function<bool (const QStringList& row, const QString& filename, QVariantList& values)> BulkImportConverterType;
+
+/*
+ * Streaming CSV importer for large files into a single table.
+ *
+ * Files are read and parsed in chunks in a worker thread while the GUI thread inserts the
+ * chunks using one prepared statement. All files are loaded in one transaction and table indexes are
+ * dropped before and recreated after loading. A progress dialog based on bytes read allows to cancel
+ * which rolls back all changes.
+ *
+ * Bypasses the undo/redo functionality of the data managers.
+ */
+class BulkImporter
+{
+  Q_DECLARE_TR_FUNCTIONS(BulkImporter)
+
+public:
+  BulkImporter(QWidget *parentWidget, atools::sql::SqlDatabase *sqlDb, const QString& tableName, const QStringList& columnNames,
+               BulkImportConverterType converterFunc);
+
+  BulkImporter(const BulkImporter& other) = delete;
+  BulkImporter& operator=(const BulkImporter& other) = delete;
+
+  /* Set separator and quote character for parsing. Default is ',' and '"' */
+  void setSeparator(QChar separatorChar, QChar quoteChar)
+  {
+    separator = separatorChar;
+    quote = quoteChar;
+  }
+
+  /* Rows per chunk handed from the reader thread to the inserting GUI thread */
+  void setChunkSize(int value)
+  {
+    chunkSize = value;
+  }
+
+  /* Import all files. Shows a progress dialog with the given title.
+   * Returns number of inserted rows or -1 if canceled by the user.
+   * Throws atools::Exception on read or SQL errors after rolling back. */
+  int importFiles(const QStringList& filenames, const QString& title);
+
+  /* Number of rows skipped by the converter in the last run */
+  int getNumSkipped() const
+  {
+    return numSkipped;
+  }
+
+  /* Split a CSV line into fields. Returns false if the line ends within a quoted field
+   * and needs to be continued with the next line. */
+  static bool parseCsvLine(QStringList& fields, const QString& line, QChar separator, QChar quote);
+
+private:
+  QWidget *parent;
+  atools::sql::SqlDatabase *db;
+  QString table;
+  QStringList columns;
+  BulkImportConverterType converter;
+
+  QChar separator = ',', quote = '"';
+  int chunkSize = 5000, numSkipped = 0;
+};
+
+#endif // LNM_BULKIMPORTER_H
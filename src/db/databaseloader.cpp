@@ -35,6 +35,7 @@
 
 #include <QDir>
 #include <QElapsedTimer>
+#include <QGuiApplication>
 #include <QSettings>
 #include <QtConcurrent/QtConcurrentRun>
 
@@ -223,6 +224,9 @@ void DatabaseLoader::loadScenery()
   // Reset timers used in progress callback in thread context
   progressTimerElapsedThread = 0L;
   timerThread.restart();
+  phaseThread.clear();
+  phaseStartThread = 0L;
+  phaseTimesShared.clear();
 
   // Initial text
   progressDialog->setLabelText(databaseTimeText.arg(tr("Counting files ...")).
@@ -294,6 +298,15 @@ void DatabaseLoader::compileDatabasePost()
 
   deleteProgressDialog();
 
+  // Add indexes needed by the application queries which are not part of the compiler schema
+  if(!resultFlagsShared.testFlag(atools::fs::COMPILE_CANCELED) && !resultFlagsShared.testFlag(atools::fs::COMPILE_FAILED))
+  {
+    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+    dbtools::createQueryIndexes(compileDb);
+    dbtools::writeSceneryAreaSignatures(compileDb, sceneryAreaSignatures);
+    QGuiApplication::restoreOverrideCursor();
+  }
+
   dbtools::closeDatabaseFile(compileDb);
 
   emit loadingFinished();
@@ -382,7 +395,7 @@ void DatabaseLoader::progressCallback()
       progressDialog->setLabelText(
         databaseTimeText.arg(tr("<big>Done.</big>")).
         arg(formatter::formatElapsed(timer)).
-        arg(QString()).
+        arg(phaseTimesText()).
         arg(QString()).
         arg(navDatabaseProgressShared->getNumErrors()).
         arg(navDatabaseProgressShared->getNumFiles()).
@@ -409,6 +422,25 @@ bool DatabaseLoader::progressCallbackThread(const atools::fs::NavDatabaseProgres
 {
   bool canceled = false;
 
+  // Collect phase timing for each event since the dialog updates below are throttled
+  QString phase;
+  if(progress.isNewOther())
+    phase = progress.getOtherAction();
+  else if(progress.isNewSceneryArea() || progress.isNewFile())
+    phase = tr("Reading scenery files");
+
+  if((!phase.isEmpty() && phase != phaseThread) || progress.isLastCall())
+  {
+    qint64 now = timerThread.elapsed();
+    if(!phaseThread.isEmpty())
+    {
+      QWriteLocker locker(&progressLock);
+      phaseTimesShared.append(std::make_pair(phaseThread, now - phaseStartThread));
+    }
+    phaseThread = phase;
+    phaseStartThread = now;
+  }
+
   // Update only every UPDATE_RATE_MS or for first and last event
   if((timerThread.elapsed() - progressTimerElapsedThread) > UPDATE_RATE_MS || progress.isFirstCall() || progress.isLastCall())
   {
@@ -433,6 +465,23 @@ bool DatabaseLoader::progressCallbackThread(const atools::fs::NavDatabaseProgres
   return canceled;
 }
 
+QString DatabaseLoader::phaseTimesText()
+{
+  // Called with progressLock held
+  if(phaseTimesShared.isEmpty())
+    return QString();
+
+  QString text = tr("<b>Phases:</b><br/>");
+  for(const std::pair<QString, qint64>& phaseTime : qAsConst(phaseTimesShared))
+  {
+    qInfo() << Q_FUNC_INFO << phaseTime.first << phaseTime.second << "ms";
+    text.append(tr("%1: %L2 s<br/>").
+                arg(atools::elideTextShortMiddle(phaseTime.first, MAX_TEXT_LENGTH)).
+                arg(phaseTime.second / 1000., 0, 'f', 1));
+  }
+  return text + tr("<br/>");
+}
+
 void DatabaseLoader::showErrors()
 {
   qDebug() << Q_FUNC_INFO;
@@ -21,11 +21,13 @@
 #include "fs/navdatabaseflags.h"
 #include "fs/fspaths.h"
 #include "db/dbtypes.h"
+#include "db/dbtools.h"
 
 #include <QElapsedTimer>
 #include <QFutureWatcher>
 #include <QObject>
 #include <QReadWriteLock>
+#include <QVector>
 
 class DatabaseProgressDialog;
 
@@ -110,6 +112,12 @@ public:
     return dbFilename;
   }
 
+  /* Scenery area signatures taken before loading. Saved in the new database on success. */
+  void setSceneryAreaSignatures(const dbtools::SceneryAreaSignatures& value)
+  {
+    sceneryAreaSignatures = value;
+  }
+
   /* Get compilation results. Do not access while thread is active. */
   const atools::fs::ResultFlags& getResultFlags() const
   {
@@ -148,6 +156,9 @@ private:
 
   void deleteProgressDialog();
 
+  /* HTML list of compilation phases and their duration for the progress dialog */
+  QString phaseTimesText();
+
   /* Progress dialog is opened on demand */
   DatabaseProgressDialog *progressDialog = nullptr;
 
@@ -165,6 +176,7 @@ private:
   SimulatorTypeMap simulators;
   atools::fs::FsPaths::SimulatorType selectedFsType;
   QString currentBglFilePath, dbFilename;
+  dbtools::SceneryAreaSignatures sceneryAreaSignatures;
   atools::fs::ResultFlags resultFlagsShared = atools::fs::COMPILE_NONE; // Shared between thread and main - locked by resultFlagsLock
   QElapsedTimer timer; /* Timer used in main thread context */
 
@@ -182,6 +194,13 @@ private:
   /* timer called in thread context to avoid too often updates */
   qint64 progressTimerElapsedThread = 0L;
   QElapsedTimer timerThread;
+
+  /* Name of current compilation phase and start time in ms from timerThread. Used in thread context. */
+  QString phaseThread;
+  qint64 phaseStartThread = 0L;
+
+  /* Name and duration in ms of finished phases - locked by progressLock */
+  QVector<std::pair<QString, qint64> > phaseTimesShared;
 };
 
 #endif // LNM_DATABASELOADER_H
@@ -22,6 +22,7 @@
 #include "common/settingsmigrate.h"
 #include "db/databasedialog.h"
 #include "db/databaseloader.h"
+#include "db/databasepool.h"
 #include "db/dbtools.h"
 #include "fs/db/databasemeta.h"
 #include "fs/navdatabase.h"
@@ -37,6 +38,7 @@
 #include "io/fileroller.h"
 #include "app/navapp.h"
 #include "options/optiondata.h"
+#include "query/querytypes.h"
 #include "settings/settings.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlexception.h"
@@ -48,6 +50,9 @@
 #include "gui/signalblocker.h"
 
 #include <QDir>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
 
 using atools::sql::SqlUtil;
 using atools::fs::NavDatabase;
@@ -148,7 +153,7 @@ DatabaseManager::DatabaseManager(MainWindow *parent)
     databaseNavAirspace = new SqlDatabase(dbtools::DATABASE_NAME_NAV_AIRSPACE);
 
     // Open user point database =================================
-    openWriteableDatabase(databaseUser, "userdata", "user", true /* backup */);
+    openWriteableDatabase(databaseUser, "userdata", "user", true /* backup */, true /* synchronous */);
     userdataManager = new atools::fs::userdata::UserdataManager(databaseUser);
     if(!userdataManager->hasSchema())
       userdataManager->createSchema(false /* verboseLogging */);
@@ -156,15 +161,16 @@ DatabaseManager::DatabaseManager(MainWindow *parent)
       userdataManager->updateSchema();
 
     // Open logbook database =================================
-    openWriteableDatabase(databaseLogbook, "logbook", "logbook", true /* backup */);
+    openWriteableDatabase(databaseLogbook, "logbook", "logbook", true /* backup */, true /* synchronous */);
     logdataManager = new atools::fs::userdata::LogdataManager(databaseLogbook);
     if(!logdataManager->hasSchema())
       logdataManager->createSchema(false /* verboseLogging */);
     else
       logdataManager->updateSchema();
+    dbtools::createLogbookIndexes(databaseLogbook);
 
     // Open user airspace database =================================
-    openWriteableDatabase(databaseUserAirspace, "userairspace", "userairspace", false /* backup */);
+    openWriteableDatabase(databaseUserAirspace, "userairspace", "userairspace", false /* backup */, true /* synchronous */);
     if(!SqlUtil(databaseUserAirspace).hasTable("boundary"))
     {
       SqlTransaction transaction(databaseUserAirspace);
@@ -174,7 +180,7 @@ DatabaseManager::DatabaseManager(MainWindow *parent)
     }
 
     // Open track database =================================
-    openWriteableDatabase(databaseTrack, "track", "track", false /* backup */);
+    openWriteableDatabase(databaseTrack, "track", "track", false /* backup */, false /* synchronous */);
     trackManager = new TrackManager(databaseTrack, databaseNav);
     trackManager->createSchema(false /* verboseLogging */);
     // trackManager->initQueries();
@@ -183,7 +189,7 @@ DatabaseManager::DatabaseManager(MainWindow *parent)
     atools::settings::Settings& settings = atools::settings::Settings::instance();
     bool verbose = settings.getAndStoreValue(lnm::OPTIONS_WHAZZUP_PARSER_DEBUG, false).toBool();
 
-    openWriteableDatabase(databaseOnline, "onlinedata", "online network", false /* backup */);
+    openWriteableDatabase(databaseOnline, "onlinedata", "online network", false /* backup */, false /* synchronous */);
     onlinedataManager = new atools::fs::online::OnlinedataManager(databaseOnline, verbose);
     onlinedataManager->createSchema();
     onlinedataManager->initQueries();
@@ -194,6 +200,15 @@ DatabaseManager::DatabaseManager(MainWindow *parent)
       logdataManager->clearUndoRedoData();
       userdataManager->clearUndoRedoData();
     }
+
+    // Checkpoint write-ahead logs of writeable databases periodically in idle time instead of blocking writers
+    int checkpointSeconds = settings.getAndStoreValue(lnm::SETTINGS_DATABASE + "WalCheckpointSeconds", 30).toInt();
+    if(checkpointSeconds > 0)
+    {
+      walCheckpointTimer.setInterval(checkpointSeconds * 1000);
+      connect(&walCheckpointTimer, &QTimer::timeout, this, &DatabaseManager::checkpointWriteableDatabases);
+      walCheckpointTimer.start();
+    }
   }
 
   // Run if instantiated from the GUI
@@ -205,10 +220,15 @@ DatabaseManager::DatabaseManager(MainWindow *parent)
     // Correct navdata selection automatically if enabled
     assignSceneryCorrection();
   }
+
+  connect(&warmupWatcher, &QFutureWatcher<qint64>::finished, this, &DatabaseManager::warmupFinished);
+  connect(&switchWarmupWatcher, &QFutureWatcher<qint64>::finished, this, &DatabaseManager::switchSimWarmupFinished);
 }
 
 DatabaseManager::~DatabaseManager()
 {
+  walCheckpointTimer.stop();
+
   // Delete simulator switch actions
   freeActions();
 
@@ -251,6 +271,33 @@ DatabaseManager::~DatabaseManager()
   SqlDatabase::removeDatabase(dbtools::DATABASE_NAME_NAV_AIRSPACE);
 }
 
+DatabaseManager::DatabaseCheckResult DatabaseManager::checkDatabaseThread(QString filename, QString connectionName)
+{
+  DatabaseCheckResult result = CHECK_OK;
+  SqlDatabase *db = dbtools::openDatabaseThread(connectionName, filename);
+  if(db != nullptr)
+  {
+    try
+    {
+      DatabaseMeta meta(db);
+      if(!meta.hasSchema())
+        result = CHECK_NO_SCHEMA;
+      else if(!meta.isDatabaseCompatible())
+        result = CHECK_INCOMPATIBLE;
+    }
+    catch(atools::Exception& e)
+    {
+      qWarning() << Q_FUNC_INFO << "Checking" << filename << "failed" << e.what();
+      result = CHECK_INCOMPATIBLE;
+    }
+    dbtools::closeDatabaseThread(db, connectionName);
+  }
+  else
+    // Cannot open read only - let the user erase it
+    result = CHECK_INCOMPATIBLE;
+  return result;
+}
+
 bool DatabaseManager::checkIncompatibleDatabases(bool *databasesErased)
 {
   bool ok = true;
@@ -265,30 +312,42 @@ bool DatabaseManager::checkIncompatibleDatabases(bool *databasesErased)
     QStringList databaseNames, databaseFiles;
 
     // Collect all incompatible databases
-
+    // Read metadata of all existing databases in parallel using separate read only connections
+    QVector<std::pair<atools::fs::FsPaths::SimulatorType, QFuture<DatabaseCheckResult> > > checks;
+    int index = 0;
     for(auto it = simulators.constBegin(); it != simulators.constEnd(); ++it)
     {
       QString dbName = buildDatabaseFileName(it.key());
       if(QFile::exists(dbName))
-      {
         // Database file exists
+        checks.append(std::make_pair(it.key(), QtConcurrent::run(checkDatabaseThread, dbName,
+                                                                 QString("LNMCHECK_%1").arg(index++))));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    for(auto& check : checks)
+    {
+      QString dbName = buildDatabaseFileName(check.first);
+      DatabaseCheckResult result = check.second.result();
+
+      if(result == CHECK_NO_SCHEMA)
+      {
+        // No schema create an empty one anyway - needs a writeable connection
         sqlDb.setDatabaseName(dbName);
         sqlDb.open();
-
-        DatabaseMeta meta(&sqlDb);
-        if(!meta.hasSchema())
-          // No schema create an empty one anyway
-          dbtools::createEmptySchema(&sqlDb);
-        else if(!meta.isDatabaseCompatible())
-        {
-          // Not compatible add to list
-          databaseNames.append("<i>" + FsPaths::typeToDisplayName(it.key()) + "</i>");
-          databaseFiles.append(dbName);
-          qWarning() << "Incompatible database" << dbName;
-        }
+        dbtools::createEmptySchema(&sqlDb);
         sqlDb.close();
       }
+      else if(result == CHECK_INCOMPATIBLE)
+      {
+        // Not compatible add to list
+        databaseNames.append("<i>" + FsPaths::typeToDisplayName(check.first) + "</i>");
+        databaseFiles.append(dbName);
+        qWarning() << "Incompatible database" << dbName;
+      }
     }
+    qDebug() << Q_FUNC_INFO << "Checked" << checks.size() << "databases in" << timer.elapsed() << "ms";
 
     // Delete the dummy database without dialog if needed
     QString dummyName = buildDatabaseFileName(atools::fs::FsPaths::NONE);
@@ -486,6 +545,7 @@ void DatabaseManager::checkCopyAndPrepareDatabases()
           simpleProgressDialog->repaint();
           atools::gui::Application::processEventsExtended();
           NavDatabase::runPreparationScript(tempDb);
+          dbtools::createQueryIndexes(&tempDb);
 
           simpleProgressDialog->setText(tr("Preparing %1 Database: Analyzing ...").arg(FsPaths::typeToDisplayName(FsPaths::NAVIGRAPH)));
           atools::gui::Application::processEventsExtended();
@@ -528,6 +588,7 @@ void DatabaseManager::checkCopyAndPrepareDatabases()
 
     // Executes all statements like create index in the table script and deletes it afterwards
     NavDatabase::runPreparationScript(tempDb);
+    dbtools::createQueryIndexes(&tempDb);
 
     tempDb.vacuum();
     tempDb.analyze();
@@ -903,6 +964,9 @@ void DatabaseManager::switchNavFromMainMenu()
 
     QGuiApplication::restoreOverrideCursor();
 
+    // Navdata mode decides which database is used for which objects
+    query::incrementRevision(query::REV_NAV_DB);
+    query::incrementRevision(query::REV_SIM_DB);
     emit postDatabaseLoad(currentFsType);
 
     mainWindow->setStatusMessage(text.arg(FsPaths::typeToDisplayName(FsPaths::NAVIGRAPH)));
@@ -921,11 +985,51 @@ void DatabaseManager::switchSimFromMainMenu()
   {
     atools::fs::FsPaths::SimulatorType type = action->data().value<atools::fs::FsPaths::SimulatorType>();
     if(currentFsType != type)
-      // Switch only if changed
-      switchSimInternal(type);
+      // Switch only if changed - keep current database serving until new one is prepared
+      switchSimWarmup(type);
   }
 }
 
+void DatabaseManager::switchSimWarmup(atools::fs::FsPaths::SimulatorType type)
+{
+  // Cancel a pending switch to another simulator
+  stopSwitchSimWarmup();
+
+  if(!Settings::instance().getAndStoreValue(lnm::SETTINGS_DATABASE + "Warmup", true).toBool())
+  {
+    switchSimInternal(type);
+    return;
+  }
+
+  qDebug() << Q_FUNC_INFO << FsPaths::typeToShortName(type);
+
+  switchWarmupFsType = type;
+  switchWarmupTerminate = false;
+  mainWindow->setStatusMessage(tr("Preparing switch to %1 ...").arg(FsPaths::typeToDisplayName(type)));
+  switchWarmupWatcher.setFuture(QtConcurrent::run(this, &DatabaseManager::warmupThread,
+                                                  QStringList({buildDatabaseFileName(type)}), &switchWarmupTerminate));
+}
+
+void DatabaseManager::switchSimWarmupFinished()
+{
+  if(!switchWarmupTerminate && switchWarmupFsType != FsPaths::NONE)
+  {
+    qDebug() << Q_FUNC_INFO << "Warm-up before switch took" << switchWarmupWatcher.result() << "ms";
+
+    // Swap databases - file cache is filled now which keeps the blocking part short
+    FsPaths::SimulatorType type = switchWarmupFsType;
+    switchWarmupFsType = FsPaths::NONE;
+    switchSimInternal(type);
+  }
+}
+
+void DatabaseManager::stopSwitchSimWarmup()
+{
+  switchWarmupTerminate = true;
+  switchWarmupWatcher.waitForFinished();
+  switchWarmupFsType = FsPaths::NONE;
+}
+
 void DatabaseManager::switchSimInternal(atools::fs::FsPaths::SimulatorType type)
 {
   qDebug() << Q_FUNC_INFO;
@@ -954,7 +1058,9 @@ void DatabaseManager::switchSimInternal(atools::fs::FsPaths::SimulatorType type)
 
   QGuiApplication::restoreOverrideCursor();
 
-  // Reopen all with new database
+  // Reopen all with new database - navdatabase can depend on simulator
+  query::incrementRevision(query::REV_NAV_DB);
+  query::incrementRevision(query::REV_SIM_DB);
   emit postDatabaseLoad(currentFsType);
   mainWindow->setStatusMessage(tr("Switched to %1.").arg(FsPaths::typeToDisplayName(currentFsType)));
 
@@ -969,8 +1075,14 @@ void DatabaseManager::switchSimInternal(atools::fs::FsPaths::SimulatorType type)
   }
 }
 
+void DatabaseManager::checkpointWriteableDatabases()
+{
+  for(SqlDatabase *db : {databaseUser, databaseLogbook, databaseUserAirspace, databaseTrack, databaseOnline})
+    dbtools::checkpointDatabase(db);
+}
+
 void DatabaseManager::openWriteableDatabase(atools::sql::SqlDatabase *database, const QString& name,
-                                            const QString& displayName, bool backup)
+                                            const QString& displayName, bool backup, bool synchronous)
 {
   QString databaseName = databaseDirectory + QDir::separator() + lnm::DATABASE_PREFIX + name + lnm::DATABASE_SUFFIX;
 
@@ -993,7 +1105,7 @@ void DatabaseManager::openWriteableDatabase(atools::sql::SqlDatabase *database,
     }
 
     dbtools::openDatabaseFileExt(database, databaseName, false /* readonly */, false /* createSchema */,
-                                 false /* exclusive */, false /* auto transactions */);
+                                 false /* exclusive */, false /* auto transactions */, true /* wal */, synchronous);
   }
   catch(atools::sql::SqlException& e)
   {
@@ -1046,27 +1158,63 @@ void DatabaseManager::closeOnlineDatabase()
 void DatabaseManager::clearLanguageIndex()
 {
   languageIndex->clear();
+  languageIndexPending = false;
 }
 
 void DatabaseManager::loadLanguageIndex()
 {
-  if(SqlUtil(databaseSim).hasTableAndRows("translation"))
-    languageIndex->readFromDb(databaseSim, OptionData::instance().getLanguage());
+  languageIndex->clear();
+  languageIndexPending = true;
 }
 
 void DatabaseManager::clearAircraftIndex()
 {
   aircraftIndex->clear();
+  aircraftIndexPending = false;
 }
 
 void DatabaseManager::loadAircraftIndex()
 {
-  if(currentFsType == FsPaths::MSFS && simulators.value(FsPaths::MSFS).isInstalled)
+  aircraftIndex->clear();
+  aircraftIndexPending = true;
+}
+
+void DatabaseManager::loadDeferredIndexes()
+{
+  getLanguageIndex();
+  getAircraftIndex();
+}
+
+const atools::fs::scenery::LanguageJson& DatabaseManager::getLanguageIndex()
+{
+  if(languageIndexPending)
   {
-    QString basePath = simulators.value(FsPaths::MSFS).basePath;
-    if(atools::checkDir(Q_FUNC_INFO, basePath, true /* warn */))
-      aircraftIndex->loadIndex({FsPaths::getMsfsCommunityPath(basePath), FsPaths::getMsfsOfficialPath(basePath)});
+    languageIndexPending = false;
+    QElapsedTimer timer;
+    timer.start();
+    if(SqlUtil(databaseSim).hasTableAndRows("translation"))
+      languageIndex->readFromDb(databaseSim, OptionData::instance().getLanguage());
+    qDebug() << Q_FUNC_INFO << "Loaded language index in" << timer.elapsed() << "ms";
   }
+  return *languageIndex;
+}
+
+atools::fs::scenery::AircraftIndex& DatabaseManager::getAircraftIndex()
+{
+  if(aircraftIndexPending)
+  {
+    aircraftIndexPending = false;
+    if(currentFsType == FsPaths::MSFS && simulators.value(FsPaths::MSFS).isInstalled)
+    {
+      QElapsedTimer timer;
+      timer.start();
+      QString basePath = simulators.value(FsPaths::MSFS).basePath;
+      if(atools::checkDir(Q_FUNC_INFO, basePath, true /* warn */))
+        aircraftIndex->loadIndex({FsPaths::getMsfsCommunityPath(basePath), FsPaths::getMsfsOfficialPath(basePath)});
+      qDebug() << Q_FUNC_INFO << "Loaded aircraft index in" << timer.elapsed() << "ms";
+    }
+  }
+  return *aircraftIndex;
 }
 
 void DatabaseManager::openAllDatabases()
@@ -1084,15 +1232,82 @@ void DatabaseManager::openAllDatabases()
     navDbFile = simDbFile;
   // else if(usingNavDatabase == MIXED)
 
+  QElapsedTimer timer;
+  timer.start();
   dbtools::openDatabaseFile(databaseSim, simDbFile, true /* readonly */, true /* createSchema */);
+  openTimeSimMs = timer.restart();
   dbtools::openDatabaseFile(databaseNav, navDbFile, true /* readonly */, true /* createSchema */);
+  openTimeNavMs = timer.elapsed();
+  qDebug() << Q_FUNC_INFO << "Opened sim database in" << openTimeSimMs << "ms and nav database in" << openTimeNavMs << "ms";
 
   dbtools::openDatabaseFile(databaseSimAirspace, simAirspaceDbFile, true /* readonly */, true /* createSchema */);
   dbtools::openDatabaseFile(databaseNavAirspace, navAirspaceDbFile, true /* readonly */, true /* createSchema */);
+
+  // Fill file cache in background using separate connections
+  warmupTimeMs = -1;
+  if(Settings::instance().getAndStoreValue(lnm::SETTINGS_DATABASE + "Warmup", true).toBool())
+  {
+    warmupTerminate = false;
+    QStringList files({simDbFile, navDbFile, simAirspaceDbFile, navAirspaceDbFile});
+    files.removeDuplicates();
+    warmupWatcher.setFuture(QtConcurrent::run(this, &DatabaseManager::warmupThread, files, &warmupTerminate));
+  }
+}
+
+qint64 DatabaseManager::warmupThread(QStringList files, const bool *terminate)
+{
+  // Thread priority is the closest portable replacement for I/O priority
+  QThread::Priority priority = QThread::currentThread()->priority();
+  QThread::currentThread()->setPriority(QThread::LowestPriority);
+
+  QElapsedTimer timer;
+  timer.start();
+  for(int i = 0; i < files.size(); i++)
+  {
+    QString fileName = QFileInfo(files.at(i)).fileName();
+    QString messagePrefix = tr("Preparing database %1 of %2 \"%3\": ").arg(i + 1).arg(files.size()).arg(fileName);
+
+    auto progress = [this, messagePrefix, terminate](const QString& table) -> void {
+      // Show status in GUI thread
+      QString message = messagePrefix + table + tr(" ...");
+      QMetaObject::invokeMethod(this, [this, message, terminate]() -> void {
+        if(mainWindow != nullptr && !*terminate)
+          mainWindow->setStatusMessage(message);
+      }, Qt::QueuedConnection);
+    };
+
+    atools::sql::SqlDatabase *db = NavApp::getDatabasePool()->getDatabase(files.at(i));
+    if(db != nullptr)
+      dbtools::warmupDatabase(db, *terminate, progress);
+  }
+
+  QThread::currentThread()->setPriority(priority);
+  return timer.elapsed();
+}
+
+void DatabaseManager::warmupFinished()
+{
+  if(!warmupTerminate)
+  {
+    warmupTimeMs = warmupWatcher.result();
+    qDebug() << Q_FUNC_INFO << "Database warm-up took" << warmupTimeMs << "ms";
+
+    if(mainWindow != nullptr)
+      mainWindow->setStatusMessage(tr("Databases prepared."));
+  }
+}
+
+void DatabaseManager::stopWarmup()
+{
+  warmupTerminate = true;
+  warmupWatcher.waitForFinished();
 }
 
 void DatabaseManager::closeAllDatabases()
 {
+  stopWarmup();
+  stopSwitchSimWarmup();
+
   dbtools::closeDatabaseFile(databaseSim);
   dbtools::closeDatabaseFile(databaseNav);
   dbtools::closeDatabaseFile(databaseSimAirspace);
@@ -1573,6 +1788,16 @@ void DatabaseManager::loadSceneryInternal()
       bool configValid = checkValidBasePaths();
 
       // Start compilation if all is valid ====================================================
+      // Skip reloading if no scenery area was changed since last load and user agrees ================
+      dbtools::SceneryAreaSignatures signatures;
+      if(configValid)
+      {
+        signatures = currentSceneryAreaSignatures();
+        configValid = confirmSceneryReload(signatures);
+        if(!configValid)
+          databaseLoader->setResultFlag(atools::fs::COMPILE_CANCELED);
+      }
+
       if(configValid)
       {
         // Compile into a temporary database file
@@ -1599,6 +1824,7 @@ void DatabaseManager::loadSceneryInternal()
         databaseLoader->setSelectedFsType(selectedFsType);
         databaseLoader->setSimulators(simulators);
         databaseLoader->setDatabaseFilename(tempFilename);
+        databaseLoader->setSceneryAreaSignatures(signatures);
         databaseLoader->clearResultFlags();
 
         if(!backgroundHintShown)
@@ -1630,6 +1856,88 @@ void DatabaseManager::loadSceneryInternal()
   }
 }
 
+dbtools::SceneryAreaSignatures DatabaseManager::currentSceneryAreaSignatures() const
+{
+  const FsPathType& paths = simulators.value(selectedFsType);
+  const QString& basePath = paths.basePath;
+
+  QStringList rootPaths;
+  if(selectedFsType == FsPaths::MSFS)
+    rootPaths << FsPaths::getMsfsCommunityPath(basePath) << FsPaths::getMsfsOfficialPath(basePath);
+  else if(FsPaths::isAnyXplane(selectedFsType))
+    rootPaths << basePath + "/Custom Scenery" << basePath + "/Custom Data" << basePath + "/Resources/default scenery";
+  else
+    rootPaths << paths.sceneryCfg << basePath + "/Scenery" << basePath + "/Addon Scenery";
+
+  const OptionData& optionData = OptionData::instance();
+  rootPaths.append(optionData.getDatabaseInclude());
+
+  // Any change in options requires a full reload
+  QStringList options({QApplication::applicationVersion(), QString::number(readInactive), QString::number(readAddOnXml)});
+  options.append(optionData.getDatabaseInclude());
+  options.append(optionData.getDatabaseExclude());
+  options.append(optionData.getDatabaseAddonExclude());
+
+  QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+  dbtools::SceneryAreaSignatures signatures = dbtools::buildSceneryAreaSignatures(rootPaths, options.join("|"));
+  QGuiApplication::restoreOverrideCursor();
+  return signatures;
+}
+
+bool DatabaseManager::confirmSceneryReload(const dbtools::SceneryAreaSignatures& signatures)
+{
+  dbtools::SceneryAreaSignatures lastSignatures;
+  if(selectedFsType == currentFsType && databaseSim != nullptr && databaseSim->isOpen())
+    lastSignatures = dbtools::readSceneryAreaSignatures(databaseSim);
+  else
+  {
+    QString filename = buildDatabaseFileName(selectedFsType);
+    if(QFile::exists(filename))
+    {
+      SqlDatabase tempDb(dbtools::DATABASE_NAME_TEMP);
+      dbtools::openDatabaseFileExt(&tempDb, filename, true /* readonly */, false /* createSchema */,
+                                   false /* exclusive */, false /* auto transactions */);
+      if(tempDb.isOpen())
+      {
+        lastSignatures = dbtools::readSceneryAreaSignatures(&tempDb);
+        dbtools::closeDatabaseFile(&tempDb);
+      }
+    }
+  }
+
+  // Database was not loaded with signatures before
+  if(lastSignatures.isEmpty())
+    return true;
+
+  // Collect added, removed and changed areas
+  QStringList changed;
+  for(auto it = signatures.constBegin(); it != signatures.constEnd(); ++it)
+  {
+    if(lastSignatures.value(it.key()) != it.value())
+      changed.append(it.key());
+  }
+  for(auto it = lastSignatures.constBegin(); it != lastSignatures.constEnd(); ++it)
+  {
+    if(!signatures.contains(it.key()))
+      changed.append(it.key());
+  }
+
+  if(!changed.isEmpty())
+  {
+    qInfo() << Q_FUNC_INFO << "Changed scenery areas" << changed;
+    return true;
+  }
+
+  qInfo() << Q_FUNC_INFO << "No scenery areas changed";
+  int result = QMessageBox::question(databaseDialog,
+                                     QApplication::applicationName(),
+                                     tr("<p>No changes found in the scenery library or loading options "
+                                        "since the database was loaded last time.</p>"
+                                        "<p>Load the scenery library database anyway?</p>"),
+                                     QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+  return result == QMessageBox::Yes;
+}
+
 void DatabaseManager::loadSceneryInternalPost()
 {
   qDebug() << Q_FUNC_INFO;
@@ -1687,7 +1995,8 @@ void DatabaseManager::loadSceneryInternalPost()
     clearAircraftIndex();
     loadAircraftIndex();
 
-    // Notify all objects in program on change
+    // Notify all objects in program on change - only scenery was reloaded
+    query::incrementRevision(query::REV_SIM_DB);
     emit postDatabaseLoad(currentFsType);
   }
   else
@@ -1866,9 +2175,19 @@ void DatabaseManager::updateDialogInfo(atools::fs::FsPaths::SimulatorType value)
     optionsHeader.append(tr("Included and excluded directories can be changed in options on page \"Scenery Library Database\"."));
   }
 
+  // Performance profile and times of the databases in use
+  QStringList profile = dbtools::readonlyProfilePragmas();
+  profile.replaceInStrings("PRAGMA ", QString());
+  QString timeText = tr("<p><b>Performance:</b> %1.<br/>"
+                        "Simulator database opened in %2, navdata database opened in %3, warm-up %4.</p>").
+                     arg(profile.join(tr(", "))).
+                     arg(openTimeSimMs >= 0 ? tr("%L1 ms").arg(openTimeSimMs) : tr("-")).
+                     arg(openTimeNavMs >= 0 ? tr("%L1 ms").arg(openTimeNavMs) : tr("-")).
+                     arg(warmupTimeMs >= 0 ? tr("%L1 ms").arg(warmupTimeMs) : tr("not done"));
+
   databaseDialog->setHeader(metaText +
                             atools::strJoin(tr("<p>"), optionsHeader, tr("<br/>"), tr("<br/>"), tr("</p>")) +
-                            tr("<p><big>Currently Loaded:</big></p><p>%1</p>").arg(tableText));
+                            tr("<p><big>Currently Loaded:</big></p><p>%1</p>").arg(tableText) + timeText);
 
   if(tempDb.isOpen())
     tempDb.close();
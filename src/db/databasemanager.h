@@ -20,9 +20,12 @@
 
 #include "fs/fspaths.h"
 #include "db/dbtypes.h"
+#include "db/dbtools.h"
 
 #include <QAction>
+#include <QFutureWatcher>
 #include <QObject>
+#include <QTimer>
 
 namespace atools {
 namespace gui {
@@ -119,14 +122,23 @@ public:
    * Only for scenery database */
   void openAllDatabases();
 
-  /* Load MSFS translations for current language */
+  /* Load MSFS translations for current language. Loading is deferred until first use or
+   * loadDeferredIndexes() is called in idle time after startup. */
   void loadLanguageIndex();
 
-  /* Load MSFS aircraft.cfg files from paths */
+  /* Load MSFS aircraft.cfg files from paths. Deferred like loadLanguageIndex(). */
   void loadAircraftIndex();
 
-  /* Open a writeable database for userpoints or online network data. Automatic transactions are off.  */
-  void openWriteableDatabase(atools::sql::SqlDatabase *database, const QString& name, const QString& displayName, bool backup);
+  /* Load all indexes now which are still pending from calls above */
+  void loadDeferredIndexes();
+
+  /* Open a writeable database for userpoints or online network data. Automatic transactions are off.
+   * Database uses write-ahead logging. synchronous false disables fsync for data which can be downloaded again. */
+  void openWriteableDatabase(atools::sql::SqlDatabase *database, const QString& name, const QString& displayName, bool backup,
+                             bool synchronous);
+
+  /* Called by timer. Passive checkpoint for all writeable databases in WAL mode. */
+  void checkpointWriteableDatabases();
   void closeLogDatabase();
   void closeUserDatabase();
   void closeTrackDatabase();
@@ -169,7 +181,7 @@ public:
    */
   void insertSimSwitchActions();
 
-  /* if false quit application */
+  /* if false quit application. Database metadata is read in parallel for all simulators. */
   bool checkIncompatibleDatabases(bool *databasesErased);
 
   /* Copy from app dir to settings directory if newer and create indexes if missing */
@@ -248,17 +260,11 @@ public:
 
   atools::sql::SqlDatabase *getDatabaseOnline() const;
 
-  /* MSFS translations from table "translation" */
-  const atools::fs::scenery::LanguageJson& getLanguageIndex() const
-  {
-    return *languageIndex;
-  }
+  /* MSFS translations from table "translation". Loaded on first call if still pending. */
+  const atools::fs::scenery::LanguageJson& getLanguageIndex();
 
-  /* MSFS translations from table "translation" */
-  atools::fs::scenery::AircraftIndex& getAircraftIndex() const
-  {
-    return *aircraftIndex;
-  }
+  /* MSFS aircraft.cfg properties. Loaded on first call if still pending. */
+  atools::fs::scenery::AircraftIndex& getAircraftIndex();
 
   /* Checks if size and last modification time have changed on the readonly nav and sim databases.
    * Shows an error dialog if this is the case */
@@ -320,6 +326,12 @@ private:
   void switchSimFromMainMenu();
   void switchSimInternal(atools::fs::FsPaths::SimulatorType type);
 
+  /* Warms up the database of the given simulator in background while the current one keeps serving
+   * map and search. Calls switchSimInternal() once done. */
+  void switchSimWarmup(atools::fs::FsPaths::SimulatorType type);
+  void switchSimWarmupFinished();
+  void stopSwitchSimWarmup();
+
   /* Navdatabase mode change from main menu */
   void switchNavFromMainMenu();
 
@@ -347,6 +359,13 @@ private:
 
   bool checkValidBasePaths() const;
 
+  /* Signatures of all scenery areas for the selected simulator and current loading options */
+  dbtools::SceneryAreaSignatures currentSceneryAreaSignatures() const;
+
+  /* Compares signatures with the ones saved in the database of the selected simulator.
+   * Asks user if nothing changed. Returns false if loading should be skipped. */
+  bool confirmSceneryReload(const dbtools::SceneryAreaSignatures& signatures);
+
   /* Disable or enable nav menu items depending on auto status */
   void updateNavMenuStatus();
 
@@ -375,6 +394,35 @@ private:
 
   bool showingDatabaseChangeWarning = false;
 
+  enum DatabaseCheckResult
+  {
+    CHECK_OK,
+    CHECK_NO_SCHEMA,
+    CHECK_INCOMPATIBLE
+  };
+
+  /* Opens filename read only in the calling thread and checks schema and version. Thread safe. */
+  static DatabaseCheckResult checkDatabaseThread(QString filename, QString connectionName);
+
+  /* Reads hot tables and indexes of the scenery and airspace databases in background after opening to fill
+   * the file cache. Shows progress in the status bar. Returns elapsed time. */
+  qint64 warmupThread(QStringList files, const bool *terminate);
+  void warmupFinished();
+  void stopWarmup();
+
+  /* Measured times for the database dialog. -1 if not available. */
+  qint64 openTimeSimMs = -1, openTimeNavMs = -1, warmupTimeMs = -1;
+  QFutureWatcher<qint64> warmupWatcher;
+  bool warmupTerminate = false;
+
+  /* Checkpoints write-ahead logs of user, logbook, track and online databases */
+  QTimer walCheckpointTimer;
+
+  /* Warm-up before switching simulators. Target is NONE if no switch is pending. */
+  QFutureWatcher<qint64> switchWarmupWatcher;
+  bool switchWarmupTerminate = false;
+  atools::fs::FsPaths::SimulatorType switchWarmupFsType = atools::fs::FsPaths::NONE;
+
   MainWindow *mainWindow = nullptr;
 
   /* Switch simulator actions */
@@ -413,6 +461,9 @@ private:
   atools::fs::scenery::LanguageJson *languageIndex = nullptr;
   atools::fs::scenery::AircraftIndex *aircraftIndex = nullptr;
 
+  /* Indexes have to be loaded on next access */
+  bool languageIndexPending = false, aircraftIndexPending = false;
+
   /* Show hint dialog only once per session */
   bool backgroundHintShown = false;
 };
@@ -0,0 +1,156 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "db/databasepool.h"
+
+#include "db/dbtools.h"
+#include "exception.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QCache>
+#include <QDebug>
+
+using atools::sql::SqlDatabase;
+using atools::sql::SqlQuery;
+
+/* Connection to one file and its prepared statements */
+struct DatabasePool::Connection
+{
+  ~Connection()
+  {
+    // Statements have to be deleted before closing the connection
+    queries.clear();
+    if(db != nullptr)
+      dbtools::closeDatabaseThread(db, name);
+  }
+
+  QString name;
+  SqlDatabase *db = nullptr;
+  QCache<QString, SqlQuery> queries;
+};
+
+/* All connections of one thread. Deleted by QThreadStorage in the owning thread when it finishes. */
+struct DatabasePool::ThreadConnections
+{
+  ~ThreadConnections()
+  {
+    qDeleteAll(connections);
+  }
+
+  int generation = 0;
+  QHash<QString, Connection *> connections;
+};
+
+DatabasePool::DatabasePool()
+{
+
+}
+
+DatabasePool::~DatabasePool()
+{
+  // Data of other threads is not deleted by QThreadStorage - these have to be finished already
+  releaseThread();
+}
+
+DatabasePool::ThreadConnections *DatabasePool::threadConnections()
+{
+  if(!connections.hasLocalData())
+  {
+    ThreadConnections *threadData = new ThreadConnections;
+    threadData->generation = generation.loadAcquire();
+    connections.setLocalData(threadData);
+  }
+
+  ThreadConnections *threadData = connections.localData();
+  int gen = generation.loadAcquire();
+  if(threadData->generation != gen)
+  {
+    // Databases were switched - close outdated connections
+    qDeleteAll(threadData->connections);
+    threadData->connections.clear();
+    threadData->generation = gen;
+  }
+  return threadData;
+}
+
+SqlDatabase *DatabasePool::getDatabase(const QString& file)
+{
+  ThreadConnections *threadData = threadConnections();
+
+  Connection *connection = threadData->connections.value(file);
+  if(connection == nullptr)
+  {
+    // Connection names have to be unique across all threads
+    QString name = "LNMPOOL" + QString::number(connectionCounter.fetchAndAddOrdered(1));
+    SqlDatabase *db = dbtools::openDatabaseThread(name, file);
+    if(db == nullptr)
+      return nullptr;
+
+    connection = new Connection;
+    connection->name = name;
+    connection->db = db;
+    connection->queries.setMaxCost(MAX_QUERIES);
+    threadData->connections.insert(file, connection);
+  }
+  return connection->db;
+}
+
+SqlQuery *DatabasePool::getQuery(const QString& file, const QString& sql)
+{
+  SqlDatabase *db = getDatabase(file);
+  if(db == nullptr)
+    return nullptr;
+
+  Connection *connection = connections.localData()->connections.value(file);
+  SqlQuery *query = connection->queries.object(sql);
+  if(query == nullptr)
+  {
+    try
+    {
+      query = new SqlQuery(db);
+      query->prepare(sql);
+    }
+    catch(atools::Exception& e)
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot prepare" << sql << e.what();
+      delete query;
+      return nullptr;
+    }
+    catch(...)
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot prepare" << sql;
+      delete query;
+      return nullptr;
+    }
+    connection->queries.insert(sql, query);
+  }
+  return query;
+}
+
+void DatabasePool::releaseThread()
+{
+  if(connections.hasLocalData())
+    // Deletes the old data and closes all connections
+    connections.setLocalData(nullptr);
+}
+
+void DatabasePool::invalidate()
+{
+  generation.fetchAndAddOrdered(1);
+  releaseThread();
+}
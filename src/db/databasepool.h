@@ -0,0 +1,82 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_DATABASEPOOL_H
+#define LNM_DATABASEPOOL_H
+
+#include <QAtomicInt>
+#include <QThreadStorage>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+class SqlQuery;
+}
+}
+
+/*
+ * Hands out read only connections to database files and cached prepared statements for the calling thread.
+ * Used by background jobs like prefetching, search counts and route network loading which cannot use the
+ * GUI thread connections.
+ *
+ * Connections are opened on first use and kept per thread until the thread finishes, releaseThread()
+ * is called in this thread or the pool is invalidated. Threads of the global QThreadPool therefore
+ * reuse their connections and statements for following jobs.
+ *
+ * All methods are thread safe. Objects returned must not be passed to other threads.
+ */
+class DatabasePool
+{
+public:
+  DatabasePool();
+  ~DatabasePool();
+
+  DatabasePool(const DatabasePool& other) = delete;
+  DatabasePool& operator=(const DatabasePool& other) = delete;
+
+  /* Get a read only connection to file for the calling thread. Returns null on error.
+   * Connection is owned by the pool. */
+  atools::sql::SqlDatabase *getDatabase(const QString& file);
+
+  /* Get a prepared statement for the connection to file of the calling thread. Returns null on error.
+   * Statement is owned by the pool and stays valid until the connection is closed or it is dropped
+   * after MAX_QUERIES other statements were used on the same connection. Call finish() when done. */
+  atools::sql::SqlQuery *getQuery(const QString& file, const QString& sql);
+
+  /* Close all connections of the calling thread */
+  void releaseThread();
+
+  /* Mark all connections as outdated. Has to be called before databases are switched or replaced.
+   * Closes the connections of the calling thread. Other threads close their outdated connections themselves on
+   * next access or when they finish since connections must not be used or closed outside of their thread.
+   * Does not block. */
+  void invalidate();
+
+private:
+  struct Connection;
+  struct ThreadConnections;
+
+  /* Maximum number of cached prepared statements per connection */
+  static Q_DECL_CONSTEXPR int MAX_QUERIES = 64;
+
+  ThreadConnections *threadConnections();
+
+  QThreadStorage<ThreadConnections *> connections;
+  QAtomicInt generation, connectionCounter;
+};
+
+#endif // LNM_DATABASEPOOL_H
@@ -18,6 +18,9 @@
 #include "db/dbtools.h"
 
 #include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlutil.h"
+#include "sql/sqltransaction.h"
 #include "exception.h"
 #include "settings/settings.h"
 #include "common/constants.h"
@@ -27,11 +30,14 @@
 #include "fs/navdatabase.h"
 
 #include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
 
 namespace dbtools {
 
 void openDatabaseFileExt(atools::sql::SqlDatabase *db, const QString& file, bool readonly,
-                         bool createSchema, bool exclusive, bool autoTransactions)
+                         bool createSchema, bool exclusive, bool autoTransactions, bool wal, bool synchronous)
 {
   atools::settings::Settings& settings = atools::settings::Settings::instance();
   int databaseCacheKb = settings.getAndStoreValue(lnm::SETTINGS_DATABASE + "CacheKb", 50000).toInt();
@@ -47,12 +53,23 @@ void openDatabaseFileExt(atools::sql::SqlDatabase *db, const QString& file, bool
     databasePragmas.append("PRAGMA journal_mode=TRUNCATE");
     databasePragmas.append("PRAGMA synchronous=OFF");
   }
+  else if(wal)
+  {
+    // Best settings for online and user databases which are updated often while the GUI reads - read/write
+    // Writers do not block readers. Checkpoints are done by timer and automatic ones are only a fallback
+    // to limit the log size
+    int autoCheckpointPages = settings.getAndStoreValue(lnm::SETTINGS_DATABASE + "WalAutoCheckpointPages", 10000).toInt();
+    databasePragmas.append("PRAGMA locking_mode=NORMAL");
+    databasePragmas.append("PRAGMA journal_mode=WAL");
+    databasePragmas.append(synchronous ? "PRAGMA synchronous=NORMAL" : "PRAGMA synchronous=OFF");
+    databasePragmas.append(QString("PRAGMA wal_autocheckpoint=%1").arg(autoCheckpointPages));
+  }
   else
   {
-    // Best settings for online and user databases which are updated often - read/write
+    // Read/write databases in rollback journal mode
     databasePragmas.append("PRAGMA locking_mode=NORMAL");
     databasePragmas.append("PRAGMA journal_mode=DELETE");
-    databasePragmas.append("PRAGMA synchronous=NORMAL");
+    databasePragmas.append(synchronous ? "PRAGMA synchronous=NORMAL" : "PRAGMA synchronous=OFF");
   }
 
   if(!readonly)
@@ -98,6 +115,14 @@ void openDatabaseFileExt(atools::sql::SqlDatabase *db, const QString& file, bool
     db->open(databasePragmas);
   }
 
+  if(readonly)
+  {
+    // Apply performance profile after schema creation since query_only prevents any modification
+    atools::sql::SqlQuery query(db);
+    for(const QString& pragma : readonlyProfilePragmas())
+      query.exec(pragma);
+  }
+
   atools::fs::db::DatabaseMeta(db).logInfo();
 }
 
@@ -117,6 +142,32 @@ void openDatabaseFile(atools::sql::SqlDatabase *db, const QString& file, bool re
   }
 }
 
+void checkpointDatabase(atools::sql::SqlDatabase *db)
+{
+  try
+  {
+    if(db != nullptr && db->isOpen())
+    {
+      atools::sql::SqlQuery query(db);
+      query.exec("PRAGMA journal_mode");
+      if(query.next() && query.valueStr(0).compare("wal", Qt::CaseInsensitive) == 0)
+      {
+        query.finish();
+
+        // Returns busy flag, number of pages in log and number of pages checkpointed
+        query.exec("PRAGMA wal_checkpoint(PASSIVE)");
+        if(query.next() && query.valueInt(1) > 0)
+          qDebug() << Q_FUNC_INFO << db->databaseName() << "busy" << query.valueInt(0)
+                   << "log pages" << query.valueInt(1) << "checkpointed" << query.valueInt(2);
+      }
+    }
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Checkpoint failed" << e.what();
+  }
+}
+
 void closeDatabaseFile(atools::sql::SqlDatabase *db)
 {
   try
@@ -137,6 +188,320 @@ void closeDatabaseFile(atools::sql::SqlDatabase *db)
   }
 }
 
+QStringList readonlyProfilePragmas()
+{
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  qint64 mmapSizeMb = settings.getAndStoreValue(lnm::SETTINGS_DATABASE + "MmapSizeMb", 256).toLongLong();
+  bool tempStoreMemory = settings.getAndStoreValue(lnm::SETTINGS_DATABASE + "TempStoreMemory", true).toBool();
+  bool queryOnly = settings.getAndStoreValue(lnm::SETTINGS_DATABASE + "QueryOnly", true).toBool();
+
+  // Memory mapped I/O avoids copying pages into the page cache - zero disables it
+  QStringList pragmas({QString("PRAGMA mmap_size=%1").arg(std::max(mmapSizeMb, 0LL) * 1024LL * 1024LL)});
+  if(tempStoreMemory)
+    pragmas.append("PRAGMA temp_store=MEMORY");
+  if(queryOnly)
+    pragmas.append("PRAGMA query_only=ON");
+  return pragmas;
+}
+
+void warmupDatabase(atools::sql::SqlDatabase *db, const bool& terminate,
+                    const std::function<void(const QString& table)>& progress)
+{
+  try
+  {
+    atools::sql::SqlUtil util(db);
+    atools::sql::SqlQuery query(db), indexQuery(db);
+    indexQuery.prepare("select name from sqlite_master where type = 'index' and tbl_name = :table");
+
+    // Tables and indexes needed for map display, search and information
+    for(const QString& table : {"airport", "runway_end", "vor", "ndb", "waypoint", "airway", "boundary"})
+    {
+      if(terminate)
+        break;
+
+      if(!util.hasTable(table))
+        continue;
+
+      if(progress)
+        progress(table);
+
+      // Full scan reads the table b-tree in rowid order which is mostly the page order for loaded databases
+      query.exec("select count(rowid) from " + table);
+      query.next();
+      query.finish();
+
+      QStringList indexes;
+      indexQuery.bindValue(":table", table);
+      indexQuery.exec();
+      while(indexQuery.next())
+        indexes.append(indexQuery.valueStr(0));
+
+      // Scan each index completely
+      for(const QString& index : qAsConst(indexes))
+      {
+        if(terminate)
+          break;
+
+        query.exec("select count(1) from " + table + " indexed by " + index);
+        query.next();
+        query.finish();
+      }
+    }
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Warm-up failed" << db->databaseName() << e.what();
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Warm-up failed" << db->databaseName();
+  }
+}
+
+/* Index name suffix, table and columns */
+struct QueryIndex
+{
+  QString name, table;
+  QStringList columns;
+};
+
+/* Creates all missing indexes and returns the number of new indexes */
+static int createIndexes(atools::sql::SqlDatabase *db, const QVector<QueryIndex>& indexes)
+{
+  int created = 0;
+  try
+  {
+    atools::sql::SqlUtil util(db);
+    atools::sql::SqlQuery query(db);
+    atools::sql::SqlQuery existsQuery(db);
+    existsQuery.prepare("select count(1) from sqlite_master where type = 'index' and name = :name");
+
+    atools::sql::SqlTransaction transaction(db);
+    for(const QueryIndex& index : indexes)
+    {
+      // Skip if table or any column is missing in this database version
+      bool hasColumns = true;
+      for(const QString& column : index.columns)
+        hasColumns &= util.hasTableAndColumn(index.table, column);
+      if(!hasColumns)
+        continue;
+
+      QString name = "lnm_idx_" + index.name;
+      existsQuery.bindValue(":name", name);
+      existsQuery.exec();
+      bool exists = existsQuery.next() && existsQuery.valueInt(0) > 0;
+      existsQuery.finish();
+
+      if(!exists)
+      {
+        query.exec("create index " + name + " on " + index.table + "(" + index.columns.join(", ") + ")");
+        created++;
+      }
+    }
+    transaction.commit();
+
+    // Update planner statistics for the new indexes
+    if(created > 0)
+      db->analyze();
+
+    qDebug() << Q_FUNC_INFO << db->databaseName() << "created" << created << "indexes";
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Creating indexes failed" << db->databaseName() << e.what();
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Creating indexes failed" << db->databaseName();
+  }
+  return created;
+}
+
+int createQueryIndexes(atools::sql::SqlDatabase *db)
+{
+  // Match where clauses of the rect and ident queries in MapQuery, AirportQuery and the search
+  static const QVector<QueryIndex> INDEXES({
+    // Airports by rect with minimum runway length and add-on airports by rect
+    {"airport_rect_length", "airport", {"lonx", "laty", "longest_runway_length"}},
+    {"airport_addon_rect", "airport", {"is_addon", "lonx", "laty"}},
+
+    // Runway overview and airports and runways by rect
+    {"runway_rect_length", "runway", {"lonx", "laty", "length"}},
+
+    // Start positions by number and name
+    {"start_airport_number", "start", {"airport_id", "number"}},
+    {"start_airport_name", "start", {"airport_id", "runway_name"}},
+
+    // Navaids by ident and region
+    {"waypoint_ident_region", "waypoint", {"ident", "region"}},
+    {"vor_ident_region", "vor", {"ident", "region"}},
+    {"ndb_ident_region", "ndb", {"ident", "region"}},
+    {"ils_ident_airport", "ils", {"ident", "loc_airport_ident"}},
+
+    // Remaining map rect queries without spatial index
+    {"marker_rect", "marker", {"lonx", "laty"}},
+    {"holding_rect", "holding", {"lonx", "laty"}},
+    {"airport_msa_rect", "airport_msa", {"lonx", "laty"}}
+  });
+
+  return createIndexes(db, INDEXES);
+}
+
+int createLogbookIndexes(atools::sql::SqlDatabase *db)
+{
+  // Logbook search filters and statistics grouping
+  static const QVector<QueryIndex> INDEXES({
+    {"logbook_departure", "logbook", {"departure_ident", "departure_name"}},
+    {"logbook_destination", "logbook", {"destination_ident", "destination_name"}},
+    {"logbook_departure_time", "logbook", {"departure_time"}},
+    {"logbook_aircraft", "logbook", {"simulator", "aircraft_type", "aircraft_registration"}}
+  });
+
+  return createIndexes(db, INDEXES);
+}
+
+SceneryAreaSignatures buildSceneryAreaSignatures(const QStringList& rootPaths, const QString& options)
+{
+  SceneryAreaSignatures signatures;
+  signatures.insert("options", options);
+
+  for(const QString& rootPath : rootPaths)
+  {
+    QFileInfo rootInfo(rootPath);
+    if(!rootInfo.exists())
+      continue;
+
+    // Root can be a single file like scenery.cfg or a folder containing areas
+    QFileInfoList areas;
+    if(rootInfo.isDir())
+      areas = QDir(rootPath).entryInfoList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot | QDir::Hidden);
+    else
+      areas.append(rootInfo);
+
+    for(const QFileInfo& area : qAsConst(areas))
+    {
+      qint64 numFiles = 0, size = 0, lastModified = 0;
+      if(area.isDir())
+      {
+        QDirIterator it(area.absoluteFilePath(), QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot,
+                        QDirIterator::Subdirectories | QDirIterator::FollowSymlinks);
+        while(it.hasNext())
+        {
+          it.next();
+          QFileInfo info = it.fileInfo();
+          numFiles++;
+          size += info.size();
+          lastModified = std::max(lastModified, info.lastModified().toMSecsSinceEpoch());
+        }
+      }
+      else
+      {
+        numFiles = 1;
+        size = area.size();
+        lastModified = area.lastModified().toMSecsSinceEpoch();
+      }
+
+      // Folder modification time catches removed files not changing the other values
+      lastModified = std::max(lastModified, area.lastModified().toMSecsSinceEpoch());
+
+      signatures.insert(QDir::cleanPath(area.absoluteFilePath()),
+                        QString("%1:%2:%3").arg(numFiles).arg(size).arg(lastModified));
+    }
+  }
+  return signatures;
+}
+
+SceneryAreaSignatures readSceneryAreaSignatures(atools::sql::SqlDatabase *db)
+{
+  SceneryAreaSignatures signatures;
+  try
+  {
+    if(atools::sql::SqlUtil(db).hasTable("scenery_area_signature"))
+    {
+      atools::sql::SqlQuery query("select path, signature from scenery_area_signature", db);
+      query.exec();
+      while(query.next())
+        signatures.insert(query.valueStr(0), query.valueStr(1));
+    }
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Reading signatures failed" << db->databaseName() << e.what();
+  }
+  return signatures;
+}
+
+void writeSceneryAreaSignatures(atools::sql::SqlDatabase *db, const SceneryAreaSignatures& signatures)
+{
+  try
+  {
+    atools::sql::SqlTransaction transaction(db);
+    atools::sql::SqlQuery query(db);
+    query.exec("drop table if exists scenery_area_signature");
+    query.exec("create table scenery_area_signature (path varchar(1024) not null, signature varchar(100) not null)");
+
+    query.prepare("insert into scenery_area_signature (path, signature) values(:path, :signature)");
+    for(auto it = signatures.constBegin(); it != signatures.constEnd(); ++it)
+    {
+      query.bindValue(":path", it.key());
+      query.bindValue(":signature", it.value());
+      query.exec();
+    }
+    transaction.commit();
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Writing signatures failed" << db->databaseName() << e.what();
+  }
+}
+
+atools::sql::SqlDatabase *openDatabaseThread(const QString& connectionName, const QString& file)
+{
+  atools::sql::SqlDatabase *db = nullptr;
+  try
+  {
+    atools::sql::SqlDatabase::addDatabase(DATABASE_TYPE, connectionName);
+    db = new atools::sql::SqlDatabase(connectionName);
+    db->setDatabaseName(file);
+    db->setReadonly();
+
+    // Normal locking since the GUI connection reads in parallel
+    db->open({"PRAGMA cache_size=-10000", "PRAGMA locking_mode=NORMAL", "PRAGMA foreign_keys = OFF"});
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << file << e.what();
+    closeDatabaseThread(db, connectionName);
+    db = nullptr;
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << file;
+    closeDatabaseThread(db, connectionName);
+    db = nullptr;
+  }
+  return db;
+}
+
+void closeDatabaseThread(atools::sql::SqlDatabase *db, const QString& connectionName)
+{
+  try
+  {
+    if(db != nullptr && db->isOpen())
+      db->close();
+    delete db;
+    atools::sql::SqlDatabase::removeDatabase(connectionName);
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot close" << connectionName << e.what();
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot close" << connectionName;
+  }
+}
+
 bool hasSchema(atools::sql::SqlDatabase *db)
 {
   try
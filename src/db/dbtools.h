@@ -18,7 +18,10 @@
 #ifndef LNM_DBTOOLS_H
 #define LNM_DBTOOLS_H
 
-#include <QString>
+#include <QMap>
+#include <QStringList>
+
+#include <functional>
 
 namespace atools {
 namespace sql {
@@ -66,13 +69,61 @@ const QString DATABASE_TYPE = "QSQLITE";
 /* Catches exceptions and terminates program if any */
 void openDatabaseFile(atools::sql::SqlDatabase *db, const QString& file, bool readonly, bool createSchema);
 
-/* Ignores exceptions */
+/* Ignores exceptions.
+ * wal enables write-ahead logging for non exclusive databases which allows readers and one writer in parallel.
+ * Automatic checkpoints are reduced to a fallback and checkpointDatabase() has to be called periodically.
+ * synchronous set to false disables fsync which might lose the last transactions on power loss. */
 void openDatabaseFileExt(atools::sql::SqlDatabase *db, const QString& file, bool readonly, bool createSchema, bool exclusive,
-                         bool autoTransactions);
+                         bool autoTransactions, bool wal = false, bool synchronous = true);
+
+/* Runs a passive checkpoint on a database in WAL mode which does not block readers or writers.
+ * Does nothing for other journal modes. Logs exceptions. */
+void checkpointDatabase(atools::sql::SqlDatabase *db);
 
 /* Catches exceptions and terminates program if any */
 void closeDatabaseFile(atools::sql::SqlDatabase *db);
 
+/* Performance profile for read only scenery library databases applied in openDatabaseFileExt().
+ * Reads keys "MmapSizeMb", "TempStoreMemory" and "QueryOnly" from section "Settings/Database".
+ * Page cache and locking mode are set by openDatabaseFileExt() itself. */
+QStringList readonlyProfilePragmas();
+
+/* Reads through the main tables and all their indexes in the given read only database to fill the operating
+ * system file cache. progress is called with the table name before reading it.
+ * Stops early if terminate is set. Ignores missing tables and logs exceptions. */
+void warmupDatabase(atools::sql::SqlDatabase *db, const bool& terminate,
+                    const std::function<void(const QString& table)>& progress = nullptr);
+
+/* Opens an additional read only connection to file which can be used in the current thread only.
+ * Does not access settings and is safe to be called from worker threads.
+ * Connection name has to be unique. Logs exceptions and returns null on error. */
+atools::sql::SqlDatabase *openDatabaseThread(const QString& connectionName, const QString& file);
+
+/* Closes, deletes and removes the connection opened by openDatabaseThread. Has to be called in the same thread. */
+void closeDatabaseThread(atools::sql::SqlDatabase *db, const QString& connectionName);
+
+/* Creates the additional indexes used by map, search and information queries in a scenery library or
+ * navdata database and runs ANALYZE if any index was created. Indexes are named "lnm_idx_*".
+ * Skips indexes for missing tables or columns and logs exceptions. Returns number of created indexes. */
+int createQueryIndexes(atools::sql::SqlDatabase *db);
+
+/* Same as createQueryIndexes() for the logbook database */
+int createLogbookIndexes(atools::sql::SqlDatabase *db);
+
+/* Signatures used to detect changed scenery areas between two scenery library loads.
+ * Key is the absolute path of an area or "options" for the loading options.
+ * Value contains number of files, total size and latest modification time of all files in the area. */
+typedef QMap<QString, QString> SceneryAreaSignatures;
+
+/* Builds signatures for each first level folder or file in rootPaths. Only file metadata is read.
+ * options is stored with key "options" to detect changed loading options. */
+SceneryAreaSignatures buildSceneryAreaSignatures(const QStringList& rootPaths, const QString& options);
+
+/* Read and write signatures from or to the table "scenery_area_signature" in a scenery library database.
+ * Reading returns an empty map if the table does not exist. Both log exceptions. */
+SceneryAreaSignatures readSceneryAreaSignatures(atools::sql::SqlDatabase *db);
+void writeSceneryAreaSignatures(atools::sql::SqlDatabase *db, const SceneryAreaSignatures& signatures);
+
 /* Checks if the current database has a schema. Exits program if this fails */
 bool hasSchema(atools::sql::SqlDatabase *db);
 
@@ -0,0 +1,130 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#include "db/statementcache.h"
+
+#include "common/constants.h"
+#include "exception.h"
+#include "settings/settings.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+
+using atools::sql::SqlDatabase;
+using atools::sql::SqlQuery;
+
+StatementCache::StatementCache(SqlDatabase *sqlDb, int maxStatementsParam)
+  : db(sqlDb), maxStatements(maxStatementsParam)
+{
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  debug = settings.getAndStoreValue(lnm::OPTIONS_QUERY_DEBUG, false).toBool();
+  slowMs = settings.getAndStoreValue(lnm::OPTIONS_QUERY_DEBUG_SLOW_MS, 20).toInt();
+}
+
+StatementCache::~StatementCache()
+{
+  clear();
+}
+
+SqlQuery *StatementCache::query(const QString& sql)
+{
+  for(int i = statements.size() - 1; i >= 0; i--)
+  {
+    if(statements.at(i).sql == sql)
+    {
+      // Move to end of list to mark as recently used
+      Statement statement = statements.takeAt(i);
+      statements.append(statement);
+      return statement.query;
+    }
+  }
+
+  // Drop least recently used
+  if(statements.size() >= maxStatements)
+    delete statements.takeFirst().query;
+
+  SqlQuery *query = new SqlQuery(db);
+  query->prepare(sql);
+  statements.append({sql, query});
+  return query;
+}
+
+void StatementCache::exec(SqlQuery *query)
+{
+  if(!debug)
+  {
+    query->exec();
+    return;
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+  query->exec();
+  qint64 elapsedMs = timer.elapsed();
+
+  for(const Statement& statement : statements)
+  {
+    if(statement.query == query)
+    {
+      if(elapsedMs >= slowMs || !explained.contains(statement.sql))
+        logQueryPlan(statement.sql, elapsedMs);
+      break;
+    }
+  }
+}
+
+void StatementCache::clear()
+{
+  for(const Statement& statement : statements)
+    delete statement.query;
+  statements.clear();
+  explained.clear();
+}
+
+void StatementCache::logQueryPlan(const QString& sql, qint64 elapsedMs)
+{
+  explained.insert(sql);
+
+  QStringList details;
+  bool fullScan = false;
+  try
+  {
+    // Parameters which are not bound are null which does not change the plan
+    SqlQuery explain(db);
+    explain.exec("explain query plan " + sql);
+    while(explain.next())
+    {
+      QString detail = explain.valueStr("detail");
+      details.append(detail);
+
+      // "SCAN TABLE airport" or "SCAN airport" depending on SQLite version - "USING INDEX" is fine
+      if(detail.startsWith("SCAN") && !detail.contains("USING"))
+        fullScan = true;
+    }
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot explain" << sql << e.what();
+    return;
+  }
+
+  if(fullScan || elapsedMs >= slowMs)
+    qDebug() << Q_FUNC_INFO << (fullScan ? "Full scan" : "Slow") << elapsedMs << "ms" << sql << details;
+}
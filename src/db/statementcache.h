@@ -0,0 +1,85 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#ifndef LNM_STATEMENTCACHE_H
+#define LNM_STATEMENTCACHE_H
+
+#include <QSet>
+#include <QVector>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+class SqlQuery;
+}
+}
+
+/*
+ * Keeps the most recently used prepared statements for one database connection keyed by SQL text.
+ * Used by query classes for statements which are built dynamically or are too rare for a permanent
+ * query in initQueries().
+ *
+ * Debug mode is enabled by setting "Options/QueryDebug" to true. Then exec() logs the execution time
+ * and "EXPLAIN QUERY PLAN" output for statements which scan a full table or exceed
+ * "Options/QueryDebugSlowMs" milliseconds.
+ *
+ * Not thread safe. Use only in the thread owning the database connection.
+ */
+class StatementCache
+{
+public:
+  explicit StatementCache(atools::sql::SqlDatabase *sqlDb, int maxStatementsParam = 32);
+  ~StatementCache();
+
+  StatementCache(const StatementCache& other) = delete;
+  StatementCache& operator=(const StatementCache& other) = delete;
+
+  /* Get a prepared statement for sql. Statement is owned by the cache and stays valid until clear()
+   * is called or until it is dropped after maxStatements other statements were used.
+   * Call finish() when done. */
+  atools::sql::SqlQuery *query(const QString& sql);
+
+  /* Execute statement returned by query() and log time and query plan if debugging is enabled */
+  void exec(atools::sql::SqlQuery *query);
+
+  /* Delete all statements. Has to be called before the database is closed. */
+  void clear();
+
+private:
+  struct Statement
+  {
+    QString sql;
+    atools::sql::SqlQuery *query;
+  };
+
+  void logQueryPlan(const QString& sql, qint64 elapsedMs);
+
+  atools::sql::SqlDatabase *db;
+  int maxStatements;
+
+  /* Least recently used first */
+  QVector<Statement> statements;
+
+  /* Statements already checked for full table scans */
+  QSet<QString> explained;
+
+  bool debug = false;
+  int slowMs = 20;
+};
+
+#endif // LNM_STATEMENTCACHE_H
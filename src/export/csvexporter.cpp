@@ -75,36 +75,32 @@ int CsvExporter::selectionAsCsv(QTableView *view, bool header, bool rows, QStrin
     {
       // Copy full selected rows ==========================================
       QTextStream stream(&result, QIODevice::WriteOnly);
-      QHeaderView *headerView = view->horizontalHeader();
+      const QVector<int> columns = exportColumns(view);
+      bool addFields = !additionalHeader.isEmpty() && additionalFields;
+
       if(header)
-        stream << buildHeader(view, exporter, additionalHeader, additionalFields) << endl;
+        stream << buildHeader(view, columns, exporter, additionalHeader, additionalFields) << endl;
 
-      for(QItemSelectionRange rng : selection->selection())
+      QVariantList vars;
+      vars.reserve(columns.size());
+      for(const QItemSelectionRange& rng : selection->selection())
       {
         // Add data
         for(int row = rng.top(); row <= rng.bottom(); ++row)
         {
-          QVariantList vars;
-          for(int viewCol = 0; viewCol < model->columnCount(); viewCol++)
+          vars.clear();
+          for(int logicalCol : columns)
           {
-            // Convert view position to model position - needed to keep order
-            int logicalCol = headerView->logicalIndex(viewCol);
-
-            if(logicalCol == -1)
-              continue;
-
-            if(!view->isColumnHidden(logicalCol) &&
-               view->columnWidth(logicalCol) > view->horizontalHeader()->minimumSectionSize())
-            {
-              if(dataCallback)
-                vars.append(dataCallback(row, logicalCol));
-              else
-                vars.append(model->data(model->index(row, logicalCol)));
-            }
+            if(dataCallback)
+              vars.append(dataCallback(row, logicalCol));
+            else
+              vars.append(model->data(model->index(row, logicalCol)));
           }
 
-          stream << exporter.getResultSetRow(vars) +
-          (additionalHeader.isEmpty() || !additionalFields ? QString() : ";" + additionalFields(row).join(";")) << endl;
+          stream << exporter.getResultSetRow(vars);
+          if(addFields)
+            stream << ';' << additionalFields(row).join(';');
+          stream << endl;
 
           exported++;
         }
@@ -142,28 +138,24 @@ int CsvExporter::tableAsCsv(QTableView *view, bool header, QString& result,
 
   // Copy full rows
   QTextStream stream(&result, QIODevice::WriteOnly);
-  QHeaderView *headerView = view->horizontalHeader();
+  const QVector<int> columns = exportColumns(view);
+  bool addFields = !additionalHeader.isEmpty() && additionalFields;
+
   if(header)
-    stream << buildHeader(view, exporter, additionalHeader, additionalFields) << endl;
+    stream << buildHeader(view, columns, exporter, additionalHeader, additionalFields) << endl;
 
+  QVariantList vars;
+  vars.reserve(columns.size());
   for(int row = 0; row < model->rowCount(); row++)
   {
-    QVariantList vars;
-    for(int viewCol = 0; viewCol < model->columnCount(); viewCol++)
-    {
-      // Convert view position to model position - needed to keep order
-      int logicalCol = headerView->logicalIndex(viewCol);
-
-      if(logicalCol == -1)
-        continue;
+    vars.clear();
+    for(int logicalCol : columns)
+      vars.append(model->data(model->index(row, logicalCol)));
 
-      if(!view->isColumnHidden(logicalCol) &&
-         view->columnWidth(logicalCol) > view->horizontalHeader()->minimumSectionSize())
-        vars.append(model->data(model->index(row, logicalCol)));
-    }
-
-    stream << exporter.getResultSetRow(vars) +
-    (additionalHeader.isEmpty() || !additionalFields ? QString() : ";" + additionalFields(row).join(";")) << endl;
+    stream << exporter.getResultSetRow(vars);
+    if(addFields)
+      stream << ';' << additionalFields(row).join(';');
+    stream << endl;
 
     exported++;
   }
@@ -171,24 +163,34 @@ int CsvExporter::tableAsCsv(QTableView *view, bool header, QString& result,
   return exported;
 }
 
-QString CsvExporter::buildHeader(QTableView *view, atools::sql::SqlExport& exporter,
-                                 const QStringList& additionalHeader,
-                                 std::function<QStringList(int index)> additionalFields)
+QVector<int> CsvExporter::exportColumns(QTableView *view)
 {
-  QAbstractItemModel *model = view->model();
-  QStringList headers;
-  for(int viewCol = 0; viewCol < model->columnCount(); viewCol++)
+  QVector<int> columns;
+  QHeaderView *headerView = view->horizontalHeader();
+  int minSize = headerView->minimumSectionSize();
+
+  for(int viewCol = 0; viewCol < view->model()->columnCount(); viewCol++)
   {
     // Convert view position to model position - needed to keep order
-    int logicalCol = view->horizontalHeader()->logicalIndex(viewCol);
+    int logicalCol = headerView->logicalIndex(viewCol);
 
     if(logicalCol == -1)
       continue;
 
-    if(!view->isColumnHidden(logicalCol) &&
-       view->columnWidth(logicalCol) > view->horizontalHeader()->minimumSectionSize())
-      headers.append(model->headerData(logicalCol, Qt::Horizontal).toString().replace("-\n", "").replace("\n", " "));
+    if(!view->isColumnHidden(logicalCol) && view->columnWidth(logicalCol) > minSize)
+      columns.append(logicalCol);
   }
+  return columns;
+}
+
+QString CsvExporter::buildHeader(QTableView *view, const QVector<int>& columns, atools::sql::SqlExport& exporter,
+                                 const QStringList& additionalHeader,
+                                 std::function<QStringList(int index)> additionalFields)
+{
+  QAbstractItemModel *model = view->model();
+  QStringList headers;
+  for(int logicalCol : columns)
+    headers.append(model->headerData(logicalCol, Qt::Horizontal).toString().replace("-\n", "").replace("\n", " "));
 
   return exporter.getResultSetHeader(headers) +
          (additionalHeader.isEmpty() || !additionalFields ? QString() : ";" + additionalHeader.join(";"));
@@ -21,6 +21,7 @@
 #include "export/exporter.h"
 
 #include <QObject>
+#include <QVector>
 
 class SqlController;
 class QWidget;
@@ -62,9 +63,12 @@ public:
                         std::function<QStringList(int)> additionalFields = nullptr);
 
 private:
-  static QString buildHeader(QTableView *view, atools::sql::SqlExport& exporter,
+  static QString buildHeader(QTableView *view, const QVector<int>& columns, atools::sql::SqlExport& exporter,
                              const QStringList& additionalHeader, std::function<QStringList(int)> additionalFields);
 
+  /* Logical indexes of all visible columns in view order. Evaluated once per export instead of once per row. */
+  static QVector<int> exportColumns(QTableView *view);
+
   /* Get file from save dialog */
   QString saveCsvFileDialog();
 
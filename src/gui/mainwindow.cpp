@@ -25,9 +25,15 @@
 #include "common/elevationprovider.h"
 #include "common/filecheck.h"
 #include "common/mapcolors.h"
+#include "common/memoryregistry.h"
+#include "common/microbenchmark.h"
 #include "common/settingsmigrate.h"
+#include "common/stallmonitor.h"
 #include "common/unit.h"
+#include "common/vehicleicons.h"
+#include "common/waitloop.h"
 #include "connect/connectclient.h"
+#include "connect/sessionrecorder.h"
 #include "db/databasemanager.h"
 #include "exception.h"
 #include "fs/gpx/gpxio.h"
@@ -42,6 +48,7 @@
 #include "gui/messagesettings.h"
 #include "gui/statusbareventfilter.h"
 #include "gui/stylehandler.h"
+#include "gui/textdialog.h"
 #include "gui/tabwidgethandler.h"
 #include "gui/timedialog.h"
 #include "gui/tools.h"
@@ -54,9 +61,13 @@
 #include "mapgui/imageexportdialog.h"
 #include "mapgui/mapairporthandler.h"
 #include "mapgui/mapdetailhandler.h"
+#include "mapgui/mapimagebatch.h"
 #include "mapgui/mapmarkhandler.h"
 #include "mapgui/mapthemehandler.h"
+#include "mapgui/mapimagetiler.h"
+#include "mapgui/maptiledownloader.h"
 #include "mapgui/mapwidget.h"
+#include "mappainter/paintstatistics.h"
 #include "app/navapp.h"
 #include "online/onlinedatacontroller.h"
 #include "options/optionsdialog.h"
@@ -68,6 +79,7 @@
 #include "route/routecontroller.h"
 #include "routeexport/routeexport.h"
 #include "routeexport/simbriefhandler.h"
+#include "routestring/routestringbatch.h"
 #include "routestring/routestringdialog.h"
 #include "routestring/routestringwriter.h"
 #include "search/airportsearch.h"
@@ -88,6 +100,7 @@
 #include "weather/weatherreporter.h"
 #include "weather/windreporter.h"
 #include "web/webcontroller.h"
+#include "web/webmapcontroller.h"
 #include "common/updatehandler.h"
 
 #include <marble/MarbleAboutDialog.h>
@@ -103,8 +116,10 @@
 #include <QMimeData>
 #include <QClipboard>
 #include <QProgressDialog>
-#include <QThread>
+#include <QElapsedTimer>
 #include <QStringBuilder>
+#include <QDir>
+#include <QTextStream>
 
 #include "ui_mainwindow.h"
 
@@ -324,6 +339,7 @@ MainWindow::MainWindow()
 
     // Init a few late objects since these depend on the map widget instance
     NavApp::initQueries();
+    NavApp::logStartupTime("Map widget created");
 
     // Create elevation profile widget and replace dummy widget in window
     qDebug() << Q_FUNC_INFO << "Creating ProfileWidget";
@@ -420,7 +436,22 @@ MainWindow::MainWindow()
       debugDumpContainerSizesTimer.start();
     }
 
+    // Drop caches if estimated or resident memory is above budget
+    memoryBudgetTimer.setInterval(30000);
+    connect(&memoryBudgetTimer, &QTimer::timeout, this, &MemoryRegistry::checkBudget);
+    memoryBudgetTimer.start();
+
+    // Log and count GUI thread stalls if enabled with "[Options] StallMonitorMs=500" in ini file
+    StallMonitor::init();
+    if(StallMonitor::isEnabled())
+    {
+      stallMonitorTimer.setInterval(StallMonitor::getHeartbeatIntervalMs());
+      connect(&stallMonitorTimer, &QTimer::timeout, this, &StallMonitor::heartbeat);
+      stallMonitorTimer.start();
+    }
+
     qDebug() << Q_FUNC_INFO << "Constructor done";
+    NavApp::logStartupTime("Main window created");
   }
   // Exit application if something goes wrong
   catch(atools::Exception& e)
@@ -604,7 +635,7 @@ void MainWindow::debugActionTriggered8()
 
 void MainWindow::updateMap() const
 {
-  mapWidget->update();
+  mapWidget->updateFull();
 }
 
 void MainWindow::updateClock() const
@@ -933,33 +964,36 @@ void MainWindow::connectAllSlots()
 {
   // Options dialog ===================================================================
   // Notify others of options change
+  // Domain specific signals are only sent if the respective options changed and before the general optionsChanged()
   // The units need to be called before all others
-  connect(optionsDialog, &OptionsDialog::optionsChanged, &Unit::optionsChanged);
+  connect(optionsDialog, &OptionsDialog::optionsChangedUnits, &Unit::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, &NavApp::optionsChanged);
 
   // Need to clean cache to regenerate some text if units have changed
   connect(optionsDialog, &OptionsDialog::optionsChanged, this, &MainWindow::clearProcedureCache);
 
   // Reset weather context first
-  connect(optionsDialog, &OptionsDialog::optionsChanged, weatherContextHandler, &WeatherContextHandler::clearWeatherContext);
+  connect(optionsDialog, &OptionsDialog::optionsChangedWeather, weatherContextHandler, &WeatherContextHandler::clearWeatherContext);
+  connect(optionsDialog, &OptionsDialog::optionsChangedWeather, weatherReporter, &WeatherReporter::optionsChanged);
+  connect(optionsDialog, &OptionsDialog::optionsChangedWeather, windReporter, &WindReporter::optionsChanged);
+
+  connect(optionsDialog, &OptionsDialog::optionsChangedElevation, NavApp::getElevationProvider(), &ElevationProvider::optionsChanged);
 
-  connect(optionsDialog, &OptionsDialog::optionsChanged, NavApp::getAirspaceController(), &AirspaceController::optionsChanged);
+  // Reload online center boundaries before online data
+  connect(optionsDialog, &OptionsDialog::optionsChangedOnline, NavApp::getAirspaceController(), &AirspaceController::optionsChanged);
+  connect(optionsDialog, &OptionsDialog::optionsChangedOnline, NavApp::getOnlinedataController(), &OnlinedataController::optionsChanged);
 
   connect(optionsDialog, &OptionsDialog::optionsChanged, this, &MainWindow::updateMapObjectsShown);
   connect(optionsDialog, &OptionsDialog::optionsChanged, this, &MainWindow::updateActionStates);
   connect(optionsDialog, &OptionsDialog::optionsChanged, this, &MainWindow::distanceChanged);
 
   connect(optionsDialog, &OptionsDialog::optionsChanged, NavApp::getMapAirportHandler(), &MapAirportHandler::optionsChanged);
-  connect(optionsDialog, &OptionsDialog::optionsChanged, weatherReporter, &WeatherReporter::optionsChanged);
-  connect(optionsDialog, &OptionsDialog::optionsChanged, windReporter, &WindReporter::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, searchController, &SearchController::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, routeController, &RouteController::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, infoController, &InfoController::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, mapWidget, &MapPaintWidget::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, profileWidget, &ProfileWidget::optionsChanged);
-  connect(optionsDialog, &OptionsDialog::optionsChanged, NavApp::getOnlinedataController(), &OnlinedataController::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, NavApp::getLogdataController(), &LogdataController::optionsChanged);
-  connect(optionsDialog, &OptionsDialog::optionsChanged, NavApp::getElevationProvider(), &ElevationProvider::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, NavApp::getAircraftPerfController(), &AircraftPerfController::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, NavApp::getTrackController(), &TrackController::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, this, &MainWindow::saveStateNow);
@@ -1035,6 +1069,7 @@ void MainWindow::connectAllSlots()
   connect(routeController, &RouteController::showPos, mapWidget, &MapPaintWidget::showPos);
   connect(routeController, &RouteController::changeMark, mapWidget, &MapWidget::changeSearchMark);
   connect(routeController, &RouteController::routeChanged, mapWidget, &MapPaintWidget::routeChanged);
+  connect(routeController, &RouteController::routeChanged, mapWidget, &MapWidget::clearTooltipCache);
   connect(routeController, &RouteController::routeAltitudeChanged, mapWidget, &MapPaintWidget::routeAltitudeChanged);
   connect(routeController, &RouteController::preRouteCalc, profileWidget, &ProfileWidget::preRouteCalc);
   connect(routeController, &RouteController::showInformation, infoController, &InfoController::showInformation);
@@ -1050,6 +1085,7 @@ void MainWindow::connectAllSlots()
   connect(routeController, &RouteController::routeChanged, profileWidget, &ProfileWidget::routeChanged);
   connect(routeController, &RouteController::routeAltitudeChanged, profileWidget, &ProfileWidget::routeAltitudeChanged);
   connect(routeController, &RouteController::routeChanged, this, &MainWindow::updateActionStates);
+  connect(routeController, &RouteController::routeChanged, this, &MainWindow::routeProcedureWarmup);
   connect(routeController, &RouteController::routeInsert, this, &MainWindow::routeInsert);
   connect(routeController, &RouteController::addAirportMsa, mapWidget, &MapWidget::addMsaMark);
 
@@ -1189,9 +1225,7 @@ void MainWindow::connectAllSlots()
   connect(onlinedataController, &OnlinedataController::onlineClientAndAtcUpdated, centerSearch, &OnlineCenterSearch::refreshData);
   connect(onlinedataController, &OnlinedataController::onlineServersUpdated, serverSearch, &OnlineServerSearch::refreshData);
 
-  // Clear cache and update map widget
-  connect(onlinedataController, &OnlinedataController::onlineClientAndAtcUpdated,
-          NavApp::getAirspaceController(), &AirspaceController::onlineClientAndAtcUpdated);
+  // Update map widget - online airspace caches are dropped lazily on next access
   connect(onlinedataController, &OnlinedataController::onlineClientAndAtcUpdated, mapWidget, &MapPaintWidget::onlineClientAndAtcUpdated);
   connect(onlinedataController, &OnlinedataController::onlineNetworkChanged, mapWidget, &MapPaintWidget::onlineNetworkChanged);
 
@@ -1219,6 +1253,8 @@ void MainWindow::connectAllSlots()
   connect(ui->actionResetTabs, &QAction::triggered, this, &MainWindow::resetTabLayout);
   connect(ui->actionResetAllSettings, &QAction::triggered, this, &MainWindow::resetAllSettings);
   connect(ui->actionCreateACrashReport, &QAction::triggered, this, &MainWindow::createIssueReport);
+  connect(ui->actionShowPaintStatistics, &QAction::triggered, this, &MainWindow::showPaintStatistics);
+  connect(ui->actionShowMemoryUsage, &QAction::triggered, this, &MainWindow::showMemoryUsage);
 
   connect(infoController, &InfoController::showPos, mapWidget, &MapPaintWidget::showPos);
   connect(infoController, &InfoController::showRect, mapWidget, &MapPaintWidget::showRect);
@@ -1311,6 +1347,8 @@ void MainWindow::connectAllSlots()
   connect(ui->actionRouteReverse, &QAction::triggered, routeController, &RouteController::reverseRoute);
   connect(ui->actionRouteCopyString, &QAction::triggered, routeController, &RouteController::routeStringToClipboard);
   connect(ui->actionRouteAdjustAltitude, &QAction::triggered, routeController, &RouteController::adjustFlightplanAltitude);
+  connect(ui->actionRouteCompareCruiseAltitudes, &QAction::triggered, routeController,
+          &RouteController::compareCruiseAltitudes);
 
   // Help menu ========================================================================
   connect(ui->actionHelpUserManualContents, &QAction::triggered, this, [this](bool)->void {
@@ -1422,6 +1460,7 @@ void MainWindow::connectAllSlots()
   connect(ui->actionMapHideAllHoldings, &QAction::triggered, mapMarkHandler, &MapMarkHandler::clearHoldings);
   connect(ui->actionMapHideAllPatterns, &QAction::triggered, mapMarkHandler, &MapMarkHandler::clearPatterns);
   connect(ui->actionMapHideAllMsa, &QAction::triggered, mapMarkHandler, &MapMarkHandler::clearMsa);
+  connect(ui->actionMapDownloadRouteTiles, &QAction::triggered, this, &MainWindow::mapDownloadRouteTiles);
 
   // Logbook view options ============================================
   connect(ui->actionSearchLogdataShowDirect, &QAction::toggled, logdataController, &LogdataController::displayOptionsChanged);
@@ -1599,6 +1638,10 @@ void MainWindow::connectAllSlots()
 
   // Map widget needs to clear track first
   connect(connectClient, &ConnectClient::connectedToSimulator, mapWidget, &MapPaintWidget::connectedToSimulator);
+
+  // Render AI icons in background and redraw map once icons are available
+  connect(connectClient, &ConnectClient::connectedToSimulator, NavApp::getVehicleIcons(), &VehicleIcons::prefetchIcons);
+  connect(NavApp::getVehicleIcons(), &VehicleIcons::iconsLoaded, mapWidget, QOverload<>::of(&QWidget::update));
   connect(connectClient, &ConnectClient::disconnectedFromSimulator, mapWidget, &MapPaintWidget::disconnectedFromSimulator);
 
   connect(connectClient, &ConnectClient::connectedToSimulator, this, &MainWindow::updateActionStates);
@@ -2187,6 +2230,7 @@ void MainWindow::routeFromStringCurrent()
     connect(routeStringDialog, &RouteStringDialog::routeFromFlightplan, this, &MainWindow::routeFromFlightplan);
     connect(routeController, &RouteController::routeChanged, routeStringDialog, &RouteStringDialog::updateButtonState);
     connect(NavApp::getStyleHandler(), &StyleHandler::styleChanged, routeStringDialog, &RouteStringDialog::styleChanged);
+    connect(NavApp::getTrackController(), &TrackController::postTrackLoad, routeStringDialog, &RouteStringDialog::clearCache);
   }
 
   routeStringDialog->show();
@@ -2704,6 +2748,44 @@ bool MainWindow::layoutOpenInternal(const QString& layoutFile)
   return false;
 }
 
+void MainWindow::waitForMapDownload(MapPaintWidget *paintWidget)
+{
+  // Create a progress dialog
+  int numSeconds = 60;
+  QString label = tr("Waiting up to %1 seconds for map download ...\n");
+  QProgressDialog progress(label.arg(numSeconds), tr("&Ignore Downloads and Continue"), 0, numSeconds, this);
+  progress.setWindowModality(Qt::WindowModal);
+  progress.setMinimumDuration(0);
+  progress.show();
+
+  // Get download job information and update progress text
+  int queuedJobs = -1, activeJobs = -1;
+  QMetaObject::Connection connection =
+    connect(paintWidget->model()->downloadManager(), &HttpDownloadManager::progressChanged, this,
+            [&progress, &queuedJobs, &activeJobs, &numSeconds, &label](int active, int queued) -> void
+  {
+    progress.setLabelText(label.arg(numSeconds) % tr("%1 downloads active and %2 downloads queued.").
+                          arg(active).arg(queued));
+    queuedJobs = queued;
+    activeJobs = active;
+  });
+
+  // Run event loop until seconds are over or all downloads are done
+  QElapsedTimer timer;
+  timer.start();
+  waitloop::run(progress, [&progress, &timer, &queuedJobs, &activeJobs, numSeconds, paintWidget](bool canceled) -> bool {
+    int seconds = static_cast<int>(timer.elapsed() / 1000);
+    progress.setValue(std::min(seconds, numSeconds));
+
+    return canceled || seconds >= numSeconds || paintWidget->renderStatus() == Marble::Complete ||
+           (queuedJobs == 0 && activeJobs == 0);
+  }, 250);
+  progress.setValue(numSeconds);
+
+  // Paint widget might be used further - lambda refers to local variables
+  disconnect(connection);
+}
+
 bool MainWindow::createMapImage(QPixmap& pixmap, const QString& dialogTitle, const QString& optionPrefx, QString *json)
 {
   ImageExportDialog exportDialog(this, dialogTitle, optionPrefx, mapWidget->width(), mapWidget->height());
@@ -2720,6 +2802,45 @@ bool MainWindow::createMapImage(QPixmap& pixmap, const QString& dialogTitle, con
       if(json != nullptr)
         *json = mapWidget->createAvitabJson();
     }
+    else if(MapImageTiler::isTiledRenderingNeeded(*mapWidget, exportDialog.getSize()))
+    {
+      // Large image - render in tiles to avoid a huge hidden widget
+      MapImageTiler tiler(this, *mapWidget, exportDialog.getSize());
+
+      // Prepare drawing by painting all tiles without navaids to start downloads
+      QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+      tiler.prepare();
+      QGuiApplication::restoreOverrideCursor();
+
+      waitForMapDownload(tiler.getPaintWidget());
+
+      QProgressDialog progress(tr("Rendering map image ..."), tr("&Cancel"), 0, 0, this);
+      progress.setWindowModality(Qt::WindowModal);
+      progress.setMinimumDuration(0);
+
+      QImage image = tiler.render([&progress](int tile, int numTiles) -> bool {
+        progress.setMaximum(numTiles);
+        progress.setValue(tile);
+        QApplication::processEvents();
+        return !progress.wasCanceled();
+      });
+      progress.setValue(progress.maximum());
+
+      if(image.isNull())
+      {
+        if(!progress.wasCanceled())
+          atools::gui::Dialog::warning(this, tr("Cannot create image of size %L1 x %L2 pixel.\n"
+                                                "Not enough memory.").
+                                       arg(exportDialog.getSize().width()).arg(exportDialog.getSize().height()));
+        return false;
+      }
+
+      pixmap = QPixmap::fromImage(std::move(image));
+
+      if(json != nullptr)
+        // Create Avitab reference for the whole image
+        *json = tiler.createAvitabJson();
+    }
     else
     {
       // Create a map widget clone with the desired resolution
@@ -2741,39 +2862,7 @@ bool MainWindow::createMapImage(QPixmap& pixmap, const QString& dialogTitle, con
       paintWidget.prepareDraw(exportDialog.getSize().width(), exportDialog.getSize().height());
       QGuiApplication::restoreOverrideCursor();
 
-      // Create a progress dialog
-      int numSeconds = 60;
-      QString label = tr("Waiting up to %1 seconds for map download ...\n");
-      QProgressDialog progress(label.arg(numSeconds), tr("&Ignore Downloads and Continue"), 0, numSeconds, this);
-      progress.setWindowModality(Qt::WindowModal);
-      progress.setMinimumDuration(0);
-      progress.show();
-      QApplication::processEvents();
-
-      // Get download job information and update progress text
-      int queuedJobs = -1, activeJobs = -1;
-      connect(paintWidget.model()->downloadManager(), &HttpDownloadManager::progressChanged, this,
-              [&progress, &queuedJobs, &activeJobs, &numSeconds, &label](int active, int queued) -> void
-      {
-        progress.setLabelText(label.arg(numSeconds) % tr("%1 downloads active and %2 downloads queued.").
-                              arg(active).arg(queued));
-        queuedJobs = queued;
-        activeJobs = active;
-      });
-
-      // Loop until seconds are over
-      for(int i = 0; i < numSeconds; i++)
-      {
-        progress.setValue(i);
-        QApplication::processEvents();
-
-        if(progress.wasCanceled() || paintWidget.renderStatus() == Marble::Complete ||
-           (queuedJobs == 0 && activeJobs == 0))
-          break;
-
-        QThread::sleep(1);
-      }
-      progress.setValue(numSeconds);
+      waitForMapDownload(&paintWidget);
 
       // Now draw the actual image including navaids
       QGuiApplication::setOverrideCursor(Qt::WaitCursor);
@@ -2790,6 +2879,11 @@ bool MainWindow::createMapImage(QPixmap& pixmap, const QString& dialogTitle, con
   return false;
 }
 
+void MainWindow::mapDownloadRouteTiles()
+{
+  MapTileDownloader(this, mapWidget).downloadRouteCorridor(NavApp::getRouteConst());
+}
+
 void MainWindow::mapSaveImage()
 {
   QPixmap pixmap;
@@ -3216,6 +3310,7 @@ void MainWindow::setDetailLabelText(const QString& text)
 void MainWindow::mainWindowShown()
 {
   qDebug() << Q_FUNC_INFO << "enter";
+  NavApp::logStartupTime("Main window shown");
 
   // This shows a warning dialog if failing - start it later within the event loop to avoid a freeze
   QTimer::singleShot(0, this, &NavApp::showElevationProviderErrors);
@@ -3303,12 +3398,53 @@ void MainWindow::mainWindowShown()
              << "geo" << screen->geometry() << "available geo" << screen->availableGeometry()
              << "available virtual geo" << screen->availableVirtualGeometry();
 
-  // Check for commands from other instances in shared memory segment
-  NavApp::getDataExchange()->startTimer();
+  // Process commands from other instances received on the local socket
+  NavApp::getDataExchange()->startListening();
 
   qDebug() << Q_FUNC_INFO << "leave";
 }
 
+void MainWindow::serverStartup()
+{
+  qInfo() << Q_FUNC_INFO << "enter";
+  NavApp::logStartupTime("Server mode");
+
+  // Allows rendering of the offscreen web map which is otherwise blanked before the main window is shown
+  NavApp::setMainWindowVisible();
+
+  // Load deferred subsystems now since the main map is never painted
+  NavApp::startupFinished();
+
+  NavApp::logDatabaseMeta();
+
+  // If enabled connect to simulator without showing dialog
+  NavApp::getConnectClient()->tryConnectOnStartup();
+
+  // Start weather downloads and regular updates
+  weatherUpdateTimeout();
+  weatherUpdateTimer.setInterval(Settings::instance().getAndStoreValue(lnm::OPTIONS_WEATHER_UPDATE_RATE_SIM, 15000).toInt());
+  weatherUpdateTimer.start();
+
+  // Start regular download of online network files
+  NavApp::getOnlinedataController()->startProcessing();
+
+  // Always start webserver independent of the menu state
+  NavApp::getWebController()->startServer();
+  updateMapKeys(); // Update API keys and theme dir in web map widget
+  webserverStatusChanged(NavApp::getWebController()->isRunning());
+
+  if(ui->actionRouteDownloadTracks->isChecked())
+    QTimer::singleShot(1000, NavApp::getTrackController(), &TrackController::startDownloadStartup);
+
+  // Record or replay simulator data from command line options "session-record" and "session-replay" if given
+  sessionStartup();
+
+  // Process commands from other instances received on the local socket
+  NavApp::getDataExchange()->startListening();
+
+  qInfo() << Q_FUNC_INFO << "leave" << "web server running" << NavApp::getWebController()->isRunning();
+}
+
 void MainWindow::loadLayoutDelayed(const QString& filename)
 {
   try
@@ -3470,6 +3606,18 @@ void MainWindow::mainWindowShownDelayed()
   // Checks if version of database is smaller than application database version and shows a warning dialog if it is
   databaseManager->checkDatabaseVersion();
 
+  // Convert route descriptions from command line option "route-batch" if given
+  routeStringBatchStartup();
+
+  // Render map images from command line option "image-batch" if given
+  imageBatchStartup();
+
+  // Run benchmarks from command line option "benchmark" if given
+  benchmarkStartup();
+
+  // Record or replay simulator data from command line options "session-record" and "session-replay" if given
+  sessionStartup();
+
   // Check for updates once main window is visible
   NavApp::checkForUpdates(OptionData::instance().getUpdateChannels(), false /* manual */, true /* startup */, false /* forceDebug */);
 
@@ -3489,6 +3637,209 @@ void MainWindow::mainWindowShownDelayed()
   qDebug() << Q_FUNC_INFO << "leave";
 }
 
+void MainWindow::routeStringBatchStartup()
+{
+  QString batchFile = NavApp::getStartupOptionStr(lnm::STARTUP_ROUTE_BATCH);
+  if(batchFile.isEmpty())
+    return;
+
+  QString outputDir = NavApp::getStartupOptionStr(lnm::STARTUP_ROUTE_BATCH_OUTPUT);
+  bool benchmark = !NavApp::getStartupOptionStr(lnm::STARTUP_ROUTE_BATCH_BENCHMARK).isEmpty();
+  bool quit = !NavApp::getStartupOptionStr(lnm::STARTUP_ROUTE_BATCH_QUIT).isEmpty();
+  qInfo() << Q_FUNC_INFO << batchFile << outputDir << "benchmark" << benchmark << "quit" << quit;
+
+  try
+  {
+    QStringList routeStrings = RouteStringBatch::readRouteStrings(batchFile);
+
+    RouteStringBatch batch(routeController->getFlightplanEntryBuilder());
+    batch.run(routeStrings, outputDir, RouteStringDialog::getOptionsFromSettings());
+    QString report = batch.getReport(benchmark);
+    qInfo().noquote().nospace() << Q_FUNC_INFO << endl << report;
+
+    if(!outputDir.isEmpty())
+    {
+      // Save report next to the flight plans
+      QFile file(QDir(outputDir).absoluteFilePath("route_batch_report.txt"));
+      if(file.open(QIODevice::WriteOnly | QIODevice::Text))
+      {
+        QTextStream stream(&file);
+        stream.setCodec("UTF-8");
+        stream << report;
+        file.close();
+      }
+      else
+        qWarning() << Q_FUNC_INFO << "Cannot open" << file.fileName() << file.errorString();
+    }
+  }
+  catch(atools::Exception& e)
+  {
+    if(quit)
+      qWarning() << Q_FUNC_INFO << e.what();
+    else
+      atools::gui::ErrorHandler(this).handleException(e);
+  }
+
+
+  if(quit)
+    QTimer::singleShot(0, this, &MainWindow::close);
+}
+
+void MainWindow::imageBatchStartup()
+{
+  QString batchFile = NavApp::getStartupOptionStr(lnm::STARTUP_IMAGE_BATCH);
+  if(batchFile.isEmpty())
+    return;
+
+  QString outputDir = NavApp::getStartupOptionStr(lnm::STARTUP_IMAGE_BATCH_OUTPUT);
+  QString sizeStr = NavApp::getStartupOptionStr(lnm::STARTUP_IMAGE_BATCH_SIZE);
+  bool quit = !NavApp::getStartupOptionStr(lnm::STARTUP_IMAGE_BATCH_QUIT).isEmpty();
+  bool headless = !NavApp::getStartupOptionStr(lnm::STARTUP_HEADLESS).isEmpty();
+  qInfo() << Q_FUNC_INFO << batchFile << outputDir << sizeStr << "quit" << quit << "headless" << headless;
+
+  QSize size = MapImageBatch::parseSize(sizeStr.isEmpty() ? "1920x1080" : sizeStr);
+  if(!size.isValid())
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid image size" << sizeStr << "using default";
+    size = QSize(1920, 1080);
+  }
+
+  try
+  {
+    QStringList entries = MapImageBatch::readEntries(batchFile);
+
+    MapImageBatch batch(this, routeController);
+    batch.run(entries, outputDir, size);
+    QString report = batch.getReport();
+    qInfo().noquote().nospace() << Q_FUNC_INFO << endl << report;
+
+    // Save report next to the images
+    QFile file(QDir(outputDir).absoluteFilePath("image_batch_report.txt"));
+    if(file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+      QTextStream stream(&file);
+      stream.setCodec("UTF-8");
+      stream << report;
+      file.close();
+    }
+    else
+      qWarning() << Q_FUNC_INFO << "Cannot open" << file.fileName() << file.errorString();
+  }
+  catch(atools::Exception& e)
+  {
+    // No dialogs in headless mode
+    if(quit || headless)
+      qWarning() << Q_FUNC_INFO << e.what();
+    else
+      atools::gui::ErrorHandler(this).handleException(e);
+  }
+
+  if(quit)
+    QTimer::singleShot(0, this, &MainWindow::close);
+}
+
+void MainWindow::benchmarkStartup()
+{
+  QString jsonFile = NavApp::getStartupOptionStr(lnm::STARTUP_BENCHMARK);
+  if(jsonFile.isEmpty())
+    return;
+
+  QString baselineFile = NavApp::getStartupOptionStr(lnm::STARTUP_BENCHMARK_BASELINE);
+  bool quit = !NavApp::getStartupOptionStr(lnm::STARTUP_BENCHMARK_QUIT).isEmpty();
+  bool headless = !NavApp::getStartupOptionStr(lnm::STARTUP_HEADLESS).isEmpty();
+  qInfo() << Q_FUNC_INFO << jsonFile << baselineFile << "quit" << quit << "headless" << headless;
+
+  try
+  {
+    MicroBenchmark benchmark(mapWidget, routeController->getFlightplanEntryBuilder());
+    benchmark.run();
+
+    if(!baselineFile.isEmpty())
+      benchmark.compareBaseline(baselineFile);
+
+    benchmark.saveJson(jsonFile);
+    qInfo().noquote().nospace() << Q_FUNC_INFO << endl << benchmark.getReport();
+  }
+  catch(atools::Exception& e)
+  {
+    // No dialogs in headless mode
+    if(quit || headless)
+      qWarning() << Q_FUNC_INFO << e.what();
+    else
+      atools::gui::ErrorHandler(this).handleException(e);
+  }
+
+  if(quit)
+    QTimer::singleShot(0, this, &MainWindow::close);
+}
+
+void MainWindow::sessionStartup()
+{
+  QString recordFile = NavApp::getStartupOptionStr(lnm::STARTUP_SESSION_RECORD);
+  QString replayFile = NavApp::getStartupOptionStr(lnm::STARTUP_SESSION_REPLAY);
+  if(recordFile.isEmpty() && replayFile.isEmpty())
+    return;
+
+  QString speedStr = NavApp::getStartupOptionStr(lnm::STARTUP_SESSION_REPLAY_SPEED);
+  QString reportFile = NavApp::getStartupOptionStr(lnm::STARTUP_SESSION_REPLAY_REPORT);
+  bool quit = !NavApp::getStartupOptionStr(lnm::STARTUP_SESSION_REPLAY_QUIT).isEmpty();
+  bool headless = !NavApp::getStartupOptionStr(lnm::STARTUP_HEADLESS).isEmpty();
+  qInfo() << Q_FUNC_INFO << recordFile << replayFile << speedStr << reportFile << "quit" << quit << "headless" << headless;
+
+  SessionRecorder *recorder = NavApp::getConnectClient()->getSessionRecorder();
+  try
+  {
+    if(!recordFile.isEmpty())
+      recorder->startRecording(recordFile);
+
+    if(!replayFile.isEmpty())
+    {
+      bool ok = true;
+      float speed = speedStr.isEmpty() ? 1.f : speedStr.toFloat(&ok);
+      if(!ok || speed < 0.f)
+      {
+        qWarning() << Q_FUNC_INFO << "Invalid replay speed" << speedStr << "using default";
+        speed = 1.f;
+      }
+
+      connect(recorder, &SessionRecorder::replayFinished, this, [this, recorder, reportFile, quit]() -> void {
+        QString report = recorder->getReport();
+        qInfo().noquote().nospace() << Q_FUNC_INFO << endl << report;
+
+        if(!reportFile.isEmpty())
+        {
+          QFile file(reportFile);
+          if(file.open(QIODevice::WriteOnly | QIODevice::Text))
+          {
+            QTextStream stream(&file);
+            stream.setCodec("UTF-8");
+            stream << report;
+            file.close();
+          }
+          else
+            qWarning() << Q_FUNC_INFO << "Cannot open" << file.fileName() << file.errorString();
+        }
+
+        if(quit)
+          QTimer::singleShot(0, this, &MainWindow::close);
+      });
+
+      recorder->startReplay(replayFile, speed);
+    }
+  }
+  catch(atools::Exception& e)
+  {
+    // No dialogs in headless mode
+    if(quit || headless)
+      qWarning() << Q_FUNC_INFO << e.what();
+    else
+      atools::gui::ErrorHandler(this).handleException(e);
+
+    if(quit)
+      QTimer::singleShot(0, this, &MainWindow::close);
+  }
+}
+
 void MainWindow::runDirToolManual()
 {
   runDirTool(true /* manual */);
@@ -3660,6 +4011,29 @@ void MainWindow::updateHighlightActionStates()
                                               routeController->hasTableSelection());
 }
 
+void MainWindow::routeProcedureWarmup()
+{
+  const Route& route = NavApp::getRouteConst();
+  QVector<map::MapAirport> airports;
+
+  if(!route.isFlightplanEmpty())
+  {
+    if(route.getDepartureAirportLeg().isAirport())
+      airports.append(route.getDepartureAirportLeg().getAirport());
+
+    if(route.getDestinationAirportLeg().isAirport())
+      airports.append(route.getDestinationAirportLeg().getAirport());
+
+    if(route.hasAlternates())
+    {
+      for(int i = route.getAlternateLegsOffset(); i < route.getAlternateLegsOffset() + route.getNumAlternateLegs(); i++)
+        airports.append(route.value(i).getAirport());
+    }
+  }
+
+  NavApp::getProcedureQuery()->warmupCache(airports);
+}
+
 /* Enable or disable actions */
 void MainWindow::updateActionStates()
 {
@@ -3708,6 +4082,8 @@ void MainWindow::updateActionStates()
   ui->actionPrintFlightplan->setEnabled(hasFlightplan);
   ui->actionRouteCopyString->setEnabled(hasFlightplan);
   ui->actionRouteAdjustAltitude->setEnabled(hasFlightplan);
+  ui->actionRouteCompareCruiseAltitudes->setEnabled(hasFlightplan);
+  ui->actionMapDownloadRouteTiles->setEnabled(hasFlightplan);
 
   bool hasTracks = NavApp::hasTracks();
   ui->actionRouteDeleteTracks->setEnabled(hasTracks);
@@ -3785,6 +4161,29 @@ void MainWindow::resetAllSettings()
     atools::gui::HelpHandler::openHelpUrlWeb(this, lnm::helpOnlineUrl % "MENUS.html#reset-and-restart", lnm::helpLanguageOnline());
 }
 
+void MainWindow::showPaintStatistics()
+{
+  atools::util::HtmlBuilder html(true);
+  html.p().b(tr("Average time per frame for all map painters since start")).pEnd();
+  mapWidget->getPaintStatistics().html(html);
+  html.p(tr("Memory cache for decoded map tiles: %L1 MB").arg(mapWidget->volatileTileCacheLimit() / 1000L));
+
+  TextDialog dialog(this, tr("%1 - Map Painting Statistics").arg(QApplication::applicationName()));
+  dialog.setHtmlMessage(html.getHtml(), false /* print to log */);
+  dialog.exec();
+}
+
+void MainWindow::showMemoryUsage()
+{
+  atools::util::HtmlBuilder html(true);
+  MemoryRegistry::html(html);
+  StallMonitor::html(html);
+
+  TextDialog dialog(this, tr("%1 - Memory Usage").arg(QApplication::applicationName()));
+  dialog.setHtmlMessage(html.getHtml(), false /* print to log */);
+  dialog.exec();
+}
+
 void MainWindow::createIssueReport()
 {
   qDebug() << Q_FUNC_INFO;
@@ -4020,8 +4419,8 @@ void MainWindow::updateMapKeys()
       mapWidget->setKeys(mapThemeHandler->getMapThemeKeysHash());
 
     // Might be null if not started
-    if(NavApp::getMapPaintWidgetWeb() != nullptr)
-      NavApp::getMapPaintWidgetWeb()->setKeys(mapThemeHandler->getMapThemeKeysHash());
+    if(NavApp::getWebMapController() != nullptr)
+      NavApp::getWebMapController()->setKeys(mapThemeHandler->getMapThemeKeysHash());
   }
 }
 
@@ -4521,6 +4920,9 @@ void MainWindow::preDatabaseLoad()
     searchController->preDatabaseLoad();
     routeController->preDatabaseLoad();
 
+    if(routeStringDialog != nullptr)
+      routeStringDialog->clearCache();
+
     mapWidget->preDatabaseLoad();
     NavApp::getWebController()->postDatabaseLoad();
 
@@ -4697,5 +5099,8 @@ void MainWindow::debugDumpContainerSizes() const
     NavApp::getOnlinedataController()->debugDumpContainerSizes();
   if(NavApp::getConnectClient() != nullptr)
     NavApp::getConnectClient()->debugDumpContainerSizes();
+  qDebug().noquote().nospace() << Q_FUNC_INFO << " " << MemoryRegistry::report();
+  if(StallMonitor::isEnabled())
+    qDebug().noquote().nospace() << Q_FUNC_INFO << " " << StallMonitor::report();
   qDebug() << Q_FUNC_INFO << "======================================";
 }
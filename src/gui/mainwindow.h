@@ -82,6 +82,7 @@ namespace Ui {
 class MainWindow;
 }
 
+class MapPaintWidget;
 class MapWidget;
 class MapQuery;
 class InfoQuery;
@@ -184,6 +185,10 @@ public:
     databasesErased = value;
   }
 
+  /* Used instead of showing the window for command line option "server".
+   * Starts simulator connection, weather and online downloads and the web server. */
+  void serverStartup();
+
   SearchController *getSearchController() const
   {
     return searchController;
@@ -291,6 +296,18 @@ private:
   void mainWindowShown();
   void mainWindowShownDelayed();
 
+  /* Run batch conversion of route descriptions given on the command line */
+  void routeStringBatchStartup();
+
+  /* Render map images from command line option "image-batch" if given */
+  void imageBatchStartup();
+
+  /* Run benchmarks from command line option "benchmark" if given and save results */
+  void benchmarkStartup();
+
+  /* Start recording or replay of simulator data from command line options if given */
+  void sessionStartup();
+
   /* Dock window functions */
   void raiseFloatingWindows();
   void hideTitleBar();
@@ -318,6 +335,9 @@ private:
   void restoreStateMain();
   void updateActionStates();
 
+  /* Start background loading of procedures for departure, destination and alternates */
+  void routeProcedureWarmup();
+
   void updateOnlineActionStates();
 
   void runDirToolManual();
@@ -375,6 +395,12 @@ private:
 
   /* Manual issue report triggered from the menu */
   void createIssueReport();
+
+  /* Show painter timing statistics for the map */
+  void showPaintStatistics();
+
+  /* Show estimated memory usage of all registered caches */
+  void showMemoryUsage();
   void showDatabaseFiles();
   void showShowMapCache();
   void showMapInstallation();
@@ -384,9 +410,15 @@ private:
   void mapSaveImageAviTab();
   void mapCopyToClipboard();
 
+  /* Download online map tiles along the flight plan into the disk cache */
+  void mapDownloadRouteTiles();
+
   /* Opens dialog for image resolution and returns pixmap and optionally AviTab JSON */
   bool createMapImage(QPixmap& pixmap, const QString& dialogTitle, const QString& optionPrefx, QString *json = nullptr);
 
+  /* Show a progress dialog and wait up to a minute until map tiles for paintWidget are downloaded */
+  void waitForMapDownload(MapPaintWidget *paintWidget);
+
   void distanceChanged();
   void showDonationPage();
   void showFaqPage();
@@ -570,6 +602,12 @@ private:
 
   /* Call debugDumpContainerSizes() every 30 seconds */
   QTimer debugDumpContainerSizesTimer;
+
+  /* Call MemoryRegistry::checkBudget() every 30 seconds */
+  QTimer memoryBudgetTimer;
+
+  /* Call StallMonitor::heartbeat() if enabled */
+  QTimer stallMonitorTimer;
 };
 
 #endif // LITTLENAVMAP_MAINWINDOW_H
@@ -41,7 +41,7 @@ const static QVector<pid::ProgressConfId> ALLIDS({
   pid::ALT_AUTOPILOT_ALT, pid::SPEED_INDICATED, pid::SPEED_INDICATED_OTHER, pid::SPEED_GROUND, pid::SPEED_GROUND_OTHER, pid::SPEED_TRUE,
   pid::SPEED_MACH, pid::SPEED_VERTICAL, pid::SPEED_VERTICAL_OTHER, pid::DESCENT_DEVIATION, pid::DESCENT_ANGLE_SPEED,
   pid::DESCENT_VERT_ANGLE_NEXT, pid::ENV_WIND_DIR_SPEED, pid::ENV_TAT, pid::ENV_SAT, pid::ENV_ISA_DEV, pid::ENV_SEA_LEVEL_PRESS,
-  pid::ENV_DENSITY_ALTITUDE, pid::ENV_CONDITIONS, pid::ENV_VISIBILITY, pid::POS_COORDINATES});
+  pid::ENV_DENSITY_ALTITUDE, pid::ENV_CONDITIONS, pid::ENV_VISIBILITY, pid::POS_COORDINATES, pid::POS_AIRSPACES});
 
 // Default ids which are enabled without settings
 const static QVector<pid::ProgressConfId> DEFAULTIDS({
@@ -214,6 +214,8 @@ void AircraftProgressConfig::progressConfiguration()
 
   // Coordinates ==========================================================================================================
   treeDialog.addItem2(rootItem, pid::POS_COORDINATES, tr("Coordinates"), tr("Aircraft coordinates."));
+  treeDialog.addItem2(rootItem, pid::POS_AIRSPACES, tr("Airspaces"), tr("Airspaces containing the aircraft at its current altitude.\n"
+                                                                       "Online centers are not included."));
   /* *INDENT-ON* */
 
   treeDialog.restoreState(false /* restoreCheckState */, true /* restoreExpandState */);
@@ -19,11 +19,13 @@
 
 #include "airspace/airspacecontroller.h"
 #include "app/navapp.h"
+#include "connect/connectclient.h"
 #include "atools.h"
 #include "common/constants.h"
 #include "common/htmlinfobuilder.h"
 #include "common/mapcolors.h"
 #include "common/maptools.h"
+#include "common/stallmonitor.h"
 #include "gui/helphandler.h"
 #include "gui/mainwindow.h"
 #include "gui/tabwidgethandler.h"
@@ -43,6 +45,7 @@
 #include "weather/weathercontext.h"
 #include "weather/weathercontexthandler.h"
 
+#include <QScrollBar>
 #include <QUrlQuery>
 
 using atools::util::HtmlBuilder;
@@ -238,6 +241,10 @@ void InfoController::showProgressContextMenu(const QPoint& point)
 
 void InfoController::visibilityChangedAircraft(bool visible)
 {
+  // Aircraft information needs full simulator update rate - change at once
+  if(NavApp::getConnectClient() != nullptr)
+    NavApp::getConnectClient()->setRateDemand(ConnectClient::RATE_DEMAND_AIRCRAFT_INFO, visible);
+
   if(visible)
     currentAircraftTabChanged(tabHandlerAircraft->getCurrentTabId());
 }
@@ -572,6 +579,9 @@ void InfoController::updateAirportWeather()
 
 void InfoController::routeChanged(bool, bool)
 {
+  LNM_STALL_SCOPE;
+
+  routeRevision++;
   updateAirportInternal(false /* new */, true /* bearing change*/, false /* scroll to top */, false /* force weather update */);
 }
 
@@ -586,8 +596,7 @@ void InfoController::updateProgress()
     html.clear();
     html.setIdBits(aircraftProgressConfig->getEnabledBits());
     infoBuilder->aircraftProgressText(lastSimData.getUserAircraftConst(), html, NavApp::getRouteConst());
-    atools::gui::util::updateTextEdit(ui->textBrowserAircraftProgressInfo, html.getHtml(),
-                                      false /* scroll to top*/, true /* keep selection */);
+    updateAircraftTextEdit(ui->textBrowserAircraftProgressInfo, html.getHtml(), lastProgressHtmlHash);
   }
 }
 
@@ -607,32 +616,73 @@ void InfoController::updateAirportInternal(bool newAirport, bool bearingChange,
 
     if(newAirport || weatherChanged || bearingChange || forceWeatherUpdate)
     {
-      HtmlBuilder html(true);
+      if(weatherChanged || forceWeatherUpdate)
+        weatherRevision++;
+      if(bearingChange)
+        bearingRevision++;
+
       map::MapAirport airport;
       airportQuery->getAirportById(airport, currentSearchResult.airports.constFirst().id);
 
       // qDebug() << Q_FUNC_INFO << "Updating html" << airport.ident << airport.id;
 
-      infoBuilder->airportText(airport, currentWeatherContext, html, &NavApp::getRouteConst());
+      // Sunrise and sunset depend on simulator or real date - use minutes as bucket
+      QDateTime datetime = NavApp::isConnectedAndAircraft() ? NavApp::getUserAircraft().getZuluTime() : QDateTime::currentDateTimeUtc();
+      const QVector<qint64> airportInputs({weatherRevision, routeRevision, bearingRevision, datetime.toSecsSinceEpoch() / 60});
 
       Ui::MainWindow *ui = NavApp::getMainUi();
       // Leave position for weather or bearing updates
-      atools::gui::util::updateTextEdit(ui->textBrowserAirportInfo, html.getHtml(),
-                                        scrollToTop, !scrollToTop /* keep selection */);
+      updateAirportFragment(ic::INFO_AIRPORT_OVERVIEW, ui->textBrowserAirportInfo, airport.id,
+                            qHashRange(airportInputs.constBegin(), airportInputs.constEnd()), scrollToTop,
+                            [&](HtmlBuilder& html) {
+        infoBuilder->airportText(airport, currentWeatherContext, html, &NavApp::getRouteConst());
+      });
 
-      if(newAirport || weatherChanged || forceWeatherUpdate)
-      {
-        html.clear();
+      // Leave position for weather updates
+      updateAirportFragment(ic::INFO_AIRPORT_WEATHER, ui->textBrowserWeatherInfo, airport.id, qHash(weatherRevision), scrollToTop,
+                            [&](HtmlBuilder& html) {
         infoBuilder->weatherText(currentWeatherContext, airport, html);
-
-        // Leave position for weather updates
-        atools::gui::util::updateTextEdit(ui->textBrowserWeatherInfo, html.getHtml(),
-                                          scrollToTop, !scrollToTop /* keep selection */);
-      }
+      });
     }
   }
 }
 
+void InfoController::updateAirportFragment(ic::TabAirportInfoId section, QTextEdit *textEdit, int airportId, uint inputHash,
+                                           bool scrollToTop, const std::function<void(HtmlBuilder& html)>& buildFunc)
+{
+  const std::pair<int, uint> fragmentId(airportId, inputHash);
+  if(shownFragments.value(section, std::make_pair(-1, 0u)) == fragmentId)
+  {
+    // Text edit already shows this content
+    if(scrollToTop)
+      textEdit->verticalScrollBar()->setValue(0);
+    return;
+  }
+
+  quint64 key = static_cast<quint64>(section) << 32 | static_cast<quint32>(airportId);
+  HtmlFragment *fragment = htmlFragmentCache.object(key);
+  if(fragment == nullptr || fragment->inputHash != inputHash)
+  {
+    // Not cached or inputs changed - rebuild
+    HtmlBuilder html(true);
+    buildFunc(html);
+
+    fragment = new HtmlFragment;
+    fragment->inputHash = inputHash;
+    fragment->html = html.getHtml();
+    htmlFragmentCache.insert(key, fragment);
+  }
+
+  atools::gui::util::updateTextEdit(textEdit, fragment->html, scrollToTop, !scrollToTop /* keep selection */);
+  shownFragments.insert(section, fragmentId);
+}
+
+void InfoController::clearFragmentCache()
+{
+  htmlFragmentCache.clear();
+  shownFragments.clear();
+}
+
 void InfoController::clearInfoTextBrowsers()
 {
   Ui::MainWindow *ui = NavApp::getMainUi();
@@ -650,6 +700,9 @@ void InfoController::clearInfoTextBrowsers()
 
   ui->textBrowserClientInfo->clear();
   ui->textBrowserCenterInfo->clear();
+
+  // Force update of airport tabs on next call
+  shownFragments.clear();
 }
 
 void InfoController::showInformation(map::MapResult result)
@@ -831,21 +884,26 @@ void InfoController::showInformationInternal(map::MapResult result, bool showWin
     if(changed || forceUpdate)
     {
       // Update parts that have now weather or bearing depenedency =====================
-      html.clear();
-      infoBuilder->runwayText(airport, html);
-      atools::gui::util::updateTextEdit(ui->textBrowserRunwayInfo, html.getHtml(), scrollToTop, !scrollToTop /* keep selection */);
+      // These depend only on airport and options - fragments are reused unless cache was cleared
+      updateAirportFragment(ic::INFO_AIRPORT_RUNWAYS, ui->textBrowserRunwayInfo, airport.id, 0, scrollToTop,
+                            [&](HtmlBuilder& fragmentHtml) {
+        infoBuilder->runwayText(airport, fragmentHtml);
+      });
 
-      html.clear();
-      infoBuilder->comText(airport, html);
-      atools::gui::util::updateTextEdit(ui->textBrowserComInfo, html.getHtml(), scrollToTop, !scrollToTop /* keep selection */);
+      updateAirportFragment(ic::INFO_AIRPORT_COM, ui->textBrowserComInfo, airport.id, 0, scrollToTop,
+                            [&](HtmlBuilder& fragmentHtml) {
+        infoBuilder->comText(airport, fragmentHtml);
+      });
 
-      html.clear();
-      infoBuilder->procedureText(airport, html);
-      atools::gui::util::updateTextEdit(ui->textBrowserApproachInfo, html.getHtml(), scrollToTop, !scrollToTop /* keep selection */);
+      updateAirportFragment(ic::INFO_AIRPORT_APPROACHES, ui->textBrowserApproachInfo, airport.id, 0, scrollToTop,
+                            [&](HtmlBuilder& fragmentHtml) {
+        infoBuilder->procedureText(airport, fragmentHtml);
+      });
 
-      html.clear();
-      infoBuilder->nearestText(airport, html);
-      atools::gui::util::updateTextEdit(ui->textBrowserNearestInfo, html.getHtml(), scrollToTop, !scrollToTop /* keep selection */);
+      updateAirportFragment(ic::INFO_AIRPORT_NEAREST, ui->textBrowserNearestInfo, airport.id, 0, scrollToTop,
+                            [&](HtmlBuilder& fragmentHtml) {
+        infoBuilder->nearestText(airport, fragmentHtml);
+      });
     }
 
     foundAirport = true;
@@ -1160,6 +1218,7 @@ void InfoController::preDatabaseLoad()
   currentSearchResult = map::MapResult();
   databaseLoadStatus = true;
   clearInfoTextBrowsers();
+  clearFragmentCache();
 }
 
 void InfoController::postDatabaseLoad()
@@ -1173,6 +1232,8 @@ void InfoController::styleChanged()
   tabHandlerInfo->styleChanged();
   tabHandlerAirportInfo->styleChanged();
   tabHandlerAircraft->styleChanged();
+  clearFragmentCache();
+  clearAircraftTextHashes();
   showInformationInternal(currentSearchResult, false /* Show windows */, false /* scroll to top */, true /* forceUpdate */);
 }
 
@@ -1205,8 +1266,7 @@ void InfoController::updateUserAircraftText()
         HtmlBuilder html(true /* has background color */);
         infoBuilder->aircraftText(lastSimData.getUserAircraftConst(), html);
         infoBuilder->aircraftTextWeightAndFuel(lastSimData.getUserAircraftConst(), html);
-        atools::gui::util::updateTextEdit(ui->textBrowserAircraftInfo, html.getHtml(),
-                                          false /* scroll to top*/, true /* keep selection */);
+        updateAircraftTextEdit(ui->textBrowserAircraftInfo, html.getHtml(), lastAircraftHtmlHash);
       }
       ui->textBrowserAircraftInfo->setToolTip(QString());
       ui->textBrowserAircraftInfo->setStatusTip(QString());
@@ -1214,12 +1274,14 @@ void InfoController::updateUserAircraftText()
     else
     {
       ui->textBrowserAircraftInfo->clear();
+      lastAircraftHtmlHash = 0;
       ui->textBrowserAircraftInfo->setPlaceholderText(waitingForUpdateText.arg(getConnectionTypeText()));
     }
   }
   else
   {
     ui->textBrowserAircraftInfo->clear();
+    lastAircraftHtmlHash = 0;
     ui->textBrowserAircraftInfo->setPlaceholderText(notConnectedText);
   }
 }
@@ -1241,8 +1303,7 @@ void InfoController::updateAircraftProgressText()
         HtmlBuilder html(true /* has background color */);
         html.setIdBits(aircraftProgressConfig->getEnabledBits());
         infoBuilder->aircraftProgressText(lastSimData.getUserAircraftConst(), html, NavApp::getRouteConst());
-        atools::gui::util::updateTextEdit(ui->textBrowserAircraftProgressInfo, html.getHtml(),
-                                          false /* scroll to top*/, true /* keep selection */);
+        updateAircraftTextEdit(ui->textBrowserAircraftProgressInfo, html.getHtml(), lastProgressHtmlHash);
       }
       ui->textBrowserAircraftProgressInfo->setToolTip(QString());
       ui->textBrowserAircraftProgressInfo->setStatusTip(QString());
@@ -1250,12 +1311,14 @@ void InfoController::updateAircraftProgressText()
     else
     {
       ui->textBrowserAircraftProgressInfo->clear();
+      lastProgressHtmlHash = 0;
       ui->textBrowserAircraftProgressInfo->setPlaceholderText(waitingForUpdateText.arg(getConnectionTypeText()));
     }
   }
   else
   {
     ui->textBrowserAircraftProgressInfo->clear();
+    lastProgressHtmlHash = 0;
     ui->textBrowserAircraftProgressInfo->setPlaceholderText(notConnectedText);
   }
 }
@@ -1287,8 +1350,7 @@ void InfoController::updateAiAircraftText()
             num++;
           }
 
-          atools::gui::util::updateTextEdit(ui->textBrowserAircraftAiInfo, html.getHtml(),
-                                            false /* scroll to top*/, true /* keep selection */);
+          updateAircraftTextEdit(ui->textBrowserAircraftAiInfo, html.getHtml(), lastAiHtmlHash);
         }
         else
         {
@@ -1301,8 +1363,7 @@ void InfoController::updateAiAircraftText()
           text += tr("No AI or multiplayer aircraft selected.<br/>"
                      "Found %1 AI or multiplayer aircraft.").
                   arg(numAi > 0 ? QLocale().toString(numAi) : tr("no"));
-          atools::gui::util::updateTextEdit(ui->textBrowserAircraftAiInfo, text,
-                                            false /* scroll to top*/, true /* keep selection */);
+          updateAircraftTextEdit(ui->textBrowserAircraftAiInfo, text, lastAiHtmlHash);
         }
       }
       ui->textBrowserAircraftAiInfo->setToolTip(QString());
@@ -1311,23 +1372,29 @@ void InfoController::updateAiAircraftText()
     else
     {
       ui->textBrowserAircraftAiInfo->clear();
+      lastAiHtmlHash = 0;
       ui->textBrowserAircraftAiInfo->setPlaceholderText(waitingForUpdateText.arg(getConnectionTypeText()));
     }
   }
   else
   {
     ui->textBrowserAircraftAiInfo->clear();
+    lastAiHtmlHash = 0;
     ui->textBrowserAircraftAiInfo->setPlaceholderText(notConnectedText);
   }
 }
 
 void InfoController::simDataChanged(const atools::fs::sc::SimConnectData& data)
 {
+  LNM_STALL_SCOPE;
+
   if(databaseLoadStatus)
     return;
 
   Ui::MainWindow *ui = NavApp::getMainUi();
 
+  NavApp::getConnectClient()->setRateDemand(ConnectClient::RATE_DEMAND_AIRCRAFT_INFO, ui->dockWidgetAircraft->isVisible());
+
   if(atools::almostNotEqual(QDateTime::currentDateTime().toMSecsSinceEpoch(),
                             lastSimUpdate, static_cast<qint64>(MIN_SIM_UPDATE_TIME_MS)))
   {
@@ -1340,11 +1407,18 @@ void InfoController::simDataChanged(const atools::fs::sc::SimConnectData& data)
       if(tabHandlerAircraft->getCurrentTabId() == ic::AIRCRAFT_USER)
         updateUserAircraftText();
 
-      if(tabHandlerAircraft->getCurrentTabId() == ic::AIRCRAFT_USER_PROGRESS)
-        updateAircraftProgressText();
+      // Large tables - use lower rate
+      if(atools::almostNotEqual(QDateTime::currentDateTime().toMSecsSinceEpoch(),
+                                lastSimProgressUpdate, static_cast<qint64>(MIN_SIM_UPDATE_PROGRESS_TIME_MS)))
+      {
+        if(tabHandlerAircraft->getCurrentTabId() == ic::AIRCRAFT_USER_PROGRESS)
+          updateAircraftProgressText();
+
+        if(tabHandlerAircraft->getCurrentTabId() == ic::AIRCRAFT_AI)
+          updateAiAircraftText();
 
-      if(tabHandlerAircraft->getCurrentTabId() == ic::AIRCRAFT_AI)
-        updateAiAircraftText();
+        lastSimProgressUpdate = QDateTime::currentDateTime().toMSecsSinceEpoch();
+      }
     }
     lastSimUpdate = QDateTime::currentDateTime().toMSecsSinceEpoch();
   }
@@ -1375,17 +1449,16 @@ void InfoController::updateAiAirports(const atools::fs::sc::SimConnectData& data
   if(data.getPacketId() > 0)
   {
     // Ignore weather updates
-    const QVector<atools::fs::sc::SimConnectAircraft>& newAiAircraft = data.getAiAircraftConst();
+    const ConnectClient *connectClient = NavApp::getConnectClient();
     QList<map::MapAiAircraft> newAiAircraftShown;
 
     // Find all aircraft currently shown on the page in the newly arrived ai list
     for(const map::MapAiAircraft& aircraft : qAsConst(currentSearchResult.aiAircraft))
     {
-      auto it = std::find_if(newAiAircraft.constBegin(), newAiAircraft.constEnd(), [&aircraft](const SimConnectAircraft& ac) -> bool {
-        return ac.getObjectId() == aircraft.getAircraft().getObjectId();
-      });
-      if(it != newAiAircraft.end())
-        newAiAircraftShown.append(map::MapAiAircraft(*it));
+      // Constant time lookup using index built by the connect client
+      const SimConnectAircraft *ac = connectClient->getAiAircraftByObjectId(data, aircraft.getAircraft().getObjectId());
+      if(ac != nullptr)
+        newAiAircraftShown.append(map::MapAiAircraft(*ac));
     }
 
     // Overwite old list
@@ -1403,10 +1476,25 @@ void InfoController::disconnectedFromSimulator()
 {
   qDebug() << Q_FUNC_INFO;
   lastSimData = atools::fs::sc::SimConnectData();
-  lastSimUpdate = 0;
+  lastSimUpdate = lastSimProgressUpdate = 0;
   updateAircraftInfo();
 }
 
+void InfoController::updateAircraftTextEdit(QTextEdit *textEdit, const QString& html, uint& lastHash)
+{
+  uint hash = qHash(html);
+  if(hash != lastHash)
+  {
+    atools::gui::util::updateTextEdit(textEdit, html, false /* scroll to top*/, true /* keep selection */);
+    lastHash = hash;
+  }
+}
+
+void InfoController::clearAircraftTextHashes()
+{
+  lastAircraftHtmlHash = lastProgressHtmlHash = lastAiHtmlHash = 0;
+}
+
 void InfoController::updateAircraftInfo()
 {
   updateUserAircraftText();
@@ -1417,7 +1505,9 @@ void InfoController::updateAircraftInfo()
 void InfoController::optionsChanged()
 {
   updateTextEditFontSizes();
+  clearFragmentCache();
   showInformationInternal(currentSearchResult, false /* Show windows */, false /* scroll to top */, true /* forceUpdate */);
+  clearAircraftTextHashes();
   updateAircraftInfo();
 }
 
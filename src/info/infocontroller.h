@@ -22,8 +22,11 @@
 #include "common/mapresult.h"
 #include "common/tabindexes.h"
 
+#include <QCache>
 #include <QObject>
 
+#include <functional>
+
 class MainWindow;
 class MapQuery;
 class AirportQuery;
@@ -135,7 +138,18 @@ private:
   /* Bearing update in information window time limit */
   static Q_DECL_CONSTEXPR int MIN_SIM_UPDATE_BEARING_TIME_MS = 1000;
 
+  /* Progress and AI tabs contain large tables which are expensive to lay out - update less often */
+  static Q_DECL_CONSTEXPR int MIN_SIM_UPDATE_PROGRESS_TIME_MS = 1000;
+
   void updateAirportInternal(bool newAirport, bool bearingChange, bool scrollToTop, bool forceWeatherUpdate);
+
+  /* Update text edit for airport tab "section" only if airport or input hash changed since the last call.
+   * Uses the fragment cache if the same airport was shown before with the same inputs. */
+  void updateAirportFragment(ic::TabAirportInfoId section, QTextEdit *textEdit, int airportId, uint inputHash,
+                             bool scrollToTop, const std::function<void(atools::util::HtmlBuilder& html)>& buildFunc);
+
+  /* Drop all cached HTML fragments. Needed after option, style or database changes. */
+  void clearFragmentCache();
   bool updateNavaidInternal(const map::MapResult& result, bool bearingChanged, bool scrollToTop, bool forceUpdate);
   bool updateUserpointInternal(const map::MapResult& result, bool bearingChanged, bool scrollToTop);
 
@@ -149,6 +163,13 @@ private:
   void updateAiAircraftText();
   void updateAircraftInfo();
 
+  /* Replace document only if the HTML differs from the last update since replacing causes a full layout.
+   * lastHash is the hash of the currently shown text and is updated. */
+  void updateAircraftTextEdit(QTextEdit *textEdit, const QString& html, uint& lastHash);
+
+  /* Force replacing the aircraft documents on next update */
+  void clearAircraftTextHashes();
+
   /* QTabWidget::currentChanged - update content when visible */
   void currentAircraftTabChanged(int id);
   void currentInfoTabChanged(int id);
@@ -178,10 +199,30 @@ private:
   atools::fs::sc::SimConnectData lastSimData;
   qint64 lastSimUpdate = 0;
   qint64 lastSimBearingUpdate = 0;
+  qint64 lastSimProgressUpdate = 0;
+
+  /* Hashes of HTML shown in the user aircraft, progress and AI tabs. 0 if cleared. */
+  uint lastAircraftHtmlHash = 0, lastProgressHtmlHash = 0, lastAiHtmlHash = 0;
 
   /* Airport and navaids that are currently shown in the tabs */
   map::MapResult currentSearchResult;
 
+  /* HTML for one airport tab and hash of the inputs which were used to build it */
+  struct HtmlFragment
+  {
+    uint inputHash;
+    QString html;
+  };
+
+  /* Key is section in high and airport id in low 32 bits */
+  QCache<quint64, HtmlFragment> htmlFragmentCache;
+
+  /* Maps section to airport id and input hash currently shown in the text edit */
+  QHash<int, std::pair<int, uint> > shownFragments;
+
+  /* Incremented on changes which affect the airport overview or weather tab */
+  quint32 weatherRevision = 0, routeRevision = 0, bearingRevision = 0;
+
   MainWindow *mainWindow = nullptr;
   MapQuery *mapQuery = nullptr;
   AirportQuery *airportQuery = nullptr;
@@ -24,6 +24,7 @@
 #include "db/undoredoprogress.h"
 #include "exception.h"
 #include "fs/gpx/gpxio.h"
+#include "fs/gpx/gpxtypes.h"
 #include "fs/userdata/logdatamanager.h"
 #include "geo/calculations.h"
 #include "gui/dialog.h"
@@ -42,6 +43,7 @@
 #include "zip/gzip.h"
 #include "app/navapp.h"
 #include "query/airportquery.h"
+#include "query/querytypes.h"
 #include "route/route.h"
 #include "route/routealtitude.h"
 #include "search/logdatasearch.h"
@@ -58,6 +60,7 @@
 #include "common/unit.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QStandardPaths>
 
 using atools::sql::SqlTransaction;
@@ -66,17 +69,85 @@ using atools::sql::SqlColumn;
 using atools::geo::Pos;
 using atools::fs::pln::FlightplanIO;
 
+/* Tolerance for simplified track geometry in degree - about 50 meters */
+const static float LOG_TRACK_TOLERANCE_DEG = 0.0005f;
+
+namespace  {
+
+/* Douglas-Peucker simplification of track points using a planar approximation with longitude scaled by latitude.
+ * First and last points are kept. */
+atools::fs::gpx::TrailPoints simplifyTrail(const atools::fs::gpx::TrailPoints& points, float tolerance)
+{
+  if(points.size() < 3)
+    return points;
+
+  QVector<bool> keep(points.size(), false);
+  keep.first() = keep.last() = true;
+
+  QVector<std::pair<int, int> > stack({std::make_pair(0, points.size() - 1)});
+  while(!stack.isEmpty())
+  {
+    std::pair<int, int> range = stack.takeLast();
+    const atools::geo::Pos first = points.at(range.first).pos.asPos(), last = points.at(range.second).pos.asPos();
+
+    float lonScale = std::cos(atools::geo::toRadians((first.getLatY() + last.getLatY()) / 2.f));
+    float x1 = first.getLonX() * lonScale, y1 = first.getLatY();
+    float dx = last.getLonX() * lonScale - x1, dy = last.getLatY() - y1;
+    float length = std::sqrt(dx * dx + dy * dy);
+
+    // Find point with largest distance to line between first and last
+    float maxDist = 0.f;
+    int maxIndex = -1;
+    for(int i = range.first + 1; i < range.second; i++)
+    {
+      const atools::geo::Pos pos = points.at(i).pos.asPos();
+      float px = pos.getLonX() * lonScale - x1, py = pos.getLatY() - y1;
+      float dist = length > 0.f ? std::abs(px * dy - py * dx) / length : std::sqrt(px * px + py * py);
+      if(dist > maxDist)
+      {
+        maxDist = dist;
+        maxIndex = i;
+      }
+    }
+
+    if(maxIndex != -1 && maxDist > tolerance)
+    {
+      keep[maxIndex] = true;
+      stack.append(std::make_pair(range.first, maxIndex));
+      stack.append(std::make_pair(maxIndex, range.second));
+    }
+  }
+
+  atools::fs::gpx::TrailPoints simplified;
+  for(int i = 0; i < points.size(); i++)
+  {
+    if(keep.at(i))
+      simplified.append(points.at(i));
+  }
+  return simplified;
+}
+
+}
+
 LogdataController::LogdataController(atools::fs::userdata::LogdataManager *logdataManager, MainWindow *parent)
   : manager(logdataManager), mainWindow(parent)
 {
   dialog = new atools::gui::Dialog(mainWindow);
 
+  // Size limit for decoded tracks and flight plans in kilobytes
+  gpxCache.setMaxCost(atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_LOGBOOK_GPX_CACHE_KB, 64 * 1024).toInt());
+
   // Do not use a parent to allow the window moving to back
   statsDialog = new LogStatisticsDialog(nullptr, this);
 
   // Add to dock handler to enable auto raise and closing on exit
   NavApp::addDialogToDockHandler(statsDialog);
 
+  // Clear statistics and caches first before dialog and map are updated
+  connect(this, &LogdataController::logDataChanged, this, []() -> void {
+    query::incrementRevision(query::REV_LOGBOOK);
+  });
+  connect(this, &LogdataController::logDataChanged, this, &LogdataController::clearCaches);
   connect(this, &LogdataController::logDataChanged, statsDialog, &LogStatisticsDialog::logDataChanged);
   connect(this, &LogdataController::logDataChanged, manager, &atools::sql::DataManagerBase::updateUndoRedoActions);
 
@@ -93,6 +164,7 @@ LogdataController::~LogdataController()
 {
   NavApp::removeDialogFromDockHandler(statsDialog);
   delete statsDialog;
+  delete gpxDataOversized;
   delete aircraftAtTakeoff;
   delete dialog;
 }
@@ -211,36 +283,87 @@ atools::sql::SqlRecord LogdataController::getLogEntryRecordById(int id)
   return manager->getRecord(id);
 }
 
+void LogdataController::updateFlightStats()
+{
+  if(!flightStats.valid)
+  {
+    QElapsedTimer timer;
+    timer.start();
+
+    FlightStats& s = flightStats;
+    manager->getFlightStatsTime(s.earliest, s.latest, s.earliestSim, s.latestSim);
+    manager->getFlightStatsDistance(s.distTotal, s.distMax, s.distAverage);
+    manager->getFlightStatsAirports(s.numDepartAirports, s.numDestAirports);
+    manager->getFlightStatsTripTime(s.timeMaximum, s.timeAverage, s.timeTotal, s.timeMaximumSim, s.timeAverageSim, s.timeTotalSim);
+    manager->getFlightStatsAircraft(s.numTypes, s.numRegistrations, s.numNames, s.numSimulators);
+    s.simulators.clear();
+    manager->getFlightStatsSimulator(s.simulators);
+    s.valid = true;
+
+    qDebug() << Q_FUNC_INFO << "Loaded statistics in" << timer.elapsed() << "ms";
+  }
+}
+
+void LogdataController::clearCaches()
+{
+  flightStats.valid = false;
+  attachmentCache.clear();
+  gpxCache.clear();
+  delete gpxDataOversized;
+  gpxDataOversized = nullptr;
+  gpxDataOversizedId = -1;
+}
+
 void LogdataController::getFlightStatsTime(QDateTime& earliest, QDateTime& latest, QDateTime& earliestSim,
                                            QDateTime& latestSim)
 {
-  manager->getFlightStatsTime(earliest, latest, earliestSim, latestSim);
+  updateFlightStats();
+  earliest = flightStats.earliest;
+  latest = flightStats.latest;
+  earliestSim = flightStats.earliestSim;
+  latestSim = flightStats.latestSim;
 }
 
 void LogdataController::getFlightStatsDistance(float& distTotal, float& distMax, float& distAverage)
 {
-  manager->getFlightStatsDistance(distTotal, distMax, distAverage);
+  updateFlightStats();
+  distTotal = flightStats.distTotal;
+  distMax = flightStats.distMax;
+  distAverage = flightStats.distAverage;
 }
 
 void LogdataController::getFlightStatsAirports(int& numDepartAirports, int& numDestAirports)
 {
-  manager->getFlightStatsAirports(numDepartAirports, numDestAirports);
+  updateFlightStats();
+  numDepartAirports = flightStats.numDepartAirports;
+  numDestAirports = flightStats.numDestAirports;
 }
 
 void LogdataController::getFlightStatsTripTime(float& timeMaximum, float& timeAverage, float& timeTotal,
                                                float& timeMaximumSim, float& timeAverageSim, float& timeTotalSim)
 {
-  manager->getFlightStatsTripTime(timeMaximum, timeAverage, timeTotal, timeMaximumSim, timeAverageSim, timeTotalSim);
+  updateFlightStats();
+  timeMaximum = flightStats.timeMaximum;
+  timeAverage = flightStats.timeAverage;
+  timeTotal = flightStats.timeTotal;
+  timeMaximumSim = flightStats.timeMaximumSim;
+  timeAverageSim = flightStats.timeAverageSim;
+  timeTotalSim = flightStats.timeTotalSim;
 }
 
 void LogdataController::getFlightStatsAircraft(int& numTypes, int& numRegistrations, int& numNames, int& numSimulators)
 {
-  manager->getFlightStatsAircraft(numTypes, numRegistrations, numNames, numSimulators);
+  updateFlightStats();
+  numTypes = flightStats.numTypes;
+  numRegistrations = flightStats.numRegistrations;
+  numNames = flightStats.numNames;
+  numSimulators = flightStats.numSimulators;
 }
 
 void LogdataController::getFlightStatsSimulator(QVector<std::pair<int, QString> >& numSimulators)
 {
-  manager->getFlightStatsSimulator(numSimulators);
+  updateFlightStats();
+  numSimulators = flightStats.simulators;
 }
 
 void LogdataController::statisticsLogbookShow()
@@ -465,19 +588,39 @@ bool LogdataController::isTrackPreviewShown()
   return NavApp::getMainUi()->actionSearchLogdataShowTrack->isChecked();
 }
 
+bool LogdataController::hasAttached(int id, int flag, std::function<bool(int)> queryFunc)
+{
+  // Checked bits are shifted by three
+  int flags = attachmentCache.value(id, 0);
+  if(!(flags & (flag << 3)))
+  {
+    flags |= flag << 3;
+    if(queryFunc(id))
+      flags |= flag;
+    attachmentCache.insert(id, flags);
+  }
+  return flags & flag;
+}
+
 bool LogdataController::hasRouteAttached(int id)
 {
-  return manager->hasRouteAttached(id);
+  return hasAttached(id, ROUTE, [this](int logId) -> bool {
+    return manager->hasRouteAttached(logId);
+  });
 }
 
 bool LogdataController::hasPerfAttached(int id)
 {
-  return manager->hasPerfAttached(id);
+  return hasAttached(id, PERF, [this](int logId) -> bool {
+    return manager->hasPerfAttached(logId);
+  });
 }
 
 bool LogdataController::hasTrackAttached(int id)
 {
-  return manager->hasTrackAttached(id);
+  return hasAttached(id, TRACK, [this](int logId) -> bool {
+    return manager->hasTrackAttached(logId);
+  });
 }
 
 void LogdataController::preDatabaseLoad()
@@ -497,7 +640,58 @@ void LogdataController::displayOptionsChanged()
 
 const atools::fs::gpx::GpxData *LogdataController::getGpxData(int id)
 {
-  return manager->getGpxData(id);
+  if(gpxCache.contains(id))
+    return gpxCache.object(id);
+
+  if(gpxDataOversized != nullptr && gpxDataOversizedId == id)
+    return gpxDataOversized;
+
+  const atools::fs::gpx::GpxData *managerData = manager->getGpxData(id);
+  if(managerData == nullptr)
+    return nullptr;
+
+  // Copy decoded data and empty the manager cache which is limited by entry count only
+  atools::fs::gpx::GpxData *data = new atools::fs::gpx::GpxData(*managerData);
+  manager->clearGeometryCache();
+
+  // Simplify tracks once for display and hit testing - bounding rectangles are kept from the full track
+  int numPoints = 0, numSimplified = 0;
+  for(atools::fs::gpx::TrailPoints& points : data->trails)
+  {
+    numPoints += points.size();
+    points = simplifyTrail(points, LOG_TRACK_TOLERANCE_DEG);
+    numSimplified += points.size();
+  }
+
+#ifdef DEBUG_INFORMATION
+  qDebug() << Q_FUNC_INFO << "id" << id << "points" << numPoints << "simplified" << numSimplified;
+#else
+  Q_UNUSED(numPoints)
+  Q_UNUSED(numSimplified)
+#endif
+
+  int costKb = gpxDataSizeKb(*data);
+  if(costKb > gpxCache.maxCost())
+  {
+    // Keep a single large entry outside of the cache
+    delete gpxDataOversized;
+    gpxDataOversized = data;
+    gpxDataOversizedId = id;
+    return data;
+  }
+
+  gpxCache.insert(id, data, costKb);
+  return data;
+}
+
+int LogdataController::gpxDataSizeKb(const atools::fs::gpx::GpxData& data)
+{
+  qint64 bytes = sizeof(atools::fs::gpx::GpxData);
+  bytes += data.flightplan.size() * static_cast<qint64>(sizeof(atools::fs::pln::FlightplanEntry) + 64 /* strings */);
+  for(const atools::fs::gpx::TrailPoints& points : data.trails)
+    bytes += points.size() * static_cast<qint64>(sizeof(atools::fs::gpx::TrailPoint));
+
+  return static_cast<int>(bytes / 1024 + 1);
 }
 
 void LogdataController::editLogEntryFromMap(int id)
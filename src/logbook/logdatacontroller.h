@@ -20,8 +20,12 @@
 
 #include "common/maptypes.h"
 
+#include <QCache>
+#include <QDateTime>
+#include <QHash>
 #include <QObject>
 #include <QVector>
+#include <functional>
 
 namespace atools {
 namespace sql {
@@ -150,6 +154,8 @@ public:
   /* Resets detection of flight */
   void resetTakeoffLandingDetection();
 
+  /* Get decoded flight plan and track for map preview and hit testing. Data is kept in a cache limited by size in bytes.
+   * Track points are simplified once after decoding. Returned pointer is only valid until the next call. */
   const atools::fs::gpx::GpxData *getGpxData(int id);
 
   /* Clear caches */
@@ -164,7 +170,7 @@ public:
   bool isRoutePreviewShown();
   bool isTrackPreviewShown();
 
-  /* true if the files are attached and length is > 0 */
+  /* true if the files are attached and length is > 0. Cached until the logbook changes. */
   bool hasRouteAttached(int id);
   bool hasPerfAttached(int id);
   bool hasTrackAttached(int id);
@@ -218,6 +224,48 @@ private:
   void undoTriggered();
   void redoTriggered();
 
+  /* Load all overview statistics from database if not already done */
+  void updateFlightStats();
+
+  /* Invalidate statistics, attachment flags and track cache on any logbook change */
+  void clearCaches();
+
+  /* Get cached attachment state from bits below or query database */
+  bool hasAttached(int id, int flag, std::function<bool(int)> queryFunc);
+
+  /* Estimated size of decoded track and flight plan in kilobytes */
+  static int gpxDataSizeKb(const atools::fs::gpx::GpxData& data);
+
+  /* Cached statistics for the statistics dialog. Loaded on first access and cleared when the logbook changes. */
+  struct FlightStats
+  {
+    QDateTime earliest, latest, earliestSim, latestSim;
+    float distTotal = 0.f, distMax = 0.f, distAverage = 0.f;
+    float timeMaximum = 0.f, timeAverage = 0.f, timeTotal = 0.f, timeMaximumSim = 0.f, timeAverageSim = 0.f, timeTotalSim = 0.f;
+    int numDepartAirports = 0, numDestAirports = 0, numTypes = 0, numRegistrations = 0, numNames = 0, numSimulators = 0;
+    QVector<std::pair<int, QString> > simulators;
+    bool valid = false;
+  };
+
+  FlightStats flightStats;
+
+  /* Bits for attachment cache. CHECKED_* is set if the value is valid. */
+  enum
+  {
+    ROUTE = 1 << 0, PERF = 1 << 1, TRACK = 1 << 2,
+    CHECKED_ROUTE = 1 << 3, CHECKED_PERF = 1 << 4, CHECKED_TRACK = 1 << 5
+  };
+
+  /* Logbook id to attachment bits */
+  QHash<int, int> attachmentCache;
+
+  /* Decoded tracks and flight plans with cost in kilobytes */
+  QCache<int, atools::fs::gpx::GpxData> gpxCache;
+
+  /* Single entry which is too large for the cache */
+  atools::fs::gpx::GpxData *gpxDataOversized = nullptr;
+  int gpxDataOversizedId = -1;
+
   /* Remember last aircraft for fuel calculations */
   const atools::fs::sc::SimConnectUserAircraft *aircraftAtTakeoff = nullptr;
   int logEntryId = -1;
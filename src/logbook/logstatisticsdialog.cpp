@@ -33,6 +33,7 @@
 #include "util/htmlbuilder.h"
 
 #include <QSqlError>
+#include <QSqlQuery>
 #include <QPushButton>
 #include <QMimeData>
 #include <QClipboard>
@@ -54,7 +55,7 @@ public:
     Q_ASSERT_X(defaultSortColumn < colParam.size(), labelParam.toLatin1().constData(), query.toLatin1().constData());
   }
 
-  QString label, /* Combo box label */ query; /* SQL query */
+  QString label, /* Combo box label */ query, /* SQL query */ table; /* Name of temporary table keeping the results */
   QStringList cols, header; /* SQL columns and Result table headers - must be equal to query columns */
   QVector<Qt::Alignment> align; /* Column alignment - must be equal to query columns */
 
@@ -92,8 +93,8 @@ class LogStatsSqlModel :
   public QSqlQueryModel
 {
 public:
-  LogStatsSqlModel(QObject *parent, const QSqlDatabase *db)
-    : QSqlQueryModel(parent), database(db)
+  LogStatsSqlModel(QObject *parent, const QSqlDatabase *db, QSet<QString> *materializedTablesParam)
+    : QSqlQueryModel(parent), database(db), materializedTables(materializedTablesParam)
   {
 
   }
@@ -144,16 +145,40 @@ private:
 
   QString buildQuery()
   {
-    // Build query with current ordering, unit placeholders and conversion factor
+    // Build query with unit placeholders and conversion factor
     QString str = query->query;
     if(str.contains("%1"))
       str = str.arg(nmToUnitFactor);
+
+    // Materialize query results in a temporary table once per logbook change and unit to allow fast sorting
+    // Key contains the unit factor
+    QString key = query->table % "_" % QString::number(static_cast<double>(nmToUnitFactor));
+    if(!materializedTables->contains(key))
+    {
+      QSqlQuery sqlQuery(*database);
+      if(sqlQuery.exec("drop table if exists temp." % query->table) &&
+         sqlQuery.exec("create temp table " % query->table % " as " % str))
+      {
+        // Remove key for other units
+        for(auto it = materializedTables->begin(); it != materializedTables->end(); )
+          it = it->startsWith(query->table % "_") ? materializedTables->erase(it) : std::next(it);
+        materializedTables->insert(key);
+      }
+      else
+        qWarning() << Q_FUNC_INFO << "Error creating table" << query->table << sqlQuery.lastError().text();
+    }
+
+    if(materializedTables->contains(key))
+      str = "select * from temp." % query->table;
+
+    // Add current ordering
     return str % " order by " % query->cols.at(sortColumn) % (sortOrder == Qt::DescendingOrder ? " desc" : " asc");
   }
 
   QLocale locale;
   float nmToUnitFactor = 1.f;
   const QSqlDatabase *database = nullptr;
+  QSet<QString> *materializedTables = nullptr;
   const Query *query = nullptr;
   int sortColumn = 0;
   Qt::SortOrder sortOrder = Qt::DescendingOrder;
@@ -243,6 +268,9 @@ void LogStatisticsDialog::updateWidgets()
 
 void LogStatisticsDialog::logDataChanged()
 {
+  // Force rebuild of temporary tables on next access
+  materializedTables.clear();
+
   if(isVisible())
   {
     setModel();
@@ -322,7 +350,7 @@ void LogStatisticsDialog::setModel()
 {
   clearModel();
 
-  model = new LogStatsSqlModel(this, &logdataController->getDatabase()->getQSqlDatabase());
+  model = new LogStatsSqlModel(this, &logdataController->getDatabase()->getQSqlDatabase(), &materializedTables);
 
   QItemSelectionModel *selectionModel = ui->tableViewLogStatsGrouped->selectionModel();
   ui->tableViewLogStatsGrouped->setModel(model);
@@ -564,6 +592,10 @@ void LogStatisticsDialog::initQueries()
           "from logbook where departure_time is not null and destination_time is not null) "
           "group by aircraft_name, aircraft_type")
   };
+
+  // Assign names for temporary result tables
+  for(int i = 0; i < queries.size(); i++)
+    queries[i].table = QString("logbook_stats_%1").arg(i);
 }
 
 void LogStatisticsDialog::showEvent(QShowEvent *)
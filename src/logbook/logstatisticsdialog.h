@@ -19,6 +19,7 @@
 #define LNM_LOGSTATISTICSDIALOG_H
 
 #include <QDialog>
+#include <QSet>
 #include <QSqlQueryModel>
 #include <QStyledItemDelegate>
 
@@ -113,6 +114,9 @@ private:
   /* Remember dilalog position when reopening */
   QPoint position;
 
+  /* Temporary tables for query results which are still valid. Cleared on logbook changes. */
+  QSet<QString> materializedTables;
+
 };
 
 #endif // LNM_LOGSTATISTICSDIALOG_H
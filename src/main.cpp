@@ -160,6 +160,22 @@ int main(int argc, char *argv[])
   // Show dialog on exception in main event queue - can be disabled for debugging purposes
   NavApp::setShowExceptionDialog(earlySettings.value("Options/ExceptionDialog", true).toBool());
 
+  // Use offscreen platform for batch processing or server mode without display - has to be set before creating the application
+  bool headless = false, server = false;
+  for(int i = 1; i < argc; i++)
+  {
+    if(QString(argv[i]) == QString("--%1").arg(lnm::STARTUP_HEADLESS))
+      headless = true;
+    if(QString(argv[i]) == QString("--%1").arg(lnm::STARTUP_SERVER))
+      headless = server = true;
+  }
+
+  if(headless)
+  {
+    renderOptMessages.append(server ? "Server mode using offscreen platform" : "Headless mode using offscreen platform");
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  }
+
   // Create application object ===========================================================
   int retval = 0;
   NavApp app(argc, argv);
@@ -228,7 +244,7 @@ int main(int argc, char *argv[])
 
       // ==============================================
       // Start splash screen
-      if(settings.valueBool(lnm::OPTIONS_DIALOG_SHOW_SPLASH, true))
+      if(settings.valueBool(lnm::OPTIONS_DIALOG_SHOW_SPLASH, true) && !headless)
         NavApp::initSplashScreen();
 
       // Log system information ========================================
@@ -400,10 +416,16 @@ int main(int argc, char *argv[])
         // Show database dialog if something was removed
         mainWindow.setDatabaseErased(databasesErased);
 
-        mainWindow.show();
+        if(server)
+          // Start only simulator connection, downloads and web server without showing the window
+          mainWindow.serverStartup();
+        else
+        {
+          mainWindow.show();
 
-        // Hide splash once main window is shown
-        NavApp::finishSplashScreen();
+          // Hide splash once main window is shown
+          NavApp::finishSplashScreen();
+        }
 
         // =============================================================================================
         // Run application
@@ -0,0 +1,128 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/airspacegeometrycache.h"
+
+#include "common/coordinateconverter.h"
+#include "geo/linestring.h"
+
+#include <marble/ViewportParams.h>
+
+AirspaceGeometryCache::AirspaceGeometryCache()
+  : geometryCache(CACHE_SIZE_BYTES, true /* clearOnViewChange */)
+{
+
+}
+
+AirspaceGeometryCache::~AirspaceGeometryCache()
+{
+  delete converter;
+}
+
+void AirspaceGeometryCache::clear()
+{
+  geometryCache.clear();
+}
+
+void AirspaceGeometryCache::setViewportParams(const Marble::ViewportParams *viewportParams)
+{
+  if(converter != nullptr)
+    delete converter;
+
+  // Create a new converter for the viewport
+  viewport = viewportParams;
+  converter = new CoordinateConverter(viewport);
+  geometryCache.clear();
+  geometryCache.updateViewport(viewport);
+}
+
+const QVector<QPolygonF *> AirspaceGeometryCache::createPolygons(const map::MapAirspaceId& id,
+                                                                 const atools::geo::LineString& linestring,
+                                                                 const QRectF& screenRect)
+{
+  Q_ASSERT(converter != nullptr);
+
+#if !defined(DEBUG_NO_AIRSPACE_CACHE)
+  // Make sure view changes are detected if used outside of painting
+  geometryCache.updateViewport(viewport);
+
+  if(!geometryCache.isFlatProjection())
+    // Rotating projection - no caching
+    return converter->createPolygons(linestring, screenRect);
+
+  QVector<QPolygonF *> polygons;
+  Entry *entry = geometryCache.object(id);
+  if(entry != nullptr)
+  {
+    // Get offset by calculating the current position of the view center at creation time
+    bool visible;
+    QPointF offset = converter->wToSF(entry->center, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible) - entry->centerPoint;
+
+    // Use only if moved less than half of the screen size to avoid issues with Mercator repetitions
+    if(visible && std::abs(offset.x()) < viewport->width() / 2. && std::abs(offset.y()) < viewport->height() / 2.)
+    {
+      // Found - create copies and translate them to the needed coordinates
+      for(const QPolygonF& polygon : qAsConst(entry->polygons))
+        polygons.append(new QPolygonF(polygon.translated(offset)));
+      return polygons;
+    }
+    else
+      // Moved too far - recalculate below
+      geometryCache.remove(id);
+  }
+
+  // Nothing in cache - create the screen polygons for each part separated at the anti-meridian
+  bool cacheable = true;
+  for(const atools::geo::LineString& line : linestring.splitAtAntiMeridianList())
+  {
+    const QVector<QPolygonF *> parts = converter->createPolygons(line, screenRect);
+
+    // Do not cache Mercator repetitions or invisible parts since these might change when moving
+    if(parts.size() != 1)
+      cacheable = false;
+    polygons.append(parts);
+  }
+
+  if(cacheable && !polygons.isEmpty())
+  {
+    // Remember view center and its screen position
+    atools::geo::Pos center(viewport->centerLongitude(), viewport->centerLatitude());
+    center.toDeg();
+
+    bool visible;
+    QPointF centerPoint = converter->wToSF(center, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
+
+    if(visible)
+    {
+      // Create a copy for the cache
+      entry = new Entry;
+      entry->center = center;
+      entry->centerPoint = centerPoint;
+
+      for(const QPolygonF *polygon : qAsConst(polygons))
+        entry->polygons.append(*polygon);
+
+      geometryCache.insert(id, entry, geocache::sizeBytes(entry->polygons));
+    }
+  }
+
+  // Return copy with correct position for drawing
+  return polygons;
+#else
+  return converter->createPolygons(linestring, screenRect);
+#endif
+}
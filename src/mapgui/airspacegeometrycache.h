@@ -0,0 +1,91 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_AIRSPACEGEOMETRYCACHE_H
+#define LNM_AIRSPACEGEOMETRYCACHE_H
+
+#include "common/mapflags.h"
+#include "geo/pos.h"
+#include "mapgui/projectedgeometrycache.h"
+
+#include <QPolygonF>
+
+class CoordinateConverter;
+namespace Marble {
+class ViewportParams;
+}
+namespace atools {
+namespace geo {
+class LineString;
+}
+}
+
+/*
+ * Caches airspace geometry in screen coordinates for the flat projections Mercator and Equirectangular.
+ *
+ * Panning in these projections only translates the screen coordinates. Cached polygons are moved by the
+ * screen offset of the view center which was used when creating them instead of projecting all points again.
+ * The whole cache is cleared if zoom, projection or screen size change.
+ *
+ * Spherical projection always recalculates the polygons since a pan is a rotation there.
+ */
+class AirspaceGeometryCache
+{
+public:
+  AirspaceGeometryCache();
+  ~AirspaceGeometryCache();
+
+  AirspaceGeometryCache(const AirspaceGeometryCache& other) = delete;
+  AirspaceGeometryCache& operator=(const AirspaceGeometryCache& other) = delete;
+
+  /* Get screen polygons for the airspace geometry from the cache or create them if needed.
+   * Result is the same as CoordinateConverter::createPolygons().
+   * Free with CoordinateConverter::releasePolygons() */
+  const QVector<QPolygonF *> createPolygons(const map::MapAirspaceId& id, const atools::geo::LineString& linestring,
+                                            const QRectF& screenRect);
+
+  /* Clear the cache */
+  void clear();
+
+  /* Has to be set before using it */
+  void setViewportParams(const Marble::ViewportParams *viewportParams);
+
+  /* Cache for registration in MapPaintWidget */
+  ProjectedGeometryCacheBase *getCache()
+  {
+    return &geometryCache;
+  }
+
+private:
+  /* Polygons in screen coordinates as calculated for the view center */
+  struct Entry
+  {
+    QVector<QPolygonF> polygons;
+    atools::geo::Pos center; /* View center at time of creation */
+    QPointF centerPoint; /* Screen coordinates of the view center at time of creation */
+  };
+
+  /* Memory limit for all polygons */
+  static const int CACHE_SIZE_BYTES = 8 * 1024 * 1024;
+
+  /* Used to convert world to screen coordinates */
+  CoordinateConverter *converter = nullptr;
+  const Marble::ViewportParams *viewport = nullptr;
+  ProjectedGeometryCache<map::MapAirspaceId, Entry> geometryCache;
+};
+
+#endif // LNM_AIRSPACEGEOMETRYCACHE_H
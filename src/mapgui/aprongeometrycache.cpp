@@ -20,6 +20,7 @@
 #include "common/coordinateconverter.h"
 #include "common/maptypes.h"
 
+#include <QBitArray>
 #include <QPainterPath>
 
 // ======= Key  ===============================================================
@@ -46,7 +47,7 @@ bool ApronGeometryCache::Key::operator!=(const ApronGeometryCache::Key& other) c
 
 // ======= ApronGeometryCache ===============================================================
 ApronGeometryCache::ApronGeometryCache()
-  : geometryCache(CACHE_SIZE)
+  : geometryCache(CACHE_SIZE_BYTES, true /* clearOnViewChange */), fsGeometryCache(CACHE_SIZE_BYTES, true /* clearOnViewChange */)
 {
 
 }
@@ -59,6 +60,7 @@ ApronGeometryCache::~ApronGeometryCache()
 void ApronGeometryCache::clear()
 {
   geometryCache.clear();
+  fsGeometryCache.clear();
 }
 
 void ApronGeometryCache::setViewportParams(const Marble::ViewportParams *viewport)
@@ -119,7 +121,7 @@ QPainterPath ApronGeometryCache::getApronGeometry(const map::MapApron& apron, fl
     painterPath->translate(-refPoint.x(), -refPoint.y());
 
     // Insert path with reference 0,0
-    geometryCache.insert(key, painterPath);
+    geometryCache.insert(key, painterPath, geocache::sizeBytes(*painterPath));
 #endif
 
     // Return copy with correct position for drawing
@@ -127,6 +129,34 @@ QPainterPath ApronGeometryCache::getApronGeometry(const map::MapApron& apron, fl
   }
 }
 
+QPolygonF ApronGeometryCache::getFsApronGeometry(const map::MapApron& apron)
+{
+  Q_ASSERT(converter != nullptr);
+
+  if(apron.vertices.isEmpty())
+    return QPolygonF();
+
+  // Calculate the coordinates of the reference point (first one)
+  bool visible;
+  QPointF refPoint = converter->wToSF(apron.vertices.constFirst(), CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
+
+  const QPolygonF *polygon = fsGeometryCache.object(apron.id);
+  if(polygon != nullptr)
+    // Found - move into the required place for drawing
+    return polygon->translated(refPoint);
+
+  // Project all vertices at once - coordinates of invisible points are used too
+  QPolygonF apronPoints;
+  QBitArray visibleBits;
+  converter->wToSBatch(apronPoints, visibleBits, apron.vertices);
+
+  // Insert polygon with reference 0,0
+  QPolygonF *cached = new QPolygonF(apronPoints.translated(-refPoint));
+  fsGeometryCache.insert(apron.id, cached, geocache::sizeBytes(*cached));
+
+  return apronPoints;
+}
+
 /* Calculate X-Plane aprons including bezier curves */
 QPainterPath ApronGeometryCache::pathForBoundary(const atools::fs::common::Boundary& boundaryNodes, bool fast)
 {
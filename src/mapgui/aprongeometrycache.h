@@ -19,8 +19,8 @@
 #define LNM_APRONGEOMETRYCACHE_H
 
 #include "fs/common/xpgeometry.h"
+#include "mapgui/projectedgeometrycache.h"
 
-#include <QCache>
 #include <QPainterPath>
 
 class QPainterPath;
@@ -35,8 +35,10 @@ struct MapApron;
 
 /*
  * Caches the complex X-Plane apron geometry in screen coordinates by zoom level and draw fast flag.
+ * Also caches the simple FSX/P3D apron polygons.
  *
  * This will keep a copy of a QPainterPath of an apron for a given zoomlevel until the cache overflows.
+ * Both caches are cleared by MapPaintWidget on projection, zoom or screen size changes.
  */
 class ApronGeometryCache
 {
@@ -51,6 +53,15 @@ public:
    * Combined key is apron ID, zoom and draw fast flag */
   QPainterPath getApronGeometry(const map::MapApron& apron, float zoomDistanceMeter, bool fast);
 
+  /* Get FSX/P3D apron polygon in screen coordinates from the cache or project all vertices */
+  QPolygonF getFsApronGeometry(const map::MapApron& apron);
+
+  /* Caches for registration in MapPaintWidget */
+  QVector<ProjectedGeometryCacheBase *> getCaches()
+  {
+    return {&geometryCache, &fsGeometryCache};
+  }
+
   /* Clear the cache */
   void clear();
 
@@ -77,12 +88,13 @@ private:
   /* Calculate X-Plane aprons including bezier curves */
   QPainterPath pathForBoundary(const atools::fs::common::Boundary& boundaryNodes, bool fast);
 
-  /* Some airport have more than 100 apron parts */
-  static const int CACHE_SIZE = 2000;
+  /* Memory limit for each cache. Some airport have more than 100 apron parts */
+  static const int CACHE_SIZE_BYTES = 8 * 1024 * 1024;
 
   /* Used to convert world to screen coordinates */
   CoordinateConverter *converter = nullptr;
-  QCache<Key, QPainterPath> geometryCache;
+  ProjectedGeometryCache<Key, QPainterPath> geometryCache;
+  ProjectedGeometryCache<int, QPolygonF> fsGeometryCache;
 };
 
 #endif // LNM_APRONGEOMETRYCACHE_H
@@ -0,0 +1,151 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/kmlsimplifier.h"
+
+#include "atools.h"
+#include "common/maptools.h"
+#include "geo/linestring.h"
+#include "settings/settings.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStringBuilder>
+#include <QUrl>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+QString KmlSimplifier::cacheFilename(const QString& filename, float toleranceDeg, qint64 minFileSize)
+{
+  QFileInfo fileinfo(filename);
+  if(toleranceDeg <= 0.f || fileinfo.suffix().compare("kml", Qt::CaseInsensitive) != 0 || fileinfo.size() < minFileSize)
+    return QString();
+
+  // Build name from path, size, modification time and tolerance to detect changed files
+  QString key = fileinfo.canonicalFilePath() % ':' % QString::number(fileinfo.size()) % ':' %
+                QString::number(fileinfo.lastModified().toMSecsSinceEpoch()) % ':' % QString::number(toleranceDeg);
+  QString hash = QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5).toHex());
+
+  return atools::settings::Settings::getPath() % atools::SEP % "kmlcache" % atools::SEP % hash % ".kml";
+}
+
+bool KmlSimplifier::simplifyFile(const QString& filename, const QString& outFilename, float toleranceDeg)
+{
+  if(QFile::exists(outFilename))
+    // Already simplified earlier
+    return true;
+
+  QFile inFile(filename);
+  if(!inFile.open(QIODevice::ReadOnly))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << inFile.errorString();
+    return false;
+  }
+
+  QDir().mkpath(QFileInfo(outFilename).absolutePath());
+
+  // Write to temporary file first and rename when done to avoid partial files in the cache
+  QString tempFilename = outFilename % ".tmp";
+  QFile outFile(tempFilename);
+  if(!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << tempFilename << outFile.errorString();
+    return false;
+  }
+
+  QXmlStreamReader reader(&inFile);
+  QXmlStreamWriter writer(&outFile);
+  bool ok = true;
+  int numIn = 0, numOut = 0;
+
+  while(!reader.atEnd() && ok)
+  {
+    reader.readNext();
+
+    if(reader.isStartElement() && reader.name() == QLatin1String("coordinates"))
+    {
+      // Replace coordinate list with simplified one
+      writer.writeCurrentToken(reader);
+      QString coordinates = reader.readElementText();
+      QString simplified = simplifyCoordinates(coordinates, toleranceDeg);
+      numIn += coordinates.size();
+      numOut += simplified.size();
+      writer.writeCharacters(simplified);
+      writer.writeEndElement();
+    }
+    else if(reader.isStartElement() && reader.name() == QLatin1String("href"))
+    {
+      // Links relative to the original file would break in the cache folder
+      writer.writeCurrentToken(reader);
+      QString href = reader.readElementText().trimmed();
+      if(!href.isEmpty() && QUrl(href).isRelative() && QFileInfo(href).isRelative())
+        ok = false;
+      writer.writeCharacters(href);
+      writer.writeEndElement();
+    }
+    else if(!reader.hasError())
+      writer.writeCurrentToken(reader);
+  }
+
+  if(reader.hasError())
+  {
+    qWarning() << Q_FUNC_INFO << "Error reading" << filename << reader.errorString();
+    ok = false;
+  }
+
+  outFile.close();
+  if(ok)
+  {
+    ok = outFile.rename(outFilename);
+    qInfo() << Q_FUNC_INFO << filename << "coordinates reduced from" << numIn << "to" << numOut << "characters";
+  }
+
+  if(!ok)
+    outFile.remove();
+
+  return ok;
+}
+
+QString KmlSimplifier::simplifyCoordinates(const QString& coordinates, float toleranceDeg)
+{
+  const QStringList tuples = coordinates.simplified().split(' ', QString::SkipEmptyParts);
+  if(tuples.size() < 3)
+    return coordinates;
+
+  // Parse longitude and latitude of each tuple - altitude is kept in the original text
+  atools::geo::LineString line;
+  for(const QString& tuple : tuples)
+  {
+    bool okLon, okLat;
+    float lonX = tuple.section(',', 0, 0).toFloat(&okLon);
+    float latY = tuple.section(',', 1, 1).toFloat(&okLat);
+    if(!okLon || !okLat)
+      // Leave unknown format untouched
+      return coordinates;
+
+    line.append(atools::geo::Pos(lonX, latY));
+  }
+
+  QStringList simplified;
+  for(int index : maptools::simplifyLineIndexes(line, toleranceDeg))
+    simplified.append(tuples.at(index));
+  return simplified.join(' ');
+}
@@ -0,0 +1,50 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_KMLSIMPLIFIER_H
+#define LNM_KMLSIMPLIFIER_H
+
+#include <QString>
+
+/*
+ * Reduces the number of points in large Google Earth KML files before they are handed over to Marble.
+ *
+ * The file is copied with a streaming XML reader and writer. Only the text of coordinates elements is changed
+ * using a Douglas-Peucker simplification. Everything else is kept as is.
+ * Simplified files are kept in a cache folder in the settings directory and are reused as long as the
+ * original file is not modified.
+ *
+ * The static methods are thread safe and can be used in a background thread.
+ */
+class KmlSimplifier
+{
+public:
+  /* Get filename of simplified file in cache. Empty if file should not be simplified (too small, KMZ or disabled).
+   * Returns the filename even if the simplified file does not exist yet. */
+  static QString cacheFilename(const QString& filename, float toleranceDeg, qint64 minFileSize);
+
+  /* Create simplified file outFilename from filename if not already present.
+   * Returns false if the file could not be read, written or contains relative links which would break when moving the file.
+   * Caller should use the original file in this case. */
+  static bool simplifyFile(const QString& filename, const QString& outFilename, float toleranceDeg);
+
+private:
+  /* Simplify a coordinates element text like "lon,lat,alt lon,lat,alt ..." */
+  static QString simplifyCoordinates(const QString& coordinates, float toleranceDeg);
+};
+
+#endif // LNM_KMLSIMPLIFIER_H
@@ -0,0 +1,122 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/linegeometrycache.h"
+
+#include "common/coordinateconverter.h"
+#include "geo/linestring.h"
+
+#include <marble/ViewportParams.h>
+
+uint qHash(const LineGeometryCache::Key& key)
+{
+  return static_cast<uint>(key.type) ^ (static_cast<uint>(key.id) << 8) ^ static_cast<uint>(key.index);
+}
+
+LineGeometryCache::LineGeometryCache()
+  : geometryCache(CACHE_SIZE_BYTES, true /* clearOnViewChange */)
+{
+
+}
+
+LineGeometryCache::~LineGeometryCache()
+{
+  delete converter;
+}
+
+void LineGeometryCache::clear()
+{
+  geometryCache.clear();
+}
+
+void LineGeometryCache::setViewportParams(const Marble::ViewportParams *viewportParams)
+{
+  if(converter != nullptr)
+    delete converter;
+
+  // Create a new converter for the viewport
+  viewport = viewportParams;
+  converter = new CoordinateConverter(viewport);
+  geometryCache.clear();
+  geometryCache.updateViewport(viewport);
+}
+
+bool LineGeometryCache::createPolylines(const Key& key, const atools::geo::Pos& pos1, const atools::geo::Pos& pos2,
+                                        float radiusNm, const std::function<atools::geo::LineString()>& geometryFunc,
+                                        const QRectF& screenRect, QVector<QPolygonF>& polylines)
+{
+  Q_ASSERT(converter != nullptr);
+
+  polylines.clear();
+  geometryCache.updateViewport(viewport);
+
+  if(!geometryCache.isFlatProjection())
+    // Rotating projection - no caching
+    return false;
+
+  Entry *entry = geometryCache.object(key);
+  if(entry != nullptr)
+  {
+    if(entry->pos1 == pos1 && entry->pos2 == pos2 && entry->radiusNm == radiusNm)
+    {
+      // Get offset by calculating the current position of the view center at creation time
+      bool visible;
+      QPointF offset = converter->wToSF(entry->center, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible) - entry->centerPoint;
+
+      // Use only if moved less than half of the screen size to avoid issues with Mercator repetitions
+      if(visible && std::abs(offset.x()) < viewport->width() / 2. && std::abs(offset.y()) < viewport->height() / 2.)
+      {
+        for(const QPolygonF& polyline : qAsConst(entry->polylines))
+          polylines.append(polyline.translated(offset));
+        return true;
+      }
+    }
+
+    // Marker was changed or view moved too far - recalculate below
+    geometryCache.remove(key);
+  }
+
+  // Nothing in cache - create the screen polylines
+  const QVector<QPolygonF *> parts = converter->createPolylines(geometryFunc(), screenRect);
+  for(const QPolygonF *part : parts)
+    polylines.append(*part);
+  converter->releasePolylines(parts);
+
+  // Do not cache Mercator repetitions, anti-meridian splits or invisible geometry since these might change when moving
+  if(polylines.size() == 1)
+  {
+    // Remember view center and its screen position
+    atools::geo::Pos center(viewport->centerLongitude(), viewport->centerLatitude());
+    center.toDeg();
+
+    bool visible;
+    QPointF centerPoint = converter->wToSF(center, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
+
+    if(visible)
+    {
+      entry = new Entry;
+      entry->polylines = polylines;
+      entry->pos1 = pos1;
+      entry->pos2 = pos2;
+      entry->radiusNm = radiusNm;
+      entry->center = center;
+      entry->centerPoint = centerPoint;
+      geometryCache.insert(key, entry, geocache::sizeBytes(entry->polylines));
+    }
+  }
+  return true;
+}
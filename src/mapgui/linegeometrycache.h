@@ -0,0 +1,125 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_LINEGEOMETRYCACHE_H
+#define LNM_LINEGEOMETRYCACHE_H
+
+#include "geo/pos.h"
+#include "mapgui/projectedgeometrycache.h"
+
+#include <QPolygonF>
+
+#include <functional>
+
+class CoordinateConverter;
+namespace Marble {
+class ViewportParams;
+}
+namespace atools {
+namespace geo {
+class LineString;
+}
+}
+
+/*
+ * Caches screen geometry of user placed range rings, distance measurement lines and flight plan legs for the flat
+ * projections Mercator and Equirectangular.
+ *
+ * Works like AirspaceGeometryCache: cached polylines are moved by the screen offset of the view center on pan
+ * and the whole cache is cleared if zoom, projection or screen size change.
+ * Entries remember the geometry they were built from and are recalculated if a marker or leg was changed.
+ */
+class LineGeometryCache
+{
+public:
+  enum Type
+  {
+    RANGE_RING,
+    DISTANCE_LINE,
+    ROUTE_LEG
+  };
+
+  /* Identifies a ring of a range marker, a distance marker line or a flight plan leg */
+  struct Key
+  {
+    Key()
+    {
+    }
+
+    Key(LineGeometryCache::Type typeParam, int idParam, int indexParam)
+      : type(typeParam), id(idParam), index(indexParam)
+    {
+    }
+
+    bool operator==(const LineGeometryCache::Key& other) const
+    {
+      return type == other.type && id == other.id && index == other.index;
+    }
+
+    LineGeometryCache::Type type = RANGE_RING;
+    int id = -1, index = 0; /* Marker id and ring index or leg index */
+  };
+
+  LineGeometryCache();
+  ~LineGeometryCache();
+
+  LineGeometryCache(const LineGeometryCache& other) = delete;
+  LineGeometryCache& operator=(const LineGeometryCache& other) = delete;
+
+  /* Get screen polylines for the line geometry from the cache or create them if needed.
+   * pos1, pos2 and radiusNm describe the geometry and are used to detect changes.
+   * geometryFunc is called to build the geometry if nothing was found.
+   * Returns false for the spherical projection which is not cached. Caller has to draw as usual in this case. */
+  bool createPolylines(const Key& key, const atools::geo::Pos& pos1, const atools::geo::Pos& pos2, float radiusNm,
+                       const std::function<atools::geo::LineString()>& geometryFunc, const QRectF& screenRect,
+                       QVector<QPolygonF>& polylines);
+
+  /* Clear the cache */
+  void clear();
+
+  /* Has to be set before using it */
+  void setViewportParams(const Marble::ViewportParams *viewportParams);
+
+  /* Cache for registration in MapPaintWidget */
+  ProjectedGeometryCacheBase *getCache()
+  {
+    return &geometryCache;
+  }
+
+private:
+  friend uint qHash(const LineGeometryCache::Key& key);
+
+  /* Polylines in screen coordinates as calculated for the view center */
+  struct Entry
+  {
+    QVector<QPolygonF> polylines;
+    atools::geo::Pos pos1, pos2; /* Geometry at time of creation */
+    float radiusNm = 0.f;
+    atools::geo::Pos center; /* View center at time of creation */
+    QPointF centerPoint; /* Screen coordinates of the view center at time of creation */
+  };
+
+  /* Memory limit for all polylines */
+  static const int CACHE_SIZE_BYTES = 2 * 1024 * 1024;
+
+  /* Used to convert world to screen coordinates */
+  CoordinateConverter *converter = nullptr;
+  const Marble::ViewportParams *viewport = nullptr;
+  ProjectedGeometryCache<Key, Entry> geometryCache;
+};
+
+#endif // LNM_LINEGEOMETRYCACHE_H
@@ -137,7 +137,7 @@ void MapContextMenu::clear()
   qDeleteAll(actionsAndMenus);
   actionsAndMenus.clear();
 
-  result->clear();
+  result->reset();
 }
 
 int MapContextMenu::getSelectedId() const
@@ -364,31 +364,44 @@ void MapContextMenu::insertMenuOrAction(QMenu& menu, mc::MenuActionType actionTy
     menu.addMenu(subMenu);
     actionsAndMenus.append(subMenu);
 
-    // Add menu items to sub. One for each map object in index
-    for(int i = 0, idx = 0; i < index.size(); i++, idx++)
-    {
-      if(idx >= MAX_MENU_ITEMS)
-      {
-        // Overflow - create new sub-menu
-        QMenu *sub = new QMenu(tr("&More"), mainWindow);
-        subMenu->addMenu(sub);
-        subMenu->setToolTipsVisible(menu.toolTipsVisible());
-
-        // Add for later deletion
-        actionsAndMenus.append(sub);
-        subMenu = sub;
-        idx = 0;
-      }
+    // Fill sub-menu only when shown since callbacks might run costly queries for each map object
+    QObject::connect(subMenu, &QMenu::aboutToShow, subMenu,
+                     [this, subMenu, actionType, index, tip, allowNoMapObject, callback]() -> void {
+      if(subMenu->isEmpty())
+        fillSubMenu(*subMenu, actionType, index, tip, allowNoMapObject, callback);
+    });
+  }
+}
 
-      // Insert related menu item for map object
-      insertAction(*subMenu, actionType, tr("%1"), tip, QString(), QIcon(), index.at(i), true, allowNoMapObject, callback);
+void MapContextMenu::fillSubMenu(QMenu& subMenu, mc::MenuActionType actionType, const map::MapResultIndex& index,
+                                 const QString& tip, bool allowNoMapObject, const ActionCallback& callback)
+{
+  QMenu *menu = &subMenu;
+
+  // Add menu items to sub. One for each map object in index
+  for(int i = 0, idx = 0; i < index.size(); i++, idx++)
+  {
+    if(idx >= MAX_MENU_ITEMS)
+    {
+      // Overflow - create new sub-menu
+      QMenu *sub = new QMenu(tr("&More"), mainWindow);
+      menu->addMenu(sub);
+      sub->setToolTipsVisible(subMenu.toolTipsVisible());
+
+      // Add for later deletion
+      actionsAndMenus.append(sub);
+      menu = sub;
+      idx = 0;
     }
 
-    if(allowNoMapObject)
-      // Add a coordinate menu item if no map object is allowed
-      insertAction(*subMenu, actionType, tr("&Position %1").arg(Unit::coords(mapBasePos->position)), tip, QString(),
-                   QIcon(":/littlenavmap/resources/icons/coordinate.svg"), mapBasePos, true, allowNoMapObject, callback);
+    // Insert related menu item for map object
+    insertAction(*menu, actionType, tr("%1"), tip, QString(), QIcon(), index.at(i), true, allowNoMapObject, callback);
   }
+
+  if(allowNoMapObject)
+    // Add a coordinate menu item if no map object is allowed
+    insertAction(*menu, actionType, tr("&Position %1").arg(Unit::coords(mapBasePos->position)), tip, QString(),
+                 QIcon(":/littlenavmap/resources/icons/coordinate.svg"), mapBasePos, true, allowNoMapObject, callback);
 }
 
 void MapContextMenu::insertInformationMenu(QMenu& menu)
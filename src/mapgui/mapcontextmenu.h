@@ -252,11 +252,16 @@ private:
 
   /* Insert menu for given action and given map objects from index. Adds a sub-menu if needed.
    * tip is added as status tip and as tooltip if menu tooltips are enabled.
-   * allowNoMapObject Enables the menu for an empty index (click without map object) and also inserts a coordinates menu.  */
+   * allowNoMapObject Enables the menu for an empty index (click without map object) and also inserts a coordinates menu.
+   * Items of sub-menus are created when the sub-menu is opened. */
   void insertMenuOrAction(QMenu& menu, mc::MenuActionType actionType, const map::MapResultIndex& index,
                           const QString& text, const QString& tip, const QString& key, const QIcon& icon,
                           bool allowNoMapObject = false, const ActionCallback& callback = nullptr);
 
+  /* Add an item for each map object in index to the sub-menu. Called when the sub-menu is shown the first time. */
+  void fillSubMenu(QMenu& subMenu, mc::MenuActionType actionType, const map::MapResultIndex& index, const QString& tip,
+                   bool allowNoMapObject, const ActionCallback& callback);
+
   /* Insert a single action. */
   QAction *insertAction(QMenu& menu, mc::MenuActionType actionType, const QString& text, const QString& tip,
                         const QString& key, const QIcon& icon, const map::MapBase *base, bool submenu,
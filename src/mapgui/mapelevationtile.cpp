@@ -0,0 +1,127 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/mapelevationtile.h"
+
+#include "app/navapp.h"
+#include "common/elevationprovider.h"
+#include "geo/pos.h"
+
+#include <marble/ViewportParams.h>
+
+#include <QtConcurrent/QtConcurrentRun>
+
+MapElevationTile::MapElevationTile(QObject *parent)
+  : QObject(parent)
+{
+  connect(&watcher, &QFutureWatcher<QVector<float> >::finished, this, &MapElevationTile::buildFinished);
+}
+
+MapElevationTile::~MapElevationTile()
+{
+  watcher.waitForFinished();
+}
+
+bool MapElevationTile::ViewKey::operator==(const ViewKey& other) const
+{
+  return size == other.size && radius == other.radius && projection == other.projection &&
+         centerLonRad == other.centerLonRad && centerLatRad == other.centerLatRad;
+}
+
+MapElevationTile::ViewKey MapElevationTile::viewKey(const Marble::ViewportParams *viewport)
+{
+  ViewKey viewKey;
+  viewKey.size = viewport->size();
+  viewKey.centerLonRad = viewport->centerLongitude();
+  viewKey.centerLatRad = viewport->centerLatitude();
+  viewKey.radius = viewport->radius();
+  viewKey.projection = viewport->projection();
+  return viewKey;
+}
+
+bool MapElevationTile::getElevationMeter(float& elevation, int x, int y, const Marble::ViewportParams *viewport)
+{
+  ViewKey currentKey = viewKey(viewport);
+
+  if(valid && key == currentKey)
+  {
+    int col = x / CELL_SIZE, row = y / CELL_SIZE;
+    if(col >= 0 && col < columns && row >= 0 && row < rows && cellValid.at(col + row * columns))
+    {
+      elevation = elevations.at(col + row * columns);
+      return true;
+    }
+    return false;
+  }
+
+  // Start building the grid unless it is already running for this view
+  if(!watcher.isRunning() || buildKey != currentKey)
+  {
+    if(watcher.isRunning())
+      // Discard result of the outdated build
+      watcher.waitForFinished();
+
+    int cols = (currentKey.size.width() + CELL_SIZE - 1) / CELL_SIZE, rws = (currentKey.size.height() + CELL_SIZE - 1) / CELL_SIZE;
+
+    // Calculate positions at cell centers in GUI thread since viewport cannot be used in background
+    QVector<atools::geo::Pos> positions(cols * rws);
+    buildCellValid.fill(false, cols * rws);
+    for(int row = 0; row < rws; row++)
+    {
+      for(int col = 0; col < cols; col++)
+      {
+        qreal lon, lat;
+        if(viewport->geoCoordinates(col * CELL_SIZE + CELL_SIZE / 2, row * CELL_SIZE + CELL_SIZE / 2, lon, lat,
+                                    Marble::GeoDataCoordinates::Degree))
+        {
+          positions[col + row * cols] = atools::geo::Pos(lon, lat);
+          buildCellValid[col + row * cols] = true;
+        }
+      }
+    }
+
+    buildKey = currentKey;
+    watcher.setFuture(QtConcurrent::run([positions]() -> QVector<float> {
+      return NavApp::getElevationProvider()->getElevationsMeter(positions);
+    }));
+  }
+  return false;
+}
+
+void MapElevationTile::buildFinished()
+{
+  // Ignore notifications from outdated or cleared builds
+  if(watcher.isRunning() || buildKey.size.isEmpty())
+    return;
+
+  elevations = watcher.result();
+  cellValid.swap(buildCellValid);
+  key = buildKey;
+  columns = (key.size.width() + CELL_SIZE - 1) / CELL_SIZE;
+  rows = (key.size.height() + CELL_SIZE - 1) / CELL_SIZE;
+  valid = elevations.size() == columns * rows;
+}
+
+void MapElevationTile::clear()
+{
+  watcher.waitForFinished();
+  elevations.clear();
+  cellValid.clear();
+  columns = rows = 0;
+  valid = false;
+  key = buildKey = ViewKey();
+}
@@ -0,0 +1,100 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_MAPELEVATIONTILE_H
+#define LNM_MAPELEVATIONTILE_H
+
+#include <QFutureWatcher>
+#include <QObject>
+#include <QSize>
+#include <QVector>
+
+#include <marble/MarbleGlobal.h>
+
+namespace Marble {
+class ViewportParams;
+}
+
+/*
+ * Coarse grid of ground elevations covering the map widget in screen coordinates.
+ * One value is kept for each cell of CELL_SIZE pixels.
+ *
+ * Positions are calculated in the GUI thread and elevations are fetched from the GLOBE data in a
+ * background thread. Used for the elevation display under the cursor, which is then a lookup in the
+ * grid instead of a GLOBE file access on each mouse movement.
+ *
+ * The grid is rebuilt on first access after the viewport has changed.
+ */
+class MapElevationTile :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit MapElevationTile(QObject *parent);
+  virtual ~MapElevationTile() override;
+
+  MapElevationTile(const MapElevationTile& other) = delete;
+  MapElevationTile& operator=(const MapElevationTile& other) = delete;
+
+  /* Elevation in meter for the cell at the screen position.
+   * Returns false if the grid does not match the viewport. Building the grid is started in background in this case. */
+  bool getElevationMeter(float& elevation, int x, int y, const Marble::ViewportParams *viewport);
+
+  /* Drop grid, for example after changing the elevation data source */
+  void clear();
+
+  /* Cell size in pixel */
+  static Q_DECL_CONSTEXPR int CELL_SIZE = 4;
+
+private:
+  /* Identifies the viewport the grid was built for */
+  struct ViewKey
+  {
+    QSize size;
+    qreal centerLonRad = 0., centerLatRad = 0.;
+    int radius = 0;
+    Marble::Projection projection = Marble::Spherical;
+
+    bool operator==(const ViewKey& other) const;
+
+    bool operator!=(const ViewKey& other) const
+    {
+      return !(*this == other);
+    }
+
+  };
+
+  static ViewKey viewKey(const Marble::ViewportParams *viewport);
+
+  /* Called by watcher when elevations are loaded */
+  void buildFinished();
+
+  QFutureWatcher<QVector<float> > watcher;
+
+  /* Elevations in meter row by row. Invalid for cells outside of the globe. */
+  QVector<float> elevations;
+  QVector<bool> cellValid;
+  int columns = 0, rows = 0;
+  bool valid = false;
+
+  /* Key for the grid and for the running build */
+  ViewKey key, buildKey;
+  QVector<bool> buildCellValid;
+};
+
+#endif // LNM_MAPELEVATIONTILE_H
@@ -0,0 +1,206 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/mapimagebatch.h"
+
+#include "app/navapp.h"
+#include "atools.h"
+#include "exception.h"
+#include "fs/pln/flightplan.h"
+#include "fs/pln/flightplanio.h"
+#include "geo/rect.h"
+#include "mapgui/mappaintwidget.h"
+#include "mapgui/mapwidget.h"
+#include "route/route.h"
+#include "route/routecontroller.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QPixmap>
+#include <QStringBuilder>
+#include <QTextStream>
+
+MapImageBatch::MapImageBatch(QWidget *parent, RouteController *routeControllerParam)
+  : routeController(routeControllerParam)
+{
+  // Hidden map clone like the one used by the web server
+  mapPaintWidget = new MapPaintWidget(parent, false /* no real widget - hidden */);
+  mapPaintWidget->setActive();
+}
+
+MapImageBatch::~MapImageBatch()
+{
+  delete mapPaintWidget;
+}
+
+int MapImageBatch::run(const QStringList& entries, const QString& outputDir, const QSize& size)
+{
+  results.clear();
+  numberWidth = std::max(4, QString::number(entries.size()).size());
+
+  if(!outputDir.isEmpty())
+    QDir().mkpath(outputDir);
+
+  // Copy all map settings once - caches stay valid for all images
+  mapPaintWidget->copySettings(*NavApp::getMapWidgetGui());
+  mapPaintWidget->setKeepWorldRect(false);
+
+  int numSaved = 0;
+  QElapsedTimer timer;
+  for(int i = 0; i < entries.size(); i++)
+  {
+    mapbatch::BatchResult result;
+    result.entry = entries.at(i);
+    QString name;
+    atools::geo::Rect rect;
+
+    // Get rectangle from entry or load flight plan ==========================
+    timer.start();
+    if(result.entry.startsWith("rect:"))
+    {
+      QStringList coords = result.entry.mid(5).split(',');
+      if(coords.size() == 4)
+        rect = atools::geo::Rect(coords.at(0).toFloat(), coords.at(1).toFloat(), coords.at(2).toFloat(), coords.at(3).toFloat());
+      name = "rect";
+    }
+    else
+    {
+      try
+      {
+        atools::fs::pln::Flightplan flightplan;
+        atools::fs::pln::FileFormat format = atools::fs::pln::FlightplanIO().load(flightplan, result.entry);
+        routeController->loadFlightplan(flightplan, format, result.entry, false /* changed */, false /* adjustAltitude */,
+                                        false /* undo */, false /* warnAltitude */);
+        rect = NavApp::getRouteConst().getBoundingRect();
+        name = QFileInfo(result.entry).completeBaseName();
+      }
+      catch(atools::Exception& e)
+      {
+        result.error = e.what();
+      }
+    }
+    result.loadMs = timer.restart();
+
+    if(result.error.isEmpty() && !rect.isValid())
+      result.error = tr("Invalid rectangle or empty flight plan");
+
+    if(result.error.isEmpty())
+    {
+      // Render image ==========================
+      mapPaintWidget->showRectStreamlined(rect);
+      QPixmap pixmap = mapPaintWidget->getPixmap(size.width(), size.height());
+      result.renderMs = timer.restart();
+
+      // Save as PNG ==========================
+      result.filename = QDir(outputDir).absoluteFilePath(QString("%1").arg(i + 1, numberWidth, 10, QChar('0')) % "_" %
+                                                         atools::cleanFilename(name) % ".png");
+      if(pixmap.isNull())
+        result.error = tr("Rendering failed");
+      else if(!pixmap.save(result.filename, "PNG"))
+        result.error = tr("Cannot save file \"%1\"").arg(result.filename);
+      else
+        numSaved++;
+      result.saveMs = timer.restart();
+    }
+
+    qDebug() << Q_FUNC_INFO << result.entry << result.filename << result.error
+             << "load" << result.loadMs << "render" << result.renderMs << "save" << result.saveMs;
+    results.append(result);
+  }
+  return numSaved;
+}
+
+QString MapImageBatch::getReport() const
+{
+  QString report;
+  QTextStream stream(&report);
+
+  qint64 loadMs = 0L, renderMs = 0L, saveMs = 0L;
+  int numSuccess = 0;
+  for(int i = 0; i < results.size(); i++)
+  {
+    const mapbatch::BatchResult& result = results.at(i);
+    bool success = result.error.isEmpty();
+    stream << QString("%1").arg(i + 1, numberWidth, 10, QChar('0')) << (success ? " OK    " : " ERROR ")
+           << result.entry << endl;
+
+    if(success)
+      stream << "  " << tr("File: %1").arg(QDir::toNativeSeparators(result.filename)) << endl;
+    else
+      stream << "  " << result.error << endl;
+
+    stream << "  " << tr("Load: %1 ms, render: %2 ms, save: %3 ms").
+      arg(result.loadMs).arg(result.renderMs).arg(result.saveMs) << endl;
+
+    loadMs += result.loadMs;
+    renderMs += result.renderMs;
+    saveMs += result.saveMs;
+    if(success)
+      numSuccess++;
+  }
+
+  stream << tr("%1 of %2 images saved successfully.").arg(numSuccess).arg(results.size()) << endl;
+
+  if(!results.isEmpty())
+  {
+    qint64 totalMs = loadMs + renderMs + saveMs;
+    stream << tr("Total: %1 ms, load: %2 ms, render: %3 ms, save: %4 ms, average per image: %5 ms").
+      arg(totalMs).arg(loadMs).arg(renderMs).arg(saveMs).
+      arg(static_cast<double>(totalMs) / results.size(), 0, 'f', 1) << endl;
+  }
+
+  stream.flush();
+  return report;
+}
+
+QStringList MapImageBatch::readEntries(const QString& filename)
+{
+  QStringList entries;
+  QFile file(filename);
+  if(file.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    while(!stream.atEnd())
+    {
+      QString line = stream.readLine().trimmed();
+      if(!line.isEmpty() && !line.startsWith('#'))
+        entries.append(line);
+    }
+    file.close();
+  }
+  else
+    throw atools::Exception(tr("Cannot open file \"%1\". Reason: %2").arg(filename).arg(file.errorString()));
+
+  return entries;
+}
+
+QSize MapImageBatch::parseSize(const QString& sizeStr)
+{
+  QStringList size = sizeStr.toLower().split('x');
+  if(size.size() == 2)
+  {
+    bool okWidth, okHeight;
+    int width = size.at(0).toInt(&okWidth), height = size.at(1).toInt(&okHeight);
+    if(okWidth && okHeight && width > 0 && height > 0)
+      return QSize(width, height);
+  }
+  return QSize();
+}
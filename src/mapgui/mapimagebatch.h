@@ -0,0 +1,88 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_MAPIMAGEBATCH_H
+#define LNM_MAPIMAGEBATCH_H
+
+#include <QCoreApplication>
+#include <QSize>
+#include <QVector>
+
+class MapPaintWidget;
+class RouteController;
+class QWidget;
+
+namespace mapbatch {
+
+/* Result for one entry of a batch run */
+struct BatchResult
+{
+  QString entry, filename, error;
+  qint64 loadMs = 0L, renderMs = 0L, saveMs = 0L;
+};
+
+}
+
+/*
+ * Renders map images for a list of flight plan files or rectangles into PNG files without a visible map.
+ * Used by the command line option "image-batch" which can be combined with "headless" to
+ * use the Qt offscreen platform.
+ *
+ * One hidden map paint widget is used for all images to reuse the tile and query caches.
+ * Flight plans are loaded into the flight plan table one after the other since the map draws the current plan.
+ * Has to be used in the main thread.
+ */
+class MapImageBatch
+{
+  Q_DECLARE_TR_FUNCTIONS(MapImageBatch)
+
+public:
+  MapImageBatch(QWidget *parent, RouteController *routeControllerParam);
+  ~MapImageBatch();
+
+  MapImageBatch(const MapImageBatch& other) = delete;
+  MapImageBatch& operator=(const MapImageBatch& other) = delete;
+
+  /* Render all entries with the given size and save them to outputDir which is created if missing.
+   * Entries are either a flight plan file name or a rectangle "rect:leftlon,toplat,rightlon,bottomlat".
+   * Returns number of saved images. */
+  int run(const QStringList& entries, const QString& outputDir, const QSize& size);
+
+  /* Results of the last run in order of the given entries */
+  const QVector<mapbatch::BatchResult>& getResults() const
+  {
+    return results;
+  }
+
+  /* Plain text report of the last run with timings per image and totals */
+  QString getReport() const;
+
+  /* Read entries from a text file. One entry per line. Empty lines and lines starting with "#" are ignored.
+   * Throws atools::Exception if the file cannot be read. */
+  static QStringList readEntries(const QString& filename);
+
+  /* Parse size like "1920x1080". Returns invalid size on error. */
+  static QSize parseSize(const QString& sizeStr);
+
+private:
+  MapPaintWidget *mapPaintWidget;
+  RouteController *routeController;
+  QVector<mapbatch::BatchResult> results;
+  int numberWidth = 4;
+};
+
+#endif // LNM_MAPIMAGEBATCH_H
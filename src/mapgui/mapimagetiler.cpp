@@ -0,0 +1,166 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/mapimagetiler.h"
+
+#include "mapgui/mappaintwidget.h"
+
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QtMath>
+
+#include <marble/GeoDataLatLonBox.h>
+
+MapImageTiler::MapImageTiler(QWidget *parent, const MapPaintWidget& other, const QSize& sizeParam)
+  : size(sizeParam)
+{
+  // Hidden map clone - does not keep the world rectangle on resize since center and radius are set for each tile
+  paintWidget = new MapPaintWidget(parent, false /* no real widget - hidden */);
+  paintWidget->setActive();
+  paintWidget->copySettings(other);
+  paintWidget->copyView(other);
+
+  mercator = other.projection() == Marble::Mercator;
+
+  // Fit visible rectangle of other into the image =============================
+  const Marble::GeoDataLatLonBox& box = other.getCurrentViewBoundingBox();
+  double west = box.west(), east = box.east();
+  if(east < west)
+    // Crosses anti-meridian
+    east += 2. * M_PI;
+
+  double north = projectLat(box.north()), south = projectLat(box.south());
+  double width = std::max(east - west, 1.e-6), height = std::max(north - south, 1.e-6);
+
+  radius = std::max(1, static_cast<int>(std::floor(std::min(size.width() / width, size.height() / height))));
+  centerLonRad = west + width / 2.;
+  centerYRad = south + height / 2.;
+
+  // Split image into tiles =============================
+  for(int y = 0; y < size.height(); y += TILE_SIZE)
+  {
+    for(int x = 0; x < size.width(); x += TILE_SIZE)
+      tiles.append(QRect(x, y, std::min(TILE_SIZE, size.width() - x), std::min(TILE_SIZE, size.height() - y)));
+  }
+
+  qDebug() << Q_FUNC_INFO << "size" << size << "radius" << radius << "tiles" << tiles.size();
+}
+
+MapImageTiler::~MapImageTiler()
+{
+  delete paintWidget;
+}
+
+bool MapImageTiler::isTiledRenderingNeeded(const MapPaintWidget& other, const QSize& size)
+{
+  return (other.projection() == Marble::Mercator || other.projection() == Marble::Equirectangular) &&
+         (size.width() > TILE_SIZE || size.height() > TILE_SIZE);
+}
+
+double MapImageTiler::projectLat(double latRad) const
+{
+  return mercator ? std::atanh(std::sin(latRad)) : latRad;
+}
+
+double MapImageTiler::unprojectLat(double yRad) const
+{
+  return mercator ? std::atan(std::sinh(yRad)) : yRad;
+}
+
+void MapImageTiler::imageToGeo(double x, double y, double& lonDeg, double& latDeg) const
+{
+  lonDeg = qRadiansToDegrees(centerLonRad + (x - size.width() / 2.) / radius);
+  latDeg = qRadiansToDegrees(unprojectLat(centerYRad - (y - size.height() / 2.) / radius));
+
+  // Normalize longitude to -180 to 180
+  while(lonDeg > 180.)
+    lonDeg -= 360.;
+  while(lonDeg < -180.)
+    lonDeg += 360.;
+}
+
+void MapImageTiler::moveToTile(const QRect& tile)
+{
+  QRect rect = tile.adjusted(-TILE_OVERLAP, -TILE_OVERLAP, TILE_OVERLAP, TILE_OVERLAP);
+  double lonDeg, latDeg;
+  imageToGeo(rect.x() + rect.width() / 2., rect.y() + rect.height() / 2., lonDeg, latDeg);
+
+  paintWidget->resize(rect.size());
+  paintWidget->setRadius(radius);
+  paintWidget->centerOn(lonDeg, latDeg, false /* animated */);
+}
+
+void MapImageTiler::prepare()
+{
+  for(const QRect& tile : qAsConst(tiles))
+  {
+    moveToTile(tile);
+    paintWidget->prepareDraw(paintWidget->width(), paintWidget->height());
+  }
+}
+
+QImage MapImageTiler::render(const std::function<bool(int, int)>& progress)
+{
+  QImage image(size, QImage::Format_RGB32);
+  if(image.isNull())
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot allocate image" << size;
+    return image;
+  }
+
+  QPainter painter(&image);
+  for(int i = 0; i < tiles.size(); i++)
+  {
+    const QRect& tile = tiles.at(i);
+    moveToTile(tile);
+
+    // Copy tile without overlap
+    painter.drawPixmap(tile.topLeft(), paintWidget->getPixmap(),
+                       QRect(QPoint(TILE_OVERLAP, TILE_OVERLAP), tile.size()));
+
+    if(progress && !progress(i + 1, tiles.size()))
+      return QImage();
+  }
+  painter.end();
+  return image;
+}
+
+QString MapImageTiler::createAvitabJson() const
+{
+  double lon1, lat1, lon2, lat2;
+  imageToGeo(0., 0., lon1, lat1);
+  imageToGeo(size.width(), size.height(), lon2, lat2);
+
+  QJsonObject calibration;
+  calibration.insert("latitude1", lat1);
+  calibration.insert("latitude2", lat2);
+  calibration.insert("longitude1", lon1);
+  calibration.insert("longitude2", lon2);
+  calibration.insert("x1", 0.);
+  calibration.insert("x2", 1.);
+  calibration.insert("y1", 0.);
+  calibration.insert("y2", 1.);
+
+  QJsonObject calibrationObj;
+  calibrationObj.insert("calibration", calibration);
+
+  QJsonDocument doc;
+  doc.setObject(calibrationObj);
+  return doc.toJson();
+}
@@ -0,0 +1,95 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_MAPIMAGETILER_H
+#define LNM_MAPIMAGETILER_H
+
+#include <QImage>
+#include <QRect>
+#include <QVector>
+
+#include <functional>
+
+class MapPaintWidget;
+class QWidget;
+
+/*
+ * Renders large map images in tiles using a small hidden map paint widget and copies them into the resulting image.
+ * Avoids a huge widget and the related Marble and backing store buffers. Memory is bound by the result image and
+ * one tile.
+ *
+ * Only possible for cylindrical projections (Mercator and equirectangular) where moving the center by a number
+ * of pixels gives an exact offset. Tiles are rendered with an overlap to include symbols and labels near the edges.
+ * Labels longer than the overlap can be cut at the tile borders.
+ *
+ * Has to be used in the main thread since Marble widgets cannot be rendered in parallel.
+ */
+class MapImageTiler
+{
+public:
+  /* Clone settings from other and prepare to render the visible rectangle of other into an image of size */
+  MapImageTiler(QWidget *parent, const MapPaintWidget& other, const QSize& sizeParam);
+  ~MapImageTiler();
+
+  MapImageTiler(const MapImageTiler& other) = delete;
+  MapImageTiler& operator=(const MapImageTiler& other) = delete;
+
+  /* true if other uses a projection which allows tiled rendering and size exceeds the tile size */
+  static bool isTiledRenderingNeeded(const MapPaintWidget& other, const QSize& size);
+
+  /* Render all tiles without navaids to trigger map tile downloads */
+  void prepare();
+
+  /* Render all tiles into the image. progress is called with tile number and total number of tiles after each tile.
+   * Stops and returns a null image if progress returns false. */
+  QImage render(const std::function<bool(int, int)>& progress);
+
+  /* Calibration for AviTab using corners of the whole image */
+  QString createAvitabJson() const;
+
+  /* Hidden widget used to render tiles. Can be used to check download progress. */
+  MapPaintWidget *getPaintWidget() const
+  {
+    return paintWidget;
+  }
+
+private:
+  /* Move the widget to the tile given in image coordinates including overlap */
+  void moveToTile(const QRect& tile);
+
+  /* Projected y coordinate in radians for latitude and inverse. Identity for equirectangular. */
+  double projectLat(double latRad) const;
+  double unprojectLat(double yRad) const;
+
+  /* Longitude and latitude in degree for a point in image coordinates */
+  void imageToGeo(double x, double y, double& lonDeg, double& latDeg) const;
+
+  /* Tile size excluding overlap and overlap on each side in pixel */
+  static Q_DECL_CONSTEXPR int TILE_SIZE = 2048;
+  static Q_DECL_CONSTEXPR int TILE_OVERLAP = 128;
+
+  MapPaintWidget *paintWidget;
+  QSize size;
+  QVector<QRect> tiles;
+  bool mercator = true;
+
+  /* Marble radius as pixel per radian and center of the whole image in projected radians */
+  int radius = 1;
+  double centerLonRad = 0., centerYRad = 0.;
+};
+
+#endif // LNM_MAPIMAGETILER_H
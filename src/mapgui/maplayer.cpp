@@ -289,6 +289,8 @@ void MapLayer::loadFromXml(atools::util::XmlStream& xmlStream)
       userpointInfo = xmlStream.readElementTextBool();
     else if(reader.name() == "UserpointSymbolSize")
       userpointSymbolSize = xmlStream.readElementTextInt();
+    else if(reader.name() == "UserpointClusterThreshold")
+      userpointClusterThreshold = xmlStream.readElementTextInt();
     else if(reader.name() == "Vor")
       vor = xmlStream.readElementTextBool();
     else if(reader.name() == "VorIdent")
@@ -432,6 +434,7 @@ QDebug operator<<(QDebug out, const MapLayer& record)
   out << "<Userpoint>" << record.userpoint << "</Userpoint>" << endl;
   out << "<UserpointInfo>" << record.userpointInfo << "</UserpointInfo>" << endl;
   out << "<UserpointSymbolSize>" << record.userpointSymbolSize << "</UserpointSymbolSize>" << endl;
+  out << "<UserpointClusterThreshold>" << record.userpointClusterThreshold << "</UserpointClusterThreshold>" << endl;
   out << "<Vor>" << record.vor << "</Vor>" << endl;
   out << "<VorIdent>" << record.vorIdent << "</VorIdent>" << endl;
   out << "<VorInfo>" << record.vorInfo << "</VorInfo>" << endl;
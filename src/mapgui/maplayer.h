@@ -282,6 +282,12 @@ public:
     return userpointSymbolSize;
   }
 
+  /* Minimum number of userpoints in view which enables clustering. 0 disables clustering. */
+  int getUserpointClusterThreshold() const
+  {
+    return userpointClusterThreshold;
+  }
+
   bool isIls() const
   {
     return ils;
@@ -681,7 +687,7 @@ private:
   bool waypointRouteName = true;
 
   int waypointSymbolSize = 3, vorSymbolSize = 3, ndbSymbolSize = 4,
-      markerSymbolSize = 8, userpointSymbolSize = 12;
+      markerSymbolSize = 8, userpointSymbolSize = 12, userpointClusterThreshold = 0;
 
   int maximumTextLengthAirport = 16, maximumTextLengthAirportMinor = 16, maximumTextLengthUserpoint = 10;
 
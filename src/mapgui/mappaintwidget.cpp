@@ -20,9 +20,15 @@
 #include "common/aircrafttrail.h"
 #include "common/constants.h"
 #include "common/mapresult.h"
+#include "common/stallmonitor.h"
 #include "common/unit.h"
 #include "geo/calculations.h"
+#include "mapgui/airspacegeometrycache.h"
+#include "mapgui/kmlsimplifier.h"
+#include "mapgui/linegeometrycache.h"
 #include "mapgui/aprongeometrycache.h"
+#include "mapgui/projectedgeometrycache.h"
+#include "mapgui/mapprefetcher.h"
 #include "mapgui/mapscreenindex.h"
 #include "mapgui/mapthemehandler.h"
 #include "mappainter/mappaintlayer.h"
@@ -40,6 +46,11 @@
 #include <QResizeEvent>
 #include <QPaintEvent>
 #include <QFile>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include <marble/MarbleLocale.h>
 #include <marble/MarbleModel.h>
@@ -71,6 +82,13 @@ MapPaintWidget::MapPaintWidget(QWidget *parent, bool visible)
   : Marble::MarbleWidget(parent), visibleWidget(visible)
 {
   verbose = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAPWIDGET_DEBUG, false).toBool();
+  snapshotEnabled = visibleWidget &&
+                    atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_DRAG_SNAPSHOT, true).toBool();
+  sunShadingIntervalSecs =
+    std::max(atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_SUN_SHADING_INTERVAL, 300).toLongLong(), 1LL);
+  kmlSimplifyDeg = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_KML_SIMPLIFY_DEG, 0.0005).toFloat();
+  kmlSimplifyMinBytes =
+    atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_KML_SIMPLIFY_MIN_KB, 1024).toLongLong() * 1024;
 
   aircraftTrail = new AircraftTrail;
   aircraftTrailLogbook = new AircraftTrail;
@@ -98,8 +116,19 @@ MapPaintWidget::MapPaintWidget(QWidget *parent, bool visible)
   apronGeometryCache = new ApronGeometryCache();
   apronGeometryCache->setViewportParams(viewport());
 
+  airspaceGeometryCache = new AirspaceGeometryCache();
+  airspaceGeometryCache->setViewportParams(viewport());
+
+  lineGeometryCache = new LineGeometryCache();
+  lineGeometryCache->setViewportParams(viewport());
+
+  geometryCaches.append(apronGeometryCache->getCaches());
+  geometryCaches.append(airspaceGeometryCache->getCache());
+  geometryCaches.append(lineGeometryCache->getCache());
+
   mapQuery = new MapQuery(NavApp::getDatabaseSim(), NavApp::getDatabaseNav(), NavApp::getDatabaseUser());
   mapQuery->initQueries();
+  mapPrefetcher = new MapPrefetcher(this);
 
   // Set up airway queries =====================
   airwayTrackQuery = new AirwayTrackQuery(new AirwayQuery(NavApp::getDatabaseNav(), false),
@@ -118,6 +147,9 @@ MapPaintWidget::~MapPaintWidget()
 {
   removeLayer(paintLayer);
 
+  // Stop background thread before deleting queries
+  ATOOLS_DELETE_LOG(mapPrefetcher);
+
   // Have to delete manually since classes can be copied and does not delete in destructor
   airwayTrackQuery->deleteChildren();
   ATOOLS_DELETE_LOG(airwayTrackQuery);
@@ -130,6 +162,8 @@ MapPaintWidget::~MapPaintWidget()
   ATOOLS_DELETE_LOG(aircraftTrail);
   ATOOLS_DELETE_LOG(aircraftTrailLogbook);
   ATOOLS_DELETE_LOG(apronGeometryCache);
+  ATOOLS_DELETE_LOG(airspaceGeometryCache);
+  ATOOLS_DELETE_LOG(lineGeometryCache);
   ATOOLS_DELETE_LOG(mapQuery);
 }
 
@@ -278,6 +312,8 @@ void MapPaintWidget::unitsUpdated()
 
 void MapPaintWidget::optionsChanged()
 {
+  paintLayer->invalidateBaseLayer();
+  paintLayer->clearAirportDiagramCache();
   const OptionData& options = OptionData::instance();
 
   // Pass API keys or tokens to map
@@ -299,12 +335,23 @@ void MapPaintWidget::optionsChanged()
 
 void MapPaintWidget::styleChanged()
 {
+  paintLayer->invalidateBaseLayer();
+  paintLayer->clearAirportDiagramCache();
   update();
 }
 
 void MapPaintWidget::updateCacheSizes()
 {
-  quint64 volCacheKb = OptionData::instance().getCacheSizeMemoryMb() * 1000L;
+  // Keep decoded tiles for at least four times the largest screen in memory to avoid decoding
+  // tiles again when zooming on high resolution screens - about 130 MB for a 4K screen
+  quint64 screenKb = 0L;
+  for(const QScreen *screen : QGuiApplication::screens())
+  {
+    QSizeF size = QSizeF(screen->size()) * screen->devicePixelRatio();
+    screenKb = std::max(screenKb, static_cast<quint64>(size.width() * size.height() * 4. /* bytes */ * 4. / 1000.));
+  }
+
+  quint64 volCacheKb = std::max(static_cast<quint64>(OptionData::instance().getCacheSizeMemoryMb()) * 1000L, screenKb);
   if(volCacheKb != volatileTileCacheLimit())
   {
     qDebug() << "Volatile cache to" << volCacheKb << "kb";
@@ -326,6 +373,7 @@ void MapPaintWidget::setShowMapSunShading(bool show)
 
 void MapPaintWidget::weatherUpdated()
 {
+  paintLayer->invalidateBaseLayer();
   if(paintLayer->getShownMapDisplayTypes().testFlag(map::AIRPORT_WEATHER))
     update();
 
@@ -334,6 +382,7 @@ void MapPaintWidget::weatherUpdated()
 
 void MapPaintWidget::windDisplayUpdated()
 {
+  paintLayer->invalidateBaseLayer();
   if(paintLayer->getShownMapDisplayTypes().testFlag(map::WIND_BARBS) ||
      paintLayer->getShownMapDisplayTypes().testFlag(map::WIND_BARBS_ROUTE))
     update();
@@ -353,10 +402,14 @@ QDateTime MapPaintWidget::getSunShadingDateTime() const
 
 void MapPaintWidget::setSunShadingDateTime(const QDateTime& datetime)
 {
-  if(std::abs(datetime.toSecsSinceEpoch() - model()->clockDateTime().toSecsSinceEpoch()) > 300)
+  // Round down to interval so that all times within an interval give the same shading
+  qint64 secs = datetime.toSecsSinceEpoch();
+  secs -= (secs % sunShadingIntervalSecs + sunShadingIntervalSecs) % sunShadingIntervalSecs;
+
+  if(secs != model()->clockDateTime().toSecsSinceEpoch())
   {
-    // Update only if difference more than 5 minutes
-    model()->setClockDateTime(datetime);
+    // Update only if interval changed - avoids rendering all tiles again
+    model()->setClockDateTime(QDateTime::fromSecsSinceEpoch(secs, Qt::UTC));
     update();
   }
 }
@@ -421,7 +474,7 @@ QVector<map::MapRef> *MapPaintWidget::getRouteDrawnNavaids()
 
 bool MapPaintWidget::isPaintOverflow() const
 {
-  return paintLayer->isObjectOverflow() || paintLayer->isQueryOverflow();
+  return paintLayer->isObjectOverflow() || paintLayer->isQueryOverflow() || paintLayer->isFramePartial();
 }
 
 bool MapPaintWidget::isDistanceCutOff() const
@@ -475,6 +528,11 @@ bool MapPaintWidget::checkPos(const atools::geo::Pos&)
   // No-op
 }
 
+bool MapPaintWidget::isSnapshotAllowed() const
+{
+  return true;
+}
+
 map::MapTypes MapPaintWidget::getShownMapTypes() const
 {
   return paintLayer->getShownMapTypes();
@@ -505,13 +563,36 @@ ApronGeometryCache *MapPaintWidget::getApronGeometryCache()
   return apronGeometryCache;
 }
 
+AirspaceGeometryCache *MapPaintWidget::getAirspaceGeometryCache()
+{
+  return airspaceGeometryCache;
+}
+
+LineGeometryCache *MapPaintWidget::getLineGeometryCache()
+{
+  return lineGeometryCache;
+}
+
+void MapPaintWidget::clearGeometryCaches()
+{
+  for(ProjectedGeometryCacheBase *cache : qAsConst(geometryCaches))
+    cache->clear();
+}
+
+void MapPaintWidget::updateGeometryCaches()
+{
+  for(ProjectedGeometryCacheBase *cache : qAsConst(geometryCaches))
+    cache->updateViewport(viewport());
+}
+
 void MapPaintWidget::preDatabaseLoad()
 {
   jumpBackToAircraftCancel();
   cancelDragAll();
   databaseLoadStatus = true;
-  apronGeometryCache->clear();
+  clearGeometryCaches();
   paintLayer->preDatabaseLoad();
+  mapPrefetcher->preDatabaseLoad();
   mapQuery->deInitQueries();
   airwayTrackQuery->deInitQueries();
   waypointTrackQuery->deInitQueries();
@@ -528,6 +609,7 @@ void MapPaintWidget::postDatabaseLoad()
   airwayTrackQuery->initQueries();
   waypointTrackQuery->initQueries();
   mapQuery->initQueries();
+  mapPrefetcher->postDatabaseLoad();
   paintLayer->postDatabaseLoad();
   update();
   updateMapVisibleUiPostDatabaseLoad();
@@ -903,15 +985,19 @@ void MapPaintWidget::showAircraft(bool centerAircraftChecked)
 
 void MapPaintWidget::changeRouteHighlights(const QList<int>& routeHighlight)
 {
+  // Highlights are drawn by the mark painter on top of the cached base layer
   screenIndex->setRouteHighlights(routeHighlight);
-  update();
+  updateDynamic();
 }
 
 void MapPaintWidget::routeChanged(bool geometryChanged)
 {
+  LNM_STALL_SCOPE;
+
 #ifdef DEBUG_INFORMATION
   qDebug() << Q_FUNC_INFO;
 #endif
+  paintLayer->invalidateBaseLayer();
 
   if(geometryChanged)
   {
@@ -924,6 +1010,7 @@ void MapPaintWidget::routeChanged(bool geometryChanged)
 
 void MapPaintWidget::routeAltitudeChanged(float)
 {
+  paintLayer->invalidateBaseLayer();
   if(databaseLoadStatus)
     return;
 
@@ -935,6 +1022,7 @@ void MapPaintWidget::routeAltitudeChanged(float)
 void MapPaintWidget::connectedToSimulator()
 {
   qDebug() << Q_FUNC_INFO;
+  paintLayer->invalidateBaseLayer();
   jumpBackToAircraftCancel();
   update();
 }
@@ -943,6 +1031,7 @@ void MapPaintWidget::disconnectedFromSimulator()
 {
   qDebug() << Q_FUNC_INFO;
   // Clear all data on disconnect
+  paintLayer->invalidateBaseLayer();
   screenIndex->clearSimData();
   updateMapVisibleUi();
   jumpBackToAircraftCancel();
@@ -966,8 +1055,12 @@ bool MapPaintWidget::addKmlFile(const QString& kmlFile)
 void MapPaintWidget::clearKmlFiles()
 {
   for(const QString& file : qAsConst(kmlFilePaths))
-    model()->removeGeoData(file);
+    model()->removeGeoData(kmlModelFiles.value(file, file));
   kmlFilePaths.clear();
+  kmlModelFiles.clear();
+
+  // Ignore simplifications still running
+  kmlGeneration++;
 }
 
 const atools::geo::Pos& MapPaintWidget::getProfileHighlight() const
@@ -977,25 +1070,21 @@ const atools::geo::Pos& MapPaintWidget::getProfileHighlight() const
 
 void MapPaintWidget::clearSearchHighlights()
 {
-  screenIndex->changeSearchHighlights(map::MapResult());
-
-  screenIndex->updateLogEntryScreenGeometry(getCurrentViewBoundingBox());
-  screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
-  update();
+  changeSearchHighlights(map::MapResult(), true /* updateAirspace */, true /* updateLogEntries */);
 }
 
 void MapPaintWidget::clearAirspaceHighlights()
 {
   screenIndex->changeAirspaceHighlights(QList<map::MapAirspace>());
   screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
-  update();
+  updateDynamic();
 }
 
 void MapPaintWidget::clearAirwayHighlights()
 {
   screenIndex->changeAirwayHighlights(QList<QList<map::MapAirway> >());
   screenIndex->updateAirwayScreenGeometry(getCurrentViewBoundingBox());
-  update();
+  updateDynamic();
 }
 
 bool MapPaintWidget::hasHighlights() const
@@ -1036,6 +1125,7 @@ const QVector<proc::MapProcedureLegs>& MapPaintWidget::getProcedureHighlights()
 
 void MapPaintWidget::changeProcedureHighlights(const QVector<proc::MapProcedureLegs>& procedures)
 {
+  paintLayer->invalidateBaseLayer();
 #ifdef DEBUG_INFORMATION_PROC_HIGHLIGHT
   qDebug() << Q_FUNC_INFO << procedures;
 #endif
@@ -1053,6 +1143,7 @@ const proc::MapProcedureLegs& MapPaintWidget::getProcedureHighlight() const
 
 void MapPaintWidget::changeProcedureHighlight(const proc::MapProcedureLegs& procedure)
 {
+  paintLayer->invalidateBaseLayer();
 #ifdef DEBUG_INFORMATION_PROC_HIGHLIGHT
   qDebug() << Q_FUNC_INFO << procedure;
 #endif
@@ -1066,7 +1157,7 @@ void MapPaintWidget::changeProcedureHighlight(const proc::MapProcedureLegs& proc
 void MapPaintWidget::changeProcedureLegHighlight(const proc::MapProcedureLeg& procedureLeg)
 {
   screenIndex->setProcedureLegHighlight(procedureLeg);
-  update();
+  updateDynamic();
 }
 
 /* Also clicked airspaces in the info window */
@@ -1074,7 +1165,7 @@ void MapPaintWidget::changeAirspaceHighlights(const QList<map::MapAirspace>& air
 {
   screenIndex->changeAirspaceHighlights(airspaces);
   screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
-  update();
+  updateDynamic();
 }
 
 /* Also clicked airways in the info window */
@@ -1082,7 +1173,7 @@ void MapPaintWidget::changeAirwayHighlights(const QList<QList<map::MapAirway> >&
 {
   screenIndex->changeAirwayHighlights(airways);
   screenIndex->updateAirwayScreenGeometry(getCurrentViewBoundingBox());
-  update();
+  updateDynamic();
 }
 
 void MapPaintWidget::updateLogEntryScreenGeometry()
@@ -1090,14 +1181,36 @@ void MapPaintWidget::updateLogEntryScreenGeometry()
   screenIndex->updateLogEntryScreenGeometry(getCurrentViewBoundingBox());
 }
 
+void MapPaintWidget::updateFull()
+{
+  paintLayer->invalidateBaseLayer();
+  update();
+}
+
+void MapPaintWidget::updateDynamic()
+{
+  paintLayer->setDynamicUpdate();
+  update();
+}
+
 void MapPaintWidget::changeSearchHighlights(const map::MapResult& newHighlights, bool updateAirspace, bool updateLogEntries)
 {
+  // Airports of highlighted logbook entries are omitted by the airport painter - base layer has to be redrawn
+  bool logbook = screenIndex->getSearchHighlights().hasLogEntries() || newHighlights.hasLogEntries();
+
   screenIndex->changeSearchHighlights(newHighlights);
   if(updateLogEntries)
     screenIndex->updateLogEntryScreenGeometry(getCurrentViewBoundingBox());
   if(updateAirspace)
     screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
-  update();
+
+  if(logbook)
+  {
+    paintLayer->invalidateBaseLayer();
+    update();
+  }
+  else
+    updateDynamic();
 }
 
 void MapPaintWidget::changeProfileHighlight(const atools::geo::Pos& pos)
@@ -1105,7 +1218,9 @@ void MapPaintWidget::changeProfileHighlight(const atools::geo::Pos& pos)
   if(pos != screenIndex->getProfileHighlight())
   {
     screenIndex->setProfileHighlight(pos);
-    update();
+
+    // Only the mark painter has to draw the changed position on top of the cached base layer
+    updateDynamic();
   }
 }
 
@@ -1145,8 +1260,9 @@ void MapPaintWidget::postTrackLoad()
   waypointTrackQuery->clearCache();
   airwayTrackQuery->clearCache();
 
-  waypointTrackQuery->initQueries();
-  airwayTrackQuery->initQueries();
+  // Track database was rewritten - nav database queries and their caches are still valid
+  waypointTrackQuery->initTrackQueries();
+  airwayTrackQuery->initTrackQueries();
 }
 
 void MapPaintWidget::cancelDragAll()
@@ -1249,6 +1365,16 @@ const QVector<atools::fs::sc::SimConnectAircraft>& MapPaintWidget::getAiAircraft
   return screenIndex->getAiAircraft();
 }
 
+const PaintStatistics& MapPaintWidget::getPaintStatistics() const
+{
+  return paintLayer->getPaintStatistics();
+}
+
+void MapPaintWidget::resetPaintStatistics()
+{
+  paintLayer->resetPaintStatistics();
+}
+
 void MapPaintWidget::resizeEvent(QResizeEvent *event)
 {
   if(verbose)
@@ -1289,6 +1415,20 @@ void MapPaintWidget::paintEvent(QPaintEvent *paintEvent)
       return;
   }
 
+  if(snapshotEnabled && !snapshotRendering && !painting && !printing && active && isSnapshotAllowed() &&
+     NavApp::isMainWindowVisible())
+  {
+    // Move and scale the last full frame while dragging or zooming - full redraw when motion stops
+    if(viewContext() == Marble::Animation && paintFromSnapshot())
+      return;
+
+    if(viewContext() == Marble::Still)
+    {
+      paintAndStoreSnapshot();
+      return;
+    }
+  }
+
   if(!painting)
   {
     painting = true;
@@ -1330,10 +1470,22 @@ void MapPaintWidget::paintEvent(QPaintEvent *paintEvent)
       }
 
       // Erase map window to avoid black rectangle but do a dummy draw call to have everything initialized
+      // Time outside of the paint layer is mostly spent for loading, decoding and scaling texture tiles
+      const PaintLayerStatistics& frameStats = paintLayer->getPaintStatistics().getFrame();
+      quint64 framesBefore = frameStats.frames;
+      QElapsedTimer paintTimer;
+      paintTimer.start();
+
       MarbleWidget::paintEvent(paintEvent);
 
+      qint64 layerNs = frameStats.frames > framesBefore ? static_cast<qint64>(frameStats.lastTotalMs() * 1000000.) : 0L;
+      paintLayer->addBaseMapTime(paintTimer.nsecsElapsed() - layerNs);
+
       if(!NavApp::isMainWindowVisible())
         QPainter(this).fillRect(paintEvent->rect(), QGuiApplication::palette().color(QPalette::Window));
+      else if(visibleWidget && !NavApp::isStartupFinished())
+        // First real frame of the main map
+        NavApp::startupFinished();
 
       if(changed)
       {
@@ -1362,11 +1514,86 @@ void MapPaintWidget::paintEvent(QPaintEvent *paintEvent)
     qWarning() << Q_FUNC_INFO << "Recursive call to paint";
 }
 
+void MapPaintWidget::paintAndStoreSnapshot()
+{
+  qreal pixelRatio = devicePixelRatioF();
+  QSize pixmapSize = size() * pixelRatio;
+  if(snapshot.size() != pixmapSize)
+  {
+    snapshot = QPixmap(pixmapSize);
+    snapshot.setDevicePixelRatio(pixelRatio);
+  }
+
+  // Begin painter on widget before rendering since render() resets the paint device redirection of this widget
+  QPainter painter(this);
+
+  // Render calls paintEvent() again which does the normal drawing into the pixmap
+  snapshotRendering = true;
+  render(&snapshot, QPoint(), QRegion(), QWidget::DrawWindowBackground);
+  snapshotRendering = false;
+
+  snapshotCenter = atools::geo::Pos(centerLongitude(), centerLatitude());
+  snapshotDistance = distance();
+
+  painter.drawPixmap(0, 0, snapshot);
+}
+
+bool MapPaintWidget::paintFromSnapshot()
+{
+  if(snapshot.isNull() || !snapshotCenter.isValid() || snapshot.size() != size() * devicePixelRatioF() ||
+     distance() <= 0.)
+    return false;
+
+  // Scale > 1 when zooming in
+  double scale = snapshotDistance / distance();
+  if(scale < 0.25 || scale > 4.)
+    return false;
+
+  // Snapshot center was the widget center - find its current screen position
+  qreal x, y;
+  if(!screenCoordinates(snapshotCenter.getLonX(), snapshotCenter.getLatY(), x, y))
+    return false;
+
+  QSizeF targetSize = QSizeF(size()) * scale;
+  QRectF target(x - targetSize.width() / 2., y - targetSize.height() / 2., targetSize.width(), targetSize.height());
+
+  QPainter painter(this);
+  painter.fillRect(rect(), QGuiApplication::palette().color(QPalette::Window));
+  painter.drawPixmap(target, snapshot, QRectF(snapshot.rect()));
+  return true;
+}
+
+void MapPaintWidget::addKmlToModel(const QString& filename, const QString& modelFilename, bool center)
+{
+  qDebug() << Q_FUNC_INFO << filename << modelFilename;
+  kmlModelFiles.insert(filename, modelFilename);
+  model()->addGeoDataFile(modelFilename, 0, center);
+}
+
 bool MapPaintWidget::loadKml(const QString& filename, bool center)
 {
   if(QFile::exists(filename))
   {
-    model()->addGeoDataFile(filename, 0, center && OptionData::instance().getFlags() & opts::GUI_CENTER_KML);
+    bool centerKml = center && OptionData::instance().getFlags() & opts::GUI_CENTER_KML;
+    QString simplifiedFilename = KmlSimplifier::cacheFilename(filename, kmlSimplifyDeg, kmlSimplifyMinBytes);
+
+    if(simplifiedFilename.isEmpty())
+      // Small file, KMZ or simplification disabled
+      addKmlToModel(filename, filename, centerKml);
+    else
+    {
+      // Reduce points of large files in background and hand the result over to Marble when done
+      int generation = kmlGeneration;
+      QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+      connect(watcher, &QFutureWatcher<bool>::finished, this,
+              [this, watcher, filename, simplifiedFilename, centerKml, generation]() -> void {
+        if(generation == kmlGeneration && kmlFilePaths.contains(filename))
+          // Use original file if simplification failed
+          addKmlToModel(filename, watcher->result() ? simplifiedFilename : filename, centerKml);
+        watcher->deleteLater();
+      });
+      watcher->setFuture(QtConcurrent::run(&KmlSimplifier::simplifyFile, filename, simplifiedFilename, kmlSimplifyDeg));
+    }
 
     if(center)
       showAircraft(false);
@@ -1377,13 +1604,20 @@ bool MapPaintWidget::loadKml(const QString& filename, bool center)
 
 void MapPaintWidget::onlineClientAndAtcUpdated()
 {
+  paintLayer->invalidateBaseLayer();
+  // Online center geometry might have changed for the same ids
+  airspaceGeometryCache->clear();
   screenIndex->updateAirspaceScreenGeometry(currentViewBoundingBox);
+  screenIndex->resetAircraftScreenGrid();
   update();
 }
 
 void MapPaintWidget::onlineNetworkChanged()
 {
+  paintLayer->invalidateBaseLayer();
+  airspaceGeometryCache->clear();
   screenIndex->resetAirspaceOnlineScreenGeometry();
   screenIndex->updateAirspaceScreenGeometry(currentViewBoundingBox);
+  screenIndex->resetAircraftScreenGrid();
   update();
 }
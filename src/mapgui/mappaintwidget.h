@@ -58,8 +58,13 @@ class SimConnectData;
 class MainWindow;
 class MapPaintLayer;
 class MapScreenIndex;
+class AirspaceGeometryCache;
+class LineGeometryCache;
 class ApronGeometryCache;
+class ProjectedGeometryCacheBase;
 class MapQuery;
+class MapPrefetcher;
+class PaintStatistics;
 class AirwayTrackQuery;
 class WaypointTrackQuery;
 class MapLayer;
@@ -355,6 +360,14 @@ public:
   }
 
   ApronGeometryCache *getApronGeometryCache();
+  AirspaceGeometryCache *getAirspaceGeometryCache();
+  LineGeometryCache *getLineGeometryCache();
+
+  /* Clear all registered geometry caches, e.g. on database changes */
+  void clearGeometryCaches();
+
+  /* Called once per frame before painting. Clears caches depending on zoom, projection or screen size if these changed. */
+  void updateGeometryCaches();
 
   /* true if real map display widget - false if hidden for online services or other applications */
   bool isVisibleWidget() const
@@ -365,6 +378,13 @@ public:
   /* Logbook display options have changed or new or edited logbook entry */
   void updateLogEntryScreenGeometry();
 
+  /* Repaint only aircraft, ships, trail, marks and highlights on top of the cached base map.
+   * Does a full repaint if the view has changed. */
+  void updateDynamic();
+
+  /* Repaint all layers on next frame. Has to be called if data shown in the cached base map changed. */
+  void updateFull();
+
   /* For debugging functions */
   MapScreenIndex *getScreenIndex()
   {
@@ -385,6 +405,16 @@ public:
     return mapQuery;
   }
 
+  /* Loads map objects for the next view in background */
+  MapPrefetcher *getMapPrefetcher() const
+  {
+    return mapPrefetcher;
+  }
+
+  /* Timing statistics for all painters of this widget */
+  const PaintStatistics& getPaintStatistics() const;
+  void resetPaintStatistics();
+
   AirwayTrackQuery *getAirwayTrackQuery() const
   {
     return airwayTrackQuery;
@@ -413,7 +443,7 @@ public:
     return currentThemeId;
   }
 
-  /* Too many objects on map */
+  /* Too many objects on map or low priority layers deferred to a follow-up pass */
   bool isPaintOverflow() const;
 
   /* Do not show anything above this zoom distance except user features */
@@ -453,6 +483,9 @@ protected:
 
   bool loadKml(const QString& filename, bool center);
 
+  /* Hand KML file over to Marble. modelFilename is either the original or the simplified file. */
+  void addKmlToModel(const QString& filename, const QString& modelFilename, bool center);
+
   /* Set cache size from option data */
   void updateCacheSizes();
 
@@ -498,6 +531,10 @@ protected:
    * returns true if position is ok. */
   virtual bool checkPos(const atools::geo::Pos&);
 
+  /* true if the cached snapshot of the last full frame can be used while moving or zooming the map.
+   * Default is true. */
+  virtual bool isSnapshotAllowed() const;
+
   virtual void resizeEvent(QResizeEvent *event) override;
 
   void updateGeometryIndex(map::MapTypes oldTypes, map::MapDisplayTypes oldDisplayTypes, int oldMinRunwayLength);
@@ -509,6 +546,11 @@ protected:
 
   /* Caches complex X-Plane apron geometry as objects in screen coordinates for faster painting. */
   ApronGeometryCache *apronGeometryCache;
+  AirspaceGeometryCache *airspaceGeometryCache;
+  LineGeometryCache *lineGeometryCache;
+
+  /* All caches above for common clear and viewport update. Not owned. */
+  QVector<ProjectedGeometryCacheBase *> geometryCaches;
 
   /* Keep the the overlays for the GUI widget from updating */
   bool ignoreOverlayUpdates = false;
@@ -523,6 +565,16 @@ protected:
   /* Loaded KML file paths */
   QStringList kmlFilePaths;
 
+  /* Files handed over to Marble keyed by KML file path. Value differs from key if a simplified copy is used. */
+  QHash<QString, QString> kmlModelFiles;
+
+  /* Incremented on clear to drop results of KML simplifications still running in background */
+  int kmlGeneration = 0;
+
+  /* Simplify KML files larger than kmlSimplifyMinBytes with the given tolerance. Disabled if tolerance is zero. */
+  float kmlSimplifyDeg = 0.0005f;
+  qint64 kmlSimplifyMinBytes = 1024 * 1024;
+
   MapPaintLayer *paintLayer;
 
   /* Do not draw while database is unavailable */
@@ -571,6 +623,12 @@ private:
   /* Override widget events */
   virtual void paintEvent(QPaintEvent *paintEvent) override;
 
+  /* Render a full frame into the snapshot pixmap and copy it to the widget */
+  void paintAndStoreSnapshot();
+
+  /* Draw the snapshot translated and scaled to the current view. Returns false if the snapshot does not fit. */
+  bool paintFromSnapshot();
+
   void unitsUpdated();
 
   /*  Add placemark files for offline maps */
@@ -583,6 +641,7 @@ private:
   MapScreenIndex *screenIndex = nullptr;
 
   MapQuery *mapQuery = nullptr;
+  MapPrefetcher *mapPrefetcher = nullptr;
   AirwayTrackQuery *airwayTrackQuery = nullptr;
   WaypointTrackQuery *waypointTrackQuery = nullptr;
 
@@ -594,6 +653,17 @@ private:
 
   /* true if inside paint event - avoids crashes due to nested calls */
   bool painting = false;
+
+  /* Last fully rendered frame which is moved and scaled while the map is in animation context.
+   * Center position and distance are the view parameters when the snapshot was taken. */
+  QPixmap snapshot;
+  atools::geo::Pos snapshotCenter;
+  double snapshotDistance = 0.;
+  bool snapshotEnabled = false, snapshotRendering = false;
+
+  /* Sun shading time is rounded down to multiples of this interval. Marble renders all texture tiles again if
+   * the time changes. */
+  qint64 sunShadingIntervalSecs = 300L;
 };
 
 
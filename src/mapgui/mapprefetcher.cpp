@@ -0,0 +1,164 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/mapprefetcher.h"
+
+#include "common/constants.h"
+#include "mapgui/maplayer.h"
+#include "mapgui/mappaintwidget.h"
+#include "settings/settings.h"
+
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+
+using namespace Marble;
+
+/* Number of steps to extrapolate the view movement */
+const static double PREDICTION_STEPS = 2.;
+
+/* Ignore views older than this since the movement stopped */
+const static qint64 MAX_VIEW_AGE_MS = 1000;
+
+/* Ignore very small movements */
+const static double MIN_MOVEMENT_FACTOR = 0.02;
+
+MapPrefetcher::MapPrefetcher(MapPaintWidget *mapPaintWidgetParam)
+  : QObject(mapPaintWidgetParam), mapPaintWidget(mapPaintWidgetParam)
+{
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  enabled = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "Prefetch", true).toBool();
+  verbose = settings.getAndStoreValue(lnm::OPTIONS_MAPWIDGET_DEBUG, false).toBool();
+
+  // Notification from thread that it has finished and we can get the result from the future
+  connect(&watcher, &QFutureWatcher<MapQueryPrefetch>::finished, this, &MapPrefetcher::prefetchFinished);
+}
+
+MapPrefetcher::~MapPrefetcher()
+{
+  terminateThread();
+}
+
+void MapPrefetcher::preDatabaseLoad()
+{
+  databaseLoadStatus = true;
+  terminateThread();
+  lastRect.clear();
+}
+
+void MapPrefetcher::postDatabaseLoad()
+{
+  databaseLoadStatus = false;
+}
+
+void MapPrefetcher::viewUpdated(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, map::MapTypes types)
+{
+  if(!enabled || databaseLoadStatus || mapLayer == nullptr)
+    return;
+
+  GeoDataLatLonBox predicted = predictRect(rect);
+
+  lastRect = rect;
+  lastRectTimer.start();
+
+  if(predicted.isEmpty() || future.isRunning())
+    // Not moving or still busy with previous prefetch
+    return;
+
+  MapQueryPrefetch prefetch = mapPaintWidget->getMapQuery()->createPrefetch(predicted, mapLayer, types);
+  if(!prefetch.isEmpty())
+  {
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "airports" << prefetch.airportTiles.size() << "vors" << prefetch.vorTiles.size()
+               << "ndbs" << prefetch.ndbTiles.size();
+
+    terminateThreadSignal = false;
+    future = QtConcurrent::run(this, &MapPrefetcher::prefetchThread, prefetch);
+
+    // Watcher will call MapPrefetcher::prefetchFinished() when finished
+    watcher.setFuture(future);
+  }
+}
+
+void MapPrefetcher::prefetchFinished()
+{
+  if(databaseLoadStatus || terminateThreadSignal)
+    return;
+
+  mapPaintWidget->getMapQuery()->insertPrefetch(future.result());
+}
+
+MapQueryPrefetch MapPrefetcher::prefetchThread(MapQueryPrefetch prefetch)
+{
+  QThread::currentThread()->setPriority(QThread::LowPriority);
+  MapQuery::runPrefetch(prefetch, terminateThreadSignal);
+  return prefetch;
+}
+
+void MapPrefetcher::terminateThread()
+{
+  if(future.isRunning() || future.isStarted())
+  {
+    terminateThreadSignal = true;
+    future.waitForFinished();
+  }
+}
+
+Marble::GeoDataLatLonBox MapPrefetcher::predictRect(const Marble::GeoDataLatLonBox& rect) const
+{
+  if(lastRect.isEmpty() || rect.isEmpty() || !lastRectTimer.isValid() || lastRectTimer.elapsed() > MAX_VIEW_AGE_MS)
+    return GeoDataLatLonBox();
+
+  double width = rect.width(GeoDataCoordinates::Degree), height = rect.height(GeoDataCoordinates::Degree);
+  double lastWidth = lastRect.width(GeoDataCoordinates::Degree);
+  if(width < 0.0001 || lastWidth < 0.0001)
+    return GeoDataLatLonBox();
+
+  // Movement of center between last and this view
+  double dLon = rect.center().longitude(GeoDataCoordinates::Degree) - lastRect.center().longitude(GeoDataCoordinates::Degree);
+  double dLat = rect.center().latitude(GeoDataCoordinates::Degree) - lastRect.center().latitude(GeoDataCoordinates::Degree);
+
+  // Shortest way across the anti-meridian
+  if(dLon > 180.)
+    dLon -= 360.;
+  else if(dLon < -180.)
+    dLon += 360.;
+
+  // Change of size - greater than one if zooming out
+  double zoom = width / lastWidth;
+
+  if(std::abs(dLon) < width * MIN_MOVEMENT_FACTOR && std::abs(dLat) < height * MIN_MOVEMENT_FACTOR &&
+     std::abs(zoom - 1.) < MIN_MOVEMENT_FACTOR)
+    // Not moving
+    return GeoDataLatLonBox();
+
+  // Extrapolate center and size for the next steps - zooming in needs no prefetch since tiles are already loaded
+  double scale = std::max(1., std::pow(zoom, PREDICTION_STEPS));
+  double centerLon = rect.center().longitude(GeoDataCoordinates::Degree) + dLon * PREDICTION_STEPS;
+  double centerLat = rect.center().latitude(GeoDataCoordinates::Degree) + dLat * PREDICTION_STEPS;
+  double halfWidth = std::min(width * scale, 359.) / 2., halfHeight = std::min(height * scale, 179.) / 2.;
+
+  double north = std::min(centerLat + halfHeight, 90.), south = std::max(centerLat - halfHeight, -90.);
+  double east = centerLon + halfWidth, west = centerLon - halfWidth;
+
+  // Normalize to -180 to 180 - box crosses the anti-meridian if west is east of east
+  if(east > 180.)
+    east -= 360.;
+  if(west < -180.)
+    west += 360.;
+
+  return GeoDataLatLonBox(north, south, east, west, GeoDataCoordinates::Degree);
+}
@@ -0,0 +1,82 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_MAPPREFETCHER_H
+#define LNM_MAPPREFETCHER_H
+
+#include "query/mapquery.h"
+
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QObject>
+
+class MapPaintWidget;
+class MapLayer;
+
+/*
+ * Loads map objects for the next pan or zoom step in a background thread.
+ *
+ * Watches the view history of a MapPaintWidget and extrapolates the next visible rectangle from the
+ * last movement. Airport, VOR and NDB tiles covering this rectangle which are not loaded yet are fetched
+ * using separate read only database connections. The results are added to the tile caches of the
+ * MapQuery in the GUI thread so the next frame does not have to wait for SQL queries.
+ */
+class MapPrefetcher :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit MapPrefetcher(MapPaintWidget *mapPaintWidgetParam);
+  virtual ~MapPrefetcher() override;
+
+  MapPrefetcher(const MapPrefetcher& other) = delete;
+  MapPrefetcher& operator=(const MapPrefetcher& other) = delete;
+
+  /* Called after each completed paint with the visible rectangle and current layer.
+   * Starts a background prefetch if the view is moving and no other prefetch is running. */
+  void viewUpdated(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, map::MapTypes types);
+
+  /* Stop and wait for thread and ignore result. Clears view history. */
+  void preDatabaseLoad();
+  void postDatabaseLoad();
+
+private:
+  /* Called by watcher when the thread is finished */
+  void prefetchFinished();
+
+  /* Runs in background thread */
+  MapQueryPrefetch prefetchThread(MapQueryPrefetch prefetch);
+
+  /* Terminate and wait for thread */
+  void terminateThread();
+
+  /* Rectangle extrapolated from the last two views. Invalid if view did not move. */
+  Marble::GeoDataLatLonBox predictRect(const Marble::GeoDataLatLonBox& rect) const;
+
+  MapPaintWidget *mapPaintWidget;
+
+  /* Last view and time since last view */
+  Marble::GeoDataLatLonBox lastRect;
+  QElapsedTimer lastRectTimer;
+
+  QFuture<MapQueryPrefetch> future;
+  QFutureWatcher<MapQueryPrefetch> watcher;
+  bool terminateThreadSignal = false, databaseLoadStatus = false, enabled = true, verbose = false;
+};
+
+#endif // LNM_MAPPREFETCHER_H
@@ -0,0 +1,102 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/mapscreengrid.h"
+
+#include "atools.h"
+
+void MapScreenGrid::reset(const QSize& size)
+{
+  columns = std::max(size.width() / CELL_SIZE + 1, 1);
+  rows = std::max(size.height() / CELL_SIZE + 1, 1);
+
+  // Keep allocated buckets if size did not change
+  if(cells.size() != columns * rows)
+  {
+    cells.clear();
+    cells.resize(columns * rows);
+  }
+  else
+  {
+    for(QVector<int>& cell : cells)
+      cell.clear();
+  }
+  objectCount = 0;
+  valid = true;
+}
+
+void MapScreenGrid::invalidate()
+{
+  for(QVector<int>& cell : cells)
+    cell.clear();
+  objectCount = 0;
+  valid = false;
+}
+
+void MapScreenGrid::insert(int x, int y, int index)
+{
+  if(x >= 0 && y >= 0)
+  {
+    int col = x / CELL_SIZE, row = y / CELL_SIZE;
+    if(col < columns && row < rows)
+      cells[row * columns + col].append(index);
+  }
+}
+
+void MapScreenGrid::insert(const QLine& line, int index)
+{
+  insertRect(QRect(line.p1(), line.p2()).normalized(), index);
+}
+
+void MapScreenGrid::insertRect(const QRect& rect, int index)
+{
+  if(columns == 0 || rows == 0)
+    return;
+
+  if(rect.right() < 0 || rect.bottom() < 0 || rect.left() / CELL_SIZE >= columns || rect.top() / CELL_SIZE >= rows)
+    // Completely outside
+    return;
+
+  // Clip to grid - cursor position is always inside the screen
+  int col1 = atools::minmax(0, columns - 1, rect.left() / CELL_SIZE);
+  int col2 = atools::minmax(0, columns - 1, rect.right() / CELL_SIZE);
+  int row1 = atools::minmax(0, rows - 1, rect.top() / CELL_SIZE);
+  int row2 = atools::minmax(0, rows - 1, rect.bottom() / CELL_SIZE);
+
+  for(int row = row1; row <= row2; row++)
+  {
+    for(int col = col1; col <= col2; col++)
+      cells[row * columns + col].append(index);
+  }
+}
+
+void MapScreenGrid::getNearest(QVector<int>& indexes, int xs, int ys, int maxDistance) const
+{
+  if(!valid || columns == 0 || rows == 0)
+    return;
+
+  int col1 = atools::minmax(0, columns - 1, (xs - maxDistance) / CELL_SIZE);
+  int col2 = atools::minmax(0, columns - 1, (xs + maxDistance) / CELL_SIZE);
+  int row1 = atools::minmax(0, rows - 1, (ys - maxDistance) / CELL_SIZE);
+  int row2 = atools::minmax(0, rows - 1, (ys + maxDistance) / CELL_SIZE);
+
+  for(int row = row1; row <= row2; row++)
+  {
+    for(int col = col1; col <= col2; col++)
+      indexes.append(cells.at(row * columns + col));
+  }
+}
@@ -0,0 +1,79 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_MAPSCREENGRID_H
+#define LNM_MAPSCREENGRID_H
+
+#include <QLine>
+#include <QRect>
+#include <QVector>
+
+/*
+ * Uniform grid of buckets covering the map widget in screen coordinates.
+ * Each bucket keeps the indexes of all objects having their position or bounding rectangle in the cell.
+ *
+ * Used by the screen index to find objects near the cursor without converting and
+ * checking all objects on each mouse movement. Indexes refer to the list used to fill the grid.
+ */
+class MapScreenGrid
+{
+public:
+  /* Clear and prepare grid for the given screen size. Grid is valid after this call. */
+  void reset(const QSize& size);
+
+  /* Remove all objects and mark grid as invalid, i.e. it has to be rebuilt before use */
+  void invalidate();
+
+  /* Add index of object at the given screen position. Positions outside of the screen are ignored. */
+  void insert(int x, int y, int index);
+
+  /* Add index of object in all cells touching the bounding rectangle of the line. Clipped to screen. */
+  void insert(const QLine& line, int index);
+
+  /* Get indexes of all objects in cells touching the square with size 2 * maxDistance around xs and ys.
+   * Indexes of lines can appear more than once. */
+  void getNearest(QVector<int>& indexes, int xs, int ys, int maxDistance) const;
+
+  /* false if invalidated or not filled yet */
+  bool isValid() const
+  {
+    return valid;
+  }
+
+  /* Number of objects used to fill the grid. Can be used to detect changes in the source list */
+  int getObjectCount() const
+  {
+    return objectCount;
+  }
+
+  void setObjectCount(int value)
+  {
+    objectCount = value;
+  }
+
+private:
+  void insertRect(const QRect& rect, int index);
+
+  /* Cell size in pixel */
+  static Q_DECL_CONSTEXPR int CELL_SIZE = 32;
+
+  QVector<QVector<int> > cells;
+  int columns = 0, rows = 0, objectCount = 0;
+  bool valid = false;
+};
+
+#endif // LNM_MAPSCREENGRID_H
@@ -23,7 +23,9 @@
 #include "common/maptools.h"
 #include "fs/gpx/gpxtypes.h"
 #include "fs/sc/simconnectdata.h"
+#include "geo/calculations.h"
 #include "logbook/logdatacontroller.h"
+#include "mapgui/airspacegeometrycache.h"
 #include "mapgui/mapairporthandler.h"
 #include "mapgui/mapfunctions.h"
 #include "mapgui/maplayer.h"
@@ -42,6 +44,8 @@
 
 #include <marble/GeoDataLineString.h>
 
+#include <QBitArray>
+
 using atools::geo::Pos;
 using atools::geo::Line;
 using atools::geo::LineString;
@@ -55,6 +59,15 @@ using atools::fs::sc::SimConnectData;
 // Calculate averages for ground speed and turn speed for 4 seconds
 const static qint64 TURN_PATH_AVERAGE_TIME_MS = 4000L;
 
+/* Predict aircraft positions only if packets arrive slower than this */
+const static qint64 PREDICTION_MIN_INTERVAL_MS = 200L;
+
+/* Do not predict further than this into the future to avoid runaway aircraft if the simulator is paused or stalled */
+const static qint64 PREDICTION_MAX_TIME_MS = 3000L;
+
+/* Time step for integrating the turn of the user aircraft */
+const static qint64 PREDICTION_STEP_MS = 250L;
+
 template<typename TYPE>
 void assignIdAndInsert(const QString& settingsName, QHash<int, TYPE>& hash)
 {
@@ -82,6 +95,8 @@ MapScreenIndex::MapScreenIndex(MapPaintWidget *mapPaintWidgetParam, MapPaintLaye
   procedureLegHighlight = new proc::MapProcedureLeg;
   movingAverageSimAircraft = new atools::util::MovingAverageTime(TURN_PATH_AVERAGE_TIME_MS);
   profileHighlight = new atools::geo::Pos;
+
+  predictionEnabled = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_AIRCRAFT_PREDICTION, true).toBool();
 }
 
 MapScreenIndex::~MapScreenIndex()
@@ -127,7 +142,17 @@ void MapScreenIndex::copy(const MapScreenIndex& other)
   routePointsEditable = other.routePointsEditable;
   routePointsAll = other.routePointsAll;
   lastUserAircraftForAverageTs = other.lastUserAircraftForAverageTs;
+  simDataReceivedMs = other.simDataReceivedMs;
+  simDataIntervalMs = other.simDataIntervalMs;
+  predictionEnabled = other.predictionEnabled;
   routeDrawnNavaids = other.routeDrawnNavaids;
+
+  // Grids are rebuilt on demand
+  routeLineGrid.invalidate();
+  airwayLineGrid.invalidate();
+  logEntryLineGrid.invalidate();
+  ilsLineGrid.invalidate();
+  resetAircraftScreenGrid();
 }
 
 void MapScreenIndex::updateAirspaceScreenGeometryInternal(QSet<map::MapAirspaceId>& ids, map::MapAirspaceSources source,
@@ -176,10 +201,11 @@ void MapScreenIndex::updateAirspaceScreenGeometryInternal(QSet<map::MapAirspaceI
       // Check if airspace overlaps with current screen and is not already in list
       if(airspacebox.intersects(curBox) && !ids.contains(airspace->combinedId()))
       {
-        const atools::geo::LineString *lines = controller->getAirspaceGeometry(airspace->combinedId());
+        const atools::geo::LineString *lines = controller->getAirspaceGeometry(airspace->combinedId(), paintLayer->getMapLayer());
         if(lines != nullptr)
         {
-          const QVector<QPolygonF *> polys = conv.createPolygons(*lines, mapWidget->rect());
+          const QVector<QPolygonF *> polys =
+            mapWidget->getAirspaceGeometryCache()->createPolygons(airspace->combinedId(), *lines, mapWidget->rect());
           for(const QPolygonF *poly : qAsConst(polys))
           {
             // Cut off all polygon parts that are not visible on screen
@@ -203,6 +229,7 @@ void MapScreenIndex::resetIlsScreenGeometry()
 {
   ilsPolygons.clear();
   ilsLines.clear();
+  ilsLineGrid.invalidate();
 }
 
 void MapScreenIndex::updateAirspaceScreenGeometry(const Marble::GeoDataLatLonBox& curBox)
@@ -307,15 +334,16 @@ void MapScreenIndex::updateIlsScreenGeometry(const Marble::GeoDataLatLonBox& cur
     {
       updateLineScreenGeometry(ilsLines, ils.id, ils.centerLine(), curBox, conv);
 
+      // Project all boundary points at once
+      QPolygonF points;
+      QBitArray visible, hidden;
+      conv.wToSBatch(points, visible, ils.boundary(), CoordinateConverter::DEFAULT_WTOS_SIZE, &hidden);
+
       QPolygon polygon;
-      bool hidden;
-      const LineString boundary = ils.boundary();
-      for(const Pos& pos : boundary)
+      for(int i = 0; i < points.size(); i++)
       {
-        int xs, ys;
-        conv.wToS(pos, xs, ys, CoordinateConverter::DEFAULT_WTOS_SIZE, &hidden);
-        if(!hidden)
-          polygon.append(QPoint(xs, ys));
+        if(!hidden.testBit(i))
+          polygon.append(points.at(i).toPoint());
       }
       polygon = polygon.intersected(QPolygon(mapWidget->rect()));
       if(!polygon.isEmpty())
@@ -327,6 +355,7 @@ void MapScreenIndex::updateIlsScreenGeometry(const Marble::GeoDataLatLonBox& cur
 void MapScreenIndex::updateLogEntryScreenGeometry(const Marble::GeoDataLatLonBox& curBox)
 {
   logEntryLines.clear();
+  logEntryLineGrid.invalidate();
 
   const MapScale *scale = paintLayer->getMapScale();
 
@@ -368,6 +397,7 @@ void MapScreenIndex::updateAirwayScreenGeometry(const Marble::GeoDataLatLonBox&
     return;
 
   airwayLines.clear();
+  airwayLineGrid.invalidate();
 
   // Use ID set to check for duplicates between calls
   QSet<int> ids;
@@ -664,7 +694,12 @@ void MapScreenIndex::clearSimData()
 
 void MapScreenIndex::updateSimData(const atools::fs::sc::SimConnectData& data)
 {
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  simDataIntervalMs = data.getUserAircraftConst().isValid() && simDataReceivedMs > 0L ? now - simDataReceivedMs : 0L;
+  simDataReceivedMs = now;
+
   *simData = data;
+  aiAircraftGrid.invalidate();
   updateAverageTurn();
 }
 
@@ -734,6 +769,60 @@ void MapScreenIndex::getAverageGroundAndTurnSpeed(float& groundSpeedKts, float&
 #endif
 }
 
+bool MapScreenIndex::isPredictionActive() const
+{
+  return predictionEnabled && simDataIntervalMs > PREDICTION_MIN_INTERVAL_MS && simData->getUserAircraftConst().isValid() &&
+         QDateTime::currentMSecsSinceEpoch() - simDataReceivedMs < PREDICTION_MAX_TIME_MS;
+}
+
+atools::geo::PosD MapScreenIndex::getPredictedUserPosition() const
+{
+  const SimConnectUserAircraft& userAircraft = simData->getUserAircraftConst();
+  atools::geo::PosD pos = userAircraft.getPositionD();
+  float groundSpeedKts = userAircraft.getGroundSpeedKts();
+
+  if(isPredictionActive() && userAircraft.isFlying() && userAircraft.getTrackDegTrue() < atools::fs::sc::SC_INVALID_FLOAT &&
+     groundSpeedKts > 0.f && groundSpeedKts < atools::fs::sc::SC_INVALID_FLOAT)
+  {
+    float averageGroundSpeedKts, turnSpeedDegPerSec;
+    getAverageGroundAndTurnSpeed(averageGroundSpeedKts, turnSpeedDegPerSec);
+
+    // Follow the turn in small steps using half of the track change before and after each step
+    qint64 elapsedMs = QDateTime::currentMSecsSinceEpoch() - simDataReceivedMs;
+    double track = userAircraft.getTrackDegTrue();
+    atools::geo::Pos curPos = pos.asPos();
+
+    for(qint64 t = 0L; t < elapsedMs; t += PREDICTION_STEP_MS)
+    {
+      double stepSec = std::min(PREDICTION_STEP_MS, elapsedMs - t) / 1000.;
+      track += turnSpeedDegPerSec * stepSec / 2.;
+      curPos = curPos.endpointDouble(atools::geo::nmToMeter(groundSpeedKts * stepSec / 3600.), track);
+      track += turnSpeedDegPerSec * stepSec / 2.;
+    }
+    curPos.setAltitude(static_cast<float>(pos.getAltitude()));
+    pos = atools::geo::PosD(curPos);
+  }
+  return pos;
+}
+
+atools::geo::Pos MapScreenIndex::getPredictedPosition(const atools::fs::sc::SimConnectAircraft& aircraft) const
+{
+  const atools::geo::Pos& pos = aircraft.getPosition();
+  float groundSpeedKts = aircraft.getGroundSpeedKts();
+
+  if(isPredictionActive() && !aircraft.isOnGround() && groundSpeedKts > 0.f && groundSpeedKts < atools::fs::sc::SC_INVALID_FLOAT &&
+     aircraft.getHeadingDegTrue() < atools::fs::sc::SC_INVALID_FLOAT)
+  {
+    // Straight line for AI
+    double elapsedSec = (QDateTime::currentMSecsSinceEpoch() - simDataReceivedMs) / 1000.;
+    atools::geo::Pos predicted = pos.endpointDouble(atools::geo::nmToMeter(groundSpeedKts * elapsedSec / 3600.),
+                                                    aircraft.getHeadingDegTrue());
+    predicted.setAltitude(pos.getAltitude());
+    return predicted;
+  }
+  return pos;
+}
+
 void MapScreenIndex::updateLastSimData(const atools::fs::sc::SimConnectData& data)
 {
   *lastSimData = data;
@@ -757,6 +846,7 @@ void MapScreenIndex::updateRouteScreenGeometry(const Marble::GeoDataLatLonBox& c
   bool alternate = paintLayer->getShownMapDisplayTypes().testFlag(map::FLIGHTPLAN_ALTERNATE);
 
   routeLines.clear();
+  routeLineGrid.invalidate();
   routePointsEditable.clear();
   routePointsAll.clear();
 
@@ -846,14 +936,21 @@ void MapScreenIndex::getAllNearest(const QPoint& point, int maxDistance, map::Ma
   // Check for AI / multiplayer aircraft from simulator ==============================
   int x, y;
 
+  // Get candidates from screen grid around cursor instead of converting all aircraft
+  updateAircraftScreenGrid(conv);
+  const QVector<atools::fs::sc::SimConnectAircraft>& aiAircraft = simData->getAiAircraftConst();
+  QVector<int> aiIndexes;
+  aiAircraftGrid.getNearest(aiIndexes, xs, ys, maxDistance);
+
   // Add boats ======================================
   result.aiAircraft.clear();
   if(NavApp::isConnected())
   {
     if(shown & map::AIRCRAFT_AI_SHIP && mapLayer->isAiShipLarge())
     {
-      for(const atools::fs::sc::SimConnectAircraft& obj : simData->getAiAircraftConst())
+      for(int index : qAsConst(aiIndexes))
       {
+        const atools::fs::sc::SimConnectAircraft& obj = aiAircraft.at(index);
         if(obj.isValid() && obj.isAnyBoat() && (obj.getModelRadiusCorrected() * 2 > layer::LARGE_SHIP_SIZE || mapLayer->isAiShipSmall()))
         {
           if(conv.wToS(obj.getPosition(), x, y))
@@ -871,8 +968,10 @@ void MapScreenIndex::getAllNearest(const QPoint& point, int maxDistance, map::Ma
   bool hideAiOnGround = OptionData::instance().getFlags().testFlag(opts::MAP_AI_HIDE_GROUND);
 
   // Add AI or injected multiplayer aircraft ======================================
-  for(const atools::fs::sc::SimConnectAircraft& ac : mapWidget->getAiAircraft())
+  for(int index : qAsConst(aiIndexes))
   {
+    const atools::fs::sc::SimConnectAircraft& ac = aiAircraft.at(index);
+
     // Skip boats
     if(ac.isAnyBoat())
       continue;
@@ -905,8 +1004,13 @@ void MapScreenIndex::getAllNearest(const QPoint& point, int maxDistance, map::Ma
   if(onlineEnabled)
   {
     // Add online clients ======================================
-    for(const atools::fs::sc::SimConnectAircraft& obj : *NavApp::getOnlinedataController()->getAircraftFromCache())
+    const QList<atools::fs::sc::SimConnectAircraft>& onlineAircraft = *NavApp::getOnlinedataController()->getAircraftFromCache();
+    QVector<int> onlineIndexes;
+    onlineAircraftGrid.getNearest(onlineIndexes, xs, ys, maxDistance);
+
+    for(int index : qAsConst(onlineIndexes))
     {
+      const atools::fs::sc::SimConnectAircraft& obj = onlineAircraft.at(index);
       if(mapfunc::aircraftVisible(obj, mapLayer, hideAiOnGround))
       {
         if(obj.isValid() && conv.wToS(obj.getPosition(), x, y))
@@ -1264,11 +1368,72 @@ void MapScreenIndex::getNearestAirspaces(int xs, int ys, map::MapResult& result)
   }
 }
 
-QSet<int> MapScreenIndex::nearestLineIds(const QList<std::pair<int, QLine> >& lineList, int xs, int ys,
+void MapScreenIndex::updateLineScreenGrid(const QList<std::pair<int, QLine> >& lineList, MapScreenGrid& grid) const
+{
+  if(!grid.isValid() || grid.getObjectCount() != lineList.size())
+  {
+    grid.reset(mapWidget->size());
+    for(int i = 0; i < lineList.size(); i++)
+      grid.insert(lineList.at(i).second, i);
+    grid.setObjectCount(lineList.size());
+  }
+}
+
+void MapScreenIndex::updateAircraftScreenGrid(const CoordinateConverter& conv) const
+{
+  const QVector<atools::fs::sc::SimConnectAircraft>& aiAircraft = simData->getAiAircraftConst();
+  const QList<atools::fs::sc::SimConnectAircraft>& onlineAircraft = *NavApp::getOnlinedataController()->getAircraftFromCache();
+  const Marble::GeoDataLatLonBox viewBox = mapWidget->getCurrentViewBoundingBox();
+  const QSize size = mapWidget->size();
+
+  // Rebuild all if view has changed
+  bool viewChanged = viewBox != aircraftGridBox || size != aircraftGridSize;
+  aircraftGridBox = viewBox;
+  aircraftGridSize = size;
+
+  int x, y;
+  if(viewChanged || !aiAircraftGrid.isValid() || aiAircraftGrid.getObjectCount() != aiAircraft.size())
+  {
+    aiAircraftGrid.reset(size);
+    for(int i = 0; i < aiAircraft.size(); i++)
+    {
+      const atools::fs::sc::SimConnectAircraft& ac = aiAircraft.at(i);
+      if(ac.isValid() && conv.wToS(ac.getPosition(), x, y))
+        aiAircraftGrid.insert(x, y, i);
+    }
+    aiAircraftGrid.setObjectCount(aiAircraft.size());
+  }
+
+  if(viewChanged || !onlineAircraftGrid.isValid() || onlineAircraftGrid.getObjectCount() != onlineAircraft.size())
+  {
+    onlineAircraftGrid.reset(size);
+    for(int i = 0; i < onlineAircraft.size(); i++)
+    {
+      const atools::fs::sc::SimConnectAircraft& ac = onlineAircraft.at(i);
+      if(ac.isValid() && conv.wToS(ac.getPosition(), x, y))
+        onlineAircraftGrid.insert(x, y, i);
+    }
+    onlineAircraftGrid.setObjectCount(onlineAircraft.size());
+  }
+}
+
+void MapScreenIndex::resetAircraftScreenGrid()
+{
+  aiAircraftGrid.invalidate();
+  onlineAircraftGrid.invalidate();
+}
+
+QSet<int> MapScreenIndex::nearestLineIds(const QList<std::pair<int, QLine> >& lineList, MapScreenGrid& grid, int xs, int ys,
                                          int maxDistance, bool lineDistanceOnly) const
 {
+  updateLineScreenGrid(lineList, grid);
+
+  // Get only lines touching cells around cursor - can contain duplicates
+  QVector<int> indexes;
+  grid.getNearest(indexes, xs, ys, maxDistance);
+
   QSet<int> ids;
-  for(int i = 0; i < lineList.size(); i++)
+  for(int i : qAsConst(indexes))
   {
     const std::pair<int, QLine>& linePair = lineList.at(i);
     const QLine& line = linePair.second;
@@ -1299,7 +1464,7 @@ void MapScreenIndex::getNearestLogEntries(int xs, int ys, int maxDistance, map::
   if(paintLayer->getShownMapDisplayTypes().testFlag(map::LOGBOOK_DIRECT) ||
      paintLayer->getShownMapDisplayTypes().testFlag(map::LOGBOOK_ROUTE))
   {
-    const QSet<int> nearestIds = nearestLineIds(logEntryLines, xs, ys, maxDistance, false /* also distance to points */);
+    const QSet<int> nearestIds = nearestLineIds(logEntryLines, logEntryLineGrid, xs, ys, maxDistance, false /* also distance to points */);
     for(int id : nearestIds)
       maptools::insertSortedByDistance(conv, result.logbookEntries, &ids, xs, ys,
                                        NavApp::getLogdataController()->getLogEntryById(id));
@@ -1314,7 +1479,7 @@ void MapScreenIndex::getNearestIls(int xs, int ys, int maxDistance, map::MapResu
     return;
 
   // Get nearest center lines (also considering buffer)
-  QSet<int> ilsIds = nearestLineIds(ilsLines, xs, ys, maxDistance, false /* lineDistanceOnly */);
+  QSet<int> ilsIds = nearestLineIds(ilsLines, ilsLineGrid, xs, ys, maxDistance, false /* lineDistanceOnly */);
 
   // Get nearest ILS by geometry - duplicates are removed in set
   for(int i = 0; i < ilsPolygons.size(); i++)
@@ -1334,7 +1499,7 @@ void MapScreenIndex::getNearestIls(int xs, int ys, int maxDistance, map::MapResu
 void MapScreenIndex::getNearestAirways(int xs, int ys, int maxDistance, map::MapResult& result) const
 {
   AirwayTrackQuery *airwayTrackQuery = mapWidget->getAirwayTrackQuery();
-  const QSet<int> nearestIds = nearestLineIds(airwayLines, xs, ys, maxDistance, true /* lineDistanceOnly */);
+  const QSet<int> nearestIds = nearestLineIds(airwayLines, airwayLineGrid, xs, ys, maxDistance, true /* lineDistanceOnly */);
   for(int id : nearestIds)
     result.airways.append(airwayTrackQuery->getAirwayById(id));
 }
@@ -1347,7 +1512,11 @@ int MapScreenIndex::getNearestRouteLegIndex(int xs, int ys, int maxDistance) con
   int minIndex = -1;
   float minDist = std::numeric_limits<float>::max();
 
-  for(int i = 0; i < routeLines.size(); i++)
+  updateLineScreenGrid(routeLines, routeLineGrid);
+  QVector<int> indexes;
+  routeLineGrid.getNearest(indexes, xs, ys, maxDistance);
+
+  for(int i : qAsConst(indexes))
   {
     const std::pair<int, QLine>& line = routeLines.at(i);
 
@@ -19,6 +19,9 @@
 #define LITTLENAVMAP_MAPSCREENINDEX_H
 
 #include "common/mapflags.h"
+#include "mapgui/mapscreengrid.h"
+
+#include <marble/GeoDataLatLonBox.h>
 
 #include <QDateTime>
 #include <QHash>
@@ -69,10 +72,6 @@ struct PatternMarker;
 struct RangeMarker;
 }
 
-namespace Marble {
-class GeoDataLatLonBox;
-}
-
 class MapPaintWidget;
 class AirwayTrackQuery;
 class AirportQuery;
@@ -128,6 +127,9 @@ public:
 
   void updateAirspaceScreenGeometry(const Marble::GeoDataLatLonBox& curBox);
   void updateIlsScreenGeometry(const Marble::GeoDataLatLonBox& curBox);
+
+  /* Force rebuild of the screen grid for aircraft after online or simulator aircraft have changed */
+  void resetAircraftScreenGrid();
   void updateLogEntryScreenGeometry(const Marble::GeoDataLatLonBox& curBox);
 
   /* Clear internal caches */
@@ -301,6 +303,16 @@ public:
   /* Get average ground speed and turn speed in degrees per second for user aircraft. Average is calculated for 2 seconds. */
   void getAverageGroundAndTurnSpeed(float& groundSpeedKts, float& turnSpeedDegPerSec) const;
 
+  /* true if simulator packets arrive slow enough to draw predicted aircraft positions between them */
+  bool isPredictionActive() const;
+
+  /* Dead reckoning position of the user aircraft for the current time based on the last simulator packet.
+   * Uses ground speed, track and average turn speed. Returns the last position if prediction is not active. */
+  atools::geo::PosD getPredictedUserPosition() const;
+
+  /* As above for AI aircraft using ground speed and heading */
+  atools::geo::Pos getPredictedPosition(const atools::fs::sc::SimConnectAircraft& aircraft) const;
+
 private:
   void getNearestAirways(int xs, int ys, int maxDistance, map::MapResult& result) const;
   void getNearestLogEntries(int xs, int ys, int maxDistance, map::MapResult& result) const;
@@ -321,7 +333,14 @@ private:
   /* Fill average values for ground speed and turn speed for turn path display. */
   void updateAverageTurn();
 
-  QSet<int> nearestLineIds(const QList<std::pair<int, QLine> >& lineList, int xs, int ys, int maxDistance, bool lineDistanceOnly) const;
+  QSet<int> nearestLineIds(const QList<std::pair<int, QLine> >& lineList, MapScreenGrid& grid, int xs, int ys, int maxDistance,
+                           bool lineDistanceOnly) const;
+
+  /* Fill grid with bounding rectangles of lines if list has changed */
+  void updateLineScreenGrid(const QList<std::pair<int, QLine> >& lineList, MapScreenGrid& grid) const;
+
+  /* Fill grids with screen positions of simulator AI and online aircraft if view or aircraft have changed */
+  void updateAircraftScreenGrid(const CoordinateConverter& conv) const;
 
   template<typename TYPE>
   int getNearestId(int xs, int ys, int maxDistance, const QHash<int, TYPE>& typeList) const;
@@ -335,6 +354,10 @@ private:
   /* Moving average for speed and lateral angular speed. Value1 is GS and value2 is turn speed (track change per second). */
   atools::util::MovingAverageTime *movingAverageSimAircraft;
 
+  /* Local time when last simulator packet arrived and interval to previous one. Used for dead reckoning. */
+  qint64 simDataReceivedMs = 0L, simDataIntervalMs = 0L;
+  bool predictionEnabled = true;
+
   MapPaintWidget *mapWidget;
   AirportQuery *airportQuery;
   MapPaintLayer *paintLayer;
@@ -387,6 +410,14 @@ private:
   QList<std::pair<int, QPolygon> > ilsPolygons;
   QList<std::pair<int, QLine> > ilsLines; /* Index ILS center lines separately to allow
                                            * tooltips when getting the cursor near a line */
+
+  /* Screen grids for fast lookup of objects near the cursor. Grids are built on demand at first use after
+   * the respective list has changed. Indexes point into the lists above or into the aircraft lists. */
+  mutable MapScreenGrid routeLineGrid, airwayLineGrid, logEntryLineGrid, ilsLineGrid, aiAircraftGrid, onlineAircraftGrid;
+
+  /* View used to build the aircraft grids */
+  mutable Marble::GeoDataLatLonBox aircraftGridBox;
+  mutable QSize aircraftGridSize;
 };
 
 #endif // LITTLENAVMAP_MAPSCREENINDEX_H
@@ -0,0 +1,172 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/maptiledownloader.h"
+
+#include "app/navapp.h"
+#include "common/constants.h"
+#include "common/unit.h"
+#include "geo/calculations.h"
+#include "gui/dialog.h"
+#include "mapgui/mappaintwidget.h"
+#include "mapgui/mapthemehandler.h"
+#include "options/optiondata.h"
+#include "route/route.h"
+#include "settings/settings.h"
+
+#include <QApplication>
+#include <QDebug>
+#include <QProgressDialog>
+#include <QThread>
+
+#include <marble/DownloadRegion.h>
+#include <marble/GeoDataLineString.h>
+#include <marble/HttpDownloadManager.h>
+#include <marble/MarbleModel.h>
+#include <marble/TextureLayer.h>
+#include <marble/TileCoordsPyramid.h>
+
+using atools::settings::Settings;
+
+MapTileDownloader::MapTileDownloader(QWidget *parentWidget, MapPaintWidget *mapPaintWidgetParam)
+  : parent(parentWidget), mapPaintWidget(mapPaintWidgetParam)
+{
+  corridorWidthNm = Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_TILE_PREFETCH_CORRIDOR_NM, 20.).toFloat();
+  maxTiles = Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_TILE_PREFETCH_MAX_TILES, 20000).toLongLong();
+}
+
+QVector<Marble::TileCoordsPyramid> MapTileDownloader::corridorTiles(const Route& route, int minLevel, int maxLevel,
+                                                                    qint64& numTiles) const
+{
+  Marble::GeoDataLineString path;
+  for(int i = 0; i < route.size(); i++)
+  {
+    const atools::geo::Pos& pos = route.value(i).getPosition();
+    path.append(Marble::GeoDataCoordinates(pos.getLonX(), pos.getLatY(), 0., Marble::GeoDataCoordinates::Degree));
+  }
+
+  Marble::DownloadRegion region;
+  region.setMarbleModel(mapPaintWidget->model());
+  region.setVisibleTileLevel(mapPaintWidget->textureLayer()->tileZoomLevel());
+  region.setTileLevelRange(minLevel, maxLevel);
+
+  // Offset is half of the corridor width in meter
+  QVector<Marble::TileCoordsPyramid> pyramids =
+    region.fromPath(mapPaintWidget->textureLayer(), atools::geo::nmToMeter(corridorWidthNm / 2.f), path);
+
+  numTiles = 0L;
+  for(const Marble::TileCoordsPyramid& pyramid : qAsConst(pyramids))
+    numTiles += pyramid.tilesCount();
+  return pyramids;
+}
+
+void MapTileDownloader::downloadRouteCorridor(const Route& route)
+{
+  if(route.size() < 2)
+    return;
+
+  const MapTheme& theme = NavApp::getMapThemeHandler()->getTheme(mapPaintWidget->getCurrentThemeId());
+  if(!theme.isOnline() || mapPaintWidget->textureLayer() == nullptr)
+  {
+    atools::gui::Dialog::warning(parent, tr("The current map theme \"%1\" does not use online map tiles.").arg(theme.getName()));
+    return;
+  }
+
+  // Find the highest tile level fitting into the limits ======================================
+  int visibleLevel = mapPaintWidget->textureLayer()->tileZoomLevel();
+  int minLevel = std::max(0, visibleLevel - 2);
+  qint64 maxSizeKb = static_cast<qint64>(OptionData::instance().getCacheSizeDiskMb()) * 1000L;
+  qint64 numTiles = 0L;
+  QVector<Marble::TileCoordsPyramid> pyramids;
+  int maxLevel = visibleLevel + 1;
+  for(; maxLevel >= minLevel; maxLevel--)
+  {
+    pyramids = corridorTiles(route, minLevel, maxLevel, numTiles);
+    if(numTiles <= maxTiles && numTiles * TILE_SIZE_KB <= maxSizeKb)
+      break;
+  }
+
+  if(maxLevel < minLevel)
+  {
+    atools::gui::Dialog::warning(parent, tr("The flight plan corridor needs more than %L1 map tiles or more than the "
+                                            "disk cache size of %L2 MB in options.\n\n"
+                                            "Zoom out or increase the disk cache size.").
+                                 arg(maxTiles).arg(maxSizeKb / 1000L));
+    return;
+  }
+
+  qDebug() << Q_FUNC_INFO << "levels" << minLevel << maxLevel << "tiles" << numTiles;
+
+  int result = atools::gui::Dialog(parent).
+               showQuestionMsgBox(lnm::ACTIONS_SHOW_ROUTE_TILE_DOWNLOAD,
+                                  tr("<p>Download about %L1 map tiles (%L2 MB) for tile levels %3 to %4 along the flight plan "
+                                     "within a corridor of %5?</p>"
+                                     "<p>Tiles are stored in the disk cache and used when flying without "
+                                     "or with a slow internet connection.</p>").
+                                  arg(numTiles).arg(numTiles * TILE_SIZE_KB / 1000L).arg(minLevel).arg(maxLevel).
+                                  arg(Unit::distNm(corridorWidthNm)),
+                                  tr("Do not &show this dialog again and download map tiles."),
+                                  QMessageBox::Yes | QMessageBox::No, QMessageBox::No, QMessageBox::Yes);
+  if(result != QMessageBox::Yes)
+    return;
+
+  // Start download in bulk queue ======================================
+  Marble::HttpDownloadManager *downloadManager = mapPaintWidget->model()->downloadManager();
+  int activeJobs = -1, queuedJobs = -1;
+  QMetaObject::Connection connection =
+    QObject::connect(downloadManager, &Marble::HttpDownloadManager::progressChanged,
+                     [&activeJobs, &queuedJobs](int active, int queued) -> void
+  {
+    activeJobs = active;
+    queuedJobs = queued;
+  });
+
+  mapPaintWidget->downloadRegion(pyramids);
+
+  int total = static_cast<int>(numTiles);
+  QProgressDialog progress(tr("Downloading map tiles ..."), tr("&Cancel"), 0, total, parent);
+  progress.setWindowModality(Qt::WindowModal);
+  progress.setMinimumDuration(0);
+  progress.show();
+
+  // Poll download manager until all jobs are done
+  while(!progress.wasCanceled())
+  {
+    QApplication::processEvents();
+
+    if(activeJobs == 0 && queuedJobs == 0)
+      break;
+
+    if(activeJobs >= 0 && queuedJobs >= 0)
+    {
+      progress.setValue(std::max(0, total - activeJobs - queuedJobs));
+      progress.setLabelText(tr("Downloading map tiles ...\n%L1 downloads active and %L2 downloads queued.").
+                            arg(activeJobs).arg(queuedJobs));
+    }
+    QThread::msleep(100);
+  }
+
+  if(progress.wasCanceled())
+  {
+    // Drop all queued jobs
+    downloadManager->setDownloadEnabled(false);
+    downloadManager->setDownloadEnabled(true);
+  }
+  progress.setValue(total);
+
+  QObject::disconnect(connection);
+}
@@ -0,0 +1,70 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_MAPTILEDOWNLOADER_H
+#define LNM_MAPTILEDOWNLOADER_H
+
+#include <QCoreApplication>
+#include <QVector>
+
+namespace Marble {
+class TileCoordsPyramid;
+}
+
+class MapPaintWidget;
+class Route;
+class QWidget;
+
+/*
+ * Downloads map tiles of the current online map theme along a corridor around the flight plan into
+ * the Marble disk cache. Allows to use online maps on slow or metered connections while flying.
+ *
+ * Tiles are downloaded for the current tile level, two levels below and one above.
+ * Upper levels are dropped if the number of tiles exceeds the limit in the settings or the estimated size
+ * exceeds the disk cache size from the options.
+ *
+ * Uses the bulk download queue of the Marble download manager which limits the number of parallel downloads.
+ * Has to be used in the main thread.
+ */
+class MapTileDownloader
+{
+  Q_DECLARE_TR_FUNCTIONS(MapTileDownloader)
+
+public:
+  MapTileDownloader(QWidget *parentWidget, MapPaintWidget *mapPaintWidgetParam);
+
+  MapTileDownloader(const MapTileDownloader& other) = delete;
+  MapTileDownloader& operator=(const MapTileDownloader& other) = delete;
+
+  /* Asks the user for confirmation, starts the download and shows a progress dialog until all tiles are
+   * downloaded or the user cancels. */
+  void downloadRouteCorridor(const Route& route);
+
+private:
+  /* Get tiles for all levels in the range. numTiles returns the sum of tiles. */
+  QVector<Marble::TileCoordsPyramid> corridorTiles(const Route& route, int minLevel, int maxLevel, qint64& numTiles) const;
+
+  /* Rough average size of a tile in kB used to estimate disk usage */
+  static Q_DECL_CONSTEXPR qint64 TILE_SIZE_KB = 20L;
+
+  QWidget *parent;
+  MapPaintWidget *mapPaintWidget;
+  float corridorWidthNm;
+  qint64 maxTiles;
+};
+
+#endif // LNM_MAPTILEDOWNLOADER_H
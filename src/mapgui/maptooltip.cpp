@@ -24,6 +24,7 @@
 #include "gui/mainwindow.h"
 #include "mapgui/mappaintwidget.h"
 #include "options/optiondata.h"
+#include "query/querytypes.h"
 #include "route/route.h"
 #include "sql/sqlrecord.h"
 #include "util/htmlbuilder.h"
@@ -106,22 +107,12 @@ void MapTooltip::buildOneTooltipRt(atools::util::HtmlBuilder& html, bool& overfl
   }
 }
 
-QString MapTooltip::buildTooltip(const map::MapResult& mapSearchResult, const atools::geo::Pos& pos, const Route& route,
-                                 bool airportDiagram)
+void MapTooltip::buildObjectsTooltip(HtmlBuilder& html, bool& bearing, bool& distance, const map::MapResult& mapSearchResult,
+                                     const Route& route, bool airportDiagram, const HtmlInfoBuilder& info) const
 {
   optsd::DisplayTooltipOptions opts = OptionData::instance().getDisplayTooltipOptions();
-
-#ifdef DEBUG_INFORMATION
-  qDebug() << Q_FUNC_INFO << mapSearchResult;
-#endif
-
-  HtmlBuilder html(false);
-  MapPaintWidget *mapPaintWidget = NavApp::getMapPaintWidgetGui();
-  HtmlInfoBuilder info(mainWindow, mapPaintWidget, false /* infoParam */, false /* infoParam */, opts.testFlag(optsd::TOOLTIP_VERBOSE));
   int numEntries = 0;
-  bool bearing = true, // Suppress bearing for user aircraft
-       distance = true, // No distance to last flight plan leg for route legs
-       overflow = false;
+  bool overflow = false;
 
   // Append HTML text for all objects found in order of importance (airports first, etc.)
   // Objects are separated by a horizontal ruler
@@ -408,6 +399,60 @@ QString MapTooltip::buildTooltip(const map::MapResult& mapSearchResult, const at
       }
     }
   }
+}
+
+QString MapTooltip::buildTooltip(const map::MapResult& mapSearchResult, const atools::geo::Pos& pos, const Route& route,
+                                 bool airportDiagram)
+{
+  optsd::DisplayTooltipOptions opts = OptionData::instance().getDisplayTooltipOptions();
+
+#ifdef DEBUG_INFORMATION
+  qDebug() << Q_FUNC_INFO << mapSearchResult;
+#endif
+
+  HtmlBuilder html(false);
+  MapPaintWidget *mapPaintWidget = NavApp::getMapPaintWidgetGui();
+  HtmlInfoBuilder info(mainWindow, mapPaintWidget, false /* infoParam */, false /* infoParam */, opts.testFlag(optsd::TOOLTIP_VERBOSE));
+  bool bearing = true, // Suppress bearing for user aircraft
+       distance = true; // No distance to last flight plan leg for route legs
+
+  // Objects depending on cursor or aircraft position are never reused
+  bool cacheable = !mapSearchResult.hasAnyAircraft() && !mapSearchResult.trailSegment.isValid() &&
+                   !mapSearchResult.trailSegmentLog.isValid() && !mapSearchResult.windPos.isValid();
+
+  map::MapRefExtVector refs;
+  if(cacheable)
+    refs = resultRefs(mapSearchResult);
+
+  // Any data shown in the tooltip text
+  quint64 revision = query::revisionKey({query::REV_NAV_DB, query::REV_SIM_DB, query::REV_TRACKS, query::REV_USERPOINTS,
+                                         query::REV_LOGBOOK, query::REV_WEATHER, query::REV_ONLINE, query::REV_OPTIONS});
+
+  if(cacheable && !refs.isEmpty() && refs == lastRefs && airportDiagram == lastAirportDiagram &&
+     static_cast<int>(opts) == lastOptions && revision == lastRevision)
+  {
+    // Same objects under cursor - reuse object part and rebuild only bearing and distance below
+    html.append(lastHtml);
+    bearing = lastBearing;
+    distance = lastDistance;
+  }
+  else
+  {
+    buildObjectsTooltip(html, bearing, distance, mapSearchResult, route, airportDiagram, info);
+
+    if(cacheable)
+    {
+      lastRefs = refs;
+      lastHtml = html.getHtml();
+      lastBearing = bearing;
+      lastDistance = distance;
+      lastAirportDiagram = airportDiagram;
+      lastOptions = static_cast<int>(opts);
+      lastRevision = revision;
+    }
+    else
+      clearCache();
+  }
 
   // Prepend distance and bearing information ================================
   QString str;
@@ -433,6 +478,49 @@ QString MapTooltip::buildTooltip(const map::MapResult& mapSearchResult, const at
 
 }
 
+void MapTooltip::clearCache()
+{
+  lastRefs.clear();
+  lastHtml.clear();
+}
+
+template<typename TYPE>
+void appendRefs(map::MapRefExtVector& refs, const QList<TYPE>& list)
+{
+  for(const TYPE& obj : list)
+    refs.append(map::MapRefExt(obj.id, obj.position, obj.objType));
+}
+
+map::MapRefExtVector MapTooltip::resultRefs(const map::MapResult& result)
+{
+  map::MapRefExtVector refs;
+  appendRefs(refs, result.airports);
+  appendRefs(refs, result.runways);
+  appendRefs(refs, result.runwayEnds);
+  appendRefs(refs, result.towers);
+  appendRefs(refs, result.parkings);
+  appendRefs(refs, result.helipads);
+  appendRefs(refs, result.waypoints);
+  appendRefs(refs, result.vors);
+  appendRefs(refs, result.ndbs);
+  appendRefs(refs, result.markers);
+  appendRefs(refs, result.ils);
+  appendRefs(refs, result.airways);
+  appendRefs(refs, result.airspaces);
+  appendRefs(refs, result.userpointsRoute);
+  appendRefs(refs, result.userpoints);
+  appendRefs(refs, result.logbookEntries);
+  appendRefs(refs, result.patternMarks);
+  appendRefs(refs, result.rangeMarks);
+  appendRefs(refs, result.distanceMarks);
+  appendRefs(refs, result.holdingMarks);
+  appendRefs(refs, result.msaMarks);
+  appendRefs(refs, result.holdings);
+  appendRefs(refs, result.airportMsa);
+  appendRefs(refs, result.procPoints);
+  return refs;
+}
+
 /* Check if the result HTML has more than the allowed number of lines and add a "more" text */
 bool MapTooltip::checkText(HtmlBuilder& html) const
 {
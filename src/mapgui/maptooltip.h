@@ -18,6 +18,8 @@
 #ifndef LITTLENAVMAP_MAPTOOLTIP_H
 #define LITTLENAVMAP_MAPTOOLTIP_H
 
+#include "common/maptypes.h"
+
 #include <QColor>
 #include <QCoreApplication>
 
@@ -70,7 +72,17 @@ public:
   QString buildTooltip(const map::MapResult& mapSearchResult, const atools::geo::Pos& pos,
                        const Route& route, bool airportDiagram);
 
+  /* Forget the last object tooltip. Call if the content of map objects changed, like flight plan or userpoints. */
+  void clearCache();
+
 private:
+  /* Build HTML for all objects excluding bearing and distance header */
+  void buildObjectsTooltip(atools::util::HtmlBuilder& html, bool& bearing, bool& distance, const map::MapResult& mapSearchResult,
+                           const Route& route, bool airportDiagram, const HtmlInfoBuilder& info) const;
+
+  /* Id, type and position of all objects in result. Used as key for the object tooltip. */
+  static map::MapRefExtVector resultRefs(const map::MapResult& result);
+
   bool checkText(atools::util::HtmlBuilder& html) const;
 
   template<typename TYPE>
@@ -85,6 +97,13 @@ private:
   MainWindow *mainWindow = nullptr;
   WeatherReporter *weather;
 
+  /* Object part of the last tooltip which is reused if the same objects are under the cursor */
+  map::MapRefExtVector lastRefs;
+  QString lastHtml;
+  bool lastBearing = true, lastDistance = true, lastAirportDiagram = false;
+  int lastOptions = 0;
+  quint64 lastRevision = 0L;
+
 };
 
 #endif // LITTLENAVMAP_MAPTOOLTIP_H
@@ -46,9 +46,62 @@ MapVisible::~MapVisible()
 
 }
 
+bool MapVisible::Summary::operator==(const Summary& other) const
+{
+  return simDbEmpty == other.simDbEmpty && render == other.render && connected == other.connected &&
+         onlineActive == other.onlineActive && gls == other.gls && mora == other.mora && windShown == other.windShown &&
+         layer == other.layer && shown == other.shown && shownDisplay == other.shownDisplay &&
+         airspaceSources == other.airspaceSources && airspaceTypes == other.airspaceTypes &&
+         weatherSource == other.weatherSource && minRunwayLength == other.minRunwayLength &&
+         windSource == other.windSource && windLevel == other.windLevel && onlineNetwork == other.onlineNetwork &&
+         userpointTypes == other.userpointTypes && markTypes == other.markTypes;
+}
+
+MapVisible::Summary MapVisible::collectSummary() const
+{
+  Summary summary;
+  summary.simDbEmpty = simDbEmpty;
+  summary.layer = paintLayer->getMapLayer();
+  summary.render = summary.layer != nullptr && !paintLayer->noRender();
+
+  if(!simDbEmpty && summary.render)
+  {
+    summary.shown = paintLayer->getShownMapTypes();
+    summary.shownDisplay = paintLayer->getShownMapDisplayTypes();
+    summary.minRunwayLength = NavApp::getMapAirportHandler()->getMinimumRunwayFt();
+    summary.gls = NavApp::getMapQueryGui()->hasGls();
+    summary.mora = NavApp::getMoraReader()->isDataAvailable();
+    summary.airspaceSources = NavApp::getAirspaceController()->getAirspaceSources();
+    summary.airspaceTypes = paintLayer->getShownAirspacesTypesByLayer().types;
+    summary.connected = NavApp::isConnected();
+    summary.onlineActive = NavApp::isOnlineNetworkActive();
+    if(summary.onlineActive)
+      summary.onlineNetwork = NavApp::getOnlineNetworkTranslated();
+    summary.weatherSource = paintLayer->getWeatherSource();
+
+    WindReporter *windReporter = NavApp::getWindReporter();
+    summary.windShown = windReporter->isWindShown();
+    summary.windSource = static_cast<int>(windReporter->getSource());
+    summary.windLevel = windReporter->getLevelText();
+
+    if(summary.layer->isUserpoint())
+      summary.userpointTypes = NavApp::getUserdataController()->getSelectedTypes();
+    summary.markTypes = NavApp::getMapMarkHandler()->getMarkTypesText();
+  }
+  return summary;
+}
+
 /* Update the visible objects indication in the status bar. */
 void MapVisible::updateVisibleObjectsStatusBar()
 {
+  // Called after each major map change like zooming or panning - avoid rebuilding the tooltip if nothing changed
+  Summary summary = collectSummary();
+  if(summaryValid && summary == lastSummary)
+    return;
+
+  lastSummary = summary;
+  summaryValid = true;
+
   if(simDbEmpty)
   {
     NavApp::getMainWindow()->setMapObjectsShownMessageText(
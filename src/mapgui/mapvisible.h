@@ -18,9 +18,13 @@
 #ifndef MAPVISIBLEOBJECTSTATUS_H
 #define MAPVISIBLEOBJECTSTATUS_H
 
+#include "common/mapflags.h"
+
 #include <QCoreApplication>
+#include <QStringList>
 
 class MapPaintLayer;
+class MapLayer;
 
 /* Update the shown map object types depending on action status (toolbar or menu) */
 class MapVisible
@@ -32,13 +36,50 @@ public:
   MapVisible(MapPaintLayer *paintLayerParam);
   ~MapVisible();
 
+  /* Rebuilds text and tooltip only if the summary of shown objects has changed since the last call */
   void updateVisibleObjectsStatusBar();
 
+  /* Force rebuild on next update, e.g. after the label was overwritten or options were changed */
+  void invalidate()
+  {
+    summaryValid = false;
+  }
+
   void postDatabaseLoad();
 
 private:
+  /* All values which are used to build the status bar label and tooltip.
+   * Only cheap getters are used to fill this since the summary is collected after each major map change. */
+  struct Summary
+  {
+    bool simDbEmpty = false, render = false, connected = false, onlineActive = false, gls = false, mora = false,
+         windShown = false;
+    const MapLayer *layer = nullptr;
+    map::MapTypes shown;
+    map::MapDisplayTypes shownDisplay;
+    map::MapAirspaceSources airspaceSources;
+    map::MapAirspaceTypes airspaceTypes;
+    map::MapWeatherSource weatherSource = map::WEATHER_SOURCE_DISABLED;
+    int minRunwayLength = 0, windSource = 0;
+    QString windLevel, onlineNetwork;
+    QStringList userpointTypes, markTypes;
+
+    bool operator==(const Summary& other) const;
+
+    bool operator!=(const Summary& other) const
+    {
+      return !(*this == other);
+    }
+
+  };
+
+  Summary collectSummary() const;
+
   MapPaintLayer *paintLayer;
   bool simDbEmpty = false;
+
+  Summary lastSummary;
+  bool summaryValid = false;
 };
 
 #endif // MAPVISIBLEOBJECTSTATUS_H
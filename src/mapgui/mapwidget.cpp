@@ -22,6 +22,7 @@
 #include "common/elevationprovider.h"
 #include "common/jumpback.h"
 #include "common/mapcolors.h"
+#include "common/stallmonitor.h"
 #include "common/symbolpainter.h"
 #include "common/unit.h"
 #include "connect/connectclient.h"
@@ -43,6 +44,7 @@
 #include "mapgui/mapairporthandler.h"
 #include "mapgui/mapcontextmenu.h"
 #include "mapgui/mapdetailhandler.h"
+#include "mapgui/mapelevationtile.h"
 #include "mapgui/maplayersettings.h"
 #include "mapgui/mapmarkhandler.h"
 #include "mapgui/mapscreenindex.h"
@@ -93,6 +95,9 @@ Q_DECLARE_TYPEINFO(SimUpdateDelta, Q_PRIMITIVE_TYPE);
 
 const static qreal SIM_UPDATE_CLOSE_KM = 1.;
 
+/* Request full simulator update rate for takeoff and landing detection below this altitude */
+const static float LOGBOOK_FULL_RATE_AGL_FT = 1000.f;
+
 // Update rates defined by delta values for higher zoom distances
 const static QHash<opts::SimUpdateRate, SimUpdateDelta> SIM_UPDATE_DELTA_MAP(
 {
@@ -157,9 +162,17 @@ const int LANDING_TIMEOUT_MS = 4000;
 const int TAKEOFF_TIMEOUT_MS = 2000;
 const int FUEL_ON_OFF_TIMEOUT_MS = 1000;
 
+/* Repaint interval and minimum screen movement for the predicted aircraft position between simulator updates */
+const int AIRCRAFT_PREDICTION_TIMER_MS = 50;
+const int AIRCRAFT_PREDICTION_MIN_PIXEL = 2;
+
 /* Update rate on tooltip for bearing display */
 const int MAX_SIM_UPDATE_TOOLTIP_MS = 500;
 
+/* Delay for building a new tooltip while one is already shown. Restarted on each tooltip event
+ * to avoid building tooltips for intermediate positions while moving the mouse */
+const int TOOLTIP_UPDATE_DELAY_MS = 50;
+
 /* Disable center waypoint and aircraft if distance to flight plan is larger */
 const float MAX_FLIGHT_PLAN_DIST_FOR_CENTER_NM = 50.f;
 
@@ -175,7 +188,6 @@ MapWidget::MapWidget(MainWindow *parent)
 {
   takeoffLandingLastAircraft = new atools::fs::sc::SimConnectUserAircraft;
   mapSearchResultTooltip = new map::MapResult;
-  mapSearchResultTooltipLast = new map::MapResult;
   mapSearchResultInfoClick = new map::MapResult;
   distanceMarkerBackup = new map::DistanceMarker;
   userpointDrag = new map::MapUserpoint;
@@ -203,6 +215,7 @@ MapWidget::MapWidget(MainWindow *parent)
   elevationDisplayTimer.setInterval(ALTITUDE_UPDATE_TIMEOUT_MS);
   elevationDisplayTimer.setSingleShot(true);
   connect(&elevationDisplayTimer, &QTimer::timeout, this, &MapWidget::elevationDisplayTimerTimeout);
+  elevationTile = new MapElevationTile(this);
 
   jumpBack = new JumpBack(this, atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_JUMP_BACK_DEBUG, false).toBool());
   connect(jumpBack, &JumpBack::jumpBack, this, &MapWidget::jumpBackToAircraftTimeout);
@@ -213,10 +226,21 @@ MapWidget::MapWidget(MainWindow *parent)
   fuelOnOffTimer.setSingleShot(true);
   connect(&fuelOnOffTimer, &QTimer::timeout, this, &MapWidget::fuelOnOffTimeout);
 
+  aircraftPredictionTimer.setInterval(AIRCRAFT_PREDICTION_TIMER_MS);
+  connect(&aircraftPredictionTimer, &QTimer::timeout, this, &MapWidget::aircraftPredictionTimeout);
+
   resetPaintForDragTimer.setSingleShot(true);
   resetPaintForDragTimer.setInterval(200);
   connect(&resetPaintForDragTimer, &QTimer::timeout, this, &MapWidget::resetPaintForDrag);
 
+  wheelZoomStillTimer.setSingleShot(true);
+  wheelZoomStillTimer.setInterval(200);
+  connect(&wheelZoomStillTimer, &QTimer::timeout, this, &MapWidget::wheelZoomStillTimeout);
+
+  tooltipUpdateTimer.setSingleShot(true);
+  tooltipUpdateTimer.setInterval(TOOLTIP_UPDATE_DELAY_MS);
+  connect(&tooltipUpdateTimer, &QTimer::timeout, this, &MapWidget::tooltipUpdateTimeout);
+
   // Fill overlay / action map ============================
   // "Compass" id "compass"
   // "License" id "license"
@@ -229,25 +253,33 @@ MapWidget::MapWidget(MainWindow *parent)
   mapOverlays.insert("overviewmap", mainWindow->getUi()->actionMapOverlayOverview);
 
   mapVisible = new MapVisible(paintLayer);
+
+  // Label is overwritten by main window - rebuild on next update
+  connect(this, &MapPaintWidget::resultTruncated, this, [this]() -> void {
+    mapVisible->invalidate();
+  });
 }
 
 MapWidget::~MapWidget()
 {
   resetPaintForDragTimer.stop();
+  wheelZoomStillTimer.stop();
+  tooltipUpdateTimer.stop();
   elevationDisplayTimer.stop();
   takeoffLandingTimer.stop();
   fuelOnOffTimer.stop();
+  aircraftPredictionTimer.stop();
 
   qDebug() << Q_FUNC_INFO << "removeEventFilter";
   removeEventFilter(this);
 
   ATOOLS_DELETE_LOG(jumpBack);
+  ATOOLS_DELETE_LOG(elevationTile);
   ATOOLS_DELETE_LOG(mapTooltip);
   ATOOLS_DELETE_LOG(mapVisible);
   ATOOLS_DELETE_LOG(pushButtonExitFullscreen);
   ATOOLS_DELETE_LOG(takeoffLandingLastAircraft);
   ATOOLS_DELETE_LOG(mapSearchResultTooltip);
-  ATOOLS_DELETE_LOG(mapSearchResultTooltipLast);
   ATOOLS_DELETE_LOG(mapSearchResultInfoClick);
   ATOOLS_DELETE_LOG(distanceMarkerBackup);
   ATOOLS_DELETE_LOG(userpointDrag);
@@ -341,7 +373,7 @@ void MapWidget::handleInfoClick(const QPoint& point)
     NavApp::getRouteController()->debugNetworkClick(Pos(lon, lat));
 #endif
 
-  mapSearchResultInfoClick->clear();
+  mapSearchResultInfoClick->reset();
   getScreenIndexConst()->getAllNearest(point, screenSearchDistance, *mapSearchResultInfoClick, map::QUERY_NONE /* For double click */);
 
   // Removes the online aircraft from onlineAircraft which also have a simulator shadow in simAircraft
@@ -439,6 +471,26 @@ void MapWidget::fuelOnOffTimeout()
   }
 }
 
+void MapWidget::aircraftPredictionTimeout()
+{
+  const MapScreenIndex *screenIndex = getScreenIndexConst();
+  if(!screenIndex->isPredictionActive() || !NavApp::isConnected())
+  {
+    aircraftPredictionTimer.stop();
+    return;
+  }
+
+  // Repaint only if the predicted position moved noticeably on the screen
+  CoordinateConverter conv(viewport());
+  bool visible = false;
+  QPoint point = conv.wToS(screenIndex->getPredictedUserPosition().asPos(), CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
+  if(visible && (point - lastPredictionPoint).manhattanLength() >= AIRCRAFT_PREDICTION_MIN_PIXEL)
+  {
+    lastPredictionPoint = point;
+    updateDynamic();
+  }
+}
+
 void MapWidget::jumpBackToAircraftStart()
 {
 #ifdef DEBUG_INFORMATION_JUMPBACK
@@ -519,11 +571,11 @@ bool MapWidget::event(QEvent *event)
         qDebug() << Q_FUNC_INFO << "tooltipGlobalPos" << tooltipGlobalPos;
 #endif
 
-        // Update result set - fetch all near cursor
-        updateTooltipResult();
-
-        // Build HTML
-        showTooltip(false /* update */);
+        if(QToolTip::isVisible())
+          // Mouse moved while tooltip is shown - delay update and drop pending one
+          tooltipUpdateTimer.start();
+        else
+          tooltipUpdateTimeout();
         event->accept();
         return true;
       }
@@ -533,6 +585,23 @@ bool MapWidget::event(QEvent *event)
   return QWidget::event(event);
 }
 
+void MapWidget::tooltipUpdateTimeout()
+{
+  if(!tooltipGlobalPos.isNull())
+  {
+    // Update result set - fetch all near cursor
+    updateTooltipResult();
+
+    // Build HTML
+    showTooltip(false /* update */);
+  }
+}
+
+void MapWidget::clearTooltipCache()
+{
+  mapTooltip->clearCache();
+}
+
 void MapWidget::updateTooltipResult()
 {
   // Get map objects for tooltip ===========================================================================
@@ -557,7 +626,7 @@ void MapWidget::updateTooltipResult()
     queryTypes |= map::QUERY_AIRCRAFT_TRAIL_LOG;
 
   // Load tooltip data into mapSearchResultTooltip
-  *mapSearchResultTooltip = map::MapResult();
+  mapSearchResultTooltip->reset();
   getScreenIndexConst()->getAllNearest(mapFromGlobal(tooltipGlobalPos), screenSearchDistanceTooltip, *mapSearchResultTooltip, queryTypes);
 
   NavApp::getOnlinedataController()->removeOnlineShadowedAircraft(mapSearchResultTooltip->onlineAircraft,
@@ -570,6 +639,7 @@ void MapWidget::hideTooltip()
   // This affects and hides tooltips across the whole application
   QToolTip::showText(tooltipGlobalPos, QString(), this);
 
+  tooltipUpdateTimer.stop();
   tooltipGlobalPos = QPoint();
 }
 
@@ -589,6 +659,9 @@ void MapWidget::updateTooltip()
 
 void MapWidget::showTooltip(bool update)
 {
+  // Cached object part of the tooltip is dropped by MapTooltip if weather or other data has changed
+  Q_UNUSED(update)
+
   if(databaseLoadStatus || noRender())
     return;
 
@@ -605,7 +678,6 @@ void MapWidget::showTooltip(bool update)
     map::AircraftTrailSegment trailSegment;
     if(geoCoordinates(point.x(), point.y(), lon, lat))
     {
-      // Build a new tooltip HTML for weather changes or aircraft updates
       QString text;
       if(paintLayer->getMapLayer() != nullptr)
         text = mapTooltip->buildTooltip(*mapSearchResultTooltip, atools::geo::Pos(lon, lat), NavApp::getRouteConst(),
@@ -1253,7 +1325,15 @@ void MapWidget::wheelEvent(QWheelEvent *event)
         if(reverse)
           directionIn = !directionIn;
 
-        zoomInOut(directionIn, event->modifiers() == Qt::ShiftModifier /* smooth */);
+        bool smooth = event->modifiers() == Qt::ShiftModifier;
+        zoomInOut(directionIn, smooth);
+
+        if(!smooth)
+        {
+          // Scale the last full frame while zooming with the wheel and redraw all when zooming stops
+          setViewContext(Marble::Animation);
+          wheelZoomStillTimer.start();
+        }
 
         // Get global coordinates of cursor in new zoom level
         qreal lon2, lat2;
@@ -1394,8 +1474,13 @@ void MapWidget::elevationDisplayTimerTimeout()
   {
     if(geoCoordinates(point.x(), point.y(), lon, lat, Marble::GeoDataCoordinates::Degree))
     {
+      // Use elevation grid of the current view if available - falls back to GLOBE data and builds the grid
       Pos pos(lon, lat);
-      pos.setAltitude(NavApp::getElevationProvider()->getElevationMeter(pos));
+      float elevation;
+      if(elevationTile->getElevationMeter(elevation, point.x(), point.y(), viewport()))
+        pos.setAltitude(elevation);
+      else
+        pos.setAltitude(NavApp::getElevationProvider()->getElevationMeter(pos));
       mainWindow->updateMapPosLabel(pos, point.x(), point.y());
     }
   }
@@ -1741,6 +1826,22 @@ void MapWidget::resetPaintForDrag()
   }
 }
 
+void MapWidget::wheelZoomStillTimeout()
+{
+  // Do a full redraw with all details after wheel zooming if not dragging anything
+  if(viewContext() == Marble::Animation && mouseState == mw::NONE)
+  {
+    setViewContext(Marble::Still);
+    update();
+  }
+}
+
+bool MapWidget::isSnapshotAllowed() const
+{
+  // Dragged objects like flight plan rubber bands have to be drawn live
+  return mouseState == mw::NONE;
+}
+
 void MapWidget::fillDistanceMarker(map::DistanceMarker& distanceMarker, const atools::geo::Pos& pos, const map::MapResult& result)
 {
   fillDistanceMarker(distanceMarker, pos,
@@ -2399,6 +2500,8 @@ void MapWidget::showGridConfiguration()
 
 void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorData)
 {
+  LNM_STALL_SCOPE;
+
   using atools::almostNotEqual;
   using atools::geo::angleAbsDiff;
 
@@ -2427,6 +2530,15 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
   qDebug() << Q_FUNC_INFO << "=========================================================";
 #endif
 
+  // Start interpolated repaints between updates if the simulator sends slowly
+  if(getScreenIndexConst()->isPredictionActive())
+  {
+    if(!aircraftPredictionTimer.isActive())
+      aircraftPredictionTimer.start();
+  }
+  else
+    aircraftPredictionTimer.stop();
+
   // Create screen coordinates =============================
   CoordinateConverter conv(viewport());
   bool visible = false;
@@ -2463,6 +2575,11 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
   qDebug() << "widgetRectSmall" << widgetRectSmall;
 #endif
 
+  // Takeoff and landing detection for logbook needs accurate data on and close to the ground
+  NavApp::getConnectClient()->setRateDemand(ConnectClient::RATE_DEMAND_LOGBOOK,
+                                            aircraft.isOnGround() || aircraft.getAltitudeAboveGroundFt() < LOGBOOK_FULL_RATE_AGL_FT ||
+                                            takeoffLandingTimer.isActive());
+
   bool pruned = aircraftTrail->appendTrailPos(aircraft, true /* allowSplit */);
   pruned |= aircraftTrailLogbook->appendTrailPos(aircraft, false /* allowSplit */);
 
@@ -2490,7 +2607,7 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
     bool updateBearing = NavApp::isConnectedAndAircraft();
 
     // Aircraft moved away from cursor or nothing in current result
-    bool aircraftDisappeared = mapSearchResultTooltip->isEmpty() && mapSearchResultTooltipLast->hasAnyAircraft();
+    bool aircraftDisappeared = mapSearchResultTooltip->isEmpty() && tooltipLastHasAircraft;
 
     // Nothing found at all or aircraft moved away from cursor
     // This affects and hides tooltips across the whole application and should not be used on each update
@@ -2502,7 +2619,7 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
       showTooltip(true /* update */);
 
     // Remember last result to detech disappearing aircraft
-    *mapSearchResultTooltipLast = *mapSearchResultTooltip;
+    tooltipLastHasAircraft = mapSearchResultTooltip->hasAnyAircraft();
   }
 
   // ================================================================================
@@ -2536,6 +2653,9 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
       }
     }
 
+    // Full simulator update rate is only needed if any aircraft is shown or map follows the aircraft
+    NavApp::getConnectClient()->setRateDemand(ConnectClient::RATE_DEMAND_MAP, visible || aiVisible || centerAircraftChecked);
+
     // Check if position has changed significantly
     bool posHasChanged = !lastAircraft.isValid() || // No previous position
                          aircraftPointDiff.manhattanLength() >= deltas.manhattanLengthDelta; // Screen position has changed
@@ -2573,6 +2693,14 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
     const Route& route = NavApp::getRouteConst();
     const RouteLeg *activeLeg = route.getActiveLeg();
 
+    // Active and passed legs are drawn in the cached base layer
+    if(route.getActiveLegIndex() != lastActiveLegIndex)
+    {
+      lastActiveLegIndex = route.getActiveLegIndex();
+      paintLayer->invalidateBaseLayer();
+      dataHasChanged = true;
+    }
+
     // Get position of next waypoint and check visibility
     Pos nextWpPos;
     QPoint nextWpPoint;
@@ -2799,8 +2927,8 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
     // touchdownDetected = false;
 
     if((dataHasChanged || aiVisible) && !contextMenuActive)
-      // Not scrolled or zoomed but needs a redraw
-      update();
+      // Not scrolled or zoomed but needs a redraw - base map is reused if view did not change
+      updateDynamic();
 
     if(!updatesEnabled())
       setUpdatesEnabled(true);
@@ -2991,6 +3119,12 @@ void MapWidget::optionsChanged()
 {
   screenSearchDistance = OptionData::instance().getMapClickSensitivity();
   screenSearchDistanceTooltip = OptionData::instance().getMapTooltipSensitivity();
+
+  // Elevation data source might have changed
+  elevationTile->clear();
+
+  // Units and layer settings might have changed
+  mapVisible->invalidate();
   MapPaintWidget::optionsChanged();
 }
 
@@ -3094,6 +3228,10 @@ void MapWidget::restoreState()
     aircraftTrail->restoreState(lnm::AIRCRAFT_TRACK_SUFFIX);
   aircraftTrail->setMaxTrackEntries(OptionData::instance().getAircraftTrailMaxPoints());
 
+  // Write new trail positions to journal to avoid loss on crash
+  if(settings.getAndStoreValue(lnm::SETTINGS_AIRCRAFT_TRAIL + "Journal", true).toBool())
+    aircraftTrail->startJournal(lnm::AIRCRAFT_TRACK_SUFFIX);
+
   aircraftTrailLogbook->restoreState(lnm::LOGBOOK_TRACK_SUFFIX);
   aircraftTrailLogbook->setMaxTrackEntries(OptionData::instance().getAircraftTrailMaxPoints());
 
@@ -28,6 +28,7 @@
 
 class JumpBack;
 class MainWindow;
+class MapElevationTile;
 class MapTooltip;
 class MapVisible;
 class QContextMenuEvent;
@@ -123,6 +124,9 @@ public:
   /* Called from weather reporter */
   void updateTooltip();
 
+  /* Called if flight plan, userpoints or logbook changed. Rebuilds the next tooltip completely. */
+  void clearTooltipCache();
+
   /* The main window show event was triggered after program startup. */
   void mainWindowShown();
 
@@ -340,6 +344,7 @@ private:
   void sunShadingToUi(map::MapSunShading sunShading);
 
   virtual bool checkPos(const atools::geo::Pos& pos) override;
+  virtual bool isSnapshotAllowed() const override;
 
   virtual void resizeEvent(QResizeEvent *event) override;
 
@@ -367,6 +372,9 @@ private:
   /* Full redraw after timout when drag and drop to avoid missing objects while moving rubber band */
   void resetPaintForDrag();
 
+  /* Full redraw after wheel zooming stopped */
+  void wheelZoomStillTimeout();
+
   /* Display elevation at mouse cursor after a short timeout */
   void elevationDisplayTimerTimeout();
 
@@ -386,6 +394,9 @@ private:
   void takeoffLandingTimeout();
   void fuelOnOffTimeout();
 
+  /* Repaint map if the predicted aircraft position moved between simulator updates */
+  void aircraftPredictionTimeout();
+
   void simDataCalcTakeoffLanding(const atools::fs::sc::SimConnectUserAircraft& aircraft,
                                  const atools::fs::sc::SimConnectUserAircraft& last);
   void simDataCalcFuelOnOff(const atools::fs::sc::SimConnectUserAircraft& aircraft,
@@ -426,6 +437,9 @@ private:
   virtual void hideTooltip() override;
   void updateTooltipResult();
 
+  /* Fetch objects and build tooltip for last position. Called directly or by tooltipUpdateTimer. */
+  void tooltipUpdateTimeout();
+
   virtual void handleHistory() override;
   virtual void updateShowAircraftUi(bool centerAircraftChecked) override;
 
@@ -467,6 +481,9 @@ private:
   /* Do a full redraw after timout when using drag and drop */
   QTimer resetPaintForDragTimer;
 
+  /* Calls MapWidget::wheelZoomStillTimeout() */
+  QTimer wheelZoomStillTimer;
+
   /* Fixed points of route drag which will not move with the mouse */
   atools::geo::LineString routeDragFixed;
 
@@ -480,7 +497,11 @@ private:
 
   /* Save last tooltip position. If invalid/null no tooltip will be shown */
   QPoint tooltipGlobalPos;
-  map::MapResult *mapSearchResultTooltip, *mapSearchResultTooltipLast, *mapSearchResultInfoClick;
+  /* Result objects are reused and reset on each query to avoid allocating on every mouse move */
+  map::MapResult *mapSearchResultTooltip, *mapSearchResultInfoClick;
+
+  /* Last tooltip result contained aircraft. Used to detect disappearing aircraft. */
+  bool tooltipLastHasAircraft = false;
 
   MapTooltip *mapTooltip;
 
@@ -495,10 +516,23 @@ private:
   /* Delay display of elevation display to avoid lagging mouse movements */
   QTimer elevationDisplayTimer;
 
+  /* Elevations for the current view to avoid GLOBE file access for the cursor elevation display */
+  MapElevationTile *elevationTile;
+
   /* Delay takeoff and landing messages to avoid false recognition of bumpy landings.
    * Calls MapWidget::takeoffLandingTimeout()  */
   QTimer takeoffLandingTimer, fuelOnOffTimer;
 
+  /* Drives repaints between simulator updates to show the predicted aircraft position.
+   * Calls MapWidget::aircraftPredictionTimeout() */
+  QTimer aircraftPredictionTimer;
+
+  /* Coalesces tooltip events while moving the mouse. Calls MapWidget::tooltipUpdateTimeout() */
+  QTimer tooltipUpdateTimer;
+
+  /* Screen position of the predicted user aircraft at last repaint */
+  QPoint lastPredictionPoint;
+
   /* Flown distance from takeoff event */
   double takeoffLandingDistanceNm = 0.;
 
@@ -523,6 +557,9 @@ private:
 
   /* Used to check for simulator aircraft updates */
   qint64 lastSimUpdateMs = 0L;
+
+  /* Repaint base layer if active leg changes */
+  int lastActiveLegIndex = map::INVALID_INDEX_VALUE;
   qint64 lastCenterAcAndWp = 0L;
   qint64 lastSimUpdateTooltipMs = 0L;
 
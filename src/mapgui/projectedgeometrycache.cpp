@@ -0,0 +1,42 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/projectedgeometrycache.h"
+
+#include <marble/ViewportParams.h>
+
+bool ProjectedGeometryCacheBase::updateViewport(const Marble::ViewportParams *viewport)
+{
+  bool changed = viewport->radius() != lastRadius || viewport->projection() != lastProjection || viewport->size() != lastSize;
+
+  lastRadius = viewport->radius();
+  lastProjection = viewport->projection();
+  lastSize = viewport->size();
+
+  if(changed && clearOnViewChange)
+  {
+    // Zoom, projection or screen size have changed - all cached coordinates are invalid
+    clear();
+    return true;
+  }
+  return false;
+}
+
+bool ProjectedGeometryCacheBase::isFlatProjection() const
+{
+  return lastProjection == Marble::Mercator || lastProjection == Marble::Equirectangular;
+}
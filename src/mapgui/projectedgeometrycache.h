@@ -0,0 +1,136 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_PROJECTEDGEOMETRYCACHE_H
+#define LNM_PROJECTEDGEOMETRYCACHE_H
+
+#include <QCache>
+#include <QPainterPath>
+#include <QPolygonF>
+#include <QSize>
+
+namespace Marble {
+class ViewportParams;
+}
+
+namespace geocache {
+
+/* Approximate memory used by geometry in bytes for cache cost calculation */
+inline int sizeBytes(const QPainterPath& path)
+{
+  return static_cast<int>(sizeof(QPainterPath) + static_cast<size_t>(path.elementCount()) * sizeof(QPainterPath::Element));
+}
+
+inline int sizeBytes(const QPolygonF& polygon)
+{
+  return static_cast<int>(sizeof(QPolygonF) + static_cast<size_t>(polygon.size()) * sizeof(QPointF));
+}
+
+inline int sizeBytes(const QVector<QPolygonF>& polygons)
+{
+  int size = static_cast<int>(sizeof(QVector<QPolygonF>));
+  for(const QPolygonF& polygon : polygons)
+    size += sizeBytes(polygon);
+  return size;
+}
+
+}
+
+/*
+ * Base for all caches keeping geometry in screen coordinates.
+ *
+ * All caches are registered in MapPaintWidget which calls updateViewport() once per frame and clear() on
+ * database or data changes. Caches created with clearOnViewChange are cleared if zoom, projection or screen size change.
+ */
+class ProjectedGeometryCacheBase
+{
+public:
+  explicit ProjectedGeometryCacheBase(bool clearOnViewChangeParam)
+    : clearOnViewChange(clearOnViewChangeParam)
+  {
+  }
+
+  virtual ~ProjectedGeometryCacheBase()
+  {
+  }
+
+  /* Remove all entries */
+  virtual void clear() = 0;
+
+  /* Total cost of all entries in bytes */
+  virtual int getSizeBytes() const = 0;
+
+  /* Clear cache if the view has changed and the cache depends on it. Returns true if cleared. */
+  bool updateViewport(const Marble::ViewportParams *viewport);
+
+  /* True if a pan only translates screen coordinates. This is the case for Mercator and Equirectangular. */
+  bool isFlatProjection() const;
+
+protected:
+  bool clearOnViewChange;
+
+  /* View parameters used to detect changes which need a clear */
+  int lastRadius = 0, lastProjection = -1;
+  QSize lastSize;
+};
+
+/*
+ * Generic LRU cache for screen geometry like QPainterPath or QPolygonF which uses memory size in bytes as cost.
+ * KEY needs qHash() and operator==. Geometry is usually stored relative to a reference point and translated for drawing.
+ */
+template<typename KEY, typename T>
+class ProjectedGeometryCache :
+  public ProjectedGeometryCacheBase
+{
+public:
+  ProjectedGeometryCache(int maxSizeBytes, bool clearOnViewChangeParam)
+    : ProjectedGeometryCacheBase(clearOnViewChangeParam), cache(maxSizeBytes)
+  {
+  }
+
+  /* Get geometry or null if not found. Pointer is valid until next insert. */
+  T *object(const KEY& key) const
+  {
+    return cache.object(key);
+  }
+
+  /* Insert and take ownership. sizeBytes is usually calculated with one of the geocache::sizeBytes() functions. */
+  void insert(const KEY& key, T *geometry, int sizeBytes)
+  {
+    cache.insert(key, geometry, std::max(1, sizeBytes));
+  }
+
+  void remove(const KEY& key)
+  {
+    cache.remove(key);
+  }
+
+  virtual void clear() override
+  {
+    cache.clear();
+  }
+
+  virtual int getSizeBytes() const override
+  {
+    return cache.totalCost();
+  }
+
+private:
+  QCache<KEY, T> cache;
+};
+
+#endif // LNM_PROJECTEDGEOMETRYCACHE_H
@@ -0,0 +1,128 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mappainter/gpulayerrenderer.h"
+
+#include <QDebug>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLPaintDevice>
+
+GpuLayerRenderer::GpuLayerRenderer(int samples)
+  : numSamples(samples)
+{
+  QSurfaceFormat format;
+  format.setSamples(0); // Multisampling is done in the framebuffer
+  format.setAlphaBufferSize(8);
+  format.setStencilBufferSize(8);
+
+  surface = new QOffscreenSurface();
+  surface->setFormat(format);
+  surface->create();
+
+  context = new QOpenGLContext();
+  context->setFormat(format);
+
+  if(!surface->isValid() || !context->create() || !context->makeCurrent(surface))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot create OpenGL context. Using raster painting.";
+    delete context;
+    context = nullptr;
+    delete surface;
+    surface = nullptr;
+  }
+  else
+  {
+    qInfo() << Q_FUNC_INFO << "OpenGL" << context->format().majorVersion() << context->format().minorVersion()
+            << "samples" << numSamples << "renderer"
+            << reinterpret_cast<const char *>(context->functions()->glGetString(GL_RENDERER));
+    context->doneCurrent();
+  }
+}
+
+GpuLayerRenderer::~GpuLayerRenderer()
+{
+  if(context != nullptr && context->makeCurrent(surface))
+  {
+    releaseFramebuffer();
+    context->doneCurrent();
+  }
+
+  delete context;
+  delete surface;
+}
+
+void GpuLayerRenderer::releaseFramebuffer()
+{
+  delete paintDevice;
+  paintDevice = nullptr;
+  delete framebuffer;
+  framebuffer = nullptr;
+}
+
+QPaintDevice *GpuLayerRenderer::begin(const QSize& size, qreal pixelRatio)
+{
+  if(context == nullptr || !context->makeCurrent(surface))
+    return nullptr;
+
+  QSize pixelSize = size * pixelRatio;
+  if(framebuffer == nullptr || framebuffer->size() != pixelSize)
+  {
+    // Size changed - recreate buffer and device
+    releaseFramebuffer();
+
+    QOpenGLFramebufferObjectFormat format;
+    format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+    format.setSamples(numSamples);
+    framebuffer = new QOpenGLFramebufferObject(pixelSize, format);
+    paintDevice = new QOpenGLPaintDevice(pixelSize);
+
+    if(!framebuffer->isValid())
+    {
+      qWarning() << Q_FUNC_INFO << "Invalid framebuffer for size" << pixelSize;
+      releaseFramebuffer();
+      context->doneCurrent();
+      return nullptr;
+    }
+  }
+
+  devicePixelRatio = pixelRatio;
+  paintDevice->setDevicePixelRatio(pixelRatio);
+
+  framebuffer->bind();
+  QOpenGLFunctions *functions = context->functions();
+  functions->glClearColor(0.f, 0.f, 0.f, 0.f);
+  functions->glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+  return paintDevice;
+}
+
+QImage GpuLayerRenderer::end()
+{
+  QImage image;
+  if(context != nullptr && framebuffer != nullptr)
+  {
+    // Resolves multisampling and converts to premultiplied ARGB
+    image = framebuffer->toImage().convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(devicePixelRatio);
+    framebuffer->release();
+    context->doneCurrent();
+  }
+  return image;
+}
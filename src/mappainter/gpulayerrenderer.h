@@ -0,0 +1,73 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_GPULAYERRENDERER_H
+#define LNM_GPULAYERRENDERER_H
+
+#include <QImage>
+
+class QOffscreenSurface;
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+class QOpenGLPaintDevice;
+class QPaintDevice;
+
+/*
+ * Renders map layers through the OpenGL paint engine of QPainter into an offscreen multisampled framebuffer.
+ *
+ * Paths, polygons, transparent fills and pixmaps are rasterized and batched by the GPU instead of the raster engine.
+ * Context, surface and framebuffer are kept across frames and the framebuffer is only recreated on size changes.
+ * The result is read back into an image which is then composited like the raster layer images.
+ *
+ * GUI thread only. isValid() returns false if no OpenGL context could be created and callers have to fall back
+ * to raster painting.
+ */
+class GpuLayerRenderer
+{
+public:
+  /* samples is the number of multisampling samples for antialiasing. 0 disables multisampling. */
+  explicit GpuLayerRenderer(int samples);
+  ~GpuLayerRenderer();
+
+  GpuLayerRenderer(const GpuLayerRenderer& other) = delete;
+  GpuLayerRenderer& operator=(const GpuLayerRenderer& other) = delete;
+
+  /* true if OpenGL context and surface were created successfully */
+  bool isValid() const
+  {
+    return context != nullptr;
+  }
+
+  /* Make context current, bind and clear framebuffer. Size is in device independent pixels.
+   * Returns the paint device for a QPainter or null on error. A painter on the device has to be ended before end(). */
+  QPaintDevice *begin(const QSize& size, qreal pixelRatio);
+
+  /* Read back the framebuffer into an image with the pixel ratio given in begin() and release the context */
+  QImage end();
+
+private:
+  void releaseFramebuffer();
+
+  QOffscreenSurface *surface = nullptr;
+  QOpenGLContext *context = nullptr;
+  QOpenGLFramebufferObject *framebuffer = nullptr;
+  QOpenGLPaintDevice *paintDevice = nullptr;
+  qreal devicePixelRatio = 1.;
+  int numSamples = 4;
+};
+
+#endif // LNM_GPULAYERRENDERER_H
@@ -0,0 +1,96 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mappainter/labelplacement.h"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+void LabelPlacement::submit(const QRectF& rect, int priority, const DrawFunc& drawFunc)
+{
+  candidates.append({rect, priority, candidates.size(), drawFunc});
+}
+
+void LabelPlacement::clear()
+{
+  candidates.clear();
+  placed.clear();
+  grid.clear();
+}
+
+int LabelPlacement::flush(QPainter *painter)
+{
+  // Higher priority first - keep submission order for equal priority which is the drawing order of the painters
+  std::sort(candidates.begin(), candidates.end(), [](const Candidate& c1, const Candidate& c2) -> bool {
+    return c1.priority == c2.priority ? c1.index < c2.index : c1.priority > c2.priority;
+  });
+
+  int drawn = 0;
+  for(const Candidate& candidate : qAsConst(candidates))
+  {
+    // Flight plan labels are always shown
+    if(candidate.priority < label::ROUTE && collides(candidate.rect))
+      continue;
+
+    occupy(candidate.rect);
+    candidate.drawFunc(painter);
+    drawn++;
+  }
+
+  clear();
+  return drawn;
+}
+
+bool LabelPlacement::collides(const QRectF& rect) const
+{
+  int x1 = static_cast<int>(std::floor(rect.left() / CELL_SIZE)), x2 = static_cast<int>(std::floor(rect.right() / CELL_SIZE));
+  int y1 = static_cast<int>(std::floor(rect.top() / CELL_SIZE)), y2 = static_cast<int>(std::floor(rect.bottom() / CELL_SIZE));
+
+  for(int x = x1; x <= x2; x++)
+  {
+    for(int y = y1; y <= y2; y++)
+    {
+      auto it = grid.constFind(cellKey(x, y));
+      if(it != grid.constEnd())
+      {
+        for(int index : it.value())
+        {
+          if(placed.at(index).intersects(rect))
+            return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+void LabelPlacement::occupy(const QRectF& rect)
+{
+  int index = placed.size();
+  placed.append(rect);
+
+  int x1 = static_cast<int>(std::floor(rect.left() / CELL_SIZE)), x2 = static_cast<int>(std::floor(rect.right() / CELL_SIZE));
+  int y1 = static_cast<int>(std::floor(rect.top() / CELL_SIZE)), y2 = static_cast<int>(std::floor(rect.bottom() / CELL_SIZE));
+
+  for(int x = x1; x <= x2; x++)
+  {
+    for(int y = y1; y <= y2; y++)
+      grid[cellKey(x, y)].append(index);
+  }
+}
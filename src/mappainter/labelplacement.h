@@ -0,0 +1,101 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_LABELPLACEMENT_H
+#define LNM_LABELPLACEMENT_H
+
+#include <QHash>
+#include <QRectF>
+#include <QVector>
+
+#include <functional>
+
+class QPainter;
+
+namespace label {
+
+/* Priorities for label candidates. Higher values win if labels overlap. */
+enum Priority
+{
+  WAYPOINT = 10,
+  NDB = 20,
+  VOR = 30,
+  USERPOINT = 40,
+  AIRPORT = 50,
+  ROUTE = 100 /* Flight plan labels are always drawn but block others */
+};
+
+}
+
+/*
+ * Collects map label candidates from all painters and draws only the ones not overlapping a label of higher priority.
+ *
+ * Painters submit a screen rectangle, a priority and a function which draws the label. flush() sorts the candidates
+ * by priority, keeping submission order within the same priority, and tests each one against the already placed
+ * labels using a screen space hash grid. Only labels not colliding are drawn.
+ *
+ * Owned by the paint layer and referenced in the PaintContext. Cleared for each rendered frame.
+ */
+class LabelPlacement
+{
+public:
+  typedef std::function<void (QPainter *painter)> DrawFunc;
+
+  /* Queue a label candidate. rect is the screen area in logical pixels covered by the label including background. */
+  void submit(const QRectF& rect, int priority, const DrawFunc& drawFunc);
+
+  /* Place and draw all candidates and clear the list. Returns number of labels drawn. */
+  int flush(QPainter *painter);
+
+  /* Drop all candidates without drawing */
+  void clear();
+
+  bool isEmpty() const
+  {
+    return candidates.isEmpty();
+  }
+
+private:
+  struct Candidate
+  {
+    QRectF rect;
+    int priority, index;
+    DrawFunc drawFunc;
+  };
+
+  /* Check occupied cells for overlap */
+  bool collides(const QRectF& rect) const;
+
+  /* Insert rectangle into all cells it covers */
+  void occupy(const QRectF& rect);
+
+  static quint64 cellKey(int x, int y)
+  {
+    return static_cast<quint64>(static_cast<quint32>(x)) << 32 | static_cast<quint32>(y);
+  }
+
+  /* Cell size of the hash grid in pixels. About the size of a two line label. */
+  static Q_DECL_CONSTEXPR int CELL_SIZE = 32;
+
+  QVector<Candidate> candidates;
+
+  /* Placed rectangles and grid cell to indexes into placed */
+  QVector<QRectF> placed;
+  QHash<quint64, QVector<int> > grid;
+};
+
+#endif // LNM_LABELPLACEMENT_H
@@ -20,6 +20,7 @@
 #include "mapgui/mappaintwidget.h"
 #include "mapgui/mapscale.h"
 #include "app/navapp.h"
+#include "common/symbolatlas.h"
 #include "common/symbolpainter.h"
 #include "geo/calculations.h"
 #include "common/mapcolors.h"
@@ -142,11 +143,13 @@ MapPainter::MapPainter(MapPaintWidget *parentMapWidget, MapScale *mapScale, Pain
 {
   airportQuery = NavApp::getAirportQuerySim();
   symbolPainter = new SymbolPainter();
+  symbolAtlas = new SymbolAtlas();
 }
 
 MapPainter::~MapPainter()
 {
   delete symbolPainter;
+  delete symbolAtlas;
 }
 
 bool MapPainter::wToSBuf(const Pos& coords, int& x, int& y, QSize size, const QMargins& margins, bool *hidden) const
@@ -454,7 +457,9 @@ void MapPainter::drawCross(Marble::GeoPainter *painter, int x, int y, int size)
 
 void MapPainter::drawPolyline(Marble::GeoPainter *painter, const atools::geo::LineString& linestring)
 {
+  qint64 statStart = context->statStart();
   QVector<QPolygonF *> polygons = createPolylines(linestring, context->screenRect);
+  context->statEnd(paintstat::PROJECTION, statStart);
   drawPolylines(painter, polygons);
   releasePolylines(polygons);
 }
@@ -494,7 +499,9 @@ void MapPainter::drawPolyline(Marble::GeoPainter *painter, const QPolygonF& poly
 
 void MapPainter::drawPolygon(Marble::GeoPainter *painter, const atools::geo::LineString& linestring)
 {
+  qint64 statStart = context->statStart();
   QVector<QPolygonF *> polygons = createPolygons(linestring, context->screenRect);
+  context->statEnd(paintstat::PROJECTION, statStart);
   drawPolygons(painter, polygons);
   releasePolygons(polygons);
 }
@@ -534,7 +541,9 @@ void MapPainter::drawPolygon(Marble::GeoPainter *painter, const QPolygonF& polyg
 
 void MapPainter::drawLine(Marble::GeoPainter *painter, const atools::geo::Line& line, bool forceDraw)
 {
+  qint64 statStart = context->statStart();
   QVector<QPolygonF *> polygons = createPolylines(LineString(line.getPos1(), line.getPos2()), context->screenRect);
+  context->statEnd(paintstat::PROJECTION, statStart);
   if(!polygons.isEmpty())
   {
     drawPolylines(painter, polygons);
@@ -946,7 +955,7 @@ void MapPainter::paintMsaMarks(const QList<map::MapAirportMsa>& airportMsa, bool
       painter->setBrush(context->darkMap ? mapcolors::msaDiagramFillColorDark : mapcolors::msaDiagramFillColor);
       drawPolygon(painter, msa.geometry);
 
-      TextPlacement textPlacement(painter, this, context->screenRect);
+      TextPlacement textPlacement(painter, this, context->screenRect, context->frameArena);
       QVector<atools::geo::Line> lines;
       QStringList texts;
 
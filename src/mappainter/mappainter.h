@@ -22,6 +22,7 @@
 #include "common/mapflags.h"
 #include "options/optiondata.h"
 #include "geo/rect.h"
+#include "mappainter/paintstatistics.h"
 
 #include <QPen>
 #include <QFont>
@@ -39,12 +40,15 @@ class GeoPainter;
 }
 
 class AirportQuery;
+class FrameArena;
+class LabelPlacement;
 class AirwayTrackQuery;
 class MapLayer;
 class MapPaintWidget;
 class MapQuery;
 class MapScale;
 class MapWidget;
+class SymbolAtlas;
 class SymbolPainter;
 class WaypointTrackQuery;
 class Route;
@@ -82,6 +86,12 @@ struct PaintContext
   /* Airports drawn having parking spots which require tooltips and more */
   QSet<int> *shownDetailAirportIds;
 
+  /* Shared label declutter for static painters. Null if disabled. Labels are drawn after all static painters. */
+  LabelPlacement *labelPlacement = nullptr;
+
+  /* Reusable temporary containers for geometry and texts. Owned by the paint layer and valid for the frame. */
+  FrameArena *frameArena = nullptr;
+
   opts::MapScrollDetail mapScrollDetail; /* Option that indicates the detail level when drawFast is true */
   QFont defaultFont /* Default widget font */;
   float distanceNm; /* Zoom distance in NM */
@@ -262,8 +272,24 @@ struct PaintContext
       renderTimesMs.clear();
   }
 
+  /* Get start time for query or projection statistics. Pass value to statEnd(). */
+  qint64 statStart() const
+  {
+    return statistics != nullptr ? statistics->start() : 0L;
+  }
+
+  /* Add time since start to the statistics of the current painter */
+  void statEnd(paintstat::TimeType type, qint64 start)
+  {
+    if(statistics != nullptr)
+      statistics->addTime(type, start);
+  }
+
   bool verboseDraw = false;
   QMap<QString, qint64> renderTimesMs;
+
+  /* Persistent timing statistics owned by the paint layer. Null if not collected. */
+  PaintStatistics *statistics = nullptr;
 };
 
 /* Used to collect airports for drawing. Needs to copy airport since it might be removed from the cache. */
@@ -420,6 +446,7 @@ protected:
 
   PaintContext *context = nullptr;
   SymbolPainter *symbolPainter = nullptr;
+  SymbolAtlas *symbolAtlas = nullptr;
   MapPaintWidget *mapPaintWidget = nullptr;
   MapQuery *mapQuery = nullptr;
   AirwayTrackQuery *airwayQuery = nullptr;
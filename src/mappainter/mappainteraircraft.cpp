@@ -18,9 +18,11 @@
 #include "mappainter/mappainteraircraft.h"
 
 #include "common/constants.h"
+#include "common/symbolatlas.h"
 #include "geo/calculations.h"
 #include "mapgui/mapfunctions.h"
 #include "mapgui/mappaintwidget.h"
+#include "mapgui/mapscreenindex.h"
 #include "app/navapp.h"
 #include "online/onlinedatacontroller.h"
 #include "settings/settings.h"
@@ -58,6 +60,7 @@ void MapPainterAircraft::render()
     bool onlineEnabled = context->objectTypes.testFlag(map::AIRCRAFT_ONLINE) && NavApp::isOnlineNetworkActive();
     bool aiEnabled = context->objectTypes.testFlag(map::AIRCRAFT_AI) && NavApp::isConnected();
     const atools::geo::Pos& userPos = userAircraft.getPosition();
+    const MapScreenIndex *screenIndex = mapPaintWidget->getScreenIndexConst();
     if(aiEnabled || onlineEnabled)
     {
       bool overflow = false;
@@ -69,9 +72,11 @@ void MapPainterAircraft::render()
       if(onlineEnabled)
       {
         // Filters duplicates from simulator and user aircraft out - remove shadow aircraft
+        qint64 statStart = context->statStart();
         const QList<SimConnectAircraft> *onlineAircraft =
           NavApp::getOnlinedataController()->getAircraft(context->viewport->viewLatLonAltBox(),
                                                          context->mapLayer, context->lazyUpdate, overflow);
+        context->statEnd(paintstat::QUERY, statStart);
 
         context->setQueryOverflow(overflow);
 
@@ -79,9 +84,21 @@ void MapPainterAircraft::render()
           allAircraft.append(&ac);
       }
 
+      // Enlarge viewport rectangle to cover the screen margins for the cheap geographic prefilter below
+      // Not used for views showing large parts of the globe
+      atools::geo::Rect cullRect = context->viewportRect;
+      bool cull = cullRect.isValid() && !cullRect.crossesAntiMeridian() && cullRect.getWidthDegree() < 90.f &&
+                  cullRect.getHeightDegree() < 60.f;
+      if(cull)
+        cullRect.inflate(cullRect.getWidthDegree() * 0.2f, cullRect.getHeightDegree() * 0.2f);
+
       // Get all AI and online shadow aircraft ======================================
       for(const SimConnectAircraft& ac : mapPaintWidget->getAiAircraft())
       {
+        // Skip aircraft far outside of the view before doing the more expensive screen projection
+        if(cull && !cullRect.contains(ac.getPosition()))
+          continue;
+
         // Skip boats
         if(ac.isAnyBoat())
           continue;
@@ -107,14 +124,21 @@ void MapPainterAircraft::render()
 
       QVector<AiDistType> aiSorted;
       bool hidden = false;
+      bool hideAiOnGround = OptionData::instance().getFlags().testFlag(opts::MAP_AI_HIDE_GROUND);
       float x, y;
       for(const SimConnectAircraft *ac : allAircraft)
       {
-        if(wToSBuf(ac->getPosition(), x, y, MARGINS, &hidden))
+        // Check layer visibility first to avoid projection and sorting of hidden aircraft
+        if(!mapfunc::aircraftVisible(*ac, context->mapLayer, hideAiOnGround))
+          continue;
+
+        // Move simulator aircraft along their path if packets arrive slowly
+        const atools::geo::Pos acPos = ac->isOnline() ? ac->getPosition() : screenIndex->getPredictedPosition(*ac);
+
+        if(wToSBuf(acPos, x, y, MARGINS, &hidden))
         {
           if(!hidden)
-            aiSorted.append({ac, x, y, userPos.distanceMeterTo(ac->getPosition()),
-                             std::abs(userPos.getAltitude() - ac->getActualAltitudeFt())});
+            aiSorted.append({ac, x, y, userPos.distanceMeterTo(acPos), std::abs(userPos.getAltitude() - ac->getActualAltitudeFt())});
         }
       }
 
@@ -125,18 +149,21 @@ void MapPainterAircraft::render()
         return ai1.distanceLateralMeter < ai2.distanceLateralMeter;
       });
 
-      bool hideAiOnGround = OptionData::instance().getFlags().testFlag(opts::MAP_AI_HIDE_GROUND);
-      int num = 0;
-      for(const AiDistType& adt : aiSorted)
+      // Draw all symbols from the atlas first and labels on top
+      QVector<float> sizes;
+      sizes.reserve(aiSorted.size());
+      for(const AiDistType& adt : qAsConst(aiSorted))
+        sizes.append(paintAiVehicleSymbol(*adt.aircraft, adt.x, adt.y));
+      symbolAtlas->flush(context->painter);
+
+      for(int i = 0; i < aiSorted.size(); i++)
       {
-        const SimConnectAircraft& ac = *adt.aircraft;
-        if(mapfunc::aircraftVisible(ac, context->mapLayer, hideAiOnGround))
-        {
-          bool forceLabelNearby = num++ < maxNearestAiLabels &&
-                                  adt.distanceLateralMeter < maxNearestAiLabelsDistNm &&
-                                  adt.distanceVerticalFt < maxNearestAiLabelsVertDistFt;
-          paintAiVehicle(ac, adt.x, adt.y, forceLabelNearby);
-        }
+        const AiDistType& adt = aiSorted.at(i);
+        bool forceLabelNearby = i < maxNearestAiLabels &&
+                                adt.distanceLateralMeter < maxNearestAiLabelsDistNm &&
+                                adt.distanceVerticalFt < maxNearestAiLabelsVertDistFt;
+        if(sizes.at(i) > 0.f)
+          paintAiVehicleLabel(*adt.aircraft, adt.x, adt.y, sizes.at(i), forceLabelNearby);
       }
     }
 
@@ -144,7 +171,8 @@ void MapPainterAircraft::render()
     if(context->objectTypes.testFlag(map::AIRCRAFT))
     {
       // Use higher accuracy - falls back to normal position if not set
-      atools::geo::PosD pos = userAircraft.getPositionD();
+      // Position is predicted from speed and turn rate if packets arrive slowly
+      atools::geo::PosD pos = screenIndex->getPredictedUserPosition();
       if(pos.isValid())
       {
         bool hidden = false;
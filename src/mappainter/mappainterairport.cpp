@@ -18,6 +18,7 @@
 #include "mappainter/mappainterairport.h"
 
 #include "atools.h"
+#include "common/constants.h"
 #include "common/formatter.h"
 #include "common/mapcolors.h"
 #include "common/maptypes.h"
@@ -28,9 +29,11 @@
 #include "mapgui/maplayer.h"
 #include "mapgui/mappaintwidget.h"
 #include "mapgui/mapscale.h"
+#include "mappainter/labelplacement.h"
 #include "query/airportquery.h"
 #include "query/mapquery.h"
 #include "route/route.h"
+#include "settings/settings.h"
 #include "util/paintercontextsaver.h"
 
 #include <QElapsedTimer>
@@ -61,6 +64,8 @@ using namespace map;
 MapPainterAirport::MapPainterAirport(MapPaintWidget *mapWidget, MapScale *mapScale, PaintContext *paintContext)
   : MapPainter(mapWidget, mapScale, paintContext)
 {
+  diagramCacheEnabled =
+    atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_LAYER_AIRPORT_DIAGRAM_CACHE, true).toBool();
 }
 
 MapPainterAirport::~MapPainterAirport()
@@ -84,8 +89,18 @@ void MapPainterAirport::render()
   // Draw diagrams or simple runway diagrams ===========================
   if(context->mapLayer->isAirportDiagramRunway())
   {
-    for(const PaintAirportType& airport : qAsConst(visibleAirports))
-      drawAirportDiagram(*airport.airport);
+    // Not cached for printing and web services which use other paint devices
+    if(diagramCacheEnabled && mapPaintWidget->isVisibleWidget() && !mapPaintWidget->isPrinting())
+    {
+      QString options = diagramOptionsKey();
+      for(const PaintAirportType& airport : qAsConst(visibleAirports))
+        drawAirportDiagramCached(*airport.airport, options);
+    }
+    else
+    {
+      for(const PaintAirportType& airport : qAsConst(visibleAirports))
+        drawAirportDiagram(*airport.airport);
+    }
   }
 
   float airportFontScale = context->mapLayer->getAirportFontScale();
@@ -124,9 +139,11 @@ void MapPainterAirport::render()
 
       context->szFont(context->textSizeAirport * (minor ? airportSoftFontScale : airportFontScale));
 
+      symbolPainter->setLabelPlacement(context->labelPlacement, label::AIRPORT);
       symbolPainter->drawAirportText(context->painter, *airport, x, y, context->dispOptsAirport, minor ? textFlagsMinor : textFlags,
                                      minor ? apMinorSymSize : apSymSize, context->mapLayer->isAirportDiagram(),
                                      context->mapLayer->getMaxTextLengthAirport());
+      symbolPainter->setLabelPlacement(nullptr, 0);
     }
   }
   context->endTimer("Airport");
@@ -152,7 +169,11 @@ void MapPainterAirport::collectVisibleAirports(QVector<PaintAirportType>& visibl
 
   // Get airports from map display cache if enabled in toolbar/menu and layer
   if(context->objectTypes.testFlag(map::AIRPORT) && context->mapLayer->isAirport())
+  {
+    qint64 statStart = context->statStart();
     airportCache = mapQuery->getAirports(curBox, context->mapLayer, context->lazyUpdate, context->objectTypes, overflow);
+    context->statEnd(paintstat::QUERY, statStart);
+  }
   context->setQueryOverflow(overflow);
 
   // Collect departure, destination and alternate airports from flight plan for potential diagram painting ================
@@ -294,14 +315,85 @@ void MapPainterAirport::drawAirportDiagramBackground(const map::MapAirport& airp
   }
 }
 
+QString MapPainterAirport::diagramOptionsKey() const
+{
+  qreal pixelRatio = context->painter->device() != nullptr ? context->painter->device()->devicePixelRatioF() : 1.;
+
+  return QString("%1|%2|%3|%4|%5|%6|%7|%8|%9").
+         arg(static_cast<quint64>(context->dispOptsAirport)).
+         arg(static_cast<quint64>(context->flags)).
+         arg(static_cast<quint64>(context->flags2)).
+         arg(reinterpret_cast<quintptr>(context->mapLayer)).
+         arg(reinterpret_cast<quintptr>(context->mapLayerEffective)).
+         arg(context->darkMap).
+         arg(pixelRatio).
+         arg(context->viewContext).
+         arg(context->defaultFont.key());
+}
+
+void MapPainterAirport::drawAirportDiagramCached(const map::MapAirport& airport, const QString& options)
+{
+  // Airport center can be outside of the screen
+  bool visible, hidden = false;
+  QPointF pos = wToSF(airport.position, DEFAULT_WTOS_SIZE, &visible, &hidden);
+  if(hidden)
+    return;
+
+  quint64 key = static_cast<quint64>(airport.id) << 1 | static_cast<quint64>(context->drawFast);
+  const ViewportParams *viewport = context->viewport;
+
+  DiagramEntry *entry = diagramCache.object(key);
+  if(entry != nullptr)
+  {
+    // Check if zoom and options are unchanged and the screen is still inside the recorded area after panning
+    QPointF offset = pos - entry->origin;
+    if(qFuzzyCompare(entry->radius, viewport->radius()) && entry->projection == viewport->projection() &&
+       entry->options == options && entry->area.contains(context->screenRect.translated(-offset.toPoint())))
+    {
+      context->painter->drawPicture(offset, entry->picture);
+      if(entry->shownDetail)
+        context->shownDetailAirportIds->insert(airport.id);
+      return;
+    }
+  }
+
+  // Record a new diagram covering half a screen more on each side to allow panning ==================
+  entry = new DiagramEntry;
+  entry->origin = pos;
+  entry->radius = viewport->radius();
+  entry->projection = viewport->projection();
+  entry->options = options;
+  entry->area = context->screenRect.marginsAdded(QMargins(context->screenRect.width() / 2, context->screenRect.height() / 2,
+                                                          context->screenRect.width() / 2, context->screenRect.height() / 2));
+
+  GeoPainter *painter = context->painter;
+  QRect screenRect = context->screenRect;
+
+  {
+    GeoPainter picturePainter(&entry->picture, context->viewport, painter->mapQuality());
+    picturePainter.setRenderHints(painter->renderHints());
+    picturePainter.setFont(painter->font());
+
+    // Buffered visibility checks use the screen rectangle of the context
+    context->painter = &picturePainter;
+    context->screenRect = entry->area;
+    drawAirportDiagram(airport);
+    context->painter = painter;
+    context->screenRect = screenRect;
+  }
+
+  entry->shownDetail = context->shownDetailAirportIds->contains(airport.id);
+
+  painter->drawPicture(QPointF(0., 0.), entry->picture);
+  diagramCache.insert(key, entry);
+}
+
 /* Draw simple FSX/P3D aprons */
 void MapPainterAirport::drawFsApron(const map::MapApron& apron)
 {
-  QVector<QPoint> apronPoints;
-  bool visible;
-  for(const Pos& pos : apron.vertices)
-    apronPoints.append(wToS(pos, DEFAULT_WTOS_SIZE, &visible));
-  context->painter->QPainter::drawPolygon(apronPoints.data(), apronPoints.size());
+  // Get projected vertices from the cache
+  QPolygonF apronPoints = mapPaintWidget->getApronGeometryCache()->getFsApronGeometry(apron);
+  context->painter->QPainter::drawPolygon(apronPoints.toPolygon());
 }
 
 void MapPainterAirport::drawXplaneApron(const map::MapApron& apron, bool fast)
@@ -20,6 +20,9 @@
 
 #include "mappainter/mappainter.h"
 
+#include <QCache>
+#include <QPicture>
+
 class SymbolPainter;
 
 namespace map {
@@ -48,7 +51,31 @@ public:
   /* Needs call of collectVisibleAirports() before */
   virtual void render() override;
 
+  /* Remove all recorded airport diagrams. Needed after database or option changes. */
+  void clearDiagramCache()
+  {
+    diagramCache.clear();
+  }
+
 private:
+  /* Recorded airport diagram for one airport, zoom level and set of display options */
+  struct DiagramEntry
+  {
+    QPicture picture;
+    QPointF origin; /* Screen position of the airport when recorded */
+    QRect area; /* Screen area covered by the recording */
+    qreal radius; /* Viewport radius defining the zoom */
+    int projection;
+    QString options; /* Display options and layer used for drawing */
+    bool shownDetail; /* Airport was added to shownDetailAirportIds */
+  };
+
+  /* Draw diagram from cache translated by the pan offset or record a new one */
+  void drawAirportDiagramCached(const map::MapAirport& airport, const QString& options);
+
+  /* Build key from all options influencing the diagram */
+  QString diagramOptionsKey() const;
+
   /* Pre-calculates visible airports for render() and fills visibleAirports.
    * visibleAirportIds gets all idents of shown airports */
   void collectVisibleAirports(QVector<PaintAirportType>& visibleAirports);
@@ -72,6 +99,9 @@ private:
   /* Extract a single number */
   QString parkingExtractNumber(const QString& parkingName);
 
+  /* Recorded diagrams keyed by airport id and fast drawing flag */
+  QCache<quint64, DiagramEntry> diagramCache{20};
+  bool diagramCacheEnabled = true;
 };
 
 #endif // LITTLENAVMAP_MAPPAINTERAIRPORT_H
@@ -22,6 +22,8 @@
 #include "util/paintercontextsaver.h"
 #include "route/route.h"
 #include "mapgui/maplayer.h"
+#include "mapgui/airspacegeometrycache.h"
+#include "mapgui/mappaintwidget.h"
 #include "airspace/airspacecontroller.h"
 #include "app/navapp.h"
 #include "mapgui/mapscale.h"
@@ -65,8 +67,10 @@ void MapPainterAirspace::render()
   AirspaceVector airspaces;
 
   bool overflow = false;
+  qint64 queryStart = context->statStart();
   controller->getAirspaces(airspaces, curBox, context->mapLayer, context->airspaceFilterByLayer, context->route->getCruiseAltitudeFt(),
                            context->viewContext == Marble::Animation, map::AIRSPACE_SRC_ALL, overflow);
+  context->statEnd(paintstat::QUERY, queryStart);
   context->setQueryOverflow(overflow);
 
   const OptionData& optionData = OptionData::instance();
@@ -111,7 +115,7 @@ void MapPainterAirspace::render()
           return;
 
         // Get cached geometry =====================
-        const LineString *lineString = controller->getAirspaceGeometry(airspace->combinedId());
+        const LineString *lineString = controller->getAirspaceGeometry(airspace->combinedId(), context->mapLayer);
         if(lineString != nullptr)
         {
           if(airspace->isOnline())
@@ -125,7 +129,10 @@ void MapPainterAirspace::render()
             painter->setBrush(mapcolors::colorForAirspaceFill(*airspace, displayTransparencyAirspace));
 
           // Convert to screen polygons probably cutting them and removing duplicate points =====================
-          const QVector<QPolygonF *> polygons = createPolygons(*lineString, context->screenRect);
+          qint64 statStart = context->statStart();
+          const QVector<QPolygonF *> polygons =
+            mapPaintWidget->getAirspaceGeometryCache()->createPolygons(airspace->combinedId(), *lineString, context->screenRect);
+          context->statEnd(paintstat::PROJECTION, statStart);
 
           // Add for text placement later
           visibleAirspaces.append(DrawAirspace(airspace, polygons));
@@ -200,7 +207,7 @@ void MapPainterAirspace::render()
       context->szFont(context->textSizeAirspace * context->mapLayer->getAirspaceFontScale());
 
       // Prepare text placement without arrows
-      TextPlacement textPlacement(painter, this, context->screenRect);
+      TextPlacement textPlacement(painter, this, context->screenRect, context->frameArena);
       textPlacement.setArrowForEmpty(false);
       textPlacement.setArrowLeft(QString());
       textPlacement.setArrowRight(QString());
@@ -88,42 +88,108 @@ void MapPainterAltitude::render()
       // Center points for rectangles for text placement
       QVector<GeoDataCoordinates> centers;
 
-      // Draw rectangles and collect other values for text placement ================================
-      for(int laty = south; laty <= north + 1; laty++)
+      // Grid lines projected once per node and drawn with a single call
+      QVector<QLineF> lines;
+      int numLat = north + 1 - south + 1;
+
+      // Collect grid lines and other values for text placement ================================
+      // Iterate over anti-meridian split
+      for(const std::pair<int, int>& range : ranges)
       {
-        // Iterate over anti-meridian split
-        for(const std::pair<int, int>& range : ranges)
+        int numLon = range.second - range.first + 1;
+
+        // MORA values for all cells in range - index is iLat * numLon + iLon
+        QVector<int> moras(numLat * numLon, 0);
+        for(int iLat = 0; iLat < numLat; iLat++)
         {
-          for(int lonx = range.first; lonx <= range.second; lonx++)
+          for(int iLon = 0; iLon < numLon; iLon++)
           {
-            int moraFt100 = moraReader->getMoraFt(lonx, laty);
+            int moraFt100 = moraReader->getMoraFt(range.first + iLon, south + iLat);
             if(moraFt100 > 10 && moraFt100 != MoraReader::OCEAN && moraFt100 != MoraReader::UNKNOWN &&
                moraFt100 != MoraReader::ERROR)
+              moras[iLat * numLon + iLon] = moraFt100;
+          }
+        }
+
+        auto hasMora = [&moras, numLon, numLat](int iLon, int iLat) -> bool {
+                         return iLon >= 0 && iLon < numLon && iLat >= 0 && iLat < numLat && moras.at(iLat * numLon + iLon) > 0;
+                       };
+
+        // Screen coordinates of cell corners converted on demand - one more than cells in each direction
+        // Node nLat is latitude south - 1 + nLat and node nLon is longitude range.first + nLon
+        int numNodeLon = numLon + 1;
+        QVector<QPointF> nodes((numLat + 1) * numNodeLon);
+        QVector<char> nodeState((numLat + 1) * numNodeLon, 0); // 0 = not converted, 1 = valid, 2 = hidden
+
+        auto node = [&, numNodeLon](int nLon, int nLat, QPointF& point) -> bool {
+                      int idx = nLat * numNodeLon + nLon;
+                      if(nodeState.at(idx) == 0)
+                      {
+                        double x = 0., y = 0.;
+                        bool hidden = false;
+                        wToS(GeoDataCoordinates(range.first + nLon, south - 1 + nLat, 0, DEG), x, y, DEFAULT_WTOS_SIZE, &hidden);
+                        nodes[idx] = QPointF(x, y);
+                        nodeState[idx] = hidden ? 2 : 1;
+                      }
+                      point = nodes.at(idx);
+                      return nodeState.at(idx) == 1;
+                    };
+
+        auto addLine = [&](int nLon1, int nLat1, int nLon2, int nLat2) -> void {
+                         QPointF p1, p2;
+                         if(node(nLon1, nLat1, p1) && node(nLon2, nLat2, p2))
+                           lines.append(QLineF(p1, p2));
+                       };
+
+        for(int iLat = 0; iLat < numLat; iLat++)
+        {
+          for(int iLon = 0; iLon < numLon; iLon++)
+          {
+            if(!hasMora(iLon, iLat))
+              continue;
+
+            int lonx = range.first + iLon, laty = south + iLat;
+            if(lonx == 179 || lonx == -180)
             {
-              // Build rectangle
+              // Use geometry based drawing at the anti-meridian where projected nodes might wrap around
               float lonxF = static_cast<float>(lonx);
               float latyF = static_cast<float>(laty);
               drawLine(context->painter, Line(lonxF, latyF, lonxF + 1.f, latyF));
               drawLine(context->painter, Line(lonxF + 1.f, latyF, lonxF + 1, latyF - 1.f));
               drawLine(context->painter, Line(lonxF + 1.f, latyF - 1, lonxF, latyF - 1.f));
               drawLine(context->painter, Line(lonxF, latyF - 1.f, lonxF, latyF));
+            }
+            else
+            {
+              // Cell spans node iLon to iLon + 1 and node iLat (bottom) to iLat + 1 (top)
+              // Edges shared with neighbor cells having a MORA are added only once
+              addLine(iLon, iLat + 1, iLon + 1, iLat + 1); // Top
+              addLine(iLon, iLat, iLon, iLat + 1); // Left
 
-              if(!context->drawFast)
-              {
-                // Calculate rectangle screen width
-                bool visibleDummy;
-                QPointF leftPt = wToSF(GeoDataCoordinates(lonx, laty - .5, 0, DEG), DEFAULT_WTOS_SIZE, &visibleDummy);
-                QPointF rightPt = wToSF(GeoDataCoordinates(lonx + 1., laty - .5, 0, DEG), DEFAULT_WTOS_SIZE, &visibleDummy);
+              if(!hasMora(iLon, iLat - 1))
+                addLine(iLon, iLat, iLon + 1, iLat); // Bottom
+              if(!hasMora(iLon + 1, iLat))
+                addLine(iLon + 1, iLat, iLon + 1, iLat + 1); // Right
+            }
+
+            if(!context->drawFast)
+            {
+              // Calculate rectangle screen width
+              bool visibleDummy;
+              QPointF leftPt = wToSF(GeoDataCoordinates(lonx, laty - .5, 0, DEG), DEFAULT_WTOS_SIZE, &visibleDummy);
+              QPointF rightPt = wToSF(GeoDataCoordinates(lonx + 1., laty - .5, 0, DEG), DEFAULT_WTOS_SIZE, &visibleDummy);
 
-                minWidth = std::min(static_cast<float>(QLineF(leftPt, rightPt).length()), minWidth);
+              minWidth = std::min(static_cast<float>(QLineF(leftPt, rightPt).length()), minWidth);
 
-                centers.append(GeoDataCoordinates(lonx + .5, laty - .5, 0, DEG));
-                altitudes.append(moraFt100);
-              }
+              centers.append(GeoDataCoordinates(lonx + .5, laty - .5, 0, DEG));
+              altitudes.append(moras.at(iLat * numLon + iLon));
             }
-          } // for(int lonx = range.first; lonx <= range.second; lonx++)
-        } // for(const std::pair<int, int>& range : ranges)
-      } // for(int laty = south; laty <= north + 1; laty++)
+          } // for(int iLon = 0; iLon < numLon; iLon++)
+        } // for(int iLat = 0; iLat < numLat; iLat++)
+      } // for(const std::pair<int, int>& range : ranges)
+
+      // Draw all grid lines at once
+      context->painter->drawLines(lines);
 
       // Draw texts =================================================================
       if(!context->drawFast && minWidth > 20.f)
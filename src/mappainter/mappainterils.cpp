@@ -68,7 +68,9 @@ void MapPainterIls::render()
        context->objectTypes.testFlag(map::AIRPORT))
     {
       bool overflow = false;
+      qint64 statStart = context->statStart();
       const QList<MapIls> *ilsList = mapQuery->getIls(curBox, context->mapLayer, context->lazyUpdate, overflow);
+      context->statEnd(paintstat::QUERY, statStart);
       context->setQueryOverflow(overflow);
 
       if(ilsList != nullptr)
@@ -217,24 +219,75 @@ void MapPainterIls::drawIlsSymbol(const map::MapIls& ils, bool fast)
 
       if(featherLen > MIN_LENGHT_FOR_TEXT)
       {
-        if(context->flags2 & opts2::MAP_NAVAID_TEXT_BACKGROUND)
-        {
-          painter->setBackground(Qt::white);
-          painter->setBackgroundMode(Qt::OpaqueMode);
-        }
-
+        bool background = context->flags2 & opts2::MAP_NAVAID_TEXT_BACKGROUND;
         QFontMetricsF metrics(painter->font());
         double texth = ils.isAnyGlsRnp() ? metrics.height() : -metrics.descent();
 
-        // Cut text to feather length
-        text = metrics.elidedText(text, Qt::ElideRight, featherLen);
-        double textw = metrics.horizontalAdvance(text);
-        double textpos = ils.displayHeading > 180. ? (featherLen - textw) / 2. : -(featherLen + textw) / 2.;
+        if(featherLen <= MAX_LENGHT_FOR_CACHED_TEXT)
+        {
+          // Blit pre-rendered label - text is elided to a slightly shorter length to allow reuse
+          const QPixmap *pixmap = ilsLabelFromCache(ils, text, textColor, background, featherLen);
+          double textw = pixmap->width() / pixmap->devicePixelRatioF();
+          double textpos = ils.displayHeading > 180. ? (featherLen - textw) / 2. : -(featherLen + textw) / 2.;
+
+          painter->setRenderHint(QPainter::SmoothPixmapTransform);
+          painter->rotate(rotate);
+          painter->drawPixmap(QPointF(textpos, texth - metrics.ascent()), *pixmap);
+          painter->resetTransform();
+        }
+        else
+        {
+          if(background)
+          {
+            painter->setBackground(Qt::white);
+            painter->setBackgroundMode(Qt::OpaqueMode);
+          }
+
+          // Cut text to feather length
+          text = metrics.elidedText(text, Qt::ElideRight, featherLen);
+          double textw = metrics.horizontalAdvance(text);
+          double textpos = ils.displayHeading > 180. ? (featherLen - textw) / 2. : -(featherLen + textw) / 2.;
 
-        painter->rotate(rotate);
-        painter->drawText(QPointF(textpos, texth), text);
-        painter->resetTransform();
+          painter->rotate(rotate);
+          painter->drawText(QPointF(textpos, texth), text);
+          painter->resetTransform();
+        }
       }
     }
   }
 }
+
+const QPixmap *MapPainterIls::ilsLabelFromCache(const map::MapIls& ils, const QString& text, const QColor& textColor,
+                                                bool background, int featherLen)
+{
+  const QFont& font = context->painter->font();
+  qreal pixelRatio = context->painter->device() != nullptr ? context->painter->device()->devicePixelRatioF() : 1.;
+  int elideWidth = featherLen / CACHED_TEXT_LENGTH_STEP * CACHED_TEXT_LENGTH_STEP;
+
+  // Text is part of the key since info and ident texts depend on layer
+  QString key = QString::number(ils.id) % '_' % QString::number(elideWidth) % '_' % QString::number(background) % '_' %
+                QString::number(atools::roundToInt(pixelRatio * 4.)) % '_' % font.key() % '_' % text;
+
+  QPixmap *pixmap = ilsLabelPixmaps.object(key);
+  if(pixmap == nullptr)
+  {
+    QFontMetricsF metrics(font);
+    QString elided = metrics.elidedText(text, Qt::ElideRight, elideWidth);
+    QSize size(std::max(1, static_cast<int>(std::ceil(metrics.horizontalAdvance(elided)))),
+               static_cast<int>(std::ceil(metrics.height())));
+
+    pixmap = new QPixmap(size * pixelRatio);
+    pixmap->setDevicePixelRatio(pixelRatio);
+    pixmap->fill(background ? QColor(Qt::white) : QColor(Qt::transparent));
+
+    QPainter pixmapPainter(pixmap);
+    pixmapPainter.setRenderHints(context->painter->renderHints());
+    pixmapPainter.setFont(font);
+    pixmapPainter.setPen(QPen(textColor, 0.5f, Qt::SolidLine, Qt::FlatCap));
+    pixmapPainter.drawText(QPointF(0., metrics.ascent()), elided);
+    pixmapPainter.end();
+
+    ilsLabelPixmaps.insert(key, pixmap);
+  }
+  return pixmap;
+}
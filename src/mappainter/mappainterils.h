@@ -20,6 +20,8 @@
 
 #include "mappainter/mappainter.h"
 
+#include <QCache>
+
 class SymbolPainter;
 
 namespace map {
@@ -46,8 +48,20 @@ private:
   static Q_DECL_CONSTEXPR int FEATHER_LEN_NM = 9;
   static Q_DECL_CONSTEXPR int MIN_LENGHT_FOR_TEXT = 40;
 
+  /* Labels are drawn from pre-rendered pixmaps up to this feather length. Closer zoom uses vector text. */
+  static Q_DECL_CONSTEXPR int MAX_LENGHT_FOR_CACHED_TEXT = 400;
+
+  /* Elide width is rounded down to this value to allow reuse of cached labels */
+  static Q_DECL_CONSTEXPR int CACHED_TEXT_LENGTH_STEP = 8;
+
   void drawIlsSymbol(const map::MapIls& ils, bool fast);
 
+  /* Get ILS label pixmap elided to featherLen from cache or render it. Text baseline is at font ascent. */
+  const QPixmap *ilsLabelFromCache(const map::MapIls& ils, const QString& text, const QColor& textColor, bool background,
+                                   int featherLen);
+
+  QCache<QString, QPixmap> ilsLabelPixmaps{500};
+
 };
 
 #endif // LITTLENAVMAP_MAPPAINTERILS_H
@@ -18,6 +18,7 @@
 #include "mappainter/mappaintermark.h"
 
 #include "mapgui/mapwidget.h"
+#include "mapgui/linegeometrycache.h"
 #include "app/navapp.h"
 #include "mapgui/mapscale.h"
 #include "mapgui/maplayer.h"
@@ -28,6 +29,7 @@
 #include "util/roundedpolygon.h"
 #include "common/symbolpainter.h"
 #include "geo/rect.h"
+#include "geo/linestring.h"
 #include "atools.h"
 #include "common/symbolpainter.h"
 #include "airspace/airspacecontroller.h"
@@ -36,12 +38,14 @@
 #include "route/route.h"
 #include "util/paintercontextsaver.h"
 #include "common/textplacement.h"
-#include "fs/userdata/logdatamanager.h"
+#include "fs/gpx/gpxtypes.h"
+#include "logbook/logdatacontroller.h"
 
 #include <marble/GeoDataLineString.h>
 #include <marble/GeoDataLinearRing.h>
 #include <marble/GeoPainter.h>
 
+#include <QBitArray>
 #include <QPainterPath>
 #include <QStringBuilder>
 
@@ -348,7 +352,7 @@ void MapPainterMark::paintHighlights()
     radius *= 0.75f;
 
   const QList<int>& routeHighlightResults = mapPaintWidget->getRouteHighlights();
-  QVector<atools::geo::Pos> positions;
+  atools::geo::LineString positions;
   for(int idx : routeHighlightResults)
   {
     const RouteLeg& routeLeg = NavApp::getRouteConst().value(idx);
@@ -360,18 +364,22 @@ void MapPainterMark::paintHighlights()
   const QPen innerPenRoute(mapcolors::adjustAlphaF(routeHighlightColor, alpha), transparent ? 1. : radius / 3., Qt::SolidLine, Qt::FlatCap);
   painter->setBrush(transparent ? QBrush(mapcolors::adjustAlphaF(routeHighlightColor, alpha)) : QBrush(Qt::NoBrush));
   painter->setPen(innerPenRoute);
-  for(const ageo::Pos& pos : positions)
+
+  QPolygonF points;
+  QBitArray visible;
+  wToSBatch(points, visible, positions);
+  for(int i = 0; i < points.size(); i++)
   {
-    float x, y;
-    if(wToS(pos, x, y))
+    if(visible.testBit(i))
     {
+      const QPointF& pt = points.at(i);
       if(!context->drawFast && !transparent)
       {
         painter->setPen(outerPenRoute);
-        painter->drawEllipse(QPointF(x, y), radius, radius);
+        painter->drawEllipse(pt, radius, radius);
         painter->setPen(innerPenRoute);
       }
-      painter->drawEllipse(QPointF(x, y), radius, radius);
+      painter->drawEllipse(pt, radius, radius);
     }
   }
 
@@ -411,7 +419,6 @@ void MapPainterMark::paintLogEntries(const QList<map::MapLogbookEntry>& entries)
 
   float minAltitude = std::numeric_limits<float>::max(), maxAltitude = std::numeric_limits<float>::min();
   // Collect visible feature parts ==========================================================================
-  atools::fs::userdata::LogdataManager *logdataManager = NavApp::getLogdataManager();
   QVector<const MapLogbookEntry *> visibleLogEntries, allLogEntries;
   ageo::LineString visibleRouteGeometries;
   QStringList visibleRouteTexts;
@@ -431,7 +438,7 @@ void MapPainterMark::paintLogEntries(const QList<map::MapLogbookEntry>& entries)
     if(showRouteAndTrail)
     {
       // Get cached data
-      const atools::fs::gpx::GpxData *gpxData = logdataManager->getGpxData(logEntry.id);
+      const atools::fs::gpx::GpxData *gpxData = NavApp::getLogdataController()->getGpxData(logEntry.id);
 
       // Geometry might be null in case of cache overflow
       // Geometry has to be copied since cache in LogDataManager might remove it any time
@@ -586,7 +593,7 @@ void MapPainterMark::paintLogEntries(const QList<map::MapLogbookEntry>& entries)
         // Text for one line
         const ageo::LineString positions = entry->lineString();
 
-        TextPlacement textPlacement(context->painter, this, context->screenRect);
+        TextPlacement textPlacement(context->painter, this, context->screenRect, context->frameArena);
         textPlacement.setDrawFast(context->drawFast);
         textPlacement.setLineWidth(outerlinewidth);
         textPlacement.calculateTextPositions(positions);
@@ -694,10 +701,13 @@ void MapPainterMark::paintAirwayList(const QList<map::MapAirway>& airwayList)
   }
 
   // Draw waypoint triangles =============================================
-  for(const ageo::Pos& pos : qAsConst(linestring))
+  QPolygonF points;
+  QBitArray visible;
+  wToSBatch(points, visible, linestring);
+  for(int i = 0; i < points.size(); i++)
   {
-    QPointF pt = wToS(pos);
-    if(!pt.isNull())
+    const QPointF& pt = points.at(i);
+    if(visible.testBit(i))
     {
       // Draw a triangle
       double radius = lineWidth * 0.8;
@@ -768,7 +778,9 @@ void MapPainterMark::paintAirspace(const map::MapAirspace& airspace)
 
     if(lineString != nullptr)
     {
+      qint64 statStart = context->statStart();
       const QVector<QPolygonF *> polygons = createPolygons(*lineString, context->screenRect);
+      context->statEnd(paintstat::PROJECTION, statStart);
 
       if(!context->drawFast)
       {
@@ -831,10 +843,11 @@ void MapPainterMark::paintRangeMarks()
           painter->setBrush(Qt::NoBrush);
 
           // Draw all rings
+          int index = 0;
           for(float radius : rings.ranges)
           {
             QPoint textPos;
-            paintCircle(painter, rings.position, radius, context->drawFast, &textPos);
+            paintRangeRing(rings, index++, radius, &textPos);
             if(!textPos.isNull())
             {
               // paintCircle found a text position - draw text
@@ -861,6 +874,65 @@ void MapPainterMark::paintRangeMarks()
   }
 }
 
+void MapPainterMark::paintRangeRing(const map::RangeMarker& rings, int index, float radiusNm, QPoint *textPos)
+{
+  GeoPainter *painter = context->painter;
+
+  if(radiusNm < 1.f || ageo::meterToNm(context->zoomDistanceMeter) < 5.f || radiusNm > ageo::EARTH_CIRCUMFERENCE_METER / 4.f)
+  {
+    // Small circles are cheap and paintCircle ignores too large ones
+    paintCircle(painter, rings.position, radiusNm, context->drawFast, textPos);
+    return;
+  }
+
+  // Build the ring geometry only if not found in cache - always with full detail since it is reused while panning
+  auto ringFunc = [this, &rings, radiusNm]() -> ageo::LineString {
+                    float radiusMeter = ageo::nmToMeter(radiusNm);
+                    int pixel = scale->getPixelIntForMeter(radiusMeter);
+                    int step = 360 / std::min(std::max(pixel / 2, CIRCLE_MIN_POINTS), CIRCLE_MAX_POINTS);
+
+                    ageo::LineString ring;
+                    for(int angle = 0; angle < 360; angle += step)
+                      ring.append(rings.position.endpoint(radiusMeter, angle));
+                    ring.append(ring.constFirst());
+                    return ring;
+                  };
+
+  QVector<QPolygonF> polylines;
+  LineGeometryCache::Key key(LineGeometryCache::RANGE_RING, rings.id, index);
+  if(!mapPaintWidget->getLineGeometryCache()->createPolylines(key, rings.position, ageo::Pos(), radiusNm, ringFunc,
+                                                              context->screenRect, polylines))
+  {
+    // Not cacheable in spherical projection
+    paintCircle(painter, rings.position, radiusNm, context->drawFast, textPos);
+    return;
+  }
+
+  QVector<QPoint> textPositions;
+  QRectF viewport(painter->viewport());
+  for(const QPolygonF& polyline : qAsConst(polylines))
+  {
+    if(polyline.boundingRect().intersects(viewport))
+    {
+      drawPolyline(painter, polyline);
+
+      // Remember visible positions for the text (center of the line segment)
+      if(textPos != nullptr)
+      {
+        for(int i = 0; i < polyline.size() - 1; i++)
+        {
+          if(context->screenRect.contains(polyline.at(i).toPoint()) && context->screenRect.contains(polyline.at(i + 1).toPoint()))
+            textPositions.append(((polyline.at(i) + polyline.at(i + 1)) / 2.).toPoint());
+        }
+      }
+    }
+  }
+
+  if(textPos != nullptr)
+    // Take the position at one third of the visible text points to avoid half hidden texts
+    *textPos = textPositions.isEmpty() ? QPoint(0, 0) : textPositions.at(textPositions.size() / 3);
+}
+
 void MapPainterMark::paintSelectedAltitudeRange()
 {
   const atools::fs::sc::SimConnectUserAircraft& userAircraft = mapPaintWidget->getUserAircraft();
@@ -1394,7 +1466,21 @@ void MapPainterMark::paintDistanceMarks()
     {
       // Draw great circle line ========================================================
       painter->setPen(QPen(color, lineWidth, Qt::SolidLine, Qt::RoundCap, Qt::MiterJoin));
-      drawLine(painter, ageo::Line(marker->from, marker->to));
+      auto lineFunc = [marker]() -> ageo::LineString {
+                        return ageo::LineString(marker->from, marker->to);
+                      };
+
+      // Get line from cache if not edited and projection allows
+      QVector<QPolygonF> polylines;
+      LineGeometryCache::Key key(LineGeometryCache::DISTANCE_LINE, marker->id, 0);
+      if(mapPaintWidget->getLineGeometryCache()->createPolylines(key, marker->from, marker->to, 0.f, lineFunc, context->screenRect,
+                                                                 polylines))
+      {
+        for(const QPolygonF& polyline : qAsConst(polylines))
+          drawPolyline(painter, polyline);
+      }
+      else
+        drawLine(painter, ageo::Line(marker->from, marker->to));
 
       // Build '\n' separated texts =============================
       QStringList texts =
@@ -1403,7 +1489,7 @@ void MapPainterMark::paintDistanceMarks()
       if(marker->from != marker->to)
       {
         painter->setPen(mapcolors::distanceMarkerTextColor);
-        TextPlacement textPlacement(context->painter, this, context->screenRect);
+        TextPlacement textPlacement(context->painter, this, context->screenRect, context->frameArena);
         textPlacement.setArrowForEmpty(true);
         textPlacement.setMinLengthForText(painter->fontMetrics().averageCharWidth() * 2);
         textPlacement.setDrawFast(context->drawFast);
@@ -1424,7 +1510,7 @@ void MapPainterMark::paintPatternMarks()
   float lineWidth = context->szF(context->thicknessUserFeature, 3);
   context->szFont(context->textSizeRangeUserFeature);
 
-  TextPlacement textPlacement(painter, this, context->screenRect);
+  TextPlacement textPlacement(painter, this, context->screenRect, context->frameArena);
   textPlacement.setLineWidth(lineWidth);
   painter->setBackgroundMode(Qt::OpaqueMode);
   painter->setBackground(Qt::white);
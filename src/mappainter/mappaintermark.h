@@ -29,6 +29,7 @@ struct MapAirspace;
 struct MapAirway;
 struct MapLogbookEntry;
 struct DistanceMarker;
+struct RangeMarker;
 }
 
 class MapWidget;
@@ -61,6 +62,9 @@ private:
   /* Draw all rang rings. This includes the red rings and the radio navaid ranges. */
   void paintRangeMarks();
 
+  /* Draw a range ring using the screen geometry cache if possible. Falls back to paintCircle() if not cacheable. */
+  void paintRangeRing(const map::RangeMarker& rings, int index, float radiusNm, QPoint *textPos);
+
   /* Draw great circle line distance measurement lines */
   void paintDistanceMarks();
 
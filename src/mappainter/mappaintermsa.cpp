@@ -51,7 +51,9 @@ void MapPainterMsa::render()
     {
       // Get drawing objects and cache them
       bool overflow = false;
+      qint64 statStart = context->statStart();
       const QList<MapAirportMsa> *msaList = mapQuery->getAirportMsa(curBox, context->mapLayer, context->lazyUpdate, overflow);
+      context->statEnd(paintstat::QUERY, statStart);
       context->setQueryOverflow(overflow);
 
       if(msaList != nullptr)
@@ -103,5 +105,5 @@ void MapPainterMsa::drawMsaSymbol(const map::MapAirportMsa& airportMsa, float x,
     scale = context->mapLayer->getAirportMsaSymbolScale();
 
   // Draw the full symbol with all sectors
-  symbolPainter->drawAirportMsa(painter, airportMsa, x, y, size * 2, scale, true /* header */, true /* transparency */, fast);
+  symbolPainter->drawAirportMsaCached(painter, airportMsa, x, y, size * 2, scale, true /* header */, true /* transparency */, fast);
 }
@@ -17,15 +17,18 @@
 
 #include "mappainter/mappainternav.h"
 
+#include "common/symbolatlas.h"
 #include "common/symbolpainter.h"
 #include "common/mapcolors.h"
 #include "common/textplacement.h"
 #include "util/paintercontextsaver.h"
 #include "mapgui/maplayer.h"
 #include "query/mapquery.h"
+#include "query/airwayquery.h"
 #include "query/airwaytrackquery.h"
 #include "query/waypointtrackquery.h"
 #include "common/maptools.h"
+#include "mappainter/labelplacement.h"
 
 #include <QElapsedTimer>
 #include <QStringBuilder>
@@ -59,12 +62,28 @@ void MapPainterNav::render()
 
   context->szFont(context->textSizeAirway);
 
-  if(drawAirway && !context->isObjectOverflow())
+  // Neither texts nor arrows at this zoom - draw merged lines instead of single segments
+  bool drawAirwayPolylines = !context->mapLayer->isAirwayIdent() && !context->mapLayer->isAirwayInfo() &&
+                             (context->drawFast || !context->mapLayer->isAirwayDetails());
+
+  if(drawAirway && !context->isObjectOverflow() && drawAirwayPolylines)
+  {
+    context->startTimer("Airway fetch");
+    qint64 statStart = context->statStart();
+    const QVector<MapAirwayPolyline> *polylines = airwayQuery->getAirwayPolylines();
+    context->statEnd(paintstat::QUERY, statStart);
+    context->endTimer("Airway fetch");
+
+    paintAirwayPolylines(polylines);
+  }
+  else if(drawAirway && !context->isObjectOverflow())
   {
     // Draw airway lines
     context->startTimer("Airway fetch");
     QList<MapAirway> airways;
+    qint64 statStart = context->statStart();
     airwayQuery->getAirways(airways, curBox, context->mapLayer, context->lazyUpdate);
+    context->statEnd(paintstat::QUERY, statStart);
     context->endTimer("Airway fetch");
 
     paintAirways(&airways, context->drawFast, false /* track */);
@@ -77,7 +96,9 @@ void MapPainterNav::render()
     // Draw track lines
     context->startTimer("Track fetch");
     QList<MapAirway> tracks;
+    qint64 statStart = context->statStart();
     airwayQuery->getTracks(tracks, curBox, context->mapLayer, context->lazyUpdate);
+    context->statEnd(paintstat::QUERY, statStart);
     context->endTimer("Track fetch");
 
     paintAirways(&tracks, context->drawFast, true /* track */);
@@ -101,7 +122,9 @@ void MapPainterNav::render()
     context->startTimer("Waypoint fetch");
     // If airways are drawn we also have to go through waypoints
     QList<MapWaypoint> waypoints;
+    qint64 statStart = context->statStart();
     waypointQuery->getWaypointsAirway(waypoints, curBox, context->mapLayer, context->lazyUpdate, overflow);
+    context->statEnd(paintstat::QUERY, statStart);
     context->setQueryOverflow(overflow);
     context->endTimer("Waypoint fetch");
 
@@ -118,7 +141,9 @@ void MapPainterNav::render()
   if(drawNormalWp && !context->isObjectOverflow())
   {
     QList<MapWaypoint> waypoints;
+    qint64 statStart = context->statStart();
     waypointQuery->getWaypoints(waypoints, curBox, context->mapLayer, context->lazyUpdate, overflow);
+    context->statEnd(paintstat::QUERY, statStart);
     context->setQueryOverflow(overflow);
     maptools::insert(allWaypoints, waypoints);
   }
@@ -129,7 +154,9 @@ void MapPainterNav::render()
   context->startTimer("VOR");
   if(context->mapLayer->isVor() && context->objectTypes.testFlag(map::VOR) && !context->isObjectOverflow())
   {
+    qint64 statStart = context->statStart();
     const QList<MapVor> *vors = mapQuery->getVors(curBox, context->mapLayer, context->lazyUpdate, overflow);
+    context->statEnd(paintstat::QUERY, statStart);
     context->setQueryOverflow(overflow);
     if(vors != nullptr)
       maptools::insert(allVor, *vors);
@@ -141,7 +168,9 @@ void MapPainterNav::render()
   context->startTimer("NDB");
   if(context->mapLayer->isNdb() && context->objectTypes.testFlag(map::NDB) && !context->isObjectOverflow())
   {
+    qint64 statStart = context->statStart();
     const QList<MapNdb> *ndbs = mapQuery->getNdbs(curBox, context->mapLayer, context->lazyUpdate, overflow);
+    context->statEnd(paintstat::QUERY, statStart);
     context->setQueryOverflow(overflow);
     if(ndbs != nullptr)
       maptools::insert(allNdb, *ndbs);
@@ -153,7 +182,9 @@ void MapPainterNav::render()
   context->startTimer("Marker");
   if(context->mapLayer->isMarker() && context->objectTypes.testFlag(map::MARKER) && !context->isObjectOverflow())
   {
+    qint64 statStart = context->statStart();
     const QList<MapMarker> *markers = mapQuery->getMarkers(curBox, context->mapLayer, context->lazyUpdate, overflow);
+    context->statEnd(paintstat::QUERY, statStart);
     context->setQueryOverflow(overflow);
 
     if(markers != nullptr)
@@ -165,7 +196,9 @@ void MapPainterNav::render()
   context->startTimer("Hold");
   if(context->mapLayer->isHolding() && context->objectTypes.testFlag(map::HOLDING) && !context->isObjectOverflow())
   {
+    qint64 statStart = context->statStart();
     const QList<MapHolding> *holds = mapQuery->getHoldings(curBox, context->mapLayer, context->lazyUpdate, overflow);
+    context->statEnd(paintstat::QUERY, statStart);
     context->setQueryOverflow(overflow);
 
     if(holds != nullptr)
@@ -174,6 +207,42 @@ void MapPainterNav::render()
   context->endTimer("Hold");
 }
 
+void MapPainterNav::paintAirwayPolylines(const QVector<map::MapAirwayPolyline> *polylines)
+{
+  if(polylines == nullptr || polylines->isEmpty())
+    return;
+
+  // Select simplification level where the error is below one pixel
+  float degreesPerPixel = static_cast<float>(context->viewport->viewLatLonAltBox().width(GeoDataCoordinates::Degree)) /
+                          std::max(context->screenRect.width(), 1);
+  int level = AirwayQuery::airwayPolylineLevel(degreesPerPixel);
+
+  float linewidthAirway = context->szF(context->thicknessAirway, 1.f);
+  Marble::GeoPainter *painter = context->painter;
+
+  // Only type is needed for color
+  MapAirway colorAirway;
+
+  context->startTimer("Airway draw");
+  for(const MapAirwayPolyline& polyline : *polylines)
+  {
+    if((polyline.type == map::AIRWAY_JET && !context->objectTypes.testFlag(map::AIRWAYJ)) ||
+       (polyline.type == map::AIRWAY_VICTOR && !context->objectTypes.testFlag(map::AIRWAYV)))
+      continue;
+
+    if(!context->viewportRect.overlaps(polyline.bounding))
+      continue;
+
+    if(context->objCount())
+      break;
+
+    colorAirway.type = polyline.type;
+    painter->setPen(QPen(mapcolors::colorForAirwayOrTrack(colorAirway), linewidthAirway));
+    drawPolyline(painter, polyline.levels.at(std::min(level, polyline.levels.size() - 1)));
+  }
+  context->endTimer("Airway draw");
+}
+
 /* Draw airways and texts */
 void MapPainterNav::paintAirways(const QList<map::MapAirway> *airways, bool fast, bool track)
 {
@@ -312,7 +381,7 @@ void MapPainterNav::paintAirways(const QList<map::MapAirway> *airways, bool fast
 
   context->startTimer(track ? "Track draw text" : "Airway draw text");
   // Draw texts ----------------------------------------
-  TextPlacement textPlacement(painter, this, context->screenRect);
+  TextPlacement textPlacement(painter, this, context->screenRect, context->frameArena);
   if(!textlist.isEmpty())
   {
     painter->setPen(mapcolors::airwayTextColor);
@@ -379,6 +448,14 @@ void MapPainterNav::paintWaypoints(const QHash<int, map::MapWaypoint>& waypoints
   // Use margins for text placed on the right side of the object to avoid disappearing at the left screen border
   const static QMargins MARGINS(50, 10, 10, 10);
 
+  // Symbols are collected in the atlas first and drawn in one call before the texts
+  struct WaypointText
+  {
+    const MapWaypoint *waypoint;
+    float x, y, size;
+  };
+  QVector<WaypointText> texts;
+
   for(const MapWaypoint& waypoint : waypoints)
   {
     if(context->routeProcIdMap.contains(waypoint.getRef()) || context->routeProcIdMapRec.contains(waypoint.getRef()))
@@ -388,7 +465,7 @@ void MapPainterNav::paintWaypoints(const QHash<int, map::MapWaypoint>& waypoints
     if(wToSBuf(waypoint.position, x, y, MARGINS))
     {
       if(context->objCount())
-        return;
+        break;
 
       float size = context->szF(context->symbolSizeNavaid, context->mapLayer->getWaypointSymbolSize());
 
@@ -396,7 +473,10 @@ void MapPainterNav::paintWaypoints(const QHash<int, map::MapWaypoint>& waypoints
       if((waypoint.hasJetAirways && drawAirwayJ) || (waypoint.hasVictorAirways && drawAirwayV) || (waypoint.hasTracks && drawTrack))
         size = std::max(5.f, size);
 
-      symbolPainter->drawWaypointSymbol(context->painter, QColor(), x, y, size, false);
+      symbolAtlas->add(context->painter, SymbolAtlas::key(SymbolAtlas::WAYPOINT, size), static_cast<int>(std::ceil(size * 1.5f)) + 2,
+                       x, y, [this, size](QPainter *painter, float center) {
+        symbolPainter->drawWaypointSymbol(painter, QColor(), center, center, size, false);
+      });
 
       // If airways are drawn force display of the respecive waypoints
       if(context->mapLayer->isWaypointName() || // Draw all waypoint names or ...
@@ -404,9 +484,15 @@ void MapPainterNav::paintWaypoints(const QHash<int, map::MapWaypoint>& waypoints
           ((drawAirwayV && waypoint.hasVictorAirways) || (drawAirwayJ && waypoint.hasJetAirways))) ||
          (context->mapLayer->isTrackInfo() && // Draw names for specific airway waypoints
           (drawTrack && waypoint.hasTracks)))
-        symbolPainter->drawWaypointText(context->painter, waypoint, x, y, textflags::IDENT, size, fill);
+        texts.append({&waypoint, x, y, size});
     }
   }
+  symbolAtlas->flush(context->painter);
+
+  symbolPainter->setLabelPlacement(context->labelPlacement, label::WAYPOINT);
+  for(const WaypointText& text : qAsConst(texts))
+    symbolPainter->drawWaypointText(context->painter, *text.waypoint, text.x, text.y, textflags::IDENT, text.size, fill);
+  symbolPainter->setLabelPlacement(nullptr, 0);
 }
 
 void MapPainterNav::paintVors(const QHash<int, map::MapVor>& vors, bool drawFast)
@@ -440,7 +526,9 @@ void MapPainterNav::paintVors(const QHash<int, map::MapVor>& vors, bool drawFast
       else if(context->mapLayer->isVorIdent())
         flags = textflags::IDENT;
 
+      symbolPainter->setLabelPlacement(context->labelPlacement, label::VOR);
       symbolPainter->drawVorText(context->painter, vor, x, y, flags, size, fill);
+      symbolPainter->setLabelPlacement(nullptr, 0);
     }
   }
 }
@@ -455,6 +543,16 @@ void MapPainterNav::paintNdbs(const QHash<int, map::MapNdb>& ndbs, bool drawFast
   int sizeInt = static_cast<int>(size);
   QMargins margins(sizeInt, std::max(sizeInt, 50), sizeInt, sizeInt);
 
+  textflags::TextFlags flags;
+  if(context->mapLayer->isNdbInfo())
+    flags = textflags::IDENT | textflags::TYPE | textflags::FREQ;
+  else if(context->mapLayer->isNdbIdent())
+    flags = textflags::IDENT;
+
+  // Symbols are collected in the atlas first and drawn in one call before the texts
+  QVector<std::pair<const MapNdb *, QPointF> > texts;
+  int side = static_cast<int>(std::ceil(size)) + 4;
+
   for(const MapNdb& ndb : ndbs)
   {
     if(context->routeProcIdMap.contains(ndb.getRef()) || context->routeProcIdMapRec.contains(ndb.getRef()))
@@ -464,20 +562,23 @@ void MapPainterNav::paintNdbs(const QHash<int, map::MapNdb>& ndbs, bool drawFast
     if(wToSBuf(ndb.position, x, y, margins))
     {
       if(context->objCount())
-        return;
+        break;
 
-      symbolPainter->drawNdbSymbol(context->painter, x, y, size, false, drawFast);
-
-      textflags::TextFlags flags;
+      symbolAtlas->add(context->painter, SymbolAtlas::key(SymbolAtlas::NDB, size, drawFast), side, x, y,
+                       [this, size, drawFast](QPainter *painter, float center) {
+        symbolPainter->drawNdbSymbol(painter, center, center, size, false, drawFast);
+      });
 
-      if(context->mapLayer->isNdbInfo())
-        flags = textflags::IDENT | textflags::TYPE | textflags::FREQ;
-      else if(context->mapLayer->isNdbIdent())
-        flags = textflags::IDENT;
-
-      symbolPainter->drawNdbText(context->painter, ndb, x, y, flags, size, fill);
+      texts.append(std::make_pair(&ndb, QPointF(x, y)));
     }
   }
+  symbolAtlas->flush(context->painter);
+
+  symbolPainter->setLabelPlacement(context->labelPlacement, label::NDB);
+  for(const std::pair<const MapNdb *, QPointF>& text : qAsConst(texts))
+    symbolPainter->drawNdbText(context->painter, *text.first, static_cast<float>(text.second.x()),
+                               static_cast<float>(text.second.y()), flags, size, fill);
+  symbolPainter->setLabelPlacement(nullptr, 0);
 }
 
 void MapPainterNav::paintMarkers(const QList<map::MapMarker> *markers, bool drawFast)
@@ -46,6 +46,9 @@ private:
   void paintMarkers(const QList<map::MapMarker> *markers, bool drawFast);
   void paintAirways(const QList<map::MapAirway> *airways, bool fast, bool track);
 
+  /* Draw merged and simplified airway lines only. Used at low zoom levels where no texts or arrows are shown. */
+  void paintAirwayPolylines(const QVector<map::MapAirwayPolyline> *polylines);
+
 };
 
 #endif // LITTLENAVMAP_MAPPAINTERAIRPORT_H
@@ -18,12 +18,16 @@
 #include "mappainter/mappainterroute.h"
 
 #include "common/formatter.h"
+#include "common/framearena.h"
 #include "common/mapcolors.h"
 #include "common/proctypes.h"
 #include "common/symbolpainter.h"
 #include "common/textplacement.h"
 #include "common/unit.h"
+#include "mappainter/labelplacement.h"
 #include "geo/calculations.h"
+#include "geo/linestring.h"
+#include "mapgui/linegeometrycache.h"
 #include "mapgui/maplayer.h"
 #include "mapgui/mappaintwidget.h"
 #include "mapgui/mapscale.h"
@@ -63,6 +67,10 @@ void MapPainterRoute::render()
   routeProcIdMap.clear();
 
   context->startTimer("Route");
+
+  // Route labels are always drawn but block labels of other painters
+  symbolPainter->setLabelPlacement(context->labelPlacement, label::ROUTE);
+
   // Draw route including procedures =====================================
   if(context->objectDisplayTypes.testFlag(map::FLIGHTPLAN))
   {
@@ -89,6 +97,7 @@ void MapPainterRoute::render()
       paintProcedure(procIdMapDummy, procedureHighlight, 0, procedureHighlight.previewColor,
                      true /* preview */, false /* previewAll */);
   }
+  symbolPainter->setLabelPlacement(nullptr, 0);
   context->endTimer("Route");
 }
 
@@ -146,8 +155,9 @@ void MapPainterRoute::paintRoute()
   int passedRouteLeg = context->flags2.testFlag(opts2::MAP_ROUTE_DIM_PASSED) ? activeRouteLeg : 0;
 
   // Collect line text and geometry from the route
-  QStringList routeTexts;
-  QVector<Line> lines;
+  FrameArena::Scope scratch(*context->frameArena);
+  QStringList& routeTexts = scratch.strings();
+  QVector<Line>& lines = scratch.geoLines();
   bool drawAlternate = context->objectDisplayTypes.testFlag(map::FLIGHTPLAN_ALTERNATE);
 
   // Collect route - only coordinates and texts ===============================
@@ -327,7 +337,7 @@ void MapPainterRoute::paintRecommended(int passedRouteLeg, QSet<map::MapRef>& id
   } // for(int i = passedRouteLeg; i < route.size(); i++)
 }
 
-void MapPainterRoute::paintRouteInternal(QStringList routeTexts, QVector<Line> lines, int passedRouteLeg)
+void MapPainterRoute::paintRouteInternal(QStringList& routeTexts, QVector<Line>& lines, int passedRouteLeg)
 {
   const static QMargins MARGINS(100, 100, 100, 100);
 
@@ -360,6 +370,36 @@ void MapPainterRoute::paintRouteInternal(QStringList routeTexts, QVector<Line> l
       routeTexts.first().clear();
     }
 
+    // Project all legs once per frame. Screen geometry is taken from the cache when only the map or the aircraft moves.
+    // Active leg highlight and passed legs are still applied for each frame when drawing.
+    LineGeometryCache *geometryCache = mapPaintWidget->getLineGeometryCache();
+    QVector<QVector<QPolygonF> > legPolylines(lines.size());
+    QBitArray legProjected(lines.size());
+    for(int i = 0; i < lines.size(); i++)
+    {
+      const Line& line = lines.at(i);
+      if(line.isValid())
+      {
+        auto lineFunc = [&line]() -> LineString {
+                          return LineString(line.getPos1(), line.getPos2());
+                        };
+        legProjected.setBit(i, geometryCache->createPolylines(LineGeometryCache::Key(LineGeometryCache::ROUTE_LEG, i, 0),
+                                                              line.getPos1(), line.getPos2(), 0.f, lineFunc,
+                                                              context->screenRect, legPolylines[i]));
+      }
+    }
+
+    // Draw leg using cached screen geometry or fall back to projecting the line
+    auto drawLeg = [this, painter, &lines, &legPolylines, &legProjected](int index) -> void {
+                     if(legProjected.testBit(index))
+                     {
+                       for(const QPolygonF& polyline : legPolylines.at(index))
+                         drawPolyline(painter, polyline);
+                     }
+                     else
+                       drawLine(painter, lines.at(index));
+                   };
+
     bool transparent = context->flags2.testFlag(opts2::MAP_ROUTE_TRANSPARENT);
     float alpha = transparent ? (1.f - context->transparencyFlightplan) : 1.f;
     float lineWidth = transparent ? outerlinewidth : innerlinewidth;
@@ -378,7 +418,7 @@ void MapPainterRoute::paintRouteInternal(QStringList routeTexts, QVector<Line> l
       // Draw gray line for passed legs
       painter->setPen(routePassedPen);
       for(int i = 0; i < passed; i++)
-        drawLine(painter, lines.at(i));
+        drawLeg(i);
 
       if(!transparent)
       {
@@ -386,26 +426,26 @@ void MapPainterRoute::paintRouteInternal(QStringList routeTexts, QVector<Line> l
         {
           painter->setPen(routeAlternateOutlinePen);
           for(int idx = alternateOffset; idx < alternateOffset + route->getNumAlternateLegs(); idx++)
-            drawLine(painter, lines.at(idx - 1));
+            drawLeg(idx - 1);
         }
 
         // Draw background for legs ahead
         painter->setPen(routeOutlinePen);
         for(int i = passed; i < route->getDestinationAirportLegIndex(); i++)
-          drawLine(painter, lines.at(i));
+          drawLeg(i);
       }
 
       // Draw center line for legs ahead
       painter->setPen(routePen);
       for(int i = passed; i < destAptIdx; i++)
-        drawLine(painter, lines.at(i));
+        drawLeg(i);
 
       // Draw center line for alternates all from destination airport to each alternate
       if(alternateOffset != map::INVALID_INDEX_VALUE && drawAlternate)
       {
         mapcolors::adjustPenForAlternate(painter);
         for(int idx = alternateOffset; idx < alternateOffset + route->getNumAlternateLegs(); idx++)
-          drawLine(painter, lines.at(idx - 1));
+          drawLeg(idx - 1);
       }
     }
 
@@ -417,19 +457,20 @@ void MapPainterRoute::paintRouteInternal(QStringList routeTexts, QVector<Line> l
       if(!transparent)
       {
         painter->setPen(routeOutlinePen);
-        drawLine(painter, lines.at(activeRouteLeg - 1));
+        drawLeg(activeRouteLeg - 1);
       }
 
       painter->setPen(QPen(mapcolors::adjustAlphaF(flightplanActiveColor(), alpha), lineWidth,
                            Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
 
-      drawLine(painter, lines.at(activeRouteLeg - 1));
+      drawLeg(activeRouteLeg - 1);
     }
   }
   context->szFont(context->textSizeFlightplan * context->mapLayerRoute->getRouteFontScale());
 
   // Collect coordinates for text placement and lines first ============================
-  LineString positions;
+  FrameArena::Scope scratch(*context->frameArena);
+  LineString& positions = scratch.lineString();
   for(int i = 0; i < route->size(); i++)
     positions.append(route->value(i).getPosition());
 
@@ -449,7 +490,7 @@ void MapPainterRoute::paintRouteInternal(QStringList routeTexts, QVector<Line> l
                             context->flags2.testFlag(opts2::MAP_ROUTE_TRANSPARENT);
 
     // Use a text placement configuration without screen buffer to have labels moving correctly
-    TextPlacement textPlacement(painter, this, context->screenRect);
+    TextPlacement textPlacement(painter, this, context->screenRect, context->frameArena);
     textPlacement.setMinLengthForText(painter->fontMetrics().averageCharWidth() * 2);
     textPlacement.setDrawFast(context->drawFast);
     textPlacement.setLineWidth(outerlinewidth);
@@ -461,7 +502,7 @@ void MapPainterRoute::paintRouteInternal(QStringList routeTexts, QVector<Line> l
 
   // ================================================================================
   // Separate text placement object with screen buffer to avoid navaids popping out at screen edges
-  TextPlacement textPlacementBuf(painter, this, context->screenRect.marginsAdded(MARGINS));
+  TextPlacement textPlacementBuf(painter, this, context->screenRect.marginsAdded(MARGINS), context->frameArena);
   textPlacementBuf.setMinLengthForText(painter->fontMetrics().averageCharWidth() * 2);
   textPlacementBuf.setDrawFast(context->drawFast);
   textPlacementBuf.setLineWidth(outerlinewidth);
@@ -761,6 +802,10 @@ void MapPainterRoute::paintProcedure(QSet<map::MapRef>& idMap, const proc::MapPr
   int activeProcLeg = activeValid ? route->getActiveLegIndex() - legsRouteOffset : 0;
   int passedProcLeg = context->flags2.testFlag(opts2::MAP_ROUTE_DIM_PASSED) ? activeProcLeg : 0;
 
+  // Project all legs once for all drawing passes below
+  QVector<ProcedureLegScreen> screenLegs;
+  projectProcedure(legs, screenLegs);
+
   // Draw black background ========================================
 
   // Keep a stack of last painted geometry since some functions need access back into the history
@@ -778,7 +823,7 @@ void MapPainterRoute::paintProcedure(QSet<map::MapRef>& idMap, const proc::MapPr
         // Do not draw outline for circle-to-land approach legs
         draw = false;
 
-      paintProcedureSegment(legs, i, lastLines, nullptr, true /* no text */, previewAll, draw);
+      paintProcedureSegment(legs, screenLegs, i, lastLines, nullptr, true /* no text */, previewAll, draw);
     }
   }
 
@@ -839,7 +884,7 @@ void MapPainterRoute::paintProcedure(QSet<map::MapRef>& idMap, const proc::MapPr
     bool draw = !activeValid || activeProcLeg != i;
 
     // Paint segment
-    paintProcedureSegment(legs, i, lastLines, &drawTextLines, noText, previewAll, draw);
+    paintProcedureSegment(legs, screenLegs, i, lastLines, &drawTextLines, noText, previewAll, draw);
   }
 
   // Paint active on top of others ====================================================
@@ -857,7 +902,8 @@ void MapPainterRoute::paintProcedure(QSet<map::MapRef>& idMap, const proc::MapPr
     else if(legs.at(activeProcLeg).isManual())
       mapcolors::adjustPenForManual(painter);
 
-    paintProcedureSegment(legs, activeProcLeg, lastActiveLines, &lastActiveDrawTextLines, noText, previewAll, true /* draw */);
+    paintProcedureSegment(legs, screenLegs, activeProcLeg, lastActiveLines, &lastActiveDrawTextLines, noText, previewAll,
+                          true /* draw */);
   }
 
   // Draw text along lines only on low zoom factors ========
@@ -935,7 +981,7 @@ void MapPainterRoute::paintProcedure(QSet<map::MapRef>& idMap, const proc::MapPr
       bool textOnLineCenter = context->flags2.testFlag(opts2::MAP_ROUTE_TEXT_BACKGROUND) ||
                               context->flags2.testFlag(opts2::MAP_ROUTE_TRANSPARENT);
 
-      TextPlacement textPlacement(painter, this, context->screenRect);
+      TextPlacement textPlacement(painter, this, context->screenRect, context->frameArena);
       textPlacement.setMinLengthForText(painter->fontMetrics().averageCharWidth() * 2);
       textPlacement.setArrowForEmpty(previewAll); // Arrow for empty texts
       textPlacement.setTextOnLineCenter(textOnLineCenter);
@@ -988,11 +1034,52 @@ void MapPainterRoute::paintProcedure(QSet<map::MapRef>& idMap, const proc::MapPr
   } // for(int i = legs.size() - 1; i >= 0; i--)
 }
 
-void MapPainterRoute::paintProcedureSegment(const proc::MapProcedureLegs& legs, int index, QVector<QLineF>& lastLines,
-                                            QVector<DrawText> *drawTextLines, bool noText, bool previewAll, bool draw)
+void MapPainterRoute::projectProcedure(const proc::MapProcedureLegs& legs, QVector<ProcedureLegScreen>& screenLegs)
+{
+  screenLegs.resize(legs.size());
+
+  // Same size for all legs
+  QSize size = scale->getScreeenSizeForRect(legs.bounding);
+  bool approachDetail = context->mapLayerRoute->isApproachDetail();
+
+  for(int i = 0; i < legs.size(); i++)
+  {
+    const proc::MapProcedureLeg& leg = legs.at(i);
+    if(!leg.line.isValid())
+      continue;
+
+    ProcedureLegScreen& screenLeg = screenLegs[i];
+
+    // Use visible dummy here since we need to call the method that also returns coordinates outside the screen
+    bool hidden;
+    wToS(leg.line, screenLeg.line, size, &hidden);
+
+    if(approachDetail)
+    {
+      if(leg.interceptPos.isValid())
+        screenLeg.interceptPoint = wToS(leg.interceptPos, size, &hidden);
+
+      if(leg.recFixPos.isValid())
+        screenLeg.recFixPoint = wToS(leg.recFixPos, size, &hidden);
+    }
+    else
+    {
+      // Needed for simplified drawing only
+      bool visible1, visible2, hidden1, hidden2;
+      wToS(leg.line.getPos1(), DEFAULT_WTOS_SIZE, &visible1, &hidden1);
+      wToS(leg.line.getPos2(), DEFAULT_WTOS_SIZE, &visible2, &hidden2);
+      screenLeg.hiddenSimple = hidden1 || hidden2;
+    }
+  }
+}
+
+void MapPainterRoute::paintProcedureSegment(const proc::MapProcedureLegs& legs, const QVector<ProcedureLegScreen>& screenLegs,
+                                            int index, QVector<QLineF>& lastLines, QVector<DrawText> *drawTextLines, bool noText,
+                                            bool previewAll, bool draw)
 {
   const static QMargins MARGINS(50, 50, 50, 50);
   const proc::MapProcedureLeg& leg = legs.at(index);
+  const ProcedureLegScreen& screenLeg = screenLegs.at(index);
 
   if(previewAll && leg.isMissed())
     return;
@@ -1004,13 +1091,7 @@ void MapPainterRoute::paintProcedureSegment(const proc::MapProcedureLegs& legs,
     return;
 
   const proc::MapProcedureLeg *prevLeg = index > 0 ? &legs.at(index - 1) : nullptr;
-
-  QSize size = scale->getScreeenSizeForRect(legs.bounding);
-
-  // Use visible dummy here since we need to call the method that also returns coordinates outside the screen
-  QLineF line;
-  bool hidden;
-  wToS(leg.line, line, size, &hidden);
+  QLineF line = screenLeg.line;
 
   if(leg.disabled)
     return;
@@ -1036,11 +1117,7 @@ void MapPainterRoute::paintProcedureSegment(const proc::MapProcedureLegs& legs,
   // Draw lines simplified if no point is hidden to avoid weird things at high zoom factors in spherical projection
   if(!context->mapLayerRoute->isApproachDetail())
   {
-    bool visible1, visible2, hidden1, hidden2;
-    wToS(leg.line.getPos1(), DEFAULT_WTOS_SIZE, &visible1, &hidden1);
-    wToS(leg.line.getPos2(), DEFAULT_WTOS_SIZE, &visible2, &hidden2);
-
-    if(!hidden1 && !hidden2)
+    if(!screenLeg.hiddenSimple)
     {
       // QLineF simpleLine(lastLine.p2(), line.p1());
       if(draw)
@@ -1059,7 +1136,7 @@ void MapPainterRoute::paintProcedureSegment(const proc::MapProcedureLegs& legs,
     return;
   }
 
-  QPointF interceptPoint = wToS(leg.interceptPos, size, &hidden);
+  QPointF interceptPoint = screenLeg.interceptPoint;
 
   bool showDistance = !leg.noDistanceDisplay();
 
@@ -1070,7 +1147,7 @@ void MapPainterRoute::paintProcedureSegment(const proc::MapProcedureLegs& legs,
     {
       if(draw)
       {
-        QPointF point = wToS(leg.recFixPos, size, &hidden);
+        const QPointF& point = screenLeg.recFixPoint;
         if(leg.correctedArc)
         {
           // Arc with stub
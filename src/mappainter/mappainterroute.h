@@ -77,9 +77,18 @@ private:
     bool distance, course;
   };
 
+  /* Screen coordinates of a procedure leg. Calculated once per procedure and frame and used by all drawing passes
+   * for outline, center line and active leg. */
+  struct ProcedureLegScreen
+  {
+    QLineF line;
+    QPointF interceptPoint, recFixPoint;
+    bool hiddenSimple = true; /* One of the line points is hidden by the globe */
+  };
+
   /* Draw route only legs - not procedures */
   void paintRoute();
-  void paintRouteInternal(QStringList routeTexts, QVector<atools::geo::Line> lines, int passedRouteLeg);
+  void paintRouteInternal(QStringList& routeTexts, QVector<atools::geo::Line>& lines, int passedRouteLeg);
 
   /* Draw recommended navaids */
   void paintRecommended(int passedRouteLeg, QSet<map::MapRef>& idMap);
@@ -98,9 +107,12 @@ private:
   void paintProcedure(QSet<map::MapRef>& idMap,
                       const proc::MapProcedureLegs& legs, int legsRouteOffset, const QColor& color, bool preview, bool previewAll);
 
+  /* Convert all leg points of a procedure to screen coordinates */
+  void projectProcedure(const proc::MapProcedureLegs& legs, QVector<ProcedureLegScreen>& screenLegs);
+
   /* Draw line and collect information for text along lines.  Called from destination to departure/aircraft */
-  void paintProcedureSegment(const proc::MapProcedureLegs& legs, int index, QVector<QLineF>& lastLines, QVector<DrawText> *drawTextLines,
-                             bool noText, bool previewAll, bool draw);
+  void paintProcedureSegment(const proc::MapProcedureLegs& legs, const QVector<ProcedureLegScreen>& screenLegs, int index,
+                             QVector<QLineF>& lastLines, QVector<DrawText> *drawTextLines, bool noText, bool previewAll, bool draw);
 
   /* Draw procedure position including text label and icon */
   void paintProcedurePoint(QSet<map::MapRef>& idMap,
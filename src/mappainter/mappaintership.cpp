@@ -18,6 +18,7 @@
 #include "mappainter/mappaintership.h"
 
 #include "app/navapp.h"
+#include "common/symbolatlas.h"
 #include "fs/sc/simconnectaircraft.h"
 #include "fs/sc/simconnectuseraircraft.h"
 #include "mapgui/maplayer.h"
@@ -62,10 +63,12 @@ void MapPainterShip::render()
           if(wToSBuf(ac.getPosition(), x, y, MARGINS, &hidden))
           {
             if(!hidden)
-              paintAiVehicle(ac, x, y, false /* forceLabelNearby */);
+              // Ships have no labels
+              paintAiVehicleSymbol(ac, x, y);
           }
         }
       }
+      symbolAtlas->flush(context->painter);
     }
   }
 }
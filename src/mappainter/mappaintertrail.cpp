@@ -21,6 +21,7 @@
 #include "common/aircrafttrail.h"
 #include "fs/sc/simconnectuseraircraft.h"
 #include "mapgui/mappaintwidget.h"
+#include "options/optiondata.h"
 #include "route/route.h"
 #include "util/paintercontextsaver.h"
 #include "geo/linestring.h"
@@ -66,8 +67,17 @@ void MapPainterTrail::render()
       if(context->route->getSizeWithoutAlternates() > 2)
         maxAltitude = std::max(context->route->getCruiseAltitudeFt(), maxAltitude);
 
+      // Show only trail recorded in the given time span before the last position
+      int fromIndex = 0;
+      int maxMinutes = OptionData::instance().getAircraftTrailMaxMinutes();
+      if(maxMinutes > 0)
+        fromIndex = aircraftTrail.getIndexForTime(aircraftTrail.getMaxTimestampMs() - maxMinutes * 60000L);
+
       atools::util::PainterContextSaver saver(context->painter);
-      const QVector<atools::geo::LineString> lineStrings = aircraftTrail.getLineStrings(mapPaintWidget->getUserAircraft().getPosition());
+      // Leave out all trail chunks outside of the viewport and use simplified trail for the current zoom
+      const QVector<atools::geo::LineString> lineStrings = aircraftTrail.getLineStrings(mapPaintWidget->getUserAircraft().getPosition(),
+                                                                                        context->viewportRect, context->mapLayerEffective,
+                                                                                        fromIndex);
       paintAircraftTrail(lineStrings, aircraftTrail.getMinAltitude(), maxAltitude);
     }
   }
@@ -20,12 +20,16 @@
 #include "atools.h"
 #include "common/symbolpainter.h"
 #include "mapgui/maplayer.h"
+#include "mapgui/mapscale.h"
+#include "mappainter/labelplacement.h"
 #include "app/navapp.h"
 #include "query/mapquery.h"
+#include "query/querytypes.h"
 #include "userdata/userdataicons.h"
 #include "util/paintercontextsaver.h"
 
 #include <QElapsedTimer>
+#include <cmath>
 
 #include <marble/GeoDataLineString.h>
 #include <marble/GeoPainter.h>
@@ -53,8 +57,71 @@ void MapPainterUser::render()
   context->szFont(context->textSizeUserpoint);
 
   // Always call paint to fill cache
-  paintUserpoints(mapQuery->getUserdataPoints(curBox, context->userPointTypes, context->userPointTypesAll,
-                                              context->userPointTypeUnknown, context->distanceNm), context->drawFast);
+  qint64 statStart = context->statStart();
+
+  // Cluster size on screen is three times the symbol size - convert to degrees for the SQL grid
+  float size = context->szF(context->symbolSizeUserpoint, context->mapLayer->getUserPointSymbolSize());
+  float cellSizeDeg = scale->getNmPerPixel() * size * 3.f / 60.f;
+
+  // Reuse last result if neither view, filter nor userpoints have changed
+  UserpointCacheKey key;
+  key.rect = curBox;
+  key.types = context->userPointTypes;
+  key.typesAll = context->userPointTypesAll;
+  key.unknownType = context->userPointTypeUnknown;
+  key.distanceNm = context->distanceNm;
+  key.cellSizeDeg = cellSizeDeg;
+  key.threshold = context->mapLayer->getUserpointClusterThreshold();
+  key.revision = query::revision(query::REV_USERPOINTS);
+  key.valid = true;
+
+  if(!(key == cacheKey))
+  {
+    cachedUserpoints.clear();
+    cachedClusters.clear();
+    if(!mapQuery->getUserdataPointClusters(cachedUserpoints, cachedClusters, curBox, key.types, key.typesAll, key.unknownType,
+                                           key.distanceNm, cellSizeDeg, key.threshold))
+      cachedUserpoints = mapQuery->getUserdataPoints(curBox, key.types, key.typesAll, key.unknownType, key.distanceNm);
+    cacheKey = key;
+  }
+  context->statEnd(paintstat::QUERY, statStart);
+
+  paintUserpointClusters(cachedClusters, size);
+  paintUserpoints(cachedUserpoints, context->drawFast);
+}
+
+bool MapPainterUser::UserpointCacheKey::operator==(const UserpointCacheKey& other) const
+{
+  return valid == other.valid && revision == other.revision && threshold == other.threshold && unknownType == other.unknownType &&
+         atools::almostEqual(distanceNm, other.distanceNm) && atools::almostEqual(cellSizeDeg, other.cellSizeDeg) &&
+         rect == other.rect && types == other.types && typesAll == other.typesAll;
+}
+
+void MapPainterUser::paintUserpointClusters(const QList<MapUserpointCluster>& clusters, float size)
+{
+  if(clusters.isEmpty())
+    return;
+
+  context->painter->setPen(QPen(Qt::black, std::max(1.f, size / 10.f)));
+  context->painter->setBrush(QColor(255, 255, 180, 220));
+
+  for(const MapUserpointCluster& cluster : clusters)
+  {
+    float x, y;
+    if(wToSBuf(cluster.position, x, y, QMargins(10, 10, 10, 10)))
+    {
+      if(context->objCount())
+        return;
+
+      // Grow circle slightly with number of points
+      float radius = std::min(size * 1.5f, size / 2.f + static_cast<float>(std::log10(cluster.count)) * size / 3.f);
+      context->painter->drawEllipse(QPointF(x, y), radius, radius);
+
+      if(!context->drawFast)
+        context->painter->drawText(QRectF(x - radius, y - radius, radius * 2.f, radius * 2.f), Qt::AlignCenter,
+                                   cluster.count > 9999 ? QString("%1k").arg(cluster.count / 1000) : QString::number(cluster.count));
+    }
+  }
 }
 
 void MapPainterUser::paintUserpoints(const QList<MapUserpoint>& userpoints, bool drawFast)
@@ -62,6 +129,28 @@ void MapPainterUser::paintUserpoints(const QList<MapUserpoint>& userpoints, bool
   const static QMargins MARGINS(100, 10, 10, 10);
   bool fill = context->flags2 & opts2::MAP_USERPOINT_TEXT_BACKGROUND;
   UserdataIcons *icons = NavApp::getUserdataIcons();
+  float size = context->szF(context->symbolSizeUserpoint, context->mapLayer->getUserPointSymbolSize());
+  int intSize = atools::roundToInt(size);
+  bool drawLabels = context->mapLayer->isUserpointInfo() && !drawFast;
+
+  // Icons are collected per type and drawn in one call for each type
+  // Keep pixmap copies since the icon cache might drop entries while collecting
+  struct IconBatch
+  {
+    QPixmap pixmap;
+    icon::TextPlacement textPlacement = icon::ICON_LABEL_LEFT;
+    QVector<QPainter::PixmapFragment> fragments;
+  };
+  QHash<QString, IconBatch> batches;
+
+  // Labels are drawn after all icons
+  struct Label
+  {
+    const MapUserpoint *userpoint;
+    icon::TextPlacement textPlacement;
+    float x, y;
+  };
+  QVector<Label> labels;
 
   // Use margins for text placed on the right side of the object to avoid disappearing at the left screen border
   for(const MapUserpoint& userpoint : userpoints)
@@ -72,67 +161,88 @@ void MapPainterUser::paintUserpoints(const QList<MapUserpoint>& userpoints, bool
     if(visible)
     {
       if(context->objCount())
-        return;
+        // Draw what was collected so far
+        break;
 
       if(icons->hasType(userpoint.type) || context->userPointTypeUnknown)
       {
-        float size = context->szF(context->symbolSizeUserpoint, context->mapLayer->getUserPointSymbolSize());
         if(userpoint.type == "Logbook")
         {
           x += size / 2.f;
           y += size / 2.f;
         }
 
-        icon::TextPlacement textPlacementHint = icon::ICON_LABEL_LEFT;
-        const QPixmap *iconPixmap = icons->getIconPixmap(userpoint.type, atools::roundToInt(size), &textPlacementHint);
-        context->painter->drawPixmap(QPointF(x - size / 2.f, y - size / 2.f), *iconPixmap);
+        auto it = batches.find(userpoint.type);
+        if(it == batches.end())
+        {
+          IconBatch batch;
+          batch.pixmap = *icons->getIconPixmap(userpoint.type, intSize, &batch.textPlacement);
+          it = batches.insert(userpoint.type, batch);
+        }
+
+        // Fragment is placed by center - calculate center for an icon drawn at the top left corner like before
+        const QPixmap& pixmap = it->pixmap;
+        qreal ratio = pixmap.devicePixelRatioF();
+        it->fragments.append(QPainter::PixmapFragment::create(QPointF(x - size / 2.f + pixmap.width() / ratio / 2.,
+                                                                      y - size / 2.f + pixmap.height() / ratio / 2.),
+                                                              QRectF(pixmap.rect()), 1. / ratio, 1. / ratio));
 
         // Do not draw labels for airport add-on marks
-        if(context->mapLayer->isUserpointInfo() && !drawFast && !userpoint.isAddon())
-        {
-          int maxTextLength = context->mapLayer->getMaxTextLengthUserpoint();
-          QStringList texts;
-          texts.append(atools::elideTextShort(userpoint.ident, maxTextLength));
-          QString name = userpoint.name != userpoint.ident ? atools::elideTextShort(userpoint.name, maxTextLength) : QString();
-          if(!name.isEmpty())
-            texts.append(name);
-
-          textatt::TextAttributes textatts = textatt::NONE;
-          float xpos = x, ypos = y;
-          float offset = size / 2.f + size / 10.f;
-
-          // Decide text placement by hint given by userpoint type
-          switch(textPlacementHint)
-          {
-            case icon::ICON_LABEL_TOP:
-              // NDB - place on top
-              textatts = textatt::ABOVE | textatt::CENTER;
-              ypos = y - offset;
-              break;
-
-            case icon::ICON_LABEL_RIGHT:
-              // VOR - alight left and place right
-              textatts = textatt::RIGHT;
-              xpos = x + offset;
-              break;
-
-            case icon::ICON_LABEL_BOTTOM:
-              // Place on bottom
-              textatts = textatt::BELOW | textatt::CENTER;
-              ypos = y + offset;
-              break;
-
-            case icon::ICON_LABEL_LEFT:
-              // Airports and waypoints - alight right and place left
-              textatts = textatt::LEFT;
-              xpos = x - offset;
-              break;
-          }
-
-          symbolPainter->textBoxF(context->painter, texts, QPen(Qt::black), xpos, ypos, textatts, fill ? 255 : 0);
-
-        } // if(context->mapLayer->isUserpointInfo() && !drawFast)
+        if(drawLabels && !userpoint.isAddon())
+          labels.append({&userpoint, it->textPlacement, x, y});
       } // if(icons->hasType(userpoint.type) || context->userPointTypeUnknown)
     } // if(visible)
   } // for(const MapUserpoint& userpoint : userpoints)
+
+  // Draw icons batched by type ===========================================================
+  for(const IconBatch& batch : qAsConst(batches))
+    context->painter->drawPixmapFragments(batch.fragments.constData(), batch.fragments.size(), batch.pixmap);
+
+  // Draw labels ===========================================================
+  int maxTextLength = context->mapLayer->getMaxTextLengthUserpoint();
+  float offset = size / 2.f + size / 10.f;
+  symbolPainter->setLabelPlacement(context->labelPlacement, label::USERPOINT);
+  for(const Label& label : qAsConst(labels))
+  {
+    const MapUserpoint& userpoint = *label.userpoint;
+    QStringList texts;
+    texts.append(atools::elideTextShort(userpoint.ident, maxTextLength));
+    QString name = userpoint.name != userpoint.ident ? atools::elideTextShort(userpoint.name, maxTextLength) : QString();
+    if(!name.isEmpty())
+      texts.append(name);
+
+    textatt::TextAttributes textatts = textatt::NONE;
+    float xpos = label.x, ypos = label.y;
+
+    // Decide text placement by hint given by userpoint type
+    switch(label.textPlacement)
+    {
+      case icon::ICON_LABEL_TOP:
+        // NDB - place on top
+        textatts = textatt::ABOVE | textatt::CENTER;
+        ypos = label.y - offset;
+        break;
+
+      case icon::ICON_LABEL_RIGHT:
+        // VOR - alight left and place right
+        textatts = textatt::RIGHT;
+        xpos = label.x + offset;
+        break;
+
+      case icon::ICON_LABEL_BOTTOM:
+        // Place on bottom
+        textatts = textatt::BELOW | textatt::CENTER;
+        ypos = label.y + offset;
+        break;
+
+      case icon::ICON_LABEL_LEFT:
+        // Airports and waypoints - alight right and place left
+        textatts = textatt::LEFT;
+        xpos = label.x - offset;
+        break;
+    }
+
+    symbolPainter->textBoxF(context->painter, texts, QPen(Qt::black), xpos, ypos, textatts, fill ? 255 : 0);
+  }
+  symbolPainter->setLabelPlacement(nullptr, 0);
 }
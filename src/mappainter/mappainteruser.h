@@ -20,12 +20,16 @@
 
 #include "mappainter/mappainter.h"
 
-namespace map {
-struct MapUserpoint;
-}
+#include "common/maptypes.h"
+
+#include <marble/GeoDataLatLonBox.h>
 
 /*
- * Draws userpoints. Does not use caching to avoid update problems when changing data.
+ * Draws userpoints. Points are aggregated into clusters if the layer threshold is exceeded.
+ *
+ * The query result is cached and reused as long as view, filter and the userpoint revision are unchanged.
+ * The revision is incremented by UserdataController on each modification.
+ * Icons are drawn in one batch per userpoint type.
  */
 class MapPainterUser :
   public MapPainter
@@ -41,6 +45,26 @@ public:
 private:
   void paintUserpoints(const QList<map::MapUserpoint>& userpoints, bool drawFast);
 
+  /* Draw circles with point count for aggregated userpoints */
+  void paintUserpointClusters(const QList<map::MapUserpointCluster>& clusters, float size);
+
+  /* Parameters for the last query. Result is reused if all are equal. */
+  struct UserpointCacheKey
+  {
+    Marble::GeoDataLatLonBox rect;
+    QStringList types, typesAll;
+    bool unknownType = false;
+    float distanceNm = 0.f, cellSizeDeg = 0.f;
+    int threshold = 0;
+    quint32 revision = 0;
+    bool valid = false;
+
+    bool operator==(const UserpointCacheKey& other) const;
+  };
+
+  UserpointCacheKey cacheKey;
+  QList<map::MapUserpoint> cachedUserpoints;
+  QList<map::MapUserpointCluster> cachedClusters;
 };
 
 #endif // LITTLENAVMAP_MAPPAINTERUSER_H
@@ -18,6 +18,7 @@
 #include "mappainter/mappaintervehicle.h"
 
 #include "common/mapcolors.h"
+#include "common/symbolatlas.h"
 #include "common/symbolpainter.h"
 #include "common/unit.h"
 #include "common/vehicleicons.h"
@@ -34,6 +35,8 @@
 
 #include <QStringBuilder>
 
+#include <cmath>
+
 using namespace Marble;
 using namespace atools::geo;
 using namespace map;
@@ -54,24 +57,21 @@ MapPainterVehicle::~MapPainterVehicle()
 
 }
 
-void MapPainterVehicle::paintAiVehicle(const SimConnectAircraft& vehicle, float x, float y, bool forceLabelNearby)
+float MapPainterVehicle::paintAiVehicleSymbol(const SimConnectAircraft& vehicle, float x, float y)
 {
   if(vehicle.isUser())
-    return;
+    return 0.f;
 
   const Pos& pos = vehicle.getPosition();
 
   if(!pos.isValid())
-    return;
+    return 0.f;
 
   float rotate = calcRotation(vehicle);
 
   if(rotate < map::INVALID_COURSE_VALUE)
   {
     // Position is visible
-    context->painter->translate(x, y);
-    context->painter->rotate(rotate);
-
     int minSize;
     if(vehicle.isUser())
       minSize = 32;
@@ -79,20 +79,51 @@ void MapPainterVehicle::paintAiVehicle(const SimConnectAircraft& vehicle, float
       minSize = vehicle.isAnyBoat() ? context->mapLayer->getAiAircraftSize() - 4 : context->mapLayer->getAiAircraftSize();
 
     float size = std::max(context->szF(context->symbolSizeAircraftAi, minSize), scale->getPixelForFeet(vehicle.getModelSize()));
-    float offset = -(size / 2.f);
-
-    // Draw symbol
-    context->painter->drawPixmap(QPointF(offset, offset),
-                                 *NavApp::getVehicleIcons()->pixmapFromCache(vehicle, static_cast<int>(size), 0));
-
-    context->painter->resetTransform();
-
-    // Build text label
-    if(!vehicle.isAnyBoat())
+    int intSize = static_cast<int>(size);
+
+    // Rotation in five degree steps to limit the number of pre-rendered symbols
+    int rotateStep = atools::roundToInt(atools::geo::normalizeCourse(rotate) / 5.f) % 72;
+    quint64 attributes = static_cast<quint64>(rotateStep) | static_cast<quint64>(VehicleIcons::iconKey(vehicle)) << 7;
+    quint64 key = SymbolAtlas::key(SymbolAtlas::VEHICLE, intSize, attributes);
+
+    // Get icon without blocking if not in atlas - might return the icon in another size while rendering in background
+    int pixmapSize = intSize;
+    const QPixmap *pixmap = symbolAtlas->contains(key) ? nullptr :
+                            NavApp::getVehicleIcons()->pixmapFromCacheNearest(vehicle, intSize, pixmapSize);
+
+    if(pixmapSize == intSize)
+      // Queue symbol - side is big enough for the rotated square
+      symbolAtlas->add(context->painter, key, static_cast<int>(std::ceil(intSize * 1.42f)) + 2, x, y,
+                       [&vehicle, intSize, rotateStep](QPainter *painter, float center) {
+        painter->translate(center, center);
+        painter->rotate(rotateStep * 5.f);
+        painter->drawPixmap(QPointF(-intSize / 2.f, -intSize / 2.f), *NavApp::getVehicleIcons()->pixmapFromCache(vehicle, intSize, 0));
+      });
+    else
     {
-      context->szFont(context->textSizeAircraftAi);
-      paintTextLabelAi(x, y, size, vehicle, forceLabelNearby);
+      // Draw scaled substitute directly to keep it out of the atlas
+      QPainter *painter = context->painter;
+      painter->save();
+      painter->translate(x, y);
+      painter->rotate(rotateStep * 5.f);
+      float pixmapScale = static_cast<float>(intSize) / pixmapSize;
+      painter->scale(pixmapScale, pixmapScale);
+      painter->drawPixmap(QPointF(-pixmapSize / 2.f, -pixmapSize / 2.f), *pixmap);
+      painter->restore();
     }
+
+    return size;
+  }
+  return 0.f;
+}
+
+void MapPainterVehicle::paintAiVehicleLabel(const SimConnectAircraft& vehicle, float x, float y, float size, bool forceLabelNearby)
+{
+  // Build text label
+  if(!vehicle.isAnyBoat())
+  {
+    context->szFont(context->textSizeAircraftAi);
+    paintTextLabelAi(x, y, size, vehicle, forceLabelNearby);
   }
 }
 
@@ -134,7 +165,8 @@ void MapPainterVehicle::paintTurnPath(const atools::fs::sc::SimConnectUserAircra
 {
   if(context->objectDisplayTypes & map::AIRCRAFT_TURN_PATH && userAircraft.isFlying())
   {
-    const atools::geo::Pos& aircraftPos = mapPaintWidget->getUserAircraft().getPosition();
+    // Start at predicted position to keep the path attached to the aircraft symbol
+    const atools::geo::Pos aircraftPos = mapPaintWidget->getScreenIndexConst()->getPredictedUserPosition().asPos();
     if(aircraftPos.isValid())
     {
       float groundSpeedKts, turnSpeedDegPerSec;
@@ -59,7 +59,13 @@ protected:
   void paintTurnPath(const atools::fs::sc::SimConnectUserAircraft& userAircraft);
 
   void paintUserAircraft(const atools::fs::sc::SimConnectUserAircraft& userAircraft, float x, float y);
-  void paintAiVehicle(const atools::fs::sc::SimConnectAircraft& vehicle, float x, float y, bool forceLabelNearby);
+
+  /* Queue AI aircraft or ship symbol in the symbol atlas. Call symbolAtlas->flush() to draw.
+   * Returns symbol size or 0 if not drawn. */
+  float paintAiVehicleSymbol(const atools::fs::sc::SimConnectAircraft& vehicle, float x, float y);
+
+  /* Draw label for a symbol drawn by paintAiVehicleSymbol() */
+  void paintAiVehicleLabel(const atools::fs::sc::SimConnectAircraft& vehicle, float x, float y, float size, bool forceLabelNearby);
 
   void paintTextLabelUser(float x, float y, int size, const atools::fs::sc::SimConnectUserAircraft& aircraft);
   void paintTextLabelAi(float x, float y, float size, const atools::fs::sc::SimConnectAircraft& aircraft, bool forceLabelNearby);
@@ -24,7 +24,6 @@
 #include "util/paintercontextsaver.h"
 #include "app/navapp.h"
 #include "route/route.h"
-#include "fs/weather/metar.h"
 #include "weather/weatherreporter.h"
 
 #include <marble/GeoPainter.h>
@@ -57,8 +56,10 @@ void MapPainterWeather::render()
   bool overflow = false;
 
   const GeoDataLatLonAltBox& curBox = context->viewport->viewLatLonAltBox();
+  qint64 statStart = context->statStart();
   const QList<MapAirport> *airportCache =
     mapQuery->getAirports(curBox, context->mapLayer, context->lazyUpdate, context->objectTypes, overflow);
+  context->statEnd(paintstat::QUERY, statStart);
   context->setQueryOverflow(overflow);
 
   // Collect all airports that are visible from cache ======================================
@@ -129,19 +130,18 @@ void MapPainterWeather::render()
   WeatherReporter *reporter = NavApp::getWeatherReporter();
   for(const PaintAirportType& airportWeather: qAsConst(visibleAirportWeather))
   {
-    atools::fs::weather::Metar metar =
-      reporter->getAirportWeather(*airportWeather.airport, true /* stationOnly */);
+    map::AirportWeatherSummary weather = reporter->getAirportWeatherSummary(*airportWeather.airport, true /* stationOnly */);
 
-    if(metar.isValid())
-      drawAirportWeather(metar, static_cast<float>(airportWeather.point.x()), static_cast<float>(airportWeather.point.y()));
+    if(weather.isValid())
+      drawAirportWeather(weather, static_cast<float>(airportWeather.point.x()), static_cast<float>(airportWeather.point.y()));
   }
 }
 
-void MapPainterWeather::drawAirportWeather(const atools::fs::weather::Metar& metar, float x, float y)
+void MapPainterWeather::drawAirportWeather(const map::AirportWeatherSummary& weather, float x, float y)
 {
   float size = context->szF(context->symbolSizeAirportWeather, context->mapLayer->getAirportSymbolSize());
   bool windBarbs = context->mapLayer->isAirportWeatherDetails();
 
-  symbolPainter->drawAirportWeather(context->painter, metar, x - size * 4.f / 5.f, y - size * 4.f / 5.f, size,
-                                    true /* Wind pointer*/, windBarbs, context->drawFast);
+  symbolPainter->drawAirportWeatherCached(context->painter, weather, x - size * 4.f / 5.f, y - size * 4.f / 5.f, size,
+                                          true /* Wind pointer*/, windBarbs, context->drawFast);
 }
@@ -20,12 +20,8 @@
 
 #include "mappainter/mappainter.h"
 
-namespace atools {
-namespace fs {
-namespace weather {
-class Metar;
-}
-}
+namespace map {
+struct AirportWeatherSummary;
 }
 
 struct PaintAirportType;
@@ -45,7 +41,7 @@ public:
   virtual void render() override;
 
 private:
-  void drawAirportWeather(const atools::fs::weather::Metar& metar, float x, float y);
+  void drawAirportWeather(const map::AirportWeatherSummary& weather, float x, float y);
 
 };
 
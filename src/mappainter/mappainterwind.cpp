@@ -17,6 +17,7 @@
 
 #include "mappainter/mappainterwind.h"
 
+#include "common/symbolatlas.h"
 #include "common/symbolpainter.h"
 #include "mapgui/maplayer.h"
 #include "util/paintercontextsaver.h"
@@ -45,9 +46,11 @@ void MapPainterWind::render()
 
   atools::util::PainterContextSaver saver(context->painter);
 
+  qint64 statStart = context->statStart();
   const atools::grib::WindPosList *windForRect =
     NavApp::getWindReporter()->getWindForRect(context->viewport->viewLatLonAltBox(), context->mapLayer, context->lazyUpdate,
                                               context->mapLayer->getWindBarbs());
+  context->statEnd(paintstat::QUERY, statStart);
 
   if(windForRect != nullptr)
   {
@@ -72,14 +75,29 @@ void MapPainterWind::render()
         bool visible = wToSBuf(windPos.pos, point, margins, &isHidden);
         if(visible && !isHidden)
         {
-          symbolPainter->drawWindBarbs(context->painter, windPos.wind.speed, 0.f, windPos.wind.dir,
-                                       static_cast<float>(point.x()), static_cast<float>(point.y()), size,
-                                       true /* wind barbs */, true /* alt wind */, false /* route */, context->drawFast);
+          // Symbol changes only with the number and type of feathers - use barb steps for key
+          float speed = windPos.wind.speed;
+          int speedInt = static_cast<int>(speed);
+          quint64 barbStep = speed < 2.f ? 0 : 1 + static_cast<quint64>(speedInt / 5);
+          int numBarbs = speedInt / 50 + speedInt % 50 / 10 + (speedInt % 10 >= 5 ? 1 : 0);
+
+          // Line length grows with the number of feathers - add margin for feathers and background
+          int side = static_cast<int>(std::ceil(size * (2.f + numBarbs * 0.3f))) * 2 + 2;
+
+          // Barb is rendered pointing north and rotated when drawing the fragment
+          bool fast = context->drawFast;
+          symbolAtlas->add(context->painter, SymbolAtlas::key(SymbolAtlas::WIND_BARB, size, barbStep | static_cast<quint64>(fast) << 16),
+                           side, static_cast<float>(point.x()), static_cast<float>(point.y()),
+                           [this, size, speed, fast](QPainter *painter, float center) {
+            symbolPainter->drawWindBarbs(painter, speed, 0.f, 0.f, center, center, size,
+                                         true /* wind barbs */, true /* alt wind */, false /* route */, fast);
+          }, windPos.wind.dir);
 
           if(context->objCount())
             break;
         }
       }
     }
+    symbolAtlas->flush(context->painter);
   }
 }
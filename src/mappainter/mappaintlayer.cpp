@@ -19,10 +19,13 @@
 
 #include "common/constants.h"
 #include "common/mapcolors.h"
+#include "common/stallmonitor.h"
 #include "geo/calculations.h"
 #include "mapgui/maplayersettings.h"
+#include "mapgui/mapprefetcher.h"
 #include "mapgui/mapscale.h"
 #include "mapgui/mapwidget.h"
+#include "mappainter/gpulayerrenderer.h"
 #include "mappainter/mappainteraircraft.h"
 #include "mappainter/mappainterairport.h"
 #include "mappainter/mappainterairspace.h"
@@ -45,6 +48,8 @@
 #include "userdata/userdatacontroller.h"
 
 #include <QElapsedTimer>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
 
 #include <marble/GeoPainter.h>
 
@@ -57,6 +62,22 @@ MapPaintLayer::MapPaintLayer(MapPaintWidget *widget)
   verbose = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_LAYER_DEBUG, false).toBool();
   verboseDraw = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_LAYER_DEBUG_DRAW, false).toBool();
 
+  // Paint independent layers into offscreen images in background threads
+  parallelPaint = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_LAYER_PARALLEL, false).toBool();
+
+  // Keep static layers in an image to allow repainting only aircraft and trail
+  baseLayerCache = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_LAYER_BASE_CACHE, true).toBool();
+
+  // Render cached static layers through the OpenGL paint engine - falls back to raster if not available
+  gpuPaint = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_LAYER_GPU, false).toBool();
+  gpuSamples = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_LAYER_GPU_SAMPLES, 4).toInt();
+
+  // Skip low priority layers if a full render takes longer and draw them in a follow-up pass
+  frameBudgetMs = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_LAYER_FRAME_BUDGET_MS, 250).toInt();
+
+  // Draw only labels not overlapping others with higher priority
+  labelDeclutter = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_LAYER_LABEL_DECLUTTER, true).toBool();
+
   // Create the layer configuration
   initMapLayerSettings();
 
@@ -74,7 +95,9 @@ MapPaintLayer::MapPaintLayer(MapPaintWidget *widget)
   mapPainterTrack = new MapPainterTrail(mapPaintWidget, mapScale, &context);
   mapPainterShip = new MapPainterShip(mapPaintWidget, mapScale, &context);
   mapPainterUser = new MapPainterUser(mapPaintWidget, mapScale, &context);
-  mapPainterAltitude = new MapPainterAltitude(mapPaintWidget, mapScale, &context);
+  // Altitude painter uses its own context to allow painting in background
+  mapPainterAltitude = new MapPainterAltitude(mapPaintWidget, mapScale, &offscreenAltitude.context);
+  offscreenAltitude.painter = mapPainterAltitude;
   mapPainterWeather = new MapPainterWeather(mapPaintWidget, mapScale, &context);
   mapPainterWind = new MapPainterWind(mapPaintWidget, mapScale, &context);
   mapPainterTop = new MapPainterTop(mapPaintWidget, mapScale, &context);
@@ -87,6 +110,9 @@ MapPaintLayer::MapPaintLayer(MapPaintWidget *widget)
 
 MapPaintLayer::~MapPaintLayer()
 {
+  offscreenAltitude.future.waitForFinished();
+
+  delete gpuRenderer;
   delete mapPainterNav;
   delete mapPainterIls;
   delete mapPainterAirport;
@@ -122,21 +148,31 @@ void MapPaintLayer::copySettings(const MapPaintLayer& other)
 void MapPaintLayer::preDatabaseLoad()
 {
   databaseLoadStatus = true;
+  mapPainterAirport->clearDiagramCache();
+}
+
+void MapPaintLayer::clearAirportDiagramCache()
+{
+  invalidateBaseLayer();
+  mapPainterAirport->clearDiagramCache();
 }
 
 void MapPaintLayer::postDatabaseLoad()
 {
+  invalidateBaseLayer();
   databaseLoadStatus = false;
 }
 
 void MapPaintLayer::setShowMapObjects(map::MapTypes type, map::MapTypes mask)
 {
+  invalidateBaseLayer();
   objectTypes &= ~mask;
   objectTypes |= type;
 }
 
 void MapPaintLayer::setShowMapObject(map::MapTypes type, bool show)
 {
+  invalidateBaseLayer();
   if(show)
     objectTypes |= type;
   else
@@ -145,6 +181,7 @@ void MapPaintLayer::setShowMapObject(map::MapTypes type, bool show)
 
 void MapPaintLayer::setShowMapObjectDisplay(map::MapDisplayTypes type, bool show)
 {
+  invalidateBaseLayer();
   if(show)
     objectDisplayTypes |= type;
   else
@@ -153,11 +190,13 @@ void MapPaintLayer::setShowMapObjectDisplay(map::MapDisplayTypes type, bool show
 
 void MapPaintLayer::setShowAirspaces(map::MapAirspaceFilter types)
 {
+  invalidateBaseLayer();
   airspaceTypes = types;
 }
 
 void MapPaintLayer::setDetailLevel(int level)
 {
+  invalidateBaseLayer();
   detailLevel = level;
   updateLayers();
 }
@@ -295,6 +334,8 @@ void MapPaintLayer::dumpMapLayers() const
 
 bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const QString& renderPos, GeoSceneLayer *layer)
 {
+  LNM_STALL_SCOPE;
+
   Q_UNUSED(renderPos)
   Q_UNUSED(layer)
 
@@ -314,12 +355,15 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const
       qDebug() << Q_FUNC_INFO << "layer" << *mapLayer;
 #endif
 
-      // Clear the airport id cache
-      shownDetailAirportIds.clear();
+      // Drop cached screen geometry if zoom, projection or size changed
+      mapPaintWidget->updateGeometryCaches();
 
       // Prepare context =====================================================
       context = PaintContext();
       context.shownDetailAirportIds = &shownDetailAirportIds;
+      context.labelPlacement = labelDeclutter ? &labelPlacement : nullptr;
+      frameArena.startFrame();
+      context.frameArena = &frameArena;
       context.route = &NavApp::getRouteConst();
       context.mapLayer = mapLayer;
       context.mapLayerRoute = mapLayerRoute;
@@ -408,9 +452,10 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const
 
       // Prepare index for all navaids drawn by route - needed for context menu and tooltips
       context.routeDrawnNavaids = mapPaintWidget->getRouteDrawnNavaids();
-      context.routeDrawnNavaids->clear();
 
       context.startTimer("All");
+      context.statistics = &statistics;
+      statistics.beginFrame();
       setNoAntiAliasFont(&context);
 
       // ====================================
@@ -537,68 +582,206 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const
 
       // =========================================================================
       // Draw ====================================
+      QSize size = mapPaintWidget->size();
+      qreal pixelRatio = painter->device()->devicePixelRatioF();
 
-      // Altitude below all others
-      mapPainterAltitude->render();
-
-      // Ship below other navaids and airports
-      mapPainterShip->render();
+      // Static painters are rendered into a cached image which is reused if only aircraft moved.
+      // Not used for printing and web services which might use other paint devices.
+      bool cacheBase = baseLayerCache && still && mapPaintWidget->isVisibleWidget() && !mapPaintWidget->isPrinting();
 
-      if(!mapPaintWidget->isDistanceCutOff())
+      if(cacheBase && dynamicUpdate && isBaseLayerCurrent(viewport, pixelRatio))
+      {
+        // Only aircraft, ships, trail or marks changed - reuse base map
+        painter->drawImage(QPointF(0., 0.), baseLayer.image);
+        context.objectCount = baseLayer.objectCount;
+      }
+      else
       {
-        if(!context.isObjectOverflow())
-          mapPainterAirspace->render();
+        // Full render of all static painters ==========================
+        // Follow-up pass for a partial frame draws all layers regardless of budget
+        frameTimer.start();
+        frameBudgetActive = frameBudgetMs > 0 && !followUpPass && mapPaintWidget->isVisibleWidget() &&
+                            !mapPaintWidget->isPrinting();
+        framePartial = followUpPass = false;
+
+        // Clear the airport id cache and navaids drawn by route
+        shownDetailAirportIds.clear();
+        context.routeDrawnNavaids->clear();
+        labelPlacement.clear();
+
+        // Painter which gets all static layers - either the map or the base layer image
+        GeoPainter *basePainter = painter, *baseImagePainter = nullptr;
+        QPaintDevice *gpuDevice = nullptr;
+        if(cacheBase)
+        {
+          if(gpuPaint)
+          {
+            if(gpuRenderer == nullptr)
+              gpuRenderer = new GpuLayerRenderer(gpuSamples);
 
-        if(!context.isObjectOverflow())
-          mapPainterIls->render();
+            if(gpuRenderer->isValid())
+              gpuDevice = gpuRenderer->begin(size, pixelRatio);
+          }
 
-        if(context.mapLayer->isAirportDiagram())
-        {
-          if(!context.isObjectOverflow())
-            mapPainterAirport->render();
+          if(gpuDevice != nullptr)
+            // Paint into framebuffer - image is read back below
+            baseImagePainter = new GeoPainter(gpuDevice, viewport, painter->mapQuality());
+          else
+          {
+            // Reuse image if size did not change
+            if(baseLayer.image.size() != size * pixelRatio || !qFuzzyCompare(baseLayer.image.devicePixelRatio(), pixelRatio))
+              baseLayer.image = createLayerImage(size, pixelRatio);
+            else
+              baseLayer.image.fill(Qt::transparent);
 
-          if(!context.isObjectOverflow())
-            mapPainterNav->render();
+            baseImagePainter = new GeoPainter(&baseLayer.image, viewport, painter->mapQuality());
+          }
+          baseImagePainter->setRenderHints(painter->renderHints());
+          baseImagePainter->setFont(painter->font());
+          basePainter = baseImagePainter;
+          context.painter = basePainter;
+        }
+
+        // Painters for offscreen layers get a copy of the context
+        offscreenAltitude.context = context;
+
+        // Paint minimum altitude grid in background while all other layers are painted into an overlay image
+        // in this thread. Both images are composited in z-order after all layers are done.
+        // Not used for printing and web services which might use other paint devices.
+        bool parallel = parallelPaint && mapPaintWidget->isVisibleWidget() && !mapPaintWidget->isPrinting() &&
+                        context.objectDisplayTypes.testFlag(map::MORA) && context.mapLayer->isMora();
+
+        QImage overlayImage;
+        GeoPainter *overlayPainter = nullptr;
+        if(parallel)
+        {
+          startOffscreenLayer(offscreenAltitude, basePainter, size, pixelRatio);
+
+          // Redirect all other painters to the overlay
+          overlayImage = createLayerImage(size, pixelRatio);
+          overlayPainter = new GeoPainter(&overlayImage, viewport, basePainter->mapQuality());
+          overlayPainter->setRenderHints(basePainter->renderHints());
+          overlayPainter->setFont(basePainter->font());
+          context.painter = overlayPainter;
         }
         else
+          // Altitude below all others
+          renderPainter(mapPainterAltitude, "Altitude");
+
+        if(!mapPaintWidget->isDistanceCutOff())
         {
-          if(!context.isObjectOverflow())
-            mapPainterMsa->render();
+          if(!context.isObjectOverflow() && !deferLayer())
+            renderPainter(mapPainterAirspace, "Airspace");
 
           if(!context.isObjectOverflow())
-            mapPainterNav->render();
+            renderPainter(mapPainterIls, "ILS");
 
-          if(!context.isObjectOverflow())
-            mapPainterAirport->render();
+          if(context.mapLayer->isAirportDiagram())
+          {
+            if(!context.isObjectOverflow())
+              renderPainter(mapPainterAirport, "Airport");
+
+            if(!context.isObjectOverflow())
+              renderPainter(mapPainterNav, "Navaid");
+          }
+          else
+          {
+            if(!context.isObjectOverflow() && !deferLayer())
+              renderPainter(mapPainterMsa, "MSA");
+
+            if(!context.isObjectOverflow())
+              renderPainter(mapPainterNav, "Navaid");
+
+            if(!context.isObjectOverflow())
+              renderPainter(mapPainterAirport, "Airport");
+          }
         }
-      }
 
-      if(!context.isObjectOverflow())
-        mapPainterUser->render();
+        if(!context.isObjectOverflow() && !deferLayer())
+          renderPainter(mapPainterUser, "Userpoint");
 
-      if(!context.isObjectOverflow())
-        mapPainterWind->render();
+        if(!context.isObjectOverflow() && !deferLayer())
+          renderPainter(mapPainterWind, "Wind");
 
-      // if(!context.isOverflow()) always paint route even if number of objects is too large
-      mapPainterRoute->render();
+        // if(!context.isOverflow()) always paint route even if number of objects is too large
+        renderPainter(mapPainterRoute, "Route");
 
-      if(!context.isObjectOverflow())
-        mapPainterWeather->render();
+        if(!context.isObjectOverflow() && !deferLayer())
+          renderPainter(mapPainterWeather, "Weather");
 
-      if(context.mapLayer->isAirportDiagram() && !context.isObjectOverflow())
-        mapPainterMsa->render();
+        if(context.mapLayer->isAirportDiagram() && !context.isObjectOverflow() && !deferLayer())
+          renderPainter(mapPainterMsa, "MSA");
 
-      if(!context.isObjectOverflow())
-        mapPainterTrack->render();
+        // Draw labels of all static painters on top
+        if(context.labelPlacement != nullptr && !deferLayer())
+        {
+          statistics.beginLayer("Labels", context.getObjectCount());
+          context.labelPlacement->flush(context.painter);
+          statistics.endLayer(context.getObjectCount());
+        }
 
-      mapPainterAircraft->render();
+        if(parallel)
+        {
+          // Composite layers in z-order into the base painter
+          delete overlayPainter;
+          context.painter = basePainter;
 
-      mapPainterMark->render();
+          finishOffscreenLayer(offscreenAltitude, basePainter);
+          basePainter->drawImage(QPointF(0., 0.), overlayImage);
+        }
+
+        if(cacheBase)
+        {
+          // Remember view for the cached image and draw it into the map
+          delete baseImagePainter;
+          context.painter = painter;
+
+          if(gpuDevice != nullptr)
+            baseLayer.image = gpuRenderer->end();
+
+          painter->drawImage(QPointF(0., 0.), baseLayer.image);
+
+          baseLayer.box = viewport->viewLatLonAltBox();
+          baseLayer.radius = viewport->radius();
+          baseLayer.projection = viewport->projection();
+          baseLayer.mapLayer = mapLayer;
+          baseLayer.objectCount = context.objectCount;
+
+          // Do not reuse an incomplete image
+          baseLayer.valid = !framePartial;
+        }
+        else
+          baseLayer.valid = false;
+
+        if(framePartial)
+        {
+          // Draw all layers in the next pass once pending events are processed - not while moving the map
+          // since the next frame follows anyway
+          if(still)
+          {
+            followUpPass = true;
+            QTimer::singleShot(0, mapPaintWidget, QOverload<>::of(&QWidget::update));
+          }
+        }
+        else
+          lastFullRenderMs = frameTimer.elapsed();
+
+        // Load objects for the next view step in background
+        if(!mapPaintWidget->isDistanceCutOff() && !context.isObjectOverflow())
+          mapPaintWidget->getMapPrefetcher()->viewUpdated(box, mapLayer, objectTypes);
+      }
+      dynamicUpdate = false;
+
+      // Aircraft, ships, trail and marks are always drawn directly into the map
+      renderDynamicPainters();
 
       resetNoAntiAliasFont(&context);
       context.endTimer("All");
 
-      mapPainterTop->render();
+      renderPainter(mapPainterTop, "Top");
+      statistics.addArenaCounts(frameArena.getAcquireCount(), frameArena.getAllocationCount());
+      statistics.endFrame(context.getObjectCount());
+      context.statistics = nullptr;
     } // if(!noRender())
 
     if(!mapPaintWidget->isPrinting() && mapPaintWidget->isVisibleWidget())
@@ -608,6 +791,91 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const
   return true;
 }
 
+void MapPaintLayer::renderDynamicPainters()
+{
+  // Ship below trail and aircraft
+  if(!context.isObjectOverflow())
+    renderPainter(mapPainterShip, "Ship");
+
+  if(!context.isObjectOverflow())
+    renderPainter(mapPainterTrack, "Trail");
+
+  renderPainter(mapPainterAircraft, "Aircraft");
+
+  renderPainter(mapPainterMark, "Mark");
+}
+
+bool MapPaintLayer::deferLayer()
+{
+  // Skip right away if the last complete render exceeded the budget to get the essentials on screen first
+  if(frameBudgetActive && (lastFullRenderMs > frameBudgetMs || frameTimer.elapsed() > frameBudgetMs))
+  {
+    framePartial = true;
+    return true;
+  }
+  return false;
+}
+
+bool MapPaintLayer::isBaseLayerCurrent(const ViewportParams *viewport, qreal pixelRatio) const
+{
+  return baseLayer.valid &&
+         baseLayer.image.size() == viewport->size() * pixelRatio &&
+         qFuzzyCompare(baseLayer.image.devicePixelRatio(), pixelRatio) &&
+         baseLayer.mapLayer == mapLayer &&
+         baseLayer.projection == viewport->projection() &&
+         qFuzzyCompare(baseLayer.radius, viewport->radius()) &&
+         baseLayer.box == viewport->viewLatLonAltBox();
+}
+
+void MapPaintLayer::renderPainter(MapPainter *painter, const QString& name)
+{
+  statistics.beginLayer(name, context.getObjectCount());
+  painter->render();
+  statistics.endLayer(context.getObjectCount());
+}
+
+QImage MapPaintLayer::createLayerImage(const QSize& size, qreal pixelRatio)
+{
+  QImage image(size * pixelRatio, QImage::Format_ARGB32_Premultiplied);
+  image.setDevicePixelRatio(pixelRatio);
+  image.fill(Qt::transparent);
+  return image;
+}
+
+void MapPaintLayer::startOffscreenLayer(OffscreenLayer& layer, const QPainter *painter, const QSize& size, qreal pixelRatio)
+{
+  layer.future.waitForFinished();
+
+  // Reuse image if size did not change
+  if(layer.image.size() != size * pixelRatio || !qFuzzyCompare(layer.image.devicePixelRatio(), pixelRatio))
+    layer.image = createLayerImage(size, pixelRatio);
+  else
+    layer.image.fill(Qt::transparent);
+
+  layer.renderHints = painter->renderHints();
+  layer.context.painter = nullptr;
+  layer.context.statistics = nullptr; // Not thread safe
+
+  layer.future = QtConcurrent::run(this, &MapPaintLayer::renderOffscreenLayer, &layer);
+}
+
+void MapPaintLayer::renderOffscreenLayer(OffscreenLayer *layer)
+{
+  GeoPainter geoPainter(&layer->image, layer->context.viewport);
+  geoPainter.setRenderHints(layer->renderHints);
+  geoPainter.setFont(layer->context.defaultFont); // Already set to no anti-aliasing if needed
+
+  layer->context.painter = &geoPainter;
+  layer->painter->render();
+  layer->context.painter = nullptr;
+}
+
+void MapPaintLayer::finishOffscreenLayer(OffscreenLayer& layer, QPainter *painter)
+{
+  layer.future.waitForFinished();
+  painter->drawImage(QPointF(0., 0.), layer.image);
+}
+
 void MapPaintLayer::setNoAntiAliasFont(PaintContext *context)
 {
   if(context->viewContext == Marble::Animation)
@@ -18,10 +18,16 @@
 #ifndef LITTLENAVMAP_MAPPAINTLAYER_H
 #define LITTLENAVMAP_MAPPAINTLAYER_H
 
+#include "common/framearena.h"
+#include "mappainter/labelplacement.h"
 #include "mappainter/mappainter.h"
 
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QImage>
 #include <QPen>
 
+#include <marble/GeoDataLatLonAltBox.h>
 #include <marble/LayerInterface.h>
 
 namespace Marble {
@@ -51,6 +57,7 @@ class MapPainterAltitude;
 class MapPainterWeather;
 class MapPainterWind;
 class MapPaintWidget;
+class GpuLayerRenderer;
 
 /*
  * Implements the Marble layer interface that paints upon the Marble map. Contains all painter instances
@@ -72,6 +79,9 @@ public:
   void preDatabaseLoad();
   void postDatabaseLoad();
 
+  /* Drop recorded airport diagrams after option or style changes */
+  void clearAirportDiagramCache();
+
   /* Get the current map layer for the zoom distance and detail level */
   const MapLayer *getMapLayer() const
   {
@@ -134,6 +144,7 @@ public:
 
   void setWeatherSource(const map::MapWeatherSource& value)
   {
+    invalidateBaseLayer();
     weatherSource = value;
   }
 
@@ -162,6 +173,29 @@ public:
     return context.isQueryOverflow();
   }
 
+  /* Last frame exceeded the frame budget and low priority layers were skipped. A follow-up pass is scheduled. */
+  bool isFramePartial() const
+  {
+    return framePartial;
+  }
+
+  /* Timing statistics for all painters collected since start or last reset */
+  const PaintStatistics& getPaintStatistics() const
+  {
+    return statistics;
+  }
+
+  void resetPaintStatistics()
+  {
+    statistics.reset();
+  }
+
+  /* Add time spent by Marble outside of this layer for one paint event */
+  void addBaseMapTime(qint64 ns)
+  {
+    statistics.addBaseMapTime(ns);
+  }
+
   void initQueries();
   void updateLayers();
 
@@ -172,6 +206,7 @@ public:
 
   void setShowMinimumRunwayFt(int value)
   {
+    invalidateBaseLayer();
     minimumRunwayLenghtFt = value;
   }
 
@@ -181,6 +216,19 @@ public:
 
   void dumpMapLayers() const;
 
+  /* Next frame repaints only the dynamic layer (aircraft, ships, trail, marks and highlights) on top of the cached
+   * base map if the view did not change. Falls back to a full render otherwise. */
+  void setDynamicUpdate()
+  {
+    dynamicUpdate = true;
+  }
+
+  /* Force a full render for the next frame */
+  void invalidateBaseLayer()
+  {
+    baseLayer.valid = false;
+  }
+
   /* Airports actually drawn having parking spots which require tooltips and more */
   const QSet<int>& getShownDetailAirportIds() const
   {
@@ -206,6 +254,54 @@ private:
   /* Restore normal font anti-aliasing for default and painter font */
   void resetNoAntiAliasFont(PaintContext *context);
 
+  /* Call render of the painter and collect statistics */
+  void renderPainter(MapPainter *painter, const QString& name);
+
+  /* Layer which is painted into an offscreen image in a background thread.
+   * Only for painters which do not access databases, caches or other GUI thread objects. */
+  struct OffscreenLayer
+  {
+    MapPainter *painter = nullptr;
+    PaintContext context; /* Separate context copied from the main context before each frame */
+    QImage image;
+    QPainter::RenderHints renderHints;
+    QFuture<void> future;
+  };
+
+  /* Start painting into the offscreen image in background */
+  void startOffscreenLayer(OffscreenLayer& layer, const QPainter *painter, const QSize& size, qreal pixelRatio);
+
+  /* Called in background thread */
+  void renderOffscreenLayer(OffscreenLayer *layer);
+
+  /* Wait for thread and draw image into painter */
+  void finishOffscreenLayer(OffscreenLayer& layer, QPainter *painter);
+
+  /* Painters drawing objects which change with each simulator update or online data refresh */
+  void renderDynamicPainters();
+
+  /* true if a low priority layer like airspaces, user points or labels should be skipped in this frame
+   * since the frame budget is exceeded. Sets framePartial. */
+  bool deferLayer();
+
+  /* Cached image of all static painters for dynamic-only updates */
+  struct BaseLayer
+  {
+    QImage image;
+    Marble::GeoDataLatLonAltBox box;
+    qreal radius = 0.;
+    int projection = -1;
+    const MapLayer *mapLayer = nullptr;
+    int objectCount = 0;
+    bool valid = false;
+  };
+
+  /* true if the cached base layer matches the current view. Data changes have to call invalidateBaseLayer(). */
+  bool isBaseLayerCurrent(const Marble::ViewportParams *viewport, qreal pixelRatio) const;
+
+  /* Create a transparent image for the given size in device independent pixels */
+  static QImage createLayerImage(const QSize& size, qreal pixelRatio);
+
   /* Map objects currently shown */
   map::MapTypes objectTypes = map::NONE;
   map::MapDisplayTypes objectDisplayTypes = map::DISPLAY_TYPE_NONE;
@@ -226,6 +322,32 @@ private:
 
   PaintContext context;
 
+  /* Timing statistics for all painters collected over all frames */
+  PaintStatistics statistics;
+
+  /* Minimum altitude grid is painted in background if parallel painting is enabled */
+  OffscreenLayer offscreenAltitude;
+
+  /* Label candidates of all static painters. Referenced by the paint context if enabled. */
+  LabelPlacement labelPlacement;
+
+  /* Temporary containers for painters. Referenced by the paint context. */
+  FrameArena frameArena;
+
+  /* Static painters are rendered into this image if enabled. Reused for dynamic-only updates. */
+  BaseLayer baseLayer;
+
+  /* Time budget for a full render in milliseconds. Low priority layers are deferred to a follow-up pass
+   * if exceeded. Disabled if zero. */
+  int frameBudgetMs = 0;
+  qint64 lastFullRenderMs = 0L;
+  QElapsedTimer frameTimer;
+  bool frameBudgetActive = false, framePartial = false, followUpPass = false;
+
+  /* Renders the base layer using OpenGL if enabled. Created on first use. */
+  GpuLayerRenderer *gpuRenderer = nullptr;
+  int gpuSamples = 4;
+
   /* All painters */
   MapPainterAirport *mapPainterAirport;
   MapPainterMsa *mapPainterMsa;
@@ -247,7 +369,8 @@ private:
   MapLayerSettings *layers = nullptr;
   MapPaintWidget *mapPaintWidget = nullptr;
   const MapLayer *mapLayer = nullptr, *mapLayerRoute = nullptr, *mapLayerEffective = nullptr;
-  bool verbose = false, verboseDraw = false;
+  bool verbose = false, verboseDraw = false, parallelPaint = false, baseLayerCache = true, dynamicUpdate = false,
+       labelDeclutter = true, gpuPaint = false;
   QFont::StyleStrategy savedFontStrategy, savedDefaultFontStrategy;
 
 };
@@ -0,0 +1,207 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mappainter/paintstatistics.h"
+
+#include "util/htmlbuilder.h"
+
+
+namespace paintstat {
+static const double NS_TO_MS = 1. / 1000000.;
+}
+
+void PaintStatistics::beginFrame()
+{
+  frameTimer.start();
+  currentLayer = nullptr;
+  for(int i = 0; i < paintstat::NUM_TIME_TYPES; i++)
+    frameNs[i] = 0;
+}
+
+void PaintStatistics::endFrame(int objectCount)
+{
+  if(frameTimer.isValid())
+  {
+    // Draw time is the remainder after subtracting summed up query and projection times
+    add(frame, frameTimer.nsecsElapsed(), frameNs, objectCount);
+    frameTimer.invalidate();
+  }
+}
+
+void PaintStatistics::beginLayer(const QString& name, int objectCount)
+{
+  if(!frameTimer.isValid())
+    return;
+
+  int index = layerIndex.value(name, -1);
+  if(index == -1)
+  {
+    index = layers.size();
+    layerIndex.insert(name, index);
+    layers.append(PaintLayerStatistics());
+    layers.last().name = name;
+  }
+
+  currentLayer = &layers[index];
+  layerStartNs = frameTimer.nsecsElapsed();
+  layerStartObjects = objectCount;
+  for(int i = 0; i < paintstat::NUM_TIME_TYPES; i++)
+    currentNs[i] = 0;
+}
+
+void PaintStatistics::endLayer(int objectCount)
+{
+  if(currentLayer != nullptr)
+  {
+    add(*currentLayer, frameTimer.nsecsElapsed() - layerStartNs, currentNs, objectCount - layerStartObjects);
+
+    for(int i = 0; i < paintstat::NUM_TIME_TYPES; i++)
+      frameNs[i] += currentNs[i];
+    currentLayer = nullptr;
+  }
+}
+
+void PaintStatistics::add(PaintLayerStatistics& stats, qint64 totalNs, const qint64 *timesNs, int objects)
+{
+  if(stats.histogram.isEmpty())
+    stats.histogram.fill(0, paintstat::HISTOGRAM_LIMITS_MS.size() + 1);
+
+  double totalMs = totalNs * paintstat::NS_TO_MS;
+  double queryMs = timesNs[paintstat::QUERY] * paintstat::NS_TO_MS;
+  double projectionMs = timesNs[paintstat::PROJECTION] * paintstat::NS_TO_MS;
+
+  stats.lastMs[paintstat::QUERY] = queryMs;
+  stats.lastMs[paintstat::PROJECTION] = projectionMs;
+  stats.lastMs[paintstat::DRAW] = std::max(totalMs - queryMs - projectionMs, 0.);
+  for(int i = 0; i < paintstat::NUM_TIME_TYPES; i++)
+    stats.sumMs[i] += stats.lastMs[i];
+
+  stats.maxMs = std::max(stats.maxMs, totalMs);
+  stats.lastObjects = objects;
+  stats.sumObjects += static_cast<quint64>(std::max(objects, 0));
+  stats.frames++;
+
+  // Find histogram bucket
+  int bucket = 0;
+  while(bucket < paintstat::HISTOGRAM_LIMITS_MS.size() && totalMs > paintstat::HISTOGRAM_LIMITS_MS.at(bucket))
+    bucket++;
+  stats.histogram[bucket]++;
+}
+
+void PaintStatistics::addBaseMapTime(qint64 ns)
+{
+  static const qint64 NO_TIMES[paintstat::NUM_TIME_TYPES] = {0, 0, 0};
+  add(baseMap, std::max(ns, static_cast<qint64>(0)), NO_TIMES, 0);
+}
+
+void PaintStatistics::addArenaCounts(int acquires, int allocations)
+{
+  lastArenaAcquires = acquires;
+  lastArenaAllocations = allocations;
+  sumArenaAcquires += static_cast<quint64>(acquires);
+  sumArenaAllocations += static_cast<quint64>(allocations);
+  arenaFrames++;
+}
+
+void PaintStatistics::reset()
+{
+  layers.clear();
+  layerIndex.clear();
+  frame = baseMap = PaintLayerStatistics();
+  currentLayer = nullptr;
+  arenaFrames = sumArenaAcquires = sumArenaAllocations = 0;
+  lastArenaAcquires = lastArenaAllocations = 0;
+}
+
+QString PaintStatistics::statsName(const PaintLayerStatistics *stats) const
+{
+  if(stats == &frame)
+    return tr("Frame");
+  else if(stats == &baseMap)
+    return tr("Base map tiles");
+  else
+    return stats->name;
+}
+
+void PaintStatistics::html(atools::util::HtmlBuilder& html) const
+{
+  // Times table ==================================
+  html.table();
+  html.tr().th(tr("Painter")).
+  th(tr("Frames")).
+  th(tr("Query ms")).
+  th(tr("Projection ms")).
+  th(tr("Draw ms")).
+  th(tr("Total ms")).
+  th(tr("Last ms")).
+  th(tr("Max ms")).
+  th(tr("Objects")).trEnd();
+
+  QVector<const PaintLayerStatistics *> all({&frame});
+  if(baseMap.frames > 0)
+    all.append(&baseMap);
+  for(const PaintLayerStatistics& layer : layers)
+    all.append(&layer);
+
+  QLocale locale;
+  for(const PaintLayerStatistics *stats : all)
+  {
+    html.tr().td(statsName(stats)).
+    td(locale.toString(stats->frames)).
+    td(locale.toString(stats->averageMs(paintstat::QUERY), 'f', 2)).
+    td(locale.toString(stats->averageMs(paintstat::PROJECTION), 'f', 2)).
+    td(locale.toString(stats->averageMs(paintstat::DRAW), 'f', 2)).
+    td(locale.toString(stats->averageTotalMs(), 'f', 2)).
+    td(locale.toString(stats->lastTotalMs(), 'f', 2)).
+    td(locale.toString(stats->maxMs, 'f', 2)).
+    td(locale.toString(stats->averageObjects(), 'f', 0)).trEnd();
+  }
+  html.tableEnd();
+
+  // Histogram table ==================================
+  html.p().b(tr("Number of frames by painter time")).pEnd();
+  html.table();
+  html.tr().th(tr("Painter"));
+  for(double limit : paintstat::HISTOGRAM_LIMITS_MS)
+    html.th(tr("≤ %1 ms").arg(limit));
+  html.th(tr("> %1 ms").arg(paintstat::HISTOGRAM_LIMITS_MS.constLast()));
+  html.trEnd();
+
+  for(const PaintLayerStatistics *stats : all)
+  {
+    html.tr().td(statsName(stats));
+    for(int i = 0; i < paintstat::HISTOGRAM_LIMITS_MS.size() + 1; i++)
+      html.td(locale.toString(stats->histogram.value(i)));
+    html.trEnd();
+  }
+  html.tableEnd();
+
+  // Frame arena table ==================================
+  if(arenaFrames > 0)
+  {
+    html.p().b(tr("Temporary containers per frame")).pEnd();
+    html.table();
+    html.tr().th(QString()).th(tr("Requested")).th(tr("Allocated")).trEnd();
+    html.tr().td(tr("Average")).
+    td(locale.toString(static_cast<double>(sumArenaAcquires) / arenaFrames, 'f', 1)).
+    td(locale.toString(static_cast<double>(sumArenaAllocations) / arenaFrames, 'f', 1)).trEnd();
+    html.tr().td(tr("Last")).
+    td(locale.toString(lastArenaAcquires)).
+    td(locale.toString(lastArenaAllocations)).trEnd();
+    html.tableEnd();
+  }
+}
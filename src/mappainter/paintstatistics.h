@@ -0,0 +1,160 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_PAINTSTATISTICS_H
+#define LNM_PAINTSTATISTICS_H
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
+
+namespace atools {
+namespace util {
+class HtmlBuilder;
+}
+}
+
+namespace paintstat {
+
+/* Time categories collected for each painter */
+enum TimeType
+{
+  QUERY, /* Database queries and cache lookups */
+  PROJECTION, /* Conversion of line and polygon geometry to screen coordinates */
+  DRAW, /* Remaining time spent in painter */
+  NUM_TIME_TYPES
+};
+
+/* Upper limits in milliseconds for the histogram buckets of the total painter time.
+ * Last bucket takes all times above the last limit. */
+const QVector<double> HISTOGRAM_LIMITS_MS = {1., 2., 5., 10., 20., 50., 100., 200.};
+
+}
+
+/* Accumulated time and object count for one painter or for the whole frame */
+struct PaintLayerStatistics
+{
+  QString name;
+  quint64 frames = 0;
+  double sumMs[paintstat::NUM_TIME_TYPES] = {0., 0., 0.}, lastMs[paintstat::NUM_TIME_TYPES] = {0., 0., 0.};
+  double maxMs = 0.; /* Maximum total time */
+  quint64 sumObjects = 0;
+  int lastObjects = 0;
+
+  /* Number of frames per total time bucket. Size is HISTOGRAM_LIMITS_MS.size() + 1 */
+  QVector<quint64> histogram;
+
+  double averageMs(paintstat::TimeType type) const
+  {
+    return frames > 0 ? sumMs[type] / frames : 0.;
+  }
+
+  double averageTotalMs() const
+  {
+    return averageMs(paintstat::QUERY) + averageMs(paintstat::PROJECTION) + averageMs(paintstat::DRAW);
+  }
+
+  double lastTotalMs() const
+  {
+    return lastMs[paintstat::QUERY] + lastMs[paintstat::PROJECTION] + lastMs[paintstat::DRAW];
+  }
+
+  double averageObjects() const
+  {
+    return frames > 0 ? static_cast<double>(sumObjects) / frames : 0.;
+  }
+
+};
+
+/*
+ * Collects persistent timing statistics for all map painters of one map widget.
+ *
+ * Total time of each painter is measured by the paint layer. Painters add query and projection times
+ * for the current painter which are subtracted from the total to get the draw time.
+ * Not thread safe. Only to be used from the GUI thread.
+ */
+class PaintStatistics
+{
+  Q_DECLARE_TR_FUNCTIONS(PaintStatistics)
+
+public:
+  /* Start and end measuring a frame */
+  void beginFrame();
+  void endFrame(int objectCount);
+
+  /* Start and end measuring a painter. objectCount is the number of objects drawn so far for the frame. */
+  void beginLayer(const QString& name, int objectCount);
+  void endLayer(int objectCount);
+
+  /* Get start time for a query or projection. Pass value to addTime(). */
+  qint64 start() const
+  {
+    return frameTimer.nsecsElapsed();
+  }
+
+  /* Add time since start to the given category of the current painter. Ignored if no painter is measured. */
+  void addTime(paintstat::TimeType type, qint64 startNs)
+  {
+    if(currentLayer != nullptr)
+      currentNs[type] += frameTimer.nsecsElapsed() - startNs;
+  }
+
+  /* Add time spent by Marble in one paint event excluding the paint layer. This is mostly loading, decoding
+   * and scaling of texture tiles for the base map. */
+  void addBaseMapTime(qint64 ns);
+
+  /* Add number of temporary containers requested from and newly created by the frame arena for the current frame */
+  void addArenaCounts(int acquires, int allocations);
+
+  /* Remove all collected values */
+  void reset();
+
+  /* Statistics for all painters in order of first painting */
+  const QVector<PaintLayerStatistics>& getLayers() const
+  {
+    return layers;
+  }
+
+  /* Statistics for all frames. Query and projection times are summed up from all painters. */
+  const PaintLayerStatistics& getFrame() const
+  {
+    return frame;
+  }
+
+  /* Append tables for frame and painters to the builder */
+  void html(atools::util::HtmlBuilder& html) const;
+
+private:
+  void add(PaintLayerStatistics& stats, qint64 totalNs, const qint64 *timesNs, int objects);
+  QString statsName(const PaintLayerStatistics *stats) const;
+
+  QVector<PaintLayerStatistics> layers;
+  QHash<QString, int> layerIndex;
+  PaintLayerStatistics frame, baseMap;
+
+  QElapsedTimer frameTimer;
+  PaintLayerStatistics *currentLayer = nullptr;
+  qint64 layerStartNs = 0, currentNs[paintstat::NUM_TIME_TYPES] = {0, 0, 0}, frameNs[paintstat::NUM_TIME_TYPES] = {0, 0, 0};
+  int layerStartObjects = 0;
+
+  /* Frame arena counters summed up over all frames and for the last frame */
+  quint64 arenaFrames = 0, sumArenaAcquires = 0, sumArenaAllocations = 0;
+  int lastArenaAcquires = 0, lastArenaAllocations = 0;
+};
+
+#endif // LNM_PAINTSTATISTICS_H
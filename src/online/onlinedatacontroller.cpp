@@ -23,7 +23,9 @@
 #include "gui/mainwindow.h"
 #include "common/maptools.h"
 #include "common/constants.h"
+#include "common/stallmonitor.h"
 #include "options/optiondata.h"
+#include "query/querytypes.h"
 #include "zip/gzip.h"
 #include "gui/dialog.h"
 #include "geo/calculations.h"
@@ -38,6 +40,8 @@
 #include <QMessageBox>
 #include <QTextCodec>
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QtConcurrent/QtConcurrentRun>
 
 static const int MIN_SERVER_DOWNLOAD_INTERVAL_MIN = 15;
 static const int MIN_TRANSCEIVER_DOWNLOAD_INTERVAL_MIN = 5;
@@ -45,6 +49,13 @@ static const int MIN_TRANSCEIVER_DOWNLOAD_INTERVAL_MIN = 5;
 // Minimum reload time for whazzup files (JSON or txt)
 static const int MIN_RELOAD_TIME_SECONDS = 15;
 
+// Inflation of the map display cache rectangle for aircraft
+static const double QUERY_RECT_INFLATION_FACTOR = 0.2;
+static const double QUERY_RECT_INFLATION_INCREMENT = 0.1;
+
+// Tile size of the client grid index in 1/100 degree
+static const int CLIENT_GRID_TILE_SIZE = 500;
+
 using atools::fs::online::OnlinedataManager;
 using atools::util::HttpDownloader;
 using atools::geo::LineString;
@@ -96,9 +107,18 @@ OnlinedataController::OnlinedataController(atools::fs::online::OnlinedataManager
   updateAtcSizes();
 
   connect(downloader, &HttpDownloader::downloadFinished, this, &OnlinedataController::downloadFinished);
+  connect(&decodeWatcher, &QFutureWatcher<std::pair<QString, int> >::finished, this, &OnlinedataController::decodeFinished);
   connect(downloader, &HttpDownloader::downloadFailed, this, &OnlinedataController::downloadFailed);
   connect(downloader, &HttpDownloader::downloadSslErrors, this, &OnlinedataController::downloadSslErrors);
 
+  // Invalidate caches depending on online data before any other receiver is notified
+  connect(this, &OnlinedataController::onlineClientAndAtcUpdated, this, []() -> void {
+    query::incrementRevision(query::REV_ONLINE);
+  });
+  connect(this, &OnlinedataController::onlineNetworkChanged, this, []() -> void {
+    query::incrementRevision(query::REV_ONLINE);
+  });
+
   // Recurring downloads
   connect(&downloadTimer, &QTimer::timeout, this, &OnlinedataController::startDownloadInternal);
 
@@ -114,6 +134,10 @@ OnlinedataController::~OnlinedataController()
 {
   manager->setGeometryCallback(atools::fs::online::GeoCallbackType(nullptr));
 
+  // Wait for background decoding to finish
+  decodeCycle++;
+  decodeWatcher.waitForFinished();
+
   deInitQueries();
 
   delete downloader;
@@ -250,7 +274,7 @@ atools::sql::SqlDatabase *OnlinedataController::getDatabase()
   return manager->getDatabase();
 }
 
-QString OnlinedataController::uncompress(const QByteArray& data, const QString& func, bool utf8)
+QString OnlinedataController::uncompress(const QByteArray& data, const QString& func, bool utf8, QTextCodec *codec)
 {
   QByteArray textData = atools::zip::gzipDecompressIf(data, func);
 
@@ -263,9 +287,58 @@ QString OnlinedataController::uncompress(const QByteArray& data, const QString&
 
 void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
 {
+  LNM_STALL_SCOPE;
+
   if(verbose)
     qDebug() << Q_FUNC_INFO << "url" << url << "data size" << data.size() << "state" << stateAsStr(currentState);
 
+  // Status and servers files use Windows encoding - all JSON files are UTF-8
+  bool utf8 = false;
+  if(currentState == DOWNLOADING_TRANSCEIVERS)
+    utf8 = true;
+  else if(currentState == DOWNLOADING_WHAZZUP)
+  {
+    atools::fs::online::Format format = convertFormat(OptionData::instance().getOnlineFormat());
+    utf8 = format == atools::fs::online::VATSIM_JSON3 || format == atools::fs::online::IVAO_JSON2;
+  }
+
+  // Skip decoding and parsing if the file is identical to the last download for this state
+  QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+  if(lastDownloadHashes.value(currentState) == hash)
+  {
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "Unchanged" << url;
+    processDownload(QString(), true /* unchanged */);
+    return;
+  }
+  lastDownloadHashes.insert(currentState, hash);
+
+  // Decompress and convert multi-megabyte files in background to keep the GUI responsive
+  // Parsing and database update is done in decodeFinished() in the GUI thread
+  QTextCodec *textCodec = codec;
+  int cycle = decodeCycle;
+  decodeWatcher.setFuture(QtConcurrent::run([data, url, utf8, textCodec, cycle]() -> std::pair<QString, int> {
+    return std::make_pair(uncompress(data, url, utf8, textCodec), cycle);
+  }));
+}
+
+void OnlinedataController::decodeFinished()
+{
+  const std::pair<QString, int> result = decodeWatcher.result();
+
+  if(result.second != decodeCycle)
+  {
+    // Processes were stopped while decoding - ignore result
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "Ignoring result from cycle" << result.second << "current" << decodeCycle;
+    return;
+  }
+
+  processDownload(result.first, false /* unchanged */);
+}
+
+void OnlinedataController::processDownload(const QString& text, bool unchanged)
+{
   const QDateTime now = QDateTime::currentDateTime();
   if(currentState == DOWNLOADING_STATUS)
   {
@@ -273,20 +346,21 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
     if(verbose)
       qDebug() << Q_FUNC_INFO << "DOWNLOADING_STATUS";
 
-    QString statusTxt = uncompress(data, Q_FUNC_INFO, false /* utf8 */);
+    const QString& statusTxt = text;
 
 #ifdef DEBUG_INFORMATION_ONLINE
     atools::strToFile(QDir::tempPath() + "/lnm_status.txt", statusTxt);
 #endif
 
     // Parse status file
-    manager->readFromStatus(statusTxt);
+    if(!unchanged)
+      manager->readFromStatus(statusTxt);
 
     // Get URL from status file
     bool whazzupGzipped = false, whazzupJson = false;
     whazzupUrlFromStatus = manager->getWhazzupUrlFromStatus(whazzupGzipped, whazzupJson);
 
-    if(!manager->getMessageFromStatus().isEmpty())
+    if(!unchanged && !manager->getMessageFromStatus().isEmpty())
       // Call later in the event loop
       QTimer::singleShot(0, this, &OnlinedataController::showMessageDialog);
 
@@ -318,13 +392,14 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
     if(verbose)
       qDebug() << Q_FUNC_INFO << "DOWNLOADING_TRANSCEIVERS";
 
-    QString tranceiversTxt = uncompress(data, Q_FUNC_INFO, true /* utf8 */);
+    const QString& tranceiversTxt = text;
 
 #ifdef DEBUG_INFORMATION_ONLINE
     atools::strToFile(QDir::tempPath() + "/lnm_tranceivers.json", tranceiversTxt);
 #endif
     // transceivers.json downloaded ============================================
-    manager->readFromTransceivers(tranceiversTxt);
+    if(!unchanged)
+      manager->readFromTransceivers(tranceiversTxt);
 
     // Next in chain after transceivers is JSON
     currentState = DOWNLOADING_WHAZZUP;
@@ -344,13 +419,14 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
     bool vatsimJson = format == atools::fs::online::VATSIM_JSON3;
     bool ivaoJson = format == atools::fs::online::IVAO_JSON2;
 
-    QString whazzupTxt = uncompress(data, Q_FUNC_INFO, ivaoJson || vatsimJson /* utf8 */);
+    const QString& whazzupTxt = text;
 
 #ifdef DEBUG_INFORMATION_ONLINE
     atools::strToFile(QDir::tempPath() + "/lnm_whazzup." + (ivaoJson || vatsimJson ? "json" : "txt"), whazzupTxt);
 #endif
 
-    if(manager->readFromWhazzup(whazzupTxt, format, manager->getLastUpdateTimeFromWhazzup()))
+    // Skip parsing and database update if file did not change
+    if(!unchanged && manager->readFromWhazzup(whazzupTxt, format, manager->getLastUpdateTimeFromWhazzup()))
     {
       QString whazzupVoiceUrlFromStatus = manager->getWhazzupVoiceUrlFromStatus();
       if(!vatsimJson && !ivaoJson && !whazzupVoiceUrlFromStatus.isEmpty() &&
@@ -368,9 +444,25 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
         currentState = NONE;
         lastUpdateTime = now;
 
-        // Clear map display cache and update spatial index to match simulator shadow aircraft
-        aircraftCache.clear();
+        // Reload in-memory client list and index - map display cache is cleared below if needed
+        loadClientAircraft();
+
+        // Clear map display cache only if changed clients are within the cached area ===============
+        bool cacheAffected = false;
+        int numChanged = diffClients(cacheAffected);
+
+        // Update spatial index to match simulator shadow aircraft
+        // Shadow changes alter the list of aircraft in the cache too
+        QHash<int, int> lastAircraftIdOnlineToSim(aircraftIdOnlineToSim);
         updateShadowIndex();
+        cacheAffected |= lastAircraftIdOnlineToSim != aircraftIdOnlineToSim;
+
+        if(cacheAffected)
+          aircraftCache.clear();
+
+        if(verbose)
+          qDebug() << Q_FUNC_INFO << "Changed clients" << numChanged << "of" << clientPositions.size()
+                   << "cacheAffected" << cacheAffected;
 
         // Message for search tabs, map widget and info
         emit onlineServersUpdated(true /* load all */, true /* keep selection */, true /* force */);
@@ -394,7 +486,7 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
     if(verbose)
       qDebug() << Q_FUNC_INFO << "DOWNLOADING_WHAZZUP_SERVERS";
 
-    QString serversTxt = uncompress(data, Q_FUNC_INFO, false /* utf8 */);
+    const QString& serversTxt = text;
     atools::fs::online::Format format = convertFormat(OptionData::instance().getOnlineFormat());
 
 #ifdef DEBUG_INFORMATION_ONLINE
@@ -415,7 +507,8 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
     atools::strToFile(QDir::tempPath() + "/lnm_servers." + suffix, serversTxt);
 #endif
 
-    manager->readServersFromWhazzup(serversTxt, format, manager->getLastUpdateTimeFromWhazzup());
+    if(!unchanged)
+      manager->readServersFromWhazzup(serversTxt, format, manager->getLastUpdateTimeFromWhazzup());
     lastServerDownload = now;
 
     // Done after downloading server.txt - start timer for next session
@@ -487,6 +580,10 @@ void OnlinedataController::stopAllProcesses()
   downloader->cancelDownload();
   downloadTimer.stop();
   currentState = NONE;
+
+  // Ignore results of running decode threads and parse next downloads in any case
+  decodeCycle++;
+  lastDownloadHashes.clear();
   // clientCallsignAndPosMap.clear(); // Do not clear these until the download is finished
 }
 
@@ -526,8 +623,13 @@ void OnlinedataController::optionsChanged()
 
   // Remove all from the database
   manager->clearData();
+  lastDownloadHashes.clear();
   aircraftCache.clear();
+  clientPositions.clear();
+  clientAircraft.clear();
+  clientAircraftGrid.clear();
   onlineAircraftSpatialIndex.clear();
+  onlineAircraftRegKeyIndex.clear();
   aircraftIdSimToOnline.clear();
   aircraftIdOnlineToSim.clear();
   currentDataPacketMap.clear();
@@ -618,11 +720,7 @@ const QList<atools::fs::sc::SimConnectAircraft> *OnlinedataController::getAircra
                                                                                    const MapLayer *mapLayer, bool lazy,
                                                                                    bool& overflow)
 {
-  static const double queryRectInflationFactor = 0.2;
-  static const double queryRectInflationIncrement = 0.1;
-  static const int queryMaxRows = 5000;
-
-  aircraftCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
+  aircraftCache.updateCache(rect, mapLayer, QUERY_RECT_INFLATION_FACTOR, QUERY_RECT_INFLATION_INCREMENT, lazy,
                             [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
   {
     return curLayer->hasSameQueryParametersAircraft(newLayer);
@@ -630,23 +728,35 @@ const QList<atools::fs::sc::SimConnectAircraft> *OnlinedataController::getAircra
 
   if((aircraftCache.list.isEmpty() && !lazy))
   {
-    for(const Marble::GeoDataLatLonBox& r : query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
+    const QVector<Marble::GeoDataLatLonBox> rects =
+      query::splitAtAntiMeridian(rect, QUERY_RECT_INFLATION_FACTOR, QUERY_RECT_INFLATION_INCREMENT);
+
+    // Look up all grid tiles covering the inflated rectangle and check each aircraft against the exact rectangles
+    for(const query::RectCacheTileKey& key :
+        query::rectCacheTiles(rect, CLIENT_GRID_TILE_SIZE, QUERY_RECT_INFLATION_FACTOR, QUERY_RECT_INFLATION_INCREMENT))
     {
-      query::bindRect(r, aircraftByRectQuery);
-      aircraftByRectQuery->exec();
-      while(aircraftByRectQuery->next())
+      for(int index : clientAircraftGrid.value(key))
       {
-        SimConnectAircraft onlineAircraft;
-        OnlinedataManager::fillFromClient(onlineAircraft, aircraftByRectQuery->record(),
-                                          getShadowSimAircraft(aircraftByRectQuery->valueInt("client_id")));
+        const SimConnectAircraft& onlineAircraft = clientAircraft.at(index);
+        const Pos& pos = onlineAircraft.getPosition();
+        Marble::GeoDataCoordinates coords(pos.getLonX(), pos.getLatY(), 0., Marble::GeoDataCoordinates::Degree);
 
-        if(!aircraftIdOnlineToSim.contains(onlineAircraft.getId()))
-          // Avoid duplicates with simulator shadow aircraft - sim aircraft are drawn in another context
-          aircraftCache.list.append(onlineAircraft);
+        for(const Marble::GeoDataLatLonBox& r : rects)
+        {
+          if(r.contains(coords))
+          {
+            if(!aircraftIdOnlineToSim.contains(onlineAircraft.getId()))
+              // Avoid duplicates with simulator shadow aircraft - sim aircraft are drawn in another context
+              aircraftCache.list.append(onlineAircraft);
+            break;
+          }
+        }
       }
     }
   }
-  overflow = aircraftCache.validate(queryMaxRows);
+
+  // No row limit needed since aircraft are not loaded from the database
+  overflow = false;
   return &aircraftCache.list;
 }
 
@@ -725,24 +835,53 @@ void OnlinedataController::updateAircraftShadowState(atools::fs::sc::SimConnectD
 }
 
 /* Return online aircraft for simulator aircraft based on distance and other parameter similarity */
+bool OnlinedataController::isShadowMatch(const atools::fs::sc::SimConnectAircraft& simAircraft, const OnlineAircraft& aircraft) const
+{
+  bool altOk = true, gsOk = true, hdgOk = true;
+
+  if(atools::inRange(-1000.f, map::INVALID_ALTITUDE_VALUE / 4.f, simAircraft.getActualAltitudeFt()) &&
+     atools::inRange(-1000.f, map::INVALID_ALTITUDE_VALUE / 4.f, aircraft.pos.getAltitude()))
+    altOk = atools::almostEqual(simAircraft.getActualAltitudeFt(), aircraft.pos.getAltitude(), maxShadowAltDiffFt);
+
+  if(atools::inRange(0.f, map::INVALID_SPEED_VALUE / 4.f, simAircraft.getGroundSpeedKts()) &&
+     atools::inRange(0.f, map::INVALID_SPEED_VALUE / 4.f, aircraft.groundSpeedKts))
+    gsOk = atools::almostEqual(simAircraft.getGroundSpeedKts(), aircraft.groundSpeedKts, maxShadowGsDiffKts);
+
+  if(atools::inRange(0.f, map::INVALID_HEADING_VALUE / 4.f, simAircraft.getHeadingDegTrue()) &&
+     atools::inRange(0.f, map::INVALID_HEADING_VALUE / 4.f, aircraft.headingTrue))
+    hdgOk = atools::geo::angleAbsDiff(simAircraft.getHeadingDegTrue(), aircraft.headingTrue) < maxShadowHdgDiffDeg;
+
+  return altOk && gsOk && hdgOk;
+}
+
 OnlineAircraft OnlinedataController::shadowAircraftInternal(const atools::fs::sc::SimConnectAircraft& simAircraft)
 {
   const static OnlineAircraft EMPTY_ONLINE_AIRCRAFT;
 
-#ifdef DEBUG_INFORMATION_USER_ONLINE_DISABLED
-  if(simAircraft.isUser())
+  // Try exact match by callsign first which avoids the radius search ======================================
+  const QString regKey = simAircraft.getAirplaneRegistrationKey();
+  if(!regKey.isEmpty())
   {
-    qDebug() << Q_FUNC_INFO << simAircraft.getAirplaneRegistrationKey() << simAircraft.getPosition();
-
-    if(onlineAircraftRegKeyIndex.contains(simAircraft.getAirplaneRegistrationKey()))
+    auto it = onlineAircraftRegKeyIndex.constFind(regKey);
+    if(it != onlineAircraftRegKeyIndex.constEnd())
     {
-      const atools::geo::Pos pos = onlineAircraftRegKeyIndex.value(simAircraft.getAirplaneRegistrationKey()).getPosition();
-      qDebug() << Q_FUNC_INFO << "online" << pos << "sim" << simAircraft.getPosition();
+      const OnlineAircraft& aircraft = it.value();
+
+#ifdef DEBUG_INFORMATION_USER_ONLINE_DISABLED
+      if(simAircraft.isUser())
+        qDebug() << Q_FUNC_INFO << regKey << "online" << aircraft.pos << "sim" << simAircraft.getPosition()
+                 << atools::geo::meterToNm(aircraft.pos.distanceMeterTo3d(simAircraft.getPosition()));
+#endif
 
-      qDebug() << Q_FUNC_INFO << atools::geo::meterToNm(pos.distanceMeterTo3d(simAircraft.getPosition()));
+      if(aircraft.pos.distanceMeterTo(simAircraft.getPosition()) < atools::geo::nmToMeter(maxShadowDistanceNm) &&
+         isShadowMatch(simAircraft, aircraft))
+      {
+        if(verbose && simAircraft.isUser())
+          qDebug() << Q_FUNC_INFO << "Found by callsign" << aircraft.registrationKey;
+        return aircraft;
+      }
     }
   }
-#endif
 
   if(!onlineAircraftSpatialIndex.isEmpty())
   {
@@ -756,21 +895,7 @@ OnlineAircraft OnlinedataController::shadowAircraftInternal(const atools::fs::sc
     // Filter out all which do not match more non-spatial criteria =================================
     nearest.erase(std::remove_if(nearest.begin(), nearest.end(),
                                  [&simAircraft, this](const OnlineAircraft& aircraft) -> bool {
-      bool altOk = true, gsOk = true, hdgOk = true;
-
-      if(atools::inRange(-1000.f, map::INVALID_ALTITUDE_VALUE / 4.f, simAircraft.getActualAltitudeFt()) &&
-         atools::inRange(-1000.f, map::INVALID_ALTITUDE_VALUE / 4.f, aircraft.pos.getAltitude()))
-        altOk = atools::almostEqual(simAircraft.getActualAltitudeFt(), aircraft.pos.getAltitude(), maxShadowAltDiffFt);
-
-      if(atools::inRange(0.f, map::INVALID_SPEED_VALUE / 4.f, simAircraft.getGroundSpeedKts()) &&
-         atools::inRange(0.f, map::INVALID_SPEED_VALUE / 4.f, aircraft.groundSpeedKts))
-        gsOk = atools::almostEqual(simAircraft.getGroundSpeedKts(), aircraft.groundSpeedKts, maxShadowGsDiffKts);
-
-      if(atools::inRange(0.f, map::INVALID_HEADING_VALUE / 4.f, simAircraft.getHeadingDegTrue()) &&
-         atools::inRange(0.f, map::INVALID_HEADING_VALUE / 4.f, aircraft.headingTrue))
-        hdgOk = atools::geo::angleAbsDiff(simAircraft.getHeadingDegTrue(), aircraft.headingTrue) < maxShadowHdgDiffDeg;
-
-      return !(altOk && gsOk && hdgOk);
+      return !isShadowMatch(simAircraft, aircraft);
     }), nearest.end());
 
     if(verbose && simAircraft.isUser())
@@ -793,10 +918,59 @@ OnlineAircraft OnlinedataController::shadowAircraftInternal(const atools::fs::sc
 void OnlinedataController::clearShadowIndexes()
 {
   onlineAircraftSpatialIndex.clear();
+  onlineAircraftRegKeyIndex.clear();
   aircraftIdSimToOnline.clear();
   aircraftIdOnlineToSim.clear();
 }
 
+int OnlinedataController::diffClients(bool& cacheAffected)
+{
+  // Use the same area as requested by the map display
+  Marble::GeoDataLatLonBox cacheRect(aircraftCache.curRect);
+  bool checkRect = !cacheRect.isEmpty();
+  if(checkRect)
+    query::inflateQueryRect(cacheRect, QUERY_RECT_INFLATION_FACTOR, QUERY_RECT_INFLATION_INCREMENT);
+
+  auto insideCache = [&cacheRect, checkRect](const Pos& pos) -> bool {
+    return !checkRect ||
+           cacheRect.contains(Marble::GeoDataCoordinates(pos.getLonX(), pos.getLatY(), 0., Marble::GeoDataCoordinates::Degree));
+  };
+
+  int numChanged = 0;
+  QHash<QString, Pos> positions;
+  for(const OnlineAircraft& aircraft : manager->getClientCallsignAndPosMap())
+  {
+    positions.insert(aircraft.registration, aircraft.pos);
+
+    auto it = clientPositions.constFind(aircraft.registration);
+    if(it == clientPositions.constEnd())
+    {
+      // New client
+      numChanged++;
+      cacheAffected |= insideCache(aircraft.pos);
+    }
+    else if(!it.value().almostEqual(aircraft.pos))
+    {
+      // Client moved - check old and new position
+      numChanged++;
+      cacheAffected |= insideCache(it.value()) || insideCache(aircraft.pos);
+    }
+  }
+
+  // Removed clients
+  for(auto it = clientPositions.constBegin(); it != clientPositions.constEnd(); ++it)
+  {
+    if(!positions.contains(it.key()))
+    {
+      numChanged++;
+      cacheAffected |= insideCache(it.value());
+    }
+  }
+
+  clientPositions.swap(positions);
+  return numChanged;
+}
+
 // Called after each download
 void OnlinedataController::updateShadowIndex()
 {
@@ -852,10 +1026,17 @@ void OnlinedataController::updateShadowIndex()
       atools::fs::sc::SimConnectData currentDataPacket = entry.value();
       if(currentDataPacket.isUserAircraftValid())
       {
-        // Fill and update spatial index =================================
-        onlineAircraftSpatialIndex.append(manager->getClientCallsignAndPosMap());
+        // Fill and update spatial index and callsign index =================================
+        const auto clients = manager->getClientCallsignAndPosMap();
+        onlineAircraftSpatialIndex.append(clients);
         onlineAircraftSpatialIndex.updateIndex();
 
+        for(const OnlineAircraft& aircraft : clients)
+        {
+          if(!aircraft.registrationKey.isEmpty())
+            onlineAircraftRegKeyIndex.insert(aircraft.registrationKey, aircraft);
+        }
+
         const atools::fs::sc::SimConnectUserAircraft& simUserAircraft = currentDataPacket.getUserAircraftConst();
         if(!simUserAircraft.isAnyBoat())
         {
@@ -939,18 +1120,53 @@ void OnlinedataController::initQueries()
 
   manager->initQueries();
 
-  aircraftByRectQuery = new atools::sql::SqlQuery(getDatabase());
-  aircraftByRectQuery->prepare("select * from client where lonx between :leftx and :rightx and laty between :bottomy and :topy");
+  aircraftAllQuery = new atools::sql::SqlQuery(getDatabase());
+  aircraftAllQuery->prepare("select * from client");
+
+  // Data might be still present in the database
+  loadClientAircraft();
+}
+
+void OnlinedataController::loadClientAircraft()
+{
+  clientAircraft.clear();
+  clientAircraftGrid.clear();
+
+  if(aircraftAllQuery == nullptr)
+    return;
+
+  aircraftAllQuery->exec();
+  while(aircraftAllQuery->next())
+  {
+    SimConnectAircraft onlineAircraft;
+    // Shadow aircraft are filtered out in getAircraft() - no need to pass a simulator aircraft
+    OnlinedataManager::fillFromClient(onlineAircraft, aircraftAllQuery->record(), SimConnectAircraft());
+
+    const Pos& pos = onlineAircraft.getPosition();
+    if(pos.isValid())
+    {
+      clientAircraftGrid[query::rectCacheTileForPos(pos.getLonX(), pos.getLatY(), CLIENT_GRID_TILE_SIZE)].append(clientAircraft.size());
+      clientAircraft.append(onlineAircraft);
+    }
+  }
+  aircraftAllQuery->finish();
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "clientAircraft.size()" << clientAircraft.size() << "tiles" << clientAircraftGrid.size();
 }
 
 void OnlinedataController::deInitQueries()
 {
   aircraftCache.clear();
+  clientPositions.clear();
 
   manager->deInitQueries();
 
-  delete aircraftByRectQuery;
-  aircraftByRectQuery = nullptr;
+  clientAircraft.clear();
+  clientAircraftGrid.clear();
+
+  delete aircraftAllQuery;
+  aircraftAllQuery = nullptr;
 }
 
 int OnlinedataController::getNumClients() const
@@ -23,6 +23,7 @@
 #include "query/querytypes.h"
 
 #include <QDateTime>
+#include <QFutureWatcher>
 #include <QObject>
 #include <QTimer>
 
@@ -104,7 +105,7 @@ public:
   QString getNetwork() const;
   bool isNetworkActive() const;
 
-  /* Get aircraft within bounding rectangle. Objects are cached. */
+  /* Get aircraft within bounding rectangle from the in-memory grid index. Objects are cached. overflow is always false. */
   const QList<atools::fs::sc::SimConnectAircraft> *getAircraft(const Marble::GeoDataLatLonBox& rect,
                                                                const MapLayer *mapLayer, bool lazy, bool& overflow);
 
@@ -171,17 +172,38 @@ private:
 
   /* Show message from status.txt */
   void showMessageDialog();
-  QString uncompress(const QByteArray& data, const QString& func, bool utf8);
+
+  /* Decompress if needed and convert to text. Thread safe. */
+  static QString uncompress(const QByteArray& data, const QString& func, bool utf8, QTextCodec *codec);
+
+  /* Called by decodeWatcher in the GUI thread once the background thread has converted the downloaded file */
+  void decodeFinished();
+
+  /* Parse decoded text depending on current state, update database and continue download chain.
+   * Parsing is skipped if unchanged is true and text is empty. */
+  void processDownload(const QString& text, bool unchanged);
   void startDownloader();
 
   /* Tries to fetch geometry for atc centers from the user geometry database from cache */
   const atools::geo::LineString *airspaceGeometryCallback(const QString& callsign, atools::fs::online::fac::FacilityType type);
 
+  /* Load all clients from the database into clientAircraft and build the grid index. Called after each download. */
+  void loadClientAircraft();
+
   /* Called after each download */
   void updateShadowIndex();
   void clearShadowIndexes();
 
-  /* Return online aircraft for simulator aircraft based on distance and other parameter similarity */
+  /* Compare all clients from the last download with the previous one by callsign and update clientPositions.
+   *  Returns the number of added, removed or moved clients. cacheAffected is set to true if any change is
+   *  within the area covered by the map display cache aircraftCache. */
+  int diffClients(bool& cacheAffected);
+
+  /* true if altitude, ground speed and heading of both aircraft are similar enough for a shadow */
+  bool isShadowMatch(const atools::fs::sc::SimConnectAircraft& simAircraft, const atools::fs::online::OnlineAircraft& aircraft) const;
+
+  /* Return online aircraft for simulator aircraft. Tries an exact callsign match first and falls back to a radius search.
+   * Both use distance and other parameter similarity. */
   atools::fs::online::OnlineAircraft shadowAircraftInternal(const atools::fs::sc::SimConnectAircraft& simAircraft);
 
   /* Database manager */
@@ -225,11 +247,24 @@ private:
 
   QTextCodec *codec = nullptr;
 
+  /* Decompression and text conversion of downloaded files is done in a background thread.
+   * Result is text and the value of decodeCycle when started. */
+  QFutureWatcher<std::pair<QString, int> > decodeWatcher;
+
+  /* SHA-1 of the last downloaded file for each download state. Used to skip unchanged files. */
+  QHash<int, QByteArray> lastDownloadHashes;
+
+  /* Incremented when stopping all processes to ignore results from running decode threads */
+  int decodeCycle = 0;
+
   bool verbose = false;
 
   // All online aircraft from download for spatial search (nearest)
   atools::geo::SpatialIndex<atools::fs::online::OnlineAircraft> onlineAircraftSpatialIndex;
 
+  // All online aircraft from download keyed by registration key (callsign) for fast exact matching
+  QHash<QString, atools::fs::online::OnlineAircraft> onlineAircraftRegKeyIndex;
+
   // Keys use either online database semi-permanent id or object ID from simulator. Includes user
   // modeS_id for X-Plane: integer 24bit (0-16777215 or 0 - 0xFFFFFF) unique ID of the airframe. This is also known as the ADS-B "hexcode".
   // dwObjectID for SimConnect
@@ -241,9 +276,19 @@ private:
   // fit to the last update time of the downloaded whazzup file
   QMap<QDateTime, atools::fs::sc::SimConnectData> currentDataPacketMap;
 
+  // Client positions from the last download keyed by callsign. Used to find changes between downloads.
+  QHash<QString, atools::geo::Pos> clientPositions;
+
   // Cache used for map display
   query::SimpleRectCache<atools::fs::sc::SimConnectAircraft> aircraftCache;
-  atools::sql::SqlQuery *aircraftByRectQuery = nullptr;
+  atools::sql::SqlQuery *aircraftAllQuery = nullptr;
+
+  // All online aircraft from last download. Filled from the client table once per download
+  // and used for map display queries instead of database rectangle queries.
+  QVector<atools::fs::sc::SimConnectAircraft> clientAircraft;
+
+  // Grid of fixed size tiles with indexes into clientAircraft
+  QHash<query::RectCacheTileKey, QVector<int> > clientAircraftGrid;
 };
 
 #endif // LNM_ONLINECONTROLLER_H
@@ -20,6 +20,7 @@
 #include "common/constants.h"
 #include "exception.h"
 
+#include <QDataStream>
 #include <QDebug>
 #include <QFont>
 #include <QFontDatabase>
@@ -168,6 +169,196 @@ const QSize OptionData::getGuiToolbarSize() const
   return QSize(guiToolbarSize, guiToolbarSize);
 }
 
+namespace  {
+/* Write flags, enums and integers with a common size */
+template<typename TYPE>
+void sig(QDataStream& out, TYPE value)
+{
+  out << static_cast<qint64>(value);
+}
+
+}
+
+QVector<QByteArray> OptionData::getDomainSignatures() const
+{
+  QVector<QByteArray> signatures;
+  for(int i = 0; i < optsdom::DOMAIN_COUNT; i++)
+    signatures.append(domainSignature(static_cast<optsdom::Domain>(1 << i)));
+  return signatures;
+}
+
+optsdom::Domains OptionData::getChangedDomains(const QVector<QByteArray>& lastSignatures) const
+{
+  if(lastSignatures.size() != optsdom::DOMAIN_COUNT)
+    return optsdom::ALL;
+
+  optsdom::Domains domains = optsdom::NONE;
+  for(int i = 0; i < optsdom::DOMAIN_COUNT; i++)
+  {
+    optsdom::Domain domain = static_cast<optsdom::Domain>(1 << i);
+    if(domainSignature(domain) != lastSignatures.at(i))
+      domains |= domain;
+  }
+  return domains;
+}
+
+QByteArray OptionData::domainSignature(optsdom::Domain domain) const
+{
+  // Flags which are not assigned to the general domain
+  const opts::Flags flagsOnline = opts::ONLINE_REMOVE_SHADOW;
+  const opts::Flags flagsElevation = opts::CACHE_USE_ONLINE_ELEVATION | opts::CACHE_USE_OFFLINE_ELEVATION;
+  const opts2::Flags2 flags2Online = opts2::ONLINE_AIRSPACE_BY_NAME | opts2::ONLINE_AIRSPACE_BY_FILE;
+  const opts2::Flags2 flags2Units = opts2::UNIT_FUEL_SHOW_OTHER | opts2::UNIT_TRUE_COURSE;
+
+  QByteArray bytes;
+  QDataStream out(&bytes, QIODevice::WriteOnly);
+
+  switch(domain)
+  {
+    case optsdom::UNITS:
+      sig(out, unitDist);
+      sig(out, unitShortDist);
+      sig(out, unitAlt);
+      sig(out, unitSpeed);
+      sig(out, unitVertSpeed);
+      sig(out, unitCoords);
+      sig(out, unitFuelWeight);
+      sig(out, flags2 & flags2Units);
+      break;
+
+    case optsdom::ONLINE:
+      sig(out, flags & flagsOnline);
+      sig(out, flags2 & flags2Online);
+      sig(out, onlineNetwork);
+      sig(out, onlineFormat);
+      out << onlineStatusUrl << onlineWhazzupUrl << onlineVatsimStatusUrl << onlineVatsimTransceiverUrl
+          << onlineIvaoWhazzupUrl << onlinePilotEdgeStatusUrl;
+      sig(out, onlineCustomReload);
+      sig(out, onlineVatsimReload);
+      sig(out, onlineVatsimTransceiverReload);
+      sig(out, onlinePilotEdgeReload);
+      sig(out, onlineIvaoReload);
+      sig(out, displayOnlineClearance);
+      sig(out, displayOnlineArea);
+      sig(out, displayOnlineApproach);
+      sig(out, displayOnlineDeparture);
+      sig(out, displayOnlineFir);
+      sig(out, displayOnlineObserver);
+      sig(out, displayOnlineGround);
+      sig(out, displayOnlineTower);
+      break;
+
+    case optsdom::WEATHER:
+      sig(out, flagsWeather);
+      out << weatherActiveSkyPath << weatherXplane11Path << weatherXplane12Path << weatherNoaaUrl << weatherVatsimUrl
+          << weatherIvaoUrl << weatherNoaaWindBaseUrl << weatherXplaneWind;
+      break;
+
+    case optsdom::ELEVATION:
+      sig(out, flags & flagsElevation);
+      out << cacheOfflineElevationPath;
+      break;
+
+    case optsdom::WEB:
+      out << webDocumentRoot;
+      sig(out, webPort);
+      sig(out, webEncrypted);
+      break;
+
+    case optsdom::GENERAL:
+      sig(out, flags & ~(flagsOnline | flagsElevation));
+      sig(out, flags2 & ~(flags2Online | flags2Units));
+      out << cacheMapThemeDir << flightplanPattern << databaseInclude << databaseExclude << databaseAddonExclude
+          << guiLanguage << guiFont << mapFont << mapThemeKeys;
+      sig(out, mapScrollDetail);
+      sig(out, mapNavigation);
+      sig(out, simUpdateRate);
+      sig(out, simUpdateBox);
+      sig(out, simUpdateBoxCenterLegZoom);
+      sig(out, cacheSizeDisk);
+      sig(out, cacheSizeMemory);
+      sig(out, guiInfoTextSize);
+      sig(out, guiPerfReportTextSize);
+      sig(out, guiInfoSimSize);
+      sig(out, guiRouteTableTextSize);
+      sig(out, guiSearchTableTextSize);
+      sig(out, guiToolbarSize);
+      sig(out, guiStyleMapDimming);
+      sig(out, mapClickSensitivity);
+      sig(out, mapTooltipSensitivity);
+      sig(out, mapSymbolSize);
+      sig(out, mapTextSize);
+      out << mapZoomShowClick << mapZoomShowMenu;
+      sig(out, routeGroundBuffer);
+      sig(out, altitudeRuleType);
+      sig(out, displayTextSizeAircraftAi);
+      sig(out, displayThicknessFlightplan);
+      sig(out, displayThicknessFlightplanProfile);
+      sig(out, displaySymbolSizeAirport);
+      sig(out, displaySymbolSizeAirportWeather);
+      sig(out, displaySymbolSizeWindBarbs);
+      sig(out, displaySymbolSizeAircraftAi);
+      sig(out, displayTextSizeNavaid);
+      sig(out, displayTextSizeUserpoint);
+      sig(out, displaySymbolSizeNavaid);
+      sig(out, displaySymbolSizeUserpoint);
+      sig(out, displaySymbolSizeHighlight);
+      sig(out, displayTextSizeAirway);
+      sig(out, displayThicknessAirway);
+      sig(out, displayTextSizeFlightplan);
+      sig(out, displayTextSizeFlightplanProfile);
+      sig(out, displayTransparencyFlightplan);
+      sig(out, displayTextSizeAircraftUser);
+      sig(out, displaySymbolSizeAircraftUser);
+      sig(out, displayTextSizeAirport);
+      sig(out, displayThicknessTrail);
+      sig(out, displayThicknessUserFeature);
+      sig(out, displayThicknessMeasurement);
+      sig(out, displayThicknessCompassRose);
+      sig(out, displaySunShadingDimFactor);
+      sig(out, aircraftTrailMaxPoints);
+      sig(out, aircraftTrailMaxMinutes);
+      sig(out, simNoFollowOnScrollTime);
+      out << simZoomOnLandingDist << simZoomOnTakeoffDist;
+      sig(out, simCleanupTableTime);
+      sig(out, displayTextSizeUserFeature);
+      sig(out, displayTextSizeMeasurement);
+      sig(out, displayTextSizeCompassRose);
+      sig(out, displayMapHighlightTransparent);
+      sig(out, displayTransparencyMora);
+      sig(out, displayTextSizeMora);
+      sig(out, displayTransparencyAirportMsa);
+      sig(out, displayTextSizeAirportMsa);
+      sig(out, mapNavTouchArea);
+      sig(out, displayThicknessAirspace);
+      sig(out, displayTransparencyAirspace);
+      sig(out, displayTextSizeAirspace);
+      out << flightplanColor << flightplanOutlineColor << flightplanProcedureColor << flightplanActiveColor
+          << flightplanPassedColor << trailColor << measurementColor << highlightFlightplanColor << highlightSearchColor
+          << highlightProfileColor;
+      sig(out, displayTrailType);
+      sig(out, displayTrailGradientType);
+      sig(out, displayOptionsUserAircraft);
+      sig(out, displayOptionsAiAircraft);
+      sig(out, displayOptionsAirport);
+      sig(out, displayOptionsRose);
+      sig(out, displayOptionsMeasurement);
+      sig(out, displayOptionsNavAid);
+      sig(out, displayOptionsAirspace);
+      sig(out, displayOptionsRoute);
+      sig(out, displayTooltipOptions);
+      sig(out, displayClickOptions);
+      sig(out, updateRate);
+      sig(out, updateChannels);
+      break;
+
+    case optsdom::NONE:
+    case optsdom::ALL:
+      break;
+  }
+  return bytes;
+}
+
 const OptionData& OptionData::instance()
 {
   OptionData& optData = instanceInternal();
@@ -20,6 +20,7 @@
 
 #include <QColor>
 #include <QMap>
+#include <QVector>
 
 class QSize;
 class QFont;
@@ -626,6 +627,29 @@ Q_DECLARE_OPERATORS_FOR_FLAGS(optsd::DisplayClickOptions);
 
 } // namespace optsd
 
+/* Option domains used to notify only the parts of the program which are affected by changed options */
+namespace optsdom {
+enum Domain : quint32
+{
+  NONE = 0,
+  UNITS = 1 << 0, /* Units and course display */
+  ONLINE = 1 << 1, /* Online network, URLs, reload rates, ATC circle sizes and center boundary lookup */
+  WEATHER = 1 << 2, /* Weather sources, paths and URLs */
+  ELEVATION = 1 << 3, /* Online or offline GLOBE elevation data */
+  WEB = 1 << 4, /* Web server */
+  GENERAL = 1 << 5, /* All other map display, GUI, simulator, flight plan and database options */
+
+  ALL = UNITS | ONLINE | WEATHER | ELEVATION | WEB | GENERAL
+};
+
+/* Number of domains above excluding NONE and ALL */
+const static int DOMAIN_COUNT = 6;
+
+Q_DECLARE_FLAGS(Domains, Domain);
+Q_DECLARE_OPERATORS_FOR_FLAGS(optsdom::Domains);
+
+} // namespace optsdom
+
 /*
  * Contains global options that are provided using a singelton pattern.
  * All default values are defined in the widgets in the options.ui file.
@@ -653,6 +677,12 @@ public:
    *  This uses the settings directly and does not need an OptionData instance. */
   static QString getLanguage();
 
+  /* Get a serialized snapshot of all values for each domain. Index is bit position of optsdom::Domain. */
+  QVector<QByteArray> getDomainSignatures() const;
+
+  /* Compare the current values against signatures from getDomainSignatures() and return all changed domains */
+  optsdom::Domains getChangedDomains(const QVector<QByteArray>& lastSignatures) const;
+
   /* Get option flags */
   const opts::Flags getFlags() const
   {
@@ -1076,6 +1106,12 @@ public:
     return aircraftTrailMaxPoints;
   }
 
+  /* Show only trail points recorded in this time span on the map. 0 shows all. */
+  int getAircraftTrailMaxMinutes() const
+  {
+    return aircraftTrailMaxMinutes;
+  }
+
   int getSimNoFollowAircraftScrollSeconds() const
   {
     return simNoFollowOnScrollTime;
@@ -1332,6 +1368,9 @@ private:
   OptionData();
   static OptionData& instanceInternal();
 
+  /* Serialize all values belonging to the given domain */
+  QByteArray domainSignature(optsdom::Domain domain) const;
+
   // Singleton instance
   static OptionData *optionData;
 
@@ -1553,6 +1592,9 @@ private:
   // spinBoxSimMaxTrackPoints
   int aircraftTrailMaxPoints = 20000;
 
+  // spinBoxSimTrailMaxMinutes
+  int aircraftTrailMaxMinutes = 0;
+
   // spinBoxSimDoNotFollowOnScrollTime
   int simNoFollowOnScrollTime = 10;
 
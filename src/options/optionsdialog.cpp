@@ -36,6 +36,7 @@
 #include "gui/widgetutil.h"
 #include "mapgui/mapthemehandler.h"
 #include "mapgui/mapwidget.h"
+#include "query/querytypes.h"
 #include "app/navapp.h"
 #include "settings/settings.h"
 #include "ui_options.h"
@@ -431,6 +432,7 @@ OptionsDialog::OptionsDialog(QMainWindow *parentWindow)
      ui->spinBoxOptionsSimUpdateBox,
      ui->spinBoxOptionsSimCenterLegZoom,
      ui->spinBoxSimMaxTrackPoints,
+     ui->spinBoxSimTrailMaxMinutes,
      ui->radioButtonOptionsStartupShowHome,
      ui->radioButtonOptionsStartupShowLast,
      ui->radioButtonOptionsStartupShowFlightplan,
@@ -878,6 +880,10 @@ void OptionsDialog::open()
 
 void OptionsDialog::buttonBoxClicked(QAbstractButton *button)
 {
+  // Snapshot of all option domains to detect changes
+  const QVector<QByteArray> lastSignatures = OptionData::instance().getDomainSignatures();
+  const QHash<QString, QVariant> lastSettings = getOptionSettings();
+
   qDebug() << "Clicked" << button->text();
   if(button == ui->buttonBoxOptions->button(QDialogButtonBox::Apply))
   {
@@ -892,7 +898,7 @@ void OptionsDialog::buttonBoxClicked(QAbstractButton *button)
     NavApp::getMapThemeHandler()->setMapThemeKeys(OptionData::instanceInternal().mapThemeKeys);
 
     NavApp::updateChannels(OptionData::instance().getUpdateChannels());
-    emit optionsChanged();
+    emitOptionsChanged(getChangedDomains(lastSignatures, lastSettings));
 
     // Update dialog internal stuff
     updateWidgetStates();
@@ -913,7 +919,7 @@ void OptionsDialog::buttonBoxClicked(QAbstractButton *button)
     NavApp::getMapThemeHandler()->setMapThemeKeys(OptionData::instanceInternal().mapThemeKeys);
 
     NavApp::updateChannels(OptionData::instance().getUpdateChannels());
-    emit optionsChanged();
+    emitOptionsChanged(getChangedDomains(lastSignatures, lastSettings));
 
     // Close dialog
     accept();
@@ -1352,6 +1358,88 @@ void OptionsDialog::restoreState()
   ui->stackedWidgetOptions->setCurrentIndex(ui->listWidgetOptionPages->currentRow());
 }
 
+optsdom::Domains OptionsDialog::getChangedDomains(const QVector<QByteArray>& lastSignatures,
+                                                  const QHash<QString, QVariant>& lastSettings) const
+{
+  optsdom::Domains domains = OptionData::instance().getChangedDomains(lastSignatures);
+
+  if(domains == optsdom::NONE && getOptionSettings() != lastSettings)
+  {
+    // Option not covered by domain signatures changed - notify all general subscribers to be safe
+    qWarning() << Q_FUNC_INFO << "Option changed which is not assigned to a domain";
+    domains = optsdom::GENERAL;
+  }
+  return domains;
+}
+
+QHash<QString, QVariant> OptionsDialog::getOptionSettings() const
+{
+  // Dialog geometry, page and splitter and file dialog states are not options
+  const QString widgetPrefix = lnm::OPTIONS_DIALOG_WIDGET % "_";
+  const QStringList excludeKeys({widgetPrefix % objectName(),
+                                 widgetPrefix % ui->listWidgetOptionPages->objectName(),
+                                 widgetPrefix % ui->splitterOptions->objectName(),
+                                 lnm::OPTIONS_DIALOG_AS_FILE_DLG, lnm::OPTIONS_DIALOG_XPLANE_DLG,
+                                 lnm::OPTIONS_DIALOG_XPLANE12_DLG, lnm::OPTIONS_DIALOG_XPLANE_WIND_FILE_DLG,
+                                 lnm::OPTIONS_DIALOG_DB_DIR_DLG, lnm::OPTIONS_DIALOG_DB_PROGRESS_DLG,
+                                 lnm::OPTIONS_DIALOG_DB_FILE_DLG, lnm::OPTIONS_DIALOG_WEB_DOCROOT_DLG});
+
+  // Group name is the first part of all option keys
+  const QString group = QString(lnm::OPTIONS_DIALOG_WIDGET).section('/', 0, 0);
+
+  QHash<QString, QVariant> values;
+  QSettings *qSettings = Settings::getQSettings();
+  qSettings->beginGroup(group);
+  const QStringList keys = qSettings->allKeys();
+  for(const QString& key : keys)
+  {
+    QString fullKey = group % "/" % key;
+
+    // Exclude keys and sub keys of states
+    bool exclude = false;
+    for(const QString& excludeKey : excludeKeys)
+    {
+      if(fullKey == excludeKey || fullKey.startsWith(excludeKey % "/"))
+      {
+        exclude = true;
+        break;
+      }
+    }
+
+    if(!exclude)
+      values.insert(fullKey, qSettings->value(key));
+  }
+  qSettings->endGroup();
+  return values;
+}
+
+void OptionsDialog::emitOptionsChanged(optsdom::Domains domains)
+{
+  qDebug() << Q_FUNC_INFO << "domains" << domains;
+
+  if(domains == optsdom::NONE)
+    // Nothing changed - avoid expensive cache resets and reloads in all subscribers
+    return;
+
+  query::incrementRevision(query::REV_OPTIONS);
+  if(domains.testFlag(optsdom::UNITS))
+    query::incrementRevision(query::REV_OPTIONS_UNITS);
+
+  // Domain specific signals first since general subscribers may depend on these
+  if(domains.testFlag(optsdom::UNITS))
+    emit optionsChangedUnits();
+  if(domains.testFlag(optsdom::WEATHER))
+    emit optionsChangedWeather();
+  if(domains.testFlag(optsdom::ELEVATION))
+    emit optionsChangedElevation();
+  if(domains.testFlag(optsdom::ONLINE))
+    emit optionsChangedOnline();
+  if(domains.testFlag(optsdom::WEB))
+    emit optionsChangedWeb();
+
+  emit optionsChanged();
+}
+
 void OptionsDialog::updateTooltipOption()
 {
   // The overall tooltip state is checked by the Application event handler Application::notify()
@@ -1992,6 +2080,7 @@ void OptionsDialog::widgetsToOptionData()
   data.simUpdateBox = ui->spinBoxOptionsSimUpdateBox->value();
   data.simUpdateBoxCenterLegZoom = ui->spinBoxOptionsSimCenterLegZoom->value();
   data.aircraftTrailMaxPoints = ui->spinBoxSimMaxTrackPoints->value();
+  data.aircraftTrailMaxMinutes = ui->spinBoxSimTrailMaxMinutes->value();
 
   data.cacheSizeDisk = ui->spinBoxOptionsCacheDiskSize->value();
   data.cacheSizeMemory = ui->spinBoxOptionsCacheMemorySize->value();
@@ -2302,6 +2391,7 @@ void OptionsDialog::optionDataToWidgets(const OptionData& data)
   ui->spinBoxOptionsSimUpdateBox->setValue(data.simUpdateBox);
   ui->spinBoxOptionsSimCenterLegZoom->setValue(data.simUpdateBoxCenterLegZoom);
   ui->spinBoxSimMaxTrackPoints->setValue(data.aircraftTrailMaxPoints);
+  ui->spinBoxSimTrailMaxMinutes->setValue(data.aircraftTrailMaxMinutes);
   ui->spinBoxOptionsCacheDiskSize->setValue(data.cacheSizeDisk);
   ui->spinBoxOptionsCacheMemorySize->setValue(data.cacheSizeMemory);
   ui->spinBoxOptionsGuiInfoText->setValue(data.guiInfoTextSize);
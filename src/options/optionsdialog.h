@@ -21,6 +21,7 @@
 #include "options/optiondata.h"
 
 #include <QDialog>
+#include <QHash>
 #include <QLocale>
 
 namespace Ui {
@@ -89,6 +90,18 @@ public:
   /* Enable or disable tooltips changed */
   void updateTooltipOption();
 
+  /* Increment options revisions and notify receivers of changed option domains.
+   * Units revision only if a unit was changed. Does nothing if no option was changed. */
+  void emitOptionsChanged(optsdom::Domains domains);
+
+  /* Get changed domains from OptionData signatures. Falls back to general domain if no domain signature changed
+   * but any other saved option differs from the snapshot. Covers options not listed in the domain signatures. */
+  optsdom::Domains getChangedDomains(const QVector<QByteArray>& lastSignatures,
+                                     const QHash<QString, QVariant>& lastSettings) const;
+
+  /* Get all option values saved in the settings excluding dialog geometry and other GUI states */
+  QHash<QString, QVariant> getOptionSettings() const;
+
   void styleChanged();
 
   /* Set by DirTool if line edit is empty and dir is valid */
@@ -98,9 +111,17 @@ public:
   void fontChanged(const QFont& font);
 
 signals:
-  /* Emitted whenever OK or Apply is pressed on the dialog window */
+  /* Emitted when OK or Apply is pressed on the dialog window and any option was changed.
+   * Domain specific signals below are sent before this one. */
   void optionsChanged();
 
+  /* Emitted only if options of the respective domain have changed. See optsdom::Domain. */
+  void optionsChangedUnits();
+  void optionsChangedWeather();
+  void optionsChangedElevation();
+  void optionsChangedOnline();
+  void optionsChangedWeb();
+
   /* QGuiApplication::fontChanged is emitted for font changes */
 
 private:
@@ -35,6 +35,7 @@
 #include "gui/tools.h"
 #include "gui/dialog.h"
 #include "ui_mainwindow.h"
+#include "common/stallmonitor.h"
 #include "common/unit.h"
 #include "common/tabindexes.h"
 #include "util/htmlbuilder.h"
@@ -91,6 +92,9 @@ AircraftPerfController::AircraftPerfController(MainWindow *parent)
   // Create performance handler for background collection
   perfHandler = new AircraftPerfHandler(this);
   connect(perfHandler, &AircraftPerfHandler::flightSegmentChanged, this, &AircraftPerfController::flightSegmentChanged);
+
+  perfCollectIntervalMs = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_PERF_COLLECT_INTERVAL_MS,
+                                                                                   500).toInt();
 }
 
 AircraftPerfController::~AircraftPerfController()
@@ -624,6 +628,8 @@ float AircraftPerfController::cruiseAlt()
 
 void AircraftPerfController::routeChanged(bool, bool)
 {
+  LNM_STALL_SCOPE;
+
 #ifdef DEBUG_INFORMATION
   qDebug() << Q_FUNC_INFO;
 #endif
@@ -1441,6 +1447,7 @@ void AircraftPerfController::optionsChanged()
 void AircraftPerfController::connectedToSimulator()
 {
   currentReportLastSampleTimeMs = reportLastSampleTimeMs = 0L; // Force update on next simDataChanged
+  perfCollectLastSampleTimeMs = 0L;
   *lastSimData = atools::fs::sc::SimConnectData();
 }
 
@@ -1452,6 +1459,8 @@ void AircraftPerfController::disconnectedFromSimulator()
 
 void AircraftPerfController::simDataChanged(const atools::fs::sc::SimConnectData& simulatorData)
 {
+  LNM_STALL_SCOPE;
+
   *lastSimData = simulatorData;
 
 #ifdef DEBUG_INFORMATION_PERF_SIMDATA
@@ -1461,8 +1470,15 @@ void AircraftPerfController::simDataChanged(const atools::fs::sc::SimConnectData
            << simulatorData.getUserAircraftConst().getLocalTime().toMSecsSinceEpoch();
 #endif
 
-  // Pass to handler for averaging
-  perfHandler->simDataChanged(simulatorData, NavApp::getCurrentSimulatorShortName());
+  // Pass to handler for averaging - thin out high simulator update rates but do not delay takeoff and landing
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  bool onGround = simulatorData.getUserAircraftConst().isOnGround();
+  if(now >= perfCollectLastSampleTimeMs + perfCollectIntervalMs || onGround != perfCollectLastOnGround)
+  {
+    perfCollectLastSampleTimeMs = now;
+    perfCollectLastOnGround = onGround;
+    perfHandler->simDataChanged(simulatorData, NavApp::getCurrentSimulatorShortName());
+  }
 
   if(simulatorData.isUserAircraftValid())
   {
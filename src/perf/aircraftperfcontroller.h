@@ -265,6 +265,12 @@ private:
   /* Last update of report when collecting data */
   qint64 currentReportLastSampleTimeMs = 0L, reportLastSampleTimeMs = 0L;
 
+  /* Minimum time between packets passed to the performance handler and time of last passed packet.
+   * Packets are also passed immediately if the on-ground state changes. */
+  int perfCollectIntervalMs = 500;
+  qint64 perfCollectLastSampleTimeMs = 0L;
+  bool perfCollectLastOnGround = false;
+
   /* Timer to delay wind updates */
   QTimer windChangeTimer;
   atools::fs::sc::SimConnectData *lastSimData;
@@ -27,6 +27,7 @@
 #include "profile/profilelabelwidgethoriz.h"
 #include "profile/profileoptions.h"
 #include "ui_mainwindow.h"
+#include "common/stallmonitor.h"
 #include "common/symbolpainter.h"
 #include "util/htmlbuilder.h"
 #include "route/route.h"
@@ -44,7 +45,10 @@
 #include "options/optiondata.h"
 #include "perf/aircraftperfcontroller.h"
 
+#include <QCache>
+#include <QMutex>
 #include <QPainter>
+#include <QThreadPool>
 #include <QTimer>
 #include <QtConcurrent/QtConcurrentRun>
 #include <QStringBuilder>
@@ -75,6 +79,12 @@ static const float ELEVATION_SAMPLE_RADIUS_NM = 0.1f;
 /* Do not calculate a profile for legs longer than this value */
 static const int ELEVATION_MAX_LEG_NM = 2000;
 
+/* Number of trail points to remove at once if the maximum is exceeded */
+static const int PRUNE_TRAIL_POINTS = 200;
+
+/* Maximum number of threads used to sample legs */
+static const int ELEVATION_MAX_THREADS = 4;
+
 /* Zoom to aircraft + 100 NM or to aircraft to destination */
 static const float ZOOM_DESTINATION_MAX_AHEAD = 100.f;
 
@@ -165,6 +175,30 @@ struct ElevationLegList
   int totalNumPoints = 0; /* Number of elevation points in whole flight plan */
 };
 
+/* Elevation samples for route legs keyed by leg geometry and sample radius.
+ * Used by the thread and cleared by the GUI thread on elevation updates. */
+struct ElevationLegCache
+{
+  ElevationLegCache(int maxCost)
+    : cache(maxCost)
+  {
+  }
+
+  /* Key is longitude/latitude of all geometry points appended by sample radius and provider */
+  static QVector<float> key(const atools::geo::LineString& geometry, float sampleRadiusNm, bool globe)
+  {
+    QVector<float> retval;
+    retval.reserve(geometry.size() * 2 + 2);
+    for(const Pos& pos : geometry)
+      retval << pos.getLonX() << pos.getLatY();
+    retval << sampleRadiusNm << (globe ? 1.f : 0.f);
+    return retval;
+  }
+
+  QMutex mutex;
+  QCache<QVector<float>, atools::geo::LineString> cache; /* Elevation in meter as returned by provider */
+};
+
 // =======================================================================================
 
 ProfileWidget::ProfileWidget(QWidget *parent)
@@ -178,6 +212,9 @@ ProfileWidget::ProfileWidget(QWidget *parent)
 
   profileOptions = new ProfileOptions(this);
   legList = new ElevationLegList;
+  elevationLegCache = new ElevationLegCache(atools::settings::Settings::instance().
+                                            getAndStoreValue(lnm::OPTIONS_PROFILE_ELEVATION_CACHE, 500000).toInt());
+  gridSafeAltitude = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_PROFILE_GRID_SAFE_ALTITUDE, true).toBool();
 
   scrollArea = new ProfileScrollArea(this, ui->scrollAreaProfile);
   scrollArea->setProfileLeftOffset(left);
@@ -223,6 +260,7 @@ ProfileWidget::~ProfileWidget()
 
   ATOOLS_DELETE_LOG(scrollArea);
   ATOOLS_DELETE_LOG(legList);
+  ATOOLS_DELETE_LOG(elevationLegCache);
   ATOOLS_DELETE_LOG(profileOptions);
 }
 
@@ -243,6 +281,8 @@ float ProfileWidget::aircraftAlt(const atools::fs::sc::SimConnectUserAircraft& a
 
 void ProfileWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorData)
 {
+  LNM_STALL_SCOPE;
+
   if(databaseLoadStatus || !simulatorData.getUserAircraftConst().isValid())
     return;
 
@@ -291,8 +331,9 @@ void ProfileWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulat
           if(std::abs(delta.dx()) > 0.1 /* NM */ || std::abs(delta.dy()) > 50. /* ft */)
             aircraftTrailPoints.append(currentPoint);
 
+          // Remove a batch of points to avoid moving all points on each update
           if(aircraftTrailPoints.size() > OptionData::instance().getAircraftTrailMaxPoints())
-            aircraftTrailPoints.removeFirst();
+            aircraftTrailPoints.remove(0, std::min(PRUNE_TRAIL_POINTS, aircraftTrailPoints.size() - 1));
         }
       }
 
@@ -400,6 +441,7 @@ float ProfileWidget::getGroundBufferForLegFt(int legIndex)
 
 void ProfileWidget::showIlsChanged()
 {
+  staticLayerRevision++;
   NavApp::getRoute().updateApproachIls();
   legList->route.updateApproachIls();
   update();
@@ -423,6 +465,9 @@ void ProfileWidget::updateScreenCoords()
 {
   /* Update all screen coordinates and scale factors */
 
+  // Route, elevation or scale changed - cached static layer has to be painted again
+  staticLayerRevision++;
+
   calcLeftMargin();
 
   // Widget drawing region width and height
@@ -456,45 +501,35 @@ void ProfileWidget::updateScreenCoords()
 
   if(!legList->elevationLegs.isEmpty())
   {
-    // First point
-    landPolygon.append(QPoint(left, h + TOP));
+    // Reduce terrain to one column per pixel if zoom or elevation data changed
+    if(terrainEnvelope.isEmpty() || atools::almostNotEqual(terrainEnvelopeScale, horizontalScale) || terrainEnvelopeLeft != left)
+      updateTerrainEnvelope();
 
 #ifdef DEBUG_INFORMATION_PROFILE
     qDebug() << Q_FUNC_INFO << "==========================================================================";
 #endif
 
-#ifdef DEBUG_INFORMATION_PROFILE
-    int num = 0;
-#endif
     for(const ElevationLeg& leg : qAsConst(legList->elevationLegs))
     {
       if(leg.distances.isEmpty() || leg.elevation.isEmpty())
         continue;
 
 #ifdef DEBUG_INFORMATION_PROFILE
-      qDebug() << Q_FUNC_INFO << num << leg.ident << "leg.distances" << leg.distances;
-      qDebug() << Q_FUNC_INFO << num << leg.ident << "leg.geometry" << leg.geometry;
-      qDebug() << Q_FUNC_INFO << num << leg.ident << "leg.elevation" << leg.elevation;
+      qDebug() << Q_FUNC_INFO << leg.ident << "leg.distances" << leg.distances;
+      qDebug() << Q_FUNC_INFO << leg.ident << "leg.geometry" << leg.geometry;
+      qDebug() << Q_FUNC_INFO << leg.ident << "leg.elevation" << leg.elevation;
 #endif
 
       waypointX.append(left + static_cast<int>(leg.distances.constFirst() * horizontalScale));
+    }
 
-      QPoint lastPt;
-      for(int i = 0; i < leg.elevation.size(); i++)
-      {
-        float alt = leg.elevation.at(i).getAltitude();
-        QPoint pt(left + static_cast<int>(leg.distances.at(i) * horizontalScale), TOP + static_cast<int>(h - alt * verticalScale));
+    // First point
+    landPolygon.append(QPoint(left, h + TOP));
 
-        if(lastPt.isNull() || i == leg.elevation.size() - 1 || (lastPt - pt).manhattanLength() > 2)
-        {
-          landPolygon.append(pt);
-          lastPt = pt;
-        }
-      }
-#ifdef DEBUG_INFORMATION_PROFILE
-      num++;
-#endif
-    }
+    // Convert altitude to screen coordinates
+    landPolygon.reserve(terrainEnvelope.size() + 2);
+    for(const QPointF& pt : qAsConst(terrainEnvelope))
+      landPolygon.append(QPoint(static_cast<int>(pt.x()), TOP + static_cast<int>(h - pt.y() * verticalScale)));
 
     // Destination point
     if(!waypointX.isEmpty())
@@ -502,6 +537,7 @@ void ProfileWidget::updateScreenCoords()
 
 #ifdef DEBUG_INFORMATION_PROFILE
     qDebug() << Q_FUNC_INFO << "waypointX" << waypointX;
+    qDebug() << Q_FUNC_INFO << "terrainEnvelope" << terrainEnvelope.size() << "samples" << legList->totalNumPoints;
     qDebug() << Q_FUNC_INFO << "==========================================================================";
 #endif
 
@@ -511,6 +547,66 @@ void ProfileWidget::updateScreenCoords()
   }
 }
 
+void ProfileWidget::updateTerrainEnvelope()
+{
+  terrainEnvelope.clear();
+  terrainEnvelopeScale = horizontalScale;
+  terrainEnvelopeLeft = left;
+
+  // Minimum and maximum elevation in the current pixel column and order of occurrence - column is -1 before first sample
+  int column = -1;
+  float minAlt = 0.f, maxAlt = 0.f;
+  bool minFirst = true;
+
+  // Add one or two points for the column - keep order to avoid crossing lines
+  auto flushColumn = [&column, &minAlt, &maxAlt, &minFirst, this]() -> void {
+    if(column == -1)
+      return;
+
+    if(atools::almostEqual(minAlt, maxAlt))
+      terrainEnvelope.append(QPointF(column, maxAlt));
+    else if(minFirst)
+      terrainEnvelope << QPointF(column, minAlt) << QPointF(column, maxAlt);
+    else
+      terrainEnvelope << QPointF(column, maxAlt) << QPointF(column, minAlt);
+  };
+
+  for(const ElevationLeg& leg : qAsConst(legList->elevationLegs))
+  {
+    if(leg.distances.isEmpty() || leg.elevation.isEmpty())
+      continue;
+
+    for(int i = 0; i < leg.elevation.size(); i++)
+    {
+      float alt = leg.elevation.at(i).getAltitude();
+      int x = left + static_cast<int>(leg.distances.value(i) * horizontalScale);
+
+      if(x != column)
+      {
+        // Next pixel column
+        flushColumn();
+        column = x;
+        minAlt = maxAlt = alt;
+        minFirst = true;
+      }
+      else
+      {
+        if(alt < minAlt)
+        {
+          minAlt = alt;
+          minFirst = false;
+        }
+        if(alt > maxAlt)
+        {
+          maxAlt = alt;
+          minFirst = true;
+        }
+      }
+    }
+  }
+  flushColumn();
+}
+
 const QVector<std::pair<int, int> > ProfileWidget::calcScaleValues()
 {
   int h = rect().height() - TOP;
@@ -869,9 +965,6 @@ void ProfileWidget::calcLeftMargin()
 
 void ProfileWidget::paintEvent(QPaintEvent *)
 {
-  // Show only ident in labels
-  static const textflags::TextFlags TEXTFLAGS = textflags::IDENT | textflags::ROUTE_TEXT | textflags::ABS_POS;
-
   if(!active)
     return;
 
@@ -881,8 +974,8 @@ void ProfileWidget::paintEvent(QPaintEvent *)
   const RouteAltitude& altitudeLegs = route.getAltitudeLegs();
   const OptionData& optionData = OptionData::instance();
 
-  // Keep margin to left, right and top
-  int w = rect().width() - left * 2, h = rect().height() - TOP;
+  // Keep margin to left and right
+  int w = rect().width() - left * 2;
 
   SymbolPainter symPainter;
   QPainter painter(this);
@@ -935,6 +1028,205 @@ void ProfileWidget::paintEvent(QPaintEvent *)
   optsp::DisplayOptionsProfile displayOptions = profileOptions->getDisplayOptions();
   map::MapDisplayTypes mapFeaturesDisplay = NavApp::getMapWidgetGui()->getShownMapDisplayTypes();
 
+  // Get active route leg and display options which are used as key for the static layer
+  const Route& curRoute = NavApp::getRouteConst();
+  StaticLayerKey key;
+  key.revision = staticLayerRevision;
+  key.size = size();
+  key.devicePixelRatio = devicePixelRatioF();
+  key.activeValid = curRoute.isActiveValid();
+  key.activeAlternate = curRoute.isActiveAlternate();
+  key.activeLegIndex = curRoute.getActiveLegIndex();
+  key.flightplanY = flightplanY;
+  key.safeAltY = safeAltY;
+  key.displayOptions = displayOptions;
+  key.mapFeaturesDisplay = mapFeaturesDisplay;
+  key.shownMapTypes = NavApp::getShownMapTypes();
+
+  QSize pixmapSize = size() * devicePixelRatioF();
+  if(pixmapSize.width() * static_cast<qint64>(pixmapSize.height()) <= STATIC_LAYER_MAX_PIXELS)
+  {
+    // Draw terrain, flight plan and labels into the cached pixmap if anything changed ===============================
+    if(staticLayerPixmap.isNull() || !(key == staticLayerKey))
+    {
+      staticLayerPixmap = QPixmap(pixmapSize);
+      staticLayerPixmap.setDevicePixelRatio(devicePixelRatioF());
+      staticLayerPixmap.fill(Qt::transparent);
+
+      QPainter pixmapPainter(&staticLayerPixmap);
+      pixmapPainter.setFont(painter.font());
+      paintStaticLayer(pixmapPainter, flightplanY, safeAltY, displayOptions, mapFeaturesDisplay);
+
+      // Remember painter state for aircraft and trail
+      staticLayerFont = pixmapPainter.font();
+      staticLayerBackgroundMode = pixmapPainter.backgroundMode();
+      staticLayerBackground = pixmapPainter.background();
+      staticLayerBrush = pixmapPainter.brush();
+      pixmapPainter.end();
+
+      staticLayerKey = key;
+    }
+
+    painter.drawPixmap(0, 0, staticLayerPixmap);
+
+    // Restore painter state as left by painting the static layer
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.setFont(staticLayerFont);
+    painter.setBackgroundMode(staticLayerBackgroundMode);
+    painter.setBackground(staticLayerBackground);
+    painter.setBrush(staticLayerBrush);
+  }
+  else
+  {
+    // Too large for caching at high zoom factors - paint directly
+    staticLayerPixmap = QPixmap();
+    paintStaticLayer(painter, flightplanY, safeAltY, displayOptions, mapFeaturesDisplay);
+  }
+
+  // Draw user aircraft trail =========================================================
+  if(!aircraftTrailPoints.isEmpty() && showAircraftTrail)
+  {
+    if(OptionData::instance().getFlags().testFlag(opts::MAP_TRAIL_GRADIENT))
+    {
+      // Gradient line - draw outline first ======================================================================
+      painter.setPen(mapcolors::aircraftTrailPenOuter(optionData.getDisplayThicknessTrail() / 100.f * 1.4f));
+      painter.drawPolyline(toScreen(aircraftTrailPoints));
+
+      // Draw gradient inner line segments ======================================================================
+      for(int i = 0; i < aircraftTrailPoints.size() - 1; i++)
+      {
+        const QPointF& pt1 = aircraftTrailPoints.value(i);
+        const QPointF& pt2 = aircraftTrailPoints.value(i + 1);
+        float altAverageFt = static_cast<float>((pt1.y() + pt2.y()) / 2.);
+
+        float maxAltitudeFt = NavApp::getAircraftTrail().getMaxAltitude();
+        // Use flight plan cruise as max altitude if valid
+        if(route.getSizeWithoutAlternates() > 2)
+          maxAltitudeFt = std::max(route.getCruiseAltitudeFt(), maxAltitudeFt);
+
+        painter.setPen(mapcolors::aircraftTrailPen(optionData.getDisplayThicknessTrail() / 100.f * 1.4f,
+                                                   NavApp::getAircraftTrail().getMinAltitude(), maxAltitudeFt, altAverageFt));
+        painter.drawLine(toScreen(pt1), toScreen(pt2));
+      }
+    }
+    else
+    {
+      // Normal line ===================================================
+      painter.setPen(mapcolors::aircraftTrailPen(optionData.getDisplayThicknessTrail() / 100.f * 2.f));
+      painter.drawPolyline(toScreen(aircraftTrailPoints));
+    }
+  }
+
+  // Draw user aircraft =========================================================
+  const atools::fs::sc::SimConnectUserAircraft& userAircraft = simData.getUserAircraftConst();
+  if(userAircraft.isValid() && showAircraft && aircraftDistanceFromStart < map::INVALID_DISTANCE_VALUE && !curRoute.isActiveMissed() &&
+     !curRoute.isActiveAlternate())
+  {
+    // Draw path line ===================
+    if(NavApp::getMainUi()->actionProfileShowVerticalTrack->isChecked())
+      paintVerticalPath(painter, route);
+
+    float acx = distanceX(aircraftDistanceFromStart);
+    float acy = altitudeY(aircraftAlt(userAircraft));
+
+    // Draw aircraft symbol =======================
+    int acsize = roundToInt(optionData.getDisplayTextSizeFlightplanProfile() / 100. * 40.);
+    painter.translate(acx, acy);
+    painter.rotate(90);
+    painter.scale(0.6, 1.);
+    painter.shear(0.0, 0.5);
+
+    // Turn aircraft if distance shrinks
+    if(movingBackwards)
+      // Reflection is a special case of scaling matrix
+      painter.scale(1., -1.);
+
+    const QPixmap *pixmap = NavApp::getVehicleIcons()->pixmapFromCache(userAircraft, acsize, 0);
+    painter.drawPixmap(QPointF(-acsize / 2., -acsize / 2.), *pixmap);
+    painter.resetTransform();
+
+    // Draw aircraft label
+    mapcolors::scaleFont(&painter, optionData.getDisplayTextSizeFlightplanProfile() / 100.f, &painter.font());
+
+    // Draw optional aircraft labels =======================
+    QStringList texts;
+
+    // Actual altitude
+    if(displayOptions.testFlag(optsp::PROFILE_AIRCRAFT_ALTITUDE))
+      texts.append(Unit::altFeet(aircraftAlt(userAircraft)));
+
+    // Actual vertical speed
+    if(displayOptions.testFlag(optsp::PROFILE_AIRCRAFT_VERT_SPEED))
+    {
+      int vspeed = roundToInt(userAircraft.getVerticalSpeedFeetPerMin());
+      if(vspeed > 10.f || vspeed < -10.f)
+      {
+        QString upDown;
+        if(vspeed > 100.f)
+          upDown = tr(" ▲");
+        else if(vspeed < -100.f)
+          upDown = tr(" ▼");
+        texts.append(Unit::speedVertFpm(vspeed) % upDown);
+      }
+    }
+
+    // Needed vertical speed to catch next calculated altitude
+    if(displayOptions.testFlag(optsp::PROFILE_AIRCRAFT_VERT_ANGLE_NEXT))
+    {
+      const Route& origRoute = NavApp::getRouteConst();
+      // The corrected leg will point to an approach leg if we head to the start of a procedure
+      int activeLegIdx = origRoute.getActiveLegIndexCorrected();
+      float nextLegDistance = 0.f;
+
+      if(activeLegIdx != map::INVALID_INDEX_VALUE && origRoute.getRouteDistances(nullptr, nullptr, &nextLegDistance, nullptr))
+      {
+        float vertAngleToNext = origRoute.getVerticalAngleToNext(nextLegDistance);
+        if(vertAngleToNext < map::INVALID_ANGLE_VALUE)
+          texts.append(Unit::speedVertFpm(-atools::geo::descentSpeedForPathAngle(userAircraft.getGroundSpeedKts(),
+                                                                                 vertAngleToNext)) % tr(" ▼ N"));
+      }
+    }
+
+    textatt::TextAttributes att = textatt::NONE;
+    float textx = acx, texty = acy + 20.f;
+
+    QRectF rect = symPainter.textBoxSize(&painter, texts, att);
+    if(textx + rect.right() > left + w)
+      // Move text to the left when approaching the right corner
+      att |= textatt::LEFT;
+
+    att |= textatt::ROUTE_BG_COLOR;
+
+    if(acy - rect.height() > scrollArea->getOffset().y() + TOP)
+      texty -= static_cast<float>(rect.bottom() + 20.); // Text at top
+
+    symPainter.textBoxF(&painter, texts, QPen(Qt::black), textx, texty, att, 255);
+  }
+
+  // Dim the map by drawing a semi-transparent black rectangle
+  mapcolors::darkenPainterRect(painter);
+
+  scrollArea->updateLabelWidgets();
+}
+
+void ProfileWidget::paintStaticLayer(QPainter& painter, int flightplanY, int safeAltY,
+                                     optsp::DisplayOptionsProfile displayOptions, map::MapDisplayTypes mapFeaturesDisplay)
+{
+  // Show only ident in labels
+  static const textflags::TextFlags TEXTFLAGS = textflags::IDENT | textflags::ROUTE_TEXT | textflags::ABS_POS;
+
+  // Saved route that was used to create the geometry
+  const Route& route = legList->route;
+
+  const RouteAltitude& altitudeLegs = route.getAltitudeLegs();
+  const OptionData& optionData = OptionData::instance();
+
+  // Keep margin to left, right and top
+  int w = rect().width() - left * 2, h = rect().height() - TOP;
+
+  SymbolPainter symPainter;
+
   // Fill background sky blue ====================================================
   painter.setRenderHint(QPainter::Antialiasing);
   painter.setRenderHint(QPainter::SmoothPixmapTransform);
@@ -1622,131 +1914,6 @@ void ProfileWidget::paintEvent(QPaintEvent *)
     QString destAltStr = Unit::altFeet(destAlt);
     symPainter.textBox(&painter, {destAltStr}, labelColor, left + w + 4, destinationAltTextY, textatt::BOLD | textatt::RIGHT, 255);
   } // if(NavApp::getMapWidget()->getShownMapFeatures() & map::FLIGHTPLAN)
-
-  // Draw user aircraft trail =========================================================
-  if(!aircraftTrailPoints.isEmpty() && showAircraftTrail)
-  {
-    if(OptionData::instance().getFlags().testFlag(opts::MAP_TRAIL_GRADIENT))
-    {
-      // Gradient line - draw outline first ======================================================================
-      painter.setPen(mapcolors::aircraftTrailPenOuter(optionData.getDisplayThicknessTrail() / 100.f * 1.4f));
-      painter.drawPolyline(toScreen(aircraftTrailPoints));
-
-      // Draw gradient inner line segments ======================================================================
-      for(int i = 0; i < aircraftTrailPoints.size() - 1; i++)
-      {
-        const QPointF& pt1 = aircraftTrailPoints.value(i);
-        const QPointF& pt2 = aircraftTrailPoints.value(i + 1);
-        float altAverageFt = static_cast<float>((pt1.y() + pt2.y()) / 2.);
-
-        float maxAltitudeFt = NavApp::getAircraftTrail().getMaxAltitude();
-        // Use flight plan cruise as max altitude if valid
-        if(route.getSizeWithoutAlternates() > 2)
-          maxAltitudeFt = std::max(route.getCruiseAltitudeFt(), maxAltitudeFt);
-
-        painter.setPen(mapcolors::aircraftTrailPen(optionData.getDisplayThicknessTrail() / 100.f * 1.4f,
-                                                   NavApp::getAircraftTrail().getMinAltitude(), maxAltitudeFt, altAverageFt));
-        painter.drawLine(toScreen(pt1), toScreen(pt2));
-      }
-    }
-    else
-    {
-      // Normal line ===================================================
-      painter.setPen(mapcolors::aircraftTrailPen(optionData.getDisplayThicknessTrail() / 100.f * 2.f));
-      painter.drawPolyline(toScreen(aircraftTrailPoints));
-    }
-  }
-
-  // Draw user aircraft =========================================================
-  const atools::fs::sc::SimConnectUserAircraft& userAircraft = simData.getUserAircraftConst();
-  if(userAircraft.isValid() && showAircraft && aircraftDistanceFromStart < map::INVALID_DISTANCE_VALUE && !curRoute.isActiveMissed() &&
-     !curRoute.isActiveAlternate())
-  {
-    // Draw path line ===================
-    if(NavApp::getMainUi()->actionProfileShowVerticalTrack->isChecked())
-      paintVerticalPath(painter, route);
-
-    float acx = distanceX(aircraftDistanceFromStart);
-    float acy = altitudeY(aircraftAlt(userAircraft));
-
-    // Draw aircraft symbol =======================
-    int acsize = roundToInt(optionData.getDisplayTextSizeFlightplanProfile() / 100. * 40.);
-    painter.translate(acx, acy);
-    painter.rotate(90);
-    painter.scale(0.6, 1.);
-    painter.shear(0.0, 0.5);
-
-    // Turn aircraft if distance shrinks
-    if(movingBackwards)
-      // Reflection is a special case of scaling matrix
-      painter.scale(1., -1.);
-
-    const QPixmap *pixmap = NavApp::getVehicleIcons()->pixmapFromCache(userAircraft, acsize, 0);
-    painter.drawPixmap(QPointF(-acsize / 2., -acsize / 2.), *pixmap);
-    painter.resetTransform();
-
-    // Draw aircraft label
-    mapcolors::scaleFont(&painter, optionData.getDisplayTextSizeFlightplanProfile() / 100.f, &painter.font());
-
-    // Draw optional aircraft labels =======================
-    QStringList texts;
-
-    // Actual altitude
-    if(displayOptions.testFlag(optsp::PROFILE_AIRCRAFT_ALTITUDE))
-      texts.append(Unit::altFeet(aircraftAlt(userAircraft)));
-
-    // Actual vertical speed
-    if(displayOptions.testFlag(optsp::PROFILE_AIRCRAFT_VERT_SPEED))
-    {
-      int vspeed = roundToInt(userAircraft.getVerticalSpeedFeetPerMin());
-      if(vspeed > 10.f || vspeed < -10.f)
-      {
-        QString upDown;
-        if(vspeed > 100.f)
-          upDown = tr(" ▲");
-        else if(vspeed < -100.f)
-          upDown = tr(" ▼");
-        texts.append(Unit::speedVertFpm(vspeed) % upDown);
-      }
-    }
-
-    // Needed vertical speed to catch next calculated altitude
-    if(displayOptions.testFlag(optsp::PROFILE_AIRCRAFT_VERT_ANGLE_NEXT))
-    {
-      const Route& origRoute = NavApp::getRouteConst();
-      // The corrected leg will point to an approach leg if we head to the start of a procedure
-      int activeLegIdx = origRoute.getActiveLegIndexCorrected();
-      float nextLegDistance = 0.f;
-
-      if(activeLegIdx != map::INVALID_INDEX_VALUE && origRoute.getRouteDistances(nullptr, nullptr, &nextLegDistance, nullptr))
-      {
-        float vertAngleToNext = origRoute.getVerticalAngleToNext(nextLegDistance);
-        if(vertAngleToNext < map::INVALID_ANGLE_VALUE)
-          texts.append(Unit::speedVertFpm(-atools::geo::descentSpeedForPathAngle(userAircraft.getGroundSpeedKts(),
-                                                                                 vertAngleToNext)) % tr(" ▼ N"));
-      }
-    }
-
-    textatt::TextAttributes att = textatt::NONE;
-    float textx = acx, texty = acy + 20.f;
-
-    QRectF rect = symPainter.textBoxSize(&painter, texts, att);
-    if(textx + rect.right() > left + w)
-      // Move text to the left when approaching the right corner
-      att |= textatt::LEFT;
-
-    att |= textatt::ROUTE_BG_COLOR;
-
-    if(acy - rect.height() > scrollArea->getOffset().y() + TOP)
-      texty -= static_cast<float>(rect.bottom() + 20.); // Text at top
-
-    symPainter.textBoxF(&painter, texts, QPen(Qt::black), textx, texty, att, 255);
-  }
-
-  // Dim the map by drawing a semi-transparent black rectangle
-  mapcolors::darkenPainterRect(painter);
-
-  scrollArea->updateLabelWidgets();
 }
 
 int ProfileWidget::calcLegScreenWidth(const QVector<QPolygon>& altLegs, int waypointIndex)
@@ -1844,6 +2011,12 @@ void ProfileWidget::elevationUpdateAvailable()
 
   // Do not terminate thread here since this can lead to starving updates
 
+  // Samples might be more accurate now
+  {
+    QMutexLocker locker(&elevationLegCache->mutex);
+    elevationLegCache->cache.clear();
+  }
+
   // Start thread after long delay to calculate new data
   // Calls ProfileWidget::updateTimeout()
   updateTimer->start(NavApp::isGlobeOfflineProvider() ?
@@ -1877,6 +2050,8 @@ void ProfileWidget::windUpdated()
 
 void ProfileWidget::routeChanged(bool geometryChanged, bool newFlightPlan)
 {
+  LNM_STALL_SCOPE;
+
   if(databaseLoadStatus)
     return;
 
@@ -1932,6 +2107,7 @@ void ProfileWidget::updateThreadFinished()
   {
     // Was not terminated in the middle of calculations - get result from the future
     *legList = future.result();
+    terrainEnvelope.clear();
     updateScreenCoords();
     updateErrorLabel();
     updateHeaderLabel();
@@ -2004,7 +2180,34 @@ bool ProfileWidget::fetchRouteElevations(atools::geo::LineString& elevations, co
   return true;
 }
 
-/* Background thread. Fetches elevation points from Marble elevation model and updates totals. */
+bool ProfileWidget::fetchLegElevations(atools::geo::LineString& elevations, const atools::geo::LineString& geometry) const
+{
+  // Look for samples of an unchanged leg first
+  QVector<float> cacheKey = ElevationLegCache::key(geometry, ELEVATION_SAMPLE_RADIUS_NM, NavApp::isGlobeOfflineProvider());
+  {
+    QMutexLocker locker(&elevationLegCache->mutex);
+    const LineString *cachedElevations = elevationLegCache->cache.object(cacheKey);
+    if(cachedElevations != nullptr)
+    {
+      elevations = *cachedElevations;
+      return true;
+    }
+  }
+
+  if(!fetchRouteElevations(elevations, geometry))
+    return false;
+
+  // Do not cache dummy values if provider is not ready
+  if(NavApp::getElevationProvider()->isValid() && !elevations.isEmpty())
+  {
+    QMutexLocker locker(&elevationLegCache->mutex);
+    elevationLegCache->cache.insert(cacheKey, new LineString(elevations), elevations.size());
+  }
+  return true;
+}
+
+/* Background thread. Fetches elevation points from Marble elevation model and updates totals.
+ * Legs are sampled by a small thread pool and processed in order afterwards. */
 ElevationLegList ProfileWidget::fetchRouteElevationsThread(ElevationLegList legs) const
 {
   QThread::currentThread()->setPriority(QThread::LowestPriority);
@@ -2030,16 +2233,73 @@ ElevationLegList ProfileWidget::fetchRouteElevationsThread(ElevationLegList legs
   // Total calculated distance across all legs
   double totalDistanceNm = 0.;
 
+  // Collect geometry for all legs to sample ========================================================
   // Loop over all route legs - first is departure airport point
+  int numLegs = 0;
+  QVector<LineString> legGeometries, legElevations;
+  QVector<bool> legSample;
   for(int i = 1; i <= legs.route.getDestinationLegIndex(); i++)
+  {
+    const RouteAltitudeLeg& altLeg = legs.route.getAltitudeLegAt(i);
+    if(altLeg.isMissed() || altLeg.isAlternate())
+      break;
+
+    LineString geometry = altLeg.getGeoLineString();
+    geometry.removeInvalid();
+    if(geometry.size() == 1)
+      geometry.append(geometry.constFirst());
+
+    legGeometries.append(geometry);
+
+    // Skip for too long segments when using the marble online provider
+    legSample.append(altLeg.getDistanceTo() < ELEVATION_MAX_LEG_NM || NavApp::isGlobeOfflineProvider());
+    numLegs++;
+  }
+  legElevations.resize(numLegs);
+
+  // Sample legs in parallel ========================================================
+  // Each thread takes every n-th leg to spread long and short legs evenly
+  int numThreads = std::max(1, std::min(QThread::idealThreadCount(), std::min(ELEVATION_MAX_THREADS, numLegs)));
+  QThreadPool threadPool;
+  threadPool.setMaxThreadCount(numThreads);
+
+  QVector<QFuture<bool> > futures;
+  for(int t = 0; t < numThreads; t++)
+  {
+    futures.append(QtConcurrent::run(&threadPool, [t, numLegs, numThreads, &legGeometries, &legElevations, &legSample, this]() -> bool {
+        QThread::currentThread()->setPriority(QThread::LowestPriority);
+        for(int k = t; k < numLegs; k += numThreads)
+        {
+          if(terminateThreadSignal)
+            return false;
+
+          if(legSample.at(k) && !fetchLegElevations(legElevations[k], legGeometries.at(k)))
+            return false;
+        }
+        return true;
+      }));
+  }
+
+  // Wait for all threads - results are stored by leg index and keep the order
+  bool success = true;
+  for(QFuture<bool>& f : futures)
+  {
+    f.waitForFinished();
+    success &= f.result();
+  }
+
+  if(!success || terminateThreadSignal)
+    // Return empty result
+    return ElevationLegList();
+
+  // Calculate distances and maximum elevation for each leg ========================================================
+  for(int i = 1; i <= numLegs; i++)
   {
     if(terminateThreadSignal)
       // Return empty result
       return ElevationLegList();
 
     const RouteAltitudeLeg& altLeg = legs.route.getAltitudeLegAt(i);
-    if(altLeg.isMissed() || altLeg.isAlternate())
-      break;
 
     ElevationLeg leg;
     leg.ident = altLeg.getIdent();
@@ -2047,20 +2307,12 @@ ElevationLegList ProfileWidget::fetchRouteElevationsThread(ElevationLegList legs
     // Used to adapt distances of all legs to total distance due to inaccuracies
     double scale = 1.;
 
-    // Skip for too long segments when using the marble online provider
-    if(altLeg.getDistanceTo() < ELEVATION_MAX_LEG_NM || NavApp::isGlobeOfflineProvider())
+    if(legSample.at(i - 1))
     {
-      LineString geometry = altLeg.getGeoLineString();
-
-      geometry.removeInvalid();
-      if(geometry.size() == 1)
-        geometry.append(geometry.constFirst());
+      const LineString& geometry = legGeometries.at(i - 1);
 
       // Includes first and last point
-      LineString elevations;
-      if(!fetchRouteElevations(elevations, geometry))
-        return ElevationLegList();
-
+      LineString& elevations = legElevations[i - 1];
       if(elevations.isEmpty())
         return ElevationLegList();
 
@@ -2103,6 +2355,14 @@ ElevationLegList ProfileWidget::fetchRouteElevationsThread(ElevationLegList legs
         lastPos = coord;
       }
 
+      if(gridSafeAltitude && NavApp::isGlobeOfflineProvider())
+      {
+        // Samples can miss peaks between points - add all terrain of the grid cells touched by the leg
+        float gridMaxFt = meterToFeet(NavApp::getElevationProvider()->getMaxElevationMeter(geometry));
+        leg.maxElevation = std::max(leg.maxElevation, gridMaxFt);
+        legs.maxElevationFt = std::max(legs.maxElevationFt, gridMaxFt);
+      }
+
       // float distanceTo = atools::geo::meterToNm(geometry.lengthMeter());
       float distanceTo = altLeg.getDistanceTo();
       totalDistanceNm += distanceTo;
@@ -2721,11 +2981,13 @@ void ProfileWidget::optionsChanged()
 
 void ProfileWidget::styleChanged()
 {
+  staticLayerRevision++;
   scrollArea->styleChanged();
 }
 
 void ProfileWidget::fontChanged(const QFont& font)
 {
+  staticLayerRevision++;
   scrollArea->fontChanged(font);
 }
 
@@ -19,8 +19,11 @@
 #define LITTLENAVMAP_PROFILEWIDGET_H
 
 #include "fs/sc/simconnectdata.h"
+#include "common/mapflags.h"
+#include "profile/profileoptions.h"
 
 #include <QFutureWatcher>
+#include <QPixmap>
 #include <QWidget>
 
 namespace atools {
@@ -48,6 +51,7 @@ class Route;
 class RouteLeg;
 class ProfileOptions;
 struct ElevationLegList;
+struct ElevationLegCache;
 
 /*
  * Loads and displays the flight plan elevation profile. The elevation data is
@@ -209,6 +213,9 @@ private:
   virtual void contextMenuEvent(QContextMenuEvent *event) override;
 
   bool fetchRouteElevations(atools::geo::LineString& elevations, const atools::geo::LineString& geometry) const;
+
+  /* Get elevations for leg from cache or fetch them. Called by several threads. */
+  bool fetchLegElevations(atools::geo::LineString& elevations, const atools::geo::LineString& geometry) const;
   ElevationLegList fetchRouteElevationsThread(ElevationLegList legs) const;
   void elevationUpdateAvailable();
   void updateTimeout();
@@ -255,6 +262,14 @@ private:
   /* Draw a vertical track/path line extending from user aircraft */
   void paintVerticalPath(QPainter& painter, const Route& route);
 
+  /* Reduce elevation samples of all legs to one minimum and maximum per pixel column */
+  void updateTerrainEnvelope();
+
+  /* Paint sky, ground, scales, safe altitudes, flight plan, symbols and labels.
+   * Painted into a cached pixmap which is reused for aircraft and trail updates. */
+  void paintStaticLayer(QPainter& painter, int flightplanY, int safeAltY, optsp::DisplayOptionsProfile displayOptions,
+                        map::MapDisplayTypes mapFeaturesDisplay);
+
   void jumpBackToAircraftStart();
   void jumpBackToAircraftTimeout();
 
@@ -295,6 +310,12 @@ private:
   bool movingBackwards = false;
   ElevationLegList *legList;
 
+  /* Elevation samples by leg geometry to avoid fetching unchanged legs again */
+  ElevationLegCache *elevationLegCache;
+
+  /* Use the minimum grid of the elevation provider for leg safe altitudes if GLOBE data is used */
+  bool gridSafeAltitude = true;
+
   JumpBack *jumpBack = nullptr;
   bool contextMenuActive = false;
 
@@ -322,6 +343,12 @@ private:
   QVector<int> waypointX; /* Flight plan waypoint screen coordinates - does contain the dummy
                            * from airport to runway but not missed legs */
   QPolygon landPolygon; /* Green landmass polygon */
+
+  /* Terrain reduced to minimum and maximum elevation per pixel column. x is screen coordinate and y is elevation in feet.
+   * Calculated once per zoom level and elevation update. */
+  QPolygonF terrainEnvelope;
+  float terrainEnvelopeScale = 0.f;
+  int terrainEnvelopeLeft = 0;
   float minSafeAltitudeFt = 0.f, /* Red line */
         maxWindowAlt = 1.f; /* Maximum altitude at top of widget */
 
@@ -335,6 +362,41 @@ private:
   /* Left margin inside widget - calculated depending on font and text size in paint */
   int left = 30;
 
+  /* All values the static layer depends on. Revision is incremented on route, elevation, scale, font and style changes. */
+  struct StaticLayerKey
+  {
+    bool operator==(const StaticLayerKey& other) const
+    {
+      return revision == other.revision && size == other.size && qFuzzyCompare(devicePixelRatio, other.devicePixelRatio) &&
+             activeValid == other.activeValid && activeAlternate == other.activeAlternate &&
+             activeLegIndex == other.activeLegIndex && flightplanY == other.flightplanY && safeAltY == other.safeAltY &&
+             displayOptions == other.displayOptions && mapFeaturesDisplay == other.mapFeaturesDisplay &&
+             shownMapTypes == other.shownMapTypes;
+    }
+
+    quint64 revision = 0;
+    QSize size;
+    qreal devicePixelRatio = 1.;
+    bool activeValid = false, activeAlternate = false;
+    int activeLegIndex = -1, flightplanY = 0, safeAltY = 0;
+    optsp::DisplayOptionsProfile displayOptions;
+    map::MapDisplayTypes mapFeaturesDisplay;
+    map::MapTypes shownMapTypes;
+  };
+
+  /* Terrain, flight plan and labels. Only aircraft and trail are drawn on top for simulator updates. */
+  QPixmap staticLayerPixmap;
+  StaticLayerKey staticLayerKey;
+  quint64 staticLayerRevision = 1;
+
+  /* Painter state after drawing the static layer */
+  QFont staticLayerFont;
+  Qt::BGMode staticLayerBackgroundMode = Qt::TransparentMode;
+  QBrush staticLayerBackground, staticLayerBrush;
+
+  /* Do not cache static layer above this size in device pixels. Widget can get very large when zoomed in. */
+  static Q_DECL_CONSTEXPR qint64 STATIC_LAYER_MAX_PIXELS = 4096LL * 4096LL;
+
   /* Numbers for aircraft track */
   static Q_DECL_CONSTEXPR quint32 FILE_MAGIC_NUMBER = 0x6B7C2A3C;
   static Q_DECL_CONSTEXPR quint16 FILE_VERSION = 1;
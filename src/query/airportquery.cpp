@@ -19,11 +19,13 @@
 
 #include "common/constants.h"
 #include "common/maptypesfactory.h"
+#include "db/statementcache.h"
 #include "query/querytypes.h"
 #include "common/mapresult.h"
 #include "fs/common/binarygeometry.h"
 #include "sql/sqldatabase.h"
 #include "common/maptools.h"
+#include "common/memoryregistry.h"
 #include "settings/settings.h"
 #include "app/navapp.h"
 #include "sql/sqlutil.h"
@@ -82,25 +84,85 @@ AirportQuery::AirportQuery(atools::sql::SqlDatabase *sqlDb, bool nav)
   : navdata(nav), db(sqlDb)
 {
   mapTypesFactory = new MapTypesFactory();
+  statements = new StatementCache(db);
   atools::settings::Settings& settings = atools::settings::Settings::instance();
 
-  runwayCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "RunwayCache", 2000).toInt());
-  apronCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "ApronCache", 1000).toInt());
-  taxipathCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "TaxipathCache", 1000).toInt());
-  parkingCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "ParkingCache", 1000).toInt());
-  startCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "StartCache", 1000).toInt());
-  helipadCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "HelipadCache", 1000).toInt());
+  facilityCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "FacilityCacheKb", 65536).toInt());
   airportIdCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "AirportIdCache", 1000).toInt());
   airportFuzzyIdCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "AirportFuzzyIdCache", 1000).toInt());
   airportIdentCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "AirportIdentCache", 1000).toInt());
+
+  // Facilities use the estimated size as cost
+  MemoryRegistry::registerCaches(this, [this](QVector<memreg::Usage>& usage) -> void {
+    const QString group(navdata ? "Airports navdata" : "Airports simulator");
+    usage.append({group, "Facilities", facilityCache.totalCost() * 1024L, facilityCache.size()});
+    usage.append(memreg::cacheUsage(group, "By ident", airportIdentCache, sizeof(map::MapAirport)));
+    usage.append(memreg::cacheUsage(group, "By id", airportIdCache, sizeof(map::MapAirport)));
+    usage.append(memreg::cacheUsage(group, "By fuzzy id", airportFuzzyIdCache, sizeof(map::MapAirport)));
+    usage.append(memreg::cacheUsage(group, "Nearest", nearestAirportCache, 2048));
+  }, [this]() -> void {
+    facilityCache.clear();
+    airportIdentCache.clear();
+    airportIdCache.clear();
+    airportFuzzyIdCache.clear();
+    nearestAirportCache.clear();
+  });
 }
 
 AirportQuery::~AirportQuery()
 {
+  MemoryRegistry::unregisterCaches(this);
   deInitQueries();
+  delete statements;
   delete mapTypesFactory;
 }
 
+struct AirportQuery::Facilities
+{
+  QList<map::MapRunway> runways;
+  QList<map::MapApron> aprons;
+  QList<map::MapTaxiPath> taxipaths;
+  QList<map::MapParking> parkings;
+  QList<map::MapStart> starts;
+  QList<map::MapHelipad> helipads;
+
+  bool hasRunways = false, hasAprons = false, hasTaxipaths = false, hasParkings = false, hasStarts = false, hasHelipads = false;
+
+  /* Estimated size in kB for cache cost */
+  int sizeKb() const
+  {
+    qint64 bytes = sizeof(Facilities) +
+                   runways.size() * static_cast<qint64>(sizeof(map::MapRunway)) +
+                   taxipaths.size() * static_cast<qint64>(sizeof(map::MapTaxiPath)) +
+                   parkings.size() * static_cast<qint64>(sizeof(map::MapParking)) +
+                   starts.size() * static_cast<qint64>(sizeof(map::MapStart)) +
+                   helipads.size() * static_cast<qint64>(sizeof(map::MapHelipad));
+
+    // Geometry is the largest part of aprons
+    for(const map::MapApron& apron : aprons)
+    {
+      const qint64 nodeSize = sizeof(decltype(apron.geometry.boundary)::value_type);
+      bytes += sizeof(map::MapApron) + apron.vertices.size() * static_cast<qint64>(sizeof(atools::geo::Pos)) +
+               apron.geometry.boundary.size() * nodeSize;
+      for(const auto& hole : apron.geometry.holes)
+        bytes += hole.size() * nodeSize;
+    }
+    return static_cast<int>(bytes / 1024L) + 1;
+  }
+};
+
+AirportQuery::Facilities *AirportQuery::takeFacilities(int airportId)
+{
+  Facilities *facilities = facilityCache.take(airportId);
+  return facilities != nullptr ? facilities : new Facilities;
+}
+
+void AirportQuery::insertFacilities(int airportId, Facilities *facilities)
+{
+  // Limit cost since QCache deletes objects exceeding the maximum immediately and pointers are returned to callers
+  facilityCache.insert(airportId, facilities, std::min(facilities->sizeKb(), facilityCache.maxCost()));
+}
+
 void AirportQuery::loadAirportProcedureCache()
 {
   // Load all airport idents having procedures from navdatabase
@@ -472,18 +534,17 @@ void AirportQuery::getAirportRegion(map::MapAirport& airport)
     return;
 
   // Use smallest manhattan distance to airport
-  SqlQuery query(db);
-  query.prepare("select w.region from waypoint w "
-                "where w.region is not null "
-                "order by (abs(:lonx - w.lonx) + abs(:laty - w.laty)) limit 1");
+  SqlQuery *query = statements->query("select w.region from waypoint w "
+                                      "where w.region is not null "
+                                      "order by (abs(:lonx - w.lonx) + abs(:laty - w.laty)) limit 1");
 
-  query.bindValue(":lonx", airport.position.getLonX());
-  query.bindValue(":laty", airport.position.getLatY());
+  query->bindValue(":lonx", airport.position.getLonX());
+  query->bindValue(":laty", airport.position.getLatY());
 
-  query.exec();
-  if(query.next())
-    airport.region = query.valueStr(0);
-  query.finish();
+  statements->exec(query);
+  if(query->next())
+    airport.region = query->valueStr(0);
+  query->finish();
 }
 
 map::MapRunwayEnd AirportQuery::getRunwayEndById(int id)
@@ -567,14 +628,16 @@ const QList<map::MapApron> *AirportQuery::getAprons(int airportId)
   if(!query::valid(Q_FUNC_INFO, apronQuery))
     return nullptr;
 
-  if(apronCache.contains(airportId))
-    return apronCache.object(airportId);
+  Facilities *cached = facilityCache.object(airportId);
+  if(cached != nullptr && cached->hasAprons)
+    return &cached->aprons;
   else
   {
     apronQuery->bindValue(":airportId", airportId);
     apronQuery->exec();
 
-    QList<map::MapApron> *aprons = new QList<map::MapApron>;
+    Facilities *facilities = takeFacilities(airportId);
+    QList<map::MapApron> *aprons = &facilities->aprons;
     while(apronQuery->next())
     {
       map::MapApron ap;
@@ -622,7 +685,8 @@ const QList<map::MapApron> *AirportQuery::getAprons(int airportId)
     if(NavApp::isAirportDatabaseXPlane(navdata))
       std::reverse(aprons->begin(), aprons->end());
 
-    apronCache.insert(airportId, aprons);
+    facilities->hasAprons = true;
+    insertFacilities(airportId, facilities);
     return aprons;
   }
 }
@@ -632,14 +696,16 @@ const QList<map::MapParking> *AirportQuery::getParkingsForAirport(int airportId)
   if(!query::valid(Q_FUNC_INFO, parkingQuery))
     return nullptr;
 
-  if(parkingCache.contains(airportId))
-    return parkingCache.object(airportId);
+  Facilities *cached = facilityCache.object(airportId);
+  if(cached != nullptr && cached->hasParkings)
+    return &cached->parkings;
   else
   {
     parkingQuery->bindValue(":airportId", airportId);
     parkingQuery->exec();
 
-    QList<map::MapParking> *ps = new QList<map::MapParking>;
+    Facilities *facilities = takeFacilities(airportId);
+    QList<map::MapParking> *ps = &facilities->parkings;
     while(parkingQuery->next())
     {
       map::MapParking p;
@@ -648,7 +714,8 @@ const QList<map::MapParking> *AirportQuery::getParkingsForAirport(int airportId)
       mapTypesFactory->fillParking(parkingQuery->record(), p);
       ps->append(p);
     }
-    parkingCache.insert(airportId, ps);
+    facilities->hasParkings = true;
+    insertFacilities(airportId, facilities);
     return ps;
   }
 }
@@ -658,21 +725,24 @@ const QList<map::MapStart> *AirportQuery::getStartPositionsForAirport(int airpor
   if(!query::valid(Q_FUNC_INFO, startQuery))
     return nullptr;
 
-  if(startCache.contains(airportId))
-    return startCache.object(airportId);
+  Facilities *cached = facilityCache.object(airportId);
+  if(cached != nullptr && cached->hasStarts)
+    return &cached->starts;
   else
   {
     startQuery->bindValue(":airportId", airportId);
     startQuery->exec();
 
-    QList<map::MapStart> *ps = new QList<map::MapStart>;
+    Facilities *facilities = takeFacilities(airportId);
+    QList<map::MapStart> *ps = &facilities->starts;
     while(startQuery->next())
     {
       map::MapStart p;
       mapTypesFactory->fillStart(startQuery->record(), p);
       ps->append(p);
     }
-    startCache.insert(airportId, ps);
+    facilities->hasStarts = true;
+    insertFacilities(airportId, facilities);
     return ps;
   }
 }
@@ -692,9 +762,8 @@ void AirportQuery::startByNameAndPos(map::MapStart& start, int airportId, const
   // Get runway number for the first part of the query fetching start positions (before union)
   int number = runwayEndName.toInt();
 
-  // No need to create a permanent query here since it is called rarely
-  SqlQuery query(db);
-  query.prepare(
+  // Called rarely - keep in statement cache instead of a permanent query
+  SqlQuery *query = statements->query(
     "select start_id, airport_id, type, heading, number, runway_name, altitude, lonx, laty from ("
     // Get start positions by number
     "select s.start_id, s.airport_id, s.type, s.heading, s.number, s.runway_name, s.altitude, s.lonx, s.laty "
@@ -705,19 +774,20 @@ void AirportQuery::startByNameAndPos(map::MapStart& start, int airportId, const
     "from start s "
     "where s.airport_id = :airportId and s.runway_name = :runwayName)");
 
-  query.bindValue(":number", number);
-  query.bindValue(":runwayName", runwayEndName);
-  query.bindValue(":airportId", airportId);
-  query.exec();
+  query->bindValue(":number", number);
+  query->bindValue(":runwayName", runwayEndName);
+  query->bindValue(":airportId", airportId);
+  statements->exec(query);
 
   // Get all start positions
   QVector<map::MapStart> starts;
-  while(query.next())
+  while(query->next())
   {
     map::MapStart s;
-    mapTypesFactory->fillStart(query.record(), s);
+    mapTypesFactory->fillStart(query->record(), s);
     starts.append(s);
   }
+  query->finish();
 
   if(!starts.isEmpty())
   {
@@ -817,21 +887,24 @@ const QList<map::MapHelipad> *AirportQuery::getHelipads(int airportId)
   if(!query::valid(Q_FUNC_INFO, helipadQuery))
     return nullptr;
 
-  if(helipadCache.contains(airportId))
-    return helipadCache.object(airportId);
+  Facilities *cached = facilityCache.object(airportId);
+  if(cached != nullptr && cached->hasHelipads)
+    return &cached->helipads;
   else
   {
     helipadQuery->bindValue(":airportId", airportId);
     helipadQuery->exec();
 
-    QList<map::MapHelipad> *hs = new QList<map::MapHelipad>;
+    Facilities *facilities = takeFacilities(airportId);
+    QList<map::MapHelipad> *hs = &facilities->helipads;
     while(helipadQuery->next())
     {
       map::MapHelipad hp;
       mapTypesFactory->fillHelipad(helipadQuery->record(), hp);
       hs->append(hp);
     }
-    helipadCache.insert(airportId, hs);
+    facilities->hasHelipads = true;
+    insertFacilities(airportId, facilities);
     return hs;
   }
 }
@@ -969,43 +1042,44 @@ void AirportQuery::bestRunwayEndAndAirport(map::MapRunwayEnd& runwayEnd, map::Ma
 void AirportQuery::getRunwaysAndAirports(map::MapResultIndex& runwayAirports, const ageo::Rect& rect, const ageo::Pos& pos, bool noRunway)
 {
   // Get runways within rectangle =====================
-  SqlQuery query(db);
-  query.prepare("select * from runway where lonx between :leftx and :rightx and laty between :bottomy and :topy");
+  SqlQuery *query = statements->query("select * from runway where lonx between :leftx and :rightx and laty between :bottomy and :topy");
 
   for(const ageo::Rect& r : rect.splitAtAntiMeridian())
   {
-    query::bindRect(r, &query);
-    query.exec();
+    query::bindRect(r, query);
+    statements->exec(query);
 
-    while(query.next())
+    while(query->next())
     {
       map::MapRunway runway;
-      mapTypesFactory->fillRunway(query.record(), runway, true /* overview */);
+      mapTypesFactory->fillRunway(query->record(), runway, true /* overview */);
       runwayAirports.add(map::MapResult::createFromMapBase(&runway));
     }
   }
+  query->finish();
 
   // Get airports without runways within rectangle too =====================
   if(noRunway)
   {
-    query.prepare("select " % airportOverviewColumns(db).join(", ") % " from airport " %
-                  "where lonx between :leftx and :rightx and laty between :bottomy and :topy and longest_runway_length = 0");
+    query = statements->query("select " % airportOverviewColumns(db).join(", ") % " from airport " %
+                              "where lonx between :leftx and :rightx and laty between :bottomy and :topy and longest_runway_length = 0");
 
     bool xp = NavApp::isAirportDatabaseXPlane(navdata /* navdata */);
     for(const ageo::Rect& r : rect.splitAtAntiMeridian())
     {
-      query::bindRect(r, &query);
-      query.exec();
+      query::bindRect(r, query);
+      statements->exec(query);
 
-      while(query.next())
+      while(query->next())
       {
         map::MapAirport airport;
-        mapTypesFactory->fillAirport(query.record(), airport, false /* complete */, navdata, xp);
+        mapTypesFactory->fillAirport(query->record(), airport, false /* complete */, navdata, xp);
         if(!navdata)
           NavApp::getAirportQueryNav()->correctAirportProcedureFlag(airport);
         runwayAirports.add(map::MapResult::createFromMapBase(&airport));
       }
     }
+    query->finish();
   }
 
   // Sort by distance to airport or runway line nearest at beginning of list
@@ -1017,14 +1091,16 @@ const QList<map::MapTaxiPath> *AirportQuery::getTaxiPaths(int airportId)
   if(!query::valid(Q_FUNC_INFO, taxiparthQuery))
     return nullptr;
 
-  if(taxipathCache.contains(airportId))
-    return taxipathCache.object(airportId);
+  Facilities *cached = facilityCache.object(airportId);
+  if(cached != nullptr && cached->hasTaxipaths)
+    return &cached->taxipaths;
   else
   {
     taxiparthQuery->bindValue(":airportId", airportId);
     taxiparthQuery->exec();
 
-    QList<map::MapTaxiPath> *tps = new QList<map::MapTaxiPath>;
+    Facilities *facilities = takeFacilities(airportId);
+    QList<map::MapTaxiPath> *tps = &facilities->taxipaths;
     while(taxiparthQuery->next())
     {
       // TODO should be moved to MapTypesFactory
@@ -1039,7 +1115,8 @@ const QList<map::MapTaxiPath> *AirportQuery::getTaxiPaths(int airportId)
 
       tps->append(tp);
     }
-    taxipathCache.insert(airportId, tps);
+    facilities->hasTaxipaths = true;
+    insertFacilities(airportId, facilities);
     return tps;
   }
 }
@@ -1049,14 +1126,16 @@ const QList<map::MapRunway> *AirportQuery::getRunways(int airportId)
   if(!query::valid(Q_FUNC_INFO, runwaysQuery))
     return nullptr;
 
-  if(runwayCache.contains(airportId))
-    return runwayCache.object(airportId);
+  Facilities *cached = facilityCache.object(airportId);
+  if(cached != nullptr && cached->hasRunways)
+    return &cached->runways;
   else
   {
     runwaysQuery->bindValue(":airportId", airportId);
     runwaysQuery->exec();
 
-    QList<map::MapRunway> *rs = new QList<map::MapRunway>;
+    Facilities *facilities = takeFacilities(airportId);
+    QList<map::MapRunway> *rs = &facilities->runways;
     while(runwaysQuery->next())
     {
       map::MapRunway runway;
@@ -1068,7 +1147,8 @@ const QList<map::MapRunway> *AirportQuery::getRunways(int airportId)
     using namespace std::placeholders;
     std::sort(rs->begin(), rs->end(), std::bind(&AirportQuery::runwayCompare, this, _1, _2));
 
-    runwayCache.insert(airportId, rs);
+    facilities->hasRunways = true;
+    insertFacilities(airportId, facilities);
     return rs;
   }
 }
@@ -1424,12 +1504,9 @@ void AirportQuery::initQueries()
 
 void AirportQuery::deInitQueries()
 {
-  runwayCache.clear();
-  apronCache.clear();
-  taxipathCache.clear();
-  parkingCache.clear();
-  startCache.clear();
-  helipadCache.clear();
+  statements->clear();
+
+  facilityCache.clear();
   airportIdentCache.clear();
   airportIdCache.clear();
   airportFuzzyIdCache.clear();
@@ -1468,9 +1545,13 @@ QHash<int, QList<map::MapParking> > AirportQuery::getParkingCache() const
 {
   QHash<int, QList<map::MapParking> > retval;
 
-  const QList<int> keys = parkingCache.keys();
+  const QList<int> keys = facilityCache.keys();
   for(int key : keys)
-    retval.insert(key, *parkingCache.object(key));
+  {
+    const Facilities *facilities = facilityCache.object(key);
+    if(facilities->hasParkings)
+      retval.insert(key, facilities->parkings);
+  }
 
   return retval;
 }
@@ -1479,9 +1560,13 @@ QHash<int, QList<map::MapHelipad> > AirportQuery::getHelipadCache() const
 {
   QHash<int, QList<map::MapHelipad> > retval;
 
-  const QList<int> keys = helipadCache.keys();
+  const QList<int> keys = facilityCache.keys();
   for(int key : keys)
-    retval.insert(key, *helipadCache.object(key));
+  {
+    const Facilities *facilities = facilityCache.object(key);
+    if(facilities->hasHelipads)
+      retval.insert(key, facilities->helipads);
+  }
 
   return retval;
 }
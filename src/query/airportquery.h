@@ -52,6 +52,7 @@ class SqlQuery;
 
 class CoordinateConverter;
 class MapTypesFactory;
+class StatementCache;
 class MapLayer;
 
 /* Key for nearestCache combining all query parameters */
@@ -250,13 +251,20 @@ private:
   MapTypesFactory *mapTypesFactory;
   atools::sql::SqlDatabase *db;
 
-  /* airport ID / object caches */
-  QCache<int, QList<map::MapRunway> > runwayCache;
-  QCache<int, QList<map::MapApron> > apronCache;
-  QCache<int, QList<map::MapTaxiPath> > taxipathCache;
-  QCache<int, QList<map::MapParking> > parkingCache;
-  QCache<int, QList<map::MapStart> > startCache;
-  QCache<int, QList<map::MapHelipad> > helipadCache;
+  /* Statements which are built dynamically or used rarely */
+  StatementCache *statements;
+
+  /* Runways, aprons, taxiways, parking, start positions and helipads of one airport.
+   * Lists are loaded on demand and kept in one cache entry. */
+  struct Facilities;
+
+  /* Get facilities from cache or a new object if not cached. Object is removed from cache and
+   * has to be passed to insertFacilities() after loading. */
+  Facilities *takeFacilities(int airportId);
+  void insertFacilities(int airportId, Facilities *facilities);
+
+  /* Airport ID to facilities. Cost is the estimated size in kB. */
+  QCache<int, Facilities> facilityCache;
 
   QCache<QString, map::MapAirport> airportIdentCache;
   QCache<int, map::MapAirport> airportIdCache, airportFuzzyIdCache;
@@ -0,0 +1,196 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "query/airspacecontainment.h"
+
+#include "geo/linestring.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace  {
+
+/* Maximum number of columns and rows */
+const static int MAX_GRID_DIMENSION = 64;
+
+/* > 0 if c is left of the line a to b */
+inline float orientation(float ax, float ay, float bx, float by, float cx, float cy)
+{
+  return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+}
+
+}
+
+AirspaceContainment::AirspaceContainment(const atools::geo::LineString& polygon)
+{
+  int num = polygon.size();
+  if(num < 3)
+    return;
+
+  lonX.reserve(num);
+  latY.reserve(num);
+  for(const atools::geo::Pos& pos : polygon)
+  {
+    lonX.append(pos.getLonX());
+    latY.append(pos.getLatY());
+  }
+
+  // Shift negative longitudes if any edge crosses the anti-meridian
+  for(int i = 0; i < num && !shifted; i++)
+    shifted = std::abs(lonX.at((i + 1) % num) - lonX.at(i)) > 180.f;
+
+  if(shifted)
+  {
+    for(float& x : lonX)
+    {
+      if(x < 0.f)
+        x += 360.f;
+    }
+  }
+
+  auto minmaxX = std::minmax_element(lonX.constBegin(), lonX.constEnd());
+  auto minmaxY = std::minmax_element(latY.constBegin(), latY.constEnd());
+  minX = *minmaxX.first;
+  minY = *minmaxY.first;
+
+  // Roughly square root of edge count cells in each direction
+  columns = rows = std::max(1, std::min(MAX_GRID_DIMENSION, static_cast<int>(std::sqrt(static_cast<float>(num)))));
+  cellWidth = std::max((*minmaxX.second - minX) / columns, 1.e-6f);
+  cellHeight = std::max((*minmaxY.second - minY) / rows, 1.e-6f);
+
+  // Add edges to all cells touched by their bounding rectangle ==========================
+  cellEdges.resize(columns * rows);
+  for(int i = 0; i < num; i++)
+  {
+    int j = (i + 1) % num;
+    int idx1 = cellIndex(std::min(lonX.at(i), lonX.at(j)), std::min(latY.at(i), latY.at(j)));
+    int idx2 = cellIndex(std::max(lonX.at(i), lonX.at(j)), std::max(latY.at(i), latY.at(j)));
+
+    for(int row = idx1 / columns; row <= idx2 / columns; row++)
+    {
+      for(int col = idx1 % columns; col <= idx2 % columns; col++)
+        cellEdges[row * columns + col].append(i);
+    }
+  }
+
+  // Calculate center states ==========================
+  // Full test for the first cell in each row and walk along the row checking only the edges of neighbors
+  cellInside.resize(columns * rows);
+  for(int row = 0; row < rows; row++)
+  {
+    float y = centerY(row);
+    bool inside = containsAll(centerX(0), y);
+    cellInside[row * columns] = inside;
+
+    for(int col = 1; col < columns; col++)
+    {
+      const QVector<int>& prevEdges = cellEdges.at(row * columns + col - 1);
+      const QVector<int>& edges = cellEdges.at(row * columns + col);
+      float x1 = centerX(col - 1), x2 = centerX(col);
+
+      // Edges are sorted by index since inserted in order - check each edge only once
+      QVector<int> edgesOnlyInCell;
+      for(int edge : edges)
+      {
+        if(!std::binary_search(prevEdges.constBegin(), prevEdges.constEnd(), edge))
+          edgesOnlyInCell.append(edge);
+      }
+
+      if(crossings(prevEdges, x1, y, x2, y) != crossings(edgesOnlyInCell, x1, y, x2, y))
+        inside = !inside;
+      cellInside[row * columns + col] = inside;
+    }
+  }
+}
+
+bool AirspaceContainment::contains(const atools::geo::Pos& pos) const
+{
+  if(cellInside.isEmpty() || !pos.isValid())
+    return false;
+
+  float x = pos.getLonX(), y = pos.getLatY();
+  if(shifted && x < 0.f)
+    x += 360.f;
+
+  if(x < minX || x > minX + cellWidth * columns || y < minY || y > minY + cellHeight * rows)
+    return false;
+
+  int idx = cellIndex(x, y);
+  const QVector<int>& edges = cellEdges.at(idx);
+  if(edges.isEmpty())
+    // Cell is completely inside or outside
+    return cellInside.at(idx);
+
+  // Line from center to position is within the cell and can only cross edges of this cell
+  return cellInside.at(idx) != crossings(edges, centerX(idx % columns), centerY(idx / columns), x, y);
+}
+
+int AirspaceContainment::getSizeBytes() const
+{
+  int size = static_cast<int>(sizeof(AirspaceContainment)) + (lonX.size() + latY.size()) * static_cast<int>(sizeof(float)) +
+             cellInside.size() * static_cast<int>(sizeof(bool));
+  for(const QVector<int>& edges : cellEdges)
+    size += static_cast<int>(sizeof(QVector<int>)) + edges.size() * static_cast<int>(sizeof(int));
+  return size;
+}
+
+int AirspaceContainment::cellIndex(float x, float y) const
+{
+  int col = std::max(0, std::min(columns - 1, static_cast<int>((x - minX) / cellWidth)));
+  int row = std::max(0, std::min(rows - 1, static_cast<int>((y - minY) / cellHeight)));
+  return row * columns + col;
+}
+
+float AirspaceContainment::centerX(int col) const
+{
+  return minX + (col + 0.5f) * cellWidth;
+}
+
+float AirspaceContainment::centerY(int row) const
+{
+  return minY + (row + 0.5f) * cellHeight;
+}
+
+bool AirspaceContainment::crossings(const QVector<int>& edges, float x1, float y1, float x2, float y2) const
+{
+  int num = lonX.size();
+  bool odd = false;
+  for(int i : edges)
+  {
+    int j = (i + 1) % num;
+    float ax = lonX.at(i), ay = latY.at(i), bx = lonX.at(j), by = latY.at(j);
+
+    // Half open comparison counts vertices touching the line only once for two adjacent edges
+    if((orientation(ax, ay, bx, by, x1, y1) > 0.f) != (orientation(ax, ay, bx, by, x2, y2) > 0.f) &&
+       (orientation(x1, y1, x2, y2, ax, ay) > 0.f) != (orientation(x1, y1, x2, y2, bx, by) > 0.f))
+      odd = !odd;
+  }
+  return odd;
+}
+
+bool AirspaceContainment::containsAll(float x, float y) const
+{
+  int num = lonX.size();
+  bool inside = false;
+  for(int i = 0, j = num - 1; i < num; j = i++)
+  {
+    if((latY.at(i) > y) != (latY.at(j) > y) &&
+       x < (lonX.at(j) - lonX.at(i)) * (y - latY.at(i)) / (latY.at(j) - latY.at(i)) + lonX.at(i))
+      inside = !inside;
+  }
+  return inside;
+}
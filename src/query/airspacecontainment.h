@@ -0,0 +1,85 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_AIRSPACECONTAINMENT_H
+#define LNM_AIRSPACECONTAINMENT_H
+
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class LineString;
+class Pos;
+}
+}
+
+/*
+ * Accelerates point in polygon tests for large airspace boundaries.
+ *
+ * The bounding rectangle of the polygon is divided into a grid of cells. Each cell holds the list of edges
+ * touching it and the precomputed inside/outside state of its center. A test for a cell without edges is a
+ * lookup. Otherwise only the edges of the cell are checked against the line from cell center to the position.
+ *
+ * Coordinates are plain longitude/latitude like the ray casting it replaces. Polygons crossing the anti-meridian
+ * are shifted to the range 0 to 360 degrees.
+ */
+class AirspaceContainment
+{
+public:
+  explicit AirspaceContainment(const atools::geo::LineString& polygon);
+
+  /* true if position is inside the polygon */
+  bool contains(const atools::geo::Pos& pos) const;
+
+  /* Number of polygon edges. Used as cache cost. */
+  int getEdgeCount() const
+  {
+    return static_cast<int>(lonX.size());
+  }
+
+  /* Approximate memory usage in bytes */
+  int getSizeBytes() const;
+
+private:
+  /* Index of cell containing x/y clamped to grid */
+  int cellIndex(float x, float y) const;
+
+  /* Center coordinates of cell at column/row */
+  float centerX(int col) const;
+  float centerY(int row) const;
+
+  /* Parity of crossings between the line x1/y1 to x2/y2 and the given polygon edges */
+  bool crossings(const QVector<int>& edges, float x1, float y1, float x2, float y2) const;
+
+  /* Full ray casting test to the right over all edges */
+  bool containsAll(float x, float y) const;
+
+  /* Polygon vertices - edge i goes from point i to point i + 1 wrapping around at the end */
+  QVector<float> lonX, latY;
+
+  /* Sorted edge indexes per cell in row major order */
+  QVector<QVector<int> > cellEdges;
+
+  /* Center inside state per cell */
+  QVector<bool> cellInside;
+
+  float minX = 0.f, minY = 0.f, cellWidth = 1.f, cellHeight = 1.f;
+  int columns = 0, rows = 0;
+  bool shifted = false;
+};
+
+#endif // LNM_AIRSPACECONTAINMENT_H
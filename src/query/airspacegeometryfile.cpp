@@ -0,0 +1,205 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "query/airspacegeometryfile.h"
+
+#include "fs/common/binarygeometry.h"
+#include "geo/linestring.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlutil.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+
+#include <algorithm>
+
+AirspaceGeometryFile::AirspaceGeometryFile()
+{
+
+}
+
+AirspaceGeometryFile::~AirspaceGeometryFile()
+{
+  close();
+}
+
+void AirspaceGeometryFile::close()
+{
+  if(data != nullptr)
+    file.unmap(const_cast<uchar *>(data));
+  file.close();
+
+  data = nullptr;
+  index = nullptr;
+  count = 0;
+  dataSize = 0;
+}
+
+bool AirspaceGeometryFile::open(atools::sql::SqlDatabase *db)
+{
+  close();
+
+  QFileInfo databaseInfo(db->databaseName());
+  if(!databaseInfo.exists() || !databaseInfo.isFile())
+    // In memory or temporary database
+    return false;
+
+  if(!atools::sql::SqlUtil(db).hasTableAndRows("boundary"))
+    return false;
+
+  file.setFileName(databaseInfo.absoluteFilePath() + ".geometry");
+
+  if(!map(databaseInfo))
+  {
+    // Missing or outdated - create a new file and try again
+    close();
+    if(write(db, file.fileName(), databaseInfo))
+      map(databaseInfo);
+  }
+
+  if(!isOpen())
+    qWarning() << Q_FUNC_INFO << "Cannot use" << file.fileName();
+
+  return isOpen();
+}
+
+bool AirspaceGeometryFile::map(const QFileInfo& databaseInfo)
+{
+  if(!file.exists() || !file.open(QIODevice::ReadOnly))
+    return false;
+
+  qint64 size = file.size();
+  if(size < static_cast<qint64>(sizeof(Header)))
+    return false;
+
+  const uchar *mapped = file.map(0, size);
+  if(mapped == nullptr)
+    return false;
+
+  const Header *header = reinterpret_cast<const Header *>(mapped);
+  if(header->magic != FILE_MAGIC || header->version != FILE_VERSION ||
+     header->databaseSize != databaseInfo.size() ||
+     header->databaseModified != databaseInfo.lastModified().toMSecsSinceEpoch() ||
+     header->count < 0 || static_cast<qint64>(sizeof(Header) + sizeof(Index) * static_cast<quint64>(header->count)) > size)
+  {
+    qInfo() << Q_FUNC_INFO << "Outdated" << file.fileName();
+    file.unmap(const_cast<uchar *>(mapped));
+    return false;
+  }
+
+  data = mapped;
+  dataSize = size;
+  count = header->count;
+  index = reinterpret_cast<const Index *>(data + sizeof(Header));
+  return true;
+}
+
+bool AirspaceGeometryFile::write(atools::sql::SqlDatabase *db, const QString& filename, const QFileInfo& databaseInfo)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  // Decode all geometry into memory first to get the offsets
+  QVector<Index> indexes;
+  QVector<float> coordinates;
+  atools::geo::LineString lines;
+
+  atools::sql::SqlQuery query("select boundary_id, geometry from boundary order by boundary_id", db);
+  query.exec();
+  while(query.next())
+  {
+    lines.clear();
+    atools::fs::common::BinaryGeometry geometry(query.value("geometry").toByteArray());
+    geometry.swapGeometry(lines);
+
+    Index idx;
+    idx.boundaryId = query.valueInt("boundary_id");
+    idx.numPoints = lines.size();
+    idx.offset = static_cast<qint64>(coordinates.size() * sizeof(float));
+    indexes.append(idx);
+
+    for(const atools::geo::Pos& pos : qAsConst(lines))
+      coordinates << pos.getLonX() << pos.getLatY();
+  }
+  query.finish();
+
+  // Make offsets relative to start of file
+  qint64 dataOffset = static_cast<qint64>(sizeof(Header) + sizeof(Index) * static_cast<quint64>(indexes.size()));
+  for(Index& idx : indexes)
+    idx.offset += dataOffset;
+
+  Header header;
+  header.magic = FILE_MAGIC;
+  header.version = FILE_VERSION;
+  header.databaseSize = databaseInfo.size();
+  header.databaseModified = databaseInfo.lastModified().toMSecsSinceEpoch();
+  header.count = indexes.size();
+  header.reserved = 0;
+
+  // Write to temporary file and rename when done
+  QSaveFile saveFile(filename);
+  if(saveFile.open(QIODevice::WriteOnly))
+  {
+    saveFile.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    saveFile.write(reinterpret_cast<const char *>(indexes.constData()), static_cast<qint64>(sizeof(Index)) * indexes.size());
+    saveFile.write(reinterpret_cast<const char *>(coordinates.constData()),
+                   static_cast<qint64>(sizeof(float)) * coordinates.size());
+
+    if(saveFile.commit())
+    {
+      qDebug() << Q_FUNC_INFO << "Written" << filename << indexes.size() << "boundaries in" << timer.elapsed() << "ms";
+      return true;
+    }
+  }
+
+  qWarning() << Q_FUNC_INFO << "Cannot write" << filename << saveFile.errorString();
+  return false;
+}
+
+bool AirspaceGeometryFile::getGeometry(atools::geo::LineString& lines, int boundaryId) const
+{
+  if(data == nullptr)
+    return false;
+
+  // Binary search in index sorted by id
+  const Index *end = index + count;
+  const Index *it = std::lower_bound(index, end, boundaryId, [](const Index& idx, int id) -> bool {
+      return idx.boundaryId < id;
+    });
+
+  if(it == end || it->boundaryId != boundaryId)
+    return false;
+
+  if(it->numPoints < 0 || it->offset + static_cast<qint64>(sizeof(float)) * 2 * it->numPoints > dataSize)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid index for" << boundaryId << "in" << file.fileName();
+    return false;
+  }
+
+  // Coordinates are used directly from the mapped memory
+  const float *coords = reinterpret_cast<const float *>(data + it->offset);
+  lines.clear();
+  lines.reserve(it->numPoints);
+  for(int i = 0; i < it->numPoints; i++)
+    lines.append(atools::geo::Pos(coords[i * 2], coords[i * 2 + 1]));
+
+  return true;
+}
@@ -0,0 +1,99 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_AIRSPACEGEOMETRYFILE_H
+#define LNM_AIRSPACEGEOMETRYFILE_H
+
+#include <QFile>
+
+namespace atools {
+namespace geo {
+class LineString;
+}
+namespace sql {
+class SqlDatabase;
+}
+}
+
+class QFileInfo;
+
+/*
+ * Memory mapped file containing decoded airspace boundary coordinates as float32 longitude/latitude pairs.
+ *
+ * The file is created next to the database file on first use and recreated if the version, size or modification
+ * time of the database changes. This avoids decoding the geometry BLOBs from the boundary table after each start.
+ *
+ * Only useful for static file based databases like simulator or navdata.
+ */
+class AirspaceGeometryFile
+{
+public:
+  AirspaceGeometryFile();
+  ~AirspaceGeometryFile();
+
+  AirspaceGeometryFile(const AirspaceGeometryFile& other) = delete;
+  AirspaceGeometryFile& operator=(const AirspaceGeometryFile& other) = delete;
+
+  /* Map the geometry file for the database and create it if missing or outdated. Returns true if usable. */
+  bool open(atools::sql::SqlDatabase *db);
+
+  /* Unmap and close file */
+  void close();
+
+  bool isOpen() const
+  {
+    return data != nullptr;
+  }
+
+  /* Fill lines with coordinates for the boundary id. Returns false if not found or file not open. */
+  bool getGeometry(atools::geo::LineString& lines, int boundaryId) const;
+
+private:
+  /* Header at the start of the file */
+  struct Header
+  {
+    quint32 magic, version;
+    qint64 databaseSize, databaseModified; /* Database size and last modification time in ms since epoch */
+    qint32 count, reserved;
+  };
+
+  /* Index following the header sorted by boundary id. Offset is relative to start of file. */
+  struct Index
+  {
+    qint32 boundaryId, numPoints;
+    qint64 offset;
+  };
+
+  /* Read all geometry from the boundary table and write the file */
+  bool write(atools::sql::SqlDatabase *db, const QString& filename, const QFileInfo& databaseInfo);
+
+  /* Map file and check header. Returns false if outdated or damaged. */
+  bool map(const QFileInfo& databaseInfo);
+
+  static const quint32 FILE_MAGIC = 0x4D474E4C; /* "LNGM" - also detects byte order changes */
+
+  /* Increment when changing the file format */
+  static const quint32 FILE_VERSION = 1;
+
+  QFile file;
+  const uchar *data = nullptr;
+  const Index *index = nullptr;
+  qint64 dataSize = 0;
+  int count = 0;
+};
+
+#endif // LNM_AIRSPACEGEOMETRYFILE_H
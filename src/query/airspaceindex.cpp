@@ -0,0 +1,122 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "query/airspaceindex.h"
+
+#include "exception.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlrecord.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QStringBuilder>
+
+using atools::sql::SqlQuery;
+
+AirspaceIndex::AirspaceIndex(atools::sql::SqlDatabase *sqlDb, const QString& tableParam, const QString& idColumnParam)
+  : db(sqlDb), table(tableParam), idColumn(idColumnParam), rtreeTable("lnm_rtree_alt_" + tableParam)
+{
+}
+
+AirspaceIndex::~AirspaceIndex()
+{
+  clear();
+}
+
+void AirspaceIndex::clear()
+{
+  if(created && db->isOpen())
+  {
+    try
+    {
+      SqlQuery(db).exec("drop table if exists temp." % rtreeTable);
+    }
+    catch(atools::Exception& e)
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot drop" << rtreeTable << e.what();
+    }
+    catch(...)
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot drop" << rtreeTable;
+    }
+  }
+
+  created = failed = false;
+}
+
+bool AirspaceIndex::create()
+{
+  if(created)
+    return true;
+
+  if(failed || !db->isOpen())
+    return false;
+
+  try
+  {
+    QElapsedTimer timer;
+    timer.start();
+
+    atools::sql::SqlRecord record = db->record(table);
+    if(!record.contains(idColumn) || !record.contains("min_altitude") || !record.contains("max_altitude"))
+    {
+      failed = true;
+      return false;
+    }
+
+    QString unlimited = QString::number(UNLIMITED_ALT);
+
+    SqlQuery query(db);
+    query.exec("drop table if exists temp." % rtreeTable);
+    query.exec("create virtual table temp." % rtreeTable %
+               " using rtree(id, min_lonx, max_lonx, min_laty, max_laty, min_alt, max_alt)");
+    query.exec("insert into temp." % rtreeTable % " (id, min_lonx, max_lonx, min_laty, max_laty, min_alt, max_alt) "
+               "select " % idColumn % ", "
+               "case when max_lonx < min_lonx then -180 else min_lonx end, "
+               "case when max_lonx < min_lonx then 180 else max_lonx end, "
+               "min_laty, max_laty, coalesce(min_altitude, 0), "
+               "case when coalesce(max_altitude, 0) = 0 then " % unlimited % " else max_altitude end "
+               "from " % table % " where min_lonx is not null and min_laty is not null");
+    created = true;
+
+    qDebug() << Q_FUNC_INFO << "Created" << rtreeTable << "in" << timer.elapsed() << "ms";
+  }
+  catch(atools::Exception& e)
+  {
+    // R*Tree module not compiled into SQLite - use plain queries
+    qWarning() << Q_FUNC_INFO << "Cannot create" << rtreeTable << e.what();
+    failed = true;
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot create" << rtreeTable;
+    failed = true;
+  }
+
+  return created;
+}
+
+QString AirspaceIndex::conditionBind()
+{
+  if(!create())
+    return QString();
+
+  return idColumn % " in (select id from temp." % rtreeTable %
+         " where max_lonx >= :leftx and min_lonx <= :rightx and max_laty >= :bottomy and min_laty <= :topy "
+         "and max_alt >= :minalt and min_alt <= :maxalt)";
+}
@@ -0,0 +1,69 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_AIRSPACEINDEX_H
+#define LNM_AIRSPACEINDEX_H
+
+#include <QString>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+/*
+ * SQLite R*Tree index on bounding rectangle and altitude range of the airspace "boundary" table.
+ * Combines the spatial and the altitude interval query into one index lookup.
+ *
+ * Airspaces crossing the anti-meridian are indexed with the full longitude range.
+ * A maximum altitude of zero is unlimited and indexed as UNLIMITED_ALT.
+ *
+ * Created in the temporary schema of the connection on first use like SpatialIndex.
+ * Has to be cleared before the database is closed or the table is modified.
+ */
+class AirspaceIndex
+{
+public:
+  AirspaceIndex(atools::sql::SqlDatabase *sqlDb, const QString& tableParam, const QString& idColumnParam);
+  ~AirspaceIndex();
+
+  AirspaceIndex(const AirspaceIndex& other) = delete;
+  AirspaceIndex& operator=(const AirspaceIndex& other) = delete;
+
+  /* Drop index. Index is created again on next use. */
+  void clear();
+
+  /* Build condition like "boundary_id in (select id from temp.lnm_rtree_alt_boundary where ...)" using the
+   * placeholders ":leftx", ":rightx", ":bottomy", ":topy", ":minalt" and ":maxalt" for prepared queries.
+   * Index is created immediately since it has to exist when preparing the query.
+   * @return empty string if index creation failed */
+  QString conditionBind();
+
+  /* Altitude used for unlimited airspaces and as maximum for queries without altitude limit */
+  static Q_DECL_CONSTEXPR int UNLIMITED_ALT = 1000000;
+
+private:
+  /* Create index if not done yet. Returns false if the R*Tree module is not available. */
+  bool create();
+
+  atools::sql::SqlDatabase *db;
+  QString table, idColumn, rtreeTable;
+  bool created = false, failed = false;
+};
+
+#endif // LNM_AIRSPACEINDEX_H
@@ -19,9 +19,16 @@
 
 #include "atools.h"
 #include "common/constants.h"
+#include "common/maptools.h"
+#include "common/memoryregistry.h"
 #include "common/maptypesfactory.h"
 #include "fs/common/binarygeometry.h"
+#include "geo/rect.h"
 #include "mapgui/maplayer.h"
+#include "query/airspaceindex.h"
+#include "query/airspacecontainment.h"
+#include "query/airspacegeometryfile.h"
+#include "query/onlinecentergeometryfile.h"
 #include "settings/settings.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlutil.h"
@@ -37,6 +44,12 @@ static double queryRectInflationFactor = 0.2;
 static double queryRectInflationIncrement = 0.1;
 int AirspaceQuery::queryMaxRows = map::MAX_MAP_OBJECTS;
 
+/* Douglas-Peucker tolerance in degree for each level of detail. Index 0 is full resolution. */
+static const float LOD_TOLERANCE_DEG[] = {0.f, 0.005f, 0.02f, 0.08f};
+
+/* Do not simplify below this number of points */
+static const int MIN_LOD_POINTS = 8;
+
 AirspaceQuery::AirspaceQuery(SqlDatabase *sqlDb, map::MapAirspaceSources src)
   : db(sqlDb), source(src)
 {
@@ -46,15 +59,46 @@ AirspaceQuery::AirspaceQuery(SqlDatabase *sqlDb, map::MapAirspaceSources src)
   airspaceLineCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "AirspaceLineCache", 10000).toInt());
   onlineCenterGeoCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "OnlineCenterGeoCache", 10000).toInt());
   onlineCenterGeoFileCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "OnlineCenterGeoFileCache", 10000).toInt());
+  airspaceContainmentCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "AirspaceContainmentCache", 1000000).toInt());
 
   queryRectInflationFactor = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "QueryRectInflationFactor", 0.3).toDouble();
   queryRectInflationIncrement = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "QueryRectInflationIncrement", 0.1).toDouble();
   queryMaxRows = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "AirspaceQueryRowLimit", map::MAX_MAP_OBJECTS).toInt();
+
+  // User airspaces are reloaded often - use file only for static databases
+  if((src & (map::AIRSPACE_SRC_SIM | map::AIRSPACE_SRC_NAV)) &&
+     settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "AirspaceGeometryFile", true).toBool())
+    geometryFile = new AirspaceGeometryFile();
+
+  // Online centers have no altitude limits
+  if(!(src & map::AIRSPACE_SRC_ONLINE) && settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "AirspaceIndex", true).toBool())
+    airspaceIndex = new AirspaceIndex(db, "boundary", "boundary_id");
+
+  // Online centers are resolved against user airspaces only
+  if((src & map::AIRSPACE_SRC_USER) && settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "OnlineCenterGeometryFile", true).toBool())
+    onlineCenterFile = new OnlineCenterGeometryFile();
+
+  MemoryRegistry::registerCaches(this, [this](QVector<memreg::Usage>& usage) -> void {
+    const QString group = "Airspaces " % map::airspaceSourceText(source);
+    usage.append(memreg::usage(group, "Map", airspaceCache.objectCount(), sizeof(map::MapAirspace)));
+    usage.append(memreg::cacheUsage(group, "Geometry", airspaceLineCache, 4096));
+    usage.append(memreg::cacheUsage(group, "Online centers", onlineCenterGeoCache, 4096));
+    usage.append(memreg::cacheUsage(group, "Online center files", onlineCenterGeoFileCache, 4096));
+
+    // Cost is number of edges - roughly two coordinates and two cell entries each
+    usage.append({group, "Containment", airspaceContainmentCache.totalCost() * 16L, airspaceContainmentCache.size()});
+  }, [this]() -> void {
+    clearCache();
+  });
 }
 
 AirspaceQuery::~AirspaceQuery()
 {
+  MemoryRegistry::unregisterCaches(this);
   deInitQueries();
+  delete airspaceIndex;
+  delete onlineCenterFile;
+  delete geometryFile;
   delete mapTypesFactory;
 }
 
@@ -110,6 +154,8 @@ const QList<map::MapAirspace> *AirspaceQuery::getAirspaces(const GeoDataLatLonBo
                                                            const map::MapAirspaceFilter& filter, float flightPlanAltitude,
                                                            bool lazy, bool& overflow)
 {
+  checkOnlineRevision();
+
   airspaceCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
                             [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
   {
@@ -126,29 +172,20 @@ const QList<map::MapAirspace> *AirspaceQuery::getAirspaces(const GeoDataLatLonBo
 
   if(airspaceCache.list.isEmpty() && !lazy)
   {
-    QStringList typeStrings;
+    const QStringList typeStrings = airspaceTypeStrings(filter);
 
-    if(filter.types != map::AIRSPACE_NONE)
+    if(!typeStrings.isEmpty())
     {
-      // Build a list of query strings based on the bitfield
-      if(filter.types == map::AIRSPACE_ALL)
-        typeStrings.append("%");
-      else
-      {
-        for(int i = 0; i <= map::MAP_AIRSPACE_TYPE_BITS; i++)
-        {
-          map::MapAirspaceTypes t(1 << i);
-          if(filter.types & t)
-            typeStrings.append(map::airspaceTypeToDatabase(t));
-        }
-      }
-
       // Select query and assign altitude limits ======================================
       SqlQuery *query = nullptr;
       int minAlt = map::MapAirspaceFilter::MIN_AIRSPACE_ALT, maxAlt = map::MapAirspaceFilter::MAX_AIRSPACE_ALT;
       if(filter.flags.testFlag(map::AIRSPACE_ALTITUDE_ALL))
+      {
         // No altitude query =========
+        minAlt = -AirspaceIndex::UNLIMITED_ALT;
+        maxAlt = AirspaceIndex::UNLIMITED_ALT;
         query = airspaceByRectQuery;
+      }
       else if(filter.flags.testFlag(map::AIRSPACE_ALTITUDE_FLIGHTPLAN))
       {
         // One altitude query =========
@@ -170,6 +207,10 @@ const QList<map::MapAirspace> *AirspaceQuery::getAirspaces(const GeoDataLatLonBo
         query = maxAlt == minAlt ? airspaceByRectAltQuery : airspaceByRectAltRangeQuery;
       }
 
+      // Indexed query covers all altitude modes
+      if(query != nullptr && airspaceByRectIndexQuery != nullptr)
+        query = airspaceByRectIndexQuery;
+
       if(query::valid(Q_FUNC_INFO, query))
       {
         QSet<int> ids;
@@ -185,7 +226,7 @@ const QList<map::MapAirspace> *AirspaceQuery::getAirspaces(const GeoDataLatLonBo
             // Bind altitude values ===========================
             if(query == airspaceByRectAltQuery)
               query->bindValue(":alt", minAlt);
-            else if(query == airspaceByRectAltRangeQuery)
+            else if(query == airspaceByRectAltRangeQuery || query == airspaceByRectIndexQuery)
             {
               query->bindValue(":minalt", minAlt);
               query->bindValue(":maxalt", maxAlt);
@@ -196,20 +237,9 @@ const QList<map::MapAirspace> *AirspaceQuery::getAirspaces(const GeoDataLatLonBo
             while(query->next())
             {
               // Avoid double airspaces which can happen if they cross the date boundary
-              if(ids.contains(query->valueInt("boundary_id")))
+              if(ids.contains(query->valueInt("boundary_id")) || !acceptAirspace(query, filter))
                 continue;
 
-              if(hasMultipleCode && filter.flags.testFlag(map::AIRSPACE_NO_MULTIPLE_Z) && query->valueStr("multiple_code") == "Z")
-                continue;
-
-              if(hasFirUir)
-              {
-                // Database has new FIR/UIR types - filter out the old deprecated centers
-                QString name = query->valueStr("name");
-                if(name.contains("(FIR)") || name.contains("(UIR)") || name.contains("(FIR/UIR)"))
-                  continue;
-              }
-
               map::MapAirspace airspace;
               mapTypesFactory->fillAirspace(query->record(), airspace, source);
               airspaceCache.list.append(airspace);
@@ -232,31 +262,184 @@ const QList<map::MapAirspace> *AirspaceQuery::getAirspaces(const GeoDataLatLonBo
   return &airspaceCache.list;
 }
 
+void AirspaceQuery::getAirspacesForRects(QVector<std::pair<int, map::MapAirspace> >& airspaces,
+                                         const QVector<atools::geo::Rect>& rects,
+                                         const QVector<std::pair<float, float> >& altitudeRanges,
+                                         const map::MapAirspaceFilter& filter)
+{
+  checkOnlineRevision();
+
+  const QStringList typeStrings = airspaceTypeStrings(filter);
+  SqlQuery *query = airspaceByRectIndexQuery != nullptr ? airspaceByRectIndexQuery : airspaceByRectAltRangeQuery;
+  if(typeStrings.isEmpty() || !query::valid(Q_FUNC_INFO, query))
+    return;
+
+  for(int i = 0; i < rects.size() && i < altitudeRanges.size(); i++)
+  {
+    const atools::geo::Rect& rect = rects.at(i);
+    if(!rect.isValid())
+      continue;
+
+    QSet<int> ids;
+    const QList<atools::geo::Rect> splitRects = rect.crossesAntiMeridian() ? rect.splitAtAntiMeridian() :
+                                                QList<atools::geo::Rect>({rect});
+    for(const atools::geo::Rect& r : splitRects)
+    {
+      for(const QString& typeStr : typeStrings)
+      {
+        query::bindRect(r, query);
+        query->bindValue(":type", typeStr);
+        query->bindValue(":minalt", atools::roundToInt(altitudeRanges.at(i).first));
+        query->bindValue(":maxalt", atools::roundToInt(altitudeRanges.at(i).second));
+
+        query->exec();
+        while(query->next())
+        {
+          if(ids.contains(query->valueInt("boundary_id")) || !acceptAirspace(query, filter))
+            continue;
+
+          map::MapAirspace airspace;
+          mapTypesFactory->fillAirspace(query->record(), airspace, source);
+          airspaces.append(std::make_pair(i, airspace));
+          ids.insert(airspace.id);
+        }
+      }
+    }
+  }
+}
+
+QStringList AirspaceQuery::airspaceTypeStrings(const map::MapAirspaceFilter& filter)
+{
+  // Build a list of query strings based on the bitfield
+  QStringList typeStrings;
+  if(filter.types == map::AIRSPACE_ALL)
+    typeStrings.append("%");
+  else if(filter.types != map::AIRSPACE_NONE)
+  {
+    for(int i = 0; i <= map::MAP_AIRSPACE_TYPE_BITS; i++)
+    {
+      map::MapAirspaceTypes t(1 << i);
+      if(filter.types & t)
+        typeStrings.append(map::airspaceTypeToDatabase(t));
+    }
+  }
+  return typeStrings;
+}
+
+bool AirspaceQuery::acceptAirspace(const SqlQuery *query, const map::MapAirspaceFilter& filter) const
+{
+  if(hasMultipleCode && filter.flags.testFlag(map::AIRSPACE_NO_MULTIPLE_Z) && query->valueStr("multiple_code") == "Z")
+    return false;
+
+  if(hasFirUir)
+  {
+    // Database has new FIR/UIR types - filter out the old deprecated centers
+    QString name = query->valueStr("name");
+    if(name.contains("(FIR)") || name.contains("(UIR)") || name.contains("(FIR/UIR)"))
+      return false;
+  }
+  return true;
+}
+
 void AirspaceQuery::airspaceGeometry(LineString *lines, const QByteArray& bytes)
 {
   atools::fs::common::BinaryGeometry geometry(bytes);
   geometry.swapGeometry(*lines);
 }
 
-const LineString *AirspaceQuery::getAirspaceGeometryById(int airspaceId)
+int AirspaceQuery::lodLevel(const MapLayer *mapLayer)
+{
+  if(mapLayer == nullptr)
+    return 0;
+
+  // Allow half a pixel deviation assuming a screen width of about 1000 pixels for the layer range
+  float maxDeviationDeg = mapLayer->getMaxRange() / 2000.f / 111.f;
+
+  int level = 0;
+  for(int i = 1; i < NUM_LOD_LEVELS; i++)
+  {
+    if(LOD_TOLERANCE_DEG[i] <= maxDeviationDeg)
+      level = i;
+  }
+  return level;
+}
+
+const LineString *AirspaceQuery::getAirspaceGeometryById(int airspaceId, const MapLayer *mapLayer)
 {
   if(!query::valid(Q_FUNC_INFO, airspaceLinesByIdQuery))
     return nullptr;
 
-  if(airspaceLineCache.contains(airspaceId))
-    return airspaceLineCache.object(airspaceId);
-  else
+  checkOnlineRevision();
+
+  AirspaceLines *lines = airspaceLineCache.object(airspaceId);
+  if(lines == nullptr)
   {
-    LineString *linestring = new LineString;
+    lines = new AirspaceLines;
+    LineString& linestring = lines->levels[0];
+
+    // Try mapped file first and fall back to decoding the BLOB
+    if(geometryFile == nullptr || !geometryFile->getGeometry(linestring, airspaceId))
+    {
+      airspaceLinesByIdQuery->bindValue(":id", airspaceId);
+      airspaceLinesByIdQuery->exec();
+      if(airspaceLinesByIdQuery->next())
+        airspaceGeometry(&linestring, airspaceLinesByIdQuery->value("geometry").toByteArray());
+      airspaceLinesByIdQuery->finish();
+    }
+
+    // Precalculate simplified geometry for all levels - each based on the more detailed one before
+    for(int i = 1; i < NUM_LOD_LEVELS; i++)
+    {
+      const LineString& previous = lines->levels[i - 1];
+      if(previous.size() > MIN_LOD_POINTS)
+      {
+        LineString simplified = maptools::simplifyLineString(previous, LOD_TOLERANCE_DEG[i]);
 
-    airspaceLinesByIdQuery->bindValue(":id", airspaceId);
-    airspaceLinesByIdQuery->exec();
-    if(airspaceLinesByIdQuery->next())
-      airspaceGeometry(linestring, airspaceLinesByIdQuery->value("geometry").toByteArray());
-    airspaceLinesByIdQuery->finish();
-    airspaceLineCache.insert(airspaceId, linestring);
+        // Keep previous if result is degenerated
+        lines->levels[i] = simplified.size() >= MIN_LOD_POINTS ? simplified : previous;
+      }
+      else
+        lines->levels[i] = previous;
+    }
 
-    return linestring;
+    airspaceLineCache.insert(airspaceId, lines);
+  }
+
+  return &lines->levels[lodLevel(mapLayer)];
+}
+
+bool AirspaceQuery::isPosInsideAirspace(int airspaceId, const Pos& pos)
+{
+  checkOnlineRevision();
+
+  AirspaceContainment *containment = airspaceContainmentCache.object(airspaceId);
+  if(containment == nullptr)
+  {
+    const LineString *lines = getAirspaceGeometryById(airspaceId);
+    if(lines == nullptr)
+      return false;
+
+    containment = new AirspaceContainment(*lines);
+    airspaceContainmentCache.insert(airspaceId, containment, std::max(1, containment->getEdgeCount()));
+  }
+
+  return containment->contains(pos);
+}
+
+void AirspaceQuery::getAirspacesAtPos(QList<map::MapAirspace>& airspaces, const Pos& pos, float altitudeFt,
+                                      const map::MapAirspaceFilter& filter)
+{
+  if(!pos.isValid())
+    return;
+
+  // Use a small rectangle since index rectangles are compared inclusive
+  QVector<std::pair<int, map::MapAirspace> > candidates;
+  getAirspacesForRects(candidates, {Rect(pos, 10.f, true /* fast */)}, {std::make_pair(altitudeFt, altitudeFt)}, filter);
+
+  for(const std::pair<int, map::MapAirspace>& candidate : qAsConst(candidates))
+  {
+    if(isPosInsideAirspace(candidate.second.id, pos))
+      airspaces.append(candidate.second);
   }
 }
 
@@ -276,23 +459,30 @@ const LineString *AirspaceQuery::getAirspaceGeometryByFile(QString callsign)
       LineString *lineString = new LineString();
       callsign = callsign.trimmed().toUpper();
 
-      // Do a pattern query and check for basename matches later
-      airspaceGeoByFileQuery->bindValue(":filepath", "%" + callsign + "%");
-      airspaceGeoByFileQuery->exec();
-
-      while(airspaceGeoByFileQuery->next())
+      // Try mapping from previous sessions first
+      if(onlineCenterFile == nullptr || !onlineCenterFile->getGeometry(*lineString, OnlineCenterGeometryFile::BY_FILE, callsign))
       {
-        QFileInfo fi(airspaceGeoByFileQuery->valueStr("filepath").trimmed());
-        QString basename = fi.baseName().toUpper().trimmed();
+        // Do a pattern query and check for basename matches later
+        airspaceGeoByFileQuery->bindValue(":filepath", "%" + callsign + "%");
+        airspaceGeoByFileQuery->exec();
 
-        // Check if the basename matches the callsign
-        if(basename == callsign.toUpper())
+        while(airspaceGeoByFileQuery->next())
         {
-          airspaceGeometry(lineString, airspaceGeoByFileQuery->value("geometry").toByteArray());
-          break;
+          QFileInfo fi(airspaceGeoByFileQuery->valueStr("filepath").trimmed());
+          QString basename = fi.baseName().toUpper().trimmed();
+
+          // Check if the basename matches the callsign
+          if(basename == callsign.toUpper())
+          {
+            airspaceGeometry(lineString, airspaceGeoByFileQuery->value("geometry").toByteArray());
+            break;
+          }
         }
+        airspaceGeoByFileQuery->finish();
+
+        if(onlineCenterFile != nullptr)
+          onlineCenterFile->insertGeometry(*lineString, OnlineCenterGeometryFile::BY_FILE, callsign);
       }
-      airspaceGeoByFileQuery->finish();
       onlineCenterGeoFileCache.insert(callsign, lineString);
       if(!lineString->isEmpty())
         return lineString;
@@ -350,15 +540,23 @@ const LineString *AirspaceQuery::airspaceGeometryByNameInternal(const QString& c
     {
       LineString *lineString = new LineString();
 
-      // Check if the airspace name matches the callsign
-      airspaceGeoByNameQuery->bindValue(":name", callsign);
-      airspaceGeoByNameQuery->bindValue(":type", facilityType.isEmpty() ? "%" : facilityType);
-      airspaceGeoByNameQuery->exec();
+      // Try mapping from previous sessions first
+      const QString fileKey = callsign % '|' % facilityType;
+      if(onlineCenterFile == nullptr || !onlineCenterFile->getGeometry(*lineString, OnlineCenterGeometryFile::BY_NAME, fileKey))
+      {
+        // Check if the airspace name matches the callsign
+        airspaceGeoByNameQuery->bindValue(":name", callsign);
+        airspaceGeoByNameQuery->bindValue(":type", facilityType.isEmpty() ? "%" : facilityType);
+        airspaceGeoByNameQuery->exec();
 
-      if(airspaceGeoByNameQuery->next())
-        airspaceGeometry(lineString, airspaceGeoByNameQuery->value("geometry").toByteArray());
+        if(airspaceGeoByNameQuery->next())
+          airspaceGeometry(lineString, airspaceGeoByNameQuery->value("geometry").toByteArray());
 
-      airspaceGeoByNameQuery->finish();
+        airspaceGeoByNameQuery->finish();
+
+        if(onlineCenterFile != nullptr)
+          onlineCenterFile->insertGeometry(*lineString, OnlineCenterGeometryFile::BY_NAME, fileKey);
+      }
       onlineCenterGeoCache.insert(callsign, lineString);
       if(!lineString->isEmpty())
         return lineString;
@@ -471,6 +669,18 @@ void AirspaceQuery::initQueries()
                                   "((:alt <= max_altitude and :alt >= min_altitude) or "
                                   "(max_altitude = 0 and :alt >= min_altitude))");
 
+  // Combined rectangle and altitude range lookup in the R*Tree index
+  if(airspaceIndex != nullptr && hasAirspaces)
+  {
+    QString indexCondition = airspaceIndex->conditionBind();
+    if(!indexCondition.isEmpty())
+    {
+      airspaceByRectIndexQuery = new SqlQuery(db);
+      airspaceByRectIndexQuery->prepare("select " % airspaceQueryBase % " from " % table %
+                                        " where " % indexCondition % " and type like :type");
+    }
+  }
+
   airspaceLinesByIdQuery = new SqlQuery(db);
   airspaceLinesByIdQuery->prepare("select geometry from " % table % " where " % id % " = :id");
 
@@ -484,10 +694,20 @@ void AirspaceQuery::initQueries()
     airspaceGeoByFileQuery->prepare("select b.geometry, f.filepath from " % table %
                                     " b join bgl_file f on b.file_id = f.bgl_file_id where f.filepath like :filepath");
   }
+
+  if(geometryFile != nullptr && hasAirspaces)
+    geometryFile->open(db);
+
+  if(onlineCenterFile != nullptr)
+    onlineCenterFile->load(db);
 }
 
 void AirspaceQuery::deInitQueries()
 {
+  // Release mapped file before the database is replaced
+  if(geometryFile != nullptr)
+    geometryFile->close();
+
   clearCache();
 
   delete airspaceByRectQuery;
@@ -499,6 +719,17 @@ void AirspaceQuery::deInitQueries()
   delete airspaceByRectAltQuery;
   airspaceByRectAltQuery = nullptr;
 
+  delete airspaceByRectIndexQuery;
+  airspaceByRectIndexQuery = nullptr;
+
+  // Index has to be dropped before the database is closed or user airspaces are reloaded
+  if(airspaceIndex != nullptr)
+    airspaceIndex->clear();
+
+  // Write new callsign mappings before user airspaces are reloaded
+  if(onlineCenterFile != nullptr)
+    onlineCenterFile->save();
+
   delete airspaceLinesByIdQuery;
   airspaceLinesByIdQuery = nullptr;
 
@@ -519,8 +750,23 @@ void AirspaceQuery::clearCache()
 {
   airspaceCache.clear();
   airspaceLineCache.clear();
+  airspaceContainmentCache.clear();
   onlineCenterGeoCache.clear();
   onlineCenterGeoFileCache.clear();
+  onlineRevision = query::revision(query::REV_ONLINE);
 
   updateAirspaceStatus();
 }
+
+void AirspaceQuery::checkOnlineRevision()
+{
+  if(source & map::AIRSPACE_SRC_ONLINE && onlineRevision != query::revision(query::REV_ONLINE))
+  {
+    airspaceCache.clear();
+    airspaceLineCache.clear();
+    airspaceContainmentCache.clear();
+    onlineRevision = query::revision(query::REV_ONLINE);
+
+    updateAirspaceStatus();
+  }
+}
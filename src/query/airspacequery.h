@@ -19,6 +19,7 @@
 #define LITTLENAVMAP_AIRSPACEQUERY_H
 
 #include "query/querytypes.h"
+#include "geo/linestring.h"
 
 #include <QCache>
 
@@ -35,6 +36,10 @@ class SqlRecord;
 
 class MapTypesFactory;
 class MapLayer;
+class AirspaceGeometryFile;
+class AirspaceIndex;
+class AirspaceContainment;
+class OnlineCenterGeometryFile;
 
 /*
  * Provides map related database queries around airspaces. Fill objects of the maptypes namespace and maintains a cache.
@@ -67,7 +72,24 @@ public:
   /* Get airspaces for map display */
   const QList<map::MapAirspace> *getAirspaces(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer,
                                               const map::MapAirspaceFilter& filter, float flightPlanAltitude, bool lazy, bool& overflow);
-  const atools::geo::LineString *getAirspaceGeometryById(int airspaceId);
+
+  /* Get airspaces overlapping each rectangle within the altitude range in feet at the same index.
+   * Result contains the rectangle index and the airspace. An airspace is added only once per rectangle.
+   * Uses one indexed query per rectangle if the R*Tree index is available. Not for online centers. */
+  void getAirspacesForRects(QVector<std::pair<int, map::MapAirspace> >& airspaces, const QVector<atools::geo::Rect>& rects,
+                            const QVector<std::pair<float, float> >& altitudeRanges, const map::MapAirspaceFilter& filter);
+
+  /* Get airspace boundary. A simplified version is returned if map layer is given and zoomed out far enough.
+   * Full resolution if mapLayer is null. */
+  const atools::geo::LineString *getAirspaceGeometryById(int airspaceId, const MapLayer *mapLayer = nullptr);
+
+  /* true if the position is inside the full resolution boundary of the airspace.
+   * Uses a grid accelerated test which is built on first use and cached alongside the geometry. */
+  bool isPosInsideAirspace(int airspaceId, const atools::geo::Pos& pos);
+
+  /* Get all airspaces containing the position and altitude in feet. Not for online centers. */
+  void getAirspacesAtPos(QList<map::MapAirspace>& airspaces, const atools::geo::Pos& pos, float altitudeFt,
+                         const map::MapAirspaceFilter& filter);
 
   /* Query raw geometry blob by online callsign (name) and facility type */
   const atools::geo::LineString *getAirspaceGeometryByName(QString callsign, const QString& facilityType);
@@ -75,9 +97,10 @@ public:
   /* Tries to fetch online airspace geometry by  file name. */
   const atools::geo::LineString *getAirspaceGeometryByFile(QString callsign);
 
-  /* True if tables atc or boundary have content. Updated in clearCache and initQueries */
+  /* True if tables atc or boundary have content. Updated in clearCache, initQueries and on online data changes */
   bool hasAirspacesDatabase()
   {
+    checkOnlineRevision();
     return hasAirspaces;
   }
 
@@ -87,26 +110,60 @@ public:
   /* Close all query objects thus disconnecting from the database */
   void deInitQueries();
 
-  /* Clear all internal caches after reloading online centers */
+  /* Clear all internal caches */
   void clearCache();
 
 private:
   void updateAirspaceStatus();
+
+  /* Type query strings for filter. Empty if nothing is selected. */
+  static QStringList airspaceTypeStrings(const map::MapAirspaceFilter& filter);
+
+  /* Filter out multiple code Z and deprecated center types */
+  bool acceptAirspace(const atools::sql::SqlQuery *query, const map::MapAirspaceFilter& filter) const;
+
+  /* Drop objects and geometry loaded from the online database if it was updated since.
+   * Center geometry from files and user airspaces does not depend on online data and is kept. */
+  void checkOnlineRevision();
   const atools::geo::LineString *airspaceGeometryByNameInternal(const QString& callsign, const QString& facilityType);
   void airspaceGeometry(atools::geo::LineString* lines, const QByteArray& bytes);
 
+  /* Number of detail levels including full resolution at index 0 */
+  static Q_DECL_CONSTEXPR int NUM_LOD_LEVELS = 4;
+
+  /* Get level of detail index for map layer. 0 is full resolution. */
+  static int lodLevel(const MapLayer *mapLayer);
+
+  /* Full resolution geometry at index 0 and simplified versions for zoomed out map layers */
+  struct AirspaceLines
+  {
+    atools::geo::LineString levels[NUM_LOD_LEVELS];
+  };
+
   MapTypesFactory *mapTypesFactory;
   atools::sql::SqlDatabase *db;
 
+  /* Decoded boundary coordinates mapped from file. Only for simulator and navdata. null if disabled. */
+  AirspaceGeometryFile *geometryFile = nullptr;
+
+  /* Callsign to geometry mapping kept between sessions. Only for user airspaces. null if disabled. */
+  OnlineCenterGeometryFile *onlineCenterFile = nullptr;
+
+  /* Rectangle and altitude index. null for online centers or if disabled. */
+  AirspaceIndex *airspaceIndex = nullptr;
+
   /* Simple bounding rectangle caches */
   query::SimpleRectCache<map::MapAirspace> airspaceCache;
   map::MapAirspaceFilter lastAirspaceFilter;
   float lastFlightplanAltitude = 0.f;
 
   /* ID/object caches */
-  QCache<int, atools::geo::LineString> airspaceLineCache;
+  QCache<int, AirspaceLines> airspaceLineCache;
   QCache<QString, atools::geo::LineString> onlineCenterGeoCache, onlineCenterGeoFileCache;
 
+  /* Point in polygon acceleration structures by airspace id. Cost is number of edges. */
+  QCache<int, AirspaceContainment> airspaceContainmentCache;
+
   static int queryMaxRows;
 
   /* True if tables atc or boundary have content. Updated in clearCache and initQueries */
@@ -117,12 +174,15 @@ private:
   /* Database queries */
   atools::sql::SqlQuery *airspaceByRectQuery = nullptr, *airspaceByRectAltRangeQuery = nullptr, *airspaceByRectAltQuery = nullptr,
                         *airspaceLinesByIdQuery = nullptr, *airspaceGeoByNameQuery = nullptr, *airspaceGeoByFileQuery = nullptr,
-                        *airspaceByIdQuery = nullptr, *airspaceInfoQuery = nullptr;
+                        *airspaceByIdQuery = nullptr, *airspaceInfoQuery = nullptr, *airspaceByRectIndexQuery = nullptr;
 
   bool hasMultipleCode = false;
 
   /* Source database definition */
   map::MapAirspaceSources source;
+
+  /* Online data revision at the time the caches were filled */
+  quint32 onlineRevision = 0;
 };
 
 #endif // LITTLENAVMAP_AIRSPACEQUERY_H
@@ -18,16 +18,26 @@
 #include "query/airwayquery.h"
 
 #include "common/constants.h"
+#include "common/memoryregistry.h"
 #include "common/mapresult.h"
+#include "common/maptools.h"
 #include "common/maptypesfactory.h"
+#include "geo/calculations.h"
 #include "mapgui/maplayer.h"
 #include "settings/settings.h"
 #include "sql/sqldatabase.h"
 
+#include <QElapsedTimer>
+
 using namespace Marble;
 using namespace atools::sql;
 using namespace atools::geo;
 
+/* Simplification tolerance in degree for each level of MapAirwayPolyline::levels */
+static const float AIRWAY_POLYLINE_TOLERANCES_DEG[] = {0.f, 0.02f, 0.1f, 0.3f};
+static const int AIRWAY_POLYLINE_NUM_LEVELS =
+  sizeof(AIRWAY_POLYLINE_TOLERANCES_DEG) / sizeof(AIRWAY_POLYLINE_TOLERANCES_DEG[0]);
+
 static double queryRectInflationFactor = 0.2;
 static double queryRectInflationIncrement = 0.1;
 int AirwayQuery::queryMaxRowsAirways = map::MAX_MAP_OBJECTS;
@@ -41,10 +51,21 @@ AirwayQuery::AirwayQuery(SqlDatabase *sqlDbNav, bool trackDatabaseParam)
   queryRectInflationFactor = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "QueryRectInflationFactor", 0.3).toDouble();
   queryRectInflationIncrement = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "QueryRectInflationIncrement", 0.1).toDouble();
   queryMaxRowsAirways = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "AirwayQueryRowLimitAw", map::MAX_MAP_OBJECTS).toInt();
+
+  MemoryRegistry::registerCaches(this, [this](QVector<memreg::Usage>& usage) -> void {
+    const QString group(trackDatabase ? "Tracks" : "Airways");
+    usage.append(memreg::usage(group, "Map", airwayCache.objectCount(), sizeof(map::MapAirway)));
+    usage.append(memreg::usage(group, "Geometry", airwayPolylines.size(), 10 * sizeof(atools::geo::Pos)));
+    usage.append(memreg::cacheUsage(group, "By name", airwayByNameCache, 20 * sizeof(map::MapAirway)));
+    usage.append(memreg::cacheUsage(group, "Nearest", nearestNavaidCache, 2048));
+  }, [this]() -> void {
+    clearCache();
+  });
 }
 
 AirwayQuery::~AirwayQuery()
 {
+  MemoryRegistry::unregisterCaches(this);
   deInitQueries();
   delete mapTypesFactory;
 }
@@ -280,6 +301,80 @@ const QList<map::MapAirway> *AirwayQuery::getAirways(const GeoDataLatLonBox& rec
   return &airwayCache.list;
 }
 
+const QVector<map::MapAirwayPolyline> *AirwayQuery::getAirwayPolylines()
+{
+  if(!airwayPolylinesLoaded && !trackDatabase && airwayByRectQuery != nullptr)
+    loadAirwayPolylines();
+  return &airwayPolylines;
+}
+
+int AirwayQuery::airwayPolylineLevel(float degreesPerPixel)
+{
+  int level = 0;
+  for(int i = 1; i < AIRWAY_POLYLINE_NUM_LEVELS; i++)
+  {
+    if(AIRWAY_POLYLINE_TOLERANCES_DEG[i] <= degreesPerPixel)
+      level = i;
+  }
+  return level;
+}
+
+void AirwayQuery::loadAirwayPolylines()
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  airwayPolylinesLoaded = true;
+  airwayPolylines.clear();
+
+  SqlQuery query(dbNav);
+  query.exec("select " + queryBase + " from " + airwayTable + " order by " + airwayNameCol + ", " + prefix +
+             "fragment_no, sequence_no");
+
+  map::MapAirway last;
+  atools::geo::LineString line;
+  int numSegments = 0;
+
+  // Add collected line as new polyline with all simplification levels
+  auto appendLine = [this, &line, &last]() -> void {
+                      if(line.size() >= 2)
+                      {
+                        map::MapAirwayPolyline polyline;
+                        polyline.type = last.type;
+                        polyline.bounding = line.boundingRect();
+                        polyline.levels.append(line);
+                        for(int i = 1; i < AIRWAY_POLYLINE_NUM_LEVELS; i++)
+                          polyline.levels.append(maptools::simplifyLine(line, AIRWAY_POLYLINE_TOLERANCES_DEG[i]));
+                        airwayPolylines.append(polyline);
+                      }
+                      line.clear();
+                    };
+
+  while(query.next())
+  {
+    map::MapAirway airway;
+    mapTypesFactory->fillAirwayOrTrack(query.record(), airway, false /* track */);
+    if(!airway.from.isValid() || !airway.to.isValid())
+      continue;
+
+    // Start a new line if not connected to the previous segment of the same airway fragment
+    if(line.isEmpty() || airway.name != last.name || airway.fragment != last.fragment || airway.type != last.type ||
+       !airway.from.almostEqual(last.to))
+    {
+      appendLine();
+      line.append(airway.from);
+    }
+
+    line.append(airway.to);
+    last = airway;
+    numSegments++;
+  }
+  appendLine();
+
+  qDebug() << Q_FUNC_INFO << "Merged" << numSegments << "airway segments into" << airwayPolylines.size()
+           << "polylines in" << timer.elapsed() << "ms";
+}
+
 void AirwayQuery::initQueries()
 {
   airwayTable = trackDatabase ? "track" : "airway";
@@ -289,7 +384,7 @@ void AirwayQuery::initQueries()
   waypointTable = trackDatabase ? "trackpoint" : "waypoint";
   prefix = trackDatabase ? "track_" : "airway_";
 
-  QString queryBase, waypointQueryBase;
+  QString waypointQueryBase;
 
   if(trackDatabase)
   {
@@ -406,6 +501,8 @@ void AirwayQuery::deInitQueries()
 
 void AirwayQuery::clearCache()
 {
+  airwayPolylines.clear();
+  airwayPolylinesLoaded = false;
   airwayCache.clear();
   airwayByNameCache.clear();
   nearestNavaidCache.clear();
@@ -94,6 +94,13 @@ public:
    * if they have to be kept between event loop calls. */
   const QList<map::MapAirway> *getAirways(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, bool lazy);
 
+  /* Get all airways merged into polylines per name and fragment. Built once from the airway table on first call
+   * and kept until the cache is cleared. Always empty for the track database. */
+  const QVector<map::MapAirwayPolyline> *getAirwayPolylines();
+
+  /* Index into MapAirwayPolyline::levels giving a simplification error below one pixel */
+  static int airwayPolylineLevel(float degreesPerPixel);
+
   /* Close all query objects thus disconnecting from the database */
   void initQueries();
 
@@ -105,6 +112,9 @@ public:
 private:
   map::MapWaypoint waypointById(int id);
 
+  /* Load all airway segments and merge consecutive ones into airwayPolylines */
+  void loadAirwayPolylines();
+
   MapTypesFactory *mapTypesFactory;
   atools::sql::SqlDatabase *dbNav;
 
@@ -117,6 +127,10 @@ private:
   /* Caches airway by name query which is called quite often. key is {airwayName, waypoint1, waypoint2} */
   QCache<QStringList, QList<map::MapAirway> > airwayByNameCache;
 
+  /* All airways merged and simplified for low zoom painting */
+  QVector<map::MapAirwayPolyline> airwayPolylines;
+  bool airwayPolylinesLoaded = false;
+
   /* true if this uses the track database (PACOTS, NAT, etc.) */
   bool trackDatabase;
 
@@ -130,7 +144,7 @@ private:
                         *airwayWaypointsQuery = nullptr, *airwayByNameQuery = nullptr, *airwayFullQuery = nullptr;
 
   /* Table and id column names depending on database type */
-  QString airwayIdCol, airwayNameCol, airwayTable, waypointIdCol, waypointTable, prefix;
+  QString airwayIdCol, airwayNameCol, airwayTable, waypointIdCol, waypointTable, prefix, queryBase;
 };
 
 #endif // LITTLENAVMAP_AIRWAYQUERY_H
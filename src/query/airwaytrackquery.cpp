@@ -28,6 +28,7 @@ using namespace atools::geo;
 AirwayTrackQuery::AirwayTrackQuery(AirwayQuery *airwayQueryParam, AirwayQuery *trackQueryParam)
   : airwayQuery(airwayQueryParam), trackQuery(trackQueryParam)
 {
+  initCaches();
 }
 
 AirwayTrackQuery::~AirwayTrackQuery()
@@ -45,29 +46,69 @@ void AirwayTrackQuery::getAirwaysForWaypoint(QList<map::MapAirway>& airways, int
 void AirwayTrackQuery::getAirwaysForWaypoints(QList<map::MapAirway>& airways, int waypointId1, int waypointId2,
                                               const QString& airwayName)
 {
-  if(useTracks)
-    trackQuery->getAirwaysForWaypoints(airways, waypointId1, waypointId2, airwayName);
+  checkTrackRevision();
+
+  const QStringList key({QString::number(waypointId1), QString::number(waypointId2), airwayName});
+  QList<map::MapAirway> *airwaysObj = airwaysForWaypointsCache.object(key);
+  if(airwaysObj != nullptr)
+    // Copy airways from cache
+    airways.append(*airwaysObj);
+  else
+  {
+    airwaysObj = new QList<map::MapAirway>;
+    if(useTracks)
+      trackQuery->getAirwaysForWaypoints(*airwaysObj, waypointId1, waypointId2, airwayName);
+    airwayQuery->getAirwaysForWaypoints(*airwaysObj, waypointId1, waypointId2, airwayName);
 
-  airwayQuery->getAirwaysForWaypoints(airways, waypointId1, waypointId2, airwayName);
+    airways.append(*airwaysObj);
+    airwaysForWaypointsCache.insert(key, airwaysObj);
+  }
 }
 
 void AirwayTrackQuery::getWaypointsForAirway(QList<map::MapWaypoint>& waypoints, const QString& airwayName,
                                              const QString& waypointIdent)
 {
-  if(useTracks)
-    trackQuery->getWaypointsForAirway(waypoints, airwayName, waypointIdent);
-  airwayQuery->getWaypointsForAirway(waypoints, airwayName, waypointIdent);
+  checkTrackRevision();
+
+  const QStringList key({airwayName, waypointIdent});
+  QList<map::MapWaypoint> *waypointsObj = waypointsForAirwayCache.object(key);
+  if(waypointsObj != nullptr)
+    waypoints.append(*waypointsObj);
+  else
+  {
+    waypointsObj = new QList<map::MapWaypoint>;
+    if(useTracks)
+      trackQuery->getWaypointsForAirway(*waypointsObj, airwayName, waypointIdent);
+    airwayQuery->getWaypointsForAirway(*waypointsObj, airwayName, waypointIdent);
+
+    waypoints.append(*waypointsObj);
+    waypointsForAirwayCache.insert(key, waypointsObj);
+  }
   maptools::removeDuplicatesById(waypoints);
 }
 
 void AirwayTrackQuery::getWaypointListForAirwayName(QList<map::MapAirwayWaypoint>& waypoints, const QString& airwayName,
                                                     int airwayFragment)
 {
-  if(useTracks)
-    trackQuery->getWaypointListForAirwayName(waypoints, airwayName, airwayFragment);
+  checkTrackRevision();
+
+  const QStringList key({airwayName, QString::number(airwayFragment)});
+  QList<map::MapAirwayWaypoint> *waypointsObj = waypointListForAirwayNameCache.object(key);
+  if(waypointsObj != nullptr)
+    waypoints.append(*waypointsObj);
+  else
+  {
+    waypointsObj = new QList<map::MapAirwayWaypoint>;
+    if(useTracks)
+      trackQuery->getWaypointListForAirwayName(*waypointsObj, airwayName, airwayFragment);
+
+    // Tracks override airways having the same name
+    if(waypointsObj->isEmpty())
+      airwayQuery->getWaypointListForAirwayName(*waypointsObj, airwayName, airwayFragment);
 
-  if(waypoints.isEmpty())
-    airwayQuery->getWaypointListForAirwayName(waypoints, airwayName, airwayFragment);
+    waypoints.append(*waypointsObj);
+    waypointListForAirwayNameCache.insert(key, waypointsObj);
+  }
 }
 
 void AirwayTrackQuery::getAirwayFull(QList<map::MapAirway>& airways, const QString& airwayName, int fragment)
@@ -117,10 +158,22 @@ void AirwayTrackQuery::getAirwaysByNameAndWaypoint(QList<map::MapAirway>& airway
   if(airwayName.isEmpty() || waypoint1.isEmpty())
     return;
 
-  if(useTracks)
-    trackQuery->getAirwaysByNameAndWaypoint(airways, airwayName, waypoint1, waypoint2);
+  checkTrackRevision();
+
+  const QStringList key({airwayName, waypoint1, waypoint2});
+  QList<map::MapAirway> *airwaysObj = airwaysByNameAndWaypointCache.object(key);
+  if(airwaysObj != nullptr)
+    airways.append(*airwaysObj);
+  else
+  {
+    airwaysObj = new QList<map::MapAirway>;
+    if(useTracks)
+      trackQuery->getAirwaysByNameAndWaypoint(*airwaysObj, airwayName, waypoint1, waypoint2);
+    airwayQuery->getAirwaysByNameAndWaypoint(*airwaysObj, airwayName, waypoint1, waypoint2);
 
-  airwayQuery->getAirwaysByNameAndWaypoint(airways, airwayName, waypoint1, waypoint2);
+    airways.append(*airwaysObj);
+    airwaysByNameAndWaypointCache.insert(key, airwaysObj);
+  }
 }
 
 bool AirwayTrackQuery::hasAirwayForNameAndWaypoint(const QString& airwayName, const QString& waypoint1,
@@ -131,6 +184,11 @@ bool AirwayTrackQuery::hasAirwayForNameAndWaypoint(const QString& airwayName, co
   return !airways.isEmpty();
 }
 
+const QVector<map::MapAirwayPolyline> *AirwayTrackQuery::getAirwayPolylines()
+{
+  return airwayQuery->getAirwayPolylines();
+}
+
 void AirwayTrackQuery::getAirways(QList<map::MapAirway>& airways, const GeoDataLatLonBox& rect,
                                   const MapLayer *mapLayer, bool lazy)
 {
@@ -161,15 +219,46 @@ void AirwayTrackQuery::initQueries()
 
 void AirwayTrackQuery::deInitQueries()
 {
+  clearMergedCache();
   trackQuery->deInitQueries();
   airwayQuery->deInitQueries();
 }
 
 void AirwayTrackQuery::clearCache()
 {
+  clearMergedCache();
   trackQuery->clearCache();
 }
 
+void AirwayTrackQuery::initCaches()
+{
+  airwaysForWaypointsCache.setMaxCost(1000);
+  airwaysByNameAndWaypointCache.setMaxCost(1000);
+  waypointsForAirwayCache.setMaxCost(1000);
+  waypointListForAirwayNameCache.setMaxCost(500);
+}
+
+void AirwayTrackQuery::clearMergedCache()
+{
+  airwaysForWaypointsCache.clear();
+  airwaysByNameAndWaypointCache.clear();
+  waypointsForAirwayCache.clear();
+  waypointListForAirwayNameCache.clear();
+  cacheTrackRevision = query::revision(query::REV_TRACKS);
+}
+
+void AirwayTrackQuery::checkTrackRevision()
+{
+  if(cacheTrackRevision != query::revision(query::REV_TRACKS))
+    clearMergedCache();
+}
+
+void AirwayTrackQuery::initTrackQueries()
+{
+  clearMergedCache();
+  trackQuery->initQueries();
+}
+
 void AirwayTrackQuery::deleteChildren()
 {
   ATOOLS_DELETE(trackQuery);
@@ -20,6 +20,8 @@
 
 #include "query/querytypes.h"
 
+#include <QCache>
+
 namespace atools {
 namespace geo {
 class Rect;
@@ -52,15 +54,17 @@ public:
 
   AirwayTrackQuery(const AirwayTrackQuery& other)
   {
+    initCaches();
     this->operator=(other);
   }
 
-  /* Does a shallow copy. Query classes are not owned by this */
+  /* Does a shallow copy. Query classes are not owned by this. Merged result caches are not copied. */
   AirwayTrackQuery& operator=(const AirwayTrackQuery& other)
   {
     airwayQuery = other.airwayQuery;
     trackQuery = other.trackQuery;
     useTracks = other.useTracks;
+    clearMergedCache();
     return *this;
   }
 
@@ -103,6 +107,9 @@ public:
   void getTracks(QList<map::MapAirway>& airways, const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer,
                  bool lazy);
 
+  /* Airways of the navigation database merged into simplified polylines for painting at low zoom levels */
+  const QVector<map::MapAirwayPolyline> *getAirwayPolylines();
+
   /* Close all query objects thus disconnecting from the database */
   void initQueries();
 
@@ -112,10 +119,15 @@ public:
   /* Tracks loaded - clear caches */
   void clearCache();
 
+  /* Tracks loaded - prepare only the track queries again. Queries and caches for the
+   * nav database are not touched and stay warm. */
+  void initTrackQueries();
+
   /* Set to false to ignore track database. Create a copy of this before using this method. */
   void setUseTracks(bool value)
   {
     useTracks = value;
+    clearMergedCache();
   }
 
   bool isUseTracks() const
@@ -127,8 +139,25 @@ public:
   void deleteChildren();
 
 private:
+  void initCaches();
+
+  /* Clear caches holding merged track and airway results */
+  void clearMergedCache();
+
+  /* Clear merged caches if tracks were loaded or deleted since last call */
+  void checkTrackRevision();
+
   AirwayQuery *airwayQuery = nullptr, *trackQuery = nullptr;
   bool useTracks = true;
+
+  /* Merged results of track and airway queries which are called often by route string parsing and
+   * route calculation. Key contains the query parameters. */
+  QCache<QStringList, QList<map::MapAirway> > airwaysForWaypointsCache, airwaysByNameAndWaypointCache;
+  QCache<QStringList, QList<map::MapWaypoint> > waypointsForAirwayCache;
+  QCache<QStringList, QList<map::MapAirwayWaypoint> > waypointListForAirwayNameCache;
+
+  /* Track revision at the time the merged caches were filled */
+  quint32 cacheTrackRevision = 0;
 };
 
 #endif // LITTLENAVMAP_AIRWAYTRACKQUERY_H
@@ -20,6 +20,8 @@
 #include "common/constants.h"
 #include "app/navapp.h"
 #include "common/maptools.h"
+#include "common/memoryregistry.h"
+#include "db/statementcache.h"
 #include "query/querytypes.h"
 #include "settings/settings.h"
 #include "sql/sqldatabase.h"
@@ -33,9 +35,14 @@ using atools::sql::SqlRecord;
 using atools::sql::SqlRecordList;
 using atools::sql::SqlUtil;
 
+/* Estimated average size of a cached record and a record list for memory accounting */
+static const qint64 RECORD_BYTES = 2048L;
+static const qint64 RECORD_LIST_BYTES = 8192L;
+
 InfoQuery::InfoQuery(SqlDatabase *sqlDbSim, atools::sql::SqlDatabase *sqlDbNav, atools::sql::SqlDatabase *sqlDbTrack)
   : dbSim(sqlDbSim), dbNav(sqlDbNav), dbTrack(sqlDbTrack)
 {
+  statementsTrack = new StatementCache(dbTrack, 4);
   atools::settings::Settings& settings = atools::settings::Settings::instance();
   airportCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_INFOQUERY + "AirportCache", 100).toInt());
   vorCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_INFOQUERY + "VorCache", 100).toInt());
@@ -50,11 +57,32 @@ InfoQuery::InfoQuery(SqlDatabase *sqlDbSim, atools::sql::SqlDatabase *sqlDbNav,
   approachCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_INFOQUERY + "ApproachCache", 100).toInt());
   transitionCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_INFOQUERY + "TransitionCache", 100).toInt());
   airportSceneryCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_INFOQUERY + "AirportSceneryCache", 100).toInt());
+
+  MemoryRegistry::registerCaches(this, [this](QVector<memreg::Usage>& usage) -> void {
+    const QString group("Information");
+    usage.append(memreg::cacheUsage(group, "Airports", airportCache, RECORD_BYTES));
+    usage.append(memreg::cacheUsage(group, "VOR", vorCache, RECORD_BYTES));
+    usage.append(memreg::cacheUsage(group, "NDB", ndbCache, RECORD_BYTES));
+    usage.append(memreg::cacheUsage(group, "MSA", msaCache, RECORD_BYTES));
+    usage.append(memreg::cacheUsage(group, "Holdings", holdingCache, RECORD_BYTES));
+    usage.append(memreg::cacheUsage(group, "Runway ends", runwayEndCache, RECORD_BYTES));
+    usage.append(memreg::cacheUsage(group, "COM", comCache, RECORD_LIST_BYTES));
+    usage.append(memreg::cacheUsage(group, "Runways", runwayCache, RECORD_LIST_BYTES));
+    usage.append(memreg::cacheUsage(group, "Helipads", helipadCache, RECORD_LIST_BYTES));
+    usage.append(memreg::cacheUsage(group, "Start positions", startCache, RECORD_LIST_BYTES));
+    usage.append(memreg::cacheUsage(group, "Procedures", approachCache, RECORD_LIST_BYTES));
+    usage.append(memreg::cacheUsage(group, "Transitions", transitionCache, RECORD_LIST_BYTES));
+    usage.append(memreg::cacheUsage(group, "Airport scenery", airportSceneryCache, RECORD_LIST_BYTES));
+  }, [this]() -> void {
+    clearCache();
+  });
 }
 
 InfoQuery::~InfoQuery()
 {
+  MemoryRegistry::unregisterCaches(this);
   deInitQueries();
+  delete statementsTrack;
 }
 
 const SqlRecord *InfoQuery::getAirportInformation(int airportId)
@@ -246,14 +274,16 @@ const SqlRecord *InfoQuery::getHoldingInformation(int holdingId)
 
 atools::sql::SqlRecord InfoQuery::getTrackMetadata(int trackId)
 {
-  SqlQuery query(dbTrack);
-  query.prepare("select m.* from track t join trackmeta m on t.trackmeta_id = m.trackmeta_id where track_id = :id");
-  query.bindValue(":id", trackId);
-  query.exec();
-  if(query.next())
-    return query.record();
-  else
-    return SqlRecord();
+  SqlQuery *query = statementsTrack->query("select m.* from track t join trackmeta m on t.trackmeta_id = m.trackmeta_id "
+                                           "where track_id = :id");
+  query->bindValue(":id", trackId);
+  statementsTrack->exec(query);
+
+  SqlRecord rec;
+  if(query->next())
+    rec = query->record();
+  query->finish();
+  return rec;
 }
 
 void InfoQuery::initQueries()
@@ -344,7 +374,7 @@ void InfoQuery::initQueries()
   transitionQuery->prepare("select * from transition where approach_id = :id order by fix_ident");
 }
 
-void InfoQuery::deInitQueries()
+void InfoQuery::clearCache()
 {
   airportCache.clear();
   vorCache.clear();
@@ -359,6 +389,12 @@ void InfoQuery::deInitQueries()
   approachCache.clear();
   transitionCache.clear();
   airportSceneryCache.clear();
+}
+
+void InfoQuery::deInitQueries()
+{
+  statementsTrack->clear();
+  clearCache();
 
   ATOOLS_DELETE(airportQuery);
   ATOOLS_DELETE(airportSceneryQuery);
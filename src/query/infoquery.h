@@ -34,6 +34,8 @@ class SqlRecord;
 }
 }
 
+class StatementCache;
+
 /*
  * Database queries for the info controller. Does not return objects but sql records. Records are cached.
  */
@@ -99,6 +101,9 @@ public:
   /* Delete all queries */
   void deInitQueries();
 
+  /* Drop all cached records */
+  void clearCache();
+
 private:
   /* Caches */
   QCache<int, atools::sql::SqlRecord> airportCache, vorCache, ndbCache, runwayEndCache, msaCache, holdingCache;
@@ -110,6 +115,9 @@ private:
 
   atools::sql::SqlDatabase *dbSim, *dbNav, *dbTrack;
 
+  /* Statements for the track database which is replaced on each download */
+  StatementCache *statementsTrack;
+
   /* Prepared database queries */
   atools::sql::SqlQuery *airportQuery = nullptr, *airportSceneryQuery = nullptr, *vorQuery = nullptr, *msaQuery = nullptr,
                         *holdingQuery = nullptr, *ndbQuery = nullptr, *comQuery = nullptr, *runwayQuery = nullptr,
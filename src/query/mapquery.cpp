@@ -18,10 +18,15 @@
 #include "query/mapquery.h"
 
 #include "airspace/airspacecontroller.h"
+#include "atools.h"
 #include "common/constants.h"
 #include "common/mapresult.h"
 #include "common/maptools.h"
+#include "common/memoryregistry.h"
 #include "common/maptypesfactory.h"
+#include "db/databasepool.h"
+#include "db/statementcache.h"
+#include "exception.h"
 #include "fs/util/fsutil.h"
 #include "logbook/logdatacontroller.h"
 #include "mapgui/mapairporthandler.h"
@@ -30,6 +35,7 @@
 #include "online/onlinedatacontroller.h"
 #include "query/airportquery.h"
 #include "query/airwaytrackquery.h"
+#include "query/spatialindex.h"
 #include "query/waypointtrackquery.h"
 #include "settings/settings.h"
 #include "sql/sqldatabase.h"
@@ -73,21 +79,122 @@ static QLatin1String AIRPORTIDENT_FROM_NDB("select a.ident, n.lonx, n.laty "
                                            "order by (abs(n.lonx - :lonx) + abs(n.laty - :laty)) limit 1");
 static float MAX_AIRPORT_IDENT_DISTANCE_M = atools::geo::nmToMeter(5.f);
 
+/* Tiles shared between all MapQuery instances. Only accessed in the GUI thread. */
+struct MapQueryTiles
+{
+  MapQueryTiles()
+  {
+    // Maximum approximate size of tile caches per type in kB
+    int maxSizeKb = atools::settings::Settings::instance().getAndStoreValue(lnm::SETTINGS_MAPQUERY + "TileCacheKb",
+                                                                            32768).toInt();
+    airports.tiles.setMaxCost(maxSizeKb);
+    vors.tiles.setMaxCost(maxSizeKb);
+    ndbs.tiles.setMaxCost(maxSizeKb);
+    markers.tiles.setMaxCost(maxSizeKb);
+    holdings.tiles.setMaxCost(maxSizeKb);
+    ils.tiles.setMaxCost(maxSizeKb);
+    airportMsa.tiles.setMaxCost(maxSizeKb);
+
+    // Tiles can be dropped any time - the lists for the current views stay valid
+    MemoryRegistry::registerCaches(this, [this](QVector<memreg::Usage>& usage) -> void {
+      const QString group("Map object tiles");
+      usage.append({group, "Airports", airports.tiles.totalCost() * 1024L, airports.tiles.size()});
+      usage.append({group, "VOR", vors.tiles.totalCost() * 1024L, vors.tiles.size()});
+      usage.append({group, "NDB", ndbs.tiles.totalCost() * 1024L, ndbs.tiles.size()});
+      usage.append({group, "Marker", markers.tiles.totalCost() * 1024L, markers.tiles.size()});
+      usage.append({group, "Holdings", holdings.tiles.totalCost() * 1024L, holdings.tiles.size()});
+      usage.append({group, "ILS", ils.tiles.totalCost() * 1024L, ils.tiles.size()});
+      usage.append({group, "MSA", airportMsa.tiles.totalCost() * 1024L, airportMsa.tiles.size()});
+    }, [this]() -> void {
+      airports.tiles.clear();
+      vors.tiles.clear();
+      ndbs.tiles.clear();
+      markers.tiles.clear();
+      holdings.tiles.clear();
+      ils.tiles.clear();
+      airportMsa.tiles.clear();
+    });
+  }
+
+  ~MapQueryTiles()
+  {
+    MemoryRegistry::unregisterCaches(this);
+  }
+
+  query::TileStore<map::MapAirport> airports;
+  query::TileStore<map::MapVor> vors;
+  query::TileStore<map::MapNdb> ndbs;
+  query::TileStore<map::MapMarker> markers;
+  query::TileStore<map::MapHolding> holdings;
+  query::TileStore<map::MapIls> ils;
+  query::TileStore<map::MapAirportMsa> airportMsa;
+};
+
+/* Deleted with the last MapQuery instance */
+static QWeakPointer<MapQueryTiles> sharedTiles;
+
 MapQuery::MapQuery(atools::sql::SqlDatabase *sqlDbSim, SqlDatabase *sqlDbNav, SqlDatabase *sqlDbUser)
   : dbSim(sqlDbSim), dbNav(sqlDbNav), dbUser(sqlDbUser)
 {
   mapTypesFactory = new MapTypesFactory();
+  statementsNav = new StatementCache(dbNav);
   atools::settings::Settings& settings = atools::settings::Settings::instance();
 
   runwayOverwiewCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "RunwayOverwiewCache", 1000).toInt());
   queryRectInflationFactor = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "QueryRectInflationFactor", 0.5).toDouble();
   queryRectInflationIncrement = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "QueryRectInflationIncrement", 0.5).toDouble();
   queryMaxRows = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "MapQueryRowLimit", map::MAX_MAP_OBJECTS).toInt();
+
+  // Attach to tiles of other instances or create them if this is the first one
+  tiles = sharedTiles.toStrongRef();
+  if(tiles.isNull())
+  {
+    tiles = QSharedPointer<MapQueryTiles>::create();
+    sharedTiles = tiles;
+  }
+
+  airportCache.setStore(&tiles->airports);
+  vorCache.setStore(&tiles->vors);
+  ndbCache.setStore(&tiles->ndbs);
+  markerCache.setStore(&tiles->markers);
+  holdingCache.setStore(&tiles->holdings);
+  ilsCache.setStore(&tiles->ils);
+  airportMsaCache.setStore(&tiles->airportMsa);
+
+  // Shared tiles are registered by MapQueryTiles
+  MemoryRegistry::registerCaches(this, [this](QVector<memreg::Usage>& usage) -> void {
+    const QString group("Map objects");
+    usage.append(memreg::usage(group, "Airports", airportCache.objectCount(), sizeof(map::MapAirport)));
+    usage.append(memreg::usage(group, "VOR", vorCache.objectCount(), sizeof(map::MapVor)));
+    usage.append(memreg::usage(group, "NDB", ndbCache.objectCount(), sizeof(map::MapNdb)));
+    usage.append(memreg::usage(group, "Marker", markerCache.objectCount(), sizeof(map::MapMarker)));
+    usage.append(memreg::usage(group, "Holdings", holdingCache.objectCount(), sizeof(map::MapHolding)));
+    usage.append(memreg::usage(group, "ILS", ilsCache.objectCount(), sizeof(map::MapIls)));
+    usage.append(memreg::usage(group, "MSA", airportMsaCache.objectCount(), sizeof(map::MapAirportMsa)));
+    usage.append(memreg::usage(group, "Userpoints", userpointCache.objectCount(), sizeof(map::MapUserpoint)));
+    usage.append(memreg::cacheUsage(group, "Runway overview", runwayOverwiewCache, 4 * sizeof(map::MapRunway)));
+    usage.append(memreg::cacheUsage(group, "Nearest", nearestNavaidCache, 2048));
+  }, [this]() -> void {
+    runwayOverwiewCache.clear();
+    nearestNavaidCache.clear();
+  });
 }
 
 MapQuery::~MapQuery()
 {
+  MemoryRegistry::unregisterCaches(this);
+
+  // Detach from shared tiles which stay valid for other instances - otherwise deInitQueries() would clear these
+  airportCache.setStore(nullptr);
+  vorCache.setStore(nullptr);
+  ndbCache.setStore(nullptr);
+  markerCache.setStore(nullptr);
+  holdingCache.setStore(nullptr);
+  ilsCache.setStore(nullptr);
+  airportMsaCache.setStore(nullptr);
+
   deInitQueries();
+  delete statementsNav;
   delete mapTypesFactory;
 }
 
@@ -410,7 +517,18 @@ void MapQuery::mapObjectByIdentInternal(map::MapResult& result, map::MapTypes ty
     maptools::removeByDistance(result.airportMsa, sortByDistancePos, maxDistanceMeter);
   }
 
-  if(type & map::VOR && query::valid(Q_FUNC_INFO, vorByIdentQuery))
+  if(type & map::VOR && identBatch.contains(ident))
+  {
+    // Take VORs from previously loaded batch
+    for(auto it = vorIdentBatch.constFind(ident); it != vorIdentBatch.constEnd() && it.key() == ident; ++it)
+    {
+      if(region.isEmpty() || it.value().region.compare(region, Qt::CaseInsensitive) == 0)
+        result.vors.append(it.value());
+    }
+    maptools::sortByDistance(result.vors, sortByDistancePos);
+    maptools::removeByDistance(result.vors, sortByDistancePos, maxDistanceMeter);
+  }
+  else if(type & map::VOR && query::valid(Q_FUNC_INFO, vorByIdentQuery))
   {
     vorByIdentQuery->bindValue(":ident", ident);
     vorByIdentQuery->bindValue(":region", region.isEmpty() ? "%" : region);
@@ -425,7 +543,18 @@ void MapQuery::mapObjectByIdentInternal(map::MapResult& result, map::MapTypes ty
     maptools::removeByDistance(result.vors, sortByDistancePos, maxDistanceMeter);
   }
 
-  if(type & map::NDB && query::valid(Q_FUNC_INFO, ndbByIdentQuery))
+  if(type & map::NDB && identBatch.contains(ident))
+  {
+    // Take NDBs from previously loaded batch
+    for(auto it = ndbIdentBatch.constFind(ident); it != ndbIdentBatch.constEnd() && it.key() == ident; ++it)
+    {
+      if(region.isEmpty() || it.value().region.compare(region, Qt::CaseInsensitive) == 0)
+        result.ndbs.append(it.value());
+    }
+    maptools::sortByDistance(result.ndbs, sortByDistancePos);
+    maptools::removeByDistance(result.ndbs, sortByDistancePos, maxDistanceMeter);
+  }
+  else if(type & map::NDB && query::valid(Q_FUNC_INFO, ndbByIdentQuery))
   {
     ndbByIdentQuery->bindValue(":ident", ident);
     ndbByIdentQuery->bindValue(":region", region.isEmpty() ? "%" : region);
@@ -474,6 +603,71 @@ void MapQuery::mapObjectByIdentInternal(map::MapResult& result, map::MapTypes ty
     NavApp::getAirwayTrackQueryGui()->getAirwaysByName(result.airways, ident);
 }
 
+void MapQuery::loadIdentBatch(const QStringList& idents)
+{
+  // Number of idents per statement - unused placeholders are bound to an empty string to allow statement reuse
+  const static int CHUNK_SIZE = 64;
+  static QString placeholders;
+  if(placeholders.isEmpty())
+  {
+    QStringList list;
+    for(int i = 0; i < CHUNK_SIZE; i++)
+      list.append(":ident" + QString::number(i));
+    placeholders = list.join(", ");
+  }
+
+  clearIdentBatch();
+
+  // Collect valid and unique idents
+  QStringList uniqueIdents;
+  for(const QString& ident : idents)
+  {
+    if(!ident.isEmpty() && !identBatch.contains(ident))
+    {
+      identBatch.insert(ident);
+      uniqueIdents.append(ident);
+    }
+  }
+
+  for(int start = 0; start < uniqueIdents.size(); start += CHUNK_SIZE)
+  {
+    // VOR ==================================
+    SqlQuery *query = statementsNav->query(vorsByIdentsSql.arg(placeholders));
+    for(int i = 0; i < CHUNK_SIZE; i++)
+      query->bindValue(":ident" + QString::number(i), uniqueIdents.value(start + i));
+
+    statementsNav->exec(query);
+    while(query->next())
+    {
+      MapVor vor;
+      mapTypesFactory->fillVor(query->record(), vor);
+      vorIdentBatch.insert(vor.ident, vor);
+    }
+    query->finish();
+
+    // NDB ==================================
+    query = statementsNav->query(ndbsByIdentsSql.arg(placeholders));
+    for(int i = 0; i < CHUNK_SIZE; i++)
+      query->bindValue(":ident" + QString::number(i), uniqueIdents.value(start + i));
+
+    statementsNav->exec(query);
+    while(query->next())
+    {
+      MapNdb ndb;
+      mapTypesFactory->fillNdb(query->record(), ndb);
+      ndbIdentBatch.insert(ndb.ident, ndb);
+    }
+    query->finish();
+  }
+}
+
+void MapQuery::clearIdentBatch()
+{
+  identBatch.clear();
+  vorIdentBatch.clear();
+  ndbIdentBatch.clear();
+}
+
 void MapQuery::getMapObjectById(map::MapResult& result, map::MapTypes type, map::MapAirspaceSources src, int id,
                                 bool airportFromNavDatabase) const
 {
@@ -856,45 +1050,60 @@ void MapQuery::getNearestScreenObjects(const CoordinateConverter& conv, const Ma
   }
 }
 
+/* Query parameters for airport tiles. Includes the GUI filter since tiles are filtered when loading. */
+static quint32 airportTileParams(const MapLayer *mapLayer, bool addon, bool normal, int minRunwayFt, map::MapTypes filterTypes)
+{
+  return query::rectCacheTileParams({mapLayer->getMinRunwayLength(), mapLayer->isAirportMinor(), addon, normal, minRunwayFt,
+                                     static_cast<int>(::qHash(filterTypes.asFlagType()))});
+}
+
 const QList<map::MapAirport> *MapQuery::getAirports(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, bool lazy,
                                                     map::MapTypes types, bool& overflow)
 {
+  if(!query::valid(Q_FUNC_INFO, airportByRectQuery))
+    return nullptr;
+
   // Get flags for running separate queries for add-on and normal airports
   bool addon = types.testFlag(map::AIRPORT_ADDON);
   bool normal = types & map::AIRPORT_ALL;
 
+  // Filter from GUI which is applied in the query and when filling tiles - not in the painter
+  int minRunwayFt = NavApp::getMapAirportHandler()->getMinimumRunwayFt();
+  map::MapTypes filterTypes = types & map::AIRPORT_ALL_AND_ADDON;
+
   airportCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                           [this, addon, normal](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
+                           airportTileParams(mapLayer, addon, normal, minRunwayFt, filterTypes),
+                           [this, mapLayer, addon, normal, minRunwayFt, filterTypes](const GeoDataLatLonBox& tileRect,
+                                                                                     QList<MapAirport>& airports) -> void
   {
-    return curLayer->hasSameQueryParametersAirport(newLayer) &&
-    // Invalidate cache if settings differ
-    airportCacheAddonFlag == addon && airportCacheNormalFlag == normal;
+    // Add-on airports are fetched by a separate query without length limit
+    airportByRectQuery->bindValue(":minlength", std::max(mapLayer->getMinRunwayLength(), minRunwayFt));
+    fetchAirports(tileRect, airportByRectQuery, false /* overview */, addon, normal, airports);
+    filterAirports(airports, filterTypes, minRunwayFt, mapLayer);
   });
 
   airportCacheAddonFlag = addon;
   airportCacheNormalFlag = normal;
+  airportCacheMinRunwayFt = minRunwayFt;
+  airportCacheTypes = filterTypes;
+
+  overflow = airportCache.validate(queryMaxRows);
+  return &airportCache.list;
+}
 
-  airportByRectQuery->bindValue(":minlength", mapLayer->getMinRunwayLength());
-  return fetchAirports(rect, airportByRectQuery, lazy, false /* overview */, addon, normal, overflow);
+void MapQuery::filterAirports(QList<map::MapAirport>& airports, map::MapTypes types, int minRunwayFt, const MapLayer *mapLayer)
+{
+  airports.erase(std::remove_if(airports.begin(), airports.end(), [types, minRunwayFt, mapLayer](const MapAirport& airport) -> bool {
+    return !airport.isVisible(types, minRunwayFt, mapLayer);
+  }), airports.end());
 }
 
 const QList<map::MapAirport> *MapQuery::getAirportsByRect(const atools::geo::Rect& rect, const MapLayer *mapLayer, bool lazy,
                                                           map::MapTypes types, bool& overflow)
 {
-  if(!query::valid(Q_FUNC_INFO, airportByRectQuery))
-    return nullptr;
-
-  const GeoDataLatLonBox latLonBox = GeoDataLatLonBox(rect.getNorth(), rect.getSouth(), rect.getEast(), rect.getWest());
-
-  // Get flags for running separate queries for add-on and normal airports
-  bool addon = types.testFlag(map::AIRPORT_ADDON);
-  bool normal = types & map::AIRPORT_ALL;
-
-  airportCacheAddonFlag = addon;
-  airportCacheNormalFlag = normal;
-
-  airportByRectQuery->bindValue(":minlength", mapLayer->getMinRunwayLength());
-  return fetchAirports(latLonBox, airportByRectQuery, lazy, false /* overview */, addon, normal, overflow);
+  const GeoDataLatLonBox latLonBox = GeoDataLatLonBox(rect.getNorth(), rect.getSouth(), rect.getEast(),
+                                                      rect.getWest(), GeoDataCoordinates::Degree);
+  return getAirports(latLonBox, mapLayer, lazy, types, overflow);
 }
 
 const QList<map::MapVor> *MapQuery::getVors(const GeoDataLatLonBox& rect, const MapLayer *mapLayer,
@@ -904,25 +1113,19 @@ const QList<map::MapVor> *MapQuery::getVors(const GeoDataLatLonBox& rect, const
     return nullptr;
 
   vorCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                       [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
+                       query::rectCacheTileParams({mapLayer->isVor()}),
+                       [this](const GeoDataLatLonBox& tileRect, QList<MapVor>& vors) -> void
   {
-    return curLayer->hasSameQueryParametersVor(newLayer);
-  });
-
-  if(vorCache.list.isEmpty() && !lazy)
-  {
-    for(const GeoDataLatLonBox& r : query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
+    query::bindRect(tileRect, vorsByRectQuery);
+    vorsByRectQuery->exec();
+    while(vorsByRectQuery->next())
     {
-      query::bindRect(r, vorsByRectQuery);
-      vorsByRectQuery->exec();
-      while(vorsByRectQuery->next())
-      {
-        MapVor vor;
-        mapTypesFactory->fillVor(vorsByRectQuery->record(), vor);
-        vorCache.list.append(vor);
-      }
+      MapVor vor;
+      mapTypesFactory->fillVor(vorsByRectQuery->record(), vor);
+      vors.append(vor);
     }
-  }
+  });
+
   overflow = vorCache.validate(queryMaxRows);
   return &vorCache.list;
 }
@@ -940,25 +1143,19 @@ const QList<map::MapNdb> *MapQuery::getNdbs(const GeoDataLatLonBox& rect, const
     return nullptr;
 
   ndbCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                       [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
-  {
-    return curLayer->hasSameQueryParametersNdb(newLayer);
-  });
-
-  if(ndbCache.list.isEmpty() && !lazy)
+                       query::rectCacheTileParams({mapLayer->isNdb()}),
+                       [this](const GeoDataLatLonBox& tileRect, QList<MapNdb>& ndbs) -> void
   {
-    for(const GeoDataLatLonBox& r : query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
+    query::bindRect(tileRect, ndbsByRectQuery);
+    ndbsByRectQuery->exec();
+    while(ndbsByRectQuery->next())
     {
-      query::bindRect(r, ndbsByRectQuery);
-      ndbsByRectQuery->exec();
-      while(ndbsByRectQuery->next())
-      {
-        MapNdb ndb;
-        mapTypesFactory->fillNdb(ndbsByRectQuery->record(), ndb);
-        ndbCache.list.append(ndb);
-      }
+      MapNdb ndb;
+      mapTypesFactory->fillNdb(ndbsByRectQuery->record(), ndb);
+      ndbs.append(ndb);
     }
-  }
+  });
+
   overflow = ndbCache.validate(queryMaxRows);
   return &ndbCache.list;
 }
@@ -970,6 +1167,12 @@ const QList<map::MapNdb> *MapQuery::getNdbsByRect(const atools::geo::Rect& rect,
   return getNdbs(latLonBox, mapLayer, lazy, overflow);
 }
 
+bool MapQuery::UserpointCacheKey::operator==(const UserpointCacheKey& other) const
+{
+  return valid == other.valid && rect == other.rect && types == other.types && typesAll == other.typesAll &&
+         unknownType == other.unknownType && atools::almostEqual(distanceNm, other.distanceNm) && revision == other.revision;
+}
+
 const QList<map::MapUserpoint> MapQuery::getUserdataPoints(const GeoDataLatLonBox& rect, const QStringList& types,
                                                            const QStringList& typesAll, bool unknownType, float distanceNm)
 {
@@ -978,8 +1181,14 @@ const QList<map::MapUserpoint> MapQuery::getUserdataPoints(const GeoDataLatLonBo
   if(!query::valid(Q_FUNC_INFO, userdataPointByRectQuery))
     return retval;
 
-  // No caching here since points can change and the dataset is usually small
+  // Reuse last result if nothing changed - points are invalidated by the userpoint revision
+  UserpointCacheKey key = {rect, types, typesAll, unknownType, true /* valid */, distanceNm,
+                           query::revision(query::REV_USERPOINTS)};
+  if(key == userpointCacheKey)
+    return userpointCache.list;
+
   userpointCache.clear();
+  userpointCacheKey = key;
 
   // Display either unknown or any type
   if(unknownType || !types.isEmpty())
@@ -1027,6 +1236,112 @@ const QList<map::MapUserpoint> MapQuery::getUserdataPoints(const GeoDataLatLonBo
   return retval;
 }
 
+bool MapQuery::getUserdataPointClusters(QList<MapUserpoint>& userpoints, QList<map::MapUserpointCluster>& clusters,
+                                        const GeoDataLatLonBox& rect, const QStringList& types, const QStringList& typesAll,
+                                        bool unknownType, float distanceNm, float cellSizeDeg, int threshold)
+{
+  if(threshold <= 0 || cellSizeDeg <= 0.f || dbUser == nullptr || (!unknownType && types.isEmpty()))
+    return false;
+
+  // Build type filter with the same semantics as getUserdataPoints()
+  QStringList typeBinds, typeAllBinds;
+  for(int i = 0; i < types.size(); i++)
+    typeBinds.append(QString(":type%1").arg(i));
+  for(int i = 0; i < typesAll.size(); i++)
+    typeAllBinds.append(QString(":typeall%1").arg(i));
+
+  QString typeCond;
+  if(!unknownType)
+  {
+    typeCond = " and type in (" + typeBinds.join(", ") + ")";
+    typeAllBinds.clear();
+  }
+  else if(types != typesAll && !typesAll.isEmpty())
+  {
+    // Selected types or unknown types not contained in the list of all types
+    typeCond = " and (type not in (" + typeAllBinds.join(", ") + ")";
+    if(!typeBinds.isEmpty())
+      typeCond += " or type in (" + typeBinds.join(", ") + ")";
+    typeCond += ")";
+  }
+  else
+  {
+    // Show all including unknown
+    typeBinds.clear();
+    typeAllBinds.clear();
+  }
+
+  // Grid aligned to absolute coordinates to avoid jumping clusters when moving the map
+  static const QLatin1String whereRect("lonx between :leftx and :rightx and laty between :bottomy and :topy");
+  const QString where = "where " + whereRect + " and visible_from > :dist" + typeCond;
+  const QString cell("cast((lonx + 180.) / :cell as integer), cast((laty + 90.) / :cell as integer)");
+
+  SqlQuery countQuery(dbUser);
+  countQuery.prepare("select count(1) from userdata " + where);
+
+  SqlQuery clusterQuery(dbUser);
+  clusterQuery.prepare("select count(1) as num, avg(lonx) as lonx, avg(laty) as laty from userdata " + where +
+                       " group by " + cell + " having count(1) > 1");
+
+  SqlQuery singleQuery(dbUser);
+  singleQuery.prepare("select * from userdata where userdata_id in (select min(userdata_id) from userdata " + where +
+                      " group by " + cell + " having count(1) = 1)");
+
+  const QList<GeoDataLatLonBox> rects = query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement);
+
+  auto bindAll = [&](SqlQuery& sqlQuery, const GeoDataLatLonBox& r, bool bindCell) {
+                   query::bindRect(r, &sqlQuery);
+                   sqlQuery.bindValue(":dist", distanceNm);
+                   if(bindCell)
+                     sqlQuery.bindValue(":cell", cellSizeDeg);
+                   for(int i = 0; i < typeBinds.size(); i++)
+                     sqlQuery.bindValue(typeBinds.at(i), types.at(i));
+                   for(int i = 0; i < typeAllBinds.size(); i++)
+                     sqlQuery.bindValue(typeAllBinds.at(i), typesAll.at(i));
+                 };
+
+  // Count first to decide if aggregation is needed at all
+  int total = 0;
+  for(const GeoDataLatLonBox& r : rects)
+  {
+    bindAll(countQuery, r, false);
+    countQuery.exec();
+    if(countQuery.next())
+      total += countQuery.valueInt(0);
+  }
+
+  if(total <= threshold)
+    return false;
+
+  userpointCache.clear();
+  userpointCacheKey = UserpointCacheKey();
+  for(const GeoDataLatLonBox& r : rects)
+  {
+    bindAll(clusterQuery, r, true);
+    clusterQuery.exec();
+    while(clusterQuery.next())
+    {
+      map::MapUserpointCluster cluster;
+      cluster.count = clusterQuery.valueInt("num");
+      cluster.position = Pos(clusterQuery.valueFloat("lonx"), clusterQuery.valueFloat("laty"));
+      clusters.append(cluster);
+    }
+
+    bindAll(singleQuery, r, true);
+    singleQuery.exec();
+    while(singleQuery.next())
+    {
+      MapUserpoint userPoint;
+      mapTypesFactory->fillUserdataPoint(singleQuery.record(), userPoint);
+      userpoints.append(userPoint);
+
+      // Cache has to be kept for map screen index
+      userpointCache.list.append(userPoint);
+    }
+  }
+  return true;
+}
+
 QString MapQuery::getAirportIdentFromWaypoint(const QString& ident, const QString& region, const Pos& pos, bool found) const
 {
   return airportIdentFromQuery(AIRPORTIDENT_FROM_WAYPOINT, ident, region, pos, found);
@@ -1048,27 +1363,26 @@ QString MapQuery::airportIdentFromQuery(const QString& queryStr, const QString&
   found = false;
 
   // Query for nearest navaid
-  SqlQuery query(dbNav);
-  query.prepare(queryStr);
-  query.bindValue(":ident", ident);
-  query.bindValue(":region", region.isEmpty() ? "%" : region);
-  query.bindValue(":lonx", pos.getLonX());
-  query.bindValue(":laty", pos.getLatY());
+  SqlQuery *query = statementsNav->query(queryStr);
+  query->bindValue(":ident", ident);
+  query->bindValue(":region", region.isEmpty() ? "%" : region);
+  query->bindValue(":lonx", pos.getLonX());
+  query->bindValue(":laty", pos.getLatY());
 
   QString airport;
-  query.exec();
-  if(query.next())
+  statementsNav->exec(query);
+  if(query->next())
   {
     // Check if max distance is not exceeded
-    Pos navaidPos(query.valueFloat("lonx"), query.valueFloat("laty"));
+    Pos navaidPos(query->valueFloat("lonx"), query->valueFloat("laty"));
     if(pos.distanceMeterTo(pos) < MAX_AIRPORT_IDENT_DISTANCE_M)
     {
       // Get airport ident and record that a navaid was found
       found = true;
-      airport = query.valueStr("ident");
+      airport = query->valueStr("ident");
     }
   }
-  query.finish();
+  query->finish();
   return airport;
 }
 
@@ -1078,26 +1392,19 @@ const QList<map::MapMarker> *MapQuery::getMarkers(const GeoDataLatLonBox& rect,
     return nullptr;
 
   markerCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                          [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
-  {
-    return curLayer->hasSameQueryParametersMarker(newLayer);
-  });
-
-  if(markerCache.list.isEmpty() && !lazy)
+                          query::rectCacheTileParams({mapLayer->isMarker()}),
+                          [this](const GeoDataLatLonBox& tileRect, QList<MapMarker>& markers) -> void
   {
-    for(const GeoDataLatLonBox& r :
-        query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
+    query::bindRect(tileRect, markersByRectQuery);
+    markersByRectQuery->exec();
+    while(markersByRectQuery->next())
     {
-      query::bindRect(r, markersByRectQuery);
-      markersByRectQuery->exec();
-      while(markersByRectQuery->next())
-      {
-        map::MapMarker marker;
-        mapTypesFactory->fillMarker(markersByRectQuery->record(), marker);
-        markerCache.list.append(marker);
-      }
+      map::MapMarker marker;
+      mapTypesFactory->fillMarker(markersByRectQuery->record(), marker);
+      markers.append(marker);
     }
-  }
+  });
+
   overflow = markerCache.validate(queryMaxRows);
   return &markerCache.list;
 }
@@ -1116,26 +1423,19 @@ const QList<map::MapHolding> *MapQuery::getHoldings(const Marble::GeoDataLatLonB
   if(holdingByRectQuery != nullptr)
   {
     holdingCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                             [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
-    {
-      return curLayer->hasSameQueryParametersHolding(newLayer);
-    });
-
-    if(holdingCache.list.isEmpty() && !lazy)
+                             query::rectCacheTileParams({mapLayer->isHolding()}),
+                             [this](const GeoDataLatLonBox& tileRect, QList<MapHolding>& holdings) -> void
     {
-      for(const GeoDataLatLonBox& r :
-          query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
+      query::bindRect(tileRect, holdingByRectQuery);
+      holdingByRectQuery->exec();
+      while(holdingByRectQuery->next())
       {
-        query::bindRect(r, holdingByRectQuery);
-        holdingByRectQuery->exec();
-        while(holdingByRectQuery->next())
-        {
-          MapHolding holding;
-          mapTypesFactory->fillHolding(holdingByRectQuery->record(), holding);
-          holdingCache.list.append(holding);
-        }
+        MapHolding holding;
+        mapTypesFactory->fillHolding(holdingByRectQuery->record(), holding);
+        holdings.append(holding);
       }
-    }
+    });
+
     overflow = holdingCache.validate(queryMaxRows);
     return &holdingCache.list;
   }
@@ -1148,27 +1448,19 @@ const QList<map::MapAirportMsa> *MapQuery::getAirportMsa(const Marble::GeoDataLa
   if(airportMsaByRectQuery != nullptr)
   {
     airportMsaCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                                [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
-    {
-      return curLayer->hasSameQueryParametersAirportMsa(newLayer);
-    });
-
-    if(airportMsaCache.list.isEmpty() && !lazy)
+                                query::rectCacheTileParams({mapLayer->isAirportMsa()}),
+                                [this](const GeoDataLatLonBox& tileRect, QList<MapAirportMsa>& msaList) -> void
     {
-      for(const GeoDataLatLonBox& r :
-          query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
+      query::bindRect(tileRect, airportMsaByRectQuery);
+      airportMsaByRectQuery->exec();
+      while(airportMsaByRectQuery->next())
       {
-        query::bindRect(r, airportMsaByRectQuery);
-
-        airportMsaByRectQuery->exec();
-        while(airportMsaByRectQuery->next())
-        {
-          MapAirportMsa msa;
-          mapTypesFactory->fillAirportMsa(airportMsaByRectQuery->record(), msa);
-          airportMsaCache.list.append(msa);
-        }
+        MapAirportMsa msa;
+        mapTypesFactory->fillAirportMsa(airportMsaByRectQuery->record(), msa);
+        msaList.append(msa);
       }
-    }
+    });
+
     overflow = airportMsaCache.validate(queryMaxRows);
     return &airportMsaCache.list;
   }
@@ -1181,20 +1473,17 @@ const QList<map::MapIls> *MapQuery::getIls(GeoDataLatLonBox rect, const MapLayer
     return nullptr;
 
   ilsCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                       [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
-  {
-    return curLayer->hasSameQueryParametersIls(newLayer);
-  });
-
-  if(ilsCache.list.isEmpty() && !lazy)
+                       query::rectCacheTileParams({mapLayer->isIls(), mapLayer->isIlsDetail()}),
+                       [this, mapLayer](GeoDataLatLonBox tileRect, QList<MapIls>& ilsList) -> void
   {
     // ILS length is 9 NM * 1' per degree
     double increase = atools::geo::toRadians(9. / 60.);
 
-    // Increase bounding rect since ILS has no bounding to query
-    rect.setBoundaries(rect.north() + increase, rect.south() - increase, rect.east() + increase, rect.west() - increase);
+    // Increase bounding rect since ILS has no bounding to query - duplicates in neighbor tiles are removed by the cache
+    tileRect.setBoundaries(tileRect.north() + increase, tileRect.south() - increase, tileRect.east() + increase,
+                           tileRect.west() - increase);
 
-    for(const GeoDataLatLonBox& r : query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
+    for(const GeoDataLatLonBox& r : query::splitAtAntiMeridian(tileRect))
     {
       query::bindRect(r, ilsByRectQuery);
 
@@ -1209,87 +1498,305 @@ const QList<map::MapIls> *MapQuery::getIls(GeoDataLatLonBox rect, const MapLayer
 
         MapIls ils;
         mapTypesFactory->fillIls(ilsByRectQuery->record(), ils, end.isFullyValid() ? end.heading : map::INVALID_HEADING_VALUE);
-        ilsCache.list.append(ils);
+        ilsList.append(ils);
       }
     }
-  }
+  });
+
   overflow = ilsCache.validate(queryMaxRows);
   return &ilsCache.list;
 }
 
-/*
- * Get airport cache
- * @param reverse reverse order of airports to have unimportant small ones below in painting order
- * @param lazy do not update cache - instead return incomplete resut
- * @param overview fetch only incomplete data for overview airports
- * @return pointer to the airport cache
- */
-const QList<map::MapAirport> *MapQuery::fetchAirports(const Marble::GeoDataLatLonBox& rect, atools::sql::SqlQuery *query,
-                                                      bool lazy, bool overview, bool addon, bool normal, bool& overflow)
+MapQueryPrefetch MapQuery::createPrefetch(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, map::MapTypes types) const
 {
-  if(!query::valid(Q_FUNC_INFO, query))
-    return nullptr;
+  MapQueryPrefetch prefetch;
+
+  if(mapLayer == nullptr || dbSim == nullptr || dbNav == nullptr || airportByRectSql.isEmpty())
+    return prefetch;
+
+  prefetch.dbFileSim = dbSim->databaseName();
+  prefetch.dbFileNav = dbNav->databaseName();
+  prefetch.airportSql = airportByRectSql;
+  prefetch.airportAddonSql = airportAddonByRectSql;
+  prefetch.vorSql = vorsByRectSql;
+  prefetch.ndbSql = ndbsByRectSql;
+  int minRunwayFt = NavApp::getMapAirportHandler()->getMinimumRunwayFt();
+  prefetch.minRunwayLength = std::max(mapLayer->getMinRunwayLength(), minRunwayFt);
+  prefetch.airportNormal = types & map::AIRPORT_ALL;
+  prefetch.airportAddon = types.testFlag(map::AIRPORT_ADDON);
+  prefetch.navdata = NavApp::isNavdataAll();
+  prefetch.xplane = NavApp::isAirportDatabaseXPlane(prefetch.navdata);
+
+  int tileSize = query::rectCacheTileSize(mapLayer);
+  const QVector<query::RectCacheTileKey> tiles = query::rectCacheTiles(rect, tileSize, queryRectInflationFactor,
+                                                                       queryRectInflationIncrement);
+
+  // Prefetch only for caches which were already loaded with the same query parameters since the view
+  // will most likely use these again
+  quint32 airportParams = airportTileParams(mapLayer, prefetch.airportAddon, prefetch.airportNormal, minRunwayFt,
+                                            types & map::AIRPORT_ALL_AND_ADDON);
+  if(mapLayer->isAirport() && airportCache.curMapLayer != nullptr && airportCache.curParams == airportParams)
+  {
+    prefetch.airportGeneration = airportCache.getGeneration();
+    prefetch.airportParams = airportParams;
+    for(query::RectCacheTileKey key : tiles)
+    {
+      key.params = airportParams;
+      if(!airportCache.hasTile(key))
+        prefetch.airportTiles.append(key);
+    }
+  }
 
-  AirportQuery *airportQueryNav = NavApp::getAirportQueryNav();
+  quint32 vorParams = query::rectCacheTileParams({mapLayer->isVor()});
+  if(mapLayer->isVor() && types.testFlag(map::VOR) && vorCache.curMapLayer != nullptr && vorCache.curParams == vorParams)
+  {
+    prefetch.vorGeneration = vorCache.getGeneration();
+    prefetch.vorParams = vorParams;
+    for(query::RectCacheTileKey key : tiles)
+    {
+      key.params = vorParams;
+      if(!vorCache.hasTile(key))
+        prefetch.vorTiles.append(key);
+    }
+  }
 
-  if(airportCache.list.isEmpty() && !lazy)
+  quint32 ndbParams = query::rectCacheTileParams({mapLayer->isNdb()});
+  if(mapLayer->isNdb() && types.testFlag(map::NDB) && ndbCache.curMapLayer != nullptr && ndbCache.curParams == ndbParams)
   {
-    bool navdata = NavApp::isNavdataAll();
+    prefetch.ndbGeneration = ndbCache.getGeneration();
+    prefetch.ndbParams = ndbParams;
+    for(query::RectCacheTileKey key : tiles)
+    {
+      key.params = ndbParams;
+      if(!ndbCache.hasTile(key))
+        prefetch.ndbTiles.append(key);
+    }
+  }
 
-    for(const GeoDataLatLonBox& r : query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
+  return prefetch;
+}
+
+void MapQuery::runPrefetch(MapQueryPrefetch& prefetch, const bool& terminate)
+{
+  // Connections and prepared statements are kept by the pool for the next prefetch in this thread
+  DatabasePool *pool = NavApp::getDatabasePool();
+  SqlQuery *query = nullptr, *queryAddon = nullptr, *queryVor = nullptr, *queryNdb = nullptr;
+  if(!prefetch.airportTiles.isEmpty())
+  {
+    query = pool->getQuery(prefetch.dbFileSim, prefetch.airportSql);
+    queryAddon = pool->getQuery(prefetch.dbFileSim, prefetch.airportAddonSql);
+  }
+
+  if(!prefetch.vorTiles.isEmpty() || !prefetch.ndbTiles.isEmpty())
+  {
+    queryVor = pool->getQuery(prefetch.dbFileNav, prefetch.vorSql);
+    queryNdb = pool->getQuery(prefetch.dbFileNav, prefetch.ndbSql);
+  }
+
+  try
+  {
+    MapTypesFactory factory;
+
+    // Airports ==============================================
+    if(query != nullptr && queryAddon != nullptr)
     {
-      // Avoid duplicates between both queries
-      QSet<int> ids;
 
-      // Get normal airports ==========
-      if(normal)
+      for(const query::RectCacheTileKey& key : qAsConst(prefetch.airportTiles))
       {
-        query::bindRect(r, query);
-        query->exec();
-        while(query->next())
+        if(terminate)
+          break;
+
+        QList<MapAirport>& airports = prefetch.airports[key];
+        QSet<int> ids;
+        GeoDataLatLonBox tileRect = query::rectCacheTileRect(key);
+
+        if(prefetch.airportNormal)
+        {
+          query::bindRect(tileRect, query);
+          query->bindValue(":minlength", prefetch.minRunwayLength);
+          query->exec();
+          while(query->next())
+          {
+            MapAirport airport;
+            factory.fillAirport(query->record(), airport, true /* complete */, prefetch.navdata, prefetch.xplane);
+            ids.insert(airport.id);
+            airports.append(airport);
+          }
+        }
+
+        if(prefetch.airportAddon)
         {
-          MapAirport airport;
-          if(overview)
-            // Fill only a part of the object
-            mapTypesFactory->fillAirportForOverview(query->record(), airport, navdata, NavApp::isAirportDatabaseXPlane(navdata));
-          else
-            mapTypesFactory->fillAirport(query->record(), airport, true /* complete */, navdata, NavApp::isAirportDatabaseXPlane(navdata));
-
-          // Need to update airport procedure flag for mixed mode databases to enable procedure filter on map
-          airportQueryNav->correctAirportProcedureFlag(airport);
-
-          ids.insert(airport.id);
-          airportCache.list.append(airport);
+          query::bindRect(tileRect, queryAddon);
+          queryAddon->exec();
+          while(queryAddon->next())
+          {
+            MapAirport airport;
+            factory.fillAirport(queryAddon->record(), airport, true /* complete */, prefetch.navdata, prefetch.xplane);
+            if(!ids.contains(airport.id))
+              airports.append(airport);
+          }
         }
       }
+    }
+
+    // VOR and NDB ==============================================
+    if(queryVor != nullptr && queryNdb != nullptr)
+    {
 
-      // Get add-on airports ==========
-      if(addon && airportAddonByRectQuery != nullptr)
+      for(const query::RectCacheTileKey& key : qAsConst(prefetch.vorTiles))
       {
-        query::bindRect(r, airportAddonByRectQuery);
-        airportAddonByRectQuery->exec();
-        while(airportAddonByRectQuery->next())
+        if(terminate)
+          break;
+
+        QList<MapVor>& vors = prefetch.vors[key];
+        query::bindRect(query::rectCacheTileRect(key), queryVor);
+        queryVor->exec();
+        while(queryVor->next())
         {
-          MapAirport airport;
-          if(overview)
-            // Fill only a part of the object
-            mapTypesFactory->fillAirportForOverview(airportAddonByRectQuery->record(), airport, navdata,
-                                                    NavApp::isAirportDatabaseXPlane(navdata));
-          else
-            mapTypesFactory->fillAirport(airportAddonByRectQuery->record(), airport, true /* complete */, navdata,
-                                         NavApp::isAirportDatabaseXPlane(navdata));
-
-          // Need to update airport procedure flag for mixed mode databases to enable procedure filter on map
-          airportQueryNav->correctAirportProcedureFlag(airport);
-
-          if(!ids.contains(airport.id))
-            airportCache.list.append(airport);
+          MapVor vor;
+          factory.fillVor(queryVor->record(), vor);
+          vors.append(vor);
+        }
+      }
+
+      for(const query::RectCacheTileKey& key : qAsConst(prefetch.ndbTiles))
+      {
+        if(terminate)
+          break;
+
+        QList<MapNdb>& ndbs = prefetch.ndbs[key];
+        query::bindRect(query::rectCacheTileRect(key), queryNdb);
+        queryNdb->exec();
+        while(queryNdb->next())
+        {
+          MapNdb ndb;
+          factory.fillNdb(queryNdb->record(), ndb);
+          ndbs.append(ndb);
         }
       }
     }
   }
-  overflow = airportCache.validate(queryMaxRows);
-  return &airportCache.list;
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Prefetch failed" << e.what();
+    prefetch.airports.clear();
+    prefetch.vors.clear();
+    prefetch.ndbs.clear();
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Prefetch failed";
+    prefetch.airports.clear();
+    prefetch.vors.clear();
+    prefetch.ndbs.clear();
+  }
+
+  for(SqlQuery *q : {query, queryAddon, queryVor, queryNdb})
+  {
+    if(q != nullptr)
+      q->finish();
+  }
+}
+
+void MapQuery::insertPrefetch(const MapQueryPrefetch& prefetch)
+{
+  // Ignore results if caches were cleared or parameters changed in the meantime
+  if(prefetch.airportGeneration == airportCache.getGeneration() && prefetch.airportParams == airportCache.curParams)
+  {
+    AirportQuery *airportQueryNav = NavApp::getAirportQueryNav();
+    for(auto it = prefetch.airports.constBegin(); it != prefetch.airports.constEnd(); ++it)
+    {
+      // Incomplete tile due to row limit
+      if(it.value().size() >= queryMaxRows)
+        continue;
+
+      // Procedure flag has to be corrected in the GUI thread before filtering
+      QList<MapAirport> airports(it.value());
+      for(MapAirport& airport : airports)
+        airportQueryNav->correctAirportProcedureFlag(airport);
+      filterAirports(airports, airportCacheTypes, airportCacheMinRunwayFt, airportCache.curMapLayer);
+      airportCache.insertTile(it.key(), airports);
+    }
+  }
+
+  if(prefetch.vorGeneration == vorCache.getGeneration() && prefetch.vorParams == vorCache.curParams)
+  {
+    for(auto it = prefetch.vors.constBegin(); it != prefetch.vors.constEnd(); ++it)
+    {
+      if(it.value().size() < queryMaxRows)
+        vorCache.insertTile(it.key(), it.value());
+    }
+  }
+
+  if(prefetch.ndbGeneration == ndbCache.getGeneration() && prefetch.ndbParams == ndbCache.curParams)
+  {
+    for(auto it = prefetch.ndbs.constBegin(); it != prefetch.ndbs.constEnd(); ++it)
+    {
+      if(it.value().size() < queryMaxRows)
+        ndbCache.insertTile(it.key(), it.value());
+    }
+  }
+}
+
+/*
+ * Fetch airports for one tile of the airport cache.
+ * @param overview fetch only incomplete data for overview airports
+ * @param airports receives the airports
+ */
+void MapQuery::fetchAirports(const Marble::GeoDataLatLonBox& rect, atools::sql::SqlQuery *query, bool overview, bool addon,
+                             bool normal, QList<map::MapAirport>& airports)
+{
+  AirportQuery *airportQueryNav = NavApp::getAirportQueryNav();
+  bool navdata = NavApp::isNavdataAll();
+
+  // Avoid duplicates between both queries
+  QSet<int> ids;
+
+  // Get normal airports ==========
+  if(normal)
+  {
+    query::bindRect(rect, query);
+    query->exec();
+    while(query->next())
+    {
+      MapAirport airport;
+      if(overview)
+        // Fill only a part of the object
+        mapTypesFactory->fillAirportForOverview(query->record(), airport, navdata, NavApp::isAirportDatabaseXPlane(navdata));
+      else
+        mapTypesFactory->fillAirport(query->record(), airport, true /* complete */, navdata, NavApp::isAirportDatabaseXPlane(navdata));
+
+      // Need to update airport procedure flag for mixed mode databases to enable procedure filter on map
+      airportQueryNav->correctAirportProcedureFlag(airport);
+
+      ids.insert(airport.id);
+      airports.append(airport);
+    }
+  }
+
+  // Get add-on airports ==========
+  if(addon && airportAddonByRectQuery != nullptr)
+  {
+    query::bindRect(rect, airportAddonByRectQuery);
+    airportAddonByRectQuery->exec();
+    while(airportAddonByRectQuery->next())
+    {
+      MapAirport airport;
+      if(overview)
+        // Fill only a part of the object
+        mapTypesFactory->fillAirportForOverview(airportAddonByRectQuery->record(), airport, navdata,
+                                                NavApp::isAirportDatabaseXPlane(navdata));
+      else
+        mapTypesFactory->fillAirport(airportAddonByRectQuery->record(), airport, true /* complete */, navdata,
+                                     NavApp::isAirportDatabaseXPlane(navdata));
+
+      // Need to update airport procedure flag for mixed mode databases to enable procedure filter on map
+      airportQueryNav->correctAirportProcedureFlag(airport);
+
+      if(!ids.contains(airport.id))
+        airports.append(airport);
+    }
+  }
 }
 
 const QList<map::MapRunway> *MapQuery::getRunwaysForOverview(int airportId)
@@ -1473,27 +1980,45 @@ void MapQuery::initQueries()
   ilsQuerySimByAirportAndIdent = new SqlQuery(dbNav);
   ilsQuerySimByAirportAndIdent->prepare("select " + ilsQueryBase + " from ils where loc_airport_ident = :apt and ident = :ident");
 
+  // R*Tree indexes in the temporary schema of the navaid connection for map rectangle queries
+  // Prefetch SQL below is run on other connections and has to use the plain coordinate condition
+  vorSpatialIndex = new SpatialIndex(dbNav, "vor", "vor_id");
+  ndbSpatialIndex = new SpatialIndex(dbNav, "ndb", "ndb_id");
+  ilsSpatialIndex = new SpatialIndex(dbNav, "ils", "ils_id");
+
+  // Fall back to coordinate columns if R*Tree is not available
+  auto spatialRect = [](SpatialIndex *index) -> QString {
+                       QString cond = index->conditionBind();
+                       return cond.isEmpty() ? QString(whereRect) : cond;
+                     };
+
   ilsByRectQuery = new SqlQuery(dbNav);
-  ilsByRectQuery->prepare("select " + ilsQueryBase + " from ils where " + whereRect + " " + whereLimit);
+  ilsByRectQuery->prepare("select " + ilsQueryBase + " from ils where " + spatialRect(ilsSpatialIndex) + " " + whereLimit);
 
+  airportByRectSql = "select " + airportQueryBase.join(", ") + " from airport where " + whereRect +
+                     " and longest_runway_length >= :minlength " + whereLimit;
   airportByRectQuery = new SqlQuery(dbSim);
-  airportByRectQuery->prepare("select " + airportQueryBase.join(", ") + " from airport where " + whereRect +
-                              " and longest_runway_length >= :minlength " + whereLimit);
+  airportByRectQuery->prepare(airportByRectSql);
 
+  airportAddonByRectSql = "select " + airportQueryBase.join(", ") + " from airport where " + whereRect + " and is_addon = 1 " + whereLimit;
   airportAddonByRectQuery = new SqlQuery(dbSim);
-  airportAddonByRectQuery->prepare(
-    "select " + airportQueryBase.join(", ") + " from airport where " + whereRect + " and is_addon = 1 " + whereLimit);
+  airportAddonByRectQuery->prepare(airportAddonByRectSql);
 
   // Runways > 4000 feet for simplyfied runway overview
   runwayOverviewQuery = new SqlQuery(dbSim);
   runwayOverviewQuery->prepare("select runway_id, length, heading, lonx, laty, primary_lonx, primary_laty, secondary_lonx, secondary_laty "
                                "from runway where airport_id = :airportId and length > 4000 " + whereLimit);
 
+  vorsByRectSql = "select " + vorQueryBase + " from vor where " + whereRect + " " + whereLimit;
   vorsByRectQuery = new SqlQuery(dbNav);
-  vorsByRectQuery->prepare("select " + vorQueryBase + " from vor where " + whereRect + " " + whereLimit);
+  vorsByRectQuery->prepare("select " + vorQueryBase + " from vor where " + spatialRect(vorSpatialIndex) + " " + whereLimit);
 
+  ndbsByRectSql = "select " + ndbQueryBase + " from ndb where " + whereRect + " " + whereLimit;
+
+  vorsByIdentsSql = "select " + vorQueryBase + " from vor where ident in (%1)";
+  ndbsByIdentsSql = "select " + ndbQueryBase + " from ndb where ident in (%1)";
   ndbsByRectQuery = new SqlQuery(dbNav);
-  ndbsByRectQuery->prepare("select " + ndbQueryBase + " from ndb where " + whereRect + " " + whereLimit);
+  ndbsByRectQuery->prepare("select " + ndbQueryBase + " from ndb where " + spatialRect(ndbSpatialIndex) + " " + whereLimit);
 
   if(msaDb != nullptr)
   {
@@ -1528,6 +2053,9 @@ void MapQuery::initQueries()
 
 void MapQuery::deInitQueries()
 {
+  statementsNav->clear();
+  clearIdentBatch();
+
   airportCache.clear();
   airportMsaCache.clear();
   vorCache.clear();
@@ -1562,4 +2090,14 @@ void MapQuery::deInitQueries()
   ATOOLS_DELETE(airportMsaByIdentQuery);
   ATOOLS_DELETE(airportMsaByRectQuery);
   ATOOLS_DELETE(airportMsaByIdQuery);
+
+  // Drop indexes after all queries using them are deleted
+  ATOOLS_DELETE(vorSpatialIndex);
+  ATOOLS_DELETE(ndbSpatialIndex);
+  ATOOLS_DELETE(ilsSpatialIndex);
+
+  airportByRectSql.clear();
+  airportAddonByRectSql.clear();
+  vorsByRectSql.clear();
+  ndbsByRectSql.clear();
 }
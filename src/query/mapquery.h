@@ -21,6 +21,10 @@
 #include "query/querytypes.h"
 
 #include <QCache>
+#include <QMultiHash>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
 
 namespace map {
 struct MapResult;
@@ -38,8 +42,43 @@ class SqlQuery;
 }
 
 class CoordinateConverter;
+class SpatialIndex;
 class MapTypesFactory;
+class StatementCache;
 class MapLayer;
+struct MapQueryTiles;
+
+/*
+ * Parameters and result for a prefetch of airport, VOR and NDB tiles which can run in a background thread.
+ * Created by MapQuery::createPrefetch(), filled by MapQuery::runPrefetch() and consumed by MapQuery::insertPrefetch().
+ */
+struct MapQueryPrefetch
+{
+  bool isEmpty() const
+  {
+    return airportTiles.isEmpty() && vorTiles.isEmpty() && ndbTiles.isEmpty();
+  }
+
+  /* Input =========================================== */
+  QString dbFileSim, dbFileNav;
+  QString airportSql, airportAddonSql, vorSql, ndbSql;
+
+  int minRunwayLength = 0;
+  bool airportNormal = false, airportAddon = false, navdata = false, xplane = false;
+
+  QVector<query::RectCacheTileKey> airportTiles, vorTiles, ndbTiles;
+
+  /* Cache generations at creation time to detect outdated results */
+  quint32 airportGeneration = 0, vorGeneration = 0, ndbGeneration = 0;
+
+  /* Query parameters of tiles. Results are dropped if the cache parameters changed in the meantime. */
+  quint32 airportParams = 0, vorParams = 0, ndbParams = 0;
+
+  /* Output =========================================== */
+  QHash<query::RectCacheTileKey, QList<map::MapAirport> > airports;
+  QHash<query::RectCacheTileKey, QList<map::MapVor> > vors;
+  QHash<query::RectCacheTileKey, QList<map::MapNdb> > ndbs;
+};
 
 /*
  * Provides map related database queries.
@@ -143,6 +182,12 @@ public:
   void getMapObjectByIdent(map::MapResult& result, map::MapTypes type, const QString& ident, const QString& region,
                            const QString& airport, bool airportFromNavDatabase, map::AirportQueryFlags flags = map::AP_QUERY_ALL) const;
 
+  /* Load all VORs and NDBs having one of the given idents with one query per type and chunk of idents.
+   * getMapObjectByIdent() takes VORs and NDBs for these idents from the batch until clearIdentBatch() is called.
+   * Used to resolve all navaids of a flight plan or route string at once. */
+  void loadIdentBatch(const QStringList& idents);
+  void clearIdentBatch();
+
   /*
    * Get a map object by type and id
    * @param result will receive objects based on type
@@ -233,12 +278,30 @@ public:
   const QList<map::MapUserpoint> getUserdataPoints(const Marble::GeoDataLatLonBox& rect, const QStringList& types,
                                                    const QStringList& typesAll, bool unknownType, float distanceNm);
 
+  /* Aggregates userpoints in a grid of cellSizeDeg degrees using SQL if more than threshold points are in rect.
+   * Returns false and does not touch the lists if threshold is not exceeded or zero.
+   * Cells containing only one point are returned as full userpoints which are also added to the screen index cache. */
+  bool getUserdataPointClusters(QList<map::MapUserpoint>& userpoints, QList<map::MapUserpointCluster>& clusters,
+                                const Marble::GeoDataLatLonBox& rect, const QStringList& types, const QStringList& typesAll,
+                                bool unknownType, float distanceNm, float cellSizeDeg, int threshold);
+
   /* Get related airport for navaids from current nav database.
    * found is true if navaid search was successful and max distance to pos is not exceeded. */
   QString getAirportIdentFromWaypoint(const QString& ident, const QString& region, const atools::geo::Pos& pos, bool found) const;
   QString getAirportIdentFromVor(const QString& ident, const QString& region, const atools::geo::Pos& pos, bool found) const;
   QString getAirportIdentFromNdb(const QString& ident, const QString& region, const atools::geo::Pos& pos, bool found) const;
 
+  /* Get parameters for loading all airport, VOR and NDB tiles covering rect which are not in the caches yet.
+   * Only types already loaded for the same layer parameters are considered. Returned object is empty if nothing to do. */
+  MapQueryPrefetch createPrefetch(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, map::MapTypes types) const;
+
+  /* Load all tiles in prefetch using separate read only database connections.
+   * Can be called from any thread. Stops early if terminate is set. */
+  static void runPrefetch(MapQueryPrefetch& prefetch, const bool& terminate);
+
+  /* Add loaded tiles to the caches. Outdated results are ignored. Must be called in the GUI thread. */
+  void insertPrefetch(const MapQueryPrefetch& prefetch);
+
   /* Close all query objects thus disconnecting from the database */
   void initQueries();
 
@@ -260,8 +323,12 @@ private:
                                 const atools::geo::Pos& sortByDistancePos,
                                 float maxDistanceMeter, bool airportFromNavDatabase, map::AirportQueryFlags flags) const;
 
-  const QList<map::MapAirport> *fetchAirports(const Marble::GeoDataLatLonBox& rect, atools::sql::SqlQuery *query,
-                                              bool lazy, bool overview, bool addon, bool normal, bool& overflow);
+  /* Remove all airports which are not visible for the given airport type filter, GUI runway length and layer.
+   * Used to keep only drawn airports in the cache. */
+  static void filterAirports(QList<map::MapAirport>& airports, map::MapTypes types, int minRunwayFt, const MapLayer *mapLayer);
+
+  void fetchAirports(const Marble::GeoDataLatLonBox& rect, atools::sql::SqlQuery *query, bool overview, bool addon, bool normal,
+                     QList<map::MapAirport>& airports);
 
   QVector<map::MapIls> ilsByAirportAndRunway(const QString& airportIdent, const QString& runway) const;
 
@@ -273,17 +340,43 @@ private:
   MapTypesFactory *mapTypesFactory;
   atools::sql::SqlDatabase *dbSim, *dbNav, *dbUser;
 
-  /* Simple bounding rectangle caches */
+  /* Dynamic statements for the nav database */
+  StatementCache *statementsNav;
+
+  /* Tiles of the caches below which are shared between all instances, i.e. all map widgets, since
+   * all use the same databases. The lists of the caches for the current view are kept per instance. */
+  QSharedPointer<MapQueryTiles> tiles;
+
+  /* Tiled bounding rectangle caches */
   bool airportCacheAddonFlag = false; // Keep addon status flag for comparing
   bool airportCacheNormalFlag = false; // Keep normal (non add-on) status flag for comparing
-  query::SimpleRectCache<map::MapAirport> airportCache;
+  int airportCacheMinRunwayFt = 0; // Minimum runway length from GUI used to filter cached airports
+  map::MapTypes airportCacheTypes = map::NONE; // Airport type filter used for cached airports
+  query::TileRectCache<map::MapAirport> airportCache;
+  query::TileRectCache<map::MapVor> vorCache;
+  query::TileRectCache<map::MapNdb> ndbCache;
+  query::TileRectCache<map::MapMarker> markerCache;
+  query::TileRectCache<map::MapHolding> holdingCache;
+  query::TileRectCache<map::MapIls> ilsCache;
+  query::TileRectCache<map::MapAirportMsa> airportMsaCache;
+
+  /* Simple bounding rectangle cache used for screen index. List is reused if the query parameters and
+   * the userpoint revision did not change. */
   query::SimpleRectCache<map::MapUserpoint> userpointCache;
-  query::SimpleRectCache<map::MapVor> vorCache;
-  query::SimpleRectCache<map::MapNdb> ndbCache;
-  query::SimpleRectCache<map::MapMarker> markerCache;
-  query::SimpleRectCache<map::MapHolding> holdingCache;
-  query::SimpleRectCache<map::MapIls> ilsCache;
-  query::SimpleRectCache<map::MapAirportMsa> airportMsaCache;
+
+  struct UserpointCacheKey
+  {
+    Marble::GeoDataLatLonBox rect;
+    QStringList types, typesAll;
+    bool unknownType = false, valid = false;
+    float distanceNm = 0.f;
+    quint32 revision = 0;
+
+    bool operator==(const UserpointCacheKey& other) const;
+
+  };
+
+  UserpointCacheKey userpointCacheKey;
 
   bool gls = false;
 
@@ -293,6 +386,20 @@ private:
 
   static int queryMaxRows;
 
+  /* SQL for rectangle queries kept for background prefetch */
+  QString airportByRectSql, airportAddonByRectSql, vorsByRectSql, ndbsByRectSql;
+
+  /* SQL for batch loading by idents. %1 is replaced with a list of bind placeholders. */
+  QString vorsByIdentsSql, ndbsByIdentsSql;
+
+  /* Navaids loaded by loadIdentBatch() keyed by ident. Idents without result are also added to the set. */
+  QSet<QString> identBatch;
+  QMultiHash<QString, map::MapVor> vorIdentBatch;
+  QMultiHash<QString, map::MapNdb> ndbIdentBatch;
+
+  /* R*Tree indexes for rectangle queries. Deleted after the queries. */
+  SpatialIndex *vorSpatialIndex = nullptr, *ndbSpatialIndex = nullptr, *ilsSpatialIndex = nullptr;
+
   /* Database queries */
   atools::sql::SqlQuery *runwayOverviewQuery = nullptr,
                         *airportByRectQuery = nullptr, *airportAddonByRectQuery = nullptr,
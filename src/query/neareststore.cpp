@@ -0,0 +1,442 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "query/neareststore.h"
+
+#include "app/navapp.h"
+#include "common/constants.h"
+#include "db/databasepool.h"
+#include "exception.h"
+#include "geo/calculations.h"
+#include "settings/settings.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringBuilder>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+
+using atools::geo::Pos;
+using atools::sql::SqlDatabase;
+using atools::sql::SqlQuery;
+
+Q_DECL_CONSTEXPR float NearestStore::MAX_DISTANCE_AIRPORT_NM;
+Q_DECL_CONSTEXPR float NearestStore::MAX_DISTANCE_NAVAID_NM;
+Q_DECL_CONSTEXPR int NearestStore::MAX_NUM_AIRPORT;
+Q_DECL_CONSTEXPR int NearestStore::MAX_NUM_NAVAID;
+
+namespace {
+
+/* Fallback factor for radius and minimum number of objects as used in MapQuery and AirportQuery */
+const static float RADIUS_EXTENSION_FACTOR = 4.f;
+const static int MIN_NUM_OBJECTS = 5;
+
+/* ILS are limited in number and distance */
+const static int MAX_NUM_ILS = 3;
+const static float MAX_DISTANCE_ILS_NM = 4.f;
+
+struct GridObject
+{
+  Pos pos;
+  int id;
+  map::MapType type;
+  QString ident;
+};
+
+/* Object with distance in meter to search position */
+typedef std::pair<float, const GridObject *> DistObject;
+
+/* Simple grid of one degree cells for radius searches */
+class ObjectGrid
+{
+public:
+  void add(const GridObject& obj)
+  {
+    cells[cellIndex(lonIndex(obj.pos.getLonX()), latIndex(obj.pos.getLatY()))].append(obj);
+  }
+
+  /* Append all objects within radius to result and sort result by distance */
+  void find(QVector<DistObject>& result, const Pos& pos, float radiusNm) const
+  {
+    float radiusMeter = atools::geo::nmToMeter(radiusNm);
+
+    // One nautical mile is one minute latitude
+    float degLat = radiusNm / 60.f;
+    float north = std::min(pos.getLatY() + degLat, 89.999f), south = std::max(pos.getLatY() - degLat, -89.999f);
+    float cosLat = std::cos(atools::geo::toRadians(std::max(std::abs(north), std::abs(south))));
+    float degLon = degLat / std::max(cosLat, 0.01f);
+
+    int lonFrom = 0, lonTo = 359;
+    if(degLon < 179.f)
+    {
+      lonFrom = lonIndex(pos.getLonX() - degLon);
+      lonTo = lonIndex(pos.getLonX() + degLon);
+    }
+    if(lonTo < lonFrom)
+      // Crosses anti-meridian
+      lonTo += 360;
+
+    for(int latIdx = latIndex(south); latIdx <= latIndex(north); latIdx++)
+    {
+      for(int lonIdx = lonFrom; lonIdx <= lonTo; lonIdx++)
+      {
+        auto it = cells.constFind(cellIndex(lonIdx % 360, latIdx));
+        if(it != cells.constEnd())
+        {
+          for(const GridObject& obj : it.value())
+          {
+            float dist = pos.distanceMeterTo(obj.pos);
+            if(dist <= radiusMeter)
+              result.append(std::make_pair(dist, &obj));
+          }
+        }
+      }
+    }
+
+    std::sort(result.begin(), result.end(), [](const DistObject& o1, const DistObject& o2) -> bool {
+      return o1.first < o2.first;
+    });
+  }
+
+private:
+  static int lonIndex(float lonX)
+  {
+    int idx = static_cast<int>(std::floor(lonX)) + 180;
+    return ((idx % 360) + 360) % 360;
+  }
+
+  static int latIndex(float latY)
+  {
+    return std::max(0, std::min(static_cast<int>(std::floor(latY)) + 90, 179));
+  }
+
+  static int cellIndex(int lonIdx, int latIdx)
+  {
+    return latIdx * 360 + lonIdx;
+  }
+
+  QHash<int, QVector<GridObject> > cells;
+};
+
+/* Count objects in sorted list which are within the distance */
+int countWithin(const QVector<DistObject>& objects, float distanceMeter)
+{
+  int num = 0;
+  while(num < objects.size() && objects.at(num).first <= distanceMeter)
+    num++;
+  return num;
+}
+
+}
+
+NearestStore::NearestStore(QObject *parent)
+  : QObject(parent)
+{
+  // Notification from thread that it has finished and we can get the result from the future
+  connect(&watcher, &QFutureWatcher<NearestHash>::finished, this, &NearestStore::loadFinished);
+}
+
+NearestStore::~NearestStore()
+{
+  terminateThread();
+}
+
+void NearestStore::preDatabaseLoad()
+{
+  terminateThread();
+  nearestHash.clear();
+}
+
+void NearestStore::postDatabaseLoad()
+{
+  terminateThread();
+  nearestHash.clear();
+
+  if(!atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_NEAREST_STORE, true).toBool())
+    return;
+
+  QFileInfo databaseInfo(NavApp::getDatabaseNav()->databaseName());
+  if(!databaseInfo.exists() || !databaseInfo.isFile())
+    // In memory or temporary database
+    return;
+
+  terminateThreadSignal = false;
+  future = QtConcurrent::run(this, &NearestStore::loadThread, databaseInfo.absoluteFilePath(), NavApp::getDatabaseAiracCycleNav());
+
+  // Watcher will call NearestStore::loadFinished() when finished
+  watcher.setFuture(future);
+}
+
+bool NearestStore::getNearest(int airportIdNav, QVector<int>& airportIds, QVector<map::MapRef>& navaidRefs) const
+{
+  auto it = nearestHash.constFind(airportIdNav);
+  if(it != nearestHash.constEnd())
+  {
+    airportIds = it.value().airportIds;
+    navaidRefs = it.value().navaidRefs;
+    return true;
+  }
+  return false;
+}
+
+void NearestStore::loadFinished()
+{
+  if(terminateThreadSignal)
+    return;
+
+  nearestHash = future.result();
+  qDebug() << Q_FUNC_INFO << "Nearest lists for" << nearestHash.size() << "airports";
+}
+
+NearestStore::NearestHash NearestStore::loadThread(QString dbFilename, QString cycle)
+{
+  QThread::currentThread()->setPriority(QThread::LowPriority);
+
+  QFileInfo databaseInfo(dbFilename);
+  qint64 databaseSize = databaseInfo.size(), databaseModified = databaseInfo.lastModified().toMSecsSinceEpoch();
+  QString filename = dbFilename + ".nearest";
+
+  NearestHash nearest;
+  if(!readFile(nearest, filename, databaseSize, databaseModified, cycle))
+  {
+    nearest = calculate(dbFilename);
+
+    if(!terminateThreadSignal && !nearest.isEmpty())
+      writeFile(nearest, filename, databaseSize, databaseModified, cycle);
+  }
+  return nearest;
+}
+
+NearestStore::NearestHash NearestStore::calculate(const QString& dbFilename) const
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  QVector<GridObject> airports;
+  ObjectGrid procAirportGrid, navaidGrid, ilsGrid;
+
+  SqlDatabase *db = NavApp::getDatabasePool()->getDatabase(dbFilename);
+  if(db == nullptr)
+    return NearestHash();
+
+  try
+  {
+    // Load positions of all objects into grids ===========================
+    SqlQuery query(db);
+    query.exec("select airport_id, ident, num_approach, lonx, laty from airport");
+    while(query.next())
+    {
+      GridObject obj = {Pos(query.valueFloat("lonx"), query.valueFloat("laty")), query.valueInt("airport_id"), map::AIRPORT,
+                        query.valueStr("ident")};
+      airports.append(obj);
+      if(query.valueInt("num_approach") > 0)
+        procAirportGrid.add(obj);
+    }
+
+    const static QVector<std::pair<QString, map::MapType> > NAVAID_TABLES({
+      std::make_pair(QString("vor"), map::VOR), std::make_pair(QString("ndb"), map::NDB), std::make_pair(QString("ils"), map::ILS)
+    });
+
+    for(const std::pair<QString, map::MapType>& table : NAVAID_TABLES)
+    {
+      if(terminateThreadSignal)
+        break;
+
+      query.exec("select " % table.first % "_id as id, lonx, laty from " % table.first);
+      while(query.next())
+      {
+        GridObject obj = {Pos(query.valueFloat("lonx"), query.valueFloat("laty")), query.valueInt("id"), table.second, QString()};
+        if(table.second == map::ILS)
+          ilsGrid.add(obj);
+        else
+          navaidGrid.add(obj);
+      }
+    }
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Loading failed" << e.what();
+    airports.clear();
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Loading failed";
+    airports.clear();
+  }
+
+  qDebug() << Q_FUNC_INFO << "Loaded" << airports.size() << "airports in" << timer.restart() << "ms";
+
+  // Calculate nearest lists for all airports in parallel ===========================
+  QVector<std::pair<const GridObject *, Nearest> > jobs;
+  jobs.reserve(airports.size());
+  for(const GridObject& airport : qAsConst(airports))
+    jobs.append(std::make_pair(&airport, Nearest()));
+
+  QtConcurrent::blockingMap(jobs, [&](std::pair<const GridObject *, Nearest>& job) -> void {
+    if(terminateThreadSignal)
+      return;
+
+    const GridObject& airport = *job.first;
+
+    // Airports with procedures excluding this one ================
+    QVector<DistObject> objects;
+    procAirportGrid.find(objects, airport.pos, MAX_DISTANCE_AIRPORT_NM * RADIUS_EXTENSION_FACTOR);
+    objects.erase(std::remove_if(objects.begin(), objects.end(), [&airport](const DistObject& obj) -> bool {
+      return obj.second->ident == airport.ident;
+    }), objects.end());
+
+    int num = countWithin(objects, atools::geo::nmToMeter(MAX_DISTANCE_AIRPORT_NM));
+    if(num < MIN_NUM_OBJECTS)
+      num = objects.size();
+
+    for(int i = 0; i < std::min(num, MAX_NUM_AIRPORT); i++)
+      job.second.airportIds.append(objects.at(i).second->id);
+
+    // VOR, NDB and ILS ================
+    QVector<DistObject> ils;
+    ilsGrid.find(ils, airport.pos, MAX_DISTANCE_ILS_NM);
+    ils.resize(std::min(ils.size(), MAX_NUM_ILS));
+
+    objects.clear();
+    navaidGrid.find(objects, airport.pos, MAX_DISTANCE_NAVAID_NM * RADIUS_EXTENSION_FACTOR);
+
+    num = countWithin(objects, atools::geo::nmToMeter(MAX_DISTANCE_NAVAID_NM));
+    if(num + ils.size() < MIN_NUM_OBJECTS)
+      num = objects.size();
+
+    objects.resize(num);
+    objects.append(ils);
+    std::sort(objects.begin(), objects.end(), [](const DistObject& o1, const DistObject& o2) -> bool {
+      return o1.first < o2.first;
+    });
+
+    for(int i = 0; i < std::min(objects.size(), MAX_NUM_NAVAID); i++)
+      job.second.navaidRefs.append(map::MapRef(objects.at(i).second->id, objects.at(i).second->type));
+  });
+
+  NearestHash nearest;
+  if(!terminateThreadSignal)
+  {
+    nearest.reserve(jobs.size());
+    for(const std::pair<const GridObject *, Nearest>& job : qAsConst(jobs))
+      nearest.insert(job.first->id, job.second);
+  }
+
+  qDebug() << Q_FUNC_INFO << "Calculated nearest for" << nearest.size() << "airports in" << timer.elapsed() << "ms";
+  return nearest;
+}
+
+bool NearestStore::readFile(NearestHash& nearest, const QString& filename, qint64 databaseSize, qint64 databaseModified,
+                            const QString& cycle) const
+{
+  QFile file(filename);
+  if(!file.exists() || !file.open(QIODevice::ReadOnly))
+    return false;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_5);
+
+  quint32 magic;
+  quint16 version;
+  qint64 fileDatabaseSize, fileDatabaseModified;
+  QString fileCycle;
+  in >> magic >> version;
+
+  if(magic != FILE_MAGIC || version != FILE_VERSION)
+  {
+    qInfo() << Q_FUNC_INFO << "Wrong magic number or version in" << filename;
+    return false;
+  }
+
+  in >> fileDatabaseSize >> fileDatabaseModified >> fileCycle;
+  if(fileDatabaseSize != databaseSize || fileDatabaseModified != databaseModified || fileCycle != cycle)
+  {
+    qInfo() << Q_FUNC_INFO << "Outdated" << filename;
+    return false;
+  }
+
+  qint32 numAirports;
+  in >> numAirports;
+  nearest.reserve(numAirports);
+  for(qint32 i = 0; i < numAirports && in.status() == QDataStream::Ok && !terminateThreadSignal; i++)
+  {
+    qint32 airportId, numNavaids;
+    Nearest entry;
+    in >> airportId >> entry.airportIds >> numNavaids;
+
+    for(qint32 j = 0; j < numNavaids && in.status() == QDataStream::Ok; j++)
+    {
+      qint32 id;
+      quint64 type;
+      in >> id >> type;
+      entry.navaidRefs.append(map::MapRef(id, static_cast<map::MapType>(type)));
+    }
+    nearest.insert(airportId, entry);
+  }
+
+  if(in.status() != QDataStream::Ok || terminateThreadSignal)
+  {
+    qWarning() << Q_FUNC_INFO << "Error reading" << filename;
+    nearest.clear();
+    return false;
+  }
+
+  qDebug() << Q_FUNC_INFO << "Read" << nearest.size() << "airports from" << filename;
+  return true;
+}
+
+void NearestStore::writeFile(const NearestHash& nearest, const QString& filename, qint64 databaseSize, qint64 databaseModified,
+                             const QString& cycle) const
+{
+  QSaveFile saveFile(filename);
+  if(saveFile.open(QIODevice::WriteOnly))
+  {
+    QDataStream out(&saveFile);
+    out.setVersion(QDataStream::Qt_5_5);
+    out << FILE_MAGIC << FILE_VERSION << databaseSize << databaseModified << cycle << static_cast<qint32>(nearest.size());
+
+    for(auto it = nearest.constBegin(); it != nearest.constEnd(); ++it)
+    {
+      out << static_cast<qint32>(it.key()) << it.value().airportIds << static_cast<qint32>(it.value().navaidRefs.size());
+      for(const map::MapRef& ref : it.value().navaidRefs)
+        out << static_cast<qint32>(ref.id) << static_cast<quint64>(ref.objType);
+    }
+
+    if(saveFile.commit())
+      qDebug() << Q_FUNC_INFO << "Written" << nearest.size() << "airports to" << filename;
+    else
+      qWarning() << Q_FUNC_INFO << "Cannot write" << filename << saveFile.errorString();
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << saveFile.errorString();
+}
+
+void NearestStore::terminateThread()
+{
+  if(future.isRunning() || future.isStarted())
+  {
+    terminateThreadSignal = true;
+    future.waitForFinished();
+  }
+}
@@ -0,0 +1,108 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_NEARESTSTORE_H
+#define LNM_NEARESTSTORE_H
+
+#include "common/maptypes.h"
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QVector>
+
+/*
+ * Precomputed lists of nearest airports with procedures and nearest radio navaids for all airports
+ * of the navdata database. Used by the "Nearest" tab of the airport information.
+ *
+ * Lists are computed once after loading a database in a background thread using a separate read only
+ * connection and an in-memory grid of all objects. The result is saved in a file next to the navdata database
+ * and loaded from there on the next start if size, modification time and AIRAC cycle of the database match.
+ *
+ * Radius and limits are the same as for the queries in MapQuery::getNearestNavaids() and
+ * AirportQuery::getNearestProcAirports().
+ */
+class NearestStore :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit NearestStore(QObject *parent);
+  virtual ~NearestStore() override;
+
+  NearestStore(const NearestStore& other) = delete;
+  NearestStore& operator=(const NearestStore& other) = delete;
+
+  /* Search radius. Radius is extended by factor four if less than five objects are found. */
+  static Q_DECL_CONSTEXPR float MAX_DISTANCE_AIRPORT_NM = 75.f;
+  static Q_DECL_CONSTEXPR float MAX_DISTANCE_NAVAID_NM = 50.f;
+
+  /* Maximum number of objects kept per airport */
+  static Q_DECL_CONSTEXPR int MAX_NUM_AIRPORT = 10;
+  static Q_DECL_CONSTEXPR int MAX_NUM_NAVAID = 15;
+
+  /* Stop background job and drop all lists */
+  void preDatabaseLoad();
+
+  /* Load lists from file or start background calculation if enabled in options */
+  void postDatabaseLoad();
+
+  /* Get airport ids and navaid references sorted by distance for the given navdata airport id.
+   * Returns false if lists are not available yet or airport is not known. */
+  bool getNearest(int airportIdNav, QVector<int>& airportIds, QVector<map::MapRef>& navaidRefs) const;
+
+private:
+  /* Nearest objects for one airport */
+  struct Nearest
+  {
+    QVector<int> airportIds;
+    QVector<map::MapRef> navaidRefs;
+  };
+
+  typedef QHash<int, Nearest> NearestHash;
+
+  /* Called by watcher in GUI thread */
+  void loadFinished();
+
+  /* Runs in background thread. Reads file or calculates and writes file. */
+  NearestHash loadThread(QString dbFilename, QString cycle);
+
+  /* Calculate lists for all airports using a separate connection */
+  NearestHash calculate(const QString& dbFilename) const;
+
+  bool readFile(NearestHash& nearest, const QString& filename, qint64 databaseSize, qint64 databaseModified,
+                const QString& cycle) const;
+  void writeFile(const NearestHash& nearest, const QString& filename, qint64 databaseSize, qint64 databaseModified,
+                 const QString& cycle) const;
+
+  /* Terminate and wait for thread */
+  void terminateThread();
+
+  static const quint32 FILE_MAGIC = 0x4E524E4C; /* "LNRN" */
+
+  /* Increment when changing the file format or the radius and limits */
+  static const quint16 FILE_VERSION = 1;
+
+  NearestHash nearestHash;
+
+  QFuture<NearestHash> future;
+  QFutureWatcher<NearestHash> watcher;
+  bool terminateThreadSignal = false;
+};
+
+#endif // LNM_NEARESTSTORE_H
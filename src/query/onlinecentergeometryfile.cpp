@@ -0,0 +1,132 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "query/onlinecentergeometryfile.h"
+
+#include "geo/linestring.h"
+#include "sql/sqldatabase.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QFileInfo>
+#include <QSaveFile>
+
+OnlineCenterGeometryFile::OnlineCenterGeometryFile()
+{
+
+}
+
+OnlineCenterGeometryFile::~OnlineCenterGeometryFile()
+{
+  save();
+}
+
+void OnlineCenterGeometryFile::load(atools::sql::SqlDatabase *db)
+{
+  save();
+
+  QFileInfo databaseInfo(db->databaseName());
+  if(!databaseInfo.exists() || !databaseInfo.isFile())
+    // In memory or temporary database
+    return;
+
+  filename = databaseInfo.absoluteFilePath() + ".onlinecenters";
+  databaseSize = databaseInfo.size();
+  databaseModified = databaseInfo.lastModified().toMSecsSinceEpoch();
+
+  QFile file(filename);
+  if(!file.exists() || !file.open(QIODevice::ReadOnly))
+    return;
+
+  QDataStream stream(&file);
+  stream.setVersion(QDataStream::Qt_5_5);
+
+  quint32 magic, version;
+  qint64 size, modified;
+  stream >> magic >> version >> size >> modified;
+
+  if(magic != FILE_MAGIC || version != FILE_VERSION || size != databaseSize || modified != databaseModified)
+  {
+    qInfo() << Q_FUNC_INFO << "Outdated" << filename;
+    return;
+  }
+
+  stream >> geometries[BY_NAME] >> geometries[BY_FILE];
+
+  if(stream.status() != QDataStream::Ok)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot read" << filename;
+    geometries[BY_NAME].clear();
+    geometries[BY_FILE].clear();
+  }
+  else
+    qDebug() << Q_FUNC_INFO << "Loaded" << filename << geometries[BY_NAME].size() << geometries[BY_FILE].size();
+}
+
+void OnlineCenterGeometryFile::save()
+{
+  if(changed && !filename.isEmpty())
+  {
+    // Write to temporary file and rename when done
+    QSaveFile saveFile(filename);
+    if(saveFile.open(QIODevice::WriteOnly))
+    {
+      QDataStream stream(&saveFile);
+      stream.setVersion(QDataStream::Qt_5_5);
+      stream << FILE_MAGIC << FILE_VERSION << databaseSize << databaseModified << geometries[BY_NAME] << geometries[BY_FILE];
+
+      if(!saveFile.commit())
+        qWarning() << Q_FUNC_INFO << "Cannot write" << filename << saveFile.errorString();
+    }
+    else
+      qWarning() << Q_FUNC_INFO << "Cannot open" << filename << saveFile.errorString();
+  }
+
+  geometries[BY_NAME].clear();
+  geometries[BY_FILE].clear();
+  filename.clear();
+  changed = false;
+}
+
+bool OnlineCenterGeometryFile::getGeometry(atools::geo::LineString& lines, LookupType type, const QString& callsign) const
+{
+  GeometryHash::const_iterator it = geometries[type].constFind(callsign);
+  if(it == geometries[type].constEnd())
+    return false;
+
+  const QVector<float>& coords = it.value();
+  lines.clear();
+  lines.reserve(coords.size() / 2);
+  for(int i = 0; i + 1 < coords.size(); i += 2)
+    lines.append(atools::geo::Pos(coords.at(i), coords.at(i + 1)));
+  return true;
+}
+
+void OnlineCenterGeometryFile::insertGeometry(const atools::geo::LineString& lines, LookupType type, const QString& callsign)
+{
+  if(filename.isEmpty())
+    return;
+
+  QVector<float> coords;
+  coords.reserve(lines.size() * 2);
+  for(const atools::geo::Pos& pos : lines)
+    coords << pos.getLonX() << pos.getLatY();
+
+  geometries[type].insert(callsign, coords);
+  changed = true;
+}
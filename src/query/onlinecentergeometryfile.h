@@ -0,0 +1,87 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_ONLINECENTERGEOMETRYFILE_H
+#define LNM_ONLINECENTERGEOMETRYFILE_H
+
+#include <QHash>
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class LineString;
+}
+namespace sql {
+class SqlDatabase;
+}
+}
+
+/*
+ * Persistent mapping from online center callsigns to resolved boundary geometry.
+ *
+ * Keeps the results of the name and file name lookups in the user airspace database between sessions.
+ * Callsigns which could not be resolved are stored with empty geometry to avoid repeated lookups.
+ *
+ * The file is stored next to the database and discarded if the version, size or modification time of the
+ * database changes, i.e. after user airspaces are reloaded.
+ */
+class OnlineCenterGeometryFile
+{
+public:
+  /* Type of lookup which resolved the callsign */
+  enum LookupType
+  {
+    BY_NAME,
+    BY_FILE
+  };
+
+  OnlineCenterGeometryFile();
+  ~OnlineCenterGeometryFile();
+
+  OnlineCenterGeometryFile(const OnlineCenterGeometryFile& other) = delete;
+  OnlineCenterGeometryFile& operator=(const OnlineCenterGeometryFile& other) = delete;
+
+  /* Read file for the database. Starts with an empty mapping if missing or outdated. */
+  void load(atools::sql::SqlDatabase *db);
+
+  /* Write file if anything was added since loading and clear mapping */
+  void save();
+
+  /* Get geometry for callsign. Returns true if the callsign was resolved before. Lines are empty if no boundary
+   * was found for the callsign. */
+  bool getGeometry(atools::geo::LineString& lines, LookupType type, const QString& callsign) const;
+
+  /* Add resolved geometry or empty geometry if callsign has no boundary */
+  void insertGeometry(const atools::geo::LineString& lines, LookupType type, const QString& callsign);
+
+private:
+  /* Longitude/latitude pairs by callsign */
+  typedef QHash<QString, QVector<float> > GeometryHash;
+
+  GeometryHash geometries[2];
+
+  QString filename;
+  qint64 databaseSize = 0, databaseModified = 0;
+  bool changed = false;
+
+  static const quint32 FILE_MAGIC = 0x434F4E4C; /* "LNOC" */
+
+  /* Increment when changing the file format */
+  static const quint32 FILE_VERSION = 1;
+};
+
+#endif // LNM_ONLINECENTERGEOMETRYFILE_H
@@ -17,6 +17,7 @@
 
 #include "query/procedurequery.h"
 
+#include "common/memoryregistry.h"
 #include "common/proctypes.h"
 #include "common/unit.h"
 #include "fs/util/fsutil.h"
@@ -25,11 +26,14 @@
 #include "app/navapp.h"
 #include "query/airportquery.h"
 #include "query/mapquery.h"
+#include "query/procedurestore.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlrecord.h"
+#include "settings/settings.h"
 #include "fs/pln/flightplanconstants.h"
 
+#include <QElapsedTimer>
 #include <QStringBuilder>
 
 using atools::sql::SqlQuery;
@@ -50,14 +54,44 @@ using proc::MapSpeedRestriction;
 namespace pln = atools::fs::pln;
 namespace ageo = atools::geo;
 
+/* Maximum time in ms spent loading procedures per warm-up timer event */
+const static int WARMUP_SLICE_MS = 15;
+
+/* Pause between warm-up slices to keep event processing responsive */
+const static int WARMUP_INTERVAL_MS = 50;
+
+/* Number of procedures and transitions kept in memory. Large enough to hold the warmed up airports. */
+const static int CACHE_SIZE = 1000;
+
 ProcedureQuery::ProcedureQuery(atools::sql::SqlDatabase *sqlDbNav)
   : dbNav(sqlDbNav)
 {
+  procedureStore = new ProcedureStore;
+  warmupAirport = new map::MapAirport;
+
+  procedureCache.setMaxCost(CACHE_SIZE);
+  transitionCache.setMaxCost(CACHE_SIZE);
+
+  warmupTimer.setInterval(WARMUP_INTERVAL_MS);
+  QObject::connect(&warmupTimer, &QTimer::timeout, [this]() {
+    warmupStep();
+  });
+
+  // Average procedure has about 15 legs
+  MemoryRegistry::registerCaches(this, [this](QVector<memreg::Usage>& usage) -> void {
+    usage.append(memreg::cacheUsage("Procedures", "Procedures", procedureCache, 15 * sizeof(proc::MapProcedureLeg)));
+    usage.append(memreg::cacheUsage("Procedures", "Transitions", transitionCache, 15 * sizeof(proc::MapProcedureLeg)));
+  }, [this]() -> void {
+    clearCache();
+  });
 }
 
 ProcedureQuery::~ProcedureQuery()
 {
+  MemoryRegistry::unregisterCaches(this);
   deInitQueries();
+  delete procedureStore;
+  delete warmupAirport;
 }
 
 const proc::MapProcedureLegs *ProcedureQuery::getProcedureLegs(map::MapAirport airport, int procedureId)
@@ -695,8 +729,15 @@ proc::MapProcedureLegs *ProcedureQuery::fetchProcedureLegs(const map::MapAirport
     qDebug() << Q_FUNC_INFO << airport.ident << "procedureId" << procedureId;
 #endif
 
-    MapProcedureLegs *legs = buildProcedureLegs(airport, procedureId);
-    postProcessLegs(airport, *legs, true /*addArtificialLegs*/);
+    MapProcedureLegs *legs = new MapProcedureLegs;
+    if(!procedureStore->readProcedure(*legs, procedureId))
+    {
+      // Not in store - load from database and process
+      delete legs;
+      legs = buildProcedureLegs(airport, procedureId);
+      postProcessLegs(airport, *legs, true /*addArtificialLegs*/);
+      procedureStore->writeProcedure(*legs, procedureId);
+    }
 
     for(int i = 0; i < legs->size(); i++)
       procedureLegIndex.insert(legs->at(i).legId, std::make_pair(procedureId, i));
@@ -724,6 +765,17 @@ proc::MapProcedureLegs *ProcedureQuery::fetchTransitionLegs(const map::MapAirpor
              << "transitionId" << transitionId;
 #endif
 
+    proc::MapProcedureLegs *storedLegs = new proc::MapProcedureLegs;
+    if(procedureStore->readTransition(*storedLegs, transitionId))
+    {
+      for(int i = 0; i < storedLegs->size(); ++i)
+        transitionLegIndex.insert(storedLegs->at(i).legId, std::make_pair(transitionId, i));
+
+      transitionCache.insert(transitionId, storedLegs);
+      return storedLegs;
+    }
+    delete storedLegs;
+
     transitionLegQuery->bindValue(":id", transitionId);
     transitionLegQuery->exec();
 
@@ -768,6 +820,7 @@ proc::MapProcedureLegs *ProcedureQuery::fetchTransitionLegs(const map::MapAirpor
     transitionQuery->finish();
 
     postProcessLegs(airport, *legs, true /*addArtificialLegs*/);
+    procedureStore->writeTransition(*legs, transitionId);
 
     for(int i = 0; i < legs->size(); ++i)
       transitionLegIndex.insert(legs->at(i).legId, std::make_pair(transitionId, i));
@@ -1961,6 +2014,8 @@ void ProcedureQuery::initQueries()
 
   deInitQueries();
 
+  procedureStore->open(dbNav, NavApp::getDatabaseSim());
+
   procedureLegQuery = new SqlQuery(dbNav);
   procedureLegQuery->prepare("select * from approach_leg where approach_id = :id "
                              "order by approach_leg_id");
@@ -2025,10 +2080,18 @@ void ProcedureQuery::initQueries()
 
   transitionIdsForProcedureQuery = new SqlQuery(dbNav);
   transitionIdsForProcedureQuery->prepare("select transition_id from transition where approach_id = :id");
+
+  procedureIdsForAirportQuery = new SqlQuery(dbNav);
+  procedureIdsForAirportQuery->prepare("select approach_id from approach where airport_id = :id");
 }
 
 void ProcedureQuery::deInitQueries()
 {
+  stopWarmup();
+  warmupIdents.clear();
+
+  procedureStore->close();
+
   procedureCache.clear();
   transitionCache.clear();
   procedureLegIndex.clear();
@@ -2047,6 +2110,7 @@ void ProcedureQuery::deInitQueries()
   ATOOLS_DELETE(sidTransIdByWpQuery);
   ATOOLS_DELETE(starTransIdByWpQuery);
   ATOOLS_DELETE(transitionIdsForProcedureQuery);
+  ATOOLS_DELETE(procedureIdsForAirportQuery);
 }
 
 void ProcedureQuery::clearFlightplanProcedureProperties(QHash<QString, QString>& properties, const proc::MapProcedureTypes& type)
@@ -2544,6 +2608,107 @@ void ProcedureQuery::clearCache()
   transitionCache.clear();
   procedureLegIndex.clear();
   transitionLegIndex.clear();
+
+  procedureStore->optionsChanged();
+
+  // Warm up again on next route change
+  stopWarmup();
+  warmupIdents.clear();
+}
+
+void ProcedureQuery::warmupCache(const QVector<map::MapAirport>& airports)
+{
+  if(!atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_PROCEDURE_WARMUP, true).toBool())
+    return;
+
+  QStringList idents;
+  for(const map::MapAirport& airport : airports)
+  {
+    if(airport.isValid())
+      idents.append(airport.ident);
+  }
+
+  if(idents == warmupIdents)
+    // Same airports - either already done or in progress
+    return;
+
+  stopWarmup();
+  warmupIdents = idents;
+
+  for(map::MapAirport airport : airports)
+  {
+    if(airport.isValid())
+    {
+      NavApp::getMapQueryGui()->getAirportNavReplace(airport);
+      if(airport.isValid() && airport.navdata && !warmupAirportIds.contains(airport.id))
+        warmupAirportIds.append(airport.id);
+    }
+  }
+
+  if(!warmupAirportIds.isEmpty())
+  {
+    qDebug() << Q_FUNC_INFO << "Starting procedure warm-up for" << warmupIdents;
+    warmupTimer.start();
+  }
+}
+
+void ProcedureQuery::stopWarmup()
+{
+  warmupTimer.stop();
+  warmupAirportIds.clear();
+  warmupProcedures.clear();
+}
+
+void ProcedureQuery::warmupNextAirport()
+{
+  airportQueryNav->getAirportById(*warmupAirport, warmupAirportIds.takeFirst());
+
+  if(!warmupAirport->isValid() || !query::valid(Q_FUNC_INFO, procedureIdsForAirportQuery))
+    return;
+
+  QVector<int> procedureIds;
+  procedureIdsForAirportQuery->bindValue(":id", warmupAirport->id);
+  procedureIdsForAirportQuery->exec();
+  while(procedureIdsForAirportQuery->next())
+    procedureIds.append(procedureIdsForAirportQuery->value("approach_id").toInt());
+
+  // Procedures first since these are shown in the tree before transitions are expanded
+  for(int procedureId : procedureIds)
+    warmupProcedures.append(std::make_pair(procedureId, -1));
+
+  for(int procedureId : procedureIds)
+  {
+    for(int transitionId : getTransitionIdsForProcedure(procedureId))
+      warmupProcedures.append(std::make_pair(procedureId, transitionId));
+  }
+}
+
+void ProcedureQuery::warmupStep()
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  while(timer.elapsed() < WARMUP_SLICE_MS)
+  {
+    if(warmupProcedures.isEmpty())
+    {
+      if(warmupAirportIds.isEmpty())
+      {
+        qDebug() << Q_FUNC_INFO << "Procedure warm-up done for" << warmupIdents;
+        warmupTimer.stop();
+        return;
+      }
+      warmupNextAirport();
+    }
+    else
+    {
+      std::pair<int, int> ids = warmupProcedures.takeFirst();
+      if(ids.second == -1)
+        fetchProcedureLegs(*warmupAirport, ids.first);
+      else
+        fetchTransitionLegs(*warmupAirport, ids.first, ids.second);
+    }
+  }
 }
 
 QVector<int> ProcedureQuery::getTransitionIdsForProcedure(int procedureId)
@@ -23,6 +23,7 @@
 
 #include <QCache>
 #include <QCoreApplication>
+#include <QTimer>
 #include <functional>
 
 namespace atools {
@@ -47,6 +48,7 @@ struct MapResult;
 }
 class MapQuery;
 class AirportQuery;
+class ProcedureStore;
 
 /* Loads and caches procedures and transitions. Procedures include
  * final approaches, SID and STAR but excludes transitions.
@@ -162,6 +164,14 @@ public:
   /* Flush the cache to update units */
   void clearCache();
 
+  /* Load and process all procedures and transitions of the given airports in small time slices in the background
+   * to avoid delays when opening the procedure tree or the preview later.
+   * Does nothing if the set of airports did not change since the last call. */
+  void warmupCache(const QVector<map::MapAirport>& airports);
+
+  /* Stop warm-up and clear pending queue */
+  void stopWarmup();
+
   /* Create all queries */
   void initQueries();
 
@@ -250,13 +260,19 @@ private:
 
   QString runwayErrorString(const QString& runway);
 
+  /* Called by timer. Loads procedures of the warm-up queue until the time slice is used up */
+  void warmupStep();
+
+  /* Fill warm-up queue with all procedures and transitions for the next airport from warmupAirportIds */
+  void warmupNextAirport();
+
   atools::sql::SqlDatabase *dbNav;
   atools::sql::SqlQuery *procedureLegQuery = nullptr, *transitionLegQuery = nullptr,
                         *transitionIdForLegQuery = nullptr, *procedureIdForTransQuery = nullptr,
                         *runwayEndIdQuery = nullptr, *transitionQuery = nullptr, *procedureQuery = nullptr,
                         *transitionIdByNameQuery = nullptr, *sidTransIdByWpQuery = nullptr, *starTransIdByWpQuery = nullptr,
                         *procedureIdByNameQuery = nullptr, *procedureIdByArincNameQuery = nullptr,
-                        *transitionIdsForProcedureQuery = nullptr;
+                        *transitionIdsForProcedureQuery = nullptr, *procedureIdsForAirportQuery = nullptr;
 
   /* approach ID and transition ID to full lists
    * The procedure also has to be stored for transitions since the handover can modify procedure legs (CI legs, etc.) */
@@ -267,6 +283,17 @@ private:
 
   AirportQuery *airportQueryNav = nullptr;
 
+  /* Persistent store for processed procedures and transitions */
+  ProcedureStore *procedureStore;
+
+  /* Cache warm-up state. Idents of last requested airports, pending nav airport ids and
+   * procedure/transition ids for the current airport. Transition id is -1 for procedures. */
+  QTimer warmupTimer;
+  QStringList warmupIdents;
+  QList<int> warmupAirportIds;
+  QList<std::pair<int, int> > warmupProcedures;
+  map::MapAirport *warmupAirport;
+
   /* Dummy used for custom approaches. */
   Q_DECL_CONSTEXPR static int CUSTOM_APPROACH_ID = 1000000000;
   Q_DECL_CONSTEXPR static int CUSTOM_DEPARTURE_ID = 1000000001;
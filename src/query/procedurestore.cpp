@@ -0,0 +1,479 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "query/procedurestore.h"
+
+#include "app/navapp.h"
+#include "common/constants.h"
+#include "common/proctypes.h"
+#include "common/unit.h"
+#include "geo/line.h"
+#include "geo/linestring.h"
+#include "geo/rect.h"
+#include "query/airportquery.h"
+#include "query/mapquery.h"
+#include "query/waypointtrackquery.h"
+#include "settings/settings.h"
+#include "sql/sqldatabase.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSaveFile>
+#include <QStringBuilder>
+
+using atools::geo::Pos;
+using atools::geo::Line;
+using atools::geo::LineString;
+using atools::geo::Rect;
+using proc::MapProcedureLeg;
+using proc::MapProcedureLegs;
+
+namespace {
+
+// Geometry ===========================================================================
+void writeLine(QDataStream& out, const Line& line)
+{
+  out << line.getPos1() << line.getPos2();
+}
+
+void readLine(QDataStream& in, Line& line)
+{
+  Pos pos1, pos2;
+  in >> pos1 >> pos2;
+  line = Line(pos1, pos2);
+}
+
+void writeLineString(QDataStream& out, const LineString& lineString)
+{
+  out << static_cast<qint32>(lineString.size());
+  for(const Pos& pos : lineString)
+    out << pos;
+}
+
+void readLineString(QDataStream& in, LineString& lineString)
+{
+  qint32 size;
+  in >> size;
+  lineString.clear();
+  lineString.reserve(size);
+  for(int i = 0; i < size && in.status() == QDataStream::Ok; i++)
+  {
+    Pos pos;
+    in >> pos;
+    lineString.append(pos);
+  }
+}
+
+// Navaids ===========================================================================
+template<typename TYPE>
+void writeIds(QDataStream& out, const QList<TYPE>& list)
+{
+  out << static_cast<qint32>(list.size());
+  for(const TYPE& obj : list)
+    out << static_cast<qint32>(obj.id);
+}
+
+QVector<int> readIds(QDataStream& in)
+{
+  qint32 size;
+  in >> size;
+  QVector<int> ids;
+  for(int i = 0; i < size && in.status() == QDataStream::Ok; i++)
+  {
+    qint32 id;
+    in >> id;
+    ids.append(id);
+  }
+  return ids;
+}
+
+void writeRunwayEnd(QDataStream& out, const map::MapRunwayEnd& end)
+{
+  out << static_cast<qint32>(end.id) << end.position << end.name << end.leftVasiType << end.rightVasiType << end.pattern
+      << end.heading << end.leftVasiPitch << end.rightVasiPitch << end.secondary << end.navdata;
+}
+
+void readRunwayEnd(QDataStream& in, map::MapRunwayEnd& end)
+{
+  qint32 id;
+  in >> id >> end.position >> end.name >> end.leftVasiType >> end.rightVasiType >> end.pattern
+  >> end.heading >> end.leftVasiPitch >> end.rightVasiPitch >> end.secondary >> end.navdata;
+  end.id = id;
+}
+
+/* Only types which are resolved by ProcedureQuery::buildLegEntry() are saved */
+void writeNavaids(QDataStream& out, const map::MapResult& result)
+{
+  writeIds(out, result.airports);
+  writeIds(out, result.vors);
+  writeIds(out, result.ndbs);
+  writeIds(out, result.waypoints);
+  writeIds(out, result.ils);
+
+  out << static_cast<qint32>(result.runwayEnds.size());
+  for(const map::MapRunwayEnd& end : result.runwayEnds)
+    writeRunwayEnd(out, end);
+}
+
+/* Load navaids again by id. Returns false if an object is not found in the database */
+bool readNavaids(QDataStream& in, map::MapResult& result)
+{
+  MapQuery *mapQuery = NavApp::getMapQueryGui();
+  AirportQuery *airportQuery = NavApp::getAirportQueryNav();
+  WaypointTrackQuery *waypointQuery = NavApp::getWaypointTrackQueryGui();
+  bool ok = true;
+
+  for(int id : readIds(in))
+  {
+    map::MapAirport airport = airportQuery->getAirportById(id);
+    ok &= airport.isValid();
+    result.airports.append(airport);
+  }
+
+  for(int id : readIds(in))
+  {
+    map::MapVor vor = mapQuery->getVorById(id);
+    ok &= vor.isValid();
+    result.vors.append(vor);
+  }
+
+  for(int id : readIds(in))
+  {
+    map::MapNdb ndb = mapQuery->getNdbById(id);
+    ok &= ndb.isValid();
+    result.ndbs.append(ndb);
+  }
+
+  for(int id : readIds(in))
+  {
+    map::MapWaypoint waypoint = waypointQuery->getWaypointById(id);
+    ok &= waypoint.isValid();
+    result.waypoints.append(waypoint);
+  }
+
+  for(int id : readIds(in))
+  {
+    map::MapIls ils = mapQuery->getIlsById(id);
+    ok &= ils.isValid();
+    result.ils.append(ils);
+  }
+
+  qint32 size;
+  in >> size;
+  for(int i = 0; i < size && in.status() == QDataStream::Ok; i++)
+  {
+    map::MapRunwayEnd end;
+    readRunwayEnd(in, end);
+    result.runwayEnds.append(end);
+  }
+
+  return ok;
+}
+
+// Legs ===========================================================================
+void writeLeg(QDataStream& out, const MapProcedureLeg& leg)
+{
+  out << leg.fixType << leg.fixIdent << leg.fixAirportIdent << leg.fixRegion
+      << leg.recFixType << leg.recFixIdent << leg.recFixRegion << leg.turnDirection << leg.arincDescrCode
+      << leg.displayText << leg.remarks
+      << leg.fixPos << leg.recFixPos << leg.interceptPos << leg.procedureTurnPos;
+
+  writeLine(out, leg.line);
+  writeLine(out, leg.holdLine);
+  writeLineString(out, leg.geometry);
+  writeNavaids(out, leg.navaids);
+  writeNavaids(out, leg.recNavaids);
+
+  out << static_cast<qint32>(leg.altRestriction.descriptor) << leg.altRestriction.alt1 << leg.altRestriction.alt2
+      << leg.altRestriction.verticalAngleAlt << leg.altRestriction.forceFinal
+      << static_cast<qint32>(leg.speedRestriction.descriptor) << leg.speedRestriction.speed
+      << static_cast<qint32>(leg.type) << static_cast<quint32>(leg.mapType)
+      << static_cast<qint32>(leg.airportId) << static_cast<qint32>(leg.procedureId)
+      << static_cast<qint32>(leg.transitionId) << static_cast<qint32>(leg.legId)
+      << leg.course << leg.distance << leg.calculatedDistance << leg.calculatedTrueCourse << leg.time
+      << leg.theta << leg.rho << leg.magvar << leg.verticalAngle << leg.rnp
+      << leg.missed << leg.flyover << leg.trueCourse << leg.intercept << leg.disabled << leg.correctedArc << leg.malteseCross;
+}
+
+bool readLeg(QDataStream& in, MapProcedureLeg& leg)
+{
+  in >> leg.fixType >> leg.fixIdent >> leg.fixAirportIdent >> leg.fixRegion
+  >> leg.recFixType >> leg.recFixIdent >> leg.recFixRegion >> leg.turnDirection >> leg.arincDescrCode
+  >> leg.displayText >> leg.remarks
+  >> leg.fixPos >> leg.recFixPos >> leg.interceptPos >> leg.procedureTurnPos;
+
+  readLine(in, leg.line);
+  readLine(in, leg.holdLine);
+  readLineString(in, leg.geometry);
+  bool ok = readNavaids(in, leg.navaids);
+  ok &= readNavaids(in, leg.recNavaids);
+
+  qint32 altDescriptor, speedDescriptor, type, airportId, procedureId, transitionId, legId;
+  quint32 mapType;
+  in >> altDescriptor >> leg.altRestriction.alt1 >> leg.altRestriction.alt2
+  >> leg.altRestriction.verticalAngleAlt >> leg.altRestriction.forceFinal
+  >> speedDescriptor >> leg.speedRestriction.speed
+  >> type >> mapType >> airportId >> procedureId >> transitionId >> legId
+  >> leg.course >> leg.distance >> leg.calculatedDistance >> leg.calculatedTrueCourse >> leg.time
+  >> leg.theta >> leg.rho >> leg.magvar >> leg.verticalAngle >> leg.rnp
+  >> leg.missed >> leg.flyover >> leg.trueCourse >> leg.intercept >> leg.disabled >> leg.correctedArc >> leg.malteseCross;
+
+  leg.altRestriction.descriptor = static_cast<proc::MapAltRestriction::Descriptor>(altDescriptor);
+  leg.speedRestriction.descriptor = static_cast<proc::MapSpeedRestriction::Descriptor>(speedDescriptor);
+  leg.type = static_cast<proc::ProcedureLegType>(type);
+  leg.mapType = proc::MapProcedureTypes(static_cast<int>(mapType));
+  leg.airportId = airportId;
+  leg.procedureId = procedureId;
+  leg.transitionId = transitionId;
+  leg.legId = legId;
+
+  return ok;
+}
+
+void writeLegs(QDataStream& out, const QVector<MapProcedureLeg>& legs)
+{
+  out << static_cast<qint32>(legs.size());
+  for(const MapProcedureLeg& leg : legs)
+    writeLeg(out, leg);
+}
+
+bool readLegs(QDataStream& in, QVector<MapProcedureLeg>& legs)
+{
+  qint32 size;
+  in >> size;
+  bool ok = true;
+  legs.clear();
+  for(int i = 0; i < size && in.status() == QDataStream::Ok; i++)
+  {
+    MapProcedureLeg leg;
+    ok &= readLeg(in, leg);
+    legs.append(leg);
+  }
+  return ok;
+}
+
+}
+
+// ===========================================================================
+ProcedureStore::ProcedureStore()
+{
+
+}
+
+ProcedureStore::~ProcedureStore()
+{
+  close();
+}
+
+void ProcedureStore::open(atools::sql::SqlDatabase *db, atools::sql::SqlDatabase *dbSim)
+{
+  close();
+
+  enabled = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_PROCEDURE_STORE, true).toBool();
+  if(!enabled)
+    return;
+
+  QFileInfo databaseInfo(db->databaseName());
+  if(!databaseInfo.exists() || !databaseInfo.isFile())
+  {
+    // In memory or temporary database
+    enabled = false;
+    return;
+  }
+
+  filename = databaseInfo.absoluteFilePath() + ".procedures";
+  cycle = NavApp::getDatabaseAiracCycleNav();
+  signature = displaySignature();
+  databaseSize = databaseInfo.size();
+  databaseModified = databaseInfo.lastModified().toMSecsSinceEpoch();
+  simDatabase = databaseIdentity(dbSim);
+
+  QFile file(filename);
+  if(file.exists() && file.open(QIODevice::ReadOnly))
+  {
+    QElapsedTimer timer;
+    timer.start();
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_5);
+
+    quint32 magic;
+    quint16 version;
+    qint64 fileDatabaseSize, fileDatabaseModified;
+    QString fileCycle, fileSignature, fileSimDatabase;
+    in >> magic >> version;
+
+    if(magic == FILE_MAGIC && version == FILE_VERSION)
+    {
+      in >> fileDatabaseSize >> fileDatabaseModified >> fileCycle >> fileSignature >> fileSimDatabase;
+
+      if(fileDatabaseSize == databaseSize && fileDatabaseModified == databaseModified &&
+         fileCycle == cycle && fileSignature == signature && fileSimDatabase == simDatabase)
+      {
+        in >> entries;
+
+        if(in.status() != QDataStream::Ok)
+        {
+          qWarning() << Q_FUNC_INFO << "Error reading" << filename;
+          entries.clear();
+        }
+        else
+          qDebug() << Q_FUNC_INFO << "Read" << entries.size() << "procedures from" << filename << "in" << timer.elapsed() << "ms";
+      }
+      else
+        qInfo() << Q_FUNC_INFO << "Outdated" << filename;
+    }
+    else
+      qInfo() << Q_FUNC_INFO << "Wrong magic number or version in" << filename;
+
+    file.close();
+  }
+}
+
+void ProcedureStore::close()
+{
+  if(enabled && changed && !filename.isEmpty())
+  {
+    QSaveFile saveFile(filename);
+    if(saveFile.open(QIODevice::WriteOnly))
+    {
+      QDataStream out(&saveFile);
+      out.setVersion(QDataStream::Qt_5_5);
+      out << FILE_MAGIC << FILE_VERSION << databaseSize << databaseModified << cycle << signature << simDatabase << entries;
+
+      if(saveFile.commit())
+        qDebug() << Q_FUNC_INFO << "Written" << entries.size() << "procedures to" << filename;
+      else
+        qWarning() << Q_FUNC_INFO << "Cannot write" << filename << saveFile.errorString();
+    }
+    else
+      qWarning() << Q_FUNC_INFO << "Cannot open" << filename << saveFile.errorString();
+  }
+
+  entries.clear();
+  filename.clear();
+  changed = enabled = false;
+}
+
+void ProcedureStore::optionsChanged()
+{
+  QString newSignature = displaySignature();
+  if(newSignature != signature)
+  {
+    if(!entries.isEmpty())
+      changed = true;
+    entries.clear();
+    signature = newSignature;
+  }
+}
+
+bool ProcedureStore::read(proc::MapProcedureLegs& legs, qint64 key) const
+{
+  if(!enabled)
+    return false;
+
+  auto it = entries.constFind(key);
+  if(it == entries.constEnd())
+    return false;
+
+  QDataStream in(it.value());
+  in.setVersion(QDataStream::Qt_5_5);
+
+  bool ok = readLegs(in, legs.transitionLegs);
+  ok &= readLegs(in, legs.procedureLegs);
+
+  qint32 airportId, runwayEndId, procedureId, transitionId, legId;
+  quint32 refMapType, mapType;
+  Pos topLeft, bottomRight;
+  bool boundingValid;
+  in >> airportId >> runwayEndId >> procedureId >> transitionId >> legId >> refMapType
+  >> boundingValid >> topLeft >> bottomRight
+  >> legs.type >> legs.suffix >> legs.procedureFixIdent >> legs.arincName >> legs.transitionType >> legs.transitionFixIdent
+  >> legs.runway >> legs.aircraftCategory;
+
+  readRunwayEnd(in, legs.runwayEnd);
+
+  in >> mapType >> legs.procedureDistance >> legs.transitionDistance >> legs.missedDistance >> legs.previewColor
+  >> legs.customAltitude >> legs.customDistance >> legs.customOffset
+  >> legs.gpsOverlay >> legs.hasError >> legs.hasHardError >> legs.circleToLand >> legs.rnp >> legs.verticalAngle;
+
+  legs.ref = proc::MapProcedureRef(airportId, runwayEndId, procedureId, transitionId, legId,
+                                   proc::MapProcedureTypes(static_cast<int>(refMapType)));
+  legs.mapType = proc::MapProcedureTypes(static_cast<int>(mapType));
+  legs.bounding = boundingValid ? Rect(topLeft.getLonX(), topLeft.getLatY(), bottomRight.getLonX(), bottomRight.getLatY()) : Rect();
+
+  if(!ok || in.status() != QDataStream::Ok)
+  {
+    // Navaid not found or damaged entry - let the caller build it again
+    qWarning() << Q_FUNC_INFO << "Cannot read procedure for key" << key;
+    legs = proc::MapProcedureLegs();
+    return false;
+  }
+  return true;
+}
+
+void ProcedureStore::write(const proc::MapProcedureLegs& legs, qint64 key)
+{
+  if(!enabled)
+    return;
+
+  QByteArray bytes;
+  QDataStream out(&bytes, QIODevice::WriteOnly);
+  out.setVersion(QDataStream::Qt_5_5);
+
+  writeLegs(out, legs.transitionLegs);
+  writeLegs(out, legs.procedureLegs);
+
+  out << static_cast<qint32>(legs.ref.airportId) << static_cast<qint32>(legs.ref.runwayEndId)
+      << static_cast<qint32>(legs.ref.procedureId) << static_cast<qint32>(legs.ref.transitionId)
+      << static_cast<qint32>(legs.ref.legId) << static_cast<quint32>(legs.ref.mapType)
+      << legs.bounding.isValid() << legs.bounding.getTopLeft() << legs.bounding.getBottomRight()
+      << legs.type << legs.suffix << legs.procedureFixIdent << legs.arincName << legs.transitionType << legs.transitionFixIdent
+      << legs.runway << legs.aircraftCategory;
+
+  writeRunwayEnd(out, legs.runwayEnd);
+
+  out << static_cast<quint32>(legs.mapType) << legs.procedureDistance << legs.transitionDistance << legs.missedDistance
+      << legs.previewColor << legs.customAltitude << legs.customDistance << legs.customOffset
+      << legs.gpsOverlay << legs.hasError << legs.hasHardError << legs.circleToLand << legs.rnp << legs.verticalAngle;
+
+  entries.insert(key, bytes);
+  changed = true;
+}
+
+QString ProcedureStore::displaySignature()
+{
+  // Distance texts are added to display texts and remarks
+  return QLocale().name() % "|" % Unit::distNm(1.f, true, 20, true);
+}
+
+QString ProcedureStore::databaseIdentity(atools::sql::SqlDatabase *db)
+{
+  if(db == nullptr)
+    return QString();
+
+  QFileInfo databaseInfo(db->databaseName());
+  if(!databaseInfo.exists() || !databaseInfo.isFile())
+    return QString();
+
+  return databaseInfo.absoluteFilePath() % "|" % QString::number(databaseInfo.size()) % "|" %
+         QString::number(databaseInfo.lastModified().toMSecsSinceEpoch());
+}
@@ -0,0 +1,116 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_PROCEDURESTORE_H
+#define LNM_PROCEDURESTORE_H
+
+#include <QHash>
+#include <QString>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+namespace proc {
+struct MapProcedureLegs;
+}
+
+class QDataStream;
+
+/*
+ * File based store for fully processed procedures and transitions including leg geometry, display texts and
+ * navaid references. Avoids building and post processing procedures from the database after each start.
+ *
+ * The file is kept next to the navdata database and is discarded if version, size or modification time of the
+ * database, the AIRAC cycle or the units and language for display texts change. Path, size and modification time
+ * of the simulator database are checked too since airport elevations and runway ends are taken from there.
+ *
+ * Navaids are saved by id and are loaded by id again when reading an entry. Runway ends are saved completely
+ * since they can be artificial.
+ */
+class ProcedureStore
+{
+public:
+  ProcedureStore();
+  ~ProcedureStore();
+
+  ProcedureStore(const ProcedureStore& other) = delete;
+  ProcedureStore& operator=(const ProcedureStore& other) = delete;
+
+  /* Load the store for the navdata database if enabled in options. Content is dropped if outdated.
+   * dbSim is the simulator database used for airport and runway information in procedures. */
+  void open(atools::sql::SqlDatabase *db, atools::sql::SqlDatabase *dbSim);
+
+  /* Write changes back to file and clear */
+  void close();
+
+  /* Drop all entries if units or language changed since display texts depend on these. Call after changing options. */
+  void optionsChanged();
+
+  /* Read procedure or transition into legs. Returns false if not found. */
+  bool readProcedure(proc::MapProcedureLegs& legs, int procedureId) const
+  {
+    return read(legs, key(procedureId, false));
+  }
+
+  bool readTransition(proc::MapProcedureLegs& legs, int transitionId) const
+  {
+    return read(legs, key(transitionId, true));
+  }
+
+  /* Add fully processed procedure or transition */
+  void writeProcedure(const proc::MapProcedureLegs& legs, int procedureId)
+  {
+    write(legs, key(procedureId, false));
+  }
+
+  void writeTransition(const proc::MapProcedureLegs& legs, int transitionId)
+  {
+    write(legs, key(transitionId, true));
+  }
+
+private:
+  static qint64 key(int id, bool transition)
+  {
+    return (static_cast<qint64>(id) << 1) | (transition ? 1 : 0);
+  }
+
+  bool read(proc::MapProcedureLegs& legs, qint64 key) const;
+  void write(const proc::MapProcedureLegs& legs, qint64 key);
+
+  /* Units and language which are used to build display texts */
+  static QString displaySignature();
+
+  /* Path, size and modification time of the database file. Empty for in memory databases. */
+  static QString databaseIdentity(atools::sql::SqlDatabase *db);
+
+  static const quint32 FILE_MAGIC = 0x504E4C50; /* "PLNP" */
+
+  /* Increment when changing the file format or structures in proctypes.h */
+  static const quint16 FILE_VERSION = 2;
+
+  QString filename, cycle, signature, simDatabase;
+  qint64 databaseSize = 0L, databaseModified = 0L;
+
+  /* Serialized MapProcedureLegs by key */
+  QHash<qint64, QByteArray> entries;
+  bool changed = false, enabled = false;
+};
+
+#endif // LNM_PROCEDURESTORE_H
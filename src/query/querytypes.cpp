@@ -17,13 +17,38 @@
 
 #include "query/querytypes.h"
 
-#include "sql/sqlquery.h"
+#include "atools.h"
 #include "geo/rect.h"
+#include "mapgui/maplayer.h"
+#include "sql/sqlquery.h"
+
+#include <QAtomicInteger>
 
 using namespace Marble;
 
 namespace query {
 
+static QAtomicInteger<quint32> revisionCounters[REV_NUM_DOMAINS];
+
+quint32 revision(RevisionDomain domain)
+{
+  return revisionCounters[domain].loadAcquire();
+}
+
+void incrementRevision(RevisionDomain domain)
+{
+  revisionCounters[domain].fetchAndAddOrdered(1);
+}
+
+quint64 revisionKey(std::initializer_list<RevisionDomain> domains)
+{
+  // Counters never decrease so the sum changes with every increment
+  quint64 key = 0;
+  for(RevisionDomain domain : domains)
+    key += revisionCounters[domain].loadAcquire();
+  return key;
+}
+
 void inflateQueryRect(Marble::GeoDataLatLonBox& rect, double factor, double increment)
 {
   rect.scale(1. + factor, 1. + factor);
@@ -87,6 +112,73 @@ const QList<Marble::GeoDataLatLonBox> splitAtAntiMeridian(const Marble::GeoDataL
     return QList<GeoDataLatLonBox>({newRect});
 }
 
+int rectCacheTileSize(const MapLayer *mapLayer)
+{
+  // Tile sizes in 1/100 degree - all divide 180 and 360 degree without remainder
+  static const QVector<int> TILE_SIZES({25, 50, 100, 200, 300, 500, 1000, 1500, 3000, 4500, 9000});
+
+  if(mapLayer == nullptr)
+    return TILE_SIZES.constLast();
+
+  // Maximum range of layer is roughly the visible width - about 111 km per degree
+  int size = static_cast<int>(mapLayer->getMaxRange() / 111.f / 2.f * 100.f);
+  for(int tileSize : TILE_SIZES)
+  {
+    if(tileSize >= size)
+      return tileSize;
+  }
+  return TILE_SIZES.constLast();
+}
+
+const QVector<RectCacheTileKey> rectCacheTiles(const Marble::GeoDataLatLonBox& rect, int tileSize, double factor, double increment)
+{
+  QVector<RectCacheTileKey> tiles;
+  if(rect.isEmpty())
+    return tiles;
+
+  double size = tileSize / 100.;
+  int maxX = static_cast<int>(std::round(360. / size)) - 1;
+  int maxY = static_cast<int>(std::round(180. / size)) - 1;
+
+  // Inflated rectangle might be split in a western and an eastern part
+  for(const GeoDataLatLonBox& r : splitAtAntiMeridian(rect, factor, increment))
+  {
+    int x1 = atools::minmax(0, maxX, static_cast<int>(std::floor((r.west(GeoDataCoordinates::Degree) + 180.) / size)));
+    int x2 = atools::minmax(0, maxX, static_cast<int>(std::floor((r.east(GeoDataCoordinates::Degree) + 180.) / size)));
+    int y1 = atools::minmax(0, maxY, static_cast<int>(std::floor((r.south(GeoDataCoordinates::Degree) + 90.) / size)));
+    int y2 = atools::minmax(0, maxY, static_cast<int>(std::floor((r.north(GeoDataCoordinates::Degree) + 90.) / size)));
+
+    for(int y = y1; y <= y2; y++)
+    {
+      for(int x = x1; x <= x2; x++)
+      {
+        RectCacheTileKey key = {tileSize, x, y};
+        if(!tiles.contains(key))
+          tiles.append(key);
+      }
+    }
+  }
+  return tiles;
+}
+
+const RectCacheTileKey rectCacheTileForPos(double lonX, double latY, int tileSize)
+{
+  double size = tileSize / 100.;
+  int maxX = static_cast<int>(std::round(360. / size)) - 1;
+  int maxY = static_cast<int>(std::round(180. / size)) - 1;
+  return {tileSize,
+          atools::minmax(0, maxX, static_cast<int>(std::floor((lonX + 180.) / size))),
+          atools::minmax(0, maxY, static_cast<int>(std::floor((latY + 90.) / size)))};
+}
+
+const Marble::GeoDataLatLonBox rectCacheTileRect(const RectCacheTileKey& key)
+{
+  double size = key.size / 100.;
+  double west = key.x * size - 180.;
+  double south = key.y * size - 90.;
+  return GeoDataLatLonBox(std::min(south + size, 90.), south, std::min(west + size, 180.), west, GeoDataCoordinates::Degree);
+}
+
 void fetchObjectsForRect(const atools::geo::Rect& rect, atools::sql::SqlQuery *query, std::function<void(atools::sql::SqlQuery *)> callback)
 {
   for(const atools::geo::Rect& r : rect.splitAtAntiMeridian())
@@ -22,7 +22,10 @@
 #include "sql/sqlquery.h"
 #include "common/maptypes.h"
 
+#include <QCache>
 #include <QList>
+#include <QSet>
+#include <QVector>
 
 #include <functional>
 
@@ -42,6 +45,30 @@ class MapLayer;
 
 namespace query {
 
+/* Data domains having their own revision counter. The revision is incremented by the owning controller whenever
+ * the data changes. Caches remember the revisions they were filled with and drop their content lazily on the next
+ * access instead of being cleared on every change notification. */
+enum RevisionDomain
+{
+  REV_NAV_DB, /* Navdatabase was switched or reloaded */
+  REV_SIM_DB, /* Simulator scenery database was switched or reloaded */
+  REV_TRACKS, /* Tracks were loaded or deleted */
+  REV_USERPOINTS, /* User defined waypoints were added, changed or removed */
+  REV_LOGBOOK, /* Logbook entries were added, changed or removed */
+  REV_WEATHER, /* Any weather source including winds aloft was updated */
+  REV_ONLINE, /* Online clients or centers were updated */
+  REV_OPTIONS, /* Options were applied in the dialog */
+  REV_OPTIONS_UNITS, /* Units were changed in the options dialog */
+  REV_ROUTE, /* Flight plan, altitude, performance or wind calculation of the route changed */
+  REV_NUM_DOMAINS
+};
+
+quint32 revision(query::RevisionDomain domain);
+void incrementRevision(query::RevisionDomain domain);
+
+/* Key changing whenever one of the given domains changes. Usable for comparison only. */
+quint64 revisionKey(std::initializer_list<query::RevisionDomain> domains);
+
 /* Returns false and logs message if query is null */
 bool valid(const QString& function, const atools::sql::SqlQuery *query);
 
@@ -85,12 +112,198 @@ struct SimpleRectCache
   /* Clears list in case of overflow and returns true */
   bool validate(int queryMaxRows);
 
+  /* Number of objects held */
+  int objectCount() const
+  {
+    return list.size();
+  }
+
   Marble::GeoDataLatLonBox curRect;
   const MapLayer *curMapLayer = nullptr;
   QList<TYPE> list;
 
 };
 
+/* Key for a tile in TileRectCache. Size is given in 1/100 degree to avoid floating point comparison. */
+struct RectCacheTileKey
+{
+  int size; /* Tile size in 1/100 degree */
+  int x, y; /* Tile column from anti-meridian eastwards and row from south pole northwards */
+  quint32 params; /* Hash of query parameters used to load the tile. 0 if not used. */
+
+  bool operator==(const query::RectCacheTileKey& other) const
+  {
+    return size == other.size && x == other.x && y == other.y && params == other.params;
+  }
+
+  bool operator!=(const query::RectCacheTileKey& other) const
+  {
+    return !operator==(other);
+  }
+
+};
+
+inline uint qHash(const query::RectCacheTileKey& key)
+{
+  return ::qHash(key.size) ^ ::qHash((key.x << 16) | key.y) ^ ::qHash(key.params);
+}
+
+/* Build a hash for RectCacheTileKey::params from all values which change the result of a tile query */
+inline quint32 rectCacheTileParams(std::initializer_list<int> values)
+{
+  quint32 params = 17;
+  for(int value : values)
+    params = params * 31 + static_cast<quint32>(value);
+  return params;
+}
+
+/* Get tile size in 1/100 degree for the map layer. Uses about two tiles for the visible range of a layer. */
+int rectCacheTileSize(const MapLayer *mapLayer);
+
+/* Get all tiles covering the rectangle after inflating it. Handles anti-meridian crossing. */
+const QVector<RectCacheTileKey> rectCacheTiles(const Marble::GeoDataLatLonBox& rect, int tileSize, double factor, double increment);
+
+/* Get tile containing the given position */
+const RectCacheTileKey rectCacheTileForPos(double lonX, double latY, int tileSize);
+
+/* Get coordinate rectangle of tile. Never crosses the anti-meridian. */
+const Marble::GeoDataLatLonBox rectCacheTileRect(const RectCacheTileKey& key);
+
+/*
+ * Tiles of a TileRectCache. Can be shared between several caches, e.g. of different map widgets, which use the same
+ * databases. Tiles loaded with different query parameters are kept side by side since the parameters are part of the key.
+ * Not thread safe. Only to be used in the GUI thread.
+ */
+template<typename TYPE>
+struct TileStore
+{
+  TileStore()
+  {
+    tiles.setMaxCost(32768);
+  }
+
+  /* Approximate size of a tile in kB used as cache cost. Memory allocated by objects themselves is not counted.
+   * Limited to the maximum cost since QCache would drop larger tiles immediately. */
+  int tileCostKb(const QList<TYPE>& tileList) const
+  {
+    int costKb = static_cast<int>((tileList.size() * (sizeof(TYPE) + sizeof(void *)) + 1023) / 1024);
+    return std::max(1, std::min(costKb, tiles.maxCost()));
+  }
+
+  void clear()
+  {
+    tiles.clear();
+    generation++;
+  }
+
+  /* Cost is approximate size in kB */
+  QCache<RectCacheTileKey, QList<TYPE> > tiles;
+
+  /* Incremented each time all tiles are dropped. Allows to detect outdated prefetch results. */
+  quint32 generation = 0;
+};
+
+/*
+ * Spatial cache dividing the world into fixed lat/lon tiles where the tile size depends on the map layer.
+ * Only tiles not already loaded are fetched by calling the fetch function which runs the query for one tile.
+ * Tiles are kept in a least recently used cache which is limited by the approximate memory size of all tiles.
+ * The tiles are held in a TileStore which is either owned or shared with other caches.
+ *
+ * The list contains all objects of the tiles covering the last requested rectangle.
+ * Objects found in more than one tile are added only once.
+ */
+template<typename TYPE>
+struct TileRectCache
+{
+  /* Load all objects inside tileRect into list */
+  typedef std::function<void (const Marble::GeoDataLatLonBox& tileRect, QList<TYPE>& list)> TileFetchFunc;
+
+  TileRectCache()
+    : store(&ownStore)
+  {
+  }
+
+  TileRectCache(const TileRectCache& other) = delete;
+  TileRectCache& operator=(const TileRectCache& other) = delete;
+
+  /*
+   * @param rect bounding rectangle - all objects inside this rectangle are returned
+   * @param mapLayer current map layer
+   * @param lazy if true do not fetch new data but return the old potentially incomplete dataset
+   * @param params hash of all query parameters built with rectCacheTileParams(). Tiles are only reused for equal parameters.
+   * @param funcFetch called for each tile not found in the cache
+   * @return true if the list was rebuilt
+   */
+  bool updateCache(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, double factor, double increment,
+                   bool lazy, quint32 params, TileFetchFunc funcFetch);
+
+  /* Clear list and all tiles of the store which also affects other caches sharing the store */
+  void clear();
+
+  /* Clear only the list and keep the tiles of the store */
+  void clearList();
+
+  /* Use tiles of the given store instead of the own one. nullptr reverts to the own store. */
+  void setStore(TileStore<TYPE> *tileStore)
+  {
+    clearList();
+    store = tileStore == nullptr ? &ownStore : tileStore;
+  }
+
+  /* Removes tiles fetched in the last update which reached the query row limit and returns true if any.
+   * Also returns true if the merged list of all tiles reached the limit. Result persists until the list is rebuilt. */
+  bool validate(int queryMaxRows);
+
+  /* Maximum approximate size of all cached tiles in kB */
+  void setMaxSizeKb(int maxSizeKb)
+  {
+    store->tiles.setMaxCost(maxSizeKb);
+  }
+
+  /* Number of objects held in the list. Tiles are reported by the owner of the store. */
+  int objectCount() const
+  {
+    return list.size();
+  }
+
+  /* Drop all tiles to free memory but keep the list of the current rectangle which stays valid */
+  void evictTiles()
+  {
+    store->tiles.clear();
+    fetchedTiles.clear();
+    maxFetchedTileSize = 0;
+  }
+
+  /* true if tile is loaded. Key has to contain the query parameters. */
+  bool hasTile(const RectCacheTileKey& key) const
+  {
+    return store->tiles.contains(key);
+  }
+
+  /* Add a tile loaded elsewhere, e.g. by a background prefetch. Ignored if tile already exists.
+   * List is not updated before the next call of updateCache() changing the tile set. */
+  void insertTile(const RectCacheTileKey& key, const QList<TYPE>& tileList)
+  {
+    if(!store->tiles.contains(key))
+      store->tiles.insert(key, new QList<TYPE>(tileList), store->tileCostKb(tileList));
+  }
+
+  quint32 getGeneration() const
+  {
+    return store->generation;
+  }
+
+  TileStore<TYPE> ownStore;
+  TileStore<TYPE> *store;
+  QVector<RectCacheTileKey> curTiles, fetchedTiles;
+  const MapLayer *curMapLayer = nullptr;
+  quint32 curParams = 0;
+  int maxFetchedTileSize = 0;
+  bool overflow = false;
+  QList<TYPE> list;
+
+};
+
 // ---------------------------------------------------------------------------------
 
 template<typename TYPE>
@@ -146,6 +359,111 @@ void SimpleRectCache<TYPE>::clear()
   curMapLayer = nullptr;
 }
 
+// ---------------------------------------------------------------------------------
+
+template<typename TYPE>
+bool TileRectCache<TYPE>::updateCache(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, double factor,
+                                      double increment, bool lazy, quint32 params, TileFetchFunc funcFetch)
+{
+  if(lazy)
+    // Nothing changed
+    return false;
+
+  QVector<RectCacheTileKey> newTiles = query::rectCacheTiles(rect, query::rectCacheTileSize(mapLayer), factor, increment);
+
+#ifdef DEBUG_DISABLE_RECT_CACHE
+  // Force reload of all tiles
+  store->clear();
+  curTiles.clear();
+#endif
+
+  // Tiles loaded with other query parameters are not touched since they might be used by other caches sharing the store
+  for(RectCacheTileKey& key : newTiles)
+    key.params = params;
+
+  curMapLayer = mapLayer;
+  curParams = params;
+
+  if(newTiles == curTiles)
+    // Same tiles as in last call - list is still valid
+    return false;
+
+  list.clear();
+  fetchedTiles.clear();
+  maxFetchedTileSize = 0;
+  overflow = false;
+
+  QSet<int> ids;
+  for(const RectCacheTileKey& key : qAsConst(newTiles))
+  {
+    bool fetched = false;
+    QList<TYPE> *tileList = store->tiles.object(key);
+    if(tileList == nullptr)
+    {
+      // Tile not loaded yet or dropped from cache
+      tileList = new QList<TYPE>;
+      funcFetch(query::rectCacheTileRect(key), *tileList);
+      fetchedTiles.append(key);
+      maxFetchedTileSize = std::max(maxFetchedTileSize, static_cast<int>(tileList->size()));
+      fetched = true;
+    }
+
+    // Copy objects before inserting since the cache might delete the tile immediately
+    for(const TYPE& obj : qAsConst(*tileList))
+    {
+      if(!ids.contains(obj.id))
+      {
+        ids.insert(obj.id);
+        list.append(obj);
+      }
+    }
+
+    if(fetched)
+      store->tiles.insert(key, tileList, store->tileCostKb(*tileList));
+  }
+
+  curTiles = newTiles;
+  return true;
+}
+
+template<typename TYPE>
+bool TileRectCache<TYPE>::validate(int queryMaxRows)
+{
+  if(maxFetchedTileSize >= queryMaxRows)
+  {
+    // At least one tile is incomplete - remove fetched tiles to load them again when the view changes
+    for(const RectCacheTileKey& key : qAsConst(fetchedTiles))
+      store->tiles.remove(key);
+
+    fetchedTiles.clear();
+    maxFetchedTileSize = 0;
+    overflow = true;
+  }
+  else if(list.size() >= queryMaxRows)
+    // All tiles are complete but the view shows too many objects in total
+    overflow = true;
+  return overflow;
+}
+
+template<typename TYPE>
+void TileRectCache<TYPE>::clear()
+{
+  clearList();
+  store->clear();
+}
+
+template<typename TYPE>
+void TileRectCache<TYPE>::clearList()
+{
+  list.clear();
+  curTiles.clear();
+  fetchedTiles.clear();
+  curMapLayer = nullptr;
+  curParams = 0;
+  maxFetchedTileSize = 0;
+  overflow = false;
+}
+
 /* Get a record from the cache or get it from a database query */
 template<typename ID>
 const atools::sql::SqlRecord *cachedRecord(QCache<ID, atools::sql::SqlRecord>& cache, atools::sql::SqlQuery *query,
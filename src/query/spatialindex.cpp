@@ -0,0 +1,140 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+#include "query/spatialindex.h"
+
+#include "exception.h"
+#include "geo/rect.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlrecord.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QStringBuilder>
+#include <QStringList>
+
+using atools::sql::SqlQuery;
+
+/* Fixed precision of about 0.1 meter */
+static QString coordStr(float value)
+{
+  return QString::number(static_cast<double>(value), 'f', 6);
+}
+
+SpatialIndex::SpatialIndex(atools::sql::SqlDatabase *sqlDb, const QString& tableParam, const QString& idColumnParam)
+  : db(sqlDb), table(tableParam), idColumn(idColumnParam), rtreeTable("lnm_rtree_" + tableParam)
+{
+}
+
+SpatialIndex::~SpatialIndex()
+{
+  clear();
+}
+
+void SpatialIndex::clear()
+{
+  if(created && db->isOpen())
+  {
+    try
+    {
+      SqlQuery(db).exec("drop table if exists temp." % rtreeTable);
+    }
+    catch(atools::Exception& e)
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot drop" << rtreeTable << e.what();
+    }
+    catch(...)
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot drop" << rtreeTable;
+    }
+  }
+
+  created = failed = false;
+}
+
+bool SpatialIndex::create()
+{
+  if(created)
+    return true;
+
+  if(failed || !db->isOpen())
+    return false;
+
+  try
+  {
+    QElapsedTimer timer;
+    timer.start();
+
+    atools::sql::SqlRecord record = db->record(table);
+    if(!record.contains(idColumn) || !record.contains("lonx") || !record.contains("laty"))
+    {
+      failed = true;
+      return false;
+    }
+
+    SqlQuery query(db);
+    query.exec("drop table if exists temp." % rtreeTable);
+    query.exec("create virtual table temp." % rtreeTable % " using rtree(id, min_lonx, max_lonx, min_laty, max_laty)");
+    query.exec("insert into temp." % rtreeTable % " (id, min_lonx, max_lonx, min_laty, max_laty) "
+               "select " % idColumn % ", lonx, lonx, laty, laty from " % table %
+               " where lonx is not null and laty is not null");
+    created = true;
+
+    qDebug() << Q_FUNC_INFO << "Created" << rtreeTable << "in" << timer.elapsed() << "ms";
+  }
+  catch(atools::Exception& e)
+  {
+    // R*Tree module not compiled into SQLite - use between queries
+    qWarning() << Q_FUNC_INFO << "Cannot create" << rtreeTable << e.what();
+    failed = true;
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot create" << rtreeTable;
+    failed = true;
+  }
+
+  return created;
+}
+
+QString SpatialIndex::rectCondition(const QString& left, const QString& right, const QString& bottom, const QString& top) const
+{
+  return "select id from temp." % rtreeTable % " where max_lonx >= " % left % " and min_lonx <= " % right %
+         " and max_laty >= " % bottom % " and min_laty <= " % top;
+}
+
+QString SpatialIndex::condition(const atools::geo::Rect& rect)
+{
+  if(!rect.isValid() || !create())
+    return QString();
+
+  const QList<atools::geo::Rect> rects = rect.crossesAntiMeridian() ? rect.splitAtAntiMeridian() : QList<atools::geo::Rect>({rect});
+
+  QStringList selects;
+  for(const atools::geo::Rect& r : rects)
+    selects.append(rectCondition(coordStr(r.getWest()), coordStr(r.getEast()), coordStr(r.getSouth()), coordStr(r.getNorth())));
+
+  return idColumn % " in (" % selects.join(" union ") % ')';
+}
+
+QString SpatialIndex::conditionBind()
+{
+  if(!create())
+    return QString();
+
+  return idColumn % " in (" % rectCondition(":leftx", ":rightx", ":bottomy", ":topy") % ')';
+}
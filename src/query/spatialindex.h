@@ -0,0 +1,75 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+#ifndef LNM_SPATIALINDEX_H
+#define LNM_SPATIALINDEX_H
+
+#include <QString>
+
+namespace atools {
+namespace geo {
+class Rect;
+}
+namespace sql {
+class SqlDatabase;
+}
+}
+
+/*
+ * SQLite R*Tree index on the point coordinates "lonx" and "laty" of a table.
+ * The index is created in the temporary schema of the connection on first use which also works for
+ * read only databases. Ids of the index are the ids of the table.
+ *
+ * Coordinates are stored as 32 bit float values in the R*Tree which are rounded outwards.
+ * Conditions can therefore return a few more rows at the rectangle borders.
+ *
+ * Only one index per table and connection can exist. Only suitable for tables which are not
+ * modified while the index exists.
+ */
+class SpatialIndex
+{
+public:
+  SpatialIndex(atools::sql::SqlDatabase *sqlDb, const QString& tableParam, const QString& idColumnParam);
+  ~SpatialIndex();
+
+  SpatialIndex(const SpatialIndex& other) = delete;
+  SpatialIndex& operator=(const SpatialIndex& other) = delete;
+
+  /* Drop index. Needed before the database is closed or changed. Index is created again on next use. */
+  void clear();
+
+  /* Build condition like "airport_id in (select id from temp.lnm_rtree_airport where ...)" for the given rectangle.
+   * Rectangles crossing the anti-meridian are split and combined with "or".
+   * @return empty string if index creation failed */
+  QString condition(const atools::geo::Rect& rect);
+
+  /* Same as above but using the placeholders ":leftx", ":rightx", ":bottomy" and ":topy" for prepared queries.
+   * Index is created immediately since it has to exist when preparing the query.
+   * @return empty string if index creation failed */
+  QString conditionBind();
+
+private:
+  /* Create index if not done yet. Returns false if the R*Tree module is not available. */
+  bool create();
+
+  QString rectCondition(const QString& left, const QString& right, const QString& bottom, const QString& top) const;
+
+  atools::sql::SqlDatabase *db;
+  QString table, idColumn, rtreeTable;
+  bool created = false, failed = false;
+};
+
+#endif // LNM_SPATIALINDEX_H
@@ -154,28 +154,22 @@ const QList<map::MapWaypoint> *WaypointQuery::getWaypoints(const GeoDataLatLonBo
     return nullptr;
 
   waypointCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                            [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
+                            query::rectCacheTileParams({mapLayer->isWaypoint()}),
+                            [this](const GeoDataLatLonBox& tileRect, QList<MapWaypoint>& waypoints) -> void
   {
-    return curLayer->hasSameQueryParametersWaypoint(newLayer);
-  });
-
-  if(waypointCache.list.isEmpty() && !lazy)
-  {
-    for(const GeoDataLatLonBox& r : query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
+    query::bindRect(tileRect, waypointsByRectQuery);
+    waypointsByRectQuery->exec();
+    while(waypointsByRectQuery->next())
     {
-      query::bindRect(r, waypointsByRectQuery);
-      waypointsByRectQuery->exec();
-      while(waypointsByRectQuery->next())
-      {
-        map::MapWaypoint wp;
-        mapTypesFactory->fillWaypoint(waypointsByRectQuery->record(), wp, trackDatabase);
-
-        // Avoid artificial waypoints created only for procedure or airway resolution
-        if(wp.artificial == map::WAYPOINT_ARTIFICIAL_NONE)
-          waypointCache.list.append(wp);
-      }
+      map::MapWaypoint wp;
+      mapTypesFactory->fillWaypoint(waypointsByRectQuery->record(), wp, trackDatabase);
+
+      // Avoid artificial waypoints created only for procedure or airway resolution
+      if(wp.artificial == map::WAYPOINT_ARTIFICIAL_NONE)
+        waypoints.append(wp);
     }
-  }
+  });
+
   overflow = waypointCache.validate(queryMaxRowsWaypoints);
   return &waypointCache.list;
 }
@@ -187,27 +181,21 @@ const QList<MapWaypoint> *WaypointQuery::getWaypointsAirway(const Marble::GeoDat
     return nullptr;
 
   waypointAirwayCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                                  [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
+                                  query::rectCacheTileParams({mapLayer->isWaypoint(), mapLayer->isAirway(), mapLayer->isTrack()}),
+                                  [this](const GeoDataLatLonBox& tileRect, QList<MapWaypoint>& waypoints) -> void
   {
-    return curLayer->hasSameQueryParametersWaypoint(newLayer) && curLayer->hasSameQueryParametersAirwayTrack(newLayer);
-  });
-
-  if(waypointAirwayCache.list.isEmpty() && !lazy)
-  {
-    for(const GeoDataLatLonBox& r : query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
+    query::bindRect(tileRect, waypointsAirwayByRectQuery);
+    waypointsAirwayByRectQuery->exec();
+    while(waypointsAirwayByRectQuery->next())
     {
-      query::bindRect(r, waypointsAirwayByRectQuery);
-      waypointsAirwayByRectQuery->exec();
-      while(waypointsAirwayByRectQuery->next())
-      {
-        map::MapWaypoint wp;
-        mapTypesFactory->fillWaypoint(waypointsAirwayByRectQuery->record(), wp, trackDatabase);
-
-        // Also insert artificial waypoints
-        waypointAirwayCache.list.append(wp);
-      }
+      map::MapWaypoint wp;
+      mapTypesFactory->fillWaypoint(waypointsAirwayByRectQuery->record(), wp, trackDatabase);
+
+      // Also insert artificial waypoints
+      waypoints.append(wp);
     }
-  }
+  });
+
   overflow = waypointAirwayCache.validate(queryMaxRowsWaypoints);
   return &waypointAirwayCache.list;
 }
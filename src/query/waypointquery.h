@@ -97,8 +97,8 @@ private:
   MapTypesFactory *mapTypesFactory;
   atools::sql::SqlDatabase *dbNav;
 
-  /* Simple bounding rectangle caches */
-  query::SimpleRectCache<map::MapWaypoint> waypointCache, waypointAirwayCache;
+  /* Tiled bounding rectangle caches */
+  query::TileRectCache<map::MapWaypoint> waypointCache, waypointAirwayCache;
   QCache<int, atools::sql::SqlRecord> waypointInfoCache;
 
   static int queryMaxRowsWaypoints;
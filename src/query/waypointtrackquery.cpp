@@ -29,6 +29,7 @@ using map::MapWaypoint;
 WaypointTrackQuery::WaypointTrackQuery(WaypointQuery *waypointQueryParam, WaypointQuery *trackQueryParam)
   : waypointQuery(waypointQueryParam), trackQuery(trackQueryParam)
 {
+  initCaches();
 }
 
 WaypointTrackQuery::~WaypointTrackQuery()
@@ -61,12 +62,26 @@ MapWaypoint WaypointTrackQuery::getWaypointByNavId(int navId, map::MapType type)
 
 void WaypointTrackQuery::getWaypointByIdent(QList<map::MapWaypoint>& waypoints, const QString& ident, const QString& region)
 {
-  if(useTracks)
-    trackQuery->getWaypointByByIdent(waypoints, ident, region);
+  checkTrackRevision();
 
-  QList<map::MapWaypoint> navWaypoints;
-  waypointQuery->getWaypointByByIdent(navWaypoints, ident, region);
-  copy(navWaypoints, waypoints);
+  const QStringList key({ident, region});
+  QList<map::MapWaypoint> *waypointsObj = waypointByIdentCache.object(key);
+  if(waypointsObj == nullptr)
+  {
+    waypointsObj = new QList<map::MapWaypoint>;
+    if(useTracks)
+      trackQuery->getWaypointByByIdent(*waypointsObj, ident, region);
+
+    QList<map::MapWaypoint> navWaypoints;
+    waypointQuery->getWaypointByByIdent(navWaypoints, ident, region);
+    copy(navWaypoints, *waypointsObj);
+
+    copy(*waypointsObj, waypoints);
+    waypointByIdentCache.insert(key, waypointsObj);
+  }
+  else
+    // Copy waypoints from cache
+    copy(*waypointsObj, waypoints);
 }
 
 void WaypointTrackQuery::getNearestScreenObjects(const CoordinateConverter& conv, const MapLayer *mapLayer,
@@ -175,15 +190,40 @@ void WaypointTrackQuery::initQueries()
 
 void WaypointTrackQuery::deInitQueries()
 {
+  clearMergedCache();
   trackQuery->deInitQueries();
   waypointQuery->deInitQueries();
 }
 
 void WaypointTrackQuery::clearCache()
 {
+  clearMergedCache();
   trackQuery->clearCache();
 }
 
+void WaypointTrackQuery::initTrackQueries()
+{
+  clearMergedCache();
+  trackQuery->initQueries();
+}
+
+void WaypointTrackQuery::initCaches()
+{
+  waypointByIdentCache.setMaxCost(2000);
+}
+
+void WaypointTrackQuery::clearMergedCache()
+{
+  waypointByIdentCache.clear();
+  cacheTrackRevision = query::revision(query::REV_TRACKS);
+}
+
+void WaypointTrackQuery::checkTrackRevision()
+{
+  if(cacheTrackRevision != query::revision(query::REV_TRACKS))
+    clearMergedCache();
+}
+
 void WaypointTrackQuery::deleteChildren()
 {
   ATOOLS_DELETE(trackQuery);
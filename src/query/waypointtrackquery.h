@@ -20,6 +20,8 @@
 
 #include "query/querytypes.h"
 
+#include <QCache>
+
 namespace map {
 struct MapResult;
 }
@@ -47,15 +49,17 @@ public:
 
   WaypointTrackQuery(const WaypointTrackQuery& other)
   {
+    initCaches();
     this->operator=(other);
   }
 
-  /* Does a shallow copy. Query classes are not owned by this */
+  /* Does a shallow copy. Query classes are not owned by this. Merged result caches are not copied. */
   WaypointTrackQuery& operator=(const WaypointTrackQuery& other)
   {
     waypointQuery = other.waypointQuery;
     trackQuery = other.trackQuery;
     useTracks = other.useTracks;
+    clearMergedCache();
     return *this;
   }
 
@@ -105,10 +109,15 @@ public:
   /* Tracks loaded - clear caches */
   void clearCache();
 
+  /* Tracks loaded - prepare only the track queries again. Queries and caches for the
+   * nav database are not touched and stay warm. */
+  void initTrackQueries();
+
   /* Set to false to ignore track database. Create a copy of this before using this method. */
   void setUseTracks(bool value)
   {
     useTracks = value;
+    clearMergedCache();
   }
 
   bool isUseTracks() const
@@ -128,8 +137,22 @@ private:
   void copy(const QList<map::MapWaypoint>& from, QList<map::MapWaypoint>& to);
   void copy(const QVector<map::MapWaypoint>& from, QVector<map::MapWaypoint>& to);
 
+  void initCaches();
+
+  /* Clear caches holding merged trackpoint and waypoint results */
+  void clearMergedCache();
+
+  /* Clear merged caches if tracks were loaded or deleted since last call */
+  void checkTrackRevision();
+
   WaypointQuery *waypointQuery = nullptr, *trackQuery = nullptr;
   bool useTracks = true;
+
+  /* Merged trackpoints and waypoints by {ident, region}. Used a lot by route string parsing. */
+  QCache<QStringList, QList<map::MapWaypoint> > waypointByIdentCache;
+
+  /* Track revision at the time the merged cache was filled */
+  quint32 cacheTrackRevision = 0;
 };
 
 #endif // LITTLENAVMAP_WAYPOINTTRACKQUERY_H
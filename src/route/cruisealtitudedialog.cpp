@@ -0,0 +1,207 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "route/cruisealtitudedialog.h"
+
+#include "app/navapp.h"
+#include "atools.h"
+#include "common/constants.h"
+#include "common/formatter.h"
+#include "common/fueltool.h"
+#include "common/unit.h"
+#include "gui/itemviewzoomhandler.h"
+#include "gui/tools.h"
+#include "gui/widgetstate.h"
+#include "route/route.h"
+#include "route/routealtitude.h"
+#include "ui_cruisealtitudedialog.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QPushButton>
+
+namespace internal {
+
+enum Column
+{
+  ALTITUDE,
+  TRIP_FUEL,
+  TIME,
+  TOC,
+  TOD,
+  REMARKS,
+  COUNT = REMARKS + 1
+};
+
+/* Limit number of calculations if range is large and step is small */
+const static int MAX_ROWS = 50;
+
+}
+
+CruiseAltitudeDialog::CruiseAltitudeDialog(QWidget *parent, const Route& routeParam)
+  : QDialog(parent), ui(new Ui::CruiseAltitudeDialog), route(routeParam)
+{
+  setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+  setWindowModality(Qt::ApplicationModal);
+
+  ui->setupUi(this);
+
+  zoomHandler = new atools::gui::ItemViewZoomHandler(ui->tableWidgetCruiseAltitude);
+  atools::gui::adjustSelectionColors(ui->tableWidgetCruiseAltitude);
+
+  // Spin boxes use local altitude unit
+  QString suffix = tr(" %1").arg(Unit::getUnitAltStr());
+  for(QSpinBox *spinBox : {ui->spinBoxCruiseAltitudeFrom, ui->spinBoxCruiseAltitudeTo, ui->spinBoxCruiseAltitudeStep})
+    spinBox->setSuffix(suffix);
+
+  ui->spinBoxCruiseAltitudeStep->setValue(atools::roundToInt(Unit::altFeetF(1000.f) / 100.f) * 100);
+
+  restoreState();
+
+  // Center range around current cruise altitude
+  int cruiseAltLocal = atools::roundToInt(Unit::altFeetF(route.getCruiseAltitudeFt()));
+  int step = ui->spinBoxCruiseAltitudeStep->value();
+  ui->spinBoxCruiseAltitudeFrom->setValue(std::max(cruiseAltLocal - 4 * step, step));
+  ui->spinBoxCruiseAltitudeTo->setValue(cruiseAltLocal + 4 * step);
+
+  updateTable();
+  updateButtons();
+
+  connect(ui->spinBoxCruiseAltitudeFrom, QOverload<int>::of(&QSpinBox::valueChanged), this, &CruiseAltitudeDialog::updateTable);
+  connect(ui->spinBoxCruiseAltitudeTo, QOverload<int>::of(&QSpinBox::valueChanged), this, &CruiseAltitudeDialog::updateTable);
+  connect(ui->spinBoxCruiseAltitudeStep, QOverload<int>::of(&QSpinBox::valueChanged), this, &CruiseAltitudeDialog::updateTable);
+  connect(ui->tableWidgetCruiseAltitude, &QTableWidget::itemSelectionChanged, this, &CruiseAltitudeDialog::updateButtons);
+  connect(ui->tableWidgetCruiseAltitude, &QTableWidget::doubleClicked, this, &CruiseAltitudeDialog::doubleClicked);
+  connect(ui->buttonBoxCruiseAltitude, &QDialogButtonBox::clicked, this, &CruiseAltitudeDialog::buttonBoxClicked);
+}
+
+CruiseAltitudeDialog::~CruiseAltitudeDialog()
+{
+  saveState();
+
+  delete zoomHandler;
+  delete ui;
+}
+
+void CruiseAltitudeDialog::buttonBoxClicked(QAbstractButton *button)
+{
+  saveState();
+
+  if(button == ui->buttonBoxCruiseAltitude->button(QDialogButtonBox::Ok))
+    QDialog::accept();
+  else if(button == ui->buttonBoxCruiseAltitude->button(QDialogButtonBox::Cancel))
+    QDialog::reject();
+}
+
+void CruiseAltitudeDialog::doubleClicked()
+{
+  saveState();
+  QDialog::accept();
+}
+
+float CruiseAltitudeDialog::getSelectedCruiseAltitudeFt() const
+{
+  const QTableWidgetItem *item = ui->tableWidgetCruiseAltitude->currentItem();
+  if(item != nullptr && ui->tableWidgetCruiseAltitude->selectionModel()->hasSelection())
+    return rowAltitudesFt.value(item->row(), map::INVALID_ALTITUDE_VALUE);
+  else
+    return map::INVALID_ALTITUDE_VALUE;
+}
+
+void CruiseAltitudeDialog::updateTable()
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  QTableWidget *table = ui->tableWidgetCruiseAltitude;
+  int from = ui->spinBoxCruiseAltitudeFrom->value(), to = ui->spinBoxCruiseAltitudeTo->value(),
+      step = std::max(ui->spinBoxCruiseAltitudeStep->value(), 1);
+
+  // Collect altitudes in local unit ========================================================
+  rowAltitudesFt.clear();
+  for(int altLocal = from; altLocal <= to && rowAltitudesFt.size() < internal::MAX_ROWS; altLocal += step)
+    rowAltitudesFt.append(Unit::rev(static_cast<float>(altLocal), Unit::altFeetF));
+
+  const atools::fs::perf::AircraftPerf& perf = NavApp::getAircraftPerformance();
+  FuelTool fuel(perf);
+  float currentCruiseAltLocal = Unit::altFeetF(route.getCruiseAltitudeFt());
+
+  table->clearContents();
+  table->setColumnCount(internal::COUNT);
+  table->setRowCount(rowAltitudesFt.size());
+  table->setHorizontalHeaderLabels({tr(" Cruise\nAltitude "), tr(" Trip\nFuel "), tr(" Time "),
+                                    tr(" Top of Climb\nfrom Departure "), tr(" Top of Descent\nto Destination "),
+                                    tr(" Remarks ")});
+
+  // Calculate each altitude on a copy of the altitude legs ==================================
+  for(int row = 0; row < rowAltitudesFt.size(); row++)
+  {
+    float altFt = rowAltitudesFt.at(row);
+    RouteAltitude altitudeLegs = route.calculateAltitudeLegsForCruise(altFt);
+
+    QVector<QTableWidgetItem *> items(internal::COUNT, nullptr);
+    items[internal::ALTITUDE] = new QTableWidgetItem(Unit::altFeet(altFt));
+
+    if(altitudeLegs.isValidProfile())
+    {
+      items[internal::TRIP_FUEL] = new QTableWidgetItem(fuel.weightVolLocal(altitudeLegs.getTripFuel()));
+      items[internal::TIME] = new QTableWidgetItem(formatter::formatMinutesHoursLong(altitudeLegs.getTravelTimeHours()));
+      items[internal::TOC] = new QTableWidgetItem(Unit::distNm(altitudeLegs.getTopOfClimbDistance()));
+      items[internal::TOD] = new QTableWidgetItem(Unit::distNm(altitudeLegs.getTopOfDescentFromDestination()));
+    }
+
+    QStringList remarks;
+    if(atools::almostEqual(Unit::altFeetF(altFt), currentCruiseAltLocal, 1.f))
+      remarks.append(tr("Current"));
+    if(altitudeLegs.hasUnflyableLegs())
+      remarks.append(tr("Unflyable legs"));
+    if(altitudeLegs.hasErrors())
+      remarks.append(altitudeLegs.getErrorStrings());
+    items[internal::REMARKS] = new QTableWidgetItem(remarks.join(tr(", ")));
+
+    for(int col = 0; col < internal::COUNT; col++)
+    {
+      if(items.at(col) == nullptr)
+        items[col] = new QTableWidgetItem(tr("-"));
+
+      if(col != internal::REMARKS)
+        items[col]->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      table->setItem(row, col, items.at(col));
+    }
+  }
+
+  table->resizeColumnsToContents();
+  updateButtons();
+
+  qDebug() << Q_FUNC_INFO << rowAltitudesFt.size() << "altitudes calculated in" << timer.elapsed() << "ms";
+}
+
+void CruiseAltitudeDialog::updateButtons()
+{
+  ui->buttonBoxCruiseAltitude->button(QDialogButtonBox::Ok)->
+  setEnabled(getSelectedCruiseAltitudeFt() < map::INVALID_ALTITUDE_VALUE);
+}
+
+void CruiseAltitudeDialog::saveState()
+{
+  atools::gui::WidgetState(lnm::ROUTE_CRUISE_ALTITUDE_DIALOG).save({this, ui->spinBoxCruiseAltitudeStep});
+}
+
+void CruiseAltitudeDialog::restoreState()
+{
+  atools::gui::WidgetState(lnm::ROUTE_CRUISE_ALTITUDE_DIALOG).restore({this, ui->spinBoxCruiseAltitudeStep});
+}
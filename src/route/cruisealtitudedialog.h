@@ -0,0 +1,71 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_CRUISEALTITUDEDIALOG_H
+#define LITTLENAVMAP_CRUISEALTITUDEDIALOG_H
+
+#include <QDialog>
+
+namespace Ui {
+class CruiseAltitudeDialog;
+}
+
+namespace atools {
+namespace gui {
+class ItemViewZoomHandler;
+}
+}
+
+class Route;
+class QAbstractButton;
+
+/*
+ * Compares trip fuel, time and top of climb/descent for a range of cruise altitudes.
+ * The flight plan is not changed. The selected altitude can be fetched after the dialog was accepted.
+ */
+class CruiseAltitudeDialog :
+  public QDialog
+{
+  Q_OBJECT
+
+public:
+  explicit CruiseAltitudeDialog(QWidget *parent, const Route& routeParam);
+  virtual ~CruiseAltitudeDialog() override;
+
+  CruiseAltitudeDialog(const CruiseAltitudeDialog& other) = delete;
+  CruiseAltitudeDialog& operator=(const CruiseAltitudeDialog& other) = delete;
+
+  /* Cruise altitude in feet of the selected row or INVALID_ALTITUDE_VALUE if nothing is selected */
+  float getSelectedCruiseAltitudeFt() const;
+
+private:
+  void saveState();
+  void restoreState();
+  void updateTable();
+  void updateButtons();
+  void buttonBoxClicked(QAbstractButton *button);
+  void doubleClicked();
+
+  Ui::CruiseAltitudeDialog *ui;
+  atools::gui::ItemViewZoomHandler *zoomHandler = nullptr;
+  const Route& route;
+
+  /* Cruise altitude in feet for each table row */
+  QVector<float> rowAltitudesFt;
+};
+
+#endif // LITTLENAVMAP_CRUISEALTITUDEDIALOG_H
@@ -18,6 +18,7 @@
 #include "route/flightplanentrybuilder.h"
 
 #include "common/proctypes.h"
+#include "fs/pln/flightplan.h"
 #include "fs/pln/flightplanentry.h"
 #include "query/mapquery.h"
 #include "app/navapp.h"
@@ -28,6 +29,28 @@ FlightplanEntryBuilder::FlightplanEntryBuilder()
 {
 }
 
+void FlightplanEntryBuilder::beginBatch(const atools::fs::pln::Flightplan& flightplan) const
+{
+  QStringList idents;
+  for(const FlightplanEntry& entry : flightplan)
+  {
+    atools::fs::pln::entry::WaypointType type = entry.getWaypointType();
+    if(type == atools::fs::pln::entry::VOR || type == atools::fs::pln::entry::NDB)
+      idents.append(entry.getIdent());
+  }
+  beginBatch(idents);
+}
+
+void FlightplanEntryBuilder::beginBatch(const QStringList& idents) const
+{
+  NavApp::getMapQueryGui()->loadIdentBatch(idents);
+}
+
+void FlightplanEntryBuilder::endBatch() const
+{
+  NavApp::getMapQueryGui()->clearIdentBatch();
+}
+
 /* Copy airport attributes to flight plan entry */
 void FlightplanEntryBuilder::buildFlightplanEntry(const map::MapAirport& airport, FlightplanEntry& entry, bool alternate) const
 {
@@ -20,6 +20,8 @@
 
 #include "common/mapflags.h"
 
+#include <QStringList>
+
 namespace atools {
 namespace geo {
 class Pos;
@@ -89,6 +91,13 @@ public:
 
   void entryFromUserpoint(const map::MapUserpoint& userpoint, atools::fs::pln::FlightplanEntry& entry);
 
+  /* Load all VORs and NDBs of the flight plan entries or route string items at once before resolving them one by one.
+   * Lookups by ident take VORs and NDBs from the loaded batch until endBatch() is called.
+   * Duplicates are resolved by distance in the lookup as usual. */
+  void beginBatch(const atools::fs::pln::Flightplan& flightplan) const;
+  void beginBatch(const QStringList& idents) const;
+  void endBatch() const;
+
   int getCurUserpointNumber() const
   {
     return curUserpointNumber;
@@ -107,4 +116,32 @@ private:
   int curUserpointNumber = 1;
 };
 
+/* Calls FlightplanEntryBuilder::beginBatch() on construction and endBatch() when going out of scope */
+class FlightplanEntryBatch
+{
+public:
+  FlightplanEntryBatch(const FlightplanEntryBuilder& builderParam, const atools::fs::pln::Flightplan& flightplan)
+    : builder(builderParam)
+  {
+    builder.beginBatch(flightplan);
+  }
+
+  FlightplanEntryBatch(const FlightplanEntryBuilder& builderParam, const QStringList& idents)
+    : builder(builderParam)
+  {
+    builder.beginBatch(idents);
+  }
+
+  ~FlightplanEntryBatch()
+  {
+    builder.endBatch();
+  }
+
+  FlightplanEntryBatch(const FlightplanEntryBatch& other) = delete;
+  FlightplanEntryBatch& operator=(const FlightplanEntryBatch& other) = delete;
+
+private:
+  const FlightplanEntryBuilder& builder;
+};
+
 #endif // LITTLENAVMAP_FLIGHTPLANENTRYBUILDER_H
@@ -58,13 +58,14 @@ const static RouteLeg EMPTY_ROUTELEG;
 const static QRegularExpression USER_WP_ID("^WP([0-9]+)$");
 
 Route::Route()
+  : flightplan(std::make_shared<atools::fs::pln::Flightplan>())
 {
   resetActive();
   altitude = new RouteAltitude(this);
 }
 
 Route::Route(const Route& other)
-  : QList<RouteLeg>(other)
+  : QList<RouteLeg>(other), flightplan(other.flightplan)
 {
   copy(other);
 }
@@ -83,7 +84,7 @@ Route& Route::operator=(const Route& other)
 
 void Route::updateAircraftPerfMetadata()
 {
-  QHash<QString, QString>& properties = flightplan.getProperties();
+  QHash<QString, QString>& properties = flightplanRef().getProperties();
   properties.insert(atools::fs::pln::AIRCRAFT_PERF_NAME, NavApp::getCurrentAircraftPerfName());
   properties.insert(atools::fs::pln::AIRCRAFT_PERF_TYPE, NavApp::getCurrentAircraftPerfAircraftType());
   properties.insert(atools::fs::pln::AIRCRAFT_PERF_FILE, NavApp::getCurrentAircraftPerfFilepath());
@@ -91,7 +92,7 @@ void Route::updateAircraftPerfMetadata()
 
 void Route::updateRouteCycleMetadata()
 {
-  QHash<QString, QString>& properties = flightplan.getProperties();
+  QHash<QString, QString>& properties = flightplanRef().getProperties();
   // Add metadata for navdata reference =========================
   properties.insert(atools::fs::pln::SIMDATA, NavApp::getDatabaseMetaSim()->getDataSource());
   properties.insert(atools::fs::pln::SIMDATA_CYCLE, NavApp::getDatabaseAiracCycleSim());
@@ -116,6 +117,7 @@ void Route::copy(const Route& other)
   QList::append(other);
 
   totalDistance = other.totalDistance;
+  // Share flight plan - legs point to the shared object and are updated on detach
   flightplan = other.flightplan;
   shownTypes = other.shownTypes;
   boundingRect = other.boundingRect;
@@ -133,22 +135,32 @@ void Route::copy(const Route& other)
   numAlternateLegs = other.numAlternateLegs;
 
   activeLegIndex = other.activeLegIndex;
+  nearestLegHint = other.nearestLegHint;
   activeLegResult = other.activeLegResult;
+  legSegments = other.legSegments;
 
   destRunwayIlsMap = other.destRunwayIlsMap;
   destRunwayIlsProfile = other.destRunwayIlsProfile;
   destRunwayIlsFlightPlanTable = other.destRunwayIlsFlightPlanTable;
   destRunwayEnd = other.destRunwayEnd;
-
-  // Update flightplan pointers to this instance
-  for(RouteLeg& routeLeg : *this)
-    routeLeg.setFlightplan(&flightplan);
+  destRunwayIlsKey = other.destRunwayIlsKey;
 
   delete altitude;
   altitude = new RouteAltitude(this);
   *altitude = other.altitude->copy(this);
 }
 
+void Route::detachFlightplan()
+{
+  if(flightplan.use_count() > 1)
+  {
+    // Shared with a copy of this route - clone and update pointers in legs to the new instance
+    flightplan = std::make_shared<atools::fs::pln::Flightplan>(*flightplan);
+    for(RouteLeg& routeLeg : *this)
+      routeLeg.setFlightplan(flightplan.get());
+  }
+}
+
 void Route::clearAll()
 {
   resetActive();
@@ -161,7 +173,10 @@ void Route::clearAll()
   destRunwayIlsProfile.clear();
   destRunwayIlsFlightPlanTable.clear();
   destRunwayEnd = map::MapRunwayEnd();
+  destRunwayIlsKey.clear();
   objectIndex.clear();
+  legSegments.clear();
+  nearestLegHint = map::INVALID_INDEX_VALUE;
 
   totalDistance = 0.f;
 }
@@ -171,7 +186,7 @@ int Route::getNextUserWaypointNumber() const
   /* Get number from user waypoint from user defined waypoint in fs flight plan */
   int nextNum = 0;
 
-  for(const FlightplanEntry& entry : flightplan)
+  for(const FlightplanEntry& entry : flightplanRef())
   {
     if(entry.getWaypointType() == atools::fs::pln::entry::USER && entry.getIdent().startsWith("WP"))
       nextNum = std::max(QString(USER_WP_ID.match(entry.getIdent()).captured(1)).toInt(), nextNum);
@@ -344,7 +359,7 @@ void Route::updateActiveLegAndPos(const map::PosCourse& pos)
   if(activeLegIndex == map::INVALID_INDEX_VALUE)
   {
     float crossDummy;
-    nearestAllLegIndex(pos, crossDummy, activeLegIndex);
+    nearestAllLegIndex(pos, crossDummy, activeLegIndex, nearestLegHint);
   }
 
   if(activeLegIndex >= size())
@@ -376,7 +391,8 @@ void Route::updateActiveLegAndPos(const map::PosCourse& pos)
 
   if(isTooFarToFlightPlan())
   {
-    // Too far away from plan - remove active leg
+    // Too far away from plan - remove active leg but remember it to speed up the search on next update
+    nearestLegHint = activeLegIndex;
     activeLegIndex = map::INVALID_INDEX_VALUE;
     return;
   }
@@ -735,7 +751,7 @@ int Route::getTopOfDescentLegIndex() const
 
 float Route::getCruiseAltitudeFt() const
 {
-  return flightplan.getCruiseAltitudeFt();
+  return flightplanRef().getCruiseAltitudeFt();
 }
 
 float Route::getAltitudeForDistance(float currentDistToDest) const
@@ -868,6 +884,21 @@ void Route::updateApproachIls()
   if(isEmpty())
     return;
 
+  // Build key from all values which are used to query and filter ILS
+  const RouteLeg& destLeg = getDestinationAirportLeg();
+  const proc::MapProcedureRef& ref = approachLegs.ref;
+  QString key = QString("%1|%2|%3|%4|%5|%6|%7|%8|%9").
+                arg(destLeg.getIdent()).arg(destLeg.getId()).
+                arg(ref.airportId).arg(ref.runwayEndId).arg(ref.procedureId).arg(ref.transitionId).
+                arg(approachLegs.runwayEnd.name).arg(approachLegs.arincName).arg(approachLegs.procedureLegs.size());
+  key.append(NavApp::getShownMapTypes().testFlag(map::ILS) ? "|ILS" : "|");
+  key.append(NavApp::getShownMapDisplayTypes().testFlag(map::GLS) ? "|GLS" : "|");
+
+  if(key == destRunwayIlsKey)
+    // Nothing changed
+    return;
+  destRunwayIlsKey = key;
+
   // Get recommended for flight plan table
   destRunwayEnd = map::MapRunwayEnd();
   destRunwayIlsFlightPlanTable.clear();
@@ -1498,7 +1529,7 @@ void Route::removeAlternateLegs()
   for(int i = 0; i < indexes.size(); i++)
   {
     removeAt(indexes.at(i));
-    flightplan.removeAt(indexes.at(i));
+    flightplanRef().removeAt(indexes.at(i));
   }
   alternateLegsOffset = map::INVALID_INDEX_VALUE;
   numAlternateLegs = 0;
@@ -1520,7 +1551,7 @@ void Route::removeMissedLegs()
   for(int i = 0; i < indexes.size(); i++)
   {
     removeAt(indexes.at(i));
-    flightplan.removeAt(indexes.at(i));
+    flightplanRef().removeAt(indexes.at(i));
   }
   alternateLegsOffset = map::INVALID_INDEX_VALUE;
   numAlternateLegs = 0;
@@ -1582,7 +1613,7 @@ void Route::removeProcedureLegs(proc::MapProcedureTypes type)
 
 void Route::clearFlightplanProcedureProperties(proc::MapProcedureTypes type)
 {
-  ProcedureQuery::clearFlightplanProcedureProperties(flightplan.getProperties(), type);
+  ProcedureQuery::clearFlightplanProcedureProperties(flightplanRef().getProperties(), type);
 }
 
 QStringList Route::getAlternateIdents() const
@@ -1732,13 +1763,13 @@ void Route::updateProcedureLegs(FlightplanEntryBuilder *entryBuilder, bool clear
   for(int i = 0; i < sidLegs.size(); i++)
   {
     int insertIndex = 1 + i;
-    RouteLeg routeLeg(&flightplan);
+    RouteLeg routeLeg(&flightplanRef());
     routeLeg.createFromProcedureLegs(i, sidLegs, &value(i));
     insert(insertIndex, routeLeg);
 
     FlightplanEntry entry;
     entryBuilder->buildFlightplanEntry(sidLegs.at(insertIndex - 1), entry, true);
-    flightplan.insert(insertIndex, entry);
+    flightplanRef().insert(insertIndex, entry);
   }
 
   // Create route legs and flight plan entries from STAR
@@ -1750,7 +1781,7 @@ void Route::updateProcedureLegs(FlightplanEntryBuilder *entryBuilder, bool clear
   {
     const RouteLeg *prev = size() >= 2 ? &value(size() - 2) : nullptr;
 
-    RouteLeg routeLeg(&flightplan);
+    RouteLeg routeLeg(&flightplanRef());
     routeLeg.createFromProcedureLegs(i, starLegs, prev);
     if(i == 0)
       // Add airway of first waypoint again
@@ -1762,7 +1793,7 @@ void Route::updateProcedureLegs(FlightplanEntryBuilder *entryBuilder, bool clear
     if(i == 0)
       // Add airway of first waypoint again
       entry.setAirway(starAirway.getIdent());
-    flightplan.insert(flightplan.size() - insertOffset, entry);
+    flightplanRef().insert(flightplanRef().size() - insertOffset, entry);
   }
 
   // Create route legs and flight plan entries from arrival
@@ -1773,26 +1804,26 @@ void Route::updateProcedureLegs(FlightplanEntryBuilder *entryBuilder, bool clear
   {
     const RouteLeg *prev = size() >= 2 ? &value(size() - 2) : nullptr;
 
-    RouteLeg routeLeg(&flightplan);
+    RouteLeg routeLeg(&flightplanRef());
     routeLeg.createFromProcedureLegs(i, approachLegs, prev);
     insert(size() - insertOffset, routeLeg);
 
     FlightplanEntry entry;
     entryBuilder->buildFlightplanEntry(approachLegs.at(i), entry, true);
-    flightplan.insert(flightplan.size() - insertOffset, entry);
+    flightplanRef().insert(flightplanRef().size() - insertOffset, entry);
   }
 
   // Leave procedure information in the PLN file
   if(clearOldProcedureProperties)
     clearFlightplanProcedureProperties(proc::PROCEDURE_ALL);
 
-  ProcedureQuery::fillFlightplanProcedureProperties(flightplan.getProperties(), approachLegs, starLegs, sidLegs);
+  ProcedureQuery::fillFlightplanProcedureProperties(flightplanRef().getProperties(), approachLegs, starLegs, sidLegs);
   updateIndicesAndOffsets();
 }
 
 proc::MapProcedureTypes Route::getMissingProcedures()
 {
-  return ProcedureQuery::getMissingProcedures(flightplan.getProperties(), approachLegs, starLegs, sidLegs);
+  return ProcedureQuery::getMissingProcedures(flightplanRef().getProperties(), approachLegs, starLegs, sidLegs);
 }
 
 void Route::selectionFlagsAlternate(const QList<int>& rows, bool& containsAlternate, bool& moveDownTouchesAlt,
@@ -1846,7 +1877,7 @@ void Route::removeLegs(int from, int to)
   for(int i = to; i >= from; i--)
   {
     removeAt(i);
-    flightplan.removeAt(i);
+    flightplanRef().removeAt(i);
   }
 }
 
@@ -1866,7 +1897,7 @@ void Route::removeRouteLegs()
   for(int i = 0; i < indexes.size(); i++)
   {
     removeAt(indexes.at(i));
-    flightplan.removeAt(indexes.at(i));
+    flightplanRef().removeAt(indexes.at(i));
   }
 }
 
@@ -1888,7 +1919,7 @@ void Route::clearProcedureLegs(proc::MapProcedureTypes type, bool clearRoute, bo
     if(clearRoute)
       removeAt(indexes.at(i));
     if(clearFlightplan)
-      flightplan.removeAt(indexes.at(i));
+      flightplanRef().removeAt(indexes.at(i));
   }
 }
 
@@ -1902,66 +1933,84 @@ void Route::updateDepartureAndDestination(bool clearInvalidStart)
 
     // Correct departure and destination values
     const RouteLeg& departure = getDepartureAirportLeg();
-    flightplan.setDepartureIdent(departure.getIdent());
-    flightplan.setDepartureName(departure.getName());
-    flightplan.setDeparturePosition(departure.getPosition());
+    flightplanRef().setDepartureIdent(departure.getIdent());
+    flightplanRef().setDepartureName(departure.getName());
+    flightplanRef().setDeparturePosition(departure.getPosition());
 
     if(hasDepartureParking())
     {
       // Get position from parking spot
-      flightplan.setDepartureParkingName(map::parkingNameForFlightplan(departure.getDepartureParking()));
-      flightplan.setDepartureParkingPosition(departure.getDepartureParking().position, departure.getAltitude(),
+      flightplanRef().setDepartureParkingName(map::parkingNameForFlightplan(departure.getDepartureParking()));
+      flightplanRef().setDepartureParkingPosition(departure.getDepartureParking().position, departure.getAltitude(),
                                              departure.getDepartureParking().heading);
-      flightplan.setDepartureParkingType(atools::fs::pln::PARKING);
+      flightplanRef().setDepartureParkingType(atools::fs::pln::PARKING);
     }
     else if(hasDepartureStart())
     {
       // Get position from start
-      flightplan.setDepartureParkingName(departure.getDepartureStart().runwayName);
-      flightplan.setDepartureParkingPosition(departure.getDepartureStart().position, departure.getAltitude(),
+      flightplanRef().setDepartureParkingName(departure.getDepartureStart().runwayName);
+      flightplanRef().setDepartureParkingPosition(departure.getDepartureStart().position, departure.getAltitude(),
                                              departure.getDepartureStart().heading);
 
       // A start can be a runway or a helipad
       if(departure.getDepartureStart().helipadNumber != -1)
-        flightplan.setDepartureParkingType(atools::fs::pln::HELIPAD);
+        flightplanRef().setDepartureParkingType(atools::fs::pln::HELIPAD);
       else if(!departure.getDepartureStart().runwayName.isEmpty())
-        flightplan.setDepartureParkingType(atools::fs::pln::RUNWAY);
+        flightplanRef().setDepartureParkingType(atools::fs::pln::RUNWAY);
     }
     else if(clearInvalidStart) // Clear only if requested - otherwise leave parking and/or start intact
     {
       // No start position and no parking - use airport/navaid position
-      flightplan.setDepartureParkingName(QString());
-      flightplan.setDepartureParkingPosition(departure.getPosition(),
+      flightplanRef().setDepartureParkingName(QString());
+      flightplanRef().setDepartureParkingPosition(departure.getPosition(),
                                              atools::fs::pln::INVALID_ALTITUDE, atools::fs::pln::INVALID_HEADING);
-      flightplan.setDepartureParkingType(atools::fs::pln::AIRPORT);
+      flightplanRef().setDepartureParkingType(atools::fs::pln::AIRPORT);
     }
 
     const RouteLeg& destination = getDestinationAirportLeg();
-    flightplan.setDestinationIdent(destination.getIdent());
-    flightplan.setDestinationName(destination.getName());
-    flightplan.setDestinationPosition(destination.getPosition());
+    flightplanRef().setDestinationIdent(destination.getIdent());
+    flightplanRef().setDestinationName(destination.getName());
+    flightplanRef().setDestinationPosition(destination.getPosition());
   }
   else
-    flightplan.clearAll();
+    flightplanRef().clearAll();
 }
 
-void Route::updateAll()
+void Route::updateAll(ru::RouteUpdates updates)
 {
-  updateIndicesAndOffsets();
-  removeDuplicateRouteLegs();
-  validateAirways();
-  updateMagvar();
-  updateDistancesAndCourse();
-  updateBoundingRect();
-  updateWaypointNames();
-  updateDepartureAndDestination(false /* clearInvalidStart */);
-  updateApproachIls();
+  if(updates.testFlag(ru::INDEXES))
+    updateIndicesAndOffsets();
+
+  if(updates.testFlag(ru::LEGS))
+  {
+    removeDuplicateRouteLegs();
+    validateAirways();
+  }
+
+  if(updates.testFlag(ru::MAGVAR))
+    updateMagvar();
+
+  if(updates.testFlag(ru::DISTANCES))
+  {
+    updateDistancesAndCourse();
+    updateBoundingRect();
+    updateLegSegments();
+  }
+
+  if(updates.testFlag(ru::NAMES))
+  {
+    updateWaypointNames();
+    updateDepartureAndDestination(false /* clearInvalidStart */);
+  }
+
+  if(updates.testFlag(ru::ILS))
+    updateApproachIls();
 }
 
 void Route::updateWaypointNames()
 {
   int num = 1;
-  for(FlightplanEntry& entry : flightplan)
+  for(FlightplanEntry& entry : flightplanRef())
   {
     if(entry.getWaypointType() == atools::fs::pln::entry::USER && entry.getIdent().startsWith("WP"))
     {
@@ -1980,7 +2029,7 @@ void Route::updateAirportRegions()
     if(leg.getMapType() == map::AIRPORT)
     {
       NavApp::getAirportQuerySim()->getAirportRegion(leg.getAirport());
-      flightplan[i].setRegion(leg.getAirport().region);
+      flightplanRef()[i].setRegion(leg.getAirport().region);
     }
     i++;
   }
@@ -2216,12 +2265,22 @@ void Route::updateMagvar()
     (*this)[i].updateMagvar(i > 0 ? &at(i - 1) : nullptr);
 }
 
-void Route::updateLegAltitudes()
+void Route::updateLegAltitudes(bool clearWindCache)
 {
+  if(clearWindCache)
+    altitude->clearWindCache();
+
   // Calculate also with empty route to allow updating of error messages
   altitude->calculateAll(NavApp::getAircraftPerformance(), getCruiseAltitudeFt());
 }
 
+RouteAltitude Route::calculateAltitudeLegsForCruise(float cruiseAltitudeFt) const
+{
+  RouteAltitude altitudeLegs = altitude->copy(this);
+  altitudeLegs.calculateAll(NavApp::getAircraftPerformance(), cruiseAltitudeFt);
+  return altitudeLegs;
+}
+
 /* Update the bounding rect using marble functions to catch anti meridian overlap */
 void Route::updateBoundingRect()
 {
@@ -2237,8 +2296,21 @@ void Route::updateBoundingRect()
   boundingRect.toDeg();
 }
 
-void Route::nearestAllLegIndex(const map::PosCourse& pos, float& crossTrackDistanceMeter,
-                               int& index) const
+void Route::updateLegSegments()
+{
+  legSegments.clear();
+  legSegments.reserve(size());
+
+  // Index 0 is a dummy to keep indexes aligned with legs
+  legSegments.append({Pos(), Pos(), 0.f});
+  for(int i = 1; i < size(); i++)
+  {
+    Pos pos1 = getPrevPositionAt(i), pos2 = getPositionAt(i);
+    legSegments.append({pos1, pos2, pos1.isValid() && pos2.isValid() ? pos1.distanceMeterTo(pos2) : 0.f});
+  }
+}
+
+void Route::nearestAllLegIndex(const map::PosCourse& pos, float& crossTrackDistanceMeter, int& index, int hintIndex) const
 {
   crossTrackDistanceMeter = map::INVALID_DISTANCE_VALUE;
   index = map::INVALID_INDEX_VALUE;
@@ -2246,14 +2318,48 @@ void Route::nearestAllLegIndex(const map::PosCourse& pos, float& crossTrackDista
   if(!pos.isValid())
     return;
 
+  // Allow some error between segment length and cross track calculation
+  const float EPSILON_METER = 10.f;
+
   float minDistance = map::INVALID_DISTANCE_VALUE;
 
   // Check only until the approach starts if required
   atools::geo::LineDistance result;
 
+  // Legs which are farther away than this can be skipped
+  float maxDistance = map::INVALID_DISTANCE_VALUE;
+  if(hintIndex > 0 && hintIndex < size())
+  {
+    // Get an upper limit from the last active leg which is likely the nearest one
+    pos.pos.distanceMeterToLine(getPrevPositionAt(hintIndex), getPositionAt(hintIndex), result);
+    if(result.status != atools::geo::INVALID)
+      maxDistance = std::abs(result.distance);
+  }
+
+  // Do not use index if outdated
+  bool useSegments = legSegments.size() == size();
+
   for(int i = 1; i < size(); i++)
   {
-    pos.pos.distanceMeterToLine(getPrevPositionAt(i), getPositionAt(i), result);
+    Pos pos1 = getPrevPositionAt(i), pos2 = getPositionAt(i);
+
+    if(useSegments && maxDistance < map::INVALID_DISTANCE_VALUE)
+    {
+      const LegSegment& segment = legSegments.at(i);
+      if(segment.pos1 == pos1 && segment.pos2 == pos2 && pos1.isValid())
+      {
+        // Each point on the segment is at least distance to start minus length away
+        // Latitude difference is a cheap lower limit for the distance to the start point
+        float limit = maxDistance + segment.lengthMeter + EPSILON_METER;
+        if(nmToMeter(std::abs(pos.pos.getLatY() - pos1.getLatY()) * 60.f) > limit)
+          continue;
+
+        if(pos.pos.distanceMeterTo(pos1) > limit)
+          continue;
+      }
+    }
+
+    pos.pos.distanceMeterToLine(pos1, pos2, result);
     float distance = std::abs(result.distance);
 
     if(result.status != atools::geo::INVALID && distance < minDistance)
@@ -2261,6 +2367,7 @@ void Route::nearestAllLegIndex(const map::PosCourse& pos, float& crossTrackDista
       minDistance = distance;
       crossTrackDistanceMeter = result.distance;
       index = i;
+      maxDistance = std::min(maxDistance, minDistance);
     }
   }
 
@@ -2273,6 +2380,18 @@ void Route::nearestAllLegIndex(const map::PosCourse& pos, float& crossTrackDista
       index = map::INVALID_INDEX_VALUE;
     }
   }
+
+#ifdef DEBUG_ACTIVE_LEG
+  // Compare with full scan
+  if(hintIndex != map::INVALID_INDEX_VALUE)
+  {
+    float crossTrackFull;
+    int indexFull;
+    nearestAllLegIndex(pos, crossTrackFull, indexFull, map::INVALID_INDEX_VALUE);
+    if(indexFull != index)
+      qWarning() << Q_FUNC_INFO << "Index mismatch" << index << "full scan" << indexFull;
+  }
+#endif
 }
 
 int Route::getNearestRouteLegResult(const Pos& pos, atools::geo::LineDistance& lineDistanceResult, bool ignoreNotEditable,
@@ -2590,7 +2709,7 @@ void Route::validateAirways()
 
     QString airway = arrivalLeg.getAirwayName();
     if(airway.isEmpty())
-      airway = flightplan.getPropertiesConst().value(atools::fs::pln::PROCAIRWAY);
+      airway = flightplanRef().getPropertiesConst().value(atools::fs::pln::PROCAIRWAY);
     if(NavApp::getAirwayTrackQueryGui()->hasAirwayForNameAndWaypoint(airway, routeLeg.getIdent(), arrivalLeg.getIdent()))
     {
       // Airway is valid - set into procedure leg and property
@@ -2603,7 +2722,7 @@ void Route::validateAirways()
       }
       else
         qDebug() << Q_FUNC_INFO << "Entry is null";
-      flightplan.getProperties().insert(atools::fs::pln::PROCAIRWAY, airway);
+      flightplanRef().getProperties().insert(atools::fs::pln::PROCAIRWAY, airway);
     }
     else
     {
@@ -2616,7 +2735,7 @@ void Route::validateAirways()
       }
       else
         qDebug() << Q_FUNC_INFO << "Entry is null";
-      flightplan.getProperties().remove(atools::fs::pln::PROCAIRWAY);
+      flightplanRef().getProperties().remove(atools::fs::pln::PROCAIRWAY);
     }
   }
 
@@ -2631,7 +2750,7 @@ void Route::validateAirways()
     if(!NavApp::getAirwayTrackQueryGui()->hasAirwayForNameAndWaypoint(routeLeg.getAirwayName(), departureLeg.getIdent(),
                                                                       routeLeg.getIdent()))
       // Airway not valid for changed waypoints - erase
-      flightplan[startIndexAfterProcedure].setAirway(QString());
+      flightplanRef()[startIndexAfterProcedure].setAirway(QString());
   }
 }
 
@@ -2656,7 +2775,7 @@ void Route::removeDuplicateRouteLegs()
       qDebug() << "removing duplicate leg at" << (arrivaLegsOffset - 1) << routeLeg;
 
       // Copy airway name from the route leg to be deleted into the first procedure leg
-      flightplan[arrivaLegsOffset].setAirway(flightplan.at(arrivaLegsOffset - 1).getAirway());
+      flightplanRef()[arrivaLegsOffset].setAirway(flightplanRef().at(arrivaLegsOffset - 1).getAirway());
 
       // Remove the route leg before the procedure
       removeAllAt(arrivaLegsOffset - 1);
@@ -2730,15 +2849,19 @@ void Route::createRouteLegsFromFlightplan()
 
   const RouteLeg *lastLeg = nullptr;
 
+  // Load all VOR and NDB at once instead of one query per leg
+  FlightplanEntryBuilder entryBuilder;
+  FlightplanEntryBatch batch(entryBuilder, flightplanRef());
+
   // Create map objects first and calculate total distance
-  for(int i = 0; i < flightplan.size(); i++)
+  for(int i = 0; i < flightplanRef().size(); i++)
   {
-    RouteLeg leg(&flightplan);
+    RouteLeg leg(&flightplanRef());
     leg.createFromDatabaseByEntry(i, lastLeg);
 
     if(leg.getMapType() == map::INVALID)
       // Not found in database
-      qWarning() << "Entry for ident" << flightplan.at(i).getIdent() << "region" << flightplan.at(i).getRegion() << "is not valid";
+      qWarning() << "Entry for ident" << flightplanRef().at(i).getIdent() << "region" << flightplanRef().at(i).getRegion() << "is not valid";
 
     append(leg);
     lastLeg = &constLast();
@@ -2749,13 +2872,13 @@ void Route::assignAltitudes()
 {
   QVector<float> altVector = altitude->getAltitudes();
   for(int i = 0; i < size(); i++)
-    flightplan[i].setAltitude(altVector.at(i));
+    flightplanRef()[i].setAltitude(altVector.at(i));
 }
 
 void Route::zeroAltitudes()
 {
   for(int i = 0; i < size(); i++)
-    flightplan[i].setAltitude(0.f);
+    flightplanRef()[i].setAltitude(0.f);
 }
 
 Route Route::updatedAltitudes() const
@@ -2838,7 +2961,7 @@ Route Route::adjustedToOptions(const Route& origRoute, rf::RouteAdjustOptions op
           entry.setFlag(atools::fs::pln::entry::PROCEDURE, false);
           entry.setAltitude(altVector.value(arrivaLegsOffset, 0.f));
 
-          RouteLeg newLeg = RouteLeg(&route.flightplan);
+          RouteLeg newLeg = RouteLeg(&route.flightplanRef());
           newLeg.createCopyFromProcedureLeg(arrivaLegsOffset, arrivalLeg, &routeLeg);
           newLeg.setAirway(arrivalLeg.getAirway());
 
@@ -2870,7 +2993,7 @@ Route Route::adjustedToOptions(const Route& origRoute, rf::RouteAdjustOptions op
           entry.setFlag(atools::fs::pln::entry::PROCEDURE, false);
           entry.setAltitude(altVector.value(startIndexAfterProcedure - 1, 0.f));
 
-          RouteLeg newLeg = RouteLeg(&route.flightplan);
+          RouteLeg newLeg = RouteLeg(&route.flightplanRef());
           newLeg.createCopyFromProcedureLeg(startIndexAfterProcedure, departureLeg, &routeLeg);
           newLeg.setAirway(map::MapAirway());
 
@@ -3521,7 +3644,7 @@ void Route::updateAirwaysAndAltitude(bool adjustRouteAltitude)
     {
       opts::UnitAlt unitAlt = Unit::getUnitAlt();
       // No valid information from airways or procedures - fall back to fixed values based on type
-      if(flightplan.getFlightplanType() == atools::fs::pln::IFR)
+      if(flightplanRef().getFlightplanType() == atools::fs::pln::IFR)
       {
         minAltitudeLocal = unitAlt == opts::ALT_FT ? 20000.f : 5000.f;
         maxAltitudeLocal = unitAlt == opts::ALT_FT ? 24000.f : 7000.f;
@@ -3552,12 +3675,12 @@ void Route::updateAirwaysAndAltitude(bool adjustRouteAltitude)
       maxAltitudeLocal = minAltitudeLocal;
 
     // Convert feet to local unit
-    float cruisingAltitudeLocal = Unit::altFeetF(flightplan.getCruiseAltitudeFt());
+    float cruisingAltitudeLocal = Unit::altFeetF(flightplanRef().getCruiseAltitudeFt());
 
     // Check airway limits after calculation ===========================
     // First do basic aligment - round to next 1000 and add 500 for VFR
     // Add 500 ft/m for VFR
-    float offset = flightplan.getFlightplanType() == atools::fs::pln::IFR ? 0.f : 500.f;
+    float offset = flightplanRef().getFlightplanType() == atools::fs::pln::IFR ? 0.f : 500.f;
 
     if(cruisingAltitudeLocal < minAltitudeLocal)
       // Below min altitude - use min altitude and round up to next valid level
@@ -3579,7 +3702,7 @@ void Route::updateAirwaysAndAltitude(bool adjustRouteAltitude)
     }
 
     // Convert local unit back to feet
-    flightplan.setCruiseAltitudeFt(Unit::rev(cruisingAltitudeLocal, Unit::altFeetF));
+    flightplanRef().setCruiseAltitudeFt(Unit::rev(cruisingAltitudeLocal, Unit::altFeetF));
 
 #ifdef DEBUG_INFORMATION
     qDebug() << Q_FUNC_INFO << "Updating flight plan altitude"
@@ -3752,7 +3875,7 @@ QString Route::buildDefaultFilename(QString pattern, QString suffix) const
   if(isEmpty())
     return tr("Empty Flightplan") + suffix;
 
-  QString type = flightplan.getFlightplanTypeStr();
+  QString type = flightplanRef().getFlightplanTypeStr();
   QString departName = getDepartureAirportLeg().getName(), departIdent = getDepartureAirportLeg().getDisplayIdent(),
           destName = getDestinationAirportLeg().getName(), destIdent = getDestinationAirportLeg().getDisplayIdent();
 
@@ -3765,7 +3888,7 @@ QString Route::buildDefaultFilename(QString pattern, QString suffix) const
     suffix.clear();
 
   return Flightplan::getFilenamePattern(pattern, type, departName, departIdent, destName, destIdent, suffix,
-                                        atools::roundToInt(Unit::altFeetF(flightplan.getCruiseAltitudeFt())));
+                                        atools::roundToInt(Unit::altFeetF(flightplanRef().getCruiseAltitudeFt())));
 }
 
 QString Route::buildDefaultFilenameShort(const QString& separator, const QString& suffix) const
@@ -3777,7 +3900,7 @@ QString Route::buildDefaultFilenameShort(const QString& separator, const QString
 
   return Flightplan::getFilenamePattern(atools::fs::pln::pattern::DEPARTIDENT % separator % atools::fs::pln::pattern::DESTIDENT,
                                         QString(), QString(), departIdent, QString(), destIdent, suffix,
-                                        atools::roundToInt(Unit::altFeetF(flightplan.getCruiseAltitudeFt())));
+                                        atools::roundToInt(Unit::altFeetF(flightplanRef().getCruiseAltitudeFt())));
 }
 
 QDebug operator<<(QDebug out, const Route& route)
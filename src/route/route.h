@@ -23,6 +23,8 @@
 
 #include "fs/pln/flightplan.h"
 
+#include <memory>
+
 class CoordinateConverter;
 class FlightplanEntryBuilder;
 class RouteAltitude;
@@ -258,22 +260,23 @@ public:
   /* The flight plan has dummy entries for procedure points that are flagged as no save */
   const atools::fs::pln::Flightplan& getFlightplanConst() const
   {
-    return flightplan;
+    return *flightplan;
   }
 
+  /* Detaches the flight plan if shared with a copy */
   atools::fs::pln::Flightplan& getFlightplan()
   {
-    return flightplan;
+    return flightplanRef();
   }
 
   bool isTypeVfr() const
   {
-    return flightplan.getFlightplanType() == atools::fs::pln::VFR;
+    return flightplan->getFlightplanType() == atools::fs::pln::VFR;
   }
 
   bool isTypeIfr() const
   {
-    return flightplan.getFlightplanType() == atools::fs::pln::IFR;
+    return flightplan->getFlightplanType() == atools::fs::pln::IFR;
   }
 
   /* Value in flight plan is stored in local unit */
@@ -281,7 +284,8 @@ public:
 
   void setFlightplan(const atools::fs::pln::Flightplan& value)
   {
-    flightplan = value;
+    flightplanRef() = value;
+    destRunwayIlsKey.clear();
   }
 
   /* Get nearest flight plan leg to given screen position xs/ys. */
@@ -479,8 +483,9 @@ public:
   const atools::geo::Pos getPrevPositionAt(int i) const;
 
   /* Update distance, course, bounding rect and total distance for route map objects.
-   *  Also calculates maximum number of user points. */
-  void updateAll();
+   *  Also calculates maximum number of user points.
+   *  Pass a reduced set of updates for edits which do not affect all derived data. */
+  void updateAll(ru::RouteUpdates updates = ru::UPDATE_ALL);
 
   /* Use an expensive heuristic to update the missing regions in all airports
    * before export for formats which need it. */
@@ -554,7 +559,7 @@ public:
   void removeAllAt(int i)
   {
     QList::removeAt(i);
-    flightplan.removeAt(i);
+    flightplanRef().removeAt(i);
   }
 
   void removeLegAt(int i)
@@ -634,7 +639,8 @@ public:
     return destRunwayEnd;
   }
 
-  /* Get ILS (for ILS and LOC approaches) and VASI pitch if approach is available */
+  /* Get ILS (for ILS and LOC approaches) and VASI pitch if approach is available.
+   * Database is not queried again if destination, approach and shown map types did not change. */
   void updateApproachIls();
 
   const RouteAltitudeLeg& getAltitudeLegAt(int i) const;
@@ -642,8 +648,13 @@ public:
   int getNumAltitudeLegs() const;
   bool isValidProfile() const;
 
-  /* Calculate route leg altitudes that are needed for the elevation profile */
-  void updateLegAltitudes();
+  /* Calculate route leg altitudes that are needed for the elevation profile.
+   * Wind is queried again only for changed legs unless clearWindCache is true. Set it if wind or performance changed. */
+  void updateLegAltitudes(bool clearWindCache = false);
+
+  /* Calculate altitude legs including trip fuel and time for the given cruise altitude on a copy of the current
+   * altitude legs. Neither this route nor its flight plan are changed. Winds of unchanged legs are reused. */
+  RouteAltitude calculateAltitudeLegsForCruise(float cruiseAltitudeFt) const;
 
   /* general distance in NM which is either cross track, previous or next waypoint */
   float getDistanceToFlightPlan() const;
@@ -760,6 +771,9 @@ private:
   void updateDistancesAndCourse();
   void updateBoundingRect();
 
+  /* Update segment index used by nearestAllLegIndex() */
+  void updateLegSegments();
+
   /* Looks fuzzy for a waypoint at the given position from front to end or vice versa if reverse is true */
   int legIndexForPosition(const atools::geo::Pos& pos, bool reverse);
 
@@ -773,7 +787,25 @@ private:
 
   /* Get indexes to nearest approach or route leg and cross track distance to the nearest ofthem in nm */
   void copy(const Route& other);
-  void nearestAllLegIndex(const map::PosCourse& pos, float& crossTrackDistanceMeter, int& index) const;
+
+  /* Clone flight plan if shared with another route and point all legs to the clone */
+  void detachFlightplan();
+
+  /* Access to the flight plan. The non-const version detaches the flight plan before modification. */
+  atools::fs::pln::Flightplan& flightplanRef()
+  {
+    detachFlightplan();
+    return *flightplan;
+  }
+
+  const atools::fs::pln::Flightplan& flightplanRef() const
+  {
+    return *flightplan;
+  }
+  /* Get nearest leg index and cross track distance. Starts with hintIndex if valid and skips legs which
+   * cannot be closer by using the segment index. Result is the same as for a full scan. */
+  void nearestAllLegIndex(const map::PosCourse& pos, float& crossTrackDistanceMeter, int& index,
+                          int hintIndex = map::INVALID_INDEX_VALUE) const;
   bool isSmaller(const atools::geo::LineDistance& dist1, const atools::geo::LineDistance& dist2, float epsilon);
   int adjustedActiveLeg() const;
 
@@ -795,12 +827,26 @@ private:
   /* Nautical miles not including missed approach and alternates */
   float totalDistance = 0.f;
 
-  atools::fs::pln::Flightplan flightplan;
+  /* Shared between copies of this route to make copies cheap. Copy-on-write by flightplanRef().
+   * Legs keep a pointer to this object. */
+  std::shared_ptr<atools::fs::pln::Flightplan> flightplan;
   proc::MapProcedureLegs approachLegs, starLegs, sidLegs;
   map::MapTypes shownTypes = map::NONE;
 
   int activeLegIndex = map::INVALID_INDEX_VALUE;
+
+  /* Last active leg before losing track. Used to start the nearest leg search. */
+  int nearestLegHint = map::INVALID_INDEX_VALUE;
   atools::geo::LineDistance activeLegResult;
+
+  /* Segment index for the nearest leg search. Start and end position and length of the line for each leg. */
+  struct LegSegment
+  {
+    atools::geo::Pos pos1, pos2;
+    float lengthMeter;
+  };
+
+  QVector<LegSegment> legSegments;
   map::PosCourse activePos;
   int sidLegsOffset = map::INVALID_INDEX_VALUE, /* First departure leg */
       starLegsOffset = map::INVALID_INDEX_VALUE, /* First STAR leg */
@@ -822,6 +868,9 @@ private:
   /* Get runway end at destination if any. Used to get the VASI information */
   map::MapRunwayEnd destRunwayEnd;
 
+  /* Destination, approach and display options used for the last ILS update. Empty if not valid. */
+  QString destRunwayIlsKey;
+
   RouteAltitude *altitude = nullptr;
 
   /* Ref to flight plan leg  index map */
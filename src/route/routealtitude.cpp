@@ -63,16 +63,18 @@ int RouteAltitude::indexForDistance(float distanceToDest) const
 
   float distFromStart = route->getTotalDistance() - distanceToDest;
 
-  for(int index = 0; index < size(); index++)
-  {
-    const RouteAltitudeLeg& leg = at(index);
+  // Missed and alternate legs are always at the end - find first one
+  auto end = std::partition_point(constBegin(), constEnd(), [](const RouteAltitudeLeg& leg) -> bool {
+    return !leg.isMissed() && !leg.isAlternate();
+  });
 
-    if(leg.isMissed() || leg.isAlternate())
-      break;
+  // Distance from start is ascending - find first leg ending after the given distance
+  auto it = std::upper_bound(constBegin(), end, distFromStart, [](float dist, const RouteAltitudeLeg& leg) -> bool {
+    return dist < leg.getDistanceFromStart();
+  });
 
-    if(distFromStart < leg.getDistanceFromStart())
-      return index;
-  }
+  if(it != end)
+    return static_cast<int>(std::distance(constBegin(), it));
 
   return map::INVALID_INDEX_VALUE;
 }
@@ -214,6 +216,7 @@ void RouteAltitude::clearAll()
   averageGroundSpeed = 0.f;
   unflyableLegs = false;
   validProfile = false;
+  lastFuelTimeValid = false;
 }
 
 const RouteAltitudeLeg& RouteAltitude::value(int i) const
@@ -319,10 +322,40 @@ QVector<float> RouteAltitude::getAltitudes() const
   return retval;
 }
 
+bool RouteAltitude::FuelTimeKey::operator==(const FuelTimeKey& other) const
+{
+  return distanceToDest == other.distanceToDest && distanceToNext == other.distanceToNext &&
+         aircraftFuelFlowLbs == other.aircraftFuelFlowLbs && aircraftFuelFlowGal == other.aircraftFuelFlowGal &&
+         aircraftGroundSpeed == other.aircraftGroundSpeed && activeLegIdx == other.activeLegIdx &&
+         alternate == other.alternate && missed == other.missed && fuelFlowValid == other.fuelFlowValid &&
+         speedValid == other.speedValid && fuelAsVolume == other.fuelAsVolume && jetFuel == other.jetFuel;
+}
+
 void RouteAltitude::calculateFuelAndTimeTo(FuelTimeResult& result, float distanceToDest, float distanceToNext,
                                            const atools::fs::perf::AircraftPerf& perf,
                                            float aircraftFuelFlowLbs, float aircraftFuelFlowGal,
                                            float aircraftGroundSpeed, int activeLegIdx) const
+{
+  FuelTimeKey key = {distanceToDest, distanceToNext, aircraftFuelFlowLbs, aircraftFuelFlowGal, aircraftGroundSpeed,
+                     activeLegIdx, route->isActiveAlternate(), route->isActiveMissed(), perf.isFuelFlowValid(),
+                     perf.isSpeedValid(), perf.useFuelAsVolume(), perf.isJetFuel()};
+
+  if(!lastFuelTimeValid || !(key == lastFuelTimeKey))
+  {
+    lastFuelTimeResult = FuelTimeResult();
+    calculateFuelAndTimeToInternal(lastFuelTimeResult, distanceToDest, distanceToNext, perf, aircraftFuelFlowLbs,
+                                   aircraftFuelFlowGal, aircraftGroundSpeed, activeLegIdx);
+    lastFuelTimeKey = key;
+    lastFuelTimeValid = true;
+  }
+
+  result = lastFuelTimeResult;
+}
+
+void RouteAltitude::calculateFuelAndTimeToInternal(FuelTimeResult& result, float distanceToDest, float distanceToNext,
+                                                   const atools::fs::perf::AircraftPerf& perf,
+                                                   float aircraftFuelFlowLbs, float aircraftFuelFlowGal,
+                                                   float aircraftGroundSpeed, int activeLegIdx) const
 {
   // otherwise estimated using aircraft fuel flow
 
@@ -995,6 +1028,8 @@ void RouteAltitude::calculateAll(const atools::fs::perf::AircraftPerf& perf, flo
   qDebug() << Q_FUNC_INFO << perf.getAircraftType() << cruiseAltitudeFt;
 #endif
 
+  lastFuelTimeValid = false;
+
   // Get default climb speed
   climbSpeedWindCorrected = perf.getClimbSpeed();
   cruiseSpeedWindCorrected = perf.getCruiseSpeed();
@@ -1735,12 +1770,37 @@ float RouteAltitude::distanceForAltitude(const RouteAltitudeLeg& leg, float alti
   return distanceForAltitude(leg.geometry.constFirst(), leg.geometry.constLast(), altitude);
 }
 
+atools::grib::Wind RouteAltitude::legWind(int legIndex, WindSlot slot, const atools::geo::LineString& line)
+{
+  LegWind& legWindEntry = legWindCache[legIndex];
+  const ageo::LineString& lastLine = legWindEntry.lines[slot];
+
+  // Compare exactly including altitude since wind is interpolated by altitude
+  bool equal = lastLine.size() == line.size() && !line.isEmpty();
+  for(int i = 0; i < line.size() && equal; i++)
+  {
+    const ageo::Pos& p1 = lastLine.at(i), & p2 = line.at(i);
+    equal = p1.getLonX() == p2.getLonX() && p1.getLatY() == p2.getLatY() && p1.getAltitude() == p2.getAltitude();
+  }
+
+  if(!equal)
+  {
+    WindReporter *windReporter = NavApp::getWindReporter();
+    legWindEntry.lines[slot] = line;
+    legWindEntry.winds[slot] = slot == WIND_POS ? windReporter->getWindForPosRoute(line.constFirst()) :
+                               windReporter->getWindForLineStringRoute(line);
+  }
+  return legWindEntry.winds[slot];
+}
+
 void RouteAltitude::calculateTrip(const atools::fs::perf::AircraftPerf& perf)
 {
   if(isEmpty())
     return;
 
-  WindReporter *windReporter = NavApp::getWindReporter();
+  // Keep winds for legs which did not change
+  if(legWindCache.size() != size())
+    legWindCache.resize(size());
 
   climbFuel = cruiseFuel = descentFuel = climbTime = cruiseTime = descentTime = tripFuel = alternateFuel = 0.f;
 
@@ -1802,14 +1862,14 @@ void RouteAltitude::calculateTrip(const atools::fs::perf::AircraftPerf& perf)
       {
         // All climb before TOC ==========================
         climbDist = legDist;
-        climbWind = windReporter->getWindForLineStringRoute(legLine);
+        climbWind = legWind(i, WIND_CLIMB, legLine);
         climbSpeed = perf.getClimbSpeed();
       }
       else if(startDistLeg >= todDist)
       {
         // All descent after TOD ==========================
         descentDist = legDist;
-        descentWind = windReporter->getWindForLineStringRoute(legLine);
+        descentWind = legWind(i, WIND_DESCENT, legLine);
         descentSpeed = perf.getDescentSpeed();
       }
       else if(startDistLeg <= tocDist && endDistLeg >= todDist)
@@ -1817,29 +1877,29 @@ void RouteAltitude::calculateTrip(const atools::fs::perf::AircraftPerf& perf)
         // Crosses TOC *and* TOD  - phases climb, cruise and descent ==========================
         // Climb to TOC ===================
         climbDist = tocDist - startDistLeg;
-        climbWind = windReporter->getWindForLineStringRoute(legLine.left(2));
+        climbWind = legWind(i, WIND_CLIMB, legLine.left(2));
         climbSpeed = perf.getClimbSpeed();
 
         // cruise - TOC to TOD ===================
         cruiseDist = todDist - tocDist;
-        cruiseWind = windReporter->getWindForLineStringRoute(legLine.mid(1, 2));
+        cruiseWind = legWind(i, WIND_CRUISE, legLine.mid(1, 2));
         cruiseSpeed = perf.getCruiseSpeed();
 
         // TOD to destination ===================
         descentDist = endDistLeg - todDist;
-        descentWind = windReporter->getWindForLineStringRoute(legLine.right(2));
+        descentWind = legWind(i, WIND_DESCENT, legLine.right(2));
         descentSpeed = perf.getDescentSpeed();
       }
       else if(startDistLeg <= tocDist && endDistLeg <= todDist)
       {
         // Crosses TOC and goes into cruise ==========================
         climbDist = tocDist - startDistLeg;
-        climbWind = windReporter->getWindForLineStringRoute(legLine.left(2));
+        climbWind = legWind(i, WIND_CLIMB, legLine.left(2));
         climbSpeed = perf.getClimbSpeed();
 
         // Cruise to TOD ==========================
         cruiseDist = endDistLeg - tocDist;
-        cruiseWind = windReporter->getWindForLineStringRoute(legLine.right(2));
+        cruiseWind = legWind(i, WIND_CRUISE, legLine.right(2));
         cruiseSpeed = perf.getCruiseSpeed();
       }
       else if(startDistLeg >= tocDist && endDistLeg >= todDist)
@@ -1847,19 +1907,19 @@ void RouteAltitude::calculateTrip(const atools::fs::perf::AircraftPerf& perf)
         // Goes from cruise to and after TOD ==========================
         // Cruise to TOD ==========================
         cruiseDist = todDist - startDistLeg;
-        cruiseWind = windReporter->getWindForLineStringRoute(legLine.left(2));
+        cruiseWind = legWind(i, WIND_CRUISE, legLine.left(2));
         cruiseSpeed = perf.getCruiseSpeed();
 
         // TOD to destination ===================
         descentDist = endDistLeg - todDist;
-        descentWind = windReporter->getWindForLineStringRoute(legLine.right(2));
+        descentWind = legWind(i, WIND_DESCENT, legLine.right(2));
         descentSpeed = perf.getDescentSpeed();
       }
       else
       {
         // Cruise only ==========================
         cruiseDist = legDist;
-        cruiseWind = windReporter->getWindForLineStringRoute(legLine);
+        cruiseWind = legWind(i, WIND_CRUISE, legLine);
         cruiseSpeed = perf.getCruiseSpeed();
       }
 
@@ -1950,7 +2010,9 @@ void RouteAltitude::calculateTrip(const atools::fs::perf::AircraftPerf& perf)
         leg.cruiseFuel = perf.getCruiseFuelFlow() * leg.cruiseTime;
         leg.descentFuel = perf.getDescentFuelFlow() * leg.descentTime;
 
-        atools::grib::Wind wind = windReporter->getWindForPosRoute(legLine.getPos2());
+        ageo::LineString posLine;
+        posLine.append(legLine.getPos2());
+        atools::grib::Wind wind = legWind(i, WIND_POS, posLine);
         leg.windSpeed = wind.speed;
         leg.windDirection = wind.dir;
 
@@ -19,6 +19,8 @@
 #define LNM_ROUTEALTITUDE_H
 
 #include "route/routealtitudeleg.h"
+#include "geo/linestring.h"
+#include "grib/windtypes.h"
 
 #include <QCoreApplication>
 
@@ -147,6 +149,13 @@ public:
    * value in feet. */
   void calculateAll(const atools::fs::perf::AircraftPerf& perf, float cruiseAltitudeFt);
 
+  /* Drop the wind values kept per leg from the last calculation. Has to be called if wind
+   * data or performance change. Otherwise only legs with changed geometry or altitude query the wind again. */
+  void clearWindCache()
+  {
+    legWindCache.clear();
+  }
+
   /* Get interpolated altitude value in ft for the given distance to destination in NM.
    *  Not for missed and alternate legs. */
   float getAltitudeForDistance(float distanceToDest) const;
@@ -407,6 +416,20 @@ public:
 private:
   friend QDebug operator<<(QDebug out, const RouteAltitude& obj);
 
+  /* Input values for calculateFuelAndTimeTo() which are not covered by the leg data */
+  struct FuelTimeKey
+  {
+    float distanceToDest, distanceToNext, aircraftFuelFlowLbs, aircraftFuelFlowGal, aircraftGroundSpeed;
+    int activeLegIdx;
+    bool alternate, missed, fuelFlowValid, speedValid, fuelAsVolume, jetFuel;
+
+    bool operator==(const FuelTimeKey& other) const;
+  };
+
+  void calculateFuelAndTimeToInternal(FuelTimeResult& result, float distanceToDest, float distanceToNext,
+                                      const atools::fs::perf::AircraftPerf& perf, float aircraftFuelFlowLbs,
+                                      float aircraftFuelFlowGal, float aircraftGroundSpeed, int activeLegIdx) const;
+
   /* Calculate altitudes for all legs. Error list will be filled with altitude restriction violations. */
   void calculate(QStringList& altRestErrors);
 
@@ -462,6 +485,26 @@ private:
 
   float windCorrectedGroundSpeed(atools::grib::Wind& wind, float course, float speed);
 
+  /* Slots for wind values in the leg cache */
+  enum WindSlot
+  {
+    WIND_CLIMB,
+    WIND_CRUISE,
+    WIND_DESCENT,
+    WIND_POS, /* Wind at end of leg */
+    NUM_WIND_SLOTS
+  };
+
+  /* Get wind for line from leg cache or wind reporter if line or altitudes have changed */
+  atools::grib::Wind legWind(int legIndex, WindSlot slot, const atools::geo::LineString& line);
+
+  /* Line and resulting wind used for the last query */
+  struct LegWind
+  {
+    atools::geo::LineString lines[NUM_WIND_SLOTS];
+    atools::grib::Wind winds[NUM_WIND_SLOTS];
+  };
+
   /* NM from start */
   float distanceTopOfClimb = map::INVALID_DISTANCE_VALUE, distanceTopOfDescent = map::INVALID_DISTANCE_VALUE;
 
@@ -501,6 +544,15 @@ private:
   /* Contains a list of messages if the calculation result violates altitude restrictions
    * which can happen if the cruise altitude is too low */
   QStringList errors;
+
+  /* Wind queries kept from the last calculation by leg index. Used to skip queries for unchanged legs. */
+  QVector<LegWind> legWindCache;
+
+  /* Result of last calculateFuelAndTimeTo() call. Reused since progress display, profile and tooltips
+   * ask for the same aircraft position. Reset on recalculation. */
+  mutable FuelTimeKey lastFuelTimeKey;
+  mutable FuelTimeResult lastFuelTimeResult;
+  mutable bool lastFuelTimeValid = false;
 };
 
 QDebug operator<<(QDebug out, const RouteAltitude& obj);
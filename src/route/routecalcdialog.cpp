@@ -79,6 +79,13 @@ RouteCalcDialog::RouteCalcDialog(QWidget *parent)
 
   connect(ui->pushButtonRouteCalcDirect, &QPushButton::clicked, this, &RouteCalcDialog::calculateDirectClicked);
   connect(ui->pushButtonRouteCalcReverse, &QPushButton::clicked, this, &RouteCalcDialog::calculateReverseClicked);
+  connect(ui->pushButtonRouteCalcAlternatives, &QPushButton::clicked, this, &RouteCalcDialog::alternativesClicked);
+  connect(ui->treeWidgetRouteCalcAlternatives, &QTreeWidget::itemDoubleClicked, this, [this](QTreeWidgetItem *item, int) {
+    int index = ui->treeWidgetRouteCalcAlternatives->indexOfTopLevelItem(item);
+    if(index != -1 && !calculating)
+      emit alternativeSelected(index);
+  });
+  ui->treeWidgetRouteCalcAlternatives->setVisible(false);
   connect(ui->pushButtonRouteCalcTrackDownload, &QPushButton::clicked, this, &RouteCalcDialog::downloadTrackClicked);
   connect(ui->pushButtonRouteCalcAdjustAltitude, &QPushButton::clicked, this, &RouteCalcDialog::adjustAltitudePressed);
   connect(ui->radioButtonRouteCalcAirway, &QRadioButton::clicked, this, &RouteCalcDialog::updateWidgets);
@@ -107,7 +114,6 @@ void RouteCalcDialog::buttonBoxClicked(QAbstractButton *button)
   {
     calculating = true;
     updateWidgets();
-    QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
     emit calculateClicked();
     calculating = false;
     updateWidgets();
@@ -118,6 +124,39 @@ void RouteCalcDialog::buttonBoxClicked(QAbstractButton *button)
     QDialog::hide();
 }
 
+void RouteCalcDialog::alternativesClicked()
+{
+  calculating = true;
+  updateWidgets();
+  emit calculateAlternativesClicked();
+  calculating = false;
+  updateWidgets();
+}
+
+void RouteCalcDialog::setAlternatives(const QList<QStringList>& rows)
+{
+  QTreeWidget *tree = ui->treeWidgetRouteCalcAlternatives;
+  tree->clear();
+
+  for(const QStringList& row : rows)
+  {
+    QTreeWidgetItem *item = new QTreeWidgetItem(row);
+    for(int col = 1; col < row.size(); col++)
+      item->setTextAlignment(col, Qt::AlignRight);
+    tree->addTopLevelItem(item);
+  }
+
+  for(int col = 0; col < tree->columnCount(); col++)
+    tree->resizeColumnToContents(col);
+
+  tree->setVisible(!rows.isEmpty());
+}
+
+void RouteCalcDialog::clearAlternatives()
+{
+  setAlternatives(QList<QStringList>());
+}
+
 void RouteCalcDialog::showForFullCalculation()
 {
   ui->radioButtonRouteCalcFull->setChecked(true);
@@ -170,6 +209,7 @@ void RouteCalcDialog::updateWidgets()
     ui->buttonBox->button(QDialogButtonBox::Close)->setEnabled(false);
     ui->pushButtonRouteCalcDirect->setEnabled(false);
     ui->pushButtonRouteCalcReverse->setEnabled(false);
+    ui->pushButtonRouteCalcAlternatives->setEnabled(false);
   }
   else
   {
@@ -187,6 +227,7 @@ void RouteCalcDialog::updateWidgets()
     bool canCalcRoute = NavApp::getRouteConst().canCalcRoute();
     ui->pushButtonRouteCalcAdjustAltitude->setEnabled(canCalcRoute);
     ui->buttonBox->button(QDialogButtonBox::Apply)->setEnabled(isCalculateSelection() ? canCalculateSelection : canCalcRoute);
+    ui->pushButtonRouteCalcAlternatives->setEnabled(isCalculateSelection() ? canCalculateSelection : canCalcRoute);
     ui->buttonBox->button(QDialogButtonBox::Close)->setEnabled(true);
 
     ui->pushButtonRouteCalcDirect->setEnabled(canCalcRoute && NavApp::getRouteConst().hasEntries());
@@ -304,7 +345,8 @@ void RouteCalcDialog::saveState()
 
 void RouteCalcDialog::preDatabaseLoad()
 {
-
+  // Results refer to the old navdata
+  clearAlternatives();
 }
 
 void RouteCalcDialog::postDatabaseLoad()
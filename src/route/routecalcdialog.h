@@ -91,6 +91,11 @@ public:
 
   void optionsChanged();
 
+  /* Show results of alternative calculations in the tree widget. One list of column texts per result.
+   * Hidden if list is empty. */
+  void setAlternatives(const QList<QStringList>& rows);
+  void clearAlternatives();
+
   /* Airway or radionav */
   rd::RoutingType getRoutingType() const;
 
@@ -139,6 +144,12 @@ signals:
   void calculateDirectClicked();
   void calculateReverseClicked();
 
+  /* Calculate alternatives button clicked */
+  void calculateAlternativesClicked();
+
+  /* User double-clicked result of alternative calculation at index */
+  void alternativeSelected(int index);
+
 private:
   /* Fill header message with departure, destination or error messages. */
   void updateHeader();
@@ -148,6 +159,7 @@ private:
   void adjustAltitudePressed();
 
   void buttonBoxClicked(QAbstractButton *button);
+  void alternativesClicked();
 
   /* Catch events to allow repositioning */
   virtual void showEvent(QShowEvent *) override;
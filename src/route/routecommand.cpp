@@ -18,6 +18,49 @@
 #include "route/routecommand.h"
 #include "route/routecontroller.h"
 
+#include "atools.h"
+
+#include <QDebug>
+#include <QHash>
+
+using atools::fs::pln::Flightplan;
+using atools::fs::pln::FlightplanEntry;
+
+/* Compare all entry fields. These are all fields which can be changed by the user or the route controller. */
+static bool entriesEqual(const FlightplanEntry& entry1, const FlightplanEntry& entry2)
+{
+  return entry1.getWaypointType() == entry2.getWaypointType() &&
+         entry1.getIdent() == entry2.getIdent() &&
+         entry1.getRegion() == entry2.getRegion() &&
+         entry1.getName() == entry2.getName() &&
+         entry1.getAirway() == entry2.getAirway() &&
+         entry1.getComment() == entry2.getComment() &&
+         entry1.getFlags() == entry2.getFlags() &&
+         entry1.getPosition() == entry2.getPosition() &&
+         atools::almostEqual(entry1.getAltitude(), entry2.getAltitude()) &&
+         atools::almostEqual(entry1.getMagvar(), entry2.getMagvar());
+}
+
+/* Checksum over the same fields as compared in entriesEqual() */
+static uint entriesChecksum(const Flightplan& flightplan)
+{
+  uint checksum = static_cast<uint>(flightplan.size());
+  for(const FlightplanEntry& entry : flightplan)
+  {
+    checksum = checksum * 31 + static_cast<uint>(entry.getWaypointType());
+    checksum = checksum * 31 + qHash(entry.getIdent());
+    checksum = checksum * 31 + qHash(entry.getRegion());
+    checksum = checksum * 31 + qHash(entry.getName());
+    checksum = checksum * 31 + qHash(entry.getAirway());
+    checksum = checksum * 31 + qHash(entry.getComment());
+    checksum = checksum * 31 + static_cast<uint>(entry.getFlags());
+    checksum = checksum * 31 + qHash(entry.getPosition().getLonX());
+    checksum = checksum * 31 + qHash(entry.getPosition().getLatY());
+    checksum = checksum * 31 + qHash(entry.getAltitude());
+  }
+  return checksum;
+}
+
 RouteCommand::RouteCommand(RouteController *routeController,
                            const atools::fs::pln::Flightplan& flightplanBefore, const QString& text,
                            rctype::RouteCmdType rcType)
@@ -33,12 +76,81 @@ RouteCommand::~RouteCommand()
 
 void RouteCommand::setFlightplanAfter(const atools::fs::pln::Flightplan& flightplanAfter)
 {
-  planAfterChange = flightplanAfter;
+  const Flightplan& before = planBeforeChange;
+  int minSize = std::min(before.size(), flightplanAfter.size());
+
+  // Find unchanged entries at start and end
+  int prefix = 0;
+  while(prefix < minSize && entriesEqual(before.at(prefix), flightplanAfter.at(prefix)))
+    prefix++;
+
+  int suffix = 0;
+  while(suffix < minSize - prefix &&
+        entriesEqual(before.at(before.size() - 1 - suffix), flightplanAfter.at(flightplanAfter.size() - 1 - suffix)))
+    suffix++;
+
+  int numBefore = before.size() - prefix - suffix, numAfter = flightplanAfter.size() - prefix - suffix;
+
+  if(type == rctype::REVERSE || (numBefore + numAfter) * 2 > before.size() + flightplanAfter.size())
+  {
+    // Change affects most of the plan - keep full copies
+    fullCopy = true;
+    planAfterChange = flightplanAfter;
+  }
+  else
+  {
+    // Keep only the replaced range and the headers
+    fullCopy = false;
+    deltaIndex = prefix;
+    sizeBeforeChange = before.size();
+    sizeAfterChange = flightplanAfter.size();
+    entriesBeforeChange = before.mid(prefix, numBefore);
+    entriesAfterChange = flightplanAfter.mid(prefix, numAfter);
+    checksumBeforeChange = entriesChecksum(before);
+    checksumAfterChange = entriesChecksum(flightplanAfter);
+
+    planAfterChange = flightplanAfter;
+    planAfterChange.clear();
+    planBeforeChange.clear();
+  }
+}
+
+bool RouteCommand::buildFlightplan(Flightplan& flightplan, const Flightplan& header, int numReplace,
+                                   const QList<FlightplanEntry>& replacement, int expectedSize, uint expectedChecksum) const
+{
+  // Clean the flight plan from any procedure entries as done for the stored states
+  Flightplan current = controller->getRouteConst().getFlightplanConst();
+  current.removeProcedureEntries();
+
+  // Applying the delta to a different plan would result in a corrupted plan - fail undo or redo instead
+  if(current.size() != expectedSize || entriesChecksum(current) != expectedChecksum)
+  {
+    qWarning() << Q_FUNC_INFO << "Flight plan does not match undo state. Size" << current.size() << "expected" << expectedSize;
+    return false;
+  }
+
+  flightplan = header;
+  flightplan.clear();
+  flightplan.append(current.mid(0, deltaIndex));
+  flightplan.append(replacement);
+  flightplan.append(current.mid(deltaIndex + numReplace));
+  return true;
 }
 
 void RouteCommand::undo()
 {
-  controller->changeRouteUndo(planBeforeChange);
+  if(fullCopy)
+    controller->changeRouteUndo(planBeforeChange);
+  else
+  {
+    Flightplan flightplan;
+    if(buildFlightplan(flightplan, planBeforeChange, entriesAfterChange.size(), entriesBeforeChange,
+                       sizeAfterChange, checksumAfterChange))
+      controller->changeRouteUndo(flightplan);
+    else
+      // Stack index is moved anyway - history is unusable now
+      controller->clearUndoStackDeferred();
+  }
 }
 
 void RouteCommand::redo()
@@ -46,6 +158,15 @@ void RouteCommand::redo()
   if(!firstRedoExecuted)
     // Skip first redo - I need to do the initial changes myself
     firstRedoExecuted = true;
-  else
+  else if(fullCopy)
     controller->changeRouteRedo(planAfterChange);
+  else
+  {
+    Flightplan flightplan;
+    if(buildFlightplan(flightplan, planAfterChange, entriesBeforeChange.size(), entriesAfterChange,
+                       sizeBeforeChange, checksumBeforeChange))
+      controller->changeRouteRedo(flightplan);
+    else
+      controller->clearUndoStackDeferred();
+  }
 }
@@ -27,7 +27,15 @@ class RouteController;
 
 /*
  * Flight plan undo command including a few workaround for QUndoCommand inflexibilities.
- * Keeps a copy of the flight plan before and after the change.
+ *
+ * Keeps the flight plan header (properties, cruise altitude, etc.) before and after the change
+ * and only the range of entries which was replaced by the change. This covers insert, move and delete
+ * of legs as well as header only changes like altitude or procedures. The untouched entries are taken
+ * from the current flight plan in RouteController when undoing or redoing.
+ *
+ * Falls back to full copies of the flight plan before and after if the change touches most of the entries
+ * like the reverse action. If the current plan does not match the size and checksum of the stored state on undo
+ * or redo, the delta is not applied and the undo stack is cleared.
  */
 class RouteCommand :
   public QUndoCommand
@@ -44,11 +52,25 @@ public:
   void setFlightplanAfter(const atools::fs::pln::Flightplan& flightplanAfter);
 
 private:
+  /* Build a flight plan from the current one in the controller by replacing the changed range of entries.
+   * Returns false if the current plan does not match the expected size and checksum. */
+  bool buildFlightplan(atools::fs::pln::Flightplan& flightplan, const atools::fs::pln::Flightplan& header, int numReplace,
+                       const QList<atools::fs::pln::FlightplanEntry>& replacement, int expectedSize,
+                       uint expectedChecksum) const;
+
   /* Avoid the first redo action when inserting the command. This not usable for complex interactions. */
   bool firstRedoExecuted = false;
   RouteController *controller;
   rctype::RouteCmdType type;
+
+  /* Full flight plans if fullCopy is true. Otherwise header only without entries. */
   atools::fs::pln::Flightplan planBeforeChange, planAfterChange;
+
+  /* Delta: entries starting at deltaIndex which were replaced by the change */
+  bool fullCopy = true;
+  int deltaIndex = 0, sizeBeforeChange = 0, sizeAfterChange = 0;
+  uint checksumBeforeChange = 0, checksumAfterChange = 0;
+  QList<atools::fs::pln::FlightplanEntry> entriesBeforeChange, entriesAfterChange;
 };
 
 #endif // LITTLENAVMAP_ROUTECOMMAND_H
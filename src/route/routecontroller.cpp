@@ -22,11 +22,14 @@
 #include "common/filecheck.h"
 #include "common/formatter.h"
 #include "common/mapcolors.h"
+#include "common/stallmonitor.h"
 #include "common/symbolpainter.h"
 #include "common/tabindexes.h"
 #include "common/unit.h"
 #include "common/unit.h"
 #include "common/unitstringtool.h"
+#include "common/waitloop.h"
+#include "db/databasepool.h"
 #include "exception.h"
 #include "export/csvexporter.h"
 #include "fs/perf/aircraftperf.h"
@@ -51,6 +54,8 @@
 #include "query/airwaytrackquery.h"
 #include "query/mapquery.h"
 #include "query/procedurequery.h"
+#include "query/querytypes.h"
+#include "route/cruisealtitudedialog.h"
 #include "route/customproceduredialog.h"
 #include "route/flightplanentrybuilder.h"
 #include "route/routealtitude.h"
@@ -71,8 +76,10 @@
 #include "ui_mainwindow.h"
 #include "util/contextsaver.h"
 #include "util/htmlbuilder.h"
+#include "weather/windreporter.h"
 
 #include <QClipboard>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QStandardItemModel>
 #include <QInputDialog>
@@ -82,7 +89,9 @@
 #include <QProgressDialog>
 #include <QScrollBar>
 #include <QStringBuilder>
+#include <QTimer>
 #include <QUndoStack>
+#include <QtConcurrent/QtConcurrentRun>
 
 namespace rcol {
 // Route table column indexes
@@ -164,6 +173,9 @@ const static int MAX_REMARK_COLS_HTML_AND_PRINT = 200;
 const static int MIN_SIM_UPDATE_TIME_MS = 100;
 const static int ROUTE_ALT_CHANGE_DELAY_MS = 500;
 
+/* Collect wind and performance changes which arrive in quick succession */
+const static int ROUTE_RECALC_DELAY_MS = 200;
+
 using atools::fs::pln::Flightplan;
 using atools::fs::pln::FlightplanEntry;
 using atools::gui::ActionTool;
@@ -342,6 +354,10 @@ RouteController::RouteController(QMainWindow *parentWindow, QTableView *tableVie
   connect(&routeAltDelayTimer, &QTimer::timeout, this, &RouteController::routeAltChangedDelayed);
   routeAltDelayTimer.setSingleShot(true);
 
+  // Recalculate altitude, wind and fuel once after wind or performance changes ====================
+  connect(&routeRecalcDelayTimer, &QTimer::timeout, this, &RouteController::routeRecalcDelayed);
+  routeRecalcDelayTimer.setSingleShot(true);
+
   // Clear selection after inactivity
   // Or move active to top after inactivity (no scrolling)
   connect(&tableCleanupTimer, &QTimer::timeout, this, &RouteController::cleanupTableTimeout);
@@ -421,10 +437,16 @@ RouteController::RouteController(QMainWindow *parentWindow, QTableView *tableVie
   connect(ui->actionRouteDisplayOptions, &QAction::triggered, this, &RouteController::routeTableOptions);
   connect(ui->pushButtonRouteSettings, &QPushButton::clicked, this, &RouteController::routeTableOptions);
 
+  // Invalidate cached texts before any other receiver is notified
+  connect(this, &RouteController::routeChanged, this, &RouteController::incrementRouteRevision);
+  connect(this, &RouteController::routeAltitudeChanged, this, &RouteController::incrementRouteRevision);
+
   connect(this, &RouteController::routeChanged, routeCalcDialog, &RouteCalcDialog::routeChanged);
   connect(routeCalcDialog, &RouteCalcDialog::calculateClicked, this, &RouteController::calculateRoute);
   connect(routeCalcDialog, &RouteCalcDialog::calculateDirectClicked, this, &RouteController::calculateDirect);
   connect(routeCalcDialog, &RouteCalcDialog::calculateReverseClicked, this, &RouteController::reverseRoute);
+  connect(routeCalcDialog, &RouteCalcDialog::calculateAlternativesClicked, this, &RouteController::calculateRouteAlternatives);
+  connect(routeCalcDialog, &RouteCalcDialog::alternativeSelected, this, &RouteController::useRouteAlternative);
   connect(routeCalcDialog, &RouteCalcDialog::downloadTrackClicked, NavApp::getTrackController(), &TrackController::startDownload);
 
   connect(routeLabel, &RouteLabel::flightplanLabelLinkActivated, this, &RouteController::flightplanLabelLinkActivated);
@@ -444,6 +466,8 @@ RouteController::~RouteController()
 {
   NavApp::removeDialogFromDockHandler(routeCalcDialog);
   routeAltDelayTimer.stop();
+  routeRecalcDelayTimer.stop();
+  waitForNetworkPreload();
 
   ATOOLS_DELETE_LOG(routeCalcDialog);
   ATOOLS_DELETE_LOG(tabHandlerRoute);
@@ -678,6 +702,24 @@ QString RouteController::getFlightplanTableAsHtml(float iconSizePixel, bool prin
   if(model->rowCount() == 0)
     return QString();
 
+  // Reuse last table if route, units, active leg and table layout did not change
+  FlightplanHtmlCacheKey key;
+  key.revision = query::revisionKey({query::REV_ROUTE, query::REV_OPTIONS, query::REV_NAV_DB, query::REV_SIM_DB});
+  key.activeLegIndex = route.getActiveLegIndex();
+  key.iconSizePixel = iconSizePixel;
+  key.print = print;
+  key.headerState = tableViewRoute->horizontalHeader()->saveState();
+
+  if(!flightplanHtmlCache.isEmpty() && flightplanHtmlCacheKey == key)
+    return flightplanHtmlCache;
+
+  flightplanHtmlCacheKey = key;
+  flightplanHtmlCache = getFlightplanTableAsHtmlInternal(iconSizePixel, print);
+  return flightplanHtmlCache;
+}
+
+QString RouteController::getFlightplanTableAsHtmlInternal(float iconSizePixel, bool print) const
+{
   using atools::util::HtmlBuilder;
 
   atools::util::HtmlBuilder html(mapcolors::webTableBackgroundColor, mapcolors::webTableAltBackgroundColor);
@@ -807,18 +849,9 @@ void RouteController::aircraftPerformanceChanged()
   updateTableHeaders(); // Update lbs/gal for fuel
   updateFlightplanFromWidgets();
 
-  // Needs to be called with empty route as well to update the error messages
-  route.updateLegAltitudes();
-
-  updateModelTimeFuelWindAlt();
-  updateModelHighlightsAndErrors();
-  highlightNextWaypoint(route.getActiveLegIndexCorrected());
-
-  routeLabel->updateHeaderLabel();
-  routeLabel->updateFooterSelectionLabel();
-
-  // Emit also for empty route to catch performance changes
-  emit routeChanged(true /* geometryChanged */);
+  // Calls RouteController::routeRecalcDelayed - emit also for empty route to catch performance changes
+  routeRecalcGeometryChanged = true;
+  routeRecalcDelayTimer.start(ROUTE_RECALC_DELAY_MS);
 }
 
 void RouteController::windUpdated()
@@ -827,20 +860,32 @@ void RouteController::windUpdated()
   qDebug() << Q_FUNC_INFO;
 #endif
 
-  if(!route.isEmpty())
-  {
-    // Get type, speed and cruise altitude from widgets
-    route.updateLegAltitudes();
+  // Calls RouteController::routeRecalcDelayed
+  routeRecalcDelayTimer.start(ROUTE_RECALC_DELAY_MS);
+}
 
-    updateModelTimeFuelWindAlt();
-    updateModelHighlightsAndErrors();
-    highlightNextWaypoint(route.getActiveLegIndexCorrected());
-  }
+void RouteController::routeRecalcDelayed()
+{
+#ifdef DEBUG_INFORMATION
+  qDebug() << Q_FUNC_INFO << "geometryChanged" << routeRecalcGeometryChanged;
+#endif
+
+  // Needs to be called with empty route as well to update the error messages
+  // Wind or performance have changed - query wind for all legs again
+  route.updateLegAltitudes(true /* clearWindCache */);
+
+  updateModelTimeFuelWindAlt();
+  updateModelHighlightsAndErrors();
+  highlightNextWaypoint(route.getActiveLegIndexCorrected());
+
+  incrementRouteRevision();
   routeLabel->updateHeaderLabel();
   routeLabel->updateFooterSelectionLabel();
 
-  // Emit also for empty route to catch performance changes
-  emit routeChanged(false /* geometryChanged */);
+  // Publish result to map, profile, info and performance report
+  bool geometryChanged = routeRecalcGeometryChanged;
+  routeRecalcGeometryChanged = false;
+  emit routeChanged(geometryChanged);
 }
 
 /* Spin box altitude has changed value */
@@ -859,6 +904,7 @@ void RouteController::routeAltChanged()
 
   postChange(undoCommand);
 
+  incrementRouteRevision();
   routeLabel->updateHeaderLabel();
   routeLabel->updateFooterSelectionLabel();
 
@@ -877,6 +923,7 @@ void RouteController::routeAltChangedDelayed()
   updateModelHighlightsAndErrors();
   highlightNextWaypoint(route.getActiveLegIndexCorrected());
 
+  incrementRouteRevision();
   routeLabel->updateHeaderLabel();
   routeLabel->updateFooterSelectionLabel();
 
@@ -1845,6 +1892,9 @@ void RouteController::calculateRouteWindowShow()
   routeCalcDialog->raise();
   routeCalcDialog->activateWindow();
 
+  // Load airway network while the user is selecting options
+  startNetworkPreload();
+
   // Transfer cruise altitude from flight plan window to calculation window
   routeCalcDialog->setCruisingAltitudeFt(route.getCruiseAltitudeFt());
 }
@@ -1912,6 +1962,9 @@ void RouteController::calculateRoute()
       mode |= atools::routing::MODE_RADIONAV_NDB;
   }
 
+  // Network might be loading in background
+  waitForNetworkPreload();
+
   if(!net->isLoaded())
   {
     atools::routing::RouteNetworkLoader loader(NavApp::getDatabaseNav(), NavApp::getDatabaseTrack());
@@ -1943,9 +1996,339 @@ void RouteController::calculateRoute()
   routeCalcDialog->updateWidgets();
 }
 
+void RouteController::calculateRouteAlternatives()
+{
+  qDebug() << Q_FUNC_INFO;
+
+  // Stop any background tasks
+  beforeRouteCalc();
+  routeAlternatives.clear();
+  routeCalcDialog->clearAlternatives();
+
+  // Parameter sets ==================================================
+  atools::routing::Modes baseMode = atools::routing::MODE_NONE;
+  int fromIdx = -1, toIdx = -1;
+  if(routeCalcDialog->isCalculateSelection())
+  {
+    fromIdx = std::max(route.getLastIndexOfDepartureProcedure(), routeCalcDialog->getRouteRangeFromIndex());
+    toIdx = std::min(route.getDestinationIndexBeforeProcedure(), routeCalcDialog->getRouteRangeToIndex());
+    baseMode |= atools::routing::MODE_POINT_TO_POINT;
+  }
+  if(route.hasAnySidProcedure())
+    baseMode |= atools::routing::MODE_POINT_TO_POINT;
+
+  atools::routing::Modes airwayMode = baseMode;
+  if(routeCalcDialog->isAirwayNoRnav())
+    airwayMode |= atools::routing::MODE_NO_RNAV;
+
+  float costFactor = routeCalcDialog->getAirwayPreferenceCostFactor();
+  QVector<RouteAlternative> alternatives;
+  alternatives.append({tr("Airways and direct"), routeNetworkAirway, airwayMode | atools::routing::MODE_AIRWAY_WAYPOINT,
+                       costFactor, true});
+  alternatives.append({tr("Airways only"), routeNetworkAirway, airwayMode | atools::routing::MODE_AIRWAY, costFactor, true});
+  alternatives.append({tr("Low altitude airways"), routeNetworkAirway, airwayMode | atools::routing::MODE_VICTOR_WAYPOINT,
+                       costFactor, true});
+  alternatives.append({tr("High altitude airways"), routeNetworkAirway, airwayMode | atools::routing::MODE_JET_WAYPOINT,
+                       costFactor, true});
+  if(NavApp::hasTracks())
+    alternatives.append({tr("Airways and tracks"), routeNetworkAirway,
+                         airwayMode | atools::routing::MODE_AIRWAY_WAYPOINT | atools::routing::MODE_TRACK, costFactor, true});
+  alternatives.append({tr("Radionav VOR"), routeNetworkRadio, baseMode | atools::routing::MODE_RADIONAV_VOR, 1.f, false});
+  alternatives.append({tr("Radionav VOR and NDB"), routeNetworkRadio,
+                       baseMode | atools::routing::MODE_RADIONAV_VOR | atools::routing::MODE_RADIONAV_NDB, 1.f, false});
+
+  // Load networks in the GUI thread - calculations only read from them ==================================
+  waitForNetworkPreload();
+  QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+  for(atools::routing::RouteNetwork *net : {routeNetworkAirway, routeNetworkRadio})
+  {
+    if(!net->isLoaded())
+    {
+      atools::routing::RouteNetworkLoader loader(NavApp::getDatabaseNav(), NavApp::getDatabaseTrack());
+      loader.load(net);
+    }
+  }
+  QGuiApplication::restoreOverrideCursor();
+
+  Pos departurePos, destinationPos;
+  if(fromIdx != -1 && toIdx != -1)
+  {
+    departurePos = route.value(fromIdx).getPosition();
+    destinationPos = route.value(toIdx).getPosition();
+  }
+  else
+  {
+    departurePos = route.getLastLegOfDepartureProcedure().getPosition();
+    destinationPos = route.getDestinationBeforeProcedure().getPosition();
+  }
+  int altitudeFt = atools::roundToInt(routeCalcDialog->getCruisingAltitudeFt());
+
+  // Start all calculations in the global thread pool ==================================
+  waitloop::Progress state;
+  QVector<QFuture<RouteAlternative> > futures;
+  QVector<QFuture<void> > waitFutures;
+  for(const RouteAlternative& alternative : qAsConst(alternatives))
+  {
+    futures.append(QtConcurrent::run(&RouteController::calculateRouteAlternativeThread, alternative, departurePos, destinationPos,
+                                     altitudeFt, &state.canceled));
+    waitFutures.append(QFuture<void>(futures.constLast()));
+  }
+
+  QProgressDialog progress(tr("Calculating Alternative Flight Plans ..."), tr("Cancel"), 0, futures.size(), routeCalcDialog);
+  progress.setWindowTitle(tr("Little Navmap - Calculating Flight Plan"));
+  progress.setWindowFlags(progress.windowFlags() & ~Qt::WindowContextHelpButtonHint);
+  progress.setWindowModality(Qt::ApplicationModal);
+  progress.setMinimumDuration(500);
+
+  // Keep GUI responsive while waiting - returns when all threads are done
+  bool canceled = !waitloop::waitForFutures(progress, waitFutures, &state);
+  progress.reset();
+
+  if(canceled)
+    return;
+
+  // Collect results ==================================
+  float directDistance = departurePos.distanceMeterTo(destinationPos);
+  bool hasWind = NavApp::getWindReporter()->hasAnyWindData();
+  for(const QFuture<RouteAlternative>& future : qAsConst(futures))
+  {
+    RouteAlternative alternative = future.result();
+
+    // Same check as for the normal calculation
+    if(alternative.found && alternative.distanceMeter / directDistance >= MAX_DISTANCE_DIRECT_RATIO)
+      alternative.found = false;
+
+    if(alternative.found && hasWind)
+      alternative.timeHours = routeAlternativeTimeHours(alternative, departurePos, destinationPos, altitudeFt);
+    routeAlternatives.append(alternative);
+  }
+
+  // Sort by wind corrected time if available and distance otherwise - not found at the end
+  std::stable_sort(routeAlternatives.begin(), routeAlternatives.end(), [](const RouteAlternative& a1, const RouteAlternative& a2) {
+    if(a1.found != a2.found)
+      return a1.found;
+    if(a1.timeHours < map::INVALID_TIME_VALUE || a2.timeHours < map::INVALID_TIME_VALUE)
+      return a1.timeHours < a2.timeHours;
+    return a1.distanceMeter < a2.distanceMeter;
+  });
+
+  // Show them in the dialog ==================================
+  QList<QStringList> rows;
+  for(const RouteAlternative& alternative : qAsConst(routeAlternatives))
+  {
+    if(alternative.found)
+    {
+      QSet<int> airwayIds;
+      for(const RouteEntry& entry : qAsConst(alternative.route))
+      {
+        if(entry.airwayId != -1)
+          airwayIds.insert(entry.airwayId);
+      }
+      rows.append({alternative.name, Unit::distMeter(alternative.distanceMeter),
+                   alternative.timeHours < map::INVALID_TIME_VALUE ? formatter::formatMinutesHours(alternative.timeHours) : QString(),
+                   QString::number(alternative.route.size()), QString::number(airwayIds.size())});
+    }
+    else
+      rows.append({alternative.name, tr("Not found"), QString(), QString(), QString()});
+  }
+
+  routeAlternativesFromIndex = fromIdx;
+  routeAlternativesToIndex = toIdx;
+  routeAlternativesDeparture = departurePos;
+  routeAlternativesDestination = destinationPos;
+  routeAlternativesAltitudeFt = altitudeFt;
+
+  routeCalcDialog->setAlternatives(rows);
+  NavApp::setStatusMessage(tr("Calculated %1 alternative flight plans.").arg(routeAlternatives.size()));
+}
+
+float RouteController::routeAlternativeTimeHours(const RouteAlternative& alternative, const Pos& departurePos,
+                                                 const Pos& destinationPos, int altitudeFt) const
+{
+  float tas = NavApp::getAircraftPerformance().getCruiseSpeed();
+  if(!(tas > 1.f))
+    return map::INVALID_TIME_VALUE;
+
+  // Collect positions at cruise altitude ============================
+  auto atCruise = [altitudeFt](Pos pos) -> Pos {
+    pos.setAltitude(altitudeFt);
+    return pos;
+  };
+
+  MapQuery *mapQuery = NavApp::getMapQueryGui();
+  LineString line(atCruise(departurePos));
+  for(const RouteEntry& entry : alternative.route)
+  {
+    map::MapResult result;
+    mapQuery->getMapObjectById(result, entry.ref.objType, map::AIRSPACE_SRC_NONE, entry.ref.id, false /* airportFromNavDatabase */);
+    const Pos& pos = result.getPosition({map::WAYPOINT, map::VOR, map::NDB, map::AIRPORT});
+    if(pos.isValid())
+      line.append(atCruise(pos));
+  }
+  line.append(atCruise(destinationPos));
+
+  // Sum up leg times using the interpolated wind field ============================
+  WindReporter *windReporter = NavApp::getWindReporter();
+  float timeHours = 0.f;
+  for(int i = 0; i < line.size() - 1; i++)
+  {
+    const Pos& pos1 = line.at(i), & pos2 = line.at(i + 1);
+    float distNm = atools::geo::meterToNm(pos1.distanceMeterTo(pos2));
+    if(distNm < 0.01f)
+      continue;
+
+    atools::grib::Wind wind = windReporter->getWindForLineRoute(pos1, pos2);
+    float groundSpeed = atools::geo::windCorrectedGroundSpeed(wind.speed, wind.dir, pos1.angleDegTo(pos2), tas);
+    if(!(groundSpeed > 1.f))
+      // Cannot fly against wind
+      return map::INVALID_TIME_VALUE;
+
+    timeHours += distNm / groundSpeed;
+  }
+  return timeHours;
+}
+
+RouteAlternative RouteController::calculateRouteAlternativeThread(RouteAlternative alternative, const Pos& departurePos,
+                                                                  const Pos& destinationPos, int altitudeFt,
+                                                                  const std::atomic_bool *canceled)
+{
+  // Finder has its own state and only reads from the loaded network
+  atools::routing::RouteFinder routeFinder(alternative.network);
+  routeFinder.setCostFactorForceAirways(alternative.costFactorForceAirways);
+  routeFinder.setProgressCallback([canceled](int, int) -> bool {
+    return !*canceled;
+  });
+
+  alternative.found = routeFinder.calculateRoute(departurePos, destinationPos, altitudeFt, alternative.mode) && !*canceled;
+  if(alternative.found)
+  {
+    RouteExtractor extractor(&routeFinder);
+    extractor.extractRoute(alternative.route, alternative.distanceMeter);
+    alternative.found = !alternative.route.isEmpty();
+  }
+  return alternative;
+}
+
+void RouteController::useRouteAlternative(int index)
+{
+  qDebug() << Q_FUNC_INFO << index;
+
+  if(index < 0 || index >= routeAlternatives.size() || !routeAlternatives.at(index).found)
+    return;
+
+  // Check if flight plan end points are still the same
+  bool calcRange = routeAlternativesFromIndex != -1 && routeAlternativesToIndex != -1;
+  Pos departurePos, destinationPos;
+  if(calcRange)
+  {
+    departurePos = route.value(routeAlternativesFromIndex).getPosition();
+    destinationPos = route.value(routeAlternativesToIndex).getPosition();
+  }
+  else
+  {
+    departurePos = route.getLastLegOfDepartureProcedure().getPosition();
+    destinationPos = route.getDestinationBeforeProcedure().getPosition();
+  }
+
+  if(!departurePos.almostEqual(routeAlternativesDeparture) || !destinationPos.almostEqual(routeAlternativesDestination))
+  {
+    atools::gui::Dialog(routeCalcDialog).showInfoMsgBox(lnm::ACTIONS_SHOW_ROUTE_ERROR,
+                                                        tr("Flight plan has changed since calculating alternatives.\n\n"
+                                                           "Calculate again."),
+                                                        tr("Do not &show this dialog again."));
+    routeAlternatives.clear();
+    routeCalcDialog->clearAlternatives();
+    return;
+  }
+
+  // Stop any background tasks
+  beforeRouteCalc();
+
+  // Ignore events triggering follow due to selection changes
+  atools::util::ContextSaverBool saver(ignoreFollowSelection);
+
+  const RouteAlternative& alternative = routeAlternatives.at(index);
+  QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+  applyCalculatedRoute(alternative.route, tr("%1 Flight Plan Calculation").arg(alternative.name), alternative.fetchAirways,
+                       routeAlternativesAltitudeFt, routeAlternativesFromIndex, routeAlternativesToIndex);
+  QGuiApplication::restoreOverrideCursor();
+
+  if(calcRange)
+  {
+    // Indexes change after calculating a range - results cannot be applied again
+    routeAlternatives.clear();
+    routeCalcDialog->clearAlternatives();
+  }
+
+  NavApp::setStatusMessage(tr("Calculated flight plan."));
+  routeCalcDialog->updateWidgets();
+}
+
 void RouteController::clearAirwayNetworkCache()
 {
+  waitForNetworkPreload();
   routeNetworkAirway->clear();
+
+  // Tracks changed - load again if user is about to calculate
+  if(routeCalcDialog->isVisible())
+    startNetworkPreload();
+}
+
+void RouteController::startNetworkPreload()
+{
+  if(networkPreloadFuture.isRunning() || routeNetworkAirway->isLoaded() ||
+     !atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_ROUTE_NETWORK_PRELOAD, true).toBool())
+    return;
+
+  atools::sql::SqlDatabase *navDb = NavApp::getDatabaseNav(), *trackDb = NavApp::getDatabaseTrack();
+  if(navDb == nullptr || trackDb == nullptr)
+    return;
+
+  qDebug() << Q_FUNC_INFO;
+  networkPreloadFuture = QtConcurrent::run(&RouteController::networkPreloadThread, routeNetworkAirway,
+                                           navDb->databaseName(), trackDb->databaseName());
+}
+
+void RouteController::waitForNetworkPreload()
+{
+  if(networkPreloadFuture.isRunning())
+  {
+    qDebug() << Q_FUNC_INFO << "Waiting for network";
+    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+    networkPreloadFuture.waitForFinished();
+    QGuiApplication::restoreOverrideCursor();
+  }
+}
+
+void RouteController::networkPreloadThread(atools::routing::RouteNetwork *network, const QString& navFile, const QString& trackFile)
+{
+  // Connections are owned by the pool and kept for other jobs in this thread
+  DatabasePool *pool = NavApp::getDatabasePool();
+  atools::sql::SqlDatabase *navDb = pool->getDatabase(navFile);
+  atools::sql::SqlDatabase *trackDb = pool->getDatabase(trackFile);
+
+  if(navDb != nullptr && trackDb != nullptr)
+  {
+    try
+    {
+      QElapsedTimer timer;
+      timer.start();
+      atools::routing::RouteNetworkLoader loader(navDb, trackDb);
+      loader.load(network);
+      qDebug() << Q_FUNC_INFO << "Loaded network in" << timer.elapsed() << "ms";
+    }
+    catch(atools::Exception& e)
+    {
+      // Network is loaded again in GUI thread when calculating
+      qWarning() << Q_FUNC_INFO << "Loading network failed" << e.what();
+      network->clear();
+    }
+    catch(...)
+    {
+      qWarning() << Q_FUNC_INFO << "Loading network failed";
+      network->clear();
+    }
+  }
 }
 
 /* Calculate a flight plan to all types */
@@ -1955,13 +2338,10 @@ bool RouteController::calculateRouteInternal(atools::routing::RouteFinder *route
 {
   qDebug() << Q_FUNC_INFO;
   bool calcRange = fromIndex != -1 && toIndex != -1;
-  int oldRouteSize = route.size();
 
   // Stop any background tasks
   beforeRouteCalc();
 
-  Flightplan& flightplan = route.getFlightplan();
-
   // Load network from database if not already done
   QGuiApplication::setOverrideCursor(Qt::WaitCursor);
 
@@ -1989,13 +2369,32 @@ bool RouteController::calculateRouteInternal(atools::routing::RouteFinder *route
   progress.setWindowModality(Qt::ApplicationModal);
   progress.setMinimumDuration(500);
 
-  bool dialogShown = false, canceled = false;
-  routeFinder->setProgressCallback([&progress, &canceled, &dialogShown](int distToDest, int currentDistToDest) -> bool
+  // Called in the worker thread
+  waitloop::Progress state;
+  routeFinder->setProgressCallback([&state](int distToDest, int currentDistToDest) -> bool
   {
-    QApplication::processEvents();
-    progress.setMaximum(distToDest);
-    progress.setValue(distToDest - currentDistToDest);
-    canceled = progress.wasCanceled();
+    state.maximum = distToDest;
+    state.value = distToDest - currentDistToDest;
+    return !state.canceled;
+  });
+
+  // Calculate the route in a worker thread - calls above lambda ================================================
+  // Finder only reads from the loaded network
+  int altitude = atools::roundToInt(altitudeFt);
+  QFuture<bool> future = QtConcurrent::run([routeFinder, departurePos, destinationPos, altitude, mode]() -> bool {
+    return routeFinder->calculateRoute(departurePos, destinationPos, altitude, mode);
+  });
+
+  // Keep GUI responsive while waiting for the worker
+  bool dialogShown = false;
+  bool canceled = !waitloop::run(progress, [&progress, &state, &future, &dialogShown](bool cancel) -> bool {
+    if(cancel)
+      state.canceled = true;
+    else
+    {
+      progress.setMaximum(state.maximum);
+      progress.setValue(state.value);
+    }
 
     if(!dialogShown && progress.isVisible())
     {
@@ -2003,12 +2402,9 @@ bool RouteController::calculateRouteInternal(atools::routing::RouteFinder *route
       dialogShown = true;
       QGuiApplication::restoreOverrideCursor();
     }
-
-    return !canceled;
+    return future.isFinished();
   });
-
-  // Calculate the route - calls above lambda ================================================
-  bool found = routeFinder->calculateRoute(departurePos, destinationPos, atools::roundToInt(altitudeFt), mode);
+  bool found = future.result();
 
   if(!dialogShown)
     QGuiApplication::restoreOverrideCursor();
@@ -2045,106 +2441,114 @@ bool RouteController::calculateRouteInternal(atools::routing::RouteFinder *route
              << "direct distance" << QString::number(directDistance, 'f', 0) << "ratio" << ratio;
 
     if(ratio < MAX_DISTANCE_DIRECT_RATIO)
-    {
-      // Start undo
-      RouteCommand *undoCommand = preChange(commandName);
-      int numAlternateLegs = route.getNumAlternateLegs();
-
-      if(calcRange)
-      {
-        flightplan[toIndex].setAirway(QString());
-        flightplan[toIndex].setFlag(atools::fs::pln::entry::TRACK, false);
-        flightplan.erase(flightplan.begin() + fromIndex + 1, flightplan.begin() + toIndex);
-      }
-      else
-        // Erase all but start and destination
-        flightplan.erase(flightplan.begin() + 1, flightplan.end() - numAlternateLegs - 1);
+      applyCalculatedRoute(calculatedRoute, commandName, fetchAirways, altitudeFt, fromIndex, toIndex);
+    else
+      // Too long
+      found = false;
+  }
 
-      int idx = 1;
-      // Create flight plan entries - will be copied later to the route map objects
-      for(const RouteEntry& routeEntry : qAsConst(calculatedRoute))
-      {
-        FlightplanEntry flightplanEntry;
-        entryBuilder->buildFlightplanEntry(routeEntry.ref.id, atools::geo::EMPTY_POS, routeEntry.ref.objType,
-                                           flightplanEntry, fetchAirways);
-        if(fetchAirways && routeEntry.airwayId != -1)
-          // Get airway by id - needed to fetch the name first
-          updateFlightplanEntryAirway(routeEntry.airwayId, flightplanEntry);
-
-        if(calcRange)
-          flightplan.insert(flightplan.begin() + fromIndex + idx, flightplanEntry);
-        else
-          flightplan.insert(flightplan.end() - numAlternateLegs - 1, flightplanEntry);
-        idx++;
-      }
+  QGuiApplication::restoreOverrideCursor();
+  if(!found && !canceled)
+    // Use routeCalcDialog as parent to avoid main raising in front
+    atools::gui::Dialog(routeCalcDialog).showInfoMsgBox(lnm::ACTIONS_SHOW_ROUTE_ERROR,
+                                                        tr("Cannot calculate flight plan.\n\n"
+                                                           "Try another calculation type,\n"
+                                                           "change the cruise altitude or\n"
+                                                           "create the flight plan manually."),
+                                                        tr("Do not &show this dialog again."));
+#ifdef DEBUG_INFORMATION
+  qDebug() << Q_FUNC_INFO << route;
+#endif
 
-      // Remove procedure points from flight plan
-      flightplan.removeProcedureEntries();
+  return found;
+}
 
-      // Copy flight plan to route object
-      route.createRouteLegsFromFlightplan();
+void RouteController::applyCalculatedRoute(const QVector<RouteEntry>& calculatedRoute, const QString& commandName,
+                                           bool fetchAirways, float altitudeFt, int fromIndex, int toIndex)
+{
+  bool calcRange = fromIndex != -1 && toIndex != -1;
+  int oldRouteSize = route.size();
+  Flightplan& flightplan = route.getFlightplan();
 
-      // Reload procedures from properties
-      loadProceduresFromFlightplan(true /* clearOldProcedureProperties */, false /* cleanupRoute */, false /* autoresolveTransition */);
-      QGuiApplication::restoreOverrideCursor();
+  // Start undo
+  RouteCommand *undoCommand = preChange(commandName);
+  int numAlternateLegs = route.getNumAlternateLegs();
 
-      // Remove duplicates in flight plan and route
-      route.updateAll();
+  if(calcRange)
+  {
+    flightplan[toIndex].setAirway(QString());
+    flightplan[toIndex].setFlag(atools::fs::pln::entry::TRACK, false);
+    flightplan.erase(flightplan.begin() + fromIndex + 1, flightplan.begin() + toIndex);
+  }
+  else
+    // Erase all but start and destination
+    flightplan.erase(flightplan.begin() + 1, flightplan.end() - numAlternateLegs - 1);
 
-      // Set altitude in local units
-      flightplan.setCruiseAltitudeFt(altitudeFt);
+  int idx = 1;
+  // Create flight plan entries - will be copied later to the route map objects
+  for(const RouteEntry& routeEntry : qAsConst(calculatedRoute))
+  {
+    FlightplanEntry flightplanEntry;
+    entryBuilder->buildFlightplanEntry(routeEntry.ref.id, atools::geo::EMPTY_POS, routeEntry.ref.objType,
+                                       flightplanEntry, fetchAirways);
+    if(fetchAirways && routeEntry.airwayId != -1)
+      // Get airway by id - needed to fetch the name first
+      updateFlightplanEntryAirway(routeEntry.airwayId, flightplanEntry);
+
+    if(calcRange)
+      flightplan.insert(flightplan.begin() + fromIndex + idx, flightplanEntry);
+    else
+      flightplan.insert(flightplan.end() - numAlternateLegs - 1, flightplanEntry);
+    idx++;
+  }
 
-      route.updateAirwaysAndAltitude(false /* adjustRouteAltitude */);
+  // Remove procedure points from flight plan
+  flightplan.removeProcedureEntries();
 
-      updateActiveLeg();
+  // Copy flight plan to route object
+  route.createRouteLegsFromFlightplan();
 
-      route.updateLegAltitudes();
+  // Reload procedures from properties
+  loadProceduresFromFlightplan(true /* clearOldProcedureProperties */, false /* cleanupRoute */, false /* autoresolveTransition */);
+  QGuiApplication::restoreOverrideCursor();
 
-      // Remove all airways violation restrictions during climb or descent
-      clearAirwayViolations();
+  // Remove duplicates in flight plan and route
+  route.updateAll();
 
-      updateTableModelAndErrors();
-      updateActions();
+  // Set altitude in local units
+  flightplan.setCruiseAltitudeFt(altitudeFt);
 
-      postChange(undoCommand);
-      NavApp::updateWindowTitle();
+  route.updateAirwaysAndAltitude(false /* adjustRouteAltitude */);
 
-#ifdef DEBUG_INFORMATION
-      qDebug() << flightplan;
-#endif
+  updateActiveLeg();
 
-      NavApp::updateErrorLabel();
+  route.updateLegAltitudes();
 
-      if(calcRange)
-      {
-        // will also update route window
-        int newToIndex = toIndex - (oldRouteSize - route.size());
-        selectRange(fromIndex, newToIndex);
-      }
+  // Remove all airways violation restrictions during climb or descent
+  clearAirwayViolations();
 
-      tableSelectionChanged(QItemSelection(), QItemSelection());
+  updateTableModelAndErrors();
+  updateActions();
 
-      emit routeChanged(true /* geometryChanged */);
-    }
-    else
-      // Too long
-      found = false;
-  }
+  postChange(undoCommand);
+  NavApp::updateWindowTitle();
 
-  QGuiApplication::restoreOverrideCursor();
-  if(!found && !canceled)
-    // Use routeCalcDialog as parent to avoid main raising in front
-    atools::gui::Dialog(routeCalcDialog).showInfoMsgBox(lnm::ACTIONS_SHOW_ROUTE_ERROR,
-                                                        tr("Cannot calculate flight plan.\n\n"
-                                                           "Try another calculation type,\n"
-                                                           "change the cruise altitude or\n"
-                                                           "create the flight plan manually."),
-                                                        tr("Do not &show this dialog again."));
 #ifdef DEBUG_INFORMATION
-  qDebug() << Q_FUNC_INFO << route;
+  qDebug() << flightplan;
 #endif
 
-  return found;
+  NavApp::updateErrorLabel();
+
+  if(calcRange)
+  {
+    // will also update route window
+    int newToIndex = toIndex - (oldRouteSize - route.size());
+    selectRange(fromIndex, newToIndex);
+  }
+
+  tableSelectionChanged(QItemSelection(), QItemSelection());
+
+  emit routeChanged(true /* geometryChanged */);
 }
 
 void RouteController::adjustFlightplanAltitude()
@@ -2183,6 +2587,40 @@ void RouteController::adjustFlightplanAltitude()
   }
 }
 
+void RouteController::compareCruiseAltitudes()
+{
+  qDebug() << Q_FUNC_INFO;
+
+  if(route.isEmpty())
+    return;
+
+  CruiseAltitudeDialog dialog(mainWindow, route);
+  if(dialog.exec() == QDialog::Accepted)
+  {
+    float altitudeFt = dialog.getSelectedCruiseAltitudeFt();
+
+    if(altitudeFt < map::INVALID_ALTITUDE_VALUE && atools::almostNotEqual(altitudeFt, route.getCruiseAltitudeFt()))
+    {
+      RouteCommand *undoCommand = preChange(tr("Change Altitude"), rctype::ALTITUDE);
+      route.getFlightplan().setCruiseAltitudeFt(altitudeFt);
+
+      updateTableModelAndErrors();
+
+      // Need to update again after updateAll and altitude change
+      route.updateLegAltitudes();
+
+      postChange(undoCommand);
+
+      NavApp::updateWindowTitle();
+      NavApp::updateErrorLabel();
+
+      emit routeAltitudeChanged(route.getCruiseAltitudeFt());
+
+      NavApp::setStatusMessage(tr("Changed flight plan cruise altitude to %1.").arg(Unit::altFeet(altitudeFt)));
+    }
+  }
+}
+
 void RouteController::showInRoute(int index)
 {
   qDebug() << Q_FUNC_INFO << index;
@@ -2262,12 +2700,17 @@ void RouteController::preDatabaseLoad()
 #ifdef DEBUG_INFORMATION
   atools::strToFile(atools::settings::Settings::getConfigFilename("_debug.lnmpln"), tempFlightplanStr);
 #endif
+  routeAlternatives.clear();
   routeCalcDialog->preDatabaseLoad();
+
+  // Background loader uses the database files
+  waitForNetworkPreload();
 }
 
 void RouteController::postDatabaseLoad()
 {
   // Clear routing caches
+  waitForNetworkPreload();
   routeNetworkRadio->clear();
   routeNetworkAirway->clear();
   clearAllErrors();
@@ -2303,6 +2746,9 @@ void RouteController::postDatabaseLoad()
 
   routeCalcDialog->postDatabaseLoad();
 
+  if(routeCalcDialog->isVisible())
+    startNetworkPreload();
+
   NavApp::updateWindowTitle();
   loadingDatabaseState = false;
 }
@@ -2528,6 +2974,7 @@ void RouteController::routeTableOptions()
     updateModelTimeFuelWindAlt();
     updateModelHighlightsAndErrors();
 
+    incrementRouteRevision();
     routeLabel->updateHeaderLabel();
     routeLabel->updateFooterSelectionLabel();
     routeLabel->updateFooterErrorLabel();
@@ -3103,7 +3550,8 @@ void RouteController::editUserWaypointName(int index)
 
       route.getFlightplan()[index] = dialog.getEntry();
 
-      route.updateAll();
+      // Legs were not added or removed - no need to update indexes
+      route.updateAll(ru::UPDATE_LEG_PROPERTIES);
       route.updateLegAltitudes();
 
       updateActiveLeg();
@@ -3293,6 +3741,7 @@ void RouteController::styleChanged()
 {
   tabHandlerRoute->styleChanged();
   updateModelHighlightsAndErrors();
+  flightplanHtmlCache.clear();
   routeLabel->styleChanged();
   atools::gui::adjustSelectionColors(NavApp::getMainUi()->tableViewRoute);
   highlightNextWaypoint(route.getActiveLegIndexCorrected());
@@ -3333,6 +3782,19 @@ void RouteController::updateUnits()
   units->update();
 }
 
+void RouteController::clearUndoStackDeferred()
+{
+  qWarning() << Q_FUNC_INFO << "Flight plan does not match undo state. Clearing undo stack.";
+
+  // Command is still executing and cannot be deleted now
+  QTimer::singleShot(0, this, [this]() -> void {
+    bool changed = hasChanged();
+    undoStack->clear();
+    undoIndex = 0;
+    undoIndexClean = changed ? -1 : 0;
+  });
+}
+
 bool RouteController::hasChanged() const
 {
   return undoIndexClean == -1 || undoIndexClean != undoIndex;
@@ -4718,7 +5180,14 @@ void RouteController::updateTableModelAndErrors()
 
   // Avoid callback selection changed which can result in crashes due to inconsistent route
   blockModel();
-  model->removeRows(0, model->rowCount());
+
+  // Clear selection as a full model reset did before - rows are updated in place below
+  if(tableViewRoute->selectionModel() != nullptr)
+    tableViewRoute->selectionModel()->clear();
+
+  // Remove surplus rows - remaining rows are updated in place to avoid a complete view reset
+  if(model->rowCount() > route.size())
+    model->removeRows(route.size(), model->rowCount() - route.size());
 
   float totalDistance = route.getTotalDistance();
 
@@ -4922,7 +5391,10 @@ void RouteController::updateTableModelAndErrors()
     itemRow[rcol::LONGITUDE]->setTextAlignment(Qt::AlignRight);
     itemRow[rcol::MAGVAR]->setTextAlignment(Qt::AlignRight);
 
-    model->appendRow(itemRow);
+    if(row < model->rowCount())
+      updateModelRow(row, itemRow);
+    else
+      model->appendRow(itemRow);
 
     for(int col = rcol::FIRST_COLUMN; col <= rcol::LAST_COLUMN; col++)
       itemRow[col] = nullptr;
@@ -4954,6 +5426,7 @@ void RouteController::updateTableModelAndErrors()
   updateModelHighlightsAndErrors();
   highlightNextWaypoint(route.getActiveLegIndexCorrected());
 
+  incrementRouteRevision();
   routeLabel->updateHeaderLabel();
   routeLabel->updateFooterSelectionLabel();
 
@@ -4963,6 +5436,29 @@ void RouteController::updateTableModelAndErrors()
   tableViewRoute->horizontalHeader()->setMinimumSectionSize(3);
 }
 
+void RouteController::updateModelRow(int row, const QList<QStandardItem *>& itemRow)
+{
+  for(int col = rcol::FIRST_COLUMN; col <= rcol::LAST_COLUMN; col++)
+  {
+    QStandardItem *newItem = itemRow.at(col);
+    const QStandardItem *item = model->item(row, col);
+
+    // Travel time, fuel, wind and altitude are updated in place by updateModelTimeFuelWindAlt()
+    bool keepItem = col == rcol::LEG_TIME || col == rcol::ETA || col == rcol::FUEL_WEIGHT || col == rcol::FUEL_VOLUME ||
+                    col == rcol::WIND || col == rcol::WIND_HEAD_TAIL || col == rcol::ALTITUDE || col == rcol::SAFE_ALTITUDE;
+
+    // Always replace ident since icon and font depend on navaid type
+    if(!keepItem && col != rcol::IDENT && item != nullptr)
+      keepItem = item->text() == newItem->text() && item->toolTip() == newItem->toolTip();
+
+    if(keepItem && item != nullptr)
+      delete newItem;
+    else
+      // Model deletes old item
+      model->setItem(row, col, newItem);
+  }
+}
+
 void RouteController::updateComboBoxFromFlightplanType()
 {
   Ui::MainWindow *ui = NavApp::getMainUi();
@@ -4988,12 +5484,12 @@ void RouteController::updateModelTimeFuelWindAlt()
 
   using atools::fs::perf::AircraftPerf;
   const RouteAltitude& altitudeLegs = route.getAltitudeLegs();
-  if(altitudeLegs.isEmpty())
-    return;
 
   int row = 0;
   float cumulatedTravelTime = 0.f;
-  bool setValues = !altitudeLegs.hasErrors();
+
+  // Clear values if altitude is not calculated yet since rows are kept when updating the model
+  bool setValues = !altitudeLegs.isEmpty() && !altitudeLegs.hasErrors();
   const AircraftPerf& perf = NavApp::getAircraftPerformance();
   float totalFuelLbsOrGal = altitudeLegs.getTripFuel() + altitudeLegs.getAlternateFuel();
 
@@ -5130,6 +5626,11 @@ void RouteController::updateModelTimeFuelWindAlt()
           }
           model->item(row, rcol::WIND_HEAD_TAIL)->setText(txt);
         }
+        else
+        {
+          model->item(row, rcol::WIND)->setText(QString());
+          model->item(row, rcol::WIND_HEAD_TAIL)->setText(QString());
+        }
 
         // Altitude at waypoint ========================================================
         txt.clear();
@@ -5146,6 +5647,16 @@ void RouteController::updateModelTimeFuelWindAlt()
           txt = Unit::altFeet(safeAlt, false /* addUnit */);
         model->item(row, rcol::SAFE_ALTITUDE)->setText(txt);
       } // if(!leg.getProcedureLeg().isMissed())
+      else
+      {
+        model->item(row, rcol::ETA)->setText(QString());
+        model->item(row, rcol::FUEL_WEIGHT)->setText(QString());
+        model->item(row, rcol::FUEL_VOLUME)->setText(QString());
+        model->item(row, rcol::WIND)->setText(QString());
+        model->item(row, rcol::WIND_HEAD_TAIL)->setText(QString());
+        model->item(row, rcol::ALTITUDE)->setText(QString());
+        model->item(row, rcol::SAFE_ALTITUDE)->setText(QString());
+      }
     } // else if(!route.isAirportAfterArrival(row))
     row++;
   } // for(int i = 0; i < route.size(); i++)
@@ -5203,6 +5714,8 @@ void RouteController::disconnectedFromSimulator()
 
 void RouteController::simDataChanged(const atools::fs::sc::SimConnectData& simulatorData)
 {
+  LNM_STALL_SCOPE;
+
   if(!loadingDatabaseState && atools::almostNotEqual(QDateTime::currentDateTime().toMSecsSinceEpoch(),
                                                      lastSimUpdate, static_cast<qint64>(MIN_SIM_UPDATE_TIME_MS)))
   {
@@ -5264,12 +5777,15 @@ void RouteController::highlightNextWaypoint(int activeLegIdx)
   if(model->rowCount() == 0)
     return;
 
+  // Reset only the previously highlighted row - all other rows are not highlighted
+  // Rows which were replaced when updating the model are not highlighted either
+  int lastActiveLegIndex = activeLegIndex;
   activeLegIndex = activeLegIdx;
-  for(int row = 0; row < model->rowCount(); ++row)
+  if(lastActiveLegIndex >= 0 && lastActiveLegIndex < model->rowCount())
   {
     for(int col = 0; col < model->columnCount(); col++)
     {
-      QStandardItem *item = model->item(row, col);
+      QStandardItem *item = model->item(lastActiveLegIndex, col);
       if(item != nullptr)
       {
         item->setBackground(Qt::NoBrush);
@@ -5755,6 +6271,11 @@ void RouteController::resetTabLayout()
   tabHandlerRoute->reset();
 }
 
+void RouteController::incrementRouteRevision()
+{
+  query::incrementRevision(query::REV_ROUTE);
+}
+
 void RouteController::updateFooterErrorLabel()
 {
   routeLabel->updateFooterErrorLabel();
@@ -5813,6 +6334,7 @@ void RouteController::debugNetworkClick(const atools::geo::Pos& pos)
   {
     qDebug() << Q_FUNC_INFO << pos;
 
+    waitForNetworkPreload();
     atools::routing::RouteNetworkLoader loader(NavApp::getDatabaseNav(), NavApp::getDatabaseTrack());
     if(!routeNetworkAirway->isLoaded())
       loader.load(routeNetworkAirway);
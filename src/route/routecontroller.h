@@ -18,12 +18,17 @@
 #ifndef LITTLENAVMAP_ROUTECONTROLLER_H
 #define LITTLENAVMAP_ROUTECONTROLLER_H
 
+#include "atools.h"
 #include "routing/routenetworktypes.h"
 #include "route/route.h"
 #include "route/routecommandflags.h"
+#include "route/routeextractor.h"
 
+#include <QFuture>
 #include <QTimer>
 
+#include <atomic>
+
 class QUndoStack;
 
 class QAction;
@@ -58,6 +63,7 @@ class FlightplanEntryBuilder;
 class QItemSelection;
 class QMainWindow;
 class QStandardItemModel;
+class QStandardItem;
 class QTableView;
 class QTextCursor;
 class RouteCalcDialog;
@@ -245,6 +251,9 @@ public:
   /* Adjust altitude according to simple east/west VFR/IFR rules */
   void adjustFlightplanAltitude();
 
+  /* Show table of trip fuel and time for several cruise altitudes and apply the selected one */
+  void compareCruiseAltitudes();
+
   /* Select result in flight plan table */
   void showInRoute(int index);
 
@@ -366,6 +375,28 @@ signals:
 private:
   friend class RouteCommand;
 
+  /* Inputs of the cached flight plan HTML table */
+  struct FlightplanHtmlCacheKey
+  {
+    quint64 revision = 0;
+    int activeLegIndex = -1;
+    float iconSizePixel = 0.f;
+    bool print = false;
+    QByteArray headerState;
+
+    bool operator==(const FlightplanHtmlCacheKey& other) const
+    {
+      return revision == other.revision && activeLegIndex == other.activeLegIndex && print == other.print &&
+             atools::almostEqual(iconSizePixel, other.iconSizePixel) && headerState == other.headerState;
+    }
+  };
+
+  /* Builds the table for getFlightplanTableAsHtml() */
+  QString getFlightplanTableAsHtmlInternal(float iconSizePixel, bool print) const;
+
+  /* Invalidates cached label and HTML texts */
+  void incrementRouteRevision();
+
   /* Move selected rows */
   enum MoveDirection
   {
@@ -386,6 +417,10 @@ private:
   /* Called by undo command */
   void changeRouteRedo(const atools::fs::pln::Flightplan& newFlightplan);
 
+  /* Called by undo command if the flight plan does not match the undo state. Clears the undo stack
+   * once the command is done since the stack index does not match the plan anymore. */
+  void clearUndoStackDeferred();
+
   /* Save undo state before and after change */
   RouteCommand *preChange(const QString& text = QString(), rctype::RouteCmdType rcType = rctype::EDIT);
   void postChange(RouteCommand *undoCommand);
@@ -422,15 +457,21 @@ private:
   void routeSetDepartureInternal(const map::MapAirport& airport);
   void routeSetDestinationInternal(const map::MapAirport& airport);
 
-  /* Update table view model completely */
+  /* Update table view model completely. Existing rows are updated in place and only changed items are replaced. */
   void updateTableModelAndErrors();
 
+  /* Replace items in an existing model row if content differs. Takes ownership of the items in itemRow. */
+  void updateModelRow(int row, const QList<QStandardItem *>& itemRow);
+
   /* Remove all airways violating restrictions after altitude calculation during climb and/or descent */
   void clearAirwayViolations();
 
   void routeAltChanged();
   void routeAltChangedDelayed();
 
+  /* Recalculate altitude, wind and fuel after wind or aircraft performance changes. Called by timer. */
+  void routeRecalcDelayed();
+
   void routeTypeChanged();
 
   /* Reset route and clear undo stack (new route) */
@@ -444,6 +485,33 @@ private:
                               bool fetchAirways, float altitudeFt, int fromIndex, int toIndex,
                               atools::routing::Modes mode);
 
+  /* Replace flight plan or range between fromIndex and toIndex with the calculated route. Indexes are -1 for full plan. */
+  void applyCalculatedRoute(const QVector<RouteEntry>& calculatedRoute, const QString& commandName,
+                            bool fetchAirways, float altitudeFt, int fromIndex, int toIndex);
+
+  /* Calculate several parameter sets concurrently and show results in the calculation dialog */
+  void calculateRouteAlternatives();
+
+  /* Estimated flight time at cruise altitude using cruise speed from aircraft performance and the wind field.
+   * Returns map::INVALID_TIME_VALUE if no speed is available or wind is too strong. */
+  float routeAlternativeTimeHours(const RouteAlternative& alternative, const atools::geo::Pos& departurePos,
+                                  const atools::geo::Pos& destinationPos, int altitudeFt) const;
+
+  /* Runs in worker thread on the loaded network */
+  static RouteAlternative calculateRouteAlternativeThread(RouteAlternative alternative, const atools::geo::Pos& departurePos,
+                                                          const atools::geo::Pos& destinationPos, int altitudeFt,
+                                                          const std::atomic_bool *canceled);
+
+  /* Use calculated alternative at index as flight plan */
+  void useRouteAlternative(int index);
+
+  /* Load the airway network in background using separate database connections. Does nothing if already loaded. */
+  void startNetworkPreload();
+
+  /* Wait for background network loading. Has to be called before accessing the airway network. */
+  void waitForNetworkPreload();
+  static void networkPreloadThread(atools::routing::RouteNetwork *network, const QString& navFile, const QString& trackFile);
+
   /* Assign type and altitude from GUI */
   void updateFlightplanFromWidgets(atools::fs::pln::Flightplan& flightplan);
   void updateFlightplanFromWidgets();
@@ -484,6 +552,8 @@ private:
   void dockVisibilityChanged(bool visible);
 
   void updateTableHeaders();
+
+  /* Set background and bold font for the active leg row. Resets only the previously highlighted row. */
   void highlightNextWaypoint(int activeLegIdx);
 
   /* Set colors for procedures and missing objects like waypoints and airways.
@@ -564,6 +634,15 @@ private:
   /* Network cache for flight plan calculation */
   atools::routing::RouteNetwork *routeNetworkRadio = nullptr, *routeNetworkAirway = nullptr;
 
+  /* Airway network loading in background */
+  QFuture<void> networkPreloadFuture;
+
+  /* Results of the last alternative calculation and its parameters */
+  QVector<RouteAlternative> routeAlternatives;
+  atools::geo::Pos routeAlternativesDeparture, routeAlternativesDestination;
+  int routeAlternativesFromIndex = -1, routeAlternativesToIndex = -1;
+  float routeAlternativesAltitudeFt = 0.f;
+
   /* Flightplan and route objects */
   Route route; /* real route containing all segments */
 
@@ -591,6 +670,10 @@ private:
   /* Takes care of the top label */
   RouteLabel *routeLabel = nullptr;
 
+  /* Last result of getFlightplanTableAsHtml() which is polled by the web server */
+  mutable QString flightplanHtmlCache;
+  mutable FlightplanHtmlCacheKey flightplanHtmlCacheKey;
+
   /* Route calculation dock window controller */
   RouteCalcDialog *routeCalcDialog = nullptr;
 
@@ -607,8 +690,12 @@ private:
 
   atools::gui::TabWidgetHandler *tabHandlerRoute = nullptr;
 
-  /* Timers for updating altitude delayer, clear selection while flying and moving active to top */
-  QTimer routeAltDelayTimer, tableCleanupTimer;
+  /* Timers for updating altitude delayer, clear selection while flying and moving active to top and
+   * collecting wind and performance changes */
+  QTimer routeAltDelayTimer, tableCleanupTimer, routeRecalcDelayTimer;
+
+  /* Set by aircraftPerformanceChanged() to emit routeChanged with geometry changed flag on next delayed recalculation */
+  bool routeRecalcGeometryChanged = false;
 
   /* Route table colum headings */
   QStringList routeColumns, routeColumnDescription;
@@ -33,6 +33,20 @@ struct RouteEntry
   int airwayId;
 };
 
+/* Parameters and result of one calculation for comparing alternative flight plans */
+struct RouteAlternative
+{
+  QString name;
+  atools::routing::RouteNetwork *network;
+  atools::routing::Modes mode;
+  float costFactorForceAirways;
+  bool fetchAirways;
+
+  QVector<RouteEntry> route;
+  float distanceMeter = 0.f, timeHours = map::INVALID_TIME_VALUE;
+  bool found = false;
+};
+
 /* Fetches the route points after calculation. Adds airway id to node and determines map object type. */
 class RouteExtractor
 {
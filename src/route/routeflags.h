@@ -111,4 +111,30 @@ Q_DECLARE_OPERATORS_FOR_FLAGS(rf::RouteAdjustOptions);
 
 }
 
+namespace ru {
+
+/* Derived data calculated by Route::updateAll(). Allows to skip parts which are not affected by an edit. */
+enum RouteUpdate
+{
+  UPDATE_NONE = 0,
+  INDEXES = 1 << 0, /* Indexes and procedure and alternate offsets. Needed after inserting, moving or removing legs. */
+  LEGS = 1 << 1, /* Remove duplicate legs and validate airways */
+  MAGVAR = 1 << 2, /* Magnetic variation of all legs */
+  DISTANCES = 1 << 3, /* Distances, courses, bounding rectangle and segments for active leg search */
+  NAMES = 1 << 4, /* User waypoint names and departure and destination in flight plan */
+  ILS = 1 << 5, /* Destination runway end and ILS. Skipped if destination and approach did not change. */
+
+  /* Flag combinations =========================================================================== */
+
+  /* Properties like position, name or comment of a leg changed but no leg was added or removed */
+  UPDATE_LEG_PROPERTIES = LEGS | MAGVAR | DISTANCES | NAMES | ILS,
+
+  UPDATE_ALL = INDEXES | LEGS | MAGVAR | DISTANCES | NAMES | ILS
+};
+
+Q_DECLARE_FLAGS(RouteUpdates, ru::RouteUpdate);
+Q_DECLARE_OPERATORS_FOR_FLAGS(ru::RouteUpdates);
+
+}
+
 #endif // LNM_ROUTEFLAGS_H
@@ -29,6 +29,7 @@
 #include "perf/aircraftperfcontroller.h"
 #include "query/airportquery.h"
 #include "query/mapquery.h"
+#include "query/querytypes.h"
 #include "route/route.h"
 #include "route/routealtitude.h"
 #include "route/routecontroller.h"
@@ -93,6 +94,8 @@ void RouteLabel::styleChanged()
 {
   // Need to clear the labels to force style update - otherwise link colors remain the same
   NavApp::getMainUi()->labelRouteInfo->clear();
+  headerCacheKey = 0;
+  errorsValid = false;
 
   // Update later in event queue to avoid obscure problem of disappearing labels
   QTimer::singleShot(0, this, &RouteLabel::updateAll);
@@ -116,6 +119,12 @@ void RouteLabel::updateHeaderLabel()
   // Hide label if no plan or nothing selected
   ui->labelRouteInfo->setVisible(visible);
 
+  // Build text only if route, units or header options changed since last call
+  quint64 key = visible ? headerKey() : 0;
+  if(key != 0 && key == headerCacheKey)
+    return;
+  headerCacheKey = key;
+
   if(visible)
   {
     autil::HtmlBuilder htmlAirports, htmlDistTime, htmlRunwayTakeoffDepart, htmlArrival, htmlRunwayLand;
@@ -145,6 +154,14 @@ void RouteLabel::updateHeaderLabel()
     ui->labelRouteInfo->clear();
 }
 
+quint64 RouteLabel::headerKey() const
+{
+  // Revisions use the upper bits and header flags the lower bits - zero is never returned
+  quint64 flags = (headerAirports ? 1 : 0) | (headerDistTime ? 2 : 0) | (headerRunwayTakeoff ? 4 : 0) |
+                  (headerDeparture ? 8 : 0) | (headerArrival ? 16 : 0) | (headerRunwayLand ? 32 : 0) | 64;
+  return (query::revisionKey({query::REV_ROUTE, query::REV_OPTIONS, query::REV_NAV_DB, query::REV_SIM_DB}) << 8) | flags;
+}
+
 void RouteLabel::buildHtmlText(atools::util::HtmlBuilder& html)
 {
   buildPrintText(html, false /* titleOnly */);
@@ -541,22 +558,37 @@ void RouteLabel::updateFooterErrorLabel()
 {
   QString toolTipText;
 
+  // Collect errors from all controllers =================================
+  QStringList routeErrors, profileErrors, perfErrors;
   if(footerError)
   {
-    // Collect errors from all controllers =================================
+    routeErrors = NavApp::getRouteController()->getErrorStrings();
+    profileErrors = NavApp::getAltitudeLegs().getErrorStrings();
+    perfErrors = NavApp::getAircraftPerfController()->getErrorStrings();
+  }
 
+  // Called by several controllers for each change - update label only if messages differ
+  if(errorsValid && routeErrors == lastRouteErrors && profileErrors == lastProfileErrors && perfErrors == lastPerfErrors)
+    return;
+
+  errorsValid = true;
+  lastRouteErrors = routeErrors;
+  lastProfileErrors = profileErrors;
+  lastPerfErrors = perfErrors;
+
+  if(footerError)
+  {
     // Flight plan ============
-    RouteController *routeController = NavApp::getRouteController();
-    buildErrorLabel(toolTipText, routeController->getErrorStrings(),
+    buildErrorLabel(toolTipText, routeErrors,
                     tr("<nobr><b>Problems on tab \"Flight Plan\":</b></nobr>", "Synchronize name with tab name"));
 
     // Elevation profile ============
-    buildErrorLabel(toolTipText, NavApp::getAltitudeLegs().getErrorStrings(),
+    buildErrorLabel(toolTipText, profileErrors,
                     tr("<nobr><b>Problems when calculating profile for window \"Flight Plan Elevation Profile\":</b></nobr>",
                        "Synchronize name with window name"));
 
     // Aircraft performance ============
-    buildErrorLabel(toolTipText, NavApp::getAircraftPerfController()->getErrorStrings(),
+    buildErrorLabel(toolTipText, perfErrors,
                     tr("<nobr><b>Problems on tab \"Fuel Report\":</b></nobr>", "Synchronize name with tab name"));
   }
 
@@ -19,6 +19,7 @@
 #define LNM_ROUTELABEL_H
 
 #include <QObject>
+#include <QStringList>
 
 class QString;
 class Route;
@@ -157,10 +158,20 @@ private:
   void buildHeaderDistTime(atools::util::HtmlBuilder& html, bool widget);
   void updateAll();
 
+  /* Key for cached header label. Changes with route, options and header flags. */
+  quint64 headerKey() const;
+
   bool headerAirports = true, headerDeparture = true, headerArrival = true, headerRunwayTakeoff = true, headerRunwayLand = true,
        headerDistTime = true, footerSelection = true, footerError = true;
 
   const Route& route;
+
+  /* Key of the currently shown header text. 0 if not valid. */
+  quint64 headerCacheKey = 0;
+
+  /* Error messages currently shown in the footer */
+  QStringList lastRouteErrors, lastProfileErrors, lastPerfErrors;
+  bool errorsValid = false;
 };
 
 #endif // LNM_ROUTELABEL_H
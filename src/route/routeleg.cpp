@@ -294,8 +294,7 @@ void RouteLeg::createFromDatabaseByEntry(int entryIndex, const RouteLeg *prevLeg
 
     // =============================== Navaid waypoint
     case atools::fs::pln::entry::WAYPOINT:
-      mapQuery->getMapObjectByIdent(result, map::WAYPOINT | map::AIRPORT,
-                                    flightplanEntry->getIdent(), region, /* region is ignored for airports */
+      mapQuery->getMapObjectByIdent(result, map::WAYPOINT, flightplanEntry->getIdent(), region,
                                     QString(), flightplanEntry->getPosition(), MAX_WAYPOINT_DISTANCE_METER);
 
       if(!result.hasWaypoints())
@@ -303,6 +302,11 @@ void RouteLeg::createFromDatabaseByEntry(int entryIndex, const RouteLeg *prevLeg
         mapQuery->getMapObjectByIdent(result, map::WAYPOINT, flightplanEntry->getIdent(), QString(),
                                       QString(), flightplanEntry->getPosition(), MAX_WAYPOINT_DISTANCE_METER);
 
+      if(!result.hasWaypoints())
+        // Look for airports only if no waypoint was found since the fuzzy airport search is expensive
+        mapQuery->getMapObjectByIdent(result, map::AIRPORT, flightplanEntry->getIdent(), QString(),
+                                      QString(), flightplanEntry->getPosition(), MAX_WAYPOINT_DISTANCE_METER);
+
       if(result.hasWaypoints())
       {
         assignIntersection(result, flightplanEntry);
@@ -39,6 +39,7 @@
 #include <QUrlQuery>
 #include <QXmlStreamReader>
 #include <QStringBuilder>
+#include <QtConcurrent/QtConcurrentRun>
 
 using atools::util::HttpDownloader;
 namespace apln = atools::fs::pln;
@@ -64,6 +65,7 @@ FetchRouteDialog::FetchRouteDialog(QWidget *parent) :
   connect(downloader, &HttpDownloader::downloadSslErrors, this, &FetchRouteDialog::downloadSslErrors);
   connect(ui->buttonBox, &QDialogButtonBox::clicked, this, &FetchRouteDialog::buttonBoxClicked);
   connect(ui->lineEditLogin, &QLineEdit::textChanged, this, &FetchRouteDialog::updateButtonStates);
+  connect(&ofpWatcher, &QFutureWatcher<Ofp>::finished, this, &FetchRouteDialog::ofpRead);
 
   // Change button texts and tooltips ============================================
   ui->buttonBox->button(QDialogButtonBox::Ok)->setText(tr("&Download Flight Plan"));
@@ -77,11 +79,19 @@ FetchRouteDialog::FetchRouteDialog(QWidget *parent) :
                                                                    "refinement or corrections."));
 
   restoreState();
+
+  // Prefetch latest OFP if login is known to have it ready when the user clicks create
+  if(!ui->lineEditLogin->text().isEmpty())
+    QTimer::singleShot(0, this, [this]() -> void {
+      startDownload();
+      updateButtonStates();
+    });
 }
 
 FetchRouteDialog::~FetchRouteDialog()
 {
   saveState();
+  ofpWatcher.waitForFinished();
   delete downloader;
   delete ui;
   delete flightplan;
@@ -128,7 +138,7 @@ void FetchRouteDialog::buttonBoxClicked(QAbstractButton *button)
 
 void FetchRouteDialog::updateButtonStates()
 {
-  if(downloader->isDownloading())
+  if(downloader->isDownloading() || ofpWatcher.isRunning())
   {
     ui->buttonBox->button(QDialogButtonBox::Ok)->setDisabled(true); // Download
     ui->buttonBox->button(QDialogButtonBox::Yes)->setDisabled(true); // Create plan
@@ -196,12 +206,22 @@ void FetchRouteDialog::downloadFinished(const QByteArray& data, QString)
 
   routeString.clear();
   flightplan->clearAll();
+  ui->textEditResult->setText(tr("Reading flight plan ..."));
+
+  // Decompress and read XML in background - calls ofpRead() when done
+  ofpWatcher.setFuture(QtConcurrent::run(&FetchRouteDialog::readOfp, data));
 
+  // Have to update states in event queue since isDownloading is still set while in this method
+  QTimer::singleShot(0, this, &FetchRouteDialog::updateButtonStates);
+}
+
+FetchRouteDialog::Ofp FetchRouteDialog::readOfp(const QByteArray& data)
+{
   // Read downloaded XML ==================================================================
   atools::util::XmlStream xmlStream(atools::zip::gzipDecompressIf(data, Q_FUNC_INFO));
   QXmlStreamReader& reader = xmlStream.getReader();
 
-  QString departure, departureRunway, destination, destinationRunway, alternate, route;
+  Ofp ofp;
   xmlStream.readUntilElement("OFP");
 
   // http://www.simbrief.com/ofp/flightplans/xml/1681767414_1A4303D4A7.xml
@@ -244,9 +264,9 @@ void FetchRouteDialog::downloadFinished(const QByteArray& data, QString)
       while(xmlStream.readNextStartElement())
       {
         if(reader.name() == "icao_code")
-          departure = reader.readElementText();
+          ofp.departure = reader.readElementText();
         else if(reader.name() == "plan_rwy")
-          departureRunway = reader.readElementText();
+          ofp.departureRunway = reader.readElementText();
         else
           xmlStream.skipCurrentElement(false /* warn */);
       }
@@ -256,9 +276,9 @@ void FetchRouteDialog::downloadFinished(const QByteArray& data, QString)
       while(xmlStream.readNextStartElement())
       {
         if(reader.name() == "icao_code")
-          destination = reader.readElementText();
+          ofp.destination = reader.readElementText();
         else if(reader.name() == "plan_rwy")
-          destinationRunway = reader.readElementText();
+          ofp.destinationRunway = reader.readElementText();
         else
           xmlStream.skipCurrentElement(false /* warn */);
       }
@@ -268,7 +288,7 @@ void FetchRouteDialog::downloadFinished(const QByteArray& data, QString)
       while(xmlStream.readNextStartElement())
       {
         if(reader.name() == "icao_code")
-          alternate = reader.readElementText();
+          ofp.alternate = reader.readElementText();
         else
           xmlStream.skipCurrentElement(false /* warn */);
       }
@@ -278,7 +298,7 @@ void FetchRouteDialog::downloadFinished(const QByteArray& data, QString)
       while(xmlStream.readNextStartElement())
       {
         if(reader.name() == "route")
-          route = reader.readElementText();
+          ofp.route = reader.readElementText();
         else
           xmlStream.skipCurrentElement(false /* warn */);
       }
@@ -287,13 +307,21 @@ void FetchRouteDialog::downloadFinished(const QByteArray& data, QString)
       xmlStream.skipCurrentElement(false /* warn */);
   }
 
+  return ofp;
+}
+
+void FetchRouteDialog::ofpRead()
+{
+  const Ofp ofp = ofpWatcher.result();
+  QString alternate = ofp.alternate;
+
   // Join plan elements to route string =============================
 
   // SimBrief sometimes reports a departure or arrival alternate - clear these
-  if(alternate == departure || alternate == destination)
+  if(alternate == ofp.departure || alternate == ofp.destination)
     alternate.clear();
 
-  routeString = departure % " " % route % " " % destination % " " % alternate;
+  routeString = ofp.departure % " " % ofp.route % " " % ofp.destination % " " % alternate;
 
   // Read string to flight plan
   RouteStringReader routeStringReader(NavApp::getRouteController()->getFlightplanEntryBuilder());
@@ -301,22 +329,22 @@ void FetchRouteDialog::downloadFinished(const QByteArray& data, QString)
 
   // Assign runways to procedures ====================================================
   QHash<QString, QString>& properties = flightplan->getProperties();
-  if(!departureRunway.isEmpty())
+  if(!ofp.departureRunway.isEmpty())
   {
     // Assign to SID - wrong runways will be replaced
     if(!properties.value(apln::SID).isEmpty())
-      properties.insert(apln::SID_RW, departureRunway);
+      properties.insert(apln::SID_RW, ofp.departureRunway);
     else
     {
       // Use as start parking - position will be calculated automatically when reading flight plan
-      flightplan->setDepartureParkingName(departureRunway);
+      flightplan->setDepartureParkingName(ofp.departureRunway);
       flightplan->setDepartureParkingType(apln::RUNWAY);
     }
   }
 
-  if(!destinationRunway.isEmpty())
+  if(!ofp.destinationRunway.isEmpty())
     // Assign to STAR - wrong runways will be replaced
-    properties.insert(apln::STAR_RW, destinationRunway);
+    properties.insert(apln::STAR_RW, ofp.destinationRunway);
 
   QString message(tr("<p>Flight successfully downloaded. Reading of route description %1.").arg(ok ? tr("successful") : tr("failed")));
 
@@ -333,16 +361,15 @@ void FetchRouteDialog::downloadFinished(const QByteArray& data, QString)
 
   ui->textEditResult->setText(message);
 
-  qDebug() << Q_FUNC_INFO << "departure" << departure << "departureRunway" << departureRunway
-           << "destination" << destination << "destinationRunway" << destinationRunway
-           << "alternate" << alternate << "route" << route;
+  qDebug() << Q_FUNC_INFO << "departure" << ofp.departure << "departureRunway" << ofp.departureRunway
+           << "destination" << ofp.destination << "destinationRunway" << ofp.destinationRunway
+           << "alternate" << alternate << "route" << ofp.route;
 
 #ifdef DEBUG_INFORMATION
   qDebug() << Q_FUNC_INFO << *flightplan;
 #endif
 
-  // Have to update states in event queue since isDownloading is still set while in this method
-  QTimer::singleShot(0, this, &FetchRouteDialog::updateButtonStates);
+  updateButtonStates();
 }
 
 void FetchRouteDialog::downloadFailed(const QString& error, int errorCode, QString downloadUrl)
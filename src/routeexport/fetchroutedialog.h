@@ -19,6 +19,7 @@
 #define LNM_FETCHROUTEDIALOG_H
 
 #include <QDialog>
+#include <QFutureWatcher>
 
 namespace atools {
 
@@ -41,6 +42,9 @@ class QAbstractButton;
 
 /*
  * Downloads a flight plan asynchronously from SimBriefs OFP.
+ * Download of the latest OFP starts when opening the dialog if a login is saved.
+ * The XML is read in a background thread. The route description is resolved in the GUI thread since
+ * it needs the database.
  *
  * Loads and saves state automatically.
  */
@@ -61,6 +65,18 @@ signals:
   void routeNewFromString(const QString& routeString);
 
 private:
+  /* Values read from OFP XML */
+  struct Ofp
+  {
+    QString departure, departureRunway, destination, destinationRunway, alternate, route;
+  };
+
+  /* Read values from downloaded and optionally compressed XML. Thread safe. */
+  static Ofp readOfp(const QByteArray& data);
+
+  /* Called when readOfp() is done. Creates route string and flight plan. */
+  void ofpRead();
+
   void restoreState();
   void saveState();
 
@@ -76,6 +92,9 @@ private:
 
   atools::util::HttpDownloader *downloader;
 
+  /* Reads OFP in background */
+  QFutureWatcher<Ofp> ofpWatcher;
+
   /* Plan is empty if parsing failed */
   atools::fs::pln::Flightplan *flightplan;
 
@@ -37,15 +37,19 @@
 #include "routeexport/routeexportdata.h"
 #include "routeexport/routemultiexportdialog.h"
 #include "routestring/routestringwriter.h"
+#include "settings/settings.h"
 #include "ui_mainwindow.h"
 
 #include <QBitArray>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QProcessEnvironment>
 #include <QXmlStreamReader>
 #include <QStringBuilder>
 
 using atools::fs::pln::FlightplanIO;
+using atools::settings::Settings;
 
 RouteExport::RouteExport(MainWindow *parent)
   : mainWindow(parent)
@@ -117,6 +121,8 @@ void RouteExport::formatExportedCallback(const RouteExportFormat& format, const
 void RouteExport::routeMultiExport()
 {
   exported.clear();
+  exportResults.clear();
+  exportJobs.clear();
 
   // Collect path errors first =======================
   // Check if selected paths exist
@@ -145,16 +151,49 @@ void RouteExport::routeMultiExport()
     if(routeValidate(exportFormatMap->getSelected(), true /* multi */))
     {
       // Export all button or menu item
-      int numExported = 0;
+      // Filenames, validation and flight plan adjustment are done in the GUI thread
+      // Writing is deferred to the thread pool in parallel mode
+      parallelExport = Settings::instance().getAndStoreValue(lnm::OPTIONS_MULTIEXPORT_PARALLEL, true).toBool();
+      QElapsedTimer totalTimer, timer;
+      totalTimer.start();
       for(const RouteExportFormat& fmt : exportFormatMap->getSelected())
       {
         if(fmt.isSelected() && fmt.isPathValid() && fmt.isPatternValid())
-          numExported += fmt.copyForMultiSave().callExport();
+        {
+          RouteExportFormat multiFormat = fmt.copyForMultiSave();
+          multiExportFormat = &multiFormat;
+
+          ExportResult result;
+          result.comment = multiFormat.getComment();
+          exportResults.append(result);
+
+          timer.start();
+          bool exportedFormat = multiFormat.callExport();
+          exportResults.last().exported = exportedFormat;
+          exportResults.last().prepareMs = timer.elapsed();
+          exportResults.last().filename = exported.value(multiFormat.getType());
+          multiExportFormat = nullptr;
+        }
       }
-      if(numExported == 0)
-        mainWindow->setStatusMessage(tr("No flight plan exported."));
-      else
-        mainWindow->setStatusMessage(tr("Exported %1 flight plans.").arg(numExported));
+
+      qDeleteAll(adjustedRouteCache);
+      adjustedRouteCache.clear();
+
+      // Write all files in parallel and wait for completion
+      runExportJobs();
+      parallelExport = false;
+
+      // Remove failed formats to avoid updating the LNMPLN file name
+      for(const ExportResult& result : qAsConst(exportResults))
+      {
+        if(!result.error.isEmpty())
+        {
+          for(auto it = exported.begin(); it != exported.end(); )
+            it = it.value() == result.filename ? exported.erase(it) : std::next(it);
+        }
+      }
+
+      showMultiExportSummary(totalTimer.elapsed());
     }
 
     // Check if native LNMPLN was exported, update filename and change status of the file if
@@ -326,20 +365,20 @@ bool RouteExport::routeExportInternalPln(const RouteExportFormat& format)
       switch(format.getType())
       {
         case rexp::PLNANNOTATED:
-          result = exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC, std::bind(&FlightplanIO::savePlnAnnotated, flightplanIO, _1, _2));
+          result = exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC, std::bind(&FlightplanIO::savePlnAnnotated, _1, _2, _3));
           break;
 
         case rexp::PLN:
-          result = exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC, std::bind(&FlightplanIO::savePln, flightplanIO, _1, _2));
+          result = exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC, std::bind(&FlightplanIO::savePln, _1, _2, _3));
           break;
 
         case rexp::PLNMSFS:
-          result = exportFlighplan(routeFile, rf::DEFAULT_OPTS_MSFS, std::bind(&FlightplanIO::savePlnMsfs, flightplanIO, _1, _2));
+          result = exportFlighplan(routeFile, rf::DEFAULT_OPTS_MSFS, std::bind(&FlightplanIO::savePlnMsfs, _1, _2, _3));
           break;
 
         case rexp::PLNISG:
           result = exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC | rf::ISG_USER_WP_NAMES | rf::REMOVE_RUNWAY_PROC,
-                                   std::bind(&FlightplanIO::savePlnIsg, flightplanIO, _1, _2));
+                                   std::bind(&FlightplanIO::savePlnIsg, _1, _2, _3));
           break;
 
         default:
@@ -369,7 +408,7 @@ bool RouteExport::routeExportFms3IniBuildsMulti(const RouteExportFormat& format)
     {
       using namespace std::placeholders;
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_FMS3 | rf::REMOVE_RUNWAY_PROC,
-                         std::bind(&FlightplanIO::saveIniBuildsMsfs, flightplanIO, _1, _2)))
+                         std::bind(&FlightplanIO::saveIniBuildsMsfs, _1, _2, _3)))
       {
         mainWindow->setStatusMessage(tr("Flight plan saved as FMS 3."));
         formatExportedCallback(format, routeFile);
@@ -390,7 +429,7 @@ bool RouteExport::routeExportFms3Multi(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_FMS3, std::bind(&FlightplanIO::saveFms3, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_FMS3, std::bind(&FlightplanIO::saveFms3, _1, _2, _3)))
       {
         mainWindow->setStatusMessage(tr("Flight plan saved as FMS 3."));
         formatExportedCallback(format, routeFile);
@@ -411,7 +450,7 @@ bool RouteExport::routeExportCivaFmsMulti(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_CIVA_FMS, std::bind(&FlightplanIO::saveCivaFms, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_CIVA_FMS, std::bind(&FlightplanIO::saveCivaFms, _1, _2, _3)))
       {
         mainWindow->setStatusMessage(tr("Flight plan saved for CIVA Navigation System."));
         formatExportedCallback(format, routeFile);
@@ -446,7 +485,7 @@ bool RouteExport::routeExportFms11(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_FMS11, std::bind(&FlightplanIO::saveFms11, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_FMS11, std::bind(&FlightplanIO::saveFms11, _1, _2, _3)))
       {
         mainWindow->setStatusMessage(tr("Flight plan saved as FMS 11."));
         formatExportedCallback(format, routeFile);
@@ -491,7 +530,7 @@ bool RouteExport::routeExportInternalFlp(const RouteExportFormat& format, bool c
           exportFunc = &FlightplanIO::saveCrjFlp;
       }
 
-      if(exportFlighplan(routeFile, options, std::bind(exportFunc, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, options, std::bind(exportFunc, _1, _2, _3)))
       {
         formatExportedCallback(format, routeFile);
         return true;
@@ -517,7 +556,7 @@ bool RouteExport::routeExportFlightgear(const RouteExportFormat& format)
     if(!routeFile.isEmpty())
     {
       using namespace std::placeholders;
-      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveFlightGear, flightplanIO, _1, _2)))
+      if(exportFlighplan(routeFile, rf::DEFAULT_OPTS, std::bind(&FlightplanIO::saveFlightGear, _1, _2, _3)))
       {
         formatExportedCallback(format, routeFile);
         return true;
@@ -671,7 +710,7 @@ bool RouteExport::routeExportRteMulti(const RouteExportFormat& format)
     {
       using namespace std::placeholders;
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC | rf::REMOVE_RUNWAY_PROC,
-                         std::bind(&FlightplanIO::saveRte, flightplanIO, _1, _2)))
+                         std::bind(&FlightplanIO::saveRte, _1, _2, _3)))
       {
         formatExportedCallback(format, routeFile);
         return true;
@@ -694,7 +733,7 @@ bool RouteExport::routeExportFprMulti(const RouteExportFormat& format)
     {
       using namespace std::placeholders;
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC | rf::REMOVE_RUNWAY_PROC,
-                         std::bind(&FlightplanIO::saveFpr, flightplanIO, _1, _2)))
+                         std::bind(&FlightplanIO::saveFpr, _1, _2, _3)))
       {
         formatExportedCallback(format, routeFile);
         return true;
@@ -758,7 +797,7 @@ bool RouteExport::routeExportFltplanMulti(const RouteExportFormat& format)
     {
       using namespace std::placeholders;
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC | rf::REMOVE_RUNWAY_PROC,
-                         std::bind(&FlightplanIO::saveFltplan, flightplanIO, _1, _2)))
+                         std::bind(&FlightplanIO::saveFltplan, _1, _2, _3)))
       {
         formatExportedCallback(format, routeFile);
         return true;
@@ -844,7 +883,7 @@ bool RouteExport::routeExportBbsMulti(const RouteExportFormat& format)
     {
       using namespace std::placeholders;
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC | rf::REMOVE_RUNWAY_PROC,
-                         std::bind(&FlightplanIO::saveBbsPln, flightplanIO, _1, _2)))
+                         std::bind(&FlightplanIO::saveBbsPln, _1, _2, _3)))
       {
         formatExportedCallback(format, routeFile);
         return true;
@@ -868,7 +907,7 @@ bool RouteExport::routeExportFeelthereFplMulti(const RouteExportFormat& format)
 
       using namespace std::placeholders;
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC | rf::REMOVE_RUNWAY_PROC,
-                         std::bind(&FlightplanIO::saveFeelthereFpl, flightplanIO, _1, _2, groundSpeed)))
+                         std::bind(&FlightplanIO::saveFeelthereFpl, _1, _2, _3, groundSpeed)))
       {
         formatExportedCallback(format, routeFile);
         return true;
@@ -888,7 +927,7 @@ bool RouteExport::routeExportLeveldRteMulti(const RouteExportFormat& format)
     {
       using namespace std::placeholders;
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC | rf::REMOVE_RUNWAY_PROC,
-                         std::bind(&FlightplanIO::saveLeveldRte, flightplanIO, _1, _2)))
+                         std::bind(&FlightplanIO::saveLeveldRte, _1, _2, _3)))
       {
         formatExportedCallback(format, routeFile);
         return true;
@@ -910,7 +949,7 @@ bool RouteExport::routeExportEfbrMulti(const RouteExportFormat& format)
       QString cycle = NavApp::getDatabaseAiracCycleNav();
       using namespace std::placeholders;
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC,
-                         std::bind(&FlightplanIO::saveEfbr, flightplanIO, _1, _2, route, cycle, QString(), QString())))
+                         std::bind(&FlightplanIO::saveEfbr, _1, _2, _3, route, cycle, QString(), QString())))
       {
         formatExportedCallback(format, routeFile);
         return true;
@@ -930,7 +969,7 @@ bool RouteExport::routeExportQwRteMulti(const RouteExportFormat& format)
     {
       using namespace std::placeholders;
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC | rf::REMOVE_RUNWAY_PROC,
-                         std::bind(&FlightplanIO::saveQwRte, flightplanIO, _1, _2)))
+                         std::bind(&FlightplanIO::saveQwRte, _1, _2, _3)))
       {
         formatExportedCallback(format, routeFile);
         return true;
@@ -950,7 +989,7 @@ bool RouteExport::routeExportMdrMulti(const RouteExportFormat& format)
     {
       using namespace std::placeholders;
       if(exportFlighplan(routeFile, rf::DEFAULT_OPTS_NO_PROC | rf::REMOVE_RUNWAY_PROC,
-                         std::bind(&FlightplanIO::saveMdr, flightplanIO, _1, _2)))
+                         std::bind(&FlightplanIO::saveMdr, _1, _2, _3)))
       {
         formatExportedCallback(format, routeFile);
         return true;
@@ -1475,20 +1514,7 @@ bool RouteExport::exportFlighplanAsGfp(const QString& filename, bool saveAsUserW
   QString gfp = RouteStringWriter().createGfpStringForRoute(
     buildAdjustedRoute(procedures ? rf::DEFAULT_OPTS_GFP : rf::DEFAULT_OPTS_GFP_NO_PROC),
     procedures, saveAsUserWaypoints, gfpCoordinates);
-
-  QFile file(filename);
-  if(file.open(QFile::WriteOnly | QIODevice::Text))
-  {
-    QByteArray utf8 = gfp.toUtf8();
-    file.write(utf8.constData(), utf8.size());
-    file.close();
-    return true;
-  }
-  else
-  {
-    atools::gui::ErrorHandler(mainWindow).handleIOError(file, tr("While saving GFP file:"));
-    return false;
-  }
+  return exportTextFile(filename, gfp.toUtf8(), tr("While saving GFP file:"));
 }
 
 bool RouteExport::exportFlighplanAsTxt(const QString& filename)
@@ -1496,20 +1522,7 @@ bool RouteExport::exportFlighplanAsTxt(const QString& filename)
   qDebug() << Q_FUNC_INFO << filename;
   QString txt = RouteStringWriter().createStringForRoute(buildAdjustedRoute(rf::DEFAULT_OPTS | rf::REMOVE_RUNWAY_PROC), 0.f,
                                                          rs::DCT | rs::START_AND_DEST | rs::SID_STAR_GENERIC);
-
-  QFile file(filename);
-  if(file.open(QFile::WriteOnly | QIODevice::Text))
-  {
-    QByteArray utf8 = txt.toUtf8();
-    file.write(utf8.constData(), utf8.size());
-    file.close();
-    return true;
-  }
-  else
-  {
-    atools::gui::ErrorHandler(mainWindow).handleIOError(file, tr("While saving TXT or FPL file:"));
-    return false;
-  }
+  return exportTextFile(filename, txt.toUtf8(), tr("While saving TXT or FPL file:"));
 }
 
 bool RouteExport::exportFlighplanAsUFmc(const QString& filename)
@@ -1586,20 +1599,7 @@ bool RouteExport::exportFlighplanAsRxpGtn(const QString& filename, bool saveAsUs
   qDebug() << Q_FUNC_INFO << filename;
   QString gfp = RouteStringWriter().createGfpStringForRoute(
     buildAdjustedRoute(rf::DEFAULT_OPTS_GFP), true /* procedures */, saveAsUserWaypoints, gfpCoordinates);
-
-  QFile file(filename);
-  if(file.open(QFile::WriteOnly | QIODevice::Text))
-  {
-    QByteArray utf8 = gfp.toUtf8();
-    file.write(utf8.constData(), utf8.size());
-    file.close();
-    return true;
-  }
-  else
-  {
-    atools::gui::ErrorHandler(mainWindow).handleIOError(file, tr("While saving GFP file:"));
-    return false;
-  }
+  return exportTextFile(filename, gfp.toUtf8(), tr("While saving GFP file:"));
 }
 
 bool RouteExport::exportFlighplanAsVfp(const RouteExportData& exportData, const QString& filename)
@@ -1814,13 +1814,138 @@ bool RouteExport::exportFlighplanAsIvap(const RouteExportData& exportData, const
   }
 }
 
+void RouteExport::runExportJobs()
+{
+  if(exportJobs.isEmpty())
+    return;
+
+  // Start all jobs in the global pool ========================
+  QVector<QFuture<QPair<QString, qint64> > > futures;
+  for(const ExportJob& job : qAsConst(exportJobs))
+  {
+    std::function<QString()> func = job.func;
+    futures.append(QtConcurrent::run([func]() -> QPair<QString, qint64> {
+      QElapsedTimer timer;
+      timer.start();
+      QString error = func();
+      return qMakePair(error, timer.elapsed());
+    }));
+  }
+
+  // Wait for all and collect errors and timings ========================
+  for(int i = 0; i < exportJobs.size(); i++)
+  {
+    futures[i].waitForFinished();
+    ExportResult& result = exportResults[exportJobs.at(i).resultIndex];
+    result.error = futures.at(i).result().first;
+    result.writeMs = futures.at(i).result().second;
+    if(!result.error.isEmpty())
+      result.exported = false;
+  }
+  exportJobs.clear();
+}
+
+void RouteExport::showMultiExportSummary(qint64 totalMs)
+{
+  int numExported = 0;
+  QStringList errors;
+  for(const ExportResult& result : qAsConst(exportResults))
+  {
+    qInfo().noquote() << Q_FUNC_INFO << result.comment << result.filename << "prepare" << result.prepareMs << "ms"
+                      << "write" << result.writeMs << "ms" << (result.exported ? "OK" : "FAILED") << result.error;
+
+    if(result.exported)
+      numExported++;
+    if(!result.error.isEmpty())
+      errors.append(tr("<b>%1</b>: %2").arg(result.comment.toHtmlEscaped()).arg(result.error.toHtmlEscaped()));
+  }
+  qInfo() << Q_FUNC_INFO << "Total" << totalMs << "ms" << "parallel" << parallelExport;
+
+  if(numExported == 0)
+    mainWindow->setStatusMessage(tr("No flight plan exported."));
+  else
+    mainWindow->setStatusMessage(tr("Exported %1 flight plans in %2 seconds.").arg(numExported).arg(totalMs / 1000., 0, 'f', 1));
+
+  // Errors from deferred writes - others are already reported by dialogs
+  if(!errors.isEmpty())
+  {
+    NavApp::closeSplashScreen();
+    QMessageBox::warning(mainWindow, QApplication::applicationName(),
+                         tr("<p>Errors while exporting flight plans:</p><ul><li>%1</li></ul>").arg(errors.join("</li><li>")));
+  }
+}
+
+bool RouteExport::isDeferredExport() const
+{
+  // Files which are appended to are written in order
+  return parallelExport && multiExportFormat != nullptr && !multiExportFormat->isAppendToFile();
+}
+
+bool RouteExport::exportTextFile(const QString& filename, const QByteArray& utf8, const QString& errorHeader)
+{
+  if(isDeferredExport())
+  {
+    // Defer to thread pool in multiexport ===============
+    exportJobs.append({exportResults.size() - 1, filename, [filename, utf8]() -> QString {
+        QFile file(filename);
+        if(file.open(QFile::WriteOnly | QIODevice::Text))
+        {
+          file.write(utf8.constData(), utf8.size());
+          file.close();
+          return QString();
+        }
+        else
+          return tr("Cannot write file \"%1\". Reason: %2").arg(filename).arg(file.errorString());
+      }});
+    return true;
+  }
+
+  QFile file(filename);
+  if(file.open(QFile::WriteOnly | QIODevice::Text))
+  {
+    file.write(utf8.constData(), utf8.size());
+    file.close();
+    return true;
+  }
+  else
+  {
+    atools::gui::ErrorHandler(mainWindow).handleIOError(file, errorHeader);
+    return false;
+  }
+}
+
 bool RouteExport::exportFlighplan(const QString& filename, rf::RouteAdjustOptions options,
-                                  std::function<void(const atools::fs::pln::Flightplan& plan,
+                                  std::function<void(atools::fs::pln::FlightplanIO& io,
+                                                     const atools::fs::pln::Flightplan& plan,
                                                      const QString& file)> exportFunc)
 {
+  if(isDeferredExport())
+  {
+    // Defer to thread pool in multiexport ===============
+    // Copy of plan - use own IO object per job
+    atools::fs::pln::Flightplan plan = buildAdjustedRoute(options).getFlightplanConst();
+    exportJobs.append({exportResults.size() - 1, filename, [plan, filename, exportFunc]() -> QString {
+        try
+        {
+          FlightplanIO io;
+          exportFunc(io, plan, filename);
+        }
+        catch(atools::Exception& e)
+        {
+          return QString(e.what());
+        }
+        catch(...)
+        {
+          return tr("Unknown error writing file \"%1\".").arg(filename);
+        }
+        return QString();
+      }});
+    return true;
+  }
+
   try
   {
-    exportFunc(buildAdjustedRoute(options).getFlightplanConst(), filename);
+    exportFunc(*flightplanIO, buildAdjustedRoute(options).getFlightplanConst(), filename);
   }
   catch(atools::Exception& e)
   {
@@ -2037,6 +2162,22 @@ QString RouteExport::buildDefaultFilename(const RouteExportFormat& format, bool
 
 Route RouteExport::buildAdjustedRoute(rf::RouteAdjustOptions options)
 {
+  // Reuse routes with same options during multiexport - global route and menu options cannot change in between
+  if(multiExportFormat != nullptr)
+  {
+    Route *cached = adjustedRouteCache.value(static_cast<int>(options), nullptr);
+    if(cached == nullptr)
+    {
+      // Disable cache for recursive call
+      const RouteExportFormat *format = multiExportFormat;
+      multiExportFormat = nullptr;
+      cached = new Route(buildAdjustedRoute(options));
+      adjustedRouteCache.insert(static_cast<int>(options), cached);
+      multiExportFormat = format;
+    }
+    return *cached;
+  }
+
   // Do not convert procedures for LNMPLN - no matter how it is saved
   if(!options.testFlag(rf::SAVE_LNMPLN))
   {
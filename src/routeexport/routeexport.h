@@ -23,6 +23,7 @@
 
 #include <QHash>
 #include <QObject>
+#include <QVector>
 #include <functional>
 
 namespace atools {
@@ -271,9 +272,25 @@ private:
   bool exportFlighplanAsRxpGns(const QString& filename, bool saveAsUserWaypoints);
   bool exportFlighplanAsRxpGtn(const QString& filename, bool saveAsUserWaypoints, bool gfpCoordinates);
 
-  /* Generic export using callback and also doing exception handling. */
+  /* Generic export using callback and also doing exception handling.
+   * Writing is deferred to a thread pool if called during a parallel multiexport. */
   bool exportFlighplan(const QString& filename, rf::RouteAdjustOptions options,
-                       std::function<void(const atools::fs::pln::Flightplan&, const QString&)> exportFunc);
+                       std::function<void(atools::fs::pln::FlightplanIO&, const atools::fs::pln::Flightplan&,
+                                          const QString&)> exportFunc);
+
+  /* Write UTF-8 text to file and show error dialog on failure.
+   * Writing is deferred to a thread pool if called during a parallel multiexport. */
+  bool exportTextFile(const QString& filename, const QByteArray& utf8, const QString& errorHeader);
+
+  /* true if file writing has to be deferred to the thread pool */
+  bool isDeferredExport() const;
+
+  /* Run all deferred write jobs in the global thread pool and wait for completion.
+   * Adds errors and timings to the results. */
+  void runExportJobs();
+
+  /* Show status message and one dialog with all errors of a multiexport */
+  void showMultiExportSummary(qint64 totalMs);
 
   /* Shows dialog for IVAP data before exporting */
   bool routeExportIvapInternal(re::RouteExportType type, const RouteExportFormat& format,
@@ -326,6 +343,34 @@ private:
   /* Filled by "formatExportedCallback" when doing a multi export using routeMultiExport() */
   QHash<int, QString> exported;
 
+  /* Result of one format in a multiexport */
+  struct ExportResult
+  {
+    QString comment, filename, error;
+    qint64 prepareMs = 0L, writeMs = 0L;
+    bool exported = false;
+  };
+
+  /* File write deferred to the thread pool. Function returns an error message or empty if successful. */
+  struct ExportJob
+  {
+    int resultIndex;
+    QString filename;
+    std::function<QString()> func;
+  };
+
+  /* Format currently exported by routeMultiExport() or null if not in multiexport */
+  const RouteExportFormat *multiExportFormat = nullptr;
+
+  /* Write files in a thread pool during multiexport */
+  bool parallelExport = false;
+
+  QVector<ExportResult> exportResults;
+  QVector<ExportJob> exportJobs;
+
+  /* Adjusted routes cached by options during multiexport since many formats use the same options */
+  QHash<int, Route *> adjustedRouteCache;
+
   /* true if any formats are selected for multiexport */
   bool selected = false;
 
@@ -0,0 +1,173 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "routestring/routestringbatch.h"
+
+#include "atools.h"
+#include "exception.h"
+#include "fs/pln/flightplan.h"
+#include "fs/pln/flightplanio.h"
+#include "routestring/routestringreader.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringBuilder>
+#include <QTextStream>
+
+RouteStringBatch::RouteStringBatch(FlightplanEntryBuilder *flightplanEntryBuilder)
+{
+  reader = new RouteStringReader(flightplanEntryBuilder);
+  reader->setPlaintextMessages(true);
+}
+
+RouteStringBatch::~RouteStringBatch()
+{
+  delete reader;
+}
+
+int RouteStringBatch::run(const QStringList& routeStrings, const QString& outputDir, rs::RouteStringOptions options)
+{
+  qDebug() << Q_FUNC_INFO << routeStrings.size() << outputDir;
+
+  results.clear();
+  numberWidth = std::max(4, static_cast<int>(QString::number(routeStrings.size()).size()));
+
+  if(!outputDir.isEmpty())
+    QDir().mkpath(outputDir);
+
+  atools::fs::pln::FlightplanIO flightplanIO;
+  QElapsedTimer timer;
+  int numSuccess = 0;
+
+  for(int i = 0; i < routeStrings.size(); i++)
+  {
+    rs::BatchResult result;
+    result.routeString = routeStrings.at(i);
+
+    // Read and resolve ========================================
+    atools::fs::pln::Flightplan flightplan;
+    timer.start();
+    result.success = reader->createRouteFromString(result.routeString, options, &flightplan);
+    qint64 readMs = timer.elapsed();
+    result.parseMs = reader->getParseTimeMs();
+    result.resolveMs = std::max(static_cast<qint64>(0), readMs - result.parseMs);
+    result.messages = reader->getAllMessages();
+    result.messages.removeAll(QString());
+    result.numEntries = flightplan.size();
+
+    // Save ===========================================
+    if(result.success && !outputDir.isEmpty())
+    {
+      result.filename = QDir(outputDir).absoluteFilePath(buildFilename(i + 1, flightplan.getDepartureIdent(),
+                                                                       flightplan.getDestinationIdent()));
+      timer.start();
+      try
+      {
+        // Will throw an exception if something goes wrong
+        flightplanIO.saveLnm(flightplan, result.filename);
+      }
+      catch(atools::Exception& e)
+      {
+        result.success = false;
+        result.messages.append(e.what());
+      }
+      result.writeMs = timer.elapsed();
+    }
+
+    if(result.success)
+      numSuccess++;
+
+    results.append(result);
+  }
+
+  qDebug() << Q_FUNC_INFO << "success" << numSuccess << "of" << routeStrings.size();
+  return numSuccess;
+}
+
+QString RouteStringBatch::getReport(bool benchmark) const
+{
+  QString report;
+  QTextStream stream(&report);
+
+  qint64 parseMs = 0L, resolveMs = 0L, writeMs = 0L;
+  int numSuccess = 0;
+  for(int i = 0; i < results.size(); i++)
+  {
+    const rs::BatchResult& result = results.at(i);
+    stream << QString("%1").arg(i + 1, numberWidth, 10, QChar('0')) << (result.success ? " OK    " : " ERROR ")
+           << result.routeString << endl;
+
+    if(!result.filename.isEmpty())
+      stream << "  " << tr("File: %1").arg(QDir::toNativeSeparators(result.filename)) << endl;
+
+    if(benchmark)
+      stream << "  " << tr("Entries: %1, parse: %2 ms, resolve: %3 ms, write: %4 ms").
+        arg(result.numEntries).arg(result.parseMs).arg(result.resolveMs).arg(result.writeMs) << endl;
+
+    for(const QString& message : result.messages)
+      stream << "  " << message << endl;
+
+    parseMs += result.parseMs;
+    resolveMs += result.resolveMs;
+    writeMs += result.writeMs;
+    if(result.success)
+      numSuccess++;
+  }
+
+  stream << tr("%1 of %2 route descriptions read successfully.").arg(numSuccess).arg(results.size()) << endl;
+
+  if(benchmark && !results.isEmpty())
+  {
+    qint64 totalMs = parseMs + resolveMs + writeMs;
+    stream << tr("Total: %1 ms, parse: %2 ms, resolve: %3 ms, write: %4 ms, average per plan: %5 ms").
+      arg(totalMs).arg(parseMs).arg(resolveMs).arg(writeMs).
+      arg(static_cast<double>(totalMs) / results.size(), 0, 'f', 1) << endl;
+  }
+
+  stream.flush();
+  return report;
+}
+
+QStringList RouteStringBatch::readRouteStrings(const QString& filename)
+{
+  QStringList routeStrings;
+  QFile file(filename);
+  if(file.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    while(!stream.atEnd())
+    {
+      QString line = stream.readLine().simplified();
+      if(!line.isEmpty() && !line.startsWith('#'))
+        routeStrings.append(line);
+    }
+    file.close();
+  }
+  else
+    throw atools::Exception(tr("Cannot open file \"%1\". Reason: %2").arg(filename).arg(file.errorString()));
+
+  return routeStrings;
+}
+
+QString RouteStringBatch::buildFilename(int index, const QString& departure, const QString& destination) const
+{
+  return QString("%1").arg(index, numberWidth, 10, QChar('0')) % "_" %
+         atools::cleanFilename(departure) % "_" % atools::cleanFilename(destination) % ".lnmpln";
+}
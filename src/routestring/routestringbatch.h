@@ -0,0 +1,87 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_ROUTESTRINGBATCH_H
+#define LNM_ROUTESTRINGBATCH_H
+
+#include "routestring/routestringtypes.h"
+
+#include <QCoreApplication>
+#include <QVector>
+
+class RouteStringReader;
+class FlightplanEntryBuilder;
+
+namespace rs {
+
+/* Result for one route description of a batch run */
+struct BatchResult
+{
+  QString routeString, filename;
+  QStringList messages;
+  bool success = false;
+  int numEntries = 0;
+  qint64 parseMs = 0L, resolveMs = 0L, writeMs = 0L;
+};
+
+}
+
+/*
+ * Converts a list of route descriptions into LNMPLN files without involving the flight plan table or any dialogs.
+ * Used by the command line option "route-batch" and the web API action "route/batch".
+ *
+ * All descriptions are read with one reader to allow reuse of cached ident lookups.
+ * Has to be used in the main thread since the reader uses the GUI queries.
+ */
+class RouteStringBatch
+{
+  Q_DECLARE_TR_FUNCTIONS(RouteStringBatch)
+
+public:
+  RouteStringBatch(FlightplanEntryBuilder *flightplanEntryBuilder);
+  ~RouteStringBatch();
+
+  RouteStringBatch(const RouteStringBatch& other) = delete;
+  RouteStringBatch& operator=(const RouteStringBatch& other) = delete;
+
+  /* Read and convert all descriptions and save them as LNMPLN to outputDir. Nothing is saved if outputDir is empty
+   * which is useful to collect timings only. Returns number of successfully read plans. */
+  int run(const QStringList& routeStrings, const QString& outputDir, rs::RouteStringOptions options = rs::SIMBRIEF_READ_DEFAULTS);
+
+  /* Results of the last run in order of the given descriptions */
+  const QVector<rs::BatchResult>& getResults() const
+  {
+    return results;
+  }
+
+  /* Plain text report of the last run with timings per plan and totals. Timings are omitted if benchmark is false. */
+  QString getReport(bool benchmark) const;
+
+  /* Read descriptions from a text file. One description per line. Empty lines and lines starting with "#" are ignored.
+   * Throws atools::Exception if the file cannot be read. */
+  static QStringList readRouteStrings(const QString& filename);
+
+private:
+  /* Filename like "0001_EDDF_LIRF.lnmpln" */
+  QString buildFilename(int index, const QString& departure, const QString& destination) const;
+
+  RouteStringReader *reader;
+  QVector<rs::BatchResult> results;
+  int numberWidth = 4;
+};
+
+#endif // LNM_ROUTESTRINGBATCH_H
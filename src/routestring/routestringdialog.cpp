@@ -516,6 +516,11 @@ rs::RouteStringOptions RouteStringDialog::getOptionsFromSettings()
   return rs::RouteStringOptions(atools::settings::Settings::instance().valueInt(lnm::ROUTE_STRING_DIALOG_OPTIONS, rs::DEFAULT_OPTIONS));
 }
 
+void RouteStringDialog::clearCache()
+{
+  routeStringReader->clearCache();
+}
+
 void RouteStringDialog::textChanged()
 {
   if(immediateUpdate)
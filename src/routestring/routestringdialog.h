@@ -77,6 +77,9 @@ public:
   /* Update buttons depending on route state */
   void updateButtonState();
 
+  /* Clear cached navaid lookups of the reader. Called on database switch and track changes. */
+  void clearCache();
+
   /* > 0 if speed was included in the string */
   float getSpeedKts() const
   {
@@ -162,7 +162,15 @@ bool RouteStringReader::createRouteFromString(const QString& routeString, rs::Ro
   QElapsedTimer timer;
   timer.start();
 
-  airwayQuery->setUseTracks(!(options & rs::NO_TRACKS));
+  bool useTracks = !(options & rs::NO_TRACKS);
+  if(useTracks != cacheUseTracks)
+  {
+    // Airway results differ depending on tracks
+    clearCache();
+    cacheUseTracks = useTracks;
+  }
+
+  airwayQuery->setUseTracks(useTracks);
   waypointQuery->setUseTracks(false);
 
   logMessages.clear();
@@ -188,6 +196,7 @@ bool RouteStringReader::createRouteFromString(const QString& routeString, rs::Ro
   // Also extracts speed, altitude, SID and STAR - Keeps airport runway and approach information intact
   float altitudeFt, speedKts;
   QStringList cleanItems = cleanItemList(items, speedKts, altitudeFt);
+  parseTimeMs = timer.elapsed();
 
   if(speedKtsParam != nullptr)
     *speedKtsParam = speedKts;
@@ -211,6 +220,9 @@ bool RouteStringReader::createRouteFromString(const QString& routeString, rs::Ro
   bool readNoAirports = options & rs::READ_NO_AIRPORTS;
   Pos lastPos;
 
+  // Load all VOR and NDB for the items at once - most items are navaids or airways which simply give no result
+  FlightplanEntryBatch batch(*entryBuilder, cleanItems);
+
 #ifdef DEBUG_INFORMATION
   qDebug() << Q_FUNC_INFO << "after prepare" << timer.restart();
 #endif
@@ -838,8 +850,22 @@ void RouteStringReader::extractAirportIdentDestination(QString item, QString& ai
     appendWarning(tr("Ignoring time specification \"%1\" for destination airport %2.").arg(time).arg(item));
 }
 
+void RouteStringReader::clearCache()
+{
+  waypointCache.clear();
+  airportCache.clear();
+  airwayWaypointCache.clear();
+}
+
 void RouteStringReader::airportSim(map::MapAirport& airport, const QString& ident)
 {
+  auto it = airportCache.constFind(ident);
+  if(it != airportCache.constEnd())
+  {
+    airport = it.value();
+    return;
+  }
+
   airport = map::MapAirport();
   airportQuerySim->getAirportByIdent(airport, ident);
   if(!airport.isValid())
@@ -850,6 +876,19 @@ void RouteStringReader::airportSim(map::MapAirport& airport, const QString& iden
     if(!airports.isEmpty())
       airport = airports.constFirst();
   }
+  airportCache.insert(ident, airport);
+}
+
+void RouteStringReader::airwayWaypointList(QList<map::MapAirwayWaypoint>& allAirwayWaypoints, const QString& airwayName)
+{
+  auto it = airwayWaypointCache.constFind(airwayName);
+  if(it != airwayWaypointCache.constEnd())
+    allAirwayWaypoints = it.value();
+  else
+  {
+    airwayQuery->getWaypointListForAirwayName(allAirwayWaypoints, airwayName);
+    airwayWaypointCache.insert(airwayName, allAirwayWaypoints);
+  }
 }
 
 QString RouteStringReader::sidStarAbbrev(QString sid)
@@ -1638,7 +1677,7 @@ void RouteStringReader::filterAirways(QList<ParseEntry>& resultList, int i)
       QList<map::MapAirwayWaypoint> allAirwayWaypoints;
 
       // Get all waypoints for the airway sorted by fragment and sequence
-      airwayQuery->getWaypointListForAirwayName(allAirwayWaypoints, airwayName);
+      airwayWaypointList(allAirwayWaypoints, airwayName);
 
 #ifdef DEBUG_INFORMATION
       for(const map::MapAirwayWaypoint& w : qAsConst(allAirwayWaypoints))
@@ -1718,6 +1757,15 @@ void RouteStringReader::filterAirways(QList<ParseEntry>& resultList, int i)
 
 void RouteStringReader::findWaypoints(MapResult& result, const QString& item, bool matchWaypoints)
 {
+  // Same token resolves to the same candidates as long as database and tracks are unchanged
+  QString key = item % (matchWaypoints ? QStringLiteral("|M") : QStringLiteral("|N"));
+  auto it = waypointCache.constFind(key);
+  if(it != waypointCache.constEnd())
+  {
+    result = it.value();
+    return;
+  }
+
   bool searchCoords = false;
   if(item.length() > 5)
     // User coordinates for sure
@@ -1762,6 +1810,8 @@ void RouteStringReader::findWaypoints(MapResult& result, const QString& item, bo
       }
     }
   }
+
+  waypointCache.insert(key, result);
 }
 
 QStringList RouteStringReader::cleanItemList(const QStringList& items, float& speedKnots, float& altFeet)
@@ -23,6 +23,7 @@
 
 #include <QStringList>
 #include <QCoreApplication>
+#include <QHash>
 
 namespace atools {
 
@@ -103,6 +104,17 @@ public:
   /* Get messages in order of error, warning and info messages separated by an empty line */
   const QStringList getAllMessages() const;
 
+  /* Milliseconds used for tokenizing and cleaning the last route string in createRouteFromString().
+   * The rest of the call is spent resolving idents, airways and procedures. */
+  qint64 getParseTimeMs() const
+  {
+    return parseTimeMs;
+  }
+
+  /* Drop all cached ident, airport and airway lookups. Has to be called if database or tracks change
+   * for long living instances. */
+  void clearCache();
+
 private:
   /* Internal parsing structure which holds all found potential candidates from a search */
   struct ParseEntry;
@@ -195,6 +207,9 @@ private:
   /* First try exact match and then all possible idents. */
   void airportSim(map::MapAirport& airport, const QString& ident);
 
+  /* Get all waypoints for the airway sorted by fragment and sequence. Uses cache. */
+  void airwayWaypointList(QList<map::MapAirwayWaypoint>& allAirwayWaypoints, const QString& airwayName);
+
   MapQuery *mapQuery = nullptr;
   AirwayTrackQuery *airwayQuery = nullptr;
   WaypointTrackQuery *waypointQuery = nullptr;
@@ -203,6 +218,14 @@ private:
   FlightplanEntryBuilder *entryBuilder = nullptr;
   QStringList errorMessages, warningMessages, logMessages;
   bool plaintextMessages = false;
+
+  /* Lookup results by ident which are kept between calls of createRouteFromString() to avoid resolving
+   * unchanged tokens again on each edit. Cleared if track usage changes or by calling clearCache(). */
+  QHash<QString, map::MapResult> waypointCache;
+  QHash<QString, map::MapAirport> airportCache;
+  QHash<QString, QList<map::MapAirwayWaypoint> > airwayWaypointCache;
+  bool cacheUseTracks = false;
+  qint64 parseTimeMs = 0L;
 };
 
 #endif // LITTLENAVMAP_ROUTESTRINGREADER_H
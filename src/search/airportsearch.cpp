@@ -284,6 +284,14 @@ AirportSearch::AirportSearch(QMainWindow *parent, QTableView *tableView, si::Tab
                 {"ident", "icao", "iata", "faa", "local"},
                 true /* allowOverride */, false /* allowExclude */)}));
 
+  // Substring searches in text fields use an FTS5 index if available
+  columns->setFullTextColumns({"ident", "icao", "iata", "faa", "local", "name", "city", "state", "country"});
+  columns->setSpatialIndex(true);
+
+  // Combined checkbox filters are evaluated on a bitmask index
+  columns->setFeatureIndexColumns({"has_avgas", "has_jetfuel", "tower_frequency", "is_closed", "is_military", "is_addon",
+                                   "num_runway_light", "num_runway_end_ils", "num_approach"});
+
   SearchBaseTable::initViewAndController(NavApp::getDatabaseSim());
 
   // Add model data handler and model format handler as callbacks
@@ -719,9 +727,6 @@ void AirportSearch::randomFlightplanClicked()
 
   qDebug() << Q_FUNC_INFO << "random flight, count source airports: " << countResult;
 
-  // above this limit do not try to find a random value beacuse this will only have few "space" to "pick" from many already picked
-  const int randomLimit = countResult / 10 * 7;
-
   // maximum equals seconds to 100% (per attempted departure)
   progress = new QProgressDialog(tr("random picking and criteria comparison running..."),
                                  tr("Abort running"), 0, 30, NavApp::getQMainWidget());
@@ -736,7 +741,7 @@ void AirportSearch::randomFlightplanClicked()
   // Disable button to avoid multiple clicks
   ui->pushButtonAirportFlightplanSearch->setDisabled(true);
 
-  RandomDepartureAirportPickingByCriteria::initStatics(countResult, randomLimit, result,
+  RandomDepartureAirportPickingByCriteria::initStatics(countResult, result,
                                                        atools::roundToInt(distanceMinMeter),
                                                        atools::roundToInt(distanceMaxMeter));
   RandomDepartureAirportPickingByCriteria *departurePicker = new RandomDepartureAirportPickingByCriteria(this);
@@ -126,8 +126,55 @@ public:
     return queryBuilder;
   }
 
+  /* Text columns which are searched using a full text index. Only for tables not modified while searching. */
+  void setFullTextColumns(const QStringList& value)
+  {
+    fullTextColumns = value;
+  }
+
+  const QStringList& getFullTextColumns() const
+  {
+    return fullTextColumns;
+  }
+
+  /* Checkbox columns which are packed into a bitmask index for combined filters.
+   * Only for tables not modified while searching. */
+  void setFeatureIndexColumns(const QStringList& value)
+  {
+    featureIndexColumns = value;
+  }
+
+  const QStringList& getFeatureIndexColumns() const
+  {
+    return featureIndexColumns;
+  }
+
+  /* Use an R*Tree index on lonx and laty for distance searches. Only for tables not modified while searching. */
+  void setSpatialIndex(bool value)
+  {
+    spatialIndex = value;
+  }
+
+  bool isSpatialIndex() const
+  {
+    return spatialIndex;
+  }
+
+  /* Keep only a window of result pages in memory instead of all fetched rows. Not used for distance search. */
+  void setPagedModel(bool value)
+  {
+    pagedModel = value;
+  }
+
+  bool isPagedModel() const
+  {
+    return pagedModel;
+  }
+
 private:
   QueryBuilder queryBuilder;
+  QStringList fullTextColumns, featureIndexColumns;
+  bool spatialIndex = false, pagedModel = false;
 
   QSpinBox *minDistanceWidget = nullptr, *maxDistanceWidget = nullptr;
   QString minDistanceWidgetSuffix, maxDistanceWidgetSuffix;
@@ -0,0 +1,184 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "search/featureindex.h"
+
+#include "exception.h"
+#include "search/column.h"
+#include "search/columnlist.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlrecord.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QStringBuilder>
+
+using atools::sql::SqlQuery;
+
+/* Two bits per column and sign bit of the SQLite integer not used */
+const static int MAX_COLUMNS = 31;
+
+FeatureIndex::FeatureIndex(atools::sql::SqlDatabase *sqlDb, const ColumnList *columnList, const QStringList& columnsParam)
+  : db(sqlDb), columns(columnList), featureTable("lnm_feature_" + columnList->getTablename())
+{
+  for(const QString& name : columnsParam)
+  {
+    const Column *col = columns->getColumn(name);
+    if(col != nullptr && col->getCheckBoxWidget() != nullptr && featureColumns.size() < MAX_COLUMNS)
+      featureColumns.append(col);
+    else
+      qWarning() << Q_FUNC_INFO << "Column not usable for feature index" << name;
+  }
+}
+
+FeatureIndex::~FeatureIndex()
+{
+  clear();
+}
+
+void FeatureIndex::clear()
+{
+  if(created && db->isOpen())
+  {
+    try
+    {
+      SqlQuery(db).exec("drop table if exists temp." % featureTable);
+    }
+    catch(atools::Exception& e)
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot drop" << featureTable << e.what();
+    }
+    catch(...)
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot drop" << featureTable;
+    }
+  }
+
+  created = failed = false;
+}
+
+QString FeatureIndex::checkedCondition(const Column *col) const
+{
+  if(col->hasIncludeExcludeCond())
+    return col->getColumnName() % ' ' % col->getIncludeCondition();
+  else
+    return col->getColumnName() % " = 1";
+}
+
+QString FeatureIndex::uncheckedCondition(const Column *col) const
+{
+  if(col->hasIncludeExcludeCond())
+    return col->getColumnName() % ' ' % col->getExcludeCondition();
+  else
+    return col->getColumnName() % " = 0";
+}
+
+int FeatureIndex::bit(const Column *col, const QString& oper, const QVariant& value) const
+{
+  int index = featureColumns.indexOf(col);
+  if(index == -1)
+    return -1;
+
+  if(col->hasIncludeExcludeCond())
+  {
+    // Condition is set by SqlModel::filter() for the checkbox state
+    if(oper == col->getIncludeCondition())
+      return index * 2;
+    else if(oper == col->getExcludeCondition())
+      return index * 2 + 1;
+  }
+  else if(oper == "=" && !value.isNull())
+  {
+    int intValue = value.toInt();
+    if(intValue == 1)
+      return index * 2;
+    else if(intValue == 0)
+      return index * 2 + 1;
+  }
+  return -1;
+}
+
+bool FeatureIndex::create()
+{
+  if(created)
+    return true;
+
+  if(failed || !db->isOpen() || featureColumns.isEmpty())
+    return false;
+
+  try
+  {
+    QElapsedTimer timer;
+    timer.start();
+
+    // Columns not existing in older databases never match
+    atools::sql::SqlRecord record = db->record(columns->getTablename());
+    if(!record.contains(columns->getIdColumnName()))
+    {
+      failed = true;
+      return false;
+    }
+
+    QStringList bits;
+    for(int i = 0; i < featureColumns.size(); i++)
+    {
+      const Column *col = featureColumns.at(i);
+      if(record.contains(col->getColumnName()))
+      {
+        bits.append(QString("(case when %1 then %2 else 0 end)").arg(checkedCondition(col)).arg(1LL << (i * 2)));
+        bits.append(QString("(case when %1 then %2 else 0 end)").arg(uncheckedCondition(col)).arg(1LL << (i * 2 + 1)));
+      }
+    }
+
+    if(bits.isEmpty())
+    {
+      failed = true;
+      return false;
+    }
+
+    SqlQuery query(db);
+    query.exec("drop table if exists temp." % featureTable);
+    query.exec("create table temp." % featureTable % "(id integer primary key, features integer not null)");
+    query.exec("insert into temp." % featureTable % "(id, features) select " % columns->getIdColumnName() % ", " %
+               bits.join(" + ") % " from " % columns->getTablename());
+    created = true;
+
+    qDebug() << Q_FUNC_INFO << "Created" << featureTable << "in" << timer.elapsed() << "ms";
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot create" << featureTable << e.what();
+    failed = true;
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot create" << featureTable;
+    failed = true;
+  }
+
+  return created;
+}
+
+QString FeatureIndex::condition(quint64 mask)
+{
+  if(mask == 0 || !create())
+    return QString();
+
+  return columns->getIdColumnName() % " in (select id from temp." % featureTable % " where features & " %
+         QString::number(mask) % " = " % QString::number(mask) % ')';
+}
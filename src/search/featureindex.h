@@ -0,0 +1,78 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_FEATUREINDEX_H
+#define LNM_FEATUREINDEX_H
+
+#include <QStringList>
+#include <QVector>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+class Column;
+class ColumnList;
+
+/*
+ * Packs the checkbox conditions of a table into one integer per row which is kept in a table in the
+ * temporary schema of the connection. Two bits are used per column: one for the checked and one for the
+ * unchecked state of the checkbox. A combination of checkbox filters is then evaluated by a single
+ * bitwise scan over the small table instead of the full table. Row ids of the index are the ids of the table.
+ *
+ * The index is created on first use which also works for read only databases.
+ * Only suitable for tables which are not modified while the index exists.
+ */
+class FeatureIndex
+{
+public:
+  /* Columns have to use a checkbox widget. Either plain 0/1 values or include and exclude conditions. */
+  FeatureIndex(atools::sql::SqlDatabase *sqlDb, const ColumnList *columnList, const QStringList& columnsParam);
+  ~FeatureIndex();
+
+  FeatureIndex(const FeatureIndex& other) = delete;
+  FeatureIndex& operator=(const FeatureIndex& other) = delete;
+
+  /* Drop index. Needed before the database is closed or changed. Index is created again on next use. */
+  void clear();
+
+  /* Get the bit for a where condition of a checkbox column or -1 if not covered by the index */
+  int bit(const Column *col, const QString& oper, const QVariant& value) const;
+
+  /* Build condition like "airport_id in (select rowid from temp.lnm_feature_airport where features & 5 = 5)".
+   * @param mask bits built from bit() which all have to be set
+   * @return empty string if index creation failed */
+  QString condition(quint64 mask);
+
+private:
+  /* Create index if not done yet */
+  bool create();
+
+  /* SQL conditions for checked and unchecked state of a column */
+  QString checkedCondition(const Column *col) const;
+  QString uncheckedCondition(const Column *col) const;
+
+  atools::sql::SqlDatabase *db;
+  const ColumnList *columns;
+  QString featureTable;
+  QVector<const Column *> featureColumns;
+  bool created = false, failed = false;
+};
+
+#endif // LNM_FEATUREINDEX_H
@@ -0,0 +1,149 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+#include "search/fulltextindex.h"
+
+#include "exception.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlrecord.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QStringBuilder>
+
+using atools::sql::SqlQuery;
+
+/* Trigram index cannot be used for shorter texts */
+const static int MIN_PATTERN_LENGTH = 3;
+
+FullTextIndex::FullTextIndex(atools::sql::SqlDatabase *sqlDb, const QString& tableParam, const QString& idColumnParam,
+                             const QStringList& columnsParam)
+  : db(sqlDb), table(tableParam), idColumn(idColumnParam), ftsTable("lnm_fts_" + tableParam), columns(columnsParam)
+{
+}
+
+FullTextIndex::~FullTextIndex()
+{
+  clear();
+}
+
+void FullTextIndex::clear()
+{
+  if(created && db->isOpen())
+  {
+    try
+    {
+      SqlQuery(db).exec("drop table if exists temp." % ftsTable);
+    }
+    catch(atools::Exception& e)
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot drop" << ftsTable << e.what();
+    }
+    catch(...)
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot drop" << ftsTable;
+    }
+  }
+
+  created = failed = false;
+  indexedColumns.clear();
+}
+
+bool FullTextIndex::create()
+{
+  if(created)
+    return true;
+
+  if(failed || !db->isOpen())
+    return false;
+
+  try
+  {
+    QElapsedTimer timer;
+    timer.start();
+
+    // Skip columns not existing in older databases
+    atools::sql::SqlRecord record = db->record(table);
+    indexedColumns.clear();
+    for(const QString& column : qAsConst(columns))
+    {
+      if(record.contains(column))
+        indexedColumns.append(column);
+    }
+
+    if(indexedColumns.isEmpty() || !record.contains(idColumn))
+    {
+      failed = true;
+      return false;
+    }
+
+    QString cols = indexedColumns.join(", ");
+    SqlQuery query(db);
+    query.exec("drop table if exists temp." % ftsTable);
+    query.exec("create virtual table temp." % ftsTable % " using fts5(" % cols % ", tokenize = 'trigram')");
+    query.exec("insert into temp." % ftsTable % "(rowid, " % cols % ") select " % idColumn % ", " % cols % " from " % table);
+    created = true;
+
+    qDebug() << Q_FUNC_INFO << "Created" << ftsTable << "in" << timer.elapsed() << "ms";
+  }
+  catch(atools::Exception& e)
+  {
+    // FTS5 or trigram tokenizer not available in SQLite - use like queries
+    qWarning() << Q_FUNC_INFO << "Cannot create" << ftsTable << e.what();
+    failed = true;
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot create" << ftsTable;
+    failed = true;
+  }
+
+  return created;
+}
+
+QString FullTextIndex::condition(const QStringList& columnList, const QString& pattern)
+{
+  if(!isPatternIndexable(pattern) || !create())
+    return QString();
+
+  QStringList selects;
+  for(const QString& column : columnList)
+  {
+    if(!columns.contains(column))
+      // Not covered by index - results would be incomplete
+      return QString();
+
+    // Skip columns not existing in table
+    if(indexedColumns.contains(column))
+      selects.append("select rowid from temp." % ftsTable % " where " % column % " like '" % pattern % '\'');
+  }
+
+  if(selects.isEmpty())
+    return QString();
+
+  return idColumn % " in (" % selects.join(" union ") % ')';
+}
+
+bool FullTextIndex::isPatternIndexable(const QString& pattern)
+{
+  if(pattern.size() < MIN_PATTERN_LENGTH + 2 || !pattern.startsWith('%') || !pattern.endsWith('%'))
+    return false;
+
+  // No other placeholders allowed
+  QString text = pattern.mid(1, pattern.size() - 2);
+  return !text.contains('%') && !text.contains('_');
+}
@@ -0,0 +1,77 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+#ifndef LNM_FULLTEXTINDEX_H
+#define LNM_FULLTEXTINDEX_H
+
+#include <QStringList>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+/*
+ * SQLite FTS5 index using the trigram tokenizer for substring searches in text columns of a table.
+ * The index is created in the temporary schema of the connection on first use which also works for
+ * read only databases. Row ids of the index are the ids of the table.
+ *
+ * An index can only be used for patterns like "%text%" with at least three characters and no other
+ * placeholders. Callers have to fall back to plain "like" conditions if an empty condition is returned.
+ *
+ * Only suitable for tables which are not modified while the index exists.
+ */
+class FullTextIndex
+{
+public:
+  FullTextIndex(atools::sql::SqlDatabase *sqlDb, const QString& tableParam, const QString& idColumnParam,
+                const QStringList& columnsParam);
+  ~FullTextIndex();
+
+  FullTextIndex(const FullTextIndex& other) = delete;
+  FullTextIndex& operator=(const FullTextIndex& other) = delete;
+
+  /* Drop index. Needed before the database is closed or changed. Index is created again on next use. */
+  void clear();
+
+  /* true if column is covered by the index */
+  bool hasColumn(const QString& column) const
+  {
+    return columns.contains(column);
+  }
+
+  /* Build condition like "airport_id in (select rowid from temp.lnm_fts_airport where name like '%abc%')".
+   * Conditions for more than one column are combined with "or". All columns have to be covered by the index.
+   * @param columnList columns to search in
+   * @param pattern SQL like pattern which has to be escaped already
+   * @return empty string if the index cannot be used for pattern or columns or if index creation failed */
+  QString condition(const QStringList& columnList, const QString& pattern);
+
+  /* true if the pattern can use the trigram index */
+  static bool isPatternIndexable(const QString& pattern);
+
+private:
+  /* Create index if not done yet. Returns false if FTS5 with trigram tokenizer is not available. */
+  bool create();
+
+  atools::sql::SqlDatabase *db;
+  QString table, idColumn, ftsTable;
+  QStringList columns, indexedColumns;
+  bool created = false, failed = false;
+};
+
+#endif // LNM_FULLTEXTINDEX_H
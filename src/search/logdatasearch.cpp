@@ -117,6 +117,9 @@ LogdataSearch::LogdataSearch(QMainWindow *parent, QTableView *tableView, si::Tab
                                         {QueryWidget(ui->lineEditLogdataAirport, {"departure_ident", "destination_ident"},
                                                      false /* allowOverride */, false /* allowExclude */)}));
 
+  // Keep only visible pages of large logbooks in memory
+  columns->setPagedModel(true);
+
   SearchBaseTable::initViewAndController(NavApp::getDatabaseLogbook());
 
   // Add model data handler and model format handler as callbacks
@@ -194,6 +194,10 @@ NavSearch::NavSearch(QMainWindow *parent, QTableView *tableView, si::TabSearchId
                                         {QueryWidget(ui->lineEditNavIcaoSearch, {"ident"},
                                                      false /* allowOverride */, false /* allowExclude */)}));
 
+  // Substring searches in text fields use an FTS5 index if available
+  columns->setFullTextColumns({"ident", "name"});
+  columns->setSpatialIndex(true);
+
   SearchBaseTable::initViewAndController(NavApp::getDatabaseNav());
 
   // Add model data handler and model format handler as callbacks
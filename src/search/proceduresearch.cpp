@@ -74,6 +74,9 @@ const static int TREEWIDGET_HEADER_ROLE = Qt::UserRole + 1;
 const static int COMBOBOX_RUNWAY_FILTER_ROLE = Qt::UserRole;
 const static int COMBOBOX_PROCEDURE_FILTER_ROLE = Qt::UserRole;
 
+/* Tree view state key for no item which is procedure and transition id -1 */
+const static quint64 INVALID_TREE_KEY = Q_UINT64_C(0xffffffffffffffff);
+
 using atools::sql::SqlRecord;
 
 using atools::sql::SqlRecordList;
@@ -269,7 +272,7 @@ void ProcedureSearch::filterChanged(const QString&)
 
 void ProcedureSearch::optionsChanged()
 {
-  QBitArray state = saveTreeViewState();
+  TreeViewState state = saveTreeViewState();
 
   // Adapt table view text size
   gridDelegate->styleChanged();
@@ -302,6 +305,7 @@ void ProcedureSearch::preDatabaseLoad()
 
   itemIndex.clear();
   itemLoadedIndex.clear();
+  procedureRefs.clear();
   *currentAirportNav = *currentAirportSim = map::MapAirport();
   recentTreeState.clear();
 }
@@ -361,7 +365,8 @@ void ProcedureSearch::showProcedures(const map::MapAirport& airport, bool depart
 
   fillProcedureTreeWidget();
 
-  restoreTreeViewState(recentTreeState.value(currentAirportNav->id), false /* block signals */);
+  restoreTreeViewState(recentTreeState.value(currentAirportNav->id, TreeViewState::fromVariant(QVariant())),
+                       false /* block signals */);
   updateHeaderLabel();
   updateWidgets();
 }
@@ -446,14 +451,27 @@ QString ProcedureSearch::procedureAndTransitionText(const QTreeWidgetItem *item,
       // Only approach
       text.append(pattern.arg(item->data(COL_DESCRIPTION, role).toString()).arg(item->text(COL_IDENT)));
 
-      if(item->childCount() == 1 && ref.mapType & proc::PROCEDURE_SID)
+      if(ref.mapType & proc::PROCEDURE_SID)
       {
-        // Special SID case that has only transition legs and only one transition
-        QTreeWidgetItem *child = item->child(0);
-        if(child != nullptr)
+        if(item->type() < itemLoadedIndex.size() && !itemLoadedIndex.at(item->type()))
         {
-          text.append(viaPattern);
-          text.append(pattern.arg(child->data(COL_DESCRIPTION, role).toString()).arg(child->text(COL_IDENT)));
+          // Transitions not loaded yet - get single transition from database
+          const SqlRecordList *transitionRecords = infoQuery->getTransitionInformation(ref.procedureId);
+          if(transitionRecords != nullptr && transitionRecords->size() == 1)
+          {
+            text.append(viaPattern);
+            text.append(pattern.arg(tr("transition")).arg(transitionRecords->constFirst().valueStr("fix_ident")));
+          }
+        }
+        else if(item->childCount() == 1)
+        {
+          // Special SID case that has only transition legs and only one transition
+          QTreeWidgetItem *child = item->child(0);
+          if(child != nullptr)
+          {
+            text.append(viaPattern);
+            text.append(pattern.arg(child->data(COL_DESCRIPTION, role).toString()).arg(child->text(COL_IDENT)));
+          }
         }
       }
     }
@@ -565,6 +583,7 @@ void ProcedureSearch::fillProcedureTreeWidget()
   treeWidget->clear();
   itemIndex.clear();
   itemLoadedIndex.clear();
+  procedureRefs.clear();
 
   if(currentAirportNav->isValid())
   {
@@ -691,18 +710,15 @@ void ProcedureSearch::fillProcedureTreeWidget()
         if(type & proc::PROCEDURE_APPROACH && !recApp.valueStr("arinc_name").isEmpty())
           ident.append(tr(" (%1)").arg(recApp.valueStr("arinc_name")));
 
-        QTreeWidgetItem *apprItem = buildProcedureItem(root, ident, prefix % procTypeText, prefix % headerText,
-                                                       prefix % menuText, attText);
+        buildProcedureItem(root, ident, prefix % procTypeText, prefix % headerText, prefix % menuText, attText);
+
+        // Transition items are created when expanding the procedure - keep references for preview of all
+        procedureRefs.append(itemIndex.constLast());
         if(transitionRecords != nullptr)
         {
-          // Transitions for this approach
           for(const SqlRecord& transitionRec : *transitionRecords)
-          {
-            // Also add runway from parent approach to transition
-            itemIndex.append({MapProcedureRef(currentAirportNav->id, runwayEndId, apprId,
-                                              transitionRec.valueInt("transition_id"), -1, type)});
-            buildTransitionItem(apprItem, transitionRec, type & proc::PROCEDURE_DEPARTURE || type & proc::PROCEDURE_STAR_ALL);
-          }
+            procedureRefs.append(MapProcedureRef(currentAirportNav->id, runwayEndId, apprId,
+                                                 transitionRec.valueInt("transition_id"), -1, type));
         }
       }
     }
@@ -722,10 +738,10 @@ void ProcedureSearch::saveState()
   atools::settings::Settings& settings = atools::settings::Settings::instance();
 
   // Use current state and update the map too
-  QBitArray state = saveTreeViewState();
+  TreeViewState state = saveTreeViewState();
   if(currentAirportNav->isValid())
     recentTreeState.insert(currentAirportNav->id, state);
-  settings.setValueVar(lnm::APPROACHTREE_STATE, state);
+  settings.setValueVar(lnm::APPROACHTREE_STATE, state.toVariant());
 
   // Save column order and width
   WidgetState(lnm::APPROACHTREE_WIDGET).save(treeWidget);
@@ -749,7 +765,7 @@ void ProcedureSearch::restoreState()
 
   updateFilterBoxes();
 
-  QBitArray state;
+  TreeViewState state = TreeViewState::fromVariant(QVariant());
   if(OptionData::instance().getFlags() & opts::STARTUP_LOAD_SEARCH && !NavApp::isSafeMode())
   {
     Ui::MainWindow *ui = NavApp::getMainUi();
@@ -759,7 +775,7 @@ void ProcedureSearch::restoreState()
     fillProcedureTreeWidget();
     if(currentAirportNav->isValid() && currentAirportNav->procedure())
     {
-      state = settings.valueVar(lnm::APPROACHTREE_STATE).toBitArray();
+      state = TreeViewState::fromVariant(settings.valueVar(lnm::APPROACHTREE_STATE));
       recentTreeState.insert(currentAirportNav->id, state);
     }
   }
@@ -875,7 +891,7 @@ void ProcedureSearch::itemSelectionChangedInternal(bool noFollow)
   }
 
   if(NavApp::getSearchController()->getCurrentSearchTabId() == tabIndex && ui->pushButtonProcedureShowAll->isChecked())
-    emit proceduresSelected(itemIndex);
+    emit proceduresSelected(procedureRefs);
   else
     emit proceduresSelected(QVector<proc::MapProcedureRef>());
 
@@ -919,8 +935,13 @@ void ProcedureSearch::itemDoubleClicked(QTreeWidgetItem *item, int)
   showEntry(item, true /* double click*/, true /* zoom */);
 }
 
-/* Load all approach or transition legs on demand - approaches and transitions are loaded after selecting the airport */
 void ProcedureSearch::itemExpanded(QTreeWidgetItem *item)
+{
+  loadChildItems(item);
+}
+
+/* Load transitions and approach or transition legs on demand - only approaches are loaded after selecting the airport */
+void ProcedureSearch::loadChildItems(QTreeWidgetItem *item)
 {
   if(item != nullptr)
   {
@@ -937,19 +958,33 @@ void ProcedureSearch::itemExpanded(QTreeWidgetItem *item)
     {
       if(ref.procedureId != -1 && ref.transitionId == -1)
       {
+        itemLoadedIndex.setBit(item->type());
+
         const MapProcedureLegs *legs = procedureQuery->getProcedureLegs(*currentAirportNav, ref.procedureId);
-        if(legs != nullptr)
-        {
-          QList<QTreeWidgetItem *> items = buildProcedureLegItems(legs, -1);
-          itemLoadedIndex.setBit(item->type());
+        QList<QTreeWidgetItem *> items = buildProcedureLegItems(legs, -1);
+        if(legs == nullptr)
+          qWarning() << Q_FUNC_INFO << "no legs found for" << currentAirportNav->id << ref.procedureId;
 
-          if(legs->mapType & proc::PROCEDURE_DEPARTURE)
-            item->insertChildren(0, items);
-          else
-            item->addChildren(items);
+        // Departure legs are shown before transitions
+        if(ref.mapType & proc::PROCEDURE_DEPARTURE)
+          item->addChildren(items);
+
+        // Transitions for this approach
+        const SqlRecordList *transitionRecords = infoQuery->getTransitionInformation(ref.procedureId);
+        if(transitionRecords != nullptr)
+        {
+          for(const SqlRecord& transitionRec : *transitionRecords)
+          {
+            // Also add runway from parent approach to transition
+            itemIndex.append(MapProcedureRef(ref.airportId, ref.runwayEndId, ref.procedureId,
+                                             transitionRec.valueInt("transition_id"), -1, ref.mapType));
+            buildTransitionItem(item, transitionRec, ref.mapType & proc::PROCEDURE_DEPARTURE ||
+                                ref.mapType & proc::PROCEDURE_STAR_ALL);
+          }
         }
-        else
-          qWarning() << Q_FUNC_INFO << "no legs found for" << currentAirportNav->id << ref.procedureId;
+
+        if(!(ref.mapType & proc::PROCEDURE_DEPARTURE))
+          item->addChildren(items);
       }
       else if(ref.procedureId != -1 && ref.transitionId != -1)
       {
@@ -1559,87 +1594,146 @@ void ProcedureSearch::setItemStyle(QTreeWidgetItem *item, const MapProcedureLeg&
   }
 }
 
-QBitArray ProcedureSearch::saveTreeViewState()
+bool ProcedureSearch::TreeViewState::isEmpty() const
 {
-  QList<const QTreeWidgetItem *> itemStack;
-  const QTreeWidgetItem *root = treeWidget->invisibleRootItem();
+  return expanded.isEmpty() && selected == INVALID_TREE_KEY && top == INVALID_TREE_KEY;
+}
+
+QVariant ProcedureSearch::TreeViewState::toVariant() const
+{
+  QVariantList list({selected, top});
+  for(quint64 key : expanded)
+    list.append(key);
+  return list;
+}
 
-  QBitArray state;
+ProcedureSearch::TreeViewState ProcedureSearch::TreeViewState::fromVariant(const QVariant& variant)
+{
+  TreeViewState state;
+  state.selected = state.top = INVALID_TREE_KEY;
 
-  if(!itemIndex.isEmpty())
+  // Older versions saved a bit array which results in an empty list
+  const QVariantList list = variant.toList();
+  if(list.size() >= 2)
   {
-    for(int i = 0; i < root->childCount(); ++i)
-      itemStack.append(root->child(i));
+    state.selected = list.at(0).toULongLong();
+    state.top = list.at(1).toULongLong();
+    for(int i = 2; i < list.size(); i++)
+      state.expanded.insert(list.at(i).toULongLong());
+  }
+  return state;
+}
 
-    int itemIdx = 0;
-    while(!itemStack.isEmpty())
-    {
-      const QTreeWidgetItem *item = itemStack.takeFirst();
+quint64 ProcedureSearch::treeStateKey(const MapProcedureRef& ref)
+{
+  return static_cast<quint64>(static_cast<quint32>(ref.procedureId)) << 32 | static_cast<quint32>(ref.transitionId);
+}
 
-      if(item->type() < itemIndex.size() && itemIndex.at(item->type()).legId != -1)
-        // Do not save legs
-        continue;
+ProcedureSearch::TreeViewState ProcedureSearch::saveTreeViewState()
+{
+  TreeViewState state = TreeViewState::fromVariant(QVariant());
 
-      bool selected = item->isSelected();
+  if(!itemIndex.isEmpty())
+  {
+    // Procedures and loaded transitions - legs are not expandable
+    const QTreeWidgetItem *root = treeWidget->invisibleRootItem();
+    for(int i = 0; i < root->childCount(); ++i)
+    {
+      const QTreeWidgetItem *item = root->child(i);
+      if(item->isExpanded())
+        state.expanded.insert(treeStateKey(itemIndex.at(item->type())));
 
-      // Check if a leg is selected and push selection status down to the approach or transition
-      // This avoids the need of expanding during loading which messes up the order
-      for(int i = 0; i < item->childCount(); i++)
+      for(int j = 0; j < item->childCount(); ++j)
       {
-        if(itemIndex.at(item->child(i)->type()).legId != -1 && item->child(i)->isSelected())
-        {
-          selected = true;
-          break;
-        }
+        const QTreeWidgetItem *child = item->child(j);
+        if(child->isExpanded())
+          state.expanded.insert(treeStateKey(itemIndex.at(child->type())));
       }
+    }
 
-      state.resize(itemIdx + 2);
-      state.setBit(itemIdx, item->isExpanded()); // Fist bit in triple: expanded or not
-      state.setBit(itemIdx + 1, selected); // Second bit: selection state
+    // Selected leg pushes selection status up to the approach or transition
+    // This avoids the need of expanding during loading
+    const QList<QTreeWidgetItem *> selectedItems = treeWidget->selectedItems();
+    if(!selectedItems.isEmpty())
+      state.selected = treeStateKey(itemIndex.at(selectedItems.constFirst()->type()));
 
-      for(int i = 0; i < item->childCount(); ++i)
-        itemStack.append(item->child(i));
-      itemIdx += 2;
-    }
+    // Keep scroll position by remembering the topmost visible item
+    const QTreeWidgetItem *topItem = treeWidget->itemAt(0, 0);
+    if(topItem != nullptr)
+      state.top = treeStateKey(itemIndex.at(topItem->type()));
   }
   return state;
 }
 
-void ProcedureSearch::restoreTreeViewState(const QBitArray& state, bool blockSignals)
+QTreeWidgetItem *ProcedureSearch::findTreeItem(quint64 key, bool load)
 {
-  if(state.isEmpty())
-    return;
+  if(key == INVALID_TREE_KEY)
+    return nullptr;
 
-  QList<QTreeWidgetItem *> itemStack;
-  const QTreeWidgetItem *root = treeWidget->invisibleRootItem();
+  quint32 procedureId = static_cast<quint32>(key >> 32);
+  bool transition = static_cast<qint32>(key & 0xffffffff) != -1;
 
-  // Find selected and expanded items first without tree modification to keep order
+  const QTreeWidgetItem *root = treeWidget->invisibleRootItem();
   for(int i = 0; i < root->childCount(); ++i)
-    itemStack.append(root->child(i));
-  int itemIdx = 0;
-  QVector<QTreeWidgetItem *> itemsToExpand;
-  QTreeWidgetItem *selectedItem = nullptr;
-  while(!itemStack.isEmpty())
   {
-    QTreeWidgetItem *item = itemStack.takeFirst();
-    if(item != nullptr && itemIdx < state.size() - 1)
+    QTreeWidgetItem *item = root->child(i);
+    const MapProcedureRef& ref = itemIndex.at(item->type());
+    if(static_cast<quint32>(ref.procedureId) == procedureId)
     {
-      if(state.at(itemIdx))
-        itemsToExpand.append(item);
-      if(state.at(itemIdx + 1))
-        selectedItem = item;
-
-      for(int i = 0; i < item->childCount(); ++i)
-        itemStack.append(item->child(i));
-      itemIdx += 2;
+      if(!transition)
+        return item;
+
+      if(load)
+        loadChildItems(item);
+
+      for(int j = 0; j < item->childCount(); ++j)
+      {
+        QTreeWidgetItem *child = item->child(j);
+        const MapProcedureRef& childRef = itemIndex.at(child->type());
+        if(!childRef.isLeg() && treeStateKey(childRef) == key)
+          return child;
+      }
+      return nullptr;
     }
   }
+  return nullptr;
+}
 
-  // Expand and possibly reload
-  for(QTreeWidgetItem *item : itemsToExpand)
-    item->setExpanded(true);
+void ProcedureSearch::restoreTreeViewState(const TreeViewState& state, bool blockSignals)
+{
+  if(state.isEmpty())
+    return;
 
-  // Center the selected item
+  // Load children before expanding since signals might be blocked
+  // Procedures first to have transitions available
+  for(quint64 key : state.expanded)
+  {
+    if(static_cast<qint32>(key & 0xffffffff) == -1)
+    {
+      QTreeWidgetItem *item = findTreeItem(key, false /* load */);
+      if(item != nullptr)
+      {
+        loadChildItems(item);
+        item->setExpanded(true);
+      }
+    }
+  }
+
+  for(quint64 key : state.expanded)
+  {
+    if(static_cast<qint32>(key & 0xffffffff) != -1)
+    {
+      QTreeWidgetItem *item = findTreeItem(key, false /* load */);
+      if(item != nullptr)
+      {
+        loadChildItems(item);
+        item->setExpanded(true);
+      }
+    }
+  }
+
+  // Selection might be on a transition of a collapsed procedure
+  QTreeWidgetItem *selectedItem = findTreeItem(state.selected, true /* load */);
   if(selectedItem != nullptr)
   {
     if(blockSignals)
@@ -1647,9 +1741,14 @@ void ProcedureSearch::restoreTreeViewState(const QBitArray& state, bool blockSig
     selectedItem->setSelected(true);
     if(blockSignals)
       treeWidget->blockSignals(false);
+  }
 
+  // Restore scroll position or center the selected item
+  QTreeWidgetItem *topItem = findTreeItem(state.top, false /* load */);
+  if(topItem != nullptr)
+    treeWidget->scrollToItem(topItem, QAbstractItemView::PositionAtTop);
+  else if(selectedItem != nullptr)
     treeWidget->scrollToItem(selectedItem, QAbstractItemView::PositionAtTop);
-  }
 }
 
 void ProcedureSearch::createFonts()
@@ -25,6 +25,7 @@
 #include <QBitArray>
 #include <QFont>
 #include <QObject>
+#include <QSet>
 #include <QVector>
 
 namespace atools {
@@ -164,9 +165,32 @@ private:
   void attachProcedure();
   void showProcedureTriggered();
 
+  /* Expanded, selected and topmost visible procedure or transition items identified by procedure and transition id.
+   * Does not depend on the order or number of created items since these are loaded on demand. */
+  struct TreeViewState
+  {
+    QSet<quint64> expanded;
+    quint64 selected, top;
+
+    bool isEmpty() const;
+
+    /* Convert to and from list of numbers for settings */
+    QVariant toVariant() const;
+    static TreeViewState fromVariant(const QVariant& variant);
+  };
+
   // Save and restore expanded and selected item state
-  QBitArray saveTreeViewState();
-  void restoreTreeViewState(const QBitArray& state, bool blockSignals);
+  TreeViewState saveTreeViewState();
+  void restoreTreeViewState(const TreeViewState& state, bool blockSignals);
+
+  /* Key for tree view state built from procedure and transition id. Legs map to their parent item. */
+  static quint64 treeStateKey(const proc::MapProcedureRef& ref);
+
+  /* Find procedure or transition item for key. Loads transitions of a procedure on demand if load is true. */
+  QTreeWidgetItem *findTreeItem(quint64 key, bool load);
+
+  /* Load transitions and/or legs as child items for a procedure or transition item if not already done */
+  void loadChildItems(QTreeWidgetItem *item);
 
   /* Build full approach or transition items for the tree view */
   QTreeWidgetItem *buildProcedureItem(QTreeWidgetItem *runwayItem, const QString& ident, const QString& procTypeText,
@@ -241,9 +265,11 @@ private:
   // item's types are the indexes into this array with approach, transition and leg ids
   QVector<proc::MapProcedureRef> itemIndex;
 
+  // All procedures and transitions passing the filter - also the ones not loaded into the tree yet
+  QVector<proc::MapProcedureRef> procedureRefs;
+
   // Item type is the index into this array
-  // Approach or transition legs are already loaded in tree if bit is set
-  // Fist bit in pair: expanded or not, Second bit: selection state
+  // Transitions and approach or transition legs are already loaded in tree if bit is set
   QBitArray itemLoadedIndex;
 
   InfoQuery *infoQuery = nullptr;
@@ -256,8 +282,8 @@ private:
 
   map::MapAirport *currentAirportNav, *currentAirportSim;
 
-  // Maps airport ID to expanded state of the tree widget items - bit array is same content as itemLoadedIndex
-  QHash<int, QBitArray> recentTreeState;
+  // Maps airport ID to expanded state of the tree widget items
+  QHash<int, TreeViewState> recentTreeState;
 
   atools::gui::GridDelegate *gridDelegate = nullptr;
 
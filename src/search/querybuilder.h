@@ -32,13 +32,13 @@ class QueryBuilderResult
 {
 public:
   explicit QueryBuilderResult()
-    : overrideQuery(false)
+    : overrideQuery(false), connectionLocal(false)
   {
 
   }
 
-  explicit QueryBuilderResult(const QString& whereParam, bool overrideParam)
-    : where(whereParam), overrideQuery(overrideParam)
+  explicit QueryBuilderResult(const QString& whereParam, bool overrideParam, bool connectionLocalParam = false)
+    : where(whereParam), overrideQuery(overrideParam), connectionLocal(connectionLocalParam)
   {
   }
 
@@ -59,9 +59,16 @@ public:
     return overrideQuery;
   }
 
+  /* Clause uses temporary tables which are visible only in the connection of the search */
+  bool isConnectionLocal() const
+  {
+    return connectionLocal;
+  }
+
 private:
   QString where; /* partial where clause */
   bool overrideQuery; /* true if this result should override all other queries */
+  bool connectionLocal; /* true if clause refers to temporary tables */
 
 };
 
@@ -16,138 +16,122 @@
 *****************************************************************************/
 
 #include "search/randomdepartureairportpickingbycriteria.h"
-#include "search/randomdestinationairportpickingbycriteria.h"
 
-#include "search/airportsearch.h"
+#include "geo/calculations.h"
 #include "geo/pos.h"
 
 #include <QRandomGenerator>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
 
 int RandomDepartureAirportPickingByCriteria::countResult = 0;
-int RandomDepartureAirportPickingByCriteria::randomLimit = 0;
 QVector<std::pair<int, atools::geo::Pos> > *RandomDepartureAirportPickingByCriteria::data = nullptr;
 int RandomDepartureAirportPickingByCriteria::distanceMin = 0;
 int RandomDepartureAirportPickingByCriteria::distanceMax = 0;
 
 RandomDepartureAirportPickingByCriteria::RandomDepartureAirportPickingByCriteria(QObject *parent) : QThread(parent)
 {
-  indexDestination = -1;
-  noSuccess = true;
+  canceled = false;
 }
 
-void RandomDepartureAirportPickingByCriteria::initStatics(int countResult, int randomLimit, QVector<std::pair<int,
-                                                                                                              atools::geo::Pos> > *data,
+void RandomDepartureAirportPickingByCriteria::initStatics(int countResult, QVector<std::pair<int, atools::geo::Pos> > *data,
                                                           int distanceMinMeter, int distanceMaxMeter)
 {
   RandomDepartureAirportPickingByCriteria::countResult = countResult;
-  RandomDepartureAirportPickingByCriteria::randomLimit = randomLimit;
   RandomDepartureAirportPickingByCriteria::data = data;
   RandomDepartureAirportPickingByCriteria::distanceMin = distanceMinMeter;
   RandomDepartureAirportPickingByCriteria::distanceMax = distanceMaxMeter;
-  RandomDestinationAirportPickingByCriteria::initStatics(countResult, randomLimit, data->data(), distanceMinMeter, distanceMaxMeter);
 }
 
 void RandomDepartureAirportPickingByCriteria::run()
 {
-  std::pair<int, atools::geo::Pos> *data = this->data->data();
-
-  QMap<int, bool> triedIndexDeparture; // acts as a lookup which indices have been tried already; QMap keys are sorted, lookup is very fast
-
-  bool departureSuccess;
-
-  int indexDeparture = 0;
-
-  runningDestinationThreads = 0;
-
-  do
+  const QVector<std::pair<int, atools::geo::Pos> >& airports = *data;
+
+  // Build index of valid airports sorted by latitude ======================================
+  latitudeIndex.clear();
+  latitudeIndex.reserve(countResult);
+  QVector<int> departures;
+  departures.reserve(countResult);
+  for(int i = 0; i < countResult; i++)
   {
-    // split index finding into 2 approaches (if(while) rather than while(if) for performance reason)
-    if(triedIndexDeparture.count() < randomLimit)
+    const atools::geo::Pos& pos = airports.at(i).second;
+    if(pos.isValid())
     {
-      // random picking
-      // on small result sets, if all are invalid value, we wouldn't switch to the incremented random approach (because the "if" is outside), but being a small result set, this approach might still try every index after some time
-      do
-      {
-        departureSuccess = false;
-        if(triedIndexDeparture.count() == countResult)
-          break;
-        do
-        {
-          indexDeparture = QRandomGenerator::global()->bounded(countResult);
-        }while(triedIndexDeparture.contains(indexDeparture));
-        triedIndexDeparture.insert(indexDeparture, true);
-        departureSuccess = true;
-      }while(!data[indexDeparture].second.isValid());
-    }
-    else
-    {
-      // random pick, then increment
-      indexDeparture = QRandomGenerator::global()->bounded(countResult);
-      do
-      {
-        departureSuccess = false;
-        if(triedIndexDeparture.count() == countResult)
-          break;
-        while(triedIndexDeparture.contains(indexDeparture))
-        {
-          indexDeparture = (indexDeparture + 1) % countResult;
-        }
-        triedIndexDeparture.insert(indexDeparture, true);
-        departureSuccess = true;
-      }while(!data[indexDeparture].second.isValid());
+      latitudeIndex.append(std::make_pair(pos.getLatY(), i));
+      departures.append(i);
     }
+  }
+  std::sort(latitudeIndex.begin(), latitudeIndex.end());
 
-    if(departureSuccess)
-    {
-      runningDestinationThreads++;
-      RandomDestinationAirportPickingByCriteria *destinationPicker = new RandomDestinationAirportPickingByCriteria(indexDeparture);
-      connect(destinationPicker, &RandomDestinationAirportPickingByCriteria::resultReady, this,
-              &RandomDepartureAirportPickingByCriteria::dataReceived);
-      connect(destinationPicker, &RandomDestinationAirportPickingByCriteria::finished, destinationPicker, &QObject::deleteLater);
-      destinationPicker->start();
-    }
+  // Try departures in random order ======================================
+  std::shuffle(departures.begin(), departures.end(), *QRandomGenerator::global());
 
-    while(noSuccess &&
-          ((runningDestinationThreads >= QThread::idealThreadCount()) ||
-           ((triedIndexDeparture.count() == countResult) && (runningDestinationThreads != 0)))) // if a CPU affinity tool is used on lnm exe, all threads created by lnm might be run on the designated core instead of being evenly distributed (at least with Process Lasso)
+  int indexDeparture = -1, indexDestination = -1;
+  int batchSize = std::max(QThread::idealThreadCount(), 1);
+
+  for(int batchStart = 0; batchStart < departures.size() && indexDestination == -1 && !canceled; batchStart += batchSize)
+  {
+    // Check a batch of departures in parallel
+    QVector<QFuture<int> > futures;
+    int batchEnd = std::min(batchStart + batchSize, departures.size());
+    for(int i = batchStart; i < batchEnd; i++)
+      futures.append(QtConcurrent::run(this, &RandomDepartureAirportPickingByCriteria::pickDestination, departures.at(i)));
+
+    // Use first departure in batch order having a destination
+    for(int i = 0; i < futures.size(); i++)
     {
-      emit progressing();
-      sleep(1);
+      futures[i].waitForFinished();
+      if(indexDestination == -1 && futures.at(i).result() != -1)
+      {
+        indexDeparture = departures.at(batchStart + i);
+        indexDestination = futures.at(i).result();
+      }
     }
 
-    if(!noSuccess || triedIndexDeparture.count() == countResult)
-      break;
-  }while(true);
-
-  RandomDestinationAirportPickingByCriteria::stopExecution = true;
-  while(runningDestinationThreads > 0)
-  {
-    sleep(1); // make sure all destination threads which still might use data have exited but not be a tight loop
+    emit progressing();
   }
 
-  if(departureSuccess && indexDestination > -1) // on cancellation departureSuccess is true and noSuccess is false but indexDestination is still -1
-  {
-    emit resultReady(true, associatedIndexDeparture, indexDestination, this->data);
-  }
+  if(indexDestination != -1 && !canceled)
+    emit resultReady(true, indexDeparture, indexDestination, data);
   else
-  {
-    emit resultReady(false, -1, -1, this->data);
-  }
+    emit resultReady(false, -1, -1, data);
 }
 
-void RandomDepartureAirportPickingByCriteria::dataReceived(const bool isSuccess, const int indexDeparture, const int indexDestination)
+int RandomDepartureAirportPickingByCriteria::pickDestination(int indexDeparture) const
 {
-  if(isSuccess)
+  if(canceled)
+    return -1;
+
+  const QVector<std::pair<int, atools::geo::Pos> >& airports = *data;
+  const atools::geo::Pos& departurePos = airports.at(indexDeparture).second;
+
+  // Latitude band which can contain destinations - one degree latitude is about 60 NM
+  float latDelta = atools::geo::meterToNm(static_cast<float>(distanceMax)) / 60.f + 1.f;
+  auto lower = std::lower_bound(latitudeIndex.constBegin(), latitudeIndex.constEnd(),
+                                std::make_pair(departurePos.getLatY() - latDelta, -1));
+  auto upper = std::upper_bound(latitudeIndex.constBegin(), latitudeIndex.constEnd(),
+                                std::make_pair(departurePos.getLatY() + latDelta, countResult));
+
+  // Collect all destinations in the distance ring
+  QVector<int> destinations;
+  for(auto it = lower; it != upper; ++it)
   {
-    noSuccess = false;
-    associatedIndexDeparture = indexDeparture;
-    this->indexDestination = indexDestination;
+    if(it->second == indexDeparture) // destination shall != departure
+      continue;
+
+    float distMeter = departurePos.distanceMeterTo(airports.at(it->second).second);
+    if(distMeter >= distanceMin && distMeter <= distanceMax)
+      destinations.append(it->second);
   }
-  runningDestinationThreads--;
+
+  if(destinations.isEmpty())
+    return -1;
+  else
+    return destinations.at(QRandomGenerator::global()->bounded(destinations.size()));
 }
 
 void RandomDepartureAirportPickingByCriteria::cancellationReceived()
 {
-  noSuccess = false;
-  RandomDestinationAirportPickingByCriteria::stopExecution = true;
+  canceled = true;
 }
@@ -21,13 +21,23 @@
 #include <QObject>
 #include <QThread>
 
+#include <atomic>
+
 namespace atools {
 namespace geo {
 class Pos;
 }
 }
 
-// should only be instantiated 1 at a time
+/*
+ * Picks a random departure and destination airport from the search result which are within the given distance range.
+ *
+ * Candidate airports are sorted by latitude. For each random departure only airports in the latitude band
+ * which can contain the maximum distance are checked. Several departures are checked in parallel in the
+ * global thread pool.
+ *
+ * Should only be instantiated once at a time.
+ */
 class RandomDepartureAirportPickingByCriteria :
   public QThread
 {
@@ -37,13 +47,12 @@ public:
   explicit RandomDepartureAirportPickingByCriteria(QObject *parent);
 
   // required calling !!
-  static void initStatics(int countResult, int randomLimit, QVector<std::pair<int, atools::geo::Pos> > *data, int distanceMinMeter,
+  static void initStatics(int countResult, QVector<std::pair<int, atools::geo::Pos> > *data, int distanceMinMeter,
                           int distanceMaxMeter);
 
   void run() override;
 
 public slots:
-  void dataReceived(const bool isSuccess, const int indexDeparture, const int indexDestination);
   void cancellationReceived();
 
 signals:
@@ -52,15 +61,18 @@ signals:
   void progressing();
 
 private:
-  bool noSuccess;
-  int indexDestination;
-  int associatedIndexDeparture;
+  /* Get a random destination index within distance range of departure or -1 if none */
+  int pickDestination(int indexDeparture) const;
+
+  std::atomic_bool canceled;
+
+  /* Valid candidate airports as latitude and index into data sorted by latitude */
+  QVector<std::pair<float, int> > latitudeIndex;
+
   static int countResult;
-  static int randomLimit;
   static QVector<std::pair<int, atools::geo::Pos> > *data;
   static int distanceMin;
   static int distanceMax;
-  int runningDestinationThreads;
 };
 
 #endif // RANDOMDEPARTUREAIRPORTPICKINGBYCRITERIA_H
@@ -37,6 +37,7 @@
 #include "route/route.h"
 #include "search/column.h"
 #include "search/columnlist.h"
+#include "search/fulltextindex.h"
 #include "search/searchcontroller.h"
 #include "search/sqlcontroller.h"
 #include "search/sqlmodel.h"
@@ -307,7 +308,7 @@ QueryBuilderResult SearchBaseTable::queryBuilderFunc(const QueryWidget& queryWid
     // "ABC DEF" GHI "JK" -> {"ABC DEF", GHI, "JK"}
     const QStringList textList = atools::splitStringAtQuotes(lineEdit->text().trimmed());
     QStringList queryList, excludeQueryList;
-    bool overrideQuery = false;
+    bool overrideQuery = false, connectionLocal = false;
 
 #ifdef DEBUG_INFORMATION
     qDebug() << Q_FUNC_INFO << textList;
@@ -355,11 +356,23 @@ QueryBuilderResult SearchBaseTable::queryBuilderFunc(const QueryWidget& queryWid
 
         // Cannot use "arg" to build string since percent confuses QString
         QStringList clauses;
-        for(const QString& col: queryWidget.getColumns())
-          if(exclude)
-            clauses.append("coalesce(" % col % ", '') not like \''" % text % '\'');
-          else
-            clauses.append(col % " like " % '\'' % text % '\'');
+
+        // Use full text index for substring search if available
+        FullTextIndex *fullTextIndex = controller != nullptr && controller->getSqlModel() != nullptr ?
+                                       controller->getSqlModel()->getFullTextIndex() : nullptr;
+        if(!exclude && fullTextIndex != nullptr)
+          clauses.append(fullTextIndex->condition(queryWidget.getColumns(), text));
+        clauses.removeAll(QString());
+        connectionLocal |= !clauses.isEmpty();
+
+        if(clauses.isEmpty())
+        {
+          for(const QString& col: queryWidget.getColumns())
+            if(exclude)
+              clauses.append("coalesce(" % col % ", '') not like \''" % text % '\'');
+            else
+              clauses.append(col % " like " % '\'' % text % '\'');
+        }
         clauses.removeAll(QString());
         clauses.removeDuplicates();
 
@@ -387,7 +400,7 @@ QueryBuilderResult SearchBaseTable::queryBuilderFunc(const QueryWidget& queryWid
     qDebug() << Q_FUNC_INFO << "query" << query;
 #endif
 
-    return QueryBuilderResult(query, overrideQuery);
+    return QueryBuilderResult(query, overrideQuery, connectionLocal);
   }
   return QueryBuilderResult();
 }
@@ -753,6 +766,7 @@ void SearchBaseTable::connectSearchSlots()
 
   connect(controller->getSqlModel(), &SqlModel::modelReset, this, &SearchBaseTable::reconnectSelectionModel);
   connect(controller->getSqlModel(), &SqlModel::fetchedMore, this, &SearchBaseTable::fetchedMore);
+  connect(controller->getSqlModel(), &SqlModel::totalRowCountUpdated, this, &SearchBaseTable::fetchedMore);
 
   connect(ui->dockWidgetSearch, &QDockWidget::visibilityChanged, this, &SearchBaseTable::dockVisibilityChanged);
 }
@@ -870,6 +884,11 @@ int SearchBaseTable::getTotalRowCount() const
   return controller->getTotalRowCount();
 }
 
+bool SearchBaseTable::isTotalRowCountEstimated() const
+{
+  return controller->isTotalRowCountEstimated();
+}
+
 int SearchBaseTable::getSelectedRowCount() const
 {
   QItemSelectionModel *sm = view->selectionModel();
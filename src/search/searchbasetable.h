@@ -127,6 +127,9 @@ public:
   /* Total number of rows returned by the last query */
   int getTotalRowCount() const;
 
+  /* true if the total row count is a lower bound while the exact count is pending */
+  bool isTotalRowCountEstimated() const;
+
   /* Number of selected rows */
   int getSelectedRowCount() const;
 
@@ -392,6 +392,9 @@ void SearchController::searchSelectionChanged(const SearchBaseTable *source, int
   bool updateAirspace = false, updateLogEntries = false;
   QString selectionLabelText = tr("%1 of %2 %3 selected, %4 visible.%5");
   QString type, lastUpdate;
+
+  // Exact count is still pending - total is the number of fetched rows
+  QString totalText = source->isTotalRowCountEstimated() ? tr("%1+").arg(total) : QString::number(total);
   if(source->getTabIndex() == si::SEARCH_ONLINE_CLIENT || source->getTabIndex() == si::SEARCH_ONLINE_CENTER)
   {
     QDateTime lastUpdateTime = NavApp::getOnlinedataController()->getLastUpdateTime();
@@ -401,17 +404,17 @@ void SearchController::searchSelectionChanged(const SearchBaseTable *source, int
   if(source->getTabIndex() == si::SEARCH_AIRPORT)
   {
     type = tr("Airports");
-    ui->labelAirportSearchStatus->setText(selectionLabelText.arg(selected).arg(total).arg(type).arg(visible).arg(QString()));
+    ui->labelAirportSearchStatus->setText(selectionLabelText.arg(selected).arg(totalText).arg(type).arg(visible).arg(QString()));
   }
   else if(source->getTabIndex() == si::SEARCH_NAV)
   {
     type = tr("Navaids");
-    ui->labelNavSearchStatus->setText(selectionLabelText.arg(selected).arg(total).arg(type).arg(visible).arg(QString()));
+    ui->labelNavSearchStatus->setText(selectionLabelText.arg(selected).arg(totalText).arg(type).arg(visible).arg(QString()));
   }
   else if(source->getTabIndex() == si::SEARCH_USER)
   {
     type = tr("Userpoints");
-    ui->labelUserdata->setText(selectionLabelText.arg(selected).arg(total).arg(type).arg(visible).arg(QString()));
+    ui->labelUserdata->setText(selectionLabelText.arg(selected).arg(totalText).arg(type).arg(visible).arg(QString()));
   }
   else if(source->getTabIndex() == si::SEARCH_LOG)
   {
@@ -441,18 +444,18 @@ void SearchController::searchSelectionChanged(const SearchBaseTable *source, int
     if(!logInformation.isEmpty())
       logText = tr("\nTravel Totals: %1.").arg(logInformation.join(tr(". ")));
 
-    ui->labelLogdata->setText(selectionLabelText.arg(selected).arg(total).arg(type).arg(visible).arg(logText));
+    ui->labelLogdata->setText(selectionLabelText.arg(selected).arg(totalText).arg(type).arg(visible).arg(logText));
   }
   else if(source->getTabIndex() == si::SEARCH_ONLINE_CLIENT)
   {
     type = tr("Clients");
-    ui->labelOnlineClientSearchStatus->setText(selectionLabelText.arg(selected).arg(total).arg(type).arg(visible).arg(lastUpdate));
+    ui->labelOnlineClientSearchStatus->setText(selectionLabelText.arg(selected).arg(totalText).arg(type).arg(visible).arg(lastUpdate));
   }
   else if(source->getTabIndex() == si::SEARCH_ONLINE_CENTER)
   {
     updateAirspace = true;
     type = tr("Centers");
-    ui->labelOnlineCenterSearchStatus->setText(selectionLabelText.arg(selected).arg(total).arg(type).arg(visible).arg(lastUpdate));
+    ui->labelOnlineCenterSearchStatus->setText(selectionLabelText.arg(selected).arg(totalText).arg(type).arg(visible).arg(lastUpdate));
   }
 
   map::MapResult result;
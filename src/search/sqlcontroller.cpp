@@ -59,7 +59,14 @@ void SqlController::preDatabaseLoad()
   viewSetModel(nullptr);
 
   if(model != nullptr)
+  {
+    // Release the second database connection and temporary tables
+    model->stopTotalCount();
+    model->clearFullTextIndex();
+    model->clearFeatureIndex();
+    model->clearSpatialIndex();
     model->clear();
+  }
 }
 
 void SqlController::postDatabaseLoad()
@@ -335,7 +342,7 @@ void SqlController::filterByDistance(const atools::geo::Pos& center, sqlmodeltyp
     proxyModel->setDistanceFilter(center, dir, minDistance, maxDistance);
 
     // Update rectangle filter in query model (first coarse filter stage)
-    model->filterByBoundingRect(rect);
+    model->filterByBoundingRect(rect, center, minDistance, maxDistance);
 
     if(proxyWasNull)
     {
@@ -382,7 +389,7 @@ void SqlController::filterByDistanceUpdate(sqlmodeltypes::SearchDirection dir, f
     // Update proxy second stage filter
     proxyModel->setDistanceFilter(currentDistanceCenter, dir, minDistance, maxDistance);
     // Update SQL model coarse first stage filter
-    model->filterByBoundingRect(rect);
+    model->filterByBoundingRect(rect, currentDistanceCenter, minDistance, maxDistance);
     searchParamsChanged = true;
   }
 }
@@ -446,6 +453,11 @@ int SqlController::getTotalRowCount() const
     return 0;
 }
 
+bool SqlController::isTotalRowCountEstimated() const
+{
+  return proxyModel == nullptr && model != nullptr && model->isTotalRowCountEstimated();
+}
+
 QModelIndex SqlController::getCurrentIndex() const
 {
   return view->currentIndex();
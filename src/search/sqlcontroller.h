@@ -111,6 +111,9 @@ public:
   /* Total number of rows returned by the last query */
   int getTotalRowCount() const;
 
+  /* true if getTotalRowCount() returns only the fetched rows while the exact count is pending */
+  bool isTotalRowCountEstimated() const;
+
   /* Current active row. Not neccessarily selected */
   QModelIndex getCurrentIndex() const;
 
@@ -22,9 +22,18 @@
 #include "sql/sqldatabase.h"
 #include "sql/sqlquery.h"
 #include "exception.h"
+#include "geo/calculations.h"
 #include "search/column.h"
 #include "search/columnlist.h"
+#include "search/featureindex.h"
+#include "search/fulltextindex.h"
+#include "search/sqlpagecache.h"
+#include "query/spatialindex.h"
 #include "sql/sqlrecord.h"
+#include "db/databasepool.h"
+#include "app/navapp.h"
+#include "common/constants.h"
+#include "settings/settings.h"
 
 #include <QLineEdit>
 #include <QCheckBox>
@@ -32,23 +41,82 @@
 #include <QRegularExpression>
 #include <QComboBox>
 #include <QStringBuilder>
+#include <QtConcurrent/QtConcurrentRun>
 
 using atools::sql::SqlQuery;
 using atools::sql::SqlDatabase;
 using atools::gui::ErrorHandler;
 using atools::sql::SqlRecord;
 
+/* Rows per page and number of pages kept in memory for paged models */
+const static int PAGE_SIZE = 256;
+const static int MAX_PAGES = 16;
+
 SqlModel::SqlModel(QWidget *parent, SqlDatabase *sqlDb, const ColumnList *columnList)
   : QSqlQueryModel(parent), db(sqlDb), columns(columnList), parentWidget(parent)
 {
   // Set default handler
   setDataCallback(nullptr, QSet<Qt::ItemDataRole>());
 
+  connect(&countWatcher, &QFutureWatcher<int>::finished, this, &SqlModel::totalCountFinished);
+
+  // Show fetched rows as estimate and defer exact count until filter changes stop
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  estimateCount = settings.getAndStoreValue(lnm::OPTIONS_SEARCH_ESTIMATE_COUNT, true).toBool();
+  countTimer.setSingleShot(true);
+  countTimer.setInterval(settings.getAndStoreValue(lnm::OPTIONS_SEARCH_COUNT_DELAY_MS, 1000).toInt());
+  connect(&countTimer, &QTimer::timeout, this, &SqlModel::countTimeout);
+
+  if(!columns->getFullTextColumns().isEmpty())
+    fullTextIndex = new FullTextIndex(db, columns->getTablename(), columns->getIdColumnName(), columns->getFullTextColumns());
+
+  if(!columns->getFeatureIndexColumns().isEmpty())
+    featureIndex = new FeatureIndex(db, columns, columns->getFeatureIndexColumns());
+
+  if(columns->isSpatialIndex())
+    spatialIndex = new SpatialIndex(db, columns->getTablename(), columns->getIdColumnName());
+
+  if(columns->isPagedModel())
+    pageCache = new SqlPageCache(db, PAGE_SIZE, MAX_PAGES);
+
   buildQuery();
 }
 
 SqlModel::~SqlModel()
 {
+  stopTotalCount();
+  delete fullTextIndex;
+  delete featureIndex;
+  delete spatialIndex;
+  delete pageCache;
+}
+
+void SqlModel::clear()
+{
+  pagedQuery = false;
+  pagedRowCount = 0;
+  if(pageCache != nullptr)
+    pageCache->clear();
+
+  QSqlQueryModel::clear();
+}
+
+void SqlModel::clearFullTextIndex()
+{
+  if(fullTextIndex != nullptr)
+    fullTextIndex->clear();
+}
+
+void SqlModel::clearFeatureIndex()
+{
+  if(featureIndex != nullptr)
+    featureIndex->clear();
+}
+
+void SqlModel::clearSpatialIndex()
+{
+  if(spatialIndex != nullptr)
+    spatialIndex->clear();
 }
 
 void SqlModel::filterByBuilder(const QWidget *widget)
@@ -69,9 +137,13 @@ void SqlModel::filterExcluding(QModelIndex index, bool forceQueryBuilder, bool e
   buildQuery();
 }
 
-void SqlModel::filterByBoundingRect(const atools::geo::Rect& boundingRectangle)
+void SqlModel::filterByBoundingRect(const atools::geo::Rect& boundingRectangle, const atools::geo::Pos& center,
+                                    float minDistanceNm, float maxDistanceNm)
 {
   boundingRect = boundingRectangle;
+  distanceCenter = center;
+  distanceMinNm = minDistanceNm;
+  distanceMaxNm = maxDistanceNm;
   buildQuery();
 }
 
@@ -85,7 +157,7 @@ void SqlModel::filterByRecord(const atools::sql::SqlRecord& record, bool ignoreQ
 
 void SqlModel::filterBy(QModelIndex index, bool exclude, bool forceQueryBuilder, bool exact)
 {
-  filterBy(exclude, getSqlRecord().fieldName(index.column()), QSqlQueryModel::data(index), forceQueryBuilder,
+  filterBy(exclude, getSqlRecord().fieldName(index.column()), rawData(index), forceQueryBuilder,
            false /* ignoreQueryBuilder */, exact);
 }
 
@@ -391,6 +463,7 @@ void SqlModel::clearWhereConditions()
 {
   whereConditionMap.clear();
   boundingRect = atools::geo::Rect();
+  distanceCenter = atools::geo::Pos();
 }
 
 /* Set header captions */
@@ -494,8 +567,15 @@ void SqlModel::buildQuery(const QWidget *widgetFromBuilder)
 
   QString queryOrder;
   const Column *col = columns->getColumn(orderByCol);
+  if(isDistanceSearchActive() && (orderByCol.isEmpty() || orderByCol == "distance"))
+  {
+    // Let the database deliver rows roughly ordered by distance - proxy does the precise sorting
+    QString distExpr = distanceSqlExpression(std::cos(atools::geo::toRadians(static_cast<double>(distanceCenter.getLatY()))));
+    if(!distExpr.isEmpty())
+      queryOrder += "order by " % distExpr % ' ' % (orderByOrder.isEmpty() ? QString("asc") : orderByOrder);
+  }
   // Distance columns are no search criteria
-  if(!orderByCol.isEmpty() && !orderByOrder.isEmpty() && !col->isDistance())
+  else if(!orderByCol.isEmpty() && !orderByOrder.isEmpty() && !col->isDistance())
   {
     Q_ASSERT(col != nullptr);
 
@@ -520,6 +600,30 @@ void SqlModel::buildQuery(const QWidget *widgetFromBuilder)
       queryOrder += "order by " % orderByCol % ' ' % orderByOrder;
   }
 
+  if(pageCache != nullptr)
+  {
+    // Add id to order for stable pages and keyset paging ==================
+    const QString idColumnName = columns->getIdColumnName();
+    QString keyColumn;
+    bool keyset = true, descending = false;
+    if(queryOrder.isEmpty())
+      queryOrder = "order by " % idColumnName % " asc";
+    else
+    {
+      descending = orderByOrder == "desc";
+
+      // Keyset paging only for plain columns - not for sort functions
+      if(queryOrder == "order by " % orderByCol % ' ' % orderByOrder)
+        keyColumn = orderByCol;
+      else
+        keyset = false;
+      queryOrder += ", " % idColumnName % ' ' % orderByOrder;
+    }
+
+    pageCache->setQuery("select " % queryCols % " from " % tablename, queryWhere, queryOrder, idColumnName, keyColumn, descending,
+                        keyset);
+  }
+
   currentSqlQuery = "select " % queryCols % " from " % tablename % ' ' % queryWhere % ' ' % queryOrder;
 
   // Build a query to find the total row count of the result ==================
@@ -578,17 +682,126 @@ void SqlModel::buildQuery(const QWidget *widgetFromBuilder)
 
 void SqlModel::updateTotalCount()
 {
+  totalRowCount = 0;
+  totalRowCountValid = true;
+
+  if(isPagedQuery())
+  {
+    // Exact count is needed as row count and is done when setting the query
+    totalRowCount = pagedRowCount;
+    return;
+  }
+
   if(!currentSqlCountQuery.isEmpty())
   {
-    SqlQuery countStmt(db);
-    countStmt.exec(currentSqlCountQuery);
-    if(countStmt.next())
-      totalRowCount = countStmt.value(0).toInt();
+    QString dbFile = db->databaseName();
+    if(dbFile.isEmpty() || dbFile == ":memory:" || whereConnectionLocal)
+    {
+      // Cannot open a second connection or query uses indexes in the temporary schema of this
+      // connection which are not visible to others - count in GUI thread
+      SqlQuery countStmt(db);
+      countStmt.exec(currentSqlCountQuery);
+      if(countStmt.next())
+        totalRowCount = countStmt.value(0).toInt();
+    }
+    else
+    {
+      // Count can take a while on large tables - do it in background
+      totalRowCountValid = false;
+
+      if(estimateCount)
+        // Restart timer - count is started later or skipped if the first page contains all rows
+        countTimer.start();
+      else if(countWatcher.isRunning())
+        // Cannot interrupt the query - remember to start again with latest query when done
+        countPending = true;
+      else
+        startTotalCount();
+    }
+  }
+}
+
+void SqlModel::countTimeout()
+{
+  if(!totalRowCountValid)
+  {
+    if(countWatcher.isRunning())
+      countPending = true;
     else
-      totalRowCount = 0;
+      startTotalCount();
   }
-  else
-    totalRowCount = 0;
+}
+
+void SqlModel::updateTotalCountFromResult()
+{
+  if(!totalRowCountValid && !lastError().isValid() && !QSqlQueryModel::canFetchMore())
+  {
+    // First page contains the whole result - no need to count
+    countTimer.stop();
+    countPending = false;
+    countWatcherSql.clear();
+
+    totalRowCount = rowCount();
+    totalRowCountValid = true;
+    emit totalRowCountUpdated();
+  }
+}
+
+void SqlModel::startTotalCount()
+{
+  countPending = false;
+  countWatcherSql = currentSqlCountQuery;
+  countWatcher.setFuture(QtConcurrent::run(&SqlModel::totalCountThread, db->databaseName(), currentSqlCountQuery));
+}
+
+void SqlModel::totalCountFinished()
+{
+  if(countPending)
+    // Result is outdated
+    startTotalCount();
+  else if(countWatcherSql == currentSqlCountQuery && !totalRowCountValid && !countWatcher.isCanceled())
+  {
+    int count = countWatcher.result();
+    if(count >= 0)
+    {
+      totalRowCount = count;
+      totalRowCountValid = true;
+    }
+    emit totalRowCountUpdated();
+  }
+}
+
+void SqlModel::stopTotalCount()
+{
+  countTimer.stop();
+  countPending = false;
+  countWatcherSql.clear();
+  countWatcher.waitForFinished();
+}
+
+int SqlModel::totalCountThread(const QString& dbFile, const QString& sql)
+{
+  // Statement is kept by the pool and reused when going back to a previous search
+  int count = -1;
+  SqlQuery *countStmt = NavApp::getDatabasePool()->getQuery(dbFile, sql);
+  if(countStmt != nullptr)
+  {
+    try
+    {
+      countStmt->exec();
+      count = countStmt->next() ? countStmt->value(0).toInt() : 0;
+      countStmt->finish();
+    }
+    catch(atools::Exception& e)
+    {
+      qWarning() << Q_FUNC_INFO << "Count failed" << e.what();
+    }
+    catch(...)
+    {
+      qWarning() << Q_FUNC_INFO << "Count failed";
+    }
+  }
+  return count;
 }
 
 /* Build where statement */
@@ -599,6 +812,7 @@ QString SqlModel::buildWhere(const atools::sql::SqlRecord& tableCols, QVector<co
   // Used to build SQL later - does not contain query builder columns and overrides are removed
   QHash<QString, WhereCondition> tempWhereConditionMap(whereConditionMap);
   overrideModeActive = false;
+  whereConnectionLocal = false;
 
   // SQL where clause
   QStringList queryWhereBuilder;
@@ -611,6 +825,7 @@ QString SqlModel::buildWhere(const atools::sql::SqlRecord& tableCols, QVector<co
     {
       // Use builder callback SQL as first clause
       queryWhereBuilder.append(builderResult.getWhere());
+      whereConnectionLocal |= builderResult.isConnectionLocal();
 
       // Check if result overrides due to string length and other conditions exist or bounding query is done
       if(builderResult.isOverrideQuery() && (!whereConditionMap.isEmpty() || isDistanceSearchActive()))
@@ -632,6 +847,35 @@ QString SqlModel::buildWhere(const atools::sql::SqlRecord& tableCols, QVector<co
   if(!queryWhereBuilder.isEmpty())
     queryWhere = '(' % queryWhereBuilder.join(" and ") % ')';
 
+  // Combine checkbox conditions into one bitmask scan if more than one is covered by the feature index =====
+  QSet<QString> featureCondColumns;
+  if(featureIndex != nullptr)
+  {
+    quint64 mask = 0;
+    for(const WhereCondition& cond : qAsConst(tempWhereConditionMap))
+    {
+      int bit = cond.col->isWidgetEnabled() && tableCols.contains(cond.col->getColumnName()) ?
+                featureIndex->bit(cond.col, cond.oper, cond.valueSql) : -1;
+      if(bit != -1)
+      {
+        mask |= 1ULL << bit;
+        featureCondColumns.insert(cond.col->getColumnName());
+      }
+    }
+
+    // A single condition is not faster than the plain column condition
+    QString featureCondition = featureCondColumns.size() > 1 ? featureIndex->condition(mask) : QString();
+    if(!featureCondition.isEmpty())
+    {
+      if(!queryWhere.isEmpty())
+        queryWhere += WHERE_OPERATOR;
+      queryWhere += ' ' % featureCondition % ' ';
+      whereConnectionLocal = true;
+    }
+    else
+      featureCondColumns.clear();
+  }
+
   // Build SQL from where condition objects ================================================
   for(const WhereCondition& cond : tempWhereConditionMap)
   {
@@ -639,6 +883,10 @@ QString SqlModel::buildWhere(const atools::sql::SqlRecord& tableCols, QVector<co
     if(!cond.col->isWidgetEnabled())
       continue;
 
+    // Already covered by feature index
+    if(featureCondColumns.contains(cond.col->getColumnName()))
+      continue;
+
     // Extract the required column from the comment in the operator and  check if it exists in the table
     // Currently used in airport search rating/3d query
     QString checkCol = cond.col->getColumnName();
@@ -657,7 +905,18 @@ QString SqlModel::buildWhere(const atools::sql::SqlRecord& tableCols, QVector<co
     if(!queryWhere.isEmpty())
       queryWhere += WHERE_OPERATOR;
 
-    if(cond.col->isIncludesName())
+    // Use full text index for substring searches if possible
+    QString fullTextCondition;
+    if(fullTextIndex != nullptr && cond.oper.trimmed() == "like" && cond.valueSql.type() == QVariant::String &&
+       fullTextIndex->hasColumn(cond.col->getColumnName()))
+      fullTextCondition = fullTextIndex->condition({cond.col->getColumnName()}, cond.valueSql.toString().replace("'", "''"));
+
+    if(!fullTextCondition.isEmpty())
+    {
+      queryWhere += ' ' % fullTextCondition % ' ';
+      whereConnectionLocal = true;
+    }
+    else if(cond.col->isIncludesName())
       // Condition includes column name
       queryWhere += ' ' % cond.oper % ' ';
     else
@@ -674,7 +933,15 @@ QString SqlModel::buildWhere(const atools::sql::SqlRecord& tableCols, QVector<co
 #endif
 
     QString rectCond;
-    if(boundingRect.crossesAntiMeridian())
+    if(spatialIndex != nullptr)
+      rectCond = spatialIndex->condition(boundingRect);
+
+    if(!rectCond.isEmpty())
+    {
+      rectCond = '(' % rectCond % ')';
+      whereConnectionLocal = true;
+    }
+    else if(boundingRect.crossesAntiMeridian())
     {
       QList<atools::geo::Rect> rect = boundingRect.splitAtAntiMeridian();
 
@@ -693,6 +960,11 @@ QString SqlModel::buildWhere(const atools::sql::SqlRecord& tableCols, QVector<co
     if(!queryWhere.isEmpty())
       queryWhere += WHERE_OPERATOR;
     queryWhere += rectCond;
+
+    // Remove the corners of the rectangle and the inner circle for minimum distance
+    QString distCond = distanceSqlCondition();
+    if(!distCond.isEmpty())
+      queryWhere += WHERE_OPERATOR % distCond;
   }
 
   if(!queryWhere.isEmpty())
@@ -706,6 +978,55 @@ bool SqlModel::isDistanceSearchActive() const
   return boundingRect.isValid() && columns->isDistanceCheckBoxActive();
 }
 
+QString SqlModel::distanceSqlExpression(double cosLat) const
+{
+  // Longitude difference does not work across the anti-meridian
+  if(!distanceCenter.isValid() || boundingRect.crossesAntiMeridian())
+    return QString();
+
+  return QString("((laty - %1) * (laty - %1) + (lonx - %2) * (lonx - %2) * %3)").
+         arg(static_cast<double>(distanceCenter.getLatY()), 0, 'g', 10).
+         arg(static_cast<double>(distanceCenter.getLonX()), 0, 'g', 10).
+         arg(cosLat * cosLat, 0, 'g', 10);
+}
+
+QString SqlModel::distanceSqlCondition() const
+{
+  // Approximation is too inaccurate for large distances and near the poles
+  const float MAX_DISTANCE_NM = 1000.f;
+  const double MAX_LATY = 80.;
+
+  // Safety margins to never remove objects which are accepted by the precise proxy filter
+  const double MAX_MARGIN = 1.1, MIN_MARGIN = 0.9;
+
+  double north = static_cast<double>(boundingRect.getNorth()), south = static_cast<double>(boundingRect.getSouth());
+  if(distanceMaxNm > MAX_DISTANCE_NM || north > MAX_LATY || south < -MAX_LATY)
+    return QString();
+
+  // Cosine for latitude closest to the pole underestimates east-west distances in the rectangle ...
+  double cosPole = std::cos(atools::geo::toRadians(std::max(std::abs(north), std::abs(south))));
+
+  // ... and cosine for latitude closest to the equator overestimates
+  double cosEquator = north > 0. && south < 0. ? 1. : std::cos(atools::geo::toRadians(std::min(std::abs(north), std::abs(south))));
+
+  QStringList conditions;
+  QString maxExpr = distanceSqlExpression(cosPole);
+  if(!maxExpr.isEmpty() && distanceMaxNm > 0.f)
+  {
+    double maxDeg = static_cast<double>(distanceMaxNm) / 60. * MAX_MARGIN;
+    conditions.append(maxExpr % " <= " % QString::number(maxDeg * maxDeg, 'g', 10));
+  }
+
+  QString minExpr = distanceSqlExpression(cosEquator);
+  if(!minExpr.isEmpty() && distanceMinNm > 0.f)
+  {
+    double minDeg = static_cast<double>(distanceMinNm) / 60. * MIN_MARGIN;
+    conditions.append(minExpr % " >= " % QString::number(minDeg * minDeg, 'g', 10));
+  }
+
+  return conditions.isEmpty() ? QString() : '(' % conditions.join(" and ") % ')';
+}
+
 /* Convert a value to string for the where clause */
 QString SqlModel::buildWhereValue(const WhereCondition& cond)
 {
@@ -728,13 +1049,49 @@ void SqlModel::refreshData(bool force)
 
 void SqlModel::resetSqlQuery(bool force)
 {
+  if(isPagedQuery())
+  {
+    // Query model only provides the columns - rows are loaded by the page cache
+    QString sql = currentSqlQuery % " limit 0";
+    if(force || !pagedQuery || QSqlQueryModel::query().lastQuery() != sql)
+    {
+      pageCache->clear();
+      pagedRowCount = 0;
+      try
+      {
+        SqlQuery countStmt(db);
+        countStmt.exec(currentSqlCountQuery);
+        if(countStmt.next())
+          pagedRowCount = countStmt.value(0).toInt();
+      }
+      catch(atools::Exception& e)
+      {
+        ATOOLS_HANDLE_EXCEPTION(e);
+      }
+
+      // Row count has to be valid before the model reset
+      pagedQuery = true;
+      totalRowCount = pagedRowCount;
+      totalRowCountValid = true;
+      QSqlQueryModel::setQuery(sql, db->getQSqlDatabase());
+
+      if(lastError().isValid())
+        atools::gui::ErrorHandler(parentWidget).handleSqlError(lastError());
+      emit totalRowCountUpdated();
+    }
+    return;
+  }
+
   // Update can be forced when changing database rows, for distance search or if the query differs
-  if(force || isDistanceSearchActive() || QSqlQueryModel::query().lastQuery() != currentSqlQuery)
+  if(force || pagedQuery || isDistanceSearchActive() || QSqlQueryModel::query().lastQuery() != currentSqlQuery)
   {
+    pagedQuery = false;
     QSqlQueryModel::setQuery(currentSqlQuery, db->getQSqlDatabase());
 
     if(lastError().isValid())
       atools::gui::ErrorHandler(parentWidget).handleSqlError(lastError());
+    else
+      updateTotalCountFromResult();
   }
 }
 
@@ -755,7 +1112,41 @@ QVariant SqlModel::defaultDataHandler(int, int, const Column *, const QVariant&,
 
 QVariant SqlModel::rawData(const QModelIndex& index) const
 {
-  return index.isValid() ? QSqlQueryModel::data(index, Qt::DisplayRole) : QVariant();
+  return index.isValid() ? sourceData(index, Qt::DisplayRole) : QVariant();
+}
+
+QVariant SqlModel::sourceData(const QModelIndex& index, int role) const
+{
+  if(pagedQuery)
+  {
+    // Same roles as QSqlQueryModel
+    if(role == Qt::DisplayRole || role == Qt::EditRole)
+      return pageCache->value(index.row(), index.column());
+    else
+      return QVariant();
+  }
+  else
+    return QSqlQueryModel::data(index, role);
+}
+
+int SqlModel::rowCount(const QModelIndex& parent) const
+{
+  if(pagedQuery)
+    return parent.isValid() ? 0 : pagedRowCount;
+  else
+    return QSqlQueryModel::rowCount(parent);
+}
+
+bool SqlModel::canFetchMore(const QModelIndex& parent) const
+{
+  // Page cache loads rows on demand
+  return pagedQuery ? false : QSqlQueryModel::canFetchMore(parent);
+}
+
+bool SqlModel::isPagedQuery() const
+{
+  // Proxy model for distance search needs all rows
+  return pageCache != nullptr && !isDistanceSearchActive();
 }
 
 QVariant SqlModel::data(const QModelIndex& index, int role) const
@@ -766,14 +1157,14 @@ QVariant SqlModel::data(const QModelIndex& index, int role) const
   Qt::ItemDataRole dataRole = static_cast<Qt::ItemDataRole>(role);
 
   // Get the default value for this role. Can be a font, color, etc.
-  QVariant roleValue = QSqlQueryModel::data(index, role);
+  QVariant roleValue = sourceData(index, role);
 
   if(handlerRoles.contains(dataRole))
   {
     // Callback wants to be called for this role
 
     // Get data to display
-    QVariant dataValue = QSqlQueryModel::data(index, Qt::DisplayRole);
+    QVariant dataValue = sourceData(index, Qt::DisplayRole);
     QString col = getSqlRecord().fieldName(index.column());
     const Column *column = columns->getColumn(col);
 
@@ -792,6 +1183,9 @@ QVariant SqlModel::data(const QModelIndex& index, int role) const
 void SqlModel::fetchMore(const QModelIndex& parent)
 {
   QSqlQueryModel::fetchMore(parent);
+
+  // Scrolled to the end of the result - rows are known now
+  updateTotalCountFromResult();
   emit fetchedMore();
 }
 
@@ -807,7 +1201,7 @@ void SqlModel::updateSqlQuery()
 
 QVariant SqlModel::getRawData(int row, int col) const
 {
-  return QSqlQueryModel::data(createIndex(row, col));
+  return sourceData(createIndex(row, col), Qt::DisplayRole);
 }
 
 QString SqlModel::getColumnName(int col) const
@@ -856,5 +1250,12 @@ atools::sql::SqlRecord SqlModel::getSqlRecord() const
 
 atools::sql::SqlRecord SqlModel::getSqlRecord(int row) const
 {
-  return atools::sql::SqlRecord(record(row), currentSqlQuery);
+  if(pagedQuery)
+  {
+    QSqlRecord rec = record();
+    pageCache->fillRecord(rec, row);
+    return atools::sql::SqlRecord(rec, currentSqlQuery);
+  }
+  else
+    return atools::sql::SqlRecord(record(row), currentSqlQuery);
 }
@@ -23,6 +23,8 @@
 #include "search/sqlmodeltypes.h"
 
 #include <QSqlQueryModel>
+#include <QFutureWatcher>
+#include <QTimer>
 
 namespace atools {
 namespace sql {
@@ -34,6 +36,10 @@ class SqlRecord;
 
 class Column;
 class ColumnList;
+class FeatureIndex;
+class FullTextIndex;
+class SpatialIndex;
+class SqlPageCache;
 
 /*
  * Extends the QSqlQueryModel and adds query building based on filters and ordering.
@@ -102,11 +108,37 @@ public:
     return orderByColIndex;
   }
 
+  /* Total number of rows in the result. The count is done in background and the number of
+   * currently fetched rows is returned until it is finished. */
   int getTotalRowCount() const
   {
-    return totalRowCount;
+    return totalRowCountValid ? totalRowCount : rowCount();
   }
 
+  /* true if the exact count is not known yet and getTotalRowCount() returns the fetched rows as a lower bound */
+  bool isTotalRowCountEstimated() const
+  {
+    return !totalRowCountValid;
+  }
+
+  /* Wait for a running background row count and discard the result. Call before closing the database. */
+  void stopTotalCount();
+
+  /* Null if not enabled in column list */
+  FullTextIndex *getFullTextIndex() const
+  {
+    return fullTextIndex;
+  }
+
+  /* Drop full text index before the database is closed. Created again on next search. */
+  void clearFullTextIndex();
+
+  /* Drop the temporary bitmask index used for checkbox filters. Created again on next use. */
+  void clearFeatureIndex();
+
+  /* Drop the temporary R*Tree index used for distance search. Created again on next use. */
+  void clearSpatialIndex();
+
   QString getCurrentSqlQuery() const
   {
     return currentSqlQuery;
@@ -115,6 +147,15 @@ public:
   /* Fetch more data and emit signal fetchedMore */
   virtual void fetchMore(const QModelIndex& parent) override;
 
+  /* Number of rows in the page cache for paged models. Otherwise rows fetched by the query model. */
+  virtual int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+  /* Always false for paged models since rows are loaded on demand */
+  virtual bool canFetchMore(const QModelIndex& parent) const override;
+
+  /* Clear query and pages */
+  virtual void clear() override;
+
   /* Get unformatted data from the model */
   QVariant getRawData(int row, int col) const;
   QVariant getRawData(int row, const QString& colname) const;
@@ -125,8 +166,11 @@ public:
   /* Set query to model causing a refresh. Unless force is set the query is compared to the current query and skipped if equal */
   void resetSqlQuery(bool force);
 
-  /* Set a filter for objects within the given bounding rectangle */
-  void filterByBoundingRect(const atools::geo::Rect& boundingRectangle);
+  /* Set a filter for objects within the given bounding rectangle.
+   * A valid center adds an approximate circle filter for the distance range and sorts by approximate distance in SQL.
+   * Precise filtering is still done by the proxy model. */
+  void filterByBoundingRect(const atools::geo::Rect& boundingRectangle, const atools::geo::Pos& center = atools::geo::Pos(),
+                            float minDistanceNm = 0.f, float maxDistanceNm = 0.f);
 
   QString getColumnName(int col) const;
 
@@ -150,6 +194,9 @@ public:
   /* Fetch data without any converts for display role */
   QVariant rawData(const QModelIndex& index) const;
 
+  /* true if rows are loaded by the page cache for the current query */
+  bool isPagedQuery() const;
+
   /*
    * Sets a data callback that is called for each table cell and the given item data roles.
    * @param func callback function or method. Use std::bind to create callbacks to non static methods.
@@ -194,6 +241,9 @@ signals:
   /* One or more columns overrides all other search options */
   void overrideMode(const QStringList& overrideColumnTitles);
 
+  /* Background count query finished and getTotalRowCount() returns the final value */
+  void totalRowCountUpdated();
+
 private:
   // Hide the record method
   using QSqlQueryModel::record;
@@ -221,10 +271,33 @@ private:
   QVariant defaultDataHandler(int, int, const Column *, const QVariant&,
                               const QVariant& displayRoleValue, Qt::ItemDataRole role) const;
   void updateTotalCount();
+
+  /* Values from page cache or query model depending on mode */
+  QVariant sourceData(const QModelIndex& index, int role) const;
+
+  /* Start background count for currentSqlCountQuery and process result */
+  void startTotalCount();
+  void totalCountFinished();
+
+  /* Delay for count timer expired */
+  void countTimeout();
+
+  /* Take the exact count from the result if all rows were fetched with the first page */
+  void updateTotalCountFromResult();
+
+  /* Runs count query in a separate database connection. Returns -1 on error. */
+  static int totalCountThread(const QString& dbFile, const QString& sql);
   void buildSqlWhereValue(QVariant& whereValue, bool exact) const;
   void buildSqlWhereValue(QString& whereValue, bool exact) const;
   bool isDistanceSearchActive() const;
 
+  /* Squared distance in degree using an equirectangular approximation with the given cosine of latitude.
+   * Uses plain arithmetic only and can be used in where and order by clauses. Empty if not applicable. */
+  QString distanceSqlExpression(double cosLat) const;
+
+  /* Circle conditions for the distance range. Empty if not applicable. */
+  QString distanceSqlCondition() const;
+
   /* Default - all conditions are combined using "and" */
   const QString WHERE_OPERATOR = " and ";
 
@@ -241,6 +314,10 @@ private:
   /* A bounding rectangle query is used if this is valid */
   atools::geo::Rect boundingRect;
 
+  /* Center and range of distance search to filter and sort by approximate distance in SQL */
+  atools::geo::Pos distanceCenter;
+  float distanceMinNm = 0.f, distanceMaxNm = 0.f;
+
   QueryBuilder queryBuilder;
 
   /* Maps column name to where condition struct */
@@ -254,9 +331,39 @@ private:
   QWidget *parentWidget;
   int totalRowCount = 0;
 
+  /* false if background count is running and totalRowCount is not valid yet */
+  bool totalRowCountValid = true;
+
+  /* Count query in background thread and the related SQL */
+  QFutureWatcher<int> countWatcher;
+  QString countWatcherSql;
+
+  /* Query changed while count thread was running - start again when done */
+  bool countPending = false;
+
+  /* Defers the exact count while the user is changing filters. Only used if estimating is enabled. */
+  QTimer countTimer;
+  bool estimateCount = true;
+
+  /* Index for substring search in text columns or null */
+  FullTextIndex *fullTextIndex = nullptr;
+  SpatialIndex *spatialIndex = nullptr;
+
+  /* Bitmask index for combined checkbox filters or null */
+  FeatureIndex *featureIndex = nullptr;
+
+  /* Keeps only a window of pages for large tables or null if not enabled in column list.
+   * The query model holds only the column information if pagedQuery is true. */
+  SqlPageCache *pageCache = nullptr;
+  bool pagedQuery = false;
+  int pagedRowCount = 0;
+
   /* Set by buildWhere. Will ignore all other filter options */
   bool overrideModeActive = false;
 
+  /* Set by buildWhere if the clause uses temporary tables of the GUI connection. Count has to run in this connection. */
+  bool whereConnectionLocal = false;
+
   bool restoreFinished = false;
   bool updatingWidgets = false;
 };
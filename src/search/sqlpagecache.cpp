@@ -0,0 +1,169 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+#include "search/sqlpagecache.h"
+
+#include "exception.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlrecord.h"
+
+#include <QDebug>
+#include <QStringBuilder>
+
+using atools::sql::SqlQuery;
+
+SqlPageCache::SqlPageCache(atools::sql::SqlDatabase *sqlDb, int pageSizeParam, int maxPagesParam)
+  : db(sqlDb), pageSize(pageSizeParam), maxPages(maxPagesParam)
+{
+  pages.setMaxCost(maxPages);
+}
+
+void SqlPageCache::setQuery(const QString& selectSqlParam, const QString& whereSqlParam, const QString& orderSqlParam,
+                            const QString& idColumnParam, const QString& keyColumnParam, bool descendingParam, bool keysetParam)
+{
+  selectSql = selectSqlParam;
+  whereSql = whereSqlParam;
+  orderSql = orderSqlParam;
+  idColumn = idColumnParam;
+  keyColumn = keyColumnParam;
+  descending = descendingParam;
+  keyset = keysetParam;
+  clear();
+}
+
+void SqlPageCache::clear()
+{
+  pages.clear();
+  pageKeys.clear();
+}
+
+QVariant SqlPageCache::value(int row, int column)
+{
+  if(row < 0 || column < 0)
+    return QVariant();
+
+  const Page *p = page(row / pageSize);
+  if(p != nullptr)
+  {
+    int pageRow = row % pageSize;
+    if(pageRow < p->size() && column < p->at(pageRow).size())
+      return p->at(pageRow).at(column);
+  }
+  return QVariant();
+}
+
+void SqlPageCache::fillRecord(QSqlRecord& record, int row)
+{
+  for(int i = 0; i < record.count(); i++)
+    record.setValue(i, value(row, i));
+}
+
+const SqlPageCache::Page *SqlPageCache::page(int pageIndex)
+{
+  const Page *p = pages.object(pageIndex);
+  if(p == nullptr)
+    p = loadPage(pageIndex);
+  return p;
+}
+
+QString SqlPageCache::keysetCondition(const PageKey& pageKey) const
+{
+  // SQLite sorts null values first in ascending and last in descending order
+  QString idCond = idColumn % (descending ? " < :lastid" : " > :lastid");
+
+  if(keyColumn.isEmpty())
+    return idCond;
+  else if(pageKey.key.isNull())
+  {
+    if(descending)
+      return "(" % keyColumn % " is null and " % idCond % ')';
+    else
+      return "(" % keyColumn % " is not null or " % idCond % ')';
+  }
+  else
+  {
+    if(descending)
+      return "(" % keyColumn % " < :lastkey or " % keyColumn % " is null or (" % keyColumn % " = :lastkey and " % idCond % "))";
+    else
+      return "(" % keyColumn % " > :lastkey or (" % keyColumn % " = :lastkey and " % idCond % "))";
+  }
+}
+
+SqlPageCache::Page *SqlPageCache::loadPage(int pageIndex)
+{
+  if(selectSql.isEmpty())
+    return nullptr;
+
+  Page *p = new Page;
+  try
+  {
+    // Use keys of the previous page if known
+    bool useKeyset = keyset && pageIndex > 0 && pageKeys.contains(pageIndex - 1);
+    PageKey prevKey = useKeyset ? pageKeys.value(pageIndex - 1) : PageKey();
+
+    QString sql = selectSql;
+    if(useKeyset)
+      sql += whereSql.isEmpty() ? " where " % keysetCondition(prevKey) : ' ' % whereSql % " and " % keysetCondition(prevKey);
+    else
+      sql += ' ' % whereSql;
+
+    sql += ' ' % orderSql % " limit " % QString::number(pageSize);
+    if(!useKeyset && pageIndex > 0)
+      sql += " offset " % QString::number(pageIndex * pageSize);
+
+    SqlQuery query(db);
+    query.prepare(sql);
+    if(useKeyset)
+    {
+      query.bindValue(":lastid", prevKey.id);
+      if(!keyColumn.isEmpty() && !prevKey.key.isNull())
+        query.bindValue(":lastkey", prevKey.key);
+    }
+    query.exec();
+
+    atools::sql::SqlRecord rec = query.record();
+    int numCols = rec.count();
+    int idIndex = rec.indexOf(idColumn);
+    int keyIndex = keyColumn.isEmpty() ? -1 : rec.indexOf(keyColumn);
+
+    p->reserve(pageSize);
+    while(query.next())
+    {
+      QVector<QVariant> row(numCols);
+      for(int i = 0; i < numCols; i++)
+        row[i] = query.value(i);
+      p->append(row);
+    }
+
+    // Remember last keys for the next page - keyset paging is not possible if columns are missing
+    if(!p->isEmpty() && idIndex != -1 && (keyColumn.isEmpty() || keyIndex != -1))
+      pageKeys.insert(pageIndex, {keyIndex != -1 ? p->constLast().at(keyIndex) : QVariant(), p->constLast().at(idIndex)});
+  }
+  catch(atools::Exception& e)
+  {
+    // Called from model data functions - do not show dialogs here
+    qWarning() << Q_FUNC_INFO << "Loading page" << pageIndex << "failed" << e.what();
+  }
+  catch(...)
+  {
+    qWarning() << Q_FUNC_INFO << "Loading page" << pageIndex << "failed";
+  }
+
+  // Cache takes ownership and might delete the page immediately if it is too large
+  pages.insert(pageIndex, p, 1);
+  return pages.object(pageIndex);
+}
@@ -0,0 +1,111 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+#ifndef LNM_SQLPAGECACHE_H
+#define LNM_SQLPAGECACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QSqlRecord>
+#include <QVariant>
+#include <QVector>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+/*
+ * Keeps a sliding window of result pages for a query instead of the whole result set.
+ * Pages are loaded on demand when a row is accessed and the least recently used pages are evicted.
+ *
+ * Pages following an already loaded page are fetched by keyset ("where key > last key") which
+ * avoids scanning all previous rows. Other pages like the target of a scroll bar jump are
+ * fetched using "offset".
+ *
+ * The order has to end with the id column to get a stable order for keyset paging.
+ */
+class SqlPageCache
+{
+public:
+  /*
+   * @param sqlDb database to use
+   * @param pageSizeParam number of rows in a page
+   * @param maxPagesParam number of pages kept in memory
+   */
+  SqlPageCache(atools::sql::SqlDatabase *sqlDb, int pageSizeParam, int maxPagesParam);
+
+  SqlPageCache(const SqlPageCache& other) = delete;
+  SqlPageCache& operator=(const SqlPageCache& other) = delete;
+
+  /*
+   * Set new query and clear all pages.
+   * @param selectSqlParam "select ... from table" without where and order clause
+   * @param whereSqlParam where clause including "where" or empty
+   * @param orderSqlParam order clause including "order by" which has to end with the id column
+   * @param idColumnParam id column used as tie breaker. Has to be part of the selected columns.
+   * @param keyColumnParam plain column used for sorting before id or empty if sorted by id only
+   * @param descendingParam sort order for key column and id
+   * @param keysetParam false if sorted by function so that only offset can be used
+   */
+  void setQuery(const QString& selectSqlParam, const QString& whereSqlParam, const QString& orderSqlParam,
+                const QString& idColumnParam, const QString& keyColumnParam, bool descendingParam, bool keysetParam);
+
+  /* Remove all pages. Query is kept. */
+  void clear();
+
+  /* Value for row and column. Loads the page if needed. Invalid if out of range. */
+  QVariant value(int row, int column);
+
+  /* Fill values of row into the given record which has to contain the fields of the query */
+  void fillRecord(QSqlRecord& record, int row);
+
+  int getPageSize() const
+  {
+    return pageSize;
+  }
+
+private:
+  typedef QVector<QVector<QVariant> > Page;
+
+  /* Last key and id of a page which are used to fetch the following page */
+  struct PageKey
+  {
+    QVariant key, id;
+  };
+
+  /* Get page from cache or load it. Returns null on error. */
+  const Page *page(int pageIndex);
+  Page *loadPage(int pageIndex);
+
+  /* Condition selecting all rows after key */
+  QString keysetCondition(const PageKey& pageKey) const;
+
+  atools::sql::SqlDatabase *db;
+  int pageSize, maxPages;
+
+  QString selectSql, whereSql, orderSql, idColumn, keyColumn;
+  bool descending = false, keyset = true;
+
+  /* Page index to rows */
+  QCache<int, Page> pages;
+
+  /* Keys are kept for evicted pages too since they are small */
+  QHash<int, PageKey> pageKeys;
+};
+
+#endif // LNM_SQLPAGECACHE_H
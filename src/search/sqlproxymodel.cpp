@@ -21,6 +21,7 @@
 #include "search/sqlmodel.h"
 #include "common/unit.h"
 #include "common/mapflags.h"
+#include "common/geobatch.h"
 
 #include <QApplication>
 
@@ -29,6 +30,18 @@ using namespace atools::geo;
 SqlProxyModel::SqlProxyModel(QObject *parent, SqlModel *sqlModel)
   : QSortFilterProxyModel(parent), sourceSqlModel(sqlModel)
 {
+  // Row positions are not valid anymore
+  connect(sourceSqlModel, &QAbstractItemModel::modelReset, this, &SqlProxyModel::clearRowCache);
+  connect(sourceSqlModel, &QAbstractItemModel::layoutChanged, this, &SqlProxyModel::clearRowCache);
+  connect(sourceSqlModel, &QAbstractItemModel::rowsRemoved, this, &SqlProxyModel::clearRowCache);
+  connect(sourceSqlModel, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex&, int first, int) {
+    // Rows are usually appended by fetchMore() - keep cached values before the first new row
+    if(first < rowDistances.size())
+    {
+      rowDistances.resize(first);
+      rowCourses.resize(first);
+    }
+  });
 }
 
 SqlProxyModel::~SqlProxyModel()
@@ -43,11 +56,51 @@ void SqlProxyModel::setDistanceFilter(const Pos& center, sqlmodeltypes::SearchDi
   maxDistMeter = nmToMeter(maxDistance);
   centerPos = center;
   direction = dir;
+  clearRowCache();
 }
 
 void SqlProxyModel::clearDistanceFilter()
 {
   centerPos = Pos();
+  clearRowCache();
+}
+
+void SqlProxyModel::clearRowCache()
+{
+  rowDistances.clear();
+  rowCourses.clear();
+}
+
+void SqlProxyModel::updateRowCache(int row) const
+{
+  int first = rowDistances.size();
+  if(row < first)
+    return;
+
+  // Calculate distance and course for all rows not cached yet in one batch
+  int num = std::max(sourceSqlModel->rowCount(), row + 1);
+  geobatch::PosBatch batch(num - first);
+  for(int i = first; i < num; i++)
+    batch.append(buildPos(i));
+
+  QVector<float> distances, courses;
+  batch.distancesMeter(distances, centerPos);
+  batch.coursesDeg(courses, centerPos);
+
+  rowDistances.append(distances);
+  rowCourses.append(courses);
+}
+
+float SqlProxyModel::distanceMeterForRow(int row) const
+{
+  updateRowCache(row);
+  return rowDistances.at(row);
+}
+
+float SqlProxyModel::courseDegForRow(int row) const
+{
+  updateRowCache(row);
+  return rowCourses.at(row);
 }
 
 /* Does the filtering by minimum and maximum distance and direction */
@@ -56,48 +109,47 @@ bool SqlProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex&) const
   if(sourceSqlModel->isOverrideModeActive())
     return true;
 
-  Pos pos = buildPos(sourceRow);
-  float heading = normalizeCourse(centerPos.angleDegTo(pos));
+  float heading = courseDegForRow(sourceRow);
+  float distMeter = distanceMeterForRow(sourceRow);
 
   switch(direction)
   {
     case sqlmodeltypes::ALL:
       // All directions
-      return matchDistance(pos);
+      return matchDistance(distMeter);
 
     case sqlmodeltypes::NORTH:
       if(MIN_NORTH_DEG <= heading || heading <= MAX_NORTH_DEG)
-        return matchDistance(pos);
+        return matchDistance(distMeter);
       else
         return false;
 
     case sqlmodeltypes::EAST:
       if(MIN_EAST_DEG <= heading && heading <= MAX_EAST_DEG)
-        return matchDistance(pos);
+        return matchDistance(distMeter);
       else
         return false;
 
     case sqlmodeltypes::SOUTH:
       if(MIN_SOUTH_DEG <= heading && heading <= MAX_SOUTH_DEG)
-        return matchDistance(pos);
+        return matchDistance(distMeter);
       else
         return false;
 
     case sqlmodeltypes::WEST:
       if(MIN_WEST_DEG <= heading && heading <= MAX_WEST_DEG)
-        return matchDistance(pos);
+        return matchDistance(distMeter);
       else
         return false;
   }
   return true;
 }
 
-bool SqlProxyModel::matchDistance(const Pos& pos) const
+bool SqlProxyModel::matchDistance(float distMeter) const
 {
   if(sourceSqlModel->isOverrideModeActive())
     return true;
 
-  float distMeter = pos.distanceMeterTo(centerPos);
   return distMeter >= minDistMeter && distMeter <= maxDistMeter;
 }
 
@@ -133,16 +185,12 @@ bool SqlProxyModel::lessThan(const QModelIndex& sourceLeft, const QModelIndex& s
   if(leftCol == "distance" && rightCol == "distance")
   {
     // Sort by distance
-    float distLeft = buildPos(sourceLeft.row()).distanceMeterTo(centerPos);
-    float distRight = buildPos(sourceRight.row()).distanceMeterTo(centerPos);
-    return distLeft < distRight;
+    return distanceMeterForRow(sourceLeft.row()) < distanceMeterForRow(sourceRight.row());
   }
   else if(leftCol == "heading" && rightCol == "heading")
   {
     // Sort by heading
-    float headingLeft = normalizeCourse(centerPos.angleDegTo(buildPos(sourceLeft.row())));
-    float headingRight = normalizeCourse(centerPos.angleDegTo(buildPos(sourceRight.row())));
-    return headingLeft < headingRight;
+    return courseDegForRow(sourceLeft.row()) < courseDegForRow(sourceRight.row());
   }
   else
   {
@@ -168,7 +216,7 @@ QVariant SqlProxyModel::data(const QModelIndex& index, int role) const
   if(sourceSqlModel->getColumnName(index.column()) == "distance")
   {
     if(role == Qt::DisplayRole)
-      return Unit::distMeter(buildPos(mapToSource(index).row()).distanceMeterTo(centerPos), false);
+      return Unit::distMeter(distanceMeterForRow(mapToSource(index).row()), false);
     else if(role == Qt::TextAlignmentRole)
       return Qt::AlignRight;
   }
@@ -176,7 +224,7 @@ QVariant SqlProxyModel::data(const QModelIndex& index, int role) const
   {
     if(role == Qt::DisplayRole)
     {
-      float heading = normalizeCourse(centerPos.angleDegTo(buildPos(mapToSource(index).row())));
+      float heading = courseDegForRow(mapToSource(index).row());
       if(heading < map::INVALID_COURSE_VALUE)
         return QLocale().toString(heading, 'f', 0);
       else
@@ -62,9 +62,15 @@ private:
   virtual bool filterAcceptsRow(int sourceRow, const QModelIndex&) const override;
   virtual bool lessThan(const QModelIndex& sourceLeft, const QModelIndex& sourceRight) const override;
 
-  bool matchDistance(const atools::geo::Pos& pos) const;
+  bool matchDistance(float distMeter) const;
   atools::geo::Pos buildPos(int row) const;
 
+  /* Distance and course from center position to source row. Calculated in batches for all loaded rows on demand. */
+  float distanceMeterForRow(int row) const;
+  float courseDegForRow(int row) const;
+  void updateRowCache(int row) const;
+  void clearRowCache();
+
   /* Direction filter ranges are decreased by this value on each side */
   static float Q_DECL_CONSTEXPR DIR_RANGE_DEG = 22.5f;
 
@@ -79,6 +85,9 @@ private:
   sqlmodeltypes::SearchDirection direction;
   float minDistMeter = 0.f, maxDistMeter = 0.f;
 
+  /* Cached values by source row index */
+  mutable QVector<float> rowDistances, rowCourses;
+
 };
 
 #endif // LITTLENAVMAP_SQLPROXYMODEL_H
@@ -101,6 +101,9 @@ UserdataSearch::UserdataSearch(QMainWindow *parent, QTableView *tableView, si::T
   iconDelegate = new UserIconDelegate(columns, NavApp::getUserdataIcons());
   view->setItemDelegateForColumn(columns->getColumn("type")->getIndex(), iconDelegate);
 
+  // Large imports can contain many thousand points - keep only visible pages in memory
+  columns->setPagedModel(true);
+
   SearchBaseTable::initViewAndController(NavApp::getDatabaseUser());
 
   // Add model data handler and model format handler as callbacks
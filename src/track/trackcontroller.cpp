@@ -19,10 +19,12 @@
 
 #include "atools.h"
 #include "common/constants.h"
+#include "common/stallmonitor.h"
 #include "gui/dialog.h"
 #include "gui/mainwindow.h"
 #include "gui/widgetstate.h"
 #include "app/navapp.h"
+#include "query/querytypes.h"
 #include "settings/settings.h"
 #include "settings/settings.h"
 #include "track/trackdownloader.h"
@@ -109,6 +111,7 @@ void TrackController::postDatabaseLoad()
   {
     emit preTrackLoad();
     trackManager->loadTracks(trackVector, downloadOnlyValid);
+    query::incrementRevision(query::REV_TRACKS);
     emit postTrackLoad();
   }
 }
@@ -148,6 +151,7 @@ void TrackController::deleteTracks()
 
   emit preTrackLoad();
   trackManager->clearTracks();
+  query::incrementRevision(query::REV_TRACKS);
   emit postTrackLoad();
 
   NavApp::setStatusMessage(tr("Tracks deleted."));
@@ -177,6 +181,8 @@ bool TrackController::hasTracks() const
 
 void TrackController::trackDownloadFinished(const atools::track::TrackVectorType& tracks, atools::track::TrackType type)
 {
+  LNM_STALL_SCOPE;
+
   qDebug() << Q_FUNC_INFO << static_cast<int>(type) << "size" << tracks.size();
 
   // Remove finished type from queue and append to vector
@@ -255,6 +261,9 @@ void TrackController::trackDownloadFailed(const QString& error, int errorCode, Q
 
 void TrackController::tracksLoaded()
 {
+  // Invalidate merged track and airway results in all track query objects and their copies
+  query::incrementRevision(query::REV_TRACKS);
+
   QMap<atools::track::TrackType, int> numTracks = trackManager->getNumTracks();
 
   const QStringList& errorMessages = trackManager->getErrorMessages();
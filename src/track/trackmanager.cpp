@@ -122,6 +122,9 @@ void TrackManager::loadTracks(const TrackVectorType& tracks, bool onlyValid)
   // Maps name to a fragment number for airway compatibility which needs name and fragment as a key
   QHash<QString, int> nameFragmentHash;
 
+  // Track segments collected in memory and written in one batch at the end
+  QList<SqlRecord> trackRecords;
+
   QDateTime now = QDateTime::currentDateTimeUtc();
   // Read each track into the database ==================================================
   for(const Track& track : tracks)
@@ -243,8 +246,8 @@ void TrackManager::loadTracks(const TrackVectorType& tracks, bool onlyValid)
         trackRec.setValue("to_lonx", ref.position.getLonX());
         trackRec.setValue("to_laty", ref.position.getLatY());
 
-        // Insert into database
-        insertOneRecord(trackRec);
+        // Keep a copy for batch insert
+        trackRecords.append(trackRec);
 
         // Set all to null
         trackRec.clearValues();
@@ -271,6 +274,9 @@ void TrackManager::loadTracks(const TrackVectorType& tracks, bool onlyValid)
   if(verbose)
     qDebug() << Q_FUNC_INFO << "after loading tracks" << timer.restart();
 
+  // Write collected track segments into database
+  insertRecords(trackRecords, "track");
+
   // Write collected trackpoints into database
   insertRecords(trackpoints.values(), "trackpoint");
 
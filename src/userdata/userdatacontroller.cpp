@@ -21,6 +21,7 @@
 #include "common/constants.h"
 #include "common/mapresult.h"
 #include "common/maptypesfactory.h"
+#include "db/bulkimporter.h"
 #include "db/undoredoprogress.h"
 #include "exception.h"
 #include "fs/userdata/userdatamanager.h"
@@ -33,6 +34,7 @@
 #include "app/navapp.h"
 #include "gui/sqlquerydialog.h"
 #include "options/optiondata.h"
+#include "query/querytypes.h"
 #include "search/searchcontroller.h"
 #include "search/userdatasearch.h"
 #include "settings/settings.h"
@@ -44,6 +46,7 @@
 #include "userdata/userdataicons.h"
 #include "common/unit.h"
 
+#include <QDateTime>
 #include <QDebug>
 #include <QProcessEnvironment>
 #include <QStandardPaths>
@@ -63,6 +66,10 @@ UserdataController::UserdataController(atools::fs::userdata::UserdataManager *us
   icons->loadIcons();
   lastAddedRecord = new SqlRecord();
 
+  // Invalidate caches depending on userpoints before any other receiver is notified
+  connect(this, &UserdataController::userdataChanged, this, []() -> void {
+    query::incrementRevision(query::REV_USERPOINTS);
+  });
   connect(this, &UserdataController::userdataChanged, manager, &atools::sql::DataManagerBase::updateUndoRedoActions);
 
   Ui::MainWindow *ui = NavApp::getMainUi();
@@ -668,11 +675,20 @@ void UserdataController::importCsv()
 
     if(!files.isEmpty())
     {
-      QGuiApplication::setOverrideCursor(Qt::WaitCursor);
-      SqlTransaction transaction(manager->getDatabase());
-      int numImported = manager->importCsv(files, atools::fs::userdata::NONE, ',', '"');
-      transaction.commit();
-      QGuiApplication::restoreOverrideCursor();
+      // Stream files in a background thread and insert in one transaction
+      BulkImporter importer(mainWindow, manager->getDatabase(), "userdata",
+                            {"type", "name", "ident", "laty", "lonx", "altitude", "tags", "description", "region",
+                             "visible_from", "last_edit_timestamp", "import_file_path"}, csvRowToUserpoint);
+      int numImported = importer.importFiles(files, tr("%1 - Importing Userpoints").arg(QApplication::applicationName()));
+
+      if(numImported == -1)
+      {
+        mainWindow->setStatusMessage(tr("Userpoint import canceled."));
+        return;
+      }
+
+      if(importer.getNumSkipped() > 0)
+        qWarning() << Q_FUNC_INFO << "Skipped" << importer.getNumSkipped() << "invalid rows";
 
       mainWindow->setStatusMessage(tr("%n userpoint(s) imported.", "", numImported));
       if(numImported > 0)
@@ -697,6 +713,36 @@ void UserdataController::importCsv()
   }
 }
 
+bool UserdataController::csvRowToUserpoint(const QStringList& row, const QString& filename, QVariantList& values)
+{
+  // Type,Name,Ident,Latitude,Longitude,Elevation,Magnetic declination,Tags,Description,Region,Visible from,Last edit,Import filename
+  bool okLat, okLon;
+  float laty = row.value(3).trimmed().toFloat(&okLat), lonx = row.value(4).trimmed().toFloat(&okLon);
+
+  // Skips also header line
+  if(!okLat || !okLon || laty < -90.f || laty > 90.f || lonx < -180.f || lonx > 180.f)
+    return false;
+
+  QString type = row.value(0).trimmed();
+  QDateTime lastEdit = QDateTime::fromString(row.value(11).trimmed(), Qt::ISODate);
+  bool okVisible;
+  int visibleFrom = row.value(10).trimmed().toInt(&okVisible);
+
+  values = {type.isEmpty() ? QString(UserdataDialog::DEFAULT_TYPE) : type,
+            row.value(1).trimmed(),
+            row.value(2).trimmed(),
+            laty,
+            lonx,
+            row.value(5).trimmed().toFloat(),
+            row.value(7).trimmed(),
+            row.value(8),
+            row.value(9).trimmed(),
+            okVisible ? visibleFrom : 250,
+            lastEdit.isValid() ? lastEdit : QDateTime::currentDateTime(),
+            row.value(12).trimmed().isEmpty() ? filename : row.value(12).trimmed()};
+  return true;
+}
+
 void UserdataController::importXplaneUserFixDat()
 {
   qDebug() << Q_FUNC_INFO;
@@ -20,6 +20,7 @@
 
 #include <QObject>
 #include <QVector>
+#include <QVariantList>
 
 namespace atools {
 namespace sql {
@@ -175,6 +176,9 @@ private:
   /* Get default X-Plane path to user_fix.dat file */
   QString xplaneUserWptDatPath();
 
+  /* Converts one row of a userpoint CSV file for BulkImporter. Called in the reader thread. */
+  static bool csvRowToUserpoint(const QStringList& row, const QString& filename, QVariantList& values);
+
   /* Get default Garmin GTN export path */
   QString garminGtnUserWptPath();
 
@@ -17,6 +17,7 @@
 
 #include "userdata/userdataicons.h"
 
+#include "common/memoryregistry.h"
 #include "settings/settings.h"
 #include "atools.h"
 
@@ -126,11 +127,16 @@ QString UserdataIcons::translatedToType(const QString& type)
 
 UserdataIcons::UserdataIcons()
 {
-
+  MemoryRegistry::registerCaches(this, [this](QVector<memreg::Usage>& usage) -> void {
+    usage.append(memreg::pixmapCacheUsage("Icons", "Userpoints", pixmapCache));
+  }, [this]() -> void {
+    pixmapCache.clear();
+  });
 }
 
 UserdataIcons::~UserdataIcons()
 {
+  MemoryRegistry::unregisterCaches(this);
   pixmapCache.clear();
 }
 
@@ -44,6 +44,25 @@ struct WeatherContext
 
 QDebug operator<<(QDebug out, const map::WeatherContext& record);
 
+/*
+ * Values of a parsed METAR needed for map symbols and wind. Kept per airport by the WeatherReporter
+ * to avoid copying the full METAR for each airport and frame.
+ */
+struct AirportWeatherSummary
+{
+  float prevailingWindDir = 0.f, prevailingWindSpeedKts = 0.f, gustSpeedKts = 0.f, windSpeedKts = 0.f;
+  int windDir = -1;
+  qint8 flightRules = 0, maxCoverage = 0;
+  bool valid = false; /* Airport has a METAR */
+  bool loaded = false; /* Filled from METAR - used by the reporter only */
+
+  bool isValid() const
+  {
+    return valid;
+  }
+
+};
+
 } // namespace map
 
 #endif // LNM_WEATHERCONTEXT_H
@@ -21,6 +21,8 @@
 #include "common/constants.h"
 #include "common/maptools.h"
 #include "common/maptypes.h"
+#include "common/memoryregistry.h"
+#include "common/stallmonitor.h"
 #include "connect/connectclient.h"
 #include "fs/weather/metar.h"
 #include "fs/weather/metarparser.h"
@@ -33,6 +35,7 @@
 #include "options/optiondata.h"
 #include "query/airportquery.h"
 #include "query/infoquery.h"
+#include "query/querytypes.h"
 #include "settings/settings.h"
 #include "util/filesystemwatcher.h"
 #include "util/filechecker.h"
@@ -42,9 +45,12 @@
 #include <QTimer>
 #include <QRegularExpression>
 #include <QStringBuilder>
+#include <QtConcurrent/QtConcurrentRun>
 
 #if defined(Q_OS_WIN32)
 #include <QProcessEnvironment>
+
+#include <algorithm>
 #endif
 
 // Checks the first line of an ASN file if it has valid content
@@ -84,6 +90,12 @@ WeatherReporter::WeatherReporter(MainWindow *parentWindow, atools::fs::FsPaths::
   onlineWeatherTimeoutSecs = atools::settings::Settings::instance().valueInt(lnm::OPTIONS_WEATHER_UPDATE, 600);
 
   verbose = Settings::instance().getAndStoreValue(lnm::OPTIONS_WEATHER_DEBUG, false).toBool();
+  metarCache.setMaxCost(Settings::instance().getAndStoreValue(lnm::OPTIONS_WEATHER_METAR_CACHE, 2000).toInt());
+
+  // Invalidate caches depending on weather before any other receiver is notified
+  connect(this, &WeatherReporter::weatherUpdated, this, []() -> void {
+    query::incrementRevision(query::REV_WEATHER);
+  });
 
   auto coordFunc = std::bind(&WeatherReporter::fetchAirportCoordinates, this, std::placeholders::_1);
 
@@ -120,6 +132,18 @@ WeatherReporter::WeatherReporter(MainWindow *parentWindow, atools::fs::FsPaths::
 
   connect(xpWeatherReader, &atools::fs::weather::XpWeatherReader::weatherUpdated, this, &WeatherReporter::xplaneWeatherFileChanged);
 
+  // Simulators and Active Sky write files in several steps - read once after changes settled
+  activeSkyReloadTimer.setSingleShot(true);
+  activeSkyReloadTimer.setInterval(1000);
+  connect(&activeSkyReloadTimer, &QTimer::timeout, this, &WeatherReporter::activeSkyReloadTimeout);
+
+  xplaneUpdateTimer.setSingleShot(true);
+  xplaneUpdateTimer.setInterval(500);
+  connect(&xplaneUpdateTimer, &QTimer::timeout, this, &WeatherReporter::xplaneUpdateTimeout);
+
+  connect(&activeSkySnapshotWatcher, &QFutureWatcher<QHash<QString, QString> >::finished,
+          this, &WeatherReporter::activeSkySnapshotLoaded);
+
   // Forward signals from clients for updates
   connect(noaaWeather, &NoaaWeatherDownloader::weatherUpdated, this, &WeatherReporter::noaaWeatherUpdated);
   connect(vatsimWeather, &WeatherNetDownload::weatherUpdated, this, &WeatherReporter::vatsimWeatherUpdated);
@@ -139,10 +163,25 @@ WeatherReporter::WeatherReporter(MainWindow *parentWindow, atools::fs::FsPaths::
   connect(noaaWeather, &NoaaWeatherDownloader::weatherDownloadProgress, this, &WeatherReporter::weatherDownloadProgress);
   connect(vatsimWeather, &WeatherNetDownload::weatherDownloadProgress, this, &WeatherReporter::weatherDownloadProgress);
   connect(ivaoWeather, &WeatherNetDownload::weatherDownloadProgress, this, &WeatherReporter::weatherDownloadProgress);
+
+  // Parsed METARs for all stations of an airport
+  MemoryRegistry::registerCaches(this, [this](QVector<memreg::Usage>& usage) -> void {
+    usage.append(memreg::cacheUsage("Weather", "METAR", metarCache, 4096));
+    usage.append(memreg::usage("Weather", "METAR summaries", summariesStation.size() + summariesNearest.size(),
+                               sizeof(map::AirportWeatherSummary)));
+  }, [this]() -> void {
+    metarCache.clear();
+    summariesStation.clear();
+    summariesNearest.clear();
+  });
 }
 
 WeatherReporter::~WeatherReporter()
 {
+  MemoryRegistry::unregisterCaches(this);
+  activeSkyReloadTimer.stop();
+  xplaneUpdateTimer.stop();
+  activeSkySnapshotWatcher.waitForFinished();
   deleteActiveSkyFsWatcher();
 
   qDebug() << Q_FUNC_INFO << "delete noaaWeather";
@@ -180,18 +219,27 @@ void WeatherReporter::weatherDownloadProgress(qint64 bytesReceived, qint64 bytes
 
 void WeatherReporter::noaaWeatherUpdated()
 {
+  LNM_STALL_SCOPE;
+
+  clearMetarCache();
   mainWindow->setStatusMessage(tr("NOAA weather downloaded."), true /* addToLog */);
   emit weatherUpdated();
 }
 
 void WeatherReporter::ivaoWeatherUpdated()
 {
+  LNM_STALL_SCOPE;
+
+  clearMetarCache();
   mainWindow->setStatusMessage(tr("IVAO weather downloaded."), true /* addToLog */);
   emit weatherUpdated();
 }
 
 void WeatherReporter::vatsimWeatherUpdated()
 {
+  LNM_STALL_SCOPE;
+
+  clearMetarCache();
   mainWindow->setStatusMessage(tr("VATSIM weather downloaded."), true /* addToLog */);
   emit weatherUpdated();
 }
@@ -243,8 +291,8 @@ void WeatherReporter::createActiveSkyFsWatcher()
   // Set path only if valid to avoid recursion through paint routine if files are not available
   if(asSnapshotPathChecker->checkFile(Q_FUNC_INFO, asSnapshotPath, false /* warn */))
   {
-    // Call notification direct
-    activeSkyWeatherFilesChanged({asSnapshotPath});
+    // Load directly since values are needed now
+    updateActiveSkyWeather();
 
     fsWatcherAsPath->setFilenameAndStart(asSnapshotPath);
   }
@@ -359,6 +407,10 @@ void WeatherReporter::initActiveSkyPaths()
 {
   deleteActiveSkyFsWatcher();
 
+  // Drop pending reloads and results of a running read
+  activeSkyReloadTimer.stop();
+  activeSkySnapshotLoadingPath.clear();
+
   activeSkyType = NONE;
   activeSkyMetars.clear();
   activeSkyDepartureMetar.clear();
@@ -495,37 +547,61 @@ void WeatherReporter::loadActiveSkySnapshot(const QString& path)
   if(path.isEmpty())
     return;
 
+  // Keep previous values if file cannot be read
+  QHash<QString, QString> metars = readActiveSkySnapshot(path);
+  if(!metars.isEmpty())
+    activeSkyMetars.swap(metars);
+}
+
+QHash<QString, QString> WeatherReporter::readActiveSkySnapshot(const QString& path)
+{
+  QHash<QString, QString> metars;
   QFile file(path);
-  if(file.open(QIODevice::ReadOnly | QIODevice::Text))
+  if(file.open(QIODevice::ReadOnly))
   {
-    int num = 0;
-    activeSkyMetars.clear();
-
-    QTextStream weatherSnapshot(&file);
-
-    int lineNum = 1;
-    QString line;
-    while(weatherSnapshot.readLineInto(&line))
+    // Map file into memory to avoid copying the large file into a buffer
+    qint64 size = file.size();
+    const char *data = size > 0 ? reinterpret_cast<const char *>(file.map(0, size)) : nullptr;
+    if(data != nullptr)
     {
-      QStringList list = line.split("::");
-      if(list.size() >= 2)
-      {
-        num++;
-        activeSkyMetars.insert(list.at(0), list.at(1));
-      }
-      else
+      metars.reserve(static_cast<int>(size / 200));
+
+      int lineNum = 1;
+      const char *end = data + size;
+      for(const char *line = data; line < end; lineNum++)
       {
-        qWarning() << Q_FUNC_INFO << "AS file" << file.fileName() << "has invalid entries";
-        qWarning() << Q_FUNC_INFO << "line #" << lineNum << line;
+        const char *lineEnd = std::find(line, end, '\n');
+
+        // Strip Windows line endings
+        const char *lastChar = lineEnd > line && *(lineEnd - 1) == '\r' ? lineEnd - 1 : lineEnd;
+
+        // Ident and METAR are separated by "::" - ignore the rest
+        const char *sep = std::search(line, lastChar, "::", "::" + 2);
+        if(sep < lastChar)
+        {
+          const char *metarStart = sep + 2;
+          const char *metarEnd = std::search(metarStart, lastChar, "::", "::" + 2);
+          metars.insert(QString::fromLatin1(line, static_cast<int>(sep - line)),
+                        QString::fromLatin1(metarStart, static_cast<int>(metarEnd - metarStart)));
+        }
+        else if(lastChar > line)
+        {
+          qWarning() << Q_FUNC_INFO << "AS file" << file.fileName() << "has invalid entries";
+          qWarning() << Q_FUNC_INFO << "line #" << lineNum << QString::fromLatin1(line, static_cast<int>(lastChar - line));
+        }
+        line = lineEnd + 1;
       }
-      lineNum++;
+      file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(data)));
     }
+    else
+      qWarning() << Q_FUNC_INFO << "cannot map" << file.fileName() << "reason" << file.errorString();
     file.close();
 
-    qDebug() << Q_FUNC_INFO << "Loaded" << num << "METARs";
+    qDebug() << Q_FUNC_INFO << "Loaded" << metars.size() << "METARs";
   }
-  else if(verbose)
+  else
     qWarning() << Q_FUNC_INFO << "cannot open" << file.fileName() << "reason" << file.errorString();
+  return metars;
 }
 
 /* Loads flight plan weather for start and destination */
@@ -835,11 +911,118 @@ atools::fs::weather::MetarResult WeatherReporter::getIvaoMetar(const QString& ai
   return ivaoWeather->getMetar(airportIcao, pos);
 }
 
+static QString metarCacheKey(map::MapWeatherSource source, bool stationOnly, const QString& ident)
+{
+  return QString::number(source) % (stationOnly ? "|S|" : "|N|") % ident;
+}
+
+bool WeatherReporter::isCacheable(map::MapWeatherSource source) const
+{
+  // Weather from FSX/P3D via connection changes without notification and is cached in ConnectClient
+  return source != map::WEATHER_SOURCE_DISABLED &&
+         (source != map::WEATHER_SOURCE_SIMULATOR || atools::fs::FsPaths::isAnyXplane(NavApp::getCurrentSimulatorDb()));
+}
+
 atools::fs::weather::Metar WeatherReporter::getAirportWeather(const map::MapAirport& airport, bool stationOnly)
+{
+  map::MapWeatherSource source = NavApp::getMapWeatherSource();
+
+  if(!isCacheable(source))
+    return getAirportWeatherInternal(airport, stationOnly, source);
+
+  const QString key = metarCacheKey(source, stationOnly, airport.metarIdent());
+  const Metar *cached = metarCache.object(key);
+  if(cached != nullptr)
+    return *cached;
+
+  Metar *metar = new Metar(getAirportWeatherInternal(airport, stationOnly, source));
+  Metar retval(*metar);
+  metarCache.insert(key, metar);
+  return retval;
+}
+
+/* Extract values needed for map display from parsed METAR */
+static map::AirportWeatherSummary weatherSummary(const atools::fs::weather::Metar& metar)
+{
+  map::AirportWeatherSummary summary;
+  summary.loaded = true;
+
+  const atools::fs::weather::MetarParser& parsed = metar.getParsedMetar();
+  summary.windDir = parsed.getWindDir();
+  summary.windSpeedKts = parsed.getWindSpeedKts();
+
+  if(metar.isValid())
+  {
+    summary.valid = true;
+    summary.flightRules = static_cast<qint8>(parsed.getFlightRules());
+    summary.maxCoverage = static_cast<qint8>(parsed.getMaxCoverage());
+    summary.prevailingWindDir = parsed.getPrevailingWindDir();
+    summary.prevailingWindSpeedKts = parsed.getPrevailingWindSpeedKnots();
+    summary.gustSpeedKts = parsed.getGustSpeedKts();
+  }
+  return summary;
+}
+
+map::AirportWeatherSummary WeatherReporter::getAirportWeatherSummary(const map::MapAirport& airport, bool stationOnly)
+{
+  // Avoid huge arrays for unexpected ids
+  const static int MAX_AIRPORT_ID = 500000;
+
+  map::MapWeatherSource source = NavApp::getMapWeatherSource();
+
+  // Ids from navdata can overlap with simulator ids
+  if(!isCacheable(source) || airport.navdata || airport.id < 0 || airport.id > MAX_AIRPORT_ID)
+    return weatherSummary(getAirportWeather(airport, stationOnly));
+
+  if(source != summarySource)
+  {
+    summariesStation.clear();
+    summariesNearest.clear();
+    summarySource = source;
+  }
+
+  QVector<map::AirportWeatherSummary>& summaries = stationOnly ? summariesStation : summariesNearest;
+  if(airport.id >= summaries.size())
+    summaries.resize(airport.id + 1);
+
+  map::AirportWeatherSummary& summary = summaries[airport.id];
+  if(!summary.loaded)
+    summary = weatherSummary(getAirportWeather(airport, stationOnly));
+  return summary;
+}
+
+void WeatherReporter::clearMetarCache()
+{
+  metarCache.clear();
+  summariesStation.clear();
+  summariesNearest.clear();
+}
+
+void WeatherReporter::clearMetarCacheActiveSky(const QStringList& idents)
+{
+  if(idents.size() > metarCache.size())
+    // Most stations changed - cheaper to drop all
+    metarCache.clear();
+  else
+  {
+    // Active Sky has no nearest reports - both keys depend on the station only
+    for(const QString& ident : idents)
+    {
+      metarCache.remove(metarCacheKey(map::WEATHER_SOURCE_ACTIVE_SKY, true /* stationOnly */, ident));
+      metarCache.remove(metarCacheKey(map::WEATHER_SOURCE_ACTIVE_SKY, false /* stationOnly */, ident));
+    }
+  }
+
+  // Summaries are indexed by airport id - refilled from the cache on demand
+  summariesStation.clear();
+  summariesNearest.clear();
+}
+
+atools::fs::weather::Metar WeatherReporter::getAirportWeatherInternal(const map::MapAirport& airport, bool stationOnly,
+                                                                      map::MapWeatherSource source)
 {
   // Empty position forces station only instead of allowing nearest
   const atools::geo::Pos& pos = stationOnly ? atools::geo::EMPTY_POS : airport.position;
-  map::MapWeatherSource source = NavApp::getMapWeatherSource();
   const QString& ident = airport.metarIdent();
 
   switch(source)
@@ -878,10 +1061,9 @@ atools::fs::weather::Metar WeatherReporter::getAirportWeather(const map::MapAirp
 
 void WeatherReporter::getAirportWind(int& windDirectionDeg, float& windSpeedKts, const map::MapAirport& airport, bool stationOnly)
 {
-  atools::fs::weather::Metar metar = getAirportWeather(airport, stationOnly);
-  const atools::fs::weather::MetarParser& parsed = metar.getParsedMetar();
-  windDirectionDeg = parsed.getWindDir();
-  windSpeedKts = parsed.getWindSpeedKts();
+  map::AirportWeatherSummary summary = getAirportWeatherSummary(airport, stationOnly);
+  windDirectionDeg = summary.windDir;
+  windSpeedKts = summary.windSpeedKts;
 }
 
 void WeatherReporter::getBestRunwaysTextShort(QString& title, QString& runwayNumbers, QString& sourceText, const map::MapAirport& airport)
@@ -924,7 +1106,9 @@ void WeatherReporter::getBestRunwaysTextShort(QString& title, QString& runwayNum
 
 void WeatherReporter::preDatabaseLoad()
 {
-
+  // Summaries are indexed by airport id which changes with the database
+  summariesStation.clear();
+  summariesNearest.clear();
 }
 
 void WeatherReporter::postDatabaseLoad(atools::fs::FsPaths::SimulatorType type)
@@ -936,6 +1120,7 @@ void WeatherReporter::postDatabaseLoad(atools::fs::FsPaths::SimulatorType type)
 
     // Simulator has changed - reload files
     simType = type;
+    clearMetarCache();
     resetErrorState();
     updateTimeouts();
     initActiveSkyPaths();
@@ -952,6 +1137,7 @@ void WeatherReporter::optionsChanged()
   // Enable warning dialogs about wrong paths again
   xp11WarningPathShown = xp12WarningPathShown = false;
 
+  clearMetarCache();
   resetErrorState();
   updateTimeouts();
   initActiveSkyPaths();
@@ -1000,6 +1186,76 @@ void WeatherReporter::activeSkyWeatherFilesChanged(const QStringList& paths)
   if(verbose)
     qDebug() << Q_FUNC_INFO << "file" << paths << "changed";
 
+  activeSkyReloadTimer.start();
+}
+
+void WeatherReporter::activeSkyReloadTimeout()
+{
+  if(activeSkySnapshotWatcher.isRunning())
+  {
+    // Read again when done
+    activeSkyReloadTimer.start();
+    return;
+  }
+
+  if(asSnapshotPathChecker->isValid())
+  {
+    // Read large snapshot file in background - calls activeSkySnapshotLoaded() when done
+    activeSkySnapshotLoadingPath = asSnapshotPath;
+    activeSkySnapshotWatcher.setFuture(QtConcurrent::run(&WeatherReporter::readActiveSkySnapshot, asSnapshotPath));
+  }
+  else if(asFlightplanPathChecker->isValid())
+    loadActiveSkyFlightplanSnapshot(asFlightplanPath);
+}
+
+void WeatherReporter::activeSkySnapshotLoaded()
+{
+  QHash<QString, QString> metars = activeSkySnapshotWatcher.result();
+
+  // Ignore if paths changed while reading or if file could not be read
+  if(activeSkySnapshotLoadingPath != asSnapshotPath || !asSnapshotPathChecker->isValid() || metars.isEmpty())
+    return;
+
+  // Collect stations with new, changed or removed reports
+  QStringList changed;
+  for(auto it = metars.constBegin(); it != metars.constEnd(); ++it)
+  {
+    if(activeSkyMetars.value(it.key()) != it.value())
+      changed.append(it.key());
+  }
+
+  for(auto it = activeSkyMetars.constBegin(); it != activeSkyMetars.constEnd(); ++it)
+  {
+    if(!metars.contains(it.key()))
+      changed.append(it.key());
+  }
+  activeSkyMetars.swap(metars);
+
+  // Flight plan file is small - read here and compare departure and destination
+  QString departureIdent = activeSkyDepartureIdent, departureMetar = activeSkyDepartureMetar,
+          destinationIdent = activeSkyDestinationIdent, destinationMetar = activeSkyDestinationMetar;
+  if(asFlightplanPathChecker->isValid())
+    loadActiveSkyFlightplanSnapshot(asFlightplanPath);
+
+  if(departureIdent != activeSkyDepartureIdent || departureMetar != activeSkyDepartureMetar)
+    changed << departureIdent << activeSkyDepartureIdent;
+  if(destinationIdent != activeSkyDestinationIdent || destinationMetar != activeSkyDestinationMetar)
+    changed << destinationIdent << activeSkyDestinationIdent;
+  changed.removeAll(QString());
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "changed stations" << changed.size() << "of" << activeSkyMetars.size();
+
+  if(!changed.isEmpty())
+  {
+    clearMetarCacheActiveSky(changed);
+    mainWindow->setStatusMessage(tr("Active Sky weather information updated."), true /* addToLog */);
+    emit weatherUpdated();
+  }
+}
+
+void WeatherReporter::updateActiveSkyWeather()
+{
   if(asSnapshotPathChecker->isValid())
     loadActiveSkySnapshot(asSnapshotPath);
 
@@ -1008,6 +1264,7 @@ void WeatherReporter::activeSkyWeatherFilesChanged(const QStringList& paths)
 
   if(asSnapshotPathChecker->isValid())
   {
+    clearMetarCache();
     mainWindow->setStatusMessage(tr("Active Sky weather information updated."), true /* addToLog */);
     emit weatherUpdated();
   }
@@ -1015,6 +1272,12 @@ void WeatherReporter::activeSkyWeatherFilesChanged(const QStringList& paths)
 
 void WeatherReporter::xplaneWeatherFileChanged()
 {
+  xplaneUpdateTimer.start();
+}
+
+void WeatherReporter::xplaneUpdateTimeout()
+{
+  clearMetarCache();
   mainWindow->setStatusMessage(tr("X-Plane weather information updated."), true /* addToLog */);
   emit weatherUpdated();
 }
@@ -1022,7 +1285,7 @@ void WeatherReporter::xplaneWeatherFileChanged()
 void WeatherReporter::debugDumpContainerSizes() const
 {
   if(verbose)
-    qDebug() << Q_FUNC_INFO << "activeSkyMetars.size()" << activeSkyMetars.size();
+    qDebug() << Q_FUNC_INFO << "activeSkyMetars.size()" << activeSkyMetars.size() << "metarCache.size()" << metarCache.size();
 
   if(noaaWeather != nullptr)
     noaaWeather->debugDumpContainerSizes();
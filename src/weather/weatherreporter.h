@@ -18,10 +18,16 @@
 #ifndef LITTLENAVMAP_WEATHERREPORTER_H
 #define LITTLENAVMAP_WEATHERREPORTER_H
 
+#include "common/mapflags.h"
 #include "fs/fspaths.h"
+#include "weather/weathercontext.h"
 
+#include <QCache>
+#include <QFutureWatcher>
 #include <QHash>
 #include <QObject>
+#include <QTimer>
+#include <QVector>
 
 namespace map {
 struct MapAirport;
@@ -107,13 +113,17 @@ public:
   /* For display. Source depends on settings and parsed objects are cached. */
   atools::fs::weather::Metar getAirportWeather(const map::MapAirport& airport, bool stationOnly);
 
+  /* Like getAirportWeather() but gives only the values needed for map symbols and wind.
+   * Values are kept in an array indexed by airport id until the next weather update. */
+  map::AirportWeatherSummary getAirportWeatherSummary(const map::MapAirport& airport, bool stationOnly);
+
   /* Get wind at airport. No nearest values for stationOnly=true. */
   void getAirportWind(int& windDirectionDeg, float& windSpeedKts, const map::MapAirport& airport, bool stationOnly);
 
   /* Gives preferred runways with title text like "Prefers runway:". Runways might be grouped. */
   void getBestRunwaysTextShort(QString& title, QString& runwayNumbers, QString& sourceText, const map::MapAirport& airport);
 
-  /* Does nothing currently */
+  /* Clears weather summaries since airport ids change */
   void preDatabaseLoad();
 
   /* Will reload new Active Sky data for the changed simulator type, but only if the path was not set manually */
@@ -184,10 +194,20 @@ private:
   void weatherDownloadFailed(const QString& error, int errorCode, QString url);
   void weatherDownloadSslErrors(const QStringList& errors, const QString& downloadUrl);
 
-  /* Called by file watcher */
+  /* Called by file watcher. Restart timers to coalesce bursts of file changes. */
   void activeSkyWeatherFilesChanged(const QStringList& paths);
   void xplaneWeatherFileChanged();
 
+  /* Called by timers after file changes settled */
+  void activeSkyReloadTimeout();
+  void xplaneUpdateTimeout();
+
+  /* Load all Active Sky files in the current thread and notify */
+  void updateActiveSkyWeather();
+
+  /* Called when the snapshot was read in background. Updates only changed stations. */
+  void activeSkySnapshotLoaded();
+
   /* Clear watcher, METARs and detect paths */
   void initActiveSkyPaths();
   void findActiveSkyFiles(QString& asnSnapshot, QString& flightplanSnapshot, const QString& activeSkyPrefix,
@@ -198,6 +218,9 @@ private:
 
   /* Load METARs from files */
   void loadActiveSkySnapshot(const QString& path);
+
+  /* Read snapshot file into a map of ident to METAR. Thread safe. */
+  static QHash<QString, QString> readActiveSkySnapshot(const QString& path);
   void loadActiveSkyFlightplanSnapshot(const QString& path);
 
   bool validateActiveSkyFlightplanFile(const QString& path);
@@ -229,11 +252,33 @@ private:
   /* Update IVAO and NOAA timeout periods - timeout is disable if weather services are not used */
   void updateTimeouts();
 
+  /* Fetch and parse weather for airport without using the cache */
+  atools::fs::weather::Metar getAirportWeatherInternal(const map::MapAirport& airport, bool stationOnly,
+                                                       map::MapWeatherSource source);
+
+  /* Clear parsed METAR cache and summaries after downloads or file changes */
+  void clearMetarCache();
+
+  /* Remove parsed METARs of the given Active Sky stations from cache and clear summaries */
+  void clearMetarCacheActiveSky(const QStringList& idents);
+
+  /* false if weather source changes without notification */
+  bool isCacheable(map::MapWeatherSource source) const;
+
   atools::fs::weather::NoaaWeatherDownloader *noaaWeather = nullptr;
   atools::fs::weather::WeatherNetDownload *vatsimWeather = nullptr;
   atools::fs::weather::WeatherNetDownload *ivaoWeather = nullptr;
 
   QHash<QString, QString> activeSkyMetars;
+
+  /* Parsed METARs for getAirportWeather() keyed by source, ident and station only flag.
+   *  Parsing is done lazily on first access for each airport. */
+  QCache<QString, atools::fs::weather::Metar> metarCache;
+
+  /* Summaries of METARs indexed by simulator database airport id for station only and nearest weather.
+   * Filled lazily and valid for summarySource. */
+  QVector<map::AirportWeatherSummary> summariesStation, summariesNearest;
+  map::MapWeatherSource summarySource = map::WEATHER_SOURCE_DISABLED;
   QString activeSkyDepartureMetar, activeSkyDestinationMetar,
           activeSkyDepartureIdent, activeSkyDestinationIdent;
 
@@ -262,6 +307,13 @@ private:
 
   bool errorReported = false;
 
+  /* Delay reading files after watcher notifications to read once for bursts of writes */
+  QTimer activeSkyReloadTimer, xplaneUpdateTimer;
+
+  /* Reads the Active Sky snapshot in background */
+  QFutureWatcher<QHash<QString, QString> > activeSkySnapshotWatcher;
+  QString activeSkySnapshotLoadingPath;
+
   bool verbose = false;
 };
 
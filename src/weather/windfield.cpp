@@ -0,0 +1,184 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+#include "weather/windfield.h"
+
+#include "atools.h"
+#include "common/mapflags.h"
+#include "geo/calculations.h"
+#include "geo/linestring.h"
+#include "grib/windquery.h"
+
+#include <cmath>
+#include <limits>
+
+/* Grid nodes per block side */
+const static int BLOCK_SIZE = 10;
+
+/* Number of blocks in x and y direction. 360 nodes from anti-meridian eastwards and 181 nodes from south to north pole */
+const static int NUM_BLOCKS_X = 360 / BLOCK_SIZE;
+const static int NUM_BLOCKS_Y = 181 / BLOCK_SIZE + 1;
+
+/* Wind components are stored in steps of 1/UV_SCALE knots which allows a range of about +/- 650 knots */
+const static float UV_SCALE = 50.f;
+const static qint16 NOT_SAMPLED = std::numeric_limits<qint16>::min();
+
+/* Altitude layers from 0 to 60000 ft */
+const static int LAYER_STEP_FT = 2000;
+const static int NUM_LAYERS = 31;
+
+/* Line segments are sampled in steps of this length for the average */
+const static float LINE_SAMPLE_STEP_NM = 30.f;
+
+WindField::WindField()
+{
+
+}
+
+void WindField::clear(atools::grib::WindQuery *query)
+{
+  blocks.clear();
+  windQuery = query;
+}
+
+WindField::WindUv WindField::nodeValue(int x, int y, int layer)
+{
+  // Wrap around at anti-meridian
+  x = (x % 360 + 360) % 360;
+  y = atools::minmax(0, 180, y);
+
+  QVector<qint16>& block = blocks[(layer * NUM_BLOCKS_Y + y / BLOCK_SIZE) * NUM_BLOCKS_X + x / BLOCK_SIZE];
+  if(block.isEmpty())
+    block.fill(NOT_SAMPLED, BLOCK_SIZE * BLOCK_SIZE * 2);
+
+  int index = ((y % BLOCK_SIZE) * BLOCK_SIZE + x % BLOCK_SIZE) * 2;
+  if(block.at(index) == NOT_SAMPLED)
+  {
+    // Not sampled yet - fetch from wind query
+    WindUv uv = toUv(windQuery->getWindForPos(atools::geo::Pos(x - 180.f, y - 90.f, static_cast<float>(layer * LAYER_STEP_FT))));
+    block[index] = quantize(uv.u);
+    block[index + 1] = quantize(uv.v);
+  }
+  return {block.at(index) / UV_SCALE, block.at(index + 1) / UV_SCALE};
+}
+
+qint16 WindField::quantize(float value)
+{
+  // Keep NOT_SAMPLED out of range
+  return static_cast<qint16>(atools::minmax(-32767, 32767, static_cast<int>(std::round(value * UV_SCALE))));
+}
+
+WindField::WindUv WindField::layerUv(int x0, int y0, float fx, float fy, int layer)
+{
+  WindUv v00 = nodeValue(x0, y0, layer), v10 = nodeValue(x0 + 1, y0, layer),
+         v01 = nodeValue(x0, y0 + 1, layer), v11 = nodeValue(x0 + 1, y0 + 1, layer);
+
+  float u0 = v00.u + (v10.u - v00.u) * fx, u1 = v01.u + (v11.u - v01.u) * fx;
+  float w0 = v00.v + (v10.v - v00.v) * fx, w1 = v01.v + (v11.v - v01.v) * fx;
+  return {u0 + (u1 - u0) * fy, w0 + (w1 - w0) * fy};
+}
+
+WindField::WindUv WindField::windUv(float lonX, float latY, float altFt)
+{
+  float gx = lonX + 180.f, gy = atools::minmax(0.f, 180.f, latY + 90.f);
+  int x0 = static_cast<int>(std::floor(gx)), y0 = std::min(static_cast<int>(std::floor(gy)), 179);
+  float fx = gx - x0, fy = gy - y0;
+
+  float ga = atools::minmax(0.f, static_cast<float>((NUM_LAYERS - 1) * LAYER_STEP_FT), altFt) / LAYER_STEP_FT;
+  int l0 = std::min(static_cast<int>(std::floor(ga)), NUM_LAYERS - 2);
+  float fa = ga - l0;
+
+  WindUv lower = layerUv(x0, y0, fx, fy, l0), upper = layerUv(x0, y0, fx, fy, l0 + 1);
+  return {lower.u + (upper.u - lower.u) * fa, lower.v + (upper.v - lower.v) * fa};
+}
+
+atools::grib::Wind WindField::getWind(const atools::geo::Pos& pos)
+{
+  if(windQuery == nullptr || !pos.isValid())
+    return atools::grib::Wind();
+
+  return fromUv(windUv(pos.getLonX(), pos.getLatY(), pos.getAltitude()));
+}
+
+void WindField::getWinds(QVector<atools::grib::Wind>& winds, const QVector<atools::geo::Pos>& positions)
+{
+  winds.resize(positions.size());
+  for(int i = 0; i < positions.size(); i++)
+    winds[i] = getWind(positions.at(i));
+}
+
+atools::grib::Wind WindField::getWindAverage(const atools::geo::LineString& line)
+{
+  if(windQuery == nullptr || line.isEmpty())
+    return atools::grib::Wind();
+
+  if(line.size() == 1)
+    return getWind(line.constFirst());
+
+  double sumU = 0., sumV = 0.;
+  int num = 0;
+  for(int i = 0; i < line.size() - 1; i++)
+  {
+    const atools::geo::Pos& p1 = line.at(i), & p2 = line.at(i + 1);
+    if(!p1.isValid() || !p2.isValid())
+      continue;
+
+    // Sample segment in regular steps including start - end is included by the next segment or below
+    int steps = std::max(1, static_cast<int>(std::ceil(atools::geo::meterToNm(p1.distanceMeterTo(p2)) / LINE_SAMPLE_STEP_NM)));
+    for(int j = 0; j < steps; j++)
+    {
+      float fraction = static_cast<float>(j) / steps;
+      atools::geo::Pos pos = j == 0 ? p1 : p1.interpolate(p2, fraction);
+      WindUv uv = windUv(pos.getLonX(), pos.getLatY(), p1.getAltitude() + (p2.getAltitude() - p1.getAltitude()) * fraction);
+      sumU += uv.u;
+      sumV += uv.v;
+      num++;
+    }
+  }
+
+  // Add last point
+  const atools::geo::Pos& last = line.constLast();
+  if(last.isValid())
+  {
+    WindUv uv = windUv(last.getLonX(), last.getLatY(), last.getAltitude());
+    sumU += uv.u;
+    sumV += uv.v;
+    num++;
+  }
+
+  if(num == 0)
+    return atools::grib::Wind();
+
+  return fromUv({static_cast<float>(sumU / num), static_cast<float>(sumV / num)});
+}
+
+WindField::WindUv WindField::toUv(const atools::grib::Wind& wind)
+{
+  // Direction is where the wind is coming from
+  if(!(wind.speed < map::INVALID_SPEED_VALUE) || !(wind.dir < map::INVALID_COURSE_VALUE))
+    return {0.f, 0.f};
+
+  double rad = atools::geo::toRadians(static_cast<double>(wind.dir));
+  return {static_cast<float>(-wind.speed * std::sin(rad)), static_cast<float>(-wind.speed * std::cos(rad))};
+}
+
+atools::grib::Wind WindField::fromUv(const WindUv& uv)
+{
+  atools::grib::Wind wind;
+  wind.speed = static_cast<float>(std::hypot(uv.u, uv.v));
+  wind.dir = static_cast<float>(atools::geo::normalizeCourse(atools::geo::toDegree(std::atan2(-uv.u, -uv.v))));
+  return wind;
+}
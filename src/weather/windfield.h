@@ -0,0 +1,104 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+#ifndef LNM_WINDFIELD_H
+#define LNM_WINDFIELD_H
+
+#include "grib/windtypes.h"
+
+#include <QHash>
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class Pos;
+class LineString;
+}
+namespace grib {
+class WindQuery;
+}
+}
+
+/*
+ * Interpolated wind field sampled from a wind query in 1 degree steps horizontally and 2000 ft vertically.
+ * Wind is stored as east/north components quantized to 16 bit integers in dense arrays per 10 by 10 degree block
+ * and altitude layer. Blocks are allocated and grid nodes are sampled lazily on first access.
+ * Therefore only the layers used by the map display and flight plan altitudes take memory.
+ *
+ * Queries use bilinear interpolation between grid nodes and linear interpolation between altitude layers.
+ * All values have to be cleared by calling clear() when the underlying wind data changes.
+ *
+ * Not thread safe.
+ */
+class WindField
+{
+public:
+  WindField();
+
+  /* Remove all sampled values and set new wind query. Data is sampled again on next access. */
+  void clear(atools::grib::WindQuery *query = nullptr);
+
+  /* Get wind for position and altitude in feet taken from position */
+  atools::grib::Wind getWind(const atools::geo::Pos& pos);
+
+  /* Get winds for all positions. Result has the same size as positions. */
+  void getWinds(QVector<atools::grib::Wind>& winds, const QVector<atools::geo::Pos>& positions);
+
+  /* Average wind along a line string. Segments are sampled in regular steps and altitude is interpolated between
+   * the points. Components are averaged. */
+  atools::grib::Wind getWindAverage(const atools::geo::LineString& line);
+
+  const atools::grib::WindQuery *getQuery() const
+  {
+    return windQuery;
+  }
+
+  /* Number of allocated blocks for debugging */
+  int getNumBlocks() const
+  {
+    return blocks.size();
+  }
+
+private:
+  /* East and north wind component in knots */
+  struct WindUv
+  {
+    float u, v;
+  };
+
+  /* Get wind components for grid node. x is 0-359 from anti-meridian, y is 0-180 from south pole, layer 0-30. */
+  WindUv nodeValue(int x, int y, int layer);
+
+  /* Interpolated wind components for position and altitude */
+  WindUv windUv(float lonX, float latY, float altFt);
+
+  /* Bilinear interpolation in one layer */
+  WindUv layerUv(int x0, int y0, float fx, float fy, int layer);
+
+  /* Convert wind component in knots to stored value */
+  static qint16 quantize(float value);
+
+  static WindUv toUv(const atools::grib::Wind& wind);
+  static atools::grib::Wind fromUv(const WindUv& uv);
+
+  atools::grib::WindQuery *windQuery = nullptr;
+
+  /* Key is block index including layer. Values are quantized u and v for all nodes of the block in one layer
+   * or NOT_SAMPLED if not sampled yet. */
+  QHash<int, QVector<qint16> > blocks;
+};
+
+#endif // LNM_WINDFIELD_H
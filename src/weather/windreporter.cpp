@@ -20,9 +20,12 @@
 #include "app/navapp.h"
 #include "ui_mainwindow.h"
 #include "grib/windquery.h"
+#include "geo/linestring.h"
 #include "settings/settings.h"
 #include "common/constants.h"
 #include "options/optiondata.h"
+#include "query/querytypes.h"
+#include "common/stallmonitor.h"
 #include "common/unit.h"
 #include "perf/aircraftperfcontroller.h"
 #include "mapgui/maplayer.h"
@@ -172,6 +175,11 @@ WindReporter::WindReporter(QObject *parent, atools::fs::FsPaths::SimulatorType t
   atools::settings::Settings& settings = atools::settings::Settings::instance();
   verbose = settings.getAndStoreValue(lnm::OPTIONS_WEATHER_DEBUG, false).toBool();
 
+  // Invalidate caches depending on weather before any other receiver is notified
+  connect(this, &WindReporter::windUpdated, this, []() -> void {
+    query::incrementRevision(query::REV_WEATHER);
+  });
+
   // Real wind ==================
   windQueryOnline = new atools::grib::WindQuery(parent, verbose);
   connect(windQueryOnline, &atools::grib::WindQuery::windDataUpdated, this, &WindReporter::windDownloadFinished);
@@ -188,6 +196,11 @@ WindReporter::WindReporter(QObject *parent, atools::fs::FsPaths::SimulatorType t
   connect(ui->actionMapShowWindManual, &QAction::triggered, this, &WindReporter::sourceActionTriggered);
   connect(ui->actionMapShowWindNOAA, &QAction::triggered, this, &WindReporter::sourceActionTriggered);
   connect(ui->actionMapShowWindSimulator, &QAction::triggered, this, &WindReporter::sourceActionTriggered);
+
+  // Drop all sampled values of the route wind field on any change
+  connect(this, &WindReporter::windUpdated, this, [this]() {
+    windField.clear(currentWindQuery());
+  });
 }
 
 WindReporter::~WindReporter()
@@ -309,6 +322,8 @@ void WindReporter::updateDataSource()
 
 void WindReporter::windDownloadFinished()
 {
+  LNM_STALL_SCOPE;
+
   qDebug() << Q_FUNC_INFO;
   updateToolButtonState();
   updateSliderLabel();
@@ -806,14 +821,27 @@ atools::grib::WindPos WindReporter::getWindForPos(const atools::geo::Pos& pos)
   return getWindForPos(pos, pos.getAltitude());
 }
 
+WindField& WindReporter::currentWindField()
+{
+  if(windField.getQuery() != currentWindQuery())
+    windField.clear(currentWindQuery());
+  return windField;
+}
+
 atools::grib::Wind WindReporter::getWindForPosRoute(const atools::geo::Pos& pos)
 {
-  return currentWindQuery()->getWindForPos(pos);
+  if(currentWindQuery()->hasWindData())
+    return currentWindField().getWind(pos);
+  else
+    return currentWindQuery()->getWindForPos(pos);
 }
 
 atools::grib::Wind WindReporter::getWindForLineRoute(const atools::geo::Pos& pos1, const atools::geo::Pos& pos2)
 {
-  return currentWindQuery()->getWindAverageForLine(pos1, pos2);
+  if(currentWindQuery()->hasWindData())
+    return currentWindField().getWindAverage(atools::geo::LineString({pos1, pos2}));
+  else
+    return currentWindQuery()->getWindAverageForLine(pos1, pos2);
 }
 
 atools::grib::Wind WindReporter::getWindForLineRoute(const atools::geo::Line& line)
@@ -823,7 +851,10 @@ atools::grib::Wind WindReporter::getWindForLineRoute(const atools::geo::Line& li
 
 atools::grib::Wind WindReporter::getWindForLineStringRoute(const atools::geo::LineString& line)
 {
-  return currentWindQuery()->getWindAverageForLineString(line);
+  if(currentWindQuery()->hasWindData())
+    return currentWindField().getWindAverage(line);
+  else
+    return currentWindQuery()->getWindAverageForLineString(line);
 }
 
 atools::grib::WindPosList WindReporter::windStackForPosInternal(const atools::geo::Pos& pos, QVector<int> altitudesFt) const
@@ -917,6 +948,7 @@ void WindReporter::updateManualRouteWinds()
   windQueryManual->initFromFixedModel(perfController->getManualWindDirDeg(),
                                       perfController->getManualWindSpeedKts(),
                                       perfController->getManualWindAltFt());
+  windField.clear(currentWindQuery());
 }
 
 #ifdef DEBUG_INFORMATION
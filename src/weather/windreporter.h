@@ -21,6 +21,7 @@
 #include "fs/fspaths.h"
 #include "grib/windtypes.h"
 #include "query/querytypes.h"
+#include "weather/windfield.h"
 
 #include <QWidgetAction>
 
@@ -207,6 +208,9 @@ private:
     return isWindManual() ? windQueryManual : windQueryOnline;
   }
 
+  /* Get interpolated wind field for the current wind query. Resets the field if the source changed. */
+  WindField& currentWindField();
+
   /* GRIB wind data query for downloading files and monitoring files- Manual wind if for user setting. */
   atools::grib::WindQuery *windQueryOnline = nullptr, *windQueryManual = nullptr;
 
@@ -239,6 +243,9 @@ private:
   query::SimpleRectCache<atools::grib::WindPos> windPosCache;
   int cachedLevel = wind::NONE;
 
+  /* Interpolated grid for route wind queries sampled lazily from the current wind query */
+  WindField windField;
+
   windinternal::WindSliderAction *sliderActionAltitude = nullptr;
   windinternal::WindLabelAction *labelActionWindAltitude = nullptr;
 
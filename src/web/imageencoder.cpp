@@ -0,0 +1,123 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "web/imageencoder.h"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QImage>
+#include <QImageWriter>
+
+#include <algorithm>
+
+/* JPEG quality for preset "fast" */
+static const int FAST_JPEG_QUALITY = 50;
+
+/* Initial buffer size which fits a medium sized JPEG */
+static const int INITIAL_BUFFER_SIZE = 512 * 1024;
+
+ImageEncoder::ImageEncoder(int maxThreads)
+  : slots(std::max(maxThreads, 1))
+{
+}
+
+void ImageEncoder::parse(Format& format, int& quality, const QString& formatName, const QString& qualityStr,
+                         Format defaultFormat)
+{
+  if(qualityStr == QLatin1String("fast"))
+  {
+    format = JPG;
+    quality = FAST_JPEG_QUALITY;
+    return;
+  }
+
+  bool ok;
+  quality = qualityStr.toInt(&ok);
+  if(!ok)
+    quality = -1;
+
+  if(formatName == QLatin1String("jpg"))
+    format = JPG;
+  else if(formatName == QLatin1String("png"))
+    format = PNG;
+  else if(formatName == QLatin1String("webp"))
+    format = isWebpSupported() ? WEBP : JPG;
+  else
+    format = defaultFormat;
+}
+
+QByteArray ImageEncoder::contentType(Format format)
+{
+  switch(format)
+  {
+    case ImageEncoder::JPG:
+      return "image/jpeg";
+
+    case ImageEncoder::PNG:
+      return "image/png";
+
+    case ImageEncoder::WEBP:
+      return "image/webp";
+  }
+  return QByteArray();
+}
+
+bool ImageEncoder::isWebpSupported()
+{
+  static const bool supported = QImageWriter::supportedImageFormats().contains("webp");
+  return supported;
+}
+
+const QByteArray& ImageEncoder::encode(const QImage& image, Format format, int quality)
+{
+  if(!buffers.hasLocalData())
+  {
+    QByteArray *buffer = new QByteArray;
+    buffer->reserve(INITIAL_BUFFER_SIZE);
+    buffers.setLocalData(buffer);
+  }
+
+  // Reserved capacity is kept when resizing to zero
+  QByteArray *bytes = buffers.localData();
+  bytes->resize(0);
+
+  slots.acquire();
+  QBuffer buffer(bytes);
+  buffer.open(QIODevice::WriteOnly);
+
+  bool ok = false;
+  switch(format)
+  {
+    case ImageEncoder::JPG:
+      ok = image.save(&buffer, "JPG", quality);
+      break;
+
+    case ImageEncoder::PNG:
+      ok = image.save(&buffer, "PNG", quality);
+      break;
+
+    case ImageEncoder::WEBP:
+      ok = image.save(&buffer, "WEBP", quality);
+      break;
+  }
+  slots.release();
+
+  if(!ok)
+    qWarning() << Q_FUNC_INFO << "Encoding failed for format" << format;
+
+  return *bytes;
+}
@@ -0,0 +1,70 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_IMAGEENCODER_H
+#define LNM_IMAGEENCODER_H
+
+#include <QSemaphore>
+#include <QThreadStorage>
+
+class QImage;
+
+/*
+ * Encodes map images for the web server in the calling HTTP server thread.
+ * The number of concurrent encodings is limited to keep CPU free for rendering in the main thread.
+ * Each thread reuses its output buffer to avoid reallocation for each image.
+ *
+ * All methods are thread safe.
+ */
+class ImageEncoder
+{
+public:
+  enum Format
+  {
+    JPG,
+    PNG,
+    WEBP
+  };
+
+  /* Allow maxThreads encodings at the same time */
+  explicit ImageEncoder(int maxThreads);
+
+  ImageEncoder(const ImageEncoder& other) = delete;
+  ImageEncoder& operator=(const ImageEncoder& other) = delete;
+
+  /* Get format and quality from request parameters. Format name is "jpg", "png" or "webp" where
+   * unknown values give defaultFormat. WebP falls back to JPG if the Qt image plugin is not installed.
+   * Quality "fast" selects JPG with a low quality for moving map clients. */
+  static void parse(Format& format, int& quality, const QString& formatName, const QString& qualityStr,
+                    Format defaultFormat = JPG);
+
+  /* MIME type like "image/jpeg" */
+  static QByteArray contentType(Format format);
+
+  /* true if Qt can write WebP images */
+  static bool isWebpSupported();
+
+  /* Encode image and return the thread local buffer which is valid until the next call in the same thread.
+   * Waits if too many images are encoded. */
+  const QByteArray& encode(const QImage& image, Format format, int quality);
+
+private:
+  QSemaphore slots;
+  QThreadStorage<QByteArray *> buffers;
+};
+
+#endif // LNM_IMAGEENCODER_H
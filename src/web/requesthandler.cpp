@@ -21,14 +21,17 @@
 #include "httpserver/httpsessionstore.h"
 #include "httpserver/httpsession.h"
 #include "templateengine/templatecache.h"
-#include "mapgui/mappaintwidget.h"
 #include "app/navapp.h"
 #include "info/infocontroller.h"
-#include "route/routecontroller.h"
 #include "web/webmapcontroller.h"
+#include "web/websnapshot.h"
+#include "web/webpushchannel.h"
+#include "web/webmetrics.h"
+#include "web/imageencoder.h"
 #include "webapi/webapicontroller.h"
 #include "web/webtools.h"
 #include "web/webapp.h"
+#include "web/staticfilecache.h"
 #include "common/mapcolors.h"
 #include "geo/calculations.h"
 #include "common/htmlinfobuilder.h"
@@ -38,44 +41,39 @@
 
 #include <QBuffer>
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QDir>
+#include <QElapsedTimer>
 #include <QUrl>
 #include <QPainter>
 #include <QtWidgets/QApplication>
 
 using namespace stefanfrings;
 
+namespace  {
+
+/* Bytes written for the current request of a server thread. Used for metrics. */
+thread_local qint64 bytesWritten = 0;
+
+void writeResponse(HttpResponse& response, const QByteArray& data, bool lastPart = false)
+{
+  bytesWritten += data.size();
+  response.write(data, lastPart);
+}
+
+}
+
 RequestHandler::RequestHandler(QObject *parent, WebMapController *webMapController,WebApiController *webApiController,
+                               WebSnapshot *webSnapshotParam, WebPushChannel *webPushChannelParam,
+                               WebMetrics *webMetricsParam, ImageEncoder *imageEncoderParam,
                                HtmlInfoBuilder *htmlInfoBuilderParam, bool verboseParam)
-  : HttpRequestHandler(parent), webApiController(webApiController), htmlInfoBuilder(htmlInfoBuilderParam), verbose(verboseParam)
+  : HttpRequestHandler(parent), webMapController(webMapController), webApiController(webApiController),
+  webSnapshot(webSnapshotParam), webPushChannel(webPushChannelParam), webMetrics(webMetricsParam),
+  imageEncoder(imageEncoderParam), htmlInfoBuilder(htmlInfoBuilderParam), verbose(verboseParam)
 {
   if(verbose)
     qDebug() << Q_FUNC_INFO;
 
-  /* Fetch data through methods asynchronously to separate the call from this thread and run it in the main thread.
-   * It has to wait for the main event queue to finish the request but saves a lot of synchronization through mutexes. */
-  connect(this, &RequestHandler::getUserAircraft,
-          NavApp::getMapPaintWidgetGui(), &MapPaintWidget::getUserAircraft, Qt::BlockingQueuedConnection);
-  connect(this, &RequestHandler::getRoute,
-          NavApp::getRouteController(),
-          static_cast<const Route& (RouteController::*)() const>(&RouteController::getRouteConst),
-          Qt::BlockingQueuedConnection);
-  connect(this, &RequestHandler::getFlightplanTableAsHtml,
-          NavApp::getRouteController(), &RouteController::getFlightplanTableAsHtml, Qt::BlockingQueuedConnection);
-  connect(this, &RequestHandler::getAirportText,
-          NavApp::getInfoController(), &InfoController::getAirportTextFull, Qt::BlockingQueuedConnection);
-  connect(this, &RequestHandler::getCurrentMapWidgetPos,
-          NavApp::getMapPaintWidgetGui(), &MapPaintWidget::getCurrentViewCenterPos, Qt::BlockingQueuedConnection);
-
-  connect(this, &RequestHandler::getPixmap, webMapController, &WebMapController::getPixmap,
-          Qt::BlockingQueuedConnection);
-  connect(this, &RequestHandler::getPixmapObject, webMapController, &WebMapController::getPixmapObject,
-          Qt::BlockingQueuedConnection);
-  connect(this, &RequestHandler::getPixmapPosDistance, webMapController, &WebMapController::getPixmapPosDistance,
-          Qt::BlockingQueuedConnection);
-  connect(this, &RequestHandler::getPixmapRect, webMapController, &WebMapController::getPixmapRect,
-          Qt::BlockingQueuedConnection);
-
   /* Connect WebApiController to serviceWebApi signal */
   connect(this,&RequestHandler::serviceWebApi, webApiController, &WebApiController::service,Qt::BlockingQueuedConnection);
 }
@@ -88,8 +86,14 @@ RequestHandler::~RequestHandler()
 
 void RequestHandler::service(HttpRequest& request, HttpResponse& response)
 {
+  lastRequestTimeMs.storeRelease(QDateTime::currentMSecsSinceEpoch());
   QString path = QString::fromUtf8(request.getPath());
 
+  QElapsedTimer timer;
+  timer.start();
+  bytesWritten = 0;
+  webMetrics->requestStarted();
+
   if(verbose)
     qDebug() << "RequestHandler::service(): path" << path << request.getMethod()
              << "header" << endl << request.getHeaderMap()
@@ -99,6 +103,10 @@ void RequestHandler::service(HttpRequest& request, HttpResponse& response)
     // ===========================================================================
     // Requests for map images only - either with or without session
     handleMapImage(request, response);
+  else if(path == QLatin1String("/events"))
+    // ===========================================================================
+    // Server-sent events pushing simulator and progress updates
+    handleEventStream(request, response);
   else if(path.startsWith(webApiController->webApiPathPrefix))
     // ===========================================================================
     // Requests for web api - either with or without session
@@ -126,7 +134,7 @@ void RequestHandler::service(HttpRequest& request, HttpResponse& response)
     else if(path == QLatin1String("/plugins"))
     {
       response.setHeader("Content-Type", "text/plain");
-      response.write(QDir(WebApp::getDocroot() + path).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name | QDir::LocaleAware).join("/").toUtf8(), true);
+      writeResponse(response, QDir(WebApp::getDocroot() + path).entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name | QDir::LocaleAware).join("/").toUtf8(), true);
     }
     else // all other paths
     {
@@ -170,9 +178,19 @@ void RequestHandler::service(HttpRequest& request, HttpResponse& response)
               handleHtmlFileRequest(request, response, session, file, extension);
             }
             else
+            {
               // ===========================================================================
               // Serve all files not ending with .html as is (css, svg, etc.)
-              WebApp::getStaticFileController()->service(request, response);
+              // Text files are compressed and cached if the client allows
+              qint64 written = WebApp::getStaticFileCache()->service(request, response, fi);
+              if(written >= 0)
+                bytesWritten += written;
+              else
+              {
+                WebApp::getStaticFileController()->service(request, response);
+                bytesWritten += fi.size();
+              }
+            }
           }
           else
             showError(request, response, 403, QStringLiteral(u"Forbidden."));
@@ -186,6 +204,78 @@ void RequestHandler::service(HttpRequest& request, HttpResponse& response)
         showError(request, response, 403, QStringLiteral(u"Forbidden."));
     } // else other paths
   } // else mapimage
+
+  webMetrics->record(metricsKey(path), timer.nsecsElapsed() / 1000, bytesWritten);
+  webMetrics->requestFinished();
+}
+
+QByteArray RequestHandler::metricsKey(const QString& path) const
+{
+  if(path.startsWith(webApiController->webApiPathPrefix))
+  {
+    // Use controller and action only since path might contain parameters like tile coordinates
+    QStringList parts = path.mid(webApiController->webApiPathPrefix.length()).split('/', QString::SkipEmptyParts);
+    return "api/" + parts.mid(0, 2).join('/').toUtf8();
+  }
+  else if(path == QLatin1String("/mapimage"))
+    return "mapimage";
+  else if(path == QLatin1String("/events"))
+    return "events";
+  else if(path.endsWith(WebApp::getHtmlExtension()) || path.endsWith('/'))
+    return "page";
+  else
+    return "static";
+}
+
+void RequestHandler::handleEventStream(HttpRequest& request, HttpResponse& response)
+{
+  /* Send a comment in this interval to keep the connection alive and detect disconnected clients */
+  static const int HEARTBEAT_MS = 15000;
+
+  Parameter params(request, verbose);
+
+  QVector<WebPushChannel::Topic> topics;
+  const QStringList topicNames = params.asStr(QStringLiteral(u"topics"), QStringLiteral(u"sim")).split(',', QString::SkipEmptyParts);
+  for(const QString& name : topicNames)
+  {
+    if(name.trimmed() == QLatin1String("sim"))
+      topics.append(WebPushChannel::TOPIC_SIM);
+    else if(name.trimmed() == QLatin1String("progress"))
+      topics.append(WebPushChannel::TOPIC_PROGRESS);
+  }
+
+  if(topics.isEmpty())
+  {
+    showError(request, response, 400, QStringLiteral(u"No valid topics."));
+    return;
+  }
+
+  if(!webPushChannel->subscribe(topics))
+  {
+    showError(request, response, 503, QStringLiteral(u"Too many event subscribers."));
+    return;
+  }
+
+  bool useDelta = params.asStr(QStringLiteral(u"delta")) == QLatin1String("true");
+
+  response.setHeader("Content-Type", "text/event-stream");
+  response.setHeader("Cache-Control", "no-cache");
+  response.setHeader("X-Accel-Buffering", "no");
+  writeResponse(response, ": connected\n\n");
+  response.flush();
+
+  QVector<qint64> lastSequence(topics.size(), 0);
+  while(response.isConnected() && !webPushChannel->isShutdown())
+  {
+    QByteArray events = webPushChannel->waitForEvents(topics, lastSequence, useDelta, HEARTBEAT_MS);
+    writeResponse(response, events.isEmpty() ? QByteArray(": heartbeat\n\n") : events);
+    response.flush();
+  }
+
+  webPushChannel->unsubscribe(topics);
+
+  if(response.isConnected())
+    writeResponse(response, QByteArray(), true /* lastPart */);
 }
 
 inline void RequestHandler::handleMapImage(HttpRequest& request, HttpResponse& response)
@@ -198,11 +288,15 @@ inline void RequestHandler::handleMapImage(HttpRequest& request, HttpResponse& r
 
   MapPixmap mapPixmap;
 
+  // Used to assign a map paint widget to each client
+  QByteArray clientKey = request.getPeerAddress().toString().toUtf8();
+
   if(params.has("session"))
   {
     // ===========================================================================
     // Stateful handling using a session which has the last zoom and position
     HttpSession session = getSession(request, response);
+    clientKey = session.getId();
 
     // Session already contains distance and position values from an earlier call
     // Values are also initialized from visible map display when creating session
@@ -222,23 +316,32 @@ inline void RequestHandler::handleMapImage(HttpRequest& request, HttpResponse& r
 
     if(mapcmd == QLatin1String("user"))
       // Show user aircraft
-      mapPixmap = emit getPixmapObject(width, height, web::USER_AIRCRAFT, QLatin1String(""), requestedDistanceKm);
+      mapPixmap = webMapController->renderQueued(clientKey, [=](WebMapController *controller) -> MapPixmap {
+        return controller->getPixmapObject(width, height, web::USER_AIRCRAFT, QLatin1String(""), requestedDistanceKm);
+      });
     else if(mapcmd == QLatin1String("route"))
       // Center flight plan
-      mapPixmap = emit getPixmapObject(width, height, web::ROUTE, QLatin1String(""), requestedDistanceKm);
+      mapPixmap = webMapController->renderQueued(clientKey, [=](WebMapController *controller) -> MapPixmap {
+        return controller->getPixmapObject(width, height, web::ROUTE, QLatin1String(""), requestedDistanceKm);
+      });
     else if(mapcmd == QLatin1String("airport"))
+    {
       // Show an airport by ident
-      mapPixmap = emit getPixmapObject(width, height, web::AIRPORT, params.asStr(
-                                         QStringLiteral(u"airport")).toUpper(), requestedDistanceKm);
+      QString ident = params.asStr(QStringLiteral(u"airport")).toUpper();
+      mapPixmap = webMapController->renderQueued(clientKey, [=](WebMapController *controller) -> MapPixmap {
+        return controller->getPixmapObject(width, height, web::AIRPORT, ident, requestedDistanceKm);
+      });
+    }
     else
     {
         // When zooming in or out use the last corrected distance (i.e. actual distance) as a base
         // Zoom or move map
-        mapPixmap = emit getPixmapPosDistance(width, height,
-                                              atools::geo::Pos(session.get("lon").toFloat(),
-                                                               session.get("lat").toFloat()),
-                                              (mapcmd == QLatin1String("in") || mapcmd == QLatin1String("out")) ?
-                                                                       session.get("corrected_distance").toFloat() : requestedDistanceKm, mapcmd);
+        atools::geo::Pos pos(session.get("lon").toFloat(), session.get("lat").toFloat());
+        float distanceKm = (mapcmd == QLatin1String("in") || mapcmd == QLatin1String("out")) ?
+                           session.get("corrected_distance").toFloat() : requestedDistanceKm;
+        mapPixmap = webMapController->renderQueued(clientKey, [=](WebMapController *controller) -> MapPixmap {
+          return controller->getPixmapPosDistance(width, height, pos, distanceKm, mapcmd);
+        });
     }
 
     if(mapPixmap.hasNoError())
@@ -261,19 +364,30 @@ inline void RequestHandler::handleMapImage(HttpRequest& request, HttpResponse& r
     // Session-less / state-less calls ============================================
     if(params.has(QStringLiteral(u"user")))
       // User aircraft =======================
-      mapPixmap = emit getPixmapObject(width, height, web::USER_AIRCRAFT, QLatin1String(""), requestedDistanceKm);
+      mapPixmap = webMapController->renderQueued(clientKey, [=](WebMapController *controller) -> MapPixmap {
+        return controller->getPixmapObject(width, height, web::USER_AIRCRAFT, QLatin1String(""), requestedDistanceKm);
+      });
     else if(params.has(QStringLiteral(u"route")))
       // Center flight plan =======================
-      mapPixmap = emit getPixmapObject(width, height, web::ROUTE, QLatin1String(""), requestedDistanceKm);
+      mapPixmap = webMapController->renderQueued(clientKey, [=](WebMapController *controller) -> MapPixmap {
+        return controller->getPixmapObject(width, height, web::ROUTE, QLatin1String(""), requestedDistanceKm);
+      });
     else if(params.has(QStringLiteral(u"airport")))
+    {
       // Show airport =======================
-      mapPixmap = emit getPixmapObject(width, height, web::AIRPORT, params.asStr("airport"), requestedDistanceKm);
+      QString ident = params.asStr("airport");
+      mapPixmap = webMapController->renderQueued(clientKey, [=](WebMapController *controller) -> MapPixmap {
+        return controller->getPixmapObject(width, height, web::AIRPORT, ident, requestedDistanceKm);
+      });
+    }
     else if(params.has(QStringLiteral(u"leftlon")) && params.has(QStringLiteral(u"toplat")) && params.has(QStringLiteral(u"rightlon")) && params.has(QStringLiteral(u"bottomlat")))
     {
       // Show rectangle =======================
       atools::geo::Rect rect(params.asFloat(QStringLiteral(u"leftlon")), params.asFloat(QStringLiteral(u"toplat")),
                              params.asFloat(QStringLiteral(u"rightlon")), params.asFloat(QStringLiteral(u"bottomlat")));
-      mapPixmap = emit getPixmapRect(width, height, rect);
+      mapPixmap = webMapController->renderQueued(clientKey, [=](WebMapController *controller) -> MapPixmap {
+        return controller->getPixmapRect(width, height, rect);
+      });
     }
     else if(params.has(QStringLiteral(u"distance")) || (params.has(QStringLiteral(u"lon")) && params.has(QStringLiteral(u"lat"))))
     {
@@ -285,11 +399,15 @@ inline void RequestHandler::handleMapImage(HttpRequest& request, HttpResponse& r
         pos.setLatY(params.asFloat(QStringLiteral(u"lat")));
       }
 
-      mapPixmap = emit getPixmapPosDistance(width, height, pos, requestedDistanceKm, QLatin1String(""));
+      mapPixmap = webMapController->renderQueued(clientKey, [=](WebMapController *controller) -> MapPixmap {
+        return controller->getPixmapPosDistance(width, height, pos, requestedDistanceKm, QLatin1String(""));
+      });
     }
     else
       // Show current map view =======================
-      mapPixmap = emit getPixmap(width, height);
+      mapPixmap = webMapController->renderQueued(clientKey, [=](WebMapController *controller) -> MapPixmap {
+        return controller->getPixmap(width, height);
+      });
 
     if(mapPixmap.hasError())
       // Show error message as image
@@ -299,31 +417,14 @@ inline void RequestHandler::handleMapImage(HttpRequest& request, HttpResponse& r
   if(mapPixmap.isValid())
   {
     // ===========================================================================
-    // Write pixmap as image
-    QByteArray bytes;
-    QBuffer buffer(&bytes);
-    buffer.open(QIODevice::WriteOnly);
-
-    int quality = params.asInt(QStringLiteral(u"quality"), -1);
-
-    // Image format, jpg is default and only jpg and png allowed ===========================================
-    QString format = params.asEnum(QStringLiteral(u"format"), QStringLiteral(u"jpg"), {QStringLiteral(u"jpg"), QStringLiteral(u"png")});
-
-    if(format == QLatin1String("jpg"))
-    {
-      response.setHeader("Content-Type", "image/jpeg");
-      mapPixmap.pixmap.save(&buffer, "JPG", quality);
-    }
-    else if(format == QLatin1String("png"))
-    {
-      response.setHeader("Content-Type", "image/png");
-      mapPixmap.pixmap.save(&buffer, "PNG", quality);
-    }
-    else
-      // Should never happen
-      qWarning() << Q_FUNC_INFO << "invalid format";
-
-    response.write(bytes);
+    // Write image encoded in this thread - jpg is default and jpg, png and webp are allowed
+    ImageEncoder::Format format;
+    int quality;
+    ImageEncoder::parse(format, quality, params.asStr(QStringLiteral(u"format")), params.asStr(QStringLiteral(u"quality")));
+
+    response.setHeader("Content-Type", ImageEncoder::contentType(format));
+    response.setHeader("Render-Queue-Depth", QByteArray::number(webMapController->getQueueDepth()));
+    writeResponse(response, imageEncoder->encode(mapPixmap.image, format, quality));
   }
   else
     // Show error message as image
@@ -345,6 +446,8 @@ inline void RequestHandler::handleWebApiRequest(HttpRequest& request, HttpRespon
   apiRequest.body = request.getBody();
 
   // Call API in-sync
+  QElapsedTimer timer;
+  timer.start();
   WebApiResponse result = emit serviceWebApi(apiRequest);
 
   // Map API response
@@ -353,8 +456,23 @@ inline void RequestHandler::handleWebApiRequest(HttpRequest& request, HttpRespon
   for (auto it = result.headers.constBegin(); it != result.headers.constEnd(); ++it)
       response.setHeader(it.key(),it.value());
 
-  // Write output
-  response.write(result.body, true);
+  // Time spent in the main thread for benchmark.html
+  response.setHeader("Server-Timing", "app;dur=" + QByteArray::number(timer.nsecsElapsed() / 1000000.));
+
+  // Write output and compress text if not already done by the controller
+  if(!result.image.isNull())
+  {
+    // Encode image here to keep the main thread free
+    ImageEncoder::Format format;
+    int quality;
+    ImageEncoder::parse(format, quality, QString(result.imageFormat), QString(result.imageQuality));
+    response.setHeader("Content-Type", ImageEncoder::contentType(format));
+    writeResponse(response, imageEncoder->encode(result.image, format, quality), true);
+  }
+  else if(result.headers.contains("Content-Encoding"))
+    writeResponse(response, result.body, true);
+  else
+    bytesWritten += webtools::writeBody(request, response, result.body, result.headers.value("Content-Type"));
 }
 
 
@@ -406,7 +524,7 @@ inline void RequestHandler::handleHtmlFileRequest(HttpRequest& request, HttpResp
 
       atools::fs::sc::SimConnectUserAircraft userAircraft;
       if(t.contains(QStringLiteral(u"{aircraftProgressText}")) || t.contains(QStringLiteral(u"{aircraftText}")))
-        userAircraft = emit getUserAircraft();
+        userAircraft = webSnapshot->getUserAircraft();
 
       if(t.contains(QStringLiteral(u"{aircraftText}")))
       {
@@ -420,7 +538,7 @@ inline void RequestHandler::handleHtmlFileRequest(HttpRequest& request, HttpResp
       // Aircraft progress
       if(t.contains(QStringLiteral(u"{aircraftProgressText}")))
       {
-        Route route = emit getRoute();
+        Route route = webSnapshot->getRoute();
         html.clear();
 
         // Additional required progress fields are defined in aircraftprogressconfig.cpp in vector ADDITIONAL_WEB_IDS
@@ -433,7 +551,7 @@ inline void RequestHandler::handleHtmlFileRequest(HttpRequest& request, HttpResp
       // ===========================================================================
       // Flight plan
       if(t.contains(QStringLiteral(u"{flightplanText}")))
-        t.setVariable(QStringLiteral(u"flightplanText"), emit getFlightplanTableAsHtml(20, false));
+        t.setVariable(QStringLiteral(u"flightplanText"), webSnapshot->getFlightplanTableAsHtml());
 
       // ===========================================================================
       // Airport information
@@ -448,7 +566,7 @@ inline void RequestHandler::handleHtmlFileRequest(HttpRequest& request, HttpResp
         if(!ident.isEmpty())
         {
           // Get airport information as HTML in the string list. Order is main, runway, com, procedure and weather.
-          QStringList airportTexts = emit getAirportText(ident);
+          QStringList airportTexts = webSnapshot->getAirportText(ident);
 
           if(airportTexts.size() == 5)
           {
@@ -484,7 +602,7 @@ inline void RequestHandler::handleHtmlFileRequest(HttpRequest& request, HttpResp
 
       // ===========================================================================
       // Write resonse
-      response.write(t.toUtf8(), true);
+      bytesWritten += webtools::writeBody(request, response, t.toUtf8(), "text/html; charset=UTF-8");
     }
     else
       showError(request, response, 500, QStringLiteral(u"Internal server error. Template empty."));
@@ -494,8 +612,8 @@ void RequestHandler::showErrorPixmap(HttpResponse& response, int width, int heig
 {
   qWarning() << Q_FUNC_INFO << "Error" << status << text;
 
-  // Create pixmap
-  QPixmap pixmap(width, height);
+  // Create image - pixmaps cannot be used outside the main thread
+  QImage pixmap(width, height, QImage::Format_RGB32);
   pixmap.fill(QColor(Qt::white));
 
   // Prepare painter and font
@@ -521,7 +639,7 @@ void RequestHandler::showErrorPixmap(HttpResponse& response, int width, int heig
   // Write to response
   response.setHeader("Content-Type", "image/jpeg");
   response.setStatus(status);
-  response.write(bytes);
+  writeResponse(response, bytes);
 }
 
 void RequestHandler::showError(HttpRequest& request, HttpResponse& response, int status, const QString& text)
@@ -538,7 +656,7 @@ void RequestHandler::showError(HttpRequest& request, HttpResponse& response, int
   // Write to response
   response.setHeader("Content-Type", "text/html; charset=UTF-8");
   response.setStatus(status);
-  response.write(t.toUtf8(), true);
+  writeResponse(response, t.toUtf8(), true);
 }
 
 stefanfrings::HttpSession RequestHandler::getSession(HttpRequest& request, HttpResponse& response)
@@ -553,7 +671,7 @@ stefanfrings::HttpSession RequestHandler::getSession(HttpRequest& request, HttpR
   else
   {
     // Session does not exist - initialize with defaults from current map view
-    atools::geo::Pos pos = emit getCurrentMapWidgetPos();
+    atools::geo::Pos pos = webSnapshot->getCurrentMapWidgetPos();
     session.set("lon", pos.getLonX());
     session.set("lat", pos.getLatY());
     session.set("requested_distance", QVariant(atools::geo::nmToKm(32.0f)));             // 32.0 is the default JS delivers from new web ui HTML default
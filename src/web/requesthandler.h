@@ -26,6 +26,7 @@
 #include "webapi/webapirequest.h"
 #include "webapi/webapiresponse.h"
 
+#include <QAtomicInteger>
 #include <QPixmap>
 
 #include "geo/pos.h"
@@ -39,6 +40,10 @@ class HttpSession;
 }
 
 class HtmlInfoBuilder;
+class WebSnapshot;
+class WebPushChannel;
+class WebMetrics;
+class ImageEncoder;
 
 /*
  * Handles all HTTP server requests including stateless and stateful. Maintains a session for the stateful page.
@@ -55,28 +60,22 @@ class RequestHandler :
 public:
   /* Prepare connections to other objects. Handler is ready to accept connections when instantiated. */
   RequestHandler(QObject *parent, WebMapController *webMapController, WebApiController *webApiController,
-                 HtmlInfoBuilder *htmlInfoBuilderParam, bool verboseParam);
+                 WebSnapshot *webSnapshotParam, WebPushChannel *webPushChannelParam, WebMetrics *webMetricsParam,
+                 ImageEncoder *imageEncoderParam, HtmlInfoBuilder *htmlInfoBuilderParam, bool verboseParam);
   virtual ~RequestHandler() override;
 
   /* Doing all the work right here. */
   void service(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response) override;
 
+  /* Milliseconds since Epoch of the last request. Thread safe. */
+  qint64 getLastRequestTimeMs() const
+  {
+    return lastRequestTimeMs.loadAcquire();
+  }
+
 signals:
-  /* Calls to the MapPaintWidget have to run in the main event queue and thread.
-   * Therefore, it is necessary to use queued signals to separate
-   * a thread from the HTTP server.*/
-  MapPixmap getPixmap(int width, int height);
-  MapPixmap getPixmapObject(int width, int height, web::ObjectType type, const QString& ident, float distanceKm);
-  MapPixmap getPixmapPosDistance(int width, int height, atools::geo::Pos pos, float distanceKm, const QString& mapCommand, const QString& errorCase = QLatin1String(""));
-  MapPixmap getPixmapRect(int width, int height, atools::geo::Rect rect, const QString& errorCase = tr("Invalid rectangle"));
-
-  atools::fs::sc::SimConnectUserAircraft getUserAircraft();
-  Route getRoute();
-  QString getFlightplanTableAsHtml(int iconSize, bool print);
-  QStringList getAirportText(QString ident);
-  atools::geo::Pos getCurrentMapWidgetPos();
-
-  /* Calls to WebApiController */
+  /* Calls to WebApiController which have to run in the main thread.
+   * Read only page data comes from WebSnapshot and map images use the render queue in WebMapController instead. */
   WebApiResponse serviceWebApi(WebApiRequest& request);
 
 private:
@@ -96,18 +95,35 @@ private:
   /* Handle stateful and stateless api requests. */
   void handleWebApiRequest(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response);
 
+  /* Handle server-sent event stream requests for path /events. Keeps the connection and thread until the
+   * client disconnects or the server is stopped.
+   * Parameters are "topics" as comma separated list of "sim" and "progress" and "delta" which
+   * sends only changed values for JSON topics if "true". */
+  void handleEventStream(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response);
+
   /* Handle html file requests. */
   void handleHtmlFileRequest(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response, stefanfrings::HttpSession& session, QString& file, const QString& extension);
 
   /* Build the select dropdown box HTML code with the default value pre-selected. */
   QString buildRefreshSelect(int defaultValue);
 
+  /* Endpoint name for metrics like "api/sim/info" for the request path */
+  QByteArray metricsKey(const QString& path) const;
+
   /* Create and prepare a session and set the cookie or return current session */
   stefanfrings::HttpSession getSession(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response);
 
+  WebMapController *webMapController;
   WebApiController *webApiController;
+  WebSnapshot *webSnapshot;
+  WebPushChannel *webPushChannel;
+  WebMetrics *webMetrics;
+  ImageEncoder *imageEncoder;
   HtmlInfoBuilder *htmlInfoBuilder;
 
+  /* Updated from the HTTP server threads */
+  QAtomicInteger<qint64> lastRequestTimeMs = 0;
+
   bool verbose = false;
 };
 
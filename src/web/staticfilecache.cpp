@@ -0,0 +1,121 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "web/staticfilecache.h"
+
+#include "web/webtools.h"
+#include "httpserver/httprequest.h"
+#include "httpserver/httpresponse.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+using namespace stefanfrings;
+
+/* Do not load larger files into memory */
+static const qint64 MAX_FILE_SIZE = 8 * 1024 * 1024;
+
+namespace  {
+
+QByteArray readFile(const QString& filename)
+{
+  QFile file(filename);
+  if(file.open(QIODevice::ReadOnly))
+    return file.readAll();
+  else
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+    return QByteArray();
+  }
+}
+
+}
+
+StaticFileCache::StaticFileCache(int maxAgeMsParam, int cacheSizeKb)
+  : maxAgeS(maxAgeMsParam / 1000)
+{
+  cache.setMaxCost(cacheSizeKb);
+}
+
+qint64 StaticFileCache::service(const HttpRequest& request, HttpResponse& response, const QFileInfo& fileInfo)
+{
+  // Files are installed with the application - include version since modification time might not change
+  QByteArray etag = '"' + QByteArray::number(fileInfo.size(), 16) + '-' +
+                    QByteArray::number(fileInfo.lastModified().toMSecsSinceEpoch(), 16) + '-' +
+                    QCoreApplication::applicationVersion().toUtf8() + '"';
+
+  response.setHeader("ETag", etag);
+  response.setHeader("Cache-Control", "max-age=" + QByteArray::number(maxAgeS));
+
+  if(request.getHeader("If-None-Match") == etag)
+  {
+    // Client copy is valid ========================
+    response.setStatus(304, "Not Modified");
+    response.write(QByteArray(), true);
+    return 0;
+  }
+
+  QByteArray contentType = webtools::compressibleContentType(fileInfo.fileName());
+  if(contentType.isEmpty() || fileInfo.size() > MAX_FILE_SIZE)
+    // Binary or too large - leave for the static file controller
+    return -1;
+
+  QByteArray data, encoding;
+  QFileInfo gzFileInfo(fileInfo.filePath() + ".gz");
+  if(gzFileInfo.exists() && gzFileInfo.lastModified() >= fileInfo.lastModified() &&
+     webtools::acceptsEncoding(request, "gzip"))
+  {
+    // Use file compressed at build or installation time ========================
+    data = readFile(gzFileInfo.filePath());
+    encoding = "gzip";
+  }
+  else if(webtools::acceptsEncoding(request, "deflate"))
+  {
+    // Compress once and cache ========================
+    encoding = "deflate";
+    {
+      QMutexLocker locker(&mutex);
+      Entry *entry = cache.object(fileInfo.filePath());
+      if(entry != nullptr && entry->etag == etag)
+        data = entry->data;
+    }
+
+    if(data.isEmpty())
+    {
+      QByteArray raw = readFile(fileInfo.filePath());
+      if(raw.isEmpty())
+        return -1;
+      data = webtools::deflate(raw);
+
+      QMutexLocker locker(&mutex);
+      cache.insert(fileInfo.filePath(), new Entry({etag, data}), data.size() / 1024 + 1);
+    }
+  }
+  else
+    return -1;
+
+  if(data.isEmpty())
+    return -1;
+
+  response.setHeader("Content-Type", contentType);
+  response.setHeader("Content-Encoding", encoding);
+  response.setHeader("Vary", "Accept-Encoding");
+  response.write(data, true);
+  return data.size();
+}
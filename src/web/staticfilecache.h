@@ -0,0 +1,62 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_STATICFILECACHE_H
+#define LNM_STATICFILECACHE_H
+
+#include <QCache>
+#include <QMutex>
+
+namespace stefanfrings {
+class HttpRequest;
+class HttpResponse;
+}
+
+class QFileInfo;
+
+/*
+ * Serves static text files like JavaScript, CSS and SVG compressed if the client accepts it.
+ * Uses precompressed files with extension ".gz" beside the original if present and newer.
+ * Otherwise files are compressed once and kept in memory until modified.
+ *
+ * Adds ETag and Cache-Control headers and answers matching If-None-Match requests with 304.
+ * All methods are thread safe.
+ */
+class StaticFileCache
+{
+public:
+  StaticFileCache(int maxAgeMsParam, int cacheSizeKb);
+
+  StaticFileCache(const StaticFileCache& other) = delete;
+  StaticFileCache& operator=(const StaticFileCache& other) = delete;
+
+  /* Writes response and returns number of bytes written. Returns -1 if not done. Then only ETag and caching
+   * headers are set and the caller has to serve the file the usual way. */
+  qint64 service(const stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response, const QFileInfo& fileInfo);
+
+private:
+  struct Entry
+  {
+    QByteArray etag, data;
+  };
+
+  QCache<QString, Entry> cache;
+  QMutex mutex;
+  int maxAgeS;
+};
+
+#endif // LNM_STATICFILECACHE_H
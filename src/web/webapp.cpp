@@ -22,10 +22,12 @@
 #include "httpserver/httpsessionstore.h"
 #include "templateengine/templatecache.h"
 #include "httpserver/staticfilecontroller.h"
+#include "web/staticfilecache.h"
 
 stefanfrings::TemplateCache *WebApp::templateCache = nullptr;
 stefanfrings::HttpSessionStore *WebApp::sessionStore = nullptr;
 stefanfrings::StaticFileController *WebApp::staticFileController = nullptr;
+StaticFileCache *WebApp::staticFileCache = nullptr;
 
 atools::io::IniKeyValues WebApp::templateCacheSettings;
 atools::io::IniKeyValues WebApp::sessionSettings;
@@ -63,9 +65,15 @@ void WebApp::init(QObject *parent, const QString& configFileName, const QString&
     staticFileControllerSettings.insert("path", docrootParam);
   staticFileControllerSettings.insert("filename", configFileName);
   staticFileController = new stefanfrings::StaticFileController(staticFileControllerSettings, parent);
+
+  staticFileCache = new StaticFileCache(staticFileControllerSettings.value("maxAge", 60000).toInt(),
+                                        staticFileControllerSettings.value("compressedCacheSizeKb", 4096).toInt());
 }
 
 void WebApp::deinit()
 {
   qDebug() << Q_FUNC_INFO;
+
+  delete staticFileCache;
+  staticFileCache = nullptr;
 }
@@ -27,6 +27,7 @@ class HttpListener;
 class StaticFileController;
 }
 
+class StaticFileCache;
 class QSettings;
 class QString;
 class QObject;
@@ -59,6 +60,11 @@ public:
     return staticFileController;
   }
 
+  static StaticFileCache *getStaticFileCache()
+  {
+    return staticFileCache;
+  }
+
   static const QString& getDocroot()
   {
     return documentRoot;
@@ -83,6 +89,9 @@ private:
   /* Controller for static files */
   static stefanfrings::StaticFileController *staticFileController;
 
+  /* Compressed text files and caching headers */
+  static StaticFileCache *staticFileCache;
+
   static atools::io::IniKeyValues templateCacheSettings, sessionSettings, staticFileControllerSettings;
 
   static QString documentRoot, htmlExtension;
@@ -20,6 +20,10 @@
 #include "settings/settings.h"
 #include "web/requesthandler.h"
 #include "web/webmapcontroller.h"
+#include "web/websnapshot.h"
+#include "web/webpushchannel.h"
+#include "web/webmetrics.h"
+#include "web/imageencoder.h"
 #include "webapi/webapicontroller.h"
 #include "web/webapp.h"
 #include "gui/helphandler.h"
@@ -29,17 +33,22 @@
 
 #include <QSettings>
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QStandardPaths>
 #include <QDir>
 #include <QMessageBox>
 #include <QWidget>
 #include <QHostInfo>
 #include <QNetworkInterface>
+#include <QThread>
 
 #include <options/optiondata.h>
 
 using namespace stefanfrings;
 
+/* Clients are considered active if a request arrived within this time */
+const static qint64 WEB_CLIENT_ACTIVE_MS = 10000;
+
 WebController::WebController(QWidget *parent) :
   QObject(parent), parentWidget(parent)
 {
@@ -57,11 +66,28 @@ WebController::WebController(QWidget *parent) :
 
   verbose = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_WEBSERVER_DEBUG, false).toBool();
 
+  // Worker threads and keep-alive time. Maximum number of threads is also the maximum number of connections.
+  // Defaults from configuration file
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  listenerSettings.insert("minThreads", settings.getAndStoreValue(lnm::OPTIONS_WEB_MIN_THREADS,
+                                                                  listenerSettings.value("minThreads", 2)).toInt());
+  listenerSettings.insert("maxThreads", settings.getAndStoreValue(lnm::OPTIONS_WEB_MAX_THREADS,
+                                                                  listenerSettings.value("maxThreads", 32)).toInt());
+  listenerSettings.insert("readTimeout", settings.getAndStoreValue(lnm::OPTIONS_WEB_KEEP_ALIVE_MS,
+                                                                   listenerSettings.value("readTimeout", 60000)).toInt());
+
   // Remember any custom set certificates for later
   sslKeyFile = listenerSettings.value("sslKeyFile").toString();
   sslCertFile = listenerSettings.value("sslCertFile").toString();
 
+  metrics = new WebMetrics;
+
+  // Leave some cores for rendering in the main thread
+  imageEncoder = new ImageEncoder(settings.getAndStoreValue(lnm::OPTIONS_WEB_ENCODE_THREADS,
+                                                            std::max(QThread::idealThreadCount() / 2, 1)).toInt());
+
   mapController = new WebMapController(parentWidget, verbose);
+  mapController->setMetrics(metrics);
   apiController = new WebApiController(parentWidget, verbose);
 
   htmlInfoBuilder = new HtmlInfoBuilder(parent, mapController->getMapPaintWidget(), true /*info*/, true /*print*/);
@@ -77,6 +103,8 @@ WebController::~WebController()
   delete mapController;
   delete apiController;
   delete htmlInfoBuilder;
+  delete metrics;
+  delete imageEncoder;
 }
 
 void WebController::startServer()
@@ -105,7 +133,10 @@ void WebController::startServer()
   // Start map
   mapController->init();
 
-  requestHandler = new RequestHandler(this, mapController, apiController, htmlInfoBuilder, verbose);
+  snapshot = new WebSnapshot(this, verbose);
+  pushChannel = new WebPushChannel(this, htmlInfoBuilder, verbose);
+  requestHandler = new RequestHandler(this, mapController, apiController, snapshot, pushChannel, metrics,
+                                      imageEncoder, htmlInfoBuilder, verbose);
 
   // Set port - always override configuration file
   listenerSettings.insert("port", port);
@@ -217,6 +248,10 @@ void WebController::stopServer()
 
   mapController->deInit();
 
+  // Let event stream threads return before the listener waits for them
+  if(pushChannel != nullptr)
+    pushChannel->shutdown();
+
   if(listener != nullptr)
     listener->close();
 
@@ -226,6 +261,12 @@ void WebController::stopServer()
   delete requestHandler;
   requestHandler = nullptr;
 
+  delete snapshot;
+  snapshot = nullptr;
+
+  delete pushChannel;
+  pushChannel = nullptr;
+
   hosts.clear();
 
   WebApp::deinit();
@@ -257,6 +298,13 @@ bool WebController::isRunning() const
   return listener != nullptr && listener->isListening();
 }
 
+bool WebController::hasActiveClients() const
+{
+  // Pages refresh at least every few seconds if clients show the map or aircraft
+  return isRunning() && requestHandler != nullptr &&
+         QDateTime::currentMSecsSinceEpoch() - requestHandler->getLastRequestTimeMs() < WEB_CLIENT_ACTIVE_MS;
+}
+
 QUrl WebController::getUrl(bool useIpAddress) const
 {
   if(hosts.isEmpty())
@@ -343,6 +391,8 @@ WebMapController *WebController::getWebMapController() const
 void WebController::preDatabaseLoad()
 {
   mapController->preDatabaseLoad();
+  if(snapshot != nullptr)
+    snapshot->preDatabaseLoad();
 }
 
 void WebController::postDatabaseLoad()
@@ -31,6 +31,10 @@ class HttpListener;
 class RequestHandler;
 class WebMapController;
 class WebApiController;
+class WebSnapshot;
+class WebPushChannel;
+class WebMetrics;
+class ImageEncoder;
 class HtmlInfoBuilder;
 class QSettings;
 
@@ -65,6 +69,9 @@ public:
   /* True if server is listening */
   bool isRunning() const;
 
+  /* True if server is running and clients sent requests recently */
+  bool hasActiveClients() const;
+
   /* Get the default url. Usually hostname and port or IP and port as fallback. */
   QUrl getUrl(bool useIpAddress) const;
 
@@ -114,6 +121,28 @@ public:
 
   WebMapController *getWebMapController() const;
 
+  /* Request and render statistics. Thread safe. */
+  const WebMetrics *getMetrics() const
+  {
+    return metrics;
+  }
+
+  /* Worker thread and keep-alive settings as used by the listener */
+  int getMinThreads() const
+  {
+    return listenerSettings.value("minThreads").toInt();
+  }
+
+  int getMaxThreads() const
+  {
+    return listenerSettings.value("maxThreads").toInt();
+  }
+
+  int getKeepAliveMs() const
+  {
+    return listenerSettings.value("readTimeout").toInt();
+  }
+
   /* Need to clear caches and tear down queries in map widget before switching database */
   void preDatabaseLoad();
 
@@ -133,6 +162,18 @@ private:
   /* Web API controller */
   WebApiController *apiController = nullptr;
 
+  /* Thread safe copies of aircraft, route and other data for the request handler. Only while running. */
+  WebSnapshot *snapshot = nullptr;
+
+  /* Server-sent events for simulator and progress updates. Only while running. */
+  WebPushChannel *pushChannel = nullptr;
+
+  /* Kept over server restarts */
+  WebMetrics *metrics = nullptr;
+
+  /* Encodes map images in server threads */
+  ImageEncoder *imageEncoder = nullptr;
+
   /* Handles all HTTP requests using templates or static */
   RequestHandler *requestHandler = nullptr;
 
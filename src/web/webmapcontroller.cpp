@@ -18,11 +18,38 @@
 #include "web/webmapcontroller.h"
 
 #include "mapgui/mappaintwidget.h"
+#include "mapgui/mapthemehandler.h"
 #include "mapgui/mapwidget.h"
 #include "app/navapp.h"
+#include "common/constants.h"
+#include "settings/settings.h"
+#include "web/webmetrics.h"
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QPixmap>
+#include <QSharedPointer>
+#include <QWaitCondition>
+
+/* Forget client assignments if there are more clients */
+const static int MAX_CLIENTS = 100;
+
+namespace {
+
+/* Shared between waiting HTTP thread and main thread */
+struct RenderJob
+{
+  QMutex mutex;
+  QWaitCondition condition;
+  bool started = false, done = false, cancelled = false;
+  MapPixmap result;
+
+  /* Started when queuing. Holds time in queue and rendering time for metrics. */
+  QElapsedTimer timer;
+  qint64 queueUs = 0, renderUs = 0;
+};
+
+}
 
 WebMapController::WebMapController(QWidget *parent, bool verboseParam)
   : QObject(parent), parentWidget(parent), verbose(verboseParam)
@@ -42,21 +69,127 @@ void WebMapController::init()
 
   deInit();
 
-  // Create a map widget clone with the desired resolution
-  mapPaintWidget = new MapPaintWidget(parentWidget, false /* no real widget - hidden */);
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  int numWidgets = std::max(1, std::min(settings.getAndStoreValue(lnm::OPTIONS_WEB_MAP_WIDGETS, 3).toInt(), 8));
+  renderTimeoutMs = std::max(1000, settings.getAndStoreValue(lnm::OPTIONS_WEB_RENDER_TIMEOUT_MS, 10000).toInt());
 
-  // Activate painting
-  mapPaintWidget->setActive();
+  for(int i = 0; i < numWidgets; i++)
+  {
+    // Create a map widget clone with the desired resolution
+    MapPaintWidget *widget = new MapPaintWidget(parentWidget, false /* no real widget - hidden */);
+
+    // Theme is copied from the map window before rendering but keys are not
+    widget->setKeys(NavApp::getMapThemeHandler()->getMapThemeKeysHash());
+
+    // Activate painting
+    widget->setActive();
+    mapPaintWidgets.append(widget);
+  }
+  mapPaintWidget = mapPaintWidgets.constFirst();
 }
 
 void WebMapController::deInit()
 {
   qDebug() << Q_FUNC_INFO;
 
-  delete mapPaintWidget;
+  qDeleteAll(mapPaintWidgets);
+  mapPaintWidgets.clear();
+  clientWidgetIndex.clear();
+  nextWidgetIndex = 0;
   mapPaintWidget = nullptr;
 }
 
+MapPaintWidget *WebMapController::paintWidgetForClient(const QByteArray& clientKey)
+{
+  if(mapPaintWidgets.isEmpty())
+    return nullptr;
+
+  if(!clientWidgetIndex.contains(clientKey))
+  {
+    if(clientWidgetIndex.size() > MAX_CLIENTS)
+      clientWidgetIndex.clear();
+
+    clientWidgetIndex.insert(clientKey, nextWidgetIndex);
+    nextWidgetIndex = (nextWidgetIndex + 1) % mapPaintWidgets.size();
+  }
+  return mapPaintWidgets.at(clientWidgetIndex.value(clientKey) % mapPaintWidgets.size());
+}
+
+MapPixmap WebMapController::renderQueued(const QByteArray& clientKey, const std::function<MapPixmap(WebMapController *)>& func)
+{
+  QSharedPointer<RenderJob> job(new RenderJob);
+  job->timer.start();
+
+  int depth = ++queueDepth;
+  int maxDepth = maxQueueDepth.loadAcquire();
+  while(depth > maxDepth && !maxQueueDepth.testAndSetOrdered(maxDepth, depth))
+    maxDepth = maxQueueDepth.loadAcquire();
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "client" << clientKey << "queue depth" << depth;
+
+  // Run in main thread event queue
+  QMetaObject::invokeMethod(this, [this, job, clientKey, func]() -> void {
+    {
+      QMutexLocker locker(&job->mutex);
+      if(job->cancelled)
+        return;
+      job->started = true;
+      job->queueUs = job->timer.nsecsElapsed() / 1000;
+    }
+
+    mapPaintWidget = paintWidgetForClient(clientKey);
+    MapPixmap result = func(this);
+    mapPaintWidget = mapPaintWidgets.value(0);
+
+    // Encoding is done in the server thread which cannot use pixmaps
+    result.image = result.pixmap.toImage();
+    result.pixmap = QPixmap();
+
+    QMutexLocker locker(&job->mutex);
+    job->renderUs = job->timer.nsecsElapsed() / 1000 - job->queueUs;
+    job->result = result;
+    job->done = true;
+    job->condition.wakeAll();
+  }, Qt::QueuedConnection);
+
+  MapPixmap result;
+  {
+    QMutexLocker locker(&job->mutex);
+    while(!job->done)
+    {
+      if(!job->condition.wait(&job->mutex, static_cast<unsigned long>(renderTimeoutMs)) && !job->started)
+      {
+        // Still waiting in queue - drop it
+        job->cancelled = true;
+        break;
+      }
+      // else rendering already started - wait for it
+    }
+
+    if(job->done)
+      result = job->result;
+  }
+
+  queueDepth--;
+
+  if(metrics != nullptr)
+  {
+    QMutexLocker locker(&job->mutex);
+    metrics->record("render-queue", job->started ? job->queueUs : job->timer.nsecsElapsed() / 1000, 0);
+    if(job->done)
+      metrics->record("render", job->renderUs, 0);
+  }
+
+  if(job->cancelled)
+  {
+    numTimeouts++;
+    qWarning() << Q_FUNC_INFO << "Render timeout for client" << clientKey << "queue depth" << depth;
+    result.error = tr("Map rendering timed out");
+  }
+  return result;
+}
+
 MapPixmap WebMapController::getPixmap(int width, int height)
 {
   if(verbose)
@@ -229,14 +362,26 @@ MapPaintWidget *WebMapController::getMapPaintWidget() const
   return mapPaintWidget;
 }
 
+void WebMapController::setTheme(const QString& themePath, const QString& themeId)
+{
+  for(MapPaintWidget *widget : qAsConst(mapPaintWidgets))
+    widget->setTheme(themePath, themeId);
+}
+
+void WebMapController::setKeys(const QHash<QString, QString>& keys)
+{
+  for(MapPaintWidget *widget : qAsConst(mapPaintWidgets))
+    widget->setKeys(keys);
+}
+
 void WebMapController::preDatabaseLoad()
 {
-  if(mapPaintWidget != nullptr)
-    mapPaintWidget->preDatabaseLoad();
+  for(MapPaintWidget *widget : qAsConst(mapPaintWidgets))
+    widget->preDatabaseLoad();
 }
 
 void WebMapController::postDatabaseLoad()
 {
-  if(mapPaintWidget != nullptr)
-    mapPaintWidget->postDatabaseLoad();
+  for(MapPaintWidget *widget : qAsConst(mapPaintWidgets))
+    widget->postDatabaseLoad();
 }
@@ -22,9 +22,16 @@
 
 #include "geo/rect.h"
 
+#include <QAtomicInt>
+#include <QHash>
 #include <QMutex>
+#include <QImage>
 #include <QPixmap>
+#include <QVector>
 
+#include <functional>
+
+class WebMetrics;
 class QPixmap;
 class MapPaintWidget;
 
@@ -34,6 +41,9 @@ class MapPaintWidget;
 struct MapPixmap
 {
   QPixmap pixmap;
+
+  /* Converted from pixmap after rendering in renderQueued() since pixmaps can only be used in the main thread */
+  QImage image;
   atools::geo::Pos pos; /* Map center */
   float requestedDistanceKm, /* Requested zoom distance */
         correctedDistanceKm; /* Actual zoom distance which can differ from above due to blur avoidance. */
@@ -53,12 +63,12 @@ struct MapPixmap
 
   bool isValid() const
   {
-    return !pixmap.isNull();
+    return !pixmap.isNull() || !image.isNull();
   }
 
   bool isInvalid() const
   {
-    return pixmap.isNull();
+    return !isValid();
   }
 
 };
@@ -69,8 +79,11 @@ struct MapPixmap
  * The map widget has a state, i.e. it remains in the last shown position and zoom value.
  * Settings are copied from normal visible map window before rendering.
  *
- * This has to run in the main thread and event queue. Therefore, it is necessary to use queued signals to separate
- * a thread from the HTTP server.
+ * This has to run in the main thread and event queue. HTTP server threads use renderQueued() which posts
+ * the request into the main event queue and waits for the result with a timeout.
+ *
+ * A small pool of map paint widgets is used. Each client gets its own widget assigned which keeps the map query
+ * caches warm for the area the client is looking at.
  *
  * All methods avoid a blurry map by zoomin out to the next best level. This can result in different distances
  * than expected.
@@ -104,9 +117,40 @@ public:
   /* Zoom to rectangel on map. */
   MapPixmap getPixmapRect(int width, int height, atools::geo::Rect rect, const QString& errorCase = tr("Invalid rectangle"));
 
-  /* Get the map paint widget */
+  /* Thread safe. Queue func for execution in the main thread using the paint widget assigned to clientKey and
+   * wait for the result. The result contains an image instead of a pixmap. A job which was not started before the render timeout elapsed is dropped and
+   * a pixmap with an error message is returned. */
+  MapPixmap renderQueued(const QByteArray& clientKey, const std::function<MapPixmap(WebMapController *)>& func);
+
+  /* Render queue metrics. Number of jobs waiting or rendering, maximum since start and dropped jobs. */
+  int getQueueDepth() const
+  {
+    return queueDepth.loadAcquire();
+  }
+
+  int getMaxQueueDepth() const
+  {
+    return maxQueueDepth.loadAcquire();
+  }
+
+  int getNumTimeouts() const
+  {
+    return numTimeouts.loadAcquire();
+  }
+
+  /* Records queue wait and render time if set */
+  void setMetrics(WebMetrics *value)
+  {
+    metrics = value;
+  }
+
+  /* Get the first map paint widget */
   MapPaintWidget* getMapPaintWidget() const;
 
+  /* Apply map theme and API keys to all widgets in the pool */
+  void setTheme(const QString& themePath, const QString& themeId);
+  void setKeys(const QHash<QString, QString>& keys);
+
   /* Need to clear caches and tear down queries before switching database */
   void preDatabaseLoad();
 
@@ -114,7 +158,19 @@ public:
   void postDatabaseLoad();
 
 private:
+  /* Get widget for client and assign a new one round robin if not known yet. Main thread only. */
+  MapPaintWidget *paintWidgetForClient(const QByteArray& clientKey);
+
+  /* Paint widget used by the getPixmap methods. Points to the first widget or the one of the current client. */
   MapPaintWidget *mapPaintWidget = nullptr;
+  QVector<MapPaintWidget *> mapPaintWidgets;
+
+  /* Maps client key to index in mapPaintWidgets */
+  QHash<QByteArray, int> clientWidgetIndex;
+  int nextWidgetIndex = 0, renderTimeoutMs = 10000;
+
+  QAtomicInt queueDepth, maxQueueDepth, numTimeouts;
+  WebMetrics *metrics = nullptr;
   QMutex mapPaintWidgetMutex;
 
   QWidget *parentWidget;
@@ -0,0 +1,94 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "web/webmetrics.h"
+
+#include <algorithm>
+#include <cmath>
+
+/* Number of latest samples per endpoint used for percentiles */
+static const int MAX_SAMPLES = 1000;
+
+namespace  {
+
+/* Nearest rank percentile from sorted vector in milliseconds */
+float percentileMs(const QVector<qint64>& sorted, int percent)
+{
+  if(sorted.isEmpty())
+    return 0.f;
+
+  int index = std::min(static_cast<int>(std::ceil(sorted.size() * percent / 100.)) - 1, sorted.size() - 1);
+  return sorted.at(std::max(index, 0)) / 1000.f;
+}
+
+}
+
+void WebMetrics::record(const QByteArray& key, qint64 durationUs, qint64 bytes)
+{
+  QMutexLocker locker(&mutex);
+  Samples& s = samples[key];
+  s.count++;
+  s.bytes += bytes;
+
+  if(s.durationsUs.size() < MAX_SAMPLES)
+    s.durationsUs.append(durationUs);
+  else
+  {
+    s.durationsUs[s.next] = durationUs;
+    s.next = (s.next + 1) % MAX_SAMPLES;
+  }
+}
+
+void WebMetrics::requestStarted()
+{
+  int active = ++activeRequests;
+  int maxActive = maxActiveRequests.loadAcquire();
+  while(active > maxActive && !maxActiveRequests.testAndSetOrdered(maxActive, active))
+    maxActive = maxActiveRequests.loadAcquire();
+}
+
+void WebMetrics::requestFinished()
+{
+  activeRequests--;
+}
+
+QVector<WebMetrics::Stat> WebMetrics::getStats() const
+{
+  QVector<Stat> stats;
+  QMutexLocker locker(&mutex);
+  for(auto it = samples.constBegin(); it != samples.constEnd(); ++it)
+  {
+    QVector<qint64> sorted(it->durationsUs);
+    std::sort(sorted.begin(), sorted.end());
+
+    stats.append({it.key(), it->count, it->bytes, percentileMs(sorted, 50), percentileMs(sorted, 95),
+                  percentileMs(sorted, 99), sorted.isEmpty() ? 0.f : sorted.constLast() / 1000.f});
+  }
+  locker.unlock();
+
+  std::sort(stats.begin(), stats.end(), [](const Stat& stat1, const Stat& stat2) -> bool {
+    return stat1.key < stat2.key;
+  });
+  return stats;
+}
+
+void WebMetrics::clear()
+{
+  QMutexLocker locker(&mutex);
+  samples.clear();
+  maxActiveRequests.storeRelease(activeRequests.loadAcquire());
+}
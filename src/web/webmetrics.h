@@ -0,0 +1,87 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_WEBMETRICS_H
+#define LNM_WEBMETRICS_H
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+
+/*
+ * Collects request counts, latency percentiles and bytes sent per endpoint for the web server.
+ * Latency percentiles are calculated from the last samples of each endpoint.
+ *
+ * All methods are thread safe.
+ */
+class WebMetrics
+{
+public:
+  WebMetrics() = default;
+
+  WebMetrics(const WebMetrics& other) = delete;
+  WebMetrics& operator=(const WebMetrics& other) = delete;
+
+  /* Summary for one endpoint as returned by getStats() */
+  struct Stat
+  {
+    QByteArray key;
+    qint64 count, bytes;
+    float p50Ms, p95Ms, p99Ms, maxMs;
+  };
+
+  /* Add a sample for key which is an endpoint like "api/sim/info" or "mapimage" */
+  void record(const QByteArray& key, qint64 durationUs, qint64 bytes);
+
+  /* Call at start and end of each request to track busy handler threads */
+  void requestStarted();
+  void requestFinished();
+
+  /* Get statistics for all endpoints sorted by key */
+  QVector<Stat> getStats() const;
+
+  int getActiveRequests() const
+  {
+    return activeRequests.loadAcquire();
+  }
+
+  int getMaxActiveRequests() const
+  {
+    return maxActiveRequests.loadAcquire();
+  }
+
+  /* Remove all samples */
+  void clear();
+
+private:
+  struct Samples
+  {
+    qint64 count = 0, bytes = 0;
+
+    /* Ring buffer of durations */
+    QVector<qint64> durationsUs;
+    int next = 0;
+  };
+
+  QHash<QByteArray, Samples> samples;
+  mutable QMutex mutex;
+
+  QAtomicInt activeRequests, maxActiveRequests;
+};
+
+#endif // LNM_WEBMETRICS_H
@@ -0,0 +1,220 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "web/webpushchannel.h"
+
+#include "app/navapp.h"
+#include "common/constants.h"
+#include "common/htmlinfobuilder.h"
+#include "common/infobuildertypes.h"
+#include "common/jsoninfobuilder.h"
+#include "common/mapcolors.h"
+#include "connect/connectclient.h"
+#include "fs/sc/simconnectdata.h"
+#include "geo/calculations.h"
+#include "info/infocontroller.h"
+#include "route/route.h"
+#include "settings/settings.h"
+#include "util/htmlbuilder.h"
+
+#include <QJsonDocument>
+
+using atools::settings::Settings;
+
+WebPushChannel::WebPushChannel(QObject *parent, HtmlInfoBuilder *htmlInfoBuilderParam, bool verboseParam)
+  : QObject(parent), htmlInfoBuilder(htmlInfoBuilderParam), verbose(verboseParam)
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO;
+
+  jsonInfoBuilder = new JsonInfoBuilder(this);
+
+  updateIntervalMs = std::max(Settings::instance().getAndStoreValue(lnm::OPTIONS_WEB_PUSH_INTERVAL_MS, 500).toInt(), 100);
+  // Every subscriber occupies a server thread - keep some free for other requests
+  maxSubscribers = Settings::instance().getAndStoreValue(lnm::OPTIONS_WEB_PUSH_MAX_SUBSCRIBERS, 16).toInt();
+
+  connect(NavApp::getConnectClient(), &ConnectClient::dataPacketReceived, this, &WebPushChannel::dataPacketReceived);
+}
+
+WebPushChannel::~WebPushChannel()
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO;
+
+  shutdown();
+  delete jsonInfoBuilder;
+}
+
+QByteArray WebPushChannel::topicName(Topic topic)
+{
+  switch(topic)
+  {
+    case WebPushChannel::TOPIC_SIM:
+      return "sim";
+
+    case WebPushChannel::TOPIC_PROGRESS:
+      return "progress";
+
+    case WebPushChannel::NUM_TOPICS:
+      break;
+  }
+  return QByteArray();
+}
+
+bool WebPushChannel::subscribe(const QVector<Topic>& topics)
+{
+  if(isShutdown())
+    return false;
+
+  if(numSubscribers.fetchAndAddOrdered(1) >= maxSubscribers)
+  {
+    numSubscribers.fetchAndAddOrdered(-1);
+    return false;
+  }
+
+  for(Topic topic : topics)
+    subscribers[topic].fetchAndAddOrdered(1);
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "subscribers" << numSubscribers.loadAcquire();
+  return true;
+}
+
+void WebPushChannel::unsubscribe(const QVector<Topic>& topics)
+{
+  for(Topic topic : topics)
+    subscribers[topic].fetchAndAddOrdered(-1);
+  numSubscribers.fetchAndAddOrdered(-1);
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "subscribers" << numSubscribers.loadAcquire();
+}
+
+void WebPushChannel::shutdown()
+{
+  QMutexLocker locker(&mutex);
+  shutdownFlag.storeRelease(1);
+  condition.wakeAll();
+}
+
+QByteArray WebPushChannel::waitForEvents(const QVector<Topic>& topics, QVector<qint64>& lastSequence, bool useDelta,
+                                         int timeoutMs)
+{
+  QMutexLocker locker(&mutex);
+
+  for(int i = 0; i < 2 && !isShutdown(); i++)
+  {
+    QByteArray events;
+    for(int j = 0; j < topics.size(); j++)
+    {
+      const Message& message = messages[topics.at(j)];
+      if(message.sequence > lastSequence.at(j))
+      {
+        // Delta can only be applied if the client got the previous message
+        bool delta = useDelta && !message.delta.isEmpty() && message.sequence == lastSequence.at(j) + 1;
+
+        events.append("event: ").append(topicName(topics.at(j))).append(delta ? "-delta\n" : "\n");
+        events.append("id: ").append(QByteArray::number(message.sequence)).append('\n');
+
+        // Event stream assigns each line to the last data field
+        for(const QByteArray& line : (delta ? message.delta : message.full).split('\n'))
+          events.append("data: ").append(line).append('\n');
+        events.append('\n');
+
+        lastSequence[j] = message.sequence;
+      }
+    }
+
+    if(!events.isEmpty())
+      return events;
+
+    // Nothing new - wait for next publish or timeout and check again
+    if(i == 0)
+      condition.wait(&mutex, static_cast<unsigned long>(timeoutMs));
+  }
+  return QByteArray();
+}
+
+void WebPushChannel::publish(Topic topic, const QByteArray& full, const QByteArray& delta)
+{
+  QMutexLocker locker(&mutex);
+  Message& message = messages[topic];
+
+  // Clients get nothing if there was no change
+  if(message.full != full)
+  {
+    message.sequence++;
+    message.full = full;
+    message.delta = delta;
+    condition.wakeAll();
+  }
+}
+
+QByteArray WebPushChannel::buildDelta(const QJsonObject& last, const QJsonObject& next)
+{
+  QJsonObject delta;
+  for(auto it = next.constBegin(); it != next.constEnd(); ++it)
+  {
+    if(last.value(it.key()) != it.value())
+      delta.insert(it.key(), it.value());
+  }
+
+  // Removed keys are sent as null
+  for(auto it = last.constBegin(); it != last.constEnd(); ++it)
+  {
+    if(!next.contains(it.key()))
+      delta.insert(it.key(), QJsonValue::Null);
+  }
+
+  return QJsonDocument(delta).toJson(QJsonDocument::Compact);
+}
+
+void WebPushChannel::dataPacketReceived(const atools::fs::sc::SimConnectData& simConnectData)
+{
+  if(numSubscribers.loadAcquire() == 0 || (lastUpdate.isValid() && lastUpdate.elapsed() < updateIntervalMs))
+    return;
+  lastUpdate.start();
+
+  if(subscribers[TOPIC_SIM].loadAcquire() > 0)
+  {
+    // Build the same JSON as SimActionsController::infoAction() ========================
+    const atools::fs::sc::SimConnectUserAircraft& aircraft = simConnectData.getUserAircraftConst();
+    InfoBuilderTypes::SimConnectInfoData data = {
+      &simConnectData,
+      aircraft.getWindSpeedKts(),
+      atools::geo::normalizeCourse(aircraft.getWindDirectionDegT() - aircraft.getMagVarDeg())
+    };
+
+    QJsonObject simJson = QJsonDocument::fromJson(jsonInfoBuilder->siminfo(data)).object();
+    QByteArray delta = lastSimJson.isEmpty() ? QByteArray() : buildDelta(lastSimJson, simJson);
+    lastSimJson = simJson;
+
+    publish(TOPIC_SIM, QJsonDocument(simJson).toJson(QJsonDocument::Compact), delta);
+  }
+
+  if(subscribers[TOPIC_PROGRESS].loadAcquire() > 0)
+  {
+    // Build the same HTML as for progress.html ========================
+    atools::util::HtmlBuilder html(mapcolors::webTableBackgroundColor, mapcolors::webTableAltBackgroundColor);
+
+    // Additional required progress fields are defined in aircraftprogressconfig.cpp in vector ADDITIONAL_WEB_IDS
+    html.setIdBits(NavApp::getInfoController()->getEnabledProgressBitsWeb());
+    htmlInfoBuilder->aircraftProgressText(NavApp::getUserAircraft(), html, NavApp::getRouteConst());
+
+    publish(TOPIC_PROGRESS, html.getHtml().toUtf8(), QByteArray());
+  }
+}
@@ -0,0 +1,121 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_WEBPUSHCHANNEL_H
+#define LNM_WEBPUSHCHANNEL_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QMutex>
+#include <QObject>
+#include <QWaitCondition>
+
+namespace atools {
+namespace fs {
+namespace sc {
+class SimConnectData;
+}
+}
+}
+
+class HtmlInfoBuilder;
+class JsonInfoBuilder;
+
+/*
+ * Push channel for server-sent events. Builds simulator information as JSON and aircraft progress as HTML
+ * once per simulator packet, limited to a configured rate, and hands the result out to all subscribers.
+ *
+ * Updates are built in the main thread only if there are subscribers for the topic.
+ * Subscribers wait in the HTTP server threads. See RequestHandler::handleEventStream().
+ */
+class WebPushChannel :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  enum Topic
+  {
+    TOPIC_SIM, /* JSON as delivered by the web API /api/sim/info */
+    TOPIC_PROGRESS, /* HTML progress table as in progress.html */
+    NUM_TOPICS
+  };
+
+  WebPushChannel(QObject *parent, HtmlInfoBuilder *htmlInfoBuilderParam, bool verboseParam);
+  virtual ~WebPushChannel() override;
+
+  WebPushChannel(const WebPushChannel& other) = delete;
+  WebPushChannel& operator=(const WebPushChannel& other) = delete;
+
+  /* Register subscriber for the given topics. Returns false if the maximum number of subscribers is reached.
+   * Has to be followed by unsubscribe() if true. Thread safe. */
+  bool subscribe(const QVector<Topic>& topics);
+  void unsubscribe(const QVector<Topic>& topics);
+
+  /* Wait until a topic has a newer update than given in lastSequence or timeout occurs.
+   * Returns the formatted event stream text for all updated topics and updates lastSequence.
+   * Sends a compact delta instead of the full message for JSON if useDelta is true and the subscriber
+   * got the previous update.
+   * Returns an empty array on timeout or shutdown. Thread safe. */
+  QByteArray waitForEvents(const QVector<Topic>& topics, QVector<qint64>& lastSequence, bool useDelta, int timeoutMs);
+
+  /* Wake up all subscribers and let them quit. Call before stopping the server. */
+  void shutdown();
+
+  /* Thread safe */
+  bool isShutdown() const
+  {
+    return shutdownFlag.loadAcquire() != 0;
+  }
+
+  /* Event name for topic */
+  static QByteArray topicName(Topic topic);
+
+private:
+  void dataPacketReceived(const atools::fs::sc::SimConnectData& simConnectData);
+  void publish(Topic topic, const QByteArray& full, const QByteArray& delta);
+
+  /* Build a JSON object containing only changed or removed top level keys */
+  static QByteArray buildDelta(const QJsonObject& last, const QJsonObject& next);
+
+  struct Message
+  {
+    qint64 sequence = 0;
+    QByteArray full, delta;
+  };
+
+  /* Guards messages and used by the condition */
+  QMutex mutex;
+  QWaitCondition condition;
+  Message messages[NUM_TOPICS];
+
+  /* Number of subscribers per topic and total */
+  QAtomicInt subscribers[NUM_TOPICS];
+  QAtomicInt numSubscribers;
+  QAtomicInt shutdownFlag;
+
+  /* Main thread only */
+  JsonInfoBuilder *jsonInfoBuilder;
+  HtmlInfoBuilder *htmlInfoBuilder;
+  QJsonObject lastSimJson;
+  QElapsedTimer lastUpdate;
+  int updateIntervalMs, maxSubscribers;
+  bool verbose = false;
+};
+
+#endif // LNM_WEBPUSHCHANNEL_H
@@ -0,0 +1,200 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "web/websnapshot.h"
+
+#include "app/navapp.h"
+#include "connect/connectclient.h"
+#include "info/infocontroller.h"
+#include "mapgui/mappaintwidget.h"
+#include "route/routecontroller.h"
+#include "web/webcontroller.h"
+
+#include <QDateTime>
+
+/* Interval for copying route and map position and for rendering the flight plan table */
+static const int UPDATE_INTERVAL_MS = 1000;
+
+/* Airport texts older than this are refreshed in the background to get updated weather */
+static const qint64 AIRPORT_TEXT_MAX_AGE_MS = 10000;
+
+/* Drop all airport texts if more than this were requested */
+static const int MAX_AIRPORT_TEXTS = 50;
+
+/* Icon size for the flight plan table */
+static const int FLIGHTPLAN_ICON_SIZE = 20;
+
+WebSnapshot::WebSnapshot(QObject *parent, bool verboseParam)
+  : QObject(parent), verbose(verboseParam)
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO;
+
+  connect(NavApp::getConnectClient(), &ConnectClient::dataPacketReceived, this, &WebSnapshot::dataPacketReceived);
+  connect(NavApp::getRouteController(), &RouteController::routeChanged, this, &WebSnapshot::routeChanged);
+  connect(NavApp::getRouteController(), &RouteController::routeAltitudeChanged, this, &WebSnapshot::routeChanged);
+
+  connect(&updateTimer, &QTimer::timeout, this, &WebSnapshot::updateTimeout);
+  updateTimer.setInterval(UPDATE_INTERVAL_MS);
+  updateTimer.start();
+
+  // Fill all values initially to have them ready for the first request
+  userAircraft = NavApp::getUserAircraft();
+  updateTimeout();
+}
+
+WebSnapshot::~WebSnapshot()
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO;
+
+  updateTimer.stop();
+}
+
+atools::fs::sc::SimConnectUserAircraft WebSnapshot::getUserAircraft() const
+{
+  QReadLocker locker(&lock);
+  return userAircraft;
+}
+
+Route WebSnapshot::getRoute() const
+{
+  QReadLocker locker(&lock);
+  return route;
+}
+
+QString WebSnapshot::getFlightplanTableAsHtml() const
+{
+  QReadLocker locker(&lock);
+  return flightplanTableHtml;
+}
+
+atools::geo::Pos WebSnapshot::getCurrentMapWidgetPos() const
+{
+  QReadLocker locker(&lock);
+  return mapWidgetPos;
+}
+
+QStringList WebSnapshot::getAirportText(const QString& ident)
+{
+  qint64 now = QDateTime::currentMSecsSinceEpoch();
+  {
+    QWriteLocker locker(&lock);
+    auto it = airportTexts.find(ident);
+    if(it != airportTexts.end())
+    {
+      if(now - it->timestampMs > AIRPORT_TEXT_MAX_AGE_MS)
+      {
+        // Outdated - return old texts and update in background
+        // Set timestamp to avoid queuing more update requests while waiting
+        it->timestampMs = now;
+        QMetaObject::invokeMethod(this, [this, ident]() {
+          updateAirportText(ident);
+        }, Qt::QueuedConnection);
+      }
+      return it->texts;
+    }
+  }
+
+  // Not cached yet - only case where the server thread has to wait for the main thread
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "Cache miss" << ident;
+
+  QMetaObject::invokeMethod(this, [this, ident]() {
+    updateAirportText(ident);
+  }, Qt::BlockingQueuedConnection);
+
+  QReadLocker locker(&lock);
+  return airportTexts.value(ident).texts;
+}
+
+void WebSnapshot::preDatabaseLoad()
+{
+  QWriteLocker locker(&lock);
+  airportTexts.clear();
+}
+
+void WebSnapshot::updateAirportText(const QString& ident)
+{
+  QStringList texts = NavApp::getInfoController()->getAirportTextFull(ident);
+
+  QWriteLocker locker(&lock);
+  if(airportTexts.size() > MAX_AIRPORT_TEXTS)
+    airportTexts.clear();
+  airportTexts.insert(ident, {texts, QDateTime::currentMSecsSinceEpoch()});
+}
+
+void WebSnapshot::dataPacketReceived(const atools::fs::sc::SimConnectData&)
+{
+  // Connected after the map widget which has already filtered and stored the aircraft
+  atools::fs::sc::SimConnectUserAircraft aircraft = NavApp::getUserAircraft();
+  {
+    QWriteLocker locker(&lock);
+    userAircraft = aircraft;
+  }
+
+  // Active leg is highlighted in the table - render again on change
+  int activeLegIndex = NavApp::getRouteConst().getActiveLegIndex();
+  if(activeLegIndex != lastActiveLegIndex)
+  {
+    lastActiveLegIndex = activeLegIndex;
+    routeDirty = flightplanTableDirty = true;
+  }
+}
+
+void WebSnapshot::routeChanged()
+{
+  routeDirty = flightplanTableDirty = true;
+}
+
+void WebSnapshot::updateTimeout()
+{
+  // Progress needs the current aircraft position in the route - copy it regularly while clients are watching
+  if(routeDirty || (NavApp::isConnectedAndAircraft() && NavApp::getWebController()->hasActiveClients()))
+    updateRoute();
+
+  if(flightplanTableDirty)
+    updateFlightplanTable();
+
+  updateMapWidgetPos();
+}
+
+void WebSnapshot::updateRoute()
+{
+  Route routeCopy = NavApp::getRouteConst();
+
+  QWriteLocker locker(&lock);
+  route = routeCopy;
+  routeDirty = false;
+}
+
+void WebSnapshot::updateFlightplanTable()
+{
+  QString html = NavApp::getRouteController()->getFlightplanTableAsHtml(FLIGHTPLAN_ICON_SIZE, false /* print */);
+
+  QWriteLocker locker(&lock);
+  flightplanTableHtml = html;
+  flightplanTableDirty = false;
+}
+
+void WebSnapshot::updateMapWidgetPos()
+{
+  atools::geo::Pos pos = NavApp::getMapPaintWidgetGui()->getCurrentViewCenterPos();
+
+  QWriteLocker locker(&lock);
+  mapWidgetPos = pos;
+}
@@ -0,0 +1,105 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_WEBSNAPSHOT_H
+#define LNM_WEBSNAPSHOT_H
+
+#include "fs/sc/simconnectuseraircraft.h"
+#include "geo/pos.h"
+#include "route/route.h"
+
+#include <QHash>
+#include <QObject>
+#include <QReadWriteLock>
+#include <QTimer>
+
+namespace atools {
+namespace fs {
+namespace sc {
+class SimConnectData;
+}
+}
+}
+
+/*
+ * Thread safe copies of the data that the HTTP server threads need for the stateful pages.
+ *
+ * All values are published from the main thread when the source data changes and read by the
+ * server threads without waiting for the main event queue.
+ * Objects have to be created and deleted in the main thread.
+ */
+class WebSnapshot :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit WebSnapshot(QObject *parent, bool verboseParam);
+  virtual ~WebSnapshot() override;
+
+  WebSnapshot(const WebSnapshot& other) = delete;
+  WebSnapshot& operator=(const WebSnapshot& other) = delete;
+
+  /* Read methods. Thread safe and return copies. */
+  atools::fs::sc::SimConnectUserAircraft getUserAircraft() const;
+  Route getRoute() const;
+  QString getFlightplanTableAsHtml() const;
+  atools::geo::Pos getCurrentMapWidgetPos() const;
+
+  /* Get airport information as HTML in the string list. Order is main, runway, com, procedure and weather.
+   * Returns cached texts and refreshes outdated ones in the background.
+   * Only the first request for an airport has to wait for the main thread. Thread safe. */
+  QStringList getAirportText(const QString& ident);
+
+  /* Drop all cached texts which might refer to the old database. Call in main thread. */
+  void preDatabaseLoad();
+
+private:
+  /* All methods below are called in the main thread */
+  void dataPacketReceived(const atools::fs::sc::SimConnectData&);
+  void routeChanged();
+  void updateTimeout();
+  void updateAirportText(const QString& ident);
+
+  /* Flight plan and map position */
+  void updateRoute();
+  void updateFlightplanTable();
+  void updateMapWidgetPos();
+
+  struct AirportText
+  {
+    QStringList texts;
+    qint64 timestampMs;
+  };
+
+  /* Guards all values below */
+  mutable QReadWriteLock lock;
+
+  atools::fs::sc::SimConnectUserAircraft userAircraft;
+  Route route;
+  QString flightplanTableHtml;
+  atools::geo::Pos mapWidgetPos;
+  QHash<QString, AirportText> airportTexts;
+
+  /* Main thread only */
+  QTimer updateTimer;
+  bool routeDirty = true, flightplanTableDirty = true;
+  int lastActiveLegIndex = -1;
+  bool verbose = false;
+};
+
+#endif // LNM_WEBSNAPSHOT_H
@@ -18,11 +18,83 @@
 #include "web/webtools.h"
 
 #include <QDebug>
+#include <QFileInfo>
 
 #include "httpserver/httprequest.h"
+#include "httpserver/httpresponse.h"
 
 using namespace stefanfrings;
 
+/* Smaller responses are not worth the compression effort */
+static const int COMPRESS_MIN_BYTES = 1024;
+
+namespace webtools {
+
+bool acceptsEncoding(const HttpRequest& request, const QByteArray& encoding)
+{
+  for(const QByteArray& enc : request.getHeader("Accept-Encoding").split(','))
+  {
+    // Ignore quality values like "gzip;q=0.5"
+    if(enc.split(';').value(0).trimmed() == encoding)
+      return true;
+  }
+  return false;
+}
+
+QByteArray deflate(const QByteArray& data)
+{
+  // qCompress prepends the uncompressed size as four bytes followed by a zlib stream
+  return qCompress(data).mid(4);
+}
+
+bool isCompressibleType(const QByteArray& contentType)
+{
+  return contentType.startsWith("text/") || contentType.startsWith("application/json") ||
+         contentType.startsWith("application/javascript") || contentType.startsWith("image/svg+xml") ||
+         contentType.startsWith("application/yaml");
+}
+
+QByteArray compressibleContentType(const QString& filename)
+{
+  const QString suffix = QFileInfo(filename).suffix().toLower();
+
+  if(suffix == QLatin1String("js"))
+    return "application/javascript; charset=UTF-8";
+  else if(suffix == QLatin1String("css"))
+    return "text/css; charset=UTF-8";
+  else if(suffix == QLatin1String("svg"))
+    return "image/svg+xml";
+  else if(suffix == QLatin1String("json"))
+    return "application/json; charset=UTF-8";
+  else if(suffix == QLatin1String("yaml"))
+    return "application/yaml; charset=UTF-8";
+  else if(suffix == QLatin1String("txt"))
+    return "text/plain; charset=UTF-8";
+  else if(suffix == QLatin1String("htm") || suffix == QLatin1String("html"))
+    return "text/html; charset=UTF-8";
+
+  return QByteArray();
+}
+
+qint64 writeBody(const HttpRequest& request, HttpResponse& response, const QByteArray& body, const QByteArray& contentType)
+{
+  if(body.size() >= COMPRESS_MIN_BYTES && isCompressibleType(contentType) && acceptsEncoding(request, "deflate"))
+  {
+    QByteArray compressed = deflate(body);
+    response.setHeader("Content-Encoding", "deflate");
+    response.setHeader("Vary", "Accept-Encoding");
+    response.write(compressed, true);
+    return compressed.size();
+  }
+  else
+  {
+    response.write(body, true);
+    return body.size();
+  }
+}
+
+} // namespace webtools
+
 Parameter::Parameter(const HttpRequest& request, bool verboseParam)
   : verbose(verboseParam)
 {
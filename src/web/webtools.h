@@ -22,8 +22,32 @@
 
 namespace stefanfrings {
 class HttpRequest;
+class HttpResponse;
 }
 
+class QString;
+
+namespace webtools {
+
+/* true if the Accept-Encoding header of the request lists the encoding like "gzip" or "deflate" */
+bool acceptsEncoding(const stefanfrings::HttpRequest& request, const QByteArray& encoding);
+
+/* Compress data for HTTP "deflate" content encoding which is a zlib stream */
+QByteArray deflate(const QByteArray& data);
+
+/* true for text content types like HTML, JSON, CSS or JavaScript which are worth compressing */
+bool isCompressibleType(const QByteArray& contentType);
+
+/* Content type for text files by extension or empty if file is binary or unknown */
+QByteArray compressibleContentType(const QString& filename);
+
+/* Write complete body and close response. Compresses the body with deflate if the
+ * client accepts it, content type is text and size is large enough. Returns number of bytes written. */
+qint64 writeBody(const stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response, const QByteArray& body,
+               const QByteArray& contentType);
+
+} // namespace webtools
+
 /*
  * Wraps parameters of a HTTP request and provides typed accessors for reading.
  */
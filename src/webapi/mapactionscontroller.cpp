@@ -29,18 +29,77 @@
 #include "app/navapp.h"
 #include "common/mapresult.h"
 #include "web/webmapcontroller.h"
+#include "route/routecontroller.h"
+#include "db/databasemanager.h"
+#include "userdata/userdatacontroller.h"
+#include "options/optionsdialog.h"
 
 #include <QDebug>
 #include <QBuffer>
 #include <QPixmap>
+#include <QDateTime>
+#include <QtMath>
+#include <QTextStream>
+#include <QRandomGenerator>
 
 using InfoBuilderTypes::MapFeaturesData;
 
+/* Encoded tile cache size */
+static const int TILE_CACHE_SIZE_KB = 64 * 1024;
+
+/* Tiles are rendered again after this time to catch weather, online and logbook changes */
+static const int TILE_MAX_AGE_S = 60;
+
+static const int TILE_MAX_ZOOM = 20;
+
+/* Feature tokens not used for this time are removed */
+static const qint64 FEATURE_SESSION_MAX_AGE_MS = 10 * 60 * 1000;
+static const int FEATURE_SESSION_MAX = 100;
+
+/* Compress feature responses larger than this if the client accepts it */
+static const int FEATURE_COMPRESS_MIN_BYTES = 1024;
+
+namespace  {
+/* Remove all features which were sent before and remember the remaining ones */
+template<typename TYPE>
+void removeKnown(QList<TYPE>& list, QSet<quint64>& knownIds, quint64 typeIndex)
+{
+  QList<TYPE> filtered;
+  for(const TYPE& type : list)
+  {
+    quint64 key = (typeIndex << 32) | static_cast<quint32>(type.id);
+    if(!knownIds.contains(key))
+    {
+      knownIds.insert(key);
+      filtered.append(type);
+    }
+  }
+  list = filtered;
+}
+
+}
+
 MapActionsController::MapActionsController(QObject *parent, bool verboseParam, AbstractInfoBuilder* infoBuilder) :
     AbstractLnmActionsController(parent, verboseParam, infoBuilder), parentWidget((QWidget *)parent) // WARNING: Uncertain cast (QWidget *) QObject
 {
     qDebug() << Q_FUNC_INFO;
     init();
+
+    tileCache.setMaxCost(TILE_CACHE_SIZE_KB);
+
+    // Invalidate cached tiles on data changes which are not covered by map settings
+    auto updateRevision = [this]() -> void {
+        dataRevision++;
+    };
+    connect(NavApp::getRouteController(), &RouteController::routeChanged, this, updateRevision);
+    connect(NavApp::getDatabaseManager(), &DatabaseManager::postDatabaseLoad, this, updateRevision);
+    connect(NavApp::getDatabaseManager(), &DatabaseManager::postDatabaseLoad, this, [this]() -> void {
+        featureRevision++;
+        featureSessions.clear();
+    });
+    connect(NavApp::getUserdataController(), &UserdataController::userdataChanged, this, updateRevision);
+    connect(NavApp::getOptionsDialog(), &OptionsDialog::optionsChanged, this, updateRevision);
+    connect(NavApp::getOptionsDialog(), &OptionsDialog::styleChanged, this, updateRevision);
 }
 
 WebApiResponse MapActionsController::imageAction(WebApiRequest request){
@@ -63,42 +122,104 @@ WebApiResponse MapActionsController::imageAction(WebApiRequest request){
         detailFactor
     );
 
-    QString format = QString(request.parameters.value("format"));
-    int quality = request.parameters.value("quality").toInt();
-
     if(map.isValid())
     {
       // ===========================================================================
-      // Write pixmap as image
-      QByteArray bytes;
-      QBuffer buffer(&bytes);
-      buffer.open(QIODevice::WriteOnly);
-
-      if(format == QLatin1String("jpg"))
-      {
-          response.headers.replace("Content-Type", "image/jpg");
-          map.pixmap.save(&buffer, "PNG", quality);
-      }
-      else if(format == QLatin1String("png"))
-      {
-          response.headers.replace("Content-Type", "image/png");
-          map.pixmap.save(&buffer, "PNG", quality);
-      }
-      else
-        // Should never happen
-        qWarning() << Q_FUNC_INFO << "invalid format";
+      // Pass image to the server thread which encodes it as jpg, png or webp
+      response.image = map.pixmap.toImage();
+      response.imageFormat = request.parameters.value("format");
+      response.imageQuality = request.parameters.value("quality");
 
       // Add copyright/attributions to header
       response.headers.insert("Image-Attributions",
                               NavApp::getMapThemeHandler()->getTheme(mapPaintWidget->getCurrentThemeId()).getCopyright().toUtf8());
 
       response.status = 200;
-      response.body = bytes;
     }
     return response;
 
 }
 
+WebApiResponse MapActionsController::tileAction(WebApiRequest request){
+
+    WebApiResponse response = getResponse();
+
+    // Path is /map/tile/{z}/{x}/{y} with optional file extension
+    QList<QByteArray> path = request.path.split('/');
+    bool okZ = false, okX = false, okY = false;
+    int z = path.value(3).toInt(&okZ);
+    int x = path.value(4).toInt(&okX);
+    int y = path.value(5).split('.').value(0).toInt(&okY);
+
+    if(!okZ || !okX || !okY || z < 0 || z > TILE_MAX_ZOOM || x < 0 || y < 0 || x >= (1 << z) || y >= (1 << z))
+    {
+        response.status = 400; /* Bad request */
+        response.body = "Invalid tile";
+        return response;
+    }
+
+    int size = request.parameters.value("size", "256").toInt() == 512 ? 512 : 256;
+    QByteArray format = request.parameters.value("format", "png") == "jpg" ? "jpg" : "png";
+    int quality = request.parameters.value("quality", "-1").toInt();
+    int detailFactor = request.parameters.value("detailfactor", QByteArray::number(MapLayerSettings::MAP_DEFAULT_DETAIL_LEVEL)).toInt();
+
+    QByteArray key = tileCacheKey(z, x, y, size, format, quality, detailFactor);
+
+    QByteArray bytes;
+    bool cached = false;
+    {
+        QMutexLocker locker(&tileCacheMutex);
+        QByteArray *tile = tileCache.object(key);
+        if(tile != nullptr)
+        {
+            bytes = *tile;
+            cached = true;
+        }
+    }
+
+    if(!cached)
+    {
+        MapPixmap map = getPixmapTile(z, x, y, size, detailFactor);
+        if(!map.isValid())
+            return response;
+
+        QBuffer buffer(&bytes);
+        buffer.open(QIODevice::WriteOnly);
+        map.pixmap.save(&buffer, format == "jpg" ? "JPG" : "PNG", quality);
+
+        QMutexLocker locker(&tileCacheMutex);
+        tileCache.insert(key, new QByteArray(bytes), bytes.size() / 1024 + 1);
+    }
+
+    response.headers.replace("Content-Type", format == "jpg" ? "image/jpg" : "image/png");
+    response.headers.insert("Cache-Control", "max-age=" + QByteArray::number(TILE_MAX_AGE_S));
+    response.headers.insert("Tile-Cache", cached ? "hit" : "miss");
+    response.headers.insert("Image-Attributions",
+                            NavApp::getMapThemeHandler()->getTheme(mapPaintWidget->getCurrentThemeId()).getCopyright().toUtf8());
+
+    response.status = 200;
+    response.body = bytes;
+    return response;
+}
+
+QByteArray MapActionsController::tileCacheKey(int z, int x, int y, int size, const QByteArray& format, int quality,
+                                              int detailFactor) const
+{
+    const MapWidget *mapWidget = NavApp::getMapWidgetGui();
+    const map::MapAirspaceFilter& airspaces = mapWidget->getShownAirspaces();
+
+    QByteArray key;
+    QTextStream stream(&key);
+    stream << z << '/' << x << '/' << y << '/' << size << '/' << format << '/' << quality << '/' << detailFactor << '/'
+           << mapWidget->getCurrentThemeId() << '/'
+           << mapWidget->getShownMapTypes().asFlagType() << '/' << static_cast<int>(mapWidget->getShownMapDisplayTypes()) << '/'
+           << static_cast<int>(airspaces.types) << '/' << static_cast<int>(airspaces.flags) << '/'
+           << airspaces.minAltitudeFt << '/' << airspaces.maxAltitudeFt << '/'
+           << dataRevision << '/' << QDateTime::currentSecsSinceEpoch() / TILE_MAX_AGE_S;
+    stream.flush();
+    return key;
+}
+
 WebApiResponse MapActionsController::featuresAction(WebApiRequest request){
 
     WebApiResponse response = getResponse();
@@ -129,12 +250,29 @@ WebApiResponse MapActionsController::featuresAction(WebApiRequest request){
     imageAction(*imageRequest);
 
     // Extract results created during dummy image request
-    const QList<map::MapAirport> airports = *mapPaintWidget->getMapQuery()->getAirportsByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,map::NONE,overflow);
+    QList<map::MapAirport> airports = *mapPaintWidget->getMapQuery()->getAirportsByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,map::NONE,overflow);
 
-    const QList<map::MapNdb> ndbs = *mapPaintWidget->getMapQuery()->getNdbsByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,overflow);
-    const QList<map::MapVor> vors = *mapPaintWidget->getMapQuery()->getVorsByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,overflow);
-    const QList<map::MapMarker> markers = *mapPaintWidget->getMapQuery()->getMarkersByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,overflow);
-    const QList<map::MapWaypoint> waypoints = mapPaintWidget->getWaypointTrackQuery()->getWaypointsByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,overflow);
+    QList<map::MapNdb> ndbs = *mapPaintWidget->getMapQuery()->getNdbsByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,overflow);
+    QList<map::MapVor> vors = *mapPaintWidget->getMapQuery()->getVorsByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,overflow);
+    QList<map::MapMarker> markers = *mapPaintWidget->getMapQuery()->getMarkersByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,overflow);
+    QList<map::MapWaypoint> waypoints = mapPaintWidget->getWaypointTrackQuery()->getWaypointsByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,overflow);
+
+    if(request.parameters.contains("token"))
+    {
+        // Delta request - drop all features the client already has ===================
+        QByteArray token = request.parameters.value("token");
+        bool reset = false;
+        FeatureSession& session = featureSession(token, reset);
+
+        removeKnown(airports, session.knownIds, 0);
+        removeKnown(ndbs, session.knownIds, 1);
+        removeKnown(vors, session.knownIds, 2);
+        removeKnown(markers, session.knownIds, 3);
+        removeKnown(waypoints, session.knownIds, 4);
+
+        response.headers.insert("Features-Token", token);
+        response.headers.insert("Features-Reset", reset ? "true" : "false");
+    }
 
     MapFeaturesData data = {
         airports,
@@ -146,10 +284,45 @@ WebApiResponse MapActionsController::featuresAction(WebApiRequest request){
 
     response.body = infoBuilder->features(data);
 
+    // Use zlib stream from qCompress without the length prefix which is the HTTP deflate encoding
+    if(response.body.size() > FEATURE_COMPRESS_MIN_BYTES &&
+       request.headers.value("accept-encoding").contains("deflate")){
+        response.body = qCompress(response.body).mid(4);
+        response.headers.insert("Content-Encoding", "deflate");
+    }
+
     return response;
 
 }
 
+MapActionsController::FeatureSession& MapActionsController::featureSession(QByteArray& token, bool& reset)
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    // Remove unused sessions
+    for(auto it = featureSessions.begin(); it != featureSessions.end();){
+        if(now - it->lastAccessMs > FEATURE_SESSION_MAX_AGE_MS)
+            it = featureSessions.erase(it);
+        else
+            ++it;
+    }
+
+    // Token is "revision-random" and is invalid after database changes
+    reset = !token.startsWith(QByteArray::number(featureRevision) + '-') || !featureSessions.contains(token);
+    if(reset){
+        if(featureSessions.size() >= FEATURE_SESSION_MAX)
+            featureSessions.clear();
+
+        token = QByteArray::number(featureRevision) + '-' +
+                QByteArray::number(QRandomGenerator::global()->generate64(), 16);
+        featureSessions.insert(token, FeatureSession());
+    }
+
+    FeatureSession& session = featureSessions[token];
+    session.lastAccessMs = now;
+    return session;
+}
+
 WebApiResponse MapActionsController::featureAction(WebApiRequest request){
 
     WebApiResponse response = getResponse();
@@ -359,3 +532,52 @@ MapPixmap MapActionsController::getPixmapRect(int width, int height, atools::geo
     return mapPixmap;
   }
 }
+
+MapPixmap MapActionsController::getPixmapTile(int z, int x, int y, int size, int detailFactor)
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << z << x << y << size;
+
+  if(mapPaintWidget != nullptr)
+  {
+    QMutexLocker locker(&mapPaintWidgetMutex);
+
+    // Copy all map settings - this also sets the Mercator projection
+    mapPaintWidget->copySettings(*NavApp::getMapWidgetGui());
+
+    // Do not center world rectangle when resizing
+    mapPaintWidget->setKeepWorldRect(false);
+    mapPaintWidget->resize(size, size);
+
+    // Center of tile in web mercator coordinates
+    double n = static_cast<double>(1 << z);
+    double lonX = (x + 0.5) / n * 360. - 180.;
+    double latY = qRadiansToDegrees(std::atan(std::sinh(M_PI * (1. - 2. * (y + 0.5) / n))));
+    mapPaintWidget->centerOn(lonX, latY, false /* animated */);
+
+    // World width is four times the radius for the Marble Mercator projection
+    mapPaintWidget->setRadius(size * (1 << z) / 4);
+
+    // Disable dynamic/live features
+    mapPaintWidget->setShowMapObject(map::AIRCRAFT_ALL, false);
+    mapPaintWidget->setShowMapObject(map::AIRCRAFT_TRAIL, false);
+
+    // Set detail factor
+    mapPaintWidget->getMapPaintLayer()->setDetailLevel(detailFactor);
+
+    // Disable copyright note
+    mapPaintWidget->setPaintCopyright(false);
+
+    MapPixmap mapPixmap;
+    mapPixmap.correctedDistanceKm = mapPixmap.requestedDistanceKm = static_cast<float>(mapPaintWidget->distance());
+    mapPixmap.pixmap = mapPaintWidget->getPixmap(size, size);
+    mapPixmap.pos = mapPaintWidget->getCurrentViewCenterPos();
+
+    return mapPixmap;
+  }
+  else
+  {
+    qWarning() << Q_FUNC_INFO << "mapPaintWidget is null";
+    return MapPixmap();
+  }
+}
@@ -19,6 +19,9 @@
 #define MAPACTIONSCONTROLLER_H
 
 #include "webapi/abstractlnmactionscontroller.h"
+#include <QCache>
+#include <QHash>
+#include <QSet>
 #include <QMutex>
 #include <QPixmap>
 #include "mapgui/maplayersettings.h"
@@ -49,8 +52,14 @@ public:
      * @brief get map image by rect
      */
     Q_INVOKABLE WebApiResponse imageAction(WebApiRequest request);
+    /**
+     * @brief get web mercator map tile by path /map/tile/{z}/{x}/{y}
+     */
+    Q_INVOKABLE WebApiResponse tileAction(WebApiRequest request);
     /**
      * @brief get map features by rect
+     * Optional parameter "token" returns only features not sent before for this token.
+     * The token to use for the next request is returned in header "Features-Token".
      */
     Q_INVOKABLE WebApiResponse featuresAction(WebApiRequest request);
     /**
@@ -80,6 +89,35 @@ protected:
     /* Zoom to rectangel on map. */
     MapPixmap getPixmapRect(int width, int height, atools::geo::Rect rect, int detailFactor = MapLayerSettings::MAP_DEFAULT_DETAIL_LEVEL, const QString& errorCase = tr("Invalid rectangle"));
 
+    /* Render square web mercator tile z/x/y with size pixels. */
+    MapPixmap getPixmapTile(int z, int x, int y, int size, int detailFactor);
+
+    /* Build cache key from tile, request options, map settings and data revision */
+    QByteArray tileCacheKey(int z, int x, int y, int size, const QByteArray& format, int quality, int detailFactor) const;
+
+    /* Encoded tiles. Cost is kB. */
+    QCache<QByteArray, QByteArray> tileCache;
+    QMutex tileCacheMutex;
+
+    /* Incremented on flight plan, userpoint, option and database changes */
+    quint32 dataRevision = 0;
+
+    /* Features already sent to a client identified by a token */
+    struct FeatureSession
+    {
+      QSet<quint64> knownIds;
+      qint64 lastAccessMs;
+    };
+
+    /* Get session for token or create a new one if token is unknown or outdated. Token is updated. */
+    FeatureSession& featureSession(QByteArray& token, bool& reset);
+
+    /* Sessions by token. Only accessed in the main thread like all actions. */
+    QHash<QByteArray, FeatureSession> featureSessions;
+
+    /* Incremented on database changes to invalidate feature tokens since ids change */
+    quint32 featureRevision = 0;
+
     MapPaintWidget *mapPaintWidget = nullptr;
     QMutex mapPaintWidgetMutex;
 
@@ -0,0 +1,117 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "routeactionscontroller.h"
+#include "airspace/airspacecontroller.h"
+#include "app/navapp.h"
+#include "common/abstractinfobuilder.h"
+#include "common/infobuildertypes.h"
+#include "route/route.h"
+#include "route/routecontroller.h"
+#include "routestring/routestringbatch.h"
+#include "routestring/routestringdialog.h"
+#include "webapi/webapirequest.h"
+#include "webapi/webapiresponse.h"
+
+using InfoBuilderTypes::RouteBatchData;
+using InfoBuilderTypes::RouteAirspacesData;
+
+#include <QDebug>
+#include <QThread>
+
+RouteActionsController::RouteActionsController(QObject *parent, bool verboseParam, AbstractInfoBuilder* infoBuilder) :
+    AbstractLnmActionsController(parent, verboseParam, infoBuilder)
+{
+    if(verbose)
+        qDebug() << Q_FUNC_INFO;
+}
+
+WebApiResponse RouteActionsController::batchAction(WebApiRequest request){
+    if(verbose)
+        qDebug() << Q_FUNC_INFO << request.parameters.value("output");
+
+    // Get a new response object
+    WebApiResponse response = getResponse();
+
+    QStringList routeStrings;
+    const QStringList lines = QString::fromUtf8(request.body).split('\n');
+    for(const QString& line : lines){
+        QString routeString = line.simplified();
+        if(!routeString.isEmpty() && !routeString.startsWith('#'))
+            routeStrings.append(routeString);
+    }
+
+    if(routeStrings.isEmpty()){
+        response.body = "No route descriptions";
+        response.status = 400;
+        return response;
+    }
+
+    QString outputDir = QString::fromUtf8(request.parameters.value("output"));
+    bool benchmark = request.parameters.value("benchmark") == "true";
+
+    // Reader uses the GUI queries which are not thread safe - run in main thread
+    auto run = [&routeStrings, &outputDir, &benchmark, &response, this]() -> void {
+        RouteStringBatch batch(NavApp::getRouteController()->getFlightplanEntryBuilder());
+        batch.run(routeStrings, outputDir, RouteStringDialog::getOptionsFromSettings());
+        response.body = infoBuilder->routebatch({&batch.getResults(), benchmark});
+    };
+
+    if(QThread::currentThread() == NavApp::navAppInstance()->thread())
+        run();
+    else
+        QMetaObject::invokeMethod(NavApp::navAppInstance(), run, Qt::BlockingQueuedConnection);
+
+    response.status = 200;
+
+    return response;
+
+}
+
+WebApiResponse RouteActionsController::airspacesAction(WebApiRequest request){
+    if(verbose)
+        qDebug() << Q_FUNC_INFO << request.parameters.value("corridor");
+
+    // Get a new response object
+    WebApiResponse response = getResponse();
+
+    bool ok;
+    float corridorNm = request.parameters.value("corridor").toFloat(&ok);
+    if(!ok)
+        corridorNm = 5.f;
+
+    // Queries and route are not thread safe - run in main thread
+    auto run = [corridorNm, &response, this]() -> void {
+        AirspaceController *controller = NavApp::getAirspaceController();
+        const Route& route = NavApp::getRouteConst();
+        map::MapAirspaceFilter filter(map::AIRSPACE_ALL, map::AIRSPACE_FLAG_DEFAULT, map::MapAirspaceFilter::MIN_AIRSPACE_ALT,
+                                      map::MapAirspaceFilter::MAX_AIRSPACE_ALT);
+        const QVector<AirspaceLegResult> results =
+            controller->getAirspacesAlongRoute(route, corridorNm, filter, controller->getAirspaceSources());
+        response.body = infoBuilder->routeairspaces({&route, &results, corridorNm});
+    };
+
+    if(QThread::currentThread() == NavApp::navAppInstance()->thread())
+        run();
+    else
+        QMetaObject::invokeMethod(NavApp::navAppInstance(), run, Qt::BlockingQueuedConnection);
+
+    response.status = 200;
+
+    return response;
+
+}
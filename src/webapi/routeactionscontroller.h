@@ -0,0 +1,45 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef ROUTEACTIONSCONTROLLER_H
+#define ROUTEACTIONSCONTROLLER_H
+
+#include "webapi/abstractlnmactionscontroller.h"
+
+/**
+ * @brief Flight plan route description actions controller implementation.
+ */
+class RouteActionsController :
+        public AbstractLnmActionsController
+{
+    Q_OBJECT
+public:
+    Q_INVOKABLE RouteActionsController(QObject *parent, bool verboseParam, AbstractInfoBuilder* infoBuilder);
+    /**
+     * @brief read route descriptions from request body (one per line) and
+     * save them as LNMPLN files to directory given by parameter "output".
+     * Timings per plan are added if parameter "benchmark" is "true".
+     */
+    Q_INVOKABLE WebApiResponse batchAction(WebApiRequest request);
+    /**
+     * @brief get airspaces within parameter "corridor" (NM, default 5) of the current flight plan
+     * and within the altitude profile of each leg.
+     */
+    Q_INVOKABLE WebApiResponse airspacesAction(WebApiRequest request);
+};
+
+#endif // ROUTEACTIONSCONTROLLER_H
@@ -3,9 +3,16 @@
 #include "mapgui/mapwidget.h"
 #include "common/infobuildertypes.h"
 #include "common/abstractinfobuilder.h"
+#include "common/memoryregistry.h"
 #include "app/navapp.h"
+#include "web/webcontroller.h"
+#include "web/webmapcontroller.h"
+#include "web/webmetrics.h"
 
 using InfoBuilderTypes::UiInfoData;
+using InfoBuilderTypes::PaintStatisticsData;
+using InfoBuilderTypes::WebMetricsData;
+using InfoBuilderTypes::MemoryUsageData;
 
 #include <QDebug>
 
@@ -37,3 +44,78 @@ Q_UNUSED(request)
     return response;
 
 }
+
+WebApiResponse UiActionsController::paintstatisticsAction(WebApiRequest request){
+Q_UNUSED(request)
+    if(verbose)
+        qDebug() << Q_FUNC_INFO;
+
+    // Get a new response object
+    WebApiResponse response = getResponse();
+
+    PaintStatisticsData data = {
+        &getMainWindow()->getMapWidget()->getPaintStatistics(),
+        &NavApp::getMapPaintWidgetWeb()->getPaintStatistics()
+    };
+
+    response.body = infoBuilder->paintstatistics(data);
+    response.status = 200;
+
+    return response;
+
+}
+
+WebApiResponse UiActionsController::metricsAction(WebApiRequest request){
+Q_UNUSED(request)
+    if(verbose)
+        qDebug() << Q_FUNC_INFO;
+
+    // Get a new response object
+    WebApiResponse response = getResponse();
+
+    const WebController *webController = NavApp::getWebController();
+    const WebMetrics *metrics = webController->getMetrics();
+    const WebMapController *mapController = webController->getWebMapController();
+
+    WebMetricsData data = {
+        metrics->getStats(),
+        metrics->getActiveRequests(),
+        metrics->getMaxActiveRequests(),
+        webController->getMinThreads(),
+        webController->getMaxThreads(),
+        webController->getKeepAliveMs(),
+        mapController->getQueueDepth(),
+        mapController->getMaxQueueDepth(),
+        mapController->getNumTimeouts()
+    };
+
+    response.body = infoBuilder->webmetrics(data);
+    response.status = 200;
+
+    return response;
+
+}
+
+WebApiResponse UiActionsController::memoryAction(WebApiRequest request){
+Q_UNUSED(request)
+    if(verbose)
+        qDebug() << Q_FUNC_INFO;
+
+    // Get a new response object
+    WebApiResponse response = getResponse();
+
+    MemoryUsageData data = {
+        MemoryRegistry::collect(),
+        MemoryRegistry::residentMemoryBytes(),
+        MemoryRegistry::getCacheBudgetBytes(),
+        MemoryRegistry::getResidentBudgetBytes(),
+        MemoryRegistry::getNumEvictionRuns(),
+        MemoryRegistry::getNumEvictedOwners()
+    };
+
+    response.body = infoBuilder->memoryusage(data);
+    response.status = 200;
+
+    return response;
+
+}
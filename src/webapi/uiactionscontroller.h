@@ -13,6 +13,18 @@ public:
      * @brief get ui info
      */
     Q_INVOKABLE WebApiResponse infoAction(WebApiRequest request);
+    /**
+     * @brief get timing statistics for all map painters
+     */
+    Q_INVOKABLE WebApiResponse paintstatisticsAction(WebApiRequest request);
+    /**
+     * @brief get web server request counts, latency percentiles per endpoint and render queue state
+     */
+    Q_INVOKABLE WebApiResponse metricsAction(WebApiRequest request);
+    /**
+     * @brief get estimated memory usage of all caches, resident memory and budgets
+     */
+    Q_INVOKABLE WebApiResponse memoryAction(WebApiRequest request);
 };
 
 #endif // UIACTIONSCONTROLLER_H
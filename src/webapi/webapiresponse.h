@@ -19,6 +19,7 @@
 #define WEBAPIRESPONSE_H
 
 #include <QByteArray>
+#include <QImage>
 #include <QMultiMap>
 
 /**
@@ -29,5 +30,13 @@ public:
     int status;
     QMultiMap<QByteArray, QByteArray> headers;
     QByteArray body;
+
+    /**
+     * @brief Image to be encoded by the server thread instead of body
+     * if not null. Keeps encoding out of the main thread.
+     */
+    QImage image;
+    QByteArray imageFormat;
+    QByteArray imageQuality;
 };
 #endif // WEBAPIRESPONSE_H